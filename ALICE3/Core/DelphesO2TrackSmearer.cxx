@@ -34,6 +34,11 @@
 // #include <iostream>
 // #include <fstream>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "ALICE3/Core/DelphesO2TrackSmearer.h"
 
 namespace o2
@@ -78,27 +83,35 @@ bool TrackSmearer::loadTable(int pdg, const char* filename, bool forceReload)
     mLUTHeader[ipdg] = nullptr;
     return false;
   }
-  const int nnch = mLUTHeader[ipdg]->nchmap.nbins;
-  const int nrad = mLUTHeader[ipdg]->radmap.nbins;
-  const int neta = mLUTHeader[ipdg]->etamap.nbins;
-  const int npt = mLUTHeader[ipdg]->ptmap.nbins;
-  mLUTEntry[ipdg] = new lutEntry_t****[nnch];
-  for (int inch = 0; inch < nnch; ++inch) {
-    mLUTEntry[ipdg][inch] = new lutEntry_t***[nrad];
-    for (int irad = 0; irad < nrad; ++irad) {
-      mLUTEntry[ipdg][inch][irad] = new lutEntry_t**[neta];
-      for (int ieta = 0; ieta < neta; ++ieta) {
-        mLUTEntry[ipdg][inch][irad][ieta] = new lutEntry_t*[npt];
-        for (int ipt = 0; ipt < npt; ++ipt) {
-          mLUTEntry[ipdg][inch][irad][ieta][ipt] = new lutEntry_t;
-          lutFile.read(reinterpret_cast<char*>(mLUTEntry[ipdg][inch][irad][ieta][ipt]), sizeof(lutEntry_t));
-          if (lutFile.gcount() != sizeof(lutEntry_t)) {
-            std::cout << " --- troubles reading covariance matrix entry for PDG " << pdg << ": " << filename << std::endl;
-            return false;
-          }
-        }
-      }
+  auto& lut = mLUT[ipdg];
+  lut.nch.set(mLUTHeader[ipdg]->nchmap);
+  lut.rad.set(mLUTHeader[ipdg]->radmap);
+  lut.eta.set(mLUTHeader[ipdg]->etamap);
+  lut.pt.set(mLUTHeader[ipdg]->ptmap);
+  lut.strideNch = lut.rad.nbins * lut.eta.nbins * lut.pt.nbins;
+  const std::size_t nEntries = static_cast<std::size_t>(lut.nch.nbins) * lut.strideNch;
+  lut.entries.clear();
+  lut.mapping.reset();
+  lut.mapped = nullptr;
+  if (mUseMemoryMapping) {
+    if (!mapTable(lut, filename, nEntries)) {
+      delete mLUTHeader[ipdg];
+      mLUTHeader[ipdg] = nullptr;
+      return false;
     }
+    std::cout << " --- mapped covariance matrix table for PDG " << pdg << ": " << filename << std::endl;
+    mLUTHeader[ipdg]->print();
+    return true;
+  }
+  lut.entries.resize(nEntries);
+  // the entries are stored in the file in the order of the flat array
+  lutFile.read(reinterpret_cast<char*>(lut.entries.data()), nEntries * sizeof(lutEntry_t));
+  if (static_cast<std::size_t>(lutFile.gcount()) != nEntries * sizeof(lutEntry_t)) {
+    std::cout << " --- troubles reading covariance matrix entry for PDG " << pdg << ": " << filename << std::endl;
+    lut.entries.clear();
+    delete mLUTHeader[ipdg];
+    mLUTHeader[ipdg] = nullptr;
+    return false;
   }
   std::cout << " --- read covariance matrix table for PDG " << pdg << ": " << filename << std::endl;
   mLUTHeader[ipdg]->print();
@@ -109,64 +122,88 @@ bool TrackSmearer::loadTable(int pdg, const char* filename, bool forceReload)
 
 /*****************************************************************/
 
+bool TrackSmearer::mapTable(lut_t& lut, const char* filename, std::size_t nEntries)
+{
+  const std::size_t size = sizeof(lutHeader_t) + nEntries * sizeof(lutEntry_t);
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    std::cout << " --- cannot open covariance matrix file for mapping: " << filename << std::endl;
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < size) {
+    std::cout << " --- covariance matrix file too short for " << nEntries << " entries: " << filename << std::endl;
+    close(fd);
+    return false;
+  }
+  void* addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd); // the mapping stays valid
+  if (addr == MAP_FAILED) {
+    std::cout << " --- cannot map covariance matrix file: " << filename << std::endl;
+    return false;
+  }
+  lut.mapping = std::shared_ptr<const void>(addr, [size](const void* p) { munmap(const_cast<void*>(p), size); });
+  // sizeof(lutHeader_t) is a multiple of the alignment of lutEntry_t, the entries of the page aligned mapping are aligned
+  lut.mapped = reinterpret_cast<const lutEntry_t*>(static_cast<const char*>(addr) + sizeof(lutHeader_t));
+  return true;
+}
+
+/*****************************************************************/
+
 lutEntry_t*
   TrackSmearer::getLUTEntry(int pdg, float nch, float radius, float eta, float pt, float& interpolatedEff)
 {
   auto ipdg = getIndexPDG(pdg);
   if (!mLUTHeader[ipdg])
     return nullptr;
-  auto inch = mLUTHeader[ipdg]->nchmap.find(nch);
-  auto irad = mLUTHeader[ipdg]->radmap.find(radius);
-  auto ieta = mLUTHeader[ipdg]->etamap.find(eta);
-  auto ipt = mLUTHeader[ipdg]->ptmap.find(pt);
+  auto& lut = mLUT[ipdg];
+  const float nchScaled = lut.nch.scaled(nch);
+  auto inch = lut.nch.find(nchScaled);
+  auto irad = lut.rad.find(lut.rad.scaled(radius));
+  auto ieta = lut.eta.find(lut.eta.scaled(eta));
+  auto ipt = lut.pt.find(lut.pt.scaled(pt));
+  // the entries are not modified, also when they are not in a read-only mapping
+  lutEntry_t* entry = const_cast<lutEntry_t*>(lut.data()) + ((static_cast<std::size_t>(inch) * lut.rad.nbins + irad) * lut.eta.nbins + ieta) * lut.pt.nbins + ipt;
 
+  if (mWhatEfficiency != 1 && mWhatEfficiency != 2)
+    return entry;
+  auto efficiency = [this](const lutEntry_t* e) { return mWhatEfficiency == 1 ? e->eff : e->eff2; };
+  interpolatedEff = efficiency(entry);
   // Interpolate if requested
-  auto fraction = mLUTHeader[ipdg]->nchmap.fracPositionWithinBin(nch);
   if (mInterpolateEfficiency) {
+    auto fraction = lut.nch.fracPositionWithinBin(nch, nchScaled);
     if (fraction > 0.5) {
-      if (mWhatEfficiency == 1) {
-        if (inch < mLUTHeader[ipdg]->nchmap.nbins - 1) {
-          interpolatedEff = (1.5f - fraction) * mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff + (-0.5f + fraction) * mLUTEntry[ipdg][inch + 1][irad][ieta][ipt]->eff;
-        } else {
-          interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff;
-        }
-      }
-      if (mWhatEfficiency == 2) {
-        if (inch < mLUTHeader[ipdg]->nchmap.nbins - 1) {
-          interpolatedEff = (1.5f - fraction) * mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff2 + (-0.5f + fraction) * mLUTEntry[ipdg][inch + 1][irad][ieta][ipt]->eff2;
-        } else {
-          interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff2;
-        }
+      if (inch < lut.nch.nbins - 1) {
+        interpolatedEff = (1.5f - fraction) * efficiency(entry) + (-0.5f + fraction) * efficiency(entry + lut.strideNch);
       }
     } else {
-      float comparisonValue = mLUTHeader[ipdg]->nchmap.log ? log10(nch) : nch;
-      if (mWhatEfficiency == 1) {
-        if (inch > 0 && comparisonValue < mLUTHeader[ipdg]->nchmap.max) {
-          interpolatedEff = (0.5f + fraction) * mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff + (0.5f - fraction) * mLUTEntry[ipdg][inch - 1][irad][ieta][ipt]->eff;
-        } else {
-          interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff;
-        }
-      }
-      if (mWhatEfficiency == 2) {
-        if (inch > 0 && comparisonValue < mLUTHeader[ipdg]->nchmap.max) {
-          interpolatedEff = (0.5f + fraction) * mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff2 + (0.5f - fraction) * mLUTEntry[ipdg][inch - 1][irad][ieta][ipt]->eff2;
-        } else {
-          interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff2;
-        }
+      if (inch > 0 && nchScaled < lut.nch.max) {
+        interpolatedEff = (0.5f + fraction) * efficiency(entry) + (0.5f - fraction) * efficiency(entry - lut.strideNch);
       }
     }
-  } else {
-    if (mWhatEfficiency == 1)
-      interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff;
-    if (mWhatEfficiency == 2)
-      interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff2;
   }
-  return mLUTEntry[ipdg][inch][irad][ieta][ipt];
+  return entry;
 } //;
 
 /*****************************************************************/
 
+namespace
+{
+// the random numbers of the original smearing
+struct GRandomEngine {
+  double uniform() { return gRandom->Uniform(); }
+  double gaus(double mean, double sigma) { return gRandom->Gaus(mean, sigma); }
+};
+} // namespace
+
 bool TrackSmearer::smearTrack(O2Track& o2track, lutEntry_t* lutEntry, float interpolatedEff)
+{
+  GRandomEngine rng;
+  return smearTrackWith(o2track, lutEntry, interpolatedEff, rng);
+}
+
+template <typename TRandomEngine>
+bool TrackSmearer::smearTrackWith(O2Track& o2track, lutEntry_t* lutEntry, float interpolatedEff, TRandomEngine& rng)
 {
   bool isReconstructed = true;
   // generate efficiency
@@ -178,7 +215,7 @@ bool TrackSmearer::smearTrack(O2Track& o2track, lutEntry_t* lutEntry, float inte
       eff = lutEntry->eff2;
     if (mInterpolateEfficiency)
       eff = interpolatedEff;
-    if (gRandom->Uniform() > eff)
+    if (rng.uniform() > eff)
       isReconstructed = false;
   }
 
@@ -192,7 +229,7 @@ bool TrackSmearer::smearTrack(O2Track& o2track, lutEntry_t* lutEntry, float inte
     double val = 0.;
     for (int j = 0; j < 5; ++j)
       val += lutEntry->eigvec[j][i] * o2track.getParam(j);
-    params_[i] = gRandom->Gaus(val, sqrt(lutEntry->eigval[i]));
+    params_[i] = rng.gaus(val, sqrt(lutEntry->eigval[i]));
   }
   // transform back params vector
   for (int i = 0; i < 5; ++i) {
@@ -228,6 +265,23 @@ bool TrackSmearer::smearTrack(O2Track& o2track, int pdg, float nch)
   return smearTrack(o2track, lutEntry, interpolatedEff);
 }
 
+/*****************************************************************/
+
+bool TrackSmearer::smearTrack(O2Track& o2track, int pdg, float nch, CounterRng& rng)
+{
+
+  auto pt = o2track.getPt();
+  if (abs(pdg) == 1000020030) {
+    pt *= 2.f;
+  }
+  auto eta = o2track.getEta();
+  float interpolatedEff = 0.0f;
+  auto lutEntry = getLUTEntry(pdg, nch, 0., eta, pt, interpolatedEff);
+  if (!lutEntry || !lutEntry->valid)
+    return false;
+  return smearTrackWith(o2track, lutEntry, interpolatedEff, rng);
+}
+
 /*****************************************************************/
 // relative uncertainty on pt
 double TrackSmearer::getPtRes(int pdg, float nch, float eta, float pt)
@@ -278,6 +332,34 @@ double TrackSmearer::getEfficiency(int pdg, float nch, float eta, float pt)
   return efficiency;
 }
 /*****************************************************************/
+// all resolutions and the efficiency
+lutResolutions_t TrackSmearer::getResolutions(int pdg, float nch, float eta, float pt)
+{
+  lutResolutions_t res;
+  float efficiency = 0.0f;
+  auto lutEntry = getLUTEntry(pdg, nch, 0., eta, pt, efficiency);
+  if (!lutEntry)
+    return res;
+  res.valid = true;
+  res.ptRes = sqrt(lutEntry->covm[14]) * lutEntry->pt;
+  res.absPtRes = res.ptRes * lutEntry->pt;
+  res.absEtaRes = fabs(sin(2.0 * atan(exp(-eta)))) * sqrt(lutEntry->covm[9]);
+  res.etaRes = res.absEtaRes / lutEntry->eta;
+  res.efficiency = efficiency;
+  return res;
+}
+/*****************************************************************/
+// batch of tracks, in the order of the span (same random number sequence as smearTrack per track)
+int TrackSmearer::smearTracks(std::span<O2Track> o2tracks, std::span<const int> pdg, float nch, std::span<uint8_t> reconstructed)
+{
+  int nReconstructed = 0;
+  for (std::size_t i = 0; i < o2tracks.size(); ++i) {
+    reconstructed[i] = smearTrack(o2tracks[i], pdg[i], nch);
+    nReconstructed += reconstructed[i];
+  }
+  return nReconstructed;
+}
+/*****************************************************************/
 // Only in DelphesO2
 // bool TrackSmearer::smearTrack(Track& track, bool atDCA)
 // {
@@ -27,9 +27,13 @@
 #include <map>
 #include <iostream>
 #include <fstream>
+#include <memory>
+#include <span>
+#include <vector>
 
 #include "TRandom.h"
 #include "ReconstructionDataFormats/Track.h"
+#include "Common/Core/CounterRng.h"
 
 ///////////////////////////////
 /// DelphesO2/src/lutCovm.hh //
@@ -163,6 +167,16 @@ struct lutEntry_t {
 
 using O2Track = o2::track::TrackParCov;
 
+// resolutions and efficiency of one LUT entry, as returned by getPtRes, getEtaRes, getAbsPtRes, getAbsEtaRes and getEfficiency
+struct lutResolutions_t {
+  bool valid = false; // false if there is no LUT for the PDG code
+  double ptRes = 0.;
+  double etaRes = 0.;
+  double absPtRes = 0.;
+  double absEtaRes = 0.;
+  double efficiency = 0.;
+};
+
 namespace o2
 {
 namespace delphes
@@ -181,17 +195,25 @@ class TrackSmearer
   void interpolateEfficiency(bool val) { mInterpolateEfficiency = val; }      //;
   void skipUnreconstructed(bool val) { mSkipUnreconstructed = val; }          //;
   void setWhatEfficiency(int val) { mWhatEfficiency = val; }                  //;
+  // map the LUT files read-only instead of reading them, the pages are shared by all the processes using the same file
+  void useMemoryMapping(bool val) { mUseMemoryMapping = val; } //;
   lutHeader_t* getLUTHeader(int pdg) { return mLUTHeader[getIndexPDG(pdg)]; } //;
   lutEntry_t* getLUTEntry(int pdg, float nch, float radius, float eta, float pt, float& interpolatedEff);
 
   bool smearTrack(O2Track& o2track, lutEntry_t* lutEntry, float interpolatedEff);
   bool smearTrack(O2Track& o2track, int pdg, float nch);
+  bool smearTrack(O2Track& o2track, int pdg, float nch, CounterRng& rng); // random numbers from rng instead of gRandom
   // bool smearTrack(Track& track, bool atDCA = true); // Only in DelphesO2
   double getPtRes(int pdg, float nch, float eta, float pt);
   double getEtaRes(int pdg, float nch, float eta, float pt);
   double getAbsPtRes(int pdg, float nch, float eta, float pt);
   double getAbsEtaRes(int pdg, float nch, float eta, float pt);
   double getEfficiency(int pdg, float nch, float eta, float pt);
+  lutResolutions_t getResolutions(int pdg, float nch, float eta, float pt); // all of the above with one LUT lookup
+
+  // smears the tracks with the PDG codes pdg (same size), reconstructed[i] (same size) tells if track i is reconstructed
+  // returns the number of reconstructed tracks
+  int smearTracks(std::span<O2Track> o2tracks, std::span<const int> pdg, float nch, std::span<uint8_t> reconstructed);
 
   int getIndexPDG(int pdg)
   {
@@ -221,11 +243,66 @@ class TrackSmearer
 
  protected:
   static constexpr unsigned int nLUTs = 8; // Number of LUT available
+
+  // binning of one LUT dimension, as map_t but with the inverse bin width computed once
+  struct lutAxis_t {
+    int nbins = 1;
+    float min = 0.;
+    float max = 1.e6;
+    float invWidth = 1.e-6;
+    bool log = false;
+    void set(const map_t& map)
+    {
+      nbins = map.nbins;
+      min = map.min;
+      max = map.max;
+      invWidth = map.nbins / (map.max - map.min);
+      log = map.log;
+    }
+    // value on the binned scale (log10 for the logarithmic maps)
+    float scaled(float val) const { return log ? log10(val) : val; }
+    int rawBin(float scaledVal) const { return static_cast<int>((scaledVal - min) * invWidth); }
+    // as map_t::find
+    int find(float scaledVal) const
+    {
+      int bin = rawBin(scaledVal);
+      if (bin < 0)
+        return 0;
+      if (bin > nbins - 1)
+        return nbins - 1;
+      return bin;
+    }
+    // as map_t::fracPositionWithinBin
+    float fracPositionWithinBin(float val, float scaledVal) const
+    {
+      if (log)
+        return (scaledVal - min) * invWidth - rawBin(scaledVal);
+      return val * invWidth - rawBin(scaledVal);
+    }
+  };
+
+  // LUT entries in one array, the pt bin running fastest: ((inch * nrad + irad) * neta + ieta) * npt + ipt
+  // This is also the layout of the LUT file after the header, so that the file can be mapped as it is.
+  struct lut_t {
+    lutAxis_t nch, rad, eta, pt;
+    int strideNch = 0; // neighbouring nch bins, used for the interpolation of the efficiency
+    std::vector<lutEntry_t> entries;   // entries read from the file
+    std::shared_ptr<const void> mapping; // or the mapped file, unmapped with the last copy
+    const lutEntry_t* mapped = nullptr;  // entries in the mapped file
+    const lutEntry_t* data() const { return mapped ? mapped : entries.data(); }
+  };
+  bool mapTable(lut_t& lut, const char* filename, std::size_t nEntries);
+
+  // smearing with the random numbers of rng (uniform() and gaus(mean, sigma))
+  template <typename TRandomEngine>
+  bool smearTrackWith(O2Track& o2track, lutEntry_t* lutEntry, float interpolatedEff, TRandomEngine& rng);
+
   lutHeader_t* mLUTHeader[nLUTs] = {nullptr};
-  lutEntry_t***** mLUTEntry[nLUTs] = {nullptr};
+  lut_t mLUT[nLUTs];
   bool mUseEfficiency = true;
   bool mInterpolateEfficiency = false;
   bool mSkipUnreconstructed = true; // don't smear tracks that are not reco'ed
+  bool mUseMemoryMapping = false;
   int mWhatEfficiency = 1;
   float mdNdEta = 1600.;
 };
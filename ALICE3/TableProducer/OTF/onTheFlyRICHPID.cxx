@@ -14,7 +14,10 @@
 //
 
 #include <utility>
+#include <algorithm>
 #include <cmath>
+#include <thread>
+#include <vector>
 
 #include <TPDGCode.h>
 
@@ -37,7 +40,6 @@
 #include "DataFormatsCalibration/MeanVertexObject.h"
 #include "CommonConstants/GeomConstants.h"
 #include "CommonConstants/PhysicsConstants.h"
-#include "TRandom3.h"
 #include "TVector3.h"
 #include "TString.h"
 #include "ALICE3/DataModel/OTFRICH.h"
@@ -45,6 +47,7 @@
 
 #include "TableHelper.h"
 #include "ALICE3/Core/DelphesO2TrackSmearer.h"
+#include "Common/Core/CounterRng.h"
 
 /// \file onTheFlyRichPid.cxx
 ///
@@ -96,6 +99,9 @@ struct OnTheFlyRichPid {
   Configurable<bool> flagIncludeTrackAngularRes{"flagIncludeTrackAngularRes", true, "flag to include or exclude track time resolution"};
   Configurable<float> multiplicityEtaRange{"multiplicityEtaRange", 0.800000012, "eta range to compute the multiplicity"};
   Configurable<bool> flagRICHLoadDelphesLUTs{"flagRICHLoadDelphesLUTs", false, "flag to load Delphes LUTs for tracking correction (use recoTrack parameters if false)"};
+  Configurable<bool> mapLUTs{"mapLUTs", false, "map the LUT files read-only (shared between processes) instead of reading them"};
+  Configurable<int> nThreads{"nThreads", 1, "number of threads for the track propagation (the results do not depend on it)"};
+  Configurable<int> smearingSeed{"smearingSeed", 0, "seed of the per-track random streams of the smearing (0: random seed)"};
 
   Configurable<std::string> lutEl{"lutEl", "lutCovm.el.dat", "LUT for electrons"};
   Configurable<std::string> lutMu{"lutMu", "lutCovm.mu.dat", "LUT for muons"};
@@ -108,8 +114,18 @@ struct OnTheFlyRichPid {
   // Track smearer (here used to get relative pt and eta uncertainties)
   o2::delphes::DelphesO2TrackSmearer mSmearer;
 
-  // needed: random number generator for smearing
-  TRandom3 pRandomNumberGenerator;
+  // needed: random numbers for smearing, one stream per track keyed by the number of the collision and the track within it
+  uint64_t mSeed = 0;
+  uint64_t mNCollisions = 0;
+
+  // true and reconstructed track of each track of the collision, propagated to the vertex before the smearing
+  struct PropagatedTrack {
+    bool hasMcParticle = false;
+    o2::track::TrackParCov o2track;
+    o2::track::TrackParCov recoTrack;
+    bool flagReachesRadiator = false;
+  };
+  std::vector<PropagatedTrack> propagatedTracks;
 
   // for handling basic QA histograms if requested
   HistogramRegistry histos{"Histos", {}, OutputObjHandlingPolicy::AnalysisObject};
@@ -210,7 +226,7 @@ struct OnTheFlyRichPid {
 
   void init(o2::framework::InitContext&)
   {
-    pRandomNumberGenerator.SetSeed(0); // fully randomize
+    mSeed = CounterRng::seedFromConfig(smearingSeed);
 
     // Load LUT for pt and eta smearing
     if (flagIncludeTrackAngularRes && flagRICHLoadDelphesLUTs) {
@@ -233,6 +249,7 @@ struct OnTheFlyRichPid {
       mapPdgLut.insert(std::make_pair(321, lutKaChar));
       mapPdgLut.insert(std::make_pair(2212, lutPrChar));
 
+      mSmearer.useMemoryMapping(mapLUTs);
       for (auto e : mapPdgLut) {
         if (!mSmearer.loadTable(e.first, e.second)) {
           LOG(fatal) << "Having issue with loading the LUT " << e.first << " " << e.second;
@@ -428,6 +445,45 @@ struct OnTheFlyRichPid {
     return track_angular_resolution;
   }
 
+  // propagates the tracks [first, last) to the vertices and checks if they reach the radiator
+  void propagateTracks(std::size_t first, std::size_t last, o2::dataformats::VertexBase const& mcPvVtx, o2::dataformats::VertexBase const& pvVtx, float magneticField)
+  {
+    for (std::size_t i = first; i < last; i++) {
+      auto& t = propagatedTracks[i];
+      if (!t.hasMcParticle) {
+        continue;
+      }
+      t.o2track.propagateToDCA(mcPvVtx, magneticField);
+      float projectiveRadiatorRadius = radiusRipple(t.o2track.getEta());
+      if (projectiveRadiatorRadius > error_value + 1.) {
+        t.flagReachesRadiator = checkMagfieldLimit(t.o2track, projectiveRadiatorRadius, magneticField);
+      }
+      t.recoTrack.propagateToDCA(pvVtx, magneticField);
+    }
+  }
+
+  // The tracks are independent of each other and the smearing is done afterwards in the order of the tracks,
+  // so that the results do not depend on the number of threads.
+  void propagateTracks(o2::dataformats::VertexBase const& mcPvVtx, o2::dataformats::VertexBase const& pvVtx)
+  {
+    const float magneticField = dBz;
+    const std::size_t nTracks = propagatedTracks.size();
+    const std::size_t nChunks = std::clamp<std::size_t>(nThreads, 1, std::max<std::size_t>(nTracks, 1));
+    if (nChunks == 1) {
+      propagateTracks(0, nTracks, mcPvVtx, pvVtx, magneticField);
+      return;
+    }
+    const std::size_t chunkSizeThread = (nTracks + nChunks - 1) / nChunks;
+    std::vector<std::thread> threads;
+    for (std::size_t iChunk = 1; iChunk < nChunks; iChunk++) {
+      threads.emplace_back([&, iChunk]() { propagateTracks(std::min(iChunk * chunkSizeThread, nTracks), std::min((iChunk + 1) * chunkSizeThread, nTracks), mcPvVtx, pvVtx, magneticField); });
+    }
+    propagateTracks(0, std::min(chunkSizeThread, nTracks), mcPvVtx, pvVtx, magneticField);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
   void process(soa::Join<aod::Collisions, aod::McCollisionLabels>::iterator const& collision, soa::Join<aod::Tracks, aod::TracksCov, aod::McTrackLabels> const& tracks, aod::McParticles const&, aod::McCollisions const&)
   {
 
@@ -468,19 +524,33 @@ struct OnTheFlyRichPid {
       }
     }
 
+    // the perfect and reconstructed tracks are built here and propagated for all tracks at once
+    propagatedTracks.resize(tracks.size());
+    std::size_t iTrack = 0;
+    for (const auto& track : tracks) {
+      auto& t = propagatedTracks[iTrack++];
+      t = PropagatedTrack{};
+      if (!track.has_mcParticle())
+        continue;
+      t.hasMcParticle = true;
+      auto mcParticle = track.mcParticle();
+      t.o2track = convertMCParticleToO2Track(mcParticle);
+      t.recoTrack = getTrackParCov(track);
+    }
+    propagateTracks(mcPvVtx, pvVtx);
+
+    const uint64_t collisionKey = mNCollisions++;
+    iTrack = 0;
     for (const auto& track : tracks) {
+      CounterRng rng(mSeed, collisionKey, iTrack);
+      const auto& propagated = propagatedTracks[iTrack++];
       // first step: find precise arrival time (if any)
       // --- convert track into perfect track
       if (!track.has_mcParticle()) // should always be OK but check please
         continue;
 
       auto mcParticle = track.mcParticle();
-      o2::track::TrackParCov o2track = convertMCParticleToO2Track(mcParticle);
-
-      // float xPv = error_value;
-      if (o2track.propagateToDCA(mcPvVtx, dBz)) {
-        // xPv = o2track.getX();
-      }
+      const auto& o2track = propagated.o2track;
 
       // get particle to calculate Cherenkov angle and resolution
       auto pdgInfo = pdg->GetParticle(mcParticle.pdgCode());
@@ -489,25 +559,18 @@ struct OnTheFlyRichPid {
       }
       float expectedAngleBarrelRich = CherenkovAngle(o2track.getP(), pdgInfo->Mass());
       float barrelRICHAngularResolution = AngularResolution(o2track.getEta());
-      float projectiveRadiatorRadius = radiusRipple(o2track.getEta());
-      bool flagReachesRadiator = false;
-      if (projectiveRadiatorRadius > error_value + 1.) {
-        flagReachesRadiator = checkMagfieldLimit(o2track, projectiveRadiatorRadius, dBz);
-      }
+      bool flagReachesRadiator = propagated.flagReachesRadiator;
       /// DISCLAIMER: Exact extrapolation of angular resolution would require track propagation
       ///             to the RICH radiator (accounting sector inclination) in terms of (R,z).
       ///             The extrapolation with Eta is correct only if the primary vertex is at origin.
       ///             Discrepancies may be negligible, but would be more rigorous if propagation tool is available
 
       // Smear with expected resolutions
-      float measuredAngleBarrelRich = pRandomNumberGenerator.Gaus(expectedAngleBarrelRich, barrelRICHAngularResolution);
+      float measuredAngleBarrelRich = rng.gaus(expectedAngleBarrelRich, barrelRICHAngularResolution);
 
       // Now we calculate the expected arrival time following certain mass hypotheses
       // and the (imperfect!) reconstructed track parametrizations
-      auto recoTrack = getTrackParCov(track);
-      if (recoTrack.propagateToDCA(pvVtx, dBz)) {
-        // xPv = recoTrack.getX();
-      }
+      const auto& recoTrack = propagated.recoTrack;
 
       // Straight to Nsigma
       float deltaThetaBarrelRich[5], nSigmaBarrelRich[5];
@@ -527,8 +590,9 @@ struct OnTheFlyRichPid {
           double pt_resolution = std::pow(recoTrack.getP() / std::cosh(recoTrack.getEta()), 2) * std::sqrt(recoTrack.getSigma1Pt2());
           double eta_resolution = std::fabs(std::sin(2.0 * std::atan(std::exp(-recoTrack.getEta())))) * std::sqrt(recoTrack.getSigmaTgl2());
           if (flagRICHLoadDelphesLUTs) {
-            pt_resolution = mSmearer.getAbsPtRes(pdgInfoThis->PdgCode(), dNdEta, recoTrack.getEta(), recoTrack.getP() / std::cosh(recoTrack.getEta()));
-            eta_resolution = mSmearer.getAbsEtaRes(pdgInfoThis->PdgCode(), dNdEta, recoTrack.getEta(), recoTrack.getP() / std::cosh(recoTrack.getEta()));
+            auto resolutions = mSmearer.getResolutions(pdgInfoThis->PdgCode(), dNdEta, recoTrack.getEta(), recoTrack.getP() / std::cosh(recoTrack.getEta()));
+            pt_resolution = resolutions.absPtRes;
+            eta_resolution = resolutions.absEtaRes;
           }
           // cout << endl <<  "Pt resolution: " << pt_resolution << ", Eta resolution: " << eta_resolution << endl << endl;
           float barrelTrackAngularReso = calculate_track_time_resolution_advanced(recoTrack.getP() / std::cosh(recoTrack.getEta()), recoTrack.getEta(), pt_resolution, eta_resolution, masses[ii], bRichRefractiveIndex);
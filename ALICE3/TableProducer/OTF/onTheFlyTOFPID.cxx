@@ -14,6 +14,9 @@
 //
 
 #include <utility>
+#include <algorithm>
+#include <thread>
+#include <vector>
 
 #include <TPDGCode.h>
 
@@ -36,11 +39,11 @@
 #include "DataFormatsCalibration/MeanVertexObject.h"
 #include "CommonConstants/GeomConstants.h"
 #include "CommonConstants/PhysicsConstants.h"
-#include "TRandom3.h"
 #include "ALICE3/DataModel/OTFTOF.h"
 #include "DetectorsVertexing/HelixHelper.h"
 #include "TableHelper.h"
 #include "ALICE3/Core/DelphesO2TrackSmearer.h"
+#include "Common/Core/CounterRng.h"
 
 /// \file onTheFlyTOFPID.cxx
 ///
@@ -87,6 +90,9 @@ struct OnTheFlyTOFPID {
   Configurable<bool> flagIncludeTrackTimeRes{"flagIncludeTrackTimeRes", true, "flag to include or exclude track time resolution"};
   Configurable<float> multiplicityEtaRange{"multiplicityEtaRange", 0.800000012, "eta range to compute the multiplicity"};
   Configurable<bool> flagTOFLoadDelphesLUTs{"flagTOFLoadDelphesLUTs", false, "flag to load Delphes LUTs for tracking correction (use recoTrack parameters if false)"};
+  Configurable<bool> mapLUTs{"mapLUTs", false, "map the LUT files read-only (shared between processes) instead of reading them"};
+  Configurable<int> nThreads{"nThreads", 1, "number of threads for the track propagation (the results do not depend on it)"};
+  Configurable<int> smearingSeed{"smearingSeed", 0, "seed of the per-track random streams of the smearing (0: random seed)"};
 
   Configurable<std::string> lutEl{"lutEl", "lutCovm.el.dat", "LUT for electrons"};
   Configurable<std::string> lutMu{"lutMu", "lutCovm.mu.dat", "LUT for muons"};
@@ -99,15 +105,26 @@ struct OnTheFlyTOFPID {
   // Track smearer (here used to get absolute pt and eta uncertainties if flagTOFLoadDelphesLUTs is true)
   o2::delphes::DelphesO2TrackSmearer mSmearer;
 
-  // needed: random number generator for smearing
-  TRandom3 pRandomNumberGenerator;
+  // needed: random numbers for smearing, one stream per track keyed by the number of the collision and the track within it
+  uint64_t mSeed = 0;
+  uint64_t mNCollisions = 0;
+
+  // true and reconstructed track of each track of the collision, propagated to the vertex before the smearing
+  struct PropagatedTrack {
+    bool hasMcParticle = false;
+    o2::track::TrackParCov o2track;
+    o2::track::TrackParCov recoTrack;
+    float trackLengthInnerTOF = -1, trackLengthOuterTOF = -1;
+    float trackLengthRecoInnerTOF = -1, trackLengthRecoOuterTOF = -1;
+  };
+  std::vector<PropagatedTrack> propagatedTracks;
 
   // for handling basic QA histograms if requested
   HistogramRegistry histos{"Histos", {}, OutputObjHandlingPolicy::AnalysisObject};
 
   void init(o2::framework::InitContext&)
   {
-    pRandomNumberGenerator.SetSeed(0); // fully randomize
+    mSeed = CounterRng::seedFromConfig(smearingSeed);
 
     // Load LUT for pt and eta smearing
     if (flagIncludeTrackTimeRes && flagTOFLoadDelphesLUTs) {
@@ -130,6 +147,7 @@ struct OnTheFlyTOFPID {
       mapPdgLut.insert(std::make_pair(321, lutKaChar));
       mapPdgLut.insert(std::make_pair(2212, lutPrChar));
 
+      mSmearer.useMemoryMapping(mapLUTs);
       for (auto e : mapPdgLut) {
         if (!mSmearer.loadTable(e.first, e.second)) {
           LOG(fatal) << "Having issue with loading the LUT " << e.first << " " << e.second;
@@ -319,6 +337,52 @@ struct OnTheFlyTOFPID {
     return track_time_resolution;
   }
 
+  // propagates the tracks [first, last) to the vertices and computes their track lengths to the TOF layers
+  void propagateTracks(std::size_t first, std::size_t last, o2::dataformats::VertexBase const& mcPvVtx, o2::dataformats::VertexBase const& pvVtx, float magneticField)
+  {
+    for (std::size_t i = first; i < last; i++) {
+      auto& t = propagatedTracks[i];
+      if (!t.hasMcParticle) {
+        continue;
+      }
+      float xPv = -100;
+      if (t.o2track.propagateToDCA(mcPvVtx, magneticField))
+        xPv = t.o2track.getX();
+      if (xPv > -99.) {
+        t.trackLengthInnerTOF = trackLength(t.o2track, innerTOFRadius, magneticField);
+        t.trackLengthOuterTOF = trackLength(t.o2track, outerTOFRadius, magneticField);
+      }
+      if (t.recoTrack.propagateToDCA(pvVtx, magneticField))
+        xPv = t.recoTrack.getX();
+      if (xPv > -99.) {
+        t.trackLengthRecoInnerTOF = trackLength(t.recoTrack, innerTOFRadius, magneticField);
+        t.trackLengthRecoOuterTOF = trackLength(t.recoTrack, outerTOFRadius, magneticField);
+      }
+    }
+  }
+
+  // The tracks are independent of each other and the smearing is done afterwards in the order of the tracks,
+  // so that the results do not depend on the number of threads.
+  void propagateTracks(o2::dataformats::VertexBase const& mcPvVtx, o2::dataformats::VertexBase const& pvVtx)
+  {
+    const float magneticField = dBz;
+    const std::size_t nTracks = propagatedTracks.size();
+    const std::size_t nChunks = std::clamp<std::size_t>(nThreads, 1, std::max<std::size_t>(nTracks, 1));
+    if (nChunks == 1) {
+      propagateTracks(0, nTracks, mcPvVtx, pvVtx, magneticField);
+      return;
+    }
+    const std::size_t chunkSizeThread = (nTracks + nChunks - 1) / nChunks;
+    std::vector<std::thread> threads;
+    for (std::size_t iChunk = 1; iChunk < nChunks; iChunk++) {
+      threads.emplace_back([&, iChunk]() { propagateTracks(std::min(iChunk * chunkSizeThread, nTracks), std::min((iChunk + 1) * chunkSizeThread, nTracks), mcPvVtx, pvVtx, magneticField); });
+    }
+    propagateTracks(0, std::min(chunkSizeThread, nTracks), mcPvVtx, pvVtx, magneticField);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
   void process(soa::Join<aod::Collisions, aod::McCollisionLabels>::iterator const& collision, soa::Join<aod::Tracks, aod::TracksCov, aod::McTrackLabels> const& tracks, aod::McParticles const&, aod::McCollisions const&)
   {
     o2::dataformats::VertexBase pvVtx({collision.posX(), collision.posY(), collision.posZ()},
@@ -358,22 +422,35 @@ struct OnTheFlyTOFPID {
       }
     }
 
+    // the perfect and reconstructed tracks are built here and propagated for all tracks at once
+    propagatedTracks.resize(tracks.size());
+    std::size_t iTrack = 0;
     for (const auto& track : tracks) {
+      auto& t = propagatedTracks[iTrack++];
+      t = PropagatedTrack{};
+      if (!track.has_mcParticle())
+        continue;
+      t.hasMcParticle = true;
+      auto mcParticle = track.mcParticle();
+      t.o2track = convertMCParticleToO2Track(mcParticle);
+      t.recoTrack = getTrackParCov(track);
+    }
+    propagateTracks(mcPvVtx, pvVtx);
+
+    const uint64_t collisionKey = mNCollisions++;
+    iTrack = 0;
+    for (const auto& track : tracks) {
+      CounterRng rng(mSeed, collisionKey, iTrack);
+      const auto& propagated = propagatedTracks[iTrack++];
       // first step: find precise arrival time (if any)
       // --- convert track into perfect track
       if (!track.has_mcParticle()) // should always be OK but check please
         continue;
 
       auto mcParticle = track.mcParticle();
-      o2::track::TrackParCov o2track = convertMCParticleToO2Track(mcParticle);
-
-      float xPv = -100, trackLengthInnerTOF = -1, trackLengthOuterTOF = -1;
-      if (o2track.propagateToDCA(mcPvVtx, dBz))
-        xPv = o2track.getX();
-      if (xPv > -99.) {
-        trackLengthInnerTOF = trackLength(o2track, innerTOFRadius, dBz);
-        trackLengthOuterTOF = trackLength(o2track, outerTOFRadius, dBz);
-      }
+      const auto& o2track = propagated.o2track;
+      const float trackLengthInnerTOF = propagated.trackLengthInnerTOF;
+      const float trackLengthOuterTOF = propagated.trackLengthOuterTOF;
 
       // get mass to calculate velocity
       auto pdgInfo = pdg->GetParticle(mcParticle.pdgCode());
@@ -384,19 +461,14 @@ struct OnTheFlyTOFPID {
       float expectedTimeOuterTOF = trackLengthOuterTOF / velocity(o2track.getP(), pdgInfo->Mass());
 
       // Smear with expected resolutions
-      float measuredTimeInnerTOF = pRandomNumberGenerator.Gaus(expectedTimeInnerTOF, innerTOFTimeReso);
-      float measuredTimeOuterTOF = pRandomNumberGenerator.Gaus(expectedTimeOuterTOF, outerTOFTimeReso);
+      float measuredTimeInnerTOF = rng.gaus(expectedTimeInnerTOF, innerTOFTimeReso);
+      float measuredTimeOuterTOF = rng.gaus(expectedTimeOuterTOF, outerTOFTimeReso);
 
       // Now we calculate the expected arrival time following certain mass hypotheses
       // and the (imperfect!) reconstructed track parametrizations
-      float trackLengthRecoInnerTOF = -1, trackLengthRecoOuterTOF = -1;
-      auto recoTrack = getTrackParCov(track);
-      if (recoTrack.propagateToDCA(pvVtx, dBz))
-        xPv = recoTrack.getX();
-      if (xPv > -99.) {
-        trackLengthRecoInnerTOF = trackLength(recoTrack, innerTOFRadius, dBz);
-        trackLengthRecoOuterTOF = trackLength(recoTrack, outerTOFRadius, dBz);
-      }
+      const auto& recoTrack = propagated.recoTrack;
+      const float trackLengthRecoInnerTOF = propagated.trackLengthRecoInnerTOF;
+      const float trackLengthRecoOuterTOF = propagated.trackLengthRecoOuterTOF;
 
       // Straight to Nsigma
       float deltaTimeInnerTOF[5], nSigmaInnerTOF[5];
@@ -437,8 +509,9 @@ struct OnTheFlyTOFPID {
           double pt_resolution = std::pow(recoTrack.getP() / std::cosh(recoTrack.getEta()), 2) * std::sqrt(recoTrack.getSigma1Pt2());
           double eta_resolution = std::fabs(std::sin(2.0 * std::atan(std::exp(-recoTrack.getEta())))) * std::sqrt(recoTrack.getSigmaTgl2());
           if (flagTOFLoadDelphesLUTs) {
-            pt_resolution = mSmearer.getAbsPtRes(pdgInfoThis->PdgCode(), dNdEta, recoTrack.getEta(), recoTrack.getP() / std::cosh(recoTrack.getEta()));
-            eta_resolution = mSmearer.getAbsEtaRes(pdgInfoThis->PdgCode(), dNdEta, recoTrack.getEta(), recoTrack.getP() / std::cosh(recoTrack.getEta()));
+            auto resolutions = mSmearer.getResolutions(pdgInfoThis->PdgCode(), dNdEta, recoTrack.getEta(), recoTrack.getP() / std::cosh(recoTrack.getEta()));
+            pt_resolution = resolutions.absPtRes;
+            eta_resolution = resolutions.absEtaRes;
           }
           float innerTrackTimeReso = calculate_track_time_resolution_advanced(recoTrack.getP() / std::cosh(recoTrack.getEta()), recoTrack.getEta(), pt_resolution, eta_resolution, masses[ii], innerTOFRadius, dBz);
           float outerTrackTimeReso = calculate_track_time_resolution_advanced(recoTrack.getP() / std::cosh(recoTrack.getEta()), recoTrack.getEta(), pt_resolution, eta_resolution, masses[ii], outerTOFRadius, dBz);
@@ -74,6 +74,8 @@ struct OnTheFlyTracker {
   Configurable<bool> enableNucleiSmearing{"enableNucleiSmearing", false, "Enable smearing of nuclei"};
   Configurable<bool> enablePrimaryVertexing{"enablePrimaryVertexing", true, "Enable primary vertexing"};
   Configurable<bool> interpolateLutEfficiencyVsNch{"interpolateLutEfficiencyVsNch", true, "interpolate LUT efficiency as f(Nch)"};
+  Configurable<bool> mapLUTs{"mapLUTs", false, "map the LUT files read-only (shared between processes) instead of reading them"};
+  Configurable<int> smearingSeed{"smearingSeed", -1, "seed of the per-particle random streams of the smearing (0: random seed), -1: smearing with gRandom"};
 
   Configurable<bool> populateTracksDCA{"populateTracksDCA", true, "populate TracksDCA table"};
   Configurable<bool> populateTracksExtra{"populateTracksExtra", false, "populate TracksExtra table (legacy)"};
@@ -135,8 +137,13 @@ struct OnTheFlyTracker {
   o2::steer::InteractionSampler irSampler;
   o2::vertexing::PVertexer vertexer;
 
+  // per-particle random streams, keyed by the number of the MC collision and the particle within it
+  uint64_t mSeed = 0;
+  uint64_t mNCollisions = 0;
+
   void init(o2::framework::InitContext&)
   {
+    mSeed = CounterRng::seedFromConfig(smearingSeed);
     if (enableLUT) {
       std::map<int, const char*> mapPdgLut;
       const char* lutElChar = lutEl->c_str();
@@ -165,6 +172,7 @@ struct OnTheFlyTracker {
         mapPdgLut.insert(std::make_pair(1000010030, lutTrChar));
         mapPdgLut.insert(std::make_pair(1000020030, lutHe3Char));
       }
+      mSmearer.useMemoryMapping(mapLUTs);
       for (auto e : mapPdgLut) {
         if (!mSmearer.loadTable(e.first, e.second)) {
           LOG(fatal) << "Having issue with loading the LUT " << e.first << " " << e.second;
@@ -304,7 +312,10 @@ struct OnTheFlyTracker {
     uint32_t multiplicityCounter = 0;
     histos.fill(HIST("hLUTMultiplicity"), dNdEta);
 
+    const uint64_t collisionKey = mNCollisions++;
+    uint64_t particleKey = 0;
     for (const auto& mcParticle : mcParticles) {
+      CounterRng rng(mSeed, collisionKey, particleKey++);
       if (!mcParticle.isPhysicalPrimary()) {
         continue;
       }
@@ -342,7 +353,7 @@ struct OnTheFlyTracker {
         histos.fill(HIST("hSimTrackX"), trackParCov.getX());
       }
 
-      bool reconstructed = mSmearer.smearTrack(trackParCov, mcParticle.pdgCode(), dNdEta);
+      bool reconstructed = smearingSeed >= 0 ? mSmearer.smearTrack(trackParCov, mcParticle.pdgCode(), dNdEta, rng) : mSmearer.smearTrack(trackParCov, mcParticle.pdgCode(), dNdEta);
       if (!reconstructed && !processUnreconstructedTracks) {
         continue;
       }
@@ -367,7 +378,7 @@ struct OnTheFlyTracker {
       }
 
       // populate vector with track if we reco-ed it
-      const float t = (ir.timeInBCNS + gRandom->Gaus(0., 100.)) * 1e-3;
+      const float t = (ir.timeInBCNS + (smearingSeed >= 0 ? rng.gaus(0., 100.) : gRandom->Gaus(0., 100.))) * 1e-3;
       if (reconstructed) {
         tracksAlice3.push_back(TrackAlice3{trackParCov, mcParticle.globalIndex(), t, 100.f * 1e-3, isDecayDaughter});
       } else {
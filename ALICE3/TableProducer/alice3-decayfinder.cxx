@@ -17,12 +17,14 @@
 //    HF decays. Work in progress: use at your own risk!
 //
 
+#include <algorithm>
 #include <cmath>
 #include <array>
 #include <cstdlib>
 #include <map>
 #include <iterator>
 #include <utility>
+#include <vector>
 
 #include "Framework/runDataProcessing.h"
 #include "Framework/RunningWorkflowInfo.h"
@@ -217,6 +219,7 @@ struct alice3decayFinder {
   Configurable<bool> doDCAplotsLc{"doDCAplotsLc", true, "do daughter prong DCA plots for Lc baryons"};
   Configurable<bool> mcSameMotherCheck{"mcSameMotherCheck", true, "check if tracks come from the same MC mother"};
   Configurable<float> dcaDaughtersSelection{"dcaDaughtersSelection", 1000.0f, "DCA between daughters (cm)"};
+  Configurable<float> massWindowPreselection{"massWindowPreselection", -1.0f, "margin (GeV/c^{2}) around the mass axis for the invariant mass of the prongs before the vertex fit, <0: off"};
 
   Configurable<float> piFromD_dcaXYconstant{"piFromD_dcaXYconstant", -1.0f, "[0] in |DCAxy| > [0]+[1]/pT"};
   Configurable<float> piFromD_dcaXYpTdep{"piFromD_dcaXYpTdep", 0.0, "[1] in |DCAxy| > [0]+[1]/pT"};
@@ -298,17 +301,44 @@ struct alice3decayFinder {
     float eta;
   } lcbaryon;
 
-  template <typename TTrackType>
-  bool buildDecayCandidateTwoBody(TTrackType const& posTrackRow, TTrackType const& negTrackRow, float posMass, float negMass)
+  // Daughter candidates of one species in a collision: track parameters and momenta computed once for all the combinations
+  struct DaughterPool {
+    std::vector<o2::track::TrackParCov> tracks;
+    std::vector<std::array<float, 3>> momenta;
+
+    template <typename TTracks>
+    void fill(TTracks const& rows)
+    {
+      tracks.clear();
+      momenta.clear();
+      for (auto const& row : rows) {
+        tracks.push_back(getTrackParCov(row));
+        std::array<float, 3> p;
+        tracks.back().getPxPyPzGlo(p);
+        momenta.push_back(p);
+      }
+    }
+  };
+  DaughterPool poolPos;
+  DaughterPool poolNeg;
+  DaughterPool poolThird;
+
+  // mass windows of the candidates before the vertex fit (mass axis of the candidates extended by massWindowPreselection)
+  float massMinD = 0.f, massMaxD = 0.f;
+  float massMinLc = 0.f, massMaxLc = 0.f;
+
+  bool passesMassPreselection(float mass, float massMin, float massMax)
   {
-    o2::track::TrackParCov posTrack = getTrackParCov(posTrackRow);
-    o2::track::TrackParCov negTrack = getTrackParCov(negTrackRow);
+    return massWindowPreselection < 0.f || (mass > massMin && mass < massMax);
+  }
 
+  bool buildDecayCandidateTwoBody(o2::track::TrackParCov const& posTrackIn, o2::track::TrackParCov const& negTrackIn, float posMass, float negMass)
+  {
     //}-{}-{}-{}-{}-{}-{}-{}-{}-{}
     // Move close to minima
     int nCand = 0;
     try {
-      nCand = fitter.process(posTrack, negTrack);
+      nCand = fitter.process(posTrackIn, negTrackIn);
     } catch (...) {
       return false;
     }
@@ -317,8 +347,8 @@ struct alice3decayFinder {
     }
     //}-{}-{}-{}-{}-{}-{}-{}-{}-{}
 
-    posTrack = fitter.getTrack(0);
-    negTrack = fitter.getTrack(1);
+    const auto& posTrack = fitter.getTrack(0);
+    const auto& negTrack = fitter.getTrack(1);
     std::array<float, 3> posP;
     std::array<float, 3> negP;
     posTrack.getPxPyPzGlo(posP);
@@ -335,18 +365,13 @@ struct alice3decayFinder {
     return true;
   }
 
-  template <typename TTrackType>
-  bool buildDecayCandidateThreeBody(TTrackType const& prong0, TTrackType const& prong1, TTrackType const& prong2, float p0mass, float p1mass, float p2mass)
+  bool buildDecayCandidateThreeBody(o2::track::TrackParCov const& prong0, o2::track::TrackParCov const& prong1, o2::track::TrackParCov const& prong2, float p0mass, float p1mass, float p2mass)
   {
-    o2::track::TrackParCov t0 = getTrackParCov(prong0);
-    o2::track::TrackParCov t1 = getTrackParCov(prong1);
-    o2::track::TrackParCov t2 = getTrackParCov(prong2);
-
     //}-{}-{}-{}-{}-{}-{}-{}-{}-{}
     // Move close to minima
     int nCand = 0;
     try {
-      nCand = fitter3.process(t0, t1, t2);
+      nCand = fitter3.process(prong0, prong1, prong2);
     } catch (...) {
       return false;
     }
@@ -355,9 +380,9 @@ struct alice3decayFinder {
     }
     //}-{}-{}-{}-{}-{}-{}-{}-{}-{}
 
-    t0 = fitter.getTrack(0);
-    t1 = fitter.getTrack(1);
-    t2 = fitter.getTrack(2);
+    const auto& t0 = fitter3.getTrack(0);
+    const auto& t1 = fitter3.getTrack(1);
+    const auto& t2 = fitter3.getTrack(2);
     std::array<float, 3> P0;
     std::array<float, 3> P1;
     std::array<float, 3> P2;
@@ -387,11 +412,12 @@ struct alice3decayFinder {
       auto mcParticle1 = track1.template mcParticle_as<aod::McParticles>();
       auto mcParticle2 = track2.template mcParticle_as<aod::McParticles>();
       if (mcParticle1.has_mothers() && mcParticle2.has_mothers()) {
-        for (auto& mcParticleMother1 : mcParticle1.template mothers_as<aod::McParticles>()) {
-          for (auto& mcParticleMother2 : mcParticle2.template mothers_as<aod::McParticles>()) {
-            if (mcParticleMother1.globalIndex() == mcParticleMother2.globalIndex()) {
-              returnValue = true;
-            }
+        // compare the mother indices, without iterating over the mother particles
+        const auto& motherIds2 = mcParticle2.mothersIds();
+        for (const auto& motherId1 : mcParticle1.mothersIds()) {
+          if (std::find(motherIds2.begin(), motherIds2.end(), motherId1) != motherIds2.end()) {
+            returnValue = true;
+            break;
           }
         }
       }
@@ -430,8 +456,10 @@ struct alice3decayFinder {
       histos.add("h3dRecD", "h2dRecD", kTH3F, {axisPt, axisEta, axisDMass});
       histos.add("h3dRecDbar", "h2dRecDbar", kTH3F, {axisPt, axisEta, axisDMass});
 
-      histos.add("hMassD", "hMassD", kTH1F, {axisDMass});
+      auto hMassD = histos.add<TH1>("hMassD", "hMassD", kTH1F, {axisDMass});
       histos.add("hMassDbar", "hMassDbar", kTH1F, {axisDMass});
+      massMinD = hMassD->GetXaxis()->GetXmin() - massWindowPreselection;
+      massMaxD = hMassD->GetXaxis()->GetXmax() + massWindowPreselection;
 
       if (doDCAplotsD) {
         histos.add("h2dDCAxyVsPtPiPlusFromD", "h2dDCAxyVsPtPiPlusFromD", kTH2F, {axisPt, axisDCA});
@@ -446,8 +474,10 @@ struct alice3decayFinder {
       histos.add("h3dRecLc", "h2dRecLc", kTH3F, {axisPt, axisEta, axisLcMass});
       histos.add("h3dRecLcbar", "h2dRecLcbar", kTH3F, {axisPt, axisEta, axisLcMass});
 
-      histos.add("hMassLc", "hMassLc", kTH1F, {axisLcMass});
+      auto hMassLc = histos.add<TH1>("hMassLc", "hMassLc", kTH1F, {axisLcMass});
       histos.add("hMassLcbar", "hMassLcbar", kTH1F, {axisLcMass});
+      massMinLc = hMassLc->GetXaxis()->GetXmin() - massWindowPreselection;
+      massMaxLc = hMassLc->GetXaxis()->GetXmax() + massWindowPreselection;
 
       if (doDCAplotsD) {
         histos.add("h2dDCAxyVsPtPiPlusFromLc", "h2dDCAxyVsPtPiPlusFromLc", kTH2F, {axisPt, axisDCA});
@@ -499,26 +529,42 @@ struct alice3decayFinder {
     }
 
     // D mesons
+    poolPos.fill(tracksPiPlusFromDgrouped);
+    poolNeg.fill(tracksKaMinusFromDgrouped);
+    std::size_t iPos = 0;
     for (auto const& posTrackRow : tracksPiPlusFromDgrouped) {
+      std::size_t iNeg = 0;
       for (auto const& negTrackRow : tracksKaMinusFromDgrouped) {
+        const std::size_t jNeg = iNeg++;
         if (mcSameMotherCheck && !checkSameMother(posTrackRow, negTrackRow))
           continue;
-        if (!buildDecayCandidateTwoBody(posTrackRow, negTrackRow, o2::constants::physics::MassPionCharged, o2::constants::physics::MassKaonCharged))
+        if (!passesMassPreselection(RecoDecay::m(array{poolPos.momenta[iPos], poolNeg.momenta[jNeg]}, array{o2::constants::physics::MassPionCharged, o2::constants::physics::MassKaonCharged}), massMinD, massMaxD))
+          continue;
+        if (!buildDecayCandidateTwoBody(poolPos.tracks[iPos], poolNeg.tracks[jNeg], o2::constants::physics::MassPionCharged, o2::constants::physics::MassKaonCharged))
           continue;
         histos.fill(HIST("hMassD"), dmeson.mass);
         histos.fill(HIST("h3dRecD"), dmeson.pt, dmeson.eta, dmeson.mass);
       }
+      iPos++;
     }
     // D mesons
+    poolPos.fill(tracksKaPlusFromDgrouped);
+    poolNeg.fill(tracksPiMinusFromDgrouped);
+    std::size_t iPos = 0;
     for (auto const& posTrackRow : tracksKaPlusFromDgrouped) {
+      std::size_t iNeg = 0;
       for (auto const& negTrackRow : tracksPiMinusFromDgrouped) {
+        const std::size_t jNeg = iNeg++;
         if (mcSameMotherCheck && !checkSameMother(posTrackRow, negTrackRow))
           continue;
-        if (!buildDecayCandidateTwoBody(posTrackRow, negTrackRow, o2::constants::physics::MassKaonCharged, o2::constants::physics::MassPionCharged))
+        if (!passesMassPreselection(RecoDecay::m(array{poolPos.momenta[iPos], poolNeg.momenta[jNeg]}, array{o2::constants::physics::MassKaonCharged, o2::constants::physics::MassPionCharged}), massMinD, massMaxD))
+          continue;
+        if (!buildDecayCandidateTwoBody(poolPos.tracks[iPos], poolNeg.tracks[jNeg], o2::constants::physics::MassKaonCharged, o2::constants::physics::MassPionCharged))
           continue;
         histos.fill(HIST("hMassDbar"), dmeson.mass);
         histos.fill(HIST("h3dRecDbar"), dmeson.pt, dmeson.eta, dmeson.mass);
       }
+      iPos++;
     }
   }
   //*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*
@@ -551,14 +597,27 @@ struct alice3decayFinder {
     }
 
     // Lc+ baryons +4122 -> +2212 -321 +211
+    poolPos.fill(tracksPrPlusFromLcgrouped);
+    poolNeg.fill(tracksKaMinusFromLcgrouped);
+    poolThird.fill(tracksPiPlusFromLcgrouped);
+    std::size_t iProton = 0;
     for (auto const& proton : tracksPrPlusFromLcgrouped) {
+      const std::size_t jProton = iProton++;
+      std::size_t iPion = 0;
       for (auto const& pion : tracksPiPlusFromLcgrouped) {
+        const std::size_t jPion = iPion++;
         if (pion.globalIndex() == proton.globalIndex())
           continue; // avoid self
+        if (mcSameMotherCheck && !checkSameMother(proton, pion))
+          continue;
+        std::size_t iKaon = 0;
         for (auto const& kaon : tracksKaMinusFromLcgrouped) {
-          if (mcSameMotherCheck && (!checkSameMother(proton, kaon) || !checkSameMother(proton, pion)))
+          const std::size_t jKaon = iKaon++;
+          if (mcSameMotherCheck && !checkSameMother(proton, kaon))
+            continue;
+          if (!passesMassPreselection(RecoDecay::m(array{poolPos.momenta[jProton], poolNeg.momenta[jKaon], poolThird.momenta[jPion]}, array{o2::constants::physics::MassProton, o2::constants::physics::MassKaonCharged, o2::constants::physics::MassPionCharged}), massMinLc, massMaxLc))
             continue;
-          if (!buildDecayCandidateThreeBody(proton, kaon, pion, o2::constants::physics::MassProton, o2::constants::physics::MassKaonCharged, o2::constants::physics::MassPionCharged))
+          if (!buildDecayCandidateThreeBody(poolPos.tracks[jProton], poolNeg.tracks[jKaon], poolThird.tracks[jPion], o2::constants::physics::MassProton, o2::constants::physics::MassKaonCharged, o2::constants::physics::MassPionCharged))
             continue;
           histos.fill(HIST("hMassLc"), lcbaryon.mass);
           histos.fill(HIST("h3dRecLc"), lcbaryon.pt, lcbaryon.eta, lcbaryon.mass);
@@ -566,14 +625,27 @@ struct alice3decayFinder {
       }
     }
     // Lc- baryons -4122 -> -2212 +321 -211
+    poolPos.fill(tracksPrMinusFromLcgrouped);
+    poolNeg.fill(tracksKaPlusFromLcgrouped);
+    poolThird.fill(tracksPiMinusFromLcgrouped);
+    std::size_t iProton = 0;
     for (auto const& proton : tracksPrMinusFromLcgrouped) {
+      const std::size_t jProton = iProton++;
+      std::size_t iPion = 0;
       for (auto const& pion : tracksPiMinusFromLcgrouped) {
+        const std::size_t jPion = iPion++;
         if (pion.globalIndex() == proton.globalIndex())
           continue; // avoid self
+        if (mcSameMotherCheck && !checkSameMother(proton, pion))
+          continue;
+        std::size_t iKaon = 0;
         for (auto const& kaon : tracksKaPlusFromLcgrouped) {
-          if (mcSameMotherCheck && (!checkSameMother(proton, kaon) || !checkSameMother(proton, pion)))
+          const std::size_t jKaon = iKaon++;
+          if (mcSameMotherCheck && !checkSameMother(proton, kaon))
+            continue;
+          if (!passesMassPreselection(RecoDecay::m(array{poolPos.momenta[jProton], poolNeg.momenta[jKaon], poolThird.momenta[jPion]}, array{o2::constants::physics::MassProton, o2::constants::physics::MassKaonCharged, o2::constants::physics::MassPionCharged}), massMinLc, massMaxLc))
             continue;
-          if (!buildDecayCandidateThreeBody(proton, kaon, pion, o2::constants::physics::MassProton, o2::constants::physics::MassKaonCharged, o2::constants::physics::MassPionCharged))
+          if (!buildDecayCandidateThreeBody(poolPos.tracks[jProton], poolNeg.tracks[jKaon], poolThird.tracks[jPion], o2::constants::physics::MassProton, o2::constants::physics::MassKaonCharged, o2::constants::physics::MassPionCharged))
             continue;
           histos.fill(HIST("hMassLcbar"), lcbaryon.mass);
           histos.fill(HIST("h3dRecLcbar"), lcbaryon.pt, lcbaryon.eta, lcbaryon.mass);
@@ -0,0 +1,127 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "CCDBObjectCache.h"
+
+#include <chrono>
+#include <limits>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace o2
+{
+CCDBObjectCache& CCDBObjectCache::instance()
+{
+  static CCDBObjectCache cache;
+  return cache;
+}
+
+bool CCDBObjectCache::prefetch(o2::ccdb::BasicCCDBManager* ccdb, int runNumber, int64_t timestamp)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (runNumber == mRunNumber) {
+    return false;
+  }
+  mRunNumber = runNumber;
+  std::vector<Object> staged;
+  if (mStaged.valid() && mStagedRunNumber == runNumber) {
+    staged = mStaged.get();
+    mStagedRunNumber = -1;
+  }
+  for (std::size_t i = 0; i < mEntries.size(); i++) {
+    auto& entry = mEntries[i];
+    if (i < staged.size()) {
+      entry.current = std::move(staged[i]);
+      continue;
+    }
+    if (entry.current.runScoped) {
+      entry.current.object.reset();
+    }
+    load(ccdb, entry, timestamp);
+  }
+  LOGP(info, "Prefetched {} CCDB objects for run {} ({} fetched in the background)", mEntries.size(), runNumber, staged.size());
+  return true;
+}
+
+bool CCDBObjectCache::prefetchAsync(o2::ccdb::BasicCCDBManager* ccdb, int runNumber, int64_t timestamp)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (runNumber == mRunNumber || runNumber == mStagedRunNumber) {
+    return false;
+  }
+  if (mStaged.valid() && mStaged.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+    return false;
+  }
+  if (!mAsyncApi) {
+    mAsyncApi = std::make_unique<o2::ccdb::CcdbApi>();
+    mAsyncApi->init(ccdb->getURL());
+  }
+  // the thread works on a copy of the declarations, later declarations are loaded synchronously
+  std::vector<std::pair<std::string, Fetcher>> fetchers;
+  fetchers.reserve(mEntries.size());
+  for (auto const& entry : mEntries) {
+    fetchers.emplace_back(entry.path, entry.fetch);
+  }
+  mStagedRunNumber = runNumber;
+  mStaged = std::async(std::launch::async, [fetchers = std::move(fetchers), api = mAsyncApi.get(), timestamp]() {
+    std::vector<Object> objects;
+    objects.reserve(fetchers.size());
+    for (auto const& [path, fetch] : fetchers) {
+      objects.push_back(fetchObject(path, fetch, *api, timestamp));
+    }
+    return objects;
+  });
+  LOGP(info, "Fetching {} CCDB objects for run {} in the background", fetchers.size(), runNumber);
+  return true;
+}
+
+void CCDBObjectCache::clear()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mStaged.valid()) {
+    mStaged.wait();
+    mStaged = {};
+  }
+  mStagedRunNumber = -1;
+  for (auto& entry : mEntries) {
+    entry.current.object.reset();
+  }
+  mRunNumber = -1;
+}
+
+CCDBObjectCache::Object CCDBObjectCache::fetchObject(std::string const& path, Fetcher const& fetch, o2::ccdb::CcdbApi const& api, int64_t timestamp)
+{
+  Object result;
+  std::map<std::string, std::string> headers;
+  result.object = fetch(api, timestamp, &headers);
+  if (!result.object) {
+    LOGP(fatal, "Could not retrieve {} from CCDB for timestamp {}", path, timestamp);
+  }
+  auto validFrom = headers.find("Valid-From");
+  auto validUntil = headers.find("Valid-Until");
+  result.runScoped = validFrom == headers.end() || validUntil == headers.end();
+  result.validFrom = result.runScoped ? std::numeric_limits<int64_t>::min() : std::stoll(validFrom->second);
+  result.validUntil = result.runScoped ? std::numeric_limits<int64_t>::max() : std::stoll(validUntil->second);
+  LOGP(debug, "Loaded {} valid in [{}, {})", path, result.validFrom, result.validUntil);
+  return result;
+}
+
+void CCDBObjectCache::load(o2::ccdb::BasicCCDBManager* ccdb, Entry& entry, int64_t timestamp)
+{
+  // another task may have refreshed the entry while we were waiting for the lock
+  if (entry.current.covers(timestamp)) {
+    return;
+  }
+  entry.current = fetchObject(entry.path, entry.fetch, ccdb->getCCDBAccessor(), timestamp);
+}
+} // namespace o2
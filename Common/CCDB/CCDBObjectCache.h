@@ -0,0 +1,156 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file CCDBObjectCache.h
+/// \brief Process-wide cache of the CCDB objects used by the analysis table producers
+///
+/// The objects are declared once by path and type, fetched for all declarations at the first BC of a run and
+/// kept together with their validity interval. The cache owns the objects, so the references handed out stay
+/// valid until the next run is prefetched, and tasks sharing a process never download the same object twice.
+/// When a dataframe already contains BCs of the next run, the objects of that run are fetched in a background
+/// thread and swapped in at the run boundary.
+
+#ifndef COMMON_CCDB_CCDBOBJECTCACHE_H_
+#define COMMON_CCDB_CCDBOBJECTCACHE_H_
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+#include "CCDB/BasicCCDBManager.h"
+#include "CCDB/CcdbApi.h"
+#include "Framework/Logger.h"
+
+namespace o2
+{
+
+class CCDBObjectCache
+{
+ public:
+  using Handle = std::size_t;
+
+  /// the cache shared by all tasks of the process
+  static CCDBObjectCache& instance();
+
+  /// Registers an object to be fetched at every run boundary, declaring the same path twice returns the same handle.
+  /// Declarations are expected in the init of the tasks, before the first prefetch.
+  template <typename T>
+  Handle declare(std::string const& path)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto found = mHandles.find(path);
+    if (found != mHandles.end()) {
+      if (mEntries[found->second].type != typeid(T).name()) {
+        LOGP(fatal, "CCDB object {} declared with two different types ({} and {})", path, mEntries[found->second].type, typeid(T).name());
+      }
+      return found->second;
+    }
+    Entry entry;
+    entry.path = path;
+    entry.type = typeid(T).name();
+    entry.fetch = [path](o2::ccdb::CcdbApi const& api, int64_t timestamp, std::map<std::string, std::string>* headers) -> std::shared_ptr<const void> {
+      std::map<std::string, std::string> metadata;
+      return std::shared_ptr<const T>(api.retrieveFromTFileAny<T>(path, metadata, timestamp, headers));
+    };
+    mEntries.push_back(std::move(entry));
+    mHandles.emplace(path, mEntries.size() - 1);
+    return mEntries.size() - 1;
+  }
+
+  /// Fetches all declared objects for the run of the given timestamp, does nothing if the run is already loaded
+  /// \return true if the objects were (re)loaded
+  bool prefetch(o2::ccdb::BasicCCDBManager* ccdb, int runNumber, int64_t timestamp);
+
+  /// Starts fetching the objects of another run in a background thread, they are used by the prefetch of that run
+  /// \return false if the run is already loaded or a background fetch is still pending
+  bool prefetchAsync(o2::ccdb::BasicCCDBManager* ccdb, int runNumber, int64_t timestamp);
+
+  /// Starts the background fetch if the dataframe ends in a run other than the loaded one
+  template <typename TBCs>
+  void lookAhead(o2::ccdb::BasicCCDBManager* ccdb, TBCs const& bcs)
+  {
+    if (bcs.size() == 0) {
+      return;
+    }
+    auto lastBC = bcs.iteratorAt(bcs.size() - 1);
+    if (lastBC.runNumber() != mRunNumber) {
+      prefetchAsync(ccdb, lastBC.runNumber(), lastBC.timestamp());
+    }
+  }
+
+  /// Object valid at the timestamp, refetched only when the timestamp leaves the validity interval of the cached one
+  template <typename T>
+  T const& get(o2::ccdb::BasicCCDBManager* ccdb, Handle handle, int64_t timestamp)
+  {
+    Entry& entry = mEntries[handle];
+    if (!entry.current.covers(timestamp)) {
+      std::lock_guard<std::mutex> lock(mMutex);
+      load(ccdb, entry, timestamp);
+    }
+    return *static_cast<const T*>(entry.current.object.get());
+  }
+
+  template <typename T>
+  T const& get(o2::ccdb::BasicCCDBManager* ccdb, std::string const& path, int64_t timestamp)
+  {
+    return get<T>(ccdb, declare<T>(path), timestamp);
+  }
+
+  int getRunNumber() const { return mRunNumber; }
+
+  /// releases all cached objects, the declarations are kept
+  void clear();
+
+ private:
+  CCDBObjectCache() = default;
+
+  using Fetcher = std::function<std::shared_ptr<const void>(o2::ccdb::CcdbApi const&, int64_t, std::map<std::string, std::string>*)>;
+
+  struct Object {
+    std::shared_ptr<const void> object;
+    int64_t validFrom = 0;
+    int64_t validUntil = 0;
+    bool runScoped = false; // no validity in the headers, the object is kept for the current run only
+
+    bool covers(int64_t timestamp) const { return object && timestamp >= validFrom && timestamp < validUntil; }
+  };
+
+  struct Entry {
+    std::string path;
+    std::string type;
+    Fetcher fetch;
+    Object current;
+  };
+
+  static Object fetchObject(std::string const& path, Fetcher const& fetch, o2::ccdb::CcdbApi const& api, int64_t timestamp);
+  void load(o2::ccdb::BasicCCDBManager* ccdb, Entry& entry, int64_t timestamp);
+
+  std::vector<Entry> mEntries;
+  std::unordered_map<std::string, Handle> mHandles;
+  int mRunNumber = -1;
+  std::mutex mMutex;
+
+  // background fetch of the next run, with its own API instance to stay independent of the manager
+  std::unique_ptr<o2::ccdb::CcdbApi> mAsyncApi;
+  int mStagedRunNumber = -1;
+  std::future<std::vector<Object>> mStaged;
+};
+
+} // namespace o2
+
+#endif // COMMON_CCDB_CCDBOBJECTCACHE_H_
@@ -11,6 +11,8 @@
 
 #include "ctpRateFetcher.h"
 
+#include <algorithm>
+#include <cmath>
 #include <map>
 #include <vector>
 
@@ -25,63 +27,115 @@ namespace o2
 double ctpRateFetcher::fetch(o2::ccdb::BasicCCDBManager* ccdb, uint64_t timeStamp, int runNumber, std::string sourceName)
 {
   setupRun(runNumber, ccdb, timeStamp);
+  return lookupRate(getRateTable(sourceName), timeStamp);
+}
+
+const ctpRateFetcher::RateTable& ctpRateFetcher::getRateTable(const std::string& sourceName)
+{
+  auto table = mRateTables.find(sourceName);
+  if (table == mRateTables.end()) {
+    table = mRateTables.emplace(sourceName, buildRateTable(sourceName)).first;
+  }
+  return table->second;
+}
+
+ctpRateFetcher::RateTable ctpRateFetcher::buildRateTable(const std::string& sourceName)
+{
   if (sourceName.find("ZNC") != std::string::npos) {
-    if (runNumber < 544448) {
-      return fetchCTPratesInputs(ccdb, timeStamp, runNumber, 25) / (sourceName.find("hadronic") != std::string::npos ? 28. : 1.);
+    double scale = sourceName.find("hadronic") != std::string::npos ? 1. / 28. : 1.;
+    if (mRunNumber < 544448) {
+      return buildInputRateTable(25, scale);
     } else {
-      return fetchCTPratesClasses(ccdb, timeStamp, runNumber, "C1ZNC-B-NOPF-CRU", 6) / (sourceName.find("hadronic") != std::string::npos ? 28. : 1.);
+      return buildClassRateTable("C1ZNC-B-NOPF-CRU", 6, scale);
     }
   } else if (sourceName == "T0CE") {
-    return fetchCTPratesClasses(ccdb, timeStamp, runNumber, "CMTVXTCE-B-NOPF");
+    return buildClassRateTable("CMTVXTCE-B-NOPF");
   } else if (sourceName == "T0SC") {
-    return fetchCTPratesClasses(ccdb, timeStamp, runNumber, "CMTVXTSC-B-NOPF");
+    return buildClassRateTable("CMTVXTSC-B-NOPF");
   } else if (sourceName == "T0VTX") {
-    if (runNumber < 534202) {
-      return fetchCTPratesClasses(ccdb, timeStamp, runNumber, "minbias_TVX_L0", 3); // 2022
+    if (mRunNumber < 534202) {
+      return buildClassRateTable("minbias_TVX_L0", 3); // 2022
     } else {
-      double_t ret = fetchCTPratesClasses(ccdb, timeStamp, runNumber, "CMTVX-B-NOPF");
-      if (ret < 0.) {
+      RateTable table = buildClassRateTable("CMTVX-B-NOPF");
+      if (!table.valid) {
         LOG(info) << "Trying different class";
-        ret = fetchCTPratesClasses(ccdb, timeStamp, runNumber, "CMTVX-NONE");
-        if (ret < 0) {
+        table = buildClassRateTable("CMTVX-NONE");
+        if (!table.valid) {
           LOG(fatal) << "None of the classes used for lumi found";
         }
       }
-      return ret;
+      return table;
     }
   }
   LOG(error) << "CTP rate for " << sourceName << " not available";
-  return -1.;
+  return RateTable{};
 }
 
-double ctpRateFetcher::fetchCTPratesClasses(o2::ccdb::BasicCCDBManager* /*ccdb*/, uint64_t timeStamp, int /*runNumber*/, const std::string& className, int inputType)
+ctpRateFetcher::RateTable ctpRateFetcher::buildClassRateTable(const std::string& className, int inputType, double scale)
 {
+  RateTable table;
   std::vector<ctp::CTPClass> ctpcls = mConfig->getCTPClasses();
   std::vector<int> clslist = mConfig->getTriggerClassList();
-  int classIndex = -1;
   for (size_t i = 0; i < clslist.size(); i++) {
     if (ctpcls[i].name.find(className) != std::string::npos) {
-      classIndex = i;
+      table.index = i;
       break;
     }
   }
-  if (classIndex == -1) {
+  if (table.index == -1) {
     LOG(warn) << "Trigger class " << className << " not found in CTPConfiguration";
-    return -1.;
+    return table;
   }
-  auto rate{mScalers->getRateGivenT(timeStamp * 1.e-3, classIndex, inputType)};
-  return pileUpCorrection(rate.second);
+  table.valid = true;
+  table.inputType = inputType;
+  table.scale = scale;
+  fillRateTable(table);
+  return table;
 }
 
-double ctpRateFetcher::fetchCTPratesInputs(o2::ccdb::BasicCCDBManager* /*ccdb*/, uint64_t timeStamp, int /*runNumber*/, int input)
+ctpRateFetcher::RateTable ctpRateFetcher::buildInputRateTable(int input, double scale)
 {
-  std::vector<ctp::CTPScalerRecordO2> recs = mScalers->getScalerRecordO2();
-  if (recs[0].scalersInps.size() == 48) {
-    return pileUpCorrection(mScalers->getRateGivenT(timeStamp * 1.e-3, input, 7).second);
-  } else {
+  RateTable table;
+  if (mScalers->getScalerRecordO2()[0].scalersInps.size() != 48) {
     LOG(error) << "Inputs not available";
+    return table;
+  }
+  table.valid = true;
+  table.isInput = true;
+  table.index = input;
+  table.inputType = 7;
+  table.scale = scale;
+  fillRateTable(table);
+  return table;
+}
+
+void ctpRateFetcher::fillRateTable(RateTable& table)
+{
+  // the scaler rates are constant between two records, so one evaluation per interval gives the whole run
+  const auto& recs = mScalers->getScalerRecordO2();
+  table.times.resize(recs.size());
+  table.rates.resize(recs.size() > 0 ? recs.size() - 1 : 0);
+  for (size_t i = 0; i < recs.size(); i++) {
+    table.times[i] = recs[i].epochTime;
+  }
+  for (size_t i = 0; i < table.rates.size(); i++) {
+    double midTime = 0.5 * (table.times[i] + table.times[i + 1]);
+    table.rates[i] = pileUpCorrection(mScalers->getRateGivenT(midTime, table.index, table.inputType).second) * table.scale;
+  }
+}
+
+double ctpRateFetcher::lookupRate(const RateTable& table, uint64_t timeStamp)
+{
+  if (!table.valid) {
     return -1.;
   }
+  double time = timeStamp * 1.e-3;
+  auto next = std::upper_bound(table.times.begin(), table.times.end(), time);
+  if (next == table.times.begin() || next == table.times.end()) {
+    // outside of the scaler records, let the scalers decide
+    return pileUpCorrection(mScalers->getRateGivenT(time, table.index, table.inputType).second) * table.scale;
+  }
+  return table.rates[next - table.times.begin() - 1];
 }
 
 double ctpRateFetcher::pileUpCorrection(double triggerRate)
@@ -89,12 +143,9 @@ double ctpRateFetcher::pileUpCorrection(double triggerRate)
   if (mLHCIFdata == nullptr) {
     LOG(fatal) << "No filling" << std::endl;
   }
-  auto bfilling = mLHCIFdata->getBunchFilling();
-  std::vector<int> bcs = bfilling.getFilledBCs();
-  double nbc = bcs.size();
-  double nTriggersPerFilledBC = triggerRate / nbc / constants::lhc::LHCRevFreq;
+  double nTriggersPerFilledBC = triggerRate / mNFilledBCs / constants::lhc::LHCRevFreq;
   double mu = -std::log(1 - nTriggersPerFilledBC);
-  return mu * nbc * constants::lhc::LHCRevFreq;
+  return mu * mNFilledBCs * constants::lhc::LHCRevFreq;
 }
 
 void ctpRateFetcher::setupRun(int runNumber, o2::ccdb::BasicCCDBManager* ccdb, uint64_t timeStamp)
@@ -124,6 +175,8 @@ void ctpRateFetcher::setupRun(int runNumber, o2::ccdb::BasicCCDBManager* ccdb, u
     LOG(fatal) << "CTPRunScalers not in database, timestamp:" << timeStamp;
   }
   mScalers->convertRawToO2();
+  mNFilledBCs = mLHCIFdata->getBunchFilling().getFilledBCs().size();
+  mRateTables.clear();
 }
 
 } // namespace o2
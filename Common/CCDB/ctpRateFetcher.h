@@ -12,7 +12,9 @@
 #ifndef COMMON_CCDB_CTPRATEFETCHER_H_
 #define COMMON_CCDB_CTPRATEFETCHER_H_
 
+#include <map>
 #include <string>
+#include <vector>
 
 #include "CCDB/BasicCCDBManager.h"
 
@@ -36,12 +38,43 @@ class ctpRateFetcher
   ctpRateFetcher() = default;
   double fetch(o2::ccdb::BasicCCDBManager* ccdb, uint64_t timeStamp, int runNumber, std::string sourceName);
 
+  /// Fills the rates for all BCs of a table, in the same order
+  template <typename TBCs>
+  void fetch(o2::ccdb::BasicCCDBManager* ccdb, TBCs const& bcs, const std::string& sourceName, std::vector<double>& rates)
+  {
+    rates.resize(bcs.size());
+    const RateTable* table = nullptr;
+    std::size_t iBC = 0;
+    for (const auto& bc : bcs) {
+      if (table == nullptr || bc.runNumber() != mRunNumber) {
+        setupRun(bc.runNumber(), ccdb, bc.timestamp());
+        table = &getRateTable(sourceName);
+      }
+      rates[iBC++] = lookupRate(*table, bc.timestamp());
+    }
+  }
+
   void setManualCleanup(bool manualCleanup = true) { mManualCleanup = manualCleanup; }
 
  private:
-  double fetchCTPratesInputs(o2::ccdb::BasicCCDBManager* ccdb, uint64_t timeStamp, int runNumber, int input);
-  double fetchCTPratesClasses(o2::ccdb::BasicCCDBManager* ccdb, uint64_t timeStamp, int runNumber, const std::string& className, int inputType = 1);
   double pileUpCorrection(double rate);
+
+  // rates of one source for all scaler record intervals of the run, pile-up corrected and scaled
+  struct RateTable {
+    bool valid = false;
+    bool isInput = false; // CTP input or class
+    int index = -1;       // input number or class index
+    int inputType = 1;
+    double scale = 1.;
+    std::vector<double> times; // record times (s), rates[i] is the rate in [times[i], times[i + 1])
+    std::vector<double> rates;
+  };
+  const RateTable& getRateTable(const std::string& sourceName);
+  RateTable buildRateTable(const std::string& sourceName);
+  RateTable buildClassRateTable(const std::string& className, int inputType = 1, double scale = 1.);
+  RateTable buildInputRateTable(int input, double scale = 1.);
+  void fillRateTable(RateTable& table);
+  double lookupRate(const RateTable& table, uint64_t timeStamp);
   void setupRun(int runNumber, o2::ccdb::BasicCCDBManager* ccdb, uint64_t timeStamp);
 
   bool mManualCleanup = false;
@@ -49,6 +82,8 @@ class ctpRateFetcher
   ctp::CTPConfiguration* mConfig = nullptr;
   ctp::CTPRunScalers* mScalers = nullptr;
   parameters::GRPLHCIFData* mLHCIFdata = nullptr;
+  double mNFilledBCs = 0.;
+  std::map<std::string, RateTable> mRateTables; // per source name, rebuilt at each run
 };
 } // namespace o2
 
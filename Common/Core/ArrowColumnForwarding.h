@@ -0,0 +1,100 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   ArrowColumnForwarding.h
+/// \brief  Helpers for the table converters which build the new table version directly on the Arrow level,
+///         forwarding the unchanged columns of the old version instead of copying them row by row
+///
+
+#ifndef COMMON_CORE_ARROWCOLUMNFORWARDING_H_
+#define COMMON_CORE_ARROWCOLUMNFORWARDING_H_
+
+#include <arrow/array.h>
+#include <arrow/buffer.h>
+#include <arrow/chunked_array.h>
+#include <arrow/memory_pool.h>
+#include <arrow/table.h>
+#include <arrow/type_traits.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Framework/ASoA.h"
+#include "Framework/Logger.h"
+
+namespace o2::common::converters
+{
+
+/// Derived columns of the output table, by column name (e.g. "fITSClusterSizes")
+using DerivedColumns = std::map<std::string, std::shared_ptr<arrow::ChunkedArray>>;
+
+/// Computes a derived column from one input column, chunk by chunk.
+/// The values are written into a preallocated buffer by a plain loop over the raw input values
+/// (auto-vectorisable for a simple f), the nulls of the input are not propagated (AO2D columns have none).
+template <typename TOut, typename TIn, typename F>
+std::shared_ptr<arrow::ChunkedArray> deriveColumn(std::shared_ptr<arrow::ChunkedArray> const& input, F&& f)
+{
+  using InArray = arrow::NumericArray<typename arrow::CTypeTraits<TIn>::ArrowType>;
+  using OutArray = arrow::NumericArray<typename arrow::CTypeTraits<TOut>::ArrowType>;
+  std::vector<std::shared_ptr<arrow::Array>> chunks;
+  chunks.reserve(input->num_chunks());
+  for (int iChunk = 0; iChunk < input->num_chunks(); iChunk++) {
+    auto in = std::static_pointer_cast<InArray>(input->chunk(iChunk));
+    const int64_t n = in->length();
+    auto buffer = arrow::AllocateBuffer(n * sizeof(TOut));
+    if (!buffer.ok()) {
+      LOGF(fatal, "Cannot allocate %d bytes for a derived column: %s", n * sizeof(TOut), buffer.status().ToString());
+    }
+    std::shared_ptr<arrow::Buffer> data{std::move(buffer).ValueOrDie()};
+    const TIn* __restrict inValues = in->raw_values();
+    TOut* __restrict outValues = reinterpret_cast<TOut*>(data->mutable_data());
+    for (int64_t i = 0; i < n; i++) {
+      outValues[i] = f(inValues[i]);
+    }
+    chunks.push_back(std::make_shared<OutArray>(n, data));
+  }
+  return std::make_shared<arrow::ChunkedArray>(chunks, arrow::CTypeTraits<TOut>::type_singleton());
+}
+
+/// Output table with the schema of the persistent columns of T.
+/// A column given in derived is taken from there, otherwise the input column with the same name is
+/// forwarded by reference (no copy of the data); a missing column or a type mismatch is fatal.
+template <typename T>
+std::shared_ptr<arrow::Table> forwardColumns(std::shared_ptr<arrow::Table> const& input, DerivedColumns const& derived)
+{
+  auto schema = o2::soa::createSchemaFromColumns(typename T::persistent_columns_t{});
+  std::vector<std::shared_ptr<arrow::ChunkedArray>> columns;
+  columns.reserve(schema->num_fields());
+  for (const auto& field : schema->fields()) {
+    auto column = derived.find(field->name());
+    std::shared_ptr<arrow::ChunkedArray> data = column != derived.end() ? column->second : input->GetColumnByName(field->name());
+    if (!data) {
+      LOGF(fatal, "Column %s of the output table is neither in the input table nor derived", field->name());
+    }
+    if (!data->type()->Equals(field->type())) {
+      LOGF(fatal, "Column %s has type %s, %s expected in the output table", field->name(), data->type()->ToString(), field->type()->ToString());
+    }
+    if (data->length() != input->num_rows()) {
+      LOGF(fatal, "Column %s has %d rows, the input table %d", field->name(), data->length(), input->num_rows());
+    }
+    columns.push_back(data);
+  }
+  return arrow::Table::Make(schema, columns, input->num_rows());
+}
+
+} // namespace o2::common::converters
+
+#endif // COMMON_CORE_ARROWCOLUMNFORWARDING_H_
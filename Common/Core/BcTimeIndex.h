@@ -0,0 +1,141 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   BcTimeIndex.h
+/// \brief  Sorted flat index from global BC to table row, for the per-timeframe BC lookups
+///         (exact match, closest BC, BC windows) of the table producers
+///
+
+#ifndef COMMON_CORE_BCTIMEINDEX_H_
+#define COMMON_CORE_BCTIMEINDEX_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+/// Global BCs and row indices (e.g. of the BCs with a given trigger) kept as sorted arrays,
+/// searched by binary search instead of walking a std::map.
+///
+/// Usage: clear(), add() the entries (usually in increasing BC order, as in the BC table), then build().
+/// If a global BC is added several times, the last entry is kept (as with std::map::operator[]).
+/// The object can be kept as a data member and refilled for each timeframe to reuse its memory.
+class BcTimeIndex
+{
+ public:
+  void clear()
+  {
+    mGlobalBCs.clear();
+    mIndices.clear();
+    mIsSorted = true;
+  }
+
+  void reserve(std::size_t n)
+  {
+    mGlobalBCs.reserve(n);
+    mIndices.reserve(n);
+  }
+
+  void add(int64_t globalBC, int32_t index)
+  {
+    if (!mGlobalBCs.empty() && globalBC < mGlobalBCs.back()) {
+      mIsSorted = false;
+    }
+    mGlobalBCs.push_back(globalBC);
+    mIndices.push_back(index);
+  }
+
+  /// Sorts the entries by global BC if needed and removes duplicated BCs, keeping the last entry
+  void build()
+  {
+    if (!mIsSorted) {
+      std::vector<std::size_t> order(mGlobalBCs.size());
+      std::iota(order.begin(), order.end(), 0);
+      std::stable_sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b) { return mGlobalBCs[a] < mGlobalBCs[b]; });
+      std::vector<int64_t> globalBCs(order.size());
+      std::vector<int32_t> indices(order.size());
+      for (std::size_t i = 0; i < order.size(); i++) {
+        globalBCs[i] = mGlobalBCs[order[i]];
+        indices[i] = mIndices[order[i]];
+      }
+      mGlobalBCs.swap(globalBCs);
+      mIndices.swap(indices);
+      mIsSorted = true;
+    }
+    std::size_t nUnique = 0;
+    for (std::size_t i = 0; i < mGlobalBCs.size(); i++) {
+      if (nUnique > 0 && mGlobalBCs[nUnique - 1] == mGlobalBCs[i]) {
+        mIndices[nUnique - 1] = mIndices[i];
+        continue;
+      }
+      mGlobalBCs[nUnique] = mGlobalBCs[i];
+      mIndices[nUnique] = mIndices[i];
+      nUnique++;
+    }
+    mGlobalBCs.resize(nUnique);
+    mIndices.resize(nUnique);
+  }
+
+  std::size_t size() const { return mGlobalBCs.size(); }
+  bool empty() const { return mGlobalBCs.empty(); }
+  int64_t globalBC(std::size_t pos) const { return mGlobalBCs[pos]; }
+  int32_t index(std::size_t pos) const { return mIndices[pos]; }
+
+  /// Index of the entry with the given global BC, -1 if not found
+  int32_t find(int64_t globalBC) const
+  {
+    auto it = std::lower_bound(mGlobalBCs.begin(), mGlobalBCs.end(), globalBC);
+    if (it == mGlobalBCs.end() || *it != globalBC) {
+      return -1;
+    }
+    return mIndices[it - mGlobalBCs.begin()];
+  }
+
+  /// Position of the entry with the closest global BC (the later one if equidistant), size() if empty
+  std::size_t closestPos(int64_t globalBC) const
+  {
+    std::size_t pos = std::lower_bound(mGlobalBCs.begin(), mGlobalBCs.end(), globalBC) - mGlobalBCs.begin();
+    if (pos == mGlobalBCs.size()) {
+      return mGlobalBCs.empty() ? pos : pos - 1;
+    }
+    if (pos > 0 && globalBC - mGlobalBCs[pos - 1] < mGlobalBCs[pos] - globalBC) {
+      pos--;
+    }
+    return pos;
+  }
+
+  /// Index of the entry with the closest global BC (the later one if equidistant), -1 if empty
+  int32_t findClosest(int64_t globalBC) const
+  {
+    if (mGlobalBCs.empty()) {
+      return -1;
+    }
+    return mIndices[closestPos(globalBC)];
+  }
+
+  /// Range of positions [first, last) of the entries with global BC in [minBC, maxBC]
+  std::pair<std::size_t, std::size_t> range(int64_t minBC, int64_t maxBC) const
+  {
+    std::size_t first = std::lower_bound(mGlobalBCs.begin(), mGlobalBCs.end(), minBC) - mGlobalBCs.begin();
+    std::size_t last = std::upper_bound(mGlobalBCs.begin() + first, mGlobalBCs.end(), maxBC) - mGlobalBCs.begin();
+    return {first, last};
+  }
+
+ private:
+  std::vector<int64_t> mGlobalBCs; // sorted global BCs
+  std::vector<int32_t> mIndices;   // row indices for the global BCs
+  bool mIsSorted = true;
+};
+
+#endif // COMMON_CORE_BCTIMEINDEX_H_
@@ -0,0 +1,126 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   BinnedLookup.h
+/// \brief  Flat copy of a TH1 calibration (bin edges and contents), for the per-collision
+///         GetBinContent(FindFixBin(x)) lookups of the table producers
+///
+
+#ifndef COMMON_CORE_BINNEDLOOKUP_H_
+#define COMMON_CORE_BINNEDLOOKUP_H_
+
+#include <TAxis.h>
+#include <TH1.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+/// Bin contents of a TH1 copied into flat arrays when the calibration is loaded.
+///
+/// get(x) returns the same value as h->GetBinContent(h->FindFixBin(x)) (converted to float), including
+/// the underflow and overflow bins, without the virtual calls and the axis checks of TH1.
+/// For a variable binning the bin is found from a uniform grid of cells over the axis range,
+/// each cell storing the first bin which overlaps it, followed by a short scan of the edges.
+class BinnedLookup
+{
+ public:
+  /// Copies the binning and the contents of the histogram, returns false (and clears the lookup) for a null histogram
+  bool set(const TH1* h)
+  {
+    mNBins = 0;
+    mContents.clear();
+    mEdges.clear();
+    mCellFirstBin.clear();
+    if (h == nullptr) {
+      return false;
+    }
+    const TAxis* axis = h->GetXaxis();
+    mNBins = axis->GetNbins();
+    mMin = axis->GetXmin();
+    mMax = axis->GetXmax();
+    mContents.resize(mNBins + 2);
+    for (int i = 0; i < mNBins + 2; i++) {
+      mContents[i] = h->GetBinContent(i);
+    }
+    mIsUniform = axis->GetXbins()->GetSize() == 0;
+    if (!mIsUniform) {
+      mEdges.resize(mNBins + 1);
+      for (int i = 0; i < mNBins + 1; i++) {
+        mEdges[i] = axis->GetBinLowEdge(i + 1);
+      }
+      const int nCells = kCellsPerBin * mNBins;
+      mInvCellWidth = nCells / (mMax - mMin);
+      mCellFirstBin.resize(nCells + 1);
+      int bin = 0;
+      for (int cell = 0; cell < nCells + 1; cell++) {
+        const double cellLow = mMin + cell / mInvCellWidth;
+        while (bin + 1 < mNBins && mEdges[bin + 1] <= cellLow) {
+          bin++;
+        }
+        mCellFirstBin[cell] = bin;
+      }
+    }
+    return true;
+  }
+
+  bool isSet() const { return mNBins > 0; }
+
+  /// Bin number of x, with the ROOT numbering (0 -- underflow, nBins + 1 -- overflow), as TAxis::FindFixBin
+  int findBin(double x) const
+  {
+    if (x < mMin) {
+      return 0;
+    }
+    if (!(x < mMax)) {
+      return mNBins + 1;
+    }
+    if (mIsUniform) {
+      return 1 + static_cast<int>(mNBins * (x - mMin) / (mMax - mMin));
+    }
+    const int cell = std::min(static_cast<int>((x - mMin) * mInvCellWidth), static_cast<int>(mCellFirstBin.size()) - 1);
+    int bin = mCellFirstBin[cell];
+    // largest edge <= x, as TMath::BinarySearch; the first step back only guards against rounding of the cell index
+    while (bin > 0 && mEdges[bin] > x) {
+      bin--;
+    }
+    while (bin + 1 < mNBins && mEdges[bin + 1] <= x) {
+      bin++;
+    }
+    return bin + 1;
+  }
+
+  /// Content of the bin of x
+  float get(double x) const { return mContents[findBin(x)]; }
+
+  /// Contents of the bins of n values
+  void get(std::size_t n, const float* x, float* values) const
+  {
+    for (std::size_t i = 0; i < n; i++) {
+      values[i] = mContents[findBin(x[i])];
+    }
+  }
+
+ private:
+  static constexpr int kCellsPerBin = 4; // cells of the uniform grid per bin, for the variable binnings
+
+  int mNBins = 0;
+  double mMin = 0.;
+  double mMax = 0.;
+  bool mIsUniform = true;
+  std::vector<float> mContents;   // bin contents, including underflow (0) and overflow (nBins + 1)
+  std::vector<double> mEdges;     // bin edges (variable binning only)
+  double mInvCellWidth = 0.;      // inverse width of the cells of the uniform grid
+  std::vector<int> mCellFirstBin; // first bin (0-based) overlapping each cell
+};
+
+#endif // COMMON_CORE_BINNEDLOOKUP_H_
@@ -20,9 +20,12 @@
 #ifndef COMMON_CORE_COLLISIONASSOCIATION_H_
 #define COMMON_CORE_COLLISIONASSOCIATION_H_
 
-#include <vector>
-#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "CommonConstants/LHCConstants.h"
 #include "Framework/AnalysisDataModel.h"
@@ -104,14 +107,15 @@ class CollisionAssociation
       }
     }
     // create reverse index track to collisions if enabled
-    std::vector<int> empty{};
     if (mFillTableOfCollIdsPerTrack) {
+      std::vector<int> collIds;
+      collIds.reserve(1);
       for (const auto& track : tracks) {
+        collIds.clear();
         if (track.has_collision()) {
-          reverseIndices(std::vector<int>{track.collisionId()});
-        } else {
-          reverseIndices(empty);
+          collIds.push_back(track.collisionId());
         }
+        reverseIndices(collIds);
       }
     }
   }
@@ -125,172 +129,201 @@ class CollisionAssociation
                         Assoc& association,
                         RevIndices& reverseIndices)
   {
-    // cache globalBC and track time in BC for optimization
-    std::vector<int64_t> globalBC;
-    std::vector<int64_t> trackBCCache;
-    std::vector<std::pair<typename TTracks::iterator, typename TTracks::iterator>> trackIterationWindows; // continous regions in which we can count on increasing globalBC numbers
-    globalBC.reserve(tracks.size());
-    trackBCCache.reserve(tracks.size());
-    auto trackBegin = tracks.begin();
-    int lastCollisionId = 0;
-    if (tracks.size() > 0) {
-      lastCollisionId = trackBegin.collisionId();
+    // index of the BC of the ambiguous tracks, built once instead of searching the ambiguous tracks for each unassigned track
+    // (the first entry of a track is used)
+    std::unordered_map<int64_t, int64_t> ambiguousBC;
+    if (mIncludeUnassigned) {
+      ambiguousBC.reserve(ambiguousTracks.size());
+      for (const auto& ambTrack : ambiguousTracks) {
+        if constexpr (isCentralBarrel) { // FIXME: to be removed as soon as it is possible to use getId<Table>() for joined tables
+          if (!ambTrack.has_bc() || ambTrack.bc().size() == 0) {
+            ambiguousBC.emplace(ambTrack.trackId(), -1);
+            continue;
+          }
+          ambiguousBC.emplace(ambTrack.trackId(), ambTrack.bc().begin().globalBC());
+        } else {
+          ambiguousBC.emplace(ambTrack.template getId<TTracks>(), ambTrack.bc().begin().globalBC());
+        }
+      }
     }
-    auto track = trackBegin;
-    for (; track != tracks.end(); ++track) {
+
+    // cache the BC, time, time resolution and compatibility criterion of the tracks
+    std::vector<TrackTimeInfo> trackInfos;
+    trackInfos.reserve(tracks.size());
+    for (const auto& track : tracks) {
       int64_t trackBC = -1;
       if (track.has_collision()) {
         trackBC = track.collision().bc().globalBC();
       } else if (mIncludeUnassigned) {
-        for (const auto& ambTrack : ambiguousTracks) {
-          if constexpr (isCentralBarrel) { // FIXME: to be removed as soon as it is possible to use getId<Table>() for joined tables
-            if (ambTrack.trackId() == track.globalIndex()) {
-              if (!ambTrack.has_bc() || ambTrack.bc().size() == 0) {
-                break;
-              }
-              trackBC = ambTrack.bc().begin().globalBC();
-              break;
-            }
-          } else {
-            if (ambTrack.template getId<TTracks>() == track.globalIndex()) {
-              trackBC = ambTrack.bc().begin().globalBC();
-              break;
-            }
-          }
+        auto ambBC = ambiguousBC.find(track.globalIndex());
+        if (ambBC != ambiguousBC.end()) {
+          trackBC = ambBC->second;
         }
       }
-      globalBC.push_back(trackBC);
-      trackBCCache.push_back(trackBC + track.trackTime() / o2::constants::lhc::LHCBunchSpacingNS);
-      // find uniform blocks
-      if ((track.collisionId() < lastCollisionId) || (lastCollisionId < 0 && track.collisionId() >= 0)) {
-        if (lastCollisionId >= 0 || mIncludeUnassigned) {
-          LOGP(debug, "Found track block from {} to {}, current id {}, last id {}", trackBegin.filteredIndex(), track.filteredIndex() - 1, track.collisionId(), lastCollisionId);
-          trackIterationWindows.push_back(std::make_pair(trackBegin, track));
+      if (trackBC < 0) {
+        continue;
+      }
+
+      TrackTimeInfo info;
+      info.globalIndex = track.globalIndex();
+      info.globalBC = trackBC;
+      info.windowBC = trackBC + track.trackTime() / o2::constants::lhc::LHCBunchSpacingNS;
+      info.time = track.trackTime();
+      info.timeRes = track.trackTimeRes();
+      if constexpr (isCentralBarrel) {
+        if (mUsePvAssociation && track.isPVContributor()) {
+          info.time = track.collision().collisionTime();        // if PV contributor, we assume the time to be the one of the collision
+          info.timeRes = o2::constants::lhc::LHCBunchSpacingNS; // 1 BC
+          info.threshold = TimeThreshold::PvContributor;
+        } else if (TESTBIT(track.flags(), o2::aod::track::TrackTimeResIsRange)) {
+          // the track time resolution is a range, not a gaussian resolution
+          info.threshold = TimeThreshold::Range;
+        } else {
+          info.threshold = TimeThreshold::Gaussian;
+        }
+      } else {
+        // the track is not a central track
+        if constexpr (TTracks::template contains<o2::aod::MFTTracks>()) {
+          // then the track is an MFT track, or an MFT track with additionnal joined info
+          // in this case TrackTimeResIsRange
+          info.threshold = TimeThreshold::Range;
+        } else if constexpr (TTracks::template contains<o2::aod::FwdTracks>()) {
+          // the track is a fwd track, with a gaussian time resolution
+          info.threshold = TimeThreshold::Gaussian;
         }
-        trackBegin = track;
       }
-      lastCollisionId = track.collisionId();
+      trackInfos.push_back(info);
     }
-    // trackIterationWindows.push_back(std::make_pair(trackBegin, tracks.end()));
-    if (lastCollisionId >= 0 || mIncludeUnassigned) {
-      LOGP(debug, "Found track block from {} to {}", trackBegin.filteredIndex(), tracks.size() - 1);
-      trackIterationWindows.push_back(std::make_pair(trackBegin, track));
-    }
-
-    // define vector of vectors to store indices of compatible collisions per track
-    std::vector<std::unique_ptr<std::vector<int>>> collsPerTrack(tracksUnfiltered.size());
+    // tracks sorted by the BC of their time, to sweep the collisions over them
+    std::stable_sort(trackInfos.begin(), trackInfos.end(), [](const TrackTimeInfo& a, const TrackTimeInfo& b) { return a.windowBC < b.windowBC; });
 
-    // loop over collisions to find time-compatible tracks
-    int64_t bcOffsetMax = mBcWindowForOneSigma * mNumSigmaForTimeCompat + mTimeMargin / o2::constants::lhc::LHCBunchSpacingNS;
+    // cache the collisions and sort them by BC
+    std::vector<CollisionTimeInfo> collInfos;
+    collInfos.reserve(collisions.size());
     for (const auto& collision : collisions) {
-      const float collTime = collision.collisionTime();
-      const float collTimeRes2 = collision.collisionTimeRes() * collision.collisionTimeRes();
-      uint64_t collBC = collision.bc().globalBC();
-
-      // This is done per block to allow optimization below. Within each block the globalBC increase continously
-      for (auto& iterationWindow : trackIterationWindows) {
-        bool iteratorMoved = false;
-        const bool isAssignedTrackWindow = (iterationWindow.first != iterationWindow.second) ? iterationWindow.first.has_collision() : false;
-        for (auto track = iterationWindow.first; track != iterationWindow.second; ++track) {
-          int64_t trackBC = globalBC[track.filteredIndex()];
-          if (trackBC < 0) {
-            continue;
-          }
-
-          // Optimization to avoid looping over the full track list each time. This builds on that tracks are sorted by BCs (which they should be because collisions are sorted by BCs)
-          const int64_t bcOffset = trackBC - (int64_t)collBC;
-          if constexpr (isCentralBarrel) {
-            // only for blocks with collision association
-            if (isAssignedTrackWindow) {
-              constexpr int margin = 200;
-              if (!iteratorMoved && bcOffset > -bcOffsetMax - margin) {
-                iterationWindow.first.setCursor(track.filteredIndex());
-                iteratorMoved = true;
-                LOGP(debug, "Moving iterator begin {}", track.filteredIndex());
-              } else if (bcOffset > bcOffsetMax + margin) {
-                LOGP(debug, "Stopping iterator {}", track.filteredIndex());
-                break;
-              }
-            }
-          }
-
-          int64_t bcOffsetWindow = trackBCCache[track.filteredIndex()] - (int64_t)collBC;
-          if (std::abs(bcOffsetWindow) > bcOffsetMax) {
-            continue;
-          }
+      collInfos.push_back({collision.globalIndex(), static_cast<int64_t>(collision.bc().globalBC()), collision.collisionTime(), collision.collisionTimeRes(), 0, 0});
+    }
+    std::vector<int> collOrder(collInfos.size());
+    std::iota(collOrder.begin(), collOrder.end(), 0);
+    std::stable_sort(collOrder.begin(), collOrder.end(), [&collInfos](int a, int b) { return collInfos[a].globalBC < collInfos[b].globalBC; });
 
-          float trackTime = 0;
-          float trackTimeRes = 0;
-          if constexpr (isCentralBarrel) {
-            if (mUsePvAssociation && track.isPVContributor()) {
-              trackTime = track.collision().collisionTime();        // if PV contributor, we assume the time to be the one of the collision
-              trackTimeRes = o2::constants::lhc::LHCBunchSpacingNS; // 1 BC
-            } else {
-              trackTime = track.trackTime();
-              trackTimeRes = track.trackTimeRes();
-            }
-          } else {
-            trackTime = track.trackTime();
-            trackTimeRes = track.trackTimeRes();
-          }
+    // two-pointer sweep: range of tracks within the maximum BC window of each collision
+    int64_t bcOffsetMax = mBcWindowForOneSigma * mNumSigmaForTimeCompat + mTimeMargin / o2::constants::lhc::LHCBunchSpacingNS;
+    const int nTrackInfos = trackInfos.size();
+    int first = 0, last = 0;
+    for (const auto iColl : collOrder) {
+      auto& collInfo = collInfos[iColl];
+      while (first < nTrackInfos && trackInfos[first].windowBC < collInfo.globalBC - bcOffsetMax) {
+        first++;
+      }
+      last = std::max(last, first);
+      while (last < nTrackInfos && trackInfos[last].windowBC <= collInfo.globalBC + bcOffsetMax) {
+        last++;
+      }
+      collInfo.firstTrack = first;
+      collInfo.lastTrack = last;
+    }
 
-          const float deltaTime = trackTime - collTime + bcOffset * o2::constants::lhc::LHCBunchSpacingNS;
-          float sigmaTimeRes2 = collTimeRes2 + trackTimeRes * trackTimeRes;
-          LOGP(debug, "collision time={}, collision time res={}, track time={}, track time res={}, bc collision={}, bc track={}, delta time={}", collTime, collision.collisionTimeRes(), track.trackTime(), track.trackTimeRes(), collBC, trackBC, deltaTime);
+    // test the time compatibility of the tracks in the range of each collision
+    // the compatible tracks are stored flat, collision after collision (CSR: collision offsets + track indices)
+    std::vector<int> compatibleTracks;
+    std::vector<int> collOffsets;
+    collOffsets.reserve(collInfos.size() + 1);
+    collOffsets.push_back(0);
+    for (const auto& collInfo : collInfos) {
+      const float collTime = collInfo.time;
+      const float collTimeRes2 = collInfo.timeRes * collInfo.timeRes;
+      for (int iTrack = collInfo.firstTrack; iTrack < collInfo.lastTrack; iTrack++) {
+        const auto& info = trackInfos[iTrack];
+        const int64_t bcOffset = info.globalBC - collInfo.globalBC;
+        const float deltaTime = info.time - collTime + bcOffset * o2::constants::lhc::LHCBunchSpacingNS;
+        float sigmaTimeRes2 = collTimeRes2 + info.timeRes * info.timeRes;
+        LOGP(debug, "collision time={}, collision time res={}, track time={}, track time res={}, bc collision={}, bc track={}, delta time={}", collTime, collInfo.timeRes, info.time, info.timeRes, collInfo.globalBC, info.globalBC, deltaTime);
 
-          float thresholdTime = 0.;
-          if constexpr (isCentralBarrel) {
-            if (mUsePvAssociation && track.isPVContributor()) {
-              thresholdTime = trackTimeRes;
-            } else if (TESTBIT(track.flags(), o2::aod::track::TrackTimeResIsRange)) {
-              // the track time resolution is a range, not a gaussian resolution
-              thresholdTime = trackTimeRes + mNumSigmaForTimeCompat * std::sqrt(collTimeRes2) + mTimeMargin;
-            } else {
-              thresholdTime = mNumSigmaForTimeCompat * std::sqrt(sigmaTimeRes2) + mTimeMargin;
-            }
-          } else {
-            // the track is not a central track
-            if constexpr (TTracks::template contains<o2::aod::MFTTracks>()) {
-              // then the track is an MFT track, or an MFT track with additionnal joined info
-              // in this case TrackTimeResIsRange
-              thresholdTime = trackTimeRes + mNumSigmaForTimeCompat * std::sqrt(collTimeRes2) + mTimeMargin;
-            } else if constexpr (TTracks::template contains<o2::aod::FwdTracks>()) {
-              // the track is a fwd track, with a gaussian time resolution
-              thresholdTime = mNumSigmaForTimeCompat * std::sqrt(sigmaTimeRes2) + mTimeMargin;
-            }
-          }
+        float thresholdTime = 0.;
+        switch (info.threshold) {
+          case TimeThreshold::PvContributor:
+            thresholdTime = info.timeRes;
+            break;
+          case TimeThreshold::Range:
+            thresholdTime = info.timeRes + mNumSigmaForTimeCompat * std::sqrt(collTimeRes2) + mTimeMargin;
+            break;
+          case TimeThreshold::Gaussian:
+            thresholdTime = mNumSigmaForTimeCompat * std::sqrt(sigmaTimeRes2) + mTimeMargin;
+            break;
+          default:
+            break;
+        }
 
-          if (std::abs(deltaTime) < thresholdTime) {
-            const auto collIdx = collision.globalIndex();
-            const auto trackIdx = track.globalIndex();
-            LOGP(debug, "Filling track id {} for coll id {}", trackIdx, collIdx);
-            association(collIdx, trackIdx);
-            if (mFillTableOfCollIdsPerTrack) {
-              if (collsPerTrack[trackIdx] == nullptr) {
-                collsPerTrack[trackIdx] = std::make_unique<std::vector<int>>();
-              }
-              collsPerTrack[trackIdx].get()->push_back(collIdx);
-            }
-          }
+        if (std::abs(deltaTime) < thresholdTime) {
+          compatibleTracks.push_back(info.globalIndex);
         }
       }
+      // the sweep runs in time order, the association is filled in the order of the track indices
+      std::sort(compatibleTracks.begin() + collOffsets.back(), compatibleTracks.end());
+      collOffsets.push_back(compatibleTracks.size());
+    }
+
+    for (size_t iColl = 0; iColl < collInfos.size(); iColl++) {
+      const auto collIdx = collInfos[iColl].globalIndex;
+      for (int iAssoc = collOffsets[iColl]; iAssoc < collOffsets[iColl + 1]; iAssoc++) {
+        LOGP(debug, "Filling track id {} for coll id {}", compatibleTracks[iAssoc], collIdx);
+        association(collIdx, compatibleTracks[iAssoc]);
+      }
     }
+
     // create reverse index track to collisions if enabled
     if (mFillTableOfCollIdsPerTrack) {
-      std::vector<int> empty{};
-      for (const auto& track : tracksUnfiltered) {
+      // transpose to CSR per track (track offsets + collision indices), in the order of the collisions
+      const int nTracksUnfiltered = tracksUnfiltered.size();
+      std::vector<int> trackOffsets(nTracksUnfiltered + 1, 0);
+      for (const auto trackIdx : compatibleTracks) {
+        trackOffsets[trackIdx + 1]++;
+      }
+      std::partial_sum(trackOffsets.begin(), trackOffsets.end(), trackOffsets.begin());
+      std::vector<int> collsPerTrack(compatibleTracks.size());
+      std::vector<int> fillPosition(trackOffsets.begin(), trackOffsets.end() - 1);
+      for (size_t iColl = 0; iColl < collInfos.size(); iColl++) {
+        for (int iAssoc = collOffsets[iColl]; iAssoc < collOffsets[iColl + 1]; iAssoc++) {
+          collsPerTrack[fillPosition[compatibleTracks[iAssoc]]++] = collInfos[iColl].globalIndex;
+        }
+      }
 
+      std::vector<int> collIds;
+      for (const auto& track : tracksUnfiltered) {
         const auto trackId = track.globalIndex();
-        if (collsPerTrack[trackId] == nullptr) {
-          reverseIndices(empty);
-        } else {
-          reverseIndices(*collsPerTrack[trackId].get());
-        }
+        collIds.assign(collsPerTrack.begin() + trackOffsets[trackId], collsPerTrack.begin() + trackOffsets[trackId + 1]);
+        reverseIndices(collIds);
       }
     }
   }
 
  private:
+  enum class TimeThreshold : uint8_t {
+    None = 0,      // never compatible
+    PvContributor, // time of the collision of the PV contributor, within 1 BC
+    Range,         // the track time resolution is a range
+    Gaussian       // the track time resolution is gaussian
+  };
+
+  struct TrackTimeInfo {
+    int globalIndex = -1;
+    int64_t globalBC = -1; // BC of the collision or of the ambiguous track
+    int64_t windowBC = -1; // BC of the track time, used to sort the tracks
+    float time = 0.f;
+    float timeRes = 0.f;
+    TimeThreshold threshold = TimeThreshold::None;
+  };
+
+  struct CollisionTimeInfo {
+    int globalIndex;
+    int64_t globalBC;
+    float time;
+    float timeRes;
+    int firstTrack; // range of time-sorted tracks within the maximum BC window
+    int lastTrack;
+  };
+
   float mNumSigmaForTimeCompat{4.};                                                  // number of sigma for time compatibility
   float mTimeMargin{500.};                                                           // additional time margin in ns
   int mTrackSelection{o2::aod::track_association::TrackSelection::GlobalTrackWoDCA}; // track selection for central barrel tracks (standard association only)
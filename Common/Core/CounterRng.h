@@ -0,0 +1,90 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   CounterRng.h
+/// \brief  Counter-based random number streams keyed by a seed and object indices (e.g. collision and track),
+///         for the MC smearing which must not depend on the processing order or on the number of threads
+///
+
+#ifndef COMMON_CORE_COUNTERRNG_H_
+#define COMMON_CORE_COUNTERRNG_H_
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+/// Random number stream of one object.
+///
+/// The n-th number of the stream is a hash (the SplitMix64 finaliser) of the stream key and n, where the key
+/// is derived from the seed and up to two indices. A stream is created where it is needed, e.g. per track, and
+/// gives the same numbers whichever thread uses it and whatever is drawn for the other objects.
+/// The streams of different keys are independent for the purpose of detector smearing (not for cryptography).
+///
+/// Usage:
+///   CounterRng rng(seed, collisionCounter, trackIndex);
+///   float smeared = rng.gaus(value, sigma);
+class CounterRng
+{
+ public:
+  CounterRng(uint64_t seed, uint64_t key1, uint64_t key2 = 0) : mKey(mix(mix(mix(seed) ^ key1) ^ key2)) {}
+
+  /// Next 64 random bits
+  uint64_t next() { return mix(mKey + kGolden * ++mCounter); }
+
+  /// Uniform in (0, 1), as TRandom::Rndm
+  double uniform() { return (static_cast<double>(next() >> 11) + 0.5) * 0x1.0p-53; }
+
+  /// Uniform in (min, max)
+  double uniform(double min, double max) { return min + (max - min) * uniform(); }
+
+  /// Gaussian with the Box-Muller method, the second value of each pair is kept for the next call
+  double gaus(double mean = 0., double sigma = 1.)
+  {
+    if (mHasSpare) {
+      mHasSpare = false;
+      return mean + sigma * mSpare;
+    }
+    const double r = std::sqrt(-2. * std::log(uniform()));
+    const double phi = 2. * M_PI * uniform();
+    mSpare = r * std::sin(phi);
+    mHasSpare = true;
+    return mean + sigma * r * std::cos(phi);
+  }
+
+  /// Seed from a configurable, a non-deterministic one if 0
+  static uint64_t seedFromConfig(int64_t seed)
+  {
+    if (seed != 0) {
+      return static_cast<uint64_t>(seed);
+    }
+    std::random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) | rd();
+  }
+
+ private:
+  static constexpr uint64_t kGolden = 0x9e3779b97f4a7c15ULL;
+
+  static uint64_t mix(uint64_t z)
+  {
+    z += kGolden;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  uint64_t mKey;
+  uint64_t mCounter = 0;
+  double mSpare = 0.;
+  bool mHasSpare = false;
+};
+
+#endif // COMMON_CORE_COUNTERRNG_H_
@@ -0,0 +1,244 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   DenseHistogram.h
+/// \brief  Dense accumulators for the TH1/TH2/TH3 of a HistogramRegistry filled per track, with the bins
+///         of the axes shared by several histograms (e.g. pt, eta, phi) found once per track
+///
+
+#ifndef COMMON_CORE_DENSEHISTOGRAM_H_
+#define COMMON_CORE_DENSEHISTOGRAM_H_
+
+#include <TAxis.h>
+#include <TH1.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/// Bin of a value on a DenseAxis, with the value for the statistics of the histograms
+struct DenseBin {
+  int bin = 0; // ROOT numbering: 0 -- underflow, nBins + 1 -- overflow
+  double x = 0.;
+};
+
+/// Binning of a TAxis, to find the bin of a value once for all the histograms with this axis
+class DenseAxis
+{
+ public:
+  DenseAxis() = default;
+  explicit DenseAxis(const TAxis* axis) { set(axis); }
+
+  void set(const TAxis* axis)
+  {
+    mNBins = axis->GetNbins();
+    mMin = axis->GetXmin();
+    mMax = axis->GetXmax();
+    mEdges.clear();
+    if (axis->IsVariableBinSize()) {
+      mEdges.assign(axis->GetXbins()->GetArray(), axis->GetXbins()->GetArray() + mNBins + 1);
+    }
+  }
+
+  int nBins() const { return mNBins; }
+
+  /// Bin as TAxis::FindBin, for an axis without the kCanExtend bit
+  int findBin(double x) const
+  {
+    if (x < mMin) {
+      return 0;
+    }
+    if (!(x < mMax)) {
+      return mNBins + 1;
+    }
+    if (mEdges.empty()) {
+      return 1 + static_cast<int>(mNBins * (x - mMin) / (mMax - mMin));
+    }
+    return static_cast<int>(std::upper_bound(mEdges.begin(), mEdges.end(), x) - mEdges.begin());
+  }
+
+  DenseBin bin(double x) const { return {findBin(x), x}; }
+
+  bool operator==(const DenseAxis& other) const
+  {
+    return mNBins == other.mNBins && mMin == other.mMin && mMax == other.mMax && mEdges == other.mEdges;
+  }
+
+ private:
+  int mNBins = 1;
+  double mMin = 0.;
+  double mMax = 1.;
+  std::vector<double> mEdges; // variable binning only
+};
+
+/// Contents of a TH1, TH2 or TH3 accumulated in dense arrays (including under- and overflow bins) and
+/// added to the histogram by flush(), together with the entries and the statistics (sums of w, w^2, w*x, ...).
+///
+/// A fill takes the bins of the values (DenseBin, from a DenseAxis equal to the axis of the histogram)
+/// and is an index computation and an addition, instead of the bin search of every axis and the virtual
+/// calls of TH1::Fill. flush() only visits the cells filled since the previous flush, it can be called
+/// e.g. at the end of each process() at a small cost.
+///
+/// Usage:
+///   hPt.init(registry.get<TH1>(HIST("pt")).get());
+///   hEtaPt.init(registry.get<TH2>(HIST("etavspt")).get());
+///   auto pt = axisPt.bin(track.pt());
+///   hPt.fill(pt);
+///   hEtaPt.fill(pt, axisEta.bin(track.eta()));
+///   ...
+///   hPt.flush();
+///   hEtaPt.flush();
+class DenseHistogram
+{
+ public:
+  static constexpr int64_t kDefaultMaxCells = 1 << 24;
+
+  /// Takes the binning of the histogram, stays inactive (returns false) if the number of cells exceeds maxCells
+  bool init(TH1* h, int64_t maxCells = kDefaultMaxCells)
+  {
+    mHist = nullptr;
+    mNDim = h->GetDimension();
+    mAxes[0].set(h->GetXaxis());
+    mAxes[1].set(h->GetYaxis());
+    mAxes[2].set(h->GetZaxis());
+    int64_t nCells = 1;
+    for (int i = 0; i < mNDim; ++i) {
+      mStrides[i] = nCells;
+      nCells *= mAxes[i].nBins() + 2;
+    }
+    mSumW.clear();
+    mSumW2.clear();
+    mTouched.clear();
+    mNFills = 0;
+    mStats.fill(0.);
+    if (nCells > maxCells) {
+      return false;
+    }
+    mHist = h;
+    mSumW.assign(nCells, 0.);
+    if (h->GetSumw2N() > 0) {
+      mSumW2.assign(nCells, 0.);
+    }
+    mStatOverflows = h->GetStatOverflowsBool();
+    return true;
+  }
+
+  bool isActive() const { return mHist != nullptr; }
+
+  /// Axis i of the histogram, to check at init that the bins of a shared DenseAxis can be used
+  const DenseAxis& axis(int i) const { return mAxes[i]; }
+
+  void fill(DenseBin x) { fillWeight(1., x); }
+  void fill(DenseBin x, DenseBin y) { fillWeight(1., x, y); }
+  void fill(DenseBin x, DenseBin y, DenseBin z) { fillWeight(1., x, y, z); }
+
+  void fillWeight(double w, DenseBin x)
+  {
+    add(x.bin, w);
+    if (isInRange(x.bin, 0)) {
+      addStatsX(w, x.x);
+    }
+  }
+
+  void fillWeight(double w, DenseBin x, DenseBin y)
+  {
+    add(x.bin + mStrides[1] * y.bin, w);
+    if (isInRange(x.bin, 0) && isInRange(y.bin, 1)) {
+      addStatsX(w, x.x);
+      mStats[4] += w * y.x;
+      mStats[5] += w * y.x * y.x;
+      mStats[6] += w * x.x * y.x;
+    }
+  }
+
+  void fillWeight(double w, DenseBin x, DenseBin y, DenseBin z)
+  {
+    add(x.bin + mStrides[1] * y.bin + mStrides[2] * z.bin, w);
+    if (isInRange(x.bin, 0) && isInRange(y.bin, 1) && isInRange(z.bin, 2)) {
+      addStatsX(w, x.x);
+      mStats[4] += w * y.x;
+      mStats[5] += w * y.x * y.x;
+      mStats[6] += w * x.x * y.x;
+      mStats[7] += w * z.x;
+      mStats[8] += w * z.x * z.x;
+      mStats[9] += w * x.x * z.x;
+      mStats[10] += w * y.x * z.x;
+    }
+  }
+
+  /// Adds the accumulated contents, entries and statistics to the histogram and resets the accumulator.
+  /// The cell numbering (first axis fastest, with under- and overflow) is the global bin numbering of TH1.
+  void flush()
+  {
+    if (!isActive() || mNFills == 0) {
+      return;
+    }
+    auto entries = mHist->GetEntries();
+    for (auto cell : mTouched) {
+      mHist->AddBinContent(cell, mSumW[cell]);
+      mSumW[cell] = 0.;
+      if (!mSumW2.empty()) {
+        mHist->GetSumw2()->fArray[cell] += mSumW2[cell];
+        mSumW2[cell] = 0.;
+      }
+    }
+    std::array<double, kNStats> stats{};
+    mHist->GetStats(stats.data());
+    for (int i = 0; i < kNStats; ++i) {
+      stats[i] += mStats[i];
+    }
+    mHist->PutStats(stats.data());
+    mHist->SetEntries(entries + mNFills);
+    mTouched.clear();
+    mStats.fill(0.);
+    mNFills = 0;
+  }
+
+ private:
+  static constexpr int kNStats = 11; // size of the statistics array of TH3, see TH1::GetStats
+
+  bool isInRange(int bin, int axis) const { return mStatOverflows || (bin > 0 && bin <= mAxes[axis].nBins()); }
+
+  void add(int64_t cell, double w)
+  {
+    if (mSumW[cell] == 0. && (mSumW2.empty() || mSumW2[cell] == 0.)) {
+      mTouched.push_back(cell);
+    }
+    mSumW[cell] += w;
+    if (!mSumW2.empty()) {
+      mSumW2[cell] += w * w;
+    }
+    ++mNFills;
+  }
+
+  void addStatsX(double w, double x)
+  {
+    mStats[0] += w;
+    mStats[1] += w * w;
+    mStats[2] += w * x;
+    mStats[3] += w * x * x;
+  }
+
+  TH1* mHist = nullptr;
+  int mNDim = 1;
+  std::array<DenseAxis, 3> mAxes;
+  std::array<int64_t, 3> mStrides{1, 0, 0};
+  std::vector<double> mSumW;
+  std::vector<double> mSumW2;   // only if the histogram stores the sum of the squared weights
+  std::vector<int64_t> mTouched; // cells filled since the last flush
+  std::array<double, kNStats> mStats{};
+  int64_t mNFills = 0;
+  bool mStatOverflows = false; // statistics also of the under- and overflow fills, as TH1::Fill
+};
+
+#endif // COMMON_CORE_DENSEHISTOGRAM_H_
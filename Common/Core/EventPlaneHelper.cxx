@@ -24,6 +24,7 @@
 #include <iterator>
 #include <vector>
 #include <memory>
+#include <span>
 
 #include "TMath.h"
 #include "TVector3.h"
@@ -54,7 +55,7 @@ double EventPlaneHelper::GetPhiFV0(int chno, o2::fv0::Geometry* fv0geom)
   return TMath::ATan2(chPos.y + offsetY, chPos.x + offsetX);
 }
 
-double EventPlaneHelper::GetPhiFT0(int chno, o2::ft0::Geometry ft0geom)
+double EventPlaneHelper::GetPhiFT0(int chno, o2::ft0::Geometry& ft0geom)
 {
   /* Calculate the azimuthal angle in FT0 for the channel number 'chno'. The offset
     of FT0-A is taken into account if chno is between 0 and 95. */
@@ -74,10 +75,44 @@ double EventPlaneHelper::GetPhiFT0(int chno, o2::ft0::Geometry ft0geom)
   return TMath::ATan2(chPos.Y() + offsetY, chPos.X() + offsetX);
 }
 
-void EventPlaneHelper::SumQvectors(int det, int chno, float ampl, int nmod, TComplex& Qvec, float& sum, o2::ft0::Geometry ft0geom, o2::fv0::Geometry* fv0geom)
+void EventPlaneHelper::SetChannelAngles(o2::ft0::Geometry& ft0geom, o2::fv0::Geometry* fv0geom, int nHarmonics, bool useOffsetFT0C)
+{
+  /* Cache the (cos(n*phi), sin(n*phi)) of each channel of FT0 and FV0 for n = 1..nHarmonics.
+    The channel centres of FT0 are calculated once for all channels. */
+  mNHarmonics = nHarmonics;
+  ft0geom.calculateChannelCenter();
+
+  for (int det = 0; det < 2; det++) {
+    mChCosPhi[det].resize(nHarmonics * kNChannels[det]);
+    mChSinPhi[det].resize(nHarmonics * kNChannels[det]);
+    for (int chno = 0; chno < kNChannels[det]; chno++) {
+      double phi = 0.;
+      if (det == 0) {
+        double offsetX = chno < 96 ? mOffsetFT0AX : (useOffsetFT0C ? mOffsetFT0CX : 0.); // No offset for FT0-C by default, as in GetPhiFT0().
+        double offsetY = chno < 96 ? mOffsetFT0AY : (useOffsetFT0C ? mOffsetFT0CY : 0.);
+        auto chPos = ft0geom.getChannelCenter(chno);
+        phi = TMath::ATan2(chPos.Y() + offsetY, chPos.X() + offsetX);
+      } else {
+        phi = GetPhiFV0(chno, fv0geom);
+      }
+      for (int n = 1; n <= nHarmonics; n++) {
+        mChCosPhi[det][(n - 1) * kNChannels[det] + chno] = TMath::Cos(phi * n);
+        mChSinPhi[det][(n - 1) * kNChannels[det] + chno] = TMath::Sin(phi * n);
+      }
+    }
+  }
+}
+
+void EventPlaneHelper::SumQvectors(int det, int chno, float ampl, int nmod, TComplex& Qvec, float& sum, o2::ft0::Geometry& ft0geom, o2::fv0::Geometry* fv0geom)
 {
   /* Calculate the complex Q-vector for the provided detector and channel number,
     before adding it to the total Q-vector given as argument. */
+  if ((det == 0 || det == 1) && nmod >= 1 && nmod <= mNHarmonics && chno >= 0 && chno < kNChannels[det]) {
+    Qvec += TComplex(ampl * GetCosPhi(det, chno, nmod), ampl * GetSinPhi(det, chno, nmod));
+    sum += ampl;
+    return;
+  }
+
   double phi = -999.;
 
   switch (det) {
@@ -102,6 +137,40 @@ void EventPlaneHelper::SumQvectors(int det, int chno, float ampl, int nmod, TCom
   sum += ampl;
 }
 
+void EventPlaneHelper::SumQvectors(int det, std::span<const int> channels, std::span<const float> ampls,
+                                   std::span<float> qx, std::span<float> qy, float& sum) const
+{
+  /* Add the Q-vectors of the harmonics 1..qx.size() of the given channels, with the
+    angles cached by SetChannelAngles(). The harmonic is the outer loop, so that the
+    cached cosines and sines of one harmonic are read contiguously. */
+  if (det != 0 && det != 1) {
+    printf("'int det' value does not correspond to any accepted case.\n");
+    return;
+  }
+  const int nCh = kNChannels[det];
+  const int nHarmonics = std::min<int>(qx.size(), mNHarmonics);
+  for (int n = 0; n < nHarmonics; n++) {
+    const float* cosPhi = mChCosPhi[det].data() + n * nCh;
+    const float* sinPhi = mChSinPhi[det].data() + n * nCh;
+    float sumX = 0.;
+    float sumY = 0.;
+    for (std::size_t i = 0; i < channels.size(); i++) {
+      if (channels[i] < 0 || channels[i] >= nCh) {
+        continue;
+      }
+      sumX += ampls[i] * cosPhi[channels[i]];
+      sumY += ampls[i] * sinPhi[channels[i]];
+    }
+    qx[n] += sumX;
+    qy[n] += sumY;
+  }
+  for (std::size_t i = 0; i < channels.size(); i++) {
+    if (channels[i] >= 0 && channels[i] < nCh) {
+      sum += ampls[i];
+    }
+  }
+}
+
 int EventPlaneHelper::GetCentBin(float cent)
 {
   const float centClasses[] = {0., 5., 10., 20., 30., 40., 50., 60., 80.};
@@ -21,8 +21,10 @@
 #ifndef COMMON_CORE_EVENTPLANEHELPER_H_
 #define COMMON_CORE_EVENTPLANEHELPER_H_
 
+#include <array>
 #include <vector>
 #include <memory>
+#include <span>
 
 #include "TNamed.h"
 
@@ -61,12 +63,28 @@ class EventPlaneHelper
   }
 
   // Methods to calculate the azimuthal angles for each part of FIT, given the channel number.
-  double GetPhiFT0(int chno, o2::ft0::Geometry ft0geom);
+  // The channel centres of FT0 are recalculated at each call, use SetChannelAngles() for many channels.
+  double GetPhiFT0(int chno, o2::ft0::Geometry& ft0geom);
   double GetPhiFV0(int chno, o2::fv0::Geometry* fv0geom);
 
+  // Method to cache (cos(n*phi), sin(n*phi)) of all the FT0 and FV0 channels for the harmonics
+  // n = 1..nHarmonics, with the offsets set before the call. To be called again when the offsets change.
+  // The offset of FT0-C is only applied with useOffsetFT0C (GetPhiFT0() applies none).
+  void SetChannelAngles(o2::ft0::Geometry& ft0geom, o2::fv0::Geometry* fv0geom, int nHarmonics, bool useOffsetFT0C = false);
+  int GetNHarmonics() const { return mNHarmonics; }
+
+  // Cached cos(n*phi) and sin(n*phi) of a channel of FT0 (det = 0) or FV0 (det = 1), 1 <= nmod <= nHarmonics.
+  float GetCosPhi(int det, int chno, int nmod) const { return mChCosPhi[det][(nmod - 1) * kNChannels[det] + chno]; }
+  float GetSinPhi(int det, int chno, int nmod) const { return mChSinPhi[det][(nmod - 1) * kNChannels[det] + chno]; }
+
   // Method to get the Q-vector and sum of amplitudes for any channel in FIT, given
   // the detector and amplitude.
-  void SumQvectors(int det, int chno, float ampl, int nmod, TComplex& Qvec, float& sum, o2::ft0::Geometry ft0geom, o2::fv0::Geometry* fv0geom);
+  void SumQvectors(int det, int chno, float ampl, int nmod, TComplex& Qvec, float& sum, o2::ft0::Geometry& ft0geom, o2::fv0::Geometry* fv0geom);
+
+  // Method to add the Q-vectors of the harmonics n = 1..qx.size() of a set of channels of FT0 (det = 0)
+  // or FV0 (det = 1) to (qx[n - 1], qy[n - 1]), and their amplitudes to sum, with the cached angles.
+  void SumQvectors(int det, std::span<const int> channels, std::span<const float> ampls,
+                   std::span<float> qx, std::span<float> qy, float& sum) const;
 
   // Method to get the bin corresponding to a centrality percentile, according to the
   // centClasses[] array defined in Tasks/qVectorsQA.cxx.
@@ -108,6 +126,11 @@ class EventPlaneHelper
   double mOffsetFV0rightX = 0.; // X-coordinate of the offset of FV0-A right.
   double mOffsetFV0rightY = 0.; // Y-coordinate of the offset of FV0-A right.
 
+  static constexpr std::array<int, 2> kNChannels = {208, 48}; // Number of channels of FT0 and FV0.
+  int mNHarmonics = 0;                                        // Number of harmonics of the cached angles.
+  std::array<std::vector<float>, 2> mChCosPhi;                //! cos(n*phi) of FT0 and FV0, indexed by (n - 1) * nChannels + chno.
+  std::array<std::vector<float>, 2> mChSinPhi;                //! sin(n*phi) of FT0 and FV0.
+
   ClassDefNV(EventPlaneHelper, 2)
 };
 
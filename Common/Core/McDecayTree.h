@@ -0,0 +1,210 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file McDecayTree.h
+/// \brief Flat index of the MC decay tree of a dataframe, for fast MC matching of reconstructed decays
+
+#ifndef COMMON_CORE_MCDECAYTREE_H_
+#define COMMON_CORE_MCDECAYTREE_H_
+
+#include <algorithm> // std::find
+#include <array>     // std::array
+#include <cmath>     // std::abs
+#include <cstdint>   // int8_t, int64_t
+#include <vector>    // std::vector
+
+#include "TMCProcess.h" // for VMC Particle Production Process
+
+/// Copy of the mother and daughter links, PDG codes, generator status codes and production processes of the MC particles of a dataframe
+///
+/// The index is built once per dataframe from the MC particle table and replaces the table iterators
+/// in the traversal of the decay tree with lookups in contiguous arrays.
+/// Particles are addressed by their global index, as in the MC particle table.
+/// \note The traversal buffers are reused between calls, so an instance must not be shared between threads.
+struct McDecayTree {
+  /// Fills the index from an MC particle table.
+  /// \param particlesMC  table with MC particles
+  template <typename T>
+  void build(const T& particlesMC)
+  {
+    const auto nParticles = particlesMC.size();
+    offset = particlesMC.offset();
+    pdgCodes.resize(nParticles);
+    genStatusCodes.resize(nParticles);
+    processes.resize(nParticles);
+    mothersFirst.resize(nParticles);
+    mothersLast.resize(nParticles);
+    daughtersFirst.resize(nParticles);
+    daughtersLast.resize(nParticles);
+    for (const auto& particle : particlesMC) {
+      const auto iParticle = particle.globalIndex() - offset;
+      pdgCodes[iParticle] = particle.pdgCode();
+      genStatusCodes[iParticle] = particle.getGenStatusCode();
+      processes[iParticle] = particle.getProcess();
+      if (particle.has_mothers()) {
+        mothersFirst[iParticle] = particle.mothersIds().front();
+        mothersLast[iParticle] = particle.mothersIds().back();
+      } else {
+        mothersFirst[iParticle] = -1;
+        mothersLast[iParticle] = -1;
+      }
+      if (particle.has_daughters()) {
+        daughtersFirst[iParticle] = particle.daughtersIds().front();
+        daughtersLast[iParticle] = particle.daughtersIds().back();
+      } else {
+        daughtersFirst[iParticle] = -1;
+        daughtersLast[iParticle] = -1;
+      }
+    }
+  }
+
+  int pdgCode(int index) const { return pdgCodes[index - offset]; }
+  int genStatusCode(int index) const { return genStatusCodes[index - offset]; }
+  int process(int index) const { return processes[index - offset]; }
+  bool hasMothers(int index) const { return mothersFirst[index - offset] > -1; }
+  bool hasDaughters(int index) const { return daughtersFirst[index - offset] > -1; }
+  int firstDaughter(int index) const { return daughtersFirst[index - offset]; }
+  int lastDaughter(int index) const { return daughtersLast[index - offset]; }
+
+  /// Finds the mother of an MC particle by looking for the expected PDG code in the mother chain.
+  /// Same as RecoDecay::getMother.
+  /// \param index  global index of the MC particle
+  /// \param PDGMother  expected mother PDG code
+  /// \param acceptAntiParticles  switch to accept the antiparticle of the expected mother
+  /// \param sign  antiparticle indicator of the found mother w.r.t. PDGMother; 1 if particle, -1 if antiparticle, 0 if mother not found
+  /// \param depthMax  maximum decay tree level to check; Mothers up to this level will be considered. If -1, all levels are considered.
+  /// \return index of the mother particle if found, -1 otherwise
+  template <bool acceptFlavourOscillation = false>
+  int getMother(int index,
+                int PDGMother,
+                bool acceptAntiParticles = false,
+                int8_t* sign = nullptr,
+                int8_t depthMax = -1) const
+  {
+    int8_t sgn = 0;       // 1 if the expected mother is particle, -1 if antiparticle (w.r.t. PDGMother)
+    int indexMother = -1; // index of the final matched mother, if found
+    int stage = 0;        // mother tree level
+    if (sign) {
+      *sign = sgn;
+    }
+
+    // indices of the particles of the current and of the next stage
+    bufferStage.assign(1, index);
+    while (indexMother < 0 && !bufferStage.empty() && (depthMax < 0 || stage < depthMax)) {
+      bufferNextStage.clear();
+      for (auto iPart : bufferStage) { // check all the particles that were the mothers at the previous stage
+        if (!hasMothers(iPart)) {
+          continue;
+        }
+        for (auto iMother = mothersFirst[iPart - offset]; iMother <= mothersLast[iPart - offset]; ++iMother) { // loop over the mother particles of the analysed particle
+          if (std::find(bufferNextStage.begin(), bufferNextStage.end(), iMother) != bufferNextStage.end()) {   // if a mother is still present in the vector, do not check it again
+            continue;
+          }
+          auto PDGParticleIMother = pdgCode(iMother); // PDG code of the mother
+          if (PDGParticleIMother == PDGMother) {      // exact PDG match
+            sgn = 1;
+            indexMother = iMother;
+            break;
+          } else if (acceptAntiParticles && PDGParticleIMother == -PDGMother) { // antiparticle PDG match
+            sgn = -1;
+            indexMother = iMother;
+            break;
+          }
+          bufferNextStage.push_back(iMother);
+        }
+      }
+      bufferStage.swap(bufferNextStage);
+      stage++;
+    }
+    if (sign) {
+      if constexpr (acceptFlavourOscillation) {
+        if (std::abs(genStatusCode(index)) == PdgStatusCodeAfterFlavourOscillation) { // take possible flavour oscillation of B0(s) mother into account
+          sgn *= -1;                                                                  // select the sign of the mother after oscillation (and not before)
+        }
+      }
+      *sign = sgn;
+    }
+    return indexMother;
+  }
+
+  /// Gets the complete list of indices of final-state daughters of an MC particle.
+  /// Same as RecoDecay::getDaughters.
+  /// \param checkProcess  switch to accept only decay daughters by checking the production process of MC particles
+  /// \param index  global index of the MC particle
+  /// \param list  vector where the indices of final-state daughters will be added
+  /// \param arrPDGFinal  array of PDG codes of particles to be considered final if found
+  /// \param depthMax  maximum decay tree level; Daughters at this level (or beyond) will be considered final. If -1, all levels are considered.
+  /// \param stage  decay tree level; If different from 0, the particle itself will be added in the list in case it has no daughters.
+  template <bool checkProcess = false, std::size_t N>
+  void getDaughters(int index,
+                    std::vector<int>* list,
+                    const std::array<int, N>& arrPDGFinal,
+                    int8_t depthMax = -1,
+                    int8_t stage = 0) const
+  {
+    if (!list) {
+      return;
+    }
+    if constexpr (checkProcess) {
+      // If the particle is neither the original particle nor coming from a decay, we do nothing and exit.
+      if (stage != 0 && process(index) != TMCProcess::kPDecay && process(index) != TMCProcess::kPPrimary) { // decay products of HF hadrons are labeled as kPPrimary
+        return;
+      }
+    }
+
+    bool isFinal = depthMax > -1 && stage >= depthMax; // Maximum depth has been reached (or exceeded).
+    if (!isFinal && !hasDaughters(index)) {
+      // If the original particle has no daughters, we do nothing and exit.
+      if (stage == 0) {
+        return;
+      }
+      // If this is not the original particle, we are at the end of this branch and this particle is final.
+      isFinal = true;
+    }
+    // If this is not the original particle, check its PDG code.
+    if (!isFinal && stage > 0) {
+      auto PDGParticle = std::abs(pdgCode(index));
+      for (auto PDGi : arrPDGFinal) {
+        if (PDGParticle == std::abs(PDGi)) { // Accept antiparticles.
+          isFinal = true;
+          break;
+        }
+      }
+    }
+    if (isFinal) {
+      list->push_back(index);
+      return;
+    }
+    // Call itself to get daughters of daughters recursively.
+    stage++;
+    for (auto iDaughter = firstDaughter(index); iDaughter <= lastDaughter(index); ++iDaughter) {
+      getDaughters<checkProcess>(iDaughter, list, arrPDGFinal, depthMax, stage);
+    }
+  }
+
+  static constexpr int8_t PdgStatusCodeAfterFlavourOscillation = 92; // decay products after B0(s) flavour oscillation
+
+  int64_t offset{0};
+  std::vector<int> pdgCodes;
+  std::vector<int> genStatusCodes;
+  std::vector<int> processes;
+  std::vector<int> mothersFirst; // -1 if no mothers
+  std::vector<int> mothersLast;
+  std::vector<int> daughtersFirst; // -1 if no daughters
+  std::vector<int> daughtersLast;
+
+  // buffers reused by the traversals
+  mutable std::vector<int> bufferStage;
+  mutable std::vector<int> bufferNextStage;
+  mutable std::vector<int> bufferDaughters;
+};
+
+#endif // COMMON_CORE_MCDECAYTREE_H_
@@ -250,6 +250,42 @@ class TOFResoParamsV2 : public o2::tof::Parameters<13>
   TGraph* gNegEtaTimeCorr = nullptr; /// Time shift correction for negative tracks
 };
 
+/// \brief Quantities of a track entering the TOF response that do not depend on the mass hypothesis.
+/// They are computed once per track (including the momentum and time shift corrections) and shared by the ExpTimes of all the hypotheses
+struct TOFResponseInputs {
+  bool hasTOF = false;
+  float mom = 0.f;              /// Track momentum
+  float length = 0.f;           /// Track length
+  float tofSignal = 0.f;        /// TOF signal
+  float evTime = 0.f;           /// Event time
+  float evTimeErr = 0.f;        /// Event time resolution
+  float tofExpMomShifted = 0.f; /// TOF expected momentum corrected for the momentum shift (and converted for Run 2 tracks)
+  float timeShift = 0.f;        /// Time shift correction of the expected times
+
+  template <typename TrackType>
+  void fill(const TOFResoParamsV2& parameters, const TrackType& track)
+  {
+    hasTOF = track.hasTOF();
+    mom = track.p();
+    length = track.length();
+    tofSignal = track.tofSignal();
+    evTime = track.tofEvTime();
+    evTimeErr = track.tofEvTimeErr();
+    if (!hasTOF) {
+      return;
+    }
+    const float eta = track.eta();
+    const auto sign = track.sign();
+    if (track.trackType() == o2::aod::track::Run2Track) {
+      tofExpMomShifted = track.tofExpMom() * kCSPEDDInv / (1.f + sign * parameters.getShift(eta));
+      timeShift = 0.f;
+      return;
+    }
+    tofExpMomShifted = track.tofExpMom() / (1.f + sign * parameters.getShift(eta));
+    timeShift = parameters.getTimeShift(eta, sign);
+  }
+};
+
 /// \brief Class to handle the the TOF detector response for the expected time
 template <typename TrackType, o2::track::PID::ID id>
 class ExpTimes
@@ -291,15 +327,32 @@ class ExpTimes
     return ComputeExpectedTime(track.tofExpMom() / (1.f + track.sign() * parameters.getShift(track.eta())), track.length()) + parameters.getTimeShift(track.eta(), track.sign());
   }
 
+  /// Gets the expected signal under the PID assumption from the precomputed inputs of the track, corrected for shifts in expected momentum
+  /// \param inputs Hypothesis-independent inputs of the track of interest
+  static float GetCorrectedExpectedSignal(const TOFResponseInputs& inputs)
+  {
+    if (!inputs.hasTOF) {
+      return defaultReturnValue;
+    }
+    return ComputeExpectedTime(inputs.tofExpMomShifted, inputs.length) + inputs.timeShift;
+  }
+
   /// Gets the expected resolution of the t-texp-t0
   /// Given a TOF signal and collision time resolutions
   /// \param parameters Detector response parameters
   /// \param track Track of interest
   /// \param tofSignal TOF signal of the track of interest
   /// \param collisionTimeRes Collision time resolution of the track of interest
-  static float GetExpectedSigma(const TOFResoParamsV2& parameters, const TrackType& track, const float tofSignal, const float collisionTimeRes)
+  static float GetExpectedSigma(const TOFResoParamsV2& parameters, const TrackType& track, const float tofSignal, const float collisionTimeRes) { return GetExpectedSigma(parameters, track.p(), tofSignal, collisionTimeRes); }
+
+  /// Gets the expected resolution of the t-texp-t0
+  /// Given the momentum, a TOF signal and collision time resolutions
+  /// \param parameters Detector response parameters
+  /// \param mom Momentum of the track of interest
+  /// \param tofSignal TOF signal of the track of interest
+  /// \param collisionTimeRes Collision time resolution of the track of interest
+  static float GetExpectedSigma(const TOFResoParamsV2& parameters, const float mom, const float tofSignal, const float collisionTimeRes)
   {
-    const float& mom = track.p();
     if (mom <= 0) {
       return -999.f;
     }
@@ -325,6 +378,11 @@ class ExpTimes
   /// \param track Track of interest
   static float GetExpectedSigma(const TOFResoParamsV2& parameters, const TrackType& track) { return GetExpectedSigma(parameters, track, track.tofSignal(), track.tofEvTimeErr()); }
 
+  /// Gets the expected resolution of the t-texp-t0 from the precomputed inputs of the track
+  /// \param parameters Detector response parameters
+  /// \param inputs Hypothesis-independent inputs of the track of interest
+  static float GetExpectedSigma(const TOFResoParamsV2& parameters, const TOFResponseInputs& inputs) { return GetExpectedSigma(parameters, inputs.mom, inputs.tofSignal, inputs.evTimeErr); }
+
   /// Gets the expected resolution of the time measurement, uses the expected time and no event time resolution
   /// \param parameters Parameters to use to compute the expected resolution
   /// \param track Track of interest
@@ -346,6 +404,11 @@ class ExpTimes
   /// \param parameters Detector response parameters
   /// \param track Track of interest
   static float GetSeparation(const TOFResoParamsV2& parameters, const TrackType& track) { return GetSeparation(parameters, track, track.tofEvTime(), GetExpectedSigma(parameters, track)); }
+
+  /// Gets the number of sigmas with respect the expected time from the precomputed inputs of the track
+  /// \param inputs Hypothesis-independent inputs of the track of interest
+  /// \param resolution Expected resolution
+  static float GetSeparation(const TOFResponseInputs& inputs, const float resolution) { return inputs.hasTOF ? (inputs.tofSignal - inputs.evTime - GetCorrectedExpectedSignal(inputs)) / resolution : defaultReturnValue; }
 };
 
 /// \brief Class to convert the trackTime to the tofSignal used for PID
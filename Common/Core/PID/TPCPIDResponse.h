@@ -85,6 +85,13 @@ class Response
   float GetSignalDelta(const TrackType& trk, const o2::track::PID::ID id) const;
   /// Gets relative dEdx resolution contribution due to relative pt resolution
   float GetRelativeResolutiondEdx(const float p, const float mass, const float charge, const float resol) const;
+  /// Gets the expected signal, expected resolution and number of sigmas for several mass hypotheses in one pass.
+  /// The per-track inputs are read once, the output arrays follow the order of ids and must hold nIds entries
+  void GetNumberOfSigmaBulk(const float p, const float tpcSignal, const float nCls, const float tgl, const float signed1Pt, const float multTPC,
+                            const o2::track::PID::ID* ids, const int nIds, float* expSignal, float* expSigma, float* nSigma) const;
+  /// Same as above, reading the per-track inputs from the collision and the track
+  template <typename CollisionType, typename TrackType>
+  void GetNumberOfSigmaBulk(const CollisionType& collision, const TrackType& trk, const o2::track::PID::ID* ids, const int nIds, float* expSignal, float* expSigma, float* nSigma) const;
 
   void PrintAll() const;
 
@@ -98,6 +105,9 @@ class Response
   bool mUseDefaultResolutionParam = true;
   float nClNorm = 152.f;
 
+  /// Parametrised resolution for a given normalised dE/dx (without the MIP factor), shared by the single and the bulk evaluation
+  float GetExpectedSigmaParametrized(const double dEdx, const double p, const double mass, const float charge, const float nCls, const float tgl, const float signed1Pt, const float multTPC) const;
+
   ClassDefNV(Response, 3);
 
 }; // class Response
@@ -125,18 +135,10 @@ inline float Response::GetExpectedSigma(const CollisionType& collision, const Tr
     const float reso = GetExpectedSignal(track, id) * mResolutionParamsDefault[0] * (static_cast<float>(track.tpcNClsFound()) > 0 ? std::sqrt(1. + mResolutionParamsDefault[1] / static_cast<float>(track.tpcNClsFound())) : 1.f);
     reso >= 0.f ? resolution = reso : resolution = -999.f;
   } else {
-
-    const double ncl = nClNorm / track.tpcNClsFound(); //
-    const double p = track.tpcInnerParam();
     const double mass = o2::track::pid_constants::sMasses[id];
-    const double bg = p / mass;
-    const double dEdx = o2::tpc::BetheBlochAleph(static_cast<float>(bg), mBetheBlochParams[0], mBetheBlochParams[1], mBetheBlochParams[2], mBetheBlochParams[3], mBetheBlochParams[4]) * std::pow(static_cast<float>(o2::track::pid_constants::sCharges[id]), mChargeFactor);
-    const double relReso = GetRelativeResolutiondEdx(p, mass, o2::track::pid_constants::sCharges[id], mResolutionParams[3]);
-
-    const std::vector<double> values{1.f / dEdx, track.tgl(), std::sqrt(ncl), relReso, track.signed1Pt(), collision.multTPC() / mMultNormalization};
-
-    const float reso = sqrt(pow(mResolutionParams[0], 2) * values[0] + pow(mResolutionParams[1], 2) * (values[2] * mResolutionParams[5]) * pow(values[0] / sqrt(1 + pow(values[1], 2)), mResolutionParams[2]) + values[2] * pow(values[3], 2) + pow(mResolutionParams[4] * values[4], 2) + pow(values[5] * mResolutionParams[6], 2) + pow(values[5] * (values[0] / sqrt(1 + pow(values[1], 2))) * mResolutionParams[7], 2)) * dEdx * mMIP;
-    reso >= 0.f ? resolution = reso : resolution = -999.f;
+    const float charge = o2::track::pid_constants::sCharges[id];
+    const double dEdx = o2::tpc::BetheBlochAleph(static_cast<float>(track.tpcInnerParam() / mass), mBetheBlochParams[0], mBetheBlochParams[1], mBetheBlochParams[2], mBetheBlochParams[3], mBetheBlochParams[4]) * std::pow(charge, mChargeFactor);
+    resolution = GetExpectedSigmaParametrized(dEdx, track.tpcInnerParam(), mass, charge, track.tpcNClsFound(), track.tgl(), track.signed1Pt(), collision.multTPC());
   }
   return resolution;
 }
@@ -145,44 +147,49 @@ inline float Response::GetExpectedSigma(const CollisionType& collision, const Tr
 template <typename CollisionType, typename TrackType>
 inline float Response::GetNumberOfSigma(const CollisionType& collision, const TrackType& trk, const o2::track::PID::ID id) const
 {
-  if (GetExpectedSigma(collision, trk, id) < 0.) {
+  if (!trk.hasTPC()) {
     return -999.f;
   }
-  if (GetExpectedSignal(trk, id) < 0.) {
+  const float expSignal = GetExpectedSignal(trk, id);
+  if (expSignal < 0.) {
     return -999.f;
   }
-  if (!trk.hasTPC()) {
+  const float expSigma = GetExpectedSigma(collision, trk, id);
+  if (expSigma < 0.) {
     return -999.f;
   }
-  return ((trk.tpcSignal() - GetExpectedSignal(trk, id)) / GetExpectedSigma(collision, trk, id));
+  return ((trk.tpcSignal() - expSignal) / expSigma);
 }
 
 template <typename CollisionType, typename TrackType>
 inline float Response::GetNumberOfSigmaMCTuned(const CollisionType& collision, const TrackType& trk, const o2::track::PID::ID id, float mcTunedTPCSignal) const
 {
-  if (GetExpectedSigma(collision, trk, id) < 0.) {
+  if (!trk.hasTPC()) {
     return -999.f;
   }
-  if (GetExpectedSignal(trk, id) < 0.) {
+  const float expSignal = GetExpectedSignal(trk, id);
+  if (expSignal < 0.) {
     return -999.f;
   }
-  if (!trk.hasTPC()) {
+  const float expSigma = GetExpectedSigma(collision, trk, id);
+  if (expSigma < 0.) {
     return -999.f;
   }
-  return ((mcTunedTPCSignal - GetExpectedSignal(trk, id)) / GetExpectedSigma(collision, trk, id));
+  return ((mcTunedTPCSignal - expSignal) / expSigma);
 }
 
 /// Gets the deviation between the actual signal and the expected signal
 template <typename TrackType>
 inline float Response::GetSignalDelta(const TrackType& trk, const o2::track::PID::ID id) const
 {
-  if (GetExpectedSignal(trk, id) < 0.) {
+  if (!trk.hasTPC()) {
     return -999.f;
   }
-  if (!trk.hasTPC()) {
+  const float expSignal = GetExpectedSignal(trk, id);
+  if (expSignal < 0.) {
     return -999.f;
   }
-  return (trk.tpcSignal() - GetExpectedSignal(trk, id));
+  return (trk.tpcSignal() - expSignal);
 }
 
 //// Gets relative dEdx resolution contribution due relative pt resolution
@@ -197,6 +204,64 @@ inline float Response::GetRelativeResolutiondEdx(const float p, const float mass
   return deltaRel;
 }
 
+/// Gets the parametrised resolution from the per-track inputs
+inline float Response::GetExpectedSigmaParametrized(const double dEdx, const double p, const double mass, const float charge, const float nCls, const float tgl, const float signed1Pt, const float multTPC) const
+{
+  const double ncl = nClNorm / nCls;
+  const double relReso = GetRelativeResolutiondEdx(p, mass, charge, mResolutionParams[3]);
+  const double invdEdx = 1.f / dEdx;
+  const double sqrtNcl = std::sqrt(ncl);
+  const double mult = multTPC / mMultNormalization;
+  const double invdEdxTgl = invdEdx / sqrt(1 + pow(tgl, 2));
+
+  const float reso = sqrt(pow(mResolutionParams[0], 2) * invdEdx + pow(mResolutionParams[1], 2) * (sqrtNcl * mResolutionParams[5]) * pow(invdEdxTgl, mResolutionParams[2]) + sqrtNcl * pow(relReso, 2) + pow(mResolutionParams[4] * signed1Pt, 2) + pow(mult * mResolutionParams[6], 2) + pow(mult * invdEdxTgl * mResolutionParams[7], 2)) * dEdx * mMIP;
+  return reso >= 0.f ? reso : -999.f;
+}
+
+/// Gets expected signal, resolution and number of sigmas for several mass hypotheses.
+/// Each step runs over contiguous per-hypothesis arrays so that the loops can be vectorised across species
+inline void Response::GetNumberOfSigmaBulk(const float p, const float tpcSignal, const float nCls, const float tgl, const float signed1Pt, const float multTPC,
+                                           const o2::track::PID::ID* ids, const int nIds, float* expSignal, float* expSigma, float* nSigma) const
+{
+  // Normalised Bethe-Bloch, stored temporarily in the resolution array
+  for (int i = 0; i < nIds; i++) {
+    expSigma[i] = o2::tpc::BetheBlochAleph(p / o2::track::pid_constants::sMasses[ids[i]], mBetheBlochParams[0], mBetheBlochParams[1], mBetheBlochParams[2], mBetheBlochParams[3], mBetheBlochParams[4]) * std::pow(static_cast<float>(o2::track::pid_constants::sCharges[ids[i]]), mChargeFactor);
+  }
+  for (int i = 0; i < nIds; i++) {
+    const float bethe = mMIP * expSigma[i];
+    expSignal[i] = bethe >= 0.f ? bethe : -999.f;
+  }
+  if (mUseDefaultResolutionParam) {
+    // The cluster term does not depend on the mass hypothesis
+    const float clusterTerm = mResolutionParamsDefault[0] * (nCls > 0 ? std::sqrt(1. + mResolutionParamsDefault[1] / nCls) : 1.f);
+    for (int i = 0; i < nIds; i++) {
+      const float reso = expSignal[i] * clusterTerm;
+      expSigma[i] = reso >= 0.f ? reso : -999.f;
+    }
+  } else {
+    for (int i = 0; i < nIds; i++) {
+      expSigma[i] = GetExpectedSigmaParametrized(expSigma[i], p, o2::track::pid_constants::sMasses[ids[i]], o2::track::pid_constants::sCharges[ids[i]], nCls, tgl, signed1Pt, multTPC);
+    }
+  }
+  for (int i = 0; i < nIds; i++) {
+    nSigma[i] = (expSignal[i] < 0.f || expSigma[i] < 0.f) ? -999.f : (tpcSignal - expSignal[i]) / expSigma[i];
+  }
+}
+
+template <typename CollisionType, typename TrackType>
+inline void Response::GetNumberOfSigmaBulk(const CollisionType& collision, const TrackType& trk, const o2::track::PID::ID* ids, const int nIds, float* expSignal, float* expSigma, float* nSigma) const
+{
+  if (!trk.hasTPC()) {
+    for (int i = 0; i < nIds; i++) {
+      expSignal[i] = -999.f;
+      expSigma[i] = -999.f;
+      nSigma[i] = -999.f;
+    }
+    return;
+  }
+  GetNumberOfSigmaBulk(trk.tpcInnerParam(), trk.tpcSignal(), trk.tpcNClsFound(), trk.tgl(), trk.signed1Pt(), collision.multTPC(), ids, nIds, expSignal, expSigma, nSigma);
+}
+
 inline void Response::PrintAll() const
 {
   LOGP(info, "==== TPC PID response parameters: ====");
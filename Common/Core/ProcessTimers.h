@@ -0,0 +1,215 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   ProcessTimers.h
+/// \brief  Opt-in timers, counters and heap deltas of the process functions of a task and of their stages,
+///         aggregated per dataframe and exported as histograms of the HistogramRegistry of the task
+///
+
+#ifndef COMMON_CORE_PROCESSTIMERS_H_
+#define COMMON_CORE_PROCESSTIMERS_H_
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+#define O2PHYSICS_PROCESS_TIMERS_HEAP 1
+#endif
+
+#include "Framework/HistogramRegistry.h"
+
+/// Timers of the stages of a task (typically the process functions and their main steps).
+///
+/// The scopes are only compiled in with -DO2PHYSICS_PROCESS_TIMERS: otherwise O2_PROCESS_TIMERS_DF and
+/// O2_PROCESS_TIMER expand to nothing and init() books no histogram, so that the instrumentation can stay
+/// in the code of production tasks. When compiled in, the timers are also enabled at run time by init().
+///
+/// For each stage the histograms hold the total time in ms, the number of calls, the user counts and the
+/// change of the heap in use in kB (glibc only), summed over the dataframes, and the time per dataframe.
+///
+/// Usage:
+///   processTimers.init(registry, {"processRun3", "buildV0s"}, cfgEnableTimers);
+///   void processRun3(...)
+///   {
+///     O2_PROCESS_TIMERS_DF(processTimers);
+///     O2_PROCESS_TIMER(processTimers, 0);
+///     ...
+///     {
+///       O2_PROCESS_TIMER(processTimers, 1);
+///       ... build ...
+///       processTimers.count(1, nBuilt);
+///     }
+///   }
+class ProcessTimers
+{
+ public:
+#ifdef O2PHYSICS_PROCESS_TIMERS
+  static constexpr bool kCompiledIn = true;
+#else
+  static constexpr bool kCompiledIn = false;
+#endif
+
+  /// Books the histograms in the directory of the registry, if compiled in and enabled
+  void init(o2::framework::HistogramRegistry& registry, const std::vector<std::string>& stages, bool enabled, const std::string& directory = "ProcessTimers")
+  {
+    mEnabled = kCompiledIn && enabled;
+    if (!mEnabled) {
+      return;
+    }
+    const int nStages = stages.size();
+    mStages.assign(nStages, Stage{});
+    const o2::framework::AxisSpec axisStage{nStages, -0.5, nStages - 0.5, "stage"};
+    const o2::framework::AxisSpec axisTimePerDF{100, -3., 5., "log_{10}(time per dataframe / ms)"};
+    mHTime = registry.add<TH1>((directory + "/hTime").c_str(), "total time;stage;ms", o2::framework::kTH1D, {axisStage}).get();
+    mHCalls = registry.add<TH1>((directory + "/hCalls").c_str(), "calls;stage;calls", o2::framework::kTH1D, {axisStage}).get();
+    mHCounts = registry.add<TH1>((directory + "/hCounts").c_str(), "user counts;stage;counts", o2::framework::kTH1D, {axisStage}).get();
+    mHHeap = registry.add<TH1>((directory + "/hHeapDelta").c_str(), "change of the heap in use;stage;kB", o2::framework::kTH1D, {axisStage}).get();
+    mHTimePerDF = registry.add<TH2>((directory + "/hTimePerDF").c_str(), "time per dataframe", o2::framework::kTH2D, {axisStage, axisTimePerDF}).get();
+    for (auto* h : {mHTime, mHCalls, mHCounts, mHHeap, static_cast<TH1*>(mHTimePerDF)}) {
+      for (int i = 0; i < nStages; ++i) {
+        h->GetXaxis()->SetBinLabel(i + 1, stages[i].c_str());
+      }
+    }
+  }
+
+  bool isEnabled() const { return mEnabled; }
+
+  /// Counts of a stage, e.g. the number of candidates built
+  void count(int stage, int64_t n = 1)
+  {
+    if (mEnabled) {
+      mStages[stage].counts += n;
+    }
+  }
+
+  void start(int stage)
+  {
+    auto& s = mStages[stage];
+    s.start = std::chrono::steady_clock::now();
+    s.heapAtStart = heapInUse();
+  }
+
+  void stop(int stage)
+  {
+    auto& s = mStages[stage];
+    s.ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s.start).count();
+    s.heapDelta += heapInUse() - s.heapAtStart;
+    ++s.calls;
+  }
+
+  /// Fills the histograms with the sums of the dataframe and resets them
+  void endDataFrame()
+  {
+    for (std::size_t i = 0; i < mStages.size(); ++i) {
+      auto& s = mStages[i];
+      if (s.calls == 0 && s.counts == 0) {
+        continue;
+      }
+      const double ms = 1.e-6 * s.ns;
+      mHTime->Fill(i, ms);
+      mHCalls->Fill(i, s.calls);
+      mHCounts->Fill(i, s.counts);
+      mHHeap->Fill(i, s.heapDelta / 1024.);
+      if (s.calls > 0) {
+        mHTimePerDF->Fill(i, std::log10(ms > 1.e-3 ? ms : 1.e-3));
+      }
+      s = Stage{};
+    }
+  }
+
+  /// Time, heap delta and call of a stage, for the lifetime of the scope
+  class Scope
+  {
+   public:
+    Scope(ProcessTimers& timers, int stage) : mTimers(timers.mEnabled ? &timers : nullptr), mStage(stage)
+    {
+      if (mTimers) {
+        mTimers->start(mStage);
+      }
+    }
+    ~Scope()
+    {
+      if (mTimers) {
+        mTimers->stop(mStage);
+      }
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    ProcessTimers* mTimers;
+    int mStage;
+  };
+
+  /// Calls endDataFrame() at the end of the scope, e.g. of a process function
+  class DataFrame
+  {
+   public:
+    explicit DataFrame(ProcessTimers& timers) : mTimers(timers.mEnabled ? &timers : nullptr) {}
+    ~DataFrame()
+    {
+      if (mTimers) {
+        mTimers->endDataFrame();
+      }
+    }
+    DataFrame(const DataFrame&) = delete;
+    DataFrame& operator=(const DataFrame&) = delete;
+
+   private:
+    ProcessTimers* mTimers;
+  };
+
+ private:
+  struct Stage {
+    std::chrono::steady_clock::time_point start{};
+    int64_t ns = 0;
+    int64_t calls = 0;
+    int64_t counts = 0;
+    int64_t heapAtStart = 0;
+    int64_t heapDelta = 0;
+  };
+
+  static int64_t heapInUse()
+  {
+#ifdef O2PHYSICS_PROCESS_TIMERS_HEAP
+    return static_cast<int64_t>(mallinfo2().uordblks);
+#else
+    return 0;
+#endif
+  }
+
+  bool mEnabled = false;
+  std::vector<Stage> mStages;
+  TH1* mHTime = nullptr;
+  TH1* mHCalls = nullptr;
+  TH1* mHCounts = nullptr;
+  TH1* mHHeap = nullptr;
+  TH2* mHTimePerDF = nullptr;
+};
+
+#define O2_PROCESS_TIMERS_CONCAT_(a, b) a##b
+#define O2_PROCESS_TIMERS_CONCAT(a, b) O2_PROCESS_TIMERS_CONCAT_(a, b)
+
+#ifdef O2PHYSICS_PROCESS_TIMERS
+#define O2_PROCESS_TIMERS_DF(timers) ProcessTimers::DataFrame O2_PROCESS_TIMERS_CONCAT(processTimersDF, __LINE__)(timers)
+#define O2_PROCESS_TIMER(timers, stage) ProcessTimers::Scope O2_PROCESS_TIMERS_CONCAT(processTimer, __LINE__)(timers, stage)
+#else
+#define O2_PROCESS_TIMERS_DF(timers)
+#define O2_PROCESS_TIMER(timers, stage)
+#endif
+
+#endif // COMMON_CORE_PROCESSTIMERS_H_
@@ -0,0 +1,114 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   QaPrescale.h
+/// \brief  Event prescaling of a group of QA histograms once a reference histogram of the group is saturated,
+///         i.e. its bins have reached a given relative statistical uncertainty
+///
+
+#ifndef COMMON_CORE_QAPRESCALE_H_
+#define COMMON_CORE_QAPRESCALE_H_
+
+#include <TH1.h>
+
+#include <cmath>
+#include <cstdint>
+
+#include "Common/Core/CounterRng.h"
+
+/// Prescale of the fills of one group of histograms.
+///
+/// All the events are accepted until the reference histogram of the group is saturated: the bins with a
+/// relative uncertainty 1 / sqrt(n) below maxRelError hold at least a fraction 1 - tailFraction of the
+/// entries (the sparsely populated tails do not prevent the saturation). From then on an event is accepted
+/// with the probability 1 / prescale. The choice is a hash of the seed, the event key and the group, so
+/// that it is the same in every run over the same input and independent of the other groups.
+/// The saturation is checked every checkInterval accepted events. The numbers of seen and accepted events
+/// are kept for the normalisation (e.g. in a bookkeeping histogram).
+///
+/// Usage:
+///   prescale.init(1, cfgPrescale, cfgMaxRelError);
+///   prescale.setReference(registry.get<TH1>(HIST("Tracks/Kine/pt")).get());
+///   if (prescale.accept(collision.globalIndex())) { ... fill the histograms of the group ... }
+class QaPrescale
+{
+ public:
+  /// prescale <= 1 disables the prescaling
+  void init(uint64_t group, int prescale, double maxRelError, double tailFraction = 0.01, int64_t checkInterval = 1000, uint64_t seed = 0)
+  {
+    mGroup = group;
+    mPrescale = prescale;
+    mMinContent = maxRelError > 0. ? 1. / (maxRelError * maxRelError) : 0.;
+    mTailFraction = tailFraction;
+    mCheckInterval = checkInterval > 0 ? checkInterval : 1;
+    mSeed = seed;
+    mSaturated = false;
+    mNSeen = 0;
+    mNAccepted = 0;
+  }
+
+  void setReference(const TH1* h) { mReference = h; }
+
+  /// Whether the histograms of the group are filled for the event
+  bool accept(uint64_t eventKey)
+  {
+    ++mNSeen;
+    if (mPrescale <= 1) {
+      ++mNAccepted;
+      return true;
+    }
+    if (mSaturated) {
+      CounterRng rng(mSeed, eventKey, mGroup);
+      if (rng.uniform() * mPrescale >= 1.) {
+        return false;
+      }
+    } else if (mReference != nullptr && mNAccepted % mCheckInterval == 0) {
+      mSaturated = isSaturated();
+    }
+    ++mNAccepted;
+    return true;
+  }
+
+  bool isSaturated() const
+  {
+    const double total = mReference->GetEntries();
+    if (total <= 0.) {
+      return false;
+    }
+    double precise = 0.;
+    for (int bin = 0; bin < mReference->GetNcells(); ++bin) {
+      const double content = mReference->GetBinContent(bin);
+      if (content >= mMinContent) {
+        precise += content;
+      }
+    }
+    return precise >= (1. - mTailFraction) * total;
+  }
+
+  bool saturated() const { return mSaturated; }
+  int64_t nSeen() const { return mNSeen; }
+  int64_t nAccepted() const { return mNAccepted; }
+
+ private:
+  const TH1* mReference = nullptr;
+  uint64_t mGroup = 0;
+  int mPrescale = 1;
+  double mMinContent = 0.; // entries of a bin with the maximum relative uncertainty
+  double mTailFraction = 0.01;
+  int64_t mCheckInterval = 1000;
+  uint64_t mSeed = 0;
+  bool mSaturated = false;
+  int64_t mNSeen = 0;
+  int64_t mNAccepted = 0;
+};
+
+#endif // COMMON_CORE_QAPRESCALE_H_
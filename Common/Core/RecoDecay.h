@@ -26,6 +26,8 @@
 #include "TMCProcess.h" // for VMC Particle Production Process
 #include "CommonConstants/MathConstants.h"
 
+#include "Common/Core/McDecayTree.h"
+
 /// Base class for calculating properties of reconstructed decays
 ///
 /// Provides static helper functions for:
@@ -782,6 +784,107 @@ struct RecoDecay {
     return indexMother;
   }
 
+  /// Checks whether the reconstructed decay candidate is the expected decay, using the decay-tree index of the dataframe.
+  /// Same as getMatchedMCRec with the MC particle table, without table iterators and heap allocations in the traversal.
+  /// \param checkProcess  switch to accept only decay daughters by checking the production process of MC particles
+  /// \param mcDecayTree  decay-tree index built from the table with MC particles
+  /// \param arrDaughters  array of candidate daughters
+  /// \param PDGMother  expected mother PDG code
+  /// \param arrPDGDaughters  array of expected daughter PDG codes
+  /// \param acceptAntiParticles  switch to accept the antiparticle version of the expected decay
+  /// \param sign  antiparticle indicator of the found mother w.r.t. PDGMother; 1 if particle, -1 if antiparticle, 0 if mother not found
+  /// \param depthMax  maximum decay tree level to check; Daughters up to this level will be considered. If -1, all levels are considered.
+  /// \return index of the mother particle if the mother and daughters are correct, -1 otherwise
+  template <bool acceptFlavourOscillation = false, bool checkProcess = false, std::size_t N, typename U>
+  static int getMatchedMCRec(const McDecayTree& mcDecayTree,
+                             const std::array<U, N>& arrDaughters,
+                             int PDGMother,
+                             std::array<int, N> arrPDGDaughters,
+                             bool acceptAntiParticles = false,
+                             int8_t* sign = nullptr,
+                             int depthMax = 1)
+  {
+    int8_t coefFlavourOscillation = 1;                        // 1 if no B0(s) flavour oscillation occured, -1 else
+    int8_t sgn = 0;                                           // 1 if the expected mother is particle, -1 if antiparticle (w.r.t. PDGMother)
+    int indexMother = -1;                                     // index of the mother particle
+    auto& arrAllDaughtersIndex = mcDecayTree.bufferDaughters; // indices of all daughters of the mother of the first provided daughter
+    std::array<int, N> arrDaughtersIndex;                     // array of indices of provided daughters
+    if (sign) {
+      *sign = sgn;
+    }
+    for (std::size_t iProng = 0; iProng < N; ++iProng) {
+      if (!arrDaughters[iProng].has_mcParticle()) {
+        return -1;
+      }
+      arrDaughtersIndex[iProng] = arrDaughters[iProng].mcParticleId();
+    }
+    if constexpr (acceptFlavourOscillation) {
+      // Loop over decay candidate prongs to spot possible oscillation decay product
+      for (auto indexDaughterI : arrDaughtersIndex) {
+        if (std::abs(mcDecayTree.genStatusCode(indexDaughterI)) == PdgStatusCodeAfterFlavourOscillation) { // oscillation decay product spotted
+          coefFlavourOscillation = -1;                                                                     // select the sign of the mother after oscillation (and not before)
+          break;
+        }
+      }
+    }
+    // Get the mother index and its sign.
+    // PDG code of the first daughter's mother determines whether the expected mother is a particle or antiparticle.
+    indexMother = mcDecayTree.getMother(arrDaughtersIndex[0], PDGMother, acceptAntiParticles, &sgn, depthMax);
+    if (indexMother <= -1) {
+      return -1;
+    }
+    // Check the daughter indices.
+    if (!mcDecayTree.hasDaughters(indexMother)) {
+      return -1;
+    }
+    // Check that the number of direct daughters is not larger than the number of expected final daughters.
+    if constexpr (!checkProcess) {
+      if (mcDecayTree.lastDaughter(indexMother) - mcDecayTree.firstDaughter(indexMother) + 1 > static_cast<int>(N)) {
+        return -1;
+      }
+    }
+    // Get the list of actual final daughters.
+    arrAllDaughtersIndex.clear();
+    mcDecayTree.getDaughters<checkProcess>(indexMother, &arrAllDaughtersIndex, arrPDGDaughters, depthMax);
+    // Check whether the number of actual final daughters is equal to the number of expected final daughters (i.e. the number of provided prongs).
+    if (arrAllDaughtersIndex.size() != N) {
+      return -1;
+    }
+    // Loop over decay candidate prongs
+    for (std::size_t iProng = 0; iProng < N; ++iProng) {
+      // Check that the daughter is in the list of final daughters.
+      // (Check that the daughter is not a stepdaughter, i.e. particle pointing to the mother while not being its daughter.)
+      bool isDaughterFound = false; // Is the index of this prong among the remaining expected indices of daughters?
+      for (std::size_t iD = 0; iD < arrAllDaughtersIndex.size(); ++iD) {
+        if (arrDaughtersIndex[iProng] == arrAllDaughtersIndex[iD]) {
+          arrAllDaughtersIndex[iD] = -1; // Remove this index from the array of expected daughters. (Rejects twin daughters, i.e. particle considered twice as a daughter.)
+          isDaughterFound = true;
+          break;
+        }
+      }
+      if (!isDaughterFound) {
+        return -1;
+      }
+      // Check daughter's PDG code.
+      auto PDGParticleI = mcDecayTree.pdgCode(arrDaughtersIndex[iProng]); // PDG code of the ith daughter
+      bool isPDGFound = false;                                            // Is the PDG code of this daughter among the remaining expected PDG codes?
+      for (std::size_t iProngCp = 0; iProngCp < N; ++iProngCp) {
+        if (PDGParticleI == coefFlavourOscillation * sgn * arrPDGDaughters[iProngCp]) {
+          arrPDGDaughters[iProngCp] = 0; // Remove this PDG code from the array of expected ones.
+          isPDGFound = true;
+          break;
+        }
+      }
+      if (!isPDGFound) {
+        return -1;
+      }
+    }
+    if (sign) {
+      *sign = sgn;
+    }
+    return indexMother;
+  }
+
   /// Checks whether the MC particle is the expected one.
   /// \param checkProcess  switch to accept only decay daughters by checking the production process of MC particles
   /// \param particlesMC  table with MC particles
@@ -0,0 +1,91 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   ReverseIndex.h
+/// \brief  Reverse of an index column (e.g. particle to tracks from the MC track labels) in a flat
+///         compressed-row layout, for the array-index tables of the MC tasks
+///
+
+#ifndef COMMON_CORE_REVERSEINDEX_H_
+#define COMMON_CORE_REVERSEINDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/// Rows of a labelled table (e.g. tracks) grouped by the row of the table they point to (e.g. McParticles).
+///
+/// build() makes two passes over the labelled table: the rows per target are counted, then the row indices
+/// are scattered into one flat array, in the order of the labelled table. No memory is allocated per target
+/// and the object can be kept as a data member and rebuilt for each dataframe to reuse its memory.
+///
+/// Usage, with the array-index table aod::ParticlesToTracks:
+///   reverse.build(mcParticles.size(), tracks, [](auto const& track) { return track.has_mcParticle() ? track.mcParticleId() : -1; });
+///   reverse.produce(p2t);
+class ReverseIndex
+{
+ public:
+  /// label(row) returns the target row of a labelled row, a negative value (or a value >= nTargets) if none
+  template <typename TLabelled, typename F>
+  void build(std::size_t nTargets, TLabelled const& labelled, F&& label)
+  {
+    mOffsets.assign(nTargets + 1, 0);
+    for (auto const& row : labelled) {
+      const auto target = label(row);
+      if (target >= 0 && static_cast<std::size_t>(target) < nTargets) {
+        ++mOffsets[target + 1];
+      }
+    }
+    for (std::size_t i = 0; i < nTargets; ++i) {
+      mOffsets[i + 1] += mOffsets[i];
+    }
+    mRows.resize(mOffsets[nTargets]);
+    mFill.assign(mOffsets.begin(), mOffsets.end() - 1);
+    for (auto const& row : labelled) {
+      const auto target = label(row);
+      if (target >= 0 && static_cast<std::size_t>(target) < nTargets) {
+        mRows[mFill[target]++] = row.globalIndex();
+      }
+    }
+  }
+
+  std::size_t nTargets() const { return mOffsets.empty() ? 0 : mOffsets.size() - 1; }
+
+  /// Labelled rows pointing to the target row
+  std::span<const int> get(std::size_t target) const
+  {
+    return {mRows.data() + mOffsets[target], static_cast<std::size_t>(mOffsets[target + 1] - mOffsets[target])};
+  }
+
+  std::size_t size(std::size_t target) const { return mOffsets[target + 1] - mOffsets[target]; }
+
+  /// Writes one row per target (in the order of the target table) with a cursor of an array-index table
+  template <typename TCursor>
+  void produce(TCursor& cursor)
+  {
+    cursor.reserve(nTargets());
+    for (std::size_t target = 0; target < nTargets(); ++target) {
+      const auto rows = get(target);
+      mScratch.assign(rows.begin(), rows.end());
+      cursor(mScratch);
+    }
+  }
+
+ private:
+  std::vector<int64_t> mOffsets; // nTargets + 1 offsets into mRows
+  std::vector<int> mRows;        // labelled rows, grouped by target
+  std::vector<int64_t> mFill;    // scatter positions, used by build()
+  std::vector<int> mScratch;     // row of the array-index column, reused by produce()
+};
+
+#endif // COMMON_CORE_REVERSEINDEX_H_
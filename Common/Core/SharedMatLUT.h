@@ -0,0 +1,162 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file SharedMatLUT.h
+/// \brief Material LUT shared by all devices of a node through a memory-mapped file
+///
+/// The first device dumps the flat buffer of the o2::base::MatLayerCylSet downloaded from CCDB into a file named
+/// after the CCDB path and ETag of the object (typically in /dev/shm). The other devices map this file privately:
+/// the cell data stay in the page cache shared by the whole node, only the few pages holding the internal pointers
+/// of the layers are copied when the pointers are relocated to the mapping address.
+
+#ifndef COMMON_CORE_SHAREDMATLUT_H_
+#define COMMON_CORE_SHAREDMATLUT_H_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <string>
+
+#include <fmt/format.h>
+
+#include "CCDB/BasicCCDBManager.h"
+#include "DetectorsBase/MatLayerCylSet.h"
+#include "Framework/Logger.h"
+
+namespace o2::common::matlut
+{
+
+struct FileHeader {
+  static constexpr uint32_t Magic = 0x4d4c5554; // "MLUT"
+  static constexpr uint32_t Version = 1;
+  static constexpr uint64_t Alignment = 64;
+
+  uint32_t magic = Magic;
+  uint32_t version = Version;
+  uint64_t objectSize = 0;   // size of the MatLayerCylSet object, stored right after the header
+  uint64_t bufferOffset = 0; // offset of the flat buffer from the start of the file
+  uint64_t bufferSize = 0;
+};
+
+inline uint64_t alignedSize(uint64_t size)
+{
+  return (size + FileHeader::Alignment - 1) / FileHeader::Alignment * FileHeader::Alignment;
+}
+
+/// Name of the shared file, unique for a given version of the CCDB object
+inline std::string sharedFileName(std::string const& directory, std::string const& path, std::string const& etag)
+{
+  return fmt::format("{}/matlut_{:016x}.bin", directory, std::hash<std::string>{}(path + "@" + etag));
+}
+
+/// Writes the LUT into the shared file, a temporary file is renamed at the end so that no device maps a partial file
+inline bool writeSharedFile(o2::base::MatLayerCylSet const& lut, std::string const& fileName)
+{
+  FileHeader header;
+  header.objectSize = sizeof(o2::base::MatLayerCylSet);
+  header.bufferOffset = alignedSize(alignedSize(sizeof(FileHeader)) + header.objectSize);
+  header.bufferSize = lut.getFlatBufferSize();
+
+  std::string tmpName = fmt::format("{}.{}.tmp", fileName, getpid());
+  std::ofstream out(tmpName, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    LOGP(warn, "Cannot create the shared material LUT file {}", tmpName);
+    return false;
+  }
+  const char padding[FileHeader::Alignment] = {0};
+  out.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+  out.write(padding, alignedSize(sizeof(FileHeader)) - sizeof(FileHeader));
+  out.write(reinterpret_cast<const char*>(&lut), header.objectSize);
+  out.write(padding, header.bufferOffset - alignedSize(sizeof(FileHeader)) - header.objectSize);
+  out.write(lut.getFlatBufferPtr(), header.bufferSize);
+  out.close();
+  if (!out || std::rename(tmpName.c_str(), fileName.c_str()) != 0) {
+    LOGP(warn, "Cannot write the shared material LUT file {}", fileName);
+    std::remove(tmpName.c_str());
+    return false;
+  }
+  return true;
+}
+
+/// Maps the shared file and returns a LUT whose flat buffer lives in the mapping, nullptr if the file is not usable.
+/// The mapping is kept for the lifetime of the process.
+inline o2::base::MatLayerCylSet* attachSharedFile(std::string const& fileName)
+{
+  int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return nullptr;
+  }
+  struct stat status;
+  if (fstat(fd, &status) != 0 || static_cast<uint64_t>(status.st_size) < sizeof(FileHeader)) {
+    close(fd);
+    return nullptr;
+  }
+  void* mapping = mmap(nullptr, status.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    LOGP(warn, "Cannot map the shared material LUT file {}", fileName);
+    return nullptr;
+  }
+  char* base = static_cast<char*>(mapping);
+  FileHeader header;
+  std::memcpy(&header, base, sizeof(FileHeader));
+  if (header.magic != FileHeader::Magic || header.version != FileHeader::Version || header.objectSize != sizeof(o2::base::MatLayerCylSet) ||
+      header.bufferOffset + header.bufferSize != static_cast<uint64_t>(status.st_size)) {
+    LOGP(warn, "Shared material LUT file {} is not compatible, ignoring it", fileName);
+    munmap(mapping, status.st_size);
+    return nullptr;
+  }
+  // relocate the pointers of the stored object to the mapping, then clone it without copying the buffer
+  auto* stored = reinterpret_cast<o2::base::MatLayerCylSet*>(base + alignedSize(sizeof(FileHeader)));
+  char* buffer = base + header.bufferOffset;
+  stored->setActualBufferAddress(buffer);
+  auto* lut = new o2::base::MatLayerCylSet();
+  lut->cloneFromObject(*stored, buffer);
+  return lut;
+}
+
+/// Material LUT from CCDB. With an empty directory it is loaded in the heap of the device as before, otherwise it
+/// is attached from (or, for the first device of the node, written to) the shared file of the current CCDB version.
+inline o2::base::MatLayerCylSet* getMatLUT(o2::ccdb::BasicCCDBManager* ccdb, std::string const& path, std::string const& directory)
+{
+  if (directory.empty()) {
+    return o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(path));
+  }
+  std::map<std::string, std::string> metadata;
+  auto headers = ccdb->getCCDBAccessor().retrieveHeaders(path, metadata, ccdb->getTimestamp());
+  auto etag = headers.find("ETag");
+  if (etag == headers.end()) {
+    LOGP(warn, "No ETag for {}, loading the material LUT without sharing it", path);
+    return o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(path));
+  }
+  std::string fileName = sharedFileName(directory, path, etag->second);
+  if (auto* lut = attachSharedFile(fileName)) {
+    LOGP(info, "Attached the material LUT from the shared file {}", fileName);
+    return lut;
+  }
+  auto* lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(path));
+  if (writeSharedFile(*lut, fileName)) {
+    LOGP(info, "Wrote the material LUT to the shared file {}", fileName);
+  }
+  return lut;
+}
+
+} // namespace o2::common::matlut
+
+#endif // COMMON_CORE_SHAREDMATLUT_H_
@@ -0,0 +1,213 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   SparseHistogram.h
+/// \brief  Hashed accumulator for the THnSparse of a HistogramRegistry, with the bin coordinates of a fill
+///         packed in a 64-bit key of an open-addressing table and added to the THnSparse once per bin
+///
+
+#ifndef COMMON_CORE_SPARSEHISTOGRAM_H_
+#define COMMON_CORE_SPARSEHISTOGRAM_H_
+
+#include <THnBase.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Common/Core/DenseHistogram.h"
+
+/// Contents of a THnSparse (or THn) accumulated in a hash table keyed by the packed bin coordinates and
+/// added to the histogram by flush(), together with the entries.
+///
+/// A fill is the bin search of every axis (DenseAxis), the packing of the bins in a 64-bit key and a
+/// lookup with linear probing in a power-of-two table, instead of THnSparse::Fill with its coordinate
+/// compression and chunk lookup for every fill. The distinct bins are added once per flush, so that the
+/// cost of the THnSparse is paid per filled bin and not per fill. The table is flushed by itself when it
+/// holds maxBins bins, which bounds its memory.
+///
+/// If the bins of all the axes (with under- and overflow) do not fit in 63 bits, the accumulator stays
+/// inactive and fill() forwards to THnBase::Fill. The sums of w*x and w*x^2 of THnBase are not updated
+/// (they are not accessible from outside), the projections and the contents are the same as with Fill.
+///
+/// Usage:
+///   hUnlike.init(registry.get<THnSparse>(HIST("unlikepm")).get());
+///   hUnlike.fill(point);
+///   ...
+///   hUnlike.flush(); // e.g. at the end of each process()
+class SparseHistogram
+{
+ public:
+  static constexpr std::size_t kDefaultMaxBins = 1 << 20;
+
+  /// Takes the binning of the histogram, returns whether the bins can be packed in a key
+  bool init(THnBase* h, std::size_t maxBins = kDefaultMaxBins)
+  {
+    mHist = h;
+    mActive = false;
+    const int nDim = h->GetNdimensions();
+    mAxes.resize(nDim);
+    mShifts.resize(nDim);
+    mBits.resize(nDim);
+    mCoords.resize(nDim);
+    int nBitsTotal = 0;
+    for (int i = 0; i < nDim; ++i) {
+      mAxes[i].set(h->GetAxis(i));
+      int nBits = 1;
+      while ((static_cast<uint64_t>(1) << nBits) < static_cast<uint64_t>(mAxes[i].nBins()) + 2) {
+        ++nBits;
+      }
+      mShifts[i] = nBitsTotal;
+      mBits[i] = nBits;
+      nBitsTotal += nBits;
+    }
+    mMaxBins = maxBins > 0 ? maxBins : kDefaultMaxBins;
+    mNFills = 0;
+    mNonUnitWeight = false;
+    mUsed.clear();
+    allocate(kInitialSlots);
+    mActive = nBitsTotal <= 63;
+    return mActive;
+  }
+
+  bool isActive() const { return mActive; }
+
+  /// Fill of the point x (one value per axis of the histogram) with the weight w
+  void fill(const double* x, double w = 1.)
+  {
+    if (!mActive) {
+      mHist->Fill(x, w);
+      return;
+    }
+    uint64_t key = 0;
+    for (std::size_t i = 0; i < mAxes.size(); ++i) {
+      key |= static_cast<uint64_t>(mAxes[i].findBin(x[i])) << mShifts[i];
+    }
+    const std::size_t slot = findSlot(key);
+    if (mKeys[slot] == kEmpty) {
+      mKeys[slot] = key;
+      mUsed.push_back(slot);
+    }
+    mSumW[slot] += w;
+    mSumW2[slot] += w * w;
+    mNonUnitWeight |= (w != 1.);
+    ++mNFills;
+    if (2 * mUsed.size() > mKeys.size()) {
+      if (mUsed.size() >= mMaxBins) {
+        flush();
+      } else {
+        rehash(2 * mKeys.size());
+      }
+    }
+  }
+
+  /// Number of distinct bins filled since the last flush
+  std::size_t nBins() const { return mUsed.size(); }
+
+  /// Adds the accumulated contents (and squared weights) and entries to the histogram and resets the accumulator.
+  /// As THnBase::Fill, the sums of the squared weights are enabled on the first fill with a weight other than 1.
+  void flush()
+  {
+    if (!mActive || mNFills == 0) {
+      return;
+    }
+    if (mNonUnitWeight && !mHist->GetCalculateErrors()) {
+      mHist->Sumw2();
+    }
+    const bool errors = mHist->GetCalculateErrors();
+    const auto entries = mHist->GetEntries();
+    for (auto slot : mUsed) {
+      const uint64_t key = mKeys[slot];
+      for (std::size_t i = 0; i < mAxes.size(); ++i) {
+        mCoords[i] = static_cast<Int_t>((key >> mShifts[i]) & ((static_cast<uint64_t>(1) << mBits[i]) - 1));
+      }
+      const Long64_t bin = mHist->GetBin(mCoords.data(), kTRUE);
+      mHist->AddBinContent(bin, mSumW[slot]);
+      if (errors) {
+        mHist->AddBinError2(bin, mSumW2[slot]);
+      }
+      mKeys[slot] = kEmpty;
+      mSumW[slot] = 0.;
+      mSumW2[slot] = 0.;
+    }
+    mHist->SetEntries(entries + mNFills);
+    mUsed.clear();
+    mNFills = 0;
+    mNonUnitWeight = false;
+  }
+
+ private:
+  static constexpr uint64_t kEmpty = ~static_cast<uint64_t>(0); // not a key: the keys use at most 63 bits
+  static constexpr std::size_t kInitialSlots = 1 << 10;
+
+  static uint64_t hash(uint64_t key)
+  {
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return key;
+  }
+
+  std::size_t findSlot(uint64_t key) const
+  {
+    const std::size_t mask = mKeys.size() - 1;
+    std::size_t slot = hash(key) & mask;
+    while (mKeys[slot] != kEmpty && mKeys[slot] != key) {
+      slot = (slot + 1) & mask;
+    }
+    return slot;
+  }
+
+  void allocate(std::size_t nSlots)
+  {
+    mKeys.assign(nSlots, kEmpty);
+    mSumW.assign(nSlots, 0.);
+    mSumW2.assign(nSlots, 0.);
+  }
+
+  void rehash(std::size_t nSlots)
+  {
+    auto keys = std::move(mKeys);
+    auto sumW = std::move(mSumW);
+    auto sumW2 = std::move(mSumW2);
+    auto used = std::move(mUsed);
+    allocate(nSlots);
+    mUsed.clear();
+    mUsed.reserve(used.size());
+    for (auto old : used) {
+      const std::size_t slot = findSlot(keys[old]);
+      mKeys[slot] = keys[old];
+      mSumW[slot] = sumW[old];
+      mSumW2[slot] = sumW2[old];
+      mUsed.push_back(slot);
+    }
+  }
+
+  THnBase* mHist = nullptr;
+  bool mActive = false;
+  std::vector<DenseAxis> mAxes;
+  std::vector<int> mShifts; // position of the bin of each axis in the key
+  std::vector<int> mBits;
+  std::vector<Int_t> mCoords; // bins of a key, for THnBase::GetBin
+  std::vector<uint64_t> mKeys;
+  std::vector<double> mSumW;
+  std::vector<double> mSumW2;
+  std::vector<std::size_t> mUsed; // slots filled since the last flush
+  std::size_t mMaxBins = kDefaultMaxBins;
+  int64_t mNFills = 0;
+  bool mNonUnitWeight = false;
+};
+
+#endif // COMMON_CORE_SPARSEHISTOGRAM_H_
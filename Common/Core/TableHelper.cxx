@@ -98,3 +98,22 @@ void enableFlagIfTableRequired(o2::framework::InitContext& initContext, const st
     LOG(info) << "Table disabled and not required: " + table;
   }
 }
+
+/// Function to disable a configurable flag if the table is not required in the workflow,
+/// i.e. if it is neither an input of a task nor saved by the AOD writer
+/// @param initContext initContext of the init function
+/// @param table name of the table to check for
+/// @param flag bool value of flag to set, a false value is kept
+void disableFlagIfTableNotRequired(o2::framework::InitContext& initContext, const std::string& table, bool& flag)
+{
+  if (!flag) {
+    LOG(info) << "Table disabled: " + table;
+    return;
+  }
+  if (isTableRequiredInWorkflow(initContext, table)) {
+    LOG(info) << "Table enabled and required: " + table;
+    return;
+  }
+  flag = false;
+  LOG(info) << "Auto-disabling table neither saved nor consumed: " + table;
+}
@@ -54,6 +54,23 @@ void enableFlagIfTableRequired(o2::framework::InitContext& initContext, const st
   enableFlagIfTableRequired(initContext, table, flag.value);
 }
 
+/// Function to disable a configurable flag if the table is not required in the workflow,
+/// i.e. if it is neither an input of a task nor saved by the AOD writer
+/// @param initContext initContext of the init function
+/// @param table name of the table to check for
+/// @param flag bool value of flag to set, a false value is kept
+void disableFlagIfTableNotRequired(o2::framework::InitContext& initContext, const std::string& table, bool& flag);
+
+/// Function to disable a configurable flag if the table is not required in the workflow
+/// @param initContext initContext of the init function
+/// @param table name of the table to check for
+/// @param flag configurable flag to set, a false value is kept
+template <typename FlagType>
+void disableFlagIfTableNotRequired(o2::framework::InitContext& initContext, const std::string& table, FlagType& flag)
+{
+  disableFlagIfTableNotRequired(initContext, table, flag.value);
+}
+
 /// Function to check for a specific configurable from another task in the current workflow and fetch its value. Useful for tasks that need to know the value of a configurable in another task.
 /// @param initContext initContext of the init function
 /// @param taskName name of the task to check for
@@ -13,14 +13,30 @@
 // Class for track selection
 //
 
+#include <bitset>
+
 #include "Framework/Logger.h"
 #include "Common/Core/TrackSelection.h"
 
+namespace
+{
+// bit mask of the ITS layers (layers beyond the 8 bits of the cluster map can never have hits)
+uint8_t itsLayersMask(const std::set<uint8_t>& layers)
+{
+  uint8_t mask = 0;
+  for (const auto& layer : layers) {
+    if (layer < 8) {
+      mask |= 1 << layer;
+    }
+  }
+  return mask;
+}
+} // namespace
+
 bool TrackSelection::FulfillsITSHitRequirements(uint8_t itsClusterMap) const
 {
-  constexpr uint8_t bit = 1;
   for (auto& itsRequirement : mRequiredITSHits) {
-    auto hits = std::count_if(itsRequirement.second.begin(), itsRequirement.second.end(), [&](auto&& requiredLayer) { return itsClusterMap & (bit << requiredLayer); });
+    int hits = std::bitset<8>(itsClusterMap & itsRequirement.second).count();
     if ((itsRequirement.first == -1) && (hits > 0)) {
       return false; // no hits were required in specified layers
     } else if (hits < itsRequirement.first) {
@@ -108,18 +124,29 @@ void TrackSelection::SetMaxDcaZ(float maxDcaZ)
 void TrackSelection::SetMaxDcaXYPtDep(std::function<float(float)> ptDepCut)
 {
   mMaxDcaXYPtDep = ptDepCut;
+  mUseMaxDcaXYPtDepParams = false;
   LOG(info) << "Track selection, set max DCA xy pt dep: " << mMaxDcaXYPtDep(1.0);
 }
 
+void TrackSelection::SetMaxDcaXYPtDep(float p0, float p1, float p2)
+{
+  mMaxDcaXYPtDepParams[0] = p0;
+  mMaxDcaXYPtDepParams[1] = p1;
+  mMaxDcaXYPtDepParams[2] = p2;
+  mUseMaxDcaXYPtDepParams = true;
+  mMaxDcaXYPtDep = nullptr;
+  LOG(info) << "Track selection, set max DCA xy pt dep: " << p0 << " + " << p1 << " / pT^" << p2;
+}
+
 void TrackSelection::SetRequireHitsInITSLayers(int8_t minNRequiredHits, std::set<uint8_t> requiredLayers)
 {
   // layer 0 corresponds to the the innermost ITS layer
-  mRequiredITSHits.push_back(std::make_pair(minNRequiredHits, requiredLayers));
+  mRequiredITSHits.push_back(std::make_pair(minNRequiredHits, itsLayersMask(requiredLayers)));
   LOG(info) << "Track selection, set require hits in ITS layers: " << static_cast<int>(minNRequiredHits);
 }
 void TrackSelection::SetRequireNoHitsInITSLayers(std::set<uint8_t> excludedLayers)
 {
-  mRequiredITSHits.push_back(std::make_pair(-1, excludedLayers));
+  mRequiredITSHits.push_back(std::make_pair(-1, itsLayersMask(excludedLayers)));
   LOG(info) << "Track selection, set require no hits in ITS layers";
 }
 
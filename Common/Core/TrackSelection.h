@@ -16,6 +16,9 @@
 #ifndef COMMON_CORE_TRACKSELECTION_H_
 #define COMMON_CORE_TRACKSELECTION_H_
 
+#include <cmath>
+#include <cstdint>
+#include <functional>
 #include <set>
 #include <vector>
 #include <utility>
@@ -65,6 +68,64 @@ class TrackSelection
 
   static const std::string mCutNames[static_cast<int>(TrackCuts::kNCuts)];
 
+  /// Quantities of a track used by the selections, read once from the table so that several selections
+  /// (or masks) can be evaluated on the same track without reading the columns, and recomputing the
+  /// dynamic pt and eta columns, for each cut. Has the accessors of the track tables used by IsSelected.
+  struct TrackValues {
+    template <typename T>
+    void fill(T const& track)
+    {
+      mTrackType = track.trackType();
+      mPt = track.pt();
+      mEta = track.eta();
+      mTpcNClsFound = track.tpcNClsFound();
+      mTpcNClsCrossedRows = track.tpcNClsCrossedRows();
+      mTpcCrossedRowsOverFindableCls = track.tpcCrossedRowsOverFindableCls();
+      mTpcChi2NCl = track.tpcChi2NCl();
+      mFlags = track.flags();
+      mHasTPC = track.hasTPC();
+      mItsNCls = track.itsNCls();
+      mItsChi2NCl = track.itsChi2NCl();
+      mHasITS = track.hasITS();
+      mItsClusterMap = track.itsClusterMap();
+      mDcaXY = track.dcaXY();
+      mDcaZ = track.dcaZ();
+    }
+
+    uint8_t trackType() const { return mTrackType; }
+    float pt() const { return mPt; }
+    float eta() const { return mEta; }
+    int16_t tpcNClsFound() const { return mTpcNClsFound; }
+    int16_t tpcNClsCrossedRows() const { return mTpcNClsCrossedRows; }
+    float tpcCrossedRowsOverFindableCls() const { return mTpcCrossedRowsOverFindableCls; }
+    float tpcChi2NCl() const { return mTpcChi2NCl; }
+    uint32_t flags() const { return mFlags; }
+    bool hasTPC() const { return mHasTPC; }
+    uint8_t itsNCls() const { return mItsNCls; }
+    float itsChi2NCl() const { return mItsChi2NCl; }
+    bool hasITS() const { return mHasITS; }
+    uint8_t itsClusterMap() const { return mItsClusterMap; }
+    float dcaXY() const { return mDcaXY; }
+    float dcaZ() const { return mDcaZ; }
+
+   private:
+    uint8_t mTrackType = 0;
+    float mPt = 0.f;
+    float mEta = 0.f;
+    int16_t mTpcNClsFound = 0;
+    int16_t mTpcNClsCrossedRows = 0;
+    float mTpcCrossedRowsOverFindableCls = 0.f;
+    float mTpcChi2NCl = 0.f;
+    uint32_t mFlags = 0;
+    bool mHasTPC = false;
+    uint8_t mItsNCls = 0;
+    float mItsChi2NCl = 0.f;
+    bool mHasITS = false;
+    uint8_t mItsClusterMap = 0;
+    float mDcaXY = 0.f;
+    float mDcaZ = 0.f;
+  };
+
   // Temporary function to check if track passes selection criteria. To be replaced by framework filters.
   template <typename T>
   bool IsSelected(T const& track) const
@@ -195,7 +256,7 @@ class TrackSelection
         return (isRun2 && mRequireGoldenChi2) ? (track.flags() & o2::aod::track::GoldenChi2) : true;
 
       case TrackCuts::kDCAxy:
-        return abs(track.dcaXY()) <= ((mMaxDcaXYPtDep) ? mMaxDcaXYPtDep(track.pt()) : mMaxDcaXY);
+        return abs(track.dcaXY()) <= GetMaxDcaXY(track.pt());
 
       case TrackCuts::kDCAz:
         return abs(track.dcaZ()) <= mMaxDcaZ;
@@ -221,6 +282,7 @@ class TrackSelection
   void SetMaxDcaXY(float maxDcaXY);
   void SetMaxDcaZ(float maxDcaZ);
   void SetMaxDcaXYPtDep(std::function<float(float)> ptDepCut);
+  void SetMaxDcaXYPtDep(float p0, float p1, float p2);
   void SetRequireHitsInITSLayers(int8_t minNRequiredHits, std::set<uint8_t> requiredLayers);
   void SetRequireNoHitsInITSLayers(std::set<uint8_t> excludedLayers);
   /// @brief Reset ITS requirements
@@ -229,6 +291,18 @@ class TrackSelection
   /// @brief Print the track selection
   void print() const;
 
+  /// @brief Maximum DCA in the xy plane for the given pT
+  float GetMaxDcaXY(float pt) const
+  {
+    if (mUseMaxDcaXYPtDepParams) {
+      if (mMaxDcaXYPtDepParams[2] == 1.f) {
+        return mMaxDcaXYPtDepParams[0] + mMaxDcaXYPtDepParams[1] / pt;
+      }
+      return mMaxDcaXYPtDepParams[0] + mMaxDcaXYPtDepParams[1] / std::pow(static_cast<double>(pt), static_cast<double>(mMaxDcaXYPtDepParams[2]));
+    }
+    return (mMaxDcaXYPtDep) ? mMaxDcaXYPtDep(pt) : mMaxDcaXY;
+  }
+
  private:
   bool FulfillsITSHitRequirements(uint8_t itsClusterMap) const;
 
@@ -249,15 +323,17 @@ class TrackSelection
   float mMaxDcaXY{1e10f};                       // max dca in xy plane
   float mMaxDcaZ{1e10f};                        // max dca in z direction
   std::function<float(float)> mMaxDcaXYPtDep{}; // max dca in xy plane as function of pT
+  float mMaxDcaXYPtDepParams[3]{0.f, 0.f, 0.f}; // max dca in xy plane as p0 + p1 / pT^p2
+  bool mUseMaxDcaXYPtDepParams{false};          // use the parametric pT dependence of the max dca in xy plane
 
   bool mRequireITSRefit{false};   // require refit in ITS
   bool mRequireTPCRefit{false};   // require refit in TPC
   bool mRequireGoldenChi2{false}; // require golden chi2 cut (Run 2 only)
 
-  // vector of ITS requirements (minNRequiredHits in specific requiredLayers)
-  std::vector<std::pair<int8_t, std::set<uint8_t>>> mRequiredITSHits{};
+  // vector of ITS requirements (minNRequiredHits in specific requiredLayers, as bit mask of the layers)
+  std::vector<std::pair<int8_t, uint8_t>> mRequiredITSHits{};
 
-  ClassDefNV(TrackSelection, 1);
+  ClassDefNV(TrackSelection, 2);
 };
 
 #endif // COMMON_CORE_TRACKSELECTION_H_
@@ -34,7 +34,7 @@ TrackSelection getGlobalTrackSelection()
   selectedTracks.SetMaxChi2PerClusterTPC(4.f);
   selectedTracks.SetRequireHitsInITSLayers(1, {0, 1}); // one hit in any SPD layer
   selectedTracks.SetMaxChi2PerClusterITS(36.f);
-  selectedTracks.SetMaxDcaXYPtDep([](float pt) { return 0.0105f + 0.0350f / pow(pt, 1.1f); });
+  selectedTracks.SetMaxDcaXYPtDep(0.0105f, 0.0350f, 1.1f); // 0.0105 + 0.0350 / pT^1.1
   selectedTracks.SetMaxDcaZ(2.f);
   return selectedTracks;
 }
@@ -68,8 +68,8 @@ TrackSelection getGlobalTrackSelectionRun3ITSMatch(int matching, int passFlag)
   switch (passFlag) {
     case TrackSelection::GlobalTrackRun3DCAxyCut::Default:
       break;
-    case TrackSelection::GlobalTrackRun3DCAxyCut::ppPass3:                            // Pass3 pp parameters
-      selectedTracks.SetMaxDcaXYPtDep([](float pt) { return 0.004f + 0.013f / pt; }); // Tuned on the LHC22f anchored MC LHC23d1d on primary pions. 7 Sigmas of the resolution
+    case TrackSelection::GlobalTrackRun3DCAxyCut::ppPass3:  // Pass3 pp parameters
+      selectedTracks.SetMaxDcaXYPtDep(0.004f, 0.013f, 1.f); // 0.004 + 0.013 / pT, tuned on the LHC22f anchored MC LHC23d1d on primary pions. 7 Sigmas of the resolution
       break;
     default:
       LOG(fatal) << "getGlobalTrackSelectionRun3ITSMatch with undefined DCA cut";
@@ -123,7 +123,7 @@ TrackSelection getJEGlobalTrackSelectionRun2()
   TrackSelection selectedTracks = getGlobalTrackSelection();
   selectedTracks.SetPtRange(0.15f, 1e15f);
   selectedTracks.SetRequireGoldenChi2(false);
-  selectedTracks.SetMaxDcaXYPtDep([](float /*pt*/) { return 1e+10; });
+  selectedTracks.SetMaxDcaXYPtDep(1e+10f, 0.f, 0.f);
   selectedTracks.SetEtaRange(-0.9f, 0.9f);
   selectedTracks.SetMaxDcaXY(2.4f);
   selectedTracks.SetMaxDcaZ(3.2f);
@@ -19,6 +19,10 @@
 
 #include <TPDGCode.h>
 
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
 #include "Framework/Logger.h"
 #include "ReconstructionDataFormats/PID.h"
 
@@ -32,6 +36,42 @@ struct TrackSelectorPID {
     Conditional,
     Accepted
   };
+
+  /// Combines TPC and TOF statuses as TrackSelectorPidBase::statusTpcOrTof.
+  static Status combineTpcOrTof(int pidTpc, int pidTof)
+  {
+    if (pidTpc == Accepted || pidTof == Accepted) {
+      return Accepted;
+    }
+    if (pidTpc == Conditional && pidTof == Conditional) {
+      return Accepted;
+    }
+    if (pidTpc == Rejected || pidTof == Rejected) {
+      return Rejected;
+    }
+    return NotApplicable; // (NotApplicable for one detector) and (NotApplicable or Conditional for the other)
+  }
+
+  /// Combines TPC and TOF statuses as TrackSelectorPidBase::statusTpcAndTof, NotApplicable for a detector without the track.
+  static Status combineTpcAndTof(int pidTpc, int pidTof)
+  {
+    if (pidTpc == Accepted && pidTof == Accepted) {
+      return Accepted;
+    }
+    if (pidTpc == Accepted && (pidTof == NotApplicable || pidTof == Conditional)) {
+      return Accepted;
+    }
+    if ((pidTpc == NotApplicable || pidTpc == Conditional) && pidTof == Accepted) {
+      return Accepted;
+    }
+    if (pidTpc == Conditional && pidTof == Conditional) {
+      return Accepted;
+    }
+    if (pidTpc == Rejected || pidTof == Rejected) {
+      return Rejected;
+    }
+    return NotApplicable; // (NotApplicable for one detector) and (NotApplicable or Conditional for the other)
+  }
 };
 
 template <uint64_t pdg = kPiPlus>
@@ -393,19 +433,7 @@ class TrackSelectorPidBase
   template <typename T>
   TrackSelectorPID::Status statusTpcOrTof(const T& track)
   {
-    int pidTpc = statusTpc(track);
-    int pidTof = statusTof(track);
-
-    if (pidTpc == TrackSelectorPID::Accepted || pidTof == TrackSelectorPID::Accepted) {
-      return TrackSelectorPID::Accepted;
-    }
-    if (pidTpc == TrackSelectorPID::Conditional && pidTof == TrackSelectorPID::Conditional) {
-      return TrackSelectorPID::Accepted;
-    }
-    if (pidTpc == TrackSelectorPID::Rejected || pidTof == TrackSelectorPID::Rejected) {
-      return TrackSelectorPID::Rejected;
-    }
-    return TrackSelectorPID::NotApplicable; // (NotApplicable for one detector) and (NotApplicable or Conditional for the other)
+    return TrackSelectorPID::combineTpcOrTof(statusTpc(track), statusTof(track));
   }
 
   /// Returns status of combined PID (TPC and TOF) selection for a given track when both detectors are applicable. Returns status of single PID otherwise.
@@ -422,23 +450,7 @@ class TrackSelectorPidBase
     if (track.hasTOF()) {
       pidTof = statusTof(track);
     }
-
-    if (pidTpc == TrackSelectorPID::Accepted && pidTof == TrackSelectorPID::Accepted) {
-      return TrackSelectorPID::Accepted;
-    }
-    if (pidTpc == TrackSelectorPID::Accepted && (pidTof == TrackSelectorPID::NotApplicable || pidTof == TrackSelectorPID::Conditional)) {
-      return TrackSelectorPID::Accepted;
-    }
-    if ((pidTpc == TrackSelectorPID::NotApplicable || pidTpc == TrackSelectorPID::Conditional) && pidTof == TrackSelectorPID::Accepted) {
-      return TrackSelectorPID::Accepted;
-    }
-    if (pidTpc == TrackSelectorPID::Conditional && pidTof == TrackSelectorPID::Conditional) {
-      return TrackSelectorPID::Accepted;
-    }
-    if (pidTpc == TrackSelectorPID::Rejected || pidTof == TrackSelectorPID::Rejected) {
-      return TrackSelectorPID::Rejected;
-    }
-    return TrackSelectorPID::NotApplicable; // (NotApplicable for one detector) and (NotApplicable or Conditional for the other)
+    return TrackSelectorPID::combineTpcAndTof(pidTpc, pidTof);
   }
 
   /// Checks whether a track is identified as electron and rejected as pion by TOF or RICH.
@@ -648,4 +660,83 @@ using TrackSelectorPi = TrackSelectorPidBase<kPiPlus>;    // Pi
 using TrackSelectorKa = TrackSelectorPidBase<kKPlus>;     // Ka
 using TrackSelectorPr = TrackSelectorPidBase<kProton>;    // Pr
 
+/// Cache of the TPC and TOF PID statuses of the tracks for one selector (species and configuration).
+///
+/// The statuses of a track are evaluated at its first request and kept by track index as packed 2-bit values,
+/// so that a track shared by several candidates (or tested for the same species in several hypotheses)
+/// is evaluated once per dataframe. The combined statuses are derived from the cached ones.
+///
+/// Usage:
+///   cachePion.setSelector(selectorPion); // in init, after the configuration of the selector
+///   cachePion.reset(tracks.size());      // in process, for each new track table
+///   auto pid = cachePion.statusTpcOrTof(candidate.prong0_as<TracksSel>());
+template <uint64_t pdg = kPiPlus>
+class TrackSelectorPidCache
+{
+ public:
+  /// Copies the configured selector whose statuses are cached and forgets the cached statuses.
+  void setSelector(const TrackSelectorPidBase<pdg>& selector)
+  {
+    mSelector = selector;
+    mStatus.clear();
+  }
+
+  /// Forgets the cached statuses and reserves the cache for a track table of the given size.
+  void reset(std::size_t nTracks)
+  {
+    mStatus.assign(nTracks, 0);
+  }
+
+  template <typename T>
+  TrackSelectorPID::Status statusTpc(const T& track)
+  {
+    return static_cast<TrackSelectorPID::Status>(statuses(track) & kMask);
+  }
+
+  template <typename T>
+  TrackSelectorPID::Status statusTof(const T& track)
+  {
+    return static_cast<TrackSelectorPID::Status>((statuses(track) >> kShiftTof) & kMask);
+  }
+
+  template <typename T>
+  TrackSelectorPID::Status statusTpcOrTof(const T& track)
+  {
+    const auto packed = statuses(track);
+    return TrackSelectorPID::combineTpcOrTof(packed & kMask, (packed >> kShiftTof) & kMask);
+  }
+
+  template <typename T>
+  TrackSelectorPID::Status statusTpcAndTof(const T& track)
+  {
+    const auto packed = statuses(track);
+    const int pidTpc = track.hasTPC() ? (packed & kMask) : TrackSelectorPID::NotApplicable;
+    const int pidTof = track.hasTOF() ? ((packed >> kShiftTof) & kMask) : TrackSelectorPID::NotApplicable;
+    return TrackSelectorPID::combineTpcAndTof(pidTpc, pidTof);
+  }
+
+ private:
+  static constexpr uint8_t kMask = 0x3;       ///< 2-bit status
+  static constexpr int kShiftTof = 2;         ///< position of the TOF status
+  static constexpr uint8_t kEvaluated = 0x80; ///< statuses of the track evaluated
+
+  /// Packed TPC and TOF statuses of the track, evaluated at the first request.
+  template <typename T>
+  uint8_t statuses(const T& track)
+  {
+    const auto index = static_cast<std::size_t>(track.globalIndex());
+    if (index >= mStatus.size()) {
+      mStatus.resize(index + 1, 0);
+    }
+    auto& packed = mStatus[index];
+    if (!(packed & kEvaluated)) {
+      packed = kEvaluated | static_cast<uint8_t>(mSelector.statusTpc(track)) | static_cast<uint8_t>(mSelector.statusTof(track) << kShiftTof);
+    }
+    return packed;
+  }
+
+  TrackSelectorPidBase<pdg> mSelector;
+  std::vector<uint8_t> mStatus; ///< per track index: kEvaluated | TOF status << kShiftTof | TPC status
+};
+
 #endif // COMMON_CORE_TRACKSELECTORPID_H_
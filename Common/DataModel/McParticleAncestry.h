@@ -0,0 +1,53 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   McParticleAncestry.h
+/// \brief  Ancestry of the MC particles (closest physical primary ancestor, heavy-flavour origin,
+///         decay depth), computed once per dataframe by the mc-particle-ancestry task.
+///         The table is joinable with McParticles.
+///
+
+#ifndef COMMON_DATAMODEL_MCPARTICLEANCESTRY_H_
+#define COMMON_DATAMODEL_MCPARTICLEANCESTRY_H_
+
+#include "Framework/AnalysisDataModel.h"
+
+namespace o2::aod
+{
+namespace mcancestry
+{
+// bits of the Flags column
+enum AncestryFlags : uint8_t {
+  kIsPhysicalPrimary = 0x1,       // the particle itself is a physical primary
+  kFromPhysicalPrimary = 0x2,     // an ancestor is a physical primary (e.g. weak decay product of a primary)
+  kFromCharmHadron = 0x4,         // an ancestor is a charm hadron
+  kFromBeautyHadron = 0x8,        // an ancestor is a beauty hadron
+  kFromTransport = 0x10,          // the particle or an ancestor was not produced by the generator
+  kTruncatedAncestry = 0x20       // the mother chain has a loop or an invalid mother index
+};
+
+DECLARE_SOA_INDEX_COLUMN_FULL(FirstPrimaryAncestor, firstPrimaryAncestor, int, McParticles, "_FirstPrimary"); //! closest physical primary in the mother chain, the particle itself if it is one (-1: none)
+DECLARE_SOA_COLUMN(HfOrigin, hfOrigin, int8_t);                                                       //! RecoDecay::OriginType: 0 -- none, 1 -- prompt (charm hadron without beauty ancestors), 2 -- non-prompt
+DECLARE_SOA_COLUMN(DecayDepth, decayDepth, uint8_t);                                                  //! number of mothers up to a particle without mother (saturates at 255)
+DECLARE_SOA_COLUMN(Flags, flags, uint8_t);                                                            //! AncestryFlags bits
+DECLARE_SOA_DYNAMIC_COLUMN(IsFromPhysicalPrimary, isFromPhysicalPrimary,                              //! an ancestor is a physical primary
+                           [](uint8_t flags) -> bool { return (flags & kFromPhysicalPrimary) != 0; });
+DECLARE_SOA_DYNAMIC_COLUMN(IsFromHeavyFlavour, isFromHeavyFlavour, //! an ancestor is a charm or beauty hadron
+                           [](uint8_t flags) -> bool { return (flags & (kFromCharmHadron | kFromBeautyHadron)) != 0; });
+} // namespace mcancestry
+
+DECLARE_SOA_TABLE(McParticleAncestry, "AOD", "MCPANCESTRY", //! ancestry of the MC particles, joinable with McParticles
+                  mcancestry::FirstPrimaryAncestorId, mcancestry::HfOrigin, mcancestry::DecayDepth, mcancestry::Flags,
+                  mcancestry::IsFromPhysicalPrimary<mcancestry::Flags>, mcancestry::IsFromHeavyFlavour<mcancestry::Flags>);
+} // namespace o2::aod
+
+#endif // COMMON_DATAMODEL_MCPARTICLEANCESTRY_H_
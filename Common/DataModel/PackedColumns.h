@@ -0,0 +1,110 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   PackedColumns.h
+/// \brief  Reduced-precision (quantised) float columns for the derived data
+///
+/// A packed column stores a float as an 8 or 16 bit code, with a linear or logarithmic binning of a fixed range.
+/// DECLARE_SOA_PACKED_COLUMN(Name, getter, quantisation) declares the stored column NamePacked (getterPacked())
+/// and the dynamic column Name (getter()), which returns the centre of the bin as float, so that a packed table
+/// is read with the same getters as the table with full float columns:
+///
+///   using nSigma = o2::aod::packing::Quantisation<int8_t, -10.f, 10.f>;
+///   DECLARE_SOA_PACKED_COLUMN(NSigTpcPi0, nSigTpcPi0, nSigma);
+///   DECLARE_SOA_TABLE(MyPackedTable, "AOD", "MYPACKED", NSigTpcPi0Packed, NSigTpcPi0<NSigTpcPi0Packed>);
+///   ...
+///   rowPacked(nSigma::pack(value));
+///
+
+#ifndef COMMON_DATAMODEL_PACKEDCOLUMNS_H_
+#define COMMON_DATAMODEL_PACKEDCOLUMNS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include "Framework/ASoA.h"
+#include "Framework/Logger.h"
+
+namespace o2::aod::packing
+{
+
+enum class Scale {
+  kLinear = 0,
+  kLog
+};
+
+/// Quantisation of the range [Min, Max) into the codes of TBinned (8 or 16 bit integer, signed or unsigned).
+/// The lowest code is reserved for the values below Min (and NaN), the highest one for the values >= Max.
+/// The bins are uniform in the value (kLinear) or in its logarithm (kLog, Min > 0).
+/// Unpacking returns the centre of the bin, the underflow and overflow codes are unpacked half a bin beyond
+/// Min and Max, i.e. outside of the range, so that cuts within the range keep their meaning.
+template <typename TBinned, float Min, float Max, Scale S = Scale::kLinear>
+struct Quantisation {
+  using binned_t = TBinned;
+  static_assert(std::is_integral_v<TBinned> && sizeof(TBinned) <= 2, "Packed columns are 8 or 16 bit integers");
+  static_assert(Min < Max, "Invalid packing range");
+  static_assert(S == Scale::kLinear || Min > 0.f, "Logarithmic packing needs a positive range");
+
+  static constexpr binned_t underflowCode = std::numeric_limits<TBinned>::min();
+  static constexpr binned_t overflowCode = std::numeric_limits<TBinned>::max();
+  static constexpr int nBins = static_cast<int>(overflowCode) - static_cast<int>(underflowCode) - 1;
+  static constexpr float binnedMin = Min;
+  static constexpr float binnedMax = Max;
+  static constexpr Scale scale = S;
+
+  /// Code of the value
+  static binned_t pack(float value)
+  {
+    if (!(value >= Min)) {
+      return underflowCode;
+    }
+    if (value >= Max) {
+      return overflowCode;
+    }
+    const int bin = std::min(static_cast<int>((transform(value) - transformedMin()) * invBinWidth()), nBins - 1);
+    return static_cast<binned_t>(static_cast<int>(underflowCode) + 1 + bin);
+  }
+
+  /// Value at the centre of the bin of the code
+  static float unpack(binned_t code)
+  {
+    const int bin = static_cast<int>(code) - static_cast<int>(underflowCode) - 1;
+    return inverse(transformedMin() + (static_cast<float>(bin) + 0.5f) / invBinWidth());
+  }
+
+  static void print()
+  {
+    LOG(info) << "Packing: " << Min << " - " << Max << (S == Scale::kLog ? " (log)" : "") << " with " << nBins << " bins of " << 8 * sizeof(binned_t) << " bit codes";
+  }
+
+ private:
+  static float transform(float value) { return S == Scale::kLog ? std::log(value) : value; }
+  static float inverse(float value) { return S == Scale::kLog ? std::exp(value) : value; }
+  static float transformedMin() { return transform(Min); }
+  static float invBinWidth()
+  {
+    static const float invWidth = nBins / (transform(Max) - transform(Min));
+    return invWidth;
+  }
+};
+
+} // namespace o2::aod::packing
+
+/// Declares the stored code column NAME##Packed and the dynamic column NAME returning the unpacked float
+#define DECLARE_SOA_PACKED_COLUMN(NAME, GETTER, QUANTISATION)                \
+  DECLARE_SOA_COLUMN(NAME##Packed, GETTER##Packed, QUANTISATION::binned_t); \
+  DECLARE_SOA_DYNAMIC_COLUMN(NAME, GETTER, [](QUANTISATION::binned_t code) -> float { return QUANTISATION::unpack(code); });
+
+#endif // COMMON_DATAMODEL_PACKEDCOLUMNS_H_
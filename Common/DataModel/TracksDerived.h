@@ -0,0 +1,54 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   TracksDerived.h
+/// \brief  Per-track quantities derived from the track parameters and the detector columns, which
+///         several tasks of a train otherwise recompute per track (the dynamic columns eta, phi, itsNCls,
+///         tpcNClsFound, ... and the pt resolution). Produced once per track by the track-derived task,
+///         joinable with Tracks.
+///
+/// A task reuses the stored values by joining aod::TracksDerived to its track tables and reading the
+/// columns of the trackderived namespace (e.g. track.etaStored()), the track-derived task has then to be
+/// part of the workflow.
+///
+
+#ifndef COMMON_DATAMODEL_TRACKSDERIVED_H_
+#define COMMON_DATAMODEL_TRACKSDERIVED_H_
+
+#include "Framework/AnalysisDataModel.h"
+
+namespace o2::aod
+{
+namespace trackderived
+{
+DECLARE_SOA_COLUMN(PtStored, ptStored, float);                                             //! transverse momentum (GeV/c), as track::Pt
+DECLARE_SOA_COLUMN(PStored, pStored, float);                                               //! momentum (GeV/c), as track::P
+DECLARE_SOA_COLUMN(EtaStored, etaStored, float);                                           //! pseudorapidity, as track::Eta
+DECLARE_SOA_COLUMN(PhiStored, phiStored, float);                                           //! azimuth in [0, 2pi), as track::Phi
+DECLARE_SOA_COLUMN(ITSNClsStored, itsNClsStored, uint8_t);                                 //! number of ITS clusters, as track::ITSNCls
+DECLARE_SOA_COLUMN(ITSNClsInnerBarrelStored, itsNClsInnerBarrelStored, uint8_t);           //! number of ITS clusters in the inner barrel, as track::ITSNClsInnerBarrel
+DECLARE_SOA_COLUMN(TPCNClsFoundStored, tpcNClsFoundStored, int16_t);                       //! number of found TPC clusters, as track::TPCNClsFound
+DECLARE_SOA_COLUMN(TPCNClsCrossedRowsStored, tpcNClsCrossedRowsStored, int16_t);           //! number of crossed TPC rows, as track::TPCNClsCrossedRows
+DECLARE_SOA_COLUMN(TPCCrossedRowsOverFindableClsStored, tpcCrossedRowsOverFindableClsStored, float); //! crossed rows over findable clusters, as track::TPCCrossedRowsOverFindableCls
+DECLARE_SOA_COLUMN(TPCFractionSharedClsStored, tpcFractionSharedClsStored, float);         //! fraction of shared TPC clusters, as track::TPCFractionSharedCls
+DECLARE_SOA_COLUMN(PtRelResolution, ptRelResolution, float);                               //! relative pt resolution pt * sigma(1/pt), -1 without the covariance matrix
+} // namespace trackderived
+
+DECLARE_SOA_TABLE(TracksDerived, "AOD", "TRACKDERIVED", //! derived per-track quantities, joinable with Tracks
+                  trackderived::PtStored, trackderived::PStored, trackderived::EtaStored, trackderived::PhiStored,
+                  trackderived::ITSNClsStored, trackderived::ITSNClsInnerBarrelStored,
+                  trackderived::TPCNClsFoundStored, trackderived::TPCNClsCrossedRowsStored,
+                  trackderived::TPCCrossedRowsOverFindableClsStored, trackderived::TPCFractionSharedClsStored,
+                  trackderived::PtRelResolution);
+} // namespace o2::aod
+
+#endif // COMMON_DATAMODEL_TRACKSDERIVED_H_
@@ -16,33 +16,51 @@
 /// The conversion is needed because the table has been extended with the ITSClusterSize column
 /// and the ITSClusterMap column is evaluated dynamically from it.
 /// In the converter a dummy ITSClusterSize column is filled with overflows if a hit in the layer is present
+/// With the workflow option --forward-columns the new table is built on the Arrow level: the unchanged
+/// columns are forwarded from the input table and only ITSClusterSize is computed, column-wise
 
 /// \author F.Mazzaschi <fmazzasc@cern.ch>
 
-#include "Framework/runDataProcessing.h"
+#include <vector>
+
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
+#include "Common/Core/ArrowColumnForwarding.h"
 
 using namespace o2;
 using namespace o2::framework;
 
+// we need to add workflow options before including Framework/runDataProcessing
+void customize(std::vector<o2::framework::ConfigParamSpec>& workflowOptions)
+{
+  std::vector<o2::framework::ConfigParamSpec> options{o2::framework::ConfigParamSpec{"forward-columns", o2::framework::VariantType::Bool, false, {"Forward the unchanged Arrow columns instead of copying the table row by row"}}};
+  std::swap(workflowOptions, options);
+}
+
+#include "Framework/runDataProcessing.h"
+
+namespace
+{
+/// Dummy cluster sizes: overflow (0xf) for each layer with a hit
+inline uint32_t clusterSizesFromMap(uint8_t itsClusterMap)
+{
+  uint32_t itsClusterSizes = 0;
+  for (int layer = 0; layer < 7; layer++) {
+    itsClusterSizes |= ((itsClusterMap >> layer) & 1u) * (0xfu << (layer * 4));
+  }
+  return itsClusterSizes;
+}
+} // namespace
+
 struct TracksExtraConverter {
   Produces<aod::StoredTracksExtra_001> tracksExtra_001;
   void process(aod::TracksExtra_000 const& tracksExtra_000)
   {
 
     for (const auto& track0 : tracksExtra_000) {
-
-      uint32_t itsClusterSizes = 0;
-      for (int layer = 0; layer < 7; layer++) {
-        if (track0.itsClusterMap() & (1 << layer)) {
-          itsClusterSizes |= (0xf << (layer * 4));
-        }
-      }
-
       tracksExtra_001(track0.tpcInnerParam(),
                       track0.flags(),
-                      itsClusterSizes,
+                      clusterSizesFromMap(track0.itsClusterMap()),
                       track0.tpcNClsFindable(),
                       track0.tpcNClsFindableMinusFound(),
                       track0.tpcNClsFindableMinusCrossedRows(),
@@ -64,6 +82,28 @@ struct TracksExtraConverter {
   }
 };
 
+/// Same conversion without Produces: the output table shares the columns of TracksExtra_000 and only
+/// the ITSClusterSizes column is materialised, the table is adopted as the StoredTracksExtra_001 output
+struct TracksExtraForwardingConverter {
+  using Output_t = aod::StoredTracksExtra_001;
+  using Metadata_t = aod::MetadataTrait<Output_t>::metadata;
+
+  void run(ProcessingContext& pc)
+  {
+    auto inputConsumer = pc.inputs().get<TableConsumer>(aod::MetadataTrait<std::decay_t<aod::TracksExtra_000>>::metadata::tableLabel());
+    auto inputTable{inputConsumer->asArrowTable()};
+
+    o2::common::converters::DerivedColumns derived;
+    derived[aod::track::ITSClusterSizes::mLabel] = o2::common::converters::deriveColumn<uint32_t, uint8_t>(inputTable->GetColumnByName(aod::track::ITSClusterMap::mLabel), clusterSizesFromMap);
+    pc.outputs().adopt(Output{Metadata_t::origin(), Metadata_t::description(), Metadata_t::version()}, o2::common::converters::forwardColumns<Output_t>(inputTable, derived));
+  }
+
+  // subscribes to the input table, the conversion is done in run()
+  void process(aod::TracksExtra_000 const&)
+  {
+  }
+};
+
 /// Spawn the extended table for TracksExtra001 to avoid the call to the internal spawner and a consequent circular dependency
 struct TracksExtraSpawner {
   Spawns<aod::TracksExtra_001> tracksExtra_001;
@@ -71,6 +111,15 @@ struct TracksExtraSpawner {
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
 {
+  if (cfgc.options().get<bool>("forward-columns")) {
+    using Metadata_t = TracksExtraForwardingConverter::Metadata_t;
+    DataProcessorSpec spec{adaptAnalysisTask<TracksExtraForwardingConverter>(cfgc)};
+    spec.outputs.emplace_back(OutputLabel{Metadata_t::tableLabel()}, Metadata_t::origin(), Metadata_t::description(), Metadata_t::version());
+    return WorkflowSpec{
+      spec,
+      adaptAnalysisTask<TracksExtraSpawner>(cfgc),
+    };
+  }
   return WorkflowSpec{
     adaptAnalysisTask<TracksExtraConverter>(cfgc),
     adaptAnalysisTask<TracksExtraSpawner>(cfgc),
@@ -108,6 +108,7 @@ struct bayesPid {
 
   std::array<std::array<float, PID::NIDs>, kNProb> Probability; /// Probabilities for all the cases defined in ProbType
   std::vector<PID::ID> enabledSpecies;                          /// Enabled species
+  std::array<bool, PID::NIDs> isEnabledSpecies{};               /// Enabled species, indexed by PID (filled once in init from enabledSpecies)
 
   /// Checker of the species that are enabled and initializer of the probabilities
   template <ProbType detIndex, o2::track::PID::ID pid>
@@ -118,20 +119,15 @@ struct bayesPid {
       LOG(debug) << "Detector " << detectorName[detIndex] << " disabled";
       return false; // Setting the probability to 1 if the detector is disabled
     }
-    LOG(debug) << "Detector " << detectorName[detIndex] << " enabled with " << enabledSpecies.size() << " species";
-
-    for (const auto enabledPid : enabledSpecies) { // Checking that the species is enabled
-      LOG(debug) << "Testing " << PID::getName(enabledPid) << " " << static_cast<int>(enabledPid) << " vs " << static_cast<int>(pid);
-      if (enabledPid == pid) {
-        LOG(debug) << "Particle " << PID::getName(enabledPid) << " enabled";
-        Probability[detIndex][pid] = 1.f / enabledSpecies.size(); // set flat distribution (no decision yet)
-        return true;
-      }
+    if (!isEnabledSpecies[pid]) { // Checking that the species is enabled
+      return false;
     }
-    return false;
+    Probability[detIndex][pid] = 1.f / enabledSpecies.size(); // set flat distribution (no decision yet)
+    return true;
   }
 
   float fRange = 5.f;
+  const float probOutOfRange = exp(-0.5 * fRange * fRange); /// TPC probability of the tracks outside of fRange sigmas
 
   void init(o2::framework::InitContext& initContext)
   {
@@ -217,6 +213,9 @@ struct bayesPid {
     } else { // All ok
       LOG(info) << enabledSpecies.size() << " species enabled for the Bayesian PID computation";
     }
+    for (const auto enabledPid : enabledSpecies) {
+      isEnabledSpecies[enabledPid] = true;
+    }
     // Getting the parametrization parameters
     ccdb->setURL(url.value);
     ccdb->setTimestamp(timestamp.value);
@@ -278,7 +277,7 @@ struct bayesPid {
 
     if (abs(dedx - bethe) > fRange * sigma) {
       // Probability[kTPC][pid] = exp(-0.5 * fRange * fRange) / sigma; // BUG fix
-      Probability[kTPC][pid] = exp(-0.5 * fRange * fRange);
+      Probability[kTPC][pid] = probOutOfRange;
     } else {
       // Probability[kTPC][pid] = exp(-0.5 * (dedx - bethe) * (dedx - bethe) / (sigma * sigma)) / sigma; //BUG fix
       Probability[kTPC][pid] = exp(-0.5 * (dedx - bethe) * (dedx - bethe) / (sigma * sigma));
@@ -378,45 +377,24 @@ struct bayesPid {
   }
 
   /// Calculate probabilities from all enabled detectors and species
-  void MergeProbabilities()
+  /// and the normalisation of the Bayesian probabilities (sum of merged probabilities times priors), in one pass
+  float MergeProbabilities()
   {
-    LOG(debug) << "Merging probabilities";
-
-    float probSum[kNDet + 1] = {0.f}; /// Summed probabilities for all detectors + 1 for the sum of all detectors
-
+    float sum = 0.f;
     for (const auto enabledPid : enabledSpecies) {
-      Probability[kMerged][enabledPid] = 1.f;
-      for (int det = 0; det < kNDet; det++) {
-        probSum[det] += Probability[det][enabledPid];
-        Probability[kMerged][enabledPid] *= Probability[det][enabledPid];
-      }
-      probSum[kNDet] += Probability[kMerged][enabledPid];
-      LOG(debug) << "For " << PID::getName(enabledPid);
+      float merged = 1.f;
       for (int det = 0; det < kNDet; det++) {
-        if (enabledDet[det]) {
-          LOG(debug) << "\t" << detectorName[det] << " Probability " << Probability[det][enabledPid];
-        }
+        merged *= Probability[det][enabledPid];
       }
-      LOG(debug) << "\tCombined: " << Probability[kMerged][enabledPid];
+      Probability[kMerged][enabledPid] = merged;
+      sum += merged * Probability[kPrior][enabledPid];
     }
-    for (int det = 0; det < kNDet; det++) {
-      if (enabledDet[det]) {
-        LOG(debug) << "\tSum " << detectorName[det] << " Probability " << probSum[det];
-      }
-    }
-    LOG(debug) << "\tSum combined: " << probSum[kNDet];
+    return sum;
   }
 
-  /// Calculate Bayesian probabilities
-  void ComputeBayesProbabilities()
+  /// Calculate Bayesian probabilities, from the normalisation given by MergeProbabilities
+  void ComputeBayesProbabilities(const float sum)
   {
-    LOG(debug) << "Computing bayes probabilities";
-
-    float sum = 0.;
-    for (const auto enabledPid : enabledSpecies) {
-      LOG(debug) << "Adding " << Probability[kMerged][enabledPid] << " with prior " << Probability[kPrior][enabledPid];
-      sum += Probability[kMerged][enabledPid] * Probability[kPrior][enabledPid];
-    }
     if (sum <= 0) {
       // LOG(warning) << "Invalid probability densities or prior probabilities";
       for (uint64_t i = 0; i < Probability[kBayesian].size(); i++) {
@@ -424,12 +402,12 @@ struct bayesPid {
       }
       return;
     }
+    const float invSum = 1.f / sum;
     for (const auto enabledPid : enabledSpecies) {
-      Probability[kBayesian][enabledPid] = Probability[kMerged][enabledPid] * Probability[kPrior][enabledPid] / sum;
+      Probability[kBayesian][enabledPid] = Probability[kMerged][enabledPid] * Probability[kPrior][enabledPid] * invSum;
       // if (probDensityMism) {
       //   probDensityMism[enabledPid] *= Probability[kPrior][enabledPid] / sum;
       // }
-      LOG(debug) << "For " << PID::getName(enabledPid) << " merged prob. " << Probability[kMerged][enabledPid] << " prior " << Probability[kPrior][enabledPid] << " sum " << sum << " bayesian Probability: " << Probability[kBayesian][enabledPid];
     }
   }
 
@@ -478,9 +456,7 @@ struct bayesPid {
       ComputeTOFProbability<PID::Helium3>(trk);
       ComputeTOFProbability<PID::Alpha>(trk);
 
-      MergeProbabilities();
-
-      ComputeBayesProbabilities();
+      ComputeBayesProbabilities(MergeProbabilities());
 
       if (pidEl == 1) {
         tablePIDEl(Probability[kBayesian][PID::Electron] * 100.f);
@@ -16,6 +16,8 @@
 ///         Only the tables for the mass hypotheses requested are filled, the others are sent empty.
 ///
 
+#include <algorithm>
+#include <array>
 #include <utility>
 #include <vector>
 #include <string>
@@ -161,10 +163,11 @@ struct tofSignal {
 /// Selection criteria for tracks used for TOF event time
 float trackSampleMinMomentum = 0.5f;
 float trackSampleMaxMomentum = 2.f;
+int trackSampleStride = 1; // only one track out of trackSampleStride (by track index) is used, set per collision to cap the number of tracks
 template <typename trackType>
 bool filterForTOFEventTime(const trackType& tr)
 {
-  return (tr.hasTOF() && tr.p() > trackSampleMinMomentum && tr.p() < trackSampleMaxMomentum && (tr.trackType() == o2::aod::track::TrackTypeEnum::Track || tr.trackType() == o2::aod::track::TrackTypeEnum::TrackIU));
+  return (tr.hasTOF() && tr.p() > trackSampleMinMomentum && tr.p() < trackSampleMaxMomentum && (tr.trackType() == o2::aod::track::TrackTypeEnum::Track || tr.trackType() == o2::aod::track::TrackTypeEnum::TrackIU)) && (trackSampleStride == 1 || tr.globalIndex() % trackSampleStride == 0);
 } // accept all
 
 /// Specialization of TOF event time maker
@@ -206,6 +209,7 @@ struct tofEventTime {
   Configurable<float> maxEvTimeTOF{"maxEvTimeTOF", 100000.0f, "Maximum value of the TOF event time"};
   Configurable<bool> sel8TOFEvTime{"sel8TOFEvTime", false, "Flag to compute the ev. time only for events that pass the sel8 ev. selection"};
   Configurable<int> maxNtracksInSet{"maxNtracksInSet", 10, "Size of the set to consider for the TOF ev. time computation"};
+  Configurable<int> maxNtracksForEvTime{"maxNtracksForEvTime", -1, "Maximum number of tracks for the TOF ev. time of a collision, above it one track out of N is used (-1: no limit)"};
   // TOF Calib configuration
   Configurable<std::string> paramFileName{"paramFileName", "", "Path to the parametrization object. If empty the parametrization is not taken from file"};
   Configurable<std::string> parametrizationPath{"parametrizationPath", "TOF/Calib/Params", "Path of the TOF parametrization on the CCDB or in the file, if the paramFileName is not empty"};
@@ -325,6 +329,25 @@ struct tofEventTime {
     o2::tof::eventTimeContainer::printConfig();
   }
 
+  /// Sets the sampling of the tracks used for the TOF event time of a collision.
+  /// The cost of the event time grows with the number of tracks, for collisions with more than maxNtracksForEvTime tracks
+  /// only one track out of N is used, with N the smallest integer that brings the number of tracks below the limit
+  template <typename trackTypeContainer>
+  void setTrackSampling(const trackTypeContainer& tracksInCollision)
+  {
+    trackSampleStride = 1;
+    if (maxNtracksForEvTime.value <= 0) {
+      return;
+    }
+    int nTracks = 0;
+    for (auto const& trk : tracksInCollision) {
+      nTracks += filterForTOFEventTime(trk);
+    }
+    if (nTracks > maxNtracksForEvTime.value) {
+      trackSampleStride = (nTracks + maxNtracksForEvTime.value - 1) / maxNtracksForEvTime.value;
+    }
+  }
+
   ///
   /// Process function to prepare the event for each track on Run 2 data
   void processRun2(aod::Tracks const& tracks,
@@ -387,6 +410,7 @@ struct tofEventTime {
       lastCollisionId = t.collisionId(); /// Cache last collision ID
 
       const auto& tracksInCollision = tracks.sliceBy(perCollision, lastCollisionId);
+      setTrackSampling(tracksInCollision);
 
       // First make table for event time
       const auto evTimeTOF = evTimeMakerForTracks<TrksEvTime::iterator, filterForTOFEventTime, o2::pid::tof::ExpTimes>(tracksInCollision, mRespParamsV2, diamond);
@@ -450,6 +474,7 @@ struct tofEventTime {
 
       const auto& tracksInCollision = tracks.sliceBy(perCollision, lastCollisionId);
       const auto& collision = t.collision_as<EvTimeCollisionsFT0>();
+      setTrackSampling(tracksInCollision);
 
       // Compute the TOF event time
       const auto evTimeTOF = evTimeMakerForTracks<TrksEvTime::iterator, filterForTOFEventTime, o2::pid::tof::ExpTimes>(tracksInCollision, mRespParamsV2, diamond);
@@ -631,6 +656,7 @@ struct tofPidMerge {
   // Running variables
   std::vector<int> mEnabledParticles;     // Vector of enabled PID hypotheses to loop on when making tables
   std::vector<int> mEnabledParticlesFull; // Vector of enabled PID hypotheses to loop on when making full tables
+  std::vector<int> mEnabledParticlesAny;  // Vector of PID hypotheses enabled for the tiny or the full tables, for which the response is computed
   void init(o2::framework::InitContext& initContext)
   {
     if (inheritFromBaseTask.value) { // Inheriting from base task
@@ -678,6 +704,9 @@ struct tofPidMerge {
       if (f == 1) {
         mEnabledParticlesFull.push_back(i);
       }
+      if (std::find(mEnabledParticles.begin(), mEnabledParticles.end(), i) != mEnabledParticles.end() || f == 1) {
+        mEnabledParticlesAny.push_back(i);
+      }
     }
     // Printing enabled tables and enabling QA histograms if needed
     LOG(info) << "++ Enabled tables:";
@@ -966,7 +995,15 @@ struct tofPidMerge {
       reserveTable(pidId, tracks.size(), true);
     }
 
-    float resolution = 1.f; // Last resolution assigned
+    // expected resolutions and separations of the enabled hypotheses, computed once per track for the tiny and the full tables
+    o2::pid::tof::TOFResponseInputs inputs;
+    std::array<float, nSpecies> resolutions{};
+    std::array<float, nSpecies> nsigmas{};
+    auto computeResponse = [&](const auto& response, const int pidId) {
+      resolutions[pidId] = response.GetExpectedSigma(mRespParamsV2, inputs);
+      nsigmas[pidId] = response.GetSeparation(inputs, resolutions[pidId]);
+    };
+
     float nsigma = 0;
     for (auto const& trk : tracks) { // Loop on all tracks
       if (!trk.has_collision()) {    // Track was not assigned, cannot compute NSigma (no event time) -> filling with empty table
@@ -979,123 +1016,116 @@ struct tofPidMerge {
         continue;
       }
 
+      inputs.fill(mRespParamsV2, trk);
+      for (auto const& pidId : mEnabledParticlesAny) {
+        switch (pidId) {
+          case idxEl:
+            computeResponse(responseEl, pidId);
+            break;
+          case idxMu:
+            computeResponse(responseMu, pidId);
+            break;
+          case idxPi:
+            computeResponse(responsePi, pidId);
+            break;
+          case idxKa:
+            computeResponse(responseKa, pidId);
+            break;
+          case idxPr:
+            computeResponse(responsePr, pidId);
+            break;
+          case idxDe:
+            computeResponse(responseDe, pidId);
+            break;
+          case idxTr:
+            computeResponse(responseTr, pidId);
+            break;
+          case idxHe:
+            computeResponse(responseHe, pidId);
+            break;
+          case idxAl:
+            computeResponse(responseAl, pidId);
+            break;
+          default:
+            LOG(fatal) << "Wrong particle ID";
+            break;
+        }
+      }
+
       for (auto const& pidId : mEnabledParticles) { // Loop on enabled particle hypotheses
+        nsigma = nsigmas[pidId];
         switch (pidId) {
-          case idxEl: {
-            nsigma = responseEl.GetSeparation(mRespParamsV2, trk);
+          case idxEl:
             aod::pidutils::packInTable<aod::pidtof_tiny::binning>(nsigma, tablePIDEl);
             break;
-          }
-          case idxMu: {
-            nsigma = responseMu.GetSeparation(mRespParamsV2, trk);
+          case idxMu:
             aod::pidutils::packInTable<aod::pidtof_tiny::binning>(nsigma, tablePIDMu);
             break;
-          }
-          case idxPi: {
-            nsigma = responsePi.GetSeparation(mRespParamsV2, trk);
+          case idxPi:
             aod::pidutils::packInTable<aod::pidtof_tiny::binning>(nsigma, tablePIDPi);
             break;
-          }
-          case idxKa: {
-            nsigma = responseKa.GetSeparation(mRespParamsV2, trk);
+          case idxKa:
             aod::pidutils::packInTable<aod::pidtof_tiny::binning>(nsigma, tablePIDKa);
             break;
-          }
-          case idxPr: {
-            nsigma = responsePr.GetSeparation(mRespParamsV2, trk);
+          case idxPr:
             aod::pidutils::packInTable<aod::pidtof_tiny::binning>(nsigma, tablePIDPr);
             break;
-          }
-          case idxDe: {
-            nsigma = responseDe.GetSeparation(mRespParamsV2, trk);
+          case idxDe:
             aod::pidutils::packInTable<aod::pidtof_tiny::binning>(nsigma, tablePIDDe);
             break;
-          }
-          case idxTr: {
-            nsigma = responseTr.GetSeparation(mRespParamsV2, trk);
+          case idxTr:
             aod::pidutils::packInTable<aod::pidtof_tiny::binning>(nsigma, tablePIDTr);
             break;
-          }
-          case idxHe: {
-            nsigma = responseHe.GetSeparation(mRespParamsV2, trk);
+          case idxHe:
             aod::pidutils::packInTable<aod::pidtof_tiny::binning>(nsigma, tablePIDHe);
             break;
-          }
-          case idxAl: {
-            nsigma = responseAl.GetSeparation(mRespParamsV2, trk);
+          case idxAl:
             aod::pidutils::packInTable<aod::pidtof_tiny::binning>(nsigma, tablePIDAl);
             break;
-          }
           default:
             LOG(fatal) << "Wrong particle ID for standard tables";
             break;
         }
         if (enableQaHistograms) {
-          hnsigma[pidId]->Fill(trk.p(), nsigma);
+          hnsigma[pidId]->Fill(inputs.mom, nsigma);
         }
       }
       for (auto const& pidId : mEnabledParticlesFull) { // Loop on enabled particle hypotheses with full tables
+        nsigma = nsigmas[pidId];
         switch (pidId) {
-          case idxEl: {
-            resolution = responseEl.GetExpectedSigma(mRespParamsV2, trk);
-            nsigma = responseEl.GetSeparation(mRespParamsV2, trk, resolution);
-            tablePIDFullEl(resolution, nsigma);
+          case idxEl:
+            tablePIDFullEl(resolutions[pidId], nsigma);
             break;
-          }
-          case idxMu: {
-            resolution = responseMu.GetExpectedSigma(mRespParamsV2, trk);
-            nsigma = responseMu.GetSeparation(mRespParamsV2, trk, resolution);
-            tablePIDFullMu(resolution, nsigma);
+          case idxMu:
+            tablePIDFullMu(resolutions[pidId], nsigma);
             break;
-          }
-          case idxPi: {
-            resolution = responsePi.GetExpectedSigma(mRespParamsV2, trk);
-            nsigma = responsePi.GetSeparation(mRespParamsV2, trk);
-            tablePIDFullPi(resolution, nsigma);
+          case idxPi:
+            tablePIDFullPi(resolutions[pidId], nsigma);
             break;
-          }
-          case idxKa: {
-            resolution = responseKa.GetExpectedSigma(mRespParamsV2, trk);
-            nsigma = responseKa.GetSeparation(mRespParamsV2, trk, resolution);
-            tablePIDFullKa(resolution, nsigma);
+          case idxKa:
+            tablePIDFullKa(resolutions[pidId], nsigma);
             break;
-          }
-          case idxPr: {
-            resolution = responsePr.GetExpectedSigma(mRespParamsV2, trk);
-            nsigma = responsePr.GetSeparation(mRespParamsV2, trk, resolution);
-            tablePIDFullPr(resolution, nsigma);
+          case idxPr:
+            tablePIDFullPr(resolutions[pidId], nsigma);
             break;
-          }
-          case idxDe: {
-            resolution = responseDe.GetExpectedSigma(mRespParamsV2, trk);
-            nsigma = responseDe.GetSeparation(mRespParamsV2, trk, resolution);
-            tablePIDFullDe(resolution, nsigma);
+          case idxDe:
+            tablePIDFullDe(resolutions[pidId], nsigma);
             break;
-          }
-          case idxTr: {
-            resolution = responseTr.GetExpectedSigma(mRespParamsV2, trk);
-            nsigma = responseTr.GetSeparation(mRespParamsV2, trk, resolution);
-            tablePIDFullTr(resolution, nsigma);
+          case idxTr:
+            tablePIDFullTr(resolutions[pidId], nsigma);
             break;
-          }
-          case idxHe: {
-            resolution = responseHe.GetExpectedSigma(mRespParamsV2, trk);
-            nsigma = responseHe.GetSeparation(mRespParamsV2, trk, resolution);
-            tablePIDFullHe(resolution, nsigma);
+          case idxHe:
+            tablePIDFullHe(resolutions[pidId], nsigma);
             break;
-          }
-          case idxAl: {
-            resolution = responseAl.GetExpectedSigma(mRespParamsV2, trk);
-            nsigma = responseAl.GetSeparation(mRespParamsV2, trk, resolution);
-            tablePIDFullAl(resolution, nsigma);
+          case idxAl:
+            tablePIDFullAl(resolutions[pidId], nsigma);
             break;
-          }
           default:
             LOG(fatal) << "Wrong particle ID for full tables";
             break;
         }
         if (enableQaHistograms) {
-          hnsigmaFull[pidId]->Fill(trk.p(), nsigma);
+          hnsigmaFull[pidId]->Fill(inputs.mom, nsigma);
         }
       }
     }
@@ -19,6 +19,11 @@
 ///         QA histograms for the TPC PID can be produced by adding `--add-qa 1` to the workflow
 ///
 
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <vector>
+
 // ROOT includes
 #include "TFile.h"
 #include "TRandom.h"
@@ -82,6 +87,18 @@ struct tpcPid {
   std::map<std::string, std::string> metadata;
   std::map<std::string, std::string> headers;
   std::vector<int> speciesNetworkFlags = std::vector<int>(9);
+  // Mass hypotheses with an enabled table, evaluated together for each track
+  std::vector<o2::track::PID::ID> enabledSpecies;
+  std::array<int, 9> enabledSpeciesSlot;
+  std::array<float, 9> bulkExpSignal;
+  std::array<float, 9> bulkExpSigma;
+  std::array<float, 9> bulkNSigma;
+  // Streaming evaluation of the network correction
+  std::vector<float> networkTrackFeatures; // species independent network inputs, 5 per track
+  std::vector<std::thread> networkWorkers;
+  std::vector<std::promise<void>> networkChunkPromises;
+  std::vector<std::future<void>> networkChunkReady;
+  uint64_t networkNextChunk = 0; // first chunk not yet collected by the table filling
 
   // Input parameters
   Service<o2::ccdb::BasicCCDBManager> ccdb;
@@ -98,6 +115,8 @@ struct tpcPid {
   Configurable<std::string> networkPathCCDB{"networkPathCCDB", "Analysis/PID/TPC/ML", "Path on CCDB"};
   Configurable<bool> enableNetworkOptimizations{"enableNetworkOptimizations", 1, "(bool) If the neural network correction is used, this enables GraphOptimizationLevel::ORT_ENABLE_EXTENDED in the ONNX session"};
   Configurable<int> networkSetNumThreads{"networkSetNumThreads", 0, "Especially important for running on a SLURM cluster. Sets the number of threads used for execution."};
+  Configurable<int> networkChunkSize{"networkChunkSize", 0, "(int) Streaming mode: number of tracks per network evaluation, evaluated asynchronously while the PID tables are filled. 0 evaluates all tracks of the data frame at once"};
+  Configurable<int> networkNumWorkers{"networkNumWorkers", 1, "(int) Streaming mode: number of worker threads evaluating the network chunks"};
   // Configuration flags to include and exclude particle hypotheses
   Configurable<int> pidEl{"pid-el", -1, {"Produce PID information for the Electron mass hypothesis, overrides the automatic setup: the corresponding table can be set off (0) or on (1)"}};
   Configurable<int> pidMu{"pid-mu", -1, {"Produce PID information for the Muon mass hypothesis, overrides the automatic setup: the corresponding table can be set off (0) or on (1)"}};
@@ -147,6 +166,25 @@ struct tpcPid {
       enableFlagIfTableRequired(initContext, "mcTPCTuneOnData", enableTuneOnDataTable);
     }
 
+    // Slots of the enabled mass hypotheses in the bulk evaluation
+    enabledSpeciesSlot.fill(-1);
+    auto enableSpecies = [&](const Configurable<int>& flag, const o2::track::PID::ID id) {
+      if (flag.value != 1) {
+        return;
+      }
+      enabledSpeciesSlot[id] = enabledSpecies.size();
+      enabledSpecies.push_back(id);
+    };
+    enableSpecies(pidEl, o2::track::PID::Electron);
+    enableSpecies(pidMu, o2::track::PID::Muon);
+    enableSpecies(pidPi, o2::track::PID::Pion);
+    enableSpecies(pidKa, o2::track::PID::Kaon);
+    enableSpecies(pidPr, o2::track::PID::Proton);
+    enableSpecies(pidDe, o2::track::PID::Deuteron);
+    enableSpecies(pidTr, o2::track::PID::Triton);
+    enableSpecies(pidHe, o2::track::PID::Helium3);
+    enableSpecies(pidAl, o2::track::PID::Alpha);
+
     speciesNetworkFlags[0] = useNetworkEl;
     speciesNetworkFlags[1] = useNetworkMu;
     speciesNetworkFlags[2] = useNetworkPi;
@@ -240,11 +278,8 @@ struct tpcPid {
   Partition<Trks> tracksWithTPC = (aod::track::tpcNClsFindable > (uint8_t)0);
 
   template <typename C, typename T, typename B>
-  std::vector<float> createNetworkPrediction(C const& collisions, T const& tracks, B const& bcs, const size_t size)
+  void createNetworkPrediction(C const& collisions, T const& tracks, B const& bcs, const size_t size, std::vector<float>& network_prediction)
   {
-
-    std::vector<float> network_prediction;
-
     auto start_network_total = std::chrono::high_resolution_clock::now();
     if (autofetchNetworks) {
       const auto& bc = bcs.begin();
@@ -288,6 +323,12 @@ struct tpcPid {
 
     network_prediction = std::vector<float>(prediction_size * 9); // For each mass hypotheses
     const float nNclNormalization = response->GetNClNormalization();
+
+    if (networkChunkSize > 0) {
+      startNetworkStream(collisions, tracks, size, nNclNormalization, network_prediction);
+      return;
+    }
+
     float duration_network = 0;
 
     std::vector<float> track_properties(track_prop_size);
@@ -333,8 +374,115 @@ struct tpcPid {
     auto stop_network_total = std::chrono::high_resolution_clock::now();
     LOG(debug) << "Neural Network for the TPC PID response correction: Time per track (eval ONNX): " << duration_network / (size * 9) << "ns ; Total time (eval ONNX): " << duration_network / 1000000000 << " s";
     LOG(debug) << "Neural Network for the TPC PID response correction: Time per track (eval + overhead): " << std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_total - start_network_total).count() / (size * 9) << "ns ; Total time (eval + overhead): " << std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_total - start_network_total).count() / 1000000000 << " s";
+  }
+
+  /// Streaming mode of the network correction: the species independent inputs are collected once per track, then the tracks are
+  /// split in chunks of networkChunkSize which are evaluated by networkNumWorkers threads while the tables are being filled.
+  /// The predictions are written with the same layout as the one-shot evaluation; waitForNetworkChunk() must be called before reading them
+  template <typename C, typename T>
+  void startNetworkStream(C const& collisions, T const& tracks, const uint64_t size, const float nNclNormalization, std::vector<float>& network_prediction)
+  {
+    networkTrackFeatures.resize(5 * size); // capacity is kept between data frames
+    uint64_t counter_track = 0;
+    for (auto const& trk : tracks) {
+      if (!trk.hasTPC()) {
+        continue;
+      }
+      if (skipTPCOnly) {
+        if (!trk.hasITS() && !trk.hasTRD() && !trk.hasTOF()) {
+          continue;
+        }
+      }
+      float* features = &networkTrackFeatures[5 * counter_track];
+      features[0] = trk.tpcInnerParam();
+      features[1] = trk.tgl();
+      features[2] = trk.signed1Pt();
+      features[3] = trk.has_collision() ? collisions.iteratorAt(trk.collisionId()).multTPC() / 11000. : 1.;
+      features[4] = std::sqrt(nNclNormalization / trk.tpcNClsFound());
+      counter_track++;
+    }
 
-    return network_prediction;
+    const uint64_t chunkSize = networkChunkSize.value;
+    const uint64_t nChunks = (size + chunkSize - 1) / chunkSize;
+    const int nWorkers = std::max(1, std::min(networkNumWorkers.value, static_cast<int>(nChunks)));
+    networkChunkPromises = std::vector<std::promise<void>>(nChunks); // not resized until the workers are joined
+    networkChunkReady.clear();
+    for (auto& promise : networkChunkPromises) {
+      networkChunkReady.push_back(promise.get_future());
+    }
+    networkNextChunk = 0;
+
+    float* prediction = network_prediction.data();
+    for (int iWorker = 0; iWorker < nWorkers; iWorker++) {
+      // each worker takes every nWorkers-th chunk, in track order, reusing its input and output buffers
+      networkWorkers.emplace_back([this, iWorker, nWorkers, nChunks, chunkSize, size, prediction]() {
+        const int input_dimensions = network.getNumInputNodes();
+        const int output_dimensions = network.getNumOutputNodes();
+        std::vector<float> input;
+        std::vector<float> output;
+        for (uint64_t iChunk = iWorker; iChunk < nChunks; iChunk += nWorkers) {
+          try {
+            const uint64_t first = iChunk * chunkSize;
+            const uint64_t nTracks = std::min(chunkSize, size - first);
+            input.resize(9 * nTracks * input_dimensions);
+            uint64_t counter_track_props = 0;
+            for (int i = 0; i < 9; i++) { // Loop over particle number for which network correction is used
+              for (uint64_t t = first; t < first + nTracks; t++) {
+                const float* features = &networkTrackFeatures[5 * t];
+                input[counter_track_props] = features[0];
+                input[counter_track_props + 1] = features[1];
+                input[counter_track_props + 2] = features[2];
+                input[counter_track_props + 3] = o2::track::pid_constants::sMasses[i];
+                input[counter_track_props + 4] = features[3];
+                input[counter_track_props + 5] = features[4];
+                counter_track_props += input_dimensions;
+              }
+            }
+            if (!network.evalModelBatch(input, output)) {
+              LOG(fatal) << "Evaluation of the network correction failed for track chunk " << iChunk;
+            }
+            for (int i = 0; i < 9; i++) {
+              std::copy_n(output.data() + i * nTracks * output_dimensions, nTracks * output_dimensions, prediction + (first + size * i) * output_dimensions);
+            }
+            networkChunkPromises[iChunk].set_value();
+          } catch (...) {
+            networkChunkPromises[iChunk].set_exception(std::current_exception());
+          }
+        }
+      });
+    }
+  }
+
+  /// Blocks until the network predictions for the given network track index are available
+  void waitForNetworkChunk(const uint64_t track)
+  {
+    if (networkChunkReady.empty()) {
+      return;
+    }
+    const uint64_t chunk = track / networkChunkSize.value;
+    while (networkNextChunk <= chunk && networkNextChunk < networkChunkReady.size()) {
+      networkChunkReady[networkNextChunk].get();
+      networkNextChunk++;
+    }
+  }
+
+  /// Joins the workers of the streaming mode once all tables are filled
+  void finishNetworkStream()
+  {
+    for (auto& worker : networkWorkers) {
+      worker.join();
+    }
+    networkWorkers.clear();
+    networkChunkReady.clear();
+    networkChunkPromises.clear();
+  }
+
+  /// Evaluates the response of all enabled mass hypotheses in one pass, reading the track inputs only once
+  template <typename CollisionType, typename TrackType>
+  void fillBulkResponse(CollisionType const& collisions, TrackType const& trk, const float tpcSignal)
+  {
+    const float multTPC = trk.has_collision() ? collisions.iteratorAt(trk.collisionId()).multTPC() : 0.f;
+    response->GetNumberOfSigmaBulk(trk.tpcInnerParam(), tpcSignal, trk.tpcNClsFound(), trk.tgl(), trk.signed1Pt(), multTPC, enabledSpecies.data(), static_cast<int>(enabledSpecies.size()), bulkExpSignal.data(), bulkExpSigma.data(), bulkNSigma.data());
   }
 
   void processStandard(Coll const& collisions, Trks const& tracks, aod::BCsWithTimestamps const& bcs)
@@ -364,7 +512,7 @@ struct tpcPid {
     std::vector<float> network_prediction;
 
     if (useNetworkCorrection) {
-      network_prediction = createNetworkPrediction(collisions, tracks, bcs, tracksForNet_size);
+      createNetworkPrediction(collisions, tracks, bcs, tracksForNet_size, network_prediction);
     }
 
     uint64_t count_tracks = 0;
@@ -390,8 +538,13 @@ struct tpcPid {
         response->PrintAll();
       }
 
+      if (trk.hasTPC()) {
+        fillBulkResponse(collisions, trk, trk.tpcSignal());
+      }
+      waitForNetworkChunk(count_tracks);
+
       // Check and fill enabled tables
-      auto makeTablePid = [&trk, &collisions, &network_prediction, &count_tracks, &tracksForNet_size, this](const int flag, auto& table, const o2::track::PID::ID pid) {
+      auto makeTablePid = [&trk, &network_prediction, &count_tracks, &tracksForNet_size, this](const int flag, auto& table, const o2::track::PID::ID pid) {
         if (flag != 1) {
           return;
         } else {
@@ -405,9 +558,10 @@ struct tpcPid {
               return;
             }
           }
-          auto expSignal = response->GetExpectedSignal(trk, pid);
-          auto expSigma = trk.has_collision() ? response->GetExpectedSigma(collisions.iteratorAt(trk.collisionId()), trk, pid) : 0.07 * expSignal; // use default sigma value of 7% if no collision information to estimate resolution
-          if (expSignal < 0. || expSigma < 0.) {                                                                                                   // skip if expected signal invalid
+          const int slot = enabledSpeciesSlot[pid];
+          auto expSignal = bulkExpSignal[slot];
+          auto expSigma = trk.has_collision() ? bulkExpSigma[slot] : 0.07 * expSignal; // use default sigma value of 7% if no collision information to estimate resolution
+          if (expSignal < 0. || expSigma < 0.) {                                       // skip if expected signal invalid
             table(aod::pidtpc_tiny::binning::underflowBin);
             return;
           }
@@ -430,7 +584,7 @@ struct tpcPid {
               LOGF(fatal, "Network output-dimensions incompatible!");
             }
           } else {
-            aod::pidutils::packInTable<aod::pidtpc_tiny::binning>(response->GetNumberOfSigma(collisions.iteratorAt(trk.collisionId()), trk, pid), table);
+            aod::pidutils::packInTable<aod::pidtpc_tiny::binning>(bulkNSigma[slot], table);
           }
         }
       };
@@ -449,6 +603,7 @@ struct tpcPid {
         count_tracks++; // Increment network track counter only if track has TPC, and (not skipping TPConly) or (is not TPConly)
       }
     }
+    finishNetworkStream();
   }
 
   PROCESS_SWITCH(tpcPid, processStandard, "Creating PID tables without MC TuneOnData", true);
@@ -483,7 +638,7 @@ struct tpcPid {
     std::vector<float> network_prediction;
 
     if (useNetworkCorrection) {
-      network_prediction = createNetworkPrediction(collisionsMc, tracksMc, bcs, tracksForNet_size);
+      createNetworkPrediction(collisionsMc, tracksMc, bcs, tracksForNet_size, network_prediction);
     }
 
     uint64_t count_tracks = 0;
@@ -507,6 +662,7 @@ struct tpcPid {
         }
         response->PrintAll();
       }
+      waitForNetworkChunk(count_tracks);
 
       // Perform TuneOnData sampling for MC dE/dx
       float mcTunedTPCSignal = 0.;
@@ -541,8 +697,12 @@ struct tpcPid {
       }
       tableTuneOnData(mcTunedTPCSignal);
 
+      if (trk.hasTPC() && mcTunedTPCSignal >= 0.f) {
+        fillBulkResponse(collisionsMc, trk, mcTunedTPCSignal);
+      }
+
       // Check and fill enabled nsigma tables
-      auto makeTablePid = [&trk, &collisionsMc, &network_prediction, &count_tracks, &tracksForNet_size, &mcTunedTPCSignal, this](const int flag, auto& table, const o2::track::PID::ID pid) {
+      auto makeTablePid = [&trk, &network_prediction, &count_tracks, &tracksForNet_size, &mcTunedTPCSignal, this](const int flag, auto& table, const o2::track::PID::ID pid) {
         if (flag != 1) {
           return;
         }
@@ -557,9 +717,10 @@ struct tpcPid {
             return;
           }
         }
-        auto expSignal = response->GetExpectedSignal(trk, pid);
-        auto expSigma = trk.has_collision() ? response->GetExpectedSigma(collisionsMc.iteratorAt(trk.collisionId()), trk, pid) : 0.07 * expSignal; // use default sigma value of 7% if no collision information to estimate resolution
-        if (expSignal < 0. || expSigma < 0.) {                                                                                                     // skip if expected signal invalid
+        const int slot = enabledSpeciesSlot[pid];
+        auto expSignal = bulkExpSignal[slot];
+        auto expSigma = trk.has_collision() ? bulkExpSigma[slot] : 0.07 * expSignal; // use default sigma value of 7% if no collision information to estimate resolution
+        if (expSignal < 0. || expSigma < 0.) {                                       // skip if expected signal invalid
           table(aod::pidtpc_tiny::binning::underflowBin);
           return;
         }
@@ -585,7 +746,7 @@ struct tpcPid {
           }
 
         } else {
-          aod::pidutils::packInTable<aod::pidtpc_tiny::binning>(response->GetNumberOfSigmaMCTuned(collisionsMc.iteratorAt(trk.collisionId()), trk, pid, mcTunedTPCSignal), table);
+          aod::pidutils::packInTable<aod::pidtpc_tiny::binning>(bulkNSigma[slot], table);
         }
       };
 
@@ -603,6 +764,7 @@ struct tpcPid {
         count_tracks++; // Increment network track counter only if track has TPC, and (not skipping TPConly) or (is not TPConly)
       }
     }
+    finishNetworkStream();
   }
 
   PROCESS_SWITCH(tpcPid, processMcTuneOnData, "Creating PID tables with MC TuneOnData", false);
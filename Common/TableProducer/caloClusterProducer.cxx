@@ -9,6 +9,11 @@
 // granted to it by virtue of its status as an Intergovernmental Organization
 // or submit itself to any jurisdiction.
 
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <vector>
+
 #include "Framework/ConfigParamSpec.h"
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
@@ -53,6 +58,7 @@ struct caloClusterProducerTask {
   Configurable<std::string> mBadMapPath{"badmapPath", "PHS/Calib/BadMap", "path to BadMap snapshot"};
   Configurable<std::string> mCalibPath{"calibPath", "PHS/Calib/CalibParams", "path to Calibration snapshot"};
   Configurable<std::string> mL1PhasePath{"L1phasePath", "PHS/Calib/L1phase", "path to L1phase snapshot"};
+  Configurable<bool> concurrentCpv{"concurrentCpv", false, "run the PHOS clusterization on a separate thread while the CPV clusters are indexed"};
 
   Service<o2::ccdb::BasicCCDBManager> ccdb;
 
@@ -65,6 +71,8 @@ struct caloClusterProducerTask {
   std::vector<o2::phos::TriggerRecord> outputPHOSClusterTrigRecs;
   std::vector<int> mclabels;
   std::vector<float> mcamplitudes;
+  o2::dataformats::MCTruthContainer<o2::phos::MCLabel> cellTruth;
+  std::vector<int64_t> mPhosClusterBCs; // BCs with PHOS clusters, sorted
 
   int mRunNumber{0};
 
@@ -87,18 +95,85 @@ struct caloClusterProducerTask {
     int indx = -1;    // track global index
   };
 
-  class trackTrigRec
+  // Points (CPV clusters or track impacts in the PHOS plane) of the timeframe grouped by BC and by matching region (CpvMatchIndex),
+  // stored in flat arrays which are reused between timeframes
+  template <typename Point>
+  class RegionIndex
   {
    public:
-    trackTrigRec() = default;
-    ~trackTrigRec() = default;
-
-   public:
-    int64_t mTR;           // BC ref
-    int mStart[kCpvCells]; // X (phi) track coordinate in PHOS plane
-    int mEnd[kCpvCells];   // Z (theta) track coordinate in PHOS plane
+    void clear()
+    {
+      mBCs.clear();
+      mEntries.clear();
+    }
+
+    // adds a BC, also if it gets no point (e.g. only CPV clusters below threshold)
+    void addBC(int64_t bc)
+    {
+      if (mBCs.empty() || mBCs.back() != bc) {
+        mBCs.push_back(bc);
+      }
+    }
+
+    void add(int64_t bc, int region, Point const& point)
+    {
+      addBC(bc);
+      mEntries.push_back({bc, region, point});
+    }
+
+    // sorts the points by BC and region, keeping the order of addition inside a region
+    void build()
+    {
+      std::sort(mBCs.begin(), mBCs.end());
+      mBCs.erase(std::unique(mBCs.begin(), mBCs.end()), mBCs.end());
+      mOffsets.assign(mBCs.size() * kCpvCells + 1, 0);
+      mKeys.resize(mEntries.size());
+      for (size_t i = 0; i < mEntries.size(); i++) {
+        mKeys[i] = find(mEntries[i].bc) * kCpvCells + mEntries[i].region;
+        mOffsets[mKeys[i] + 1]++;
+      }
+      std::partial_sum(mOffsets.begin(), mOffsets.end(), mOffsets.begin());
+      mFill.assign(mOffsets.begin(), mOffsets.end() - 1);
+      mPoints.resize(mEntries.size());
+      for (size_t i = 0; i < mEntries.size(); i++) {
+        mPoints[mFill[mKeys[i]]++] = mEntries[i].point;
+      }
+    }
+
+    // position of the BC in the index, -1 if the BC is not there
+    int find(int64_t bc) const
+    {
+      auto it = std::lower_bound(mBCs.begin(), mBCs.end(), bc);
+      return (it == mBCs.end() || *it != bc) ? -1 : static_cast<int>(it - mBCs.begin());
+    }
+
+    // points of a region in the BC at the given position, empty for a missing BC or a region outside of the grid
+    gsl::span<const Point> points(int bcPos, int region) const
+    {
+      if (bcPos < 0 || region < 0 || region >= kCpvCells) {
+        return {};
+      }
+      const int key = bcPos * kCpvCells + region;
+      return {mPoints.data() + mOffsets[key], static_cast<size_t>(mOffsets[key + 1] - mOffsets[key])};
+    }
+
+   private:
+    struct Entry {
+      int64_t bc;
+      int region;
+      Point point;
+    };
+    std::vector<int64_t> mBCs;   // sorted BCs
+    std::vector<Entry> mEntries; // points in the order of addition
+    std::vector<int> mKeys;      // BC position * kCpvCells + region of the entries
+    std::vector<int> mOffsets;   // first point of each (BC, region)
+    std::vector<int> mFill;
+    std::vector<Point> mPoints; // points sorted by (BC, region)
   };
 
+  RegionIndex<std::pair<float, float>> mCpvIndex; // CPV cluster positions
+  RegionIndex<trackMatch> mTrackIndex;            // track impacts in PHOS
+
   void init(o2::framework::InitContext&)
   {
     ccdb->setURL(o2::base::NameConf::getCCDBServer());
@@ -182,6 +257,8 @@ struct caloClusterProducerTask {
 
     o2::InteractionRecord ir;
     const int kPHOS = 0;
+    int64_t lastBCId = -1;
+    uint64_t cellBC = 0; // global BC of the current cell, looked up once per BC
     for (auto& c : cells) {
       if (c.caloType() != kPHOS) // PHOS
         continue;
@@ -189,15 +266,19 @@ struct caloClusterProducerTask {
       if ((c.cellType() == phos::TRU2x2 || c.cellType() == phos::TRU4x4) && c.cellNumber() == 0) {
         continue;
       }
+      if (c.bcId() != lastBCId) {
+        lastBCId = c.bcId();
+        cellBC = c.bc_as<aod::BCsWithTimestamps>().globalBC();
+      }
       if (phosCellTRs.size() == 0) { // first cell, first TrigRec
-        ir.setFromLong(c.bc_as<aod::BCsWithTimestamps>().globalBC());
+        ir.setFromLong(cellBC);
         phosCellTRs.emplace_back(ir, 0, 0); // BC,first cell, ncells
       }
-      if (static_cast<uint64_t>(phosCellTRs.back().getBCData().toLong()) != c.bc_as<aod::BCsWithTimestamps>().globalBC()) { // switch to new BC
+      if (static_cast<uint64_t>(phosCellTRs.back().getBCData().toLong()) != cellBC) { // switch to new BC
         // switch to another BC: set size and create next TriRec
         phosCellTRs.back().setNumberOfObjects(phosCells.size() - phosCellTRs.back().getFirstEntry());
         // Next event/trig rec.
-        ir.setFromLong(c.bc_as<aod::BCsWithTimestamps>().globalBC());
+        ir.setFromLong(cellBC);
         phosCellTRs.emplace_back(ir, phosCells.size(), 0);
       }
       phosCells.emplace_back(c.cellNumber(), c.amplitude(), c.time(),
@@ -208,51 +289,9 @@ struct caloClusterProducerTask {
       phosCellTRs.back().setNumberOfObjects(phosCells.size() - phosCellTRs.back().getFirstEntry());
     }
 
-    // clusterize
+    // clusterize PHOS, and index the CPV clusters in the meantime
     o2::dataformats::MCTruthContainer<o2::phos::MCLabel> dummyMC;
-    clusterizerPHOS->processCells(phosCells, phosCellTRs, nullptr,
-                                  outputPHOSClusters, outputCluElements, outputPHOSClusterTrigRecs, dummyMC);
-
-    // Find  CPV clusters corresponding to PHOS trigger records
-    std::vector<std::pair<float, float>> cpvMatchPoints[kCpvCells];
-    // Number of entries in each cell per TrigRecord
-    std::vector<trackTrigRec> cpvNMatchPoints;
-    cpvNMatchPoints.reserve(outputPHOSClusterTrigRecs.size());
-    int64_t curBC = -1;
-    if (cpvs.begin() != cpvs.end()) {
-      curBC = cpvs.begin().bc_as<aod::BCsWithTimestamps>().globalBC();
-      cpvNMatchPoints.emplace_back();
-      cpvNMatchPoints.back().mTR = curBC;
-      for (int i = kCpvCells; i--;) {
-        cpvNMatchPoints.back().mStart[i] = 0;
-      }
-    }
-
-    for (const auto& cpvclu : cpvs) {
-      if (static_cast<int64_t>(cpvclu.bc_as<aod::BCsWithTimestamps>().globalBC()) != curBC) { // new BC
-        // mark last entry in previous range
-        for (int i = kCpvCells; i--;) {
-          cpvNMatchPoints.back().mEnd[i] = cpvMatchPoints[i].size();
-        }
-        curBC = cpvclu.bc_as<aod::BCsWithTimestamps>().globalBC();
-        cpvNMatchPoints.back() = cpvNMatchPoints.emplace_back();
-        cpvNMatchPoints.back().mTR = curBC;
-        for (int i = kCpvCells; i--;) {
-          cpvNMatchPoints.back().mStart[i] = cpvMatchPoints[i].size();
-        }
-      }
-      // anyway add coordinates
-      if (cpvclu.amplitude() < static_cast<std::vector<double>>(cpvMinE)[static_cast<int>(cpvclu.moduleNumber()) - 2]) {
-        continue;
-      }
-      int index = CpvMatchIndex(cpvclu.moduleNumber(), cpvclu.posX(), cpvclu.posZ());
-      cpvMatchPoints[index].emplace_back(cpvclu.posX(), cpvclu.posZ());
-    }
-    if (cpvNMatchPoints.size() > 0) {
-      for (int i = kCpvCells; i--;) {
-        cpvNMatchPoints.back().mEnd[i] = cpvMatchPoints[i].size();
-      }
-    }
+    clusterizeAndIndexCpv(cpvs, nullptr, dummyMC);
 
     // Fill output
     for (auto& cluTR : outputPHOSClusterTrigRecs) {
@@ -270,16 +309,9 @@ struct caloClusterProducerTask {
         colId = coliter->second;
       }
 
-      bool cpvExist = false;
-      // find cpvTR for this BC
-      auto cpvPoints = cpvNMatchPoints.begin();
-      while (cpvPoints != cpvNMatchPoints.end()) {
-        if (cpvPoints->mTR == cluTR.getBCData().toLong()) {
-          cpvExist = true;
-          break;
-        }
-        cpvPoints++;
-      }
+      // CPV clusters of this BC
+      const int cpvBC = mCpvIndex.find(cluTR.getBCData().toLong());
+      bool cpvExist = cpvBC >= 0;
 
       for (int i = firstClusterInEvent; i < lastClusterInEvent; i++) {
         o2::phos::Cluster& clu = outputPHOSClusters[i];
@@ -311,49 +343,19 @@ struct caloClusterProducerTask {
         mom.SetMag(e);
 
         float cpvdist = 99.;
-        const float cellSizeX = 2 * cpvMaxX / kCpvX;
-        const float cellSizeZ = 2 * cpvMaxZ / kCpvZ;
         // look 9 CPV regions around PHOS cluster
 
         if (mod >= 2 && cpvExist) { // CPV exist in mods 2,3,4
-          int phosIndex = CpvMatchIndex(mod, posX, posZ);
-          std::vector<int> regions;
-          regions.push_back(phosIndex);
-          if (posX > -cpvMaxX + cellSizeX) {
-            if (posZ > -cpvMaxZ + cellSizeZ) { // bottom left
-              regions.push_back(phosIndex - kCpvZ - 1);
-            }
-            regions.push_back(phosIndex - kCpvZ);
-            if (posZ < cpvMaxZ - cellSizeZ) { // top left
-              regions.push_back(phosIndex - kCpvZ + 1);
-            }
-          }
-          if (posZ > -cpvMaxZ + cellSizeZ) { // bottom
-            regions.push_back(phosIndex - 1);
-          }
-          if (posZ < cpvMaxZ - cellSizeZ) { // top
-            regions.push_back(phosIndex + 1);
-          }
-          if (posX < cpvMaxX - cellSizeX) {
-            if (posZ > -cpvMaxZ + cellSizeZ) { // bottom right
-              regions.push_back(phosIndex + kCpvZ - 1);
-            }
-            regions.push_back(phosIndex + kCpvZ);
-            if (posZ < cpvMaxZ - cellSizeZ) { // top right
-              regions.push_back(phosIndex + kCpvZ + 1);
-            }
-          }
+          int regions[9];
+          const int nRegions = matchRegions(mod, posX, posZ, regions);
           float sigmaX = 1. / TMath::Min(5.2, 1.111 + 0.56 * TMath::Exp(-0.031 * e * e) + 4.8 / TMath::Power(e + 0.61, 3)); // inverse sigma X
           float sigmaZ = 1. / TMath::Min(3.3, 1.12 + 0.35 * TMath::Exp(-0.032 * e * e) + 0.75 / TMath::Power(e + 0.24, 3)); // inverse sigma Z
 
-          for (int indx : regions) {
-            if (indx >= 0 && indx < kCpvCells) {
-              for (int ii = cpvPoints->mStart[indx]; ii < cpvPoints->mEnd[indx]; ii++) {
-                auto p = cpvMatchPoints[indx][ii];
-                float d = pow((p.first - posX) * sigmaX, 2) + pow((p.second - posZ) * sigmaZ, 2);
-                if (d < cpvdist) {
-                  cpvdist = d;
-                }
+          for (int ir = 0; ir < nRegions; ir++) {
+            for (const auto& p : mCpvIndex.points(cpvBC, regions[ir])) {
+              float d = pow((p.first - posX) * sigmaX, 2) + pow((p.second - posZ) * sigmaZ, 2);
+              if (d < cpvdist) {
+                cpvdist = d;
               }
             }
           }
@@ -476,7 +478,9 @@ struct caloClusterProducerTask {
 
     o2::InteractionRecord ir;
     const int kPHOS = 0;
-    o2::dataformats::MCTruthContainer<o2::phos::MCLabel> cellTruth;
+    int64_t lastBCId = -1;
+    uint64_t cellBC = 0; // global BC of the current cell, looked up once per BC
+    cellTruth.clear();
     for (auto& c : cells) {
       if (c.caloType() != kPHOS) // PHOS
         continue;
@@ -484,15 +488,19 @@ struct caloClusterProducerTask {
       if ((c.cellType() == phos::TRU2x2 || c.cellType() == phos::TRU4x4) && c.cellNumber() == 0) {
         continue;
       }
+      if (c.bcId() != lastBCId) {
+        lastBCId = c.bcId();
+        cellBC = c.bc_as<aod::BCsWithTimestamps>().globalBC();
+      }
       if (phosCellTRs.size() == 0) { // first cell, first TrigRec
-        ir.setFromLong(c.bc_as<aod::BCsWithTimestamps>().globalBC());
+        ir.setFromLong(cellBC);
         phosCellTRs.emplace_back(ir, 0, 0); // BC,first cell, ncells
       }
-      if (static_cast<uint64_t>(phosCellTRs.back().getBCData().toLong()) != c.bc_as<aod::BCsWithTimestamps>().globalBC()) { // switch to new BC
+      if (static_cast<uint64_t>(phosCellTRs.back().getBCData().toLong()) != cellBC) { // switch to new BC
         // switch to another BC: set size and create next TriRec
         phosCellTRs.back().setNumberOfObjects(phosCells.size() - phosCellTRs.back().getFirstEntry());
         // Next event/trig rec.
-        ir.setFromLong(c.bc_as<aod::BCsWithTimestamps>().globalBC());
+        ir.setFromLong(cellBC);
         phosCellTRs.emplace_back(ir, phosCells.size(), 0);
       }
       phosCells.emplace_back(c.cellNumber(), c.amplitude(), c.time(),
@@ -524,51 +532,9 @@ struct caloClusterProducerTask {
       phosCellTRs.back().setNumberOfObjects(phosCells.size() - phosCellTRs.back().getFirstEntry());
     }
 
-    // clusterize
+    // clusterize PHOS, and index the CPV clusters in the meantime
     o2::dataformats::MCTruthContainer<o2::phos::MCLabel> outputTruthCont;
-    clusterizerPHOS->processCells(phosCells, phosCellTRs, &cellTruth,
-                                  outputPHOSClusters, outputCluElements, outputPHOSClusterTrigRecs, outputTruthCont);
-
-    // Find  CPV clusters corresponding to PHOS trigger records
-    std::vector<std::pair<float, float>> cpvMatchPoints[kCpvCells];
-    // Number of entries in each cell per TrigRecord
-    std::vector<trackTrigRec> cpvNMatchPoints;
-    cpvNMatchPoints.reserve(outputPHOSClusterTrigRecs.size());
-    int64_t curBC = -1;
-    if (cpvs.begin() != cpvs.end()) {
-      curBC = cpvs.begin().bc_as<aod::BCsWithTimestamps>().globalBC();
-      cpvNMatchPoints.emplace_back();
-      cpvNMatchPoints.back().mTR = curBC;
-      for (int i = kCpvCells; i--;) {
-        cpvNMatchPoints.back().mStart[i] = 0;
-      }
-    }
-
-    for (const auto& cpvclu : cpvs) {
-      if (static_cast<int64_t>(cpvclu.bc_as<aod::BCsWithTimestamps>().globalBC()) != curBC) { // new BC
-        // mark last entry in previous range
-        for (int i = kCpvCells; i--;) {
-          cpvNMatchPoints.back().mEnd[i] = cpvMatchPoints[i].size();
-        }
-        curBC = cpvclu.bc_as<aod::BCsWithTimestamps>().globalBC();
-        cpvNMatchPoints.back() = cpvNMatchPoints.emplace_back();
-        cpvNMatchPoints.back().mTR = curBC;
-        for (int i = kCpvCells; i--;) {
-          cpvNMatchPoints.back().mStart[i] = cpvMatchPoints[i].size();
-        }
-      }
-      // anyway add coordinates
-      if (cpvclu.amplitude() < static_cast<std::vector<double>>(cpvMinE)[static_cast<int>(cpvclu.moduleNumber()) - 2]) {
-        continue;
-      }
-      int index = CpvMatchIndex(cpvclu.moduleNumber(), cpvclu.posX(), cpvclu.posZ());
-      cpvMatchPoints[index].emplace_back(cpvclu.posX(), cpvclu.posZ());
-    }
-    if (cpvNMatchPoints.size() > 0) {
-      for (int i = kCpvCells; i--;) {
-        cpvNMatchPoints.back().mEnd[i] = cpvMatchPoints[i].size();
-      }
-    }
+    clusterizeAndIndexCpv(cpvs, &cellTruth, outputTruthCont);
 
     // Fill output
     for (auto& cluTR : outputPHOSClusterTrigRecs) {
@@ -586,16 +552,9 @@ struct caloClusterProducerTask {
         colId = coliter->second;
       }
 
-      bool cpvExist = false;
-      // find cpvTR for this BC
-      auto cpvPoints = cpvNMatchPoints.begin();
-      while (cpvPoints != cpvNMatchPoints.end()) {
-        if (cpvPoints->mTR == cluTR.getBCData().toLong()) {
-          cpvExist = true;
-          break;
-        }
-        cpvPoints++;
-      }
+      // CPV clusters of this BC
+      const int cpvBC = mCpvIndex.find(cluTR.getBCData().toLong());
+      bool cpvExist = cpvBC >= 0;
 
       for (int i = firstClusterInEvent; i < lastClusterInEvent; i++) {
         o2::phos::Cluster& clu = outputPHOSClusters[i];
@@ -627,49 +586,19 @@ struct caloClusterProducerTask {
         mom.SetMag(e);
 
         float cpvdist = 99.;
-        const float cellSizeX = 2 * cpvMaxX / kCpvX;
-        const float cellSizeZ = 2 * cpvMaxZ / kCpvZ;
         // look 9 CPV regions around PHOS cluster
 
         if (mod >= 2 && cpvExist) { // CPV exist in mods 2,3,4
-          int phosIndex = CpvMatchIndex(mod, posX, posZ);
-          std::vector<int> regions;
-          regions.push_back(phosIndex);
-          if (posX > -cpvMaxX + cellSizeX) {
-            if (posZ > -cpvMaxZ + cellSizeZ) { // bottom left
-              regions.push_back(phosIndex - kCpvZ - 1);
-            }
-            regions.push_back(phosIndex - kCpvZ);
-            if (posZ < cpvMaxZ - cellSizeZ) { // top left
-              regions.push_back(phosIndex - kCpvZ + 1);
-            }
-          }
-          if (posZ > -cpvMaxZ + cellSizeZ) { // bottom
-            regions.push_back(phosIndex - 1);
-          }
-          if (posZ < cpvMaxZ - cellSizeZ) { // top
-            regions.push_back(phosIndex + 1);
-          }
-          if (posX < cpvMaxX - cellSizeX) {
-            if (posZ > -cpvMaxZ + cellSizeZ) { // bottom right
-              regions.push_back(phosIndex + kCpvZ - 1);
-            }
-            regions.push_back(phosIndex + kCpvZ);
-            if (posZ < cpvMaxZ - cellSizeZ) { // top right
-              regions.push_back(phosIndex + kCpvZ + 1);
-            }
-          }
+          int regions[9];
+          const int nRegions = matchRegions(mod, posX, posZ, regions);
           float sigmaX = 1. / TMath::Min(5.2, 1.111 + 0.56 * TMath::Exp(-0.031 * e * e) + 4.8 / TMath::Power(e + 0.61, 3)); // inverse sigma X
           float sigmaZ = 1. / TMath::Min(3.3, 1.12 + 0.35 * TMath::Exp(-0.032 * e * e) + 0.75 / TMath::Power(e + 0.24, 3)); // inverse sigma Z
 
-          for (int indx : regions) {
-            if (indx >= 0 && indx < kCpvCells) {
-              for (int ii = cpvPoints->mStart[indx]; ii < cpvPoints->mEnd[indx]; ii++) {
-                auto p = cpvMatchPoints[indx][ii];
-                float d = pow((p.first - posX) * sigmaX, 2) + pow((p.second - posZ) * sigmaZ, 2);
-                if (d < cpvdist) {
-                  cpvdist = d;
-                }
+          for (int ir = 0; ir < nRegions; ir++) {
+            for (const auto& p : mCpvIndex.points(cpvBC, regions[ir])) {
+              float d = pow((p.first - posX) * sigmaX, 2) + pow((p.second - posZ) * sigmaZ, 2);
+              if (d < cpvdist) {
+                cpvdist = d;
               }
             }
           }
@@ -818,6 +747,8 @@ struct caloClusterProducerTask {
 
     o2::InteractionRecord ir;
     const int kPHOS = 0;
+    int64_t lastBCId = -1;
+    uint64_t cellBC = 0; // global BC of the current cell, looked up once per BC
     for (auto& c : cells) {
       if (c.caloType() != kPHOS) // PHOS
         continue;
@@ -825,15 +756,19 @@ struct caloClusterProducerTask {
       if ((c.cellType() == phos::TRU2x2 || c.cellType() == phos::TRU4x4) && c.cellNumber() == 0) {
         continue;
       }
+      if (c.bcId() != lastBCId) {
+        lastBCId = c.bcId();
+        cellBC = c.bc_as<aod::BCsWithTimestamps>().globalBC();
+      }
       if (phosCellTRs.size() == 0) { // first cell, first TrigRec
-        ir.setFromLong(c.bc_as<aod::BCsWithTimestamps>().globalBC());
+        ir.setFromLong(cellBC);
         phosCellTRs.emplace_back(ir, 0, 0); // BC,first cell, ncells
       }
-      if (static_cast<uint64_t>(phosCellTRs.back().getBCData().toLong()) != c.bc_as<aod::BCsWithTimestamps>().globalBC()) { // switch to new BC
+      if (static_cast<uint64_t>(phosCellTRs.back().getBCData().toLong()) != cellBC) { // switch to new BC
         // switch to another BC: set size and create next TriRec
         phosCellTRs.back().setNumberOfObjects(phosCells.size() - phosCellTRs.back().getFirstEntry());
         // Next event/trig rec.
-        ir.setFromLong(c.bc_as<aod::BCsWithTimestamps>().globalBC());
+        ir.setFromLong(cellBC);
         phosCellTRs.emplace_back(ir, phosCells.size(), 0);
       }
       phosCells.emplace_back(c.cellNumber(), c.amplitude(), c.time(),
@@ -844,125 +779,11 @@ struct caloClusterProducerTask {
       phosCellTRs.back().setNumberOfObjects(phosCells.size() - phosCellTRs.back().getFirstEntry());
     }
 
-    // clusterize
+    // clusterize PHOS, and index the CPV clusters in the meantime
     o2::dataformats::MCTruthContainer<o2::phos::MCLabel> dummyMC;
-    clusterizerPHOS->processCells(phosCells, phosCellTRs, nullptr,
-                                  outputPHOSClusters, outputCluElements, outputPHOSClusterTrigRecs, dummyMC);
-
-    // Find  CPV clusters corresponding to PHOS trigger records
-    std::vector<std::pair<float, float>> cpvMatchPoints[kCpvCells];
-    // Number of entries in each cell per TrigRecord
-    std::vector<trackTrigRec> cpvNMatchPoints;
-    cpvNMatchPoints.reserve(outputPHOSClusterTrigRecs.size());
-
-    int64_t curBC = -1;
-    if (cpvs.begin() != cpvs.end()) {
-      curBC = cpvs.begin().bc_as<aod::BCsWithTimestamps>().globalBC();
-      cpvNMatchPoints.emplace_back();
-      cpvNMatchPoints.back().mTR = curBC;
-      for (int i = kCpvCells; i--;) {
-        cpvNMatchPoints.back().mStart[i] = 0;
-      }
-    }
-
-    for (const auto& cpvclu : cpvs) {
-      if (static_cast<int64_t>(cpvclu.bc_as<aod::BCsWithTimestamps>().globalBC()) != curBC) { // new BC
-        // mark last entry in previous range
-        for (int i = kCpvCells; i--;) {
-          cpvNMatchPoints.back().mEnd[i] = cpvMatchPoints[i].size();
-        }
-        curBC = cpvclu.bc_as<aod::BCsWithTimestamps>().globalBC();
-        cpvNMatchPoints.back() = cpvNMatchPoints.emplace_back();
-        cpvNMatchPoints.back().mTR = curBC;
-        for (int i = kCpvCells; i--;) {
-          cpvNMatchPoints.back().mStart[i] = cpvMatchPoints[i].size();
-        }
-      }
-      if (cpvclu.amplitude() < static_cast<std::vector<double>>(cpvMinE)[static_cast<int>(cpvclu.moduleNumber()) - 2]) {
-        continue;
-      }
-      int index = CpvMatchIndex(cpvclu.moduleNumber(), cpvclu.posX(), cpvclu.posZ());
-      cpvMatchPoints[index].emplace_back(cpvclu.posX(), cpvclu.posZ());
-    }
-    if (cpvNMatchPoints.size()) {
-      for (int i = kCpvCells; i--;) {
-        cpvNMatchPoints.back().mEnd[i] = cpvMatchPoints[i].size();
-      }
-    }
-    // same for tracks
-    std::vector<trackMatch> trackMatchPoints[kCpvCells]; // tracks hit in grid/cell in PHOS
-    // Number of entries in each cell per TrigRecord
-    std::vector<trackTrigRec> trackNMatchPoints;
-    trackNMatchPoints.reserve(outputPHOSClusterTrigRecs.size());
-
-    curBC = 0;
-    for (const auto& track : tracks) {
-      if (track.has_collision()) { // ignore orphan tracks without collision
-        curBC = track.collision().bc_as<aod::BCsWithTimestamps>().globalBC();
-        break;
-      }
-    }
-    bool keepBC = false;
-    for (auto& cluTR : outputPHOSClusterTrigRecs) {
-      if (cluTR.getBCData().toLong() == curBC) {
-        keepBC = true;
-        break;
-      }
-    }
-    if (keepBC) {
-      trackNMatchPoints.emplace_back();
-      trackNMatchPoints.back().mTR = curBC;
-      for (int i = kCpvCells; i--;) {
-        trackNMatchPoints.back().mStart[i] = 0;
-      }
-    }
-    for (const auto& track : tracks) {
-      if (!track.has_collision()) {
-        continue;
-      }
-      if (static_cast<int64_t>(track.collision().bc_as<aod::BCsWithTimestamps>().globalBC()) != curBC) { // new BC
-        // close previous BC if exist
-        if (keepBC) {
-          // mark last entry in previous range
-          for (int i = kCpvCells; i--;) {
-            trackNMatchPoints.back().mEnd[i] = trackMatchPoints[i].size();
-          }
-          curBC = track.collision().bc_as<aod::BCsWithTimestamps>().globalBC();
-        }
-        keepBC = false;
-        for (auto& cluTR : outputPHOSClusterTrigRecs) {
-          if (cluTR.getBCData().toLong() == curBC) {
-            keepBC = true;
-            break;
-          }
-        }
-        if (!keepBC) {
-          continue;
-        }
-        trackNMatchPoints.emplace_back();
-        trackNMatchPoints.back().mTR = curBC;
-        for (int i = kCpvCells; i--;) {
-          trackNMatchPoints.back().mStart[i] = trackMatchPoints[i].size();
-        }
-      }
-      // if (!keepBC || !track.isGlobalTrack()) {  // only global tracks
-      if (!keepBC) {
-        continue;
-      }
-      // calculate coordinate in PHOS plane
-      int16_t module;
-      float trackX, trackZ;
-      auto trackPar = getTrackPar(track);
-      if (impactOnPHOS(trackPar, track.trackEtaEmcal(), track.trackPhiEmcal(), track.collision().posZ(), module, trackX, trackZ)) {
-        int index = CpvMatchIndex(module, trackX, trackZ);
-        trackMatchPoints[index].emplace_back(trackX, trackZ, track.globalIndex());
-      }
-    }
-    if (keepBC) {
-      for (int i = kCpvCells; i--;) {
-        trackNMatchPoints.back().mEnd[i] = trackMatchPoints[i].size();
-      }
-    }
+    clusterizeAndIndexCpv(cpvs, nullptr, dummyMC);
+    // same for tracks, for the BCs with PHOS clusters
+    fillTrackIndex(tracks);
 
     // Fill output tables
     for (auto& cluTR : outputPHOSClusterTrigRecs) {
@@ -980,25 +801,12 @@ struct caloClusterProducerTask {
         colId = coliter->second;
       }
 
-      bool cpvExist = false;
-      // find cpvTR for this BC
-      auto cpvPoints = cpvNMatchPoints.begin();
-      while (cpvPoints != cpvNMatchPoints.end()) {
-        if (cpvPoints->mTR == cluTR.getBCData().toLong()) {
-          cpvExist = true;
-          break;
-        }
-        cpvPoints++;
-      }
+      // CPV clusters of this BC
+      const int cpvBC = mCpvIndex.find(cluTR.getBCData().toLong());
+      bool cpvExist = cpvBC >= 0;
 
-      // find cpvTR for this BC
-      auto trackPoints = trackNMatchPoints.begin();
-      while (trackPoints != trackNMatchPoints.end()) {
-        if (trackPoints->mTR == cluTR.getBCData().toLong()) {
-          break;
-        }
-        trackPoints++;
-      }
+      // track impacts of this BC
+      const int trackBC = mTrackIndex.find(cluTR.getBCData().toLong());
 
       for (int i = firstClusterInEvent; i < lastClusterInEvent; i++) {
         o2::phos::Cluster& clu = outputPHOSClusters[i];
@@ -1030,66 +838,31 @@ struct caloClusterProducerTask {
         mom.SetMag(e);
 
         // CPV and track match
-        const float cellSizeX = 2 * cpvMaxX / kCpvX;
-        const float cellSizeZ = 2 * cpvMaxZ / kCpvZ;
         // look 9 CPV regions around PHOS cluster
-        int phosIndex = CpvMatchIndex(mod, posX, posZ);
-        std::vector<int> regions;
-        regions.push_back(phosIndex);
-        if (posX > -cpvMaxX + cellSizeX) {
-          if (posZ > -cpvMaxZ + cellSizeZ) { // bottom left
-            regions.push_back(phosIndex - kCpvZ - 1);
-          }
-          regions.push_back(phosIndex - kCpvZ);
-          if (posZ < cpvMaxZ - cellSizeZ) { // top left
-            regions.push_back(phosIndex - kCpvZ + 1);
-          }
-        }
-        if (posZ > -cpvMaxZ + cellSizeZ) { // bottom
-          regions.push_back(phosIndex - 1);
-        }
-        if (posZ < cpvMaxZ - cellSizeZ) { // top
-          regions.push_back(phosIndex + 1);
-        }
-        if (posX < cpvMaxX - cellSizeX) {
-          if (posZ > -cpvMaxZ + cellSizeZ) { // bottom right
-            regions.push_back(phosIndex + kCpvZ - 1);
-          }
-          regions.push_back(phosIndex + kCpvZ);
-          if (posZ < cpvMaxZ - cellSizeZ) { // top right
-            regions.push_back(phosIndex + kCpvZ + 1);
-          }
-        }
+        int regions[9];
+        const int nRegions = matchRegions(mod, posX, posZ, regions);
         float sigmaX = 1. / TMath::Min(5.2, 1.111 + 0.56 * TMath::Exp(-0.031 * e * e) + 4.8 / TMath::Power(e + 0.61, 3)); // inverse sigma X
         float sigmaZ = 1. / TMath::Min(3.3, 1.12 + 0.35 * TMath::Exp(-0.032 * e * e) + 0.75 / TMath::Power(e + 0.24, 3)); // inverse sigma Z
         float cpvdist = 99., trackdist = 99.;
         // float cpvDx = 0., cpvDz = 0.;
         float trackDx = 9999., trackDz = 9999.;
         int trackindex = -1;
-        for (int indx : regions) {
-          if (cpvPoints != cpvNMatchPoints.end()) {
-            if (indx >= 0 && indx < kCpvCells) {
-              for (int ii = cpvPoints->mStart[indx]; ii < cpvPoints->mEnd[indx]; ii++) {
-                auto p = cpvMatchPoints[indx][ii];
-                float d = pow((p.first - posX) * sigmaX, 2) + pow((p.second - posZ) * sigmaZ, 2);
-                if (d < cpvdist) {
-                  cpvdist = d;
-                }
-              }
+        for (int ir = 0; ir < nRegions; ir++) {
+          for (const auto& p : mCpvIndex.points(cpvBC, regions[ir])) {
+            float d = pow((p.first - posX) * sigmaX, 2) + pow((p.second - posZ) * sigmaZ, 2);
+            if (d < cpvdist) {
+              cpvdist = d;
             }
           }
 
           // same for tracks
-          if (trackPoints != trackNMatchPoints.end()) {
-            for (int ii = trackPoints->mStart[indx]; ii < trackPoints->mEnd[indx]; ii++) {
-              auto pp = trackMatchPoints[indx][ii];
-              float d = pow((pp.pX - posX) * sigmaX, 2) + pow((pp.pZ - posZ) * sigmaZ, 2); // TODO different sigma for tracks
-              if (d < trackdist) {
-                trackdist = d;
-                trackDx = pp.pX - posX;
-                trackDz = pp.pZ - posZ;
-                trackindex = pp.indx;
-              }
+          for (const auto& pp : mTrackIndex.points(trackBC, regions[ir])) {
+            float d = pow((pp.pX - posX) * sigmaX, 2) + pow((pp.pZ - posZ) * sigmaZ, 2); // TODO different sigma for tracks
+            if (d < trackdist) {
+              trackdist = d;
+              trackDx = pp.pX - posX;
+              trackDz = pp.pZ - posZ;
+              trackindex = pp.indx;
             }
           }
         }
@@ -1224,10 +997,12 @@ struct caloClusterProducerTask {
     outputCluElements.clear();
     outputPHOSClusters.clear();
     outputPHOSClusterTrigRecs.clear();
-    o2::dataformats::MCTruthContainer<o2::phos::MCLabel> cellTruth;
+    cellTruth.clear();
 
     o2::InteractionRecord ir;
     const int kPHOS = 0;
+    int64_t lastBCId = -1;
+    uint64_t cellBC = 0; // global BC of the current cell, looked up once per BC
     for (auto& c : cells) {
       if (c.caloType() != kPHOS) // PHOS
         continue;
@@ -1235,15 +1010,19 @@ struct caloClusterProducerTask {
       if ((c.cellType() == phos::TRU2x2 || c.cellType() == phos::TRU4x4) && c.cellNumber() == 0) {
         continue;
       }
+      if (c.bcId() != lastBCId) {
+        lastBCId = c.bcId();
+        cellBC = c.bc_as<aod::BCsWithTimestamps>().globalBC();
+      }
       if (phosCellTRs.size() == 0) { // first cell, first TrigRec
-        ir.setFromLong(c.bc_as<aod::BCsWithTimestamps>().globalBC());
+        ir.setFromLong(cellBC);
         phosCellTRs.emplace_back(ir, 0, 0); // BC,first cell, ncells
       }
-      if (static_cast<uint64_t>(phosCellTRs.back().getBCData().toLong()) != c.bc_as<aod::BCsWithTimestamps>().globalBC()) { // switch to new BC
+      if (static_cast<uint64_t>(phosCellTRs.back().getBCData().toLong()) != cellBC) { // switch to new BC
         // switch to another BC: set size and create next TriRec
         phosCellTRs.back().setNumberOfObjects(phosCells.size() - phosCellTRs.back().getFirstEntry());
         // Next event/trig rec.
-        ir.setFromLong(c.bc_as<aod::BCsWithTimestamps>().globalBC());
+        ir.setFromLong(cellBC);
         phosCellTRs.emplace_back(ir, phosCells.size(), 0);
       }
       phosCells.emplace_back(c.cellNumber(), c.amplitude(), c.time(),
@@ -1275,125 +1054,11 @@ struct caloClusterProducerTask {
     if (phosCellTRs.size() > 0) {
       phosCellTRs.back().setNumberOfObjects(phosCells.size() - phosCellTRs.back().getFirstEntry());
     }
-    // clusterize
+    // clusterize PHOS, and index the CPV clusters in the meantime
     o2::dataformats::MCTruthContainer<o2::phos::MCLabel> outputTruthCont;
-    clusterizerPHOS->processCells(phosCells, phosCellTRs, &cellTruth,
-                                  outputPHOSClusters, outputCluElements, outputPHOSClusterTrigRecs, outputTruthCont);
-
-    // Find  CPV clusters corresponding to PHOS trigger records
-    std::vector<std::pair<float, float>> cpvMatchPoints[kCpvCells];
-    // Number of entries in each cell per TrigRecord
-    std::vector<trackTrigRec> cpvNMatchPoints;
-    cpvNMatchPoints.reserve(outputPHOSClusterTrigRecs.size());
-
-    int64_t curBC = -1;
-    if (cpvs.begin() != cpvs.end()) {
-      curBC = cpvs.begin().bc_as<aod::BCsWithTimestamps>().globalBC();
-      cpvNMatchPoints.emplace_back();
-      cpvNMatchPoints.back().mTR = curBC;
-      for (int i = kCpvCells; i--;) {
-        cpvNMatchPoints.back().mStart[i] = 0;
-      }
-    }
-
-    for (const auto& cpvclu : cpvs) {
-      if (static_cast<int64_t>(cpvclu.bc_as<aod::BCsWithTimestamps>().globalBC()) != curBC) { // new BC
-        // mark last entry in previous range
-        for (int i = kCpvCells; i--;) {
-          cpvNMatchPoints.back().mEnd[i] = cpvMatchPoints[i].size();
-        }
-        curBC = cpvclu.bc_as<aod::BCsWithTimestamps>().globalBC();
-        cpvNMatchPoints.emplace_back();
-        cpvNMatchPoints.back().mTR = curBC;
-        for (int i = kCpvCells; i--;) {
-          cpvNMatchPoints.back().mStart[i] = cpvMatchPoints[i].size();
-        }
-      }
-      if (cpvclu.amplitude() < static_cast<std::vector<double>>(cpvMinE)[static_cast<int>(cpvclu.moduleNumber()) - 2]) {
-        continue;
-      }
-      int index = CpvMatchIndex(cpvclu.moduleNumber(), cpvclu.posX(), cpvclu.posZ());
-      cpvMatchPoints[index].emplace_back(cpvclu.posX(), cpvclu.posZ());
-    }
-    if (cpvNMatchPoints.size()) {
-      for (int i = kCpvCells; i--;) {
-        cpvNMatchPoints.back().mEnd[i] = cpvMatchPoints[i].size();
-      }
-    }
-    // same for tracks
-    std::vector<trackMatch> trackMatchPoints[kCpvCells]; // tracks hit in grid/cell in PHOS
-    // Number of entries in each cell per TrigRecord
-    std::vector<trackTrigRec> trackNMatchPoints;
-    trackNMatchPoints.reserve(outputPHOSClusterTrigRecs.size());
-
-    curBC = -1;
-    for (const auto& track : tracks) {
-      if (track.has_collision()) { // ignore orphan tracks without collision
-        curBC = track.collision().bc_as<aod::BCsWithTimestamps>().globalBC();
-        break;
-      }
-    }
-    bool keepBC = false;
-    for (auto& cluTR : outputPHOSClusterTrigRecs) {
-      if (cluTR.getBCData().toLong() == curBC) {
-        keepBC = true;
-        break;
-      }
-    }
-    if (keepBC) {
-      trackNMatchPoints.emplace_back();
-      trackNMatchPoints.back().mTR = curBC;
-      for (int i = kCpvCells; i--;) {
-        trackNMatchPoints.back().mStart[i] = 0;
-      }
-    }
-    for (const auto& track : tracks) {
-      if (!track.has_collision()) {
-        continue;
-      }
-      if (static_cast<int64_t>(track.collision().bc_as<aod::BCsWithTimestamps>().globalBC()) != curBC) { // new BC
-        // close previous BC if exist
-        if (keepBC) {
-          // mark last entry in previous range
-          for (int i = kCpvCells; i--;) {
-            trackNMatchPoints.back().mEnd[i] = trackMatchPoints[i].size();
-          }
-          curBC = track.collision().bc_as<aod::BCsWithTimestamps>().globalBC();
-        }
-        keepBC = false;
-        for (auto& cluTR : outputPHOSClusterTrigRecs) {
-          if (cluTR.getBCData().toLong() == curBC) {
-            keepBC = true;
-            break;
-          }
-        }
-        if (!keepBC) {
-          continue;
-        }
-        trackNMatchPoints.emplace_back();
-        trackNMatchPoints.back().mTR = curBC;
-        for (int i = kCpvCells; i--;) {
-          trackNMatchPoints.back().mStart[i] = trackMatchPoints[i].size();
-        }
-      }
-      // if (!keepBC || !track.isGlobalTrack()) {  // only global tracks
-      if (!keepBC) {
-        continue;
-      }
-      // calculate coordinate in PHOS plane
-      int16_t module;
-      float trackX, trackZ;
-      auto trackPar = getTrackPar(track);
-      if (impactOnPHOS(trackPar, track.trackEtaEmcal(), track.trackPhiEmcal(), track.collision().posZ(), module, trackX, trackZ)) {
-        int index = CpvMatchIndex(module, trackX, trackZ);
-        trackMatchPoints[index].emplace_back(trackX, trackZ, track.globalIndex());
-      }
-    }
-    if (keepBC) {
-      for (int i = kCpvCells; i--;) {
-        trackNMatchPoints.back().mEnd[i] = trackMatchPoints[i].size();
-      }
-    }
+    clusterizeAndIndexCpv(cpvs, &cellTruth, outputTruthCont);
+    // same for tracks, for the BCs with PHOS clusters
+    fillTrackIndex(tracks);
 
     // Fill output tables
     for (auto& cluTR : outputPHOSClusterTrigRecs) {
@@ -1411,24 +1076,11 @@ struct caloClusterProducerTask {
         colId = coliter->second;
       }
 
-      bool cpvExist = false;
-      // find cpvTR for this BC
-      auto cpvPoints = cpvNMatchPoints.begin();
-      while (cpvPoints != cpvNMatchPoints.end()) {
-        if (cpvPoints->mTR == cluTR.getBCData().toLong()) {
-          cpvExist = true;
-          break;
-        }
-        cpvPoints++;
-      }
-      // find cpvTR for this BC
-      auto trackPoints = trackNMatchPoints.begin();
-      while (trackPoints != trackNMatchPoints.end()) {
-        if (trackPoints->mTR == cluTR.getBCData().toLong()) {
-          break;
-        }
-        trackPoints++;
-      }
+      // CPV clusters of this BC
+      const int cpvBC = mCpvIndex.find(cluTR.getBCData().toLong());
+      bool cpvExist = cpvBC >= 0;
+      // track impacts of this BC
+      const int trackBC = mTrackIndex.find(cluTR.getBCData().toLong());
 
       for (int i = firstClusterInEvent; i < lastClusterInEvent; i++) {
         o2::phos::Cluster& clu = outputPHOSClusters[i];
@@ -1459,65 +1111,31 @@ struct caloClusterProducerTask {
 
         mom.SetMag(e);
         // CPV and track match
-        const float cellSizeX = 2 * cpvMaxX / kCpvX;
-        const float cellSizeZ = 2 * cpvMaxZ / kCpvZ;
         // look 9 CPV regions around PHOS cluster
-        int phosIndex = CpvMatchIndex(mod, posX, posZ);
-        std::vector<int> regions;
-        regions.push_back(phosIndex);
-        if (posX > -cpvMaxX + cellSizeX) {
-          if (posZ > -cpvMaxZ + cellSizeZ) { // bottom left
-            regions.push_back(phosIndex - kCpvZ - 1);
-          }
-          regions.push_back(phosIndex - kCpvZ);
-          if (posZ < cpvMaxZ - cellSizeZ) { // top left
-            regions.push_back(phosIndex - kCpvZ + 1);
-          }
-        }
-        if (posZ > -cpvMaxZ + cellSizeZ) { // bottom
-          regions.push_back(phosIndex - 1);
-        }
-        if (posZ < cpvMaxZ - cellSizeZ) { // top
-          regions.push_back(phosIndex + 1);
-        }
-        if (posX < cpvMaxX - cellSizeX) {
-          if (posZ > -cpvMaxZ + cellSizeZ) { // bottom right
-            regions.push_back(phosIndex + kCpvZ - 1);
-          }
-          regions.push_back(phosIndex + kCpvZ);
-          if (posZ < cpvMaxZ - cellSizeZ) { // top right
-            regions.push_back(phosIndex + kCpvZ + 1);
-          }
-        }
+        int regions[9];
+        const int nRegions = matchRegions(mod, posX, posZ, regions);
         float sigmaX = 1. / TMath::Min(5.2, 1.111 + 0.56 * TMath::Exp(-0.031 * e * e) + 4.8 / TMath::Power(e + 0.61, 3)); // inverse sigma X
         float sigmaZ = 1. / TMath::Min(3.3, 1.12 + 0.35 * TMath::Exp(-0.032 * e * e) + 0.75 / TMath::Power(e + 0.24, 3)); // inverse sigma Z
         float cpvdist = 99., trackdist = 99.;
         // float cpvDx = 0., cpvDz = 0.;
         float trackDx = 9999., trackDz = 9999.;
         int trackindex = -1;
-        for (int indx : regions) {
-          if (cpvPoints != cpvNMatchPoints.end()) {
-            if (indx >= 0 && indx < kCpvCells) {
-              for (int ii = cpvPoints->mStart[indx]; ii < cpvPoints->mEnd[indx]; ii++) {
-                auto p = cpvMatchPoints[indx][ii];
-                float d = pow((p.first - posX) * sigmaX, 2) + pow((p.second - posZ) * sigmaZ, 2);
-                if (d < cpvdist) {
-                  cpvdist = d;
-                }
-              }
+        for (int ir = 0; ir < nRegions; ir++) {
+          for (const auto& p : mCpvIndex.points(cpvBC, regions[ir])) {
+            float d = pow((p.first - posX) * sigmaX, 2) + pow((p.second - posZ) * sigmaZ, 2);
+            if (d < cpvdist) {
+              cpvdist = d;
             }
           }
+
           // same for tracks
-          if (trackPoints != trackNMatchPoints.end()) {
-            for (int ii = trackPoints->mStart[indx]; ii < trackPoints->mEnd[indx]; ii++) {
-              auto pp = trackMatchPoints[indx][ii];
-              float d = pow((pp.pX - posX) * sigmaX, 2) + pow((pp.pZ - posZ) * sigmaZ, 2); // TODO different sigma for tracks
-              if (d < trackdist) {
-                trackdist = d;
-                trackDx = pp.pX - posX;
-                trackDz = pp.pZ - posZ;
-                trackindex = pp.indx;
-              }
+          for (const auto& pp : mTrackIndex.points(trackBC, regions[ir])) {
+            float d = pow((pp.pX - posX) * sigmaX, 2) + pow((pp.pZ - posZ) * sigmaZ, 2); // TODO different sigma for tracks
+            if (d < trackdist) {
+              trackdist = d;
+              trackDx = pp.pX - posX;
+              trackDz = pp.pZ - posZ;
+              trackindex = pp.indx;
             }
           }
         }
@@ -1583,6 +1201,118 @@ struct caloClusterProducerTask {
 
   PROCESS_SWITCH(caloClusterProducerTask, processFullMC, "Process MC with track matching", false);
 
+  // Clusterizes the PHOS cells of the timeframe and indexes the CPV clusters above the amplitude threshold of their module,
+  // the PHOS clusterization runs on a separate thread if concurrentCpv is set
+  void clusterizeAndIndexCpv(o2::aod::CPVClusters const& cpvs, const o2::dataformats::MCTruthContainer<o2::phos::MCLabel>* cellTruthContainer,
+                             o2::dataformats::MCTruthContainer<o2::phos::MCLabel>& outputTruthContainer)
+  {
+    auto clusterizePHOS = [&]() {
+      clusterizerPHOS->processCells(phosCells, phosCellTRs, cellTruthContainer,
+                                    outputPHOSClusters, outputCluElements, outputPHOSClusterTrigRecs, outputTruthContainer);
+    };
+    std::thread phosThread;
+    if (concurrentCpv) {
+      phosThread = std::thread(clusterizePHOS);
+    } else {
+      clusterizePHOS();
+    }
+
+    // the CPV clusters are read from the table on this thread
+    const std::vector<double>& cpvMinAmplitudes = cpvMinE.value;
+    mCpvIndex.clear();
+    int64_t lastBCId = -1;
+    int64_t cpvBC = 0;
+    for (const auto& cpvclu : cpvs) {
+      if (cpvclu.bcId() != lastBCId) {
+        lastBCId = cpvclu.bcId();
+        cpvBC = cpvclu.bc_as<aod::BCsWithTimestamps>().globalBC();
+      }
+      mCpvIndex.addBC(cpvBC);
+      if (cpvclu.amplitude() < cpvMinAmplitudes[static_cast<int>(cpvclu.moduleNumber()) - 2]) {
+        continue;
+      }
+      mCpvIndex.add(cpvBC, CpvMatchIndex(cpvclu.moduleNumber(), cpvclu.posX(), cpvclu.posZ()), {cpvclu.posX(), cpvclu.posZ()});
+    }
+    mCpvIndex.build();
+
+    if (phosThread.joinable()) {
+      phosThread.join();
+    }
+  }
+
+  // Indexes the impact points in PHOS of the tracks of the BCs with PHOS clusters
+  template <typename Tracks>
+  void fillTrackIndex(Tracks const& tracks)
+  {
+    mPhosClusterBCs.clear();
+    for (auto& cluTR : outputPHOSClusterTrigRecs) {
+      mPhosClusterBCs.push_back(cluTR.getBCData().toLong());
+    }
+    std::sort(mPhosClusterBCs.begin(), mPhosClusterBCs.end());
+
+    mTrackIndex.clear();
+    int64_t lastCollisionId = -1;
+    int64_t trackBC = 0;
+    bool keepBC = false;
+    for (const auto& track : tracks) {
+      if (!track.has_collision()) { // ignore orphan tracks without collision
+        continue;
+      }
+      if (track.collisionId() != lastCollisionId) {
+        lastCollisionId = track.collisionId();
+        trackBC = track.collision().template bc_as<aod::BCsWithTimestamps>().globalBC();
+        keepBC = std::binary_search(mPhosClusterBCs.begin(), mPhosClusterBCs.end(), trackBC);
+      }
+      // if (!keepBC || !track.isGlobalTrack()) {  // only global tracks
+      if (!keepBC) {
+        continue;
+      }
+      // calculate coordinate in PHOS plane
+      int16_t module;
+      float trackX, trackZ;
+      auto trackPar = getTrackPar(track);
+      if (impactOnPHOS(trackPar, track.trackEtaEmcal(), track.trackPhiEmcal(), track.collision().posZ(), module, trackX, trackZ)) {
+        mTrackIndex.add(trackBC, CpvMatchIndex(module, trackX, trackZ), trackMatch(trackX, trackZ, track.globalIndex()));
+      }
+    }
+    mTrackIndex.build();
+  }
+
+  // Regions of the CpvMatchIndex grid around a PHOS cluster: its own region and the neighbouring ones, returns their number
+  int matchRegions(int16_t mod, float posX, float posZ, int (&regions)[9])
+  {
+    const float cellSizeX = 2 * cpvMaxX / kCpvX;
+    const float cellSizeZ = 2 * cpvMaxZ / kCpvZ;
+    const int phosIndex = CpvMatchIndex(mod, posX, posZ);
+    int nRegions = 0;
+    regions[nRegions++] = phosIndex;
+    if (posX > -cpvMaxX + cellSizeX) {
+      if (posZ > -cpvMaxZ + cellSizeZ) { // bottom left
+        regions[nRegions++] = phosIndex - kCpvZ - 1;
+      }
+      regions[nRegions++] = phosIndex - kCpvZ;
+      if (posZ < cpvMaxZ - cellSizeZ) { // top left
+        regions[nRegions++] = phosIndex - kCpvZ + 1;
+      }
+    }
+    if (posZ > -cpvMaxZ + cellSizeZ) { // bottom
+      regions[nRegions++] = phosIndex - 1;
+    }
+    if (posZ < cpvMaxZ - cellSizeZ) { // top
+      regions[nRegions++] = phosIndex + 1;
+    }
+    if (posX < cpvMaxX - cellSizeX) {
+      if (posZ > -cpvMaxZ + cellSizeZ) { // bottom right
+        regions[nRegions++] = phosIndex + kCpvZ - 1;
+      }
+      regions[nRegions++] = phosIndex + kCpvZ;
+      if (posZ < cpvMaxZ - cellSizeZ) { // top right
+        regions[nRegions++] = phosIndex + kCpvZ + 1;
+      }
+    }
+    return nRegions;
+  }
+
   int CpvMatchIndex(int16_t module, float x, float z)
   {
     // calculate cell index in grid over PHOS detector
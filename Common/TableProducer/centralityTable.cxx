@@ -21,6 +21,7 @@
 #include "Framework/RunningWorkflowInfo.h"
 #include "Common/DataModel/Multiplicity.h"
 #include "Common/DataModel/Centrality.h"
+#include "Common/Core/BinnedLookup.h"
 #include "TableHelper.h"
 
 using namespace o2;
@@ -117,6 +118,7 @@ struct CentralityTable {
     std::string name = "";
     bool mCalibrationStored = false;
     TH1* mhMultSelCalib = nullptr;
+    BinnedLookup mMultSelCalib; // flat copy of mhMultSelCalib, filled when the run calibration is loaded
     float mMCScalePars[6] = {0.0};
     TFormula* mMCScale = nullptr;
     explicit calibrationInfo(std::string name)
@@ -420,7 +422,7 @@ struct CentralityTable {
           auto getccdb = [callst, bc](struct calibrationInfo& estimator, const Configurable<std::string> generatorName) { // TODO: to consider the name inside the estimator structure
             estimator.mhMultSelCalib = reinterpret_cast<TH1*>(callst->FindObject(TString::Format("hCalibZeq%s", estimator.name.c_str()).Data()));
             estimator.mMCScale = reinterpret_cast<TFormula*>(callst->FindObject(TString::Format("%s-%s", generatorName->c_str(), estimator.name.c_str()).Data()));
-            if (estimator.mhMultSelCalib != nullptr) {
+            if (estimator.mMultSelCalib.set(estimator.mhMultSelCalib)) {
               if (generatorName->length() != 0) {
                 LOGF(info, "Retrieving MC calibration for %d, generator name: %s", bc.runNumber(), generatorName->c_str());
                 if (estimator.mMCScale != nullptr) {
@@ -494,7 +496,7 @@ struct CentralityTable {
             scaledMultiplicity = scaleMC(multiplicity, estimator.mMCScalePars);
             LOGF(debug, "Unscaled %s multiplicity: %f, scaled %s multiplicity: %f", estimator.name.c_str(), multiplicity, estimator.name.c_str(), scaledMultiplicity);
           }
-          percentile = estimator.mhMultSelCalib->GetBinContent(estimator.mhMultSelCalib->FindFixBin(scaledMultiplicity));
+          percentile = estimator.mMultSelCalib.get(scaledMultiplicity);
           if (assignOutOfRange)
             percentile = 100.5f;
         }
@@ -16,6 +16,8 @@
 #include "Common/DataModel/EventSelection.h"
 #include "Common/CCDB/EventSelectionParams.h"
 #include "Common/CCDB/TriggerAliases.h"
+#include "Common/CCDB/CCDBObjectCache.h"
+#include "Common/Core/BcTimeIndex.h"
 #include "CCDB/BasicCCDBManager.h"
 #include "CommonConstants/LHCConstants.h"
 #include "Framework/HistogramRegistry.h"
@@ -47,12 +49,16 @@ struct BcSelectionTask {
   Configurable<int> confTimeFrameEndBorderMargin{"TimeFrameEndBorderMargin", -1, "Number of bcs to cut at the end of the Time Frame. Take from CCDB if -1"};
 
   int lastRunNumber = -1;
+  o2::CCDBObjectCache& ccdbCache = o2::CCDBObjectCache::instance();
+  o2::CCDBObjectCache::Handle hEvSelParams = 0;
+  o2::CCDBObjectCache::Handle hTriggerAliases = 0;
   int64_t bcSOR = -1;                    // global bc of the start of the first orbit
   int64_t nBCsPerTF = -1;                // duration of TF in bcs, should be 128*3564 or 32*3564
   int mITSROFrameStartBorderMargin = 10; // default value
   int mITSROFrameEndBorderMargin = 20;   // default value
   int mTimeFrameStartBorderMargin = 300; // default value
   int mTimeFrameEndBorderMargin = 4000;  // default value
+  BcTimeIndex mBcIndexByGlobalBC;        // global BC -> BC index, refilled for each TF
 
   void init(InitContext&)
   {
@@ -60,6 +66,9 @@ struct BcSelectionTask {
     ccdb->setURL("http://alice-ccdb.cern.ch");
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
+    // per-BC objects, fetched once per run through the shared cache
+    hEvSelParams = ccdbCache.declare<EventSelectionParams>("EventSelection/EventSelectionParams");
+    hTriggerAliases = ccdbCache.declare<TriggerAliases>("EventSelection/TriggerAliases");
 
     histos.add("hCounterTVX", "", kTH1D, {{1, 0., 1.}});
     histos.add("hCounterTCE", "", kTH1D, {{1, 0., 1.}});
@@ -88,10 +97,14 @@ struct BcSelectionTask {
     aod::FDDs const&)
   {
     bcsel.reserve(bcs.size());
+    if (bcs.size() != 0) {
+      ccdbCache.prefetch(ccdb.service, bcs.iteratorAt(0).runNumber(), bcs.iteratorAt(0).timestamp());
+      ccdbCache.lookAhead(ccdb.service, bcs);
+    }
 
     for (auto& bc : bcs) {
-      EventSelectionParams* par = ccdb->getForTimeStamp<EventSelectionParams>("EventSelection/EventSelectionParams", bc.timestamp());
-      TriggerAliases* aliases = ccdb->getForTimeStamp<TriggerAliases>("EventSelection/TriggerAliases", bc.timestamp());
+      const EventSelectionParams* par = &ccdbCache.get<EventSelectionParams>(ccdb.service, hEvSelParams, bc.timestamp());
+      const TriggerAliases* aliases = &ccdbCache.get<TriggerAliases>(ccdb.service, hTriggerAliases, bc.timestamp());
       // fill fired aliases
       uint32_t alias{0};
       uint64_t triggerMask = bc.triggerMask();
@@ -220,11 +233,13 @@ struct BcSelectionTask {
     int64_t ts = bcs.iteratorAt(0).timestamp();
     auto alppar = ccdb->getForTimeStamp<o2::itsmft::DPLAlpideParam<0>>("ITS/Config/AlpideParam", ts);
 
-    // map from GlobalBC to BcId needed to find triggerBc
-    std::map<uint64_t, int32_t> mapGlobalBCtoBcId;
+    // index from GlobalBC to BcId needed to find triggerBc
+    mBcIndexByGlobalBC.clear();
+    mBcIndexByGlobalBC.reserve(bcs.size());
     for (auto& bc : bcs) {
-      mapGlobalBCtoBcId[bc.globalBC()] = bc.globalIndex();
+      mBcIndexByGlobalBC.add(bc.globalBC(), bc.globalIndex());
     }
+    mBcIndexByGlobalBC.build();
     int triggerBcShift = confTriggerBcShift;
     if (confTriggerBcShift == 999) {
       int run = bcs.iteratorAt(0).runNumber();
@@ -265,13 +280,15 @@ struct BcSelectionTask {
     }
 
     // bc loop
+    ccdbCache.prefetch(ccdb.service, run, bcs.iteratorAt(0).timestamp());
+    ccdbCache.lookAhead(ccdb.service, bcs);
     for (auto bc : bcs) {
-      EventSelectionParams* par = ccdb->getForTimeStamp<EventSelectionParams>("EventSelection/EventSelectionParams", bc.timestamp());
-      TriggerAliases* aliases = ccdb->getForTimeStamp<TriggerAliases>("EventSelection/TriggerAliases", bc.timestamp());
+      const EventSelectionParams* par = &ccdbCache.get<EventSelectionParams>(ccdb.service, hEvSelParams, bc.timestamp());
+      const TriggerAliases* aliases = &ccdbCache.get<TriggerAliases>(ccdb.service, hTriggerAliases, bc.timestamp());
       uint32_t alias{0};
       // workaround for pp2022 (trigger info is shifted by -294 bcs)
-      int32_t triggerBcId = mapGlobalBCtoBcId[bc.globalBC() + triggerBcShift];
-      if (triggerBcId) {
+      int32_t triggerBcId = mBcIndexByGlobalBC.find(bc.globalBC() + triggerBcShift);
+      if (triggerBcId > 0) {
         auto triggerBc = bcs.iteratorAt(triggerBcId);
         uint64_t triggerMask = triggerBc.triggerMask();
         for (auto& al : aliases->GetAliasToTriggerMaskMap()) {
@@ -436,19 +453,8 @@ struct EventSelectionTask {
   int64_t bcSOR = -1;     // global bc of the start of the first orbit
   int64_t nBCsPerTF = -1; // duration of TF in bcs, should be 128*3564 or 32*3564
 
-  int32_t findClosest(int64_t globalBC, std::map<int64_t, int32_t>& bcs)
-  {
-    auto it = bcs.lower_bound(globalBC);
-    int64_t bc1 = it->first;
-    int32_t index1 = it->second;
-    if (it != bcs.begin())
-      --it;
-    int64_t bc2 = it->first;
-    int32_t index2 = it->second;
-    int64_t dbc1 = std::abs(bc1 - globalBC);
-    int64_t dbc2 = std::abs(bc2 - globalBC);
-    return (dbc1 <= dbc2) ? index1 : index2;
-  }
+  BcTimeIndex bcsWithTVX; // global BC -> BC index for TVX-fired bcs, refilled for each TF
+  BcTimeIndex bcsWithTOR; // global BC -> BC index for FT0-OR-fired bcs, refilled for each TF
 
   void init(InitContext&)
   {
@@ -571,10 +577,10 @@ struct EventSelectionTask {
       nBCsPerTF = nOrbitsPerTF * o2::constants::lhc::LHCMaxBunches;
     }
 
-    // create maps from globalBC to bc index for TVX or FT0-OR fired bcs
+    // create indices from globalBC to bc index for TVX or FT0-OR fired bcs
     // to be used for closest TVX (FT0-OR) searches
-    std::map<int64_t, int32_t> mapGlobalBcWithTVX;
-    std::map<int64_t, int32_t> mapGlobalBcWithTOR;
+    bcsWithTVX.clear();
+    bcsWithTOR.clear();
     for (auto& bc : bcs) {
       int64_t globalBC = bc.globalBC();
       // skip non-colliding bcs for data and anchored runs
@@ -582,15 +588,17 @@ struct EventSelectionTask {
         continue;
       }
       if (bc.selection_bit(kIsBBT0A) || bc.selection_bit(kIsBBT0C)) {
-        mapGlobalBcWithTOR[globalBC] = bc.globalIndex();
+        bcsWithTOR.add(globalBC, bc.globalIndex());
       }
       if (bc.selection_bit(kIsTriggerTVX)) {
-        mapGlobalBcWithTVX[globalBC] = bc.globalIndex();
+        bcsWithTVX.add(globalBC, bc.globalIndex());
       }
     }
+    bcsWithTVX.build();
+    bcsWithTOR.build();
 
     // protection against empty FT0 maps
-    if (mapGlobalBcWithTOR.size() == 0 || mapGlobalBcWithTVX.size() == 0) {
+    if (bcsWithTOR.empty() || bcsWithTVX.empty()) {
       LOGP(error, "FT0 table is empty or corrupted. Filling evsel table with dummy values");
       for (auto& col : cols) {
         auto bc = col.bc_as<BCsWithBcSelsRun3>();
@@ -666,12 +674,12 @@ struct EventSelectionTask {
       int64_t minBC = meanBC - deltaBC;
       int64_t maxBC = meanBC + deltaBC;
 
-      int32_t indexClosestTVX = findClosest(meanBC, mapGlobalBcWithTVX);
+      int32_t indexClosestTVX = bcsWithTVX.findClosest(meanBC);
       int64_t tvxBC = bcs.iteratorAt(indexClosestTVX).globalBC();
       if (tvxBC >= minBC && tvxBC <= maxBC) { // closest TVX within search region
         bc.setCursor(indexClosestTVX);
       } else { // no TVX within search region, searching for TOR = T0A | T0C
-        int32_t indexClosestTOR = findClosest(meanBC, mapGlobalBcWithTOR);
+        int32_t indexClosestTOR = bcsWithTOR.findClosest(meanBC);
         int64_t torBC = bcs.iteratorAt(indexClosestTOR).globalBC();
         if (torBC >= minBC && torBC <= maxBC) {
           bc.setCursor(indexClosestTOR);
@@ -693,64 +701,34 @@ struct EventSelectionTask {
       vIsFullInfoForOccupancy[colIndex] = ((bcInTF - 300) * bcNS > timeWinOccupancyCalcNS) && ((nBCsPerTF - 4000 - bcInTF) * bcNS > timeWinOccupancyCalcNS) ? true : false;
     }
 
-    // save indices of collisions in time range for occupancy calculation
-    std::vector<std::vector<int>> vCollsInTimeWin;
-    for (auto& col : cols) {
-      int32_t colIndex = col.globalIndex();
-      std::vector<int> vAssocToThisCol;
-
-      // protection against the TF borders
+    // perform the occupancy calculation in the pre-defined time window:
+    // sum over the neighbouring collisions in the same TF and within the time range, walking from the current collision
+    std::vector<int> vNumTracksITS567inTimeWin(cols.size(), 0); // counter of tracks per found bc for occupancy studies
+    const int32_t nCols = cols.size();
+    for (int32_t colIndex = 0; colIndex < nCols; colIndex++) {
+      // protection against TF borders
       if (!vIsFullInfoForOccupancy[colIndex]) {
-        vCollsInTimeWin.push_back(vAssocToThisCol);
+        vNumTracksITS567inTimeWin[colIndex] = -1; // occupancy in undefined (too close to TF borders)
         continue;
       }
       int64_t foundGlobalBC = vFoundGlobalBC[colIndex];
       int64_t TFid = (foundGlobalBC - bcSOR) / nBCsPerTF;
+      int nITS567tracksInTimeWindow = 0;
 
-      // find all collisions in time window before the current one (start with the current collision)
-      int32_t minColIndex = colIndex;
-      while (minColIndex >= 0) {
+      // collisions in time window before the current one (start with the current collision)
+      for (int32_t minColIndex = colIndex; minColIndex >= 0; minColIndex--) {
         int64_t thisBC = vFoundGlobalBC[minColIndex];
-        // check if this is still the same TF
-        int64_t thisTFid = (thisBC - bcSOR) / nBCsPerTF;
-        if (thisTFid != TFid)
+        // check if this is still the same TF and if we are within the chosen time range
+        if ((thisBC - bcSOR) / nBCsPerTF != TFid || (foundGlobalBC - thisBC) * bcNS > timeWinOccupancyCalcNS)
           break;
-
-        // check if we are within the chosen time range
-        if ((foundGlobalBC - thisBC) * bcNS > timeWinOccupancyCalcNS)
-          break;
-        vAssocToThisCol.push_back(minColIndex);
-        minColIndex--;
+        nITS567tracksInTimeWindow += vTracksITS567perColl[minColIndex];
       }
-      // find all collisions in time window after the current one
-      int32_t maxColIndex = colIndex + 1;
-      while (maxColIndex < cols.size()) {
+      // collisions in time window after the current one
+      for (int32_t maxColIndex = colIndex + 1; maxColIndex < nCols; maxColIndex++) {
         int64_t thisBC = vFoundGlobalBC[maxColIndex];
-        int64_t thisTFid = (thisBC - bcSOR) / nBCsPerTF;
-        if (thisTFid != TFid)
-          break;
-        if ((thisBC - foundGlobalBC) * bcNS > timeWinOccupancyCalcNS)
+        if ((thisBC - bcSOR) / nBCsPerTF != TFid || (thisBC - foundGlobalBC) * bcNS > timeWinOccupancyCalcNS)
           break;
-        vAssocToThisCol.push_back(maxColIndex);
-        maxColIndex++;
-      }
-      vCollsInTimeWin.push_back(vAssocToThisCol);
-    }
-
-    // perform the occupancy calculation in the pre-defined time window
-    std::vector<int> vNumTracksITS567inTimeWin(cols.size(), 0); // counter of tracks per found bc for occupancy studies
-    for (auto& col : cols) {
-      int32_t colIndex = col.globalIndex();
-      // protection against TF borders
-      if (!vIsFullInfoForOccupancy[colIndex]) {
-        vNumTracksITS567inTimeWin[colIndex] = -1; // occupancy in undefined (too close to TF borders)
-        continue;
-      }
-      std::vector<int> vAssocToThisCol = vCollsInTimeWin[colIndex];
-      int nITS567tracksInTimeWindow = 0;
-      for (int iCol = 0; iCol < vAssocToThisCol.size(); iCol++) {
-        int thisColIndex = vAssocToThisCol[iCol];
-        nITS567tracksInTimeWindow += vTracksITS567perColl[thisColIndex];
+        nITS567tracksInTimeWindow += vTracksITS567perColl[maxColIndex];
       }
       vNumTracksITS567inTimeWin[colIndex] = nITS567tracksInTimeWindow - vTracksITS567perColl[colIndex]; // current collision is subtracted
     }
@@ -31,7 +31,6 @@ using namespace o2;
 using namespace o2::framework;
 using namespace o2::framework::expressions;
 
-using SMatrix55 = ROOT::Math::SMatrix<double, 5, 5, ROOT::Math::MatRepSym<double, 5>>;
 using SMatrix5 = ROOT::Math::SVector<double, 5>;
 
 struct FwdTrackExtension {
@@ -46,12 +45,12 @@ struct FwdTrackExtension {
         if (track.trackType() == o2::aod::fwdtrack::ForwardTrackTypeEnum::GlobalMuonTrack || track.trackType() == o2::aod::fwdtrack::ForwardTrackTypeEnum::GlobalForwardTrack || track.trackType() == o2::aod::fwdtrack::ForwardTrackTypeEnum::MuonStandaloneTrack) {
 
           auto const& collision = track.collision();
-          double chi2 = track.chi2();
+          // only the parameters are needed for the DCA, the covariances (all zero here) are not propagated
           SMatrix5 tpars(track.x(), track.y(), track.phi(), track.tgl(), track.signed1Pt());
-          std::vector<double> v1;
-          SMatrix55 tcovs(v1.begin(), v1.end());
-          o2::track::TrackParCovFwd pars1{track.z(), tpars, tcovs, chi2};
-          pars1.propagateToZlinear(collision.posZ());
+          o2::track::TrackParFwd pars1;
+          pars1.setZ(track.z());
+          pars1.setParameters(tpars);
+          pars1.propagateParamToZlinear(collision.posZ());
 
           dcaX = (pars1.getX() - collision.posX());
           dcaY = (pars1.getY() - collision.posY());
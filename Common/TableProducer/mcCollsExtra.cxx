@@ -63,9 +63,6 @@ struct mcCollisionExtra {
   Configurable<bool> pdgCodeAbsolute{"pdgCodeAbsolute", true, "if true, accept +/- pdgCodeOfInterest"};
   Configurable<float> poiEtaWindow{"poiEtaWindow", 0.8, "PDG code requirement within this eta window"};
 
-  // For manual sliceBy
-  Preslice<aod::McParticle> perMcCollision = aod::mcparticle::mcCollisionId;
-
   template <typename T>
   std::vector<std::size_t> sort_indices(const std::vector<T>& v)
   {
@@ -105,35 +102,35 @@ struct mcCollisionExtra {
   void processMcContexts(aod::McCollisions const& mcCollisions, aod::McParticles const& mcParticlesUngrouped, FullCollisions const& collisions)
   {
     std::vector<float> mcCollisionTimes;
-    std::vector<bool> mcCollisionHasPoI;
+    mcCollisionTimes.reserve(mcCollisions.size());
     for (auto& mcCollision : mcCollisions) {
-      bool PoIpresent = false;
-      auto mcParticles = mcParticlesUngrouped.sliceBy(perMcCollision, mcCollision.globalIndex());
-      for (auto& mcParticle : mcParticles) {
-        if (std::abs(mcParticle.eta()) < poiEtaWindow) {
-          if (mcParticle.pdgCode() == pdgCodeOfInterest) {
-            PoIpresent = true;
-          }
-          if (mcParticle.pdgCode() == -pdgCodeOfInterest && pdgCodeAbsolute) {
-            PoIpresent = true;
-          }
-        }
-      }
       mcCollisionTimes.emplace_back(mcCollision.t());
-      mcCollisionHasPoI.emplace_back(PoIpresent);
+    }
+    // flag the mcCollisions with a particle of interest in one pass over all the particles
+    std::vector<bool> mcCollisionHasPoI(mcCollisions.size(), false);
+    for (auto& mcParticle : mcParticlesUngrouped) {
+      if (mcParticle.mcCollisionId() < 0 || std::abs(mcParticle.eta()) >= poiEtaWindow) {
+        continue;
+      }
+      if (mcParticle.pdgCode() == pdgCodeOfInterest || (mcParticle.pdgCode() == -pdgCodeOfInterest && pdgCodeAbsolute)) {
+        mcCollisionHasPoI[mcParticle.mcCollisionId()] = true;
+      }
     }
     // sort mcCollisions according to time
     auto sortedIndices = sort_indices(mcCollisionTimes);
+    // position of each mcCollision in the time order, to find the neighbours of a collision without a search
+    std::vector<int> timeOrder(sortedIndices.size());
+    for (std::size_t iSorted = 0; iSorted < sortedIndices.size(); iSorted++) {
+      timeOrder[sortedIndices[iSorted]] = iSorted;
+    }
     for (auto& collision : collisions) {
       uint16_t forwardHistory = 0, backwardHistory = 0;
       if (!collision.has_mcCollision()) {
         mcCollContexts(forwardHistory, backwardHistory);
         continue;
       }
-      auto mcCollision = collision.mcCollision();
-      auto iter = std::find(sortedIndices.begin(), sortedIndices.end(), mcCollision.index());
-      if (iter != sortedIndices.end()) {
-        int index = iter - sortedIndices.begin();
+      if (static_cast<std::size_t>(collision.mcCollisionId()) < timeOrder.size()) {
+        int index = timeOrder[collision.mcCollisionId()];
         for (int iMcColl = index + 1; iMcColl < index + 17; iMcColl++) {
           if (iMcColl >= sortedIndices.size())
             continue;
@@ -0,0 +1,155 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   mcParticleAncestry.cxx
+/// \brief  Task producing the McParticleAncestry table: per MC particle the closest physical primary
+///         ancestor, the heavy-flavour origin, the decay depth and the ancestry flags.
+///
+/// The mother chain of each particle is followed through the first mother only. The columns of
+/// McParticles needed for the traversal are copied once into flat arrays and the result of each
+/// particle is reused by its daughters, so that each particle is visited once per dataframe.
+///
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "Framework/runDataProcessing.h"
+#include "Framework/AnalysisTask.h"
+#include "Framework/AnalysisDataModel.h"
+#include "Common/Core/RecoDecay.h"
+#include "Common/DataModel/McParticleAncestry.h"
+
+using namespace o2;
+using namespace o2::framework;
+using namespace o2::aod::mcancestry;
+
+struct McParticleAncestryTask {
+  Produces<aod::McParticleAncestry> ancestry;
+
+  // per-particle inputs and results, reused for each dataframe
+  std::vector<int> firstMother;
+  std::vector<uint8_t> hfFlavour; // 4 -- charm hadron, 5 -- beauty hadron, 0 -- other
+  std::vector<uint8_t> ownFlags;  // kIsPhysicalPrimary and kFromTransport of the particle itself
+  std::vector<int> firstPrimary;
+  std::vector<uint8_t> depth;
+  std::vector<uint8_t> flags;
+  std::vector<int8_t> state; // 0 -- not visited, 1 -- on the stack, 2 -- done
+  std::vector<int> stack;
+
+  static uint8_t heavyFlavour(int pdg)
+  {
+    auto apdg = std::abs(pdg);
+    if (apdg / 100 == 4 || apdg / 1000 == 4) {
+      return 4;
+    }
+    if (apdg / 100 == 5 || apdg / 1000 == 5) {
+      return 5;
+    }
+    return 0;
+  }
+
+  // result of particle i from the one of its mother m (m < 0: no mother)
+  void resolve(int i, int m)
+  {
+    if (m < 0) {
+      depth[i] = 0;
+      flags[i] = ownFlags[i];
+      firstPrimary[i] = (ownFlags[i] & kIsPhysicalPrimary) ? i : -1;
+      return;
+    }
+    depth[i] = depth[m] < 255 ? depth[m] + 1 : 255;
+    uint8_t f = ownFlags[i] | (flags[m] & (kFromPhysicalPrimary | kFromCharmHadron | kFromBeautyHadron | kFromTransport | kTruncatedAncestry));
+    if (flags[m] & kIsPhysicalPrimary) {
+      f |= kFromPhysicalPrimary;
+    }
+    if (hfFlavour[m] == 4) {
+      f |= kFromCharmHadron;
+    } else if (hfFlavour[m] == 5) {
+      f |= kFromBeautyHadron;
+    }
+    flags[i] = f;
+    firstPrimary[i] = (ownFlags[i] & kIsPhysicalPrimary) ? i : firstPrimary[m];
+  }
+
+  void process(aod::McParticles const& particles)
+  {
+    const int n = particles.size();
+    firstMother.assign(n, -1);
+    hfFlavour.assign(n, 0);
+    ownFlags.assign(n, 0);
+    firstPrimary.assign(n, -1);
+    depth.assign(n, 0);
+    flags.assign(n, 0);
+    state.assign(n, 0);
+
+    // one sequential pass over the table
+    int i = 0;
+    for (auto const& particle : particles) {
+      if (particle.has_mothers()) {
+        int m = particle.mothersIds().front() - particles.offset();
+        if (m >= 0 && m < n && m != i) {
+          firstMother[i] = m;
+        } else {
+          ownFlags[i] |= kTruncatedAncestry;
+        }
+      }
+      hfFlavour[i] = heavyFlavour(particle.pdgCode());
+      if (particle.isPhysicalPrimary()) {
+        ownFlags[i] |= kIsPhysicalPrimary;
+      }
+      if (!particle.producedByGenerator()) {
+        ownFlags[i] |= kFromTransport;
+      }
+      ++i;
+    }
+
+    // mother chains, each particle is resolved once
+    for (int p = 0; p < n; ++p) {
+      if (state[p] == 2) {
+        continue;
+      }
+      stack.clear();
+      int cur = p;
+      while (cur >= 0 && state[cur] == 0) {
+        state[cur] = 1;
+        stack.push_back(cur);
+        cur = firstMother[cur];
+      }
+      if (cur >= 0 && state[cur] == 1) {
+        // loop in the mother chain: the particle closing it is treated as having no mother
+        ownFlags[stack.back()] |= kTruncatedAncestry;
+        firstMother[stack.back()] = -1;
+      }
+      for (auto it = stack.rbegin(); it != stack.rend(); ++it) {
+        resolve(*it, firstMother[*it]);
+        state[*it] = 2;
+      }
+    }
+
+    ancestry.reserve(n);
+    for (int p = 0; p < n; ++p) {
+      int8_t origin = RecoDecay::OriginType::None;
+      if (flags[p] & kFromBeautyHadron) {
+        origin = RecoDecay::OriginType::NonPrompt;
+      } else if ((flags[p] & kFromCharmHadron) || hfFlavour[p] == 4) {
+        origin = RecoDecay::OriginType::Prompt;
+      }
+      ancestry(firstPrimary[p], origin, depth[p], flags[p]);
+    }
+  }
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{adaptAnalysisTask<McParticleAncestryTask>(cfgc, TaskName{"mc-particle-ancestry"})};
+}
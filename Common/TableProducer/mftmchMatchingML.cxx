@@ -15,8 +15,11 @@
 #else
 #include <onnxruntime_cxx_api.h>
 #endif
+#include <algorithm>
+#include <cmath>
 #include <string>
 #include <regex>
+#include <vector>
 #include <TLorentzVector.h>
 #include "Common/DataModel/MftmchMatchingML.h"
 #include "Framework/AnalysisDataModel.h"
@@ -84,140 +87,205 @@ struct mftmchMatchingML {
 #endif
   OnnxModel model;
 
-  template <typename F, typename M>
-  std::vector<float> getVariables(F const& fwdtrack, M const& mfttrack)
-  {
-
-    static constexpr Double_t MatchingPlaneZ = -77.5;
-
-    // propagate muontrack to matching position
-    double muonchi2 = fwdtrack.chi2();
-    SMatrix5 muonpars(fwdtrack.x(), fwdtrack.y(), fwdtrack.phi(), fwdtrack.tgl(), fwdtrack.signed1Pt());
-    std::vector<double> muonv1;
-    SMatrix55 muoncovs(muonv1.begin(), muonv1.end());
-    o2::track::TrackParCovFwd muonpars1{fwdtrack.z(), muonpars, muoncovs, muonchi2};
-    muonpars1.propagateToZlinear(MatchingPlaneZ);
-
-    // propagate mfttrack to matching position
-    double mftchi2 = mfttrack.chi2();
-    SMatrix5 mftpars(mfttrack.x(), mfttrack.y(), mfttrack.phi(), mfttrack.tgl(), mfttrack.signed1Pt());
-    std::vector<double> mftv1;
-    SMatrix55 mftcovs(mftv1.begin(), mftv1.end());
-    o2::track::TrackParCovFwd mftpars1{mfttrack.z(), mftpars, mftcovs, mftchi2};
-    mftpars1.propagateToZlinear(MatchingPlaneZ);
+  static constexpr Double_t MatchingPlaneZ = -77.5;
+  static constexpr std::size_t NInputs = 17;
 
-    Float_t MFT_X = mftpars1.getX();
-    Float_t MFT_Y = mftpars1.getY();
-    Float_t MFT_Phi = mftpars1.getPhi();
-    Float_t MFT_Tanl = mftpars1.getTanl();
-
-    Float_t MCH_X = muonpars1.getX();
-    Float_t MCH_Y = muonpars1.getY();
-    Float_t MCH_Phi = muonpars1.getPhi();
-    Float_t MCH_Tanl = muonpars1.getTanl();
-
-    Float_t Ratio_X = MFT_X / MCH_X;
-    Float_t Ratio_Y = MFT_Y / MCH_Y;
-    Float_t Ratio_Phi = MFT_Phi / MCH_Phi;
-    Float_t Ratio_Tanl = MFT_Tanl / MCH_Tanl;
+  // track parameters at the matching plane
+  struct PlaneState {
+    Float_t x = 0.f;
+    Float_t y = 0.f;
+    Float_t phi = 0.f;
+    Float_t tanl = 0.f;
+  };
 
-    Float_t Delta_X = MFT_X - MCH_X;
-    Float_t Delta_Y = MFT_Y - MCH_Y;
-    Float_t Delta_Phi = MFT_Phi - MCH_Phi;
-    Float_t Delta_Tanl = MFT_Tanl - MCH_Tanl;
+  // names and shapes of the model inputs and outputs, read once from the session
+  std::vector<std::string> input_names;
+  std::vector<std::vector<int64_t>> input_shapes;
+  std::vector<std::string> output_names;
+  std::vector<std::vector<int64_t>> output_shapes;
+
+  // per dataframe: MFT tracks at the matching plane, indexed by a grid of cells of size XY-window
+  std::vector<PlaneState> mftStates;
+  std::vector<int> mftCells;              // cell of each MFT track, -1 if not finite
+  std::vector<int> cellOffsets;           // MFT tracks of cell c: cellTracks[cellOffsets[c], cellOffsets[c + 1])
+  std::vector<int> cellTracks;            // in increasing row order within a cell
+  float gridMinX = 0.f, gridMinY = 0.f, gridCell = 1.f;
+  int gridNX = 0, gridNY = 0;
+
+  // per muon: candidates within the search windows, their inputs and scores
+  std::vector<int> candidates;
+  std::vector<float> pairInputs;
+  std::vector<float> scores;
+
+  template <typename T>
+  PlaneState propagateToMatchingPlane(T const& track)
+  {
+    double chi2 = track.chi2();
+    SMatrix5 pars(track.x(), track.y(), track.phi(), track.tgl(), track.signed1Pt());
+    std::vector<double> v1;
+    SMatrix55 covs(v1.begin(), v1.end());
+    o2::track::TrackParCovFwd pars1{track.z(), pars, covs, chi2};
+    pars1.propagateToZlinear(MatchingPlaneZ);
+    PlaneState state;
+    state.x = pars1.getX();
+    state.y = pars1.getY();
+    state.phi = pars1.getPhi();
+    state.tanl = pars1.getTanl();
+    return state;
+  }
 
+  // writes the NInputs model inputs of the pair
+  void getVariables(PlaneState const& mft, PlaneState const& mch, float* inputs)
+  {
+    Float_t Delta_X = mft.x - mch.x;
+    Float_t Delta_Y = mft.y - mch.y;
     Float_t Delta_XY = sqrt(Delta_X * Delta_X + Delta_Y * Delta_Y);
-
-    std::vector<float> input_tensor_values{
-      MFT_X,
-      MFT_Y,
-      MFT_Phi,
-      MFT_Tanl,
-      MCH_X,
-      MCH_Y,
-      MCH_Phi,
-      MCH_Tanl,
+    const float values[NInputs] = {
+      mft.x,
+      mft.y,
+      mft.phi,
+      mft.tanl,
+      mch.x,
+      mch.y,
+      mch.phi,
+      mch.tanl,
       Delta_XY,
       Delta_X,
       Delta_Y,
-      Delta_Phi,
-      Delta_Tanl,
-      Ratio_X,
-      Ratio_Y,
-      Ratio_Phi,
-      Ratio_Tanl,
+      mft.phi - mch.phi,
+      mft.tanl - mch.tanl,
+      mft.x / mch.x,
+      mft.y / mch.y,
+      mft.phi / mch.phi,
+      mft.tanl / mch.tanl,
     };
-    return input_tensor_values;
+    std::copy(values, values + NInputs, inputs);
   }
 
-  template <typename F, typename M>
-  double matchONNX(F const& fwdtrack, M const& mfttrack)
+  // scores of the nPairs pairs with the inputs in pairInputs, in one run of the session
+  void matchONNX(std::size_t nPairs)
   {
-    std::vector<std::string> input_names;
-    std::vector<std::vector<int64_t>> input_shapes;
-    std::vector<std::string> output_names;
-    std::vector<std::vector<int64_t>> output_shapes;
-
-#if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
-    input_names = onnx_session->GetInputNames();
-    input_shapes = onnx_session->GetInputShapes();
-    output_names = onnx_session->GetOutputNames();
-    output_shapes = onnx_session->GetOutputShapes();
-#else
-    Ort::AllocatorWithDefaultOptions tmpAllocator;
-    for (size_t i = 0; i < onnx_session->GetInputCount(); ++i) {
-      input_names.push_back(onnx_session->GetInputNameAllocated(i, tmpAllocator).get());
+    scores.assign(nPairs, 0.f);
+    if (nPairs == 0) {
+      return;
     }
-    for (size_t i = 0; i < onnx_session->GetInputCount(); ++i) {
-      input_shapes.emplace_back(onnx_session->GetInputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape());
-    }
-    for (size_t i = 0; i < onnx_session->GetOutputCount(); ++i) {
-      output_names.push_back(onnx_session->GetOutputNameAllocated(i, tmpAllocator).get());
-    }
-    for (size_t i = 0; i < onnx_session->GetOutputCount(); ++i) {
-      output_shapes.emplace_back(onnx_session->GetOutputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape());
-    }
-#endif
-
     auto input_shape = input_shapes[0];
-    input_shape[0] = 1;
-
-    std::vector<float> input_tensor_values;
-    input_tensor_values = getVariables(fwdtrack, mfttrack);
+    input_shape[0] = nPairs;
 
-    if (input_tensor_values[8] < cfgXYWindow) {
-      std::vector<Ort::Value> input_tensors;
+    std::vector<Ort::Value> input_tensors;
 #if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
-      input_tensors.push_back(Ort::Experimental::Value::CreateTensor<float>(input_tensor_values.data(), input_tensor_values.size(), input_shape));
+    input_tensors.push_back(Ort::Experimental::Value::CreateTensor<float>(pairInputs.data(), nPairs * NInputs, input_shape));
 
-      std::vector<Ort::Value> output_tensors = onnx_session->Run(input_names, input_tensors, output_names);
+    std::vector<Ort::Value> output_tensors = onnx_session->Run(input_names, input_tensors, output_names);
 #else
-      Ort::MemoryInfo mem_info =
-        Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
-      input_tensors.push_back(Ort::Value::CreateTensor<float>(mem_info, input_tensor_values.data(), input_tensor_values.size(), input_shape.data(), input_shape.size()));
+    Ort::MemoryInfo mem_info =
+      Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
+    input_tensors.push_back(Ort::Value::CreateTensor<float>(mem_info, pairInputs.data(), nPairs * NInputs, input_shape.data(), input_shape.size()));
 
-      Ort::RunOptions runOptions;
-      std::vector<const char*> inputNamesChar(input_names.size(), nullptr);
-      std::transform(std::begin(input_names), std::end(input_names), std::begin(inputNamesChar),
-                     [&](const std::string& str) { return str.c_str(); });
+    Ort::RunOptions runOptions;
+    std::vector<const char*> inputNamesChar(input_names.size(), nullptr);
+    std::transform(std::begin(input_names), std::end(input_names), std::begin(inputNamesChar),
+                   [&](const std::string& str) { return str.c_str(); });
 
-      std::vector<const char*> outputNamesChar(output_names.size(), nullptr);
-      std::transform(std::begin(output_names), std::end(output_names), std::begin(outputNamesChar),
-                     [&](const std::string& str) { return str.c_str(); });
+    std::vector<const char*> outputNamesChar(output_names.size(), nullptr);
+    std::transform(std::begin(output_names), std::end(output_names), std::begin(outputNamesChar),
+                   [&](const std::string& str) { return str.c_str(); });
 
-      std::vector<Ort::Value> output_tensors = onnx_session->Run(runOptions, inputNamesChar.data(), input_tensors.data(), input_tensors.size(), outputNamesChar.data(), outputNamesChar.size());
+    std::vector<Ort::Value> output_tensors = onnx_session->Run(runOptions, inputNamesChar.data(), input_tensors.data(), input_tensors.size(), outputNamesChar.data(), outputNamesChar.size());
 #endif
 
-      const float* output_value = output_tensors[0].GetTensorData<float>();
+    // the score of a pair is the first output value of its row
+    const float* output_value = output_tensors[0].GetTensorData<float>();
+    const std::size_t stride = output_tensors[0].GetTensorTypeAndShapeInfo().GetElementCount() / nPairs;
+    for (std::size_t i = 0; i < nPairs; ++i) {
+      scores[i] = output_value[i * stride];
+    }
+  }
 
-      auto score = output_value[0];
+  int findCell(PlaneState const& state) const
+  {
+    if (!std::isfinite(state.x) || !std::isfinite(state.y)) {
+      return -1;
+    }
+    const int cx = static_cast<int>((state.x - gridMinX) / gridCell);
+    const int cy = static_cast<int>((state.y - gridMinY) / gridCell);
+    return cy * gridNX + cx;
+  }
 
-      return score;
-    } else {
-      auto score = 0;
-      return score;
+  // propagates the MFT tracks once and sorts them into the cells of the grid
+  template <typename M>
+  void buildMFTGrid(M const& mfttracks)
+  {
+    static constexpr int MaxCells = 1 << 20;
+    mftStates.clear();
+    mftStates.reserve(mfttracks.size());
+    float maxX = 0.f, maxY = 0.f;
+    gridMinX = gridMinY = 0.f;
+    bool first = true;
+    for (auto const& mfttrack : mfttracks) {
+      mftStates.push_back(propagateToMatchingPlane(mfttrack));
+      auto const& state = mftStates.back();
+      if (std::isfinite(state.x) && std::isfinite(state.y)) {
+        gridMinX = first ? state.x : std::min(gridMinX, state.x);
+        gridMinY = first ? state.y : std::min(gridMinY, state.y);
+        maxX = first ? state.x : std::max(maxX, state.x);
+        maxY = first ? state.y : std::max(maxY, state.y);
+        first = false;
+      }
     }
-  };
+    gridCell = cfgXYWindow > 0.f ? cfgXYWindow.value : 1.f;
+    while (static_cast<double>((maxX - gridMinX) / gridCell + 1) * ((maxY - gridMinY) / gridCell + 1) > MaxCells) {
+      gridCell *= 2; // a coarser grid still contains all the candidates in the 3x3 neighbourhood
+    }
+    gridNX = static_cast<int>((maxX - gridMinX) / gridCell) + 1;
+    gridNY = static_cast<int>((maxY - gridMinY) / gridCell) + 1;
+
+    const int nCells = gridNX * gridNY;
+    cellOffsets.assign(nCells + 1, 0);
+    mftCells.resize(mftStates.size());
+    for (std::size_t i = 0; i < mftStates.size(); ++i) {
+      mftCells[i] = findCell(mftStates[i]);
+      if (mftCells[i] >= 0) {
+        ++cellOffsets[mftCells[i] + 1];
+      }
+    }
+    for (int c = 0; c < nCells; ++c) {
+      cellOffsets[c + 1] += cellOffsets[c];
+    }
+    cellTracks.resize(cellOffsets[nCells]);
+    std::vector<int> fill(cellOffsets.begin(), cellOffsets.end() - 1);
+    for (std::size_t i = 0; i < mftStates.size(); ++i) {
+      if (mftCells[i] >= 0) {
+        cellTracks[fill[mftCells[i]]++] = i;
+      }
+    }
+  }
+
+  // MFT tracks (rows) within XY-window of the muon at the matching plane, in increasing row order
+  void findCandidates(PlaneState const& mch)
+  {
+    candidates.clear();
+    if (!std::isfinite(mch.x) || !std::isfinite(mch.y) || mftStates.empty()) {
+      return;
+    }
+    const int cx = static_cast<int>(std::clamp<double>(std::floor((mch.x - gridMinX) / gridCell), -2., gridNX + 1.));
+    const int cy = static_cast<int>(std::clamp<double>(std::floor((mch.y - gridMinY) / gridCell), -2., gridNY + 1.));
+    for (int iy = std::max(cy - 1, 0); iy <= std::min(cy + 1, gridNY - 1); ++iy) {
+      for (int ix = std::max(cx - 1, 0); ix <= std::min(cx + 1, gridNX - 1); ++ix) {
+        const int c = iy * gridNX + ix;
+        for (int k = cellOffsets[c]; k < cellOffsets[c + 1]; ++k) {
+          const auto& mft = mftStates[cellTracks[k]];
+          Float_t Delta_X = mft.x - mch.x;
+          Float_t Delta_Y = mft.y - mch.y;
+          Float_t Delta_XY = sqrt(Delta_X * Delta_X + Delta_Y * Delta_Y);
+          if (Delta_XY < cfgXYWindow) {
+            candidates.push_back(cellTracks[k]);
+          }
+        }
+      }
+    }
+    std::sort(candidates.begin(), candidates.end());
+  }
 
   void init(o2::framework::InitContext&)
   {
@@ -237,6 +305,26 @@ struct mftmchMatchingML {
                 << "/" << cfgModelName.value;
       model.initModel(cfgModelName, false, 1, strtoul(headers["Valid-From"].c_str(), NULL, 0), strtoul(headers["Valid-Until"].c_str(), NULL, 0));
       onnx_session = model.getSession();
+#if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
+      input_names = onnx_session->GetInputNames();
+      input_shapes = onnx_session->GetInputShapes();
+      output_names = onnx_session->GetOutputNames();
+      output_shapes = onnx_session->GetOutputShapes();
+#else
+      Ort::AllocatorWithDefaultOptions tmpAllocator;
+      for (size_t i = 0; i < onnx_session->GetInputCount(); ++i) {
+        input_names.push_back(onnx_session->GetInputNameAllocated(i, tmpAllocator).get());
+      }
+      for (size_t i = 0; i < onnx_session->GetInputCount(); ++i) {
+        input_shapes.emplace_back(onnx_session->GetInputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape());
+      }
+      for (size_t i = 0; i < onnx_session->GetOutputCount(); ++i) {
+        output_names.push_back(onnx_session->GetOutputNameAllocated(i, tmpAllocator).get());
+      }
+      for (size_t i = 0; i < onnx_session->GetOutputCount(); ++i) {
+        output_shapes.emplace_back(onnx_session->GetOutputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape());
+      }
+#endif
     } else {
       LOG(info) << "Failed to retrieve Network file";
     }
@@ -244,40 +332,49 @@ struct mftmchMatchingML {
 
   void process(aod::Collisions const&, soa::Filtered<aod::FwdTracks> const& fwdtracks, aod::MFTTracks const& mfttracks)
   {
+    buildMFTGrid(mfttracks);
     for (auto& fwdtrack : fwdtracks) {
       if (fwdtrack.trackType() == aod::fwdtrack::ForwardTrackTypeEnum::MuonStandaloneTrack) {
+        if (!fwdtrack.has_collision()) {
+          continue;
+        }
         double bestscore = 0;
         int bestmfttrackid = -1;
-        for (auto& mfttrack : mfttracks) {
-          if (fwdtrack.has_collision() && mfttrack.has_collision()) {
-            if (0 <= fwdtrack.collisionId() - mfttrack.collisionId() && fwdtrack.collisionId() - mfttrack.collisionId() < cfgColWindow) {
-              double result = matchONNX(fwdtrack, mfttrack);
-              if (result > cfgThrScore) {
-                bestscore = result;
-                bestmfttrackid = mfttrack.globalIndex();
-              }
-            }
+        // MFT tracks close to the muon at the matching plane and in the collision window, scored in one batch
+        const auto mch = propagateToMatchingPlane(fwdtrack);
+        findCandidates(mch);
+        std::size_t nPairs = 0;
+        pairInputs.resize(candidates.size() * NInputs);
+        for (auto row : candidates) {
+          auto mfttrack = mfttracks.rawIteratorAt(row);
+          if (mfttrack.has_collision() && 0 <= fwdtrack.collisionId() - mfttrack.collisionId() && fwdtrack.collisionId() - mfttrack.collisionId() < cfgColWindow) {
+            getVariables(mftStates[row], mch, pairInputs.data() + nPairs * NInputs);
+            candidates[nPairs++] = row;
           }
         }
-        if (bestmfttrackid != -1) {
-          for (auto& mfttrack : mfttracks) {
-            if (mfttrack.globalIndex() == bestmfttrackid) {
-              double mftchi2 = mfttrack.chi2();
-              SMatrix5 mftpars(mfttrack.x(), mfttrack.y(), mfttrack.phi(), mfttrack.tgl(), mfttrack.signed1Pt());
-              std::vector<double> mftv1;
-              SMatrix55 mftcovs(mftv1.begin(), mftv1.end());
-              o2::track::TrackParCovFwd mftpars1{mfttrack.z(), mftpars, mftcovs, mftchi2};
-              mftpars1.propagateToZlinear(mfttrack.collision().posZ());
-
-              float dcaX = (mftpars1.getX() - mfttrack.collision().posX());
-              float dcaY = (mftpars1.getY() - mfttrack.collision().posY());
-              double px = fwdtrack.p() * sin(M_PI / 2 - atan(mfttrack.tgl())) * cos(mfttrack.phi());
-              double py = fwdtrack.p() * sin(M_PI / 2 - atan(mfttrack.tgl())) * sin(mfttrack.phi());
-              double pz = fwdtrack.p() * cos(M_PI / 2 - atan(mfttrack.tgl()));
-              fwdtrackml(fwdtrack.collisionId(), 0, mfttrack.x(), mfttrack.y(), mfttrack.z(), mfttrack.phi(), mfttrack.tgl(), fwdtrack.sign() / std::sqrt(std::pow(px, 2) + std::pow(py, 2)), fwdtrack.nClusters(), fwdtrack.pDca(), fwdtrack.rAtAbsorberEnd(), 0, 0, 0, bestscore, mfttrack.globalIndex(), fwdtrack.globalIndex(), fwdtrack.mchBitMap(), fwdtrack.midBitMap(), fwdtrack.midBoards(), mfttrack.trackTime(), mfttrack.trackTimeRes(), mfttrack.eta(), std::sqrt(std::pow(px, 2) + std::pow(py, 2)), std::sqrt(std::pow(px, 2) + std::pow(py, 2) + std::pow(pz, 2)), dcaX, dcaY);
-            }
+        matchONNX(nPairs);
+        for (std::size_t i = 0; i < nPairs; ++i) {
+          if (scores[i] > cfgThrScore) {
+            bestscore = scores[i];
+            bestmfttrackid = candidates[i];
           }
         }
+        if (bestmfttrackid != -1) {
+          auto mfttrack = mfttracks.rawIteratorAt(bestmfttrackid);
+          double mftchi2 = mfttrack.chi2();
+          SMatrix5 mftpars(mfttrack.x(), mfttrack.y(), mfttrack.phi(), mfttrack.tgl(), mfttrack.signed1Pt());
+          std::vector<double> mftv1;
+          SMatrix55 mftcovs(mftv1.begin(), mftv1.end());
+          o2::track::TrackParCovFwd mftpars1{mfttrack.z(), mftpars, mftcovs, mftchi2};
+          mftpars1.propagateToZlinear(mfttrack.collision().posZ());
+
+          float dcaX = (mftpars1.getX() - mfttrack.collision().posX());
+          float dcaY = (mftpars1.getY() - mfttrack.collision().posY());
+          double px = fwdtrack.p() * sin(M_PI / 2 - atan(mfttrack.tgl())) * cos(mfttrack.phi());
+          double py = fwdtrack.p() * sin(M_PI / 2 - atan(mfttrack.tgl())) * sin(mfttrack.phi());
+          double pz = fwdtrack.p() * cos(M_PI / 2 - atan(mfttrack.tgl()));
+          fwdtrackml(fwdtrack.collisionId(), 0, mfttrack.x(), mfttrack.y(), mfttrack.z(), mfttrack.phi(), mfttrack.tgl(), fwdtrack.sign() / std::sqrt(std::pow(px, 2) + std::pow(py, 2)), fwdtrack.nClusters(), fwdtrack.pDca(), fwdtrack.rAtAbsorberEnd(), 0, 0, 0, bestscore, mfttrack.globalIndex(), fwdtrack.globalIndex(), fwdtrack.mchBitMap(), fwdtrack.midBitMap(), fwdtrack.midBoards(), mfttrack.trackTime(), mfttrack.trackTimeRes(), mfttrack.eta(), std::sqrt(std::pow(px, 2) + std::pow(py, 2)), std::sqrt(std::pow(px, 2) + std::pow(py, 2) + std::pow(pz, 2)), dcaX, dcaY);
+        }
       }
     }
   }
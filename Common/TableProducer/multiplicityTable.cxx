@@ -17,6 +17,7 @@
 #include "Common/DataModel/Multiplicity.h"
 #include "TableHelper.h"
 #include "iostream"
+#include <vector>
 #include "Framework/ASoAHelpers.h"
 #include "Framework/O2DatabasePDGPlugin.h"
 #include "Common/DataModel/TrackSelectionTables.h"
@@ -237,13 +238,77 @@ struct MultiplicityTable {
   }
 
   using Run3Tracks = soa::Join<aod::TracksIU, aod::TracksExtra>;
-  Partition<Run3Tracks> tracksIUWithTPC = (aod::track::tpcNClsFindable > (uint8_t)0);
-  Partition<Run3Tracks> pvAllContribTracksIU = ((aod::track::flags & (uint32_t)o2::aod::track::PVContributor) == (uint32_t)o2::aod::track::PVContributor);
-  Partition<Run3Tracks> pvContribTracksIU = (nabs(aod::track::eta) < 0.8f) && ((aod::track::flags & (uint32_t)o2::aod::track::PVContributor) == (uint32_t)o2::aod::track::PVContributor);
-  Partition<Run3Tracks> pvContribTracksIUEta1 = (nabs(aod::track::eta) < 1.0f) && ((aod::track::flags & (uint32_t)o2::aod::track::PVContributor) == (uint32_t)o2::aod::track::PVContributor);
-  Partition<Run3Tracks> pvContribTracksIUEtaHalf = (nabs(aod::track::eta) < 0.5f) && ((aod::track::flags & (uint32_t)o2::aod::track::PVContributor) == (uint32_t)o2::aod::track::PVContributor);
+
+  // Barrel track counters of one collision, for all the track-based estimators
+  struct TrackCounters {
+    int multTPC = 0;              // tracks with TPC clusters findable
+    int multNContribs = 0;        // PV contributors |eta| < 0.8
+    int multNContribsEta1 = 0;    // PV contributors |eta| < 1
+    int multNContribsEtaHalf = 0; // PV contributors |eta| < 0.5
+    int nHasITS = 0, nHasTPC = 0, nHasTOF = 0, nHasTRD = 0; // PV contributors per detector
+    int nITSonly = 0, nTPConly = 0, nITSTPC = 0;            // PV contributors per detector combination
+    int nAllTracksTPCOnly = 0, nAllTracksITSTPC = 0;        // tracks with TPC clusters findable, without / with ITS
+  };
+  std::vector<TrackCounters> mTrackCounters; // per collision, indexed by the collision row
+
+  // one loop over the tracks of the timeframe fills the counters of all the collisions,
+  // instead of one grouping per estimator and per collision
+  template <typename TTracks>
+  void fillTrackCounters(TTracks const& tracks)
+  {
+    const std::size_t nCollisions = mTrackCounters.size();
+    for (const auto& track : tracks) {
+      const int collisionId = track.collisionId();
+      if (collisionId < 0 || static_cast<std::size_t>(collisionId) >= nCollisions) {
+        continue;
+      }
+      auto& counters = mTrackCounters[collisionId];
+      const bool isPVContributor = (track.flags() & (uint32_t)o2::aod::track::PVContributor) == (uint32_t)o2::aod::track::PVContributor;
+      const bool hasITS = track.hasITS();
+      const bool hasTPC = track.hasTPC();
+      const bool hasTOF = track.hasTOF();
+      const bool hasTRD = track.hasTRD();
+
+      if (track.tpcNClsFindable() > 0) {
+        counters.multTPC++;
+        if (hasITS) {
+          counters.nAllTracksITSTPC++;
+        } else {
+          counters.nAllTracksTPCOnly++;
+        }
+      }
+      if (!isPVContributor) {
+        continue;
+      }
+      const float absEta = std::abs(track.eta());
+      if (absEta < 1.0f) {
+        counters.multNContribsEta1++;
+        if (absEta < 0.8)
+          counters.multNContribs++;
+        if (absEta < 0.5)
+          counters.multNContribsEtaHalf++;
+      }
+      if (hasITS) {
+        counters.nHasITS++;
+        if (hasTPC)
+          counters.nITSTPC++;
+        if (!hasTPC && !hasTOF && !hasTRD)
+          counters.nITSonly++;
+      }
+      if (hasTPC) {
+        counters.nHasTPC++;
+        if (!hasITS && !hasTOF && !hasTRD)
+          counters.nTPConly++;
+      }
+      if (hasTOF)
+        counters.nHasTOF++;
+      if (hasTRD)
+        counters.nHasTRD++;
+    }
+  }
+
   void processRun3(soa::Join<aod::Collisions, aod::EvSels> const& collisions,
-                   Run3Tracks const&,
+                   Run3Tracks const& tracks,
                    BCsWithRun3Matchings const&,
                    aod::Zdcs const&,
                    aod::FV0As const&,
@@ -322,13 +387,21 @@ struct MultiplicityTable {
     float multZeqFDDC = 0.f;
     float multZeqNContribs = 0.f;
 
+    bool needTrackCounters = false;
+    for (auto i : mEnabledTables) {
+      needTrackCounters |= (i == kTPCMults || i == kPVMults || i == kMultsExtra);
+    }
+    mTrackCounters.assign(collisions.size(), TrackCounters{});
+    if (needTrackCounters) {
+      fillTrackCounters(tracks);
+    }
+
     for (auto const& collision : collisions) {
       if ((fractionOfEvents < 1.f) && (static_cast<float>(rand_r(&randomSeed)) / static_cast<float>(RAND_MAX)) > fractionOfEvents) { // Skip events that are not sampled (only for the QA)
         return;
       }
-      int multNContribs = 0;
-      int multNContribsEta1 = 0;
-      int multNContribsEtaHalf = 0;
+      const TrackCounters& counters = mTrackCounters[collision.globalIndex()];
+      const int multNContribs = counters.multNContribs;
 
       /* check the previous run number */
       const auto& bc = collision.bc_as<BCsWithRun3Matchings>();
@@ -447,67 +520,23 @@ struct MultiplicityTable {
           } break;
           case kTPCMults: // TPC
           {
-            const auto& tracksGrouped = tracksIUWithTPC->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
-            const int multTPC = tracksGrouped.size();
+            const int multTPC = counters.multTPC;
             tableTpc(multTPC);
             LOGF(debug, "multTPC=%i", multTPC);
           } break;
           case kPVMults: // PV multiplicity
           {
-            // use only one single grouping operation, then do loop
-            const auto& tracksThisCollision = pvContribTracksIUEta1.sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
-            multNContribsEta1 = tracksThisCollision.size();
-            for (auto track : tracksThisCollision) {
-              if (std::abs(track.eta()) < 0.8)
-                multNContribs++;
-              if (std::abs(track.eta()) < 0.5)
-                multNContribsEtaHalf++;
-            }
-            tablePv(multNContribs, multNContribsEta1, multNContribsEtaHalf);
-            LOGF(debug, "multNContribs=%i, multNContribsEta1=%i, multNContribsEtaHalf=%i", multNContribs, multNContribsEta1, multNContribsEtaHalf);
+            tablePv(counters.multNContribs, counters.multNContribsEta1, counters.multNContribsEtaHalf);
+            LOGF(debug, "multNContribs=%i, multNContribsEta1=%i, multNContribsEtaHalf=%i", counters.multNContribs, counters.multNContribsEta1, counters.multNContribsEtaHalf);
           } break;
           case kMultsExtra: // Extra
           {
-            int nHasITS = 0, nHasTPC = 0, nHasTOF = 0, nHasTRD = 0;
-            int nITSonly = 0, nTPConly = 0, nITSTPC = 0;
-            const auto& pvAllContribsGrouped = pvAllContribTracksIU->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
-            const auto& tpcTracksGrouped = tracksIUWithTPC->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
-
-            for (auto track : pvAllContribsGrouped) {
-              if (track.hasITS()) {
-                nHasITS++;
-                if (track.hasTPC())
-                  nITSTPC++;
-                if (!track.hasTPC() && !track.hasTOF() && !track.hasTRD())
-                  nITSonly++;
-              }
-              if (track.hasTPC()) {
-                nHasTPC++;
-                if (!track.hasITS() && !track.hasTOF() && !track.hasTRD())
-                  nTPConly++;
-              }
-              if (track.hasTOF())
-                nHasTOF++;
-              if (track.hasTRD())
-                nHasTRD++;
-            }
-
-            int nAllTracksTPCOnly = 0;
-            int nAllTracksITSTPC = 0;
-            for (auto track : tpcTracksGrouped) {
-              if (track.hasITS()) {
-                nAllTracksITSTPC++;
-              } else {
-                nAllTracksTPCOnly++;
-              }
-            }
-
             int bcNumber = bc.globalBC() % 3564;
 
             tableExtra(collision.numContrib(), collision.chi2(), collision.collisionTimeRes(),
                        mRunNumber, collision.posZ(), collision.sel8(),
-                       nHasITS, nHasTPC, nHasTOF, nHasTRD, nITSonly, nTPConly, nITSTPC,
-                       nAllTracksTPCOnly, nAllTracksITSTPC, bcNumber, collision.trackOccupancyInTimeRange());
+                       counters.nHasITS, counters.nHasTPC, counters.nHasTOF, counters.nHasTRD, counters.nITSonly, counters.nTPConly, counters.nITSTPC,
+                       counters.nAllTracksTPCOnly, counters.nAllTracksITSTPC, bcNumber, collision.trackOccupancyInTimeRange());
           } break;
           case kMultSelections: // Multiplicity selections
           {
@@ -19,10 +19,12 @@
 ///
 
 // C++/ROOT includes.
+#include <algorithm>
 #include <chrono>
 #include <string>
 #include <vector>
 #include <TComplex.h>
+#include <TMath.h>
 #include <TH3F.h>
 
 // o2Physics includes.
@@ -104,6 +106,12 @@ struct qVectorsTable {
   std::vector<float> FT0RelGainConst{};
   std::vector<float> FV0RelGainConst{};
 
+  // Per-run copy of the Q-vector corrections of objQvec (centrality bin, correction, detector), with under- and overflow bins.
+  std::vector<float> QvecCorrections{};
+  int nCorrBinsX = 0;
+  int nCorrBinsY = 0;
+  int nCorrBinsZ = 0;
+
   // Enable access to the CCDB for the offset and correction constants and save them
   // in dedicated variables.
   Service<o2::ccdb::BasicCCDBManager> ccdb;
@@ -121,6 +129,19 @@ struct qVectorsTable {
 
   TH3F* objQvec = nullptr;
 
+  // Detector flags, resolved once from useDetector in init.
+  bool useDetectorType[kBNeg + 1] = {false};
+  std::vector<bool> correctDetectorBlock{}; // Corrections of the i-th Q-vector block, in the iteration order of useDetector.
+
+  // Output buffers, reused between the collisions.
+  std::vector<int> TrkBPosLabel{};
+  std::vector<int> TrkBNegLabel{};
+  std::vector<float> qvecRe{};
+  std::vector<float> qvecIm{};
+  std::vector<float> qvecAmp{};
+
+  Preslice<MyTracks> tracksPerCollision = aod::track::collisionId;
+
   std::unordered_map<string, bool> useDetector = {
     {"QvectorBNegs", cfgUseBNeg},
     {"QvectorBPoss", cfgUseBPos},
@@ -175,6 +196,17 @@ struct qVectorsTable {
     histosQA.add("FT0AmpCor", "", {HistType::kTH2F, {axisFITamp, axisChID}});
     histosQA.add("FV0Amp", "", {HistType::kTH2F, {axisFITamp, axisChID}});
     histosQA.add("FV0AmpCor", "", {HistType::kTH2F, {axisFITamp, axisChID}});
+
+    useDetectorType[kFT0C] = useDetector["QvectorFT0Cs"];
+    useDetectorType[kFT0A] = useDetector["QvectorFT0As"];
+    useDetectorType[kFT0M] = useDetector["QvectorFT0Ms"];
+    useDetectorType[kFV0A] = useDetector["QvectorFV0As"];
+    useDetectorType[kBPos] = useDetector["QvectorBPoss"];
+    useDetectorType[kBNeg] = useDetector["QvectorBNegs"];
+    correctDetectorBlock.clear();
+    for (auto const& det : useDetector) {
+      correctDetectorBlock.push_back(det.second);
+    }
   }
 
   void initCCDB(aod::BCsWithTimestamps::iterator const& bc, int harmonics)
@@ -231,6 +263,36 @@ struct qVectorsTable {
     } else {
       FV0RelGainConst = *(objfv0Gain);
     }
+
+    // Channel azimuthal angles with the alignment offsets of this run.
+    helperEP.SetChannelAngles(ft0geom, fv0geom, harmonics);
+
+    QvecCorrections.clear();
+    if (objQvec != nullptr) {
+      nCorrBinsX = objQvec->GetNbinsX();
+      nCorrBinsY = objQvec->GetNbinsY();
+      nCorrBinsZ = objQvec->GetNbinsZ();
+      QvecCorrections.resize((nCorrBinsX + 2) * (nCorrBinsY + 2) * (nCorrBinsZ + 2));
+      for (int iz = 0; iz < nCorrBinsZ + 2; iz++) {
+        for (int iy = 0; iy < nCorrBinsY + 2; iy++) {
+          for (int ix = 0; ix < nCorrBinsX + 2; ix++) {
+            QvecCorrections[(iz * (nCorrBinsY + 2) + iy) * (nCorrBinsX + 2) + ix] = objQvec->GetBinContent(ix, iy, iz);
+          }
+        }
+      }
+    }
+  }
+
+  // Q-vector correction of objQvec for the given bins, as objQvec->GetBinContent(binX, binY, binZ)
+  float getQvecCorrection(int binX, int binY, int binZ) const
+  {
+    if (QvecCorrections.empty()) {
+      LOGF(fatal, "Could not get the Q-vector corrections.");
+    }
+    binX = std::clamp(binX, 0, nCorrBinsX + 1);
+    binY = std::clamp(binY, 0, nCorrBinsY + 1);
+    binZ = std::clamp(binZ, 0, nCorrBinsZ + 1);
+    return QvecCorrections[(binZ * (nCorrBinsY + 2) + binY) * (nCorrBinsX + 2) + binX];
   }
 
   template <typename TrackType>
@@ -258,20 +320,22 @@ struct qVectorsTable {
     return true;
   }
 
-  void process(MyCollisions::iterator const& coll, aod::BCsWithTimestamps const&, aod::FT0s const&, aod::FV0As const&, MyTracks const& tracks)
+  template <typename TCollision, typename TTracks>
+  void fillQvectors(TCollision const& coll, TTracks const& tracks)
   {
-    std::vector<int> TrkBPosLabel{};
-    std::vector<int> TrkBNegLabel{};
-    std::vector<float> qvecRe{};
-    std::vector<float> qvecIm{};
-    std::vector<float> qvecAmp{};
+    TrkBPosLabel.clear();
+    TrkBNegLabel.clear();
+    qvecRe.clear();
+    qvecIm.clear();
+    qvecAmp.clear();
 
-    auto bc = coll.bc_as<aod::BCsWithTimestamps>();
+    auto bc = coll.template bc_as<aod::BCsWithTimestamps>();
     int currentRun = bc.runNumber();
     if (runNumber != currentRun) {
       initCCDB(bc, static_cast<int>(cfgnMod));
       runNumber = currentRun;
     }
+    const int nMod = cfgnMod;
 
     // Get the centrality value for all subscribed estimators and takes the one
     // corresponding to cfgCentEsti. Reject also the events with invalid values.
@@ -306,11 +370,11 @@ struct qVectorsTable {
     /// First check if the collision has a found FT0. If yes, calculate the
     /// Q-vectors for FT0A and FT0C (both real and imaginary parts). If no,
     /// attribute dummy values to the corresponding qVect.
-    if (coll.has_foundFT0() && (useDetector["QvectorFT0As"] || useDetector["QvectorFT0Cs"] || useDetector["QvectorFT0Ms"])) {
+    if (coll.has_foundFT0() && (useDetectorType[kFT0A] || useDetectorType[kFT0C] || useDetectorType[kFT0M])) {
       auto ft0 = coll.foundFT0();
 
       // Check whether FT0-A is being used.
-      if (useDetector["QvectorFT0As"]) {
+      if (useDetectorType[kFT0A]) {
         // Iterate over the non-dead channels for FT0-A to get the total Q-vector
         // and sum of amplitudes.
         for (std::size_t iChA = 0; iChA < ft0.channelA().size(); iChA++) {
@@ -318,12 +382,16 @@ struct qVectorsTable {
           float ampl = ft0.amplitudeA()[iChA];
           int FT0AchId = ft0.channelA()[iChA];
 
+          float amplCor = ampl / FT0RelGainConst[FT0AchId];
+
           histosQA.fill(HIST("FT0Amp"), ampl, FT0AchId);
-          histosQA.fill(HIST("FT0AmpCor"), ampl / FT0RelGainConst[FT0AchId], FT0AchId);
-          // Update the Q-vector and sum of amplitudes using the helper function.
-          // LOKI: Note this assumes nHarmo = 2!! Likely generalise in the future.
-          helperEP.SumQvectors(0, FT0AchId, ampl / FT0RelGainConst[FT0AchId], cfgnMod, QvecDet, sumAmplFT0A, ft0geom, fv0geom);
-          helperEP.SumQvectors(0, FT0AchId, ampl / FT0RelGainConst[FT0AchId], cfgnMod, QvecFT0M, sumAmplFT0M, ft0geom, fv0geom);
+          histosQA.fill(HIST("FT0AmpCor"), amplCor, FT0AchId);
+          // Update the Q-vector and sum of amplitudes with the channel angle of this run.
+          TComplex qvecCh(amplCor * helperEP.GetCosPhi(0, FT0AchId, nMod), amplCor * helperEP.GetSinPhi(0, FT0AchId, nMod));
+          QvecDet += qvecCh;
+          sumAmplFT0A += amplCor;
+          QvecFT0M += qvecCh;
+          sumAmplFT0M += amplCor;
         } // Go to the next channel iChA.
 
         // Set the Qvectors for FT0A with the normalised Q-vector values if the sum of
@@ -342,7 +410,7 @@ struct qVectorsTable {
         qVectFT0A[1] = -999.;
       }
 
-      if (useDetector["QvectorFT0Cs"]) {
+      if (useDetectorType[kFT0C]) {
         // Repeat the procedure with FT0-C for the found FT0.
         // Start by resetting to zero the intermediate quantities.
         QvecDet = TComplex(0., 0.);
@@ -352,11 +420,16 @@ struct qVectorsTable {
           float ampl = ft0.amplitudeC()[iChC];
           int FT0CchId = ft0.channelC()[iChC] + 96;
 
+          float amplCor = ampl / FT0RelGainConst[FT0CchId];
+
           histosQA.fill(HIST("FT0Amp"), ampl, FT0CchId);
-          histosQA.fill(HIST("FT0AmpCor"), ampl / FT0RelGainConst[FT0CchId], FT0CchId);
+          histosQA.fill(HIST("FT0AmpCor"), amplCor, FT0CchId);
 
-          helperEP.SumQvectors(0, FT0CchId, ampl / FT0RelGainConst[FT0CchId], cfgnMod, QvecDet, sumAmplFT0C, ft0geom, fv0geom);
-          helperEP.SumQvectors(0, FT0CchId, ampl / FT0RelGainConst[FT0CchId], cfgnMod, QvecFT0M, sumAmplFT0M, ft0geom, fv0geom);
+          TComplex qvecCh(amplCor * helperEP.GetCosPhi(0, FT0CchId, nMod), amplCor * helperEP.GetSinPhi(0, FT0CchId, nMod));
+          QvecDet += qvecCh;
+          sumAmplFT0C += amplCor;
+          QvecFT0M += qvecCh;
+          sumAmplFT0M += amplCor;
         }
 
         if (sumAmplFT0C > 1e-8) {
@@ -373,7 +446,7 @@ struct qVectorsTable {
         qVectFT0C[1] = -999.;
       }
 
-      if (sumAmplFT0M > 1e-8 && useDetector["QvectorFT0Ms"]) {
+      if (sumAmplFT0M > 1e-8 && useDetectorType[kFT0M]) {
         QvecFT0M /= sumAmplFT0M;
         qVectFT0M[0] = QvecFT0M.Re();
         qVectFT0M[1] = QvecFT0M.Im();
@@ -392,16 +465,18 @@ struct qVectorsTable {
 
     QvecDet = TComplex(0., 0.);
     sumAmplFV0A = 0;
-    if (coll.has_foundFV0() && useDetector["QvectorFV0As"]) {
+    if (coll.has_foundFV0() && useDetectorType[kFV0A]) {
       auto fv0 = coll.foundFV0();
 
       for (std::size_t iCh = 0; iCh < fv0.channel().size(); iCh++) {
         float ampl = fv0.amplitude()[iCh];
         int FV0AchId = fv0.channel()[iCh];
+        float amplCor = ampl / FV0RelGainConst[FV0AchId];
         histosQA.fill(HIST("FV0Amp"), ampl, FV0AchId);
-        histosQA.fill(HIST("FV0AmpCor"), ampl / FV0RelGainConst[FV0AchId], FV0AchId);
+        histosQA.fill(HIST("FV0AmpCor"), amplCor, FV0AchId);
 
-        helperEP.SumQvectors(1, FV0AchId, ampl / FV0RelGainConst[FV0AchId], cfgnMod, QvecDet, sumAmplFV0A, ft0geom, fv0geom);
+        QvecDet += TComplex(amplCor * helperEP.GetCosPhi(1, FV0AchId, nMod), amplCor * helperEP.GetSinPhi(1, FV0AchId, nMod));
+        sumAmplFV0A += amplCor;
       }
 
       if (sumAmplFV0A > 1e-8) {
@@ -425,18 +500,27 @@ struct qVectorsTable {
       if (!SelTrack(trk)) {
         continue;
       }
-      histosQA.fill(HIST("ChTracks"), trk.pt(), trk.eta(), trk.phi(), cent);
-      if (std::abs(trk.eta()) < 0.1 || std::abs(trk.eta()) > 0.8) {
+      const float pt = trk.pt();
+      const float eta = trk.eta();
+      const float phi = trk.phi();
+      histosQA.fill(HIST("ChTracks"), pt, eta, phi, cent);
+      if (std::abs(eta) < 0.1 || std::abs(eta) > 0.8) {
         continue;
       }
-      if (trk.eta() > 0 && useDetector["QvectorBPoss"]) {
-        qVectBPos[0] += trk.pt() * std::cos(trk.phi() * cfgnMod);
-        qVectBPos[1] += trk.pt() * std::sin(trk.phi() * cfgnMod);
+      const bool isBPos = eta > 0 && useDetectorType[kBPos];
+      if (!isBPos && !(eta < 0 && useDetectorType[kBNeg])) {
+        continue;
+      }
+      const float qx = pt * std::cos(phi * nMod);
+      const float qy = pt * std::sin(phi * nMod);
+      if (isBPos) {
+        qVectBPos[0] += qx;
+        qVectBPos[1] += qy;
         TrkBPosLabel.push_back(trk.globalIndex());
         nTrkBPos++;
-      } else if (trk.eta() < 0 && useDetector["QvectorBNegs"]) {
-        qVectBNeg[0] += trk.pt() * std::cos(trk.phi() * cfgnMod);
-        qVectBNeg[1] += trk.pt() * std::sin(trk.phi() * cfgnMod);
+      } else {
+        qVectBNeg[0] += qx;
+        qVectBNeg[1] += qy;
         TrkBNegLabel.push_back(trk.globalIndex());
         nTrkBNeg++;
       }
@@ -492,27 +576,27 @@ struct qVectorsTable {
 
     if (cent < 80) {
       int i = 0;
-      for (auto det : useDetector) {
+      for (bool correctBlock : correctDetectorBlock) {
         // Check whether Q-vectors are found for a detector
-        if (!useDetector[det.first.data()]) {
+        if (!correctBlock) {
           i++;
           continue;
         }
 
         helperEP.DoRecenter(qvecRe[i * 4 + 1], qvecIm[i * 4 + 1],
-                            objQvec->GetBinContent(static_cast<int>(cent) + 1, 1, i + 1), objQvec->GetBinContent(static_cast<int>(cent) + 1, 2, i + 1));
+                            getQvecCorrection(static_cast<int>(cent) + 1, 1, i + 1), getQvecCorrection(static_cast<int>(cent) + 1, 2, i + 1));
 
         helperEP.DoRecenter(qvecRe[i * 4 + 2], qvecIm[i * 4 + 2],
-                            objQvec->GetBinContent(static_cast<int>(cent) + 1, 1, i + 1), objQvec->GetBinContent(static_cast<int>(cent) + 1, 2, i + 1));
+                            getQvecCorrection(static_cast<int>(cent) + 1, 1, i + 1), getQvecCorrection(static_cast<int>(cent) + 1, 2, i + 1));
         helperEP.DoTwist(qvecRe[i * 4 + 2], qvecIm[i * 4 + 2],
-                         objQvec->GetBinContent(static_cast<int>(cent) + 1, 3, i + 1), objQvec->GetBinContent(static_cast<int>(cent) + 1, 4, i + 1));
+                         getQvecCorrection(static_cast<int>(cent) + 1, 3, i + 1), getQvecCorrection(static_cast<int>(cent) + 1, 4, i + 1));
 
         helperEP.DoRecenter(qvecRe[i * 4 + 3], qvecIm[i * 4 + 3],
-                            objQvec->GetBinContent(static_cast<int>(cent) + 1, 1, i + 1), objQvec->GetBinContent(static_cast<int>(cent) + 1, 2, i + 1));
+                            getQvecCorrection(static_cast<int>(cent) + 1, 1, i + 1), getQvecCorrection(static_cast<int>(cent) + 1, 2, i + 1));
         helperEP.DoTwist(qvecRe[i * 4 + 3], qvecIm[i * 4 + 3],
-                         objQvec->GetBinContent(static_cast<int>(cent) + 1, 3, i + 1), objQvec->GetBinContent(static_cast<int>(cent) + 1, 4, i + 1));
+                         getQvecCorrection(static_cast<int>(cent) + 1, 3, i + 1), getQvecCorrection(static_cast<int>(cent) + 1, 4, i + 1));
         helperEP.DoRescale(qvecRe[i * 4 + 3], qvecIm[i * 4 + 3],
-                           objQvec->GetBinContent(static_cast<int>(cent) + 1, 5, i + 1), objQvec->GetBinContent(static_cast<int>(cent) + 1, 6, i + 1));
+                           getQvecCorrection(static_cast<int>(cent) + 1, 5, i + 1), getQvecCorrection(static_cast<int>(cent) + 1, 6, i + 1));
         i++;
       }
     }
@@ -520,19 +604,42 @@ struct qVectorsTable {
     // Fill the columns of the Qvectors table if they are found for a detector.
     int CorrLevel = cfgCorrLevel == 0 ? 0 : cfgCorrLevel - 1;
     qVector(cent, IsCalibrated, qvecRe, qvecIm, qvecAmp);
-    if (useDetector["QvectorFT0Cs"])
+    if (useDetectorType[kFT0C])
       qVectorFT0C(IsCalibrated, qvecRe[kFT0C * 4 + CorrLevel], qvecIm[kFT0C * 4 + CorrLevel], sumAmplFT0C);
-    if (useDetector["QvectorFT0As"])
+    if (useDetectorType[kFT0A])
       qVectorFT0A(IsCalibrated, qvecRe[kFT0A * 4 + CorrLevel], qvecIm[kFT0A * 4 + CorrLevel], sumAmplFT0A);
-    if (useDetector["QvectorFT0Ms"])
+    if (useDetectorType[kFT0M])
       qVectorFT0M(IsCalibrated, qvecRe[kFT0M * 4 + CorrLevel], qvecIm[kFT0M * 4 + CorrLevel], sumAmplFT0M);
-    if (useDetector["QvectorFV0As"])
+    if (useDetectorType[kFV0A])
       qVectorFV0A(IsCalibrated, qvecRe[kFV0A * 4 + CorrLevel], qvecIm[kFV0A * 4 + CorrLevel], sumAmplFV0A);
-    if (useDetector["QvectorBPoss"])
+    if (useDetectorType[kBPos])
       qVectorBPos(IsCalibrated, qvecRe[kBPos * 4 + CorrLevel], qvecIm[kBPos * 4 + CorrLevel], nTrkBPos, TrkBPosLabel);
-    if (useDetector["QvectorBNegs"])
+    if (useDetectorType[kBNeg])
       qVectorBNeg(IsCalibrated, qvecRe[kBNeg * 4 + CorrLevel], qvecIm[kBNeg * 4 + CorrLevel], nTrkBNeg, TrkBNegLabel);
 
+  } // End fillQvectors.
+
+  void process(MyCollisions const& colls, aod::BCsWithTimestamps const&, aod::FT0s const&, aod::FV0As const&, MyTracks const& tracks)
+  {
+    // the output tables are reserved once per dataframe
+    qVector.reserve(colls.size());
+    if (useDetectorType[kFT0C])
+      qVectorFT0C.reserve(colls.size());
+    if (useDetectorType[kFT0A])
+      qVectorFT0A.reserve(colls.size());
+    if (useDetectorType[kFT0M])
+      qVectorFT0M.reserve(colls.size());
+    if (useDetectorType[kFV0A])
+      qVectorFV0A.reserve(colls.size());
+    if (useDetectorType[kBPos])
+      qVectorBPos.reserve(colls.size());
+    if (useDetectorType[kBNeg])
+      qVectorBNeg.reserve(colls.size());
+
+    for (auto const& coll : colls) {
+      auto tracksThisColl = tracks.sliceBy(tracksPerCollision, coll.globalIndex());
+      fillQvectors(coll, tracksThisColl);
+    }
   } // End process.
 };
 
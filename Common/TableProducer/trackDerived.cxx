@@ -0,0 +1,66 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   trackDerived.cxx
+/// \brief  Task producing the TracksDerived table: the per-track quantities computed by the dynamic
+///         columns of Tracks and TracksExtra (eta, phi, cluster counts, ...) and the relative pt
+///         resolution, evaluated once per track for all the tasks of the workflow.
+///
+
+#include <cmath>
+
+#include "Framework/runDataProcessing.h"
+#include "Framework/AnalysisTask.h"
+#include "Framework/AnalysisDataModel.h"
+#include "Common/DataModel/TracksDerived.h"
+
+using namespace o2;
+using namespace o2::framework;
+
+struct TrackDerived {
+  Produces<aod::TracksDerived> tracksDerived;
+
+  template <bool withCov, typename T>
+  void fillTable(T const& tracks)
+  {
+    tracksDerived.reserve(tracks.size());
+    for (const auto& track : tracks) {
+      const float pt = track.pt();
+      float ptRelResolution = -1.f;
+      if constexpr (withCov) {
+        ptRelResolution = pt * std::sqrt(track.c1Pt21Pt2());
+      }
+      tracksDerived(pt, track.p(), track.eta(), track.phi(),
+                    track.itsNCls(), track.itsNClsInnerBarrel(),
+                    track.tpcNClsFound(), track.tpcNClsCrossedRows(),
+                    track.tpcCrossedRowsOverFindableCls(), track.tpcFractionSharedCls(),
+                    ptRelResolution);
+    }
+  }
+
+  void processWithCov(soa::Join<aod::Tracks, aod::TracksExtra, aod::TracksCov> const& tracks)
+  {
+    fillTable<true>(tracks);
+  }
+  PROCESS_SWITCH(TrackDerived, processWithCov, "Tracks with covariance matrix", true);
+
+  void processWithoutCov(soa::Join<aod::Tracks, aod::TracksExtra> const& tracks)
+  {
+    fillTable<false>(tracks);
+  }
+  PROCESS_SWITCH(TrackDerived, processWithoutCov, "Tracks without covariance matrix (pt resolution set to -1)", false);
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{adaptAnalysisTask<TrackDerived>(cfgc, TaskName{"track-derived"})};
+}
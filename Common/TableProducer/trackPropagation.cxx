@@ -13,8 +13,13 @@
 // Task to add a table of track parameters propagated to the primary vertex
 //
 
+#include <algorithm>
+#include <thread>
+#include <vector>
+
 #include "TableHelper.h"
 #include "Common/Tools/TrackTuner.h"
+#include "Common/Core/SharedMatLUT.h"
 
 // The Run 3 AO2D stores the tracks at the point of innermost update. For a track with ITS this is the innermost (or second innermost)
 // ITS layer. For a track without ITS, this is the TPC inner wall or for loopers in the TPC even a radius beyond that.
@@ -55,10 +60,15 @@ struct TrackPropagation {
 
   Configurable<std::string> ccdburl{"ccdb-url", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
   Configurable<std::string> lutPath{"lutPath", "GLO/Param/MatLUT", "Path of the Lut parametrization"};
+  Configurable<std::string> lutSharedDir{"lutSharedDir", "", "Directory of the material LUT file shared by the devices of a node (e.g. /dev/shm), empty to load it per device"};
   Configurable<std::string> geoPath{"geoPath", "GLO/Config/GeometryAligned", "Path of the geometry file"};
   Configurable<std::string> grpmagPath{"grpmagPath", "GLO/Config/GRPMagField", "CCDB path of the GRPMagField object"};
   Configurable<std::string> mVtxPath{"mVtxPath", "GLO/Calib/MeanVertex", "Path of the mean vertex file"};
   Configurable<float> minPropagationRadius{"minPropagationDistance", o2::constants::geom::XTPCInnerRef + 0.1, "Only tracks which are at a smaller radius will be propagated, defaults to TPC inner wall"};
+  Configurable<float> minPtForPropagation{"minPtForPropagation", -1.f, "Only tracks with a larger pT at the innermost update will be propagated, the others are filled unpropagated (< 0: no selection)"};
+  Configurable<float> maxEtaForPropagation{"maxEtaForPropagation", -1.f, "Only tracks with a smaller |eta| at the innermost update will be propagated, the others are filled unpropagated (< 0: no selection)"};
+  Configurable<int> nThreads{"nThreads", 1, "Number of threads for the track propagation"};
+  Configurable<int> chunkSize{"chunkSize", 0, "Number of tracks staged and propagated at once, bounds the memory of the propagation buffers (<= 0: whole dataframe)"};
   // for TrackTuner only (MC smearing)
   Configurable<bool> useTrackTuner{"useTrackTuner", false, "Apply track tuner corrections to MC"};
   Configurable<bool> fillTrackTunerTable{"fillTrackTunerTable", false, "flag to fill track tuner table"};
@@ -109,7 +119,7 @@ struct TrackPropagation {
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
 
-    lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(lutPath));
+    lut = o2::common::matlut::getMatLUT(ccdb.service, lutPath, lutSharedDir);
     // Histograms for track tuner
     AxisSpec axisBinsDCA = {600, -0.15f, 0.15f, "#it{dca}_{xy} (cm)"};
     registry.add("hDCAxyVsPtRec", "hDCAxyVsPtRec", kTH2F, {axisBinsDCA, axisPtQA});
@@ -142,144 +152,223 @@ struct TrackPropagation {
     runNumber = bc.runNumber();
   }
 
-  // Running variables
-  gpu::gpustd::array<float, 2> mDcaInfo;
-  o2::dataformats::DCA mDcaInfoCov;
-  o2::dataformats::VertexBase mVtx;
-  o2::track::TrackParametrization<float> mTrackPar;
-  o2::track::TrackParametrizationWithError<float> mTrackParCov;
-
-  template <typename TTrack, typename TParticle, bool isMc, bool fillCovMat = false, bool useTrkPid = false>
-  void fillTrackTables(TTrack const& tracks,
-                       TParticle const&,
-                       aod::Collisions const&,
-                       aod::BCsWithTimestamps const& bcs)
+  // Propagation status of the staged tracks
+  enum PropagationStatus : uint8_t {
+    kNotPropagated = 0, // filled at the innermost update
+    kToPropagate,
+    kPropagationFailed,
+    kPropagated
+  };
+
+  // Buffers of the chunk of tracks being propagated, reused between chunks and dataframes
+  std::vector<o2::track::TrackParametrization<float>> mTrackPars;
+  std::vector<o2::track::TrackParametrizationWithError<float>> mTrackParCovs;
+  std::vector<gpu::gpustd::array<float, 2>> mDcaInfos;
+  std::vector<o2::dataformats::DCA> mDcaInfoCovs;
+  std::vector<o2::dataformats::VertexBase> mVertices;
+  std::vector<uint8_t> mStatus;
+  std::vector<double> mQ2OverPtNew;
+
+  // Reads the tracks [first, last) into the chunk buffers and selects the ones to propagate (serial, the track tuner fills histograms)
+  template <typename TTrack, bool isMc, bool fillCovMat, bool useTrkPid>
+  void stageTracks(TTrack const& tracks, int64_t first, int64_t last)
   {
-    if (bcs.size() == 0) {
-      return;
-    }
-    initCCDB(bcs.begin());
-
+    const std::size_t nStaged = last - first;
     if constexpr (fillCovMat) {
-      tracksParCovPropagated.reserve(tracks.size());
-      tracksParCovExtensionPropagated.reserve(tracks.size());
-      if (fillTracksDCACov) {
-        tracksDCACov.reserve(tracks.size());
-      }
+      mTrackParCovs.resize(nStaged);
+      mDcaInfoCovs.resize(nStaged);
     } else {
-      tracksParPropagated.reserve(tracks.size());
-      tracksParExtensionPropagated.reserve(tracks.size());
-      if (fillTracksDCA) {
-        tracksDCA.reserve(tracks.size());
-      }
+      mTrackPars.resize(nStaged);
+      mDcaInfos.resize(nStaged);
     }
+    mVertices.resize(nStaged);
+    mStatus.assign(nStaged, kNotPropagated);
+    mQ2OverPtNew.assign(nStaged, -9999.);
 
-    for (auto& track : tracks) {
+    for (std::size_t i = 0; i < nStaged; i++) {
+      auto track = tracks.iteratorAt(first + i);
+      float pt, eta;
       if constexpr (fillCovMat) {
-        if (fillTracksDCA || fillTracksDCACov) {
-          mDcaInfoCov.set(999, 999, 999, 999, 999);
-        }
-        setTrackParCov(track, mTrackParCov);
+        mDcaInfoCovs[i].set(999, 999, 999, 999, 999);
+        setTrackParCov(track, mTrackParCovs[i]);
         if constexpr (useTrkPid) {
-          mTrackParCov.setPID(track.pidForTracking());
+          mTrackParCovs[i].setPID(track.pidForTracking());
         }
+        pt = mTrackParCovs[i].getPt();
+        eta = mTrackParCovs[i].getEta();
       } else {
-        if (fillTracksDCA) {
-          mDcaInfo[0] = 999;
-          mDcaInfo[1] = 999;
-        }
-        setTrackPar(track, mTrackPar);
+        mDcaInfos[i][0] = 999;
+        mDcaInfos[i][1] = 999;
+        setTrackPar(track, mTrackPars[i]);
         if constexpr (useTrkPid) {
-          mTrackPar.setPID(track.pidForTracking());
+          mTrackPars[i].setPID(track.pidForTracking());
         }
+        pt = mTrackPars[i].getPt();
+        eta = mTrackPars[i].getEta();
       }
-      // auto trackParCov = getTrackParCov(track);
-      aod::track::TrackTypeEnum trackType = (aod::track::TrackTypeEnum)track.trackType();
-      // std::array<float, 3> trackPxPyPz;
-      // std::array<float, 3> trackPxPyPzTuned = {0.0, 0.0, 0.0};
-      double q2OverPtNew = -9999.;
       // Only propagate tracks which have passed the innermost wall of the TPC (e.g. skipping loopers etc). Others fill unpropagated.
-      if (track.trackType() == aod::track::TrackIU && track.x() < minPropagationRadius) {
-        if constexpr (isMc && fillCovMat) { // checking MC and fillCovMat block begins
-          // bool hasMcParticle = track.has_mcParticle();
-          if (useTrackTuner) {
-            trackTunedTracks->Fill(1); // all tracks
-            bool hasMcParticle = track.has_mcParticle();
-            if (hasMcParticle) {
-              auto mcParticle = track.mcParticle();
-              trackTunerObj.tuneTrackParams(mcParticle, mTrackParCov, matCorr, &mDcaInfoCov, trackTunedTracks);
-              q2OverPtNew = mTrackParCov.getQ2Pt();
-            }
-          }
-        } // MC and fillCovMat block ends
-        bool isPropagationOK = true;
-
-        if (track.has_collision()) {
-          auto const& collision = track.collision();
-          if constexpr (fillCovMat) {
-            mVtx.setPos({collision.posX(), collision.posY(), collision.posZ()});
-            mVtx.setCov(collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ());
-            isPropagationOK = o2::base::Propagator::Instance()->propagateToDCABxByBz(mVtx, mTrackParCov, 2.f, matCorr, &mDcaInfoCov);
-          } else {
-            isPropagationOK = o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, mTrackPar, 2.f, matCorr, &mDcaInfo);
-          }
-        } else {
-          if constexpr (fillCovMat) {
-            mVtx.setPos({mMeanVtx->getX(), mMeanVtx->getY(), mMeanVtx->getZ()});
-            mVtx.setCov(mMeanVtx->getSigmaX() * mMeanVtx->getSigmaX(), 0.0f, mMeanVtx->getSigmaY() * mMeanVtx->getSigmaY(), 0.0f, 0.0f, mMeanVtx->getSigmaZ() * mMeanVtx->getSigmaZ());
-            isPropagationOK = o2::base::Propagator::Instance()->propagateToDCABxByBz(mVtx, mTrackParCov, 2.f, matCorr, &mDcaInfoCov);
-          } else {
-            isPropagationOK = o2::base::Propagator::Instance()->propagateToDCABxByBz({mMeanVtx->getX(), mMeanVtx->getY(), mMeanVtx->getZ()}, mTrackPar, 2.f, matCorr, &mDcaInfo);
+      if (track.trackType() != aod::track::TrackIU || !(track.x() < minPropagationRadius)) {
+        continue;
+      }
+      // cheap pre-selection: tracks out of the analysis acceptance are filled unpropagated as well
+      if ((minPtForPropagation >= 0.f && pt < minPtForPropagation) || (maxEtaForPropagation >= 0.f && std::abs(eta) > maxEtaForPropagation)) {
+        continue;
+      }
+      if constexpr (isMc && fillCovMat) { // checking MC and fillCovMat block begins
+        if (useTrackTuner) {
+          trackTunedTracks->Fill(1); // all tracks
+          bool hasMcParticle = track.has_mcParticle();
+          if (hasMcParticle) {
+            auto mcParticle = track.mcParticle();
+            trackTunerObj.tuneTrackParams(mcParticle, mTrackParCovs[i], matCorr, &mDcaInfoCovs[i], trackTunedTracks);
+            mQ2OverPtNew[i] = mTrackParCovs[i].getQ2Pt();
           }
         }
-        if (isPropagationOK) {
-          trackType = aod::track::Track;
-        }
+      } // MC and fillCovMat block ends
+
+      auto& vtx = mVertices[i];
+      if (track.has_collision()) {
+        auto const& collision = track.collision();
+        vtx.setPos({collision.posX(), collision.posY(), collision.posZ()});
+        vtx.setCov(collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ());
+      } else {
+        vtx.setPos({mMeanVtx->getX(), mMeanVtx->getY(), mMeanVtx->getZ()});
+        vtx.setCov(mMeanVtx->getSigmaX() * mMeanVtx->getSigmaX(), 0.0f, mMeanVtx->getSigmaY() * mMeanVtx->getSigmaY(), 0.0f, 0.0f, mMeanVtx->getSigmaZ() * mMeanVtx->getSigmaZ());
+      }
+      mStatus[i] = kToPropagate;
+    }
+  }
+
+  // Propagates the staged tracks [first, last) to their vertex
+  template <bool fillCovMat>
+  void propagateStaged(std::size_t first, std::size_t last)
+  {
+    const auto* propagator = o2::base::Propagator::Instance();
+    for (std::size_t i = first; i < last; i++) {
+      if (mStatus[i] != kToPropagate) {
+        continue;
+      }
+      bool isPropagationOK;
+      if constexpr (fillCovMat) {
+        isPropagationOK = propagator->propagateToDCABxByBz(mVertices[i], mTrackParCovs[i], 2.f, matCorr, &mDcaInfoCovs[i]);
+      } else {
+        isPropagationOK = propagator->propagateToDCABxByBz(mVertices[i].getXYZ(), mTrackPars[i], 2.f, matCorr, &mDcaInfos[i]);
+      }
+      mStatus[i] = isPropagationOK ? kPropagated : kPropagationFailed;
+    }
+  }
+
+  // Propagates the staged tracks, split in contiguous chunks over the threads
+  // The tracks are independent of each other, so the outputs do not depend on the number of threads.
+  template <bool fillCovMat>
+  void propagateStaged()
+  {
+    const std::size_t nStaged = mStatus.size();
+    const std::size_t nChunks = std::clamp<std::size_t>(nThreads, 1, std::max<std::size_t>(nStaged, 1));
+    if (nChunks == 1) {
+      propagateStaged<fillCovMat>(0, nStaged);
+      return;
+    }
+    const std::size_t chunkSizeThread = (nStaged + nChunks - 1) / nChunks;
+    std::vector<std::thread> threads;
+    for (std::size_t iChunk = 1; iChunk < nChunks; iChunk++) {
+      threads.emplace_back([this, iChunk, chunkSizeThread, nStaged]() { propagateStaged<fillCovMat>(std::min(iChunk * chunkSizeThread, nStaged), std::min((iChunk + 1) * chunkSizeThread, nStaged)); });
+    }
+    propagateStaged<fillCovMat>(0, std::min(chunkSizeThread, nStaged));
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  // Fills the tables with the staged tracks, in the order of the input tracks
+  template <typename TTrack, bool isMc, bool fillCovMat>
+  void fillStaged(TTrack const& tracks, int64_t first)
+  {
+    for (std::size_t i = 0; i < mStatus.size(); i++) {
+      auto track = tracks.iteratorAt(first + i);
+      const bool isPropagationOK = mStatus[i] == kPropagated;
+      aod::track::TrackTypeEnum trackType = isPropagationOK ? aod::track::Track : (aod::track::TrackTypeEnum)track.trackType();
+      if constexpr (isMc && fillCovMat) { // checking MC and fillCovMat block begins
         // filling some QA histograms for track tuner test purpose
-        if constexpr (isMc && fillCovMat) { // checking MC and fillCovMat block begins
-          if (track.has_mcParticle() && isPropagationOK) {
-            auto mcParticle1 = track.mcParticle();
-            // && abs(mcParticle1.pdgCode())==211
-            if (mcParticle1.isPhysicalPrimary()) {
-              registry.fill(HIST("hDCAxyVsPtRec"), mDcaInfoCov.getY(), mTrackParCov.getPt());
-              registry.fill(HIST("hDCAxyVsPtMC"), mDcaInfoCov.getY(), mcParticle1.pt());
-              registry.fill(HIST("hDCAzVsPtRec"), mDcaInfoCov.getZ(), mTrackParCov.getPt());
-              registry.fill(HIST("hDCAzVsPtMC"), mDcaInfoCov.getZ(), mcParticle1.pt());
-            }
+        if (isPropagationOK && track.has_mcParticle()) {
+          auto mcParticle1 = track.mcParticle();
+          // && abs(mcParticle1.pdgCode())==211
+          if (mcParticle1.isPhysicalPrimary()) {
+            registry.fill(HIST("hDCAxyVsPtRec"), mDcaInfoCovs[i].getY(), mTrackParCovs[i].getPt());
+            registry.fill(HIST("hDCAxyVsPtMC"), mDcaInfoCovs[i].getY(), mcParticle1.pt());
+            registry.fill(HIST("hDCAzVsPtRec"), mDcaInfoCovs[i].getZ(), mTrackParCovs[i].getPt());
+            registry.fill(HIST("hDCAzVsPtMC"), mDcaInfoCovs[i].getZ(), mcParticle1.pt());
           }
-        } // MC and fillCovMat block ends
-      }
+        }
+      } // MC and fillCovMat block ends
       // Filling modified Q/Pt values at IU/production point by track tuner in track tuner table
       if (useTrackTuner && fillTrackTunerTable) {
-        tunertable(q2OverPtNew);
+        tunertable(mQ2OverPtNew[i]);
       }
-      // LOG(info) <<  " trackPropagation (this value filled in tuner table)--> "  << q2OverPtNew;
       if constexpr (fillCovMat) {
-        tracksParPropagated(track.collisionId(), trackType, mTrackParCov.getX(), mTrackParCov.getAlpha(), mTrackParCov.getY(), mTrackParCov.getZ(), mTrackParCov.getSnp(), mTrackParCov.getTgl(), mTrackParCov.getQ2Pt());
-        tracksParExtensionPropagated(mTrackParCov.getPt(), mTrackParCov.getP(), mTrackParCov.getEta(), mTrackParCov.getPhi());
+        const auto& trackParCov = mTrackParCovs[i];
+        tracksParPropagated(track.collisionId(), trackType, trackParCov.getX(), trackParCov.getAlpha(), trackParCov.getY(), trackParCov.getZ(), trackParCov.getSnp(), trackParCov.getTgl(), trackParCov.getQ2Pt());
+        tracksParExtensionPropagated(trackParCov.getPt(), trackParCov.getP(), trackParCov.getEta(), trackParCov.getPhi());
         // TODO do we keep the rho as 0? Also the sigma's are duplicated information
-        tracksParCovPropagated(std::sqrt(mTrackParCov.getSigmaY2()), std::sqrt(mTrackParCov.getSigmaZ2()), std::sqrt(mTrackParCov.getSigmaSnp2()),
-                               std::sqrt(mTrackParCov.getSigmaTgl2()), std::sqrt(mTrackParCov.getSigma1Pt2()), 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
-        tracksParCovExtensionPropagated(mTrackParCov.getSigmaY2(), mTrackParCov.getSigmaZY(), mTrackParCov.getSigmaZ2(), mTrackParCov.getSigmaSnpY(),
-                                        mTrackParCov.getSigmaSnpZ(), mTrackParCov.getSigmaSnp2(), mTrackParCov.getSigmaTglY(), mTrackParCov.getSigmaTglZ(), mTrackParCov.getSigmaTglSnp(),
-                                        mTrackParCov.getSigmaTgl2(), mTrackParCov.getSigma1PtY(), mTrackParCov.getSigma1PtZ(), mTrackParCov.getSigma1PtSnp(), mTrackParCov.getSigma1PtTgl(),
-                                        mTrackParCov.getSigma1Pt2());
+        tracksParCovPropagated(std::sqrt(trackParCov.getSigmaY2()), std::sqrt(trackParCov.getSigmaZ2()), std::sqrt(trackParCov.getSigmaSnp2()),
+                               std::sqrt(trackParCov.getSigmaTgl2()), std::sqrt(trackParCov.getSigma1Pt2()), 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+        tracksParCovExtensionPropagated(trackParCov.getSigmaY2(), trackParCov.getSigmaZY(), trackParCov.getSigmaZ2(), trackParCov.getSigmaSnpY(),
+                                        trackParCov.getSigmaSnpZ(), trackParCov.getSigmaSnp2(), trackParCov.getSigmaTglY(), trackParCov.getSigmaTglZ(), trackParCov.getSigmaTglSnp(),
+                                        trackParCov.getSigmaTgl2(), trackParCov.getSigma1PtY(), trackParCov.getSigma1PtZ(), trackParCov.getSigma1PtSnp(), trackParCov.getSigma1PtTgl(),
+                                        trackParCov.getSigma1Pt2());
         if (fillTracksDCA) {
-          tracksDCA(mDcaInfoCov.getY(), mDcaInfoCov.getZ());
+          tracksDCA(mDcaInfoCovs[i].getY(), mDcaInfoCovs[i].getZ());
         }
         if (fillTracksDCACov) {
-          tracksDCACov(mDcaInfoCov.getSigmaY2(), mDcaInfoCov.getSigmaZ2());
+          tracksDCACov(mDcaInfoCovs[i].getSigmaY2(), mDcaInfoCovs[i].getSigmaZ2());
         }
       } else {
-        tracksParPropagated(track.collisionId(), trackType, mTrackPar.getX(), mTrackPar.getAlpha(), mTrackPar.getY(), mTrackPar.getZ(), mTrackPar.getSnp(), mTrackPar.getTgl(), mTrackPar.getQ2Pt());
-        tracksParExtensionPropagated(mTrackPar.getPt(), mTrackPar.getP(), mTrackPar.getEta(), mTrackPar.getPhi());
+        const auto& trackPar = mTrackPars[i];
+        tracksParPropagated(track.collisionId(), trackType, trackPar.getX(), trackPar.getAlpha(), trackPar.getY(), trackPar.getZ(), trackPar.getSnp(), trackPar.getTgl(), trackPar.getQ2Pt());
+        tracksParExtensionPropagated(trackPar.getPt(), trackPar.getP(), trackPar.getEta(), trackPar.getPhi());
         if (fillTracksDCA) {
-          tracksDCA(mDcaInfo[0], mDcaInfo[1]);
+          tracksDCA(mDcaInfos[i][0], mDcaInfos[i][1]);
         }
       }
     }
   }
 
+  template <typename TTrack, typename TParticle, bool isMc, bool fillCovMat = false, bool useTrkPid = false>
+  void fillTrackTables(TTrack const& tracks,
+                       TParticle const&,
+                       aod::Collisions const&,
+                       aod::BCsWithTimestamps const& bcs)
+  {
+    if (bcs.size() == 0) {
+      return;
+    }
+    initCCDB(bcs.begin());
+
+    if constexpr (fillCovMat) {
+      tracksParCovPropagated.reserve(tracks.size());
+      tracksParCovExtensionPropagated.reserve(tracks.size());
+      if (fillTracksDCACov) {
+        tracksDCACov.reserve(tracks.size());
+      }
+    } else {
+      tracksParPropagated.reserve(tracks.size());
+      tracksParExtensionPropagated.reserve(tracks.size());
+      if (fillTracksDCA) {
+        tracksDCA.reserve(tracks.size());
+      }
+    }
+
+    // the tracks are staged, propagated and filled in chunks, so that the buffers do not scale with the dataframe size
+    const int64_t nTracks = tracks.size();
+    const int64_t nTracksPerChunk = chunkSize > 0 ? static_cast<int64_t>(chunkSize) : std::max<int64_t>(nTracks, 1);
+    for (int64_t first = 0; first < nTracks; first += nTracksPerChunk) {
+      const int64_t last = std::min(first + nTracksPerChunk, nTracks);
+      stageTracks<TTrack, isMc, fillCovMat, useTrkPid>(tracks, first, last);
+      propagateStaged<fillCovMat>();
+      fillStaged<TTrack, isMc, fillCovMat>(tracks, first);
+    }
+  }
+
   void processStandard(aod::StoredTracksIU const& tracks, aod::Collisions const& collisions, aod::BCsWithTimestamps const& bcs)
   {
     fillTrackTables</*TTrack*/ aod::StoredTracksIU, /*Particle*/ aod::StoredTracksIU, /*isMc = */ false, /*fillCovMat =*/false, /*useTrkPid =*/false>(tracks, tracks, collisions, bcs);
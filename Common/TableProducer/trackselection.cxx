@@ -143,22 +143,25 @@ struct TrackSelectionTask {
     if (produceTable == 0 && produceFBextendedTable == 0) {
       return;
     }
+    // the track quantities are read once per track and shared by all the selections
+    TrackSelection::TrackValues trackValues;
     if (isRun3) {
       for (auto& track : tracks) {
+        trackValues.fill(track);
+        o2::aod::track::TrackSelectionFlags::flagtype trackflagGlob = globalTracks.IsSelectedMask(trackValues);
 
         if (produceTable == 1) {
           filterTable((uint8_t)0,
-                      globalTracks.IsSelectedMask(track),
-                      filtBit1.IsSelected(track),
-                      filtBit2.IsSelected(track),
-                      filtBit3.IsSelected(track),
-                      filtBit4.IsSelected(track),
-                      filtBit5.IsSelected(track));
+                      trackflagGlob,
+                      filtBit1.IsSelected(trackValues),
+                      filtBit2.IsSelected(trackValues),
+                      filtBit3.IsSelected(trackValues),
+                      filtBit4.IsSelected(trackValues),
+                      filtBit5.IsSelected(trackValues));
         }
         if (produceFBextendedTable == 1) {
-          o2::aod::track::TrackSelectionFlags::flagtype trackflagGlob = globalTracks.IsSelectedMask(track);
-          o2::aod::track::TrackSelectionFlags::flagtype trackflagFB1 = filtBit1.IsSelectedMask(track);
-          o2::aod::track::TrackSelectionFlags::flagtype trackflagFB2 = filtBit2.IsSelectedMask(track);
+          o2::aod::track::TrackSelectionFlags::flagtype trackflagFB1 = filtBit1.IsSelectedMask(trackValues);
+          o2::aod::track::TrackSelectionFlags::flagtype trackflagFB2 = filtBit2.IsSelectedMask(trackValues);
           // o2::aod::track::TrackSelectionFlags::flagtype trackflagFB3 = filtBit3.IsSelectedMask(track); // only temporarily commented, will be used
           // o2::aod::track::TrackSelectionFlags::flagtype trackflagFB4 = filtBit4.IsSelectedMask(track);
           // o2::aod::track::TrackSelectionFlags::flagtype trackflagFB5 = filtBit5.IsSelectedMask(track);
@@ -186,15 +189,16 @@ struct TrackSelectionTask {
     }
 
     for (auto& track : tracks) {
-      o2::aod::track::TrackSelectionFlags::flagtype trackflagGlob = globalTracks.IsSelectedMask(track);
+      trackValues.fill(track);
+      o2::aod::track::TrackSelectionFlags::flagtype trackflagGlob = globalTracks.IsSelectedMask(trackValues);
       if (produceTable == 1) {
-        filterTable((uint8_t)globalTracksSDD.IsSelected(track),
-                    globalTracks.IsSelectedMask(track),
-                    filtBit1.IsSelected(track),
-                    filtBit2.IsSelected(track),
-                    filtBit3.IsSelected(track),
-                    filtBit4.IsSelected(track),
-                    filtBit5.IsSelected(track));
+        filterTable((uint8_t)globalTracksSDD.IsSelected(trackValues),
+                    trackflagGlob,
+                    filtBit1.IsSelected(trackValues),
+                    filtBit2.IsSelected(trackValues),
+                    filtBit3.IsSelected(trackValues),
+                    filtBit4.IsSelected(trackValues),
+                    filtBit5.IsSelected(trackValues));
       }
       if (produceFBextendedTable == 1) {
         filterTableDetail(o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kTrackType),
@@ -23,11 +23,14 @@ struct WeakDecayIndicesV0 {
 
   void process(aod::V0s_000 const& v0s, aod::Tracks const&)
   {
+    v0s_001.reserve(v0s.size());
     for (auto& v0 : v0s) {
-      if (v0.posTrack().collisionId() != v0.negTrack().collisionId()) {
-        LOGF(fatal, "V0 %d has inconsistent collision information (%d, %d)", v0.globalIndex(), v0.posTrack().collisionId(), v0.negTrack().collisionId());
+      const auto posCollisionId = v0.posTrack().collisionId();
+      const auto negCollisionId = v0.negTrack().collisionId();
+      if (posCollisionId != negCollisionId) {
+        LOGF(fatal, "V0 %d has inconsistent collision information (%d, %d)", v0.globalIndex(), posCollisionId, negCollisionId);
       }
-      v0s_001(v0.posTrack().collisionId(), v0.posTrackId(), v0.negTrackId());
+      v0s_001(posCollisionId, v0.posTrackId(), v0.negTrackId());
     }
   }
 };
@@ -38,12 +41,17 @@ struct WeakDecayIndicesCascades {
 
   void process(aod::V0s const&, aod::Cascades_000 const& cascades, aod::Tracks const&)
   {
+    cascades_001.reserve(cascades.size());
     for (auto& cascade : cascades) {
-      if (cascade.bachelor().collisionId() != cascade.v0().posTrack().collisionId() || cascade.v0().posTrack().collisionId() != cascade.v0().negTrack().collisionId()) {
-        LOGF(fatal, "Cascade %d has inconsistent collision information (%d, %d, %d) track ids %d %d %d", cascade.globalIndex(), cascade.bachelor().collisionId(),
-             cascade.v0().posTrack().collisionId(), cascade.v0().negTrack().collisionId(), cascade.bachelorId(), cascade.v0().posTrackId(), cascade.v0().negTrackId());
+      const auto v0 = cascade.v0();
+      const auto bachCollisionId = cascade.bachelor().collisionId();
+      const auto posCollisionId = v0.posTrack().collisionId();
+      const auto negCollisionId = v0.negTrack().collisionId();
+      if (bachCollisionId != posCollisionId || posCollisionId != negCollisionId) {
+        LOGF(fatal, "Cascade %d has inconsistent collision information (%d, %d, %d) track ids %d %d %d", cascade.globalIndex(), bachCollisionId,
+             posCollisionId, negCollisionId, cascade.bachelorId(), v0.posTrackId(), v0.negTrackId());
       }
-      cascades_001(cascade.bachelor().collisionId(), cascade.v0Id(), cascade.bachelorId());
+      cascades_001(bachCollisionId, cascade.v0Id(), cascade.bachelorId());
     }
   }
 };
@@ -27,6 +27,9 @@
 #include "TArrayF.h"
 #include "multCalibrator.h"
 
+#include <algorithm>
+#include <vector>
+
 using namespace std;
 
 const TString multCalibrator::fCentEstimName[kNCentEstim] = {
@@ -138,6 +141,24 @@ Double_t multCalibrator::GetRawMax(TH1* histo)
 }
 
 Double_t multCalibrator::GetBoundaryForPercentile(TH1* histo, Double_t lPercentileRequested, Double_t& lPrecisionEstimate)
+{
+  std::vector<Double_t> lCumulative;
+  GetCumulative(histo, lCumulative);
+  return GetBoundaryForPercentile(histo, lCumulative, GetRawMax(histo), lPercentileRequested, lPrecisionEstimate);
+}
+
+void multCalibrator::GetCumulative(TH1* histo, std::vector<Double_t>& lCumulative)
+{
+  //Content of the bins 0 (underflow) to ii - 1 at index ii, for ii = 0 ... nbins + 1:
+  //the integral of the bins a to b is lCumulative[b + 1] - lCumulative[a]
+  const Long_t lNBins = histo->GetNbinsX();
+  lCumulative.resize(lNBins + 2);
+  lCumulative[0] = 0.;
+  for (Long_t ibin = 0; ibin <= lNBins; ibin++)
+    lCumulative[ibin + 1] = lCumulative[ibin] + histo->GetBinContent(ibin);
+}
+
+Double_t multCalibrator::GetBoundaryForPercentile(TH1* histo, const std::vector<Double_t>& lCumulative, Double_t lRawMax, Double_t lPercentileRequested, Double_t& lPrecisionEstimate)
 {
   //This function returns the boundary for a specific percentile.
   //It uses a linear interpolation in an attempt to get more precision
@@ -148,11 +169,12 @@ Double_t multCalibrator::GetBoundaryForPercentile(TH1* histo, Double_t lPercenti
   //with the entire cross section, effectively reporting back a percentage
   //that corresponds to those bins. If this percentage is O(percentile bin
   //width requested), then the user should worry and we print out a warning.
+  //
+  //The bin is found with a binary search on the cumulative bin contents
+  //(see GetCumulative), instead of summing the bins up to the boundary.
 
   const Double_t lPrecisionConstant = 2.0;
 
-  Double_t lRawMax = GetRawMax(histo);
-
   if (lPercentileRequested < 1e-7)
     return lRawMax; //safeguard
   if (lPercentileRequested > 100 - 1e-7)
@@ -167,32 +189,35 @@ Double_t multCalibrator::GetBoundaryForPercentile(TH1* histo, Double_t lPercenti
   Double_t lCount = 0;
 
   // Anchor point changes: if anchored, start at the first bin that includes that
+  const Long_t lNBins = histo->GetNbinsX();
   Long_t lFirstBin = 1;
-  Double_t lHadronicTotal = histo->Integral(1, histo->GetNbinsX()); // histo->GetEntries();
+  Double_t lHadronicTotal = lCumulative[lNBins + 1] - lCumulative[1]; // histo->GetEntries();
   if (fAnchorPointValue > 0) {
-    lFirstBin = histo->FindBin(fAnchorPointValue + 1e-6);
-    Double_t lAbove = histo->Integral(lFirstBin, histo->GetNbinsX());
+    lFirstBin = std::min<Long_t>(histo->FindBin(fAnchorPointValue + 1e-6), lNBins + 1);
+    Double_t lAbove = lCumulative[lNBins + 1] - lCumulative[lFirstBin];
     lHadronicTotal = lAbove * 100.0 / (fAnchorPointPercentage);
     lCount = lHadronicTotal - lAbove; // the relevant anchored-out part
   }
 
-  const Long_t lNBins = histo->GetNbinsX();
   Double_t lCountDesired = lPercentile * lHadronicTotal / 100;
 
-  for (Long_t ibin = lFirstBin; ibin < lNBins; ibin++) {
-    lCount += histo->GetBinContent(ibin);
-    if (lCount >= lCountDesired) {
-      //Found bin I am looking for!
-      Double_t lWidth = histo->GetBinWidth(ibin);
-      Double_t lLeftPercentile = 100. * (lCount - histo->GetBinContent(ibin)) / lHadronicTotal;
-      Double_t lRightPercentile = 100. * lCount / lHadronicTotal;
-      lPrecisionEstimate = (lRightPercentile - lLeftPercentile) / lPrecisionConstant;
+  //first bin ibin in [lFirstBin, lNBins - 1] where the count up to and including ibin reaches lCountDesired
+  const Double_t lCumulativeFirst = lCumulative[lFirstBin];
+  const auto lEnd = lCumulative.begin() + std::max(lNBins, lFirstBin) + 1;
+  auto lFound = std::lower_bound(lCumulative.begin() + lFirstBin + 1, lEnd, lCountDesired,
+                                 [&](Double_t lCumulativeBin, Double_t lDesired) { return lCount + (lCumulativeBin - lCumulativeFirst) < lDesired; });
+  if (lFound != lEnd) {
+    //Found bin I am looking for!
+    const Long_t ibin = (lFound - lCumulative.begin()) - 1;
+    lCount += *lFound - lCumulativeFirst;
+    Double_t lWidth = histo->GetBinWidth(ibin);
+    Double_t lLeftPercentile = 100. * (lCount - histo->GetBinContent(ibin)) / lHadronicTotal;
+    Double_t lRightPercentile = 100. * lCount / lHadronicTotal;
+    lPrecisionEstimate = (lRightPercentile - lLeftPercentile) / lPrecisionConstant;
 
-      Double_t lProportion = (lPercentile - lLeftPercentile) / (lRightPercentile - lLeftPercentile);
+    Double_t lProportion = (lPercentile - lLeftPercentile) / (lRightPercentile - lLeftPercentile);
 
-      lReturnValue = histo->GetBinLowEdge(ibin) + lProportion * lWidth;
-      break;
-    }
+    lReturnValue = histo->GetBinLowEdge(ibin) + lProportion * lWidth;
   }
   return lReturnValue;
 }
@@ -265,6 +290,11 @@ TH1F* multCalibrator::GetCalibrationHistogram(TH1* histoRaw, TString lHistoName)
   Double_t lBounds[lNDesiredBoundaries + 1];
   Double_t lPrecision[lNDesiredBoundaries + 1];
 
+  //Cumulative contents and raw max once for all the boundaries
+  std::vector<Double_t> lCumulative;
+  GetCumulative(histoRaw, lCumulative);
+  const Double_t lRawMax = GetRawMax(histoRaw);
+
   if (fAnchorPointValue > 0) {
     lBounds[0] = 0;
   }
@@ -273,7 +303,7 @@ TH1F* multCalibrator::GetCalibrationHistogram(TH1* histoRaw, TString lHistoName)
     Int_t lDisplacedii = ii;
     if (fAnchorPointValue > 0)
       lDisplacedii++;
-    lBounds[lDisplacedii] = GetBoundaryForPercentile(histoRaw, lDesiredBoundaries[ii], lPrecision[ii]);
+    lBounds[lDisplacedii] = GetBoundaryForPercentile(histoRaw, lCumulative, lRawMax, lDesiredBoundaries[ii], lPrecision[ii]);
     TString lPrecisionString = "(Precision OK)";
     if (ii != 0 && ii != lNDesiredBoundaries - 1) {
       //check precision, please
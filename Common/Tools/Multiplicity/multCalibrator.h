@@ -21,6 +21,7 @@
 
 #include <iostream>
 #include <map>
+#include <vector>
 
 #include "TNamed.h"
 #include "TH1D.h"
@@ -68,6 +69,9 @@ class multCalibrator : public TNamed
   //Auxiliary functions
   Double_t GetRawMax(TH1* histo);
   Double_t GetBoundaryForPercentile(TH1* histo, Double_t lPercentileRequested, Double_t& lPrecisionEstimate);
+  //Same, with the cumulative bin contents and the raw max of the histogram computed once for all the boundaries
+  void GetCumulative(TH1* histo, std::vector<Double_t>& lCumulative);
+  Double_t GetBoundaryForPercentile(TH1* histo, const std::vector<Double_t>& lCumulative, Double_t lRawMax, Double_t lPercentileRequested, Double_t& lPrecisionEstimate);
 
   //Precision bookkeeping
   TH1D* GetPrecisionHistogram() { return fPrecisionHistogram; }; //gets precision histogram from current object
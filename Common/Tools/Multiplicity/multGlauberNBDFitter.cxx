@@ -190,30 +190,73 @@ Double_t multGlauberNBDFitter::ProbDistrib(Double_t* x, Double_t* par)
       return 0;
     }
     fhNanc->Scale(1. / fhNanc->Integral());
+
+    //Keep the non-empty bins only, the bin of zero ancestors is not used
+    fAncValue.clear();
+    fAncCount.clear();
+    Int_t lStartBin = fhNanc->FindBin(0.0) + 1;
+    for (Long_t iNanc = lStartBin; iNanc < fhNanc->GetNbinsX() + 1; iNanc++) {
+      if (fhNanc->GetBinContent(iNanc) == 0.)
+        continue;
+      fAncValue.push_back(fhNanc->GetBinCenter(iNanc));
+      fAncCount.push_back(fhNanc->GetBinContent(iNanc));
+    }
+    fNBDk = -1.; //force the update of the NBD terms
   }
   //______________________________________________________
-  //Actually evaluate function
-  Int_t lStartBin = fhNanc->FindBin(0.0) + 1;
-  for (Long_t iNanc = lStartBin; iNanc < fhNanc->GetNbinsX() + 1; iNanc++) {
-    Double_t lNancestors = fhNanc->GetBinCenter(iNanc);
-    Double_t lNancestorCount = fhNanc->GetBinContent(iNanc);
-    //if(lNancestorCount<1e-12&&lNancestors>10) break;
+  //NBD terms of the ancestors, once per Minuit step instead of once per multiplicity value
+  if (par[0] != fNBDMu || par[1] != fNBDk || par[4] != fNBDdMu)
+    UpdateAncestorNBD(par[0], par[1], par[4]);
+  if (lMultValue <= 1e-6)
+    return 0.;
 
-    // allow for variable mu in case requested
-    Double_t lThisMu = (((Double_t)lNancestors)) * (par[0] + par[4] * lNancestors);
-    Double_t lThisk = (((Double_t)lNancestors)) * par[1];
-    Double_t lpval = TMath::Power(1.0 + lThisMu / lThisk, -1);
-    fNBD->SetParameter(1, lThisk);
-    fNBD->SetParameter(0, lpval);
-    Double_t lMult = 0.0;
-    if (lMultValue > 1e-6)
-      lMult = fAncestorMode != 2 ? fNBD->Eval(lMultValue) : ContinuousNBD(lMultValue, lThisMu, lThisk);
-    lProbability += lNancestorCount * lMult;
+  //______________________________________________________
+  //Actually evaluate function
+  const size_t lNAnc = fAncValue.size();
+  if (fAncestorMode == 2) {
+    //ContinuousNBD in its logarithmic form, with the terms not depending on the multiplicity precomputed
+    const Double_t lLnGammaN1 = TMath::LnGamma(lMultValue + 1.);
+    for (size_t iAnc = 0; iAnc < lNAnc; iAnc++) {
+      const Double_t lThisk = fAnck[iAnc];
+      const Double_t lLogMult = TMath::LnGamma(lMultValue + lThisk) - lLnGammaN1 - fAncLnGammak[iAnc] + lMultValue * fAncLogRatio[iAnc] - (lMultValue + lThisk) * fAncLog1pRatio[iAnc];
+      lProbability += fAncCount[iAnc] * TMath::Exp(lLogMult);
+    }
+  } else {
+    for (size_t iAnc = 0; iAnc < lNAnc; iAnc++) {
+      fNBD->SetParameter(1, fAnck[iAnc]);
+      fNBD->SetParameter(0, fAncpval[iAnc]);
+      lProbability += fAncCount[iAnc] * fNBD->Eval(lMultValue);
+    }
   }
   //______________________________________________________
   return par[3] * lProbability;
 }
 
+//________________________________________________________________
+void multGlauberNBDFitter::UpdateAncestorNBD(Double_t lMu, Double_t lk, Double_t ldMu)
+{
+  fNBDMu = lMu;
+  fNBDk = lk;
+  fNBDdMu = ldMu;
+  const size_t lNAnc = fAncValue.size();
+  fAnck.resize(lNAnc);
+  fAncpval.resize(lNAnc);
+  fAncLogRatio.resize(lNAnc);
+  fAncLog1pRatio.resize(lNAnc);
+  fAncLnGammak.resize(lNAnc);
+  for (size_t iAnc = 0; iAnc < lNAnc; iAnc++) {
+    // allow for variable mu in case requested
+    Double_t lNancestors = fAncValue[iAnc];
+    Double_t lThisMu = lNancestors * (lMu + ldMu * lNancestors);
+    Double_t lThisk = lNancestors * lk;
+    fAnck[iAnc] = lThisk;
+    fAncpval[iAnc] = TMath::Power(1.0 + lThisMu / lThisk, -1);
+    fAncLogRatio[iAnc] = TMath::Log(lThisMu / lThisk);
+    fAncLog1pRatio[iAnc] = TMath::Log(1.0 + lThisMu / lThisk);
+    fAncLnGammak[iAnc] = TMath::LnGamma(lThisk);
+  }
+}
+
 //________________________________________________________________
 Bool_t multGlauberNBDFitter::SetNpartNcollCorrelation(TH2* hNpNc)
 {
@@ -13,6 +13,7 @@
 #define MULTGLAUBERNBDFITTER_H
 
 #include <iostream>
+#include <vector>
 #include "TNamed.h"
 #include "TF1.h"
 #include "TH1.h"
@@ -95,6 +96,19 @@ class multGlauberNBDFitter : public TNamed
   Bool_t ffChanged;
   Double_t fCurrentf;
 
+  //Non-empty bins of fhNanc, with the NBD terms of each for the current (mu, k, dMu/dNanc)
+  void UpdateAncestorNBD(Double_t lMu, Double_t lk, Double_t ldMu);
+  std::vector<Double_t> fAncValue;      //!
+  std::vector<Double_t> fAncCount;      //!
+  std::vector<Double_t> fAnck;          //! k of the NBD
+  std::vector<Double_t> fAncpval;       //! p of the NBD, 1 / (1 + mu/k)
+  std::vector<Double_t> fAncLogRatio;   //! log(mu/k)
+  std::vector<Double_t> fAncLog1pRatio; //! log(1 + mu/k)
+  std::vector<Double_t> fAncLnGammak;   //! log(Gamma(k))
+  Double_t fNBDMu = -1.;                //! parameters of the cached NBD terms
+  Double_t fNBDk = -1.;                 //!
+  Double_t fNBDdMu = -1.;               //!
+
   //0: truncation, 1: rounding, 2: analytical continuation
   Int_t fAncestorMode;
 
@@ -18,6 +18,7 @@
 #ifndef COMMON_TOOLS_TRACKTUNER_H_
 #define COMMON_TOOLS_TRACKTUNER_H_
 
+#include <array>
 #include <map>
 #include <memory>
 #include <string>
@@ -98,6 +99,26 @@ struct TrackTuner {
   std::unique_ptr<TGraphErrors> grDcaZPullVsPtPionMC;
   std::unique_ptr<TGraphErrors> grDcaZPullVsPtPionData;
 
+  /// corrections vs pT tabulated at the union of the points of all the graphs, see buildCorrectionTable()
+  enum Correction {
+    kDcaXYResMC = 0,
+    kDcaXYResData,
+    kDcaZResMC,
+    kDcaZResData,
+    kDcaXYMeanMC,
+    kDcaXYMeanData,
+    kDcaXYPullMC,
+    kDcaXYPullData,
+    kDcaZPullMC,
+    kDcaZPullData,
+    kOneOverPtMC,
+    kOneOverPtData,
+    kNCorrections
+  };
+  std::vector<double> corrTablePt;     // sorted pT nodes
+  std::vector<double> corrTableValues; // value of correction c at node i in [i * kNCorrections + c]
+  bool useCorrTable = false;           // false: graphs not sorted in x, evaluated with TGraph::Eval
+
   /// @brief Function to configure the TrackTuner parameters
   /// @param inputString Input string with all parameter configuration. Format: <name>=<value>|<name>=<value>
   /// @return String with the values of all parameters after configurations are listed, to cross check that everything worked well
@@ -391,8 +412,87 @@ struct TrackTuner {
       grOneOverPtPionMC.reset(dynamic_cast<TGraphErrors*>(inputFileQoverPt->Get(grOneOverPtPionNameMC.c_str())));
       grOneOverPtPionData.reset(dynamic_cast<TGraphErrors*>(inputFileQoverPt->Get(grOneOverPtPionNameData.c_str())));
     }
+
+    buildCorrectionTable();
   } // getDcaGraphs() ends here
 
+  /// Correction graphs in the order of the Correction enum
+  std::array<const TGraphErrors*, kNCorrections> correctionGraphs() const
+  {
+    return {grDcaXYResVsPtPionMC.get(), grDcaXYResVsPtPionData.get(), grDcaZResVsPtPionMC.get(), grDcaZResVsPtPionData.get(),
+            grDcaXYMeanVsPtPionMC.get(), grDcaXYMeanVsPtPionData.get(), grDcaXYPullVsPtPionMC.get(), grDcaXYPullVsPtPionData.get(),
+            grDcaZPullVsPtPionMC.get(), grDcaZPullVsPtPionData.get(), grOneOverPtPionMC.get(), grOneOverPtPionData.get()};
+  }
+
+  /// Tabulates all the correction graphs at the union of their points.
+  /// The graphs are linear between their points (TGraph::Eval) and constant outside of their range (evalGraph),
+  /// so that the linear interpolation of the table gives the same values, with one search of the pT node per track.
+  void buildCorrectionTable()
+  {
+    const auto graphs = correctionGraphs();
+
+    corrTablePt.clear();
+    corrTableValues.clear();
+    useCorrTable = false;
+    for (const auto* graph : graphs) {
+      if (!graph) {
+        continue;
+      }
+      const double* x = graph->GetX();
+      for (int i = 0; i < graph->GetN(); i++) {
+        if (i > 0 && !(x[i] > x[i - 1])) {
+          LOG(warning) << "[TrackTuner] points of the graph " << graph->GetName() << " not sorted in pT, the graphs are evaluated with TGraph::Eval";
+          corrTablePt.clear();
+          return;
+        }
+        corrTablePt.push_back(x[i]);
+      }
+    }
+    std::sort(corrTablePt.begin(), corrTablePt.end());
+    corrTablePt.erase(std::unique(corrTablePt.begin(), corrTablePt.end()), corrTablePt.end());
+    if (corrTablePt.empty()) {
+      return;
+    }
+
+    corrTableValues.assign(corrTablePt.size() * kNCorrections, 0.);
+    for (std::size_t i = 0; i < corrTablePt.size(); i++) {
+      for (int c = 0; c < kNCorrections; c++) {
+        if (graphs[c]) {
+          corrTableValues[i * kNCorrections + c] = evalGraph(corrTablePt[i], graphs[c]);
+        }
+      }
+    }
+    useCorrTable = true;
+  }
+
+  /// Values of all the corrections at pT, 0 for the graphs not loaded
+  void evalCorrections(double pt, std::array<double, kNCorrections>& values) const
+  {
+    if (!useCorrTable) {
+      const auto graphs = correctionGraphs();
+      for (int c = 0; c < kNCorrections; c++) {
+        values[c] = graphs[c] ? evalGraph(pt, graphs[c]) : 0.;
+      }
+      return;
+    }
+    const std::size_t nNodes = corrTablePt.size();
+    if (nNodes == 1 || !(pt > corrTablePt.front())) {
+      std::copy_n(corrTableValues.begin(), kNCorrections, values.begin());
+      return;
+    }
+    if (!(pt < corrTablePt.back())) {
+      std::copy_n(corrTableValues.begin() + (nNodes - 1) * kNCorrections, kNCorrections, values.begin());
+      return;
+    }
+    const std::size_t i = std::upper_bound(corrTablePt.begin(), corrTablePt.end(), pt) - corrTablePt.begin() - 1;
+    const double frac = (pt - corrTablePt[i]) / (corrTablePt[i + 1] - corrTablePt[i]);
+    const double* low = corrTableValues.data() + i * kNCorrections;
+    const double* high = low + kNCorrections;
+    for (int c = 0; c < kNCorrections; c++) {
+      values[c] = low[c] + frac * (high[c] - low[c]);
+    }
+  }
+
   template <typename T1, typename T2, typename T3, typename T4, typename H>
   void tuneTrackParams(T1 const& mcparticle, T2& trackParCov, T3 const& matCorr, T4 dcaInfoCov, H hQA)
   {
@@ -412,11 +512,14 @@ struct TrackTuner {
     double dcaZPullMC = 1.0;
     double dcaZPullData = 1.0;
 
-    dcaXYResMC = evalGraph(ptMC, grDcaXYResVsPtPionMC.get());
-    dcaXYResData = evalGraph(ptMC, grDcaXYResVsPtPionData.get());
+    std::array<double, kNCorrections> corrections{};
+    evalCorrections(ptMC, corrections);
+
+    dcaXYResMC = corrections[kDcaXYResMC];
+    dcaXYResData = corrections[kDcaXYResData];
 
-    dcaZResMC = evalGraph(ptMC, grDcaZResVsPtPionMC.get());
-    dcaZResData = evalGraph(ptMC, grDcaZResVsPtPionData.get());
+    dcaZResMC = corrections[kDcaZResMC];
+    dcaZResData = corrections[kDcaZResData];
 
     // For Q/Pt corrections, files on CCDB will be used if both qOverPtMC and qOverPtData are null
     if (updateCurvature || updateCurvatureIU) {
@@ -428,20 +531,20 @@ struct TrackTuner {
         if (!grOneOverPtPionData.get() || !grOneOverPtPionMC.get()) {
           LOG(fatal) << "### q/pt smearing: input graphs not correctly retrieved. Aborting.";
         }
-        qOverPtMC = std::max(0.0, evalGraph(ptMC, grOneOverPtPionMC.get()));
-        qOverPtData = std::max(0.0, evalGraph(ptMC, grOneOverPtPionData.get()));
+        qOverPtMC = std::max(0.0, corrections[kOneOverPtMC]);
+        qOverPtData = std::max(0.0, corrections[kOneOverPtData]);
       } // qOverPtMC, qOverPtData block ends here
     }   // updateCurvature, updateCurvatureIU block ends here
 
     if (updateTrackDCAs) {
-      dcaXYMeanMC = evalGraph(ptMC, grDcaXYMeanVsPtPionMC.get());
-      dcaXYMeanData = evalGraph(ptMC, grDcaXYMeanVsPtPionData.get());
+      dcaXYMeanMC = corrections[kDcaXYMeanMC];
+      dcaXYMeanData = corrections[kDcaXYMeanData];
 
-      dcaXYPullMC = evalGraph(ptMC, grDcaXYPullVsPtPionMC.get());
-      dcaXYPullData = evalGraph(ptMC, grDcaXYPullVsPtPionData.get());
+      dcaXYPullMC = corrections[kDcaXYPullMC];
+      dcaXYPullData = corrections[kDcaXYPullData];
 
-      dcaZPullMC = evalGraph(ptMC, grDcaZPullVsPtPionMC.get());
-      dcaZPullData = evalGraph(ptMC, grDcaZPullVsPtPionData.get());
+      dcaZPullMC = corrections[kDcaZPullMC];
+      dcaZPullData = corrections[kDcaZPullData];
     }
     //  Unit conversion, is it required ??
     dcaXYResMC *= 1.e-4;
@@ -24,7 +24,10 @@
 #ifndef TRACKSELECTIONREQUEST_H
 #define TRACKSELECTIONREQUEST_H
 
+#include <cmath>
+#include <cstdint>
 #include <iosfwd>
+#include <vector>
 #include <Rtypes.h>
 #include <TMath.h>
 
@@ -39,18 +42,18 @@ class trackSelectionRequest
   void setTrackPhysicsType(int trackPhysicsType_);
   int getTrackPhysicsType() const;
   void setMinPt(float minPt_);
-  int getMinPt() const;
+  float getMinPt() const;
   void setMaxPt(float maxPt_);
-  int getMaxPt() const;
+  float getMaxPt() const;
   void setMinEta(float minEta_);
-  int getMinEta() const;
+  float getMinEta() const;
   void setMaxEta(float maxEta_);
-  int getMaxEta() const;
+  float getMaxEta() const;
 
   void setMaxDCAz(float maxDCAz_);
-  int getMaxDCAz() const;
+  float getMaxDCAz() const;
   void setMaxDCAxyPtDep(float maxDCAxyPtDep_);
-  int getMaxDCAxyPtDep() const;
+  float getMaxDCAxyPtDep() const;
 
   void setRequireTPC(bool requireTPC_);
   bool getRequireTPC() const;
@@ -59,21 +62,21 @@ class trackSelectionRequest
   void setMinTPCCrossedRows(int minTPCCrossedRows_);
   int getMinTPCCrossedRows() const;
   void setMinTPCCrossedRowsOverFindable(float minTPCCrossedRowsOverFindable_);
-  int getMinTPCCrossedRowsOverFindable() const;
+  float getMinTPCCrossedRowsOverFindable() const;
 
   void setRequireITS(bool requireITS_);
   bool getRequireITS() const;
   void setMinITSClusters(int minITSclusters_);
   int getMinITSClusters() const;
   void setMaxITSChi2PerCluster(float maxITSChi2percluster_);
-  int getMaxITSChi2PerCluster() const;
+  float getMaxITSChi2PerCluster() const;
 
   // Calculate logical OR of selection criteria conveniently
   void CombineWithLogicalOR(trackSelectionRequest const& lTraSelRe);
 
   // Apply track selection checks (to be used in core services)
   template <typename TTrack>
-  bool IsTrackSelected(TTrack const& lTrack)
+  bool IsTrackSelected(TTrack const& lTrack) const
   {
     // Selector that applies all selections
     // Phase-space
@@ -86,7 +89,9 @@ class trackSelectionRequest
     if (lTrack.eta() > maxEta)
       return false;
     // DCA to PV
-    if (fabs(lTrack.dcaXY()) < maxDCAz)
+    if (std::fabs(lTrack.dcaXY()) > maxDCAxyPtDep)
+      return false;
+    if (std::fabs(lTrack.dcaZ()) > maxDCAz)
       return false;
     // TracksExtra-based
     if (lTrack.hasTPC() == false && requireTPC)
@@ -101,12 +106,12 @@ class trackSelectionRequest
       return false;
     if (lTrack.itsNCls() < minITSclusters)
       return false;
-    if (lTrack.itsChi2NCl() < maxITSChi2percluster)
+    if (lTrack.itsChi2NCl() > maxITSChi2percluster)
       return false; // FIXME this is a LO approximation
     return true;
   }
   template <typename TTrack>
-  bool IsTrackSelected_TrackExtraCriteria(TTrack const& lTrack)
+  bool IsTrackSelected_TrackExtraCriteria(TTrack const& lTrack) const
   {
     // Selector that only applies TracksExtra columns selection
     if (lTrack.hasTPC() == false && requireTPC)
@@ -121,7 +126,7 @@ class trackSelectionRequest
       return false;
     if (lTrack.itsNCls() < minITSclusters)
       return false;
-    if (lTrack.itsChi2NCl() < maxITSChi2percluster)
+    if (lTrack.itsChi2NCl() > maxITSChi2percluster)
       return false; // FIXME this is a LO approximation
     return true;
   }
@@ -156,4 +161,52 @@ class trackSelectionRequest
 
 std::ostream& operator<<(std::ostream& os, trackSelectionRequest const& c);
 
+// Requests of several analyses (e.g. the wagons of a train) evaluated in a single
+// pass over the tracks: a track is first checked against the logical OR of all the
+// requests, which rejects most of the tracks with one evaluation, and only the tracks
+// passing it are checked against each request. The result is a bitmask with bit i set
+// if the track passes request i, to be stored or passed on instead of re-applying
+// equivalent selections in each analysis.
+class trackSelectionRequestSet
+{
+ public:
+  static constexpr int MaxRequests = 32;
+
+  // Adds a request, returns its bit or -1 if the set is full
+  int AddRequest(trackSelectionRequest const& lTraSelRe);
+  int GetNRequests() const { return requests.size(); }
+  trackSelectionRequest const& GetRequest(int i) const { return requests[i]; }
+  // Logical OR of all the requests
+  trackSelectionRequest const& GetCombinedRequest() const { return combined; }
+
+  template <typename TTrack>
+  uint32_t GetSelectionBits(TTrack const& lTrack) const
+  {
+    uint32_t bits = 0;
+    if (requests.empty() || !combined.IsTrackSelected(lTrack))
+      return bits;
+    for (size_t i = 0; i < requests.size(); ++i) {
+      if (requests[i].IsTrackSelected(lTrack))
+        bits |= (1u << i);
+    }
+    return bits;
+  }
+  template <typename TTrack>
+  uint32_t GetSelectionBits_TrackExtraCriteria(TTrack const& lTrack) const
+  {
+    uint32_t bits = 0;
+    if (requests.empty() || !combined.IsTrackSelected_TrackExtraCriteria(lTrack))
+      return bits;
+    for (size_t i = 0; i < requests.size(); ++i) {
+      if (requests[i].IsTrackSelected_TrackExtraCriteria(lTrack))
+        bits |= (1u << i);
+    }
+    return bits;
+  }
+
+ private:
+  std::vector<trackSelectionRequest> requests;
+  trackSelectionRequest combined;
+};
+
 #endif // TRACKSELECTIONREQUEST_H
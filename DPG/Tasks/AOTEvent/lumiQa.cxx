@@ -85,18 +85,20 @@ struct LumiQaTask {
       }
     }
 
+    // counters of the dataframe, filled in the alphanumeric bin of the run once at the end instead of per BC
+    int64_t nZNA = 0, nZNC = 0, nZEM = 0, nTCE = 0;
     for (const auto& bc : bcs) {
       if (bc.has_zdc()) {
         float timeZNA = bc.zdc().timeZNA();
         float timeZNC = bc.zdc().timeZNC();
         if (fabs(timeZNA) < 2) {
-          histos.get<TH1>(HIST("hCounterZNA"))->Fill(srun, 1);
+          nZNA++;
         }
         if (fabs(timeZNC) < 2) {
-          histos.get<TH1>(HIST("hCounterZNC"))->Fill(srun, 1);
+          nZNC++;
         }
         if (fabs(timeZNA) < 2 || fabs(timeZNC) < 2) {
-          histos.get<TH1>(HIST("hCounterZEM"))->Fill(srun, 1);
+          nZEM++;
         }
       }
 
@@ -135,7 +137,19 @@ struct LumiQaTask {
       histos.fill(HIST("hMultT0CselTVXTCEB"), multT0C);
       histos.fill(HIST("hCentT0CselTVXTCEB"), centT0C);
 
-      histos.get<TH1>(HIST("hCounterTCE"))->Fill(srun, 1);
+      nTCE++;
+    }
+    if (nZNA > 0) {
+      histos.get<TH1>(HIST("hCounterZNA"))->Fill(srun, nZNA);
+    }
+    if (nZNC > 0) {
+      histos.get<TH1>(HIST("hCounterZNC"))->Fill(srun, nZNC);
+    }
+    if (nZEM > 0) {
+      histos.get<TH1>(HIST("hCounterZEM"))->Fill(srun, nZEM);
+    }
+    if (nTCE > 0) {
+      histos.get<TH1>(HIST("hCounterTCE"))->Fill(srun, nTCE);
     }
   }
 };
@@ -34,10 +34,13 @@
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "Common/Core/TrackSelection.h"
 #include "Common/Core/TrackSelectionDefaults.h"
+#include "Common/Core/DenseHistogram.h"
+#include "Common/Core/QaPrescale.h"
 #include "Common/TableProducer/PID/pidTOFBase.h"
 
 #include "string"
 #include "vector"
+#include "array"
 
 using namespace o2;
 using namespace o2::framework;
@@ -57,10 +60,34 @@ struct qaEventTrack {
   // for particle charges
   Service<o2::framework::O2DatabasePDG> pdgDB;
 
+  // dense accumulators of the Tracks/Kine histograms of the filtered tracks, the pt, eta and phi bins are found once per track
+  enum DenseKine {
+    kDensePt = 0,
+    kDensePtPositive,
+    kDensePtNegative,
+    kDenseEta,
+    kDensePhi,
+    kDenseEtaVsPhi,
+    kDenseEtaVsPt,
+    kDensePhiVsPt,
+    kNDenseKine
+  };
+  std::array<DenseHistogram, kNDenseKine> denseKine;
+  DenseAxis denseAxisPt;
+  DenseAxis denseAxisEta;
+  DenseAxis denseAxisPhi;
+  bool useDenseKine = false;
+
+  // prescale of the per-track histograms of the selected collisions
+  QaPrescale tracksPrescale;
+
   // general steering settings
   Configurable<bool> isRun3{"isRun3", true, "Is Run3 dataset"}; // TODO: derive this from metadata once possible to get rid of the flag
   Configurable<bool> overwriteAxisRangeForPbPb{"overwriteAxisRangeForPbPb", false, "Global switch to easily set the most relaxed default axis ranges of multiplicity and PVcontribs for PbPb"};
   Configurable<bool> doDebug{"doDebug", false, "Bool to enable debug outputs"};
+  Configurable<int> prescaleTracks{"prescaleTracks", 1, "once the track histograms are saturated, fill them for 1 out of prescaleTracks collisions (1: no prescale)"};
+  Configurable<float> prescaleMaxRelError{"prescaleMaxRelError", 0.01, "saturation of the track histograms: relative statistical uncertainty of the bins holding 99% of the Tracks/Kine/pt entries"};
+  Configurable<bool> denseKineHistograms{"denseKineHistograms", true, "accumulate the kinematic histograms of the filtered tracks in dense arrays, added to the histograms once per collision"};
 
   // options to select specific events
   Configurable<bool> selectGoodEvents{"selectGoodEvents", true, "select good events"};
@@ -267,6 +294,16 @@ struct qaEventTrack {
     histos.add("Tracks/Kine/etavsphi", "#eta vs #varphi", kTH2F, {axisEta, axisPhi});
     histos.add("Tracks/Kine/etavspt", "#eta vs #it{p}_{T}", kTH2F, {axisPt, axisEta});
     histos.add("Tracks/Kine/phivspt", "#varphi vs #it{p}_{T}", kTH2F, {axisPt, axisPhi});
+    if (denseKineHistograms) {
+      setupDenseKine();
+    }
+    tracksPrescale.init(0, prescaleTracks, prescaleMaxRelError);
+    tracksPrescale.setReference(histos.get<TH1>(HIST("Tracks/Kine/pt")).get());
+    if (prescaleTracks > 1) {
+      auto h = histos.add<TH1>("Tracks/prescaledCollisions", "Collisions for the track histograms", kTH1D, {{2, 0.5, 2.5, ""}});
+      h->GetXaxis()->SetBinLabel(1, "selected");
+      h->GetXaxis()->SetBinLabel(2, "tracks filled");
+    }
     if (doprocessMC || doprocessRun2ConvertedMC) {
       // pT resolution
       histos.add<TH3>("Tracks/Kine/resoPt", "", kTH3D, {axisDeltaPt, axisPt, axisSign});
@@ -699,6 +736,30 @@ struct qaEventTrack {
   }
 
   // General functions to fill data and MC histograms
+  void setupDenseKine()
+  {
+    useDenseKine = true;
+    useDenseKine &= denseKine[kDensePt].init(histos.get<TH1>(HIST("Tracks/Kine/pt")).get());
+    useDenseKine &= denseKine[kDensePtPositive].init(histos.get<TH1>(HIST("Tracks/Kine/ptFilteredPositive")).get());
+    useDenseKine &= denseKine[kDensePtNegative].init(histos.get<TH1>(HIST("Tracks/Kine/ptFilteredNegative")).get());
+    useDenseKine &= denseKine[kDenseEta].init(histos.get<TH1>(HIST("Tracks/Kine/eta")).get());
+    useDenseKine &= denseKine[kDensePhi].init(histos.get<TH1>(HIST("Tracks/Kine/phi")).get());
+    useDenseKine &= denseKine[kDenseEtaVsPhi].init(histos.get<TH2>(HIST("Tracks/Kine/etavsphi")).get());
+    useDenseKine &= denseKine[kDenseEtaVsPt].init(histos.get<TH2>(HIST("Tracks/Kine/etavspt")).get());
+    useDenseKine &= denseKine[kDensePhiVsPt].init(histos.get<TH2>(HIST("Tracks/Kine/phivspt")).get());
+    denseAxisPt = denseKine[kDensePt].axis(0);
+    denseAxisEta = denseKine[kDenseEta].axis(0);
+    denseAxisPhi = denseKine[kDensePhi].axis(0);
+    // the shared bins are only valid for the same binning
+    useDenseKine &= denseKine[kDensePtPositive].axis(0) == denseAxisPt && denseKine[kDensePtNegative].axis(0) == denseAxisPt;
+    useDenseKine &= denseKine[kDenseEtaVsPhi].axis(0) == denseAxisEta && denseKine[kDenseEtaVsPhi].axis(1) == denseAxisPhi;
+    useDenseKine &= denseKine[kDenseEtaVsPt].axis(0) == denseAxisPt && denseKine[kDenseEtaVsPt].axis(1) == denseAxisEta;
+    useDenseKine &= denseKine[kDensePhiVsPt].axis(0) == denseAxisPt && denseKine[kDensePhiVsPt].axis(1) == denseAxisPhi;
+    if (!useDenseKine) {
+      LOG(info) << "Tracks/Kine histograms filled directly";
+    }
+  }
+
   template <bool IS_MC, bool FILL_FILTERED, typename T>
   void fillRecoHistogramsAllTracks(const T& tracks, const aod::AmbiguousTracks& tracksAmbiguous);
   template <bool IS_MC, typename C, typename T, typename T_UNF>
@@ -1490,7 +1551,17 @@ void qaEventTrack::fillRecoHistogramsGroupedTracks(const C& collision, const T&
   histos.fill(HIST("Events/nContribWithTOFvsWithTRD"), nPvContrWithTOF, nPvContrWithTRD);
   histos.fill(HIST("Events/nContribAllvsWithTRD"), collision.numContrib(), nPvContrWithTRD);
 
-  // track related histograms
+  // track related histograms, prescaled once saturated
+  const bool fillTracks = tracksPrescale.accept(collision.globalIndex());
+  if (prescaleTracks > 1) {
+    histos.fill(HIST("Tracks/prescaledCollisions"), 1);
+    if (fillTracks) {
+      histos.fill(HIST("Tracks/prescaledCollisions"), 2);
+    }
+  }
+  if (!fillTracks) {
+    return;
+  }
   for (const auto& track : tracks) {
     if (checkOnlyPVContributor && !track.isPVContributor()) {
       continue;
@@ -1499,17 +1570,30 @@ void qaEventTrack::fillRecoHistogramsGroupedTracks(const C& collision, const T&
       continue;
     }
     // fill kinematic variables
-    histos.fill(HIST("Tracks/Kine/pt"), track.pt());
-    if (track.sign() > 0) {
-      histos.fill(HIST("Tracks/Kine/ptFilteredPositive"), track.pt());
+    if (useDenseKine) {
+      const auto pt = denseAxisPt.bin(track.pt());
+      const auto eta = denseAxisEta.bin(track.eta());
+      const auto phi = denseAxisPhi.bin(track.phi());
+      denseKine[kDensePt].fill(pt);
+      denseKine[track.sign() > 0 ? kDensePtPositive : kDensePtNegative].fill(pt);
+      denseKine[kDenseEta].fill(eta);
+      denseKine[kDensePhi].fill(phi);
+      denseKine[kDenseEtaVsPhi].fill(eta, phi);
+      denseKine[kDenseEtaVsPt].fill(pt, eta);
+      denseKine[kDensePhiVsPt].fill(pt, phi);
     } else {
-      histos.fill(HIST("Tracks/Kine/ptFilteredNegative"), track.pt());
+      histos.fill(HIST("Tracks/Kine/pt"), track.pt());
+      if (track.sign() > 0) {
+        histos.fill(HIST("Tracks/Kine/ptFilteredPositive"), track.pt());
+      } else {
+        histos.fill(HIST("Tracks/Kine/ptFilteredNegative"), track.pt());
+      }
+      histos.fill(HIST("Tracks/Kine/eta"), track.eta());
+      histos.fill(HIST("Tracks/Kine/phi"), track.phi());
+      histos.fill(HIST("Tracks/Kine/etavsphi"), track.eta(), track.phi());
+      histos.fill(HIST("Tracks/Kine/etavspt"), track.pt(), track.eta());
+      histos.fill(HIST("Tracks/Kine/phivspt"), track.pt(), track.phi());
     }
-    histos.fill(HIST("Tracks/Kine/eta"), track.eta());
-    histos.fill(HIST("Tracks/Kine/phi"), track.phi());
-    histos.fill(HIST("Tracks/Kine/etavsphi"), track.eta(), track.phi());
-    histos.fill(HIST("Tracks/Kine/etavspt"), track.pt(), track.eta());
-    histos.fill(HIST("Tracks/Kine/phivspt"), track.pt(), track.phi());
     histos.fill(HIST("Tracks/Kine/relativeResoPt"), track.pt(), track.pt() * std::sqrt(track.c1Pt21Pt2()));
     histos.fill(HIST("Tracks/Kine/relativeResoPtMean"), track.pt(), track.pt() * std::sqrt(track.c1Pt21Pt2()));
     auto eta = track.eta();
@@ -1705,4 +1789,8 @@ void qaEventTrack::fillRecoHistogramsGroupedTracks(const C& collision, const T&
       histos.fill(HIST("Tracks/ITS/hasITSANDhasTPC"), track.pt());
     }
   }
+
+  for (auto& dense : denseKine) {
+    dense.flush();
+  }
 }
@@ -16,8 +16,11 @@
 /// \brief  Task to produce calibration objects for the TOF. Based on AO2D or TOF skimmed data
 ///
 
+#include <vector>
+
 #include "Framework/AnalysisTask.h"
 #include "Framework/runDataProcessing.h"
+#include "Common/Core/DenseHistogram.h"
 #include "Common/DataModel/PIDResponse.h"
 #include "Common/DataModel/Multiplicity.h"
 #include "Common/DataModel/TrackSelectionTables.h"
@@ -61,6 +64,28 @@ struct tofOfflineCalib {
   std::shared_ptr<TH1> hGoodRefWithTRD;
   std::shared_ptr<TH1> hBadRefWithTRD;
 
+  // Accumulators of the histograms above, filled for every pair and added to the histograms at the end of each event
+  DenseAxis axisP;
+  DenseAxis axisDoubleDelta;
+  DenseHistogram denseDeltaVsP;
+  DenseHistogram denseDeltaVsPHighChi2;
+  DenseHistogram denseGood;
+  DenseHistogram denseBad;
+  DenseHistogram denseGoodRefWithTRD;
+  DenseHistogram denseBadRefWithTRD;
+
+  // Quantities of the tracks with TOF of an event, computed once instead of for each reference track
+  struct TOFTrack {
+    int64_t row; // row in the filtered track table
+    int64_t globalIndex;
+    float p;
+    float tofChi2;
+    float delta[5]; // tofSignal - texp for e, mu, pi, K, p
+    bool hasTRD;
+    int8_t lastTRDLayer;
+  };
+  std::vector<TOFTrack> tofTracks;
+
   unsigned int randomSeed = 0;
   void init(o2::framework::InitContext&)
   {
@@ -146,58 +171,67 @@ struct tofOfflineCalib {
       hBadRefWithTRD = histos.add<TH1>(Form("Run%i/hBadRefWithTRD", lastRun), "Bad", kTH1D, {doubleDeltaAxis});
       deltaVsP = histos.add<TH2>(Form("Run%i/deltaVsP", lastRun), "Low Chi2", kTH2F, {pTAxis, doubleDeltaAxis});
       deltaVsPHighChi2 = histos.add<TH2>(Form("Run%i/deltaVsPHighChi2", lastRun), "High Chi2", kTH2F, {pTAxis, doubleDeltaAxis});
+      axisP.set(deltaVsP->GetXaxis());
+      axisDoubleDelta.set(deltaVsP->GetYaxis());
+      denseDeltaVsP.init(deltaVsP.get());
+      denseDeltaVsPHighChi2.init(deltaVsPHighChi2.get());
+      denseGood.init(hGood.get());
+      denseBad.init(hBad.get());
+      denseGoodRefWithTRD.init(hGoodRefWithTRD.get());
+      denseBadRefWithTRD.init(hBadRefWithTRD.get());
     }
 
-    int8_t lastTRDLayer = -1;
-    for (auto& track1 : tracks) {
-      if (!track1.hasTOF()) {
-        continue;
+    tofTracks.clear();
+    int64_t row = 0;
+    for (auto const& track : tracks) {
+      if (track.hasTOF()) {
+        const float tofSignal = track.tofSignal();
+        const float tof = tofSignal - track.tofEvTime();
+        TOFTrack tofTrack{row, track.globalIndex(), track.p(), track.tofChi2(),
+                          {tofSignal - track.tofExpSignalEl(tof), tofSignal - track.tofExpSignalMu(tof), tofSignal - track.tofExpSignalPi(tof), tofSignal - track.tofExpSignalKa(tof), tofSignal - track.tofExpSignalPr(tof)},
+                          track.hasTRD(), -1};
+        if (track.hasTRD()) {
+          for (int8_t l = 7; l >= 0; l--) {
+            if (track.trdPattern() & (1 << l)) {
+              tofTrack.lastTRDLayer = l;
+              break;
+            }
+          }
+        }
+        tofTracks.push_back(tofTrack);
       }
+      ++row;
+    }
+
+    for (const auto& ref : tofTracks) {
       // Selecting good reference
-      const float& texp1Pi = track1.tofExpSignalPi(track1.tofSignal() - track1.tofEvTime());
-      const float& delta1Pi = track1.tofSignal() - texp1Pi;
-      if (track1.p() < pRefMin || track1.p() > pRefMax || track1.tofChi2() > maxTOFChi2 || fabs(delta1Pi) > deltatTh) {
+      const float delta1Pi = ref.delta[2];
+      if (ref.p < pRefMin || ref.p > pRefMax || ref.tofChi2 > maxTOFChi2 || fabs(delta1Pi) > deltatTh) {
         continue;
       }
-      for (auto& track2 : tracks) {
-        if (!track2.hasTOF()) {
+      for (const auto& tofTrack : tofTracks) {
+        if (ref.globalIndex == tofTrack.globalIndex) { // Skipping the same track
           continue;
         }
-        if (track1.globalIndex() == track2.globalIndex()) { // Skipping the same track
-          continue;
+        const float delta2Pi = tofTrack.delta[2];
+        const auto doubleDelta = axisDoubleDelta.bin(delta2Pi - delta1Pi);
+        if (tofTrack.tofChi2 < maxTOFChi2) {
+          denseDeltaVsP.fill(axisP.bin(tofTrack.p), doubleDelta);
+        } else if (tofTrack.tofChi2 > maxTOFChi2) {
+          denseDeltaVsPHighChi2.fill(axisP.bin(tofTrack.p), doubleDelta);
         }
-        const float& texp2El = track2.tofExpSignalEl(track2.tofSignal() - track2.tofEvTime());
-        const float& texp2Mu = track2.tofExpSignalMu(track2.tofSignal() - track2.tofEvTime());
-        const float& texp2Pi = track2.tofExpSignalPi(track2.tofSignal() - track2.tofEvTime());
-        const float& texp2Ka = track2.tofExpSignalKa(track2.tofSignal() - track2.tofEvTime());
-        const float& texp2Pr = track2.tofExpSignalPr(track2.tofSignal() - track2.tofEvTime());
-        const float& delta2Pi = track2.tofSignal() - texp2Pi;
-        if (track2.tofChi2() < maxTOFChi2) {
-          deltaVsP->Fill(track2.p(), delta2Pi - delta1Pi);
-        } else if (track2.tofChi2() > maxTOFChi2) {
-          deltaVsPHighChi2->Fill(track2.p(), delta2Pi - delta1Pi);
-        }
-        if (track2.p() > pRefMin && track2.p() < pRefMax) {
-          if (track1.hasTRD()) {
-            if (track2.tofChi2() < maxTOFChi2) {
-              hGoodRefWithTRD->Fill(delta2Pi - delta1Pi);
-            } else if (track2.tofChi2() > maxTOFChi2 + 2) {
-              hBadRefWithTRD->Fill(delta2Pi - delta1Pi);
+        if (tofTrack.p > pRefMin && tofTrack.p < pRefMax) {
+          if (ref.hasTRD) {
+            if (tofTrack.tofChi2 < maxTOFChi2) {
+              denseGoodRefWithTRD.fill(doubleDelta);
+            } else if (tofTrack.tofChi2 > maxTOFChi2 + 2) {
+              denseBadRefWithTRD.fill(doubleDelta);
             }
           } else {
-            if (track2.tofChi2() < maxTOFChi2) {
-              hGood->Fill(delta2Pi - delta1Pi);
-            } else if (track2.tofChi2() > maxTOFChi2 + 2) {
-              hBad->Fill(delta2Pi - delta1Pi);
-            }
-          }
-        }
-        lastTRDLayer = -1;
-        if (track2.hasTRD()) {
-          for (int8_t l = 7; l >= 0; l--) {
-            if (track2.trdPattern() & (1 << l)) {
-              lastTRDLayer = l;
-              break;
+            if (tofTrack.tofChi2 < maxTOFChi2) {
+              denseGood.fill(doubleDelta);
+            } else if (tofTrack.tofChi2 > maxTOFChi2 + 2) {
+              denseBad.fill(doubleDelta);
             }
           }
         }
@@ -205,6 +239,8 @@ struct tofOfflineCalib {
         if (!makeTable) {
           continue;
         }
+        const auto& track1 = tracks.iteratorAt(ref.row);
+        const auto& track2 = tracks.iteratorAt(tofTrack.row);
         tableRow(track2.collisionId(),
                  track2.p(),
                  track1.p() - track2.p(),
@@ -214,11 +250,11 @@ struct tofOfflineCalib {
                  track1.eta() - track2.eta(),
                  track2.phi(),
                  track1.phi() - track2.phi(),
-                 track2.tofSignal() - texp2El,
-                 track2.tofSignal() - texp2Mu,
+                 tofTrack.delta[0],
+                 tofTrack.delta[1],
                  delta2Pi,
-                 track2.tofSignal() - texp2Ka,
-                 track2.tofSignal() - texp2Pr,
+                 tofTrack.delta[3],
+                 tofTrack.delta[4],
                  delta2Pi - delta1Pi,
                  track1.sign(),
                  track2.length(),
@@ -235,7 +271,7 @@ struct tofOfflineCalib {
                  collision.collisionTime(),
                  collision.collisionTimeRes(),
                  track2.tofFlags(),
-                 lastTRDLayer);
+                 tofTrack.lastTRDLayer);
 
         // float doubleDelta = delta2Pi - delta1Pi;
 
@@ -251,6 +287,12 @@ struct tofOfflineCalib {
         //   tout->Fill();
       }
     }
+    denseDeltaVsP.flush();
+    denseDeltaVsPHighChi2.flush();
+    denseGood.flush();
+    denseBad.flush();
+    denseGoodRefWithTRD.flush();
+    denseBadRefWithTRD.flush();
   }
 };
 
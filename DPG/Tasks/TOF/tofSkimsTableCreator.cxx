@@ -18,6 +18,7 @@
 
 #include "Framework/AnalysisTask.h"
 #include "Framework/runDataProcessing.h"
+#include "Common/Core/CounterRng.h"
 #include "Common/DataModel/PIDResponse.h"
 #include "Common/DataModel/Multiplicity.h"
 #include "Common/DataModel/TrackSelectionTables.h"
@@ -46,11 +47,12 @@ struct tofSkimsTableCreator {
   Configurable<int> trackSelection{"trackSelection", 1, "Track selection: 0 -> No Cut, 1 -> kGlobalTrack, 2 -> kGlobalTrackWoPtEta, 3 -> kGlobalTrackWoDCA, 4 -> kQualityTracks, 5 -> kInAcceptanceTracks"};
   Configurable<bool> keepTpcOnly{"keepTpcOnly", false, "Flag to keep the TPC only tracks as well"};
   Configurable<float> fractionOfEvents{"fractionOfEvents", 0.1, "Fractions of events to keep"};
+  Configurable<int> samplingSeed{"samplingSeed", 0, "Seed of the event sampling, drawn per collision: 0 -> random seed"};
 
-  unsigned int randomSeed = 0;
+  uint64_t randomSeed = 0;
   void init(o2::framework::InitContext&)
   {
-    randomSeed = static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+    randomSeed = CounterRng::seedFromConfig(samplingSeed);
     switch (applyEvSel.value) {
       case 0:
       case 1:
@@ -87,7 +89,7 @@ struct tofSkimsTableCreator {
   void process(soa::Filtered<Coll>::iterator const& collision,
                soa::Filtered<Trks> const& tracks)
   {
-    if (fractionOfEvents < 1.f && (static_cast<float>(rand_r(&randomSeed)) / static_cast<float>(RAND_MAX)) > fractionOfEvents) { // Skip events that are not sampled
+    if (fractionOfEvents < 1.f && CounterRng(randomSeed, collision.globalIndex()).uniform() > fractionOfEvents) { // Skip events that are not sampled, independently of the processing order
       return;
     }
     tableRow.reserve(tracks.size());
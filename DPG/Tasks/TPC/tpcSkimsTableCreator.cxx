@@ -18,14 +18,16 @@
 
 #include "tpcSkimsTableCreator.h"
 #include <CCDB/BasicCCDBManager.h>
+#include <array>
 #include <cmath>
-/// ROOT
-#include "TRandom3.h"
+#include <cstdint>
 /// O2
 #include "Framework/AnalysisTask.h"
 #include "Framework/HistogramRegistry.h"
 #include "Framework/runDataProcessing.h"
+#include "MathUtils/detail/TypeTruncation.h"
 /// O2Physics
+#include "Common/Core/CounterRng.h"
 #include "Common/Core/trackUtilities.h"
 #include "Common/DataModel/PIDResponse.h"
 #include "Common/DataModel/TrackSelectionTables.h"
@@ -39,6 +41,14 @@ using namespace o2::framework;
 using namespace o2::framework::expressions;
 using namespace o2::track;
 using namespace o2::dataformats;
+using namespace o2::math_utils::detail;
+
+/// Mask of truncateFloatFraction which zeroes the lowest nBits bits of the mantissa (at most 23, i.e. all of them)
+uint32_t truncationMask(int nBits)
+{
+  nBits = nBits < 0 ? 0 : (nBits > 23 ? 23 : nBits);
+  return 0xFFFFFFFFu << nBits;
+}
 
 struct TreeWriterTpcV0 {
 
@@ -61,6 +71,8 @@ struct TreeWriterTpcV0 {
   Configurable<float> downsamplingTsalisPions{"downsamplingTsalisPions", -1., "Downsampling factor to reduce the number of pions"};
   Configurable<float> downsamplingTsalisProtons{"downsamplingTsalisProtons", -1., "Downsampling factor to reduce the number of protons"};
   Configurable<float> downsamplingTsalisElectrons{"downsamplingTsalisElectrons", -1., "Downsampling factor to reduce the number of electrons"};
+  Configurable<int> downsamplingSeed{"downsamplingSeed", 0, "Seed of the Tsallis downsampling, drawn per track and species: 0 -> random seed"};
+  Configurable<int> nTruncatedBitsAux{"nTruncatedBitsAux", 0, "Number of low mantissa bits zeroed in the auxiliary columns (normalised multiplicity, V0 topology and pT), for a better compression of the skim: 0 -> full precision"};
 
   Filter trackFilter = (trackSelection.node() == 0) ||
                        ((trackSelection.node() == 1) && requireGlobalTrackInFilter()) ||
@@ -71,7 +83,7 @@ struct TreeWriterTpcV0 {
 
   /// Funktion to fill skimmed tables
   template <typename T, typename C, typename V0>
-  void fillSkimmedV0Table(V0 const& v0, T const& track, C const& collision, const float nSigmaTPC, const float nSigmaTOF, const float dEdxExp, const o2::track::PID::ID id, int runnumber, double dwnSmplFactor)
+  void fillSkimmedV0Table(V0 const& v0, T const& track, C const& collision, const float nSigmaTPC, const float nSigmaTOF, const float dEdxExp, const o2::track::PID::ID id, int runnumber)
   {
 
     const double ncl = track.tpcNClsFound();
@@ -80,38 +92,35 @@ struct TreeWriterTpcV0 {
     const double bg = p / mass;
     const int multTPC = collision.multTPC();
 
-    const float alpha = v0.alpha();
-    const float qt = v0.qtarm();
-    const float cosPA = v0.v0cosPA();
-    const float pT = v0.pt();
-    const float v0radius = v0.v0radius();
-    const float gammapsipair = v0.psipair();
-
-    const double pseudoRndm = track.pt() * 1000. - (int64_t)(track.pt() * 1000);
-    if (pseudoRndm < dwnSmplFactor) {
-      rowTPCTree(track.tpcSignal(),
-                 1. / dEdxExp,
-                 track.tpcInnerParam(),
-                 track.tgl(),
-                 track.signed1Pt(),
-                 track.eta(),
-                 track.phi(),
-                 track.y(),
-                 mass,
-                 bg,
-                 multTPC / 11000.,
-                 std::sqrt(nClNorm / ncl),
-                 id,
-                 nSigmaTPC,
-                 nSigmaTOF,
-                 alpha,
-                 qt,
-                 cosPA,
-                 pT,
-                 v0radius,
-                 gammapsipair,
-                 runnumber);
-    }
+    const float alpha = truncateFloatFraction(v0.alpha(), mTruncationMaskAux);
+    const float qt = truncateFloatFraction(v0.qtarm(), mTruncationMaskAux);
+    const float cosPA = truncateFloatFraction(v0.v0cosPA(), mTruncationMaskAux);
+    const float pT = truncateFloatFraction(v0.pt(), mTruncationMaskAux);
+    const float v0radius = truncateFloatFraction(v0.v0radius(), mTruncationMaskAux);
+    const float gammapsipair = truncateFloatFraction(v0.psipair(), mTruncationMaskAux);
+
+    rowTPCTree(track.tpcSignal(),
+               1. / dEdxExp,
+               track.tpcInnerParam(),
+               track.tgl(),
+               track.signed1Pt(),
+               track.eta(),
+               track.phi(),
+               track.y(),
+               mass,
+               bg,
+               truncateFloatFraction(multTPC / 11000.f, mTruncationMaskAux),
+               std::sqrt(nClNorm / ncl),
+               id,
+               nSigmaTPC,
+               nSigmaTOF,
+               alpha,
+               qt,
+               cosPA,
+               pT,
+               v0radius,
+               gammapsipair,
+               runnumber);
   };
 
   double tsalisCharged(double pt, double mass, double sqrts)
@@ -128,21 +137,34 @@ struct TreeWriterTpcV0 {
 
   /// Random downsampling trigger function using Tsalis/Hagedorn spectra fit (sqrt(s) = 62.4 GeV to 13 TeV)
   /// as in https://iopscience.iop.org/article/10.1088/2399-6528/aab00f/pdf
-  TRandom3* fRndm = new TRandom3(0);
-  bool downsampleTsalisCharged(double pt, double factor1Pt, double sqrts, double mass)
+  /// The random number is a hash of the seed, the track and the species, so that the decision does not depend
+  /// on the processing order and is the same for a track used in several candidates
+  uint64_t mDownsamplingSeed = 0;
+  uint32_t mTruncationMaskAux = 0xFFFFFFFF; // from nTruncatedBitsAux
+  std::array<double, o2::track::PID::NIDs> mTsalisNorm{}; // Tsallis yield at pT = 1 GeV/c of each species
+  bool downsampleTsalisCharged(int64_t trackId, const o2::track::PID::ID id, double pt, double factor1Pt)
   {
     if (factor1Pt < 0.) {
       return true;
     }
-    const double prob = tsalisCharged(pt, mass, sqrts) * pt;
-    const double probNorm = tsalisCharged(1., mass, sqrts);
-    if ((fRndm->Rndm() * ((prob / probNorm) * pt * pt)) > factor1Pt) {
+    const double prob = tsalisCharged(pt, o2::track::pid_constants::sMasses[id], sqrtSNN) * pt;
+    CounterRng rng(mDownsamplingSeed, trackId, id);
+    if ((rng.uniform() * ((prob / mTsalisNorm[id]) * pt * pt)) > factor1Pt) {
       return false;
     } else {
       return true;
     }
   };
 
+  /// Downsampling of a track for a species, decided before the skimmed quantities are computed:
+  /// first the fixed fraction (from the pT digits), then the pT dependent Tsallis downsampling
+  template <typename T>
+  bool downsampleTrack(T const& track, const o2::track::PID::ID id, double factor1Pt, double dwnSmplFactor)
+  {
+    const double pseudoRndm = track.pt() * 1000. - (int64_t)(track.pt() * 1000);
+    return pseudoRndm < dwnSmplFactor && downsampleTsalisCharged(track.globalIndex(), id, track.pt(), factor1Pt);
+  };
+
   /// Event selection
   template <typename CollisionType, typename TrackType>
   bool isEventSelected(const CollisionType& collision, const TrackType& /*tracks*/)
@@ -161,6 +183,11 @@ struct TreeWriterTpcV0 {
 
   void init(o2::framework::InitContext&)
   {
+    mDownsamplingSeed = CounterRng::seedFromConfig(downsamplingSeed);
+    mTruncationMaskAux = truncationMask(nTruncatedBitsAux);
+    for (int id = 0; id < o2::track::PID::NIDs; ++id) {
+      mTsalisNorm[id] = tsalisCharged(1., o2::track::pid_constants::sMasses[id], sqrtSNN);
+    }
   }
 
   /// Apply a track quality selection with a filter!
@@ -181,38 +208,38 @@ struct TreeWriterTpcV0 {
       auto negTrack = v0.negTrack_as<soa::Filtered<Trks>>();
       // gamma
       if (static_cast<bool>(posTrack.pidbit() & (1 << 0)) && static_cast<bool>(negTrack.pidbit() & (1 << 0))) {
-        if (downsampleTsalisCharged(posTrack.pt(), downsamplingTsalisElectrons, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Electron])) {
-          fillSkimmedV0Table(v0, posTrack, collision, posTrack.tpcNSigmaEl(), posTrack.tofNSigmaEl(), posTrack.tpcExpSignalEl(posTrack.tpcSignal()), o2::track::PID::Electron, runnumber, dwnSmplFactor_El);
+        if (downsampleTrack(posTrack, o2::track::PID::Electron, downsamplingTsalisElectrons, dwnSmplFactor_El)) {
+          fillSkimmedV0Table(v0, posTrack, collision, posTrack.tpcNSigmaEl(), posTrack.tofNSigmaEl(), posTrack.tpcExpSignalEl(posTrack.tpcSignal()), o2::track::PID::Electron, runnumber);
         }
-        if (downsampleTsalisCharged(negTrack.pt(), downsamplingTsalisElectrons, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Electron])) {
-          fillSkimmedV0Table(v0, negTrack, collision, negTrack.tpcNSigmaEl(), negTrack.tofNSigmaEl(), negTrack.tpcExpSignalEl(negTrack.tpcSignal()), o2::track::PID::Electron, runnumber, dwnSmplFactor_El);
+        if (downsampleTrack(negTrack, o2::track::PID::Electron, downsamplingTsalisElectrons, dwnSmplFactor_El)) {
+          fillSkimmedV0Table(v0, negTrack, collision, negTrack.tpcNSigmaEl(), negTrack.tofNSigmaEl(), negTrack.tpcExpSignalEl(negTrack.tpcSignal()), o2::track::PID::Electron, runnumber);
         }
       }
       // Ks0
       if (static_cast<bool>(posTrack.pidbit() & (1 << 1)) && static_cast<bool>(negTrack.pidbit() & (1 << 1))) {
-        if (downsampleTsalisCharged(posTrack.pt(), downsamplingTsalisPions, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Pion])) {
-          fillSkimmedV0Table(v0, posTrack, collision, posTrack.tpcNSigmaPi(), posTrack.tofNSigmaPi(), posTrack.tpcExpSignalPi(posTrack.tpcSignal()), o2::track::PID::Pion, runnumber, dwnSmplFactor_Pi);
+        if (downsampleTrack(posTrack, o2::track::PID::Pion, downsamplingTsalisPions, dwnSmplFactor_Pi)) {
+          fillSkimmedV0Table(v0, posTrack, collision, posTrack.tpcNSigmaPi(), posTrack.tofNSigmaPi(), posTrack.tpcExpSignalPi(posTrack.tpcSignal()), o2::track::PID::Pion, runnumber);
         }
-        if (downsampleTsalisCharged(negTrack.pt(), downsamplingTsalisPions, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Pion])) {
-          fillSkimmedV0Table(v0, negTrack, collision, negTrack.tpcNSigmaPi(), negTrack.tofNSigmaPi(), negTrack.tpcExpSignalPi(negTrack.tpcSignal()), o2::track::PID::Pion, runnumber, dwnSmplFactor_Pi);
+        if (downsampleTrack(negTrack, o2::track::PID::Pion, downsamplingTsalisPions, dwnSmplFactor_Pi)) {
+          fillSkimmedV0Table(v0, negTrack, collision, negTrack.tpcNSigmaPi(), negTrack.tofNSigmaPi(), negTrack.tpcExpSignalPi(negTrack.tpcSignal()), o2::track::PID::Pion, runnumber);
         }
       }
       // Lambda
       if (static_cast<bool>(posTrack.pidbit() & (1 << 2)) && static_cast<bool>(negTrack.pidbit() & (1 << 2))) {
-        if (downsampleTsalisCharged(posTrack.pt(), downsamplingTsalisProtons, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Proton])) {
-          fillSkimmedV0Table(v0, posTrack, collision, posTrack.tpcNSigmaPr(), posTrack.tofNSigmaPr(), posTrack.tpcExpSignalPr(posTrack.tpcSignal()), o2::track::PID::Proton, runnumber, dwnSmplFactor_Pr);
+        if (downsampleTrack(posTrack, o2::track::PID::Proton, downsamplingTsalisProtons, dwnSmplFactor_Pr)) {
+          fillSkimmedV0Table(v0, posTrack, collision, posTrack.tpcNSigmaPr(), posTrack.tofNSigmaPr(), posTrack.tpcExpSignalPr(posTrack.tpcSignal()), o2::track::PID::Proton, runnumber);
         }
-        if (downsampleTsalisCharged(negTrack.pt(), downsamplingTsalisPions, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Pion])) {
-          fillSkimmedV0Table(v0, negTrack, collision, negTrack.tpcNSigmaPi(), negTrack.tofNSigmaPi(), negTrack.tpcExpSignalPi(negTrack.tpcSignal()), o2::track::PID::Pion, runnumber, dwnSmplFactor_Pi);
+        if (downsampleTrack(negTrack, o2::track::PID::Pion, downsamplingTsalisPions, dwnSmplFactor_Pi)) {
+          fillSkimmedV0Table(v0, negTrack, collision, negTrack.tpcNSigmaPi(), negTrack.tofNSigmaPi(), negTrack.tpcExpSignalPi(negTrack.tpcSignal()), o2::track::PID::Pion, runnumber);
         }
       }
       // Antilambda
       if (static_cast<bool>(posTrack.pidbit() & (1 << 3)) && static_cast<bool>(negTrack.pidbit() & (1 << 3))) {
-        if (downsampleTsalisCharged(posTrack.pt(), downsamplingTsalisPions, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Pion])) {
-          fillSkimmedV0Table(v0, posTrack, collision, posTrack.tpcNSigmaPi(), posTrack.tofNSigmaPi(), posTrack.tpcExpSignalPi(posTrack.tpcSignal()), o2::track::PID::Pion, runnumber, dwnSmplFactor_Pi);
+        if (downsampleTrack(posTrack, o2::track::PID::Pion, downsamplingTsalisPions, dwnSmplFactor_Pi)) {
+          fillSkimmedV0Table(v0, posTrack, collision, posTrack.tpcNSigmaPi(), posTrack.tofNSigmaPi(), posTrack.tpcExpSignalPi(posTrack.tpcSignal()), o2::track::PID::Pion, runnumber);
         }
-        if (downsampleTsalisCharged(negTrack.pt(), downsamplingTsalisProtons, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Proton])) {
-          fillSkimmedV0Table(v0, negTrack, collision, negTrack.tpcNSigmaPr(), negTrack.tofNSigmaPr(), negTrack.tpcExpSignalPr(negTrack.tpcSignal()), o2::track::PID::Proton, runnumber, dwnSmplFactor_Pr);
+        if (downsampleTrack(negTrack, o2::track::PID::Proton, downsamplingTsalisProtons, dwnSmplFactor_Pr)) {
+          fillSkimmedV0Table(v0, negTrack, collision, negTrack.tpcNSigmaPr(), negTrack.tofNSigmaPr(), negTrack.tpcExpSignalPr(negTrack.tpcSignal()), o2::track::PID::Proton, runnumber);
         }
       }
     }
@@ -271,6 +298,8 @@ struct TreeWriterTPCTOF {
   Configurable<float> downsamplingTsalisProtons{"downsamplingTsalisProtons", -1., "Downsampling factor to reduce the number of protons"};
   Configurable<float> downsamplingTsalisKaons{"downsamplingTsalisKaons", -1., "Downsampling factor to reduce the number of kaons"};
   Configurable<float> downsamplingTsalisPions{"downsamplingTsalisPions", -1., "Downsampling factor to reduce the number of pions"};
+  Configurable<int> downsamplingSeed{"downsamplingSeed", 0, "Seed of the Tsallis downsampling, drawn per track and species: 0 -> random seed"};
+  Configurable<int> nTruncatedBitsAux{"nTruncatedBitsAux", 0, "Number of low mantissa bits zeroed in the auxiliary columns (normalised multiplicity), for a better compression of the skim: 0 -> full precision"};
 
   Filter trackFilter = (trackSelection.node() == 0) ||
                        ((trackSelection.node() == 1) && requireGlobalTrackInFilter()) ||
@@ -293,24 +322,37 @@ struct TreeWriterTPCTOF {
 
   /// Random downsampling trigger function using Tsalis/Hagedorn spectra fit (sqrt(s) = 62.4 GeV to 13 TeV)
   /// as in https://iopscience.iop.org/article/10.1088/2399-6528/aab00f/pdf
-  TRandom3* fRndm = new TRandom3(0);
-  bool downsampleTsalisCharged(double pt, float factor1Pt, double sqrts, double mass)
+  /// The random number is a hash of the seed, the track and the species, so that the decision does not depend
+  /// on the processing order and is the same for a track used in several candidates
+  uint64_t mDownsamplingSeed = 0;
+  uint32_t mTruncationMaskAux = 0xFFFFFFFF; // from nTruncatedBitsAux
+  std::array<double, o2::track::PID::NIDs> mTsalisNorm{}; // Tsallis yield at pT = 1 GeV/c of each species
+  bool downsampleTsalisCharged(int64_t trackId, const o2::track::PID::ID id, double pt, float factor1Pt)
   {
     if (factor1Pt < 0.) {
       return true;
     }
-    const double prob = tsalisCharged(pt, mass, sqrts) * pt;
-    const double probNorm = tsalisCharged(1., mass, sqrts);
-    if ((fRndm->Rndm() * ((prob / probNorm) * pt * pt)) > factor1Pt) {
+    const double prob = tsalisCharged(pt, o2::track::pid_constants::sMasses[id], sqrtSNN) * pt;
+    CounterRng rng(mDownsamplingSeed, trackId, id);
+    if ((rng.uniform() * ((prob / mTsalisNorm[id]) * pt * pt)) > factor1Pt) {
       return false;
     } else {
       return true;
     }
   };
 
+  /// Downsampling of a track for a species, decided before the skimmed quantities are computed:
+  /// first the fixed fraction (from the pT digits), then the pT dependent Tsallis downsampling
+  template <typename T>
+  bool downsampleTrack(T const& track, const o2::track::PID::ID id, float factor1Pt, double dwnSmplFactor)
+  {
+    const double pseudoRndm = track.pt() * 1000. - (int64_t)(track.pt() * 1000);
+    return pseudoRndm < dwnSmplFactor && downsampleTsalisCharged(track.globalIndex(), id, track.pt(), factor1Pt);
+  };
+
   /// Function to fill trees
   template <typename T, typename C>
-  void fillSkimmedTPCTOFTable(T const& track, C const& collision, const float nSigmaTPC, const float nSigmaTOF, const float dEdxExp, const o2::track::PID::ID id, int runnumber, double dwnSmplFactor)
+  void fillSkimmedTPCTOFTable(T const& track, C const& collision, const float nSigmaTPC, const float nSigmaTOF, const float dEdxExp, const o2::track::PID::ID id, int runnumber)
   {
 
     const double ncl = track.tpcNClsFound();
@@ -319,25 +361,22 @@ struct TreeWriterTPCTOF {
     const double bg = p / mass;
     const int multTPC = collision.multTPC();
 
-    const double pseudoRndm = track.pt() * 1000. - (int64_t)(track.pt() * 1000);
-    if (pseudoRndm < dwnSmplFactor) {
-      rowTPCTOFTree(track.tpcSignal(),
-                    1. / dEdxExp,
-                    track.tpcInnerParam(),
-                    track.tgl(),
-                    track.signed1Pt(),
-                    track.eta(),
-                    track.phi(),
-                    track.y(),
-                    mass,
-                    bg,
-                    multTPC / 11000.,
-                    std::sqrt(nClNorm / ncl),
-                    id,
-                    nSigmaTPC,
-                    nSigmaTOF,
-                    runnumber);
-    }
+    rowTPCTOFTree(track.tpcSignal(),
+                  1. / dEdxExp,
+                  track.tpcInnerParam(),
+                  track.tgl(),
+                  track.signed1Pt(),
+                  track.eta(),
+                  track.phi(),
+                  track.y(),
+                  mass,
+                  bg,
+                  truncateFloatFraction(multTPC / 11000.f, mTruncationMaskAux),
+                  std::sqrt(nClNorm / ncl),
+                  id,
+                  nSigmaTPC,
+                  nSigmaTOF,
+                  runnumber);
   };
 
   /// Event selection
@@ -358,6 +397,11 @@ struct TreeWriterTPCTOF {
 
   void init(o2::framework::InitContext&)
   {
+    mDownsamplingSeed = CounterRng::seedFromConfig(downsamplingSeed);
+    mTruncationMaskAux = truncationMask(nTruncatedBitsAux);
+    for (int id = 0; id < o2::track::PID::NIDs; ++id) {
+      mTsalisNorm[id] = tsalisCharged(1., o2::track::pid_constants::sMasses[id], sqrtSNN);
+    }
   }
 
   void process(Coll::iterator const& collision, soa::Filtered<Trks> const& tracks, aod::BCsWithTimestamps const&)
@@ -372,34 +416,34 @@ struct TreeWriterTPCTOF {
     rowTPCTOFTree.reserve(tracks.size());
     for (auto const& trk : tracks) {
       /// Fill tree for tritons
-      if (trk.tpcInnerParam() < maxMomHardCutOnlyTr && trk.tpcInnerParam() <= maxMomTPCOnlyTr && std::abs(trk.tpcNSigmaTr()) < nSigmaTPCOnlyTr && downsampleTsalisCharged(trk.pt(), downsamplingTsalisProtons, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Triton])) {
-        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaTr(), trk.tofNSigmaTr(), trk.tpcExpSignalTr(trk.tpcSignal()), o2::track::PID::Triton, runnumber, dwnSmplFactor_Tr);
-      } else if (trk.tpcInnerParam() < maxMomHardCutOnlyTr && trk.tpcInnerParam() > maxMomTPCOnlyTr && std::abs(trk.tofNSigmaTr()) < nSigmaTOF_TPCTOF_Tr && std::abs(trk.tpcNSigmaTr()) < nSigmaTPC_TPCTOF_Tr && downsampleTsalisCharged(trk.pt(), downsamplingTsalisProtons, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Triton])) {
-        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaTr(), trk.tofNSigmaTr(), trk.tpcExpSignalTr(trk.tpcSignal()), o2::track::PID::Triton, runnumber, dwnSmplFactor_Tr);
+      if (trk.tpcInnerParam() < maxMomHardCutOnlyTr && trk.tpcInnerParam() <= maxMomTPCOnlyTr && std::abs(trk.tpcNSigmaTr()) < nSigmaTPCOnlyTr && downsampleTrack(trk, o2::track::PID::Triton, downsamplingTsalisProtons, dwnSmplFactor_Tr)) {
+        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaTr(), trk.tofNSigmaTr(), trk.tpcExpSignalTr(trk.tpcSignal()), o2::track::PID::Triton, runnumber);
+      } else if (trk.tpcInnerParam() < maxMomHardCutOnlyTr && trk.tpcInnerParam() > maxMomTPCOnlyTr && std::abs(trk.tofNSigmaTr()) < nSigmaTOF_TPCTOF_Tr && std::abs(trk.tpcNSigmaTr()) < nSigmaTPC_TPCTOF_Tr && downsampleTrack(trk, o2::track::PID::Triton, downsamplingTsalisProtons, dwnSmplFactor_Tr)) {
+        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaTr(), trk.tofNSigmaTr(), trk.tpcExpSignalTr(trk.tpcSignal()), o2::track::PID::Triton, runnumber);
       }
       /// Fill tree for deuterons
-      if (trk.tpcInnerParam() < maxMomHardCutOnlyDe && trk.tpcInnerParam() <= maxMomTPCOnlyDe && std::abs(trk.tpcNSigmaDe()) < nSigmaTPCOnlyDe && downsampleTsalisCharged(trk.pt(), downsamplingTsalisProtons, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Deuteron])) {
-        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaDe(), trk.tofNSigmaDe(), trk.tpcExpSignalDe(trk.tpcSignal()), o2::track::PID::Deuteron, runnumber, dwnSmplFactor_De);
-      } else if (trk.tpcInnerParam() < maxMomHardCutOnlyDe && trk.tpcInnerParam() > maxMomTPCOnlyDe && std::abs(trk.tofNSigmaDe()) < nSigmaTOF_TPCTOF_De && std::abs(trk.tpcNSigmaDe()) < nSigmaTPC_TPCTOF_De && downsampleTsalisCharged(trk.pt(), downsamplingTsalisProtons, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Deuteron])) {
-        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaDe(), trk.tofNSigmaDe(), trk.tpcExpSignalDe(trk.tpcSignal()), o2::track::PID::Deuteron, runnumber, dwnSmplFactor_De);
+      if (trk.tpcInnerParam() < maxMomHardCutOnlyDe && trk.tpcInnerParam() <= maxMomTPCOnlyDe && std::abs(trk.tpcNSigmaDe()) < nSigmaTPCOnlyDe && downsampleTrack(trk, o2::track::PID::Deuteron, downsamplingTsalisProtons, dwnSmplFactor_De)) {
+        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaDe(), trk.tofNSigmaDe(), trk.tpcExpSignalDe(trk.tpcSignal()), o2::track::PID::Deuteron, runnumber);
+      } else if (trk.tpcInnerParam() < maxMomHardCutOnlyDe && trk.tpcInnerParam() > maxMomTPCOnlyDe && std::abs(trk.tofNSigmaDe()) < nSigmaTOF_TPCTOF_De && std::abs(trk.tpcNSigmaDe()) < nSigmaTPC_TPCTOF_De && downsampleTrack(trk, o2::track::PID::Deuteron, downsamplingTsalisProtons, dwnSmplFactor_De)) {
+        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaDe(), trk.tofNSigmaDe(), trk.tpcExpSignalDe(trk.tpcSignal()), o2::track::PID::Deuteron, runnumber);
       }
       /// Fill tree for protons
-      if (trk.tpcInnerParam() <= maxMomTPCOnlyPr && std::abs(trk.tpcNSigmaPr()) < nSigmaTPCOnlyPr && downsampleTsalisCharged(trk.pt(), downsamplingTsalisProtons, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Proton])) {
-        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaPr(), trk.tofNSigmaPr(), trk.tpcExpSignalPr(trk.tpcSignal()), o2::track::PID::Proton, runnumber, dwnSmplFactor_Pr);
-      } else if (trk.tpcInnerParam() > maxMomTPCOnlyPr && std::abs(trk.tofNSigmaPr()) < nSigmaTOF_TPCTOF_Pr && std::abs(trk.tpcNSigmaPr()) < nSigmaTPC_TPCTOF_Pr && downsampleTsalisCharged(trk.pt(), downsamplingTsalisProtons, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Proton])) {
-        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaPr(), trk.tofNSigmaPr(), trk.tpcExpSignalPr(trk.tpcSignal()), o2::track::PID::Proton, runnumber, dwnSmplFactor_Pr);
+      if (trk.tpcInnerParam() <= maxMomTPCOnlyPr && std::abs(trk.tpcNSigmaPr()) < nSigmaTPCOnlyPr && downsampleTrack(trk, o2::track::PID::Proton, downsamplingTsalisProtons, dwnSmplFactor_Pr)) {
+        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaPr(), trk.tofNSigmaPr(), trk.tpcExpSignalPr(trk.tpcSignal()), o2::track::PID::Proton, runnumber);
+      } else if (trk.tpcInnerParam() > maxMomTPCOnlyPr && std::abs(trk.tofNSigmaPr()) < nSigmaTOF_TPCTOF_Pr && std::abs(trk.tpcNSigmaPr()) < nSigmaTPC_TPCTOF_Pr && downsampleTrack(trk, o2::track::PID::Proton, downsamplingTsalisProtons, dwnSmplFactor_Pr)) {
+        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaPr(), trk.tofNSigmaPr(), trk.tpcExpSignalPr(trk.tpcSignal()), o2::track::PID::Proton, runnumber);
       }
       /// Fill tree for kaons
-      if (trk.tpcInnerParam() < maxMomHardCutOnlyKa && trk.tpcInnerParam() <= maxMomTPCOnlyKa && std::abs(trk.tpcNSigmaKa()) < nSigmaTPCOnlyKa && downsampleTsalisCharged(trk.pt(), downsamplingTsalisKaons, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Kaon])) {
-        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaKa(), trk.tofNSigmaKa(), trk.tpcExpSignalKa(trk.tpcSignal()), o2::track::PID::Kaon, runnumber, dwnSmplFactor_Ka);
-      } else if (trk.tpcInnerParam() < maxMomHardCutOnlyKa && trk.tpcInnerParam() > maxMomTPCOnlyKa && std::abs(trk.tofNSigmaKa()) < nSigmaTOF_TPCTOF_Ka && std::abs(trk.tpcNSigmaKa()) < nSigmaTPC_TPCTOF_Ka && downsampleTsalisCharged(trk.pt(), downsamplingTsalisKaons, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Kaon])) {
-        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaKa(), trk.tofNSigmaKa(), trk.tpcExpSignalKa(trk.tpcSignal()), o2::track::PID::Kaon, runnumber, dwnSmplFactor_Ka);
+      if (trk.tpcInnerParam() < maxMomHardCutOnlyKa && trk.tpcInnerParam() <= maxMomTPCOnlyKa && std::abs(trk.tpcNSigmaKa()) < nSigmaTPCOnlyKa && downsampleTrack(trk, o2::track::PID::Kaon, downsamplingTsalisKaons, dwnSmplFactor_Ka)) {
+        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaKa(), trk.tofNSigmaKa(), trk.tpcExpSignalKa(trk.tpcSignal()), o2::track::PID::Kaon, runnumber);
+      } else if (trk.tpcInnerParam() < maxMomHardCutOnlyKa && trk.tpcInnerParam() > maxMomTPCOnlyKa && std::abs(trk.tofNSigmaKa()) < nSigmaTOF_TPCTOF_Ka && std::abs(trk.tpcNSigmaKa()) < nSigmaTPC_TPCTOF_Ka && downsampleTrack(trk, o2::track::PID::Kaon, downsamplingTsalisKaons, dwnSmplFactor_Ka)) {
+        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaKa(), trk.tofNSigmaKa(), trk.tpcExpSignalKa(trk.tpcSignal()), o2::track::PID::Kaon, runnumber);
       }
       /// Fill tree pions
-      if (trk.tpcInnerParam() <= maxMomTPCOnlyPi && std::abs(trk.tpcNSigmaPi()) < nSigmaTPCOnlyPi && downsampleTsalisCharged(trk.pt(), downsamplingTsalisPions, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Pion])) {
-        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaPi(), trk.tofNSigmaPi(), trk.tpcExpSignalPi(trk.tpcSignal()), o2::track::PID::Pion, runnumber, dwnSmplFactor_Pi);
-      } else if (trk.tpcInnerParam() > maxMomTPCOnlyPi && std::abs(trk.tofNSigmaPi()) < nSigmaTOF_TPCTOF_Pi && std::abs(trk.tpcNSigmaPi()) < nSigmaTPC_TPCTOF_Pi && downsampleTsalisCharged(trk.pt(), downsamplingTsalisPions, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Pion])) {
-        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaPi(), trk.tofNSigmaPi(), trk.tpcExpSignalPi(trk.tpcSignal()), o2::track::PID::Pion, runnumber, dwnSmplFactor_Pi);
+      if (trk.tpcInnerParam() <= maxMomTPCOnlyPi && std::abs(trk.tpcNSigmaPi()) < nSigmaTPCOnlyPi && downsampleTrack(trk, o2::track::PID::Pion, downsamplingTsalisPions, dwnSmplFactor_Pi)) {
+        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaPi(), trk.tofNSigmaPi(), trk.tpcExpSignalPi(trk.tpcSignal()), o2::track::PID::Pion, runnumber);
+      } else if (trk.tpcInnerParam() > maxMomTPCOnlyPi && std::abs(trk.tofNSigmaPi()) < nSigmaTOF_TPCTOF_Pi && std::abs(trk.tpcNSigmaPi()) < nSigmaTPC_TPCTOF_Pi && downsampleTrack(trk, o2::track::PID::Pion, downsamplingTsalisPions, dwnSmplFactor_Pi)) {
+        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaPi(), trk.tofNSigmaPi(), trk.tpcExpSignalPi(trk.tpcSignal()), o2::track::PID::Pion, runnumber);
       }
     } /// Loop tracks
   }   /// process
@@ -203,6 +203,14 @@ struct CFFilter {
     "ConfAutocorRejection",
     true,
     "Rejection autocorrelation pL pairs"};
+  Configurable<bool> ConfPruneTriplets{
+    "ConfPruneTriplets",
+    false,
+    "Skip the triplets with a pair above the Q3 limit, the triplet histograms are then only filled below the Q3 limit"};
+  Configurable<bool> ConfStopAtFirstTriplet{
+    "ConfStopAtFirstTriplet",
+    false,
+    "Stop the triplet search of a three-body trigger once the event is kept (the triplet histograms are incomplete)"};
 
   // Configs for tracks
   Configurable<bool> ConfDeuteronThPVMom{
@@ -1628,18 +1636,36 @@ struct CFFilter {
       }
 
       float Q3 = 999.f, kstar = 999.f;
+      // Q3^2 of a triplet is the sum of the -q_ij^2 >= 0 of its pairs, so a pair above the Q3 limit
+      // cannot make a triplet below it and the triplets built on it are skipped
+      const bool pruneTriplets = ConfPruneTriplets.value;
+      auto pairAboveQ3Limit = [&](const ROOT::Math::PtEtaPhiMVector& part1, const ROOT::Math::PtEtaPhiMVector& part2, float limit) {
+        return pruneTriplets && -getqij(part1, part2).M2() >= limit * limit;
+      };
+      // the event is kept for a three-body trigger as soon as one triplet is below the Q3 limit
+      auto tripletsDone = [&](int trigger) {
+        return ConfStopAtFirstTriplet.value && lowQ3Triplets[trigger] > 0;
+      };
       if (ConfTriggerSwitches->get("Switch", "ppp") > 0.) {
         // ppp trigger
         for (auto iProton1 = protons.begin(); iProton1 != protons.end(); ++iProton1) {
           auto iProton2 = iProton1 + 1;
           for (; iProton2 != protons.end(); ++iProton2) {
+            if (tripletsDone(CFTrigger::kPPP) || pairAboveQ3Limit(*iProton1, *iProton2, ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPPP))) {
+              continue;
+            }
             auto iProton3 = iProton2 + 1;
             for (; iProton3 != protons.end(); ++iProton3) {
+              if (tripletsDone(CFTrigger::kPPP)) {
+                break;
+              }
               Q3 = getQ3(*iProton1, *iProton2, *iProton3);
-              registry.fill(HIST("ppp/fSE_particle"), Q3);
-              registry.fill(HIST("ppp/fProtonPtVsQ3"), Q3, (*iProton1).Pt());
-              registry.fill(HIST("ppp/fProtonPtVsQ3"), Q3, (*iProton2).Pt());
-              registry.fill(HIST("ppp/fProtonPtVsQ3"), Q3, (*iProton3).Pt());
+              if (!pruneTriplets || Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPPP)) {
+                registry.fill(HIST("ppp/fSE_particle"), Q3);
+                registry.fill(HIST("ppp/fProtonPtVsQ3"), Q3, (*iProton1).Pt());
+                registry.fill(HIST("ppp/fProtonPtVsQ3"), Q3, (*iProton2).Pt());
+                registry.fill(HIST("ppp/fProtonPtVsQ3"), Q3, (*iProton3).Pt());
+              }
               if (Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPPP)) {
                 if (ConfDownsample->get("Switch", "PPP") > 0) {
                   if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "PPP")) {
@@ -1656,13 +1682,21 @@ struct CFFilter {
         for (auto iAntiProton1 = antiprotons.begin(); iAntiProton1 != antiprotons.end(); ++iAntiProton1) {
           auto iAntiProton2 = iAntiProton1 + 1;
           for (; iAntiProton2 != antiprotons.end(); ++iAntiProton2) {
+            if (tripletsDone(CFTrigger::kPPP) || pairAboveQ3Limit(*iAntiProton1, *iAntiProton2, ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPPP))) {
+              continue;
+            }
             auto iAntiProton3 = iAntiProton2 + 1;
             for (; iAntiProton3 != antiprotons.end(); ++iAntiProton3) {
+              if (tripletsDone(CFTrigger::kPPP)) {
+                break;
+              }
               Q3 = getQ3(*iAntiProton1, *iAntiProton2, *iAntiProton3);
-              registry.fill(HIST("ppp/fSE_antiparticle"), Q3);
-              registry.fill(HIST("ppp/fAntiProtonPtVsQ3"), Q3, (*iAntiProton1).Pt());
-              registry.fill(HIST("ppp/fAntiProtonPtVsQ3"), Q3, (*iAntiProton2).Pt());
-              registry.fill(HIST("ppp/fAntiProtonPtVsQ3"), Q3, (*iAntiProton3).Pt());
+              if (!pruneTriplets || Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPPP)) {
+                registry.fill(HIST("ppp/fSE_antiparticle"), Q3);
+                registry.fill(HIST("ppp/fAntiProtonPtVsQ3"), Q3, (*iAntiProton1).Pt());
+                registry.fill(HIST("ppp/fAntiProtonPtVsQ3"), Q3, (*iAntiProton2).Pt());
+                registry.fill(HIST("ppp/fAntiProtonPtVsQ3"), Q3, (*iAntiProton3).Pt());
+              }
               if (Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPPP)) {
                 if (ConfDownsample->get("Switch", "aPaPaP") > 0) {
                   if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "aPaPaP")) {
@@ -1683,8 +1717,14 @@ struct CFFilter {
           auto iProton2 = iProton1 + 1;
           auto i1 = std::distance(protons.begin(), iProton1);
           for (; iProton2 != protons.end(); ++iProton2) {
+            if (tripletsDone(CFTrigger::kPPL) || pairAboveQ3Limit(*iProton1, *iProton2, ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPPL))) {
+              continue;
+            }
             auto i2 = std::distance(protons.begin(), iProton2);
             for (auto iLambda1 = lambdas.begin(); iLambda1 != lambdas.end(); ++iLambda1) {
+              if (tripletsDone(CFTrigger::kPPL)) {
+                break;
+              }
               auto i3 = std::distance(lambdas.begin(), iLambda1);
               if (ConfAutocorRejection.value &&
                   (ProtonIndex.at(i1) == LambdaPosDaughIndex.at(i3) ||
@@ -1692,10 +1732,12 @@ struct CFFilter {
                 continue;
               }
               Q3 = getQ3(*iProton1, *iProton2, *iLambda1);
-              registry.fill(HIST("ppl/fSE_particle"), Q3);
-              registry.fill(HIST("ppl/fProtonPtVsQ3"), Q3, (*iProton1).Pt());
-              registry.fill(HIST("ppl/fProtonPtVsQ3"), Q3, (*iProton2).Pt());
-              registry.fill(HIST("ppl/fLambdaPtVsQ3"), Q3, (*iLambda1).Pt());
+              if (!pruneTriplets || Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPPL)) {
+                registry.fill(HIST("ppl/fSE_particle"), Q3);
+                registry.fill(HIST("ppl/fProtonPtVsQ3"), Q3, (*iProton1).Pt());
+                registry.fill(HIST("ppl/fProtonPtVsQ3"), Q3, (*iProton2).Pt());
+                registry.fill(HIST("ppl/fLambdaPtVsQ3"), Q3, (*iLambda1).Pt());
+              }
               if (Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPPL)) {
                 if (ConfDownsample->get("Switch", "PPL") > 0) {
                   if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "PPL")) {
@@ -1713,8 +1755,14 @@ struct CFFilter {
           auto iAntiProton2 = iAntiProton1 + 1;
           auto i1 = std::distance(antiprotons.begin(), iAntiProton1);
           for (; iAntiProton2 != antiprotons.end(); ++iAntiProton2) {
+            if (tripletsDone(CFTrigger::kPPL) || pairAboveQ3Limit(*iAntiProton1, *iAntiProton2, ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPPL))) {
+              continue;
+            }
             auto i2 = std::distance(antiprotons.begin(), iAntiProton2);
             for (auto iAntiLambda1 = antilambdas.begin(); iAntiLambda1 != antilambdas.end(); ++iAntiLambda1) {
+              if (tripletsDone(CFTrigger::kPPL)) {
+                break;
+              }
               auto i3 = std::distance(antilambdas.begin(), iAntiLambda1);
               if (ConfAutocorRejection.value &&
                   (AntiProtonIndex.at(i1) == AntiLambdaNegDaughIndex.at(i3) ||
@@ -1722,10 +1770,12 @@ struct CFFilter {
                 continue;
               }
               Q3 = getQ3(*iAntiProton1, *iAntiProton2, *iAntiLambda1);
-              registry.fill(HIST("ppl/fSE_antiparticle"), Q3);
-              registry.fill(HIST("ppl/fAntiProtonPtVsQ3"), Q3, (*iAntiProton1).Pt());
-              registry.fill(HIST("ppl/fAntiProtonPtVsQ3"), Q3, (*iAntiProton2).Pt());
-              registry.fill(HIST("ppl/fAntiLambdaPtVsQ3"), Q3, (*iAntiLambda1).Pt());
+              if (!pruneTriplets || Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPPL)) {
+                registry.fill(HIST("ppl/fSE_antiparticle"), Q3);
+                registry.fill(HIST("ppl/fAntiProtonPtVsQ3"), Q3, (*iAntiProton1).Pt());
+                registry.fill(HIST("ppl/fAntiProtonPtVsQ3"), Q3, (*iAntiProton2).Pt());
+                registry.fill(HIST("ppl/fAntiLambdaPtVsQ3"), Q3, (*iAntiLambda1).Pt());
+              }
               if (Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPPL)) {
                 if (ConfDownsample->get("Switch", "aPaPaL") > 0) {
                   if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "aPaPaL")) {
@@ -1746,6 +1796,9 @@ struct CFFilter {
           auto iLambda2 = iLambda1 + 1;
           auto i1 = std::distance(lambdas.begin(), iLambda1);
           for (; iLambda2 != lambdas.end(); ++iLambda2) {
+            if (tripletsDone(CFTrigger::kPLL) || pairAboveQ3Limit(*iLambda1, *iLambda2, ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPLL))) {
+              continue;
+            }
             auto i2 = std::distance(lambdas.begin(), iLambda2);
             if (ConfAutocorRejection.value &&
                 (LambdaPosDaughIndex.at(i1) == LambdaPosDaughIndex.at(i2) ||
@@ -1753,6 +1806,9 @@ struct CFFilter {
               continue;
             }
             for (auto iProton1 = protons.begin(); iProton1 != protons.end(); ++iProton1) {
+              if (tripletsDone(CFTrigger::kPLL)) {
+                break;
+              }
               auto i3 = std::distance(protons.begin(), iProton1);
               if (ConfAutocorRejection.value &&
                   (LambdaPosDaughIndex.at(i1) == ProtonIndex.at(i3) ||
@@ -1760,10 +1816,12 @@ struct CFFilter {
                 continue;
               }
               Q3 = getQ3(*iLambda1, *iLambda2, *iProton1);
-              registry.fill(HIST("pll/fSE_particle"), Q3);
-              registry.fill(HIST("pll/fProtonPtVsQ3"), Q3, (*iProton1).Pt());
-              registry.fill(HIST("pll/fLambdaPtVsQ3"), Q3, (*iLambda1).Pt());
-              registry.fill(HIST("pll/fLambdaPtVsQ3"), Q3, (*iLambda2).Pt());
+              if (!pruneTriplets || Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPLL)) {
+                registry.fill(HIST("pll/fSE_particle"), Q3);
+                registry.fill(HIST("pll/fProtonPtVsQ3"), Q3, (*iProton1).Pt());
+                registry.fill(HIST("pll/fLambdaPtVsQ3"), Q3, (*iLambda1).Pt());
+                registry.fill(HIST("pll/fLambdaPtVsQ3"), Q3, (*iLambda2).Pt());
+              }
               if (Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPLL)) {
                 if (ConfDownsample->get("Switch", "PLL") > 0) {
                   if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "PLL")) {
@@ -1781,6 +1839,9 @@ struct CFFilter {
           auto iAntiLambda2 = iAntiLambda1 + 1;
           auto i1 = std::distance(antilambdas.begin(), iAntiLambda1);
           for (; iAntiLambda2 != antilambdas.end(); ++iAntiLambda2) {
+            if (tripletsDone(CFTrigger::kPLL) || pairAboveQ3Limit(*iAntiLambda1, *iAntiLambda2, ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPLL))) {
+              continue;
+            }
             auto i2 = std::distance(antilambdas.begin(), iAntiLambda2);
             if (ConfAutocorRejection.value &&
                 (AntiLambdaPosDaughIndex.at(i1) == AntiLambdaPosDaughIndex.at(i2) ||
@@ -1788,6 +1849,9 @@ struct CFFilter {
               continue;
             }
             for (auto iAntiProton1 = antiprotons.begin(); iAntiProton1 != antiprotons.end(); ++iAntiProton1) {
+              if (tripletsDone(CFTrigger::kPLL)) {
+                break;
+              }
               auto i3 = std::distance(antiprotons.begin(), iAntiProton1);
               if (ConfAutocorRejection.value &&
                   (AntiLambdaNegDaughIndex.at(i1) == AntiProtonIndex.at(i3) ||
@@ -1795,10 +1859,12 @@ struct CFFilter {
                 continue;
               }
               Q3 = getQ3(*iAntiLambda1, *iAntiLambda2, *iAntiProton1);
-              registry.fill(HIST("pll/fSE_antiparticle"), Q3);
-              registry.fill(HIST("pll/fAntiProtonPtVsQ3"), Q3, (*iAntiProton1).Pt());
-              registry.fill(HIST("pll/fAntiLambdaPtVsQ3"), Q3, (*iAntiLambda1).Pt());
-              registry.fill(HIST("pll/fAntiLambdaPtVsQ3"), Q3, (*iAntiLambda2).Pt());
+              if (!pruneTriplets || Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPLL)) {
+                registry.fill(HIST("pll/fSE_antiparticle"), Q3);
+                registry.fill(HIST("pll/fAntiProtonPtVsQ3"), Q3, (*iAntiProton1).Pt());
+                registry.fill(HIST("pll/fAntiLambdaPtVsQ3"), Q3, (*iAntiLambda1).Pt());
+                registry.fill(HIST("pll/fAntiLambdaPtVsQ3"), Q3, (*iAntiLambda2).Pt());
+              }
               if (Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPLL)) {
                 if (ConfDownsample->get("Switch", "aPaLaL") > 0) {
                   if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "aPaLaL")) {
@@ -1819,6 +1885,9 @@ struct CFFilter {
           auto iLambda2 = iLambda1 + 1;
           auto i1 = std::distance(lambdas.begin(), iLambda1);
           for (; iLambda2 != lambdas.end(); ++iLambda2) {
+            if (tripletsDone(CFTrigger::kLLL) || pairAboveQ3Limit(*iLambda1, *iLambda2, ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kLLL))) {
+              continue;
+            }
             auto i2 = std::distance(lambdas.begin(), iLambda2);
             if (ConfAutocorRejection.value &&
                 (LambdaPosDaughIndex.at(i1) == LambdaPosDaughIndex.at(i2) ||
@@ -1827,6 +1896,9 @@ struct CFFilter {
             }
             auto iLambda3 = iLambda2 + 1;
             for (; iLambda3 != lambdas.end(); ++iLambda3) {
+              if (tripletsDone(CFTrigger::kLLL)) {
+                break;
+              }
               auto i3 = std::distance(lambdas.begin(), iLambda3);
               if (ConfAutocorRejection.value &&
                   (LambdaPosDaughIndex.at(i1) == LambdaPosDaughIndex.at(i3) ||
@@ -1836,10 +1908,12 @@ struct CFFilter {
                 continue;
               }
               Q3 = getQ3(*iLambda1, *iLambda2, *iLambda3);
-              registry.fill(HIST("lll/fSE_particle"), Q3);
-              registry.fill(HIST("lll/fLambdaPtVsQ3"), Q3, (*iLambda1).Pt());
-              registry.fill(HIST("lll/fLambdaPtVsQ3"), Q3, (*iLambda2).Pt());
-              registry.fill(HIST("lll/fLambdaPtVsQ3"), Q3, (*iLambda3).Pt());
+              if (!pruneTriplets || Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kLLL)) {
+                registry.fill(HIST("lll/fSE_particle"), Q3);
+                registry.fill(HIST("lll/fLambdaPtVsQ3"), Q3, (*iLambda1).Pt());
+                registry.fill(HIST("lll/fLambdaPtVsQ3"), Q3, (*iLambda2).Pt());
+                registry.fill(HIST("lll/fLambdaPtVsQ3"), Q3, (*iLambda3).Pt());
+              }
               if (Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kLLL)) {
                 if (ConfDownsample->get("Switch", "LLL") > 0) {
                   if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "LLL")) {
@@ -1857,6 +1931,9 @@ struct CFFilter {
           auto iAntiLambda2 = iAntiLambda1 + 1;
           auto i1 = std::distance(antilambdas.begin(), iAntiLambda1);
           for (; iAntiLambda2 != antilambdas.end(); ++iAntiLambda2) {
+            if (tripletsDone(CFTrigger::kLLL) || pairAboveQ3Limit(*iAntiLambda1, *iAntiLambda2, ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kLLL))) {
+              continue;
+            }
             auto i2 = std::distance(antilambdas.begin(), iAntiLambda2);
             if (ConfAutocorRejection.value &&
                 (AntiLambdaPosDaughIndex.at(i1) == AntiLambdaPosDaughIndex.at(i2) ||
@@ -1865,6 +1942,9 @@ struct CFFilter {
             }
             auto iAntiLambda3 = iAntiLambda2 + 1;
             for (; iAntiLambda3 != antilambdas.end(); ++iAntiLambda3) {
+              if (tripletsDone(CFTrigger::kLLL)) {
+                break;
+              }
               auto i3 = std::distance(antilambdas.begin(), iAntiLambda3);
               if (ConfAutocorRejection.value &&
                   (AntiLambdaPosDaughIndex.at(i1) == AntiLambdaPosDaughIndex.at(i3) ||
@@ -1874,10 +1954,12 @@ struct CFFilter {
                 continue;
               }
               Q3 = getQ3(*iAntiLambda1, *iAntiLambda2, *iAntiLambda3);
-              registry.fill(HIST("lll/fSE_antiparticle"), Q3);
-              registry.fill(HIST("lll/fAntiLambdaPtVsQ3"), Q3, (*iAntiLambda1).Pt());
-              registry.fill(HIST("lll/fAntiLambdaPtVsQ3"), Q3, (*iAntiLambda2).Pt());
-              registry.fill(HIST("lll/fAntiLambdaPtVsQ3"), Q3, (*iAntiLambda3).Pt());
+              if (!pruneTriplets || Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kLLL)) {
+                registry.fill(HIST("lll/fSE_antiparticle"), Q3);
+                registry.fill(HIST("lll/fAntiLambdaPtVsQ3"), Q3, (*iAntiLambda1).Pt());
+                registry.fill(HIST("lll/fAntiLambdaPtVsQ3"), Q3, (*iAntiLambda2).Pt());
+                registry.fill(HIST("lll/fAntiLambdaPtVsQ3"), Q3, (*iAntiLambda3).Pt());
+              }
               if (Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kLLL)) {
                 if (ConfDownsample->get("Switch", "aLaLaL") > 0) {
                   if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "aLaLaL")) {
@@ -35,6 +35,7 @@
 #include "Framework/HistogramRegistry.h"
 #include "Framework/runDataProcessing.h"
 
+#include "Common/Core/CounterRng.h"
 #include "Common/Core/trackUtilities.h"
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
@@ -56,6 +57,8 @@ struct HfFilterPrepareMlSamples { // Main struct
   Configurable<bool> fillSignal{"fillSignal", true, "Flag to fill derived tables with signal for ML trainings"};
   Configurable<bool> fillBackground{"fillBackground", true, "Flag to fill derived tables with background for ML trainings"};
   Configurable<float> downSampleBkgFactor{"downSampleBkgFactor", 1., "Fraction of background candidates to keep for ML trainings"};
+  Configurable<float> ptMaxForDownSample{"ptMaxForDownSample", 10., "Maximum pt for the application of the downsampling factor"};
+  Configurable<int> downSampleSeed{"downSampleSeed", 0, "Seed of the background downsampling, drawn per candidate: 0 -> random seed"};
 
   // CCDB configuration
   o2::ccdb::CcdbApi ccdbApi;
@@ -66,6 +69,7 @@ struct HfFilterPrepareMlSamples { // Main struct
   // material correction for track propagation
   o2::base::Propagator::MatCorrType noMatCorr = o2::base::Propagator::MatCorrType::USEMatCorrNONE;
   int currentRun = 0; // needed to detect if the run changed and trigger update of calibrations etc.
+  uint64_t mDownSampleSeed = 0;
 
   void init(InitContext&)
   {
@@ -74,6 +78,25 @@ struct HfFilterPrepareMlSamples { // Main struct
     ccdb->setLocalObjectValidityChecking();
     ccdb->setCreatedNotAfter(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
     ccdbApi.init(url);
+    mDownSampleSeed = CounterRng::seedFromConfig(downSampleSeed);
+  }
+
+  /// Whether a candidate is written, decided before the propagation of the daughters and the computation of the features.
+  /// The background is downsampled below ptMaxForDownSample (pT from the daughter momenta at their PCA) with a random
+  /// number which is a hash of the seed and of the candidate, independent of the processing order
+  bool keepCandidate(bool isSignal, float ptCand, int64_t candIndex, int nProngs)
+  {
+    if (isSignal) {
+      return fillSignal;
+    }
+    if (!fillBackground) {
+      return false;
+    }
+    if (downSampleBkgFactor >= 1.f || ptCand >= ptMaxForDownSample) {
+      return true;
+    }
+    CounterRng rng(mDownSampleSeed, static_cast<uint64_t>(candIndex), nProngs);
+    return rng.uniform() < downSampleBkgFactor;
   }
 
   using BigTracksMCPID = soa::Join<aod::Tracks, aod::TracksExtra, aod::TracksDCA, aod::pidTPCFullPi, aod::pidTOFFullPi, aod::pidTPCFullKa, aod::pidTOFFullKa, aod::pidTPCFullPr, aod::pidTOFFullPr, aod::McTrackLabels>;
@@ -100,6 +123,24 @@ struct HfFilterPrepareMlSamples { // Main struct
       auto trackPos = cand2Prong.prong0_as<BigTracksMCPID>(); // positive daughter
       auto trackNeg = cand2Prong.prong1_as<BigTracksMCPID>(); // negative daughter
 
+      int8_t sign = 0;
+      int8_t flag = RecoDecay::OriginType::None;
+
+      // D0(bar) → π± K∓
+      bool isInCorrectColl{false};
+      auto indexRec = RecoDecay::getMatchedMCRec(mcParticles, std::array{trackPos, trackNeg}, o2::constants::physics::Pdg::kD0, std::array{+kPiPlus, -kKPlus}, true, &sign);
+      if (indexRec > -1) {
+        auto particle = mcParticles.rawIteratorAt(indexRec);
+        flag = RecoDecay::getCharmHadronOrigin(mcParticles, particle);
+        isInCorrectColl = (collision.mcCollisionId() == particle.mcCollisionId());
+        if (flag < RecoDecay::OriginType::Prompt) {
+          continue;
+        }
+      }
+      if (!keepCandidate(indexRec > -1, RecoDecay::pt(trackPos.pVector(), trackNeg.pVector()), cand2Prong.globalIndex(), 2)) {
+        continue;
+      }
+
       auto trackParPos = getTrackPar(trackPos);
       auto trackParNeg = getTrackPar(trackNeg);
       o2::gpu::gpustd::array<float, 2> dcaPos{trackPos.dcaXY(), trackPos.dcaZ()};
@@ -121,26 +162,8 @@ struct HfFilterPrepareMlSamples { // Main struct
       auto invMassD0 = RecoDecay::m(std::array{pVecPos, pVecNeg}, std::array{massPi, massKa});
       auto invMassD0bar = RecoDecay::m(std::array{pVecPos, pVecNeg}, std::array{massKa, massPi});
 
-      int8_t sign = 0;
-      int8_t flag = RecoDecay::OriginType::None;
-
-      // D0(bar) → π± K∓
-      bool isInCorrectColl{false};
-      auto indexRec = RecoDecay::getMatchedMCRec(mcParticles, std::array{trackPos, trackNeg}, o2::constants::physics::Pdg::kD0, std::array{+kPiPlus, -kKPlus}, true, &sign);
-      if (indexRec > -1) {
-        auto particle = mcParticles.rawIteratorAt(indexRec);
-        flag = RecoDecay::getCharmHadronOrigin(mcParticles, particle);
-        isInCorrectColl = (collision.mcCollisionId() == particle.mcCollisionId());
-        if (flag < RecoDecay::OriginType::Prompt) {
-          continue;
-        }
-      }
-
-      float pseudoRndm = trackPos.pt() * 1000. - (int64_t)(trackPos.pt() * 1000);
-      if ((fillSignal && indexRec > -1) || (fillBackground && indexRec < 0 && pseudoRndm < downSampleBkgFactor)) {
-        train2P(invMassD0, invMassD0bar, pt2Prong, trackParPos.getPt(), dcaPos[0], dcaPos[1], trackPos.tpcNSigmaPi(), trackPos.tpcNSigmaKa(), trackPos.tofNSigmaPi(), trackPos.tofNSigmaKa(),
-                trackParNeg.getPt(), dcaNeg[0], dcaNeg[1], trackNeg.tpcNSigmaPi(), trackNeg.tpcNSigmaKa(), trackNeg.tofNSigmaPi(), trackNeg.tofNSigmaKa(), flag, isInCorrectColl);
-      }
+      train2P(invMassD0, invMassD0bar, pt2Prong, trackParPos.getPt(), dcaPos[0], dcaPos[1], trackPos.tpcNSigmaPi(), trackPos.tpcNSigmaKa(), trackPos.tofNSigmaPi(), trackPos.tofNSigmaKa(),
+              trackParNeg.getPt(), dcaNeg[0], dcaNeg[1], trackNeg.tpcNSigmaPi(), trackNeg.tpcNSigmaKa(), trackNeg.tofNSigmaPi(), trackNeg.tofNSigmaKa(), flag, isInCorrectColl);
     } // end loop over 2-prong candidates
 
     for (const auto& cand3Prong : cand3Prongs) { // start loop over 3 prongs
@@ -160,6 +183,51 @@ struct HfFilterPrepareMlSamples { // Main struct
       auto trackThird = cand3Prong.prong2_as<BigTracksMCPID>();  // third daughter
       auto arrayDaughters = std::array{trackFirst, trackSecond, trackThird};
 
+      int8_t sign = 0;
+      int8_t flag = RecoDecay::OriginType::None;
+      int8_t channel = -1;
+
+      // D± → π± K∓ π±
+      auto indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, o2::constants::physics::Pdg::kDPlus, std::array{+kPiPlus, -kKPlus, +kPiPlus}, true, &sign, 2);
+      if (indexRec >= 0) {
+        channel = kDplus;
+      }
+      if (indexRec < 0) {
+        // Ds± → K± K∓ π±
+        indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, o2::constants::physics::Pdg::kDS, std::array{+kKPlus, -kKPlus, +kPiPlus}, true, &sign, 2);
+        if (indexRec >= 0) {
+          channel = kDs;
+        }
+      }
+      if (indexRec < 0) {
+        // Λc± → p± K∓ π±
+        indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, o2::constants::physics::Pdg::kLambdaCPlus, std::array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2);
+        if (indexRec >= 0) {
+          channel = kLc;
+        }
+      }
+      if (indexRec < 0) {
+        // Ξc± → p± K∓ π±
+        indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, o2::constants::physics::Pdg::kXiCPlus, std::array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2);
+        if (indexRec >= 0) {
+          channel = kXic;
+        }
+      }
+
+      bool isInCorrectColl{false};
+      if (indexRec > -1) {
+        auto particle = mcParticles.rawIteratorAt(indexRec);
+        flag = RecoDecay::getCharmHadronOrigin(mcParticles, particle);
+        isInCorrectColl = (collision.mcCollisionId() == particle.mcCollisionId());
+        if (flag < RecoDecay::OriginType::Prompt) {
+          continue;
+        }
+      }
+
+      if (!keepCandidate(indexRec > -1, RecoDecay::pt(trackFirst.pVector(), trackSecond.pVector(), trackThird.pVector()), cand3Prong.globalIndex(), 3)) {
+        continue;
+      }
+
       auto trackParFirst = getTrackPar(trackFirst);
       auto trackParSecond = getTrackPar(trackSecond);
       auto trackParThird = getTrackPar(trackThird);
@@ -202,55 +270,12 @@ struct HfFilterPrepareMlSamples { // Main struct
         deltaMassKKFirst = std::abs(RecoDecay::m(std::array{pVecFirst, pVecSecond}, std::array{massKa, massKa}) - massPhi);
         deltaMassKKSecond = std::abs(RecoDecay::m(std::array{pVecThird, pVecSecond}, std::array{massKa, massKa}) - massPhi);
       }
-      int8_t sign = 0;
-      int8_t flag = RecoDecay::OriginType::None;
-      int8_t channel = -1;
 
-      // D± → π± K∓ π±
-      auto indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, o2::constants::physics::Pdg::kDPlus, std::array{+kPiPlus, -kKPlus, +kPiPlus}, true, &sign, 2);
-      if (indexRec >= 0) {
-        channel = kDplus;
-      }
-      if (indexRec < 0) {
-        // Ds± → K± K∓ π±
-        indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, o2::constants::physics::Pdg::kDS, std::array{+kKPlus, -kKPlus, +kPiPlus}, true, &sign, 2);
-        if (indexRec >= 0) {
-          channel = kDs;
-        }
-      }
-      if (indexRec < 0) {
-        // Λc± → p± K∓ π±
-        indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, o2::constants::physics::Pdg::kLambdaCPlus, std::array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2);
-        if (indexRec >= 0) {
-          channel = kLc;
-        }
-      }
-      if (indexRec < 0) {
-        // Ξc± → p± K∓ π±
-        indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, o2::constants::physics::Pdg::kXiCPlus, std::array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2);
-        if (indexRec >= 0) {
-          channel = kXic;
-        }
-      }
-
-      bool isInCorrectColl{false};
-      if (indexRec > -1) {
-        auto particle = mcParticles.rawIteratorAt(indexRec);
-        flag = RecoDecay::getCharmHadronOrigin(mcParticles, particle);
-        isInCorrectColl = (collision.mcCollisionId() == particle.mcCollisionId());
-        if (flag < RecoDecay::OriginType::Prompt) {
-          continue;
-        }
-      }
-
-      float pseudoRndm = trackFirst.pt() * 1000. - (int64_t)(trackFirst.pt() * 1000);
-      if ((fillSignal && indexRec > -1) || (fillBackground && indexRec < 0 && pseudoRndm < downSampleBkgFactor)) {
-        train3P(invMassDplus, invMassDsToKKPi, invMassDsToPiKK, invMassLcToPKPi, invMassLcToPiKP, invMassXicToPKPi, invMassXicToPiKP, pt3Prong, deltaMassKKFirst, deltaMassKKSecond,
-                trackParFirst.getPt(), dcaFirst[0], dcaFirst[1], trackFirst.tpcNSigmaPi(), trackFirst.tpcNSigmaKa(), trackFirst.tpcNSigmaPr(), trackFirst.tofNSigmaPi(), trackFirst.tofNSigmaKa(), trackFirst.tofNSigmaPr(),
-                trackParSecond.getPt(), dcaSecond[0], dcaSecond[1], trackSecond.tpcNSigmaPi(), trackSecond.tpcNSigmaKa(), trackSecond.tpcNSigmaPr(), trackSecond.tofNSigmaPi(), trackSecond.tofNSigmaKa(), trackSecond.tofNSigmaPr(),
-                trackParThird.getPt(), dcaThird[0], dcaThird[1], trackThird.tpcNSigmaPi(), trackThird.tpcNSigmaKa(), trackThird.tpcNSigmaPr(), trackThird.tofNSigmaPi(), trackThird.tofNSigmaKa(), trackThird.tofNSigmaPr(),
-                flag, channel, cand3Prong.hfflag(), isInCorrectColl);
-      }
+      train3P(invMassDplus, invMassDsToKKPi, invMassDsToPiKK, invMassLcToPKPi, invMassLcToPiKP, invMassXicToPKPi, invMassXicToPiKP, pt3Prong, deltaMassKKFirst, deltaMassKKSecond,
+              trackParFirst.getPt(), dcaFirst[0], dcaFirst[1], trackFirst.tpcNSigmaPi(), trackFirst.tpcNSigmaKa(), trackFirst.tpcNSigmaPr(), trackFirst.tofNSigmaPi(), trackFirst.tofNSigmaKa(), trackFirst.tofNSigmaPr(),
+              trackParSecond.getPt(), dcaSecond[0], dcaSecond[1], trackSecond.tpcNSigmaPi(), trackSecond.tpcNSigmaKa(), trackSecond.tpcNSigmaPr(), trackSecond.tofNSigmaPi(), trackSecond.tofNSigmaKa(), trackSecond.tofNSigmaPr(),
+              trackParThird.getPt(), dcaThird[0], dcaThird[1], trackThird.tpcNSigmaPi(), trackThird.tpcNSigmaKa(), trackThird.tpcNSigmaPr(), trackThird.tofNSigmaPi(), trackThird.tofNSigmaKa(), trackThird.tofNSigmaPr(),
+              flag, channel, cand3Prong.hfflag(), isInCorrectColl);
     } // end loop over 3-prong candidates
   }
 };
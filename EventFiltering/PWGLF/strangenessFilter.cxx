@@ -516,9 +516,13 @@ struct strangenessFilter {
       if (casc.cascradius() < cascradius) {
         continue;
       }
-      if (casc.v0cosPA(collision.posX(), collision.posY(), collision.posZ()) < v0cospa) {
+      // pointing angles and DCA to the primary vertex of the builder output, evaluated once per candidate
+      const float v0CosPA = casc.v0cosPA(collision.posX(), collision.posY(), collision.posZ());
+      if (v0CosPA < v0cospa) {
         continue;
       }
+      const float cascCosPA = casc.casccosPA(collision.posX(), collision.posY(), collision.posZ());
+      const float dcaV0ToPV = casc.dcav0topv(collision.posX(), collision.posY(), collision.posZ());
       if (casc.dcaV0daughters() > dcav0dau) {
         continue;
       }
@@ -533,8 +537,8 @@ struct strangenessFilter {
       }
 
       isXi = (TMath::Abs(bachelor.tpcNSigmaPi()) < nsigmatpcpi) &&
-             (casc.casccosPA(collision.posX(), collision.posY(), collision.posZ()) > casccospaxi) &&
-             (casc.dcav0topv(collision.posX(), collision.posY(), collision.posZ()) > dcav0topv) &&
+             (cascCosPA > casccospaxi) &&
+             (dcaV0ToPV > dcav0topv) &&
              (TMath::Abs(casc.mXi() - o2::constants::physics::MassXiMinus) < ximasswindow) &&
              (TMath::Abs(casc.mOmega() - o2::constants::physics::MassOmegaMinus) > omegarej) &&
              (xiproperlifetime < properlifetimefactor * ctauxi) &&
@@ -546,16 +550,16 @@ struct strangenessFilter {
                (xiproperlifetime < properlifetimefactor * ctauxi) &&
                (TMath::Abs(casc.yXi()) < rapidity); // add PID on bachelor
       isOmega = (TMath::Abs(bachelor.tpcNSigmaKa()) < nsigmatpcka) &&
-                (casc.casccosPA(collision.posX(), collision.posY(), collision.posZ()) > casccospaomega) &&
-                (casc.dcav0topv(collision.posX(), collision.posY(), collision.posZ()) > dcav0topv) &&
+                (cascCosPA > casccospaomega) &&
+                (dcaV0ToPV > dcav0topv) &&
                 (casc.cascradius() < upperradiusOmega) &&
                 (TMath::Abs(casc.mOmega() - o2::constants::physics::MassOmegaMinus) < omegamasswindow) &&
                 (TMath::Abs(casc.mXi() - o2::constants::physics::MassXiMinus) > xirej) &&
                 (omegaproperlifetime < properlifetimefactor * ctauomega) &&
                 (TMath::Abs(casc.yOmega()) < rapidity); // add PID on bachelor
       isOmegalargeR = (TMath::Abs(bachelor.tpcNSigmaKa()) < nsigmatpcka) &&
-                      (casc.casccosPA(collision.posX(), collision.posY(), collision.posZ()) > casccospaomega) &&
-                      (casc.dcav0topv(collision.posX(), collision.posY(), collision.posZ()) > dcav0topv) &&
+                      (cascCosPA > casccospaomega) &&
+                      (dcaV0ToPV > dcav0topv) &&
                       (casc.cascradius() > lowerradiusOmega) &&
                       (TMath::Abs(casc.mOmega() - o2::constants::physics::MassOmegaMinus) < omegamasswindow) &&
                       (TMath::Abs(casc.mXi() - o2::constants::physics::MassXiMinus) > xirej) &&
@@ -600,6 +604,7 @@ struct strangenessFilter {
         }
         // triggcounter++;
         keepEvent[1] = true;
+        break;
       } // end loop over tracks
     }
 
@@ -713,6 +718,7 @@ struct strangenessFilter {
     int triggcounter = 0;
     int triggcounterAllEv = 0;
     int triggcounterForEstimates = 0;
+    int hasTriggerTrack = -1; // whether the event has a selected track, -1 until it is needed
 
     for (auto& casc : fullCasc) { // loop over cascades
       triggcounterForEstimates = 0;
@@ -797,9 +803,13 @@ struct strangenessFilter {
         continue;
       }
       hCandidate->Fill(9.5);
-      if (casc.v0cosPA(collision.posX(), collision.posY(), collision.posZ()) < v0cospa) {
+      // pointing angles and DCA to the primary vertex of the builder output, evaluated once per candidate
+      const float v0CosPA = casc.v0cosPA(collision.posX(), collision.posY(), collision.posZ());
+      if (v0CosPA < v0cospa) {
         continue;
       }
+      const float cascCosPA = casc.casccosPA(collision.posX(), collision.posY(), collision.posZ());
+      const float dcaV0ToPV = casc.dcav0topv(collision.posX(), collision.posY(), collision.posZ());
       hCandidate->Fill(10.5);
       if (casc.dcaV0daughters() > dcav0dau) {
         continue;
@@ -826,9 +836,9 @@ struct strangenessFilter {
       hCandidate->Fill(15.5);
 
       // Fill selections QA for XiMinus
-      if (casc.casccosPA(collision.posX(), collision.posY(), collision.posZ()) > casccospaxi) {
+      if (cascCosPA > casccospaxi) {
         hCandidate->Fill(16.5);
-        if (casc.dcav0topv(collision.posX(), collision.posY(), collision.posZ()) > dcav0topv) {
+        if (dcaV0ToPV > dcav0topv) {
           hCandidate->Fill(17.5);
           if (xiproperlifetime < properlifetimefactor * ctauxi) {
             hCandidate->Fill(18.5);
@@ -842,8 +852,8 @@ struct strangenessFilter {
       const auto deltaMassXi = useSigmaBasedMassCutXi ? getMassWindow(stfilter::species::Xi, casc.pt()) : ximasswindow;
       const auto deltaMassOmega = useSigmaBasedMassCutOmega ? getMassWindow(stfilter::species::Omega, casc.pt()) : omegamasswindow;
       isXi = (TMath::Abs(bachelor.tpcNSigmaPi()) < nsigmatpcpi) &&
-             (casc.casccosPA(collision.posX(), collision.posY(), collision.posZ()) > casccospaxi) &&
-             (casc.dcav0topv(collision.posX(), collision.posY(), collision.posZ()) > dcav0topv) &&
+             (cascCosPA > casccospaxi) &&
+             (dcaV0ToPV > dcav0topv) &&
              (TMath::Abs(casc.mXi() - o2::constants::physics::MassXiMinus) < deltaMassXi) &&
              (TMath::Abs(casc.mOmega() - o2::constants::physics::MassOmegaMinus) > omegarej) &&
              (xiproperlifetime < properlifetimefactor * ctauxi) &&
@@ -855,16 +865,16 @@ struct strangenessFilter {
                (xiproperlifetime < properlifetimefactor * ctauxi) &&
                (TMath::Abs(casc.yXi()) < rapidity);
       isOmega = (TMath::Abs(bachelor.tpcNSigmaKa()) < nsigmatpcka) &&
-                (casc.casccosPA(collision.posX(), collision.posY(), collision.posZ()) > casccospaomega) &&
-                (casc.dcav0topv(collision.posX(), collision.posY(), collision.posZ()) > dcav0topv) &&
+                (cascCosPA > casccospaomega) &&
+                (dcaV0ToPV > dcav0topv) &&
                 (TMath::Abs(casc.mOmega() - o2::constants::physics::MassOmegaMinus) < deltaMassOmega) &&
                 (TMath::Abs(casc.mXi() - o2::constants::physics::MassXiMinus) > xirej) &&
                 (casc.cascradius() < upperradiusOmega) &&
                 (omegaproperlifetime < properlifetimefactor * ctauomega) &&
                 (TMath::Abs(casc.yOmega()) < rapidity);
       isOmegalargeR = (TMath::Abs(bachelor.tpcNSigmaKa()) < nsigmatpcka) &&
-                      (casc.casccosPA(collision.posX(), collision.posY(), collision.posZ()) > casccospaomega) &&
-                      (casc.dcav0topv(collision.posX(), collision.posY(), collision.posZ()) > dcav0topv) &&
+                      (cascCosPA > casccospaomega) &&
+                      (dcaV0ToPV > dcav0topv) &&
                       (casc.cascradius() > lowerradiusOmega) &&
                       (TMath::Abs(casc.mOmega() - o2::constants::physics::MassOmegaMinus) < deltaMassOmega) &&
                       (TMath::Abs(casc.mXi() - o2::constants::physics::MassXiMinus) > xirej) &&
@@ -876,11 +886,11 @@ struct strangenessFilter {
         QAHistos.fill(HIST("hPtXi"), casc.pt());
         QAHistos.fill(HIST("hEtaXi"), casc.eta());
         QAHistosTopologicalVariables.fill(HIST("hProperLifetimeXi"), xiproperlifetime);
-        QAHistosTopologicalVariables.fill(HIST("hCascCosPAXi"), casc.casccosPA(collision.posX(), collision.posY(), collision.posZ()));
-        QAHistosTopologicalVariables.fill(HIST("hV0CosPAXi"), casc.v0cosPA(collision.posX(), collision.posY(), collision.posZ()));
+        QAHistosTopologicalVariables.fill(HIST("hCascCosPAXi"), cascCosPA);
+        QAHistosTopologicalVariables.fill(HIST("hV0CosPAXi"), v0CosPA);
         QAHistosTopologicalVariables.fill(HIST("hCascRadiusXi"), casc.cascradius());
         QAHistosTopologicalVariables.fill(HIST("hV0RadiusXi"), casc.v0radius());
-        QAHistosTopologicalVariables.fill(HIST("hDCAV0ToPVXi"), casc.dcav0topv(collision.posX(), collision.posY(), collision.posZ()));
+        QAHistosTopologicalVariables.fill(HIST("hDCAV0ToPVXi"), dcaV0ToPV);
         QAHistosTopologicalVariables.fill(HIST("hDCAV0DaughtersXi"), casc.dcaV0daughters());
         QAHistosTopologicalVariables.fill(HIST("hDCACascDaughtersXi"), casc.dcacascdaughters());
         QAHistosTopologicalVariables.fill(HIST("hDCABachToPVXi"), TMath::Abs(casc.dcabachtopv()));
@@ -912,14 +922,17 @@ struct strangenessFilter {
         xicounter++;
 
         // Plot for estimates
-        for (auto track : tracks) { // start loop over tracks
-          if (isTrackFilter && !mTrackSelector.IsSelected(track)) {
-            continue;
-          }
-          triggcounterForEstimates++;
-          if (triggcounterForEstimates > 0)
+        if (hasTriggerTrack < 0) { // search of a selected track, once per event
+          hasTriggerTrack = 0;
+          for (auto track : tracks) { // start loop over tracks
+            if (isTrackFilter && !mTrackSelector.IsSelected(track)) {
+              continue;
+            }
+            hasTriggerTrack = 1;
             break;
+          }
         }
+        triggcounterForEstimates = hasTriggerTrack;
         if (triggcounterForEstimates && (TMath::Abs(casc.mXi() - o2::constants::physics::MassXiMinus) < 0.01))
           hhXiPairsvsPt->Fill(casc.pt()); // Fill the histogram with all the Xis produced in events with a trigger particle
         // End plot for estimates
@@ -934,11 +947,11 @@ struct strangenessFilter {
         QAHistos.fill(HIST("hPtOmega"), casc.pt());
         QAHistos.fill(HIST("hEtaOmega"), casc.eta());
         QAHistosTopologicalVariables.fill(HIST("hProperLifetimeOmega"), omegaproperlifetime);
-        QAHistosTopologicalVariables.fill(HIST("hCascCosPAOmega"), casc.casccosPA(collision.posX(), collision.posY(), collision.posZ()));
-        QAHistosTopologicalVariables.fill(HIST("hV0CosPAOmega"), casc.v0cosPA(collision.posX(), collision.posY(), collision.posZ()));
+        QAHistosTopologicalVariables.fill(HIST("hCascCosPAOmega"), cascCosPA);
+        QAHistosTopologicalVariables.fill(HIST("hV0CosPAOmega"), v0CosPA);
         QAHistosTopologicalVariables.fill(HIST("hCascRadiusOmega"), casc.cascradius());
         QAHistosTopologicalVariables.fill(HIST("hV0RadiusOmega"), casc.v0radius());
-        QAHistosTopologicalVariables.fill(HIST("hDCAV0ToPVOmega"), casc.dcav0topv(collision.posX(), collision.posY(), collision.posZ()));
+        QAHistosTopologicalVariables.fill(HIST("hDCAV0ToPVOmega"), dcaV0ToPV);
         QAHistosTopologicalVariables.fill(HIST("hDCAV0DaughtersOmega"), casc.dcaV0daughters());
         QAHistosTopologicalVariables.fill(HIST("hDCACascDaughtersOmega"), casc.dcacascdaughters());
         QAHistosTopologicalVariables.fill(HIST("hDCABachToPVOmega"), TMath::Abs(casc.dcabachtopv()));
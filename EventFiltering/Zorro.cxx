@@ -12,89 +12,241 @@
 
 #include "Zorro.h"
 
+#include <algorithm>
+#include <chrono>
 #include <map>
+#include <numeric>
 
 #include "TH1D.h"
 
 #include "CCDB/BasicCCDBManager.h"
-#include "CommonDataFormat/InteractionRecord.h"
+#include "CCDB/CcdbApi.h"
+#include "Framework/Logger.h"
 
-using o2::InteractionRecord;
+Zorro::Zorro() = default;
 
-std::vector<int> Zorro::initCCDB(o2::ccdb::BasicCCDBManager* ccdb, int runNumber, uint64_t timestamp, std::string tois, int bcRange)
+Zorro::~Zorro()
 {
-  if (mRunNumber == runNumber) {
-    return mTOIidx;
+  if (mPrefetched.valid()) {
+    mPrefetched.wait();
   }
-  mCCDB = ccdb;
-  mRunNumber = runNumber;
-  mBCtolerance = bcRange;
+}
+
+std::shared_ptr<Zorro::RunInfo> Zorro::fetchRun(o2::ccdb::CcdbApi const& api, std::string const& basePath, int runNumber, uint64_t timestamp)
+{
+  auto run = std::make_shared<RunInfo>();
+  run->runNumber = runNumber;
   std::map<std::string, std::string> metadata;
   metadata["runNumber"] = std::to_string(runNumber);
-  mScalers = mCCDB->getSpecific<TH1D>(mBaseCCDBPath + "FilterCounters", timestamp, metadata);
-  mSelections = mCCDB->getSpecific<TH1D>(mBaseCCDBPath + "SelectionCounters", timestamp, metadata);
-  mInspectedTVX = mCCDB->getSpecific<TH1D>(mBaseCCDBPath + "InspectedTVX", timestamp, metadata);
-  auto selectedBCs = mCCDB->getSpecific<std::vector<std::array<uint64_t, 2>>>(mBaseCCDBPath + "SelectedBCs", timestamp, metadata);
-  mBCranges.clear();
-  for (auto bc : *selectedBCs) {
-    mBCranges.emplace_back(InteractionRecord::long2IR(std::min(bc[0], bc[1])), InteractionRecord::long2IR(std::max(bc[0], bc[1])));
+  run->scalers.reset(api.retrieveFromTFileAny<TH1D>(basePath + "FilterCounters", metadata, timestamp));
+  run->selections.reset(api.retrieveFromTFileAny<TH1D>(basePath + "SelectionCounters", metadata, timestamp));
+  run->inspectedTVX.reset(api.retrieveFromTFileAny<TH1D>(basePath + "InspectedTVX", metadata, timestamp));
+  std::unique_ptr<std::vector<std::array<uint64_t, 2>>> selectedBCs{api.retrieveFromTFileAny<std::vector<std::array<uint64_t, 2>>>(basePath + "SelectedBCs", metadata, timestamp)};
+  run->selectionBitMask.reset(api.retrieveFromTFileAny<std::vector<std::array<uint64_t, 2>>>(basePath + "SelectionBitMask", metadata, timestamp));
+  run->filterBitMask.reset(api.retrieveFromTFileAny<std::vector<std::array<uint64_t, 2>>>(basePath + "FilterBitMask", metadata, timestamp));
+  if (!selectedBCs || !run->filterBitMask) {
+    LOGF(fatal, "Selected BCs or filter bit masks not available in %s for run %d", basePath.c_str(), runNumber);
   }
-  std::sort(mBCranges.begin(), mBCranges.end(), [](const auto& a, const auto& b) { return a.getMin() < b.getMin(); });
 
-  mSelectionBitMask = mCCDB->getSpecific<std::vector<std::array<uint64_t, 2>>>(mBaseCCDBPath + "SelectionBitMask", timestamp, metadata);
-  mFilterBitMask = mCCDB->getSpecific<std::vector<std::array<uint64_t, 2>>>(mBaseCCDBPath + "FilterBitMask", timestamp, metadata);
+  /// Flat BC ranges sorted by their first BC, each with the filter bit mask of the same entry
+  std::vector<size_t> order(selectedBCs->size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&selectedBCs](size_t a, size_t b) { return std::min((*selectedBCs)[a][0], (*selectedBCs)[a][1]) < std::min((*selectedBCs)[b][0], (*selectedBCs)[b][1]); });
+  run->bcMin.reserve(order.size());
+  run->bcMaxPrefix.reserve(order.size());
+  run->bcMasks.reserve(order.size());
+  uint64_t bcMaxPrefix = 0;
+  for (auto idx : order) {
+    const auto& bc = (*selectedBCs)[idx];
+    bcMaxPrefix = std::max(bcMaxPrefix, std::max(bc[0], bc[1]));
+    run->bcMin.push_back(std::min(bc[0], bc[1]));
+    run->bcMaxPrefix.push_back(bcMaxPrefix);
+    run->bcMasks.push_back(run->filterBitMask->at(idx));
+  }
+  return run;
+}
 
-  mLastBCglobalId = 0;
-  mLastSelectedIdx = 0;
+void Zorro::parseTOIs(std::string const& tois)
+{
+  if (tois == mTOIstring && !mTOIs.empty()) {
+    return;
+  }
+  mTOIstring = tois;
   mTOIs.clear();
-  mTOIidx.clear();
-  size_t pos = 0;
-  while ((pos = tois.find(",")) != std::string::npos) {
-    std::string token = tois.substr(0, pos);
+  size_t start = 0;
+  while (start <= tois.size()) {
+    size_t end = tois.find(',', start);
+    if (end == std::string::npos) {
+      end = tois.size();
+    }
     // Trim leading and trailing whitespaces from the token
-    token.erase(0, token.find_first_not_of(" "));
-    token.erase(token.find_last_not_of(" ") + 1);
-    int bin = mScalers->GetXaxis()->FindBin(token.c_str()) - 2;
-    mTOIs.push_back(token);
-    mTOIidx.push_back(bin);
-    tois.erase(0, pos + 1);
+    size_t first = tois.find_first_not_of(' ', start);
+    if (first != std::string::npos && first < end) {
+      size_t last = tois.find_last_not_of(' ', end - 1);
+      mTOIs.push_back(tois.substr(first, last - first + 1));
+    }
+    start = end + 1;
   }
   mTOIcounts.resize(mTOIs.size(), 0);
+  for (auto& run : mRunCache) {
+    run->toiResolved = false;
+  }
+}
+
+void Zorro::resolveTOIs(RunInfo& run) const
+{
+  run.toiIdx.clear();
+  run.toiMask = {0ull, 0ull};
+  if (!mTOIs.empty() && !run.scalers) {
+    LOGF(fatal, "Filter counters not available in %s for run %d", mBaseCCDBPath.c_str(), run.runNumber);
+  }
+  for (auto const& toi : mTOIs) {
+    int bin = run.scalers->GetXaxis()->FindBin(toi.c_str()) - 2;
+    run.toiIdx.push_back(bin);
+    if (bin >= 0 && bin < 128) {
+      run.toiMask[bin / 64] |= 1ull << (bin % 64);
+    }
+  }
+  run.toiResolved = true;
+}
+
+std::vector<int> Zorro::initCCDB(o2::ccdb::BasicCCDBManager* ccdb, int runNumber, uint64_t timestamp, std::string tois, int bcRange)
+{
+  parseTOIs(tois);
+  if (mRunNumber == runNumber && mRun && mRun->toiResolved) {
+    return mTOIidx;
+  }
+  mCCDB = ccdb;
+  mRunNumber = runNumber;
+  mBCtolerance = bcRange;
+
+  auto cached = std::find_if(mRunCache.begin(), mRunCache.end(), [runNumber](auto const& run) { return run->runNumber == runNumber; });
+  if (cached != mRunCache.end()) {
+    mRun = *cached;
+    mRunCache.erase(cached);
+  } else if (mPrefetched.valid() && mPrefetchedRunNumber == runNumber) {
+    mRun = mPrefetched.get();
+    mPrefetchedRunNumber = -1;
+    LOGF(info, "Using the trigger objects of run %d downloaded in the background", runNumber);
+  } else {
+    mRun = fetchRun(mCCDB->getCCDBAccessor(), mBaseCCDBPath, runNumber, timestamp);
+  }
+  mRunCache.push_front(mRun);
+  while (mRunCache.size() > std::max<size_t>(mRunCacheSize, 1)) {
+    mRunCache.pop_back();
+  }
+  if (!mRun->toiResolved) {
+    resolveTOIs(*mRun);
+  }
+
+  mScalers = mRun->scalers.get();
+  mSelections = mRun->selections.get();
+  mInspectedTVX = mRun->inspectedTVX.get();
+  mSelectionBitMask = mRun->selectionBitMask.get();
+  mFilterBitMask = mRun->filterBitMask.get();
+  mTOIidx = mRun->toiIdx;
+  mLastBCglobalId = 0;
+  mLastSelectedIdx = 0;
+  mCursor = 0;
   return mTOIidx;
 }
 
+bool Zorro::prefetch(int runNumber, uint64_t timestamp)
+{
+  if (!mCCDB || runNumber == mRunNumber || runNumber == mPrefetchedRunNumber) {
+    return false;
+  }
+  if (std::any_of(mRunCache.begin(), mRunCache.end(), [runNumber](auto const& run) { return run->runNumber == runNumber; })) {
+    return false;
+  }
+  if (mPrefetched.valid() && mPrefetched.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+    return false;
+  }
+  if (!mAsyncApi) {
+    mAsyncApi = std::make_unique<o2::ccdb::CcdbApi>();
+    mAsyncApi->init(mCCDB->getURL());
+  }
+  mPrefetchedRunNumber = runNumber;
+  mPrefetched = std::async(std::launch::async, [api = mAsyncApi.get(), basePath = mBaseCCDBPath, runNumber, timestamp]() {
+    return fetchRun(*api, basePath, runNumber, timestamp);
+  });
+  LOGF(info, "Downloading the trigger objects of run %d in the background", runNumber);
+  return true;
+}
+
+int Zorro::findRange(uint64_t bcGlobalId, uint64_t tolerance)
+{
+  /// A range [min, max] is selected if it overlaps with [bc - tolerance, bc + tolerance].
+  /// The running maximum of the range ends is sorted, so the first range ending after bc - tolerance is found by binary search,
+  /// galloping from the position of the previous call when it is still valid (BCs in increasing order).
+  if (!mRun) {
+    return -1;
+  }
+  const uint64_t bcLow = bcGlobalId > tolerance ? bcGlobalId - tolerance : 0;
+  const uint64_t bcHigh = bcGlobalId + tolerance;
+  const size_t nRanges = mRun->bcMaxPrefix.size();
+  size_t first = 0;
+  size_t last = nRanges;
+  if (mCursor <= nRanges && (mCursor == 0 || mRun->bcMaxPrefix[mCursor - 1] < bcLow)) {
+    first = mCursor;
+    size_t probe = first;
+    size_t step = 1;
+    while (probe < nRanges && mRun->bcMaxPrefix[probe] < bcLow) {
+      first = probe + 1;
+      probe = first + step;
+      step *= 2;
+    }
+    last = std::min(probe + 1, nRanges);
+  }
+  const size_t pos = std::lower_bound(mRun->bcMaxPrefix.begin() + first, mRun->bcMaxPrefix.begin() + last, bcLow) - mRun->bcMaxPrefix.begin();
+  mCursor = pos;
+  mLastBCglobalId = bcGlobalId;
+  if (pos == nRanges || mRun->bcMin[pos] > bcHigh) {
+    return -1;
+  }
+  return pos;
+}
+
 std::bitset<128> Zorro::fetch(uint64_t bcGlobalId, uint64_t tolerance)
 {
   std::bitset<128> result;
-  o2::dataformats::IRFrame bcFrame{InteractionRecord::long2IR(bcGlobalId) - tolerance, InteractionRecord::long2IR(bcGlobalId) + tolerance};
-  if (bcGlobalId < mLastBCglobalId) {
-    mLastSelectedIdx = 0;
-  }
-  for (size_t i = mLastSelectedIdx; i < mBCranges.size(); i++) {
-    if (!bcFrame.getOverlap(mBCranges[i]).isZeroLength()) {
-      for (int iMask{0}; iMask < 2; ++iMask) {
-        for (int iTOI{0}; iTOI < 64; ++iTOI) {
-          result.set(iMask * 64 + iTOI, mFilterBitMask->at(i)[iMask] & (1ull << iTOI));
-        }
-      }
-      mLastSelectedIdx = i;
-      return result;
-    }
+  int idx = findRange(bcGlobalId, tolerance);
+  if (idx >= 0) {
+    const auto& mask = mRun->bcMasks[idx];
+    result = (std::bitset<128>(mask[1]) << 64) | std::bitset<128>(mask[0]);
+    mLastSelectedIdx = idx;
   }
   return result;
 }
 
 bool Zorro::isSelected(uint64_t bcGlobalId, uint64_t tolerance)
 {
-  int lastSelectedIdx = mLastSelectedIdx;
-  std::bitset<128> result = fetch(bcGlobalId, tolerance);
+  uint64_t lastSelectedIdx = mLastSelectedIdx;
+  int idx = findRange(bcGlobalId, tolerance);
+  if (idx < 0) {
+    return false;
+  }
+  mLastSelectedIdx = idx;
+  const auto& mask = mRun->bcMasks[idx];
+  if (((mask[0] & mRun->toiMask[0]) | (mask[1] & mRun->toiMask[1])) == 0) {
+    return false;
+  }
   for (size_t i{0}; i < mTOIidx.size(); ++i) {
-    if (mTOIidx[i] < 0) {
+    if (mTOIidx[i] < 0 || mTOIidx[i] >= 128) {
       continue;
-    } else if (result.test(mTOIidx[i])) {
+    } else if (mask[mTOIidx[i] / 64] & (1ull << (mTOIidx[i] % 64))) {
       mTOIcounts[i] += (lastSelectedIdx != mLastSelectedIdx); /// Avoid double counting
       return true;
     }
   }
   return false;
-}
\ No newline at end of file
+}
+
+std::vector<bool> Zorro::selectAll(gsl::span<const uint64_t> bcGlobalIds, uint64_t tolerance)
+{
+  std::vector<bool> selection(bcGlobalIds.size());
+  for (size_t i{0}; i < bcGlobalIds.size(); ++i) {
+    selection[i] = isSelected(bcGlobalIds[i], tolerance);
+  }
+  return selection;
+}
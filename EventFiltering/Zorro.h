@@ -14,11 +14,16 @@
 #ifndef EVENTFILTERING_ZORRO_H_
 #define EVENTFILTERING_ZORRO_H_
 
+#include <array>
 #include <bitset>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <memory>
 #include <string>
 #include <vector>
 
-#include "CommonDataFormat/IRFrame.h"
+#include <gsl/span>
 
 class TH1D;
 namespace o2
@@ -26,39 +31,91 @@ namespace o2
 namespace ccdb
 {
 class BasicCCDBManager;
+class CcdbApi;
 };
 }; // namespace o2
 
 class Zorro
 {
  public:
-  Zorro() = default;
+  Zorro();
+  ~Zorro();
   std::vector<int> initCCDB(o2::ccdb::BasicCCDBManager* ccdb, int runNumber, uint64_t timestamp, std::string tois, int bcTolerance = 500);
   std::bitset<128> fetch(uint64_t bcGlobalId, uint64_t tolerance = 100);
   bool isSelected(uint64_t bcGlobalId, uint64_t tolerance = 100);
+  /// Selection of a whole BC table (e.g. the global BCs of the collisions of a dataframe), with the TOI accounting of isSelected
+  std::vector<bool> selectAll(gsl::span<const uint64_t> bcGlobalIds, uint64_t tolerance = 100);
+
+  /// Starts downloading the trigger objects of another run in a background thread, they are used by the initCCDB of that run.
+  /// Requires a previous call to initCCDB. Returns false if the run is already cached or a background download is pending.
+  bool prefetch(int runNumber, uint64_t timestamp);
+  /// Prefetches the run of the last BC of the table if it is not the current one (merged datasets)
+  template <typename TBCs>
+  void lookAhead(TBCs const& bcs)
+  {
+    if (bcs.size() == 0) {
+      return;
+    }
+    auto lastBC = bcs.iteratorAt(bcs.size() - 1);
+    if (lastBC.runNumber() != mRunNumber) {
+      prefetch(lastBC.runNumber(), lastBC.timestamp());
+    }
+  }
 
   std::vector<int> getTOIcounters() const { return mTOIcounts; }
 
   void setCCDBpath(std::string path) { mBaseCCDBPath = path; }
   void setBaseCCDBPath(std::string path) { mBaseCCDBPath = path; }
   void setBCtolerance(int tolerance) { mBCtolerance = tolerance; }
+  void setRunCacheSize(size_t size) { mRunCacheSize = size; }
 
  private:
+  /// Trigger objects of one run, with the flattened BC ranges
+  struct RunInfo {
+    int runNumber = 0;
+    std::shared_ptr<TH1D> scalers;
+    std::shared_ptr<TH1D> selections;
+    std::shared_ptr<TH1D> inspectedTVX;
+    std::shared_ptr<std::vector<std::array<uint64_t, 2>>> filterBitMask;
+    std::shared_ptr<std::vector<std::array<uint64_t, 2>>> selectionBitMask;
+    std::vector<uint64_t> bcMin;                  // first BC of the selected ranges, sorted
+    std::vector<uint64_t> bcMaxPrefix;            // running maximum of the last BC of the ranges, in the order of bcMin
+    std::vector<std::array<uint64_t, 2>> bcMasks; // filter bit masks of the ranges, in the order of bcMin
+    std::vector<int> toiIdx;                      // bins of mTOIs in the scalers, resolved once per run
+    std::array<uint64_t, 2> toiMask = {0ull, 0ull};
+    bool toiResolved = false;
+  };
+
+  static std::shared_ptr<RunInfo> fetchRun(o2::ccdb::CcdbApi const& api, std::string const& basePath, int runNumber, uint64_t timestamp);
+  void parseTOIs(std::string const& tois);
+  void resolveTOIs(RunInfo& run) const;
+  int findRange(uint64_t bcGlobalId, uint64_t tolerance);
+
   std::string mBaseCCDBPath = "Users/m/mpuccio/EventFiltering/OTS/";
   int mRunNumber = 0;
   int mBCtolerance = 100;
   uint64_t mLastBCglobalId = 0;
   uint64_t mLastSelectedIdx = 0;
+  size_t mCursor = 0; // position of the last search in the BC ranges, for the monotonic access
   TH1D* mScalers = nullptr;
   TH1D* mSelections = nullptr;
   TH1D* mInspectedTVX = nullptr;
-  std::vector<o2::dataformats::IRFrame> mBCranges;
+  std::shared_ptr<RunInfo> mRun; // trigger objects of the current run
   std::vector<std::array<uint64_t, 2>>* mFilterBitMask = nullptr;
   std::vector<std::array<uint64_t, 2>>* mSelectionBitMask = nullptr;
+  std::string mTOIstring;
   std::vector<std::string> mTOIs;
   std::vector<int> mTOIidx;
   std::vector<int> mTOIcounts;
   o2::ccdb::BasicCCDBManager* mCCDB = nullptr;
+
+  // trigger objects of the recently used runs, most recent first
+  std::list<std::shared_ptr<RunInfo>> mRunCache;
+  size_t mRunCacheSize = 16;
+  // background download of another run, with its own API instance to stay independent of the manager
+  std::unique_ptr<o2::ccdb::CcdbApi> mAsyncApi;
+  int mPrefetchedRunNumber = -1;
+  std::future<std::shared_ptr<RunInfo>> mPrefetched;
 };
 
 #endif // EVENTFILTERING_ZORRO_H_
\ No newline at end of file
@@ -14,9 +14,10 @@
 #include <rapidjson/document.h>
 #include <rapidjson/filereadstream.h>
 
+#include <algorithm>
 #include <iostream>
 #include <cstdio>
-#include <random>
+#include <cstring>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -69,6 +70,16 @@ bool readJsonFile(std::string& config, Document& d)
 }
 
 std::unordered_map<std::string, std::unordered_map<std::string, float>> mDownscaling;
+
+/// Counter-based random number (splitmix64 finaliser): the same key always gives the same number,
+/// so that the downscaling of an event does not depend on the processing order
+inline uint64_t counterRandom(uint64_t key)
+{
+  key += 0x9e3779b97f4a7c15ull;
+  key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ull;
+  key = (key ^ (key >> 27)) * 0x94d049bb133111ebull;
+  return key ^ (key >> 31);
+}
 static const std::vector<std::string> downscalingName{"Downscaling"};
 static const float defaultDownscaling[128][1]{
   {1.f},
@@ -225,6 +236,24 @@ struct centralEventFilterTask {
   FILTER_CONFIGURABLE(FullJetFilters);
   FILTER_CONFIGURABLE(PhotonFilters);
 
+  Configurable<uint64_t> cfgDownscalingSeed{"cfgDownscalingSeed", 0, "Seed of the random numbers used for the downscaling"};
+
+  /// Trigger channel, compiled at init from the downscaling configuration
+  struct FilterChannel {
+    std::string name;
+    int scalerBin{0};      // bin of the channel in the scaler histograms
+    int bitIndex{0};       // position of the channel in the 128-bit decision
+    uint64_t threshold{0}; // the event is kept if the 53-bit random number is below the threshold (downscaling * 2^53)
+    int columnIndex{-1};   // index of the column in the filter table, -1 if the column is missing
+  };
+  struct FilterTable {
+    std::string name;
+    std::vector<FilterChannel> channels;
+    bool columnsResolved{false};
+  };
+  std::vector<FilterTable> mFilterTables;
+  std::vector<uint64_t> mEventKeys; // random-number key of each event of the timeframe
+
   void init(o2::framework::InitContext& initc)
   {
     LOG(debug) << "Start init";
@@ -261,6 +290,23 @@ struct centralEventFilterTask {
         col.second = filterOpt.get(col.first.data(), 0u);
       }
     }
+
+    // flat list of the channels, in the order of the scaler bins
+    bin = 2;
+    mFilterTables.clear();
+    for (auto& table : mDownscaling) {
+      auto& filterTable = mFilterTables.emplace_back();
+      filterTable.name = table.first;
+      for (auto& column : table.second) {
+        auto& channel = filterTable.channels.emplace_back();
+        channel.name = column.first;
+        channel.scalerBin = bin;
+        channel.bitIndex = bin - 2;
+        const double downscaling = std::clamp(static_cast<double>(column.second), 0., 1.);
+        channel.threshold = static_cast<uint64_t>(downscaling * static_cast<double>(1ull << 53));
+        bin++;
+      }
+    }
   }
 
   void run(ProcessingContext& pc)
@@ -303,49 +349,63 @@ struct centralEventFilterTask {
     auto mCovariance{scalers.get<TH2>(HIST("mCovariance"))};
 
     int64_t nEvents{collTabPtr->num_rows()};
-    std::vector<std::array<uint64_t, 2>> outTrigger, outDecision;
-    for (auto& tableName : mDownscaling) {
-      if (!pc.inputs().isValid(tableName.first)) {
-        LOG(fatal) << tableName.first << " table is not valid.";
+    std::vector<std::array<uint64_t, 2>> outTrigger(nEvents, {0ull, 0ull}), outDecision(nEvents, {0ull, 0ull});
+
+    // random-number key of each event, from its global BC and collision time
+    mEventKeys.resize(nEvents);
+    for (int64_t iE{0}; iE < nEvents; ++iE) {
+      const float collTime = CollTimeArray->Value(iE);
+      uint32_t collTimeBits;
+      std::memcpy(&collTimeBits, &collTime, sizeof(collTimeBits));
+      mEventKeys[iE] = counterRandom(cfgDownscalingSeed.value ^ GloBCArray->Value(CollBCIdArray->Value(iE))) ^ collTimeBits;
+    }
+
+    for (auto& filterTable : mFilterTables) {
+      if (!pc.inputs().isValid(filterTable.name)) {
+        LOG(fatal) << filterTable.name << " table is not valid.";
       }
-      auto tableConsumer = pc.inputs().get<TableConsumer>(tableName.first);
+      auto tableConsumer = pc.inputs().get<TableConsumer>(filterTable.name);
       auto tablePtr{tableConsumer->asArrowTable()};
       int64_t nRows{tablePtr->num_rows()};
       if (nEvents != nRows) {
-        LOGF(fatal, "Inconsistent number of rows in the trigger table %s: %lld but it should be %lld", tableName.first.data(), nRows, nEvents);
+        LOGF(fatal, "Inconsistent number of rows in the trigger table %s: %lld but it should be %lld", filterTable.name.data(), nRows, nEvents);
       }
 
-      if (outDecision.size() == 0) {
-        outDecision.resize(nEvents, {0ull, 0ull});
-        outTrigger.resize(nEvents, {0ull, 0ull});
+      if (!filterTable.columnsResolved) {
+        auto schema{tablePtr->schema()};
+        for (auto& channel : filterTable.channels) {
+          channel.columnIndex = schema->GetFieldIndex(channel.name);
+        }
+        filterTable.columnsResolved = true;
       }
 
-      auto schema{tablePtr->schema()};
-      for (auto& colName : tableName.second) {
-        uint64_t bin{static_cast<uint64_t>(mScalers->GetXaxis()->FindBin(colName.first.data()))};
-        double binCenter{mScalers->GetXaxis()->GetBinCenter(bin)};
-        uint64_t decisionBin{(bin - 2) / 64};
-        uint64_t triggerBit{BIT((bin - 2) % 64)};
-        auto column{tablePtr->GetColumnByName(colName.first)};
-        double downscaling{colName.second};
-        if (column) {
-          int entry = 0;
-          for (int64_t iC{0}; iC < column->num_chunks(); ++iC) {
-            auto chunk{column->chunk(iC)};
-            auto boolArray = std::static_pointer_cast<arrow::BooleanArray>(chunk);
-            for (int64_t iS{startCollision}; iS < chunk->length(); ++iS) {
-              if (boolArray->Value(iS)) {
-                mScalers->Fill(binCenter);
-                outTrigger[entry][decisionBin] |= triggerBit;
-                if (mUniformGenerator(mGeneratorEngine) < downscaling) {
-                  mFiltered->Fill(binCenter);
-                  outDecision[entry][decisionBin] |= triggerBit;
-                }
-              }
-              entry++;
+      for (const auto& channel : filterTable.channels) {
+        if (channel.columnIndex < 0) {
+          continue;
+        }
+        const int decisionWord{channel.bitIndex / 64};
+        const uint64_t triggerBit{BIT(channel.bitIndex % 64)};
+        const uint64_t channelKey{(channel.bitIndex + 1) * 0x9e3779b97f4a7c15ull};
+        int64_t nTriggered{0}, nFiltered{0};
+        auto column{tablePtr->column(channel.columnIndex)};
+        int64_t entry{0};
+        for (int64_t iC{0}; iC < column->num_chunks(); ++iC) {
+          auto boolArray = std::static_pointer_cast<arrow::BooleanArray>(column->chunk(iC));
+          const int64_t chunkLength{boolArray->length()};
+          for (int64_t iS{startCollision}; iS < chunkLength; ++iS, ++entry) {
+            if (!boolArray->Value(iS)) {
+              continue;
+            }
+            nTriggered++;
+            outTrigger[entry][decisionWord] |= triggerBit;
+            if ((counterRandom(mEventKeys[entry] ^ channelKey) >> 11) < channel.threshold) {
+              nFiltered++;
+              outDecision[entry][decisionWord] |= triggerBit;
             }
           }
         }
+        mScalers->AddBinContent(channel.scalerBin, nTriggered);
+        mFiltered->AddBinContent(channel.scalerBin, nFiltered);
       }
     }
     mScalers->SetBinContent(1, mScalers->GetBinContent(1) + nEvents - startCollision);
@@ -353,15 +413,12 @@ struct centralEventFilterTask {
 
     for (uint64_t iE{0}; iE < outTrigger.size(); ++iE) {
       for (uint64_t iD{0}; iD < outTrigger[0].size(); ++iD) {
-        for (int iB{0}; iB < 64; ++iB) {
-          if (!(outTrigger[iE][iD] & BIT(iB))) {
-            continue;
-          }
-          for (int jD{0}; jD < outTrigger[0].size(); ++jD) {
-            for (int iC{iB}; iC < 64; ++iC) {
-              if (outTrigger[iE][iD] & BIT(iC)) {
-                mCovariance->Fill(iD * 64 + iB, jD * 64 + iC);
-              }
+        // loop over the set bits only
+        for (uint64_t bitsB{outTrigger[iE][iD]}; bitsB; bitsB &= bitsB - 1) {
+          const int iB{__builtin_ctzll(bitsB)};
+          for (uint64_t jD{0}; jD < outTrigger[0].size(); ++jD) {
+            for (uint64_t bitsC{bitsB}; bitsC; bitsC &= bitsC - 1) {
+              mCovariance->Fill(iD * 64 + iB, jD * 64 + __builtin_ctzll(bitsC));
             }
           }
         }
@@ -393,9 +450,6 @@ struct centralEventFilterTask {
   void process(CCs const&, BCs const&)
   {
   }
-
-  std::mt19937_64 mGeneratorEngine;
-  std::uniform_real_distribution<double> mUniformGenerator = std::uniform_real_distribution<double>(0., 1.);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfg)
@@ -74,6 +74,7 @@ struct BCRangeSelector {
     auto filt = decisions.begin();
     int firstSelectedCollision{-1};
     std::vector<IRFrame> bcRanges;
+    bcRanges.reserve(cols.size());
     int nColl{0}, nSelected{0};
     for (auto collision : cols) {
       if (filt.cefpSelected0() || filt.cefpSelected1()) {
@@ -111,18 +112,29 @@ struct BCRangeSelector {
       return a.getMin() < b.getMin();
     });
 
-    std::vector<IRFrame> bcRangesMerged(1, bcRanges[0]);
+    /// Sweep of the sorted ranges, merged in place. The ranges are inclusive, so that also the ranges which are
+    /// adjacent (next minimum = current maximum + 1) are coalesced into one range of the output
+    std::vector<uint64_t> bcMin(bcRanges.size()), bcMax(bcRanges.size());
+    for (uint64_t iR{0}; iR < bcRanges.size(); ++iR) {
+      bcMin[iR] = bcRanges[iR].getMin().toLong();
+      bcMax[iR] = bcRanges[iR].getMax().toLong();
+    }
+    uint64_t nMerged{0};
     for (uint64_t iR{1}; iR < bcRanges.size(); ++iR) {
-      if (bcRangesMerged.back().getMax() >= bcRanges[iR].getMin()) {
-        bcRangesMerged.back().getMax() = std::max(bcRangesMerged.back().getMax(), bcRanges[iR].getMax());
+      if (bcMax[nMerged] + 1 >= bcMin[iR]) {
+        bcMax[nMerged] = std::max(bcMax[nMerged], bcMax[iR]);
       } else {
-        bcRangesMerged.push_back(bcRanges[iR]);
+        ++nMerged;
+        bcMin[nMerged] = bcMin[iR];
+        bcMax[nMerged] = bcMax[iR];
       }
     }
-    bcRanges.swap(bcRangesMerged);
+    ++nMerged;
+    LOGF(info, "%zu BC ranges merged into %llu", bcRanges.size(), static_cast<unsigned long long>(nMerged));
 
-    for (auto& range : bcRanges) {
-      tags(range.getMin().toLong(), range.getMax().toLong());
+    tags.reserve(nMerged);
+    for (uint64_t iR{0}; iR < nMerged; ++iR) {
+      tags(bcMin[iR], bcMax[iR]);
     }
   }
 
@@ -27,13 +27,72 @@
 #include "TCanvas.h"
 #include "TF1.h"
 #include "THn.h"
+#include "TArray.h"
+#include "TAxis.h"
 #include "Framework/HistogramSpec.h"
 #include "CommonConstants/MathConstants.h"
 
+#include <array>
+#include <cmath>
+#include <vector>
+
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::constants::math;
 
+namespace
+{
+// Contents and squared errors of a 4d histogram (deltaphi, deltaeta, zvtx, multiplicity) as from getHistsZVtxMult,
+// stored as one dense deltaphi-deltaeta slab per (zvtx, multiplicity) bin. The histogram is read once, and the
+// deltaphi-deltaeta projection of a single (zvtx, multiplicity) bin is then a copy of its slab instead of a loop
+// over all the bins of the histogram.
+class ZVtxMultSlabs
+{
+ public:
+  explicit ZVtxMultSlabs(THnBase* hist)
+  {
+    for (int i = 0; i < 4; i++) {
+      mN[i] = hist->GetAxis(i)->GetNbins() + 2; // with under- and overflow
+    }
+    mContent.assign(static_cast<size_t>(mN[0]) * mN[1] * mN[2] * mN[3], 0.);
+    mError2.assign(mContent.size(), 0.);
+    Int_t coord[4];
+    for (Long64_t bin = 0; bin < hist->GetNbins(); bin++) {
+      Double_t content = hist->GetBinContent(bin, coord);
+      size_t index = slab(coord[2], coord[3]) + static_cast<size_t>(coord[1]) * mN[0] + coord[0];
+      mContent[index] = content;
+      mError2[index] = hist->GetBinError2(bin);
+    }
+  }
+
+  // Returns a clone of the (empty) deltaphi-deltaeta histogram filled as Projection(1, 0, "E") of the bin
+  TH2* project(const TH2* empty, Int_t vertexBin, Int_t multBin) const
+  {
+    TH2* proj = static_cast<TH2*>(empty->Clone());
+    size_t index = slab(vertexBin, multBin);
+    Double_t entries = 0;
+    for (Int_t y = 0; y < mN[1]; y++) {
+      for (Int_t x = 0; x < mN[0]; x++, index++) {
+        if (mContent[index] != 0 || mError2[index] != 0) {
+          proj->SetBinContent(x, y, mContent[index]);
+          proj->SetBinError(x, y, std::sqrt(mError2[index]));
+          entries += mContent[index];
+        }
+      }
+    }
+    proj->SetEntries(entries);
+    return proj;
+  }
+
+ private:
+  size_t slab(Int_t vertexBin, Int_t multBin) const { return (static_cast<size_t>(multBin) * mN[2] + vertexBin) * mN[0] * mN[1]; }
+
+  std::array<Int_t, 4> mN{};
+  std::vector<Double_t> mContent;
+  std::vector<Double_t> mError2;
+};
+} // namespace
+
 ClassImp(CorrelationContainer);
 
 const Int_t CorrelationContainer::fgkCFSteps = 11;
@@ -222,6 +281,10 @@ void CorrelationContainer::Copy(TObject& c) const
   target.mTrackEtaCut = mTrackEtaCut;
   target.mWeightPerEvent = mWeightPerEvent;
   target.mSkipScaleMixedEvent = mSkipScaleMixedEvent;
+
+  // the axes of the pair buffer point to the previous pair histogram
+  target.mBufferAxes.clear();
+  target.mBufferFilled.clear();
 }
 
 //____________________________________________________________________
@@ -539,6 +602,14 @@ TH2* CorrelationContainer::getSumOfRatios(CorrelationContainer* mixed, Correlati
     multBinEnd = multAxis->FindBin(mCentralityMax);
   }
 
+  // deltaphi-deltaeta slabs of all the (vertex, multiplicity) bins, read once instead of one projection per bin
+  const ZVtxMultSlabs slabsSame(trackSameAll);
+  const ZVtxMultSlabs slabsMixed(trackMixedAll);
+  TH2* emptySame = trackSameAll->Projection(1, 0, "E");
+  emptySame->Reset();
+  TH2* emptyMixed = trackMixedAll->Projection(1, 0, "E");
+  emptyMixed->Reset();
+
   for (Int_t multBin = TMath::Max(1, multBinBegin); multBin <= TMath::Min(multAxis->GetNbins(), multBinEnd); multBin++) {
     trackSameAll->GetAxis(3)->SetRange(multBin, multBin);
     trackMixedAll->GetAxis(3)->SetRange(multBin, multBin);
@@ -647,11 +718,8 @@ TH2* CorrelationContainer::getSumOfRatios(CorrelationContainer* mixed, Correlati
     }
 
     for (Int_t vertexBin = vertexBinBegin; vertexBin <= vertexBinEnd; vertexBin++) {
-      trackSameAll->GetAxis(2)->SetRange(vertexBin, vertexBin);
-      trackMixedAll->GetAxis(2)->SetRange(vertexBin, vertexBin);
-
-      TH2* tracksSame = trackSameAll->Projection(1, 0, "E");
-      TH2* tracksMixed = trackMixedAll->Projection(1, 0, "E");
+      TH2* tracksSame = slabsSame.project(emptySame, vertexBin, multBin);
+      TH2* tracksMixed = slabsMixed.project(emptyMixed, vertexBin, multBin);
 
       // asssume flat in dphi, gain in statistics
       //     TH1* histMixedproj = mixedTwoD->ProjectionY();
@@ -761,6 +829,8 @@ TH2* CorrelationContainer::getSumOfRatios(CorrelationContainer* mixed, Correlati
     totalTracks->Scale(1.0 / normalization);
   }
 
+  delete emptySame;
+  delete emptyMixed;
   delete trackSameAll;
   delete trackMixedAll;
   delete trackMixedAllStep6;
@@ -1651,3 +1721,158 @@ void CorrelationContainer::fillEvent(Float_t centrality, CFStep step)
   // Fill per-event information
   mEventCount->Fill(step, centrality);
 }
+
+//____________________________________________________________________
+void CorrelationContainer::startPairs(CFStep step, Float_t centrality, Float_t zVtx)
+{
+  // Starts the buffered filling of the pairs of an event in the pair histogram
+  // The local buffer spans the axes delta eta (0), pT assoc (1), pT trig (2), delta phi (4) and the optional user axis (6)
+
+  if (mBufferFilled.size() > 0) {
+    flushPairs();
+  }
+
+  if (mBufferAxes.size() == 0) {
+    const Int_t nVars = mPairHist->getNVar();
+    if (nVars != 6 && nVars != 7) {
+      LOGF(fatal, "The pair buffer supports pair histograms with 6 or 7 axes, found %d", nVars);
+    }
+    Long64_t nLocalBins = 1;
+    for (Int_t i = 0; i < nVars; i++) {
+      mBufferAxes.push_back(mPairHist->GetAxis(i));
+      mBufferNbins.push_back(mBufferAxes[i]->GetNbins());
+      if (i != 3 && i != 5) {
+        nLocalBins *= mBufferNbins[i];
+      }
+    }
+    mBufferSumW.assign(nLocalBins, 0);
+    mBufferSumW2.assign(nLocalBins, 0);
+  }
+
+  mBufferStep = step;
+  mBufferUnitWeights = kTRUE;
+  mBufferTriggerBin = -1;
+  mBufferEventBins[0] = mBufferAxes[3]->FindBin(centrality) - 1;
+  mBufferEventBins[1] = mBufferAxes[5]->FindBin(zVtx) - 1;
+  mBufferEventInRange = mBufferEventBins[0] >= 0 && mBufferEventBins[0] < mBufferNbins[3] && mBufferEventBins[1] >= 0 && mBufferEventBins[1] < mBufferNbins[5];
+}
+
+//____________________________________________________________________
+void CorrelationContainer::setPairTrigger(Float_t ptTrigger, Float_t userValue)
+{
+  // Sets the trigger particle of the following pairs
+
+  mBufferTriggerBin = -1;
+  Int_t binPtTrigger = mBufferAxes[2]->FindBin(ptTrigger) - 1;
+  if (binPtTrigger < 0 || binPtTrigger >= mBufferNbins[2]) {
+    return;
+  }
+  Int_t binUser = 0;
+  if (mBufferAxes.size() == 7) {
+    binUser = mBufferAxes[6]->FindBin(userValue) - 1;
+    if (binUser < 0 || binUser >= mBufferNbins[6]) {
+      return;
+    }
+  }
+  mBufferTriggerBin = binPtTrigger;
+  if (mBufferAxes.size() == 7) {
+    mBufferTriggerBin = mBufferTriggerBin * mBufferNbins[6] + binUser;
+  }
+}
+
+//____________________________________________________________________
+void CorrelationContainer::addPair(Float_t deltaEta, Float_t ptAssoc, Float_t deltaPhi, Float_t weight)
+{
+  // Adds a pair of the current trigger particle to the buffer
+
+  if (!mBufferEventInRange || mBufferTriggerBin < 0) {
+    return;
+  }
+  Int_t binDeltaEta = mBufferAxes[0]->FindBin(deltaEta) - 1;
+  if (binDeltaEta < 0 || binDeltaEta >= mBufferNbins[0]) {
+    return;
+  }
+  Int_t binPtAssoc = mBufferAxes[1]->FindBin(ptAssoc) - 1;
+  if (binPtAssoc < 0 || binPtAssoc >= mBufferNbins[1]) {
+    return;
+  }
+  Int_t binDeltaPhi = mBufferAxes[4]->FindBin(deltaPhi) - 1;
+  if (binDeltaPhi < 0 || binDeltaPhi >= mBufferNbins[4]) {
+    return;
+  }
+
+  // local bin, with the trigger axes (pT trig and user axis) between pT assoc and delta phi
+  const Long64_t nTriggerBins = mBufferNbins[2] * (mBufferAxes.size() == 7 ? mBufferNbins[6] : 1);
+  const Long64_t localBin = ((Long64_t(binDeltaEta) * mBufferNbins[1] + binPtAssoc) * nTriggerBins + mBufferTriggerBin) * mBufferNbins[4] + binDeltaPhi;
+
+  if (mBufferSumW[localBin] == 0 && mBufferSumW2[localBin] == 0) {
+    mBufferFilled.push_back(localBin);
+  }
+  mBufferSumW[localBin] += weight;
+  mBufferSumW2[localBin] += weight * weight;
+  if (weight != 1) {
+    mBufferUnitWeights = kFALSE;
+  }
+}
+
+//____________________________________________________________________
+void CorrelationContainer::flushPairs()
+{
+  // Adds the buffered pairs to the pair histogram and clears the buffer
+
+  if (mBufferFilled.size() == 0) {
+    return;
+  }
+
+  const bool hasUserAxis = mBufferAxes.size() == 7;
+  const Int_t nUserBins = hasUserAxis ? mBufferNbins[6] : 1;
+  Int_t bins[7] = {0};
+  auto globalBin = [&](Long64_t localBin) {
+    // decomposes the local bin and returns the bin of the StepTHn storage (the last axis running fastest)
+    bins[4] = localBin % mBufferNbins[4];
+    localBin /= mBufferNbins[4];
+    bins[6] = localBin % nUserBins;
+    localBin /= nUserBins;
+    bins[2] = localBin % mBufferNbins[2];
+    localBin /= mBufferNbins[2];
+    bins[1] = localBin % mBufferNbins[1];
+    bins[0] = localBin / mBufferNbins[1];
+    bins[3] = mBufferEventBins[0];
+    bins[5] = mBufferEventBins[1];
+    Long64_t bin = 0;
+    for (UInt_t i = 0; i < mBufferAxes.size(); i++) {
+      bin = bin * mBufferNbins[i] + bins[i];
+    }
+    return bin;
+  };
+
+  // the containers of a step are created by StepTHn::Fill: the first bin is filled through it if needed,
+  // with a weight different from one if the sum of squared weights has to be stored
+  if (!mPairHist->getValues(mBufferStep) || (!mBufferUnitWeights && !mPairHist->getSumw2(mBufferStep))) {
+    const Long64_t localBin = mBufferFilled[0];
+    globalBin(localBin);
+    const Double_t weight = mBufferUnitWeights ? 1. : 0.5;
+    Double_t positionAndWeight[8];
+    for (UInt_t i = 0; i < mBufferAxes.size(); i++) {
+      positionAndWeight[i] = mBufferAxes[i]->GetBinCenter(bins[i] + 1);
+    }
+    positionAndWeight[mBufferAxes.size()] = weight;
+    mPairHist->Fill(mBufferStep, mBufferAxes.size() + 1, positionAndWeight);
+    mBufferSumW[localBin] -= weight;
+    mBufferSumW2[localBin] -= weight * weight;
+  }
+
+  TArray* values = mPairHist->getValues(mBufferStep);
+  TArray* sumw2 = mPairHist->getSumw2(mBufferStep);
+  for (auto localBin : mBufferFilled) {
+    const Long64_t bin = globalBin(localBin);
+    values->SetAt(values->GetAt(bin) + mBufferSumW[localBin], bin);
+    if (sumw2) {
+      sumw2->SetAt(sumw2->GetAt(bin) + mBufferSumW2[localBin], bin);
+    }
+    mBufferSumW[localBin] = 0;
+    mBufferSumW2[localBin] = 0;
+  }
+  mBufferFilled.clear();
+  mBufferUnitWeights = kTRUE;
+}
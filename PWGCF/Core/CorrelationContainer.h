@@ -14,6 +14,8 @@
 
 // encapsulate histogram and corrections for correlation analysis
 
+#include <vector>
+
 #include "TNamed.h"
 #include "TString.h"
 #include "Framework/HistogramSpec.h"
@@ -29,6 +31,7 @@ class TH2D;
 class TCollection;
 class THnSparse;
 class THnBase;
+class TAxis;
 class StepTHn;
 
 class CorrelationContainer : public TNamed
@@ -103,6 +106,15 @@ class CorrelationContainer : public TNamed
 
   void fillEvent(Float_t centrality, CFStep step);
 
+  // Fast filling of the pair histogram. The pairs of an event are summed in a local buffer over the axes which
+  // change within the event (delta eta, pT assoc, pT trig, delta phi and the optional user axis) and added to the
+  // pair histogram at once by flushPairs(). Same content as filling each pair with getPairHist()->Fill().
+  // Pairs outside of the axis ranges are dropped, as in StepTHn::Fill.
+  void startPairs(CFStep step, Float_t centrality, Float_t zVtx);
+  void setPairTrigger(Float_t ptTrigger, Float_t userValue = 0);
+  void addPair(Float_t deltaEta, Float_t ptAssoc, Float_t deltaPhi, Float_t weight = 1);
+  void flushPairs();
+
   void extendTrackingEfficiency(Bool_t verbose = kFALSE);
 
   void setEtaRange(Float_t etaMin, Float_t etaMax)
@@ -178,6 +190,17 @@ class CorrelationContainer : public TNamed
   Bool_t mGetMultCacheOn; //! cache for getHistsZVtxMult function active
   THnBase* mGetMultCache; //! cache for getHistsZVtxMult function
 
+  std::vector<TAxis*> mBufferAxes;     //! axes of the pair histogram
+  std::vector<Int_t> mBufferNbins;     //! number of bins of the axes of the pair histogram
+  Int_t mBufferStep = -1;              //! step filled through the pair buffer
+  Bool_t mBufferEventInRange = kFALSE; //! centrality and vertex of the event inside the axis ranges
+  Int_t mBufferEventBins[2] = {0, 0};  //! bins (from 0) of the centrality and vertex axes
+  Long64_t mBufferTriggerBin = -1;     //! local bin (from 0) of the pT trig and user axes, -1 if out of range
+  Bool_t mBufferUnitWeights = kTRUE;   //! only weights equal to one buffered since the last flush
+  std::vector<Double_t> mBufferSumW;   //! sum of the weights per local bin
+  std::vector<Double_t> mBufferSumW2;  //! sum of the squared weights per local bin
+  std::vector<Long64_t> mBufferFilled; //! local bins filled since the last flush
+
   ClassDef(CorrelationContainer, 2) // underlying event histogram container
 };
 
@@ -0,0 +1,39 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef PWGCF_CORE_FEMTOPRODUCERUTILS_H_
+#define PWGCF_CORE_FEMTOPRODUCERUTILS_H_
+
+#include <algorithm>
+
+// Helpers shared by the derived-data producers of FemtoDream, FemtoUniverse and FemtoWorld
+
+namespace o2::analysis::femto
+{
+
+/// Row of a V0 (or cascade) daughter in the table of the primary tracks written for the collision
+/// \param daughID Global index of the daughter track
+/// \param vecID Global indices of the primary tracks in the order of their rows, increasing as the tracks are written
+///              in the order of the track table
+/// \return Row of the daughter, -1 if the daughter is not a primary track of the collision
+template <typename T>
+int getRowDaughters(int daughID, T const& vecID)
+{
+  auto it = std::lower_bound(vecID.begin(), vecID.end(), daughID);
+  if (it == vecID.end() || *it != daughID) {
+    return -1;
+  }
+  return static_cast<int>(it - vecID.begin());
+}
+
+} // namespace o2::analysis::femto
+
+#endif // PWGCF_CORE_FEMTOPRODUCERUTILS_H_
@@ -0,0 +1,134 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef PWGCF_CORE_MIXINGPOOL_H_
+#define PWGCF_CORE_MIXINGPOOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <random>
+#include <utility>
+
+// Event-mixing pools for the pair analyses
+//
+// The events are kept per mixing bin (e.g. vertex-z & multiplicity) as user-defined, self-contained
+// records (typically the magnetic field and vectors of compact particle records), so that the pools
+// do not depend on the lifetime of the tables and can be kept between dataframes.
+// Each new event is paired with the pooled events of its bin through a kernel callback before being added.
+//
+// Pool policies, for a depth N > 0 (N = 0: all the events are kept):
+//   kFIFO      -- the N most recent events of the bin are kept
+//   kReservoir -- a uniform random sample of N events out of all the events seen in the bin is kept
+//                 (reservoir sampling), instead of skipping event pairs at random
+//
+// Example usage:
+//
+//   struct MyEvent { float magField; std::vector<MyParticle> particles; };
+//   MixingPool<MyEvent, std::pair<int, int>> pool(5, PoolPolicy::kFIFO);
+//   ...
+//   pool.mixAndAdd({vzBin, multBin}, std::move(event), [&](const MyEvent& pooled, const MyEvent& current) { ... });
+
+namespace o2::analysis::mixing
+{
+
+enum class PoolPolicy {
+  kFIFO = 0,
+  kReservoir
+};
+
+template <typename TEvent, typename TKey = int>
+class MixingPool
+{
+ public:
+  MixingPool() = default;
+  explicit MixingPool(std::size_t depth, PoolPolicy policy = PoolPolicy::kFIFO, uint64_t seed = 0) : mDepth(depth), mPolicy(policy), mGenerator(seed) {}
+
+  void setDepth(std::size_t depth) { mDepth = depth; }
+  void setPolicy(PoolPolicy policy) { mPolicy = policy; }
+  void setSeed(uint64_t seed) { mGenerator.seed(seed); }
+  std::size_t getDepth() const { return mDepth; }
+  PoolPolicy getPolicy() const { return mPolicy; }
+
+  /// Calls kernel(pooled, event) for every event pooled in the bin (oldest first for kFIFO)
+  template <typename TKernel>
+  void mix(const TKey& key, const TEvent& event, TKernel&& kernel) const
+  {
+    auto bin = mBins.find(key);
+    if (bin == mBins.end()) {
+      return;
+    }
+    for (const auto& pooled : bin->second.events) {
+      kernel(pooled, event);
+    }
+  }
+
+  /// Adds the event to the pool of its bin, according to the pool policy
+  void add(const TKey& key, TEvent&& event)
+  {
+    auto& bin = mBins[key];
+    bin.nSeen++;
+    if (mDepth == 0 || bin.events.size() < mDepth) {
+      bin.events.push_back(std::move(event));
+      return;
+    }
+    if (mPolicy == PoolPolicy::kFIFO) {
+      bin.events.pop_front();
+      bin.events.push_back(std::move(event));
+      return;
+    }
+    // reservoir sampling: the n-th event replaces a random pooled event with probability depth / n
+    uint64_t slot = std::uniform_int_distribution<uint64_t>(0, bin.nSeen - 1)(mGenerator);
+    if (slot < mDepth) {
+      bin.events[slot] = std::move(event);
+    }
+  }
+
+  /// Mixes the event with its bin and adds it to the pool
+  template <typename TKernel>
+  void mixAndAdd(const TKey& key, TEvent&& event, TKernel&& kernel)
+  {
+    mix(key, event, kernel);
+    add(key, std::move(event));
+  }
+
+  /// Number of events pooled in the bin
+  std::size_t size(const TKey& key) const
+  {
+    auto bin = mBins.find(key);
+    return bin == mBins.end() ? 0 : bin->second.events.size();
+  }
+  /// Number of events added to the bin since the last clear
+  uint64_t nSeen(const TKey& key) const
+  {
+    auto bin = mBins.find(key);
+    return bin == mBins.end() ? 0 : bin->second.nSeen;
+  }
+  std::size_t nBins() const { return mBins.size(); }
+
+  void clear() { mBins.clear(); }
+
+ private:
+  struct Bin {
+    std::deque<TEvent> events;
+    uint64_t nSeen = 0;
+  };
+
+  std::map<TKey, Bin> mBins;
+  std::size_t mDepth = 0; // maximum number of events per bin, 0 -- no limit
+  PoolPolicy mPolicy = PoolPolicy::kFIFO;
+  std::mt19937_64 mGenerator;
+};
+
+} // namespace o2::analysis::mixing
+
+#endif // PWGCF_CORE_MIXINGPOOL_H_
@@ -12,11 +12,15 @@
 #ifndef O2_ANALYSIS_PAIRCUTS_H
 #define O2_ANALYSIS_PAIRCUTS_H
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <vector>
 
 #include "Framework/Logger.h"
 #include "Framework/HistogramRegistry.h"
 #include "CommonConstants/MathConstants.h"
+#include "PWGCF/Core/PhiStar.h"
 
 // Functions which cut on particle pairs (decays, conversions, two-track cuts)
 //
@@ -65,6 +69,11 @@ class PairCuts
   template <typename T>
   bool twoTrackCut(T const& track1, T const& track2, int magField);
 
+  // Two-track cut of track1 against n particles given as arrays, with the same decisions as twoTrackCut
+  // rejected: pairs with a non-zero entry are skipped, entries of removed pairs are set to 1
+  template <typename T>
+  void twoTrackCut(T const& track1, int n, const float* pt, const float* eta, const float* phi, const int8_t* sign, int magField, uint8_t* rejected);
+
  protected:
   float mCuts[ParticlesLastEntry] = {-1};
   float mTwoTrackDistance = -1; // distance below which the pair is flagged as to be removed
@@ -83,6 +92,17 @@ class PairCuts
 
   template <typename T>
   float getDPhiStar(T const& track1, T const& track2, float radius, int magField);
+
+  static float foldDPhiStar(float dphistar);
+
+  // buffers of the batch two-track cut, one entry per pair passing the delta eta preselection
+  std::vector<int> mBatchIndex;
+  std::vector<double> mBatchPhi;
+  std::vector<double> mBatchCharge;
+  std::vector<double> mBatchPt;
+  std::vector<double> mBatchPhiStar;
+  std::vector<float> mBatchDPhiStarMin;
+  std::vector<float> mBatchDPhiStarMinAbs;
 };
 
 template <typename T>
@@ -160,6 +180,91 @@ bool PairCuts::twoTrackCut(T const& track1, T const& track2, int magField)
   return false;
 }
 
+template <typename T>
+void PairCuts::twoTrackCut(T const& track1, int n, const float* pt, const float* eta, const float* phi, const int8_t* sign, int magField, uint8_t* rejected)
+{
+  // Same cut as twoTrackCut above. The phi* of the trigger particle is computed once per radius
+  // and the phi* of the associated particles for all pairs at once, in loops over contiguous arrays.
+
+  const double bz = 0.1 * magField; // kG -> T
+  const float kLimit = mTwoTrackDistance * 3;
+
+  mBatchIndex.clear();
+  mBatchPhi.clear();
+  mBatchCharge.clear();
+  mBatchPt.clear();
+  for (int i = 0; i < n; i++) {
+    if (rejected[i] == 0 && std::fabs(track1.eta() - eta[i]) < mTwoTrackDistance * 2.5 * 3) {
+      mBatchIndex.push_back(i);
+      mBatchPhi.push_back(phi[i]);
+      mBatchCharge.push_back(sign[i]);
+      mBatchPt.push_back(pt[i]);
+    }
+  }
+  if (mBatchIndex.empty()) {
+    return;
+  }
+
+  // check first boundaries to see if is worth to loop and find the minimum
+  int nPairs = mBatchIndex.size();
+  mBatchPhiStar.resize(nPairs);
+  mBatchDPhiStarMin.resize(nPairs);
+  mBatchDPhiStarMinAbs.resize(nPairs);
+  o2::analysis::phistar::phiAtRadius(nPairs, mBatchPhi.data(), mBatchCharge.data(), mBatchPt.data(), bz, mTwoTrackRadius, mBatchPhiStar.data());
+  double phiStar1 = o2::analysis::phistar::phiAtRadius(track1.phi(), track1.sign(), track1.pt(), bz, mTwoTrackRadius);
+  for (int j = 0; j < nPairs; j++) {
+    mBatchDPhiStarMin[j] = foldDPhiStar(phiStar1 - mBatchPhiStar[j]);
+  }
+  o2::analysis::phistar::phiAtRadius(nPairs, mBatchPhi.data(), mBatchCharge.data(), mBatchPt.data(), bz, 2.5, mBatchPhiStar.data());
+  phiStar1 = o2::analysis::phistar::phiAtRadius(track1.phi(), track1.sign(), track1.pt(), bz, 2.5);
+  int nSelected = 0;
+  for (int j = 0; j < nPairs; j++) {
+    float dphistar1 = mBatchDPhiStarMin[j];
+    float dphistar2 = foldDPhiStar(phiStar1 - mBatchPhiStar[j]);
+    if (std::fabs(dphistar1) < kLimit || std::fabs(dphistar2) < kLimit || dphistar1 * dphistar2 < 0) {
+      mBatchIndex[nSelected] = mBatchIndex[j];
+      mBatchPhi[nSelected] = mBatchPhi[j];
+      mBatchCharge[nSelected] = mBatchCharge[j];
+      mBatchPt[nSelected] = mBatchPt[j];
+      nSelected++;
+    }
+  }
+  if (nSelected == 0) {
+    return;
+  }
+
+  std::fill_n(mBatchDPhiStarMin.begin(), nSelected, 1e5f);
+  std::fill_n(mBatchDPhiStarMinAbs.begin(), nSelected, 1e5f);
+  for (Double_t rad = mTwoTrackRadius; rad < 2.51; rad += 0.01) {
+    o2::analysis::phistar::phiAtRadius(nSelected, mBatchPhi.data(), mBatchCharge.data(), mBatchPt.data(), bz, rad, mBatchPhiStar.data());
+    phiStar1 = o2::analysis::phistar::phiAtRadius(track1.phi(), track1.sign(), track1.pt(), bz, rad);
+    for (int j = 0; j < nSelected; j++) {
+      float dphistar = foldDPhiStar(phiStar1 - mBatchPhiStar[j]);
+      float dphistarabs = std::fabs(dphistar);
+      bool smaller = dphistarabs < mBatchDPhiStarMinAbs[j];
+      mBatchDPhiStarMin[j] = smaller ? dphistar : mBatchDPhiStarMin[j];
+      mBatchDPhiStarMinAbs[j] = smaller ? dphistarabs : mBatchDPhiStarMinAbs[j];
+    }
+  }
+
+  for (int j = 0; j < nSelected; j++) {
+    int i = mBatchIndex[j];
+    auto deta = track1.eta() - eta[i];
+    if (histogramRegistry != nullptr) {
+      histogramRegistry->fill(HIST("TwoTrackDistancePt_0"), deta, mBatchDPhiStarMin[j], std::fabs(track1.pt() - pt[i]));
+    }
+
+    if (mBatchDPhiStarMinAbs[j] < mTwoTrackDistance && std::fabs(deta) < mTwoTrackDistance) {
+      rejected[i] = 1;
+      continue;
+    }
+
+    if (histogramRegistry != nullptr) {
+      histogramRegistry->fill(HIST("TwoTrackDistancePt_1"), deta, mBatchDPhiStarMin[j], std::fabs(track1.pt() - pt[i]));
+    }
+  }
+}
+
 template <typename T>
 bool PairCuts::conversionCut(T const& track1, T const& track2, Particle conv, double cut)
 {
@@ -316,16 +421,14 @@ float PairCuts::getDPhiStar(T const& track1, T const& track2, float radius, int
   // calculates dphistar
   //
 
-  auto phi1 = track1.phi();
-  auto pt1 = track1.pt();
-  auto charge1 = track1.sign();
+  const double bz = 0.1 * magField; // kG -> T
+  float dphistar = o2::analysis::phistar::phiAtRadius(track1.phi(), track1.sign(), track1.pt(), bz, radius) - o2::analysis::phistar::phiAtRadius(track2.phi(), track2.sign(), track2.pt(), bz, radius);
 
-  auto phi2 = track2.phi();
-  auto pt2 = track2.pt();
-  auto charge2 = track2.sign();
-
-  float dphistar = phi1 - phi2 - charge1 * std::asin(0.015 * magField * radius / pt1) + charge2 * std::asin(0.015 * magField * radius / pt2);
+  return foldDPhiStar(dphistar);
+}
 
+inline float PairCuts::foldDPhiStar(float dphistar)
+{
   if (dphistar > PI) {
     dphistar = TwoPI - dphistar;
   }
@@ -0,0 +1,157 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef PWGCF_CORE_PAIRKINEMATICS_H_
+#define PWGCF_CORE_PAIRKINEMATICS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Pair kinematics for the femtoscopy analyses, from the Cartesian momenta and masses of the two particles
+//
+// With P = p1 + p2 and q = p1 - p2 (four-vectors):
+//   kstar -- momentum of the particles in the pair rest frame, k*^2 = (q.P)^2 / P^2 - q.q (Lorentz invariant, any masses)
+//   qinv  -- sqrt(|q.q|), equal to 2 k* for equal masses
+//   kT    -- half of the pair transverse momentum
+//   mT    -- sqrt(kT^2 + ((m1 + m2) / 2)^2)
+//   qout, qside, qlong -- components of q in the longitudinally co-moving system (LCMS, boost along z to Pz = 0),
+//                         with the out axis along the pair transverse momentum
+//
+// The functions do not allocate and the block version loops over contiguous arrays (auto-vectorisable).
+// Units: GeV/c, GeV/c^2
+
+namespace o2::analysis::pairkinematics
+{
+
+struct PairKinematics {
+  float kstar = 0.f;
+  float qinv = 0.f;
+  float kT = 0.f;
+  float mT = 0.f;
+  float qout = 0.f;
+  float qside = 0.f;
+  float qlong = 0.f;
+};
+
+/// Computes the kinematic variables of one pair
+inline PairKinematics computePair(float px1, float py1, float pz1, float m1, float px2, float py2, float pz2, float m2)
+{
+  PairKinematics res;
+  const float e1 = std::sqrt(px1 * px1 + py1 * py1 + pz1 * pz1 + m1 * m1);
+  const float e2 = std::sqrt(px2 * px2 + py2 * py2 + pz2 * pz2 + m2 * m2);
+  const float sumX = px1 + px2, sumY = py1 + py2, sumZ = pz1 + pz2, sumE = e1 + e2;
+  const float difX = px1 - px2, difY = py1 - py2, difZ = pz1 - pz2, difE = e1 - e2;
+
+  const float sumPt2 = sumX * sumX + sumY * sumY;
+  const float sumM2 = sumE * sumE - sumZ * sumZ - sumPt2;
+  const float qq = difE * difE - difX * difX - difY * difY - difZ * difZ;
+  const float qP = difE * sumE - difX * sumX - difY * sumY - difZ * sumZ;
+  res.kstar = 0.5f * std::sqrt(std::max(qP * qP / sumM2 - qq, 0.f));
+  res.qinv = std::sqrt(std::abs(qq));
+  res.kT = 0.5f * std::sqrt(sumPt2);
+  res.mT = std::sqrt(res.kT * res.kT + 0.25f * (m1 + m2) * (m1 + m2));
+
+  const float sumPt = std::sqrt(sumPt2);
+  const float sumMt = std::sqrt(sumE * sumE - sumZ * sumZ);
+  res.qout = sumPt > 0.f ? (difX * sumX + difY * sumY) / sumPt : difX;
+  res.qside = sumPt > 0.f ? (difY * sumX - difX * sumY) / sumPt : difY;
+  res.qlong = (sumE * difZ - sumZ * difE) / sumMt;
+  return res;
+}
+
+/// Computes the kinematic variables of one pair from pT, eta, phi and mass of the particles
+inline PairKinematics computePairPtEtaPhi(float pt1, float eta1, float phi1, float m1, float pt2, float eta2, float phi2, float m2)
+{
+  return computePair(pt1 * std::cos(phi1), pt1 * std::sin(phi1), pt1 * std::sinh(eta1), m1,
+                     pt2 * std::cos(phi2), pt2 * std::sin(phi2), pt2 * std::sinh(eta2), m2);
+}
+
+/// Kinematic variables of a block of pairs, as contiguous arrays
+/// The first and second particles of the pairs are given as arrays of px, py, pz and mass
+struct PairBlock {
+  std::vector<float> kstar, qinv, kT, mT, qout, qside, qlong;
+
+  void resize(int n)
+  {
+    for (auto* v : {&kstar, &qinv, &kT, &mT, &qout, &qside, &qlong}) {
+      if (v->size() < static_cast<size_t>(n)) {
+        v->resize(n);
+      }
+    }
+  }
+
+  void compute(int n, const float* px1, const float* py1, const float* pz1, const float* m1,
+               const float* px2, const float* py2, const float* pz2, const float* m2)
+  {
+    resize(n);
+    float* __restrict outKstar = kstar.data();
+    float* __restrict outQinv = qinv.data();
+    float* __restrict outKT = kT.data();
+    float* __restrict outMT = mT.data();
+    float* __restrict outQout = qout.data();
+    float* __restrict outQside = qside.data();
+    float* __restrict outQlong = qlong.data();
+    for (int i = 0; i < n; i++) {
+      const auto res = computePair(px1[i], py1[i], pz1[i], m1[i], px2[i], py2[i], pz2[i], m2[i]);
+      outKstar[i] = res.kstar;
+      outQinv[i] = res.qinv;
+      outKT[i] = res.kT;
+      outMT[i] = res.mT;
+      outQout[i] = res.qout;
+      outQside[i] = res.qside;
+      outQlong[i] = res.qlong;
+    }
+  }
+};
+
+/// Uniform binning, with the ROOT bin numbering (0 -- underflow, nBins + 1 -- overflow)
+struct FixedAxis {
+  int nBins = 1;
+  float min = 0.f;
+  float max = 1.f;
+  float invWidth = 1.f;
+
+  FixedAxis() = default;
+  FixedAxis(int n, float lo, float hi) : nBins(n), min(lo), max(hi), invWidth(n / (hi - lo)) {}
+
+  int findBin(float x) const
+  {
+    if (x < min) {
+      return 0;
+    }
+    if (!(x < max)) {
+      return nBins + 1;
+    }
+    return 1 + std::min(static_cast<int>((x - min) * invWidth), nBins - 1);
+  }
+
+  /// Bin indices of n values
+  void findBins(int n, const float* x, int* bins) const
+  {
+    for (int i = 0; i < n; i++) {
+      bins[i] = findBin(x[i]);
+    }
+  }
+};
+
+/// Index of the bin of x in the variable binning given by its edges, -1 if x is outside [edges.front(), edges.back())
+inline int findBin(float x, const std::vector<float>& edges)
+{
+  if (edges.size() < 2 || x < edges.front() || !(x < edges.back())) {
+    return -1;
+  }
+  return static_cast<int>(std::upper_bound(edges.begin(), edges.end(), x) - edges.begin()) - 1;
+}
+
+} // namespace o2::analysis::pairkinematics
+
+#endif // PWGCF_CORE_PAIRKINEMATICS_H_
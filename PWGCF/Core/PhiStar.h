@@ -0,0 +1,48 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef PWGCF_CORE_PHISTAR_H_
+#define PWGCF_CORE_PHISTAR_H_
+
+#include <cmath>
+
+// Azimuthal angle of a track at a given transverse radius in the solenoidal field (phi*),
+// shared by the two-track cuts of the correlation and femtoscopy analyses
+//
+// Units: pT in GeV/c, Bz in T, radius in m
+
+namespace o2::analysis::phistar
+{
+
+/// Sine of the azimuthal bending angle of a track between the primary vertex and the given radius
+/// \note |value| > 1 means that the track does not reach the radius
+inline double sinBendingAngle(double charge, double pt, double bz, double radius)
+{
+  return 0.15 * charge * bz * radius / pt;
+}
+
+/// phi* of a track at the given radius
+inline double phiAtRadius(double phi, double charge, double pt, double bz, double radius)
+{
+  return phi - std::asin(sinBendingAngle(charge, pt, bz, radius));
+}
+
+/// phi* of n tracks at the given radius, loop over contiguous arrays (auto-vectorisable)
+inline void phiAtRadius(int n, const double* phi, const double* charge, const double* pt, double bz, double radius, double* phiStar)
+{
+  for (int i = 0; i < n; i++) {
+    phiStar[i] = phi[i] - std::asin(0.15 * charge[i] * bz * radius / pt[i]);
+  }
+}
+
+} // namespace o2::analysis::phistar
+
+#endif // PWGCF_CORE_PHISTAR_H_
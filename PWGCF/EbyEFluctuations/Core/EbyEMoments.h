@@ -0,0 +1,175 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file EbyEMoments.h
+/// \brief Fill of the per-event moments of the EbyE fluctuation tasks in the profiles of the full sample and of
+///        the subsamples, with the bin of the event found once for all the profiles
+
+#ifndef PWGCF_EBYEFLUCTUATIONS_CORE_EBYEMOMENTS_H_
+#define PWGCF_EBYEFLUCTUATIONS_CORE_EBYEMOMENTS_H_
+
+#include <TProfile.h>
+#include <TProfile2D.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "Common/Core/DenseHistogram.h"
+
+namespace o2::analysis::ebye
+{
+
+/// Moments of an event (e.g. the powers of the net-proton number) filled in TProfile or TProfile2D with the same
+/// binning: one profile per moment for the full sample (set 0) and for each subsample (sets 1 to nSubsamples).
+///
+/// The bin of the event is found once (DenseAxis) and the moments are added to the contents, the sums of the
+/// squares and the bin entries of the profiles directly, instead of one TProfile::Fill with its bin search per
+/// profile. The statistics of the profiles (sums of w, w*x, w*y, ...) and the entries are accumulated per profile
+/// and added by flush(), e.g. at the end of each process(). The profiles must not have a range of the values.
+///
+/// Usage:
+///   moments.addSet({prof_mu1, prof_mu2});           // full sample
+///   moments.addSet({sub0_prof_mu1, sub0_prof_mu2}); // subsample 0, ...
+///   for (const auto& event : events) {
+///     const double mu[2] = {n, n * n};
+///     moments.fill(event.centrality(), mu, subsample);
+///   }
+///   moments.flush();
+template <typename TProfileND>
+class EbyEMoments
+{
+ public:
+  static_assert(std::is_same_v<TProfileND, TProfile> || std::is_same_v<TProfileND, TProfile2D>, "TProfile or TProfile2D");
+  static constexpr int kNDim = std::is_same_v<TProfileND, TProfile2D> ? 2 : 1;
+
+  /// Profiles of the moments of the full sample (first call) or of the next subsample, with the binning of the first profile
+  void addSet(const std::vector<TProfileND*>& profiles)
+  {
+    if (mTargets.empty()) {
+      mNMoments = profiles.size();
+      mAxisX.set(profiles[0]->GetXaxis());
+      if constexpr (kNDim == 2) {
+        mAxisY.set(profiles[0]->GetYaxis());
+      }
+      mStatOverflows = profiles[0]->GetStatOverflowsBool();
+    }
+    for (std::size_t i = 0; i < mNMoments; ++i) {
+      auto* p = profiles[i];
+      mTargets.push_back({p, p->GetArray(), p->GetSumw2N() > 0 ? p->GetSumw2()->GetArray() : nullptr, p->GetBinSumw2()->fN > 0 ? p->GetBinSumw2()->GetArray() : nullptr, {}});
+    }
+    mNFills.push_back(0);
+  }
+
+  /// Moments of an event at x in the full sample and in the subsample (0 to nSubsamples - 1)
+  void fill(double x, const double* moments, int subsample)
+  {
+    static_assert(kNDim == 1, "fill(x, y, moments, subsample) for TProfile2D");
+    const int binX = mAxisX.findBin(x);
+    const bool inRange = mStatOverflows || (binX > 0 && binX <= mAxisX.nBins());
+    fillSet(0, binX, inRange, x, 0., moments);
+    fillSet(1 + subsample, binX, inRange, x, 0., moments);
+  }
+
+  /// Moments of an event at (x, y) in the full sample and in the subsample (0 to nSubsamples - 1)
+  void fill(double x, double y, const double* moments, int subsample)
+  {
+    static_assert(kNDim == 2, "fill(x, moments, subsample) for TProfile");
+    const int binX = mAxisX.findBin(x);
+    const int binY = mAxisY.findBin(y);
+    const int cell = binX + (mAxisX.nBins() + 2) * binY; // global bin of TH2
+    const bool inRange = mStatOverflows || (binX > 0 && binX <= mAxisX.nBins() && binY > 0 && binY <= mAxisY.nBins());
+    fillSet(0, cell, inRange, x, y, moments);
+    fillSet(1 + subsample, cell, inRange, x, y, moments);
+  }
+
+  /// Adds the accumulated statistics and entries to the profiles
+  void flush()
+  {
+    for (std::size_t set = 0; set < mNFills.size(); ++set) {
+      if (mNFills[set] == 0) {
+        continue;
+      }
+      for (std::size_t i = 0; i < mNMoments; ++i) {
+        auto& target = mTargets[set * mNMoments + i];
+        const auto entries = target.profile->GetEntries();
+        std::array<double, kNStats> stats{};
+        target.profile->GetStats(stats.data());
+        for (int k = 0; k < kNStats; ++k) {
+          stats[k] += target.stats[k];
+        }
+        target.profile->PutStats(stats.data());
+        target.profile->SetEntries(entries + mNFills[set]);
+        target.stats.fill(0.);
+      }
+      mNFills[set] = 0;
+    }
+  }
+
+ private:
+  static constexpr int kNStats = kNDim == 2 ? 9 : 6; // size of the statistics array, see TProfile::GetStats, TProfile2D::GetStats
+
+  struct Target {
+    TProfileND* profile;
+    double* content;  // sum of the values
+    double* sumw2;    // sum of the squared values
+    double* binSumw2; // sum of the squared weights, only if enabled
+    std::array<double, kNStats> stats;
+  };
+
+  void fillSet(std::size_t set, int cell, bool inRange, double x, double y, const double* moments)
+  {
+    for (std::size_t i = 0; i < mNMoments; ++i) {
+      auto& target = mTargets[set * mNMoments + i];
+      const double v = moments[i];
+      target.content[cell] += v;
+      if (target.sumw2 != nullptr) {
+        target.sumw2[cell] += v * v;
+      }
+      target.profile->SetBinEntries(cell, target.profile->GetBinEntries(cell) + 1.);
+      if (target.binSumw2 != nullptr) {
+        target.binSumw2[cell] += 1.;
+      }
+      if (!inRange) {
+        continue;
+      }
+      auto& s = target.stats;
+      s[0] += 1.;
+      s[1] += 1.;
+      s[2] += x;
+      s[3] += x * x;
+      if constexpr (kNDim == 2) {
+        s[4] += y;
+        s[5] += y * y;
+        s[6] += x * y;
+        s[7] += v;
+        s[8] += v * v;
+      } else {
+        s[4] += v;
+        s[5] += v * v;
+      }
+    }
+    ++mNFills[set];
+  }
+
+  std::size_t mNMoments = 0;
+  DenseAxis mAxisX;
+  DenseAxis mAxisY;
+  bool mStatOverflows = false;
+  std::vector<Target> mTargets; // set-major: the moments of the full sample, then of each subsample
+  std::vector<int64_t> mNFills; // events per set since the last flush
+};
+
+} // namespace o2::analysis::ebye
+
+#endif // PWGCF_EBYEFLUCTUATIONS_CORE_EBYEMOMENTS_H_
@@ -15,6 +15,7 @@
 
 #include <iostream>
 #include <array>
+#include <vector>
 #include <TH1F.h>
 // O2 includes
 #include "Framework/AnalysisDataModel.h"
@@ -89,7 +90,12 @@ struct FactorialMoments {
   array<Int_t, 5> countTracks{0, 0, 0, 0, 0};
   array<array<array<Double_t, nBins>, 5>, 6> fqEvent;
   array<array<Double_t, nBins>, 5> binConEvent;
-  std::vector<std::shared_ptr<TH2>> mHistArrReset;
+  // eta-phi cells of the M x M binnings, as the histograms of the moments: eta in [kEtaMin, kEtaMax), phi in [0, 2pi)
+  static constexpr Double_t kEtaMin = -0.8;
+  static constexpr Double_t kEtaMax = 0.8;
+  std::vector<std::vector<Int_t>> mCellCounts;   // tracks per cell of the event, one grid per (pT bin, M binning)
+  std::vector<std::vector<Int_t>> mTouchedCells; // cells of each grid filled in the event, to read and clear only them
+  std::vector<array<Double_t, 6>> mFallingFactorials; // n (n - 1) ... (n - q + 1) for the orders q = 2, ..., 7
   std::vector<std::shared_ptr<TH1>> mHistArrQA;
   std::vector<std::shared_ptr<TH1>> mFqBinFinal;
   std::vector<std::shared_ptr<TH1>> mBinConFinal;
@@ -116,8 +122,8 @@ struct FactorialMoments {
       mHistArrQA.push_back(std::get<std::shared_ptr<TH1>>(histos.add(Form("bin%i/mPhi", iPt + 1), Form("#phi for bin %.2f-%.2f;#phi", confPtBins.value[2 * iPt], confPtBins.value[2 * iPt + 1]), HistType::kTH1F, {{1000, 0, 2 * TMath::Pi()}})));
       mHistArrQA.push_back(std::get<std::shared_ptr<TH1>>(histos.add(Form("bin%i/mMultiplicity", iPt + 1), Form("Multiplicity for bin %.2f-%.2f;Multiplicity", confPtBins.value[2 * iPt], confPtBins.value[2 * iPt + 1]), HistType::kTH1F, {{1000, 0, 8000}})));
       for (auto iM = 0; iM < nBins; ++iM) {
-        auto mHistsR = std::get<std::shared_ptr<TH2>>(histos.add(Form("bin%i/Reset/mEtaPhi%i", iPt + 1, iM), Form("#eta#phi_%i for bin %.2f-%.2f;#eta;#phi", iM, confPtBins.value[2 * iPt], confPtBins.value[2 * iPt + 1]), HistType::kTH2F, {{binningM[iM], -0.8, 0.8}, {binningM[iM], 0, 2 * TMath::Pi()}}));
-        mHistArrReset.push_back(mHistsR);
+        mCellCounts.emplace_back(binningM[iM] * binningM[iM], 0);
+        mTouchedCells.emplace_back();
       }
       for (auto i = 0; i < 6; ++i) {
         auto mHistFq = std::get<std::shared_ptr<TH1>>(histos.add(Form("mFinalFq%i_bin%i", i + 2, iPt + 1), Form("Final F_%i for bin %.2f-%.2f;M", i + 2, confPtBins.value[2 * iPt], confPtBins.value[2 * iPt + 1]), HistType::kTH1F, {{nBins, -0.5, nBins - 0.5}}));
@@ -137,14 +143,48 @@ struct FactorialMoments {
         mHistArrQA[iPt * 4 + 1]->Fill(track.pt());
         mHistArrQA[iPt * 4 + 2]->Fill(track.phi());
         countTracks[iPt]++;
-        for (auto iM = 0; iM < nBins; ++iM) {
-          mHistArrReset[iPt * nBins + iM]->Fill(track.eta(), track.phi());
-        }
+        countTrack(iPt, track.eta(), track.phi());
       }
     }
   }
 
-  void calculateMoments(std::vector<std::shared_ptr<TH2>> hist)
+  /// Counts the track in its cell of each M x M binning, with the bins of TAxis::FindBin
+  void countTrack(Int_t iPt, Double_t eta, Double_t phi)
+  {
+    if (eta < kEtaMin || !(eta < kEtaMax) || phi < 0. || !(phi < TMath::TwoPi())) {
+      return;
+    }
+    for (auto iM = 0; iM < nBins; ++iM) {
+      const Int_t iEta = static_cast<Int_t>(binningM[iM] * (eta - kEtaMin) / (kEtaMax - kEtaMin));
+      const Int_t iPhi = static_cast<Int_t>(binningM[iM] * phi / TMath::TwoPi());
+      if (iEta >= binningM[iM] || iPhi >= binningM[iM]) {
+        continue; // rounded to the upper edge, overflow as for the histograms
+      }
+      const Int_t cell = iEta * binningM[iM] + iPhi;
+      auto& counts = mCellCounts[iPt * nBins + iM];
+      if (counts[cell]++ == 0) {
+        mTouchedCells[iPt * nBins + iM].push_back(cell);
+      }
+    }
+  }
+
+  /// n! / (n - q)! for the orders q = 2, ..., 7, zero for n < q
+  const array<Double_t, 6>& fallingFactorials(Int_t n)
+  {
+    while (static_cast<Int_t>(mFallingFactorials.size()) <= n) {
+      const Int_t m = mFallingFactorials.size();
+      array<Double_t, 6> ff{};
+      Double_t product = m * (m - 1.);
+      for (auto iOrder = 0; iOrder < 6; ++iOrder) {
+        ff[iOrder] = m >= iOrder + 2 ? product : 0.;
+        product *= m - (iOrder + 2);
+      }
+      mFallingFactorials.push_back(ff);
+    }
+    return mFallingFactorials[n];
+  }
+
+  void calculateMoments()
   {
     Double_t binContent = 0;
     // Calculate the normalized factorial moments
@@ -153,23 +193,19 @@ struct FactorialMoments {
         binContent = 0;
         Double_t sumfqBin[6] = {0};
 
-        for (auto iEta = 1; iEta <= hist[iPt * nBins + iM]->GetNbinsX(); ++iEta) {
-          for (auto iPhi = 1; iPhi <= hist[iPt * nBins + iM]->GetNbinsY(); ++iPhi) {
-            double binconVal = 0;
-            binconVal = hist[iPt * nBins + iM]->GetBinContent(iEta, iPhi);
-            binContent += binconVal;
-            for (auto iOrder = 0; iOrder < 6; ++iOrder) {
-              Double_t fqBin = 0;
-              if (binconVal >= iOrder + 2) {
-                fqBin = TMath::Factorial(binconVal) / (TMath::Factorial(binconVal - (iOrder + 2)));
-              }
-              if (isnan(fqBin)) {
-                break;
-              }
-              sumfqBin[iOrder] += fqBin;
-            }
+        // only the filled cells contribute, they are cleared for the next event
+        auto& counts = mCellCounts[iPt * nBins + iM];
+        auto& touched = mTouchedCells[iPt * nBins + iM];
+        for (const auto cell : touched) {
+          const Int_t binconVal = counts[cell];
+          counts[cell] = 0;
+          binContent += binconVal;
+          const auto& fqBin = fallingFactorials(binconVal);
+          for (auto iOrder = 0; iOrder < 6; ++iOrder) {
+            sumfqBin[iOrder] += fqBin[iOrder];
           }
         }
+        touched.clear();
         binConEvent[iPt][iM] = binContent / (TMath::Power(binningM[iM], 2));
         for (auto iOrder = 0; iOrder < 6; ++iOrder) {
           if (sumfqBin[iOrder] > 0) {
@@ -200,9 +236,6 @@ struct FactorialMoments {
     histos.fill(HIST("mCentFT0A"), coll.centFT0A());
     histos.fill(HIST("mCentFT0C"), coll.centFT0C());
 
-    for (auto const& h : mHistArrReset) {
-      h->Reset();
-    }
     countTracks = {0, 0, 0, 0, 0};
     fqEvent = {0, 0, 0, 0, 0, 0};
     binConEvent = {0, 0, 0, 0, 0};
@@ -239,7 +272,7 @@ struct FactorialMoments {
       }
     }
     // Calculate the normalized factorial moments
-    calculateMoments(mHistArrReset);
+    calculateMoments();
   }
   PROCESS_SWITCH(FactorialMoments, processRun3, "main process function", false);
 
@@ -255,9 +288,6 @@ struct FactorialMoments {
     histos.fill(HIST("mVertexY"), coll.posY());
     histos.fill(HIST("mVertexZ"), coll.posZ());
     histos.fill(HIST("mCentFT0M"), coll.centRun2V0M());
-    for (auto const& h : mHistArrReset) {
-      h->Reset();
-    }
 
     countTracks = {0, 0, 0, 0, 0};
     fqEvent = {0, 0, 0, 0, 0, 0};
@@ -295,7 +325,7 @@ struct FactorialMoments {
       }
     }
     // Calculate the normalized factorial moments
-    calculateMoments(mHistArrReset);
+    calculateMoments();
   }
   PROCESS_SWITCH(FactorialMoments, processRun2, "for RUN2", false);
 };
@@ -26,6 +26,7 @@
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "Common/DataModel/Centrality.h"
 #include "Common/DataModel/Multiplicity.h"
+#include "PWGCF/EbyEFluctuations/Core/EbyEMoments.h"
 
 #include "TList.h"
 #include "TProfile.h"
@@ -241,6 +242,7 @@ struct MeanptFluctuations_analysis {
   // Define output
   HistogramRegistry registry{"registry", {}, OutputObjHandlingPolicy::AnalysisObject};
   std::vector<std::vector<std::shared_ptr<TProfile2D>>> Subsample;
+  o2::analysis::ebye::EbyEMoments<TProfile2D> moments; // full sample and subsamples, filled with the bin found once per event
   TRandom3* fRndm = new TRandom3(0);
 
   void init(o2::framework::InitContext&)
@@ -266,6 +268,12 @@ struct MeanptFluctuations_analysis {
       Subsample[i][2] = std::get<std::shared_ptr<TProfile2D>>(registry.add(Form("Subsample_%d/Prof_skew_t1", i), "", {HistType::kTProfile2D, {centAxis, multAxis}}));
       Subsample[i][3] = std::get<std::shared_ptr<TProfile2D>>(registry.add(Form("Subsample_%d/Prof_kurt_t1", i), "", {HistType::kTProfile2D, {centAxis, multAxis}}));
     }
+
+    moments.addSet({registry.get<TProfile2D>(HIST("Prof_mean_t1")).get(), registry.get<TProfile2D>(HIST("Prof_var_t1")).get(),
+                    registry.get<TProfile2D>(HIST("Prof_skew_t1")).get(), registry.get<TProfile2D>(HIST("Prof_kurt_t1")).get()});
+    for (int i = 0; i < cfgNSubsample; i++) {
+      moments.addSet({Subsample[i][0].get(), Subsample[i][1].get(), Subsample[i][2].get(), Subsample[i][3].get()});
+    }
   }
 
   float mean_term1;
@@ -273,32 +281,29 @@ struct MeanptFluctuations_analysis {
   float skewness_term1;
   float kurtosis_term1;
 
-  // void process(aod::MultPtQn::iterator const& event_ptqn)
-  void process(FilteredMultPtQn::iterator const& event_ptqn)
+  // void process(aod::MultPtQn const& events)
+  void process(FilteredMultPtQn const& events)
   {
-    // LOGF(info, "Centrality= %f Nch= %f Q1= %f Q2= %f", event_ptqn.centrality(), event_ptqn.n_ch(), event_ptqn.q1(), event_ptqn.q2());
-
-    // calculating observables
-    mean_term1 = event_ptqn.q1() / event_ptqn.n_ch();
-    variance_term1 = (TMath::Power(event_ptqn.q1(), 2.0f) - event_ptqn.q2()) / (event_ptqn.n_ch() * (event_ptqn.n_ch() - 1.0f));
-    skewness_term1 = (TMath::Power(event_ptqn.q1(), 3.0f) - 3.0f * event_ptqn.q2() * event_ptqn.q1() + 2.0f * event_ptqn.q3()) / (event_ptqn.n_ch() * (event_ptqn.n_ch() - 1.0f) * (event_ptqn.n_ch() - 2.0f));
-    kurtosis_term1 = (TMath::Power(event_ptqn.q1(), 4.0f) - (6.0f * event_ptqn.q4()) + (8.0f * event_ptqn.q1() * event_ptqn.q3()) - (6.0f * TMath::Power(event_ptqn.q1(), 2.0f) * event_ptqn.q2()) + (3.0f * TMath::Power(event_ptqn.q2(), 2.0f))) / (event_ptqn.n_ch() * (event_ptqn.n_ch() - 1.0f) * (event_ptqn.n_ch() - 2.0f) * (event_ptqn.n_ch() - 3.0f));
-
-    // filling profiles and histograms for central values
-    registry.get<TProfile2D>(HIST("Prof_mean_t1"))->Fill(event_ptqn.centrality(), event_ptqn.n_ch(), mean_term1);
-    registry.get<TProfile2D>(HIST("Prof_var_t1"))->Fill(event_ptqn.centrality(), event_ptqn.n_ch(), variance_term1);
-    registry.get<TProfile2D>(HIST("Prof_skew_t1"))->Fill(event_ptqn.centrality(), event_ptqn.n_ch(), skewness_term1);
-    registry.get<TProfile2D>(HIST("Prof_kurt_t1"))->Fill(event_ptqn.centrality(), event_ptqn.n_ch(), kurtosis_term1);
-    registry.fill(HIST("Hist2D_Nch_centrality"), event_ptqn.centrality(), event_ptqn.n_ch());
-    registry.fill(HIST("Hist2D_meanpt_centrality"), event_ptqn.centrality(), mean_term1);
-
-    // selecting subsample and filling profiles
-    float l_Random = fRndm->Rndm();
-    int SampleIndex = static_cast<int>(cfgNSubsample * l_Random);
-    Subsample[SampleIndex][0]->Fill(event_ptqn.centrality(), event_ptqn.n_ch(), mean_term1);
-    Subsample[SampleIndex][1]->Fill(event_ptqn.centrality(), event_ptqn.n_ch(), variance_term1);
-    Subsample[SampleIndex][2]->Fill(event_ptqn.centrality(), event_ptqn.n_ch(), skewness_term1);
-    Subsample[SampleIndex][3]->Fill(event_ptqn.centrality(), event_ptqn.n_ch(), kurtosis_term1);
+    for (const auto& event_ptqn : events) {
+      // LOGF(info, "Centrality= %f Nch= %f Q1= %f Q2= %f", event_ptqn.centrality(), event_ptqn.n_ch(), event_ptqn.q1(), event_ptqn.q2());
+
+      // calculating observables
+      mean_term1 = event_ptqn.q1() / event_ptqn.n_ch();
+      variance_term1 = (TMath::Power(event_ptqn.q1(), 2.0f) - event_ptqn.q2()) / (event_ptqn.n_ch() * (event_ptqn.n_ch() - 1.0f));
+      skewness_term1 = (TMath::Power(event_ptqn.q1(), 3.0f) - 3.0f * event_ptqn.q2() * event_ptqn.q1() + 2.0f * event_ptqn.q3()) / (event_ptqn.n_ch() * (event_ptqn.n_ch() - 1.0f) * (event_ptqn.n_ch() - 2.0f));
+      kurtosis_term1 = (TMath::Power(event_ptqn.q1(), 4.0f) - (6.0f * event_ptqn.q4()) + (8.0f * event_ptqn.q1() * event_ptqn.q3()) - (6.0f * TMath::Power(event_ptqn.q1(), 2.0f) * event_ptqn.q2()) + (3.0f * TMath::Power(event_ptqn.q2(), 2.0f))) / (event_ptqn.n_ch() * (event_ptqn.n_ch() - 1.0f) * (event_ptqn.n_ch() - 2.0f) * (event_ptqn.n_ch() - 3.0f));
+
+      // filling histograms for central values
+      registry.fill(HIST("Hist2D_Nch_centrality"), event_ptqn.centrality(), event_ptqn.n_ch());
+      registry.fill(HIST("Hist2D_meanpt_centrality"), event_ptqn.centrality(), mean_term1);
+
+      // selecting subsample and filling profiles of the central values and of the subsample
+      float l_Random = fRndm->Rndm();
+      int SampleIndex = static_cast<int>(cfgNSubsample * l_Random);
+      const double terms[4] = {mean_term1, variance_term1, skewness_term1, kurtosis_term1};
+      moments.fill(event_ptqn.centrality(), event_ptqn.n_ch(), terms, SampleIndex);
+    }
+    moments.flush();
   }
 };
 
@@ -23,6 +23,7 @@
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "Common/DataModel/Centrality.h"
 #include "Common/DataModel/PIDResponse.h"
+#include "PWGCF/EbyEFluctuations/Core/EbyEMoments.h"
 
 #include "TList.h"
 #include "TProfile.h"
@@ -188,6 +189,8 @@ struct NetProtonCumulants_analysis {
   HistogramRegistry registry{"registry", {}, OutputObjHandlingPolicy::AnalysisObject};
   std::vector<std::vector<std::shared_ptr<TProfile2D>>> Subsample2D;
   std::vector<std::vector<std::shared_ptr<TProfile>>> Subsample;
+  o2::analysis::ebye::EbyEMoments<TProfile2D> moments2D; // full sample and subsamples, filled with the bin found once per event
+  o2::analysis::ebye::EbyEMoments<TProfile> moments1D;
   TRandom3* fRndm = new TRandom3(0);
 
   void init(o2::framework::InitContext&)
@@ -239,51 +242,47 @@ struct NetProtonCumulants_analysis {
       Subsample[i][6] = std::get<std::shared_ptr<TProfile>>(registry.add(Form("Subsample_%d/Prof_mu7_netproton", i), "", {HistType::kTProfile, {centAxis}}));
       Subsample[i][7] = std::get<std::shared_ptr<TProfile>>(registry.add(Form("Subsample_%d/Prof_mu8_netproton", i), "", {HistType::kTProfile, {centAxis}}));
     }
+
+    moments2D.addSet({registry.get<TProfile2D>(HIST("Prof2D_mu1_netproton")).get(), registry.get<TProfile2D>(HIST("Prof2D_mu2_netproton")).get(),
+                      registry.get<TProfile2D>(HIST("Prof2D_mu3_netproton")).get(), registry.get<TProfile2D>(HIST("Prof2D_mu4_netproton")).get(),
+                      registry.get<TProfile2D>(HIST("Prof2D_mu5_netproton")).get(), registry.get<TProfile2D>(HIST("Prof2D_mu6_netproton")).get(),
+                      registry.get<TProfile2D>(HIST("Prof2D_mu7_netproton")).get(), registry.get<TProfile2D>(HIST("Prof2D_mu8_netproton")).get()});
+    moments1D.addSet({registry.get<TProfile>(HIST("Prof_mu1_netproton")).get(), registry.get<TProfile>(HIST("Prof_mu2_netproton")).get(),
+                      registry.get<TProfile>(HIST("Prof_mu3_netproton")).get(), registry.get<TProfile>(HIST("Prof_mu4_netproton")).get(),
+                      registry.get<TProfile>(HIST("Prof_mu5_netproton")).get(), registry.get<TProfile>(HIST("Prof_mu6_netproton")).get(),
+                      registry.get<TProfile>(HIST("Prof_mu7_netproton")).get(), registry.get<TProfile>(HIST("Prof_mu8_netproton")).get()});
+    for (int i = 0; i < cfgNSubsample; i++) {
+      std::vector<TProfile2D*> subsample2D;
+      std::vector<TProfile*> subsample;
+      for (int k = 0; k < 8; k++) {
+        subsample2D.push_back(Subsample2D[i][k].get());
+        subsample.push_back(Subsample[i][k].get());
+      }
+      moments2D.addSet(subsample2D);
+      moments1D.addSet(subsample);
+    }
   }
 
-  void process(aod::NetProton::iterator const& event_netproton)
+  void process(aod::NetProton const& events)
   {
-    // LOGF(info, "Centrality= %f Nch= %f net-proton no. = %f", event_netproton.centrality(), event_netproton.n_ch(), event_netproton.net_prot_no());
-
-    // filling profiles for central values
-    registry.get<TProfile2D>(HIST("Prof2D_mu1_netproton"))->Fill(event_netproton.centrality(), event_netproton.n_ch(), pow(event_netproton.net_prot_no(), 1.0));
-    registry.get<TProfile2D>(HIST("Prof2D_mu2_netproton"))->Fill(event_netproton.centrality(), event_netproton.n_ch(), pow(event_netproton.net_prot_no(), 2.0));
-    registry.get<TProfile2D>(HIST("Prof2D_mu3_netproton"))->Fill(event_netproton.centrality(), event_netproton.n_ch(), pow(event_netproton.net_prot_no(), 3.0));
-    registry.get<TProfile2D>(HIST("Prof2D_mu4_netproton"))->Fill(event_netproton.centrality(), event_netproton.n_ch(), pow(event_netproton.net_prot_no(), 4.0));
-    registry.get<TProfile2D>(HIST("Prof2D_mu5_netproton"))->Fill(event_netproton.centrality(), event_netproton.n_ch(), pow(event_netproton.net_prot_no(), 5.0));
-    registry.get<TProfile2D>(HIST("Prof2D_mu6_netproton"))->Fill(event_netproton.centrality(), event_netproton.n_ch(), pow(event_netproton.net_prot_no(), 6.0));
-    registry.get<TProfile2D>(HIST("Prof2D_mu7_netproton"))->Fill(event_netproton.centrality(), event_netproton.n_ch(), pow(event_netproton.net_prot_no(), 7.0));
-    registry.get<TProfile2D>(HIST("Prof2D_mu8_netproton"))->Fill(event_netproton.centrality(), event_netproton.n_ch(), pow(event_netproton.net_prot_no(), 8.0));
-
-    registry.get<TProfile>(HIST("Prof_mu1_netproton"))->Fill(event_netproton.centrality(), pow(event_netproton.net_prot_no(), 1.0));
-    registry.get<TProfile>(HIST("Prof_mu2_netproton"))->Fill(event_netproton.centrality(), pow(event_netproton.net_prot_no(), 2.0));
-    registry.get<TProfile>(HIST("Prof_mu3_netproton"))->Fill(event_netproton.centrality(), pow(event_netproton.net_prot_no(), 3.0));
-    registry.get<TProfile>(HIST("Prof_mu4_netproton"))->Fill(event_netproton.centrality(), pow(event_netproton.net_prot_no(), 4.0));
-    registry.get<TProfile>(HIST("Prof_mu5_netproton"))->Fill(event_netproton.centrality(), pow(event_netproton.net_prot_no(), 5.0));
-    registry.get<TProfile>(HIST("Prof_mu6_netproton"))->Fill(event_netproton.centrality(), pow(event_netproton.net_prot_no(), 6.0));
-    registry.get<TProfile>(HIST("Prof_mu7_netproton"))->Fill(event_netproton.centrality(), pow(event_netproton.net_prot_no(), 7.0));
-    registry.get<TProfile>(HIST("Prof_mu8_netproton"))->Fill(event_netproton.centrality(), pow(event_netproton.net_prot_no(), 8.0));
-
-    // selecting subsample and filling profiles
-    float l_Random = fRndm->Rndm();
-    int SampleIndex = static_cast<int>(cfgNSubsample * l_Random);
-    Subsample2D[SampleIndex][0]->Fill(event_netproton.centrality(), event_netproton.n_ch(), pow(event_netproton.net_prot_no(), 1.0));
-    Subsample2D[SampleIndex][1]->Fill(event_netproton.centrality(), event_netproton.n_ch(), pow(event_netproton.net_prot_no(), 2.0));
-    Subsample2D[SampleIndex][2]->Fill(event_netproton.centrality(), event_netproton.n_ch(), pow(event_netproton.net_prot_no(), 3.0));
-    Subsample2D[SampleIndex][3]->Fill(event_netproton.centrality(), event_netproton.n_ch(), pow(event_netproton.net_prot_no(), 4.0));
-    Subsample2D[SampleIndex][4]->Fill(event_netproton.centrality(), event_netproton.n_ch(), pow(event_netproton.net_prot_no(), 5.0));
-    Subsample2D[SampleIndex][5]->Fill(event_netproton.centrality(), event_netproton.n_ch(), pow(event_netproton.net_prot_no(), 6.0));
-    Subsample2D[SampleIndex][6]->Fill(event_netproton.centrality(), event_netproton.n_ch(), pow(event_netproton.net_prot_no(), 7.0));
-    Subsample2D[SampleIndex][7]->Fill(event_netproton.centrality(), event_netproton.n_ch(), pow(event_netproton.net_prot_no(), 8.0));
-
-    Subsample[SampleIndex][0]->Fill(event_netproton.centrality(), pow(event_netproton.net_prot_no(), 1.0));
-    Subsample[SampleIndex][1]->Fill(event_netproton.centrality(), pow(event_netproton.net_prot_no(), 2.0));
-    Subsample[SampleIndex][2]->Fill(event_netproton.centrality(), pow(event_netproton.net_prot_no(), 3.0));
-    Subsample[SampleIndex][3]->Fill(event_netproton.centrality(), pow(event_netproton.net_prot_no(), 4.0));
-    Subsample[SampleIndex][4]->Fill(event_netproton.centrality(), pow(event_netproton.net_prot_no(), 5.0));
-    Subsample[SampleIndex][5]->Fill(event_netproton.centrality(), pow(event_netproton.net_prot_no(), 6.0));
-    Subsample[SampleIndex][6]->Fill(event_netproton.centrality(), pow(event_netproton.net_prot_no(), 7.0));
-    Subsample[SampleIndex][7]->Fill(event_netproton.centrality(), pow(event_netproton.net_prot_no(), 8.0));
+    double mu[8];
+    for (const auto& event_netproton : events) {
+      // LOGF(info, "Centrality= %f Nch= %f net-proton no. = %f", event_netproton.centrality(), event_netproton.n_ch(), event_netproton.net_prot_no());
+
+      // powers of the net-proton number
+      mu[0] = event_netproton.net_prot_no();
+      for (int k = 1; k < 8; k++) {
+        mu[k] = mu[k - 1] * mu[0];
+      }
+
+      // selecting subsample and filling profiles of the central values and of the subsample
+      float l_Random = fRndm->Rndm();
+      int SampleIndex = static_cast<int>(cfgNSubsample * l_Random);
+      moments2D.fill(event_netproton.centrality(), event_netproton.n_ch(), mu, SampleIndex);
+      moments1D.fill(event_netproton.centrality(), mu, SampleIndex);
+    }
+    moments2D.flush();
+    moments1D.flush();
   }
 };
 
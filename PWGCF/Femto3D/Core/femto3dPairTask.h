@@ -23,11 +23,16 @@
 // #include "Framework/Logger.h"
 // #include "Common/DataModel/Multiplicity.h"
 
+#include <cmath>
+#include <cstdint>
 #include <vector>
 #include "TLorentzVector.h"
 #include "TVector3.h"
 #include "TDatabasePDG.h"
 
+#include "PWGCF/Core/PairKinematics.h"
+#include "PWGCF/Core/PhiStar.h"
+
 double particle_mass(int PDGcode)
 {
   // if(PDGcode == 2212) return TDatabasePDG::Instance()->GetParticle(2212)->Mass();
@@ -93,6 +98,34 @@ TVector3 GetQLCMSFrom4vectors(TLorentzVector& first4momentum, TLorentzVector& se
 
 //====================================================================================
 
+// compact copy of the kinematics of a selected track, to keep it in the mixing pools independently of the tables
+// (same accessors as the SingleTrackSels table, for the FemtoPair)
+struct FemtoParticle {
+  float _p = 0.0, _eta = 0.0, _phi = 0.0;
+  int8_t _sign = 0;
+
+  FemtoParticle() {}
+  template <typename TrackType>
+  explicit FemtoParticle(TrackType const& track) : _p(track.p()), _eta(track.eta()), _phi(track.phi()), _sign(track.sign())
+  {
+  }
+
+  float p() const { return _p; }
+  float eta() const { return _eta; }
+  float phi() const { return _phi; }
+  int8_t sign() const { return _sign; }
+  float pt() const { return _p / std::cosh(_eta); }
+  float px() const { return pt() * std::sin(_phi); }
+  float py() const { return pt() * std::cos(_phi); }
+  float pz() const { return _p * std::tanh(_eta); }
+  float phiStar(float magfield = 0.0, float radius = 1.6) const
+  {
+    if (magfield == 0.0)
+      return -1000.0;
+    return o2::analysis::phistar::phiAtRadius(_phi, _sign, pt(), magfield, radius);
+  }
+};
+
 template <typename TrackType>
 class FemtoPair
 {
@@ -140,8 +173,16 @@ class FemtoPair
   void SetIdentical(const bool& isidentical) { _isidentical = isidentical; }
   void SetMagField1(const float& magfield1) { _magfield1 = magfield1; }
   void SetMagField2(const float& magfield2) { _magfield2 = magfield2; }
-  void SetPDG1(const int& PDG1) { _PDG1 = PDG1; }
-  void SetPDG2(const int& PDG2) { _PDG2 = PDG2; }
+  void SetPDG1(const int& PDG1)
+  {
+    _PDG1 = PDG1;
+    _mass1 = PDG1 ? particle_mass(PDG1) : 0.0;
+  }
+  void SetPDG2(const int& PDG2)
+  {
+    _PDG2 = PDG2;
+    _mass2 = PDG2 ? particle_mass(PDG2) : 0.0;
+  }
   int GetPDG1() { return _PDG1; }
   int GetPDG2() { return _PDG2; }
   void ResetPair();
@@ -166,6 +207,7 @@ class FemtoPair
     else
       return 1000;
   }
+  o2::analysis::pairkinematics::PairKinematics GetKinematics() const;
   float GetKstar() const;
   TVector3 GetQLCMS() const;
   float GetKt() const;
@@ -176,6 +218,7 @@ class FemtoPair
   TrackType _second = NULL;
   float _magfield1 = 0.0, _magfield2 = 0.0;
   int _PDG1 = 0, _PDG2 = 0;
+  float _mass1 = 0.0, _mass2 = 0.0; // masses of the PDG codes, looked up once
   bool _isidentical = true;
 };
 
@@ -195,6 +238,8 @@ void FemtoPair<TrackType>::ResetAll()
   _magfield2 = 0.0;
   _PDG1 = 0;
   _PDG2 = 0;
+  _mass1 = 0.0;
+  _mass2 = 0.0;
   _isidentical = true;
 }
 
@@ -213,6 +258,13 @@ bool FemtoPair<TrackType>::IsClosePair(const float& deta, const float& dphi, con
   return false;
 }
 
+template <typename TrackType>
+o2::analysis::pairkinematics::PairKinematics FemtoPair<TrackType>::GetKinematics() const
+{
+  return o2::analysis::pairkinematics::computePairPtEtaPhi(_first->pt(), _first->eta(), _first->phi(), _mass1,
+                                                           _second->pt(), _second->eta(), _second->phi(), _mass2);
+}
+
 template <typename TrackType>
 float FemtoPair<TrackType>::GetKstar() const
 {
@@ -223,12 +275,8 @@ float FemtoPair<TrackType>::GetKstar() const
   if (_PDG1 * _PDG2 == 0)
     return -1000;
 
-  TLorentzVector first4momentum;
-  first4momentum.SetPtEtaPhiM(_first->pt(), _first->eta(), _first->phi(), particle_mass(_PDG1));
-  TLorentzVector second4momentum;
-  second4momentum.SetPtEtaPhiM(_second->pt(), _second->eta(), _second->phi(), particle_mass(_PDG2));
-
-  return GetKstarFrom4vectors(first4momentum, second4momentum, _isidentical);
+  const auto kinematics = GetKinematics();
+  return _isidentical ? 0.5 * kinematics.qinv : kinematics.kstar;
 }
 
 template <typename TrackType>
@@ -241,12 +289,8 @@ TVector3 FemtoPair<TrackType>::GetQLCMS() const
   if (_PDG1 * _PDG2 == 0)
     return TVector3(-1000, -1000, -1000);
 
-  TLorentzVector first4momentum;
-  first4momentum.SetPtEtaPhiM(_first->pt(), _first->eta(), _first->phi(), particle_mass(_PDG1));
-  TLorentzVector second4momentum;
-  second4momentum.SetPtEtaPhiM(_second->pt(), _second->eta(), _second->phi(), particle_mass(_PDG2));
-
-  return GetQLCMSFrom4vectors(first4momentum, second4momentum);
+  const auto kinematics = GetKinematics();
+  return TVector3(kinematics.qout, kinematics.qside, kinematics.qlong);
 }
 
 template <typename TrackType>
@@ -272,14 +316,11 @@ float FemtoPair<TrackType>::GetMt() const
   if (_PDG1 * _PDG2 == 0)
     return -1000;
 
-  TLorentzVector first4momentum;
-  first4momentum.SetPtEtaPhiM(_first->pt(), _first->eta(), _first->phi(), particle_mass(_PDG1));
-  TLorentzVector second4momentum;
-  second4momentum.SetPtEtaPhiM(_second->pt(), _second->eta(), _second->phi(), particle_mass(_PDG2));
-
-  TLorentzVector fourmomentasum = first4momentum + second4momentum;
+  const float firstEnergy = std::sqrt(_first->p() * _first->p() + _mass1 * _mass1);
+  const float secondEnergy = std::sqrt(_second->p() * _second->p() + _mass2 * _mass2);
+  const float sumPz = _first->pz() + _second->pz();
 
-  return 0.5 * fourmomentasum.Mt();
+  return 0.5 * std::sqrt((firstEnergy + secondEnergy) * (firstEnergy + secondEnergy) - sumPz * sumPz);
 }
 } // namespace o2::aod::singletrackselector
 
@@ -25,6 +25,7 @@
 #include "Common/DataModel/PIDResponse.h"
 #include "Framework/Logger.h"
 #include "Common/DataModel/Multiplicity.h"
+#include "PWGCF/Core/PhiStar.h"
 
 namespace o2::aod
 {
@@ -162,7 +163,7 @@ DECLARE_SOA_DYNAMIC_COLUMN(PhiStar, phiStar,
                              if (magfield == 0.0) {
                                return -1000.0;
                              } else {
-                               return phi + std::asin(-0.3 * magfield * sign * radius / (2.0 * p / std::cosh(eta)));
+                               return o2::analysis::phistar::phiAtRadius(phi, sign, p / std::cosh(eta), magfield, radius);
                              }
                            });
 
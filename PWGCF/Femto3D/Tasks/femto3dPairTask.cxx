@@ -21,6 +21,7 @@
 #include <TParameter.h>
 #include <TH1F.h>
 
+#include "PWGCF/Core/MixingPool.h"
 #include "PWGCF/Femto3D/Core/femto3dPairTask.h"
 #include "PWGCF/Femto3D/DataModel/singletrackselector.h"
 #include "TLorentzVector.h"
@@ -103,6 +104,11 @@ struct FemtoCorrelations {
   // P.P.P.S. choose wisely....
   // P.P.P.P.S this way is still being testing i might be reconsidered; might change in the future, keep looking at the source code
   Configurable<unsigned int> _MEreductionFactor{"MEreductionFactor", 1, "only one (pseudo)randomly choosen event out per pair $value events will be processed and contribute to the final mixing (if < 2 -> all the possible event pairs (per vertex&cent bin) will be processed); implemented for the sake of efficiency; look at the source code;"};
+  // the pools of events to mix with, per vertex&mult bin, keep compact copies of the selected tracks (see PWGCF/Core/MixingPool.h)
+  // with a limited depth each event is mixed with at most $depth events of its bin, either the most recent ones or a uniform random sample of all the previous ones (reservoir sampling)
+  Configurable<unsigned int> _mixingDepth{"mixingDepth", 0, "max. number of events kept per vertex&mult bin for the mixing (0 -- all the events, i.e. all the possible event pairs per bin)"};
+  Configurable<bool> _mixingReservoir{"mixingReservoir", false, "when the pool of a bin is full: true -- keep a uniform random sample of all the events of the bin (reservoir sampling); false -- keep the most recent events"};
+  Configurable<bool> _keepMixingPools{"keepMixingPools", false, "true -- keep the mixing pools between DFs (the events are then mixed also with the ones of the previous DFs); false -- mix only within a DF"};
 
   bool IsIdentical;
 
@@ -115,12 +121,18 @@ struct FemtoCorrelations {
   using FilteredCollisions = soa::Join<aod::SingleCollSels, aod::SingleCollExtras>;
   using FilteredTracks = aod::SingleTrackSels;
 
-  typedef std::shared_ptr<soa::Filtered<FilteredTracks>::iterator> trkType;
-  typedef std::shared_ptr<soa::Filtered<FilteredCollisions>::iterator> colType;
+  typedef o2::aod::singletrackselector::FemtoParticle trkRecord;
+  typedef const trkRecord* trkType;
 
-  std::map<int64_t, std::vector<trkType>> selectedtracks_1;
-  std::map<int64_t, std::vector<trkType>> selectedtracks_2;
-  std::map<std::pair<int, float>, std::vector<colType>> mixbins;
+  struct MixingEvent {
+    float magField = 0.0;
+    std::vector<trkRecord> tracks_1;
+    std::vector<trkRecord> tracks_2;
+  };
+
+  std::map<int64_t, std::vector<trkRecord>> selectedtracks_1;
+  std::map<int64_t, std::vector<trkRecord>> selectedtracks_2;
+  o2::analysis::mixing::MixingPool<MixingEvent, std::pair<int, float>> mixingPool;
 
   std::unique_ptr<o2::aod::singletrackselector::FemtoPair<trkType>> Pair = std::make_unique<o2::aod::singletrackselector::FemtoPair<trkType>>();
 
@@ -161,6 +173,10 @@ struct FemtoCorrelations {
     if (_vertexNbinsToMix.value < 1)
       LOGF(fatal, "The configured number of VertexZ bins is less than 1 !!!");
 
+    mixingPool.setDepth(_mixingDepth);
+    mixingPool.setPolicy(_mixingReservoir ? o2::analysis::mixing::PoolPolicy::kReservoir : o2::analysis::mixing::PoolPolicy::kFIFO);
+    mixingPool.setSeed(std::chrono::steady_clock::now().time_since_epoch().count());
+
     IsIdentical = (_sign_1 * _particlePDG_1 == _sign_2 * _particlePDG_2);
 
     Pair->SetIdentical(IsIdentical);
@@ -266,13 +282,13 @@ struct FemtoCorrelations {
     for (unsigned int ii = 0; ii < tracks.size(); ii++) { // nested loop for all the combinations
       for (unsigned int iii = ii + 1; iii < tracks.size(); iii++) {
 
-        Pair->SetPair(tracks[ii], tracks[iii]);
+        Pair->SetPair(&tracks[ii], &tracks[iii]);
         float pair_kT = Pair->GetKt();
 
         if (pair_kT < *_kTbins.value.begin() || pair_kT >= *(_kTbins.value.end() - 1))
           continue;
 
-        unsigned int kTbin = o2::aod::singletrackselector::getBinIndex<unsigned int>(pair_kT, _kTbins);
+        unsigned int kTbin = o2::analysis::pairkinematics::findBin(pair_kT, _kTbins.value);
         if (kTbin > SEhistos_1D[multBin].size())
           LOGF(fatal, "kTbin value obtained for a pair exceeds the configured number of kT bins (1D)");
         if (_fill3dCF && kTbin > SEhistos_3D[multBin].size())
@@ -309,16 +325,16 @@ struct FemtoCorrelations {
     if (_fill3dCF && multBin > SEhistos_3D.size())
       LOGF(fatal, "multBin value passed to the mixTracks function exceeds the configured number of Cent. bins (3D)");
 
-    for (auto ii : tracks1) {
-      for (auto iii : tracks2) {
+    for (auto const& ii : tracks1) {
+      for (auto const& iii : tracks2) {
 
-        Pair->SetPair(ii, iii);
+        Pair->SetPair(&ii, &iii);
         float pair_kT = Pair->GetKt();
 
         if (pair_kT < *_kTbins.value.begin() || pair_kT >= *(_kTbins.value.end() - 1))
           continue;
 
-        unsigned int kTbin = o2::aod::singletrackselector::getBinIndex<unsigned int>(pair_kT, _kTbins);
+        unsigned int kTbin = o2::analysis::pairkinematics::findBin(pair_kT, _kTbins.value);
         if (kTbin > SEhistos_1D[multBin].size())
           LOGF(fatal, "kTbin value obtained for a pair exceeds the configured number of kT bins (1D)");
         if (_fill3dCF && kTbin > SEhistos_3D[multBin].size())
@@ -390,7 +406,7 @@ struct FemtoCorrelations {
         continue;
 
       if (track.sign() == _sign_1 && (track.p() < _PIDtrshld_1 ? o2::aod::singletrackselector::TPCselection(track, TPCcuts_1) : o2::aod::singletrackselector::TOFselection(track, TOFcuts_1, _tpcNSigmaResidual_1.value))) { // filling the map: eventID <-> selected particles1
-        selectedtracks_1[track.singleCollSelId()].push_back(std::make_shared<decltype(track)>(track));
+        selectedtracks_1[track.singleCollSelId()].emplace_back(track);
 
         registry.fill(HIST("p_first"), track.p());
         if (_particlePDG_1 == 211) {
@@ -414,7 +430,7 @@ struct FemtoCorrelations {
       if (IsIdentical) {
         continue;
       } else if (track.sign() != _sign_2 && !TOFselection(track, std::make_pair(_particlePDGtoReject, _rejectWithinNsigmaTOF)) && (track.p() < _PIDtrshld_2 ? o2::aod::singletrackselector::TPCselection(track, TPCcuts_2) : o2::aod::singletrackselector::TOFselection(track, TOFcuts_2, _tpcNSigmaResidual_2.value))) { // filling the map: eventID <-> selected particles2 if (see condition above ^)
-        selectedtracks_2[track.singleCollSelId()].push_back(std::make_shared<decltype(track)>(track));
+        selectedtracks_2[track.singleCollSelId()].emplace_back(track);
 
         registry.fill(HIST("p_second"), track.p());
         if (_particlePDG_2 == 211) {
@@ -449,100 +465,60 @@ struct FemtoCorrelations {
       if (_requestVertexITSTPC && !collision.isVertexITSTPC())
         continue;
 
-      if (selectedtracks_1.find(collision.globalIndex()) == selectedtracks_1.end()) {
+      auto tracks_1 = selectedtracks_1.find(collision.globalIndex());
+      auto tracks_2 = selectedtracks_2.find(collision.globalIndex());
+      if (tracks_1 == selectedtracks_1.end()) {
         if (IsIdentical)
           continue;
-        else if (selectedtracks_2.find(collision.globalIndex()) == selectedtracks_2.end())
+        else if (tracks_2 == selectedtracks_2.end())
           continue;
       }
       int vertexBinToMix = std::floor((collision.posZ() + _vertexZ) / (2 * _vertexZ / _vertexNbinsToMix));
       float centBinToMix = o2::aod::singletrackselector::getBinIndex<float>(collision.multPerc(), _centBins, _multNsubBins);
+      unsigned int centBin = std::floor(centBinToMix);
 
-      mixbins[std::pair<int, float>{vertexBinToMix, centBinToMix}].push_back(std::make_shared<decltype(collision)>(collision));
-    }
-
-    //====================================== mixing starts here ======================================
-
-    if (IsIdentical) { //====================================== mixing identical ======================================
-
-      for (auto i = mixbins.begin(); i != mixbins.end(); i++) { // iterating over all vertex&mult bins
-        unsigned int EvPerBin = (i->second).size();
-
-        for (unsigned int indx1 = 0; indx1 < EvPerBin; indx1++) { // loop over all the events in each vertex&mult bin
-
-          auto col1 = (i->second)[indx1];
+      MixingEvent event;
+      event.magField = collision.magField();
+      if (tracks_1 != selectedtracks_1.end())
+        event.tracks_1 = std::move(tracks_1->second);
+      if (!IsIdentical && tracks_2 != selectedtracks_2.end())
+        event.tracks_2 = std::move(tracks_2->second);
 
-          Pair->SetMagField1(col1->magField());
-          Pair->SetMagField2(col1->magField());
-
-          unsigned int centBin = std::floor((i->first).second);
-          MultHistos[centBin]->Fill(col1->mult());
-
-          mixTracks(selectedtracks_1[col1->index()], centBin); // mixing SE identical
-
-          for (unsigned int indx2 = indx1 + 1; indx2 < EvPerBin; indx2++) { // nested loop for all the combinations of collisions in a chosen mult/vertex bin
-            if (_MEreductionFactor.value > 1) {
-              std::mt19937 mt(std::chrono::steady_clock::now().time_since_epoch().count());
-              if ((mt() % (_MEreductionFactor.value + 1)) < _MEreductionFactor.value)
-                continue;
-            }
-
-            auto col2 = (i->second)[indx2];
-
-            Pair->SetMagField2(col2->magField());
-            mixTracks<1>(selectedtracks_1[col1->index()], selectedtracks_1[col2->index()], centBin); // mixing ME identical, in <> brackets: 0 -- SE; 1 -- ME
-          }
-        }
-      }
+      //====================================== mixing starts here ======================================
 
-    } else { //====================================== mixing non-identical ======================================
+      MultHistos[centBin]->Fill(collision.mult());
 
-      for (auto i = mixbins.begin(); i != mixbins.end(); i++) { // iterating over all vertex&mult bins
-        unsigned int EvPerBin = (i->second).size();
+      Pair->SetMagField1(event.magField);
+      Pair->SetMagField2(event.magField);
+      if (IsIdentical)
+        mixTracks(event.tracks_1, centBin); // mixing SE identical
+      else
+        mixTracks<0>(event.tracks_1, event.tracks_2, centBin); // mixing SE non-identical, in <> brackets: 0 -- SE; 1 -- ME
 
-        for (unsigned int indx1 = 0; indx1 < EvPerBin; indx1++) { // loop over all the events in each vertex&mult bin
-
-          auto col1 = (i->second)[indx1];
-
-          Pair->SetMagField1(col1->magField());
-          Pair->SetMagField2(col1->magField());
-
-          unsigned int centBin = std::floor((i->first).second);
-          MultHistos[centBin]->Fill(col1->mult());
-
-          mixTracks<0>(selectedtracks_1[col1->index()], selectedtracks_2[col1->index()], centBin); // mixing SE non-identical, in <> brackets: 0 -- SE; 1 -- ME
-
-          for (unsigned int indx2 = indx1 + 1; indx2 < EvPerBin; indx2++) { // nested loop for all the combinations of collisions in a chosen mult/vertex bin
-            if (_MEreductionFactor.value > 1) {
-              std::mt19937 mt(std::chrono::steady_clock::now().time_since_epoch().count());
-              if (mt() % (_MEreductionFactor.value + 1) < _MEreductionFactor.value)
-                continue;
-            }
-
-            auto col2 = (i->second)[indx2];
-
-            Pair->SetMagField2(col2->magField());
-            mixTracks<1>(selectedtracks_1[col1->index()], selectedtracks_2[col2->index()], centBin); // mixing ME non-identical, in <> brackets: 0 -- SE; 1 -- ME
-          }
+      // mixing ME with the events pooled in the same vertex&mult bin, the pooled (earlier) event provides the first particle
+      mixingPool.mixAndAdd(std::pair<int, float>{vertexBinToMix, centBinToMix}, std::move(event), [&](MixingEvent const& pooled, MixingEvent const& current) {
+        if (_MEreductionFactor.value > 1) {
+          std::mt19937 mt(std::chrono::steady_clock::now().time_since_epoch().count());
+          if ((mt() % (_MEreductionFactor.value + 1)) < _MEreductionFactor.value)
+            return;
         }
-      }
 
-    } //====================================== end of mixing non-identical ======================================
+        Pair->SetMagField1(pooled.magField);
+        Pair->SetMagField2(current.magField);
+        if (IsIdentical)
+          mixTracks<1>(pooled.tracks_1, current.tracks_1, centBin); // mixing ME identical, in <> brackets: 0 -- SE; 1 -- ME
+        else
+          mixTracks<1>(pooled.tracks_1, current.tracks_2, centBin); // mixing ME non-identical, in <> brackets: 0 -- SE; 1 -- ME
+      });
+    }
 
     // clearing up
-    for (auto i = selectedtracks_1.begin(); i != selectedtracks_1.end(); i++)
-      (i->second).clear();
     selectedtracks_1.clear();
-
-    if (!IsIdentical) {
-      for (auto i = selectedtracks_2.begin(); i != selectedtracks_2.end(); i++)
-        (i->second).clear();
+    if (!IsIdentical)
       selectedtracks_2.clear();
-    }
 
-    for (auto i = mixbins.begin(); i != mixbins.end(); i++)
-      (i->second).clear();
-    mixbins.clear();
+    if (!_keepMixingPools)
+      mixingPool.clear();
   }
 };
 
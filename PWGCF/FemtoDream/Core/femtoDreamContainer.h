@@ -24,6 +24,7 @@
 #include <string>
 
 #include "Framework/HistogramRegistry.h"
+#include "PWGCF/Core/PairKinematics.h"
 #include "PWGCF/FemtoDream/Core/femtoDreamMath.h"
 #include "PWGCF/FemtoDream/Core/femtoDreamUtils.h"
 #include "PWGCF/DataModel/FemtoDerived.h"
@@ -184,16 +185,18 @@ class FemtoDreamContainer
     mPDGTwo = pdg2;
   }
 
-  /// Pass a pair to the container and compute all the relevant observables
+  /// Fill the histograms of a pair with its observables
   /// Called by setPair both in case of data/ and Monte Carlo reconstructed and for Monte Carlo truth
   /// \tparam T type of the femtodreamparticle
+  /// \param femtoObs Femtoscopic observable of the pair
+  /// \param kT kT of the pair
+  /// \param mT mT of the pair
   /// \param part1 Particle one
   /// \param part2 Particle two
   /// \param mult Multiplicity of the event
   template <o2::aod::femtodreamMCparticle::MCType mc, typename T>
-  void setPair_base(const float femtoObs, const float mT, T const& part1, T const& part2, const int mult, const float multPercentile, bool use4dplots, bool extendedplots)
+  void setPair_base(const float femtoObs, const float kT, const float mT, T const& part1, T const& part2, const int mult, const float multPercentile, bool use4dplots, bool extendedplots)
   {
-    const float kT = FemtoDreamMath::getkT(part1, mMassOne, part2, mMassTwo);
     mHistogramRegistry->fill(HIST(mFolderSuffix[mEventType]) + HIST(o2::aod::femtodreamMCparticle::MCTypeName[mc]) + HIST("/relPairDist"), femtoObs);
     mHistogramRegistry->fill(HIST(mFolderSuffix[mEventType]) + HIST(o2::aod::femtodreamMCparticle::MCTypeName[mc]) + HIST("/relPairkT"), kT);
     mHistogramRegistry->fill(HIST(mFolderSuffix[mEventType]) + HIST(o2::aod::femtodreamMCparticle::MCTypeName[mc]) + HIST("/relPairkstarkT"), femtoObs, kT);
@@ -239,6 +242,7 @@ class FemtoDreamContainer
   }
 
   /// Templated function to handle data/ Monte Carlo reconstructed and Monte Carlo truth
+  /// The pair observables are computed once with the pair kinematics kernel (PWGCF/Core/PairKinematics.h)
   /// Always calls setPair_base to compute the observables with reconstructed data
   /// In case of Monte Carlo, calls setPair_base with MC info and specialized function setPair_MC for additional histogramms
   /// \tparam T type of the femtodreamparticle
@@ -249,30 +253,34 @@ class FemtoDreamContainer
   void setPair(T const& part1, T const& part2, const int mult, const float multPercentile, bool use4dplots, bool extendedplots, bool smearingByOrigin = false)
   {
     float femtoObs, femtoObsMC;
-    // Calculate femto observable and the mT with reconstructed information
+    // Calculate femto observable, kT and mT with reconstructed information
+    const auto kinematics = o2::analysis::pairkinematics::computePairPtEtaPhi(part1.pt(), part1.eta(), part1.phi(), mMassOne, part2.pt(), part2.eta(), part2.phi(), mMassTwo);
     if constexpr (mFemtoObs == femtoDreamContainer::Observable::kstar) {
-      femtoObs = FemtoDreamMath::getkstar(part1, mMassOne, part2, mMassTwo);
+      femtoObs = kinematics.kstar;
     }
     if (mHighkstarCut > 0) {
       if (femtoObs > mHighkstarCut) {
         return;
       }
     }
-    const float mT = FemtoDreamMath::getmT(part1, mMassOne, part2, mMassTwo);
+    const float mT = kinematics.mT;
 
     if (mHistogramRegistry) {
-      setPair_base<o2::aod::femtodreamMCparticle::MCType::kRecon>(femtoObs, mT, part1, part2, mult, multPercentile, use4dplots, extendedplots);
+      setPair_base<o2::aod::femtodreamMCparticle::MCType::kRecon>(femtoObs, kinematics.kT, mT, part1, part2, mult, multPercentile, use4dplots, extendedplots);
 
       if constexpr (isMC) {
         if (part1.has_fdMCParticle() && part2.has_fdMCParticle()) {
-          // calculate the femto observable and the mT with MC truth information
+          // calculate the femto observable, kT and mT with MC truth information
+          const auto& mcPart1 = part1.fdMCParticle();
+          const auto& mcPart2 = part2.fdMCParticle();
+          const auto kinematicsMC = o2::analysis::pairkinematics::computePairPtEtaPhi(mcPart1.pt(), mcPart1.eta(), mcPart1.phi(), mMassOne, mcPart2.pt(), mcPart2.eta(), mcPart2.phi(), mMassTwo);
           if constexpr (mFemtoObs == femtoDreamContainer::Observable::kstar) {
-            femtoObsMC = FemtoDreamMath::getkstar(part1.fdMCParticle(), mMassOne, part2.fdMCParticle(), mMassTwo);
+            femtoObsMC = kinematicsMC.kstar;
           }
-          const float mTMC = FemtoDreamMath::getmT(part1.fdMCParticle(), mMassOne, part2.fdMCParticle(), mMassTwo);
+          const float mTMC = kinematicsMC.mT;
 
           if (abs(part1.fdMCParticle().pdgMCTruth()) == mPDGOne && abs(part2.fdMCParticle().pdgMCTruth()) == mPDGTwo) { // Note: all pair-histogramms are filled with MC truth information ONLY in case of non-fake candidates
-            setPair_base<o2::aod::femtodreamMCparticle::MCType::kTruth>(femtoObsMC, mTMC, part1.fdMCParticle(), part2.fdMCParticle(), mult, multPercentile, use4dplots, extendedplots);
+            setPair_base<o2::aod::femtodreamMCparticle::MCType::kTruth>(femtoObsMC, kinematicsMC.kT, mTMC, part1.fdMCParticle(), part2.fdMCParticle(), mult, multPercentile, use4dplots, extendedplots);
             setPair_MC(femtoObsMC, femtoObs, mT, mult, part1.fdMCParticle().partOriginMCTruth(), part2.fdMCParticle().partOriginMCTruth(), smearingByOrigin);
           } else {
             mHistogramRegistry->fill(HIST(mFolderSuffix[mEventType]) + HIST(o2::aod::femtodreamMCparticle::MCTypeName[o2::aod::femtodreamMCparticle::MCType::kTruth]) + HIST("/hFakePairsCounter"), 0);
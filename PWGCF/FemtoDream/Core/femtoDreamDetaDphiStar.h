@@ -20,6 +20,7 @@
 #include <string>
 #include <vector>
 #include "PWGCF/DataModel/FemtoDerived.h"
+#include "PWGCF/Core/PhiStar.h"
 #include "Framework/HistogramRegistry.h"
 
 using namespace o2;
@@ -320,13 +321,13 @@ class FemtoDreamDetaDphiStar
     float pt = part.pt();
     for (size_t i = 0; i < 9; i++) {
       if (runOldVersion) {
-        tmpVec.push_back(phi0 - std::asin(0.3 * charge * 0.1 * magfield * tmpRadiiTPC[i] * 0.01 / (2. * pt)));
+        tmpVec.push_back(o2::analysis::phistar::phiAtRadius(phi0, charge, pt, 0.1 * magfield, tmpRadiiTPC[i] * 0.01));
       }
       if (!runOldVersion) {
-        auto arg = 0.3 * charge * magfield * tmpRadiiTPC[i] * 0.01 / (2. * pt);
+        auto arg = o2::analysis::phistar::sinBendingAngle(charge, pt, magfield, tmpRadiiTPC[i] * 0.01);
         // for very low pT particles, this value goes outside of range -1 to 1 at at large tpc radius; asin fails
         if (abs(arg) < 1) {
-          tmpVec.push_back(phi0 - std::asin(0.3 * charge * magfield * tmpRadiiTPC[i] * 0.01 / (2. * pt)));
+          tmpVec.push_back(phi0 - std::asin(arg));
         } else {
           tmpVec.push_back(999);
         }
@@ -357,13 +358,13 @@ class FemtoDreamDetaDphiStar
     float pt = part.pt();
     float phiAtRadii = 0;
     if (runOldVersion) {
-      phiAtRadii = phi0 - std::asin(0.3 * charge * 0.1 * magfield * radii * 0.01 / (2. * pt));
+      phiAtRadii = o2::analysis::phistar::phiAtRadius(phi0, charge, pt, 0.1 * magfield, radii * 0.01);
     }
     if (!runOldVersion) {
-      auto arg = 0.3 * charge * magfield * radii * 0.01 / (2. * pt);
+      auto arg = o2::analysis::phistar::sinBendingAngle(charge, pt, magfield, radii * 0.01);
       // for very low pT particles, this value goes outside of range -1 to 1 at at large tpc radius; asin fails
       if (abs(arg) < 1) {
-        phiAtRadii = phi0 - std::asin(0.3 * charge * magfield * radii * 0.01 / (2. * pt));
+        phiAtRadii = phi0 - std::asin(arg);
       } else {
         phiAtRadii = 999.;
       }
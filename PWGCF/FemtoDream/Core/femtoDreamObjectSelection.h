@@ -17,6 +17,7 @@
 #define PWGCF_FEMTODREAM_CORE_FEMTODREAMOBJECTSELECTION_H_
 
 #include <algorithm>
+#include <cmath>
 #include <string>
 #include <vector>
 
@@ -100,6 +101,64 @@ class FemtoDreamObjectSelection
     for (auto& sel : sels) {
       mSelections.push_back(sel);
     }
+    compileSelections();
+  }
+
+  /// Consecutive selections of mSelections with the same variable and type, whose bits are set together
+  struct SelectionRange {
+    selVariable variable;
+    femtoDreamSelection::SelectionType type;
+    size_t first;  ///< Position of the first selection in mSelections
+    size_t size;   ///< Number of selections
+    bool isSorted; ///< Limits ordered from the most open one, so that the fulfilled selections are the first ones
+  };
+
+  /// Check all the selections of a range and set their bits, as checkSelectionSetBit() of each selection.
+  /// For sorted limits the number of fulfilled selections is found by a binary search of the observable in the selection values
+  /// 	param T Data type of the bit-wise container for the systematic variations
+  /// \param range Range of selections to be checked
+  /// \param observable Value of the variable to be checked
+  /// \param cutContainer Bit-wise container for the systematic variations
+  /// \param counter Position in the bit-wise container of the first selection of the range, moved after the last one
+  /// \param registry Registry with the cut counter histogram, can be nullptr
+  template <typename T>
+  void checkSelectionRangeSetBits(const SelectionRange& range, selValDataType observable, T& cutContainer, size_t& counter, HistogramRegistry* registry)
+  {
+    if (!range.isSorted) {
+      for (size_t i = range.first; i < range.first + range.size; ++i) {
+        mSelections[i].checkSelectionSetBit(observable, cutContainer, counter, registry);
+      }
+      return;
+    }
+    const auto begin = mSelectionValues.begin() + range.first;
+    const auto end = begin + range.size;
+    size_t nSelected = 0;
+    switch (range.type) {
+      case (femtoDreamSelection::SelectionType::kAbsUpperLimit):
+        observable = std::abs(observable);
+        [[fallthrough]];
+      case (femtoDreamSelection::SelectionType::kUpperLimit):
+        nSelected = std::partition_point(begin, end, [observable](selValDataType selVal) { return observable <= selVal; }) - begin;
+        break;
+      case (femtoDreamSelection::SelectionType::kAbsLowerLimit):
+        observable = std::abs(observable);
+        [[fallthrough]];
+      case (femtoDreamSelection::SelectionType::kLowerLimit):
+        nSelected = std::partition_point(begin, end, [observable](selValDataType selVal) { return observable >= selVal; }) - begin;
+        break;
+      case (femtoDreamSelection::SelectionType::kEqual):
+        break;
+    }
+    for (size_t i = 0; i < range.size; ++i, ++counter) {
+      if (i < nSelected) {
+        cutContainer |= 1UL << counter;
+        if (registry) {
+          registry->fill(HIST("AnalysisQA/CutCounter"), 8 * sizeof(o2::aod::femtodreamparticle::cutContainerType));
+        }
+      } else if (registry) {
+        registry->fill(HIST("AnalysisQA/CutCounter"), counter);
+      }
+    }
   }
 
   /// Retrieve the most open selection of a given selection variable
@@ -190,6 +249,41 @@ class FemtoDreamObjectSelection
   HistogramRegistry* mHistogramRegistry;                                     ///< For Analysis QA output
   HistogramRegistry* mQAHistogramRegistry;                                   ///< For QA output
   std::vector<FemtoDreamSelection<selValDataType, selVariable>> mSelections; ///< Vector containing all selections
+  std::vector<SelectionRange> mSelectionRanges;                              ///< Ranges of mSelections with the same variable and type
+  std::vector<selValDataType> mSelectionValues;                              ///< Values of mSelections, for the binary search of the observables
+
+ private:
+  /// Group the selections into ranges of the same variable and type, called whenever selections are added
+  void compileSelections()
+  {
+    mSelectionRanges.clear();
+    mSelectionValues.clear();
+    for (size_t i = 0; i < mSelections.size(); ++i) {
+      auto& sel = mSelections[i];
+      const auto selVal = sel.getSelectionValue();
+      mSelectionValues.push_back(selVal);
+      if (mSelectionRanges.empty() || mSelectionRanges.back().variable != sel.getSelectionVariable() || mSelectionRanges.back().type != sel.getSelectionType()) {
+        mSelectionRanges.push_back({sel.getSelectionVariable(), sel.getSelectionType(), i, 0, sel.getSelectionType() != femtoDreamSelection::SelectionType::kEqual});
+      }
+      auto& range = mSelectionRanges.back();
+      if (range.size > 0) {
+        const auto previousVal = mSelectionValues[i - 1];
+        switch (range.type) {
+          case (femtoDreamSelection::SelectionType::kUpperLimit):
+          case (femtoDreamSelection::SelectionType::kAbsUpperLimit):
+            range.isSorted = range.isSorted && previousVal >= selVal;
+            break;
+          case (femtoDreamSelection::SelectionType::kLowerLimit):
+          case (femtoDreamSelection::SelectionType::kAbsLowerLimit):
+            range.isSorted = range.isSorted && previousVal <= selVal;
+            break;
+          case (femtoDreamSelection::SelectionType::kEqual):
+            break;
+        }
+      }
+      ++range.size;
+    }
+  }
 };
 
 } // namespace femtoDream
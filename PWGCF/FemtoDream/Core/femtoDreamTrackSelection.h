@@ -245,6 +245,8 @@ class FemtoDreamTrackSelection : public FemtoDreamObjectSelection<float, femtoDr
   float nSigmaPIDMax;
   float nSigmaPIDOffsetTPC;
   float nSigmaPIDOffsetTOF;
+  std::vector<float> mPidTPC; ///< nSigma TPC of the PID species of the current track, reused for all tracks
+  std::vector<float> mPidTOF; ///< nSigma TOF of the PID species of the current track, reused for all tracks
   std::vector<o2::track::PID> mPIDspecies; ///< All the particle species for which the n_sigma values need to be stored
   static constexpr int kNtrackSelection = 14;
   static constexpr std::string_view mSelectionNames[kNtrackSelection] = {"Sign",
@@ -501,23 +503,27 @@ std::array<cutContainerType, 2> FemtoDreamTrackSelection::getCutContainer(T cons
   const auto dcaZ = track.dcaZ();
   const auto dca = Dca;
 
-  std::vector<float> pidTPC, pidTOF;
+  mPidTPC.clear();
+  mPidTOF.clear();
   for (auto it : mPIDspecies) {
-    pidTPC.push_back(getNsigmaTPC(track, it));
-    pidTOF.push_back(getNsigmaTOF(track, it));
+    mPidTPC.push_back(getNsigmaTPC(track, it));
+    mPidTOF.push_back(getNsigmaTOF(track, it));
   }
 
   float observable = 0.;
-  for (auto& sel : mSelections) {
-    const auto selVariable = sel.getSelectionVariable();
+  for (const auto& range : mSelectionRanges) {
+    const auto selVariable = range.variable;
     if (selVariable == femtoDreamTrackSelection::kPIDnSigmaMax) {
       /// PID needs to be handled a bit differently since we may need more than one species
-      for (size_t i = 0; i < mPIDspecies.size(); ++i) {
-        auto pidTPCVal = pidTPC.at(i) - nSigmaPIDOffsetTPC;
-        auto pidTOFVal = pidTOF.at(i) - nSigmaPIDOffsetTOF;
-        auto pidComb = std::sqrt(pidTPCVal * pidTPCVal + pidTOFVal * pidTOFVal);
-        sel.checkSelectionSetBitPID(pidTPCVal, outputPID);
-        sel.checkSelectionSetBitPID(pidComb, outputPID);
+      for (size_t iSel = range.first; iSel < range.first + range.size; ++iSel) {
+        auto& sel = mSelections[iSel];
+        for (size_t i = 0; i < mPIDspecies.size(); ++i) {
+          auto pidTPCVal = mPidTPC[i] - nSigmaPIDOffsetTPC;
+          auto pidTOFVal = mPidTOF[i] - nSigmaPIDOffsetTOF;
+          auto pidComb = std::sqrt(pidTPCVal * pidTPCVal + pidTOFVal * pidTOFVal);
+          sel.checkSelectionSetBitPID(pidTPCVal, outputPID);
+          sel.checkSelectionSetBitPID(pidComb, outputPID);
+        }
       }
     } else {
       /// for the rest it's all the same
@@ -562,7 +568,7 @@ std::array<cutContainerType, 2> FemtoDreamTrackSelection::getCutContainer(T cons
         case (femtoDreamTrackSelection::kPIDnSigmaMax):
           break;
       }
-      sel.checkSelectionSetBit(observable, output, counter, mHistogramRegistry);
+      checkSelectionRangeSetBits(range, observable, output, counter, mHistogramRegistry);
     }
   }
   return {output, outputPID};
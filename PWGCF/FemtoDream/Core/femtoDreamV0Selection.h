@@ -589,12 +589,14 @@ std::array<cutContainerType, 5>
   const std::vector<float> decVtx = {v0.x(), v0.y(), v0.z()};
 
   float observable = 0.;
-  for (auto& sel : mSelections) {
-    const auto selVariable = sel.getSelectionVariable();
+  for (const auto& range : mSelectionRanges) {
+    const auto selVariable = range.variable;
     if (selVariable == femtoDreamV0Selection::kV0DecVtxMax) {
-      for (size_t i = 0; i < decVtx.size(); ++i) {
-        auto decVtxValue = decVtx.at(i);
-        sel.checkSelectionSetBit(decVtxValue, output, counter, nullptr);
+      for (size_t iSel = range.first; iSel < range.first + range.size; ++iSel) {
+        for (size_t i = 0; i < decVtx.size(); ++i) {
+          auto decVtxValue = decVtx.at(i);
+          mSelections[iSel].checkSelectionSetBit(decVtxValue, output, counter, nullptr);
+        }
       }
     } else {
       switch (selVariable) {
@@ -625,7 +627,7 @@ std::array<cutContainerType, 5>
         case (femtoDreamV0Selection::kV0DecVtxMax):
           break;
       }
-      sel.checkSelectionSetBit(observable, output, counter, nullptr);
+      checkSelectionRangeSetBits(range, observable, output, counter, nullptr);
     }
   }
   return {
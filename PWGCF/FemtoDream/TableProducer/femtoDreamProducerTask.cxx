@@ -33,6 +33,7 @@
 #include "Framework/runDataProcessing.h"
 #include "Math/Vector4D.h"
 #include "PWGCF/DataModel/FemtoDerived.h"
+#include "PWGCF/Core/FemtoProducerUtils.h"
 #include "PWGLF/DataModel/LFStrangenessTables.h"
 #include "ReconstructionDataFormats/Track.h"
 #include "TMath.h"
@@ -57,18 +58,7 @@ using FemtoFullTracks =
             aod::pidTOFFullEl, aod::pidTOFFullPi, aod::pidTOFFullKa, aod::pidTOFFullPr, aod::pidTOFFullDe>;
 } // namespace o2::aod
 
-template <typename T>
-int getRowDaughters(int daughID, T const& vecID)
-{
-  int rowInPrimaryTrackTableDaugh = -1;
-  for (size_t i = 0; i < vecID.size(); i++) {
-    if (vecID.at(i) == daughID) {
-      rowInPrimaryTrackTableDaugh = i;
-      break;
-    }
-  }
-  return rowInPrimaryTrackTableDaugh;
-}
+using o2::analysis::femto::getRowDaughters;
 
 struct femtoDreamProducerTask {
 
@@ -34,6 +34,7 @@
 #include "Framework/runDataProcessing.h"
 #include "Math/Vector4D.h"
 #include "PWGCF/FemtoUniverse/DataModel/FemtoDerived.h"
+#include "PWGCF/Core/FemtoProducerUtils.h"
 #include "PWGLF/DataModel/LFStrangenessTables.h"
 #include "ReconstructionDataFormats/Track.h"
 #include "TMath.h"
@@ -58,18 +59,7 @@ using FemtoFullCollisionMC = soa::Join<aod::Collisions, aod::EvSels, aod::Mults,
 // sizeof(arrayV0Sel[0]); unsigned int columns = sizeof(arrayV0Sel[0]) /
 // sizeof(arrayV0Sel[0][0]);
 
-template <typename T>
-int getRowDaughters(int daughID, T const& vecID)
-{
-  int rowInPrimaryTrackTableDaugh = -1;
-  for (size_t i = 0; i < vecID.size(); i++) {
-    if (vecID.at(i) == daughID) {
-      rowInPrimaryTrackTableDaugh = i;
-      break;
-    }
-  }
-  return rowInPrimaryTrackTableDaugh;
-}
+using o2::analysis::femto::getRowDaughters;
 
 struct femtoUniverseProducerMCTruthTask {
   int mRunNumber;
@@ -31,6 +31,7 @@
 #include "Framework/runDataProcessing.h"
 #include "Math/Vector4D.h"
 #include "PWGCF/FemtoUniverse/DataModel/FemtoDerived.h"
+#include "PWGCF/Core/FemtoProducerUtils.h"
 #include "PWGLF/DataModel/LFStrangenessTables.h"
 #include "ReconstructionDataFormats/Track.h"
 #include "TMath.h"
@@ -62,18 +63,7 @@ using FemtoFullTracks =
 // sizeof(arrayV0Sel[0]); unsigned int columns = sizeof(arrayV0Sel[0]) /
 // sizeof(arrayV0Sel[0][0]);
 
-template <typename T>
-int getRowDaughters(int daughID, T const& vecID)
-{
-  int rowInPrimaryTrackTableDaugh = -1;
-  for (size_t i = 0; i < vecID.size(); i++) {
-    if (vecID.at(i) == daughID) {
-      rowInPrimaryTrackTableDaugh = i;
-      break;
-    }
-  }
-  return rowInPrimaryTrackTableDaugh;
-}
+using o2::analysis::femto::getRowDaughters;
 
 struct femtoUniverseProducerTaskV0Only {
 
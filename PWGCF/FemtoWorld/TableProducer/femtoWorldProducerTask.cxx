@@ -23,6 +23,7 @@
 #include "PWGCF/FemtoWorld/Core/FemtoWorldPhiSelection.h"
 #include "PWGCF/FemtoWorld/DataModel/FemtoWorldDerived.h"
 #include "PWGCF/FemtoWorld/Core/FemtoWorldPairCleaner.h"
+#include "PWGCF/Core/FemtoProducerUtils.h"
 
 #include "PWGHF/Core/HfHelper.h"
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
@@ -82,18 +83,7 @@ using FemtoPhiTracks = soa::Join<aod::FullTracks,
 // unsigned int rows = sizeof(arrayV0Sel) / sizeof(arrayV0Sel[0]);
 // unsigned int columns = sizeof(arrayV0Sel[0]) / sizeof(arrayV0Sel[0][0]);
 
-template <typename T>
-int getRowDaughters(int daughID, T const& vecID)
-{
-  int rowInPrimaryTrackTableDaugh = -1;
-  for (size_t i = 0; i < vecID.size(); i++) {
-    if (vecID.at(i) == daughID) {
-      rowInPrimaryTrackTableDaugh = i;
-      break;
-    }
-  }
-  return rowInPrimaryTrackTableDaugh;
-}
+using o2::analysis::femto::getRowDaughters;
 
 struct femtoWorldProducerTask {
 
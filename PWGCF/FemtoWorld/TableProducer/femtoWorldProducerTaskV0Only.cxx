@@ -17,6 +17,7 @@
 #include "PWGCF/FemtoWorld/Core/FemtoWorldTrackSelection.h"
 #include "PWGCF/FemtoWorld/Core/FemtoWorldV0Selection.h"
 #include "PWGCF/FemtoWorld/DataModel/FemtoWorldDerived.h"
+#include "PWGCF/Core/FemtoProducerUtils.h"
 
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/AnalysisTask.h"
@@ -60,18 +61,7 @@ using FemtoFullTracks = soa::Join<aod::FullTracks,
 // unsigned int rows = sizeof(arrayV0Sel) / sizeof(arrayV0Sel[0]);
 // unsigned int columns = sizeof(arrayV0Sel[0]) / sizeof(arrayV0Sel[0][0]);
 
-template <typename T>
-int getRowDaughters(int daughID, T const& vecID)
-{
-  int rowInPrimaryTrackTableDaugh = -1;
-  for (size_t i = 0; i < vecID.size(); i++) {
-    if (vecID.at(i) == daughID) {
-      rowInPrimaryTrackTableDaugh = i;
-      break;
-    }
-  }
-  return rowInPrimaryTrackTableDaugh;
-}
+using o2::analysis::femto::getRowDaughters;
 
 struct femtoWorldProducerTaskV0Only {
 
@@ -43,6 +43,7 @@ void BootstrapProfile::InitializeSubsamples(Int_t nSub)
   }
   if (fListOfEntries)
     delete fListOfEntries;
+  fCachedList = nullptr;
   fListOfEntries = new TList();
   fListOfEntries->SetOwner(kTRUE);
   TProfile* dummyPF = reinterpret_cast<TProfile*>(this);
@@ -60,7 +61,7 @@ void BootstrapProfile::FillProfile(const Double_t& xv, const Double_t& yv, const
   Int_t targetInd = rn * fNSubs;
   if (targetInd >= fNSubs)
     targetInd = 0;
-  reinterpret_cast<TProfile*>(fListOfEntries->At(targetInd))->Fill(xv, yv, w);
+  getSubProfile(targetInd)->Fill(xv, yv, w);
 }
 void BootstrapProfile::FillProfile(const Double_t& xv, const Double_t& yv, const Double_t& w)
 {
@@ -127,7 +128,7 @@ Long64_t BootstrapProfile::Merge(TCollection* collist)
         reinterpret_cast<TProfile*>(fListOfEntries->At(i))->Reset();
     }
     for (Int_t i = 0; i < fListOfEntries->GetEntries(); i++)
-      reinterpret_cast<TProfile*>(fListOfEntries->At(i))->Add(reinterpret_cast<TProfile*>(tarL->At(i)));
+      getSubProfile(i)->Add(l_PBS->getSubProfile(i));
   }
   return nmergedpf;
 };
@@ -204,7 +205,7 @@ void BootstrapProfile::MergeBS(BootstrapProfile* target)
       reinterpret_cast<TProfile*>(fListOfEntries->At(i))->Reset();
   }
   for (Int_t i = 0; i < fListOfEntries->GetEntries(); i++)
-    reinterpret_cast<TProfile*>(fListOfEntries->At(i))->Add(reinterpret_cast<TProfile*>(tarL->At(i)));
+    getSubProfile(i)->Add(target->getSubProfile(i));
 }
 TProfile* BootstrapProfile::getSummedProfiles()
 {
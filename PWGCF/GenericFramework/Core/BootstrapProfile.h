@@ -18,6 +18,8 @@
 #include "TCollection.h"
 #include "TMath.h"
 
+#include <vector>
+
 class BootstrapProfile : public TProfile
 {
  public:
@@ -55,6 +57,19 @@ class BootstrapProfile : public TProfile
   Int_t fMultiRebin;                //! externaly set runtime, no need to store
   Double_t* fMultiRebinEdges;       //! externaly set runtime, no need to store
   BootstrapProfile* fPresetWeights; //! BootstrapProfile whose weights we should copy
+  // Subprofiles of fListOfEntries by index, instead of walking the list (TList::At) at every fill
+  std::vector<TProfile*> fSubProfiles; //! runtime cache, rebuilt when the list changes
+  TList* fCachedList = nullptr;        //! list from which fSubProfiles was built
+  TProfile* getSubProfile(Int_t ind)
+  {
+    if (fCachedList != fListOfEntries || static_cast<Int_t>(fSubProfiles.size()) != fListOfEntries->GetEntries()) {
+      fSubProfiles.clear();
+      for (TObject* obj : *fListOfEntries)
+        fSubProfiles.push_back(reinterpret_cast<TProfile*>(obj));
+      fCachedList = fListOfEntries;
+    }
+    return fSubProfiles[ind];
+  };
   void ResetBin(TProfile* tpf, Int_t nbin)
   {
     tpf->SetBinEntries(nbin, 0);
@@ -11,6 +11,11 @@
 
 #include "FlowContainer.h"
 
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+
 ClassImp(FlowContainer);
 
 FlowContainer::FlowContainer() : TNamed("", ""),
@@ -149,6 +154,124 @@ int FlowContainer::FillProfile(const char* hname, double multi, double corr, dou
   }
   return 0;
 };
+int FlowContainer::GetProfileIndex(const char* hname) const
+{
+  if (!fProf)
+    return 0;
+  int yin = fProf->GetYaxis()->FindFixBin(hname);
+  if (!yin)
+    printf("Could not find bin %s\n", hname);
+  return yin;
+};
+int FlowContainer::FillProfile(int index, double multi, double corr, double w, double rn)
+{
+  if (!fProf || index < 1)
+    return -1;
+  fProf->Fill(multi, index, corr, w);
+  if (fNRandom) {
+    double rnind = rn * fNRandom;
+    static_cast<TProfile2D*>(fProfRand->UncheckedAt(static_cast<int>(rnind)))->Fill(multi, index, corr, w);
+  }
+  return 0;
+};
+FlowContainer::Accumulator FlowContainer::CreateAccumulator() const
+{
+  Accumulator acc;
+  if (!fProf)
+    return acc;
+  acc.fXAxis = fProf->GetXaxis();
+  acc.fNcellsX = fProf->GetNbinsX() + 2;
+  acc.fNcells = fProf->GetNcells();
+  acc.fNRandom = fNRandom;
+  acc.Reset();
+  return acc;
+};
+void FlowContainer::Accumulator::Reset()
+{
+  fSums.assign(static_cast<size_t>(fNRandom + 1) * fNcells * kNSums, 0.);
+  fStats.assign(static_cast<size_t>(fNRandom + 1) * kNStats, 0.);
+  fEntries.assign(fNRandom + 1, 0.);
+};
+void FlowContainer::Accumulator::AddFill(int profile, int bin, bool inRange, double x, double y, double z, double w)
+{
+  // Same sums as TProfile2D::Fill(x, y, z, w)
+  double* sums = &fSums[(static_cast<size_t>(profile) * fNcells + bin) * kNSums];
+  sums[kSumW] += w;
+  sums[kSumWY] += w * z;
+  sums[kSumWY2] += w * z * z;
+  sums[kSumW2] += w * w;
+  fEntries[profile]++;
+  if (!inRange)
+    return; // under/overflows are not used for the statistics
+  double* stats = &fStats[profile * kNStats];
+  stats[0] += w;
+  stats[1] += w * w;
+  stats[2] += w * x;
+  stats[3] += w * x * x;
+  stats[4] += w * y;
+  stats[5] += w * y * y;
+  stats[6] += w * x * y;
+  stats[7] += w * z;
+  stats[8] += w * z * z;
+};
+void FlowContainer::Accumulator::Fill(int index, double multi, double corr, double w, double rn)
+{
+  if (!fXAxis || index < 1)
+    return;
+  int binx = fXAxis->FindFixBin(multi);
+  bool inRange = binx > 0 && binx < fNcellsX - 1;
+  int bin = binx + fNcellsX * index;
+  AddFill(0, bin, inRange, multi, index, corr, w);
+  if (fNRandom)
+    AddFill(1 + static_cast<int>(rn * fNRandom), bin, inRange, multi, index, corr, w);
+};
+void FlowContainer::Accumulator::Add(const Accumulator& other)
+{
+  if (other.fSums.size() != fSums.size()) {
+    printf("Accumulators with different binnings, not adding\n");
+    return;
+  }
+  for (size_t i = 0; i < fSums.size(); i++)
+    fSums[i] += other.fSums[i];
+  for (size_t i = 0; i < fStats.size(); i++)
+    fStats[i] += other.fStats[i];
+  for (size_t i = 0; i < fEntries.size(); i++)
+    fEntries[i] += other.fEntries[i];
+};
+void FlowContainer::Flush(Accumulator& acc)
+{
+  if (!fProf || acc.fNcells != fProf->GetNcells() || acc.fNRandom != fNRandom) {
+    printf("Accumulator does not match the profiles, not flushing\n");
+    return;
+  }
+  for (int iProf = 0; iProf <= fNRandom; iProf++) {
+    TProfile2D* prof = iProf ? static_cast<TProfile2D*>(fProfRand->UncheckedAt(iProf - 1)) : fProf;
+    if (!acc.fEntries[iProf])
+      continue;
+    std::array<double, Accumulator::kNStats> stats; // before the bins are changed, GetStats may recompute them from the bins
+    prof->GetStats(stats.data());
+    if (!prof->GetBinSumw2()->fN)
+      prof->Sumw2();
+    double* sumwy = prof->fArray;
+    double* sumwy2 = prof->GetSumw2()->fArray;
+    double* sumw2 = prof->GetBinSumw2()->fArray;
+    const double* sums = &acc.fSums[static_cast<size_t>(iProf) * acc.fNcells * Accumulator::kNSums];
+    for (int bin = 0; bin < acc.fNcells; bin++, sums += Accumulator::kNSums) {
+      if (sums[Accumulator::kSumW] == 0 && sums[Accumulator::kSumW2] == 0)
+        continue;
+      prof->SetBinEntries(bin, prof->GetBinEntries(bin) + sums[Accumulator::kSumW]);
+      sumwy[bin] += sums[Accumulator::kSumWY];
+      sumwy2[bin] += sums[Accumulator::kSumWY2];
+      sumw2[bin] += sums[Accumulator::kSumW2];
+    }
+    for (int i = 0; i < Accumulator::kNStats; i++)
+      stats[i] += acc.fStats[iProf * Accumulator::kNStats + i];
+    double entries = prof->GetEntries() + acc.fEntries[iProf];
+    prof->PutStats(stats.data());
+    prof->SetEntries(entries);
+  }
+  acc.Reset();
+};
 void FlowContainer::OverrideProfileErrors(TProfile2D* inpf)
 {
   int nBinsX = fProf->GetNbinsX();
@@ -201,49 +324,29 @@ Long64_t FlowContainer::Merge(TCollection* collist)
       tpro->Add(spro);
     }
     nmerged++;
-    TObjArray* tarr = l_FC->GetSubProfiles();
-    if (!tarr)
-      continue;
-    if (!fProfRand) {
-      fProfRand = new TObjArray();
-      fProfRand->SetOwner(kTRUE);
-    }
-    for (int i = 0; i < tarr->GetEntries(); i++) {
-      if (!(fProfRand->FindObject(tarr->At(i)->GetName()))) {
-        fProfRand->Add(dynamic_cast<TProfile2D*>(tarr->At(i)->Clone(tarr->At(i)->GetName())));
-        dynamic_cast<TProfile2D*>(fProfRand->At(fProfRand->GetEntries() - 1))->SetDirectory(0);
-      } else {
-        dynamic_cast<TProfile2D*>(fProfRand->FindObject(tarr->At(i)->GetName()))->Add(dynamic_cast<TProfile2D*>(tarr->At(i)));
-      }
-    }
+    MergeSubProfiles(l_FC->GetSubProfiles());
   }
   return nmerged;
 }
 
 void FlowContainer::ReadAndMerge(const char* filelist)
 {
-  FILE* flist = fopen(filelist, "r");
-  char str[150];
+  std::ifstream flist(filelist);
+  std::string str;
   int nFiles = 0;
-  while (fscanf(flist, "%s\n", str) == 1)
+  while (flist >> str) {
+    std::unique_ptr<TFile> tf(TFile::Open(str.c_str(), "READ"));
     nFiles++;
-  rewind(flist);
-  if (nFiles == 0) {
-    printf("No files to read!\n");
-    return;
-  }
-  for (int i = 0; i < nFiles; i++) {
-    auto retVal = fscanf(flist, "%s\n", str);
-    (void)retVal;
-    TFile* tf = new TFile(str, "READ");
-    if (tf->IsZombie()) {
-      printf("Could not open file %s!\n", str);
-      tf->Close();
+    if (!tf || tf->IsZombie()) {
+      printf("Could not open file %s!\n", str.c_str());
       continue;
     }
-    PickAndMerge(tf);
+    PickAndMerge(tf.get());
     tf->Close();
   }
+  if (nFiles == 0) {
+    printf("No files to read!\n");
+  }
 }
 void FlowContainer::PickAndMerge(TFile* tfi)
 {
@@ -260,7 +363,11 @@ void FlowContainer::PickAndMerge(TFile* tfi)
   } else {
     tpro->Add(spro);
   }
-  TObjArray* tarr = lfc->GetSubProfiles();
+  MergeSubProfiles(lfc->GetSubProfiles());
+  delete lfc;
+}
+void FlowContainer::MergeSubProfiles(TObjArray* tarr)
+{
   if (!tarr) {
     return;
   }
@@ -269,11 +376,14 @@ void FlowContainer::PickAndMerge(TFile* tfi)
     fProfRand->SetOwner(kTRUE);
   }
   for (int i = 0; i < tarr->GetEntries(); i++) {
-    if (!(fProfRand->FindObject(tarr->At(i)->GetName()))) {
-      fProfRand->Add(dynamic_cast<TProfile2D*>(tarr->At(i)->Clone(tarr->At(i)->GetName())));
+    const char* name = tarr->At(i)->GetName();
+    // the subprofiles of all the inputs are normally in the same order: check the same position before searching by name
+    TObject* target = (i < fProfRand->GetEntries() && !strcmp(fProfRand->At(i)->GetName(), name)) ? fProfRand->At(i) : fProfRand->FindObject(name);
+    if (!target) {
+      fProfRand->Add(dynamic_cast<TProfile2D*>(tarr->At(i)->Clone(name)));
       dynamic_cast<TProfile2D*>(fProfRand->At(fProfRand->GetEntries() - 1))->SetDirectory(0);
     } else {
-      dynamic_cast<TProfile2D*>(fProfRand->FindObject(tarr->At(i)->GetName()))->Add(dynamic_cast<TProfile2D*>(tarr->At(i)));
+      dynamic_cast<TProfile2D*>(target)->Add(dynamic_cast<TProfile2D*>(tarr->At(i)));
     }
   }
 }
@@ -12,6 +12,7 @@
 #ifndef PWGCF_GENERICFRAMEWORK_CORE_FLOWCONTAINER_H_
 #define PWGCF_GENERICFRAMEWORK_CORE_FLOWCONTAINER_H_
 #include <vector>
+#include <array>
 #include "TH3F.h"
 #include "TProfile2D.h"
 #include "TProfile.h"
@@ -51,10 +52,43 @@ class FlowContainer : public TNamed
   int GetNMultiBins() { return fProf->GetNbinsX(); }
   double GetMultiAtBin(int bin) { return fProf->GetXaxis()->GetBinCenter(bin); }
   int FillProfile(const char* hname, double multi, double y, double w, double rn);
+  int GetProfileIndex(const char* hname) const;                            // index of a correlator for the FillProfile below, 0 if not found
+  int FillProfile(int index, double multi, double y, double w, double rn); // no name lookup
+  // Raw sums of the profile and subsample bins, filled without touching the ROOT objects and
+  // added to the profiles only in Flush. One accumulator per thread can be filled without locks;
+  // flushing the accumulators in a fixed order makes the result independent of the scheduling.
+  // An accumulator is bound to the binning of the container at creation time (before any rebinning).
+  class Accumulator
+  {
+   public:
+    void Fill(int index, double multi, double y, double w, double rn);
+    void Add(const Accumulator& other);
+    void Reset();
+
+   private:
+    friend class FlowContainer;
+    enum SumIndex { kSumW,
+                    kSumWY,
+                    kSumWY2,
+                    kSumW2,
+                    kNSums };
+    static constexpr int kNStats = 9; // TProfile2D statistics, see TProfile2D::GetStats
+    const TAxis* fXAxis = nullptr;
+    int fNcellsX = 0;
+    int fNcells = 0;
+    int fNRandom = 0;
+    std::vector<double> fSums;    // per profile (main, then subsamples), per bin, kNSums sums
+    std::vector<double> fStats;   // per profile, kNStats statistics
+    std::vector<double> fEntries; // per profile
+    void AddFill(int profile, int bin, bool inRange, double x, double y, double z, double w);
+  };
+  Accumulator CreateAccumulator() const;
+  void Flush(Accumulator& acc); // adds the sums of the accumulator to the profiles and resets it
   TProfile2D* GetProfile() { return fProf; }
   void OverrideProfileErrors(TProfile2D* inpf);
   void ReadAndMerge(const char* infile);
   void PickAndMerge(TFile* tfi);
+  void MergeSubProfiles(TObjArray* tarr); // adds the subprofiles, matched by name, creating the missing ones
   bool OverrideBinsWithZero(int xb1, int yb1, int xb2, int yb2);
   bool OverrideMainWithSub(int subind, bool ExcludeChosen);
   bool RandomizeProfile(int nSubsets = 0);
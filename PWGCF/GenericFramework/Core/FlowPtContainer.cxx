@@ -186,8 +186,15 @@ void FlowPtContainer::Initialise(int nbinsx, double xlow, double xhigh, const in
 };
 void FlowPtContainer::Fill(const double& w, const double& pt)
 {
-  for (auto i = 0; i < sumP.size(); ++i) {
-    sumP[i] += pow(w, i % (mpar + 1)) * pow(pt, i / (mpar + 1));
+  // sumP[GetVectorIndex(i, j)] += w^i * pt^j, with the powers built up by multiplication
+  double ptPow = 1.0;
+  for (int j = 0; j <= mpar; ++j) {
+    double wPtPow = ptPow;
+    for (int i = 0; i <= mpar; ++i) {
+      sumP[GetVectorIndex(i, j)] += wPtPow;
+      wPtPow *= w;
+    }
+    ptPow *= pt;
   }
   return;
 }
@@ -201,8 +208,8 @@ void FlowPtContainer::CalculateCorrelations()
   corrDen[0] = 1.0;
   double sumNum = 0;
   double sumDenum = 0;
-  std::vector<double> valNum;
-  std::vector<double> valDenum;
+  std::vector<double>& valNum = fValNum;
+  std::vector<double>& valDenum = fValDenum;
   for (int m(1); m <= mpar; ++m) {
     for (int k(1); k <= m; ++k) {
       valNum.push_back(fSign[k - 1] * corrNum[m - k] * (fFactorial[m - 1] / fFactorial[m - k]) * sumP[GetVectorIndex(k, k)]);
@@ -253,25 +260,36 @@ void FlowPtContainer::FillCMProfiles(const double& centmult, const double& rn)
   // double weight4 = 1 - 10*tau1 + 15*tau1*tau1 + 20*tau2 - 20*tau1*tau2 - 30*tau3 + 24*tau4;
   if (mpar < 1 || sumP[GetVectorIndex(1, 0)] == 0)
     return;
-  dynamic_cast<BootstrapProfile*>(fCMTermList->At(0))->FillProfile(centmult, sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)], (fEventWeight == kEventWeight::kUnity) ? 1.0 : sumP[GetVectorIndex(1, 0)], rn);
+  // ratios sumP(i, j) / sumP(i, 0) of the order i, computed once the order is checked
+  const double r11 = sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)];
+  dynamic_cast<BootstrapProfile*>(fCMTermList->At(0))->FillProfile(centmult, r11, (fEventWeight == kEventWeight::kUnity) ? 1.0 : sumP[GetVectorIndex(1, 0)], rn);
   if (mpar < 2 || sumP[GetVectorIndex(2, 0)] == 0 || weight1 == 0)
     return;
-  dynamic_cast<BootstrapProfile*>(fCMTermList->At(1))->FillProfile(centmult, 1 / weight1 * (sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] - tau1 * sumP[GetVectorIndex(2, 2)] / sumP[GetVectorIndex(2, 0)]), (fEventWeight == kEventWeight::kUnity) ? 1.0 : weight1, rn);
-  dynamic_cast<BootstrapProfile*>(fCMTermList->At(2))->FillProfile(centmult, 1 / weight1 * (-2 * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] + 2 * tau1 * sumP[GetVectorIndex(2, 1)] / sumP[GetVectorIndex(2, 0)]), (fEventWeight == kEventWeight::kUnity) ? 1.0 : weight1, rn);
+  const double r21 = sumP[GetVectorIndex(2, 1)] / sumP[GetVectorIndex(2, 0)];
+  const double r22 = sumP[GetVectorIndex(2, 2)] / sumP[GetVectorIndex(2, 0)];
+  dynamic_cast<BootstrapProfile*>(fCMTermList->At(1))->FillProfile(centmult, 1 / weight1 * (r11 * r11 - tau1 * r22), (fEventWeight == kEventWeight::kUnity) ? 1.0 : weight1, rn);
+  dynamic_cast<BootstrapProfile*>(fCMTermList->At(2))->FillProfile(centmult, 1 / weight1 * (-2 * r11 + 2 * tau1 * r21), (fEventWeight == kEventWeight::kUnity) ? 1.0 : weight1, rn);
   if (mpar < 3 || sumP[GetVectorIndex(3, 0)] == 0 || weight2 == 0)
     return;
-  dynamic_cast<BootstrapProfile*>(fCMTermList->At(3))->FillProfile(centmult, 1 / weight2 * (sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] - 3 * tau1 * sumP[GetVectorIndex(2, 2)] / sumP[GetVectorIndex(2, 0)] * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] + 2 * tau2 * sumP[GetVectorIndex(3, 3)] / sumP[GetVectorIndex(3, 0)]), (fEventWeight == kEventWeight::kUnity) ? 1.0 : weight2, rn);
-  dynamic_cast<BootstrapProfile*>(fCMTermList->At(4))->FillProfile(centmult, 1 / weight2 * (-3 * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] + 3 * tau1 * sumP[GetVectorIndex(2, 2)] / sumP[GetVectorIndex(2, 0)] + 6 * tau1 * sumP[GetVectorIndex(2, 1)] / sumP[GetVectorIndex(2, 0)] * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] - 6 * tau2 * sumP[GetVectorIndex(3, 2)] / sumP[GetVectorIndex(3, 0)]), (fEventWeight == kEventWeight::kUnity) ? 1.0 : weight2, rn);
-  dynamic_cast<BootstrapProfile*>(fCMTermList->At(5))->FillProfile(centmult, 1 / weight2 * (3 * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] - 6 * tau1 * sumP[GetVectorIndex(2, 1)] / sumP[GetVectorIndex(2, 0)] - 3 * tau1 * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] + 6 * tau2 * sumP[GetVectorIndex(3, 1)] / sumP[GetVectorIndex(3, 0)]), (fEventWeight == kEventWeight::kUnity) ? 1.0 : weight2, rn);
+  const double r31 = sumP[GetVectorIndex(3, 1)] / sumP[GetVectorIndex(3, 0)];
+  const double r32 = sumP[GetVectorIndex(3, 2)] / sumP[GetVectorIndex(3, 0)];
+  const double r33 = sumP[GetVectorIndex(3, 3)] / sumP[GetVectorIndex(3, 0)];
+  dynamic_cast<BootstrapProfile*>(fCMTermList->At(3))->FillProfile(centmult, 1 / weight2 * (r11 * r11 * r11 - 3 * tau1 * r22 * r11 + 2 * tau2 * r33), (fEventWeight == kEventWeight::kUnity) ? 1.0 : weight2, rn);
+  dynamic_cast<BootstrapProfile*>(fCMTermList->At(4))->FillProfile(centmult, 1 / weight2 * (-3 * r11 * r11 + 3 * tau1 * r22 + 6 * tau1 * r21 * r11 - 6 * tau2 * r32), (fEventWeight == kEventWeight::kUnity) ? 1.0 : weight2, rn);
+  dynamic_cast<BootstrapProfile*>(fCMTermList->At(5))->FillProfile(centmult, 1 / weight2 * (3 * r11 - 6 * tau1 * r21 - 3 * tau1 * r11 + 6 * tau2 * r31), (fEventWeight == kEventWeight::kUnity) ? 1.0 : weight2, rn);
   if (mpar < 4 || sumP[GetVectorIndex(4, 0)] == 0 || weight3 == 0)
     return;
-  dynamic_cast<BootstrapProfile*>(fCMTermList->At(6))->FillProfile(centmult, 1 / weight3 * (sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] - 6 * tau1 * sumP[GetVectorIndex(2, 2)] / sumP[GetVectorIndex(2, 0)] * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] + 3 * tau1 * tau1 * sumP[GetVectorIndex(2, 2)] / sumP[GetVectorIndex(2, 0)] * sumP[GetVectorIndex(2, 2)] / sumP[GetVectorIndex(2, 0)] + 8 * tau2 * sumP[GetVectorIndex(3, 3)] / sumP[GetVectorIndex(3, 0)] * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] - 6 * tau3 * sumP[GetVectorIndex(4, 4)] / sumP[GetVectorIndex(4, 0)]), (fEventWeight == kEventWeight::kUnity) ? 1.0 : weight3, rn);
-  dynamic_cast<BootstrapProfile*>(fCMTermList->At(7))->FillProfile(centmult, 1 / weight3 * (-4 * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] + 12 * tau1 * sumP[GetVectorIndex(2, 2)] / sumP[GetVectorIndex(2, 0)] * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] + 12 * tau1 * sumP[GetVectorIndex(2, 1)] / sumP[GetVectorIndex(2, 0)] * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] - 12 * tau1 * tau1 * sumP[GetVectorIndex(2, 2)] / sumP[GetVectorIndex(2, 0)] * sumP[GetVectorIndex(2, 1)] / sumP[GetVectorIndex(2, 0)] - 8 * tau2 * sumP[GetVectorIndex(3, 3)] / sumP[GetVectorIndex(3, 0)] - 24 * tau2 * sumP[GetVectorIndex(3, 2)] / sumP[GetVectorIndex(3, 0)] * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] + 24 * tau3 * sumP[GetVectorIndex(4, 3)] / sumP[GetVectorIndex(4, 0)]), (fEventWeight == kEventWeight::kUnity) ? 1.0 : weight3, rn);
-  dynamic_cast<BootstrapProfile*>(fCMTermList->At(8))->FillProfile(centmult, 1 / weight3 * (6 * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] - 6 * tau1 * sumP[GetVectorIndex(2, 2)] / sumP[GetVectorIndex(2, 0)] - 24 * tau1 * sumP[GetVectorIndex(2, 1)] / sumP[GetVectorIndex(2, 0)] * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] - 6 * tau1 * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] + 6 * tau1 * tau1 * sumP[GetVectorIndex(2, 2)] / sumP[GetVectorIndex(2, 0)] + 12 * tau1 * tau1 * sumP[GetVectorIndex(2, 1)] / sumP[GetVectorIndex(2, 0)] * sumP[GetVectorIndex(2, 1)] / sumP[GetVectorIndex(2, 0)] + 24 * tau2 * sumP[GetVectorIndex(3, 2)] / sumP[GetVectorIndex(3, 0)] + 24 * tau2 * sumP[GetVectorIndex(3, 1)] / sumP[GetVectorIndex(3, 0)] * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] - 36 * tau3 * sumP[GetVectorIndex(4, 2)] / sumP[GetVectorIndex(4, 0)]), (fEventWeight == kEventWeight::kUnity) ? 1.0 : weight3, rn);
-  dynamic_cast<BootstrapProfile*>(fCMTermList->At(9))->FillProfile(centmult, 1 / weight3 * (-4 * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] + 12 * tau1 * sumP[GetVectorIndex(2, 1)] / sumP[GetVectorIndex(2, 0)] + 12 * tau1 * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] - 12 * tau1 * tau1 * sumP[GetVectorIndex(2, 1)] / sumP[GetVectorIndex(2, 0)] - 24 * tau2 * sumP[GetVectorIndex(3, 1)] / sumP[GetVectorIndex(3, 0)] - 8 * tau2 * sumP[GetVectorIndex(1, 1)] / sumP[GetVectorIndex(1, 0)] + 24 * tau3 * sumP[GetVectorIndex(4, 1)] / sumP[GetVectorIndex(4, 0)]), (fEventWeight == kEventWeight::kUnity) ? 1.0 : weight3, rn);
+  const double r41 = sumP[GetVectorIndex(4, 1)] / sumP[GetVectorIndex(4, 0)];
+  const double r42 = sumP[GetVectorIndex(4, 2)] / sumP[GetVectorIndex(4, 0)];
+  const double r43 = sumP[GetVectorIndex(4, 3)] / sumP[GetVectorIndex(4, 0)];
+  const double r44 = sumP[GetVectorIndex(4, 4)] / sumP[GetVectorIndex(4, 0)];
+  dynamic_cast<BootstrapProfile*>(fCMTermList->At(6))->FillProfile(centmult, 1 / weight3 * (r11 * r11 * r11 * r11 - 6 * tau1 * r22 * r11 * r11 + 3 * tau1 * tau1 * r22 * r22 + 8 * tau2 * r33 * r11 - 6 * tau3 * r44), (fEventWeight == kEventWeight::kUnity) ? 1.0 : weight3, rn);
+  dynamic_cast<BootstrapProfile*>(fCMTermList->At(7))->FillProfile(centmult, 1 / weight3 * (-4 * r11 * r11 * r11 + 12 * tau1 * r22 * r11 + 12 * tau1 * r21 * r11 * r11 - 12 * tau1 * tau1 * r22 * r21 - 8 * tau2 * r33 - 24 * tau2 * r32 * r11 + 24 * tau3 * r43), (fEventWeight == kEventWeight::kUnity) ? 1.0 : weight3, rn);
+  dynamic_cast<BootstrapProfile*>(fCMTermList->At(8))->FillProfile(centmult, 1 / weight3 * (6 * r11 * r11 - 6 * tau1 * r22 - 24 * tau1 * r21 * r11 - 6 * tau1 * r11 * r11 + 6 * tau1 * tau1 * r22 + 12 * tau1 * tau1 * r21 * r21 + 24 * tau2 * r32 + 24 * tau2 * r31 * r11 - 36 * tau3 * r42), (fEventWeight == kEventWeight::kUnity) ? 1.0 : weight3, rn);
+  dynamic_cast<BootstrapProfile*>(fCMTermList->At(9))->FillProfile(centmult, 1 / weight3 * (-4 * r11 + 12 * tau1 * r21 + 12 * tau1 * r11 - 12 * tau1 * tau1 * r21 - 24 * tau2 * r31 - 8 * tau2 * r11 + 24 * tau3 * r41), (fEventWeight == kEventWeight::kUnity) ? 1.0 : weight3, rn);
   return;
 }
-double FlowPtContainer::OrderedAddition(std::vector<double> vec)
+double FlowPtContainer::OrderedAddition(std::vector<double>& vec)
 {
   double sum = 0;
   std::sort(vec.begin(), vec.end());
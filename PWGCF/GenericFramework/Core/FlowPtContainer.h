@@ -61,7 +61,7 @@ class FlowPtContainer : public TNamed
   TH1* getCorrHist(int ind, int m);
   Int_t getMpar() { return mpar; }
   Long64_t Merge(TCollection* collist);
-  Double_t OrderedAddition(std::vector<double> vec);
+  Double_t OrderedAddition(std::vector<double>& vec); // sorts vec in place
   void CreateCentralMomentList();
   void CalculateCentralMomentHists(std::vector<TH1*> inh, int ind, int m, TH1* hMpt);
   void CreateCumulantList();
@@ -87,6 +87,8 @@ class FlowPtContainer : public TNamed
   std::vector<double> sumP;    //!
   std::vector<double> corrNum; //!
   std::vector<double> corrDen; //!
+  std::vector<double> fValNum;   //! terms of the correlation recursion, kept to reuse their storage
+  std::vector<double> fValDenum; //!
 
   static constexpr float fFactorial[9] = {1., 1., 2., 6., 24., 120., 720., 5040., 40320.};
   static constexpr int fSign[9] = {1, -1, 1, -1, 1, -1, 1, -1, 1};
@@ -82,6 +82,7 @@ int GFW::CreateRegions()
   for (auto pItr = fCumulants.begin(); pItr != fCumulants.end(); ++pItr)
     pItr->DestroyComplexVectorArray();
   fCumulants.clear();
+  ClearCompiledCorr();
   InitializePowerArrays();
   if (fRegions.size() < 1) {
     printf("No regions set. Skipping...\n");
@@ -105,6 +106,28 @@ void GFW::Fill(double eta, int ptin, double phi, double weight, int mask, double
     if (fRegions.at(i).EtaMin < eta && fRegions.at(i).EtaMax > eta && (fRegions.at(i).BitMask & mask))
       fCumulants.at(i).FillArray(ptin, phi, weight, SecondWeight);
   }
+  fEpoch++;
+};
+void GFW::Fill(int nParticles, const double* eta, const int* ptin, const double* phi, const double* weight, const int* mask, const double* SecondWeight)
+{
+  for (int i = 0; i < static_cast<int>(fRegions.size()); ++i) {
+    const Region& lRegion = fRegions.at(i);
+    fBatchPt.clear();
+    fBatchPhi.clear();
+    fBatchWeight.clear();
+    fBatchSecondWeight.clear();
+    for (int j = 0; j < nParticles; ++j) {
+      if (lRegion.EtaMin < eta[j] && lRegion.EtaMax > eta[j] && (lRegion.BitMask & mask[j])) {
+        fBatchPt.push_back(ptin[j]);
+        fBatchPhi.push_back(phi[j]);
+        fBatchWeight.push_back(weight[j]);
+        fBatchSecondWeight.push_back(SecondWeight ? SecondWeight[j] : -1);
+      }
+    }
+    if (!fBatchPt.empty())
+      fCumulants.at(i).FillArray(static_cast<int>(fBatchPt.size()), fBatchPt.data(), fBatchPhi.data(), fBatchWeight.data(), fBatchSecondWeight.data());
+  }
+  fEpoch++;
 };
 complex<double> GFW::TwoRec(int n1, int n2, int p1, int p2, int ptbin, GFWCumulant* r1, GFWCumulant* r2, GFWCumulant* r3)
 {
@@ -162,12 +185,110 @@ complex<double> GFW::RecursiveCorr(GFWCumulant* qpoi, GFWCumulant* qref, GFWCumu
   pows.push_back(powlast);
   return formula;
 };
+int GFW::CompileCorr(int poi, int ref, int ovl, int ptbin, vector<int>& hars, vector<int>& pows)
+{
+  // Same recursion as RecursiveCorr, but each distinct term becomes a node of the graph, created once
+  if ((pows.at(0) != 1) && ovl > -1)
+    poi = ovl;
+  fCorrKey.assign({poi, ref, ovl, ptbin});
+  fCorrKey.insert(fCorrKey.end(), hars.begin(), hars.end());
+  fCorrKey.insert(fCorrKey.end(), pows.begin(), pows.end());
+  auto lFound = fCorrNodeIndex.find(fCorrKey);
+  if (lFound != fCorrNodeIndex.end())
+    return lFound->second;
+  vector<int> lKey = fCorrKey; // fCorrKey is overwritten by the recursion
+  CorrNode lNode;
+  lNode.poi = poi;
+  lNode.ref = ref;
+  lNode.ovl = ovl;
+  lNode.ptbin = ptbin;
+  lNode.n1 = hars.at(0);
+  lNode.p1 = pows.at(0);
+  lNode.n2 = 0;
+  lNode.p2 = 0;
+  lNode.prefix = -1;
+  lNode.epoch = 0;
+  if (hars.size() < 2) {
+    lNode.type = CorrNode::kOne;
+  } else if (hars.size() < 3) {
+    lNode.type = CorrNode::kTwo;
+    lNode.n2 = hars.at(1);
+    lNode.p2 = pows.at(1);
+  } else {
+    lNode.type = CorrNode::kRecursive;
+    int harlast = hars.at(hars.size() - 1);
+    int powlast = pows.at(pows.size() - 1);
+    lNode.n2 = harlast;
+    lNode.p2 = powlast;
+    hars.erase(hars.end() - 1);
+    pows.erase(pows.end() - 1);
+    lNode.prefix = CompileCorr(poi, ref, ovl, ptbin, hars, pows);
+    int lDegeneracy = 1;
+    int harSize = static_cast<int>(hars.size());
+    for (int i = harSize - 1; i >= 0; i--) {
+      if (i > 2) {
+        if (hars.at(i) == hars.at(i - 1) && pows.at(i) == pows.at(i - 1)) {
+          lDegeneracy++;
+          continue;
+        }
+      }
+      hars.at(i) += harlast;
+      pows.at(i) += powlast;
+      lNode.subtractions.emplace_back(CompileCorr(poi, ref, ovl, ptbin, hars, pows), lDegeneracy);
+      lDegeneracy = 1;
+      hars.at(i) -= harlast;
+      pows.at(i) -= powlast;
+    }
+    hars.push_back(harlast);
+    pows.push_back(powlast);
+  }
+  int lIndex = static_cast<int>(fCorrNodes.size());
+  fCorrNodes.push_back(lNode);
+  fCorrNodeIndex.emplace(std::move(lKey), lIndex);
+  return lIndex;
+};
+complex<double> GFW::EvaluateCorr(int node)
+{
+  CorrNode& lNode = fCorrNodes[node];
+  if (lNode.epoch == fEpoch)
+    return lNode.value;
+  GFWCumulant* qpoi = &fCumulants.at(lNode.poi);
+  GFWCumulant* qref = &fCumulants.at(lNode.ref);
+  GFWCumulant* qovl = (lNode.ovl > -1) ? &fCumulants.at(lNode.ovl) : 0;
+  complex<double> formula;
+  switch (lNode.type) {
+    case CorrNode::kOne:
+      formula = qpoi->Vec(lNode.n1, lNode.p1, lNode.ptbin);
+      break;
+    case CorrNode::kTwo:
+      formula = TwoRec(lNode.n1, lNode.n2, lNode.p1, lNode.p2, lNode.ptbin, qpoi, qref, qovl);
+      break;
+    case CorrNode::kRecursive:
+      formula = EvaluateCorr(lNode.prefix) * qref->Vec(lNode.n2, lNode.p2);
+      for (const auto& [lTerm, lDegeneracy] : fCorrNodes[node].subtractions) {
+        complex<double> subtractVal = EvaluateCorr(lTerm);
+        if (lDegeneracy > 1)
+          subtractVal *= lDegeneracy;
+        formula -= subtractVal;
+      }
+      break;
+  }
+  fCorrNodes[node].value = formula;
+  fCorrNodes[node].epoch = fEpoch;
+  return formula;
+};
+void GFW::ClearCompiledCorr()
+{
+  fCorrNodes.clear();
+  fCorrNodeIndex.clear();
+};
 void GFW::Clear()
 {
   if (!fInitialized)
     CreateRegions();
   for (auto ptr = fCumulants.begin(); ptr != fCumulants.end(); ++ptr)
     ptr->ResetQs();
+  fEpoch++;
 };
 GFW::CorrConfig GFW::GetCorrelatorConfig(string config, string head, bool ptdif)
 {
@@ -301,7 +422,9 @@ complex<double> GFW::Calculate(CorrConfig corconf, int ptbin, bool SetHarmsToZer
         corconf.Hars.at(i).at(j) = 0;
       }
     }
-    retval *= RecursiveCorr(qpoi, qref, qovl, ptInd, corconf.Hars.at(i));
+    fCorrPows.assign(corconf.Hars.at(i).size(), 1);
+    int lOvl = qovl ? static_cast<int>(qovl - fCumulants.data()) : -1;
+    retval *= EvaluateCorr(CompileCorr(poi, ref, lOvl, ptInd, corconf.Hars.at(i), fCorrPows));
   }
   return retval;
 };
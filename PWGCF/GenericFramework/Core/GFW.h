@@ -26,6 +26,7 @@ If used, modified, or distributed, please aknowledge the author of this code.
 #include <utility>
 #include <algorithm>
 #include <complex>
+#include <map>
 
 class GFW
 {
@@ -62,6 +63,7 @@ class GFW
   void AddRegion(std::string refName, int lNhar, int* lNparVec, double lEtaMin, double lEtaMax, int lNpT, int BitMask);  // Legacy support, array instead of a vector
   int CreateRegions();
   void Fill(double eta, int ptin, double phi, double weight, int mask, double secondWeight = -1);
+  void Fill(int nParticles, const double* eta, const int* ptin, const double* phi, const double* weight, const int* mask, const double* secondWeight = nullptr); // Batch version, one FillArray call per region
   void Clear();
   GFWCumulant GetCumulant(int index) { return fCumulants.at(index); }
   CorrConfig GetCorrelatorConfig(std::string config, std::string head = "", bool ptdif = false);
@@ -71,6 +73,32 @@ class GFW
  protected:
   bool fInitialized;
   std::vector<CorrConfig> fListOfCFGs;
+  std::vector<int> fBatchPt; // Particles of one region in the batch filling
+  std::vector<double> fBatchPhi;
+  std::vector<double> fBatchWeight;
+  std::vector<double> fBatchSecondWeight;
+  // Correlators compiled into a graph of terms shared between configurations and pt bins, each term evaluated once per event
+  struct CorrNode {
+    enum NodeType { kOne,      // Q_poi(n1, p1)
+                    kTwo,      // Q_poi(n1, p1) Q_ref(n2, p2) - Q_ovl(n1 + n2, p1 + p2)
+                    kRecursive // prefix * Q_ref(n2, p2) - sum of degeneracy * subtracted terms
+    };
+    NodeType type;
+    int poi, ref, ovl, ptbin;
+    int n1, p1, n2, p2;
+    int prefix;
+    std::vector<std::pair<int, int>> subtractions; // (term, degeneracy)
+    unsigned int epoch;                            // event at which value was computed
+    std::complex<double> value;
+  };
+  std::vector<CorrNode> fCorrNodes;               //!
+  std::map<std::vector<int>, int> fCorrNodeIndex; //! (poi, ref, ovl, ptbin, harmonics, powers) -> term
+  std::vector<int> fCorrKey;                      //! Buffers for the term lookup
+  std::vector<int> fCorrPows;                     //!
+  unsigned int fEpoch = 1;                        //! Incremented whenever the Q vectors change
+  int CompileCorr(int poi, int ref, int ovl, int ptbin, std::vector<int>& hars, std::vector<int>& pows);
+  std::complex<double> EvaluateCorr(int node);
+  void ClearCompiledCorr();
   std::complex<double> TwoRec(int n1, int n2, int p1, int p2, int ptbin, GFWCumulant*, GFWCumulant*, GFWCumulant*);
   std::complex<double> RecursiveCorr(GFWCumulant* qpoi, GFWCumulant* qref, GFWCumulant* qol, int ptbin, std::vector<int>& hars, std::vector<int>& pows); // POI, Ref. flow, overlapping region
   std::complex<double> RecursiveCorr(GFWCumulant* qpoi, GFWCumulant* qref, GFWCumulant* qol, int ptbin, std::vector<int>& hars);                         // POI, Ref. flow, overlapping region
@@ -18,18 +18,22 @@ If used, modified, or distributed, please aknowledge the author of this code.
 */
 
 #include "GFWCumulant.h"
+#include <algorithm>
 
 using std::complex;
 using std::vector;
 
-GFWCumulant::GFWCumulant() : fQvector(0),
+GFWCumulant::GFWCumulant() : fQvector(),
+                             fQOffsets(),
+                             fQStride(0),
                              fUsed(kBlank),
                              fNEntries(-1),
                              fN(1),
                              fPow(1),
                              fPt(1),
-                             fFilledPts(0),
-                             fInitialized(false) {}
+                             fFilledPts(),
+                             fInitialized(false),
+                             fMaxPow(0) {}
 
 GFWCumulant::~GFWCumulant() {}
 void GFWCumulant::FillArray(int ptin, double phi, double weight, double SecondWeight)
@@ -40,54 +44,65 @@ void GFWCumulant::FillArray(int ptin, double phi, double weight, double SecondWe
     ptin = 0; // If one bin, then just fill it straight; otherwise, if ptin is out-of-range, do not fill
   else if (ptin < 0 || ptin >= fPt)
     return;
+  FillQs(ptin, complex<double>(cos(phi), sin(phi)), weight, SecondWeight);
+  Inc();
+};
+void GFWCumulant::FillArray(int nParticles, const int* ptin, const double* phi, const double* weight, const double* SecondWeight)
+{
+  if (!fInitialized)
+    CreateComplexVectorArray(1, 1, 1);
+  // Only one cos and sin per particle, in a loop which can be vectorised
+  fCosPhi.resize(nParticles);
+  fSinPhi.resize(nParticles);
+  for (int i = 0; i < nParticles; i++) {
+    fCosPhi[i] = cos(phi[i]);
+    fSinPhi[i] = sin(phi[i]);
+  }
+  for (int i = 0; i < nParticles; i++) {
+    int lPt = ptin[i];
+    if (fPt == 1)
+      lPt = 0;
+    else if (lPt < 0 || lPt >= fPt)
+      continue;
+    FillQs(lPt, complex<double>(fCosPhi[i], fSinPhi[i]), weight[i], SecondWeight ? SecondWeight[i] : -1);
+    Inc();
+  }
+};
+void GFWCumulant::FillQs(int ptin, complex<double> lExpPhi, double weight, double SecondWeight)
+{
   fFilledPts[ptin] = true;
+  // Powers of the weight; multiplication is cheaper than power
+  // Also, if second weight is specified, then keep the first weight with power no more than 1, and us the other weight otherwise
+  // this is important when POIs are a subset of REFs and have different weights than REFs
+  fWeightPow[0] = 1;
+  for (int lPow = 1; lPow < fMaxPow; lPow++)
+    fWeightPow[lPow] = fWeightPow[lPow - 1] * ((SecondWeight > 0 && lPow > 1) ? SecondWeight : weight);
+  // Harmonics from the recurrence e^{in phi} = e^{i phi} e^{i(n-1) phi}
+  complex<double> lExpNPhi(1, 0);
+  complex<double>* lQ = fQvector.data() + ptin * fQStride;
   for (int lN = 0; lN < fN; lN++) {
-    double lSin = sin(lN * phi); // No need to recalculate for each power
-    double lCos = cos(lN * phi); // No need to recalculate for each power
-    for (int lPow = 0; lPow < PW(lN); lPow++) {
-      double lPrefactor = 0;
-      // Dont calculate it twice; multiplication is cheaper that power
-      // Also, if second weight is specified, then keep the first weight with power no more than 1, and us the other weight otherwise
-      // this is important when POIs are a subset of REFs and have different weights than REFs
-      if (SecondWeight > 0 && lPow > 1)
-        lPrefactor = pow(SecondWeight, lPow - 1) * weight;
-      else
-        lPrefactor = pow(weight, lPow);
-      double qsin = lPrefactor * lSin;
-      double qcos = lPrefactor * lCos;
-      fQvector[ptin][lN][lPow] += complex<double>(qcos, qsin);
-    }
+    complex<double>* lQN = lQ + fQOffsets[lN];
+    for (int lPow = 0; lPow < PW(lN); lPow++)
+      lQN[lPow] += fWeightPow[lPow] * lExpNPhi;
+    lExpNPhi *= lExpPhi;
   }
-  Inc();
 };
 void GFWCumulant::ResetQs()
 {
   if (!fNEntries)
     return; // If 0 entries, then no need to reset. Otherwise, if -1, then just initialized and need to set to 0.
-  for (int i = 0; i < fPt; i++) {
-    fFilledPts[i] = false;
-    for (int lN = 0; lN < fN; lN++) {
-      for (int lPow = 0; lPow < PW(lN); lPow++) {
-        fQvector[i][lN][lPow] = fNullQ;
-      }
-    }
-  }
+  std::fill(fFilledPts.begin(), fFilledPts.end(), false);
+  std::fill(fQvector.begin(), fQvector.end(), fNullQ);
   fNEntries = 0;
 };
 void GFWCumulant::DestroyComplexVectorArray()
 {
   if (!fInitialized)
     return;
-  for (int l_n = 0; l_n < fN; l_n++) {
-    for (int i = 0; i < fPt; i++) {
-      delete[] fQvector[i][l_n];
-    }
-  }
-  for (int i = 0; i < fPt; i++) {
-    delete[] fQvector[i];
-  }
-  delete[] fQvector;
-  delete[] fFilledPts;
+  fQvector.clear();
+  fQOffsets.clear();
+  fQStride = 0;
+  fFilledPts.clear();
   fInitialized = false;
   fNEntries = -1;
 };
@@ -106,17 +121,18 @@ void GFWCumulant::CreateComplexVectorArrayVarPower(int N, vector<int> PowVec, in
   fN = N;
   fPow = 0;
   fPt = Pt;
-  fFilledPts = new bool[Pt];
+  fFilledPts.assign(Pt, false);
   fPowVec = PowVec;
-  fQvector = new complex<double>**[fPt];
-  for (int i = 0; i < fPt; i++) {
-    fQvector[i] = new complex<double>*[fN];
-  }
+  fQOffsets.resize(fN);
+  fQStride = 0;
+  fMaxPow = 1;
   for (int l_n = 0; l_n < fN; l_n++) {
-    for (int i = 0; i < fPt; i++) {
-      fQvector[i][l_n] = new complex<double>[PW(l_n)];
-    }
+    fQOffsets[l_n] = fQStride;
+    fQStride += PW(l_n);
+    fMaxPow = std::max(fMaxPow, PW(l_n));
   }
+  fWeightPow.resize(fMaxPow);
+  fQvector.assign(fPt * fQStride, fNullQ);
   ResetQs();
   fInitialized = true;
 };
@@ -127,12 +143,12 @@ complex<double> GFWCumulant::Vec(int n, int p, int ptbin)
   if (ptbin >= fPt || ptbin < 0)
     ptbin = 0;
   if (n >= 0)
-    return fQvector[ptbin][n][p];
-  return conj(fQvector[ptbin][-n][p]);
+    return fQvector[ptbin * fQStride + fQOffsets[n] + p];
+  return conj(fQvector[ptbin * fQStride + fQOffsets[-n] + p]);
 };
 bool GFWCumulant::IsPtBinFilled(int ptb)
 {
-  if (!fFilledPts)
+  if (fFilledPts.empty())
     return false;
   if (ptb > 0) {
     if (fPt == 1)
@@ -30,6 +30,7 @@ class GFWCumulant
   ~GFWCumulant();
   void ResetQs();
   void FillArray(int ptin, double phi, double weight = 1, double SecondWeight = -1);
+  void FillArray(int nParticles, const int* ptin, const double* phi, const double* weight, const double* SecondWeight = nullptr); // Batch version, SecondWeight not used if null
   enum UsedFlags_t { kBlank = 0,
                      kFull = 1,
                      kPt = 2 };
@@ -47,7 +48,9 @@ class GFWCumulant
   void DestroyComplexVectorArray();
   std::complex<double> Vec(int, int, int ptbin = 0); // envelope class to summarize pt-dif. Q-vec getter
  protected:
-  std::complex<double>*** fQvector;
+  std::vector<std::complex<double>> fQvector; //! Q vectors, contiguous in pt bin, harmonic, power
+  std::vector<int> fQOffsets;                //! Offset of each harmonic within a pt bin
+  int fQStride;                              //! Number of Q vectors per pt bin
   uint fUsed;
   int fNEntries;
   // Q-vectors. Could be done recursively, but maybe defining each one of them explicitly is easier to read
@@ -55,9 +58,14 @@ class GFWCumulant
   int fPow;                 //! Power
   std::vector<int> fPowVec; //! Powers array
   int fPt;                  //! fPt bins
-  bool* fFilledPts;
+  std::vector<bool> fFilledPts;
   bool fInitialized; // Arrays are initialized
   std::complex<double> fNullQ = 0;
+  int fMaxPow;                    //! Highest power over all harmonics
+  std::vector<double> fWeightPow; //! Powers of the weight of the particle being filled
+  std::vector<double> fCosPhi;    //! Buffers of the batch filling
+  std::vector<double> fSinPhi;    //!
+  void FillQs(int ptin, std::complex<double> lExpPhi, double weight, double SecondWeight);
 };
 
 #endif // PWGCF_GENERICFRAMEWORK_CORE_GFWCUMULANT_H_
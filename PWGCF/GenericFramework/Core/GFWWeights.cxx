@@ -143,27 +143,79 @@ double GFWWeights::GetWeight(double phi, double eta, double vz, double pt, doubl
 };
 double GFWWeights::GetNUA(double phi, double eta, double vz)
 {
-  if (!fAccInt)
-    CreateNUA();
-  int xind = fAccInt->GetXaxis()->FindBin(phi);
-  int etaind = fAccInt->GetYaxis()->FindBin(eta);
-  int vzind = fAccInt->GetZaxis()->FindBin(vz);
-  double weight = fAccInt->GetBinContent(xind, etaind, vzind);
-  if (weight != 0)
-    return 1. / weight;
-  return 1;
+  if (fNUAGrid.values.empty()) {
+    if (!fAccInt)
+      CreateNUA();
+    fNUAGrid.Build(fAccInt);
+  }
+  return fNUAGrid.Get(phi, eta, vz);
 }
 double GFWWeights::GetNUE(double pt, double eta, double vz)
 {
-  if (!fEffInt)
-    CreateNUE();
-  int xind = fEffInt->GetXaxis()->FindBin(pt);
-  int etaind = fEffInt->GetYaxis()->FindBin(eta);
-  int vzind = fEffInt->GetZaxis()->FindBin(vz);
-  double weight = fEffInt->GetBinContent(xind, etaind, vzind);
-  if (weight != 0)
-    return 1. / weight;
-  return 1;
+  if (fNUEGrid.values.empty()) {
+    if (!fEffInt)
+      CreateNUE();
+    fNUEGrid.Build(fEffInt);
+  }
+  return fNUEGrid.Get(pt, eta, vz);
+}
+void GFWWeights::GetNUA(int n, const double* phi, const double* eta, const double* vz, double* weights)
+{
+  if (n < 1)
+    return;
+  GetNUA(phi[0], eta[0], vz[0]); // build the grid if needed
+  for (int i = 0; i < n; i++)
+    weights[i] = fNUAGrid.Get(phi[i], eta[i], vz[i]);
+}
+void GFWWeights::GetNUE(int n, const double* pt, const double* eta, const double* vz, double* weights)
+{
+  if (n < 1)
+    return;
+  GetNUE(pt[0], eta[0], vz[0]); // build the grid if needed
+  for (int i = 0; i < n; i++)
+    weights[i] = fNUEGrid.Get(pt[i], eta[i], vz[i]);
+}
+int GFWWeights::WeightGrid::Axis::FindBin(double xv) const
+{
+  // Same as TAxis::FindFixBin
+  if (xv < min)
+    return 0;
+  if (!(xv < max))
+    return nBins + 1;
+  if (edges.empty())
+    return 1 + static_cast<int>(nBins * (xv - min) / (max - min));
+  return 1 + TMath::BinarySearch(nBins + 1, edges.data(), xv);
+}
+void GFWWeights::WeightGrid::Build(TH3D* h)
+{
+  values.clear();
+  if (!h) {
+    // no correction available: a single cell with unit weight
+    x = y = z = Axis{};
+    strideY = 2;
+    strideZ = 4;
+    values.assign(8, 1.f);
+    return;
+  }
+  Axis* axes[3] = {&x, &y, &z};
+  TAxis* hAxes[3] = {h->GetXaxis(), h->GetYaxis(), h->GetZaxis()};
+  for (int i = 0; i < 3; i++) {
+    axes[i]->nBins = hAxes[i]->GetNbins();
+    axes[i]->min = hAxes[i]->GetXmin();
+    axes[i]->max = hAxes[i]->GetXmax();
+    axes[i]->edges.clear();
+    if (hAxes[i]->GetXbins()->fN)
+      axes[i]->edges.assign(hAxes[i]->GetXbins()->fArray, hAxes[i]->GetXbins()->fArray + hAxes[i]->GetXbins()->fN);
+  }
+  strideY = x.nBins + 2;
+  strideZ = strideY * (y.nBins + 2);
+  values.resize(static_cast<size_t>(strideZ) * (z.nBins + 2));
+  for (int iz = 0; iz <= z.nBins + 1; iz++)
+    for (int iy = 0; iy <= y.nBins + 1; iy++)
+      for (int ix = 0; ix <= x.nBins + 1; ix++) {
+        double weight = h->GetBinContent(ix, iy, iz);
+        values[ix + strideY * iy + strideZ * iz] = (weight != 0) ? 1. / weight : 1.;
+      }
 }
 double GFWWeights::FindMax(TH3D* inh, int& ix, int& iy, int& iz)
 {
@@ -237,6 +289,7 @@ void GFWWeights::CreateNUA(bool IntegrateOverCentAndPt)
       fAccInt->GetZaxis()->SetRange(1, fAccInt->GetNbinsZ());
     }
     fAccInt->GetYaxis()->SetRange(1, fAccInt->GetNbinsY());
+    fNUAGrid.Build(fAccInt);
     return;
   }
 };
@@ -278,6 +331,7 @@ void GFWWeights::CreateNUE(bool IntegrateOverCentrality)
     den->RebinZ(5);
     fEffInt = reinterpret_cast<TH3D*>(num->Clone("Efficiency_Integrated"));
     fEffInt->Divide(den);
+    fNUEGrid.Build(fEffInt);
     return;
   }
 };
@@ -362,6 +416,7 @@ void GFWWeights::OverwriteNUA()
   delete trash;
   fW_data->Add(reinterpret_cast<TH3D*>(fAccInt->Clone(ts.Data())));
   delete fAccInt;
+  fAccInt = 0;
 }
 Long64_t GFWWeights::Merge(TCollection* collist)
 {
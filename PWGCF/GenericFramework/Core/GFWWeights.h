@@ -19,6 +19,7 @@
 #include "TFile.h"
 #include "TCollection.h"
 #include "TString.h"
+#include <vector>
 
 class GFWWeights : public TNamed
 {
@@ -31,6 +32,8 @@ class GFWWeights : public TNamed
   double GetWeight(double phi, double eta, double vz, double pt, double cent, int htype);             // htype: 0 for data, 1 for mc rec, 2 for mc gen
   double GetNUA(double phi, double eta, double vz);                                                   // This just fetches correction from integrated NUA, should speed up
   double GetNUE(double pt, double eta, double vz);                                                    // fetches weight from fEffInt
+  void GetNUA(int n, const double* phi, const double* eta, const double* vz, double* weights);        // batch version of GetNUA
+  void GetNUE(int n, const double* pt, const double* eta, const double* vz, double* weights);         // batch version of GetNUE
   bool IsDataFilled() { return fDataFilled; }
   bool IsMCFilled() { return fMCFilled; }
   double FindMax(TH3D* inh, int& ix, int& iy, int& iz);
@@ -64,6 +67,28 @@ class GFWWeights : public TNamed
   TH3D* fAccInt;   //!
   int fNbinsPt;    //! do not store
   double* fbinsPt; //! do not store
+  // Correction factors (1/content, or 1 for empty bins) of a TH3D in one flat array, including under- and overflows,
+  // with the bin finding of TAxis::FindFixBin, so that a lookup does not go through the histogram
+  struct WeightGrid {
+    struct Axis {
+      int nBins = 0;
+      double min = 0;
+      double max = 0;
+      std::vector<double> edges; // empty for uniform binning
+      int FindBin(double x) const;
+    };
+    Axis x, y, z;
+    int strideY = 0;
+    int strideZ = 0;
+    std::vector<float> values;
+    void Build(TH3D* h);
+    double Get(double xv, double yv, double zv) const
+    {
+      return values[x.FindBin(xv) + strideY * y.FindBin(yv) + strideZ * z.FindBin(zv)];
+    }
+  };
+  WeightGrid fNUAGrid; //! built from fAccInt
+  WeightGrid fNUEGrid; //! built from fEffInt
   void AddArray(TObjArray* targ, TObjArray* sour);
   const char* GetBinName(double /*ptv*/, double /*v0mv*/, const char* pf = "")
   {
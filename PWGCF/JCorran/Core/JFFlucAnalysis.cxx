@@ -135,6 +135,20 @@ void JFFlucAnalysis::UserExec(Option_t* popt)
 
   const TComplex(*pQq)[kNH][nKL] = pqvecs->QvectorQCgap;
 
+  // symmetric cumulants of the full event, the same for both subevents
+  const Double_t ref_four = Four(0, 0, 0, 0).Re();
+  const Double_t ref_two = Two(0, 0).Re();
+  Double_t scfour[kNH][kcNH];
+  Double_t sctwo[kNH];
+  for (UInt_t ih = 2; ih < kNH; ih++) {
+    for (UInt_t ihh = 2, mm = (ih < kcNH ? ih : kcNH); ihh < mm; ihh++)
+      scfour[ih][ihh] = Four(ih, ihh, -ih, -ihh).Re() / ref_four;
+    sctwo[ih] = Two(ih, -ih).Re() / ref_two;
+  }
+
+  THnSparse* phVn = phs[HIST_THN_SPARSE_VN];
+  THnSparse* phVnVn = phs[HIST_THN_SPARSE_VN_VN];
+
   for (UInt_t i = 0; i < 2; ++i) {
     if ((subeventMask & (1 << i)) == 0)
       continue;
@@ -187,7 +201,10 @@ void JFFlucAnalysis::UserExec(Option_t* popt)
       ncorr[ih][3] = SixGap33(pQq, i, ih, ih, ih, ih, ih, ih);
       for (UInt_t ik = 4; ik < nKL; ik++)
         ncorr[ih][ik] = corr[ih][ik]; // for 8,...-particle correlations, ignore the autocorrelation / weight dependency for now
+    }
 
+    // products of the correlators of two harmonics, once ncorr is set for all of them
+    for (UInt_t ih = 2; ih < kNH; ih++) {
       for (UInt_t ihh = 2; ihh < kcNH; ihh++) {
         ncorr2[ih][1][ihh][1] = FourGap22(pQq, i, ih, ihh, ih, ihh);
         ncorr2[ih][1][ihh][2] = SixGap33(pQq, i, ih, ihh, ihh, ih, ihh, ihh);
@@ -203,11 +220,11 @@ void JFFlucAnalysis::UserExec(Option_t* popt)
                                             // vn2[ih][ik] = corr[ih][ik].Re() / ref_2Np[ik - 1];
         // fh_vn[ih][ik][fCBin]->Fill(vn2[ih][ik], ebe_2Np_weight[ik - 1]);
         // fh_vna[ih][ik][fCBin]->Fill(ncorr[ih][ik].Re() / ref_2Np[ik - 1], ebe_2Np_weight[ik - 1]);
-        phs[HIST_THN_SPARSE_VN]->Fill(fCent, ih, ik, ncorr[ih][ik].Re() / ref_2Np[ik - 1], ebe_2Np_weight[ik - 1]);
+        phVn->Fill(fCent, ih, ik, ncorr[ih][ik].Re() / ref_2Np[ik - 1], ebe_2Np_weight[ik - 1]);
         for (UInt_t ihh = 2; ihh < kcNH; ihh++) {
           for (UInt_t ikk = 1; ikk < nKL; ikk++) {
             Double_t vn2_vn2 = ncorr2[ih][ik][ihh][ikk] / ref_2Np[ik + ikk - 1];
-            phs[HIST_THN_SPARSE_VN_VN]->Fill(fCent, ih, ik, ihh, ikk, vn2_vn2, ebe_2Np_weight[ik + ikk - 1]);
+            phVnVn->Fill(fCent, ih, ik, ihh, ikk, vn2_vn2, ebe_2Np_weight[ik + ikk - 1]);
           }
         }
       }
@@ -290,20 +307,16 @@ void JFFlucAnalysis::UserExec(Option_t* popt)
     Double_t event_weight_two = 1.0;
     Double_t event_weight_two_gap = 1.0;
     if (flags & kFlucEbEWeighting) {
-      event_weight_four = Four(0, 0, 0, 0).Re();
-      event_weight_two = Two(0, 0).Re();
+      event_weight_four = ref_four;
+      event_weight_two = ref_two;
       event_weight_two_gap = (pqvecs->QvectorQCgap[kSubA][0][1] * pqvecs->QvectorQCgap[kSubB][0][1]).Re();
     }
 
     for (UInt_t ih = 2; ih < kNH; ih++) {
-      for (UInt_t ihh = 2, mm = (ih < kcNH ? ih : kcNH); ihh < mm; ihh++) {
-        TComplex scfour = Four(ih, ihh, -ih, -ihh) / Four(0, 0, 0, 0).Re();
-
-        pht[HIST_THN_SC_with_QC_4corr]->Fill(fCent, ih, ihh, scfour.Re(), event_weight_four);
-      }
+      for (UInt_t ihh = 2, mm = (ih < kcNH ? ih : kcNH); ihh < mm; ihh++)
+        pht[HIST_THN_SC_with_QC_4corr]->Fill(fCent, ih, ihh, scfour[ih][ihh], event_weight_four);
 
-      TComplex sctwo = Two(ih, -ih) / Two(0, 0).Re();
-      pht[HIST_THN_SC_with_QC_2corr]->Fill(fCent, ih, sctwo.Re(), event_weight_two);
+      pht[HIST_THN_SC_with_QC_2corr]->Fill(fCent, ih, sctwo[ih], event_weight_two);
 
       TComplex sctwoGap = (pqvecs->QvectorQCgap[kSubA][ih][1] * TComplex::Conjugate(pqvecs->QvectorQCgap[kSubB][ih][1])) / (pqvecs->QvectorQCgap[kSubA][0][1] * pqvecs->QvectorQCgap[kSubB][0][1]).Re();
       pht[HIST_THN_SC_with_QC_2corr_gap]->Fill(fCent, ih, sctwoGap.Re(), event_weight_two_gap);
@@ -63,23 +63,39 @@ class JQVectors : public std::conditional_t<gap, JQVectorsGapBase<Q, nh, nk>, JQ
         continue;
 
       UInt_t isub = (UInt_t)(track.eta() > 0.0);
+      bool inGap = false;
+      if constexpr (gap)
+        inGap = TMath::Abs(track.eta()) > etamin;
+
+      // weight factor of the power ik is w^ik, with w the inverse of the track weights
+      Double_t w = 1.0;
+      using JInputClassIter = typename JInputClass::iterator;
+      if constexpr (std::experimental::is_detected<hasWeightNUA, const JInputClassIter>::value)
+        w /= track.weightNUA();
+      if constexpr (std::experimental::is_detected<hasWeightEff, const JInputClassIter>::value)
+        w /= track.weightEff();
+
+      // cos(ih phi) and sin(ih phi) from the recurrence of the complex phase exp(i phi)
+      const Double_t phi = track.phi();
+      const Double_t c1 = TMath::Cos(phi);
+      const Double_t s1 = TMath::Sin(phi);
+      Double_t ch = 1.0;
+      Double_t sh = 0.0;
       for (UInt_t ih = 0; ih < nh; ++ih) {
         Double_t tf = 1.0;
         for (UInt_t ik = 0; ik < nk; ++ik) {
-          Q q(tf * TMath::Cos(ih * track.phi()), tf * TMath::Sin(ih * track.phi()));
+          Q q(tf * ch, tf * sh);
           QvectorQC[ih][ik] += q;
 
           if constexpr (gap) {
-            if (TMath::Abs(track.eta()) > etamin)
+            if (inGap)
               this->QvectorQCgap[isub][ih][ik] += q;
           }
-
-          using JInputClassIter = typename JInputClass::iterator;
-          if constexpr (std::experimental::is_detected<hasWeightNUA, const JInputClassIter>::value)
-            tf /= track.weightNUA();
-          if constexpr (std::experimental::is_detected<hasWeightEff, const JInputClassIter>::value)
-            tf /= track.weightEff();
+          tf *= w;
         }
+        const Double_t chNext = ch * c1 - sh * s1;
+        sh = sh * c1 + ch * s1;
+        ch = chNext;
       }
     }
   }
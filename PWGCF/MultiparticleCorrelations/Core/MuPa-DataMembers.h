@@ -12,6 +12,8 @@
 #ifndef PWGCF_MULTIPARTICLECORRELATIONS_CORE_MUPA_DATAMEMBERS_H_
 #define PWGCF_MULTIPARTICLECORRELATIONS_CORE_MUPA_DATAMEMBERS_H_
 
+#include <vector>
+
 // General remarks:
 // 0. Starting with C++11, it's possible to initialize data members at declaration, so I do it here
 // 1. Use //!<! for introducing a Doxygen comment interpreted as transient in both ROOT 5 and ROOT 6.
@@ -160,6 +162,9 @@ struct Qvector {
   TComplex fQvector[gMaxHarmonic * gMaxCorrelator + 1][gMaxCorrelator + 1] = {{TComplex(0., 0.)}};                                     //! "integrated" Q-vector
   TComplex fqvector[eqvectorKine_N][gMaxNoBinsKine][gMaxHarmonic * gMaxCorrelator + 1][gMaxCorrelator + 1] = {{{{TComplex(0., 0.)}}}}; //! "differenttial" q-vector [kine var.][binNo][fMaxHarmonic*fMaxCorrelator+1][fMaxCorrelator+1] = [6*12+1][12+1]
   Int_t fqVectorEntries[eqvectorKine_N][gMaxNoBinsKine] = {{0}};                                                                       // count number of entries in each differential q-vector
+  std::vector<Double_t> fParticlePhi;                                                                                                  //! e-b-e buffer of azimuthal angles, the integrated Q-vector is filled from it in one go
+  std::vector<Double_t> fParticleWeight;                                                                                               //! e-b-e buffer of particle weights (product of all integrated weights)
+  std::vector<Double_t> fBuffer;                                                                                                       //! work space for FillQvectorFromBuffers()
 } qv;                                                                                                                                  // "qv" is a common label for objects in this struct
 
 // *) Multiparticle correlations (standard, isotropic, same harmonic):
@@ -192,6 +197,8 @@ struct NestedLoops {
   Bool_t fCalculateCustomNestedLoops = kFALSE;                                 // validate e-b-e all correlations with custom nested loop
   Bool_t fCalculateKineCustomNestedLoops = kFALSE;                             // validate e-b-e all differential (vs pt, eta, etc.) correlations with custom nested loop
   Int_t fMaxNestedLoop = -1;                                                   // if set to e.g. 4, all nested loops beyond that, e.g. 6-p and 8-p, are NOT calculated
+  Float_t fSamplingFraction = 1.;                                              // fraction of randomly sampled events for which nested loops are calculated (1. = all events)
+  Bool_t fSampledEvent = kTRUE;                                                // nested loops are calculated for the current event
   TProfile* fNestedLoopsPro[4][gMaxHarmonic][eAsFunctionOf_N] = {{{NULL}}};    //! multiparticle correlations from nested loops
                                                                                //! [2p=0,4p=1,6p=2,8p=3][n=1,n=2,...,n=gMaxHarmonic][0=integrated,1=vs.
                                                                                //! multiplicity,2=vs. centrality,3=pT,4=eta]
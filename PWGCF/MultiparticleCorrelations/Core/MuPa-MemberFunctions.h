@@ -348,6 +348,7 @@ void DefaultConfiguration()
   nl.fCalculateCustomNestedLoops = cf_nl.cfCalculateCustomNestedLoops;
   nl.fCalculateKineCustomNestedLoops = cf_nl.cfCalculateKineCustomNestedLoops;
   nl.fMaxNestedLoop = cf_nl.cfMaxNestedLoop;
+  nl.fSamplingFraction = cf_nl.cfNestedLoopsSamplingFraction;
 
   // ...
 
@@ -1237,6 +1238,11 @@ void InsanityChecks()
     LOGF(fatal, "\033[1;31m%s at line %d : Cannot calculate Test0, in case Q-vectors are not filled \033[0m", __FUNCTION__, __LINE__);
   }
 
+  // *) Sampling fraction for nested loops must be in (0,1]:
+  if (!(nl.fSamplingFraction > 0. && nl.fSamplingFraction <= 1.)) {
+    LOGF(fatal, "\033[1;31m%s at line %d : nl.fSamplingFraction = %f is not in (0,1] \033[0m", __FUNCTION__, __LINE__, nl.fSamplingFraction);
+  }
+
   // *) Insanity check on individual flags: Make sure that only one process is set to kTRUE.
   //    If 2 or more are kTRUE, then corresponding process function is executed over ALL data, then another process(...) function, etc.
   //    Re-think this if it's possible to run different process(...)'s concurently over the same data.
@@ -2239,7 +2245,7 @@ void BookNestedLoopsHistograms()
 
   // a) Book the profile holding flags:
   nl.fNestedLoopsFlagsPro =
-    new TProfile("fNestedLoopsFlagsPro", "flags for nested loops", 4, 0., 4.);
+    new TProfile("fNestedLoopsFlagsPro", "flags for nested loops", 5, 0., 5.);
   nl.fNestedLoopsFlagsPro->SetStats(kFALSE);
   nl.fNestedLoopsFlagsPro->SetLineColor(eColor);
   nl.fNestedLoopsFlagsPro->SetFillColor(eFillColor);
@@ -2252,6 +2258,8 @@ void BookNestedLoopsHistograms()
   nl.fNestedLoopsFlagsPro->Fill(2.5, nl.fCalculateKineCustomNestedLoops);
   nl.fNestedLoopsFlagsPro->GetXaxis()->SetBinLabel(4, "fMaxNestedLoop");
   nl.fNestedLoopsFlagsPro->Fill(3.5, nl.fMaxNestedLoop);
+  nl.fNestedLoopsFlagsPro->GetXaxis()->SetBinLabel(5, "fSamplingFraction");
+  nl.fNestedLoopsFlagsPro->Fill(4.5, nl.fSamplingFraction);
   nl.fNestedLoopsList->Add(nl.fNestedLoopsFlagsPro);
 
   if (!(nl.fCalculateNestedLoops || nl.fCalculateCustomNestedLoops || nl.fCalculateKineCustomNestedLoops)) {
@@ -2799,7 +2807,7 @@ void InternalValidation()
       }
 
       // *) Fill nested loops containers:
-      if (nl.fCalculateNestedLoops || nl.fCalculateCustomNestedLoops) {
+      if ((nl.fCalculateNestedLoops || nl.fCalculateCustomNestedLoops) && nl.fSampledEvent) {
         this->FillNestedLoopsContainers(ebye.fSelectedTracks, dPhi, dPt, dEta); // all 4 arguments are passed by reference
       }
 
@@ -3290,19 +3298,27 @@ void ResetEventByEventQuantities()
       }
     }
     // b2) diff. Q-vector:
-    for (Int_t bin = 1; bin <= gMaxNoBinsKine; bin++) {
-      qv.fqVectorEntries[PTq][bin - 1] = 0; // TBI 20240214 shall I loop also over enum's PTq and ETAq? If yes, fix it also below for qv.fqvector[PTq][bin - 1][...
-      qv.fqVectorEntries[ETAq][bin - 1] = 0;
-      for (Int_t h = 0; h < gMaxHarmonic * gMaxCorrelator + 1; h++) {
-        for (Int_t wp = 0; wp < gMaxCorrelator + 1; wp++) { // weight power
-          qv.fqvector[PTq][bin - 1][h][wp] = TComplex(0., 0.);
-          qv.fqvector[ETAq][bin - 1][h][wp] = TComplex(0., 0.);
-        } // for (Int_t wp = 0; wp < gMaxCorrelator + 1; wp++) { // weight power
-      }   // for (Int_t h = 0; h < gMaxHarmonic * gMaxCorrelator + 1; h++) {
-    }     // for (Int_t b = 0; b < gMaxNoBinsKine; b++ ) {
-  }       // if(qv.fCalculateQvectors)
-
-  // c) Reset ebe containers for nested loops:
+    //     Remark: only the bins which were filled in this event (i.e. with non-zero number of entries) need to be reset.
+    for (Int_t kv = 0; kv < eqvectorKine_N; kv++) {
+      for (Int_t bin = 1; bin <= gMaxNoBinsKine; bin++) {
+        if (0 == qv.fqVectorEntries[kv][bin - 1]) {
+          continue;
+        }
+        qv.fqVectorEntries[kv][bin - 1] = 0;
+        for (Int_t h = 0; h < gMaxHarmonic * gMaxCorrelator + 1; h++) {
+          for (Int_t wp = 0; wp < gMaxCorrelator + 1; wp++) { // weight power
+            qv.fqvector[kv][bin - 1][h][wp] = TComplex(0., 0.);
+          } // for (Int_t wp = 0; wp < gMaxCorrelator + 1; wp++) { // weight power
+        }   // for (Int_t h = 0; h < gMaxHarmonic * gMaxCorrelator + 1; h++) {
+      }     // for (Int_t bin = 1; bin <= gMaxNoBinsKine; bin++) {
+    }       // for (Int_t kv = 0; kv < eqvectorKine_N; kv++) {
+    // b3) buffers for integrated Q-vector:
+    qv.fParticlePhi.clear();
+    qv.fParticleWeight.clear();
+  } // if(qv.fCalculateQvectors)
+
+  // c) Reset ebe containers for nested loops, and decide if nested loops are calculated for the next event:
+  nl.fSampledEvent = (nl.fSamplingFraction >= 1. || gRandom->Uniform(0., 1.) < nl.fSamplingFraction);
   if (nl.fCalculateNestedLoops || nl.fCalculateCustomNestedLoops) {
     if (nl.ftaNestedLoops[0]) {
       nl.ftaNestedLoops[0]->Reset();
@@ -5208,7 +5224,7 @@ void CalculateCorrelations()
       LOGF(fatal, "In function \033[1;31m%s at line %d, wTwo = %f <=0. ebye.fSelectedTracks = %d\033[0m", __FUNCTION__, __LINE__, wTwo, ebye.fSelectedTracks);
     }
 
-    if (nl.fCalculateCustomNestedLoops) {
+    if (nl.fCalculateCustomNestedLoops && nl.fSampledEvent) {
       // e-b-e sanity check:
       TArrayI* harmonics = new TArrayI(2);
       harmonics->SetAt(h, 0);
@@ -5259,7 +5275,7 @@ void CalculateCorrelations()
       // TBI 20240110 shall I 'continue' here, instead of bailing out?
     }
 
-    if (nl.fCalculateCustomNestedLoops) {
+    if (nl.fCalculateCustomNestedLoops && nl.fSampledEvent) {
       // e-b-e sanity check:
       TArrayI* harmonics = new TArrayI(4);
       harmonics->SetAt(h, 0);
@@ -5312,7 +5328,7 @@ void CalculateCorrelations()
       // TBI 20240110 shall I 'continue' here, instead of bailing out?
     }
 
-    if (nl.fCalculateCustomNestedLoops) {
+    if (nl.fCalculateCustomNestedLoops && nl.fSampledEvent) {
       // e-b-e sanity check:
       TArrayI* harmonics = new TArrayI(6);
       harmonics->SetAt(h, 0);
@@ -5367,7 +5383,7 @@ void CalculateCorrelations()
       // TBI 20240110 shall I 'continue' here, instead of bailing out?
     }
 
-    if (nl.fCalculateCustomNestedLoops) {
+    if (nl.fCalculateCustomNestedLoops && nl.fSampledEvent) {
       // e-b-e sanity check:
       TArrayI* harmonics = new TArrayI(8);
       harmonics->SetAt(h, 0);
@@ -5574,7 +5590,7 @@ void CalculateTest0()
         }
 
         // e-b-e sanity check:
-        if (nl.fCalculateCustomNestedLoops) {
+        if (nl.fCalculateCustomNestedLoops && nl.fSampledEvent) {
           TArrayI* harmonics = new TArrayI(mo + 1);
           for (Int_t i = 0; i < mo + 1; i++) {
             harmonics->SetAt(n[i], i);
@@ -5771,7 +5787,7 @@ void CalculateKineTest0(eAsFunctionOf AFO_variable)
           } // switch(mo+1)
 
           // *) e-b-e sanity check:
-          if (nl.fCalculateKineCustomNestedLoops) {
+          if (nl.fCalculateKineCustomNestedLoops && nl.fSampledEvent) {
             TArrayI* harmonics = new TArrayI(mo + 1);
             for (Int_t i = 0; i < mo + 1; i++) {
               harmonics->SetAt(n[i], i);
@@ -8328,10 +8344,9 @@ void FillQvector(const Double_t& dPhi, const Double_t& dPt, const Double_t& dEta
   }
 
   // Particle weights:
-  Double_t wPhi = 1.;      // integrated phi weight
-  Double_t wPt = 1.;       // integrated pt weight
-  Double_t wEta = 1.;      // integrated eta weight
-  Double_t wToPowerP = 1.; // weight raised to power p
+  Double_t wPhi = 1.; // integrated phi weight
+  Double_t wPt = 1.;  // integrated pt weight
+  Double_t wEta = 1.; // integrated eta weight
 
   if (pw.fUseWeights[wPHI]) {
     wPhi = Weight(dPhi, wPHI);
@@ -8357,23 +8372,87 @@ void FillQvector(const Double_t& dPhi, const Double_t& dPt, const Double_t& dEta
     }
   } // if(pw.fUseWeights[wETA])
 
+  // Only the angle and the weight are stored here, all harmonics and powers are filled once per event in FillQvectorFromBuffers():
   if (qv.fCalculateQvectors) {
-    for (Int_t h = 0; h < gMaxHarmonic * gMaxCorrelator + 1; h++) {
-      for (Int_t wp = 0; wp < gMaxCorrelator + 1; wp++) { // weight power
-        if (pw.fUseWeights[wPHI] || pw.fUseWeights[wPT] || pw.fUseWeights[wETA]) {
-          wToPowerP = pow(wPhi * wPt * wEta, wp);
-          qv.fQvector[h][wp] += TComplex(wToPowerP * TMath::Cos(h * dPhi), wToPowerP * TMath::Sin(h * dPhi)); // Q-vector with weights
-        } else {
-          qv.fQvector[h][wp] += TComplex(TMath::Cos(h * dPhi), TMath::Sin(h * dPhi)); // bare Q-vector without weights
-        }
-      } // for(Int_t wp=0;wp<gMaxCorrelator+1;wp++)
-    }   // for(Int_t h=0;h<gMaxHarmonic*gMaxCorrelator+1;h++)
-  }     // if (qv.fCalculateQvectors) {
+    qv.fParticlePhi.push_back(dPhi);
+    qv.fParticleWeight.push_back(wPhi * wPt * wEta);
+  } // if (qv.fCalculateQvectors) {
 
 } // void FillQvector(const Double_t& dPhi, const Double_t& dPt, const Double_t& dEta)
 
 //============================================================
 
+void FillQvectorFromBuffers()
+{
+  // Fill integrated Q-vector from the e-b-e buffers of angles and weights filled in FillQvector(...).
+  // All harmonics are obtained with the recurrence exp(i*h*phi) = exp(i*(h-1)*phi) * exp(i*phi), and all weight powers
+  // by successive multiplications, so that cos and sin are evaluated only once per particle. The loops over particles
+  // are over contiguous arrays, so that the compiler can vectorize them.
+  // Example usage: this->FillQvectorFromBuffers();
+
+  if (tc.fVerbose) {
+    LOGF(info, "\033[1;32m%s\033[0m", __FUNCTION__);
+  }
+
+  const Int_t nParticles = qv.fParticlePhi.size();
+  if (0 == nParticles) {
+    return;
+  }
+  const Bool_t bUseWeights = pw.fUseWeights[wPHI] || pw.fUseWeights[wPT] || pw.fUseWeights[wETA];
+  const Int_t nPowers = bUseWeights ? gMaxCorrelator + 1 : 1; // without weights, all powers are the same
+
+  // *) Work space: [cos(phi), sin(phi), cos(h*phi), sin(h*phi), w^0, w^1, ..., w^gMaxCorrelator]:
+  qv.fBuffer.resize((4 + nPowers) * nParticles);
+  Double_t* c1 = &qv.fBuffer[0];
+  Double_t* s1 = c1 + nParticles;
+  Double_t* ch = s1 + nParticles;
+  Double_t* sh = ch + nParticles;
+  Double_t* wToPowerP = sh + nParticles;
+  for (Int_t i = 0; i < nParticles; i++) {
+    c1[i] = TMath::Cos(qv.fParticlePhi[i]);
+    s1[i] = TMath::Sin(qv.fParticlePhi[i]);
+    ch[i] = 1.; // h = 0
+    sh[i] = 0.;
+    wToPowerP[i] = 1.;
+  }
+  for (Int_t wp = 1; wp < nPowers; wp++) {
+    for (Int_t i = 0; i < nParticles; i++) {
+      wToPowerP[wp * nParticles + i] = wToPowerP[(wp - 1) * nParticles + i] * qv.fParticleWeight[i];
+    }
+  }
+
+  // *) Sum over particles, for all harmonics and weight powers:
+  for (Int_t h = 0; h < gMaxHarmonic * gMaxCorrelator + 1; h++) {
+    if (h > 0) {
+      for (Int_t i = 0; i < nParticles; i++) {
+        Double_t tmp = ch[i] * c1[i] - sh[i] * s1[i];
+        sh[i] = sh[i] * c1[i] + ch[i] * s1[i];
+        ch[i] = tmp;
+      }
+    }
+    for (Int_t wp = 0; wp < nPowers; wp++) { // weight power
+      const Double_t* w = wToPowerP + wp * nParticles;
+      Double_t re = 0.;
+      Double_t im = 0.;
+      for (Int_t i = 0; i < nParticles; i++) {
+        re += w[i] * ch[i];
+        im += w[i] * sh[i];
+      }
+      qv.fQvector[h][wp] += TComplex(re, im);
+    }
+    for (Int_t wp = nPowers; wp < gMaxCorrelator + 1; wp++) { // bare Q-vector without weights: same for all powers
+      qv.fQvector[h][wp] = qv.fQvector[h][0];
+    }
+  } // for(Int_t h=0;h<gMaxHarmonic*gMaxCorrelator+1;h++)
+
+  // *) The buffers are consumed:
+  qv.fParticlePhi.clear();
+  qv.fParticleWeight.clear();
+
+} // void FillQvectorFromBuffers()
+
+//============================================================
+
 void Fillqvector(const Double_t& dPhi, const Double_t& kineVarValue, eqvectorKine kineVarChoice)
 {
   // Fill differential q-vector, in generic kinematic variable. Here "kine" originally meant vs. pt or vs. eta, now it's general.
@@ -8447,21 +8526,29 @@ void Fillqvector(const Double_t& dPhi, const Double_t& kineVarValue, eqvectorKin
   } // if(pw.fUseDiffWeights[AFO_diffWeight]) {
 
   // *) Finally, fill differential q-vector in that bin:
+  //    Remark: harmonics are obtained with the recurrence exp(i*h*phi) = exp(i*(h-1)*phi) * exp(i*phi), and weight powers by successive multiplications.
+  // TBI 20240212 supported at the moment: e.g. q-vector vs pt can be weighted only with diff. phi(pt) and integrated pt weights.
+  // It cannot be weighted in addition with eta weights, since in any case I anticipate I will do always 1-D analysis, by integrating out all other dependencies
+  const Double_t wParticle = (pw.fUseWeights[AFO_weight] || pw.fUseDiffWeights[AFO_diffWeight]) ? diffPhiWeightsForThisKineVar * kineVarWeight : 1.;
+  const Double_t c1 = TMath::Cos(dPhi);
+  const Double_t s1 = TMath::Sin(dPhi);
+  Double_t ch = 1.; // cos(h*dPhi)
+  Double_t sh = 0.; // sin(h*dPhi)
   for (Int_t h = 0; h < gMaxHarmonic * gMaxCorrelator + 1; h++) {
+    if (h > 0) {
+      Double_t tmp = ch * c1 - sh * s1;
+      sh = sh * c1 + ch * s1;
+      ch = tmp;
+    }
+    wToPowerP = 1.;
     for (Int_t wp = 0; wp < gMaxCorrelator + 1; wp++) { // weight power
-      if (pw.fUseWeights[AFO_weight] || pw.fUseDiffWeights[AFO_diffWeight]) {
-        // TBI 20240212 supported at the moment: e.g. q-vector vs pt can be weighted only with diff. phi(pt) and integrated pt weights.
-        // It cannot be weighted in addition with eta weights, since in any case I anticipate I will do always 1-D analysis, by integrating out all other dependencies
-        wToPowerP = pow(diffPhiWeightsForThisKineVar * kineVarWeight, wp);
-        qv.fqvector[kineVarChoice][bin - 1][h][wp] += TComplex(wToPowerP * TMath::Cos(h * dPhi), wToPowerP * TMath::Sin(h * dPhi)); // q-vector with weights
-      } else {
-        qv.fqvector[kineVarChoice][bin - 1][h][wp] += TComplex(TMath::Cos(h * dPhi), TMath::Sin(h * dPhi)); // bare q-vector without weights
-      }
+      qv.fqvector[kineVarChoice][bin - 1][h][wp] += TComplex(wToPowerP * ch, wToPowerP * sh);
+      wToPowerP *= wParticle;
     } // for(Int_t wp=0;wp<gMaxCorrelator+1;wp++)
   }   // for(Int_t h=0;h<gMaxHarmonic*gMaxCorrelator+1;h++)
 
   // *) Differential nested loops:
-  if (nl.fCalculateKineCustomNestedLoops) {
+  if (nl.fCalculateKineCustomNestedLoops && nl.fSampledEvent) {
     nl.ftaNestedLoopsKine[kineVarChoice][bin - 1][0]->AddAt(dPhi, qv.fqVectorEntries[kineVarChoice][bin - 1]);
     nl.ftaNestedLoopsKine[kineVarChoice][bin - 1][1]->AddAt(diffPhiWeightsForThisKineVar * kineVarWeight, qv.fqVectorEntries[kineVarChoice][bin - 1]);
   }
@@ -8491,6 +8578,11 @@ void CalculateEverything()
   }
   // TBI 20240423 I need to re-organize here if-else statements + add support for the case when I process only sim, etc.
 
+  // *) Fill integrated Q-vectors from the buffers filled in the loop over particles:
+  if (qv.fCalculateQvectors) {
+    this->FillQvectorFromBuffers();
+  }
+
   // *) Calculate multiparticle correlations (standard, isotropic, same harmonic):
   if (qv.fCalculateQvectors && mupa.fCalculateCorrelations) {
     this->CalculateCorrelations();
@@ -8512,10 +8604,11 @@ void CalculateEverything()
   }
 
   // *) Calculate nested loops:
-  if (nl.fCalculateNestedLoops) {
+  if (nl.fCalculateNestedLoops && nl.fSampledEvent) {
     this->CalculateNestedLoops();
-    if (mupa.fCalculateCorrelations) {
+    if (mupa.fCalculateCorrelations && nl.fSamplingFraction >= 1.) {
       this->ComparisonNestedLoopsVsCorrelations(); // I call it here, so comparison is performed cumulatively after each event. The final printout corresponds to all events.
+      // Remark: Cumulative comparison makes sense only if nested loops are calculated for all events.
     }
   }
 
@@ -8738,7 +8831,7 @@ void MainLoopOverParticles(T const& tracks)
     }
 
     // *) Fill nested loops containers:
-    if (nl.fCalculateNestedLoops || nl.fCalculateCustomNestedLoops) {
+    if ((nl.fCalculateNestedLoops || nl.fCalculateCustomNestedLoops) && nl.fSampledEvent) {
       this->FillNestedLoopsContainers(ebye.fSelectedTracks, dPhi, dPt, dEta); // all 4 arguments are passed by reference
     }
 
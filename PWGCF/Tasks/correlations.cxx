@@ -12,6 +12,10 @@
 
 #include <TH1F.h>
 #include <cmath>
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <vector>
 #include <TDirectory.h>
 #include <THn.h>
 #include <TFile.h>
@@ -85,6 +89,8 @@ struct CorrelationTask {
 
   O2_DEFINE_CONFIGURABLE(cfgDecayParticleMask, int, 0, "Selection bitmask for the decay particles: 0 = no selection")
   O2_DEFINE_CONFIGURABLE(cfgMassAxis, int, 0, "Use invariant mass axis (0 = OFF, 1 = ON)")
+  O2_DEFINE_CONFIGURABLE(cfgPairBuffer, bool, false, "Sum the pairs of an event in a local buffer before filling the pair histogram (faster for large multiplicities)")
+  O2_DEFINE_CONFIGURABLE(cfgTrackSnapshot, bool, false, "Loop over a pT-sorted copy of the selected associated particles, reused for the mixed events of a dataframe")
 
   ConfigurableAxis axisVertex{"axisVertex", {7, -7, 7}, "vertex axis for histograms"};
   ConfigurableAxis axisDeltaPhi{"axisDeltaPhi", {72, -PIHalf, PIHalf * 3}, "delta phi axis for histograms"};
@@ -122,6 +128,29 @@ struct CorrelationTask {
 
   std::vector<float> efficiencyAssociatedCache;
 
+  // Selected associated particles of a collision, sorted by pT
+  struct TrackSnapshot {
+    std::vector<float> pt;
+    std::vector<float> eta;
+    std::vector<float> phi;
+    std::vector<int8_t> sign;
+    std::vector<int64_t> globalIndex;
+  };
+  // key: step, global index of the first particle and number of particles of the (grouped) table
+  std::map<std::tuple<int, int64_t, int64_t>, TrackSnapshot> trackSnapshots;
+  std::vector<float> snapshotWeights;
+  std::vector<uint8_t> snapshotRejected;
+
+  // Minimal track interface for PairCuts
+  struct SnapshotTrack {
+    float mPt, mEta, mPhi;
+    int8_t mSign;
+    float pt() const { return mPt; }
+    float eta() const { return mEta; }
+    float phi() const { return mPhi; }
+    int8_t sign() const { return mSign; }
+  };
+
   struct Config {
     bool mPairCuts = false;
     THn* mEfficiencyTrigger = nullptr;
@@ -284,12 +313,164 @@ struct CorrelationTask {
   template <class T>
   using hasProng1Id = decltype(std::declval<T&>().cfTrackProng1Id());
 
+  // Returns the snapshot of the associated particles passing the selections of step
+  // The snapshots are kept until the end of the process function, as the same collisions are mixed several times
+  template <CorrelationContainer::CFStep step, typename TTracks2>
+  const TrackSnapshot& getSnapshot(TTracks2& tracks2)
+  {
+    int64_t first = tracks2.size() > 0 ? tracks2.begin().globalIndex() : -1;
+    auto [it, inserted] = trackSnapshots.try_emplace(std::make_tuple(static_cast<int>(step), first, static_cast<int64_t>(tracks2.size())));
+    auto& snapshot = it->second;
+    if (!inserted) {
+      return snapshot;
+    }
+
+    std::vector<std::tuple<float, float, float, int8_t, int64_t>> selected;
+    selected.reserve(tracks2.size());
+    for (auto& track2 : tracks2) {
+      if constexpr (step <= CorrelationContainer::kCFStepTracked) {
+        if (!checkObject<step>(track2)) {
+          continue;
+        }
+      }
+      if (cfgAssociatedCharge != 0 && cfgAssociatedCharge * track2.sign() < 0) {
+        continue;
+      }
+      selected.emplace_back(track2.pt(), track2.eta(), track2.phi(), track2.sign(), track2.globalIndex());
+    }
+    std::sort(selected.begin(), selected.end(), [](const auto& a, const auto& b) { return std::get<0>(a) < std::get<0>(b); });
+
+    snapshot.pt.reserve(selected.size());
+    snapshot.eta.reserve(selected.size());
+    snapshot.phi.reserve(selected.size());
+    snapshot.sign.reserve(selected.size());
+    snapshot.globalIndex.reserve(selected.size());
+    for (auto& [pt, eta, phi, sign, globalIndex] : selected) {
+      snapshot.pt.push_back(pt);
+      snapshot.eta.push_back(eta);
+      snapshot.phi.push_back(phi);
+      snapshot.sign.push_back(sign);
+      snapshot.globalIndex.push_back(globalIndex);
+    }
+    return snapshot;
+  }
+
+  // Pair loop of fillCorrelations over the snapshot of the associated particles
+  // The pT ordering is a bound of the loop and the associated particle selections are applied when building the snapshot.
+  // The pair selections are collected in a mask first, so that the two-track cut runs in batch on the remaining pairs.
+  template <CorrelationContainer::CFStep step, typename TTarget, typename TTrack1, bool sameType>
+  void fillPairsSnapshot(TTarget target, TTrack1& track1, const TrackSnapshot& snapshot, float multiplicity, float posZ, int magField, float triggerWeight)
+  {
+    std::size_t nAssociated = snapshot.pt.size();
+    if (cfgPtOrder != 0) {
+      nAssociated = std::lower_bound(snapshot.pt.begin(), snapshot.pt.end(), track1.pt()) - snapshot.pt.begin();
+    }
+
+    // pairs rejected by the pair selections, the two-track cut is evaluated for all remaining pairs at once
+    snapshotRejected.assign(nAssociated, 0);
+    for (std::size_t i = 0; i < nAssociated; i++) {
+      if constexpr (sameType) {
+        if (track1.globalIndex() == snapshot.globalIndex[i]) {
+          snapshotRejected[i] = 1;
+          continue;
+        }
+      }
+      if constexpr (std::experimental::is_detected<hasProng0Id, TTrack1>::value) {
+        if (snapshot.globalIndex[i] == track1.cfTrackProng0Id()) { // do not correlate daughter tracks of the same event
+          snapshotRejected[i] = 1;
+          continue;
+        }
+      }
+      if constexpr (std::experimental::is_detected<hasProng1Id, TTrack1>::value) {
+        if (snapshot.globalIndex[i] == track1.cfTrackProng1Id()) { // do not correlate daughter tracks of the same event
+          snapshotRejected[i] = 1;
+          continue;
+        }
+      }
+
+      if constexpr (std::experimental::is_detected<hasSign, TTrack1>::value) {
+        if (cfgPairCharge != 0 && cfgPairCharge * track1.sign() * snapshot.sign[i] < 0) {
+          snapshotRejected[i] = 1;
+          continue;
+        }
+      }
+
+      if constexpr (sameType) {
+        if constexpr (step >= CorrelationContainer::kCFStepReconstructed) {
+          if (cfg.mPairCuts) {
+            SnapshotTrack trigger{track1.pt(), track1.eta(), track1.phi(), static_cast<int8_t>(track1.sign())};
+            SnapshotTrack associated{snapshot.pt[i], snapshot.eta[i], snapshot.phi[i], snapshot.sign[i]};
+            if (mPairCuts.conversionCuts(trigger, associated)) {
+              snapshotRejected[i] = 1;
+              continue;
+            }
+          }
+        }
+      }
+    }
+
+    if constexpr (sameType) {
+      if constexpr (step >= CorrelationContainer::kCFStepReconstructed) {
+        if (cfgTwoTrackCut > 0) {
+          mPairCuts.twoTrackCut(track1, static_cast<int>(nAssociated), snapshot.pt.data(), snapshot.eta.data(), snapshot.phi.data(), snapshot.sign.data(), magField, snapshotRejected.data());
+        }
+      }
+    }
+
+    for (std::size_t i = 0; i < nAssociated; i++) {
+      if (snapshotRejected[i]) {
+        continue;
+      }
+
+      float associatedWeight = triggerWeight;
+      if constexpr (step == CorrelationContainer::kCFStepCorrected) {
+        if (cfg.mEfficiencyAssociated) {
+          associatedWeight *= snapshotWeights[i];
+        }
+      }
+
+      float deltaPhi = track1.phi() - snapshot.phi[i];
+      if (deltaPhi > 1.5f * PI) {
+        deltaPhi -= TwoPI;
+      }
+      if (deltaPhi < -PIHalf) {
+        deltaPhi += TwoPI;
+      }
+
+      if (cfgPairBuffer) {
+        target->addPair(track1.eta() - snapshot.eta[i], snapshot.pt[i], deltaPhi, associatedWeight);
+        continue;
+      }
+
+      // last param is the weight
+      if (cfgMassAxis) {
+        if constexpr (std::experimental::is_detected<hasInvMass, TTrack1>::value)
+          target->getPairHist()->Fill(step, track1.eta() - snapshot.eta[i], snapshot.pt[i], track1.pt(), multiplicity, deltaPhi, posZ, track1.invMass(), associatedWeight);
+        else
+          LOGF(fatal, "Can not fill mass axis without invMass column. Disable cfgMassAxis.");
+      } else {
+        target->getPairHist()->Fill(step, track1.eta() - snapshot.eta[i], snapshot.pt[i], track1.pt(), multiplicity, deltaPhi, posZ, associatedWeight);
+      }
+    }
+  }
+
   template <CorrelationContainer::CFStep step, typename TTarget, typename TTracks1, typename TTracks2>
   void fillCorrelations(TTarget target, TTracks1& tracks1, TTracks2& tracks2, float multiplicity, float posZ, int magField, float eventWeight)
   {
+    const TrackSnapshot* snapshot = nullptr;
+    if (cfgTrackSnapshot) {
+      snapshot = &getSnapshot<step>(tracks2);
+    }
+
     // Cache efficiency for particles (too many FindBin lookups)
     if constexpr (step == CorrelationContainer::kCFStepCorrected) {
-      if (cfg.mEfficiencyAssociated) {
+      if (cfg.mEfficiencyAssociated && snapshot) {
+        // the efficiency depends on the multiplicity and vertex of the trigger collision, not cached in the snapshot
+        snapshotWeights.resize(snapshot->pt.size());
+        for (std::size_t i = 0; i < snapshotWeights.size(); i++) {
+          snapshotWeights[i] = getEfficiencyCorrection(cfg.mEfficiencyAssociated, snapshot->eta[i], snapshot->pt[i], multiplicity, posZ);
+        }
+      } else if (cfg.mEfficiencyAssociated) {
         efficiencyAssociatedCache.clear();
         efficiencyAssociatedCache.reserve(tracks2.size());
         for (auto& track : tracks2) {
@@ -298,6 +479,10 @@ struct CorrelationTask {
       }
     }
 
+    if (cfgPairBuffer) {
+      target->startPairs(step, multiplicity, posZ);
+    }
+
     for (auto& track1 : tracks1) {
       // LOGF(info, "Track %f | %f | %f  %d %d", track1.eta(), track1.phi(), track1.pt(), track1.isGlobalTrack(), track1.isGlobalTrackSDD());
 
@@ -334,6 +519,19 @@ struct CorrelationTask {
         target->getTriggerHist()->Fill(step, track1.pt(), multiplicity, posZ, triggerWeight);
       }
 
+      if (cfgPairBuffer) {
+        if constexpr (std::experimental::is_detected<hasInvMass, typename TTracks1::iterator>::value) {
+          target->setPairTrigger(track1.pt(), cfgMassAxis ? track1.invMass() : 0.f);
+        } else {
+          target->setPairTrigger(track1.pt());
+        }
+      }
+
+      if (snapshot) {
+        fillPairsSnapshot<step, TTarget, typename TTracks1::iterator, std::is_same<TTracks1, TTracks2>::value>(target, track1, *snapshot, multiplicity, posZ, magField, triggerWeight);
+        continue;
+      }
+
       for (auto& track2 : tracks2) {
         if constexpr (std::is_same<TTracks1, TTracks2>::value) {
           if (track1.globalIndex() == track2.globalIndex()) {
@@ -397,6 +595,11 @@ struct CorrelationTask {
           deltaPhi += TwoPI;
         }
 
+        if (cfgPairBuffer) {
+          target->addPair(track1.eta() - track2.eta(), track2.pt(), deltaPhi, associatedWeight);
+          continue;
+        }
+
         // last param is the weight
         if (cfgMassAxis) {
           if constexpr (std::experimental::is_detected<hasInvMass, typename TTracks1::iterator>::value)
@@ -408,6 +611,10 @@ struct CorrelationTask {
         }
       }
     }
+
+    if (cfgPairBuffer) {
+      target->flushPairs();
+    }
   }
 
   void loadEfficiency(uint64_t timestamp)
@@ -455,6 +662,8 @@ struct CorrelationTask {
   // Version with explicit nested loop
   void processSameAOD(aodCollisions::iterator const& collision, aod::BCsWithTimestamps const&, aodTracks const& tracks)
   {
+    trackSnapshots.clear();
+
     // NOTE legacy function for O2 integration tests. Full version needs derived data
 
     if (cfgVerbosity > 0) {
@@ -478,6 +687,8 @@ struct CorrelationTask {
 
   void processSameDerived(derivedCollisions::iterator const& collision, soa::Filtered<aod::CFTracks> const& tracks)
   {
+    trackSnapshots.clear();
+
     BinningTypeDerived configurableBinningDerived{{axisVertex, axisMultiplicity}, true}; // true is for 'ignore overflows' (true by default). Underflows and overflows will have bin -1.
     if (cfgVerbosity > 0) {
       LOGF(info, "processSameDerived: Tracks for collision: %d | Vertex: %.1f | Multiplicity/Centrality: %.1f", tracks.size(), collision.posZ(), collision.multiplicity());
@@ -506,6 +717,8 @@ struct CorrelationTask {
 
   void processSame2ProngDerived(derivedCollisions::iterator const& collision, soa::Filtered<aod::CFTracks> const& tracks, soa::Filtered<aod::CF2ProngTracks> const& p2tracks)
   {
+    trackSnapshots.clear();
+
     BinningTypeDerived configurableBinningDerived{{axisVertex, axisMultiplicity}, true}; // true is for 'ignore overflows' (true by default). Underflows and overflows will have bin -1.
     if (cfgVerbosity > 0) {
       LOGF(info, "processSame2ProngDerived: Tracks for collision: %d | 2-prong candidates: %d | Vertex: %.1f | Multiplicity/Centrality: %.1f", tracks.size(), p2tracks.size(), collision.posZ(), collision.multiplicity());
@@ -531,6 +744,8 @@ struct CorrelationTask {
   using BinningTypeAOD = ColumnBinningPolicy<aod::collision::PosZ, aod::cent::CentRun2V0M>;
   void processMixedAOD(aodCollisions& collisions, aodTracks const& tracks, aod::BCsWithTimestamps const&)
   {
+    trackSnapshots.clear();
+
     // NOTE legacy function for O2 integration tests. Full version needs derived data
 
     // Strictly upper categorised collisions, for cfgNoMixedEvents combinations per bin, skipping those in entry -1
@@ -574,6 +789,8 @@ struct CorrelationTask {
   using BinningTypeDerived = ColumnBinningPolicy<aod::collision::PosZ, aod::cfcollision::Multiplicity>;
   void processMixedDerived(derivedCollisions& collisions, derivedTracks const& tracks)
   {
+    trackSnapshots.clear();
+
     BinningTypeDerived configurableBinningDerived{{axisVertex, axisMultiplicity}, true}; // true is for 'ignore overflows' (true by default). Underflows and overflows will have bin -1.
     // Strictly upper categorised collisions, for cfgNoMixedEvents combinations per bin, skipping those in entry -1
     auto tracksTuple = std::make_tuple(tracks);
@@ -615,6 +832,8 @@ struct CorrelationTask {
 
   void processMixed2ProngDerived(derivedCollisions& collisions, derivedTracks const& tracks, soa::Filtered<aod::CF2ProngTracks> const& p2tracks)
   {
+    trackSnapshots.clear();
+
     BinningTypeDerived configurableBinningDerived{{axisVertex, axisMultiplicity}, true}; // true is for 'ignore overflows' (true by default). Underflows and overflows will have bin -1.
     // Strictly upper categorised collisions, for cfgNoMixedEvents combinations per bin, skipping those in entry -1
     auto tracksTuple = std::make_tuple(p2tracks, tracks);
@@ -777,6 +996,8 @@ struct CorrelationTask {
   // NOTE SmallGroups includes soa::Filtered always
   void processMCSameDerived(soa::Filtered<aod::CFMcCollisions>::iterator const& mcCollision, soa::Filtered<aod::CFMcParticles> const& mcParticles, soa::SmallGroups<aod::CFCollisionsWithLabel> const& collisions)
   {
+    trackSnapshots.clear();
+
     if (cfgVerbosity > 0) {
       LOGF(info, "processMCSameDerived. MC collision: %d, particles: %d, collisions: %d", mcCollision.globalIndex(), mcParticles.size(), collisions.size());
     }
@@ -818,6 +1039,8 @@ struct CorrelationTask {
   PresliceUnsorted<aod::CFCollisionsWithLabel> collisionPerMCCollision = aod::cfcollision::cfMcCollisionId;
   void processMCMixedDerived(soa::Filtered<aod::CFMcCollisions>& mcCollisions, soa::Filtered<aod::CFMcParticles> const& mcParticles, soa::Filtered<aod::CFCollisionsWithLabel> const& collisions)
   {
+    trackSnapshots.clear();
+
     bool useMCMultiplicity = (cfgCentBinsForMC == 0);
     auto getMultiplicity =
       [&collisions, &useMCMultiplicity, this](auto& col) {
@@ -114,6 +114,12 @@ struct DptDptCorrelationsTask {
     std::vector<std::vector<TProfile*>> fhSum2PtPtnw_vsC{nch, {nch, nullptr}};   //!<! un-weighted accumulated \f${p_T}_1 {p_T}_2\f$ distribution vs event centrality/multiplicity 1-1,1-2,2-1,2-2, combinations
     std::vector<std::vector<TProfile*>> fhSum2DptDptnw_vsC{nch, {nch, nullptr}}; //!<! un-weighted accumulated \f$\sum ({p_T}_1- <{p_T}_1>) ({p_T}_2 - <{p_T}_2>) \f$ distribution vs \f$\Delta\eta,\;\Delta\phi\f$ distribution vs event centrality/multiplicity 1-1,1-2,2-1,2-2, combinations
 
+    /* eta and phi bin indices of the tracks of the pairs being processed */
+    std::vector<int> etaix1;
+    std::vector<int> phiix1;
+    std::vector<int> etaix2;
+    std::vector<int> phiix2;
+
     bool ccdbstored = false;
 
     float isCCDBstored()
@@ -160,38 +166,52 @@ struct DptDptCorrelationsTask {
       return etaix * phibins + phiix;
     }
 
-    /// \brief Returns the TH2 global index for the differential histograms
-    /// \param t1 the intended track one
-    /// \param t2 the intended track two
-    /// \return the globl TH2 bin for delta eta delta phi
+    /// \brief Stores the zero based eta and phi bin indices of the tracks of a list
+    /// \param tracks the intended track list
+    /// \param etaix the eta bin indices, in the order of the list
+    /// \param phiix the phi bin indices, in the order of the list
     ///
+    /// The indices are obtained once per track so that the pair loop only combines them
     /// WARNING: for performance reasons no checks are done about the consistency
     /// of tracks' eta and phi within the corresponding ranges so, it is suppossed
     /// the tracks have been accepted and they are within that ranges
     /// IF THAT IS NOT THE CASE THE ROUTINE WILL PRODUCE NONSENSE RESULTS
-    template <typename TrackObject>
-    int GetDEtaDPhiGlobalIndex(TrackObject const& t1, TrackObject const& t2)
+    template <typename TrackListObject>
+    void storeEtaPhiIndices(TrackListObject const& tracks, std::vector<int>& etaix, std::vector<int>& phiix)
     {
       using namespace correlationstask;
       using namespace o2::analysis::dptdptfilter;
 
-      /* rule: ix are always zero based while bins are always one based */
-      int etaix_1 = static_cast<int>((t1.eta() - etalow) / etabinwidth);
-      /* consider a potential phi origin shift */
-      float phi = GetShiftedPhi(t1.phi());
-      int phiix_1 = static_cast<int>((phi - philow) / phibinwidth);
-      int etaix_2 = static_cast<int>((t2.eta() - etalow) / etabinwidth);
-      /* consider a potential phi origin shift */
-      phi = GetShiftedPhi(t2.phi());
-      int phiix_2 = static_cast<int>((phi - philow) / phibinwidth);
+      etaix.clear();
+      phiix.clear();
+      for (auto& t : tracks) {
+        etaix.push_back(static_cast<int>((t.eta() - etalow) / etabinwidth));
+        /* consider a potential phi origin shift */
+        float phi = GetShiftedPhi(t.phi());
+        phiix.push_back(static_cast<int>((phi - philow) / phibinwidth));
+      }
+    }
+
+    /// \brief Returns the TH2 global index for the differential histograms
+    /// \param etaix_1 the zero based eta bin index of track one
+    /// \param phiix_1 the zero based phi bin index of track one
+    /// \param etaix_2 the zero based eta bin index of track two
+    /// \param phiix_2 the zero based phi bin index of track two
+    /// \param nxbins the number of delta eta bins of the differential histograms including under and overflow
+    /// \return the globl TH2 bin for delta eta delta phi, as TH2::GetBin
+    int GetDEtaDPhiGlobalIndex(int etaix_1, int phiix_1, int etaix_2, int phiix_2, int nxbins)
+    {
+      using namespace correlationstask;
+      using namespace o2::analysis::dptdptfilter;
 
+      /* rule: ix are always zero based while bins are always one based */
       int deltaeta_ix = etaix_1 - etaix_2 + etabins - 1;
       int deltaphi_ix = phiix_1 - phiix_2;
       if (deltaphi_ix < 0) {
         deltaphi_ix += phibins;
       }
 
-      return fhN2_vsDEtaDPhi[0][0]->GetBin(deltaeta_ix + 1, deltaphi_ix + 1);
+      return (deltaeta_ix + 1) + nxbins * (deltaphi_ix + 1);
     }
 
     void storeTrackCorrections(std::vector<TH3*> corrs)
@@ -328,6 +348,9 @@ struct DptDptCorrelationsTask {
       std::vector<std::vector<double>> n2nw(nch, std::vector<double>(nch, 0.0));         ///< not weighted number of track1 track 2 pairs for current collision
       std::vector<std::vector<double>> sum2PtPtnw(nch, std::vector<double>(nch, 0.0));   ///< accumulated sum of not weighted track 1 track 2 \f${p_T}_1 {p_T}_2\f$ for current collision
       std::vector<std::vector<double>> sum2DptDptnw(nch, std::vector<double>(nch, 0.0)); ///< accumulated sum of not weighted number of track 1 tracks times not weighted track 2 \f$p_T\f$ for current collision
+      storeEtaPhiIndices(trks1, etaix1, phiix1);
+      storeEtaPhiIndices(trks2, etaix2, phiix2);
+      const int nxbins = fhN2_vsDEtaDPhi[0][0]->GetNbinsX() + 2;
       int index1 = 0;
 
       for (auto& track1 : trks1) {
@@ -356,7 +379,7 @@ struct DptDptCorrelationsTask {
           double dptdptw = (corr1 * track1.pt() - ptavg_1) * (corr2 * track2.pt() - ptavg_2);
 
           /* get the global bin for filling the differential histograms */
-          int globalbin = GetDEtaDPhiGlobalIndex(track1, track2);
+          int globalbin = GetDEtaDPhiGlobalIndex(etaix1[index1], phiix1[index1], etaix2[index2], phiix2[index2], nxbins);
           float deltaeta = track1.eta() - track2.eta();
           float deltaphi = track1.phi() - track2.phi();
           while (deltaphi >= deltaphiup) {
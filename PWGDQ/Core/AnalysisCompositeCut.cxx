@@ -68,3 +68,40 @@ bool AnalysisCompositeCut::IsSelected(float* values)
     return false;
   }
 }
+
+void AnalysisCompositeCut::IsSelectedBlock(float* const* values, int nCandidates, bool* selected)
+{
+  //
+  // apply cuts on a block of candidates
+  //
+  for (int i = 0; i < nCandidates; ++i) {
+    selected[i] = fOptionUseAND;
+  }
+  std::unique_ptr<bool[]> subSelected(new bool[nCandidates]);
+
+  auto combine = [&](AnalysisCut& cut) {
+    cut.IsSelectedBlock(values, nCandidates, subSelected.get());
+    bool allDecided = true;
+    for (int i = 0; i < nCandidates; ++i) {
+      if (fOptionUseAND) {
+        selected[i] = selected[i] && subSelected[i];
+      } else {
+        selected[i] = selected[i] || subSelected[i];
+      }
+      allDecided = allDecided && (selected[i] != fOptionUseAND);
+    }
+    return allDecided;
+  };
+
+  // stop as soon as the decision is final for all candidates (all rejected for AND, all accepted for OR)
+  for (auto& cut : fCutList) {
+    if (combine(cut)) {
+      return;
+    }
+  }
+  for (auto& cut : fCompositeCutList) {
+    if (combine(cut)) {
+      return;
+    }
+  }
+}
@@ -43,6 +43,7 @@ class AnalysisCompositeCut : public AnalysisCut
   int GetNCuts() const { return fCutList.size() + fCompositeCutList.size(); }
 
   bool IsSelected(float* values) override;
+  void IsSelectedBlock(float* const* values, int nCandidates, bool* selected) override;
 
  protected:
   bool fOptionUseAND;                                  // true (default): apply AND on all cuts; false: use OR
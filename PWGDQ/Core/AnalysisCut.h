@@ -18,6 +18,8 @@
 #define AnalysisCut_H
 
 #include <TF1.h>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 //_________________________________________________________________________
@@ -39,6 +41,13 @@ class AnalysisCut : public TNamed
               int dependentVar2 = -1, float depCut2Low = 0., float depCut2High = 0., bool depCut2Exclude = false);
 
   virtual bool IsSelected(float* values);
+  // Evaluate the cut for a block of nCandidates candidates stored as structure-of-arrays:
+  //   values[var][i] is the value of variable var for candidate i (only the variables used by the cut need to be provided)
+  // The decision for candidate i is written in selected[i]
+  virtual void IsSelectedBlock(float* const* values, int nCandidates, bool* selected);
+  // Evaluate a list of cuts on a block of candidates; bit icut of masks[i] is set if candidate i passes cuts[icut]
+  template <typename TCut>
+  static void FillSelectionMasks(std::vector<TCut>& cuts, float* const* values, int nCandidates, uint32_t* masks);
 
   static std::vector<int> fgUsedVars; //! vector of used variables
 
@@ -174,4 +183,66 @@ inline bool AnalysisCut::IsSelected(float* values)
   return true;
 }
 
+inline void AnalysisCut::IsSelectedBlock(float* const* values, int nCandidates, bool* selected)
+{
+  //
+  // apply the configured cuts on a block of candidates
+  //
+  for (int i = 0; i < nCandidates; ++i) {
+    selected[i] = true;
+  }
+  for (const auto& cut : fCuts) {
+    const float* vals = values[cut.fVar];
+    const float* depVals = (cut.fDepVar != -1 ? values[cut.fDepVar] : nullptr);
+    const float* dep2Vals = (cut.fDepVar2 != -1 ? values[cut.fDepVar2] : nullptr);
+
+    // NOTE: a cut is applied only if the dependent variables are in the requested range (or outside, for exclusion)
+    //       The loop without cut functions has no data dependent branches so it can be vectorized
+    if (!cut.fFuncLow && !cut.fFuncHigh) {
+      for (int i = 0; i < nCandidates; ++i) {
+        bool applies = (depVals == nullptr || ((depVals[i] > cut.fDepLow && depVals[i] <= cut.fDepHigh) != cut.fDepExclude));
+        applies = applies && (dep2Vals == nullptr || ((dep2Vals[i] > cut.fDep2Low && dep2Vals[i] <= cut.fDep2High) != cut.fDep2Exclude));
+        bool pass = ((vals[i] >= cut.fLow && vals[i] <= cut.fHigh) != cut.fExclude);
+        selected[i] = selected[i] && (pass || !applies);
+      }
+      continue;
+    }
+
+    for (int i = 0; i < nCandidates; ++i) {
+      if (!selected[i]) {
+        continue;
+      }
+      if (depVals && ((depVals[i] > cut.fDepLow && depVals[i] <= cut.fDepHigh) == cut.fDepExclude)) {
+        continue;
+      }
+      if (dep2Vals && ((dep2Vals[i] > cut.fDep2Low && dep2Vals[i] <= cut.fDep2High) == cut.fDep2Exclude)) {
+        continue;
+      }
+      float cutLow = (cut.fFuncLow ? cut.fFuncLow->Eval(depVals[i]) : cut.fLow);
+      float cutHigh = (cut.fFuncHigh ? cut.fFuncHigh->Eval(depVals[i]) : cut.fHigh);
+      selected[i] = ((vals[i] >= cutLow && vals[i] <= cutHigh) != cut.fExclude);
+    }
+  }
+}
+
+template <typename TCut>
+void AnalysisCut::FillSelectionMasks(std::vector<TCut>& cuts, float* const* values, int nCandidates, uint32_t* masks)
+{
+  //
+  // run each cut once on the whole block and collect the decisions in a bit map per candidate
+  //
+  std::unique_ptr<bool[]> selected(new bool[nCandidates]);
+  for (int i = 0; i < nCandidates; ++i) {
+    masks[i] = 0;
+  }
+  int icut = 0;
+  for (auto& cut : cuts) {
+    cut.IsSelectedBlock(values, nCandidates, selected.get());
+    for (int i = 0; i < nCandidates; ++i) {
+      masks[i] |= (static_cast<uint32_t>(selected[i]) << icut);
+    }
+    icut++;
+  }
+}
+
 #endif
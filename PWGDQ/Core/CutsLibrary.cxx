@@ -13,8 +13,16 @@
 //
 #include "PWGDQ/Core/CutsLibrary.h"
 #include <TF1.h>
+#include <memory>
+#include <unordered_map>
 #include "VarManager.h"
 
+namespace o2::aod::dqcuts
+{
+// builds a new analysis cut from its name, see GetAnalysisCut
+AnalysisCut* BuildAnalysisCut(const char* cutName);
+} // namespace o2::aod::dqcuts
+
 AnalysisCompositeCut* o2::aod::dqcuts::GetCompositeCut(const char* cutName)
 {
   //
@@ -2948,6 +2956,26 @@ AnalysisCompositeCut* o2::aod::dqcuts::GetCompositeCut(const char* cutName)
 }
 
 AnalysisCut* o2::aod::dqcuts::GetAnalysisCut(const char* cutName)
+{
+  //
+  // The same analysis cuts are requested by many composite cuts (e.g. the kinematic and quality cuts),
+  // so each name is looked up once in the list of BuildAnalysisCut and the cut is copied afterwards.
+  // The copies share the TF1 of the function cuts, which are kept by the cached cut.
+  //
+  static std::unordered_map<std::string, std::unique_ptr<AnalysisCut>> cachedCuts;
+  auto cached = cachedCuts.find(cutName);
+  if (cached == cachedCuts.end()) {
+    cached = cachedCuts.emplace(cutName, std::unique_ptr<AnalysisCut>(BuildAnalysisCut(cutName))).first;
+  } else if (!cached->second) {
+    LOGF(info, Form("Did not find cut %s", cutName));
+  }
+  if (!cached->second) {
+    return nullptr;
+  }
+  return new AnalysisCut(*cached->second);
+}
+
+AnalysisCut* o2::aod::dqcuts::BuildAnalysisCut(const char* cutName)
 {
   //
   // define here cuts which are likely to be used often
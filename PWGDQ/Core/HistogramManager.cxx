@@ -39,6 +39,8 @@ HistogramManager::HistogramManager() : TNamed("", ""),
                                        fNVars(0),
                                        fUsedVars(nullptr),
                                        fVariablesMap(),
+                                       fClassHandles(),
+                                       fFillPlans(),
                                        fUseDefaultVariableNames(false),
                                        fBinsAllocated(0),
                                        fVariableNames(nullptr),
@@ -55,6 +57,8 @@ HistogramManager::HistogramManager(const char* name, const char* title, const in
                                                                                               fNVars(maxNVars),
                                                                                               fUsedVars(),
                                                                                               fVariablesMap(),
+                                                                                              fClassHandles(),
+                                                                                              fFillPlans(),
                                                                                               fUseDefaultVariableNames(kFALSE),
                                                                                               fBinsAllocated(0),
                                                                                               fVariableNames(),
@@ -113,6 +117,8 @@ void HistogramManager::AddHistClass(const char* histClass)
   fMainList->Add(hList);
   std::list<std::vector<int>> varList;
   fVariablesMap[histClass] = varList;
+  fClassHandles[histClass] = fFillPlans.size();
+  fFillPlans.emplace_back();
 }
 
 //_________________________________________________________________
@@ -322,6 +328,7 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
       hList->Add(h);
       break;
   } // end switch
+  AddToFillPlan(histClass, h, varVector);
 }
 
 //_________________________________________________________________
@@ -527,6 +534,7 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
       hList->Add(h);
       break;
   } // end switch(dimension)
+  AddToFillPlan(histClass, h, varVector);
 }
 
 //_________________________________________________________________
@@ -620,6 +628,7 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   }
 
   fBinsAllocated += nbins;
+  AddToFillPlan(histClass, h, varVector);
 }
 
 //_________________________________________________________________
@@ -726,6 +735,53 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
     }
   }
   fBinsAllocated += bins;
+  AddToFillPlan(histClass, h, varVector);
+}
+
+//__________________________________________________________________
+void HistogramManager::AddToFillPlan(const char* histClass, TObject* h, const std::vector<int>& varVector)
+{
+  //
+  // decode the variable identifiers of a newly created histogram and append it to the fill plan of its class
+  //
+  auto handle = fClassHandles.find(histClass);
+  if (handle == fClassHandles.end()) {
+    return;
+  }
+  FillPlan& plan = fFillPlans[handle->second];
+
+  FillPlanEntry entry;
+  entry.fHist = h;
+  entry.fVarW = varVector[2];
+  entry.fFirstVar = plan.fVars.size();
+  bool isProfile = (varVector[0] == 1);
+  if (varVector[1] > 0) { // THn
+    entry.fDimension = varVector[1];
+    entry.fType = (h->InheritsFrom(THnSparse::Class()) ? kTHnSparse : kTHn);
+    for (int i = 0; i < entry.fDimension; ++i) {
+      plan.fVars.push_back(varVector[3 + i]);
+    }
+  } else {
+    entry.fDimension = (reinterpret_cast<TH1*>(h))->GetDimension();
+    entry.fType = (isProfile ? kTProfile : kTH1) + entry.fDimension - 1;
+    for (int i = 3; i < 7; ++i) { // varX, varY, varZ, varT
+      plan.fVars.push_back(varVector[i]);
+    }
+  }
+  plan.fEntries.push_back(entry);
+}
+
+//__________________________________________________________________
+int HistogramManager::GetHistClassHandle(const char* className) const
+{
+  //
+  // get the handle of the fill plan for a histogram class
+  //
+  auto handle = fClassHandles.find(className);
+  if (handle == fClassHandles.end()) {
+    return kNothing;
+  }
+  return handle->second;
 }
 
 //__________________________________________________________________
@@ -734,124 +790,100 @@ void HistogramManager::FillHistClass(const char* className, Float_t* values)
   //
   //  fill a class of histograms
   //
-
-  // get the needed histogram list
-  auto* hList = reinterpret_cast<TList*>(fMainList->FindObject(className));
-  if (!hList) {
+  auto handle = fClassHandles.find(className);
+  if (handle == fClassHandles.end()) {
     // TODO: add some meaningfull error message
     /*LOG(warn) << "HistogramManager::FillHistClass(): Histogram list " << className << " not found!";
     LOG(warn) << "         Histogram list not filled" << endl; */
     return;
   }
+  FillHistClass(handle->second, values);
+}
 
-  // get the corresponding std::list containng identifiers to the needed variables to be filled
-  list varList = fVariablesMap[className];
-
-  TIter next(hList);
+//__________________________________________________________________
+void HistogramManager::FillHistClass(int classHandle, Float_t* values)
+{
+  //
+  //  fill a class of histograms using its precompiled fill plan
+  //
+  if (classHandle < 0 || classHandle >= static_cast<int>(fFillPlans.size())) {
+    return;
+  }
+  const FillPlan& plan = fFillPlans[classHandle];
 
-  TObject* h = nullptr;
-  bool isProfile;
-  bool isTHn;
-  int dimension = 0;
-  bool isSparse = kFALSE;
   // TODO: At the moment, maximum 20 dimensions are foreseen for the THn histograms. We should make this more dynamic
   //       But maybe its better to have it like to avoid dynamically allocating this array in the histogram loop
   double fillValues[20] = {0.0};
-  int varX = -1, varY = -1, varZ = -1, varT = -1, varW = -1;
-
-  // loop over the histogram and std::list
-  // NOTE: these two should contain the same number of elements and be synchronized, otherwise its a mess
-  for (auto varIter = varList.begin(); varIter != varList.end(); varIter++) {
-    h = next(); // get the histogram
-    // decode information from the vector of indices
-    isProfile = (varIter->at(0) == 1 ? true : false);
-    isTHn = (varIter->at(1) > 0 ? true : false);
-    if (isTHn) {
-      dimension = varIter->at(1);
-    } else {
-      dimension = (reinterpret_cast<TH1*>(h))->GetDimension();
-    }
-
-    // get the various variable indices
-    varW = varIter->at(2);
-    if (isTHn) {
-      for (int i = 0; i < dimension; i++) {
-        fillValues[i] = values[varIter->at(3 + i)];
-      }
-    } else {
-      varX = varIter->at(3);
-      varY = varIter->at(4);
-      varZ = varIter->at(5);
-      varT = varIter->at(6);
-    }
 
-    if (!isTHn) {
-      switch (dimension) {
-        case 1:
-          if (isProfile) {
-            if (varW > kNothing) {
-              (reinterpret_cast<TProfile*>(h))->Fill(values[varX], values[varY], values[varW]);
-            } else {
-              (reinterpret_cast<TProfile*>(h))->Fill(values[varX], values[varY]);
-            }
-          } else {
-            if (varW > kNothing) {
-              (reinterpret_cast<TH1*>(h))->Fill(values[varX], values[varW]);
-            } else {
-              (reinterpret_cast<TH1*>(h))->Fill(values[varX]);
-            }
-          }
-          break;
-        case 2:
-          if (isProfile) {
-            if (varW > kNothing) {
-              (reinterpret_cast<TProfile2D*>(h))->Fill(values[varX], values[varY], values[varZ], values[varW]);
-            } else {
-              (reinterpret_cast<TProfile2D*>(h))->Fill(values[varX], values[varY], values[varZ]);
-            }
+  for (const auto& entry : plan.fEntries) {
+    TObject* h = entry.fHist;
+    const int* vars = plan.fVars.data() + entry.fFirstVar;
+    const int varW = entry.fVarW;
+    switch (entry.fType) {
+      case kTH1:
+        if (varW > kNothing) {
+          (reinterpret_cast<TH1*>(h))->Fill(values[vars[0]], values[varW]);
+        } else {
+          (reinterpret_cast<TH1*>(h))->Fill(values[vars[0]]);
+        }
+        break;
+      case kTH2:
+        if (varW > kNothing) {
+          (reinterpret_cast<TH2*>(h))->Fill(values[vars[0]], values[vars[1]], values[varW]);
+        } else {
+          (reinterpret_cast<TH2*>(h))->Fill(values[vars[0]], values[vars[1]]);
+        }
+        break;
+      case kTH3:
+        if (varW > kNothing) {
+          (reinterpret_cast<TH3*>(h))->Fill(values[vars[0]], values[vars[1]], values[vars[2]], values[varW]);
+        } else {
+          (reinterpret_cast<TH3*>(h))->Fill(values[vars[0]], values[vars[1]], values[vars[2]]);
+        }
+        break;
+      case kTProfile:
+        if (varW > kNothing) {
+          (reinterpret_cast<TProfile*>(h))->Fill(values[vars[0]], values[vars[1]], values[varW]);
+        } else {
+          (reinterpret_cast<TProfile*>(h))->Fill(values[vars[0]], values[vars[1]]);
+        }
+        break;
+      case kTProfile2D:
+        if (varW > kNothing) {
+          (reinterpret_cast<TProfile2D*>(h))->Fill(values[vars[0]], values[vars[1]], values[vars[2]], values[varW]);
+        } else {
+          (reinterpret_cast<TProfile2D*>(h))->Fill(values[vars[0]], values[vars[1]], values[vars[2]]);
+        }
+        break;
+      case kTProfile3D:
+        if (varW > kNothing) {
+          (reinterpret_cast<TProfile3D*>(h))->Fill(values[vars[0]], values[vars[1]], values[vars[2]], values[vars[3]], values[varW]);
+        } else {
+          (reinterpret_cast<TProfile3D*>(h))->Fill(values[vars[0]], values[vars[1]], values[vars[2]], values[vars[3]]);
+        }
+        break;
+      case kTHn:
+      case kTHnSparse:
+        for (int i = 0; i < entry.fDimension; i++) {
+          fillValues[i] = values[vars[i]];
+        }
+        if (entry.fType == kTHnSparse) {
+          if (varW > kNothing) {
+            (reinterpret_cast<THnSparse*>(h))->Fill(fillValues, values[varW]);
           } else {
-            if (varW > kNothing) {
-              (reinterpret_cast<TH2*>(h))->Fill(values[varX], values[varY], values[varW]);
-            } else {
-              (reinterpret_cast<TH2*>(h))->Fill(values[varX], values[varY]);
-            }
+            (reinterpret_cast<THnSparse*>(h))->Fill(fillValues);
           }
-          break;
-        case 3:
-          if (isProfile) {
-            if (varW > kNothing) {
-              (reinterpret_cast<TProfile3D*>(h))->Fill(values[varX], values[varY], values[varZ], values[varT], values[varW]);
-            } else {
-              (reinterpret_cast<TProfile3D*>(h))->Fill(values[varX], values[varY], values[varZ], values[varT]);
-            }
+        } else {
+          if (varW > kNothing) {
+            (reinterpret_cast<THn*>(h))->Fill(fillValues, values[varW]);
           } else {
-            if (varW > kNothing) {
-              (reinterpret_cast<TH3*>(h))->Fill(values[varX], values[varY], values[varZ], values[varW]);
-            } else {
-              (reinterpret_cast<TH3*>(h))->Fill(values[varX], values[varY], values[varZ]);
-            }
+            (reinterpret_cast<THn*>(h))->Fill(fillValues);
           }
-          break;
-
-        default:
-          break;
-      } // end switch
-      // end if(!isTHn)
-    } else {
-      if (varW > kNothing) {
-        if (isSparse) {
-          (reinterpret_cast<THnSparse*>(h))->Fill(fillValues, values[varW]);
-        } else {
-          (reinterpret_cast<THn*>(h))->Fill(fillValues, values[varW]);
         }
-      } else {
-        if (isSparse) {
-          (reinterpret_cast<THnSparse*>(h))->Fill(fillValues);
-        } else {
-          (reinterpret_cast<THn*>(h))->Fill(fillValues);
-        }
-      }
-    } // end else
+        break;
+      default:
+        break;
+    } // end switch
   }   // end loop over histograms
 }
 
@@ -85,6 +85,10 @@ class HistogramManager : public TNamed
                     TString* axLabels = nullptr, int varW = -1, bool useSparse = kFALSE, bool isdouble = false);
 
   void FillHistClass(const char* className, float* values);
+  // Get an integer handle to the fill plan of a histogram class (kNothing if the class does not exist)
+  // The fill plan is kept up to date by AddHistogram(); filling via the handle avoids the class name lookups
+  int GetHistClassHandle(const char* className) const;
+  void FillHistClass(int classHandle, float* values);
 
   void SetUseDefaultVariableNames(bool flag) { fUseDefaultVariableNames = flag; }
   void SetDefaultVarNames(TString* vars, TString* units);
@@ -108,6 +112,32 @@ class HistogramManager : public TNamed
   TString* fVariableNames;          //! variable names
   TString* fVariableUnits;          //! variable units
 
+  // flattened information needed to fill one histogram, decoded once when the histogram is defined
+  enum FillTypes {
+    kTH1 = 0,
+    kTH2,
+    kTH3,
+    kTProfile,
+    kTProfile2D,
+    kTProfile3D,
+    kTHn,
+    kTHnSparse
+  };
+  struct FillPlanEntry {
+    TObject* fHist; // histogram to be filled
+    int fType;      // histogram type, see FillTypes
+    int fDimension; // number of axis variables
+    int fVarW;      // variable used as weight (kNothing if none)
+    int fFirstVar;  // position of the first axis variable in the variable indices of the class
+  };
+  struct FillPlan {
+    std::vector<FillPlanEntry> fEntries; // one entry per histogram, in the order of the histogram list
+    std::vector<int> fVars;              // contiguous variable indices used by all the entries
+  };
+  std::map<std::string, int> fClassHandles; //! map from histogram class name to fill plan handle
+  std::vector<FillPlan> fFillPlans;         //! fill plans, indexed by the class handle
+
+  void AddToFillPlan(const char* histClass, TObject* h, const std::vector<int>& varVector);
   void MakeAxisLabels(TAxis* ax, const char* labels);
 
   HistogramManager& operator=(const HistogramManager& c);
@@ -94,6 +94,26 @@ class MCSignal : public TNamed
     return CheckMC(0, checkSources, args...);
   };
 
+  // check only the prong i, without the common ancestor requirement
+  template <typename T>
+  bool CheckProngWithoutAncestor(int i, bool checkSources, const T& track)
+  {
+    return CheckProng(i, checkSources, track, false);
+  };
+
+  bool HasCommonAncestor() const
+  {
+    if (fNProngs < 2) {
+      return false;
+    }
+    for (auto idx : fCommonAncestorIdxs) {
+      if (idx >= 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
   void PrintConfig();
 
  private:
@@ -103,7 +123,7 @@ class MCSignal : public TNamed
   int fTempAncestorLabel;
 
   template <typename T>
-  bool CheckProng(int i, bool checkSources, const T& track);
+  bool CheckProng(int i, bool checkSources, const T& track, bool checkCommonAncestor = true);
 
   bool CheckMC(int, bool)
   {
@@ -123,7 +143,7 @@ class MCSignal : public TNamed
 };
 
 template <typename T>
-bool MCSignal::CheckProng(int i, bool checkSources, const T& track)
+bool MCSignal::CheckProng(int i, bool checkSources, const T& track, bool checkCommonAncestor)
 {
   using P = typename T::parent_t;
   auto currentMCParticle = track;
@@ -135,7 +155,7 @@ bool MCSignal::CheckProng(int i, bool checkSources, const T& track)
       return false;
     }
     // check the common ancestor (if specified)
-    if (fNProngs > 1 && fCommonAncestorIdxs[i] == j) {
+    if (checkCommonAncestor && fNProngs > 1 && fCommonAncestorIdxs[i] == j) {
       if (i == 0) {
         fTempAncestorLabel = currentMCParticle.globalIndex();
       } else {
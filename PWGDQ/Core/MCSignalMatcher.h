@@ -0,0 +1,164 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//
+// Contact: iarsene@cern.ch, i.c.arsene@fys.uio.no
+//
+/* Matching of MC particles against a list of MC signals, using bit maps
+
+  Each MC particle is checked only once against every prong of every signal, the first time it is used,
+  and the result is kept as a bit map per prong (bit i set if the particle matches that prong of the i-th signal).
+  The decision for a tuple of particles is then the AND of the prong bit maps of its particles.
+  Only the signals requiring a common ancestor, for which the prong bit maps are a necessary condition, are
+  checked again with MCSignal::CheckSignal for the tuples surviving the AND.
+
+Example usage:
+
+  MCSignalMatcher matcher(signals);
+  ...
+  matcher.Reset(mcTracks.size());
+  for (auto& [t1, t2] : combinations(tracks, tracks)) {
+    uint64_t decision = matcher.GetSignalMask(t1.reducedMCTrack(), t2.reducedMCTrack());
+  }
+*/
+#ifndef PWGDQ_CORE_MCSIGNALMATCHER_H_
+#define PWGDQ_CORE_MCSIGNALMATCHER_H_
+
+#include "MCSignal.h"
+#include "Framework/Logger.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+class MCSignalMatcher
+{
+ public:
+  static constexpr int kNMaxSignals = 64;
+  static constexpr int kNMaxProngs = 3;
+
+  MCSignalMatcher() = default;
+  explicit MCSignalMatcher(const std::vector<MCSignal>& signals, bool checkSources = false)
+  {
+    SetSignals(signals, checkSources);
+  }
+
+  void SetSignals(const std::vector<MCSignal>& signals, bool checkSources = false)
+  {
+    fSignals.clear();
+    fProngSignals.fill(0);
+    fNProngsSignals.fill(0);
+    fAncestorSignals = 0;
+    fCheckSources = checkSources;
+    for (const auto& sig : signals) {
+      if (fSignals.size() == kNMaxSignals) {
+        LOG(warn) << "MCSignalMatcher: at most " << kNMaxSignals << " signals are supported, signal " << sig.GetName() << " and the following ones are ignored";
+        break;
+      }
+      if (sig.GetNProngs() < 1 || sig.GetNProngs() > kNMaxProngs) {
+        LOG(warn) << "MCSignalMatcher: signal " << sig.GetName() << " with " << sig.GetNProngs() << " prongs is not supported, it will never be matched";
+        fSignals.push_back(sig);
+        continue;
+      }
+      uint64_t bit = uint64_t(1) << fSignals.size();
+      for (int iProng = 0; iProng < sig.GetNProngs(); iProng++) {
+        fProngSignals[iProng] |= bit;
+      }
+      fNProngsSignals[sig.GetNProngs()] |= bit;
+      if (sig.HasCommonAncestor()) {
+        fAncestorSignals |= bit;
+      }
+      fSignals.push_back(sig);
+    }
+    fEpochs.clear();
+    fProngMasks.clear();
+  }
+
+  // Invalidate the cached decisions, to be called whenever the table of MC particles changes
+  // nParticles: number of MC particles of the table; particles with a larger global index are not cached
+  void Reset(std::size_t nParticles)
+  {
+    fEpoch++;
+    if (fEpochs.size() < nParticles) {
+      fEpochs.resize(nParticles, 0);
+      fProngMasks.resize(nParticles * kNMaxProngs, 0);
+    }
+  }
+
+  const std::vector<MCSignal>& GetSignals() const { return fSignals; }
+  int GetNSignals() const { return fSignals.size(); }
+  // bit map of the signals with nProngs prongs
+  uint64_t GetSignalsWithNProngs(int nProngs) const { return (nProngs > 0 && nProngs <= kNMaxProngs) ? fNProngsSignals[nProngs] : 0; }
+
+  // bit map of the signals for which the MC particle matches the prong iProng, without the common ancestor requirement
+  template <typename T>
+  uint64_t GetProngMask(int iProng, const T& particle)
+  {
+    auto idx = particle.globalIndex();
+    if (idx < 0 || static_cast<std::size_t>(idx) >= fEpochs.size()) {
+      return ComputeProngMask(iProng, particle);
+    }
+    if (fEpochs[idx] != fEpoch) {
+      for (int jProng = 0; jProng < kNMaxProngs; jProng++) {
+        fProngMasks[idx * kNMaxProngs + jProng] = ComputeProngMask(jProng, particle);
+      }
+      fEpochs[idx] = fEpoch;
+    }
+    return fProngMasks[idx * kNMaxProngs + iProng];
+  }
+
+  // bit map of the signals with sizeof...(T) prongs matched by the tuple of MC particles
+  template <typename... T>
+  uint64_t GetSignalMask(const T&... particles)
+  {
+    static_assert(sizeof...(T) > 0 && sizeof...(T) <= kNMaxProngs, "unsupported number of prongs");
+    uint64_t mask = fNProngsSignals[sizeof...(T)];
+    if (!mask) {
+      return 0;
+    }
+    int iProng = 0;
+    ((mask &= GetProngMask(iProng++, particles)), ...);
+    // check the common ancestor of the surviving signals which require it
+    uint64_t toCheck = mask & fAncestorSignals;
+    for (int isig = 0; toCheck; isig++, toCheck >>= 1) {
+      if ((toCheck & 1) && !fSignals[isig].CheckSignal(fCheckSources, particles...)) {
+        mask &= ~(uint64_t(1) << isig);
+      }
+    }
+    return mask;
+  }
+
+ private:
+  std::vector<MCSignal> fSignals;
+  std::array<uint64_t, kNMaxProngs> fProngSignals{};       // bit map of the signals having a prong with this index
+  std::array<uint64_t, kNMaxProngs + 1> fNProngsSignals{}; // bit map of the signals with this number of prongs
+  uint64_t fAncestorSignals{0};                            // bit map of the signals requiring a common ancestor
+  bool fCheckSources{false};
+
+  uint32_t fEpoch{0};
+  std::vector<uint32_t> fEpochs;     // epoch at which the prong bit maps of each particle were computed
+  std::vector<uint64_t> fProngMasks; // kNMaxProngs bit maps per particle
+
+  template <typename T>
+  uint64_t ComputeProngMask(int iProng, const T& particle)
+  {
+    uint64_t mask = 0;
+    uint64_t candidates = fProngSignals[iProng];
+    for (int isig = 0; candidates; isig++, candidates >>= 1) {
+      if ((candidates & 1) && fSignals[isig].CheckProngWithoutAncestor(iProng, fCheckSources, particle)) {
+        mask |= (uint64_t(1) << isig);
+      }
+    }
+    return mask;
+  }
+};
+
+#endif // PWGDQ_CORE_MCSIGNALMATCHER_H_
@@ -26,7 +26,9 @@ ClassImp(MixingHandler);
 MixingHandler::MixingHandler() : TNamed(),
                                  fIsInitialized(kFALSE),
                                  fVariableLimits(),
-                                 fVariables()
+                                 fVariables(),
+                                 fPoolDepth(100),
+                                 fPools()
 {
   //
   // default constructor
@@ -37,7 +39,9 @@ MixingHandler::MixingHandler() : TNamed(),
 MixingHandler::MixingHandler(const char* name, const char* title) : TNamed(name, title),
                                                                     fIsInitialized(kFALSE),
                                                                     fVariableLimits(),
-                                                                    fVariables()
+                                                                    fVariables(),
+                                                                    fPoolDepth(100),
+                                                                    fPools()
 {
   //
   // Named constructor
@@ -115,10 +119,65 @@ void MixingHandler::Init()
   for (auto v : fVariableLimits) {
     size *= (v.GetSize() - 1);
   }
-  (void)size;
+  if (fVariables.size() > 0) {
+    fPools.resize(size);
+    ResetPools();
+  }
   fIsInitialized = kTRUE;
 }
 
+//_________________________________________________________________________
+void MixingHandler::ResetPools()
+{
+  //
+  // Empty the event pools, keeping the allocated memory
+  //
+  for (auto& pool : fPools) {
+    pool.fEvents.resize(fPoolDepth);
+    for (auto& event : pool.fEvents) {
+      event.clear();
+    }
+    pool.fNEvents = 0;
+    pool.fNext = 0;
+  }
+}
+
+//_________________________________________________________________________
+int MixingHandler::GetNPoolEvents(int category) const
+{
+  if (category < 0 || category >= static_cast<int>(fPools.size())) {
+    return 0;
+  }
+  return fPools[category].fNEvents;
+}
+
+//_________________________________________________________________________
+const std::vector<MixingHandler::PoolTrack>& MixingHandler::GetPoolEvent(int category, int i) const
+{
+  return fPools[category].fEvents[i];
+}
+
+//_________________________________________________________________________
+void MixingHandler::AddEventToPool(int category, const std::vector<PoolTrack>& tracks)
+{
+  //
+  // Store the tracks of an event in the pool of the given category
+  //
+  if (!fIsInitialized) {
+    Init();
+  }
+  if (category < 0 || category >= static_cast<int>(fPools.size()) || fPoolDepth < 1) {
+    return;
+  }
+  EventPool& pool = fPools[category];
+  // NOTE: assign() reuses the capacity of the overwritten event, so no allocation happens once the pools are warmed up
+  pool.fEvents[pool.fNext].assign(tracks.begin(), tracks.end());
+  pool.fNext = (pool.fNext + 1) % fPoolDepth;
+  if (pool.fNEvents < fPoolDepth) {
+    pool.fNEvents++;
+  }
+}
+
 //_________________________________________________________________________
 int MixingHandler::FindEventCategory(float* values)
 {
@@ -132,31 +191,15 @@ int MixingHandler::FindEventCategory(float* values)
     Init();
   }
 
-  std::vector<int> bin;
+  // the category is the bin of the first variable, times the number of bins of the following ones, plus the category of the following ones
+  int category = 0;
   int iVar = 0;
   for (auto v = fVariableLimits.begin(); v != fVariableLimits.end(); v++, iVar++) {
-    int binValue = TMath::BinarySearch((*v).GetSize(), (*v).GetArray(), values[fVariables[iVar]]);
-    bin.push_back(binValue);
-    if (bin[iVar] == -1 || bin[iVar] == (*v).GetSize() - 1) {
+    int bin = TMath::BinarySearch((*v).GetSize(), (*v).GetArray(), values[fVariables[iVar]]);
+    if (bin == -1 || bin == (*v).GetSize() - 1) {
       return -1; // all variables must be inside limits
     }
-  }
-
-  int category = 0;
-  int tempCategory = 1;
-  int iv1 = 0;
-  int iv2 = 0;
-  for (auto v1 = fVariables.begin(); v1 != fVariables.end(); v1++, iv1++) {
-    tempCategory = 1;
-    iv2 = iv1;
-    for (auto v2 = v1; v2 != fVariables.end(); v2++, iv2++) {
-      if (iv2 == iv1) {
-        tempCategory *= bin[iv2];
-      } else {
-        tempCategory *= (fVariableLimits[iv2].GetSize() - 1);
-      }
-    }
-    category += tempCategory;
+    category = category * ((*v).GetSize() - 1) + bin;
   }
   return category;
 }
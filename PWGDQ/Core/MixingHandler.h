@@ -24,6 +24,10 @@
 #include <TList.h>
 #include <TString.h>
 
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
 #include "PWGDQ/Core/HistogramManager.h"
 #include "PWGDQ/Core/VarManager.h"
 
@@ -48,6 +52,32 @@ class MixingHandler : public TNamed
   int FindEventCategory(float* values);
   int GetBinFromCategory(VarManager::Variables var, int category) const;
 
+  // Event pools: one ring buffer with a fixed number of events for each event category (see FindEventCategory())
+  // Each pool event keeps compact records of its selected tracks, stored contiguously, so that the mixed-event pairing
+  // is a plain loop over packed arrays and the pool memory stays bounded once the pools are full
+  struct PoolTrack {
+    float fPt;           // transverse momentum
+    float fEta;          // pseudorapidity
+    float fPhi;          // azimuthal angle
+    int fSign;           // charge
+    uint32_t fFilterMap; // bit map of the track cuts passed by the track
+  };
+  void SetPoolDepth(int depth)
+  {
+    fPoolDepth = depth;
+    ResetPools();
+  }
+  int GetPoolDepth() const { return fPoolDepth; }
+  int GetNPoolEvents(int category) const;
+  // Get the tracks of the i-th event stored in the pool of a given category (i < GetNPoolEvents(category))
+  const std::vector<PoolTrack>& GetPoolEvent(int category, int i) const;
+  // Append the tracks of an event to the pool of the given category, overwriting the oldest event if the pool is full
+  void AddEventToPool(int category, const std::vector<PoolTrack>& tracks);
+  // Call func(track, poolTrack) for all the combinations, with at least one common filter bit, between the given tracks and the pool tracks
+  template <typename F>
+  void MixWithPool(int category, const std::vector<PoolTrack>& tracks, F&& func) const;
+  void ResetPools();
+
  private:
   MixingHandler(const MixingHandler& handler);
   MixingHandler& operator=(const MixingHandler& handler);
@@ -58,7 +88,88 @@ class MixingHandler : public TNamed
   std::vector<TArrayF> fVariableLimits;
   std::vector<int> fVariables;
 
-  ClassDef(MixingHandler, 1);
+  struct EventPool {
+    std::vector<std::vector<PoolTrack>> fEvents; // ring buffer of events, the track vectors are reused when overwritten
+    int fNEvents;                                // number of filled events, up to the pool depth
+    int fNext;                                   // position of the next event to be written
+  };
+  int fPoolDepth;                // number of events kept in each pool
+  std::vector<EventPool> fPools; //! event pools, one per event category
+
+  ClassDef(MixingHandler, 2);
+};
+
+template <typename F>
+void MixingHandler::MixWithPool(int category, const std::vector<PoolTrack>& tracks, F&& func) const
+{
+  //
+  // combine the tracks with all the tracks in the events stored in the pool
+  //
+  if (category < 0 || category >= static_cast<int>(fPools.size())) {
+    return;
+  }
+  const EventPool& pool = fPools[category];
+  for (int iev = 0; iev < pool.fNEvents; ++iev) {
+    const std::vector<PoolTrack>& poolTracks = pool.fEvents[iev];
+    for (const auto& track : tracks) {
+      for (const auto& poolTrack : poolTracks) {
+        if (track.fFilterMap & poolTrack.fFilterMap) {
+          func(track, poolTrack);
+        }
+      }
+    }
+  }
+}
+
+// Index of the events of a dataframe in rings of the last N events of each mixing category (e.g. the MixingHash column),
+// updated as the events arrive. Each new event is combined with the events of its category already in the index and
+// then added to it, which gives the same pairs as the self-combinations of the framework with the same depth, without
+// grouping the events of the whole table first
+class MixingEventIndex
+{
+ public:
+  void Reset(int depth)
+  {
+    fDepth = depth;
+    for (auto& ring : fRings) {
+      ring.second.fNEvents = 0;
+      ring.second.fNext = 0;
+    }
+  }
+
+  // Call func(previousEvent) for the events of the category in the index, from the oldest to the most recent, then add the event.
+  // Events with a negative category are not mixed
+  template <typename F>
+  void MixAndAdd(int category, int64_t event, F&& func)
+  {
+    if (category < 0 || fDepth < 1) {
+      return;
+    }
+    Ring& ring = fRings[category];
+    if (static_cast<int>(ring.fEvents.size()) != fDepth) {
+      ring.fEvents.assign(fDepth, -1);
+      ring.fNEvents = 0;
+      ring.fNext = 0;
+    }
+    const int first = ring.fNEvents < fDepth ? 0 : ring.fNext;
+    for (int i = 0; i < ring.fNEvents; ++i) {
+      func(ring.fEvents[(first + i) % fDepth]);
+    }
+    ring.fEvents[ring.fNext] = event;
+    ring.fNext = (ring.fNext + 1) % fDepth;
+    if (ring.fNEvents < fDepth) {
+      ring.fNEvents++;
+    }
+  }
+
+ private:
+  struct Ring {
+    std::vector<int64_t> fEvents; // positions of the events in the table
+    int fNEvents = 0;
+    int fNext = 0;
+  };
+  int fDepth = 0;
+  std::unordered_map<int, Ring> fRings; // rings are kept between dataframes to reuse their memory
 };
 
 #endif
@@ -22,6 +22,8 @@ TString VarManager::fgVariableNames[VarManager::kNVars] = {""};
 TString VarManager::fgVariableUnits[VarManager::kNVars] = {""};
 bool VarManager::fgUsedVars[VarManager::kNVars] = {false};
 bool VarManager::fgUsedKF = false;
+bool VarManager::fgUsePropagatedMuonCache = false;
+std::map<std::tuple<int64_t, int64_t, int>, o2::dataformats::GlobalFwdTrack> VarManager::fgPropagatedMuons;
 float VarManager::fgMagField = 0.5;
 float VarManager::fgValues[VarManager::kNVars] = {0.0f};
 std::map<int, int> VarManager::fgRunMap;
@@ -54,6 +56,34 @@ VarManager::VarManager() : TObject()
 //__________________________________________________________________
 VarManager::~VarManager() = default;
 
+//__________________________________________________________________
+VarManager::FillContext::FillContext() : fValues{0.0f},
+                                         fFitterTwoProngBarrel(fgFitterTwoProngBarrel),
+                                         fFitterTwoProngFwd(fgFitterTwoProngFwd),
+                                         fFitterThreeProngBarrel(fgFitterThreeProngBarrel),
+                                         fFitterThreeProngFwd(fgFitterThreeProngFwd)
+{
+  //
+  // constructor, takes the vertexing configuration from the static fitters
+  //
+}
+
+//__________________________________________________________________
+void VarManager::FillContext::update()
+{
+  //
+  // take again the vertexing configuration from the static fitters, only if their field changed
+  //
+  if (fFitterTwoProngBarrel.getBz() == fgFitterTwoProngBarrel.getBz() && fFitterTwoProngFwd.getBz() == fgFitterTwoProngFwd.getBz() &&
+      fFitterThreeProngBarrel.getBz() == fgFitterThreeProngBarrel.getBz() && fFitterThreeProngFwd.getBz() == fgFitterThreeProngFwd.getBz()) {
+    return;
+  }
+  fFitterTwoProngBarrel = fgFitterTwoProngBarrel;
+  fFitterTwoProngFwd = fgFitterTwoProngFwd;
+  fFitterThreeProngBarrel = fgFitterThreeProngBarrel;
+  fFitterThreeProngFwd = fgFitterThreeProngFwd;
+}
+
 //__________________________________________________________________
 void VarManager::SetVariableDependencies()
 {
@@ -29,6 +29,7 @@
 #include <iostream>
 #include <utility>
 #include <complex>
+#include <tuple>
 
 #include <TObject.h>
 #include <TString.h>
@@ -698,6 +699,7 @@ class VarManager : public TObject
     for (auto& var : usedVars) {
       fgUsedVars[var] = true;
     }
+    SetVariableDependencies();
   }
   static bool GetUsedVar(int var)
   {
@@ -824,6 +826,18 @@ class VarManager : public TObject
 
   template <typename T, typename C>
   static o2::dataformats::GlobalFwdTrack PropagateMuon(const T& muon, const C& collision, int endPoint = kToVertex);
+  // Cache of the PropagateMuon results per (muon, collision, end point), for the tasks which propagate the same muon
+  // in several pairs. The keys are the global indices of the muon and of the collision, so the cache must be reset
+  // for each data frame
+  static void SetUsePropagatedMuonCache(bool use)
+  {
+    fgUsePropagatedMuonCache = use;
+    fgPropagatedMuons.clear();
+  }
+  static void ResetPropagatedMuonCache()
+  {
+    fgPropagatedMuons.clear();
+  }
   template <uint32_t fillMap, typename T, typename C>
   static void FillMuonPDca(const T& muon, const C& collision, float* values = nullptr);
   template <uint32_t fillMap, typename T, typename C>
@@ -857,11 +871,15 @@ class VarManager : public TObject
   template <typename T1, typename T2, typename T3>
   static void FillTripleMC(T1 const& t1, T2 const& t2, T3 const& t3, float* values = nullptr, PairCandidateType pairType = kTripleCandidateToEEPhoton);
   template <int pairType, uint32_t collFillMap, uint32_t fillMap, typename C, typename T>
-  static void FillPairVertexing(C const& collision, T const& t1, T const& t2, bool propToSV = false, float* values = nullptr);
+  static void FillPairVertexing(C const& collision, T const& t1, T const& t2, bool propToSV = false, float* values = nullptr,
+                                o2::vertexing::DCAFitterN<2>* fitterBarrel = nullptr, o2::vertexing::FwdDCAFitterN<2>* fitterFwd = nullptr);
   template <uint32_t collFillMap, uint32_t fillMap, typename C, typename T>
-  static void FillTripletVertexing(C const& collision, T const& t1, T const& t2, T const& t3, PairCandidateType tripletType, float* values = nullptr);
+  static void FillTripletVertexing(C const& collision, T const& t1, T const& t2, T const& t3, PairCandidateType tripletType, float* values = nullptr,
+                                   o2::vertexing::DCAFitterN<3>* fitterThreeProngBarrel = nullptr);
   template <int candidateType, uint32_t collFillMap, uint32_t fillMap, typename C, typename T1>
-  static void FillDileptonTrackVertexing(C const& collision, T1 const& lepton1, T1 const& lepton2, T1 const& track, float* values);
+  static void FillDileptonTrackVertexing(C const& collision, T1 const& lepton1, T1 const& lepton2, T1 const& track, float* values,
+                                         o2::vertexing::DCAFitterN<2>* fitterTwoProngBarrel = nullptr, o2::vertexing::FwdDCAFitterN<2>* fitterTwoProngFwd = nullptr,
+                                         o2::vertexing::DCAFitterN<3>* fitterThreeProngBarrel = nullptr, o2::vertexing::FwdDCAFitterN<3>* fitterThreeProngFwd = nullptr);
   template <typename T1, typename T2>
   static void FillDileptonHadron(T1 const& dilepton, T2 const& hadron, float* values = nullptr, float hadronMass = 0.0f);
   template <typename T1, typename T2>
@@ -928,9 +946,53 @@ class VarManager : public TObject
   static float fgValues[kNVars]; // array holding all variables computed during analysis
   static void ResetValues(int startValue = 0, int endValue = kNVars, float* values = nullptr);
 
+  // Working state needed to compute variables without using the static value array and vertexing fitters,
+  // so that e.g. pairs of different collisions can be processed concurrently, with one context per thread.
+  // The fitters are copied from the static ones, so contexts should be created after the Setup*() calls,
+  // and update() takes the configuration again when the field of the static fitters changed (e.g. new run).
+  // The KFParticle field is global to KFParticle and shared by all the contexts
+  struct FillContext {
+    FillContext();
+    void update();
+    float fValues[kNVars];                                // array holding the variables computed with this context
+    o2::vertexing::DCAFitterN<2> fFitterTwoProngBarrel;   // two-prong fitter for barrel tracks
+    o2::vertexing::FwdDCAFitterN<2> fFitterTwoProngFwd;   // two-prong fitter for forward tracks
+    o2::vertexing::DCAFitterN<3> fFitterThreeProngBarrel; // three-prong fitter for barrel tracks
+    o2::vertexing::FwdDCAFitterN<3> fFitterThreeProngFwd; // three-prong fitter for forward tracks
+  };
+  template <uint32_t fillMap, typename T>
+  static void FillTrack(FillContext& context, T const& track)
+  {
+    FillTrack<fillMap>(track, context.fValues);
+  }
+  template <int pairType, uint32_t fillMap, typename T1, typename T2>
+  static void FillPair(FillContext& context, T1 const& t1, T2 const& t2)
+  {
+    FillPair<pairType, fillMap>(t1, t2, context.fValues);
+  }
+  template <int pairType, uint32_t collFillMap, uint32_t fillMap, typename C, typename T>
+  static void FillPairVertexing(FillContext& context, C const& collision, T const& t1, T const& t2, bool propToSV = false)
+  {
+    FillPairVertexing<pairType, collFillMap, fillMap>(collision, t1, t2, propToSV, context.fValues, &context.fFitterTwoProngBarrel, &context.fFitterTwoProngFwd);
+  }
+  template <uint32_t collFillMap, uint32_t fillMap, typename C, typename T>
+  static void FillTripletVertexing(FillContext& context, C const& collision, T const& t1, T const& t2, T const& t3, PairCandidateType tripletType)
+  {
+    FillTripletVertexing<collFillMap, fillMap>(collision, t1, t2, t3, tripletType, context.fValues, &context.fFitterThreeProngBarrel);
+  }
+  template <int candidateType, uint32_t collFillMap, uint32_t fillMap, typename C, typename T1>
+  static void FillDileptonTrackVertexing(FillContext& context, C const& collision, T1 const& lepton1, T1 const& lepton2, T1 const& track)
+  {
+    FillDileptonTrackVertexing<candidateType, collFillMap, fillMap>(collision, lepton1, lepton2, track, context.fValues,
+                                                                     &context.fFitterTwoProngBarrel, &context.fFitterTwoProngFwd,
+                                                                     &context.fFitterThreeProngBarrel, &context.fFitterThreeProngFwd);
+  }
+
  private:
   static bool fgUsedVars[kNVars]; // holds flags for when the corresponding variable is needed (e.g., in the histogram manager, in cuts, mixing handler, etc.)
   static bool fgUsedKF;
+  static bool fgUsePropagatedMuonCache;                                                                  // whether PropagateMuon reads from and fills the cache
+  static std::map<std::tuple<int64_t, int64_t, int>, o2::dataformats::GlobalFwdTrack> fgPropagatedMuons; // propagated muons per (muon, collision, end point)
   static void SetVariableDependencies(); // toggle those variables on which other used variables might depend
 
   static float fgMagField;
@@ -1062,6 +1124,19 @@ KFPVertex VarManager::createKFPVertexFromCollision(const T& collision)
 template <typename T, typename C>
 o2::dataformats::GlobalFwdTrack VarManager::PropagateMuon(const T& muon, const C& collision, const int endPoint)
 {
+  if (fgUsePropagatedMuonCache) {
+    auto key = std::make_tuple(static_cast<int64_t>(muon.globalIndex()), static_cast<int64_t>(collision.globalIndex()), endPoint);
+    auto cached = fgPropagatedMuons.find(key);
+    if (cached != fgPropagatedMuons.end()) {
+      return cached->second;
+    }
+    fgUsePropagatedMuonCache = false;
+    auto propmuon = PropagateMuon(muon, collision, endPoint);
+    fgUsePropagatedMuonCache = true;
+    fgPropagatedMuons.emplace(key, propmuon);
+    return propmuon;
+  }
+
   double chi2 = muon.chi2();
   SMatrix5 tpars(muon.x(), muon.y(), muon.phi(), muon.tgl(), muon.signed1Pt());
   std::vector<double> v1{muon.cXX(), muon.cXY(), muon.cYY(), muon.cPhiX(), muon.cPhiY(),
@@ -1575,7 +1650,7 @@ void VarManager::FillTwoMixEvents(T1 const& ev1, T1 const& ev2, T2 const& /*trac
     values[kQ2Y0A2] = ev2.q2y0a();
   }
 
-  if (isnan(VarManager::fgValues[VarManager::kTwoR2SP1]) == true || isnan(VarManager::fgValues[VarManager::kTwoR2EP1]) == true) {
+  if (isnan(values[kTwoR2SP1]) == true || isnan(values[kTwoR2EP1]) == true) {
     values[kTwoR2SP1] = -999.;
     values[kTwoR2SP2] = -999.;
     values[kTwoR2EP1] = -999.;
@@ -2242,42 +2317,45 @@ void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
     }
   }
 
-  // TO DO: get the correct values from CCDB
-  double BeamMomentum = TMath::Sqrt(fgCenterOfMassEnergy * fgCenterOfMassEnergy / 4 - fgMassofCollidingParticle * fgMassofCollidingParticle); // GeV
-  ROOT::Math::PxPyPzEVector Beam1(0., 0., -BeamMomentum, fgCenterOfMassEnergy / 2);
-  ROOT::Math::PxPyPzEVector Beam2(0., 0., BeamMomentum, fgCenterOfMassEnergy / 2);
+  // The boosts and polarization frames are needed only for the polarization angles, skip them if none is used
+  if (fgUsedVars[kCosThetaHE] || fgUsedVars[kPhiHE] || fgUsedVars[kCosThetaCS] || fgUsedVars[kPhiCS]) {
+    // TO DO: get the correct values from CCDB
+    double BeamMomentum = TMath::Sqrt(fgCenterOfMassEnergy * fgCenterOfMassEnergy / 4 - fgMassofCollidingParticle * fgMassofCollidingParticle); // GeV
+    ROOT::Math::PxPyPzEVector Beam1(0., 0., -BeamMomentum, fgCenterOfMassEnergy / 2);
+    ROOT::Math::PxPyPzEVector Beam2(0., 0., BeamMomentum, fgCenterOfMassEnergy / 2);
 
-  // Boost to center of mass frame
-  ROOT::Math::Boost boostv12{v12.BoostToCM()};
-  ROOT::Math::XYZVectorF v1_CM{(boostv12(v1).Vect()).Unit()};
-  ROOT::Math::XYZVectorF v2_CM{(boostv12(v2).Vect()).Unit()};
-  ROOT::Math::XYZVectorF Beam1_CM{(boostv12(Beam1).Vect()).Unit()};
-  ROOT::Math::XYZVectorF Beam2_CM{(boostv12(Beam2).Vect()).Unit()};
+    // Boost to center of mass frame
+    ROOT::Math::Boost boostv12{v12.BoostToCM()};
+    ROOT::Math::XYZVectorF v1_CM{(boostv12(v1).Vect()).Unit()};
+    ROOT::Math::XYZVectorF v2_CM{(boostv12(v2).Vect()).Unit()};
+    ROOT::Math::XYZVectorF Beam1_CM{(boostv12(Beam1).Vect()).Unit()};
+    ROOT::Math::XYZVectorF Beam2_CM{(boostv12(Beam2).Vect()).Unit()};
 
-  // Helicity frame
-  ROOT::Math::XYZVectorF zaxis_HE{(v12.Vect()).Unit()};
-  ROOT::Math::XYZVectorF yaxis_HE{(Beam1_CM.Cross(Beam2_CM)).Unit()};
-  ROOT::Math::XYZVectorF xaxis_HE{(yaxis_HE.Cross(zaxis_HE)).Unit()};
+    // Helicity frame
+    ROOT::Math::XYZVectorF zaxis_HE{(v12.Vect()).Unit()};
+    ROOT::Math::XYZVectorF yaxis_HE{(Beam1_CM.Cross(Beam2_CM)).Unit()};
+    ROOT::Math::XYZVectorF xaxis_HE{(yaxis_HE.Cross(zaxis_HE)).Unit()};
 
-  // Collins-Soper frame
-  ROOT::Math::XYZVectorF zaxis_CS{((Beam1_CM.Unit() - Beam2_CM.Unit()).Unit())};
-  ROOT::Math::XYZVectorF yaxis_CS{(Beam1_CM.Cross(Beam2_CM)).Unit()};
-  ROOT::Math::XYZVectorF xaxis_CS{(yaxis_CS.Cross(zaxis_CS)).Unit()};
+    // Collins-Soper frame
+    ROOT::Math::XYZVectorF zaxis_CS{((Beam1_CM.Unit() - Beam2_CM.Unit()).Unit())};
+    ROOT::Math::XYZVectorF yaxis_CS{(Beam1_CM.Cross(Beam2_CM)).Unit()};
+    ROOT::Math::XYZVectorF xaxis_CS{(yaxis_CS.Cross(zaxis_CS)).Unit()};
 
-  if (fgUsedVars[kCosThetaHE]) {
-    values[kCosThetaHE] = (t1.sign() > 0 ? zaxis_HE.Dot(v1_CM) : zaxis_HE.Dot(v2_CM));
-  }
+    if (fgUsedVars[kCosThetaHE]) {
+      values[kCosThetaHE] = (t1.sign() > 0 ? zaxis_HE.Dot(v1_CM) : zaxis_HE.Dot(v2_CM));
+    }
 
-  if (fgUsedVars[kPhiHE]) {
-    values[kPhiHE] = (t1.sign() > 0 ? TMath::ATan2(yaxis_HE.Dot(v1_CM), xaxis_HE.Dot(v1_CM)) : TMath::ATan2(yaxis_HE.Dot(v2_CM), xaxis_HE.Dot(v2_CM)));
-  }
+    if (fgUsedVars[kPhiHE]) {
+      values[kPhiHE] = (t1.sign() > 0 ? TMath::ATan2(yaxis_HE.Dot(v1_CM), xaxis_HE.Dot(v1_CM)) : TMath::ATan2(yaxis_HE.Dot(v2_CM), xaxis_HE.Dot(v2_CM)));
+    }
 
-  if (fgUsedVars[kCosThetaCS]) {
-    values[kCosThetaCS] = (t1.sign() > 0 ? zaxis_CS.Dot(v1_CM) : zaxis_CS.Dot(v2_CM));
-  }
+    if (fgUsedVars[kCosThetaCS]) {
+      values[kCosThetaCS] = (t1.sign() > 0 ? zaxis_CS.Dot(v1_CM) : zaxis_CS.Dot(v2_CM));
+    }
 
-  if (fgUsedVars[kPhiCS]) {
-    values[kPhiCS] = (t1.sign() > 0 ? TMath::ATan2(yaxis_CS.Dot(v1_CM), xaxis_CS.Dot(v1_CM)) : TMath::ATan2(yaxis_CS.Dot(v2_CM), xaxis_CS.Dot(v2_CM)));
+    if (fgUsedVars[kPhiCS]) {
+      values[kPhiCS] = (t1.sign() > 0 ? TMath::ATan2(yaxis_CS.Dot(v1_CM), xaxis_CS.Dot(v1_CM)) : TMath::ATan2(yaxis_CS.Dot(v2_CM), xaxis_CS.Dot(v2_CM)));
+    }
   }
 
   if constexpr ((pairType == kDecayToEE) && ((fillMap & TrackCov) > 0 || (fillMap & ReducedTrackBarrelCov) > 0)) {
@@ -2506,7 +2584,8 @@ void VarManager::FillTripleMC(T1 const& t1, T2 const& t2, T3 const& t3, float* v
 }
 
 template <int pairType, uint32_t collFillMap, uint32_t fillMap, typename C, typename T>
-void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2, bool propToSV, float* values)
+void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2, bool propToSV, float* values,
+                                   o2::vertexing::DCAFitterN<2>* fitterBarrel, o2::vertexing::FwdDCAFitterN<2>* fitterFwd)
 {
   // check at compile time that the event and cov matrix have the cov matrix
   constexpr bool eventHasVtxCov = ((collFillMap & Collision) > 0 || (collFillMap & ReducedEventVtxCov) > 0);
@@ -2516,6 +2595,12 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
   if (!values) {
     values = fgValues;
   }
+  if (!fitterBarrel) {
+    fitterBarrel = &fgFitterTwoProngBarrel;
+  }
+  if (!fitterFwd) {
+    fitterFwd = &fgFitterTwoProngFwd;
+  }
   float m1 = o2::constants::physics::MassElectron;
   float m2 = o2::constants::physics::MassElectron;
   if constexpr (pairType == kDecayToKPi) {
@@ -2549,7 +2634,7 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
                                       t2.cSnpSnp(), t2.cTglY(), t2.cTglZ(), t2.cTglSnp(), t2.cTglTgl(),
                                       t2.c1PtY(), t2.c1PtZ(), t2.c1PtSnp(), t2.c1PtTgl(), t2.c1Pt21Pt2()};
       o2::track::TrackParCov pars2{t2.x(), t2.alpha(), t2pars, t2covs};
-      procCode = fgFitterTwoProngBarrel.process(pars1, pars2);
+      procCode = fitterBarrel->process(pars1, pars2);
     } else if constexpr ((pairType == kDecayToMuMu) && muonHasCov) {
       // Initialize track parameters for forward
       double chi21 = t1.chi2();
@@ -2566,7 +2651,7 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
                              t2.c1PtX(), t2.c1PtY(), t2.c1PtPhi(), t2.c1PtTgl(), t2.c1Pt21Pt2()};
       SMatrix55 t2covs(v2.begin(), v2.end());
       o2::track::TrackParCovFwd pars2{t2.z(), t2pars, t2covs, chi22};
-      procCode = fgFitterTwoProngFwd.process(pars1, pars2);
+      procCode = fitterFwd->process(pars1, pars2);
     } else {
       return;
     }
@@ -2605,11 +2690,11 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
       auto covMatrixPV = primaryVertex.getCov();
 
       if constexpr ((pairType == kDecayToEE || pairType == kDecayToKPi) && trackHasCov) {
-        secondaryVertex = fgFitterTwoProngBarrel.getPCACandidate();
-        covMatrixPCA = fgFitterTwoProngBarrel.calcPCACovMatrixFlat();
-        auto chi2PCA = fgFitterTwoProngBarrel.getChi2AtPCACandidate();
-        auto trackParVar0 = fgFitterTwoProngBarrel.getTrack(0);
-        auto trackParVar1 = fgFitterTwoProngBarrel.getTrack(1);
+        secondaryVertex = fitterBarrel->getPCACandidate();
+        covMatrixPCA = fitterBarrel->calcPCACovMatrixFlat();
+        auto chi2PCA = fitterBarrel->getChi2AtPCACandidate();
+        auto trackParVar0 = fitterBarrel->getTrack(0);
+        auto trackParVar1 = fitterBarrel->getTrack(1);
         values[kVertexingChi2PCA] = chi2PCA;
         v1 = {trackParVar0.getPt(), trackParVar0.getEta(), trackParVar0.getPhi(), m1};
         v2 = {trackParVar1.getPt(), trackParVar1.getEta(), trackParVar1.getPhi(), m2};
@@ -2617,11 +2702,11 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
 
       } else if constexpr (pairType == kDecayToMuMu && muonHasCov) {
         // Get pca candidate from forward DCA fitter
-        secondaryVertex = fgFitterTwoProngFwd.getPCACandidate();
-        covMatrixPCA = fgFitterTwoProngFwd.calcPCACovMatrixFlat();
-        auto chi2PCA = fgFitterTwoProngFwd.getChi2AtPCACandidate();
-        auto trackParVar0 = fgFitterTwoProngFwd.getTrack(0);
-        auto trackParVar1 = fgFitterTwoProngFwd.getTrack(1);
+        secondaryVertex = fitterFwd->getPCACandidate();
+        covMatrixPCA = fitterFwd->calcPCACovMatrixFlat();
+        auto chi2PCA = fitterFwd->getChi2AtPCACandidate();
+        auto trackParVar0 = fitterFwd->getTrack(0);
+        auto trackParVar1 = fitterFwd->getTrack(1);
         values[kVertexingChi2PCA] = chi2PCA;
         v1 = {trackParVar0.getPt(), trackParVar0.getEta(), trackParVar0.getPhi(), m1};
         v2 = {trackParVar1.getPt(), trackParVar1.getEta(), trackParVar1.getPhi(), m2};
@@ -2891,7 +2976,8 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
 }
 
 template <uint32_t collFillMap, uint32_t fillMap, typename C, typename T>
-void VarManager::FillTripletVertexing(C const& collision, T const& t1, T const& t2, T const& t3, VarManager::PairCandidateType tripletType, float* values)
+void VarManager::FillTripletVertexing(C const& collision, T const& t1, T const& t2, T const& t3, VarManager::PairCandidateType tripletType, float* values,
+                                      o2::vertexing::DCAFitterN<3>* fitterThreeProngBarrel)
 {
   // TODO: Vertexing error variables
   constexpr bool eventHasVtxCov = ((collFillMap & Collision) > 0 || (collFillMap & ReducedEventVtxCov) > 0);
@@ -2900,6 +2986,9 @@ void VarManager::FillTripletVertexing(C const& collision, T const& t1, T const&
   if (!values) {
     values = fgValues;
   }
+  if (!fitterThreeProngBarrel) {
+    fitterThreeProngBarrel = &fgFitterThreeProngBarrel;
+  }
 
   float m1, m2, m3;
 
@@ -2932,7 +3021,7 @@ void VarManager::FillTripletVertexing(C const& collision, T const& t1, T const&
                                     t3.cSnpSnp(), t3.cTglY(), t3.cTglZ(), t3.cTglSnp(), t3.cTglTgl(),
                                     t3.c1PtY(), t3.c1PtZ(), t3.c1PtSnp(), t3.c1PtTgl(), t3.c1Pt21Pt2()};
     o2::track::TrackParCov pars3{t3.x(), t3.alpha(), t3pars, t3covs};
-    procCode = VarManager::fgFitterThreeProngBarrel.process(pars1, pars2, pars3);
+    procCode = fitterThreeProngBarrel->process(pars1, pars2, pars3);
   } else {
     return;
   }
@@ -2961,7 +3050,7 @@ void VarManager::FillTripletVertexing(C const& collision, T const& t1, T const&
     return;
   }
 
-  Vec3D secondaryVertex = fgFitterThreeProngBarrel.getPCACandidate();
+  Vec3D secondaryVertex = fitterThreeProngBarrel->getPCACandidate();
 
   if constexpr (eventHasVtxCov) {
     if (fgUsedVars[kVertexingLxy] || fgUsedVars[kVertexingLz] || fgUsedVars[kVertexingLxyz]) {
@@ -2991,7 +3080,9 @@ void VarManager::FillTripletVertexing(C const& collision, T const& t1, T const&
 }
 
 template <int candidateType, uint32_t collFillMap, uint32_t fillMap, typename C, typename T1>
-void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton1, T1 const& lepton2, T1 const& track, float* values)
+void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton1, T1 const& lepton2, T1 const& track, float* values,
+                                            o2::vertexing::DCAFitterN<2>* fitterTwoProngBarrel, o2::vertexing::FwdDCAFitterN<2>* fitterTwoProngFwd,
+                                            o2::vertexing::DCAFitterN<3>* fitterThreeProngBarrel, o2::vertexing::FwdDCAFitterN<3>* fitterThreeProngFwd)
 {
 
   constexpr bool eventHasVtxCov = ((collFillMap & Collision) > 0 || (collFillMap & ReducedEventVtxCov) > 0);
@@ -3000,6 +3091,18 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
   if (!values) {
     values = fgValues;
   }
+  if (!fitterTwoProngBarrel) {
+    fitterTwoProngBarrel = &fgFitterTwoProngBarrel;
+  }
+  if (!fitterTwoProngFwd) {
+    fitterTwoProngFwd = &fgFitterTwoProngFwd;
+  }
+  if (!fitterThreeProngBarrel) {
+    fitterThreeProngBarrel = &fgFitterThreeProngBarrel;
+  }
+  if (!fitterThreeProngFwd) {
+    fitterThreeProngFwd = &fgFitterThreeProngFwd;
+  }
 
   float mtrack;
   float mlepton1, mlepton2;
@@ -3037,8 +3140,8 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
                              track.c1PtX(), track.c1PtY(), track.c1PtPhi(), track.c1PtTgl(), track.c1Pt21Pt2()};
       SMatrix55 t3covs(v3.begin(), v3.end());
       o2::track::TrackParCovFwd pars3{track.z(), t3pars, t3covs, chi23};
-      procCode = VarManager::fgFitterThreeProngFwd.process(pars1, pars2, pars3);
-      procCodeJpsi = VarManager::fgFitterTwoProngFwd.process(pars1, pars2);
+      procCode = fitterThreeProngFwd->process(pars1, pars2, pars3);
+      procCodeJpsi = fitterTwoProngFwd->process(pars1, pars2);
     } else if constexpr ((candidateType == kBtoJpsiEEK || candidateType == kDstarToD0KPiPi) && trackHasCov) {
       if constexpr ((candidateType == kBtoJpsiEEK) && trackHasCov) {
         mlepton1 = o2::constants::physics::MassElectron;
@@ -3064,8 +3167,8 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
                                            track.cSnpSnp(), track.cTglY(), track.cTglZ(), track.cTglSnp(), track.cTglTgl(),
                                            track.c1PtY(), track.c1PtZ(), track.c1PtSnp(), track.c1PtTgl(), track.c1Pt21Pt2()};
       o2::track::TrackParCov pars3{track.x(), track.alpha(), lepton3pars, lepton3covs};
-      procCode = VarManager::fgFitterThreeProngBarrel.process(pars1, pars2, pars3);
-      procCodeJpsi = VarManager::fgFitterTwoProngBarrel.process(pars1, pars2);
+      procCode = fitterThreeProngBarrel->process(pars1, pars2, pars3);
+      procCodeJpsi = fitterTwoProngBarrel->process(pars1, pars2);
     } else {
       return;
     }
@@ -3120,14 +3223,14 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
       auto covMatrixPV = primaryVertex.getCov();
 
       if constexpr ((candidateType == kBtoJpsiEEK || candidateType == kDstarToD0KPiPi) && trackHasCov) {
-        secondaryVertex = fgFitterThreeProngBarrel.getPCACandidate();
-        covMatrixPCA = fgFitterThreeProngBarrel.calcPCACovMatrixFlat();
+        secondaryVertex = fitterThreeProngBarrel->getPCACandidate();
+        covMatrixPCA = fitterThreeProngBarrel->calcPCACovMatrixFlat();
       } else if constexpr (candidateType == kBcToThreeMuons && muonHasCov) {
-        secondaryVertex = fgFitterThreeProngFwd.getPCACandidate();
-        covMatrixPCA = fgFitterThreeProngFwd.calcPCACovMatrixFlat();
+        secondaryVertex = fitterThreeProngFwd->getPCACandidate();
+        covMatrixPCA = fitterThreeProngFwd->calcPCACovMatrixFlat();
       }
 
-      auto chi2PCA = fgFitterThreeProngBarrel.getChi2AtPCACandidate();
+      auto chi2PCA = fitterThreeProngBarrel->getChi2AtPCACandidate();
       if (fgUsedVars[kVertexingChi2PCA])
         values[VarManager::kVertexingChi2PCA] = chi2PCA;
 
@@ -3507,23 +3610,23 @@ void VarManager::FillPairVn(T1 const& t1, T2 const& t2, float* values)
   values[kCos2DeltaPhiMu1] = std::cos(2 * (v1.Phi() - v12.Phi()));
   values[kCos2DeltaPhiMu2] = std::cos(2 * (v2.Phi() - v12.Phi()));
 
-  if (isnan(VarManager::fgValues[VarManager::kU2Q2]) == true) {
+  if (isnan(values[kU2Q2]) == true) {
     values[kU2Q2] = -999.;
     values[kR2SP_AB] = -999.;
     values[kR2SP_AC] = -999.;
     values[kR2SP_BC] = -999.;
   }
-  if (isnan(VarManager::fgValues[VarManager::kU3Q3]) == true) {
+  if (isnan(values[kU3Q3]) == true) {
     values[kU3Q3] = -999.;
     values[kR3SP] = -999.;
   }
-  if (isnan(VarManager::fgValues[VarManager::kCos2DeltaPhi]) == true) {
+  if (isnan(values[kCos2DeltaPhi]) == true) {
     values[kCos2DeltaPhi] = -999.;
     values[kR2EP_AB] = -999.;
     values[kR2EP_AC] = -999.;
     values[kR2EP_BC] = -999.;
   }
-  if (isnan(VarManager::fgValues[VarManager::kCos3DeltaPhi]) == true) {
+  if (isnan(values[kCos3DeltaPhi]) == true) {
     values[kCos3DeltaPhi] = -999.;
     values[kR3EP] = -999.;
   }
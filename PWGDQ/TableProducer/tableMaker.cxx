@@ -17,7 +17,9 @@
 // The skimming can optionally produce just the barrel, muon, or both barrel and muon tracks
 // The event filtering (filterPP), centrality, and V0Bits (from v0-selector) can be switched on/off by selecting one
 //  of the process functions
+#include <algorithm>
 #include <iostream>
+#include <vector>
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/ASoAHelpers.h"
@@ -164,6 +166,7 @@ struct TableMaker {
   Configurable<float> fConfigMinTpcSignal{"cfgMinTpcSignal", 30.0, "Minimum TPC signal"};
   Configurable<float> fConfigMaxTpcSignal{"cfgMaxTpcSignal", 300.0, "Maximum TPC signal"};
   Configurable<bool> fConfigQA{"cfgQA", false, "If true, fill QA histograms"};
+  Configurable<int> fConfigQAPrescale{"cfgQAPrescale", 1, "Fill the QA histograms of the track and muon cuts for one event out of N"};
   Configurable<bool> fConfigDetailedQA{"cfgDetailedQA", false, "If true, include more QA histograms (BeforeCuts classes)"};
   Configurable<bool> fIsRun2{"cfgIsRun2", false, "Whether we analyze Run-2 or Run-3 data"};
   Configurable<bool> fIsAmbiguous{"cfgIsAmbiguous", false, "Whether we enable QA plots for ambiguous tracks"};
@@ -188,6 +191,12 @@ struct TableMaker {
   AnalysisCompositeCut* fEventCut;              //! Event selection cut
   std::vector<AnalysisCompositeCut> fTrackCuts; //! Barrel track cuts
   std::vector<AnalysisCompositeCut> fMuonCuts;  //! Muon track cuts
+  // names of the QA histogram classes of the cuts, to avoid formatting them for each track
+  std::vector<TString> fTrackCutHistNames;
+  std::vector<TString> fAmbiTrackCutHistNames;
+  std::vector<TString> fMuonCutHistNames;
+  std::vector<TString> fAmbiMuonCutHistNames;
+  std::vector<int64_t> fAmbiguousIds; // sorted indices of the ambiguous tracks (or muons) of the dataframe
 
   Preslice<MyBarrelTracks> perCollisionTracks = aod::track::collisionId;
   Preslice<MyMuons> perCollisionMuons = aod::fwdtrack::collisionId;
@@ -321,6 +330,8 @@ struct TableMaker {
       std::unique_ptr<TObjArray> objArray(cutNamesStr.Tokenize(","));
       for (int icut = 0; icut < objArray->GetEntries(); ++icut) {
         fTrackCuts.push_back(*dqcuts::GetCompositeCut(objArray->At(icut)->GetName()));
+        fTrackCutHistNames.push_back(Form("TrackBarrel_%s", fTrackCuts.back().GetName()));
+        fAmbiTrackCutHistNames.push_back(Form("Ambiguous_TrackBarrel_%s", fTrackCuts.back().GetName()));
       }
     }
 
@@ -330,6 +341,8 @@ struct TableMaker {
       std::unique_ptr<TObjArray> objArray(cutNamesStr.Tokenize(","));
       for (int icut = 0; icut < objArray->GetEntries(); ++icut) {
         fMuonCuts.push_back(*dqcuts::GetCompositeCut(objArray->At(icut)->GetName()));
+        fMuonCutHistNames.push_back(Form("Muons_%s", fMuonCuts.back().GetName()));
+        fAmbiMuonCutHistNames.push_back(Form("Ambiguous_Muons_%s", fMuonCuts.back().GetName()));
       }
     }
 
@@ -340,6 +353,8 @@ struct TableMaker {
   template <uint32_t TEventFillMap, uint32_t TTrackFillMap, uint32_t TMuonFillMap, uint32_t TMFTFillMap = 0u, typename TEvent, typename TTracks, typename TMuons, typename TAmbiTracks, typename TAmbiMuons, typename TMFTTracks = std::nullptr_t>
   void fullSkimming(TEvent const& collision, aod::BCsWithTimestamps const&, TTracks const& tracksBarrel, TMuons const& tracksMuon, TAmbiTracks const& ambiTracksMid, TAmbiMuons const& ambiTracksFwd, TMFTTracks const& mftTracks = nullptr)
   {
+    // the QA of the track and muon cuts is filled for a prescaled subset of the events
+    const bool fillCutQA = fConfigQA && (fConfigQAPrescale <= 1 || collision.globalIndex() % fConfigQAPrescale == 0);
     auto bc = collision.template bc_as<aod::BCsWithTimestamps>();
     if (fCurrentRun != bc.runNumber()) {
       if (fConfigComputeTPCpostCalib) {
@@ -453,17 +468,21 @@ struct TableMaker {
       }
       trackBarrelPID.reserve(tracksBarrel.size());
 
+      if constexpr ((TTrackFillMap & VarManager::ObjTypes::AmbiTrack) > 0) {
+        if (fIsAmbiguous) {
+          fAmbiguousIds.clear();
+          for (auto& ambiTrackMid : ambiTracksMid) {
+            fAmbiguousIds.push_back(ambiTrackMid.trackId());
+          }
+          std::sort(fAmbiguousIds.begin(), fAmbiguousIds.end());
+        }
+      }
+
       // loop over tracks
       for (auto& track : tracksBarrel) {
         if constexpr ((TTrackFillMap & VarManager::ObjTypes::AmbiTrack) > 0) {
           if (fIsAmbiguous) {
-            isAmbiguous = 0;
-            for (auto& ambiTrackMid : ambiTracksMid) {
-              if (ambiTrackMid.trackId() == track.globalIndex()) {
-                isAmbiguous = 1;
-                break;
-              }
-            }
+            isAmbiguous = std::binary_search(fAmbiguousIds.begin(), fAmbiguousIds.end(), track.globalIndex()) ? 1 : 0;
           }
         }
 
@@ -482,10 +501,10 @@ struct TableMaker {
         for (auto cut = fTrackCuts.begin(); cut != fTrackCuts.end(); cut++, i++) {
           if ((*cut).IsSelected(VarManager::fgValues)) {
             trackTempFilterMap |= (uint8_t(1) << i);
-            if (fConfigQA) {
-              fHistMan->FillHistClass(Form("TrackBarrel_%s", (*cut).GetName()), VarManager::fgValues);
+            if (fillCutQA) {
+              fHistMan->FillHistClass(fTrackCutHistNames[i].Data(), VarManager::fgValues);
               if (fIsAmbiguous && isAmbiguous == 1) {
-                fHistMan->FillHistClass(Form("Ambiguous_TrackBarrel_%s", (*cut).GetName()), VarManager::fgValues);
+                fHistMan->FillHistClass(fAmbiTrackCutHistNames[i].Data(), VarManager::fgValues);
               }
             }
             (reinterpret_cast<TH1I*>(fStatsList->At(1)))->Fill(static_cast<float>(i));
@@ -647,17 +666,21 @@ struct TableMaker {
         }
       }
 
+      if constexpr ((TMuonFillMap & VarManager::ObjTypes::AmbiMuon) > 0) {
+        if (fIsAmbiguous) {
+          fAmbiguousIds.clear();
+          for (auto& ambiTrackFwd : ambiTracksFwd) {
+            fAmbiguousIds.push_back(ambiTrackFwd.fwdtrackId());
+          }
+          std::sort(fAmbiguousIds.begin(), fAmbiguousIds.end());
+        }
+      }
+
       // now let's save the muons with the correct indices and matches
       for (auto& muon : tracksMuon) {
         if constexpr ((TMuonFillMap & VarManager::ObjTypes::AmbiMuon) > 0) {
           if (fIsAmbiguous) {
-            isAmbiguous = 0;
-            for (auto& ambiTrackFwd : ambiTracksFwd) {
-              if (ambiTrackFwd.fwdtrackId() == muon.globalIndex()) {
-                isAmbiguous = 1;
-                break;
-              }
-            }
+            isAmbiguous = std::binary_search(fAmbiguousIds.begin(), fAmbiguousIds.end(), muon.globalIndex()) ? 1 : 0;
           }
         }
         fwdFilteringTag = uint8_t(0);
@@ -687,10 +710,10 @@ struct TableMaker {
         for (auto cut = fMuonCuts.begin(); cut != fMuonCuts.end(); cut++, i++) {
           if ((*cut).IsSelected(VarManager::fgValues)) {
             trackTempFilterMap |= (uint8_t(1) << i);
-            if (fConfigQA) {
-              fHistMan->FillHistClass(Form("Muons_%s", (*cut).GetName()), VarManager::fgValues);
+            if (fillCutQA) {
+              fHistMan->FillHistClass(fMuonCutHistNames[i].Data(), VarManager::fgValues);
               if (fIsAmbiguous && isAmbiguous == 1) {
-                fHistMan->FillHistClass(Form("Ambiguous_Muons_%s", (*cut).GetName()), VarManager::fgValues);
+                fHistMan->FillHistClass(fAmbiMuonCutHistNames[i].Data(), VarManager::fgValues);
               }
             }
             (reinterpret_cast<TH1I*>(fStatsList->At(2)))->Fill(static_cast<float>(i));
@@ -770,6 +793,8 @@ struct TableMaker {
   template <uint32_t TEventFillMap, uint32_t TTrackFillMap, uint32_t TMuonFillMap, typename TEvent, typename TTracks, typename TMuons, typename AssocTracks, typename AssocMuons>
   void fullSkimmingIndices(TEvent const& collision, aod::BCsWithTimestamps const&, TTracks const& tracksBarrel, TMuons const& tracksMuon, AssocTracks const& trackIndices, AssocMuons const& fwdtrackIndices)
   {
+    // the QA of the track and muon cuts is filled for a prescaled subset of the events
+    const bool fillCutQA = fConfigQA && (fConfigQAPrescale <= 1 || collision.globalIndex() % fConfigQAPrescale == 0);
     auto bc = collision.template bc_as<aod::BCsWithTimestamps>();
     if (fCurrentRun != bc.runNumber()) {
       if (fConfigComputeTPCpostCalib) {
@@ -906,10 +931,10 @@ struct TableMaker {
         for (auto cut = fTrackCuts.begin(); cut != fTrackCuts.end(); cut++, i++) {
           if ((*cut).IsSelected(VarManager::fgValues)) {
             trackTempFilterMap |= (uint8_t(1) << i);
-            if (fConfigQA) {
-              fHistMan->FillHistClass(Form("TrackBarrel_%s", (*cut).GetName()), VarManager::fgValues);
+            if (fillCutQA) {
+              fHistMan->FillHistClass(fTrackCutHistNames[i].Data(), VarManager::fgValues);
               if (fIsAmbiguous && isAmbiguous == 1) {
-                fHistMan->FillHistClass(Form("Ambiguous_TrackBarrel_%s", (*cut).GetName()), VarManager::fgValues);
+                fHistMan->FillHistClass(fAmbiTrackCutHistNames[i].Data(), VarManager::fgValues);
               }
             }
             (reinterpret_cast<TH1I*>(fStatsList->At(1)))->Fill(static_cast<float>(i));
@@ -1059,10 +1084,10 @@ struct TableMaker {
         for (auto cut = fMuonCuts.begin(); cut != fMuonCuts.end(); cut++, i++) {
           if ((*cut).IsSelected(VarManager::fgValues)) {
             trackTempFilterMap |= (uint8_t(1) << i);
-            if (fConfigQA) {
-              fHistMan->FillHistClass(Form("Muons_%s", (*cut).GetName()), VarManager::fgValues);
+            if (fillCutQA) {
+              fHistMan->FillHistClass(fMuonCutHistNames[i].Data(), VarManager::fgValues);
               if (fIsAmbiguous && isAmbiguous == 1) {
-                fHistMan->FillHistClass(Form("Ambiguous_Muons_%s", (*cut).GetName()), VarManager::fgValues);
+                fHistMan->FillHistClass(fAmbiMuonCutHistNames[i].Data(), VarManager::fgValues);
               }
             }
             (reinterpret_cast<TH1I*>(fStatsList->At(2)))->Fill(static_cast<float>(i));
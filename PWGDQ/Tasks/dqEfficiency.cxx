@@ -30,6 +30,7 @@
 #include "PWGDQ/Core/HistogramsLibrary.h"
 #include "PWGDQ/Core/CutsLibrary.h"
 #include "PWGDQ/Core/MCSignal.h"
+#include "PWGDQ/Core/MCSignalMatcher.h"
 #include "PWGDQ/Core/MCSignalLibrary.h"
 #include "CCDB/BasicCCDBManager.h"
 #include "DataFormatsParameters/GRPMagField.h"
@@ -526,6 +527,8 @@ struct AnalysisSameEventPairing {
   std::vector<std::vector<TString>> fBarrelMuonHistNamesMCmatched;
   std::vector<MCSignal> fRecMCSignals;
   std::vector<MCSignal> fGenMCSignals;
+  MCSignalMatcher fRecMCSignalMatcher; // bit map decisions of fRecMCSignals, cached per MC particle
+  MCSignalMatcher fGenMCSignalMatcher; // bit map decisions of fGenMCSignals, cached per MC particle
 
   void init(o2::framework::InitContext& context)
   {
@@ -680,13 +683,16 @@ struct AnalysisSameEventPairing {
       }
     }
 
+    fRecMCSignalMatcher.SetSignals(fRecMCSignals);
+    fGenMCSignalMatcher.SetSignals(fGenMCSignals);
+
     DefineHistograms(fHistMan, histNames.Data());    // define all histograms
     VarManager::SetUseVars(fHistMan->GetUsedVars()); // provide the list of required variables so that VarManager knows what to fill
     fOutputList.setObject(fHistMan->GetMainHistogramList());
   }
 
   template <int TPairType, uint32_t TEventFillMap, uint32_t TEventMCFillMap, uint32_t TTrackFillMap, typename TEvent, typename TTracks1, typename TTracks2, typename TEventsMC, typename TTracksMC>
-  void runPairing(TEvent const& event, TTracks1 const& tracks1, TTracks2 const& tracks2, TEventsMC const& /*eventsMC*/, TTracksMC const& /*tracksMC*/)
+  void runPairing(TEvent const& event, TTracks1 const& tracks1, TTracks2 const& tracks2, TEventsMC const& /*eventsMC*/, TTracksMC const& tracksMC)
   {
     if (fCurrentRun != event.runNumber()) {
       if (fUseRemoteField) {
@@ -728,6 +734,9 @@ struct AnalysisSameEventPairing {
       histNamesMCmatched = fBarrelMuonHistNamesMCmatched;
     }
 
+    // MC decisions are cached per MC particle: prongs are checked once per track instead of once per pair
+    fRecMCSignalMatcher.Reset(tracksMC.size());
+
     // Loop over two track combinations
     uint8_t twoTrackFilter = 0;
     uint32_t dileptonFilterMap = 0;
@@ -762,19 +771,12 @@ struct AnalysisSameEventPairing {
 
       // run MC matching for this pair
       uint32_t mcDecision = 0;
-      int isig = 0;
-      for (auto sig = fRecMCSignals.begin(); sig != fRecMCSignals.end(); sig++, isig++) {
-        if constexpr (TTrackFillMap & VarManager::ObjTypes::ReducedTrack || TTrackFillMap & VarManager::ObjTypes::ReducedMuon) { // for skimmed DQ model
-          if ((*sig).CheckSignal(false, t1.reducedMCTrack(), t2.reducedMCTrack())) {
-            mcDecision |= (uint32_t(1) << isig);
-          }
-        }
-        if constexpr (TTrackFillMap & VarManager::ObjTypes::Track || TTrackFillMap & VarManager::ObjTypes::Muon) { // for Framework data model
-          if ((*sig).CheckSignal(false, t1.template mcParticle_as<aod::McParticles_001>(), t2.template mcParticle_as<aod::McParticles_001>())) {
-            mcDecision |= (uint32_t(1) << isig);
-          }
-        }
-      } // end loop over MC signals
+      if constexpr (TTrackFillMap & VarManager::ObjTypes::ReducedTrack || TTrackFillMap & VarManager::ObjTypes::ReducedMuon) { // for skimmed DQ model
+        mcDecision = fRecMCSignalMatcher.GetSignalMask(t1.reducedMCTrack(), t2.reducedMCTrack());
+      }
+      if constexpr (TTrackFillMap & VarManager::ObjTypes::Track || TTrackFillMap & VarManager::ObjTypes::Muon) { // for Framework data model
+        mcDecision = fRecMCSignalMatcher.GetSignalMask(t1.template mcParticle_as<aod::McParticles_001>(), t2.template mcParticle_as<aod::McParticles_001>());
+      }
 
       dileptonFilterMap = twoTrackFilter;
       dileptonMcDecision = mcDecision;
@@ -856,45 +858,47 @@ struct AnalysisSameEventPairing {
     // loop over mc stack and fill histograms for pure MC truth signals
     // group all the MC tracks which belong to the MC event corresponding to the current reconstructed event
     // auto groupedMCTracks = tracksMC.sliceBy(aod::reducedtrackMC::reducedMCeventId, event.reducedMCevent().globalIndex());
+    // MC decisions are cached per MC particle: each particle is checked once against all the signals, also for the pairing
+    fGenMCSignalMatcher.Reset(groupedMCTracks.offset() + groupedMCTracks.size());
     for (auto& mctrack : groupedMCTracks) {
       VarManager::FillTrackMC(groupedMCTracks, mctrack);
       // NOTE: Signals are checked here mostly based on the skimmed MC stack, so depending on the requested signal, the stack could be incomplete.
       // NOTE: However, the working model is that the decisions on MC signals are precomputed during skimming and are stored in the mcReducedFlags member.
       // TODO:  Use the mcReducedFlags to select signals
-      for (auto& sig : fGenMCSignals) {
-        if (sig.GetNProngs() != 1) { // NOTE: 1-prong signals required
-          continue;
-        }
-        bool checked = false;
-        if constexpr (soa::is_soa_filtered_v<TTracksMC>) {
-          auto mctrack_raw = groupedMCTracks.rawIteratorAt(mctrack.globalIndex());
-          checked = sig.CheckSignal(false, mctrack_raw);
-        } else {
-          checked = sig.CheckSignal(false, mctrack);
-        }
-        if (checked) {
-          fHistMan->FillHistClass(Form("MCTruthGen_%s", sig.GetName()), VarManager::fgValues);
+      uint64_t mcDecision = 0; // NOTE: 1-prong signals required
+      if constexpr (soa::is_soa_filtered_v<TTracksMC>) {
+        auto mctrack_raw = groupedMCTracks.rawIteratorAt(mctrack.globalIndex());
+        mcDecision = fGenMCSignalMatcher.GetSignalMask(mctrack_raw);
+      } else {
+        mcDecision = fGenMCSignalMatcher.GetSignalMask(mctrack);
+      }
+      for (unsigned int isig = 0; mcDecision; isig++, mcDecision >>= 1) {
+        if (mcDecision & 1) {
+          fHistMan->FillHistClass(Form("MCTruthGen_%s", fGenMCSignals[isig].GetName()), VarManager::fgValues);
         }
       }
     }
 
     //    // loop over mc stack and fill histograms for pure MC truth signals
-    for (auto& sig : fGenMCSignals) {
-      if (sig.GetNProngs() != 2) { // NOTE: 2-prong signals required
+    if (!fGenMCSignalMatcher.GetSignalsWithNProngs(2)) { // NOTE: 2-prong signals required
+      return;
+    }
+    for (auto& [t1, t2] : combinations(groupedMCTracks, groupedMCTracks)) {
+      uint64_t mcDecision = 0;
+      if constexpr (soa::is_soa_filtered_v<TTracksMC>) {
+        auto t1_raw = groupedMCTracks.rawIteratorAt(t1.globalIndex());
+        auto t2_raw = groupedMCTracks.rawIteratorAt(t2.globalIndex());
+        mcDecision = fGenMCSignalMatcher.GetSignalMask(t1_raw, t2_raw);
+      } else {
+        mcDecision = fGenMCSignalMatcher.GetSignalMask(t1, t2);
+      }
+      if (!mcDecision) {
         continue;
       }
-      for (auto& [t1, t2] : combinations(groupedMCTracks, groupedMCTracks)) {
-        bool checked = false;
-        if constexpr (soa::is_soa_filtered_v<TTracksMC>) {
-          auto t1_raw = groupedMCTracks.rawIteratorAt(t1.globalIndex());
-          auto t2_raw = groupedMCTracks.rawIteratorAt(t2.globalIndex());
-          checked = sig.CheckSignal(false, t1_raw, t2_raw);
-        } else {
-          checked = sig.CheckSignal(false, t1, t2);
-        }
-        if (checked) {
-          VarManager::FillPairMC(t1, t2);
-          fHistMan->FillHistClass(Form("MCTruthGenPair_%s", sig.GetName()), VarManager::fgValues);
+      VarManager::FillPairMC(t1, t2);
+      for (unsigned int isig = 0; mcDecision; isig++, mcDecision >>= 1) {
+        if (mcDecision & 1) {
+          fHistMan->FillHistClass(Form("MCTruthGenPair_%s", fGenMCSignals[isig].GetName()), VarManager::fgValues);
         }
       }
     } // end of true pairing loop
@@ -1108,24 +1112,15 @@ struct AnalysisDileptonTrack {
     // Set the global index offset to find the proper lepton
     // TO DO: remove it once the issue with lepton index is solved
     int indexOffset = -999;
-    std::vector<int> trackGlobalIndexes;
 
-    if (dileptons.size() > 0) {
-      for (auto track : tracks) {
-        trackGlobalIndexes.push_back(track.globalIndex());
-        // std::cout << track.index() << " " << track.globalIndex() << std::endl;
-      }
+    if (dileptons.size() > 0 && tracks.size() > 0) {
+      indexOffset = tracks.begin().globalIndex();
     }
     for (auto dilepton : dileptons) {
 
       int indexLepton1 = dilepton.index0Id();
       int indexLepton2 = dilepton.index1Id();
 
-      if (indexOffset == -999) {
-        indexOffset = trackGlobalIndexes.at(0);
-      }
-      trackGlobalIndexes.clear();
-
       auto lepton1 = tracks.iteratorAt(indexLepton1 - indexOffset);
       auto lepton2 = tracks.iteratorAt(indexLepton2 - indexOffset);
 
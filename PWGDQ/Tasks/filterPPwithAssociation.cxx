@@ -612,6 +612,8 @@ struct DQFilterPPTask {
       if (!o2::base::GeometryManager::isGeometryLoaded()) {
         fCCDB->get<TGeoManager>(geoPath);
       }
+      // each muon is propagated once per collision and not again for each of its pairs
+      VarManager::SetUsePropagatedMuonCache(true);
     }
     DefineCuts();
 
@@ -829,6 +831,7 @@ struct DQFilterPPTask {
   {
     fFiltersMap.clear();
     fCEFPfilters.clear();
+    VarManager::ResetPropagatedMuonCache();
 
     cout << "------------------- filterPP, n assocs barrel/muon :: " << trackAssocs.size() << " / " << muonAssocs.size() << endl;
 
@@ -601,8 +601,12 @@ struct AnalysisEventMixing {
   std::vector<std::vector<TString>> fTrackHistNames;
   std::vector<std::vector<TString>> fMuonHistNames;
   std::vector<std::vector<TString>> fTrackMuonHistNames;
+  // handles to the histogram class fill plans, same layout as the histogram names above
+  std::vector<std::vector<int>> fTrackHistHandles;
+  std::vector<std::vector<int>> fMuonHistHandles;
+  std::vector<std::vector<int>> fTrackMuonHistHandles;
 
-  NoBinningPolicy<aod::dqanalysisflags::MixingHash> hashBin;
+  MixingEventIndex fMixingIndex; // last events of each mixing category
 
   void init(o2::framework::InitContext& context)
   {
@@ -673,22 +677,34 @@ struct AnalysisEventMixing {
     DefineHistograms(fHistMan, histNames.Data(), fConfigAddEventMixingHistogram); // define all histograms
     VarManager::SetUseVars(fHistMan->GetUsedVars());                              // provide the list of required variables so that VarManager knows what to fill
     fOutputList.setObject(fHistMan->GetMainHistogramList());
+
+    // resolve the histogram class handles once, so that the pairing loops do not need any string lookup
+    auto getHandles = [&](const std::vector<std::vector<TString>>& names, std::vector<std::vector<int>>& handles) {
+      for (const auto& cutNames : names) {
+        std::vector<int> cutHandles;
+        for (const auto& name : cutNames) {
+          cutHandles.push_back(fHistMan->GetHistClassHandle(name.Data()));
+        }
+        handles.push_back(cutHandles);
+      }
+    };
+    getHandles(fTrackHistNames, fTrackHistHandles);
+    getHandles(fMuonHistNames, fMuonHistHandles);
+    getHandles(fTrackMuonHistNames, fTrackMuonHistHandles);
   }
 
   template <uint32_t TEventFillMap, int TPairType, typename TTracks1, typename TTracks2>
   void runMixedPairing(TTracks1 const& tracks1, TTracks2 const& tracks2)
   {
 
-    unsigned int ncuts = fTrackHistNames.size();
-    std::vector<std::vector<TString>> histNames = fTrackHistNames;
+    const std::vector<std::vector<int>>* histHandles = &fTrackHistHandles;
     if constexpr (TPairType == pairTypeMuMu) {
-      ncuts = fMuonHistNames.size();
-      histNames = fMuonHistNames;
+      histHandles = &fMuonHistHandles;
     }
     if constexpr (TPairType == pairTypeEMu) {
-      ncuts = fTrackMuonHistNames.size();
-      histNames = fTrackMuonHistNames;
+      histHandles = &fTrackMuonHistHandles;
     }
+    unsigned int ncuts = histHandles->size();
 
     uint32_t twoTrackFilter = 0;
     for (auto& track1 : tracks1) {
@@ -720,12 +736,12 @@ struct AnalysisEventMixing {
         for (unsigned int icut = 0; icut < ncuts; icut++) {
           if (twoTrackFilter & (uint32_t(1) << icut)) {
             if (track1.sign() * track2.sign() < 0) {
-              fHistMan->FillHistClass(histNames[icut][0].Data(), VarManager::fgValues);
+              fHistMan->FillHistClass((*histHandles)[icut][0], VarManager::fgValues);
             } else {
               if (track1.sign() > 0) {
-                fHistMan->FillHistClass(histNames[icut][1].Data(), VarManager::fgValues);
+                fHistMan->FillHistClass((*histHandles)[icut][1], VarManager::fgValues);
               } else {
-                fHistMan->FillHistClass(histNames[icut][2].Data(), VarManager::fgValues);
+                fHistMan->FillHistClass((*histHandles)[icut][2], VarManager::fgValues);
               }
             }
           } // end if (filter bits)
@@ -749,19 +765,23 @@ struct AnalysisEventMixing {
     }
 
     events.bindExternalIndices(&tracks);
-    int mixingDepth = fConfigMixingDepth.value;
-    for (auto& [event1, event2] : selfCombinations(hashBin, mixingDepth, -1, events, events)) {
-      VarManager::ResetValues(0, VarManager::kNVars);
-      VarManager::FillEvent<TEventFillMap>(event1, VarManager::fgValues);
-
-      auto tracks1 = tracks.sliceBy(preSlice, event1.globalIndex());
-      tracks1.bindExternalIndices(&events);
-
-      auto tracks2 = tracks.sliceBy(preSlice, event2.globalIndex());
-      tracks2.bindExternalIndices(&events);
-
-      VarManager::FillTwoMixEvents<TEventFillMap>(event1, event2, tracks1, tracks2);
-      runMixedPairing<TEventFillMap, TPairType>(tracks1, tracks2);
+    fMixingIndex.Reset(fConfigMixingDepth.value);
+    int64_t ievent = 0;
+    for (auto& event2 : events) {
+      fMixingIndex.MixAndAdd(event2.mixingHash(), ievent++, [&](int64_t ievent1) {
+        auto event1 = events.iteratorAt(ievent1);
+        VarManager::ResetValues(0, VarManager::kNVars);
+        VarManager::FillEvent<TEventFillMap>(event1, VarManager::fgValues);
+
+        auto tracks1 = tracks.sliceBy(preSlice, event1.globalIndex());
+        tracks1.bindExternalIndices(&events);
+
+        auto tracks2 = tracks.sliceBy(preSlice, event2.globalIndex());
+        tracks2.bindExternalIndices(&events);
+
+        VarManager::FillTwoMixEvents<TEventFillMap>(event1, event2, tracks1, tracks2);
+        runMixedPairing<TEventFillMap, TPairType>(tracks1, tracks2);
+      });
     } // end event loop
   }
 
@@ -781,17 +801,22 @@ struct AnalysisEventMixing {
 
     events.bindExternalIndices(&muons);
 
-    for (auto& [event1, event2] : selfCombinations(hashBin, 100, -1, events, events)) {
-      VarManager::ResetValues(0, VarManager::kNVars);
-      VarManager::FillEvent<TEventFillMap>(event1, VarManager::fgValues);
+    fMixingIndex.Reset(100);
+    int64_t ievent = 0;
+    for (auto& event2 : events) {
+      fMixingIndex.MixAndAdd(event2.mixingHash(), ievent++, [&](int64_t ievent1) {
+        auto event1 = events.iteratorAt(ievent1);
+        VarManager::ResetValues(0, VarManager::kNVars);
+        VarManager::FillEvent<TEventFillMap>(event1, VarManager::fgValues);
 
-      auto tracks1 = tracks.sliceBy(perEventsSelectedT, event1.globalIndex());
-      tracks1.bindExternalIndices(&events);
+        auto tracks1 = tracks.sliceBy(perEventsSelectedT, event1.globalIndex());
+        tracks1.bindExternalIndices(&events);
 
-      auto muons2 = muons.sliceBy(perEventsSelectedM, event2.globalIndex());
-      muons2.bindExternalIndices(&events);
+        auto muons2 = muons.sliceBy(perEventsSelectedM, event2.globalIndex());
+        muons2.bindExternalIndices(&events);
 
-      runMixedPairing<TEventFillMap, pairTypeEMu>(tracks1, muons2);
+        runMixedPairing<TEventFillMap, pairTypeEMu>(tracks1, muons2);
+      });
     } // end event loop
   }
 
@@ -1562,7 +1587,9 @@ struct AnalysisDileptonHadron {
   //      The current condition should be replaced when bitwise operators will become available in Filter expressions
   int fNHadronCutBit;
 
-  NoBinningPolicy<aod::dqanalysisflags::MixingHash> hashBin;
+  MixingEventIndex fMixingIndex; // last events of each mixing category
+
+  std::vector<int64_t> fHadronRows; // rows in the event of the tracks passing the hadron cut, reused across events
 
   void init(o2::framework::InitContext& context)
   {
@@ -1632,12 +1659,19 @@ struct AnalysisDileptonHadron {
     // Set the global index offset to find the proper lepton
     // TO DO: remove it once the issue with lepton index is solved
     int indexOffset = -999;
-    std::vector<int> trackGlobalIndexes;
 
+    // select the hadrons once for all the dileptons of the event
+    fHadronRows.clear();
     if (dileptons.size() > 0) {
-      for (auto track : tracks) {
-        trackGlobalIndexes.push_back(track.globalIndex());
-        // std::cout << track.index() << " " << track.globalIndex() << std::endl;
+      int64_t row = 0;
+      for (auto& track : tracks) {
+        if (indexOffset == -999) {
+          indexOffset = track.globalIndex();
+        }
+        if (uint32_t(track.isBarrelSelected()) & (uint32_t(1) << fNHadronCutBit)) {
+          fHadronRows.push_back(row);
+        }
+        ++row;
       }
     }
     // loop once over dileptons for QA purposes
@@ -1649,11 +1683,6 @@ struct AnalysisDileptonHadron {
       int indexLepton1 = dilepton.index0Id();
       int indexLepton2 = dilepton.index1Id();
 
-      if (indexOffset == -999) {
-        indexOffset = trackGlobalIndexes.at(0);
-      }
-      trackGlobalIndexes.clear();
-
       // get full track info of tracks based on the index
       auto lepton1 = tracks.iteratorAt(indexLepton1 - indexOffset);
       auto lepton2 = tracks.iteratorAt(indexLepton2 - indexOffset);
@@ -1669,10 +1698,8 @@ struct AnalysisDileptonHadron {
       }
 
       // loop over hadrons
-      for (auto& hadron : tracks) {
-        if (!(uint32_t(hadron.isBarrelSelected()) & (uint32_t(1) << fNHadronCutBit))) {
-          continue;
-        }
+      for (auto row : fHadronRows) {
+        auto hadron = tracks.iteratorAt(row);
 
         // if the hadron is either of the electron legs, continue
         int index = hadron.globalIndex();
@@ -1703,29 +1730,32 @@ struct AnalysisDileptonHadron {
     events.bindExternalIndices(&dileptons);
     events.bindExternalIndices(&tracks);
 
-    for (auto& [event1, event2] : selfCombinations(hashBin, fConfigMixingDepth.value, -1, events, events)) {
-      VarManager::ResetValues(0, VarManager::kNVars);
-      VarManager::FillEvent<gkEventFillMap>(event1, VarManager::fgValues);
+    fMixingIndex.Reset(fConfigMixingDepth.value);
+    int64_t ievent = 0;
+    for (auto& event2 : events) {
+      fMixingIndex.MixAndAdd(event2.mixingHash(), ievent++, [&](int64_t ievent1) {
+        auto event1 = events.iteratorAt(ievent1);
+        VarManager::ResetValues(0, VarManager::kNVars);
+        VarManager::FillEvent<gkEventFillMap>(event1, VarManager::fgValues);
 
-      auto evDileptons = dileptons.sliceBy(perEventPairs, event1.globalIndex());
-      evDileptons.bindExternalIndices(&events);
+        auto evDileptons = dileptons.sliceBy(perEventPairs, event1.globalIndex());
+        evDileptons.bindExternalIndices(&events);
 
-      auto evTracks = tracks.sliceBy(perEventTracks, event2.globalIndex());
-      evTracks.bindExternalIndices(&events);
+        auto evTracks = tracks.sliceBy(perEventTracks, event2.globalIndex());
+        evTracks.bindExternalIndices(&events);
 
-      for (auto dilepton : evDileptons) {
+        // hadron cut checked once per track, not for each dilepton
         for (auto& track : evTracks) {
-
           if (!(uint32_t(track.isBarrelSelected()) & (uint32_t(1) << fNHadronCutBit))) {
             continue;
           }
-
-          VarManager::FillDileptonHadron(dilepton, track, VarManager::fgValues);
-          fHistMan->FillHistClass("DileptonHadronInvMassME", VarManager::fgValues);
-          fHistMan->FillHistClass("DileptonHadronCorrelationME", VarManager::fgValues);
-        } // end for (track)
-      }   // end for (dilepton)
-
+          for (auto dilepton : evDileptons) {
+            VarManager::FillDileptonHadron(dilepton, track, VarManager::fgValues);
+            fHistMan->FillHistClass("DileptonHadronInvMassME", VarManager::fgValues);
+            fHistMan->FillHistClass("DileptonHadronCorrelationME", VarManager::fgValues);
+          } // end for (dilepton)
+        }   // end for (track)
+      });
     } // end event loop
   }
 
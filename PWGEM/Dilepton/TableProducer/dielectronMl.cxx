@@ -14,6 +14,9 @@
 /// \author Daniel Samitz, <daniel.samitz@cern.ch>, SMI Vienna
 ///         Elisa Meninno, <elisa.meninno@cern.ch>, SMI Vienna
 
+#include <algorithm>
+#include <vector>
+
 #include "Framework/AnalysisTask.h"
 #include "Framework/runDataProcessing.h"
 #include "Common/DataModel/TrackSelectionTables.h"
@@ -213,32 +216,53 @@ struct DielectronMlSingleTrack {
     return true;
   }
 
+  std::vector<float> inputFeatures;
+  std::vector<int> batchIndices; // index of each track in the batch, -1 if not preselected
+
   template <typename T>
   void runSingleTracks(T const& tracks)
   {
+    // the preselected tracks are scored in batches, one model call per pT bin
+    batchIndices.clear();
     for (const auto& track : tracks) {
       if (!applyPreSelectionCuts(track)) {
+        batchIndices.push_back(-1);
+        continue;
+      }
+      mlResponse.getInputFeatures(track, inputFeatures);
+      const int iCand = mlResponse.addToBatch(inputFeatures, track.pt());
+      if (iCand < 0) {
+        LOG(fatal) << "Track pT " << track.pt() << " outside of the pT bins of the models! Please check your configurables.";
+      }
+      batchIndices.push_back(iCand);
+    }
+    mlResponse.evaluateBatch();
+
+    std::vector<float> outputMl(nClassesMl, -1);
+    int iTrack = 0;
+    for (const auto& track : tracks) {
+      const int iCand = batchIndices[iTrack++];
+      if (iCand < 0) {
         singleTrackSelection(false);
         if (fillScoreTable) {
-          std::vector<float> outputMl(nClassesMl, -1);
+          std::fill(outputMl.begin(), outputMl.end(), -1);
           singleTrackScore(outputMl);
         }
         continue;
       }
       auto pt = track.pt();
-      std::vector<float> inputFeatures = mlResponse.getInputFeatures(track);
-      std::vector<float> outputMl = {};
-
-      bool isSelected = mlResponse.isSelectedMl(inputFeatures, pt, outputMl);
+      const float* scores = mlResponse.getBatchOutput(iCand);
+      outputMl.assign(scores, scores + nClassesMl);
       for (int classMl = 0; classMl < nClassesMl; classMl++) {
         hModelScore[classMl]->Fill(outputMl[classMl]);
         hModelScoreVsPt[classMl]->Fill(outputMl[classMl], pt);
       }
-      singleTrackSelection(isSelected);
+      singleTrackSelection(mlResponse.isSelectedMlBatch(iCand));
       if (fillScoreTable) {
         singleTrackScore(outputMl);
       }
     }
+    mlResponse.clearBatch();
   }
 
   void processSkimmedSingleTrack(MySkimmedTracksWithPID const& tracks)
@@ -309,34 +333,50 @@ struct DielectronMlPair {
     }
   }
 
-  void processPair(DielectronsExtra const& dielectrons, MySkimmedTracks const&)
+  std::vector<float> inputFeatures;
+  std::vector<int> batchIndices; // index of each unlike-sign pair in the batch
+  std::vector<float> pairMasses;
+
+  void processPair(DielectronsExtra const& dielectrons, MySkimmedTracks const& tracks)
   {
     // dummy value for magentic field. ToDo: take it from ccdb!
     float d_bz = 1.;
     mlResponse.setBz(d_bz);
+    // per-track quantities computed once, the pair features are built from them
+    mlResponse.cacheTracks(tracks);
+    batchIndices.clear();
+    pairMasses.clear();
     for (const auto& dielectron : dielectrons) {
-      const auto& track1 = dielectron.index0_as<MySkimmedTracks>();
-      const auto& track2 = dielectron.index1_as<MySkimmedTracks>();
-      if (track1.sign() == track2.sign()) {
+      const int i1 = dielectron.index0Id();
+      const int i2 = dielectron.index1Id();
+      if (tracks.rawIteratorAt(i1).sign() == tracks.rawIteratorAt(i2).sign()) {
         continue;
       }
-      ROOT::Math::PtEtaPhiMVector v1(track1.pt(), track1.eta(), track1.phi(), o2::constants::physics::MassElectron);
-      ROOT::Math::PtEtaPhiMVector v2(track2.pt(), track2.eta(), track2.phi(), o2::constants::physics::MassElectron);
-      ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
-      auto m = v12.M();
-      std::vector<float> inputFeatures = mlResponse.getInputFeatures(track1, track2);
-      std::vector<float> outputMl = {};
-
-      bool isSelected = mlResponse.isSelectedMl(inputFeatures, m, outputMl);
+      float m = mlResponse.getInputFeatures(i1, i2, inputFeatures);
+      const int iCand = mlResponse.addToBatch(inputFeatures, m);
+      if (iCand < 0) {
+        LOG(fatal) << "Pair mass " << m << " outside of the mass bins of the models! Please check your configurables.";
+      }
+      pairMasses.push_back(m);
+      batchIndices.push_back(iCand);
+    }
+    mlResponse.evaluateBatch();
+
+    std::vector<float> outputMl(nClassesMl, -1);
+    for (std::size_t iPair = 0; iPair < batchIndices.size(); iPair++) {
+      const int iCand = batchIndices[iPair];
+      const float* scores = mlResponse.getBatchOutput(iCand);
+      outputMl.assign(scores, scores + nClassesMl);
       for (int classMl = 0; classMl < nClassesMl; classMl++) {
         hModelScore[classMl]->Fill(outputMl[classMl]);
-        hModelScoreVsM[classMl]->Fill(outputMl[classMl], m);
+        hModelScoreVsM[classMl]->Fill(outputMl[classMl], pairMasses[iPair]);
       }
-      pairSelection(isSelected);
+      pairSelection(mlResponse.isSelectedMlBatch(iCand));
       if (fillScoreTable) {
         pairScore(outputMl);
       }
     }
+    mlResponse.clearBatch();
   }
   PROCESS_SWITCH(DielectronMlPair, processPair, "Apply ML selection at pair level", false);
 
@@ -13,6 +13,8 @@
 // Analysis task to produce smeared pt,eta,phi for electrons/muons in dilepton analysis
 //    Please write to: daiki.sekihata@cern.ch
 
+#include <vector>
+
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
@@ -56,27 +58,46 @@ struct ApplySmearing {
     smearer.init();
   }
 
+  // generated kinematics and smeared values of the leptons of the dataframe, for the batch smearing
+  std::vector<int> fCharges;
+  std::vector<float> fPtGen, fEtaGen, fPhiGen;
+  std::vector<float> fPtSmeared, fEtaSmeared, fPhiSmeared;
+
   template <typename TTracksMC>
   void applySmearing(TTracksMC const& tracksMC)
   {
+    fCharges.clear();
+    fPtGen.clear();
+    fEtaGen.clear();
+    fPhiGen.clear();
+    for (auto& mctrack : tracksMC) {
+      int pdgCode = mctrack.pdgCode();
+      if (abs(pdgCode) == fPdgCode) {
+        fCharges.push_back(pdgCode < 0 ? 1 : -1);
+        fPtGen.push_back(mctrack.pt());
+        fEtaGen.push_back(mctrack.eta());
+        fPhiGen.push_back(mctrack.phi());
+      }
+    }
+    // apply smearing for electrons or muons.
+    const int nLeptons = fCharges.size();
+    fPtSmeared.resize(nLeptons);
+    fEtaSmeared.resize(nLeptons);
+    fPhiSmeared.resize(nLeptons);
+    smearer.applySmearing(nLeptons, fCharges.data(), fPtGen.data(), fEtaGen.data(), fPhiGen.data(), fPtSmeared.data(), fEtaSmeared.data(), fPhiSmeared.data());
+
+    int iLepton = 0;
     for (auto& mctrack : tracksMC) {
       float ptgen = mctrack.pt();
       float etagen = mctrack.eta();
       float phigen = mctrack.phi();
       float efficiency = 1.;
 
-      int pdgCode = mctrack.pdgCode();
-      if (abs(pdgCode) == fPdgCode) {
-        int ch = -1;
-        if (pdgCode < 0) {
-          ch = 1;
-        }
-        // apply smearing for electrons or muons.
-        float ptsmeared, etasmeared, phismeared;
-        smearer.applySmearing(ch, ptgen, etagen, phigen, ptsmeared, etasmeared, phismeared);
+      if (abs(mctrack.pdgCode()) == fPdgCode) {
         // get the efficiency
         efficiency = smearer.getEfficiency(ptgen, etagen, phigen);
-        smearedtrack(ptsmeared, etasmeared, phismeared, efficiency);
+        smearedtrack(fPtSmeared[iLepton], fEtaSmeared[iLepton], fPhiSmeared[iLepton], efficiency);
+        iLepton++;
       } else {
         // don't apply smearing
         smearedtrack(ptgen, etagen, phigen, efficiency);
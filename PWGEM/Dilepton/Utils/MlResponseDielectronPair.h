@@ -88,6 +88,11 @@ class MlResponseDielectronPair : public MlResponse<TypeOutputScore>
 
   template <typename T>
   float get_phiv(T const& t1, T const& t2)
+  {
+    return get_phiv(t1.pt(), t1.eta(), t1.phi(), t1.sign(), t2.pt(), t2.eta(), t2.phi(), t2.sign());
+  }
+
+  float get_phiv(float pt1, float eta1, float phi1, int sign1, float pt2, float eta2, float phi2, int sign2)
   {
     // cos(phiv) = w*a /|w||a|
     // with w = u x v
@@ -95,8 +100,8 @@ class MlResponseDielectronPair : public MlResponse<TypeOutputScore>
     // u = v12 / |v12|            , the unit vector of v12
     // v = v1 x v2 / |v1 x v2|    , unit vector perpendicular to v1 and v2
 
-    ROOT::Math::PtEtaPhiMVector v1(t1.pt(), t1.eta(), t1.phi(), o2::constants::physics::MassElectron);
-    ROOT::Math::PtEtaPhiMVector v2(t2.pt(), t2.eta(), t2.phi(), o2::constants::physics::MassElectron);
+    ROOT::Math::PtEtaPhiMVector v1(pt1, eta1, phi1, o2::constants::physics::MassElectron);
+    ROOT::Math::PtEtaPhiMVector v2(pt2, eta2, phi2, o2::constants::physics::MassElectron);
     ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
 
     bool swapTracks = false;
@@ -110,9 +115,9 @@ class MlResponseDielectronPair : public MlResponse<TypeOutputScore>
     // momentum of e+ and e- in (ax,ay,az) axis. Note that az=0 by definition.
     // vector product of pep X pem
     float vpx = 0, vpy = 0, vpz = 0;
-    if (t1.sign() * t2.sign() > 0) { // Like Sign
+    if (sign1 * sign2 > 0) { // Like Sign
       if (!swapTracks) {
-        if (d_bz * t1.sign() < 0) {
+        if (d_bz * sign1 < 0) {
           vpx = v1.Py() * v2.Pz() - v1.Pz() * v2.Py();
           vpy = v1.Pz() * v2.Px() - v1.Px() * v2.Pz();
           vpz = v1.Px() * v2.Py() - v1.Py() * v2.Px();
@@ -122,7 +127,7 @@ class MlResponseDielectronPair : public MlResponse<TypeOutputScore>
           vpz = v2.Px() * v1.Py() - v2.Py() * v1.Px();
         }
       } else { // swaped tracks
-        if (d_bz * t2.sign() < 0) {
+        if (d_bz * sign2 < 0) {
           vpx = v1.Py() * v2.Pz() - v1.Pz() * v2.Py();
           vpy = v1.Pz() * v2.Px() - v1.Px() * v2.Pz();
           vpz = v1.Px() * v2.Py() - v1.Py() * v2.Px();
@@ -134,7 +139,7 @@ class MlResponseDielectronPair : public MlResponse<TypeOutputScore>
       }
     } else { // Unlike Sign
       if (!swapTracks) {
-        if (d_bz * t1.sign() > 0) {
+        if (d_bz * sign1 > 0) {
           vpx = v1.Py() * v2.Pz() - v1.Pz() * v2.Py();
           vpy = v1.Pz() * v2.Px() - v1.Px() * v2.Pz();
           vpz = v1.Px() * v2.Py() - v1.Py() * v2.Px();
@@ -144,7 +149,7 @@ class MlResponseDielectronPair : public MlResponse<TypeOutputScore>
           vpz = v2.Px() * v1.Py() - v2.Py() * v1.Px();
         }
       } else { // swaped tracks
-        if (d_bz * t2.sign() > 0) {
+        if (d_bz * sign2 > 0) {
           vpx = v1.Py() * v2.Pz() - v1.Pz() * v2.Py();
           vpy = v1.Pz() * v2.Px() - v1.Px() * v2.Pz();
           vpz = v1.Px() * v2.Py() - v1.Py() * v2.Px();
@@ -207,6 +212,64 @@ class MlResponseDielectronPair : public MlResponse<TypeOutputScore>
     return inputFeatures;
   }
 
+  /// Caches the per-track quantities entering the pair features, once per track of the table
+  /// \param tracks is the track table, the cached tracks are then accessed with their row index
+  template <typename T>
+  void cacheTracks(T const& tracks)
+  {
+    const auto nTracks = tracks.size();
+    for (auto* v : {&mTrackPt, &mTrackEta, &mTrackPhi, &mTrackDcaXYNorm, &mTrackDcaZNorm}) {
+      v->resize(nTracks);
+    }
+    mTrackSign.resize(nTracks);
+    int i = 0;
+    for (const auto& track : tracks) {
+      mTrackPt[i] = track.pt();
+      mTrackEta[i] = track.eta();
+      mTrackPhi[i] = track.phi();
+      mTrackSign[i] = track.sign();
+      mTrackDcaXYNorm[i] = track.dcaXY() / sqrt(track.cYY());
+      mTrackDcaZNorm[i] = track.dcaZ() / sqrt(track.cZZ());
+      i++;
+    }
+  }
+
+  /// Method to get the input features of a pair from the cached tracks (see cacheTracks())
+  /// \param i1 is the row index of the first track
+  /// \param i2 is the row index of the second track
+  /// \param inputFeatures is the vector to be filled, its allocation is kept between the pairs
+  /// \return invariant mass of the pair
+  float getInputFeatures(int i1, int i2, std::vector<float>& inputFeatures)
+  {
+    inputFeatures.clear();
+    ROOT::Math::PtEtaPhiMVector v1(mTrackPt[i1], mTrackEta[i1], mTrackPhi[i1], o2::constants::physics::MassElectron);
+    ROOT::Math::PtEtaPhiMVector v2(mTrackPt[i2], mTrackEta[i2], mTrackPhi[i2], o2::constants::physics::MassElectron);
+    ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
+
+    for (const auto& idx : MlResponse<TypeOutputScore>::mCachedIndices) {
+      switch (idx) {
+        CHECK_AND_FILL_VEC_DIELECTRON_PAIR(m, M);
+        CHECK_AND_FILL_VEC_DIELECTRON_PAIR(pt, Pt);
+        CHECK_AND_FILL_VEC_DIELECTRON_PAIR(eta, Eta);
+        CHECK_AND_FILL_VEC_DIELECTRON_PAIR(phi, Phi);
+        case static_cast<uint8_t>(InputFeaturesDielectronPair::phiv): {
+          inputFeatures.emplace_back(get_phiv(mTrackPt[i1], mTrackEta[i1], mTrackPhi[i1], mTrackSign[i1], mTrackPt[i2], mTrackEta[i2], mTrackPhi[i2], mTrackSign[i2]));
+          break;
+        }
+        case static_cast<uint8_t>(InputFeaturesDielectronPair::pairDcaXY): {
+          inputFeatures.emplace_back(sqrt((mTrackDcaXYNorm[i1] * mTrackDcaXYNorm[i1] + mTrackDcaXYNorm[i2] * mTrackDcaXYNorm[i2]) / 2.));
+          break;
+        }
+        case static_cast<uint8_t>(InputFeaturesDielectronPair::pairDcaZ): {
+          inputFeatures.emplace_back(sqrt((mTrackDcaZNorm[i1] * mTrackDcaZNorm[i1] + mTrackDcaZNorm[i2] * mTrackDcaZNorm[i2]) / 2.));
+          break;
+        }
+      }
+    }
+
+    return v12.M();
+  }
+
   void setBz(float bz)
   {
     d_bz = bz;
@@ -227,6 +290,14 @@ class MlResponseDielectronPair : public MlResponse<TypeOutputScore>
   }
 
   float d_bz = 0.;
+
+  // per-track quantities of the cached tracks, by row index
+  std::vector<float> mTrackPt;
+  std::vector<float> mTrackEta;
+  std::vector<float> mTrackPhi;
+  std::vector<int> mTrackSign;
+  std::vector<float> mTrackDcaXYNorm; // dcaXY / sqrt(cYY)
+  std::vector<float> mTrackDcaZNorm;  // dcaZ / sqrt(cZZ)
 };
 
 } // namespace o2::analysis
@@ -100,7 +100,17 @@ class MlResponseDielectronSingleTrack : public MlResponse<TypeOutputScore>
   std::vector<float> getInputFeatures(T const& track)
   {
     std::vector<float> inputFeatures;
+    getInputFeatures(track, inputFeatures);
+    return inputFeatures;
+  }
 
+  /// Method to fill the input features vector needed for ML inference, keeping its allocation
+  /// \param track is the single track
+  /// \param inputFeatures is the vector to be filled
+  template <typename T>
+  void getInputFeatures(T const& track, std::vector<float>& inputFeatures)
+  {
+    inputFeatures.clear();
     for (const auto& idx : MlResponse<TypeOutputScore>::mCachedIndices) {
       switch (idx) {
         CHECK_AND_FILL_VEC_DIELECTRON_SINGLE_TRACK(sign);
@@ -132,8 +142,6 @@ class MlResponseDielectronSingleTrack : public MlResponse<TypeOutputScore>
         CHECK_AND_FILL_VEC_DIELECTRON_SINGLE_TRACK(itsChi2NCl);
       }
     }
-
-    return inputFeatures;
   }
 
  protected:
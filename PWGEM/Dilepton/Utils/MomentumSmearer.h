@@ -16,11 +16,16 @@
 #define PWGEM_DILEPTON_UTILS_MOMENTUMSMEARER_H_
 
 #include <TH1D.h>
+#include <TH2D.h>
 #include <TString.h>
 #include <TGrid.h>
 #include <TObjArray.h>
 #include <TFile.h>
+#include <TRandom.h>
+#include <algorithm>
+#include <vector>
 #include "Framework/Logger.h"
+#include "Common/Core/CounterRng.h"
 
 class MomentumSmearer
 {
@@ -110,6 +115,12 @@ class MomentumSmearer
       fArrResoPhi_Pos = ArrResoPhi_Pos;
       fArrResoPhi_Neg = ArrResoPhi_Neg;
       fFile->Close();
+
+      // flat inverse-CDF tables of the resolution slices, the pT bin of phi is taken from the map of the positive tracks for both charges
+      fTablePt.build(fArrResoPt, fArrResoPt);
+      fTableEta.build(fArrResoEta, fArrResoEta);
+      fTablePhi_Pos.build(fArrResoPhi_Pos, fArrResoPhi_Pos);
+      fTablePhi_Neg.build(fArrResoPhi_Neg, fArrResoPhi_Pos);
     }
 
     // get efficiency histo
@@ -147,53 +158,27 @@ class MomentumSmearer
   void applySmearing(const int ch, const float ptgen, const float etagen, const float phigen, float& ptsmeared, float& etasmeared, float& phismeared)
   {
     // smear pt
-    int ptbin = reinterpret_cast<TH2D*>(fArrResoPt->At(0))->GetXaxis()->FindBin(ptgen);
-    if (ptbin < 1) {
-      ptbin = 1;
-    }
-    if (ptbin > fArrResoPt->GetLast()) {
-      ptbin = fArrResoPt->GetLast();
-    }
-    float smearing = 0.;
-    TH1D* thisHist = reinterpret_cast<TH1D*>(fArrResoPt->At(ptbin));
-    if (thisHist->GetEntries() > 0) {
-      smearing = thisHist->GetRandom() * ptgen;
-    }
-    ptsmeared = ptgen - smearing;
-
+    ptsmeared = ptgen - fTablePt.getRandom(ptgen) * ptgen;
     // smear eta
-    ptbin = reinterpret_cast<TH2D*>(fArrResoEta->At(0))->GetXaxis()->FindBin(ptgen);
-    if (ptbin < 1) {
-      ptbin = 1;
-    }
-    if (ptbin > fArrResoEta->GetLast()) {
-      ptbin = fArrResoEta->GetLast();
-    }
-    smearing = 0.;
-    thisHist = reinterpret_cast<TH1D*>(fArrResoEta->At(ptbin));
-    if (thisHist->GetEntries() > 0) {
-      smearing = thisHist->GetRandom();
-    }
-    etasmeared = etagen - smearing;
-
+    etasmeared = etagen - fTableEta.getRandom(ptgen);
     // smear phi
-    ptbin = reinterpret_cast<TH2D*>(fArrResoPhi_Pos->At(0))->GetXaxis()->FindBin(ptgen);
-    if (ptbin < 1) {
-      ptbin = 1;
-    }
-    if (ptbin > fArrResoPhi_Pos->GetLast()) {
-      ptbin = fArrResoPhi_Pos->GetLast();
-    }
-    smearing = 0.;
-    if (ch < 0) {
-      thisHist = reinterpret_cast<TH1D*>(fArrResoPhi_Neg->At(ptbin));
-    } else {
-      thisHist = reinterpret_cast<TH1D*>(fArrResoPhi_Pos->At(ptbin));
-    }
-    if (thisHist->GetEntries() > 0) {
-      smearing = thisHist->GetRandom();
+    phismeared = phigen - (ch < 0 ? fTablePhi_Neg : fTablePhi_Pos).getRandom(ptgen);
+  }
+
+  /// Same with the random numbers of the stream of the track, independent of the order in which the tracks are smeared
+  void applySmearing(const int ch, const float ptgen, const float etagen, const float phigen, float& ptsmeared, float& etasmeared, float& phismeared, CounterRng& rng)
+  {
+    ptsmeared = ptgen - fTablePt.getRandom(ptgen, rng) * ptgen;
+    etasmeared = etagen - fTableEta.getRandom(ptgen, rng);
+    phismeared = phigen - (ch < 0 ? fTablePhi_Neg : fTablePhi_Pos).getRandom(ptgen, rng);
+  }
+
+  /// Smearing of n tracks given as arrays, the random numbers are drawn in the same order as for the tracks one by one
+  void applySmearing(const int n, const int* ch, const float* ptgen, const float* etagen, const float* phigen, float* ptsmeared, float* etasmeared, float* phismeared)
+  {
+    for (int i = 0; i < n; i++) {
+      applySmearing(ch[i], ptgen[i], etagen[i], phigen[i], ptsmeared[i], etasmeared[i], phismeared[i]);
     }
-    phismeared = phigen - smearing;
   }
 
   float getEfficiency(float pt, float eta, float phi)
@@ -284,6 +269,87 @@ class MomentumSmearer
   TObject* getArrEff() { return fArrEff; }
 
  private:
+  /// Inverse-CDF tables of the resolution slices of a map
+  /// (TObjArray with a TH2D giving the pT binning at 0 and the TH1D of the pT bin i at i),
+  /// sampled as TH1::GetRandom(): one uniform number, a binary search in the cumulative and a linear interpolation in the bin
+  class SmearingTable
+  {
+   public:
+    void build(const TObjArray* arr, const TObjArray* axisArr)
+    {
+      const TAxis* axis = reinterpret_cast<TH2D*>(axisArr->At(0))->GetXaxis();
+      fPtEdges.resize(axis->GetNbins() + 1);
+      for (int i = 0; i <= axis->GetNbins(); i++) {
+        fPtEdges[i] = axis->GetBinLowEdge(i + 1);
+      }
+      fNSlices = arr->GetLast();
+      fOffsets.assign(fNSlices + 2, 0);
+      fCdf.clear();
+      fEdges.clear();
+      for (int slice = 1; slice <= fNSlices; slice++) {
+        fOffsets[slice] = fCdf.size();
+        TH1D* h = reinterpret_cast<TH1D*>(arr->At(slice));
+        if (h == nullptr || h->GetEntries() <= 0 || h->ComputeIntegral() <= 0) {
+          continue; // no smearing
+        }
+        const double* integral = h->GetIntegral();
+        for (int bin = 0; bin <= h->GetNbinsX(); bin++) {
+          fCdf.push_back(integral[bin]);
+          fEdges.push_back(h->GetXaxis()->GetBinLowEdge(bin + 1));
+        }
+      }
+      fOffsets[fNSlices + 1] = fCdf.size();
+    }
+
+    /// Slice of the pT (ROOT bin number of the pT axis, limited to the slices of the map)
+    int findSlice(float pt) const
+    {
+      const int bin = std::upper_bound(fPtEdges.begin(), fPtEdges.end(), pt) - fPtEdges.begin();
+      return std::clamp(bin, 1, std::max(fNSlices, 1));
+    }
+
+    /// Random smearing for the pT, 0 (without drawing a random number) if the slice is empty
+    double getRandom(float pt) const
+    {
+      return drawRandom(pt, [] { return gRandom->Rndm(); });
+    }
+
+    /// Same with a random number of the stream rng
+    double getRandom(float pt, CounterRng& rng) const
+    {
+      return drawRandom(pt, [&rng] { return rng.uniform(); });
+    }
+
+   private:
+    template <typename TUniform>
+    double drawRandom(float pt, TUniform&& uniform) const
+    {
+      const int slice = findSlice(pt);
+      if (slice > fNSlices) {
+        return 0.;
+      }
+      const double* cdf = fCdf.data() + fOffsets[slice];
+      const double* edges = fEdges.data() + fOffsets[slice];
+      const int nBins = fOffsets[slice + 1] - fOffsets[slice] - 1;
+      if (nBins < 1) {
+        return 0.;
+      }
+      const double r = uniform();
+      const int bin = std::max(static_cast<int>(std::upper_bound(cdf, cdf + nBins, r) - cdf) - 1, 0);
+      double x = edges[bin];
+      if (r > cdf[bin]) {
+        x += (edges[bin + 1] - edges[bin]) * (r - cdf[bin]) / (cdf[bin + 1] - cdf[bin]);
+      }
+      return x;
+    }
+
+    std::vector<double> fPtEdges; // pT bin edges of the map
+    int fNSlices = 0;
+    std::vector<int> fOffsets;  // range [fOffsets[i], fOffsets[i + 1]) of slice i in fCdf and fEdges
+    std::vector<double> fCdf;   // normalised cumulative of the slices, nBins + 1 values starting with 0
+    std::vector<double> fEdges; // bin edges of the slices
+  };
+
   bool fInitialized = false;
   TString fResFileName;
   TString fResPtHistName;
@@ -298,6 +364,10 @@ class MomentumSmearer
   TObjArray* fArrResoPhi_Pos;
   TObjArray* fArrResoPhi_Neg;
   TObject* fArrEff;
+  SmearingTable fTablePt;
+  SmearingTable fTableEta;
+  SmearingTable fTablePhi_Pos;
+  SmearingTable fTablePhi_Neg;
 };
 
 #endif // PWGEM_DILEPTON_UTILS_MOMENTUMSMEARER_H_
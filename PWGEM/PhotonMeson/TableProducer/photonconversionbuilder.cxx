@@ -20,7 +20,10 @@
 #include <cstdlib>
 #include <map>
 #include <iterator>
+#include <set>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "Math/Vector4D.h"
 
@@ -298,7 +301,7 @@ struct PhotonConversionBuilder {
     return true;
   }
 
-  float cospaXY_KF(KFParticle kfp, KFParticle PV)
+  float cospaXY_KF(KFParticle const& kfp, KFParticle const& PV)
   {
     float lx = kfp.GetX() - PV.GetX(); // flight length X
     float ly = kfp.GetY() - PV.GetY(); // flight length Y
@@ -314,7 +317,7 @@ struct PhotonConversionBuilder {
     return cospaXY;
   }
 
-  float cospaRZ_KF(KFParticle kfp, KFParticle PV)
+  float cospaRZ_KF(KFParticle const& kfp, KFParticle const& PV)
   {
     float lx = kfp.GetX() - PV.GetX();              // flight length X
     float ly = kfp.GetY() - PV.GetY();              // flight length Y
@@ -623,7 +626,9 @@ struct PhotonConversionBuilder {
   Preslice<aod::V0s> perCollision = o2::aod::v0::collisionId;
   std::map<std::tuple<int64_t, int64_t, int64_t, int64_t>, float> pca_map;   //(v0.globalIndex(), collision.globalIndex(), pos.globalIndex(), ele.globalIndex()) -> pca
   std::map<std::tuple<int64_t, int64_t, int64_t, int64_t>, float> cospa_map; //(v0.globalIndex(), collision.globalIndex(), pos.globalIndex(), ele.globalIndex()) -> cospa
-  std::vector<std::pair<int64_t, int64_t>> stored_v0Ids;                     //(pos.globalIndex(), ele.globalIndex())
+  std::unordered_map<int64_t, std::vector<decltype(pca_map)::const_iterator>> v0s_per_pos; // pos.globalIndex() -> v0s in pca_map with this positive leg
+  std::unordered_map<int64_t, std::vector<decltype(pca_map)::const_iterator>> v0s_per_ele; // ele.globalIndex() -> v0s in pca_map with this negative leg
+  std::set<std::pair<int64_t, int64_t>> stored_v0Ids;                                       //(pos.globalIndex(), ele.globalIndex())
 
   template <bool isMC, typename TCollisions, typename TV0s, typename TTracks, typename TBCs>
   void build(TCollisions const& collisions, TV0s const& v0s, TTracks const& /*tracks*/, TBCs const&)
@@ -647,7 +652,11 @@ struct PhotonConversionBuilder {
       } // end of v0 loop
     }   // end of collision loop
 
-    stored_v0Ids.reserve(pca_map.size()); // number of photon candidates per DF
+    // only the candidates sharing a leg compete with each other below, so they are grouped by leg
+    for (auto it = pca_map.cbegin(); it != pca_map.cend(); ++it) {
+      v0s_per_pos[std::get<2>(it->first)].push_back(it);
+      v0s_per_ele[std::get<3>(it->first)].push_back(it);
+    }
 
     // find minimal pca
     for (const auto& [key, value] : pca_map) {
@@ -656,36 +665,39 @@ struct PhotonConversionBuilder {
       auto posId = std::get<2>(key);
       auto eleId = std::get<3>(key);
       float v0pca = value;
-      float cospa = cospa_map[key];
+      float cospa = cospa_map.at(key);
       bool is_closest_v0 = true;
       bool is_most_aligned_v0 = true;
 
-      for (const auto& [key_tmp, value_tmp] : pca_map) {
-        auto v0Id_tmp = std::get<0>(key_tmp);
-        auto collisionId_tmp = std::get<1>(key_tmp);
-        auto posId_tmp = std::get<2>(key_tmp);
-        auto eleId_tmp = std::get<3>(key_tmp);
-        float v0pca_tmp = value_tmp;
-        float cospa_tmp = cospa_map[key_tmp];
-
-        if (v0Id == v0Id_tmp) { // skip exactly the same v0
-          continue;
-        }
+      for (const auto* v0s_sharing_leg : {&v0s_per_pos[posId], &v0s_per_ele[eleId]}) {
+        for (const auto& it_tmp : *v0s_sharing_leg) {
+          const auto& key_tmp = it_tmp->first;
+          auto v0Id_tmp = std::get<0>(key_tmp);
+          auto collisionId_tmp = std::get<1>(key_tmp);
+          auto posId_tmp = std::get<2>(key_tmp);
+          auto eleId_tmp = std::get<3>(key_tmp);
+          float v0pca_tmp = it_tmp->second;
+
+          if (v0Id == v0Id_tmp) { // skip exactly the same v0
+            continue;
+          }
 
-        if (collisionId != collisionId_tmp && eleId == eleId_tmp && posId == posId_tmp && cospa < cospa_tmp) { // same ele and pos, but attached to different collision
-          // LOGF(info, "!reject! | collision id = %d | posid1 = %d , eleid1 = %d , posid2 = %d , eleid2 = %d , cospa1 = %f , cospa2 = %f", collisionId, posId, eleId, posId_tmp, eleId_tmp, cospa, cospa_tmp);
-          is_most_aligned_v0 = false;
-          break;
-        }
+          if (collisionId != collisionId_tmp && eleId == eleId_tmp && posId == posId_tmp && cospa < cospa_map.at(key_tmp)) { // same ele and pos, but attached to different collision
+            is_most_aligned_v0 = false;
+            break;
+          }
 
-        if ((eleId == eleId_tmp || posId == posId_tmp) && v0pca > v0pca_tmp) {
-          // LOGF(info, "!reject! | collision id = %d | posid1 = %d , eleid1 = %d , posid2 = %d , eleid2 = %d , pca1 = %f , pca2 = %f", collisionId, posId, eleId, posId_tmp, eleId_tmp, v0pca, v0pca_tmp);
-          is_closest_v0 = false;
+          if ((eleId == eleId_tmp || posId == posId_tmp) && v0pca > v0pca_tmp) {
+            is_closest_v0 = false;
+            break;
+          }
+        } // end of loop over the v0s sharing a leg
+        if (!is_closest_v0 || !is_most_aligned_v0) {
           break;
         }
-      } // end of pca_map tmp loop
+      }
 
-      bool is_stored = std::find(stored_v0Ids.begin(), stored_v0Ids.end(), std::make_pair(posId, eleId)) != stored_v0Ids.end();
+      bool is_stored = stored_v0Ids.find(std::make_pair(posId, eleId)) != stored_v0Ids.end();
       if (is_closest_v0 && is_most_aligned_v0 && !is_stored) {
         auto v0 = v0s.rawIteratorAt(v0Id);
         // auto collision = collisions.rawIteratorAt(collisionId);
@@ -693,14 +705,15 @@ struct PhotonConversionBuilder {
         // auto ele = tracks.rawIteratorAt(eleId);
         // LOGF(info, "!accept! | collision id = %d | v0id1 = %d , posid1 = %d , eleid1 = %d , pca1 = %f , cospa = %f", collisionId, v0Id, posId, eleId, v0pca, cospa);
         fillV0Table<isMC, TCollisions, TTracks>(v0, true);
-        stored_v0Ids.emplace_back(std::make_pair(posId, eleId));
+        stored_v0Ids.emplace(posId, eleId);
       }
     } // end of pca_map loop
     // LOGF(info, "pca_map.size() = %d", pca_map.size());
     pca_map.clear();
     cospa_map.clear();
+    v0s_per_pos.clear();
+    v0s_per_ele.clear();
     stored_v0Ids.clear();
-    stored_v0Ids.shrink_to_fit();
   } // end of build
 
   //! type of V0. 0: built solely for cascades (does not pass standard V0 cuts), 1: standard 2, 3: photon-like with TPC-only use. Regular analysis should always use type 1 or 3.
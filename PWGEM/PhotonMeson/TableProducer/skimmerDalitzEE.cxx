@@ -12,6 +12,8 @@
 /// \brief write relevant information for dalitz ee analysis to an AO2D.root file. This file is then the only necessary input to perform pcm analysis.
 /// \author daiki.sekihata@cern.ch
 
+#include <vector>
+
 #include "Math/Vector4D.h"
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
@@ -191,64 +193,68 @@ struct skimmerDalitzEE {
     return minTPCNsigmaEl < track.tpcNSigmaEl() && track.tpcNSigmaEl() < maxTPCNsigmaEl && abs(track.tofNSigmaEl()) < maxTOFNsigmaEl;
   }
 
-  template <EM_EEPairType pairtype, bool isCEFP, typename TCollision, typename TTracks1, typename TTracks2>
-  int fillPairTable(TCollision const& collision, TTracks1 const& tracks1, TTracks2 const& tracks2)
+  struct Lepton {
+    int64_t globalIndex;
+    int8_t sign;
+    float px;
+    float py;
+    float pz;
+    ROOT::Math::PxPyPzEVector v; // as from PtEtaPhiMVector(pt, eta, phi, MassElectron)
+  };
+  std::vector<Lepton> posLeptons; // selected tracks of the current collision, per charge
+  std::vector<Lepton> negLeptons;
+
+  // the track selection is applied once per track instead of once per pair
+  template <typename TTracks>
+  void fillLeptons(TTracks const& tracks, std::vector<Lepton>& leptons)
+  {
+    leptons.clear();
+    for (auto& track : tracks) {
+      if (!checkTrack(track)) {
+        continue;
+      }
+      ROOT::Math::PtEtaPhiMVector v(track.pt(), track.eta(), track.phi(), o2::constants::physics::MassElectron);
+      leptons.push_back({track.globalIndex(), track.sign(), track.px(), track.py(), track.pz(), ROOT::Math::PxPyPzEVector(v)});
+    }
+  }
+
+  template <EM_EEPairType pairtype, bool isCEFP, typename TCollision>
+  bool fillPair(TCollision const& collision, Lepton const& t1, Lepton const& t2)
+  {
+    ROOT::Math::PxPyPzEVector v12 = t1.v + t2.v;
+    if (v12.M() > maxMee) { // don't store
+      return false;
+    }
+    float phiv = getPhivPair(t1.px, t1.py, t1.pz, t2.px, t2.py, t2.pz, t1.sign, t2.sign, collision.bz());
+    float opangle = getOpeningAngle(t1.px, t1.py, t1.pz, t2.px, t2.py, t2.pz);
+
+    if constexpr (isCEFP) {
+      dalitzees(collision.globalIndex(), t1.globalIndex, t2.globalIndex, v12.Pt(), v12.Eta(), v12.Phi() > 0 ? v12.Phi() : v12.Phi() + TMath::TwoPi(), v12.M(), v12.Rapidity(), phiv, opangle, static_cast<int>(pairtype));
+      dalitz_ee_eventid(collision.globalIndex());
+    } else { // for analysis
+      dalitzees(collision.collisionId(), t1.globalIndex, t2.globalIndex, v12.Pt(), v12.Eta(), v12.Phi() > 0 ? v12.Phi() : v12.Phi() + TMath::TwoPi(), v12.M(), v12.Rapidity(), phiv, opangle, static_cast<int>(pairtype));
+      dalitz_ee_eventid(collision.globalIndex());
+    }
+
+    fRegistry.fill(HIST("hNpairs"), static_cast<int>(pairtype));
+    return true;
+  }
+
+  template <EM_EEPairType pairtype, bool isCEFP, typename TCollision>
+  int fillPairTable(TCollision const& collision, std::vector<Lepton> const& leptons1, std::vector<Lepton> const& leptons2)
   {
     int npair = 0;
     if constexpr (pairtype == EM_EEPairType::kULS) { // ULS
-      for (auto& [t1, t2] : combinations(CombinationsFullIndexPolicy(tracks1, tracks2))) {
-        if (!checkTrack(t1) || !checkTrack(t2)) {
-          continue;
-        }
-
-        ROOT::Math::PtEtaPhiMVector v1(t1.pt(), t1.eta(), t1.phi(), o2::constants::physics::MassElectron);
-        ROOT::Math::PtEtaPhiMVector v2(t2.pt(), t2.eta(), t2.phi(), o2::constants::physics::MassElectron);
-        ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
-        if (v12.M() > maxMee) { // don't store
-          continue;
-        }
-        float phiv = getPhivPair(t1.px(), t1.py(), t1.pz(), t2.px(), t2.py(), t2.pz(), t1.sign(), t2.sign(), collision.bz());
-        float opangle = getOpeningAngle(t1.px(), t1.py(), t1.pz(), t2.px(), t2.py(), t2.pz());
-
-        // if (!std::isfinite(phiv)) {
-        //   LOGF(info, "t1.px() = %f, t1.py() = %f, t1.pz() = %f, t2.px() = %f, t2.py() = %f, t2.pz() = %f", t1.px(), t1.py(), t1.pz(), t2.px(), t2.py(), t2.pz());
-        // }
-
-        if constexpr (isCEFP) {
-          dalitzees(collision.globalIndex(), t1.globalIndex(), t2.globalIndex(), v12.Pt(), v12.Eta(), v12.Phi() > 0 ? v12.Phi() : v12.Phi() + TMath::TwoPi(), v12.M(), v12.Rapidity(), phiv, opangle, static_cast<int>(pairtype));
-          dalitz_ee_eventid(collision.globalIndex());
-        } else { // for analysis
-          dalitzees(collision.collisionId(), t1.globalIndex(), t2.globalIndex(), v12.Pt(), v12.Eta(), v12.Phi() > 0 ? v12.Phi() : v12.Phi() + TMath::TwoPi(), v12.M(), v12.Rapidity(), phiv, opangle, static_cast<int>(pairtype));
-          dalitz_ee_eventid(collision.globalIndex());
+      for (auto& t1 : leptons1) {
+        for (auto& t2 : leptons2) {
+          npair += fillPair<pairtype, isCEFP>(collision, t1, t2);
         }
-
-        fRegistry.fill(HIST("hNpairs"), static_cast<int>(pairtype));
-        npair++;
       }      // end of pairing loop
-    } else { // LS
-      for (auto& [t1, t2] : combinations(CombinationsStrictlyUpperIndexPolicy(tracks1, tracks2))) {
-        if (!checkTrack(t1) || !checkTrack(t2)) {
-          continue;
-        }
-        ROOT::Math::PtEtaPhiMVector v1(t1.pt(), t1.eta(), t1.phi(), o2::constants::physics::MassElectron);
-        ROOT::Math::PtEtaPhiMVector v2(t2.pt(), t2.eta(), t2.phi(), o2::constants::physics::MassElectron);
-        ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
-        if (v12.M() > maxMee) { // don't store
-          continue;
-        }
-        float phiv = getPhivPair(t1.px(), t1.py(), t1.pz(), t2.px(), t2.py(), t2.pz(), t1.sign(), t2.sign(), collision.bz());
-        float opangle = getOpeningAngle(t1.px(), t1.py(), t1.pz(), t2.px(), t2.py(), t2.pz());
-
-        if constexpr (isCEFP) {
-          dalitzees(collision.globalIndex(), t1.globalIndex(), t2.globalIndex(), v12.Pt(), v12.Eta(), v12.Phi() > 0 ? v12.Phi() : v12.Phi() + TMath::TwoPi(), v12.M(), v12.M(), phiv, opangle, static_cast<int>(pairtype));
-          dalitz_ee_eventid(collision.globalIndex());
-        } else { // for analysis
-          dalitzees(collision.collisionId(), t1.globalIndex(), t2.globalIndex(), v12.Pt(), v12.Eta(), v12.Phi() > 0 ? v12.Phi() : v12.Phi() + TMath::TwoPi(), v12.M(), v12.Rapidity(), phiv, opangle, static_cast<int>(pairtype));
-          dalitz_ee_eventid(collision.globalIndex());
+    } else { // LS, leptons1 and leptons2 are the same pool
+      for (size_t i1 = 0; i1 < leptons1.size(); i1++) {
+        for (size_t i2 = i1 + 1; i2 < leptons2.size(); i2++) {
+          npair += fillPair<pairtype, isCEFP>(collision, leptons1[i1], leptons2[i2]);
         }
-
-        fRegistry.fill(HIST("hNpairs"), static_cast<int>(pairtype));
-        npair++;
       } // end of pairing loop
     }
     return npair;
@@ -271,11 +277,14 @@ struct skimmerDalitzEE {
       fRegistry.fill(HIST("hNele"), collision.centFT0C(), negTracks_per_coll.size());
       // LOGF(info, "collision.centFT0C() = %f, posTracks_per_coll.size() = %d, negTracks_per_coll.size() = %d", collision.centFT0C() , posTracks_per_coll.size(), negTracks_per_coll.size());
 
+      fillLeptons(posTracks_per_coll, posLeptons);
+      fillLeptons(negTracks_per_coll, negLeptons);
+
       int npair_uls = 0, npair_lspp = 0, npair_lsmm = 0;
-      npair_uls = fillPairTable<EM_EEPairType::kULS, false>(collision, posTracks_per_coll, negTracks_per_coll); // ULS
+      npair_uls = fillPairTable<EM_EEPairType::kULS, false>(collision, posLeptons, negLeptons); // ULS
       if (storeLS) {
-        npair_lspp = fillPairTable<EM_EEPairType::kLSpp, false>(collision, posTracks_per_coll, posTracks_per_coll); // LS++
-        npair_lsmm = fillPairTable<EM_EEPairType::kLSmm, false>(collision, negTracks_per_coll, negTracks_per_coll); // LS--
+        npair_lspp = fillPairTable<EM_EEPairType::kLSpp, false>(collision, posLeptons, posLeptons); // LS++
+        npair_lsmm = fillPairTable<EM_EEPairType::kLSmm, false>(collision, negLeptons, negLeptons); // LS--
       }
       event_nee(npair_uls, npair_lspp, npair_lsmm);
     } // end of collision loop
@@ -290,11 +299,14 @@ struct skimmerDalitzEE {
       auto posTracks_per_coll = posTracks_cefp->sliceByCachedUnsorted(o2::aod::emprimaryelectron::collisionId, collision.globalIndex(), cache_cefp);
       auto negTracks_per_coll = negTracks_cefp->sliceByCachedUnsorted(o2::aod::emprimaryelectron::collisionId, collision.globalIndex(), cache_cefp);
 
+      fillLeptons(posTracks_per_coll, posLeptons);
+      fillLeptons(negTracks_per_coll, negLeptons);
+
       int npair_uls = 0, npair_lspp = 0, npair_lsmm = 0;
-      npair_uls = fillPairTable<EM_EEPairType::kULS, true>(collision, posTracks_per_coll, negTracks_per_coll); // ULS
+      npair_uls = fillPairTable<EM_EEPairType::kULS, true>(collision, posLeptons, negLeptons); // ULS
       if (storeLS) {
-        npair_lspp = fillPairTable<EM_EEPairType::kLSpp, true>(collision, posTracks_per_coll, posTracks_per_coll); // LS++
-        npair_lsmm = fillPairTable<EM_EEPairType::kLSmm, true>(collision, negTracks_per_coll, negTracks_per_coll); // LS--
+        npair_lspp = fillPairTable<EM_EEPairType::kLSpp, true>(collision, posLeptons, posLeptons); // LS++
+        npair_lsmm = fillPairTable<EM_EEPairType::kLSmm, true>(collision, negLeptons, negLeptons); // LS--
       }
       event_nee(npair_uls, npair_lspp, npair_lsmm);
     } // end of collision loop
@@ -12,6 +12,8 @@
 /// \brief write relevant information for dalitz mumu analysis to an AO2D.root file. This file is then the only necessary input to perform pcm analysis.
 /// \author daiki.sekihata@cern.ch
 
+#include <vector>
+
 #include "Math/Vector4D.h"
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
@@ -126,43 +128,57 @@ struct skimmerDalitzMuMu {
     return true;
   }
 
-  template <EM_MuMuPairType pairtype, typename TCollision, typename TTracks1, typename TTracks2>
-  int fillPairTable(TCollision const& collision, TTracks1 const& tracks1, TTracks2 const& tracks2)
+  struct Lepton {
+    int64_t globalIndex;
+    ROOT::Math::PxPyPzEVector v; // as from PtEtaPhiMVector(pt, eta, phi, MassMuon)
+  };
+  std::vector<Lepton> posLeptons; // selected tracks of the current collision, per charge
+  std::vector<Lepton> negLeptons;
+
+  // the track selection is applied once per track instead of once per pair
+  template <typename TTracks>
+  void fillLeptons(TTracks const& tracks, std::vector<Lepton>& leptons)
+  {
+    leptons.clear();
+    for (auto& track : tracks) {
+      if (!checkTrack(track)) {
+        continue;
+      }
+      ROOT::Math::PtEtaPhiMVector v(track.pt(), track.eta(), track.phi(), o2::constants::physics::MassMuon);
+      leptons.push_back({track.globalIndex(), ROOT::Math::PxPyPzEVector(v)});
+    }
+  }
+
+  template <EM_MuMuPairType pairtype, typename TCollision>
+  bool fillPair(TCollision const& collision, Lepton const& t1, Lepton const& t2)
   {
-    int npair = 0;
     const float phiv = 0.f;
     const float opangle = 0.f;
+    ROOT::Math::PxPyPzEVector v12 = t1.v + t2.v;
+    if (v12.M() > maxMmumu) { // don't store
+      return false;
+    }
+    dalitzmumus(collision.collisionId(), t1.globalIndex, t2.globalIndex, v12.Pt(), v12.Eta(), v12.Phi() > 0 ? v12.Phi() : v12.Phi() + TMath::TwoPi(), v12.M(), v12.Rapidity(), phiv, opangle, static_cast<int>(pairtype));
+    dalitz_mumu_eventid(collision.globalIndex());
+    fRegistry.fill(HIST("hNpairs"), static_cast<int>(pairtype));
+    return true;
+  }
+
+  template <EM_MuMuPairType pairtype, typename TCollision>
+  int fillPairTable(TCollision const& collision, std::vector<Lepton> const& leptons1, std::vector<Lepton> const& leptons2)
+  {
+    int npair = 0;
     if constexpr (pairtype == EM_MuMuPairType::kULS) { // ULS
-      for (auto& [t1, t2] : combinations(CombinationsFullIndexPolicy(tracks1, tracks2))) {
-        if (!checkTrack(t1) || !checkTrack(t2)) {
-          continue;
-        }
-        ROOT::Math::PtEtaPhiMVector v1(t1.pt(), t1.eta(), t1.phi(), o2::constants::physics::MassMuon);
-        ROOT::Math::PtEtaPhiMVector v2(t2.pt(), t2.eta(), t2.phi(), o2::constants::physics::MassMuon);
-        ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
-        if (v12.M() > maxMmumu) { // don't store
-          continue;
+      for (auto& t1 : leptons1) {
+        for (auto& t2 : leptons2) {
+          npair += fillPair<pairtype>(collision, t1, t2);
         }
-        dalitzmumus(collision.collisionId(), t1.globalIndex(), t2.globalIndex(), v12.Pt(), v12.Eta(), v12.Phi() > 0 ? v12.Phi() : v12.Phi() + TMath::TwoPi(), v12.M(), v12.Rapidity(), phiv, opangle, static_cast<int>(pairtype));
-        dalitz_mumu_eventid(collision.globalIndex());
-        fRegistry.fill(HIST("hNpairs"), static_cast<int>(pairtype));
-        npair++;
       }      // end of pairing loop
-    } else { // LS
-      for (auto& [t1, t2] : combinations(CombinationsStrictlyUpperIndexPolicy(tracks1, tracks2))) {
-        if (!checkTrack(t1) || !checkTrack(t2)) {
-          continue;
+    } else { // LS, leptons1 and leptons2 are the same pool
+      for (size_t i1 = 0; i1 < leptons1.size(); i1++) {
+        for (size_t i2 = i1 + 1; i2 < leptons2.size(); i2++) {
+          npair += fillPair<pairtype>(collision, leptons1[i1], leptons2[i2]);
         }
-        ROOT::Math::PtEtaPhiMVector v1(t1.pt(), t1.eta(), t1.phi(), o2::constants::physics::MassMuon);
-        ROOT::Math::PtEtaPhiMVector v2(t2.pt(), t2.eta(), t2.phi(), o2::constants::physics::MassMuon);
-        ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
-        if (v12.M() > maxMmumu) { // don't store
-          continue;
-        }
-        dalitzmumus(collision.collisionId(), t1.globalIndex(), t2.globalIndex(), v12.Pt(), v12.Eta(), v12.Phi() > 0 ? v12.Phi() : v12.Phi() + TMath::TwoPi(), v12.M(), v12.Rapidity(), phiv, opangle, static_cast<int>(pairtype));
-        dalitz_mumu_eventid(collision.globalIndex());
-        fRegistry.fill(HIST("hNpairs"), static_cast<int>(pairtype));
-        npair++;
       } // end of pairing loop
     }
     return npair;
@@ -182,11 +198,14 @@ struct skimmerDalitzMuMu {
       auto posTracks_per_coll = posTracks->sliceByCached(o2::aod::emprimarymuon::emeventId, collision.globalIndex(), cache);
       auto negTracks_per_coll = negTracks->sliceByCached(o2::aod::emprimarymuon::emeventId, collision.globalIndex(), cache);
 
+      fillLeptons(posTracks_per_coll, posLeptons);
+      fillLeptons(negTracks_per_coll, negLeptons);
+
       int npair_uls = 0, npair_lspp = 0, npair_lsmm = 0;
-      npair_uls = fillPairTable<EM_MuMuPairType::kULS>(collision, posTracks_per_coll, negTracks_per_coll); // ULS
+      npair_uls = fillPairTable<EM_MuMuPairType::kULS>(collision, posLeptons, negLeptons); // ULS
       if (storeLS) {
-        npair_lspp = fillPairTable<EM_MuMuPairType::kLSpp>(collision, posTracks_per_coll, posTracks_per_coll); // LS++
-        npair_lsmm = fillPairTable<EM_MuMuPairType::kLSmm>(collision, negTracks_per_coll, negTracks_per_coll); // LS--
+        npair_lspp = fillPairTable<EM_MuMuPairType::kLSpp>(collision, posLeptons, posLeptons); // LS++
+        npair_lsmm = fillPairTable<EM_MuMuPairType::kLSmm>(collision, negLeptons, negLeptons); // LS--
       }
       event_nmumu(npair_uls, npair_lspp, npair_lsmm);
     } // end of collision loop
@@ -32,7 +32,6 @@ using namespace o2::framework::expressions;
 struct skimmerGammaCalo {
 
   Preslice<o2::aod::EMCALClusterCells> CellperCluster = o2::aod::emcalclustercell::emcalclusterId;
-  Preslice<o2::aod::EMCALMatchedTracks> MTperCluster = o2::aod::emcalclustercell::emcalclusterId;
 
   Produces<aod::SkimEMCClusters> tableGammaEMCReco;
   Produces<aod::EMCClusterMCLabels> tableEMCClusterMCLabels;
@@ -68,7 +67,7 @@ struct skimmerGammaCalo {
     LOG(info) << "| M02 cut: " << minM02 << " < M02 < " << maxM02 << std::endl;
   }
 
-  void processRec(aod::Collision const&, aod::EMCALClusters const& emcclusters, aod::EMCALClusterCells const& emcclustercells, aod::EMCALMatchedTracks const& emcmatchedtracks, aod::FullTracks const&)
+  void processRec(aod::Collision const&, soa::Join<aod::EMCALClusters, aod::EMCALClusterMatchedTrackSlices> const& emcclusters, aod::EMCALClusterCells const& emcclustercells, aod::EMCALMatchedTracks const&, aod::FullTracks const&)
   {
     for (const auto& emccluster : emcclusters) {
       historeg.fill(HIST("hCaloClusterEIn"), emccluster.energy());
@@ -97,7 +96,7 @@ struct skimmerGammaCalo {
       std::vector<float> vPhi;
       std::vector<float> vP;
       std::vector<float> vPt;
-      auto groupedMTs = emcmatchedtracks.sliceBy(MTperCluster, emccluster.globalIndex());
+      auto groupedMTs = emccluster.matchedTracks_as<aod::EMCALMatchedTracks>();
       vTrackIds.reserve(groupedMTs.size());
       vEta.reserve(groupedMTs.size());
       vPhi.reserve(groupedMTs.size());
@@ -397,9 +397,35 @@ struct Pi0EtaToGammaGamma {
     fPHOSCut.SetEnergyRange(phoscuts.cfg_min_Ecluster, 1e+10);
   }
 
+  /// \brief Selection of the photons of one collision by one cut, evaluated once per photon instead of once per pair
+  struct PhotonSelection {
+    int64_t firstId = 0;
+    std::vector<bool> isSelected; // by photon.globalIndex() - firstId
+    bool operator()(int64_t globalIndex) const
+    {
+      return globalIndex >= firstId && globalIndex - firstId < static_cast<int64_t>(isSelected.size()) && isSelected[globalIndex - firstId];
+    }
+  };
+  PhotonSelection fSelection1, fSelection2, fSelectionRotation;
+
+  template <typename TSubInfos, typename TPhotons, typename TCut>
+  void SelectPhotons(TPhotons const& photons_coll, TCut const& cut, PhotonSelection& selection)
+  {
+    selection.isSelected.clear();
+    if (photons_coll.size() == 0) {
+      return;
+    }
+    selection.firstId = photons_coll.begin().globalIndex();
+    for (auto& photon : photons_coll) {
+      selection.isSelected.resize(photon.globalIndex() - selection.firstId + 1, false);
+      selection.isSelected.back() = cut.template IsSelected<TSubInfos>(photon);
+    }
+  }
+
   /// \brief Calculate background (using rotation background method only for EMCal!)
+  /// \param selection is the selection of photons_coll by the EMCal cut
   template <typename TPhotons>
-  void RotationBackground(const ROOT::Math::PtEtaPhiMVector& meson, ROOT::Math::PtEtaPhiMVector photon1, ROOT::Math::PtEtaPhiMVector photon2, TPhotons const& photons_coll, unsigned int ig1, unsigned int ig2, EMCPhotonCut const& cut, aod::SkimEMCMTs const&)
+  void RotationBackground(const ROOT::Math::PtEtaPhiMVector& meson, ROOT::Math::PtEtaPhiMVector photon1, ROOT::Math::PtEtaPhiMVector photon2, TPhotons const& photons_coll, unsigned int ig1, unsigned int ig2, PhotonSelection const& selection)
   {
     // if less than 3 clusters are present skip event since we need at least 3 clusters
     if (photons_coll.size() < 3) {
@@ -416,7 +442,7 @@ struct Pi0EtaToGammaGamma {
         // only combine rotated photons with other photons
         continue;
       }
-      if (!cut.template IsSelected<aod::SkimEMCMTs>(photon)) {
+      if (!selection(photon.globalIndex())) {
         continue;
       }
 
@@ -462,7 +488,7 @@ struct Pi0EtaToGammaGamma {
                   TSubInfos1 const& subinfos1, TSubInfos2 const& subinfos2,
                   TPreslice1 const& perCollision1, TPreslice2 const& perCollision2,
                   TCut1 const& cut1, TCut2 const& cut2,
-                  TTracksMatchedWithEMC const& tracks_emc, TTracksMatchedWithPHOS const& tracks_phos)
+                  TTracksMatchedWithEMC const& /*tracks_emc*/, TTracksMatchedWithPHOS const& tracks_phos)
   {
     for (auto& collision : collisions) {
       int ndiphoton = 0;
@@ -515,9 +541,14 @@ struct Pi0EtaToGammaGamma {
       if constexpr (pairtype == PairType::kPCMPCM || pairtype == PairType::kPHOSPHOS || pairtype == PairType::kEMCEMC) { // same kinds pairing
         auto photons1_per_collision = photons1.sliceBy(perCollision1, collision.globalIndex());
         auto photons2_per_collision = photons2.sliceBy(perCollision2, collision.globalIndex());
+        SelectPhotons<TSubInfos1>(photons1_per_collision, cut1, fSelection1);
+        SelectPhotons<TSubInfos2>(photons2_per_collision, cut2, fSelection2);
+        if constexpr (pairtype == PairType::kEMCEMC) {
+          SelectPhotons<aod::SkimEMCMTs>(photons2_per_collision, cut1, fSelectionRotation);
+        }
 
         for (auto& [g1, g2] : combinations(CombinationsStrictlyUpperIndexPolicy(photons1_per_collision, photons2_per_collision))) {
-          if (!cut1.template IsSelected<TSubInfos1>(g1) || !cut2.template IsSelected<TSubInfos2>(g2)) {
+          if (!fSelection1(g1.globalIndex()) || !fSelection2(g2.globalIndex())) {
             continue;
           }
 
@@ -530,7 +561,7 @@ struct Pi0EtaToGammaGamma {
           o2::aod::pwgem::photonmeson::utils::nmhistogram::fillPairInfo<0, pairtype>(&fRegistry, collision, v12, cfgDoFlow);
 
           if constexpr (pairtype == PairType::kEMCEMC) {
-            RotationBackground<MyEMCClusters>(v12, v1, v2, photons2_per_collision, g1.globalIndex(), g2.globalIndex(), cut1, tracks_emc);
+            RotationBackground<MyEMCClusters>(v12, v1, v2, photons2_per_collision, g1.globalIndex(), g2.globalIndex(), fSelectionRotation);
           }
 
           std::pair<int, int> pair_tmp_id1 = std::make_pair(ndf, g1.globalIndex());
@@ -672,9 +703,11 @@ struct Pi0EtaToGammaGamma {
       } else { // PCM-EMC, PCM-PHOS. Nightmare. don't run these pairs.
         auto photons1_per_collision = photons1.sliceBy(perCollision1, collision.globalIndex());
         auto photons2_per_collision = photons2.sliceBy(perCollision2, collision.globalIndex());
+        SelectPhotons<TSubInfos1>(photons1_per_collision, cut1, fSelection1);
+        SelectPhotons<TSubInfos2>(photons2_per_collision, cut2, fSelection2);
 
         for (auto& [g1, g2] : combinations(CombinationsFullIndexPolicy(photons1_per_collision, photons2_per_collision))) {
-          if (!cut1.template IsSelected<TSubInfos1>(g1) || !cut2.template IsSelected<TSubInfos2>(g2)) {
+          if (!fSelection1(g1.globalIndex()) || !fSelection2(g2.globalIndex())) {
             continue;
           }
           ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
@@ -704,7 +737,7 @@ struct Pi0EtaToGammaGamma {
         continue;
       }
 
-      // make a vector of selected photons in this collision.
+      // selected photons in this collision.
       auto selected_photons1_in_this_event = emh1->GetTracksPerCollision(key_df_collision);
       auto selected_photons2_in_this_event = emh2->GetTracksPerCollision(key_df_collision);
 
@@ -712,8 +745,6 @@ struct Pi0EtaToGammaGamma {
       auto collisionIds2_in_mixing_pool = emh2->GetCollisionIdsFromEventPool(key_bin);
 
       if constexpr (pairtype == PairType::kPCMPCM || pairtype == PairType::kPHOSPHOS || pairtype == PairType::kEMCEMC) { // same kinds pairing
-        selected_photons1_in_this_event.insert(selected_photons1_in_this_event.end(), selected_photons2_in_this_event.begin(), selected_photons2_in_this_event.end());
-
         for (auto& mix_dfId_collisionId : collisionIds1_in_mixing_pool) {
           int mix_dfId = mix_dfId_collisionId.first;
           int64_t mix_collisionId = mix_dfId_collisionId.second;
@@ -724,18 +755,21 @@ struct Pi0EtaToGammaGamma {
 
           auto photons1_from_event_pool = emh1->GetTracksPerCollision(mix_dfId_collisionId);
           auto photons2_from_event_pool = emh2->GetTracksPerCollision(mix_dfId_collisionId);
-          photons1_from_event_pool.insert(photons1_from_event_pool.end(), photons2_from_event_pool.begin(), photons2_from_event_pool.end());
-          // LOGF(info, "Do event mixing: current event (%d, %d), ngamma = %d | event pool (%d, %d), ngamma = %d", ndf, collision.globalIndex(), selected_photons1_in_this_event.size(), mix_dfId, mix_collisionId, photons1_from_event_pool.size());
-
-          for (auto& g1 : selected_photons1_in_this_event) {
-            for (auto& g2 : photons1_from_event_pool) {
-              ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
-              ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
-              ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
-              if (abs(v12.Rapidity()) > maxY) {
-                continue;
+          // LOGF(info, "Do event mixing: current event (%d, %d), ngamma = %d | event pool (%d, %d), ngamma = %d", ndf, collision.globalIndex(), selected_photons1_in_this_event.size() + selected_photons2_in_this_event.size(), mix_dfId, mix_collisionId, photons1_from_event_pool.size() + photons2_from_event_pool.size());
+
+          // both photon lists of this event with both photon lists of the pooled event
+          for (const auto& photons_in_this_event : {selected_photons1_in_this_event, selected_photons2_in_this_event}) {
+            for (const auto& photons_from_event_pool : {photons1_from_event_pool, photons2_from_event_pool}) {
+              for (auto& g1 : photons_in_this_event) {
+                ROOT::Math::PxPyPzEVector v1(g1.px(), g1.py(), g1.pz(), g1.e());
+                for (auto& g2 : photons_from_event_pool) {
+                  ROOT::Math::PxPyPzEVector v12 = v1 + ROOT::Math::PxPyPzEVector(g2.px(), g2.py(), g2.pz(), g2.e());
+                  if (abs(v12.Rapidity()) > maxY) {
+                    continue;
+                  }
+                  o2::aod::pwgem::photonmeson::utils::nmhistogram::fillPairInfo<1, pairtype>(&fRegistry, collision, v12, cfgDoFlow);
+                }
               }
-              o2::aod::pwgem::photonmeson::utils::nmhistogram::fillPairInfo<1, pairtype>(&fRegistry, collision, v12, cfgDoFlow);
             }
           }
         } // end of loop over mixed event pool
@@ -754,13 +788,10 @@ struct Pi0EtaToGammaGamma {
           // LOGF(info, "Do event mixing: current event (%d, %d), ngamma = %d | event pool (%d, %d), nll = %d", ndf, collision.globalIndex(), selected_photons1_in_this_event.size(), mix_dfId, mix_collisionId, photons2_from_event_pool.size());
 
           for (auto& g1 : selected_photons1_in_this_event) {
+            ROOT::Math::PxPyPzEVector v1(g1.px(), g1.py(), g1.pz(), g1.e());
             for (auto& g2 : photons2_from_event_pool) {
-              ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
-              ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
-              if constexpr (pairtype == PairType::kPCMDalitzEE || pairtype == PairType::kPCMDalitzMuMu) { //[photon from event1, dilepton from event2] and [photon from event2, dilepton from event1]
-                v2.SetM(g2.mass());
-              }
-              ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
+              // the energy of the pooled tracks includes their mass (that of the dilepton for [photon from event1, dilepton from event2])
+              ROOT::Math::PxPyPzEVector v12 = v1 + ROOT::Math::PxPyPzEVector(g2.px(), g2.py(), g2.pz(), g2.e());
               if (abs(v12.Rapidity()) > maxY) {
                 continue;
               }
@@ -781,13 +812,9 @@ struct Pi0EtaToGammaGamma {
           // LOGF(info, "Do event mixing: current event (%d, %d), nll = %d | event pool (%d, %d), ngamma = %d", ndf, collision.globalIndex(), selected_photons2_in_this_event.size(), mix_dfId, mix_collisionId, photons1_from_event_pool.size());
 
           for (auto& g1 : selected_photons2_in_this_event) {
+            ROOT::Math::PxPyPzEVector v1(g1.px(), g1.py(), g1.pz(), g1.e()); // with the mass of the dilepton for [photon from event2, dilepton from event1]
             for (auto& g2 : photons1_from_event_pool) {
-              ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
-              ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
-              if constexpr (pairtype == PairType::kPCMDalitzEE || pairtype == PairType::kPCMDalitzMuMu) { //[photon from event1, dilepton from event2] and [photon from event2, dilepton from event1]
-                v1.SetM(g1.mass());
-              }
-              ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
+              ROOT::Math::PxPyPzEVector v12 = v1 + ROOT::Math::PxPyPzEVector(g2.px(), g2.py(), g2.pz(), g2.e());
               if (abs(v12.Rapidity()) > maxY) {
                 continue;
               }
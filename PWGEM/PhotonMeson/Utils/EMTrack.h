@@ -15,6 +15,8 @@
 #ifndef PWGEM_PHOTONMESON_UTILS_EMTRACK_H_
 #define PWGEM_PHOTONMESON_UTILS_EMTRACK_H_
 
+#include <cmath>
+
 class EMTrack
 {
  public:
@@ -28,6 +30,11 @@ class EMTrack
     fMass = mass;
     fCharge = charge;
     fDCA3D = dca_3d;
+    // cartesian momentum and energy computed once, for the pairing with the tracks of the mixed events
+    fPx = pt * std::cos(phi);
+    fPy = pt * std::sin(phi);
+    fPz = pt * std::sinh(eta);
+    fE = std::sqrt(fPx * fPx + fPy * fPy + fPz * fPz + mass * mass);
   }
 
   ~EMTrack() {}
@@ -40,9 +47,10 @@ class EMTrack
   float mass() const { return fMass; }
   int8_t sign() const { return fCharge; }
   float dca3DinSigma() const { return fDCA3D; }
-  float px() const { return fPt * std::cos(fPhi); }
-  float py() const { return fPt * std::sin(fPhi); }
-  float pz() const { return fPt * std::sinh(fEta); }
+  float px() const { return fPx; }
+  float py() const { return fPy; }
+  float pz() const { return fPz; }
+  float e() const { return fE; }
 
  private:
   int fCollisionId;
@@ -53,6 +61,10 @@ class EMTrack
   float fMass;
   int8_t fCharge;
   float fDCA3D;
+  float fPx;
+  float fPy;
+  float fPz;
+  float fE;
 };
 
 #endif // PWGEM_PHOTONMESON_UTILS_EMTRACK_H_
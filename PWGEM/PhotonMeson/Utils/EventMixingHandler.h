@@ -16,11 +16,15 @@
 #define PWGEM_PHOTONMESON_UTILS_EVENTMIXINGHANDLER_H_
 
 #include <map>
+#include <span>
 #include <utility>
 #include <vector>
 
 namespace o2::aod::pwgem::photonmeson::utils
 {
+// The pool of each mixing bin is a ring buffer of at most ndepth collisions, the oldest collision being overwritten.
+// The track arrays of the collisions are kept in slots which are reused (with their capacity) after the eviction of a collision,
+// and are accessed through spans, without copies.
 template <typename T, typename U, typename V>
 class EventMixingHandler
 {
@@ -28,50 +32,103 @@ class EventMixingHandler
   EventMixingHandler()
   {
     fNdepth = 0;
-    fMapMixBins.clear();
-    fMap_Tracks_per_collision.clear();
   }
 
   explicit EventMixingHandler(int ndepth)
   {
     fNdepth = ndepth;
-    fMapMixBins.clear();
-    fMap_Tracks_per_collision.clear();
   }
 
   ~EventMixingHandler()
   {
     fMapMixBins.clear();
-    fMap_Tracks_per_collision.clear();
+    fMapCollisionSlot.clear();
+    fTrackSlots.clear();
   }
 
   void SetNdepth(int ndepth) { fNdepth = ndepth; }
 
   void AddTrackToEventPool(U key_df_collision, V obj)
   {
-    fMap_Tracks_per_collision[key_df_collision].emplace_back(obj);
+    fTrackSlots[getSlot(key_df_collision)].emplace_back(obj);
   }
 
-  std::vector<U> GetCollisionIdsFromEventPool(T key_bin) { return fMapMixBins[key_bin]; }
-  std::vector<V> GetTracksPerCollision(T key_bin, int index) { return fMap_Tracks_per_collision[fMapMixBins[key_bin][index]]; }
-  std::vector<V> GetTracksPerCollision(U key_df_collision) { return fMap_Tracks_per_collision[key_df_collision]; }
+  /// collisions pooled in the bin, in the order of the ring buffer
+  std::span<const U> GetCollisionIdsFromEventPool(T key_bin) const
+  {
+    auto pool = fMapMixBins.find(key_bin);
+    if (pool == fMapMixBins.end()) {
+      return {};
+    }
+    return pool->second.collisions;
+  }
+  std::span<const V> GetTracksPerCollision(T key_bin, int index) const { return GetTracksPerCollision(GetCollisionIdsFromEventPool(key_bin)[index]); }
+  std::span<const V> GetTracksPerCollision(U key_df_collision) const
+  {
+    auto slot = fMapCollisionSlot.find(key_df_collision);
+    if (slot == fMapCollisionSlot.end()) {
+      return {};
+    }
+    return fTrackSlots[slot->second];
+  }
 
   // call this function at the end of collision loop
   void AddCollisionIdAtLast(T key_bin, U key_df_collision)
   {
-    // LOGF(info, "fMapMixBins[key_bin].size() = %d", fMapMixBins[key_bin].size());
-    if (static_cast<int>(fMapMixBins[key_bin].size()) >= fNdepth) {
-      fMap_Tracks_per_collision[fMapMixBins[key_bin][0]].clear();
-      fMap_Tracks_per_collision[fMapMixBins[key_bin][0]].shrink_to_fit();
-      fMapMixBins[key_bin].erase(fMapMixBins[key_bin].begin());
+    if (fNdepth <= 0) {
+      releaseCollision(key_df_collision);
+      return;
     }
-    fMapMixBins[key_bin].emplace_back(key_df_collision);
+    auto& pool = fMapMixBins[key_bin];
+    if (static_cast<int>(pool.collisions.size()) < fNdepth) {
+      pool.collisions.emplace_back(key_df_collision);
+      return;
+    }
+    releaseCollision(pool.collisions[pool.oldest]);
+    pool.collisions[pool.oldest] = key_df_collision;
+    pool.oldest = (pool.oldest + 1) % pool.collisions.size();
   }
 
  private:
-  int fNdepth;                                           // depth of event mixing
-  std::map<T, std::vector<U>> fMapMixBins;               // map : e.g. <zbin, centbin, epbin> -> pair<df index, global collision index>
-  std::map<U, std::vector<V>> fMap_Tracks_per_collision; // map : e.g. pair<df index, global collision index> -> track array
+  struct Pool {
+    std::vector<U> collisions; // at most fNdepth collisions
+    size_t oldest = 0;         // position of the oldest collision, once the pool is full
+  };
+
+  int getSlot(const U& key_df_collision)
+  {
+    auto it = fMapCollisionSlot.find(key_df_collision);
+    if (it != fMapCollisionSlot.end()) {
+      return it->second;
+    }
+    int slot;
+    if (!fFreeSlots.empty()) {
+      slot = fFreeSlots.back();
+      fFreeSlots.pop_back();
+    } else {
+      slot = fTrackSlots.size();
+      fTrackSlots.emplace_back();
+    }
+    fMapCollisionSlot.emplace(key_df_collision, slot);
+    return slot;
+  }
+
+  void releaseCollision(const U& key_df_collision)
+  {
+    auto it = fMapCollisionSlot.find(key_df_collision);
+    if (it == fMapCollisionSlot.end()) {
+      return;
+    }
+    fTrackSlots[it->second].clear(); // the capacity is kept for the next collision
+    fFreeSlots.emplace_back(it->second);
+    fMapCollisionSlot.erase(it);
+  }
+
+  int fNdepth;                             // depth of event mixing
+  std::map<T, Pool> fMapMixBins;           // map : e.g. <zbin, centbin, epbin> -> ring buffer of pair<df index, global collision index>
+  std::map<U, int> fMapCollisionSlot;      // map : e.g. pair<df index, global collision index> -> slot of the track array
+  std::vector<std::vector<V>> fTrackSlots; // track arrays of the pooled (and current) collisions
+  std::vector<int> fFreeSlots;             // slots released by evicted collisions
 };
 } // namespace o2::aod::pwgem::photonmeson::utils
 #endif // PWGEM_PHOTONMESON_UTILS_EVENTMIXINGHANDLER_H_
@@ -84,6 +84,50 @@ class HfHelper
     return candidate.cosThetaStar(std::array{o2::constants::physics::MassKPlus, o2::constants::physics::MassPiPlus}, o2::constants::physics::MassD0, 0);
   }
 
+  /// Invariant masses and cos(θ*) of a D0 candidate in both the D0 → π+ K− and D0bar → K+ π− hypotheses
+  struct KinematicsD0 {
+    float invMassD0 = 0.f;
+    float invMassD0bar = 0.f;
+    float cosThetaStarD0 = 0.f;
+    float cosThetaStarD0bar = 0.f;
+  };
+
+  /// Computes invMassD0ToPiK, invMassD0barToKPi, cosThetaStarD0 and cosThetaStarD0bar at once, sharing the prong momenta,
+  /// the candidate momentum and the boost between the hypotheses. Same results as the single functions up to rounding.
+  template <typename T>
+  KinematicsD0 kinematicsD0(const T& candidate)
+  {
+    constexpr double MassPi = o2::constants::physics::MassPiPlus;
+    constexpr double MassK = o2::constants::physics::MassKPlus;
+    constexpr double MassD0 = o2::constants::physics::MassD0;
+    const std::array<float, 3> pVec0{candidate.pxProng0(), candidate.pyProng0(), candidate.pzProng0()};
+    const std::array<float, 3> pVec1{candidate.pxProng1(), candidate.pyProng1(), candidate.pzProng1()};
+    KinematicsD0 kinematics;
+
+    // invariant masses, as RecoDecay::m2(arrMom, arrMass)
+    const double p2Prong0 = RecoDecay::p2(pVec0);
+    const double p2Prong1 = RecoDecay::p2(pVec1);
+    const double p2Tot = RecoDecay::p2(std::array{static_cast<double>(pVec0[0]) + pVec1[0], static_cast<double>(pVec0[1]) + pVec1[1], static_cast<double>(pVec0[2]) + pVec1[2]});
+    const double eProng0Pi = std::sqrt(p2Prong0 + MassPi * MassPi);
+    const double eProng0K = std::sqrt(p2Prong0 + MassK * MassK);
+    const double eProng1Pi = std::sqrt(p2Prong1 + MassPi * MassPi);
+    const double eProng1K = std::sqrt(p2Prong1 + MassK * MassK);
+    kinematics.invMassD0 = std::sqrt(RecoDecay::sq(eProng0Pi + eProng1K) - p2Tot);
+    kinematics.invMassD0bar = std::sqrt(RecoDecay::sq(eProng0K + eProng1Pi) - p2Tot);
+
+    // cos(θ*) of the kaon, as RecoDecay::cosThetaStar, the boost and p* are the same for both hypotheses
+    const auto pVecTot = RecoDecay::pVec(pVec0, pVec1);
+    const double pTot = RecoDecay::p(pVecTot);
+    const double eTot = RecoDecay::e(pTot, MassD0);
+    const double gamma = eTot / MassD0;
+    const double beta = pTot / eTot;
+    const double pStar = std::sqrt(RecoDecay::sq(RecoDecay::sq(MassD0) - RecoDecay::sq(MassPi) - RecoDecay::sq(MassK)) - RecoDecay::sq(2 * MassPi * MassK)) / (2 * MassD0);
+    const double betaEStarK = beta * RecoDecay::e(pStar, MassK);
+    kinematics.cosThetaStarD0 = (RecoDecay::dotProd(pVec1, pVecTot) / (pTot * gamma) - betaEStarK) / pStar;
+    kinematics.cosThetaStarD0bar = (RecoDecay::dotProd(pVec0, pVecTot) / (pTot * gamma) - betaEStarK) / pStar;
+    return kinematics;
+  }
+
   // J/ψ
 
   template <typename T>
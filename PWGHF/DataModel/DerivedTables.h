@@ -23,6 +23,7 @@
 #include "Framework/ASoA.h"
 
 #include "Common/Core/RecoDecay.h"
+#include "Common/DataModel/PackedColumns.h"
 
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
@@ -253,6 +254,28 @@ DECLARE_SOA_COLUMN(MlScoreNonPrompt, mlScoreNonPrompt, float);      //! ML score
 DECLARE_SOA_COLUMN(MlScores, mlScores, std::vector<float>);         //! vector of ML scores
 } // namespace hf_cand_mc
 
+// Packed candidate columns, read with the getters of the float columns
+namespace hf_cand_packed
+{
+using nSigma = o2::aod::packing::Quantisation<int8_t, -10.f, 10.f>;  // n sigma, bins of 0.079
+using mlScore = o2::aod::packing::Quantisation<uint16_t, 0.f, 1.f>; // ML score, bins of 1.5e-5
+DECLARE_SOA_PACKED_COLUMN(NSigTpcPi0, nSigTpcPi0, nSigma);
+DECLARE_SOA_PACKED_COLUMN(NSigTpcKa0, nSigTpcKa0, nSigma);
+DECLARE_SOA_PACKED_COLUMN(NSigTofPi0, nSigTofPi0, nSigma);
+DECLARE_SOA_PACKED_COLUMN(NSigTofKa0, nSigTofKa0, nSigma);
+DECLARE_SOA_PACKED_COLUMN(NSigTpcTofPi0, nSigTpcTofPi0, nSigma);
+DECLARE_SOA_PACKED_COLUMN(NSigTpcTofKa0, nSigTpcTofKa0, nSigma);
+DECLARE_SOA_PACKED_COLUMN(NSigTpcPi1, nSigTpcPi1, nSigma);
+DECLARE_SOA_PACKED_COLUMN(NSigTpcKa1, nSigTpcKa1, nSigma);
+DECLARE_SOA_PACKED_COLUMN(NSigTofPi1, nSigTofPi1, nSigma);
+DECLARE_SOA_PACKED_COLUMN(NSigTofKa1, nSigTofKa1, nSigma);
+DECLARE_SOA_PACKED_COLUMN(NSigTpcTofPi1, nSigTpcTofPi1, nSigma);
+DECLARE_SOA_PACKED_COLUMN(NSigTpcTofKa1, nSigTpcTofKa1, nSigma);
+DECLARE_SOA_PACKED_COLUMN(MlScore0, mlScore0, mlScore); //! first ML score (underflow if not available)
+DECLARE_SOA_PACKED_COLUMN(MlScore1, mlScore1, mlScore); //! second ML score (underflow if not available)
+DECLARE_SOA_PACKED_COLUMN(MlScore2, mlScore2, mlScore); //! third ML score (underflow if not available)
+} // namespace hf_cand_packed
+
 // D0
 
 DECLARE_SOA_TABLE(HfD0Bases, "AOD", "HFD0BASE", //! Table with basic candidate properties used in the analyses
@@ -333,6 +356,36 @@ DECLARE_SOA_TABLE(HfD0Mls, "AOD", "HFD0ML", //! Table with candidate selection M
                   hf_cand_mc::MlScores,
                   soa::Marker<MarkerD0>);
 
+DECLARE_SOA_TABLE(HfD0PidPackeds, "AOD", "HFD0PIDPACKED", //! Table with packed PID n sigma of the prongs (alternative to the ones of HfD0Pars)
+                  hf_cand_packed::NSigTpcPi0Packed, hf_cand_packed::NSigTpcKa0Packed,
+                  hf_cand_packed::NSigTofPi0Packed, hf_cand_packed::NSigTofKa0Packed,
+                  hf_cand_packed::NSigTpcTofPi0Packed, hf_cand_packed::NSigTpcTofKa0Packed,
+                  hf_cand_packed::NSigTpcPi1Packed, hf_cand_packed::NSigTpcKa1Packed,
+                  hf_cand_packed::NSigTofPi1Packed, hf_cand_packed::NSigTofKa1Packed,
+                  hf_cand_packed::NSigTpcTofPi1Packed, hf_cand_packed::NSigTpcTofKa1Packed,
+                  hf_cand_packed::NSigTpcPi0<hf_cand_packed::NSigTpcPi0Packed>,
+                  hf_cand_packed::NSigTpcKa0<hf_cand_packed::NSigTpcKa0Packed>,
+                  hf_cand_packed::NSigTofPi0<hf_cand_packed::NSigTofPi0Packed>,
+                  hf_cand_packed::NSigTofKa0<hf_cand_packed::NSigTofKa0Packed>,
+                  hf_cand_packed::NSigTpcTofPi0<hf_cand_packed::NSigTpcTofPi0Packed>,
+                  hf_cand_packed::NSigTpcTofKa0<hf_cand_packed::NSigTpcTofKa0Packed>,
+                  hf_cand_packed::NSigTpcPi1<hf_cand_packed::NSigTpcPi1Packed>,
+                  hf_cand_packed::NSigTpcKa1<hf_cand_packed::NSigTpcKa1Packed>,
+                  hf_cand_packed::NSigTofPi1<hf_cand_packed::NSigTofPi1Packed>,
+                  hf_cand_packed::NSigTofKa1<hf_cand_packed::NSigTofKa1Packed>,
+                  hf_cand_packed::NSigTpcTofPi1<hf_cand_packed::NSigTpcTofPi1Packed>,
+                  hf_cand_packed::NSigTpcTofKa1<hf_cand_packed::NSigTpcTofKa1Packed>,
+                  soa::Marker<MarkerD0>);
+
+DECLARE_SOA_TABLE(HfD0MlPackeds, "AOD", "HFD0MLPACKED", //! Table with packed candidate selection ML scores (alternative to HfD0Mls)
+                  hf_cand_packed::MlScore0Packed,
+                  hf_cand_packed::MlScore1Packed,
+                  hf_cand_packed::MlScore2Packed,
+                  hf_cand_packed::MlScore0<hf_cand_packed::MlScore0Packed>,
+                  hf_cand_packed::MlScore1<hf_cand_packed::MlScore1Packed>,
+                  hf_cand_packed::MlScore2<hf_cand_packed::MlScore2Packed>,
+                  soa::Marker<MarkerD0>);
+
 DECLARE_SOA_TABLE(HfD0Ids, "AOD", "HFD0ID", //! Table with original global indices for candidates
                   hf_cand::CollisionId,
                   hf_track_index::Prong0Id,
@@ -234,6 +234,35 @@ DECLARE_SOA_TABLE(DplusHadronRecoInfo, "AOD", "DPLUSHRECOINFO", //! D+-Hadrons p
                   aod::hf_correlation_dplus_hadron::MD,
                   aod::hf_correlation_dplus_hadron::SignalStatus);
 
+// definition of columns for the compact pair output: triggers and associated tracks stored once per event,
+// the pairs of a trigger are the associated tracks [assocStart, assocEnd) of its event except its daughters
+namespace hf_correlation_compact
+{
+DECLARE_SOA_COLUMN(AssocStart, assocStart, int);         //! First row of the associated tracks of the event
+DECLARE_SOA_COLUMN(AssocEnd, assocEnd, int);             //! End row of the associated tracks of the event
+DECLARE_SOA_COLUMN(DaughterAssoc0, daughterAssoc0, int); //! Row of the associated track of the first daughter, -1 if none
+DECLARE_SOA_COLUMN(DaughterAssoc1, daughterAssoc1, int); //! Row of the associated track of the second daughter, -1 if none
+DECLARE_SOA_COLUMN(DaughterAssoc2, daughterAssoc2, int); //! Row of the associated track of the third daughter, -1 if none
+} // namespace hf_correlation_compact
+
+DECLARE_SOA_TABLE(DplusTrigs, "AOD", "DPLUSTRIG", //! D+ triggers of the compact D+-hadron pair output
+                  aod::hf_dplus_meson::Phi,
+                  aod::hf_dplus_meson::Eta,
+                  aod::hf_dplus_meson::PtD,
+                  aod::hf_dplus_meson::MD,
+                  aod::hf_dplus_meson::PoolBin,
+                  aod::hf_correlation_dplus_hadron::SignalStatus,
+                  aod::hf_correlation_compact::AssocStart,
+                  aod::hf_correlation_compact::AssocEnd,
+                  aod::hf_correlation_compact::DaughterAssoc0,
+                  aod::hf_correlation_compact::DaughterAssoc1,
+                  aod::hf_correlation_compact::DaughterAssoc2);
+
+DECLARE_SOA_TABLE(DplusAssocs, "AOD", "DPLUSASSOC", //! Associated hadrons of the compact D+-hadron pair output
+                  aod::hf_assoc_tracks::Phi,
+                  aod::hf_assoc_tracks::Eta,
+                  aod::hf_assoc_tracks::PtH);
+
 // definition of columns and tables for Dstar-Hadron correlation pair
 namespace hf_correlation_dstar_hadron
 {
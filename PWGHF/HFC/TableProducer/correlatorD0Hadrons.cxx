@@ -194,6 +194,20 @@ struct HfCorrelatorD0Hadrons {
   double massK{0.};
   double softPiMass = 0.14543; // pion mass + Q-value of the D*->D0pi decay
 
+  /// D0 candidate quantities of the mixed-event pairs, computed once per candidate for all its pairs in all the mixed events
+  struct MixingCandidate {
+    std::array<float, 3> pVector{};
+    float pt = 0.f;
+    float eta = 0.f;
+    float phi = 0.f;
+    float invMassD0 = 0.f;
+    float invMassD0bar = 0.f;
+    double ePiK = 0.; // energy in the D0 hypothesis, for the D* soft pion removal
+    double eKPi = 0.; // energy in the D0bar hypothesis
+    bool isInRapidity = false;
+  };
+  std::vector<MixingCandidate> mixingCandidates; // by candidate global index
+
   Preslice<aod::HfCand2Prong> perCol = aod::hf_cand::collisionId;
 
   Partition<soa::Join<aod::HfCand2Prong, aod::HfSelD0>> selectedD0Candidates = aod::hf_sel_candidate_d0::isSelD0 >= selectionFlagD0 || aod::hf_sel_candidate_d0::isSelD0bar >= selectionFlagD0bar;
@@ -672,6 +686,29 @@ struct HfCorrelatorD0Hadrons {
 
   PROCESS_SWITCH(HfCorrelatorD0Hadrons, processMcGen, "Process MC Gen mode", false);
 
+  /// Fills the mixed-event quantities of the candidates of the dataframe
+  template <typename TCandidates>
+  void fillMixingCandidates(TCandidates const& candidates)
+  {
+    mixingCandidates.clear();
+    for (const auto& candidate : candidates) {
+      const auto index = static_cast<std::size_t>(candidate.globalIndex());
+      if (index >= mixingCandidates.size()) {
+        mixingCandidates.resize(index + 1);
+      }
+      auto& mixingCandidate = mixingCandidates[index];
+      mixingCandidate.pVector = candidate.pVector();
+      mixingCandidate.pt = candidate.pt();
+      mixingCandidate.eta = candidate.eta();
+      mixingCandidate.phi = candidate.phi();
+      mixingCandidate.invMassD0 = hfHelper.invMassD0ToPiK(candidate);
+      mixingCandidate.invMassD0bar = hfHelper.invMassD0barToKPi(candidate);
+      mixingCandidate.ePiK = RecoDecay::e(candidate.pVectorProng0(), massPi) + RecoDecay::e(candidate.pVectorProng1(), massK);
+      mixingCandidate.eKPi = RecoDecay::e(candidate.pVectorProng0(), massK) + RecoDecay::e(candidate.pVectorProng1(), massPi);
+      mixingCandidate.isInRapidity = !(yCandMax >= 0. && std::abs(hfHelper.yD0(candidate)) > yCandMax);
+    }
+  }
+
   // ====================== Implement Event mixing on Data ===================================
 
   void processDataMixedEvent(SelectedCollisions const& collisions,
@@ -680,34 +717,35 @@ struct HfCorrelatorD0Hadrons {
   {
     auto tracksTuple = std::make_tuple(candidates, tracks);
     Pair<SelectedCollisions, SelectedCandidatesData, SelectedTracks, BinningType> pairData{corrBinning, 5, -1, collisions, tracksTuple, &cache};
+    fillMixingCandidates(candidates);
 
     for (const auto& [c1, tracks1, c2, tracks2] : pairData) {
       // LOGF(info, "Mixed event collisions: Index = (%d, %d), tracks Size: (%d, %d), Z Vertex: (%f, %f), Pool Bin: (%d, %d)", c1.globalIndex(), c2.globalIndex(), tracks1.size(), tracks2.size(), c1.posZ(), c2.posZ(), corrBinning.getBin(std::make_tuple(c1.posZ(), c1.multFV0M())),corrBinning.getBin(std::make_tuple(c2.posZ(), c2.multFV0M()))); // For debug
       int poolBin = corrBinning.getBin(std::make_tuple(c2.posZ(), c2.multFV0M()));
       for (const auto& [t1, t2] : o2::soa::combinations(o2::soa::CombinationsFullIndexPolicy(tracks1, tracks2))) {
-
-        if (yCandMax >= 0. && std::abs(hfHelper.yD0(t1)) > yCandMax) {
+        const auto& candidate = mixingCandidates[t1.globalIndex()];
+        if (!candidate.isInRapidity) {
           continue;
         }
 
         // soft pion removal, signal status 1,3 for D0 and 2,3 for D0bar (SoftPi removed), signal status 11,13 for D0  and 12.13 for D0bar (only SoftPi)
-        auto ePiK = RecoDecay::e(t1.pVectorProng0(), massPi) + RecoDecay::e(t1.pVectorProng1(), massK);
-        auto eKPi = RecoDecay::e(t1.pVectorProng0(), massK) + RecoDecay::e(t1.pVectorProng1(), massPi);
+        auto ePiK = candidate.ePiK;
+        auto eKPi = candidate.eKPi;
         double invMassDstar1 = 0., invMassDstar2 = 0.;
         bool isSoftPiD0 = false, isSoftPiD0bar = false;
-        auto pSum2 = RecoDecay::p2(t1.pVector(), t2.pVector());
+        auto pSum2 = RecoDecay::p2(candidate.pVector, t2.pVector());
         auto ePion = t2.energy(massPi);
         invMassDstar1 = std::sqrt((ePiK + ePion) * (ePiK + ePion) - pSum2);
         invMassDstar2 = std::sqrt((eKPi + ePion) * (eKPi + ePion) - pSum2);
 
         if (t1.isSelD0() >= selectionFlagD0) {
-          if ((std::abs(invMassDstar1 - hfHelper.invMassD0ToPiK(t1)) - softPiMass) < ptSoftPionMax) {
+          if ((std::abs(invMassDstar1 - candidate.invMassD0) - softPiMass) < ptSoftPionMax) {
             isSoftPiD0 = true;
           }
         }
 
         if (t1.isSelD0bar() >= selectionFlagD0bar) {
-          if ((std::abs(invMassDstar2 - hfHelper.invMassD0barToKPi(t1)) - softPiMass) < ptSoftPionMax) {
+          if ((std::abs(invMassDstar2 - candidate.invMassD0bar) - softPiMass) < ptSoftPionMax) {
             isSoftPiD0bar = true;
           }
         }
@@ -728,8 +766,8 @@ struct HfCorrelatorD0Hadrons {
           }
         }
 
-        entryD0HadronPair(getDeltaPhi(t1.phi(), t2.phi()), t1.eta() - t2.eta(), t1.pt(), t2.pt(), poolBin);
-        entryD0HadronRecoInfo(hfHelper.invMassD0ToPiK(t1), hfHelper.invMassD0barToKPi(t1), signalStatus);
+        entryD0HadronPair(getDeltaPhi(candidate.phi, t2.phi()), candidate.eta - t2.eta(), candidate.pt, t2.pt(), poolBin);
+        entryD0HadronRecoInfo(candidate.invMassD0, candidate.invMassD0bar, signalStatus);
       }
     }
   }
@@ -743,35 +781,36 @@ struct HfCorrelatorD0Hadrons {
   {
     auto tracksTuple = std::make_tuple(candidates, tracks);
     Pair<SelectedCollisions, SelectedCandidatesMcRec, SelectedTracks, BinningType> pairMcRec{corrBinning, 5, -1, collisions, tracksTuple, &cache};
+    fillMixingCandidates(candidates);
     bool flagD0 = false;
     bool flagD0bar = false;
     for (const auto& [c1, tracks1, c2, tracks2] : pairMcRec) {
       int poolBin = corrBinning.getBin(std::make_tuple(c2.posZ(), c2.multFV0M()));
 
       for (const auto& [t1, t2] : o2::soa::combinations(o2::soa::CombinationsFullIndexPolicy(tracks1, tracks2))) {
-
-        if (yCandMax >= 0. && std::abs(hfHelper.yD0(t1)) > yCandMax) {
+        const auto& candidate = mixingCandidates[t1.globalIndex()];
+        if (!candidate.isInRapidity) {
           continue;
         }
 
         // soft pion removal
-        auto ePiK = RecoDecay::e(t1.pVectorProng0(), massPi) + RecoDecay::e(t1.pVectorProng1(), massK);
-        auto eKPi = RecoDecay::e(t1.pVectorProng0(), massK) + RecoDecay::e(t1.pVectorProng1(), massPi);
+        auto ePiK = candidate.ePiK;
+        auto eKPi = candidate.eKPi;
         double invMassDstar1 = 0., invMassDstar2 = 0.;
         bool isSoftPiD0 = false, isSoftPiD0bar = false;
-        auto pSum2 = RecoDecay::p2(t1.pVector(), t2.pVector());
+        auto pSum2 = RecoDecay::p2(candidate.pVector, t2.pVector());
         auto ePion = t2.energy(massPi);
         invMassDstar1 = std::sqrt((ePiK + ePion) * (ePiK + ePion) - pSum2);
         invMassDstar2 = std::sqrt((eKPi + ePion) * (eKPi + ePion) - pSum2);
 
         if (t1.isSelD0() >= selectionFlagD0) {
-          if ((std::abs(invMassDstar1 - hfHelper.invMassD0ToPiK(t1)) - softPiMass) < ptSoftPionMax) {
+          if ((std::abs(invMassDstar1 - candidate.invMassD0) - softPiMass) < ptSoftPionMax) {
             isSoftPiD0 = true;
           }
         }
 
         if (t1.isSelD0bar() >= selectionFlagD0bar) {
-          if ((std::abs(invMassDstar2 - hfHelper.invMassD0barToKPi(t1)) - softPiMass) < ptSoftPionMax) {
+          if ((std::abs(invMassDstar2 - candidate.invMassD0bar) - softPiMass) < ptSoftPionMax) {
             isSoftPiD0bar = true;
           }
         }
@@ -829,8 +868,8 @@ struct HfCorrelatorD0Hadrons {
         } // background case D0bar
 
         registry.fill(HIST("hSignalStatusMERec"), signalStatus);
-        entryD0HadronPair(getDeltaPhi(t1.phi(), t2.phi()), t1.eta() - t2.eta(), t1.pt(), t2.pt(), poolBin);
-        entryD0HadronRecoInfo(hfHelper.invMassD0ToPiK(t1), hfHelper.invMassD0barToKPi(t1), signalStatus);
+        entryD0HadronPair(getDeltaPhi(candidate.phi, t2.phi()), candidate.eta - t2.eta(), candidate.pt, t2.pt(), poolBin);
+        entryD0HadronRecoInfo(candidate.invMassD0, candidate.invMassD0bar, signalStatus);
       }
     }
   }
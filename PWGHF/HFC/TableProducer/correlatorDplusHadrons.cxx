@@ -27,6 +27,7 @@
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
 #include "PWGHF/HFC/DataModel/CorrelationTables.h"
+#include "PWGHF/HFC/Utils/utilsCorrelations.h"
 
 using namespace o2;
 using namespace o2::analysis;
@@ -138,6 +139,8 @@ struct HfCorrelatorDplusHadrons {
   Produces<aod::DplusHadronRecoInfo> entryDplusHadronRecoInfo;
   Produces<aod::Dplus> entryDplus;
   Produces<aod::Hadron> entryHadron;
+  Produces<aod::DplusTrigs> entryDplusTrig;
+  Produces<aod::DplusAssocs> entryDplusAssoc;
 
   Configurable<int> selectionFlagDplus{"selectionFlagDplus", 7, "Selection Flag for Dplus"}; // 7 corresponds to topo+PID cuts
   Configurable<int> applyEfficiency{"applyEfficiency", 1, "Flag for applying D-meson efficiency weights"};
@@ -155,11 +158,22 @@ struct HfCorrelatorDplusHadrons {
   ConfigurableAxis binsMultiplicity{"binsMultiplicity", {VARIABLE_WIDTH, 0.0f, 2000.0f, 6000.0f, 100000.0f}, "Mixing bins - multiplicity"};
   ConfigurableAxis binsZVtx{"binsZVtx", {VARIABLE_WIDTH, -10.0f, -2.5f, 2.5f, 10.0f}, "Mixing bins - z-vertex"};
   ConfigurableAxis binsMultiplicityMc{"binsMultiplicityMc", {VARIABLE_WIDTH, 0.0f, 20.0f, 50.0f, 500.0f}, "Mixing bins - MC multiplicity"}; // In MCGen multiplicity is defined by counting tracks
+  Configurable<bool> storePairs{"storePairs", true, "Store the same-event pairs in the DplusHadronPair table"};
+  Configurable<bool> fillPairHistograms{"fillPairHistograms", false, "Fill the same-event pairs in the hCorrelPairs histogram"};
+  Configurable<bool> storeCompactPairs{"storeCompactPairs", false, "Store the same-event Dplus and associated tracks once per event in the DplusTrigs and DplusAssocs tables (data and MC reco)"};
+  ConfigurableAxis binsPtHadron{"binsPtHadron", {VARIABLE_WIDTH, 0.3f, 1.0f, 2.0f, 3.0f, 5.0f, 10.0f, 100.0f}, "pT bins of the associated hadrons in hCorrelPairs"};
+  ConfigurableAxis binsDeltaEta{"binsDeltaEta", {40, -2.f, 2.f}, "#Delta#eta bins in hCorrelPairs"};
 
   HfHelper hfHelper;
   SliceCache cache;
   BinningType corrBinning{{binsZVtx, binsMultiplicity}, true};
 
+  // associated tracks of the current event, selected once for all the Dplus candidates
+  o2::analysis::hf_correlations::AssociatedTracks assocTracks;
+  std::vector<int> assocMothers;       // MC gen: mothers of the associated particles, flattened
+  std::vector<size_t> assocMothersEnd; // MC gen: end of the mothers of each associated particle in assocMothers
+  int compactAssocStart = -1;          // first row of the associated tracks of the event in DplusAssocs, -1 if not written yet
+
   // Event Mixing for the Data Mode
   using SelCollisionsWithDplus = soa::Filtered<soa::Join<aod::Collisions, aod::Mults, aod::DmesonSelection>>;
   using TracksWithDca = soa::Filtered<soa::Join<aod::TracksWDca, aod::TrackSelection>>; // track Selection applied
@@ -219,9 +233,55 @@ struct HfCorrelatorDplusHadrons {
     registry.add("hMassDplusMCRecSig", "Dplus signal candidates - MC reco;inv. mass (#pi K) (GeV/#it{c}^{2});entries", {HistType::kTH2F, {{massAxisBins, massAxisMin, massAxisMax}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
     registry.add("hMassDplusMCRecBkg", "Dplus background candidates - MC reco;inv. mass (#pi K) (GeV/#it{c}^{2});entries", {HistType::kTH2F, {{massAxisBins, massAxisMin, massAxisMax}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
     registry.add("hcountDplustriggersMCGen", "Dplus trigger particles - MC gen;;N of trigger Dplus", {HistType::kTH2F, {{1, -0.5, 0.5}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
+    if (fillPairHistograms) {
+      registry.add("hCorrelPairs", "Dplus-hadron pairs;#Delta#varphi;#Delta#eta;#it{p}_{T}^{D} (GeV/#it{c});#it{p}_{T}^{h} (GeV/#it{c});inv. mass (K^{-}#pi^{+}#pi^{+}) (GeV/#it{c}^{2});pool bin",
+                   {HistType::kTHnSparseF, {{phiAxisBins, phiAxisMin, phiAxisMax}, {binsDeltaEta}, {vbins}, {binsPtHadron}, {massAxisBins, massAxisMin, massAxisMax}, {9, 0., 9.}}});
+    }
     corrBinning = {{binsZVtx, binsMultiplicity}, true};
   }
 
+  /// Writes a same-event pair in the pair tables and/or in the pair histogram
+  void fillPair(float deltaPhi, float deltaEta, float ptD, float ptHadron, int poolBin, float invMass, bool writeRecoInfo, bool isSignal)
+  {
+    if (storePairs) {
+      entryDplusHadronPair(deltaPhi, deltaEta, ptD, ptHadron, poolBin);
+      if (writeRecoInfo) {
+        entryDplusHadronRecoInfo(invMass, isSignal);
+      }
+    }
+    if (fillPairHistograms) {
+      registry.fill(HIST("hCorrelPairs"), deltaPhi, deltaEta, ptD, ptHadron, invMass, poolBin);
+    }
+  }
+
+  /// Writes a Dplus of the compact pair output, with the associated tracks of its event at the first Dplus of the event
+  void fillCompactTrigger(float phi, float eta, float pt, float invMass, int poolBin, bool isSignal, std::array<int, 3> const& daughterAssocs)
+  {
+    if (compactAssocStart < 0) {
+      compactAssocStart = entryDplusAssoc.lastIndex() + 1;
+      for (size_t iTrack = 0; iTrack < assocTracks.size(); ++iTrack) {
+        entryDplusAssoc(assocTracks.phi(iTrack), assocTracks.eta(iTrack), assocTracks.pt(iTrack));
+      }
+    }
+    auto toRow = [this](int iTrack) { return iTrack < 0 ? -1 : compactAssocStart + iTrack; };
+    entryDplusTrig(phi, eta, pt, invMass, poolBin, isSignal, compactAssocStart, compactAssocStart + static_cast<int>(assocTracks.size()),
+                   toRow(daughterAssocs[0]), toRow(daughterAssocs[1]), toRow(daughterAssocs[2]));
+  }
+
+  /// Selects the associated tracks of the event
+  template <typename TTracks>
+  void selectAssociatedTracks(TTracks const& tracks)
+  {
+    compactAssocStart = -1;
+    assocTracks.clear();
+    for (const auto& track : tracks) {
+      if (!track.isGlobalTrackWoDCA()) {
+        continue;
+      }
+      assocTracks.add(track.globalIndex(), track.phi(), track.eta(), track.pt());
+    }
+  }
+
   /// Dplus-hadron correlation pair builder - for real data and data-like analysis (i.e. reco-level w/o matching request via MC truth)
   void processData(SelCollisionsWithDplus::iterator const& collision,
                    TracksWithDca const& tracks,
@@ -248,6 +308,7 @@ struct HfCorrelatorDplusHadrons {
         return;
       }
       registry.fill(HIST("hMultiplicity"), nTracks);
+      selectAssociatedTracks(tracks);
 
       int cntDplus = 0;
       for (const auto& candidate : candidates) {
@@ -273,23 +334,26 @@ struct HfCorrelatorDplusHadrons {
         entryDplus(candidate.phi(), candidate.eta(), candidate.pt(), hfHelper.invMassDplusToPiKPi(candidate), poolBin, gCollisionId, timeStamp);
         // Dplus-Hadron correlation dedicated section
         // if the candidate is a Dplus, search for Hadrons and evaluate correlations
-        for (const auto& track : tracks) {
-          // apply track selection
-          if (!track.isGlobalTrackWoDCA()) {
-            continue;
-          }
+        const float invMass = hfHelper.invMassDplusToPiKPi(candidate);
+        assocTracks.correlate<true>(candidate.phi(), candidate.eta());
+        std::array<int, 3> daughterAssocs = {-1, -1, -1};
+        int nDaughterAssocs = 0;
+        for (size_t iTrack = 0; iTrack < assocTracks.size(); ++iTrack) {
           // Removing Dplus daughters by checking track indices
-          if ((candidate.prong0Id() == track.globalIndex()) || (candidate.prong1Id() == track.globalIndex()) || (candidate.prong2Id() == track.globalIndex())) {
+          const auto trackIndex = assocTracks.globalIndex(iTrack);
+          if ((candidate.prong0Id() == trackIndex) || (candidate.prong1Id() == trackIndex) || (candidate.prong2Id() == trackIndex)) {
+            if (nDaughterAssocs < 3) {
+              daughterAssocs[nDaughterAssocs++] = iTrack;
+            }
             continue;
           }
-          entryDplusHadronPair(getDeltaPhi(track.phi(), candidate.phi()),
-                               track.eta() - candidate.eta(),
-                               candidate.pt(),
-                               track.pt(), poolBin);
-          entryDplusHadronRecoInfo(hfHelper.invMassDplusToPiKPi(candidate), 0);
+          fillPair(assocTracks.deltaPhi(iTrack), assocTracks.deltaEta(iTrack), candidate.pt(), assocTracks.pt(iTrack), poolBin, invMass, true, false);
           if (cntDplus == 0)
-            entryHadron(track.phi(), track.eta(), track.pt(), poolBin, gCollisionId, timeStamp);
+            entryHadron(assocTracks.phi(iTrack), assocTracks.eta(iTrack), assocTracks.pt(iTrack), poolBin, gCollisionId, timeStamp);
         } // Hadron Tracks loop
+        if (storeCompactPairs) {
+          fillCompactTrigger(candidate.phi(), candidate.eta(), candidate.pt(), invMass, poolBin, false, daughterAssocs);
+        }
         cntDplus++;
       } // end outer Dplus loop
       registry.fill(HIST("hZvtx"), collision.posZ());
@@ -320,6 +384,7 @@ struct HfCorrelatorDplusHadrons {
         return;
       }
       registry.fill(HIST("hMultiplicity"), nTracks);
+      selectAssociatedTracks(tracks);
 
       // MC reco level
       bool flagDplusSignal = false;
@@ -355,21 +420,24 @@ struct HfCorrelatorDplusHadrons {
         // if the candidate is selected as Dplus, search for Hadron and evaluate correlations
         flagDplusSignal = candidate.flagMcMatchRec() == 1 << aod::hf_cand_3prong::DecayType::DplusToPiKPi;
 
-        for (const auto& track : tracks) {
-          // apply track selection
-          if (!track.isGlobalTrackWoDCA()) {
-            continue;
-          }
+        const float invMass = hfHelper.invMassDplusToPiKPi(candidate);
+        assocTracks.correlate<true>(candidate.phi(), candidate.eta());
+        std::array<int, 3> daughterAssocs = {-1, -1, -1};
+        int nDaughterAssocs = 0;
+        for (size_t iTrack = 0; iTrack < assocTracks.size(); ++iTrack) {
           // Removing Dplus daughters by checking track indices
-          if ((candidate.prong0Id() == track.globalIndex()) || (candidate.prong1Id() == track.globalIndex()) || (candidate.prong2Id() == track.globalIndex())) {
+          const auto trackIndex = assocTracks.globalIndex(iTrack);
+          if ((candidate.prong0Id() == trackIndex) || (candidate.prong1Id() == trackIndex) || (candidate.prong2Id() == trackIndex)) {
+            if (nDaughterAssocs < 3) {
+              daughterAssocs[nDaughterAssocs++] = iTrack;
+            }
             continue;
           }
-          entryDplusHadronPair(getDeltaPhi(track.phi(), candidate.phi()),
-                               track.eta() - candidate.eta(),
-                               candidate.pt(),
-                               track.pt(), poolBin);
-          entryDplusHadronRecoInfo(hfHelper.invMassDplusToPiKPi(candidate), flagDplusSignal);
+          fillPair(assocTracks.deltaPhi(iTrack), assocTracks.deltaEta(iTrack), candidate.pt(), assocTracks.pt(iTrack), poolBin, invMass, true, flagDplusSignal);
         } // end inner loop (Tracks)
+        if (storeCompactPairs) {
+          fillCompactTrigger(candidate.phi(), candidate.eta(), candidate.pt(), invMass, poolBin, flagDplusSignal, daughterAssocs);
+        }
 
       } // end outer Dplus loop
       registry.fill(HIST("hZvtx"), collision.posZ());
@@ -396,6 +464,26 @@ struct HfCorrelatorDplusHadrons {
     };
     using BinningTypeMCGen = FlexibleBinningPolicy<std::tuple<decltype(getTracksSize)>, aod::mccollision::PosZ, decltype(getTracksSize)>;
     BinningTypeMCGen corrBinningMcGen{{getTracksSize}, {binsZVtx, binsMultiplicityMc}, true};
+    const int nTracksMcGen = getTracksSize(mcCollision);
+    const int poolBin = corrBinningMcGen.getBin(std::make_tuple(mcCollision.posZ(), nTracksMcGen));
+
+    // associated particles, selected once for all the Dplus of the event
+    assocTracks.clear();
+    assocMothers.clear();
+    assocMothersEnd.clear();
+    for (const auto& particle2 : mcParticles) {
+      if (std::abs(particle2.eta()) >= etaTrackMax || particle2.pt() <= ptTrackMin) {
+        continue;
+      }
+      if ((std::abs(particle2.pdgCode()) != 11) && (std::abs(particle2.pdgCode()) != 13) && (std::abs(particle2.pdgCode()) != 211) && (std::abs(particle2.pdgCode()) != 321) && (std::abs(particle2.pdgCode()) != 2212)) {
+        continue;
+      }
+      assocTracks.add(particle2.globalIndex(), particle2.phi(), particle2.eta(), particle2.pt());
+      for (const auto& motherId : particle2.mothersIds()) {
+        assocMothers.push_back(motherId);
+      }
+      assocMothersEnd.push_back(assocMothers.size());
+    }
 
     // MC gen level
     for (const auto& particle1 : mcParticles) {
@@ -418,33 +506,27 @@ struct HfCorrelatorDplusHadrons {
         continue;
       }
       registry.fill(HIST("hcountDplustriggersMCGen"), 0, particle1.pt()); // to count trigger Dplus for normalisation)
-      for (const auto& particle2 : mcParticles) {
+      assocTracks.correlate<true>(particle1.phi(), particle1.eta());
+      for (size_t iAssoc = 0; iAssoc < assocTracks.size(); ++iAssoc) {
 
         // Check Mother of particle 2
         bool flagMotherFound = false;
-        for (const auto& m : particle2.mothers_as<aod::McParticles>()) {
-          if (m.globalIndex() == particle1.globalIndex()) {
+        for (size_t iMother = iAssoc > 0 ? assocMothersEnd[iAssoc - 1] : 0; iMother < assocMothersEnd[iAssoc]; ++iMother) {
+          if (assocMothers[iMother] == particle1.globalIndex()) {
             flagMotherFound = true;
             break;
           }
         }
-        if (flagMotherFound || std::abs(particle2.eta()) >= etaTrackMax || particle2.pt() <= ptTrackMin) {
-          continue;
-        }
-        if ((std::abs(particle2.pdgCode()) != 11) && (std::abs(particle2.pdgCode()) != 13) && (std::abs(particle2.pdgCode()) != 211) && (std::abs(particle2.pdgCode()) != 321) && (std::abs(particle2.pdgCode()) != 2212)) {
+        if (flagMotherFound) {
           continue;
         }
-        int poolBin = corrBinningMcGen.getBin(std::make_tuple(mcCollision.posZ(), getTracksSize(mcCollision)));
-        entryDplusHadronPair(getDeltaPhi(particle2.phi(), particle1.phi()),
-                             particle2.eta() - particle1.eta(),
-                             particle1.pt(),
-                             particle2.pt(), poolBin);
+        fillPair(assocTracks.deltaPhi(iAssoc), assocTracks.deltaEta(iAssoc), particle1.pt(), assocTracks.pt(iAssoc), poolBin, MassDPlus, false, true);
 
       } // end inner loop
     }   // end outer loop
     registry.fill(HIST("hcountDplusHadronPerEvent"), counterDplusHadron);
     registry.fill(HIST("hZvtx"), mcCollision.posZ());
-    registry.fill(HIST("hMultiplicity"), getTracksSize(mcCollision));
+    registry.fill(HIST("hMultiplicity"), nTracksMcGen);
   }
   PROCESS_SWITCH(HfCorrelatorDplusHadrons, processMcGen, "Process MC Gen mode", false);
 
@@ -20,6 +20,7 @@
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
 #include "PWGHF/Utils/utilsAnalysis.h"
 #include "PWGHF/HFC/DataModel/CorrelationTables.h"
+#include "PWGHF/HFC/Utils/utilsCorrelations.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -139,105 +140,132 @@ struct HfTaskCorrelationDplusHadrons {
     registry.get<THnSparse>(HIST("hCorrel2DVsPtMCGen"))->Sumw2();
   }
 
-  void processData(aod::DplusHadronPairFull const& pairEntries)
+  /// Fills the correlation plots of one data pair
+  void fillPairData(double deltaPhi, double deltaEta, double ptD, double ptHadron, int poolBin, double massD)
   {
-    for (const auto& pairEntry : pairEntries) {
-      // define variables for widely used quantities
-      double deltaPhi = pairEntry.deltaPhi();
-      double deltaEta = pairEntry.deltaEta();
-      double ptD = pairEntry.ptD();
-      double ptHadron = pairEntry.ptHadron();
-      int poolBin = pairEntry.poolBin();
-      double massD = pairEntry.mD();
-      int effBinD = o2::analysis::findBin(binsPtEfficiency, ptD);
-      int pTBinD = o2::analysis::findBin(binsPtCorrelations, ptD);
+    int effBinD = o2::analysis::findBin(binsPtEfficiency, ptD);
+    int pTBinD = o2::analysis::findBin(binsPtCorrelations, ptD);
 
-      // reject entries outside pT ranges of interest
-      if (pTBinD < 0 || effBinD < 0) {
-        continue;
-      }
-      if (ptHadron > 10.0) {
-        ptHadron = 10.5;
-      }
-      double efficiencyWeight = 1.;
-      double efficiencyHadron = 1.; // Note: To be implemented later on
-      if (applyEfficiency) {
-        efficiencyWeight = 1. / (efficiencyD->at(effBinD) * efficiencyHadron);
-      }
-      // check if correlation entry belongs to signal region, sidebands or is outside both, and fill correlation plots
-      if (massD > signalRegionInner->at(pTBinD) && massD < signalRegionOuter->at(pTBinD)) {
-        // in signal region
-        registry.fill(HIST("hCorrel2DVsPtSignalRegion"), deltaPhi, deltaEta, ptD, ptHadron, poolBin, efficiencyWeight);
-        registry.fill(HIST("hCorrel2DPtIntSignalRegion"), deltaPhi, deltaEta, efficiencyWeight);
-        registry.fill(HIST("hDeltaEtaPtIntSignalRegion"), deltaEta, efficiencyWeight);
-        registry.fill(HIST("hDeltaPhiPtIntSignalRegion"), deltaPhi, efficiencyWeight);
-      }
+    // reject entries outside pT ranges of interest
+    if (pTBinD < 0 || effBinD < 0) {
+      return;
+    }
+    if (ptHadron > 10.0) {
+      ptHadron = 10.5;
+    }
+    double efficiencyWeight = 1.;
+    double efficiencyHadron = 1.; // Note: To be implemented later on
+    if (applyEfficiency) {
+      efficiencyWeight = 1. / (efficiencyD->at(effBinD) * efficiencyHadron);
+    }
+    // check if correlation entry belongs to signal region, sidebands or is outside both, and fill correlation plots
+    if (massD > signalRegionInner->at(pTBinD) && massD < signalRegionOuter->at(pTBinD)) {
+      // in signal region
+      registry.fill(HIST("hCorrel2DVsPtSignalRegion"), deltaPhi, deltaEta, ptD, ptHadron, poolBin, efficiencyWeight);
+      registry.fill(HIST("hCorrel2DPtIntSignalRegion"), deltaPhi, deltaEta, efficiencyWeight);
+      registry.fill(HIST("hDeltaEtaPtIntSignalRegion"), deltaEta, efficiencyWeight);
+      registry.fill(HIST("hDeltaPhiPtIntSignalRegion"), deltaPhi, efficiencyWeight);
+    }
 
-      if ((massD > sidebandLeftOuter->at(pTBinD) && massD < sidebandLeftInner->at(pTBinD)) ||
-          (massD > sidebandRightInner->at(pTBinD) && massD < sidebandRightOuter->at(pTBinD))) {
-        // in sideband region
-        registry.fill(HIST("hCorrel2DVsPtSidebands"), deltaPhi, deltaEta, ptD, ptHadron, poolBin, efficiencyWeight);
-        registry.fill(HIST("hCorrel2DPtIntSidebands"), deltaPhi, deltaEta, efficiencyWeight);
-        registry.fill(HIST("hDeltaEtaPtIntSidebands"), deltaEta, efficiencyWeight);
-        registry.fill(HIST("hDeltaPhiPtIntSidebands"), deltaPhi, efficiencyWeight);
-      }
+    if ((massD > sidebandLeftOuter->at(pTBinD) && massD < sidebandLeftInner->at(pTBinD)) ||
+        (massD > sidebandRightInner->at(pTBinD) && massD < sidebandRightOuter->at(pTBinD))) {
+      // in sideband region
+      registry.fill(HIST("hCorrel2DVsPtSidebands"), deltaPhi, deltaEta, ptD, ptHadron, poolBin, efficiencyWeight);
+      registry.fill(HIST("hCorrel2DPtIntSidebands"), deltaPhi, deltaEta, efficiencyWeight);
+      registry.fill(HIST("hDeltaEtaPtIntSidebands"), deltaEta, efficiencyWeight);
+      registry.fill(HIST("hDeltaPhiPtIntSidebands"), deltaPhi, efficiencyWeight);
+    }
+  }
+
+  /// Fills the correlation plots of one MC reco pair
+  void fillPairMcRec(double deltaPhi, double deltaEta, double ptD, double ptHadron, int poolBin, double massD, bool signalStatus)
+  {
+    int effBinD = o2::analysis::findBin(binsPtEfficiency, ptD);
+    int pTBinD = o2::analysis::findBin(binsPtCorrelations, ptD);
+    if (pTBinD < 0 || effBinD < 0) {
+      return;
+    }
+    if (ptHadron > 10.0) {
+      ptHadron = 10.5;
+    }
+    double efficiencyWeight = 1.;
+    double efficiencyHadron = 1.; // Note: To be implemented later on
+    if (applyEfficiency) {
+      efficiencyWeight = 1. / (efficiencyD->at(effBinD) * efficiencyHadron);
+    }
+    // fill correlation plots for signal/bagkground correlations
+    if (signalStatus) {
+      registry.fill(HIST("hCorrel2DVsPtSignalMCRec"), deltaPhi, deltaEta, ptD, ptHadron, poolBin, efficiencyWeight);
+    } else {
+      registry.fill(HIST("hCorrel2DVsPtBkgMCRec"), deltaPhi, deltaEta, ptD, ptHadron, poolBin, efficiencyWeight);
+    }
+    // reject entries outside pT ranges of interest
+
+    // check if correlation entry belongs to signal region, sidebands or is outside both, and fill correlation plots
+    if (massD > signalRegionInner->at(pTBinD) && massD < signalRegionOuter->at(pTBinD)) {
+      // in signal region
+      registry.fill(HIST("hCorrel2DVsPtSignalRegionMCRec"), deltaPhi, deltaEta, ptD, ptHadron, poolBin, efficiencyWeight);
+      registry.fill(HIST("hCorrel2DPtIntSignalRegionMCRec"), deltaPhi, deltaEta, efficiencyWeight);
+      registry.fill(HIST("hDeltaEtaPtIntSignalRegionMCRec"), deltaEta, efficiencyWeight);
+      registry.fill(HIST("hDeltaPhiPtIntSignalRegionMCRec"), deltaPhi, efficiencyWeight);
+    }
+
+    if (((massD > sidebandLeftOuter->at(pTBinD)) && (massD < sidebandLeftInner->at(pTBinD))) ||
+        ((massD > sidebandRightInner->at(pTBinD) && massD < sidebandRightOuter->at(pTBinD)))) {
+      // in sideband region
+      registry.fill(HIST("hCorrel2DVsPtSidebandsMCRec"), deltaPhi, deltaEta, ptD, ptHadron, poolBin, efficiencyWeight);
+      registry.fill(HIST("hCorrel2DPtIntSidebandsMCRec"), deltaPhi, deltaEta, efficiencyWeight);
+      registry.fill(HIST("hDeltaEtaPtIntSidebandsMCRec"), deltaEta, efficiencyWeight);
+      registry.fill(HIST("hDeltaPhiPtIntSidebandsMCRec"), deltaPhi, efficiencyWeight);
+    }
+  }
+
+  void processData(aod::DplusHadronPairFull const& pairEntries)
+  {
+    for (const auto& pairEntry : pairEntries) {
+      fillPairData(pairEntry.deltaPhi(), pairEntry.deltaEta(), pairEntry.ptD(), pairEntry.ptHadron(), pairEntry.poolBin(), pairEntry.mD());
     } // end loop
   }
   PROCESS_SWITCH(HfTaskCorrelationDplusHadrons, processData, "Process data", false);
 
+  /// D-Hadron correlation pair filling task, from the compact trigger and associated track tables - for data-level analysis
+  void processDataCompact(aod::DplusTrigs const& triggers, aod::DplusAssocs const& assocs)
+  {
+    for (const auto& trigger : triggers) {
+      const double ptD = trigger.ptD();
+      const double massD = trigger.mD();
+      const int poolBin = trigger.poolBin();
+      o2::analysis::hf_correlations::forEachPair<true>(trigger, assocs, [&](float deltaPhi, float deltaEta, float ptHadron) {
+        fillPairData(deltaPhi, deltaEta, ptD, ptHadron, poolBin, massD);
+      });
+    }
+  }
+  PROCESS_SWITCH(HfTaskCorrelationDplusHadrons, processDataCompact, "Process data from the compact pair tables", false);
+
   /// D-Hadron correlation pair filling task, from pair tables - for MC reco-level analysis (candidates matched to true signal only, but also bkg sources are studied)
   void processMcRec(aod::DplusHadronPairFull const& pairEntries)
   {
     for (const auto& pairEntry : pairEntries) {
-      // define variables for widely used quantities
-      double deltaPhi = pairEntry.deltaPhi();
-      double deltaEta = pairEntry.deltaEta();
-      double ptD = pairEntry.ptD();
-      double ptHadron = pairEntry.ptHadron();
-      int poolBin = pairEntry.poolBin();
-      double massD = pairEntry.mD();
-      int effBinD = o2::analysis::findBin(binsPtEfficiency, ptD);
-      int pTBinD = o2::analysis::findBin(binsPtCorrelations, ptD);
-      if (pTBinD < 0 || effBinD < 0) {
-        continue;
-      }
-      if (ptHadron > 10.0) {
-        ptHadron = 10.5;
-      }
-      double efficiencyWeight = 1.;
-      double efficiencyHadron = 1.; // Note: To be implemented later on
-      if (applyEfficiency) {
-        efficiencyWeight = 1. / (efficiencyD->at(effBinD) * efficiencyHadron);
-      }
-      // fill correlation plots for signal/bagkground correlations
-      if (pairEntry.signalStatus()) {
-        registry.fill(HIST("hCorrel2DVsPtSignalMCRec"), deltaPhi, deltaEta, ptD, ptHadron, poolBin, efficiencyWeight);
-      } else {
-        registry.fill(HIST("hCorrel2DVsPtBkgMCRec"), deltaPhi, deltaEta, ptD, ptHadron, poolBin, efficiencyWeight);
-      }
-      // reject entries outside pT ranges of interest
-
-      // check if correlation entry belongs to signal region, sidebands or is outside both, and fill correlation plots
-      if (massD > signalRegionInner->at(pTBinD) && massD < signalRegionOuter->at(pTBinD)) {
-        // in signal region
-        registry.fill(HIST("hCorrel2DVsPtSignalRegionMCRec"), deltaPhi, deltaEta, ptD, ptHadron, poolBin, efficiencyWeight);
-        registry.fill(HIST("hCorrel2DPtIntSignalRegionMCRec"), deltaPhi, deltaEta, efficiencyWeight);
-        registry.fill(HIST("hDeltaEtaPtIntSignalRegionMCRec"), deltaEta, efficiencyWeight);
-        registry.fill(HIST("hDeltaPhiPtIntSignalRegionMCRec"), deltaPhi, efficiencyWeight);
-      }
-
-      if (((massD > sidebandLeftOuter->at(pTBinD)) && (massD < sidebandLeftInner->at(pTBinD))) ||
-          ((massD > sidebandRightInner->at(pTBinD) && massD < sidebandRightOuter->at(pTBinD)))) {
-        // in sideband region
-        registry.fill(HIST("hCorrel2DVsPtSidebandsMCRec"), deltaPhi, deltaEta, ptD, ptHadron, poolBin, efficiencyWeight);
-        registry.fill(HIST("hCorrel2DPtIntSidebandsMCRec"), deltaPhi, deltaEta, efficiencyWeight);
-        registry.fill(HIST("hDeltaEtaPtIntSidebandsMCRec"), deltaEta, efficiencyWeight);
-        registry.fill(HIST("hDeltaPhiPtIntSidebandsMCRec"), deltaPhi, efficiencyWeight);
-      }
+      fillPairMcRec(pairEntry.deltaPhi(), pairEntry.deltaEta(), pairEntry.ptD(), pairEntry.ptHadron(), pairEntry.poolBin(), pairEntry.mD(), pairEntry.signalStatus());
     } // end loop
   }
   PROCESS_SWITCH(HfTaskCorrelationDplusHadrons, processMcRec, "Process MC Reco mode", true);
 
+  /// D-Hadron correlation pair filling task, from the compact trigger and associated track tables - for MC reco-level analysis
+  void processMcRecCompact(aod::DplusTrigs const& triggers, aod::DplusAssocs const& assocs)
+  {
+    for (const auto& trigger : triggers) {
+      const double ptD = trigger.ptD();
+      const double massD = trigger.mD();
+      const int poolBin = trigger.poolBin();
+      const bool signalStatus = trigger.signalStatus();
+      o2::analysis::hf_correlations::forEachPair<true>(trigger, assocs, [&](float deltaPhi, float deltaEta, float ptHadron) {
+        fillPairMcRec(deltaPhi, deltaEta, ptD, ptHadron, poolBin, massD, signalStatus);
+      });
+    }
+  }
+  PROCESS_SWITCH(HfTaskCorrelationDplusHadrons, processMcRecCompact, "Process MC Reco mode from the compact pair tables", false);
+
   /// D-Hadron correlation pair filling task, from pair tables - for MC gen-level analysis (no filter/selection, only true signal)
   void processMcGen(aod::DplusHadronPair const& pairEntries)
   {
@@ -0,0 +1,124 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file utilsCorrelations.h
+/// \brief Associated tracks of an event selected once for all the trigger candidates, for the HF-hadron correlators,
+///        and reader of the compact pair output (triggers and associated tracks stored once per event)
+
+#ifndef PWGHF_HFC_UTILS_UTILSCORRELATIONS_H_
+#define PWGHF_HFC_UTILS_UTILSCORRELATIONS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "CommonConstants/MathConstants.h"
+
+namespace o2::analysis::hf_correlations
+{
+
+/// Δφ constrained to [-π/2, 3π/2), as RecoDecay::constrainAngle(deltaPhi, -π/2) for a difference of two angles in [0, 2π)
+inline double constrainDeltaPhi(double deltaPhi)
+{
+  deltaPhi += deltaPhi < -o2::constants::math::PIHalf ? o2::constants::math::TwoPI : 0.;
+  deltaPhi -= deltaPhi >= -o2::constants::math::PIHalf + o2::constants::math::TwoPI ? o2::constants::math::TwoPI : 0.;
+  return deltaPhi;
+}
+
+/// Associated tracks (or MC particles) of one event, in flat arrays.
+///
+/// The tracks are selected once per event with add(), then correlate() computes the Δφ and Δη of all of them
+/// with respect to each trigger in one loop over contiguous arrays, instead of iterating the track table and
+/// re-applying the track selection for each trigger.
+///
+/// Usage:
+///   assocTracks.clear();
+///   for (const auto& track : tracks) { if (selected) assocTracks.add(track.globalIndex(), track.phi(), track.eta(), track.pt()); }
+///   for (const auto& candidate : candidates) {
+///     assocTracks.correlate(candidate.phi(), candidate.eta());
+///     for (std::size_t i = 0; i < assocTracks.size(); ++i) { ... assocTracks.deltaPhi(i), assocTracks.deltaEta(i), assocTracks.pt(i) ... }
+///   }
+class AssociatedTracks
+{
+ public:
+  void clear()
+  {
+    mGlobalIndex.clear();
+    mPhi.clear();
+    mEta.clear();
+    mPt.clear();
+  }
+
+  void add(int64_t globalIndex, float phi, float eta, float pt)
+  {
+    mGlobalIndex.push_back(globalIndex);
+    mPhi.push_back(phi);
+    mEta.push_back(eta);
+    mPt.push_back(pt);
+  }
+
+  std::size_t size() const { return mPt.size(); }
+
+  int64_t globalIndex(std::size_t i) const { return mGlobalIndex[i]; }
+  float phi(std::size_t i) const { return mPhi[i]; }
+  float eta(std::size_t i) const { return mEta[i]; }
+  float pt(std::size_t i) const { return mPt[i]; }
+
+  /// Δφ in [-π/2, 3π/2) and Δη = η_assoc - η_trig of all the associated tracks with respect to a trigger.
+  /// Δφ is φ_assoc - φ_trig, or φ_trig - φ_assoc with TriggerMinusAssociated (as stored by some correlators).
+  /// For azimuthal angles in [0, 2π) Δφ is the one of RecoDecay::constrainAngle(Δφ, -π/2).
+  template <bool TriggerMinusAssociated = false>
+  void correlate(float phiTrig, float etaTrig)
+  {
+    const std::size_t n = size();
+    mDeltaPhi.resize(n);
+    mDeltaEta.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      mDeltaPhi[i] = constrainDeltaPhi(TriggerMinusAssociated ? static_cast<double>(phiTrig) - mPhi[i] : static_cast<double>(mPhi[i]) - phiTrig);
+      mDeltaEta[i] = mEta[i] - etaTrig;
+    }
+  }
+
+  float deltaPhi(std::size_t i) const { return mDeltaPhi[i]; }
+  float deltaEta(std::size_t i) const { return mDeltaEta[i]; }
+
+ private:
+  std::vector<int64_t> mGlobalIndex;
+  std::vector<float> mPhi;
+  std::vector<float> mEta;
+  std::vector<float> mPt;
+  std::vector<float> mDeltaPhi; // with respect to the last trigger passed to correlate()
+  std::vector<float> mDeltaEta;
+};
+
+/// Pairs of a trigger of a compact pair output (columns of hf_correlation_compact) with the associated tracks of its
+/// event, with the kinematics computed as in AssociatedTracks::correlate().
+/// f(deltaPhi, deltaEta, ptHadron) is called for each associated track which is not a daughter of the trigger.
+template <bool TriggerMinusAssociated = false, typename TTrig, typename TAssocs, typename F>
+void forEachPair(TTrig const& trig, TAssocs const& assocs, F&& f)
+{
+  const float phiTrig = trig.phi();
+  const float etaTrig = trig.eta();
+  for (int row = trig.assocStart(); row < trig.assocEnd(); ++row) {
+    if (row == trig.daughterAssoc0() || row == trig.daughterAssoc1() || row == trig.daughterAssoc2()) {
+      continue;
+    }
+    const auto assoc = assocs.rawIteratorAt(row);
+    const float phiAssoc = assoc.phi();
+    const float deltaPhi = constrainDeltaPhi(TriggerMinusAssociated ? static_cast<double>(phiTrig) - phiAssoc : static_cast<double>(phiAssoc) - phiTrig);
+    const float deltaEta = assoc.eta() - etaTrig;
+    f(deltaPhi, deltaEta, assoc.ptH());
+  }
+}
+
+} // namespace o2::analysis::hf_correlations
+
+#endif // PWGHF_HFC_UTILS_UTILSCORRELATIONS_H_
@@ -43,6 +43,7 @@
 #include "PWGHF/Utils/utilsBfieldCCDB.h"
 #include "PWGHF/Utils/utilsEvSelHf.h"
 #include "PWGHF/Utils/utilsTrkCandHf.h"
+#include "PWGHF/Utils/utilsVertexingHf.h"
 
 using namespace o2;
 using namespace o2::analysis;
@@ -75,6 +76,7 @@ struct HfCandidateCreator2Prong {
   Configurable<double> minParamChange{"minParamChange", 1.e-3, "stop iterations if largest change of any X is smaller than this"};
   Configurable<double> minRelChi2Change{"minRelChi2Change", 0.9, "stop iterations is chi2/chi2old > this"};
   Configurable<bool> fillHistograms{"fillHistograms", true, "do validation plots"};
+  Configurable<int> nThreadsVertexing{"nThreadsVertexing", 1, "number of threads for the DCAFitterN vertex fits of a dataframe"};
   // magnetic field setting from CCDB
   Configurable<bool> isRun2{"isRun2", false, "enable Run 2 or Run 3 GRP objects for magnetic field"};
   Configurable<std::string> ccdbUrl{"ccdbUrl", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
@@ -82,7 +84,9 @@ struct HfCandidateCreator2Prong {
   Configurable<std::string> ccdbPathGrp{"ccdbPathGrp", "GLO/GRP/GRP", "Path of the grp file (Run 2)"};
   Configurable<std::string> ccdbPathGrpMag{"ccdbPathGrpMag", "GLO/Config/GRPMagField", "CCDB path of the GRPMagField object (Run 3)"};
 
-  o2::vertexing::DCAFitterN<2> df; // 2-prong vertex fitter
+  o2::vertexing::DCAFitterN<2> df;                                          // 2-prong vertex fitter
+  std::vector<o2::hf_vertexing::Fit<o2::vertexing::DCAFitterN<2>, 2>> fits; // inputs and outputs of the vertex fits of a dataframe
+  std::vector<int64_t> fitIndices;                                          // index in fits of each candidate row, -1 if not fitted
   Service<o2::ccdb::BasicCCDBManager> ccdb;
   o2::base::MatLayerCylSet* lut;
   o2::base::Propagator::MatCorrType matCorr = o2::base::Propagator::MatCorrType::USEMatCorrLUT;
@@ -186,8 +190,11 @@ struct HfCandidateCreator2Prong {
                                       TTracks const&,
                                       aod::BCsWithTimestamps const&)
   {
-    // loop over pairs of track indices
+    // collect the fit inputs of the candidates in selected collisions
+    fits.clear();
+    fitIndices.clear();
     for (const auto& rowTrackIndexProng2 : rowsTrackIndexProng2) {
+      fitIndices.push_back(-1);
 
       /// reject candidates not satisfying the event selections
       auto collision = rowTrackIndexProng2.template collision_as<Coll>();
@@ -200,8 +207,6 @@ struct HfCandidateCreator2Prong {
 
       auto track0 = rowTrackIndexProng2.template prong0_as<TTracks>();
       auto track1 = rowTrackIndexProng2.template prong1_as<TTracks>();
-      auto trackParVarPos1 = getTrackParCov(track0);
-      auto trackParVarNeg1 = getTrackParCov(track1);
 
       /// Set the magnetic field from ccdb.
       /// The static instance of the propagator was already modified in the HFTrackIndexSkimCreator,
@@ -215,30 +220,48 @@ struct HfCandidateCreator2Prong {
         // df.setBz(bz); /// put it outside the 'if'! Otherwise we have a difference wrt bz Configurable (< 1 permille) in Run2 conv. data
         // df.print();
       }
-      df.setBz(bz);
+      fitIndices.back() = fits.size();
+      auto& fit = fits.emplace_back();
+      fit.tracks = {getTrackParCov(track0), getTrackParCov(track1)};
+      fit.bz = bz;
+    }
+
+    // reconstruct the 2-prong secondary vertices, possibly in parallel
+    o2::hf_vertexing::runFits(df, fits, nThreadsVertexing);
+
+    // fill the tables in the input order
+    std::size_t iRow = 0;
+    for (const auto& rowTrackIndexProng2 : rowsTrackIndexProng2) {
+      const auto fitIndex = fitIndices[iRow++];
+      if (fitIndex < 0) {
+        continue;
+      }
+      const auto& fit = fits[fitIndex];
+      auto collision = rowTrackIndexProng2.template collision_as<Coll>();
+      auto track0 = rowTrackIndexProng2.template prong0_as<TTracks>();
+      auto track1 = rowTrackIndexProng2.template prong1_as<TTracks>();
+      const double bzCand = fit.bz;
 
-      // reconstruct the 2-prong secondary vertex
       hCandidates->Fill(SVFitting::BeforeFit);
-      try {
-        if (df.process(trackParVarPos1, trackParVarNeg1) == 0) {
-          continue;
-        }
-      } catch (const std::runtime_error& error) {
-        LOG(info) << "Run time error found: " << error.what() << ". DCFitterN cannot work, skipping the candidate.";
+      if (fit.status == o2::hf_vertexing::FitStatus::NoVertex) {
+        continue;
+      }
+      if (fit.status == o2::hf_vertexing::FitStatus::Error) {
+        LOG(info) << "Run time error found: " << fit.error << ". DCFitterN cannot work, skipping the candidate.";
         hCandidates->Fill(SVFitting::Fail);
         continue;
       }
       hCandidates->Fill(SVFitting::FitOk);
 
-      const auto& secondaryVertex = df.getPCACandidate();
-      auto chi2PCA = df.getChi2AtPCACandidate();
-      auto covMatrixPCA = df.calcPCACovMatrixFlat();
+      const auto& secondaryVertex = fit.secondaryVertex;
+      auto chi2PCA = fit.chi2PCA;
+      auto covMatrixPCA = fit.covMatrixPCA;
       registry.fill(HIST("hCovSVXX"), covMatrixPCA[0]); // FIXME: Calculation of errorDecayLength(XY) gives wrong values without this line.
       registry.fill(HIST("hCovSVYY"), covMatrixPCA[2]);
       registry.fill(HIST("hCovSVXZ"), covMatrixPCA[3]);
       registry.fill(HIST("hCovSVZZ"), covMatrixPCA[5]);
-      auto trackParVar0 = df.getTrack(0);
-      auto trackParVar1 = df.getTrack(1);
+      auto trackParVar0 = fit.tracksAtPCA[0];
+      auto trackParVar1 = fit.tracksAtPCA[1];
 
       // get track momenta
       std::array<float, 3> pvec0;
@@ -272,8 +295,8 @@ struct HfCandidateCreator2Prong {
       registry.fill(HIST("hCovPVZZ"), covMatrixPV[5]);
       o2::dataformats::DCA impactParameter0;
       o2::dataformats::DCA impactParameter1;
-      trackParVar0.propagateToDCA(primaryVertex, bz, &impactParameter0);
-      trackParVar1.propagateToDCA(primaryVertex, bz, &impactParameter1);
+      trackParVar0.propagateToDCA(primaryVertex, bzCand, &impactParameter0);
+      trackParVar1.propagateToDCA(primaryVertex, bzCand, &impactParameter1);
       registry.fill(HIST("hDcaXYProngs"), track0.pt(), impactParameter0.getY() * toMicrometers);
       registry.fill(HIST("hDcaXYProngs"), track1.pt(), impactParameter1.getY() * toMicrometers);
       registry.fill(HIST("hDcaZProngs"), track0.pt(), impactParameter0.getZ() * toMicrometers);
@@ -667,6 +690,7 @@ struct HfCandidateCreator2ProngExpressions {
   Produces<aod::HfCand2ProngMcGen> rowMcMatchGen;
 
   float zPvPosMax{1000.f};
+  McDecayTree mcDecayTree; // decay-tree index of the MC particles of the dataframe
 
   // inspect for which zPvPosMax cut was set for reconstructed
   void init(InitContext& initContext)
@@ -691,6 +715,7 @@ struct HfCandidateCreator2ProngExpressions {
                  aod::McCollisions const&)
   {
     rowCandidateProng2->bindExternalIndices(&tracks);
+    mcDecayTree.build(mcParticles);
 
     int indexRec = -1;
     int8_t sign = 0;
@@ -706,14 +731,14 @@ struct HfCandidateCreator2ProngExpressions {
       auto arrayDaughters = std::array{candidate.prong0_as<aod::TracksWMc>(), candidate.prong1_as<aod::TracksWMc>()};
 
       // D0(bar) → π± K∓
-      indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, Pdg::kD0, std::array{+kPiPlus, -kKPlus}, true, &sign);
+      indexRec = RecoDecay::getMatchedMCRec(mcDecayTree, arrayDaughters, Pdg::kD0, std::array{+kPiPlus, -kKPlus}, true, &sign);
       if (indexRec > -1) {
         flag = sign * (1 << DecayType::D0ToPiK);
       }
 
       // J/ψ → e+ e−
       if (flag == 0) {
-        indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, Pdg::kJPsi, std::array{+kElectron, -kElectron}, true);
+        indexRec = RecoDecay::getMatchedMCRec(mcDecayTree, arrayDaughters, Pdg::kJPsi, std::array{+kElectron, -kElectron}, true);
         if (indexRec > -1) {
           flag = 1 << DecayType::JpsiToEE;
         }
@@ -721,7 +746,7 @@ struct HfCandidateCreator2ProngExpressions {
 
       // J/ψ → μ+ μ−
       if (flag == 0) {
-        indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, Pdg::kJPsi, std::array{+kMuonPlus, -kMuonPlus}, true);
+        indexRec = RecoDecay::getMatchedMCRec(mcDecayTree, arrayDaughters, Pdg::kJPsi, std::array{+kMuonPlus, -kMuonPlus}, true);
         if (indexRec > -1) {
           flag = 1 << DecayType::JpsiToMuMu;
         }
@@ -31,6 +31,7 @@
 #include "PWGHF/Utils/utilsBfieldCCDB.h"
 #include "PWGHF/Utils/utilsEvSelHf.h"
 #include "PWGHF/Utils/utilsTrkCandHf.h"
+#include "PWGHF/Utils/utilsVertexingHf.h"
 
 using namespace o2;
 using namespace o2::analysis;
@@ -62,6 +63,7 @@ struct HfCandidateCreator3Prong {
   Configurable<double> minParamChange{"minParamChange", 1.e-3, "stop iterations if largest change of any X is smaller than this"};
   Configurable<double> minRelChi2Change{"minRelChi2Change", 0.9, "stop iterations is chi2/chi2old > this"};
   Configurable<bool> fillHistograms{"fillHistograms", true, "do validation plots"};
+  Configurable<int> nThreadsVertexing{"nThreadsVertexing", 1, "number of threads for the DCAFitterN vertex fits of a dataframe"};
   // magnetic field setting from CCDB
   Configurable<bool> isRun2{"isRun2", false, "enable Run 2 or Run 3 GRP objects for magnetic field"};
   Configurable<std::string> ccdbUrl{"ccdbUrl", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
@@ -74,7 +76,9 @@ struct HfCandidateCreator3Prong {
   Configurable<bool> createLc{"createLc", false, "enable Lc+/- candidate creation"};
   Configurable<bool> createXic{"createXic", false, "enable Xic+/- candidate creation"};
 
-  o2::vertexing::DCAFitterN<3> df; // 3-prong vertex fitter
+  o2::vertexing::DCAFitterN<3> df;                                          // 3-prong vertex fitter
+  std::vector<o2::hf_vertexing::Fit<o2::vertexing::DCAFitterN<3>, 3>> fits; // inputs and outputs of the vertex fits of a dataframe
+  std::vector<int64_t> fitIndices;                                          // index in fits of each candidate row, -1 if not fitted
   Service<o2::ccdb::BasicCCDBManager> ccdb;
   o2::base::MatLayerCylSet* lut;
   o2::base::Propagator::MatCorrType matCorr = o2::base::Propagator::MatCorrType::USEMatCorrLUT;
@@ -178,8 +182,11 @@ struct HfCandidateCreator3Prong {
                         aod::TracksWCovExtra const&,
                         aod::BCsWithTimestamps const&)
   {
-    // loop over triplets of track indices
+    // collect the fit inputs of the candidates in selected collisions
+    fits.clear();
+    fitIndices.clear();
     for (const auto& rowTrackIndexProng3 : rowsTrackIndexProng3) {
+      fitIndices.push_back(-1);
 
       /// reject candidates in collisions not satisfying the event selections
       auto collision = rowTrackIndexProng3.template collision_as<Coll>();
@@ -193,9 +200,6 @@ struct HfCandidateCreator3Prong {
       auto track0 = rowTrackIndexProng3.template prong0_as<aod::TracksWCovExtra>();
       auto track1 = rowTrackIndexProng3.template prong1_as<aod::TracksWCovExtra>();
       auto track2 = rowTrackIndexProng3.template prong2_as<aod::TracksWCovExtra>();
-      auto trackParVar0 = getTrackParCov(track0);
-      auto trackParVar1 = getTrackParCov(track1);
-      auto trackParVar2 = getTrackParCov(track2);
 
       /// Set the magnetic field from ccdb.
       /// The static instance of the propagator was already modified in the HFTrackIndexSkimCreator,
@@ -209,31 +213,50 @@ struct HfCandidateCreator3Prong {
         // df.setBz(bz); /// put it outside the 'if'! Otherwise we have a difference wrt bz Configurable (< 1 permille) in Run2 conv. data
         // df.print();
       }
-      df.setBz(bz);
+      fitIndices.back() = fits.size();
+      auto& fit = fits.emplace_back();
+      fit.tracks = {getTrackParCov(track0), getTrackParCov(track1), getTrackParCov(track2)};
+      fit.bz = bz;
+    }
+
+    // reconstruct the 3-prong secondary vertices, possibly in parallel
+    o2::hf_vertexing::runFits(df, fits, nThreadsVertexing);
+
+    // fill the tables in the input order
+    std::size_t iRow = 0;
+    for (const auto& rowTrackIndexProng3 : rowsTrackIndexProng3) {
+      const auto fitIndex = fitIndices[iRow++];
+      if (fitIndex < 0) {
+        continue;
+      }
+      const auto& fit = fits[fitIndex];
+      auto collision = rowTrackIndexProng3.template collision_as<Coll>();
+      auto track0 = rowTrackIndexProng3.template prong0_as<aod::TracksWCovExtra>();
+      auto track1 = rowTrackIndexProng3.template prong1_as<aod::TracksWCovExtra>();
+      auto track2 = rowTrackIndexProng3.template prong2_as<aod::TracksWCovExtra>();
+      const double bzCand = fit.bz;
 
-      // reconstruct the 3-prong secondary vertex
       hCandidates->Fill(SVFitting::BeforeFit);
-      try {
-        if (df.process(trackParVar0, trackParVar1, trackParVar2) == 0) {
-          continue;
-        }
-      } catch (const std::runtime_error& error) {
-        LOG(info) << "Run time error found: " << error.what() << ". DCFitterN cannot work, skipping the candidate.";
+      if (fit.status == o2::hf_vertexing::FitStatus::NoVertex) {
+        continue;
+      }
+      if (fit.status == o2::hf_vertexing::FitStatus::Error) {
+        LOG(info) << "Run time error found: " << fit.error << ". DCFitterN cannot work, skipping the candidate.";
         hCandidates->Fill(SVFitting::Fail);
         continue;
       }
       hCandidates->Fill(SVFitting::FitOk);
 
-      const auto& secondaryVertex = df.getPCACandidate();
-      auto chi2PCA = df.getChi2AtPCACandidate();
-      auto covMatrixPCA = df.calcPCACovMatrixFlat();
+      const auto& secondaryVertex = fit.secondaryVertex;
+      auto chi2PCA = fit.chi2PCA;
+      auto covMatrixPCA = fit.covMatrixPCA;
       registry.fill(HIST("hCovSVXX"), covMatrixPCA[0]); // FIXME: Calculation of errorDecayLength(XY) gives wrong values without this line.
       registry.fill(HIST("hCovSVYY"), covMatrixPCA[2]);
       registry.fill(HIST("hCovSVXZ"), covMatrixPCA[3]);
       registry.fill(HIST("hCovSVZZ"), covMatrixPCA[5]);
-      trackParVar0 = df.getTrack(0);
-      trackParVar1 = df.getTrack(1);
-      trackParVar2 = df.getTrack(2);
+      auto trackParVar0 = fit.tracksAtPCA[0];
+      auto trackParVar1 = fit.tracksAtPCA[1];
+      auto trackParVar2 = fit.tracksAtPCA[2];
 
       // get track momenta
       std::array<float, 3> pvec0;
@@ -270,9 +293,9 @@ struct HfCandidateCreator3Prong {
       o2::dataformats::DCA impactParameter0;
       o2::dataformats::DCA impactParameter1;
       o2::dataformats::DCA impactParameter2;
-      trackParVar0.propagateToDCA(primaryVertex, bz, &impactParameter0);
-      trackParVar1.propagateToDCA(primaryVertex, bz, &impactParameter1);
-      trackParVar2.propagateToDCA(primaryVertex, bz, &impactParameter2);
+      trackParVar0.propagateToDCA(primaryVertex, bzCand, &impactParameter0);
+      trackParVar1.propagateToDCA(primaryVertex, bzCand, &impactParameter1);
+      trackParVar2.propagateToDCA(primaryVertex, bzCand, &impactParameter2);
       registry.fill(HIST("hDcaXYProngs"), track0.pt(), impactParameter0.getY() * toMicrometers);
       registry.fill(HIST("hDcaXYProngs"), track1.pt(), impactParameter1.getY() * toMicrometers);
       registry.fill(HIST("hDcaXYProngs"), track2.pt(), impactParameter2.getY() * toMicrometers);
@@ -471,6 +494,7 @@ struct HfCandidateCreator3ProngExpressions {
   bool createLc{false};
   bool createXic{false};
   float zPvPosMax{1000.f};
+  McDecayTree mcDecayTree; // decay-tree index of the MC particles of the dataframe
 
   void init(InitContext& initContext)
   {
@@ -509,6 +533,7 @@ struct HfCandidateCreator3ProngExpressions {
                  aod::McCollisions const&)
   {
     rowCandidateProng3->bindExternalIndices(&tracks);
+    mcDecayTree.build(mcParticles);
 
     int indexRec = -1;
     int8_t sign = 0;
@@ -536,7 +561,7 @@ struct HfCandidateCreator3ProngExpressions {
 
       // D± → π± K∓ π±
       if (createDplus) {
-        indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, Pdg::kDPlus, std::array{+kPiPlus, -kKPlus, +kPiPlus}, true, &sign, 2);
+        indexRec = RecoDecay::getMatchedMCRec(mcDecayTree, arrayDaughters, Pdg::kDPlus, std::array{+kPiPlus, -kKPlus, +kPiPlus}, true, &sign, 2);
         if (indexRec > -1) {
           flag = sign * (1 << DecayType::DplusToPiKPi);
         }
@@ -545,10 +570,10 @@ struct HfCandidateCreator3ProngExpressions {
       // Ds± → K± K∓ π± and D± → K± K∓ π±
       if (flag == 0 && createDs) {
         bool isDplus = false;
-        indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, Pdg::kDS, std::array{+kKPlus, -kKPlus, +kPiPlus}, true, &sign, 2);
+        indexRec = RecoDecay::getMatchedMCRec(mcDecayTree, arrayDaughters, Pdg::kDS, std::array{+kKPlus, -kKPlus, +kPiPlus}, true, &sign, 2);
         if (indexRec == -1) {
           isDplus = true;
-          indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, Pdg::kDPlus, std::array{+kKPlus, -kKPlus, +kPiPlus}, true, &sign, 2);
+          indexRec = RecoDecay::getMatchedMCRec(mcDecayTree, arrayDaughters, Pdg::kDPlus, std::array{+kKPlus, -kKPlus, +kPiPlus}, true, &sign, 2);
         }
         if (indexRec > -1) {
           // DecayType::DsToKKPi is used to flag both Ds± → K± K∓ π± and D± → K± K∓ π±
@@ -574,7 +599,7 @@ struct HfCandidateCreator3ProngExpressions {
 
       // Λc± → p± K∓ π±
       if (flag == 0 && createLc) {
-        indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, Pdg::kLambdaCPlus, std::array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2);
+        indexRec = RecoDecay::getMatchedMCRec(mcDecayTree, arrayDaughters, Pdg::kLambdaCPlus, std::array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2);
         if (indexRec > -1) {
           flag = sign * (1 << DecayType::LcToPKPi);
 
@@ -601,7 +626,7 @@ struct HfCandidateCreator3ProngExpressions {
 
       // Ξc± → p± K∓ π±
       if (flag == 0 && createXic) {
-        indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, Pdg::kXiCPlus, std::array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2);
+        indexRec = RecoDecay::getMatchedMCRec(mcDecayTree, arrayDaughters, Pdg::kXiCPlus, std::array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2);
         if (indexRec > -1) {
           flag = sign * (1 << DecayType::XicToPKPi);
         }
@@ -174,6 +174,7 @@ struct HfCandidateCreatorB0 {
 
     static int ncol = 0;
 
+    std::vector<TracksWithSel::iterator> bachelorPions;
     for (const auto& collision : collisions) {
       auto primaryVertex = getPrimaryVertex(collision);
       auto covMatrixPV = primaryVertex.getCov();
@@ -199,6 +200,24 @@ struct HfCandidateCreatorB0 {
       auto thisCollId = collision.globalIndex();
       auto candsDThisColl = candsD.sliceBy(candsDPerCollision, thisCollId);
 
+      // bachelor pions of this collision, selected once for all the D candidates
+      bachelorPions.clear();
+      auto trackIdsThisCollision = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
+      for (const auto& trackId : trackIdsThisCollision) { // start loop over track indices associated to this collision
+        auto trackPion = trackId.track_as<TracksWithSel>();
+
+        // check isGlobalTrackWoDCA status for pions if wanted
+        if (usePionIsGlobalTrackWoDCA && !trackPion.isGlobalTrackWoDCA()) {
+          continue;
+        }
+
+        // minimum pT selection
+        if (trackPion.pt() < ptPionMin || !isSelectedTrackDCA(trackPion)) {
+          continue;
+        }
+        bachelorPions.push_back(trackPion);
+      }
+
       for (const auto& candD : candsDThisColl) { // start loop over filtered D candidates indices as associated to this collision in candidateCreator3Prong.cxx
         hMassDToPiKPi->Fill(hfHelper.invMassDplusToPiKPi(candD), candD.pt());
         hPtD->Fill(candD.pt());
@@ -268,20 +287,7 @@ struct HfCandidateCreatorB0 {
         int indexTrack1 = track1.globalIndex();
         int indexTrack2 = track2.globalIndex();
 
-        auto trackIdsThisCollision = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
-
-        for (const auto& trackId : trackIdsThisCollision) { // start loop over track indices associated to this collision
-          auto trackPion = trackId.track_as<TracksWithSel>();
-
-          // check isGlobalTrackWoDCA status for pions if wanted
-          if (usePionIsGlobalTrackWoDCA && !trackPion.isGlobalTrackWoDCA()) {
-            continue;
-          }
-
-          // minimum pT selection
-          if (trackPion.pt() < ptPionMin || !isSelectedTrackDCA(trackPion)) {
-            continue;
-          }
+        for (const auto& trackPion : bachelorPions) { // start loop over the bachelor pions of this collision
           // reject pions that are D daughters
           if (trackPion.globalIndex() == indexTrack0 || trackPion.globalIndex() == indexTrack1 || trackPion.globalIndex() == indexTrack2) {
             continue;
@@ -175,6 +175,7 @@ struct HfCandidateCreatorBplus {
 
     static int nCol = 0;
 
+    std::vector<TracksWithSel::iterator> bachelorPions;
     for (const auto& collision : collisions) {
       auto primaryVertex = getPrimaryVertex(collision);
 
@@ -199,6 +200,28 @@ struct HfCandidateCreatorBplus {
       auto thisCollId = collision.globalIndex();
       auto candsDThisColl = candsD.sliceBy(candsDPerCollision, thisCollId);
 
+      // bachelor pions of this collision, selected once for all the D candidates
+      bachelorPions.clear();
+      auto trackIdsThisCollision = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
+      for (const auto& trackId : trackIdsThisCollision) { // start loop over track indices associated to this collision
+        auto trackPion = trackId.track_as<TracksWithSel>();
+
+        // check isGlobalTrackWoDCA status for pions if wanted
+        if (usePionIsGlobalTrackWoDCA && !trackPion.isGlobalTrackWoDCA()) {
+          continue;
+        }
+
+        // minimum pT selection
+        if (trackPion.pt() < ptPionMin || !isSelectedTrack(trackPion)) {
+          continue;
+        }
+
+        if (etaTrackMax >= 0. && std::abs(trackPion.eta()) > etaTrackMax) {
+          continue;
+        }
+        bachelorPions.push_back(trackPion);
+      }
+
       // loop over pairs of track indices
       for (const auto& candD0 : candsDThisColl) {
 
@@ -259,36 +282,18 @@ struct HfCandidateCreatorBplus {
         int indexTrack0 = prong0.globalIndex();
         int indexTrack1 = prong1.globalIndex();
 
-        auto trackIdsThisCollision = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
-
         // loop over tracks pi
-        for (const auto& trackId : trackIdsThisCollision) { // start loop over track indices associated to this collision
-          auto trackPion = trackId.track_as<TracksWithSel>();
-
-          // check isGlobalTrackWoDCA status for pions if wanted
-          if (usePionIsGlobalTrackWoDCA && !trackPion.isGlobalTrackWoDCA()) {
-            continue;
-          }
-
+        for (const auto& trackPion : bachelorPions) { // start loop over the bachelor pions of this collision
           // Select D0pi- and D0(bar)pi+ pairs only
           if (!((candD0.isSelD0() >= selectionFlagD0 && trackPion.sign() < 0) || (candD0.isSelD0bar() >= selectionFlagD0bar && trackPion.sign() > 0))) {
             // LOGF(debug, "D0: %d, D0bar%d, sign: %d", candD0.isSelD0(), candD0.isSelD0bar(), track.sign());
             continue;
           }
 
-          // minimum pT selection
-          if (trackPion.pt() < ptPionMin || !isSelectedTrack(trackPion)) {
-            continue;
-          }
-
           if (indexTrack0 == trackPion.globalIndex() || indexTrack1 == trackPion.globalIndex()) {
             continue; // different id between D0 daughters and bachelor track
           }
 
-          if (etaTrackMax >= 0. && std::abs(trackPion.eta()) > etaTrackMax) {
-            continue;
-          }
-
           hEtaPi->Fill(trackPion.eta());
 
           auto trackParCovPi = getTrackParCov(trackPion);
@@ -162,6 +162,7 @@ struct HfCandidateCreatorBs {
                TracksWithSel const&,
                aod::BCsWithTimestamps const&)
   {
+    std::vector<TracksWithSel::iterator> bachelorPions;
     for (const auto& collision : collisions) {
       auto primaryVertex = getPrimaryVertex(collision);
       auto covMatrixPV = primaryVertex.getCov();
@@ -182,6 +183,24 @@ struct HfCandidateCreatorBs {
       auto thisCollId = collision.globalIndex();
       auto candsDsThisColl = candsDs.sliceBy(candsDsPerCollision, thisCollId);
 
+      // bachelor pions of this collision, selected once for all the D candidates
+      bachelorPions.clear();
+      auto trackIdsThisCollision = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
+      for (const auto& trackId : trackIdsThisCollision) { // start loop over track indices associated to this collision
+        auto trackPion = trackId.track_as<TracksWithSel>();
+
+        // check isGlobalTrackWoDCA status for pions if wanted
+        if (usePionIsGlobalTrackWoDCA && !trackPion.isGlobalTrackWoDCA()) {
+          continue;
+        }
+
+        // minimum pT selection
+        if (trackPion.pt() < ptPionMin || !isSelectedTrackDCA(trackPion)) {
+          continue;
+        }
+        bachelorPions.push_back(trackPion);
+      }
+
       for (const auto& candDs : candsDsThisColl) { // start loop over filtered Ds candidates indices as associated to this collision in candidateCreator3Prong.cxx
 
         // track0 <-> K, track1 <-> K, track2 <-> pi
@@ -250,20 +269,7 @@ struct HfCandidateCreatorBs {
         int indexTrack1 = track1.globalIndex();
         int indexTrack2 = track2.globalIndex();
 
-        auto trackIdsThisCollision = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
-
-        for (const auto& trackId : trackIdsThisCollision) { // start loop over track indices associated to this collision
-          auto trackPion = trackId.track_as<TracksWithSel>();
-
-          // check isGlobalTrackWoDCA status for pions if wanted
-          if (usePionIsGlobalTrackWoDCA && !trackPion.isGlobalTrackWoDCA()) {
-            continue;
-          }
-
-          // minimum pT selection
-          if (trackPion.pt() < ptPionMin || !isSelectedTrackDCA(trackPion)) {
-            continue;
-          }
+        for (const auto& trackPion : bachelorPions) { // start loop over the bachelor pions of this collision
           // reject pions that are Ds daughters
           if (trackPion.globalIndex() == indexTrack0 || trackPion.globalIndex() == indexTrack1 || trackPion.globalIndex() == indexTrack2) {
             continue;
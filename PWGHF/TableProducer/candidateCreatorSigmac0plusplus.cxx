@@ -81,6 +81,22 @@ struct HfCandidateCreatorSigmac0plusplus {
 
   using CandidatesLc = soa::Filtered<soa::Join<aod::HfCand3Prong, aod::HfSelLc>>;
 
+  /// Candidate Λc+ of the current collision passing the selections for the Σc0,++ creation
+  struct LcForSigmac {
+    int64_t globalIndex = -1;
+    int64_t collisionId = -1;
+    std::array<int64_t, 3> indexProngs{};
+    float px = 0.f;
+    float py = 0.f;
+    float pz = 0.f;
+    uint8_t hfflag = 0;
+    int8_t charge = 0;
+    int statusSpreadMinvPKPiFromPDG = 0;
+    int statusSpreadMinvPiKPFromPDG = 0;
+  };
+  std::vector<LcForSigmac> lcPool; // reused across collisions
+  int nLcThisColl = 0;             // candidates Λc+ of the collision before the selections
+
   /// Filter the candidate Λc+ used for the Σc0,++ creation
   Filter filterSelectCandidateLc = (aod::hf_sel_candidate_lc::isSelLcToPKPi >= selectionFlagLc || aod::hf_sel_candidate_lc::isSelLcToPiKP >= selectionFlagLc);
 
@@ -161,16 +177,16 @@ struct HfCandidateCreatorSigmac0plusplus {
     runNumber = 0;
   }
 
-  /// @param trackSoftPi is the track (with dcaXY, dcaZ information)of a candidate soft-pion in the collision
-  /// @param candidates are 3-prong candidates satisfying the analysis selections for Λc+ → pK-π+ (and charge conj.)
-  /// @param tracks are the tracks (with dcaXY, dcaZ information) → soft-pion candidate tracks
-  template <typename TRK, typename CAND>
-  void makeSoftPiLcPair(TRK const& trackSoftPi, CAND const& candidatesThisColl, aod::TracksWDcaExtra const&)
+  /// @brief selects once per collision the candidates Λc+ → pK-π+ (and charge conj.) used for the Σc0,++ creation
+  /// @param candidatesThisColl are 3-prong candidates satisfying the analysis selections for Λc+ → pK-π+ (and charge conj.)
+  template <typename CAND>
+  void fillLcPool(CAND const& candidatesThisColl)
   {
+    lcPool.clear();
+    nLcThisColl = candidatesThisColl.size();
 
     /// loop over Λc+ → pK-π+ (and charge conj.) candidates
     for (const auto& candLc : candidatesThisColl) {
-      histos.fill(HIST("hCounter"), 4);
 
       /// keep only the candidates flagged as possible Λc+ (and charge conj.) decaying into a charged pion, kaon and proton
       /// if not selected, skip it and go to the next one
@@ -206,9 +222,37 @@ struct HfCandidateCreatorSigmac0plusplus {
         /// none of the two possibilities are satisfied, therefore this candidate Lc can be skipped
         continue;
       }
-      histos.fill(HIST("hCounter"), 5);
 
-      // auto trackSoftPi = tracks.rawIteratorAt(trackId.trackId());
+      const auto prong0 = candLc.template prong0_as<aod::TracksWDcaExtra>();
+      const auto prong1 = candLc.template prong1_as<aod::TracksWDcaExtra>();
+      const auto prong2 = candLc.template prong2_as<aod::TracksWDcaExtra>();
+      LcForSigmac& lc = lcPool.emplace_back();
+      lc.globalIndex = candLc.globalIndex();
+      lc.collisionId = candLc.collisionId();
+      lc.indexProngs = {prong0.globalIndex(), prong1.globalIndex(), prong2.globalIndex()};
+      lc.px = candLc.px();
+      lc.py = candLc.py();
+      lc.pz = candLc.pz();
+      lc.hfflag = candLc.hfflag();
+      lc.charge = prong0.sign() + prong1.sign() + prong2.sign();
+      lc.statusSpreadMinvPKPiFromPDG = statusSpreadMinvPKPiFromPDG;
+      lc.statusSpreadMinvPiKPFromPDG = statusSpreadMinvPiKPFromPDG;
+    } /// end loop over Λc+ → pK-π+ (and charge conj.) candidates
+  }
+
+  /// @param trackSoftPi is the track (with dcaXY, dcaZ information)of a candidate soft-pion in the collision
+  /// pairs it with the candidates Λc+ of the collision selected by fillLcPool
+  template <typename TRK>
+  void makeSoftPiLcPair(TRK const& trackSoftPi)
+  {
+    histos.fill(HIST("hCounter"), 4, nLcThisColl);
+    histos.fill(HIST("hCounter"), 5, lcPool.size());
+
+    const int64_t indexSoftPi = trackSoftPi.globalIndex();
+    const int chargeSoftPi = trackSoftPi.sign();
+
+    /// loop over Λc+ → pK-π+ (and charge conj.) candidates
+    for (const auto& lc : lcPool) {
 
       //////////////////////////////////////////////////////////////////////////////////////
       ///                       Σc0,++ candidate creation                                ///
@@ -217,49 +261,40 @@ struct HfCandidateCreatorSigmac0plusplus {
       //////////////////////////////////////////////////////////////////////////////////////
 
       /// Exclude the current candidate soft pion if it corresponds already to a candidate Lc prong
-      int indexProng0 = candLc.template prong0_as<aod::TracksWDcaExtra>().globalIndex();
-      int indexProng1 = candLc.template prong1_as<aod::TracksWDcaExtra>().globalIndex();
-      int indexProng2 = candLc.template prong2_as<aod::TracksWDcaExtra>().globalIndex();
-      int indexSoftPi = trackSoftPi.globalIndex();
-      if (indexSoftPi == indexProng0 || indexSoftPi == indexProng1 || indexSoftPi == indexProng2) {
+      if (indexSoftPi == lc.indexProngs[0] || indexSoftPi == lc.indexProngs[1] || indexSoftPi == lc.indexProngs[2]) {
         continue;
       }
       histos.fill(HIST("hCounter"), 6);
 
       /// determine the Σc candidate charge
-      int chargeLc = candLc.template prong0_as<aod::TracksWDcaExtra>().sign() + candLc.template prong1_as<aod::TracksWDcaExtra>().sign() + candLc.template prong2_as<aod::TracksWDcaExtra>().sign();
-      int chargeSoftPi = trackSoftPi.sign();
-      int8_t chargeSigmac = chargeLc + chargeSoftPi;
+      int8_t chargeSigmac = lc.charge + chargeSoftPi;
       if (std::abs(chargeSigmac) != 0 && std::abs(chargeSigmac) != 2) {
         /// this shall never happen
-        LOG(fatal) << ">>> Sc candidate with charge +1 built, not possible! Charge Lc: " << chargeLc << ", charge soft pion: " << chargeSoftPi;
+        LOG(fatal) << ">>> Sc candidate with charge +1 built, not possible! Charge Lc: " << lc.charge << ", charge soft pion: " << chargeSoftPi;
       }
       histos.fill(HIST("hCounter"), 7);
 
       /// fill the Σc0,++ candidate table
       rowScCandidates(/* general columns */
-                      candLc.collisionId(),
+                      lc.collisionId,
                       /* 2-prong specific columns */
-                      candLc.px(), candLc.py(), candLc.pz(),
+                      lc.px, lc.py, lc.pz,
                       trackSoftPi.px(), trackSoftPi.py(), trackSoftPi.pz(),
-                      candLc.globalIndex(), trackSoftPi.globalIndex(),
-                      candLc.hfflag(),
+                      lc.globalIndex, indexSoftPi,
+                      lc.hfflag,
                       /* Σc0,++ specific columns */
                       chargeSigmac,
-                      statusSpreadMinvPKPiFromPDG, statusSpreadMinvPiKPFromPDG);
+                      lc.statusSpreadMinvPKPiFromPDG, lc.statusSpreadMinvPiKPFromPDG);
     } /// end loop over Λc+ → pK-π+ (and charge conj.) candidates
   }   /// end makeSoftPiLcPair
 
   /// @brief function to loop over candidate soft pions and, for each of them, over candidate Λc+ for Σc0,++ → Λc+(→pK-π+) π- candidate reconstruction
   /// @param collision is a o2::aod::Collisions
   /// @param trackSoftPi is the track (with dcaXY, dcaZ information)of a candidate soft-pion in the collision
-  /// @param tracks are the tracks (with dcaXY, dcaZ information) → soft-pion candidate tracks
-  /// @param candidates are 3-prong candidates satisfying the analysis selections for Λc+ → pK-π+ (and charge conj.)
+  /// The candidates Λc+ of the collision are those selected by fillLcPool
   template <bool withTimeAssoc, typename TRK>
   void createSigmaC(aod::Collisions::iterator const& collision,
                     TRK const& trackSoftPi,
-                    aod::TracksWDcaExtra const& tracks,
-                    CandidatesLc const& candidates,
                     aod::BCsWithTimestamps const&)
   {
 
@@ -304,14 +339,7 @@ struct HfCandidateCreatorSigmac0plusplus {
     histos.fill(HIST("hCounter"), 3);
 
     /// loop over Λc+ → pK-π+ (and charge conj.) candidates
-    if constexpr (withTimeAssoc) {
-      /// need to group candidates manually
-      auto candidatesThisColl = candidates.sliceBy(hf3ProngPerCollision, thisCollId);
-      makeSoftPiLcPair(trackSoftPi, candidatesThisColl, tracks);
-    } else {
-      /// tracks and candidates already grouped by collision at the level of process function
-      makeSoftPiLcPair(trackSoftPi, candidates, tracks);
-    }
+    makeSoftPiLcPair(trackSoftPi);
 
   } /// end createSigmaC
 
@@ -322,7 +350,7 @@ struct HfCandidateCreatorSigmac0plusplus {
   /// @param candidates are 3-prong candidates satisfying the analysis selections for Λc+ → pK-π+ (and charge conj.)
   void processDataTrackToCollAssoc(aod::Collisions const& collisions,
                                    aod::TrackAssoc const& trackIndices,
-                                   aod::TracksWDcaExtra const& tracks,
+                                   aod::TracksWDcaExtra const&,
                                    CandidatesLc const& candidates,
                                    aod::BCsWithTimestamps const& bcWithTimeStamps)
   {
@@ -335,13 +363,20 @@ struct HfCandidateCreatorSigmac0plusplus {
       auto trackIdsThisCollision = trackIndices.sliceBy(trackIndicesPerCollision, collision.globalIndex());
       // LOG(info) << "[processDataTrackToCollAssoc]     - number of tracks: " << trackIdsThisCollision.size();
 
+      /// need to group candidates manually
+      auto candidatesThisColl = candidates.sliceBy(hf3ProngPerCollision, collision.globalIndex());
+      fillLcPool(candidatesThisColl);
+      if (lcPool.empty()) {
+        continue;
+      }
+
       /// loop over tracks for soft pion
       for (const auto& trackId : trackIdsThisCollision) {
         /// slice soft pion tracks associated to the current collision
         auto trackSoftPi = trackId.track_as<aod::TracksWDcaExtra>();
 
         /// create SigmaC candidate with the current soft pion and Lc candidates
-        createSigmaC<true>(collision, trackSoftPi, tracks, candidates, bcWithTimeStamps);
+        createSigmaC<true>(collision, trackSoftPi, bcWithTimeStamps);
 
       } /// end loop over tracks for soft pion
 
@@ -364,12 +399,18 @@ struct HfCandidateCreatorSigmac0plusplus {
     // LOG(info) << "[processDataNoTrackToCollAssoc]     - number of tracks: " << tracks.size();
     // LOG(info) << "[processDataNoTrackToCollAssoc]     - number of Lc candidates: " << candidates.size();
 
+    /// tracks and candidates already grouped by collision at the level of process function
+    fillLcPool(candidates);
+    if (lcPool.empty()) {
+      return;
+    }
+
     /// loop over tracks for soft pion
     /// In this case, they are already grouped by collision, using the track::CollisionId
     for (const auto& trackSoftPi : tracks) {
 
       /// create SigmaC candidate with the current soft pion and Lc candidates
-      createSigmaC<false>(collision, trackSoftPi, tracks, candidates, bcWithTimeStamps);
+      createSigmaC<false>(collision, trackSoftPi, bcWithTimeStamps);
 
     } /// end loop over tracks for soft pion
   }
@@ -79,6 +79,8 @@ struct HfCandidateSelectorD0 {
   o2::ccdb::CcdbApi ccdbApi;
   TrackSelectorPi selectorPion;
   TrackSelectorKa selectorKaon;
+  TrackSelectorPidCache<kPiPlus> cachePidPion; // PID statuses of the prong tracks, evaluated once per track and species
+  TrackSelectorPidCache<kKPlus> cachePidKaon;
   HfHelper hfHelper;
 
   using TracksSel = soa::Join<aod::TracksWDcaExtra, aod::TracksPidPi, aod::PidTpcTofFullPi, aod::TracksPidKa, aod::PidTpcTofFullKa>;
@@ -110,6 +112,8 @@ struct HfCandidateSelectorD0 {
     selectorPion.setRangeNSigmaTof(-nSigmaTofMax, nSigmaTofMax);
     selectorPion.setRangeNSigmaTofCondTpc(-nSigmaTofCombinedMax, nSigmaTofCombinedMax);
     selectorKaon = selectorPion;
+    cachePidPion.setSelector(selectorPion);
+    cachePidKaon.setSelector(selectorKaon);
 
     if (applyMl) {
       hfMlResponse.configure(binsPtMl, cutsMl, cutDirMl, nClassesMl);
@@ -185,10 +189,11 @@ struct HfCandidateSelectorD0 {
   /// \param candidate is candidate
   /// \param trackPion is the track with the pion hypothesis
   /// \param trackKaon is the track with the kaon hypothesis
+  /// \param kinematics are the invariant masses and cos(θ*) of the candidate in both hypotheses
   /// \note trackPion = positive and trackKaon = negative for D0 selection and inverse for D0bar
   /// \return true if candidate passes all cuts for the given Conjugate
   template <int reconstructionType, typename T1, typename T2>
-  bool selectionTopolConjugate(const T1& candidate, const T2& trackPion, const T2& trackKaon)
+  bool selectionTopolConjugate(const T1& candidate, const T2& trackPion, const T2& trackKaon, const HfHelper::KinematicsD0& kinematics)
   {
     auto candpT = candidate.pt();
     auto pTBin = findBin(binsPt, candpT);
@@ -202,8 +207,8 @@ struct HfCandidateSelectorD0 {
       massD0 = candidate.kfGeoMassD0();
       massD0bar = candidate.kfGeoMassD0bar();
     } else {
-      massD0 = hfHelper.invMassD0ToPiK(candidate);
-      massD0bar = hfHelper.invMassD0barToKPi(candidate);
+      massD0 = kinematics.invMassD0;
+      massD0bar = kinematics.invMassD0bar;
     }
     if (trackPion.sign() > 0) {
       if (std::abs(massD0 - o2::constants::physics::MassD0) > cuts->get(pTBin, "m")) {
@@ -227,11 +232,11 @@ struct HfCandidateSelectorD0 {
 
     // cut on cos(theta*)
     if (trackPion.sign() > 0) {
-      if (std::abs(hfHelper.cosThetaStarD0(candidate)) > cuts->get(pTBin, "cos theta*")) {
+      if (std::abs(kinematics.cosThetaStarD0) > cuts->get(pTBin, "cos theta*")) {
         return false;
       }
     } else {
-      if (std::abs(hfHelper.cosThetaStarD0bar(candidate)) > cuts->get(pTBin, "cos theta*")) {
+      if (std::abs(kinematics.cosThetaStarD0bar) > cuts->get(pTBin, "cos theta*")) {
         return false;
       }
     }
@@ -239,11 +244,11 @@ struct HfCandidateSelectorD0 {
     // in case only sideband candidates have to be stored, additional invariant-mass cut
     if (keepOnlySidebandCandidates) {
       if (trackPion.sign() > 0) {
-        if (std::abs(hfHelper.invMassD0ToPiK(candidate) - o2::constants::physics::MassD0) < distanceFromD0MassForSidebands) {
+        if (std::abs(kinematics.invMassD0 - o2::constants::physics::MassD0) < distanceFromD0MassForSidebands) {
           return false;
         }
       } else {
-        if (std::abs(hfHelper.invMassD0barToKPi(candidate) - o2::constants::physics::MassD0) < distanceFromD0MassForSidebands) {
+        if (std::abs(kinematics.invMassD0bar - o2::constants::physics::MassD0) < distanceFromD0MassForSidebands) {
           return false;
         }
       }
@@ -253,8 +258,10 @@ struct HfCandidateSelectorD0 {
   }
   template <int reconstructionType, typename CandType>
   void processSel(CandType const& candidates,
-                  TracksSel const&)
+                  TracksSel const& tracks)
   {
+    cachePidPion.reset(tracks.size());
+    cachePidKaon.reset(tracks.size());
     // looping over 2-prong candidates
     for (const auto& candidate : candidates) {
 
@@ -295,10 +302,12 @@ struct HfCandidateSelectorD0 {
       // implement filter bit 4 cut - should be done before this task at the track selection level
       // need to add special cuts (additional cuts on decay length and d0 norm)
 
+      // masses and cos(θ*) of both hypotheses, computed once for both conjugates
+      const auto kinematics = hfHelper.kinematicsD0(candidate);
       // conjugate-dependent topological selection for D0
-      bool topolD0 = selectionTopolConjugate<reconstructionType>(candidate, trackPos, trackNeg);
+      bool topolD0 = selectionTopolConjugate<reconstructionType>(candidate, trackPos, trackNeg, kinematics);
       // conjugate-dependent topological selection for D0bar
-      bool topolD0bar = selectionTopolConjugate<reconstructionType>(candidate, trackNeg, trackPos);
+      bool topolD0bar = selectionTopolConjugate<reconstructionType>(candidate, trackNeg, trackPos, kinematics);
 
       if (!topolD0 && !topolD0bar) {
         hfSelD0Candidate(statusD0, statusD0bar, statusHFFlag, statusTopol, statusCand, statusPID);
@@ -317,20 +326,20 @@ struct HfCandidateSelectorD0 {
         int pidTrackNegPion = -1;
 
         if (usePidTpcOnly) {
-          pidTrackPosKaon = selectorKaon.statusTpc(trackPos);
-          pidTrackPosPion = selectorPion.statusTpc(trackPos);
-          pidTrackNegKaon = selectorKaon.statusTpc(trackNeg);
-          pidTrackNegPion = selectorPion.statusTpc(trackNeg);
+          pidTrackPosKaon = cachePidKaon.statusTpc(trackPos);
+          pidTrackPosPion = cachePidPion.statusTpc(trackPos);
+          pidTrackNegKaon = cachePidKaon.statusTpc(trackNeg);
+          pidTrackNegPion = cachePidPion.statusTpc(trackNeg);
         } else if (usePidTpcAndTof) {
-          pidTrackPosKaon = selectorKaon.statusTpcAndTof(trackPos);
-          pidTrackPosPion = selectorPion.statusTpcAndTof(trackPos);
-          pidTrackNegKaon = selectorKaon.statusTpcAndTof(trackNeg);
-          pidTrackNegPion = selectorPion.statusTpcAndTof(trackNeg);
+          pidTrackPosKaon = cachePidKaon.statusTpcAndTof(trackPos);
+          pidTrackPosPion = cachePidPion.statusTpcAndTof(trackPos);
+          pidTrackNegKaon = cachePidKaon.statusTpcAndTof(trackNeg);
+          pidTrackNegPion = cachePidPion.statusTpcAndTof(trackNeg);
         } else {
-          pidTrackPosKaon = selectorKaon.statusTpcOrTof(trackPos);
-          pidTrackPosPion = selectorPion.statusTpcOrTof(trackPos);
-          pidTrackNegKaon = selectorKaon.statusTpcOrTof(trackNeg);
-          pidTrackNegPion = selectorPion.statusTpcOrTof(trackNeg);
+          pidTrackPosKaon = cachePidKaon.statusTpcOrTof(trackPos);
+          pidTrackPosPion = cachePidPion.statusTpcOrTof(trackPos);
+          pidTrackNegKaon = cachePidKaon.statusTpcOrTof(trackNeg);
+          pidTrackNegPion = cachePidPion.statusTpcOrTof(trackNeg);
         }
 
         // int pidBayesTrackPos1Pion = selectorPion.statusBayes(trackPos);
@@ -406,13 +415,13 @@ struct HfCandidateSelectorD0 {
             registry.fill(HIST("DebugBdt/hBdtScore1VsStatus"), outputMlD0[0], statusD0);
             registry.fill(HIST("DebugBdt/hBdtScore2VsStatus"), outputMlD0[1], statusD0);
             registry.fill(HIST("DebugBdt/hBdtScore3VsStatus"), outputMlD0[2], statusD0);
-            registry.fill(HIST("DebugBdt/hMassDmesonSel"), hfHelper.invMassD0ToPiK(candidate));
+            registry.fill(HIST("DebugBdt/hMassDmesonSel"), kinematics.invMassD0);
           }
           if (isSelectedMlD0bar) {
             registry.fill(HIST("DebugBdt/hBdtScore1VsStatus"), outputMlD0bar[0], statusD0bar);
             registry.fill(HIST("DebugBdt/hBdtScore2VsStatus"), outputMlD0bar[1], statusD0bar);
             registry.fill(HIST("DebugBdt/hBdtScore3VsStatus"), outputMlD0bar[2], statusD0bar);
-            registry.fill(HIST("DebugBdt/hMassDmesonSel"), hfHelper.invMassD0barToKPi(candidate));
+            registry.fill(HIST("DebugBdt/hMassDmesonSel"), kinematics.invMassD0bar);
           }
         }
       }
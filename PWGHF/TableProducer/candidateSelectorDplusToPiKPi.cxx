@@ -79,6 +79,8 @@ struct HfCandidateSelectorDplusToPiKPi {
   o2::ccdb::CcdbApi ccdbApi;
   TrackSelectorPi selectorPion;
   TrackSelectorKa selectorKaon;
+  TrackSelectorPidCache<kPiPlus> cachePidPion; // PID statuses of the prong tracks, evaluated once per track and species
+  TrackSelectorPidCache<kKPlus> cachePidKaon;
   HfHelper hfHelper;
 
   using TracksSel = soa::Join<aod::TracksWExtra, aod::TracksPidPi, aod::PidTpcTofFullPi, aod::TracksPidKa, aod::PidTpcTofFullKa>;
@@ -94,6 +96,8 @@ struct HfCandidateSelectorDplusToPiKPi {
     selectorPion.setRangeNSigmaTof(-nSigmaTofMax, nSigmaTofMax);
     selectorPion.setRangeNSigmaTofCondTpc(-nSigmaTofCombinedMax, nSigmaTofCombinedMax);
     selectorKaon = selectorPion;
+    cachePidPion.setSelector(selectorPion);
+    cachePidKaon.setSelector(selectorKaon);
 
     if (activateQA) {
       constexpr int kNBinsSelections = 1 + aod::SelectionStep::NSelectionSteps;
@@ -206,8 +210,10 @@ struct HfCandidateSelectorDplusToPiKPi {
   }
 
   void process(aod::HfCand3Prong const& candidates,
-               TracksSel const&)
+               TracksSel const& tracks)
   {
+    cachePidPion.reset(tracks.size());
+    cachePidKaon.reset(tracks.size());
     // looping over 3-prong candidates
     for (const auto& candidate : candidates) {
 
@@ -254,13 +260,13 @@ struct HfCandidateSelectorDplusToPiKPi {
       int pidTrackPos2Pion = -1;
 
       if (usePidTpcAndTof) {
-        pidTrackPos1Pion = selectorPion.statusTpcAndTof(trackPos1);
-        pidTrackNegKaon = selectorKaon.statusTpcAndTof(trackNeg);
-        pidTrackPos2Pion = selectorPion.statusTpcAndTof(trackPos2);
+        pidTrackPos1Pion = cachePidPion.statusTpcAndTof(trackPos1);
+        pidTrackNegKaon = cachePidKaon.statusTpcAndTof(trackNeg);
+        pidTrackPos2Pion = cachePidPion.statusTpcAndTof(trackPos2);
       } else {
-        pidTrackPos1Pion = selectorPion.statusTpcOrTof(trackPos1);
-        pidTrackNegKaon = selectorKaon.statusTpcOrTof(trackNeg);
-        pidTrackPos2Pion = selectorPion.statusTpcOrTof(trackPos2);
+        pidTrackPos1Pion = cachePidPion.statusTpcOrTof(trackPos1);
+        pidTrackNegKaon = cachePidKaon.statusTpcOrTof(trackNeg);
+        pidTrackPos2Pion = cachePidPion.statusTpcOrTof(trackPos2);
       }
 
       if (!selectionPID(pidTrackPos1Pion, pidTrackNegKaon, pidTrackPos2Pion)) { // exclude D±
@@ -79,6 +79,8 @@ struct HfCandidateSelectorDsToKKPi {
   o2::ccdb::CcdbApi ccdbApi;
   TrackSelectorPi selectorPion;
   TrackSelectorKa selectorKaon;
+  TrackSelectorPidCache<kPiPlus> cachePidPion; // PID statuses of the prong tracks, evaluated once per track and species
+  TrackSelectorPidCache<kKPlus> cachePidKaon;
 
   using TracksSel = soa::Join<aod::TracksWExtra, aod::TracksPidPi, aod::PidTpcTofFullPi, aod::TracksPidKa, aod::PidTpcTofFullKa>;
 
@@ -93,6 +95,8 @@ struct HfCandidateSelectorDsToKKPi {
     selectorPion.setRangeNSigmaTof(-nSigmaTofMax, nSigmaTofMax);
     selectorPion.setRangeNSigmaTofCondTpc(-nSigmaTofCombinedMax, nSigmaTofCombinedMax);
     selectorKaon = selectorPion;
+    cachePidPion.setSelector(selectorPion);
+    cachePidKaon.setSelector(selectorKaon);
 
     if (activateQA) {
       constexpr int kNBinsSelections = 1 + aod::SelectionStep::NSelectionSteps;
@@ -234,8 +238,10 @@ struct HfCandidateSelectorDsToKKPi {
   }
 
   void process(aod::HfCand3Prong const& candidates,
-               TracksSel const&)
+               TracksSel const& tracks)
   {
+    cachePidPion.reset(tracks.size());
+    cachePidKaon.reset(tracks.size());
     // looping over 3-prong candidates
     for (const auto& candidate : candidates) {
 
@@ -302,17 +308,17 @@ struct HfCandidateSelectorDsToKKPi {
       int pidTrackNegKaon = -1;
 
       if (usePidTpcAndTof) {
-        pidTrackPos1Pion = selectorPion.statusTpcAndTof(trackPos1);
-        pidTrackPos1Kaon = selectorKaon.statusTpcAndTof(trackPos1);
-        pidTrackPos2Pion = selectorPion.statusTpcAndTof(trackPos2);
-        pidTrackPos2Kaon = selectorKaon.statusTpcAndTof(trackPos2);
-        pidTrackNegKaon = selectorKaon.statusTpcAndTof(trackNeg);
+        pidTrackPos1Pion = cachePidPion.statusTpcAndTof(trackPos1);
+        pidTrackPos1Kaon = cachePidKaon.statusTpcAndTof(trackPos1);
+        pidTrackPos2Pion = cachePidPion.statusTpcAndTof(trackPos2);
+        pidTrackPos2Kaon = cachePidKaon.statusTpcAndTof(trackPos2);
+        pidTrackNegKaon = cachePidKaon.statusTpcAndTof(trackNeg);
       } else {
-        pidTrackPos1Pion = selectorPion.statusTpcOrTof(trackPos1);
-        pidTrackPos1Kaon = selectorKaon.statusTpcOrTof(trackPos1);
-        pidTrackPos2Pion = selectorPion.statusTpcOrTof(trackPos2);
-        pidTrackPos2Kaon = selectorKaon.statusTpcOrTof(trackPos2);
-        pidTrackNegKaon = selectorKaon.statusTpcOrTof(trackNeg);
+        pidTrackPos1Pion = cachePidPion.statusTpcOrTof(trackPos1);
+        pidTrackPos1Kaon = cachePidKaon.statusTpcOrTof(trackPos1);
+        pidTrackPos2Pion = cachePidPion.statusTpcOrTof(trackPos2);
+        pidTrackPos2Kaon = cachePidKaon.statusTpcOrTof(trackPos2);
+        pidTrackNegKaon = cachePidKaon.statusTpcOrTof(trackNeg);
       }
 
       bool pidDsToKKPi = !(pidTrackPos1Kaon == TrackSelectorPID::Rejected ||
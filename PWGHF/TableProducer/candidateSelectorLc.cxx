@@ -95,6 +95,9 @@ struct HfCandidateSelectorLc {
   TrackSelectorPi selectorPion;
   TrackSelectorKa selectorKaon;
   TrackSelectorPr selectorProton;
+  TrackSelectorPidCache<kPiPlus> cachePidPion; // PID statuses of the prong tracks, evaluated once per track and species
+  TrackSelectorPidCache<kKPlus> cachePidKaon;
+  TrackSelectorPidCache<kProton> cachePidProton;
 
   using TracksSel = soa::Join<aod::TracksWExtra,
                               aod::TracksPidPi, aod::PidTpcTofFullPi, aod::TracksPidKa, aod::PidTpcTofFullKa, aod::TracksPidPr, aod::PidTpcTofFullPr,
@@ -113,6 +116,9 @@ struct HfCandidateSelectorLc {
     selectorPion.setRangePtBayes(ptPidBayesMin, ptPidBayesMax);
     selectorKaon = selectorPion;
     selectorProton = selectorPion;
+    cachePidPion.setSelector(selectorPion);
+    cachePidKaon.setSelector(selectorKaon);
+    cachePidProton.setSelector(selectorProton);
 
     if (activateQA) {
       constexpr int kNBinsSelections = 1 + aod::SelectionStep::NSelectionSteps;
@@ -261,8 +267,11 @@ struct HfCandidateSelectorLc {
   }
 
   void process(aod::HfCand3Prong const& candidates,
-               TracksSel const&)
+               TracksSel const& tracks)
   {
+    cachePidPion.reset(tracks.size());
+    cachePidKaon.reset(tracks.size());
+    cachePidProton.reset(tracks.size());
     // looping over 3-prong candidates
     for (const auto& candidate : candidates) {
 
@@ -345,17 +354,17 @@ struct HfCandidateSelectorLc {
         TrackSelectorPID::Status pidTrackPos2Pion = TrackSelectorPID::Accepted;
         TrackSelectorPID::Status pidTrackNegKaon = TrackSelectorPID::Accepted;
         if (usePidTpcAndTof) {
-          pidTrackPos1Proton = selectorProton.statusTpcAndTof(trackPos1);
-          pidTrackPos2Proton = selectorProton.statusTpcAndTof(trackPos2);
-          pidTrackPos1Pion = selectorPion.statusTpcAndTof(trackPos1);
-          pidTrackPos2Pion = selectorPion.statusTpcAndTof(trackPos2);
-          pidTrackNegKaon = selectorKaon.statusTpcAndTof(trackNeg);
+          pidTrackPos1Proton = cachePidProton.statusTpcAndTof(trackPos1);
+          pidTrackPos2Proton = cachePidProton.statusTpcAndTof(trackPos2);
+          pidTrackPos1Pion = cachePidPion.statusTpcAndTof(trackPos1);
+          pidTrackPos2Pion = cachePidPion.statusTpcAndTof(trackPos2);
+          pidTrackNegKaon = cachePidKaon.statusTpcAndTof(trackNeg);
         } else {
-          pidTrackPos1Proton = selectorProton.statusTpcOrTof(trackPos1);
-          pidTrackPos2Proton = selectorProton.statusTpcOrTof(trackPos2);
-          pidTrackPos1Pion = selectorPion.statusTpcOrTof(trackPos1);
-          pidTrackPos2Pion = selectorPion.statusTpcOrTof(trackPos2);
-          pidTrackNegKaon = selectorKaon.statusTpcOrTof(trackNeg);
+          pidTrackPos1Proton = cachePidProton.statusTpcOrTof(trackPos1);
+          pidTrackPos2Proton = cachePidProton.statusTpcOrTof(trackPos2);
+          pidTrackPos1Pion = cachePidPion.statusTpcOrTof(trackPos1);
+          pidTrackPos2Pion = cachePidPion.statusTpcOrTof(trackPos2);
+          pidTrackNegKaon = cachePidKaon.statusTpcOrTof(trackNeg);
         }
 
         if (!isSelectedPID(pidTrackPos1Proton, pidTrackNegKaon, pidTrackPos2Pion)) {
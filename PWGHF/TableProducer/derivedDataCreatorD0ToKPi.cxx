@@ -20,6 +20,7 @@
 #include "Framework/runDataProcessing.h"
 
 #include "Common/Core/RecoDecay.h"
+#include "Common/Core/TableHelper.h"
 #include "Common/DataModel/Centrality.h"
 #include "Common/DataModel/Multiplicity.h"
 
@@ -40,6 +41,8 @@ struct HfDerivedDataCreatorD0ToKPi {
   Produces<o2::aod::HfD0ParEs> rowCandidateParE;
   Produces<o2::aod::HfD0Sels> rowCandidateSel;
   Produces<o2::aod::HfD0Mls> rowCandidateMl;
+  Produces<o2::aod::HfD0PidPackeds> rowCandidatePidPacked;
+  Produces<o2::aod::HfD0MlPackeds> rowCandidateMlPacked;
   Produces<o2::aod::HfD0Ids> rowCandidateId;
   Produces<o2::aod::HfD0Mcs> rowCandidateMc;
   // Collisions
@@ -59,6 +62,8 @@ struct HfDerivedDataCreatorD0ToKPi {
   Configurable<bool> fillCandidateParE{"fillCandidateParE", true, "Fill candidate extended parameters"};
   Configurable<bool> fillCandidateSel{"fillCandidateSel", true, "Fill candidate selection flags"};
   Configurable<bool> fillCandidateMl{"fillCandidateMl", true, "Fill candidate selection ML scores"};
+  Configurable<bool> fillCandidatePidPacked{"fillCandidatePidPacked", false, "Fill packed (8 bit) PID n sigma of the prongs"};
+  Configurable<bool> fillCandidateMlPacked{"fillCandidateMlPacked", false, "Fill packed (16 bit) candidate selection ML scores"};
   Configurable<bool> fillCandidateId{"fillCandidateId", true, "Fill original indices from the candidate table"};
   Configurable<bool> fillCandidateMc{"fillCandidateMc", true, "Fill candidate MC info"};
   Configurable<bool> fillCollBase{"fillCollBase", true, "Fill collision base properties"};
@@ -68,6 +73,7 @@ struct HfDerivedDataCreatorD0ToKPi {
   Configurable<bool> fillMcRCollId{"fillMcRCollId", true, "Fill indices of saved derived reconstructed collisions matched to saved derived MC collisions"};
   Configurable<bool> fillParticleBase{"fillParticleBase", true, "Fill MC particle properties"};
   Configurable<bool> fillParticleId{"fillParticleId", true, "Fill original MC indices"};
+  Configurable<bool> skipUnrequiredTables{"skipUnrequiredTables", false, "Do not fill the enabled tables which are neither saved nor consumed in the workflow"};
   // Parameters for production of training samples
   Configurable<float> downSampleBkgFactor{"downSampleBkgFactor", 1., "Fraction of background candidates to keep for ML trainings"};
   Configurable<float> ptMaxForDownSample{"ptMaxForDownSample", 10., "Maximum pt for the application of the downsampling factor"};
@@ -123,13 +129,34 @@ struct HfDerivedDataCreatorD0ToKPi {
   Partition<SelectedCandidatesMcKfMl> candidatesMcKfMlSig = nabs(aod::hf_cand_2prong::flagMcMatchRec) == static_cast<int8_t>(BIT(aod::hf_cand_2prong::DecayType::D0ToPiK));
   Partition<SelectedCandidatesMcKfMl> candidatesMcKfMlBkg = nabs(aod::hf_cand_2prong::flagMcMatchRec) != static_cast<int8_t>(BIT(aod::hf_cand_2prong::DecayType::D0ToPiK));
 
-  void init(InitContext const&)
+  void init(InitContext& initContext)
   {
     std::array<bool, 16> doprocess{doprocessDataWithDCAFitterN, doprocessDataWithKFParticle, doprocessMcWithDCAFitterSig, doprocessMcWithDCAFitterBkg, doprocessMcWithDCAFitterAll, doprocessMcWithKFParticleSig, doprocessMcWithKFParticleBkg, doprocessMcWithKFParticleAll,
                                    doprocessDataWithDCAFitterNMl, doprocessDataWithKFParticleMl, doprocessMcWithDCAFitterMlSig, doprocessMcWithDCAFitterMlBkg, doprocessMcWithDCAFitterMlAll, doprocessMcWithKFParticleMlSig, doprocessMcWithKFParticleMlBkg, doprocessMcWithKFParticleMlAll};
     if (std::accumulate(doprocess.begin(), doprocess.end(), 0) != 1) {
       LOGP(fatal, "Only one process function can be enabled at a time.");
     }
+    if (skipUnrequiredTables) {
+      disableFlagIfTableNotRequired(initContext, "HfD0Bases", fillCandidateBase);
+      disableFlagIfTableNotRequired(initContext, "HfD0Pars", fillCandidatePar);
+      disableFlagIfTableNotRequired(initContext, "HfD0ParEs", fillCandidateParE);
+      disableFlagIfTableNotRequired(initContext, "HfD0Sels", fillCandidateSel);
+      disableFlagIfTableNotRequired(initContext, "HfD0Mls", fillCandidateMl);
+      disableFlagIfTableNotRequired(initContext, "HfD0PidPackeds", fillCandidatePidPacked);
+      disableFlagIfTableNotRequired(initContext, "HfD0MlPackeds", fillCandidateMlPacked);
+      disableFlagIfTableNotRequired(initContext, "HfD0Ids", fillCandidateId);
+      disableFlagIfTableNotRequired(initContext, "HfD0Mcs", fillCandidateMc);
+      disableFlagIfTableNotRequired(initContext, "HfD0CollBases", fillCollBase);
+      disableFlagIfTableNotRequired(initContext, "HfD0CollIds", fillCollId);
+      disableFlagIfTableNotRequired(initContext, "HfD0McCollBases", fillMcCollBase);
+      disableFlagIfTableNotRequired(initContext, "HfD0McCollIds", fillMcCollId);
+      disableFlagIfTableNotRequired(initContext, "HfD0McRCollIds", fillMcRCollId);
+      disableFlagIfTableNotRequired(initContext, "HfD0PBases", fillParticleBase);
+      disableFlagIfTableNotRequired(initContext, "HfD0PIds", fillParticleId);
+      // keep the collision tables indexed by the filled tables
+      fillCollBase.value = fillCollBase || fillCandidateBase || fillMcRCollId;
+      fillMcCollBase.value = fillMcCollBase || fillParticleBase || fillMcRCollId;
+    }
   }
 
   template <typename T>
@@ -264,6 +291,29 @@ struct HfDerivedDataCreatorD0ToKPi {
       rowCandidateMl(
         mlScores);
     }
+    if (fillCandidatePidPacked) {
+      using nSigma = aod::hf_cand_packed::nSigma;
+      rowCandidatePidPacked(
+        nSigma::pack(prong0.tpcNSigmaPi()),
+        nSigma::pack(prong0.tpcNSigmaKa()),
+        nSigma::pack(prong0.tofNSigmaPi()),
+        nSigma::pack(prong0.tofNSigmaKa()),
+        nSigma::pack(prong0.tpcTofNSigmaPi()),
+        nSigma::pack(prong0.tpcTofNSigmaKa()),
+        nSigma::pack(prong1.tpcNSigmaPi()),
+        nSigma::pack(prong1.tpcNSigmaKa()),
+        nSigma::pack(prong1.tofNSigmaPi()),
+        nSigma::pack(prong1.tofNSigmaKa()),
+        nSigma::pack(prong1.tpcTofNSigmaPi()),
+        nSigma::pack(prong1.tpcTofNSigmaKa()));
+    }
+    if (fillCandidateMlPacked) {
+      using mlScore = aod::hf_cand_packed::mlScore;
+      rowCandidateMlPacked(
+        mlScore::pack(mlScores.size() > 0 ? mlScores[0] : -1.f),
+        mlScore::pack(mlScores.size() > 1 ? mlScores[1] : -1.f),
+        mlScore::pack(mlScores.size() > 2 ? mlScores[2] : -1.f));
+    }
     if (fillCandidateId) {
       rowCandidateId(
         candidate.collisionId(),
@@ -336,6 +386,7 @@ struct HfDerivedDataCreatorD0ToKPi {
       reserveTable(rowCandidatePar, fillCandidatePar, sizeTableCand);
       reserveTable(rowCandidateParE, fillCandidateParE, sizeTableCand);
       reserveTable(rowCandidateSel, fillCandidateSel, sizeTableCand);
+      reserveTable(rowCandidatePidPacked, fillCandidatePidPacked, sizeTableCand);
       reserveTable(rowCandidateId, fillCandidateId, sizeTableCand);
       if constexpr (isMc) {
         reserveTable(rowCandidateMc, fillCandidateMc, sizeTableCand);
@@ -364,28 +415,31 @@ struct HfDerivedDataCreatorD0ToKPi {
         }
         auto prong0 = candidate.template prong0_as<TracksWPid>();
         auto prong1 = candidate.template prong1_as<TracksWPid>();
-        double ct = hfHelper.ctD0(candidate);
-        double y = hfHelper.yD0(candidate);
-        float massD0, massD0bar;
+        // quantities only used in the tables which are not filled are not computed
+        double ct = fillCandidateParE ? hfHelper.ctD0(candidate) : 0.;
+        double y = fillCandidateBase ? hfHelper.yD0(candidate) : 0.;
+        float massD0 = 0.f, massD0bar = 0.f;
         float topolChi2PerNdf = -999.;
         if constexpr (reconstructionType == aod::hf_cand::VertexerType::KfParticle) {
           massD0 = candidate.kfGeoMassD0();
           massD0bar = candidate.kfGeoMassD0bar();
           topolChi2PerNdf = candidate.kfTopolChi2OverNdf();
-        } else {
+        } else if (fillCandidateBase) {
           massD0 = hfHelper.invMassD0ToPiK(candidate);
           massD0bar = hfHelper.invMassD0barToKPi(candidate);
         }
         std::vector<float> mlScoresD0, mlScoresD0bar;
         if constexpr (isMl) {
-          std::copy(candidate.mlProbD0().begin(), candidate.mlProbD0().end(), std::back_inserter(mlScoresD0));
-          std::copy(candidate.mlProbD0bar().begin(), candidate.mlProbD0bar().end(), std::back_inserter(mlScoresD0bar));
+          if (fillCandidateMl || fillCandidateMlPacked) {
+            std::copy(candidate.mlProbD0().begin(), candidate.mlProbD0().end(), std::back_inserter(mlScoresD0));
+            std::copy(candidate.mlProbD0bar().begin(), candidate.mlProbD0bar().end(), std::back_inserter(mlScoresD0bar));
+          }
         }
         if (candidate.isSelD0()) {
-          fillTablesCandidate(candidate, prong0, prong1, 0, massD0, hfHelper.cosThetaStarD0(candidate), topolChi2PerNdf, ct, y, flagMcRec, origin, mlScoresD0);
+          fillTablesCandidate(candidate, prong0, prong1, 0, massD0, fillCandidateParE ? hfHelper.cosThetaStarD0(candidate) : 0., topolChi2PerNdf, ct, y, flagMcRec, origin, mlScoresD0);
         }
         if (candidate.isSelD0bar()) {
-          fillTablesCandidate(candidate, prong0, prong1, 1, massD0bar, hfHelper.cosThetaStarD0bar(candidate), topolChi2PerNdf, ct, y, flagMcRec, origin, mlScoresD0bar);
+          fillTablesCandidate(candidate, prong0, prong1, 1, massD0bar, fillCandidateParE ? hfHelper.cosThetaStarD0bar(candidate) : 0., topolChi2PerNdf, ct, y, flagMcRec, origin, mlScoresD0bar);
         }
       }
     }
@@ -20,6 +20,7 @@
 #include "Framework/runDataProcessing.h"
 
 #include "Common/Core/RecoDecay.h"
+#include "Common/Core/TableHelper.h"
 #include "Common/DataModel/Centrality.h"
 #include "Common/DataModel/Multiplicity.h"
 
@@ -68,6 +69,7 @@ struct HfDerivedDataCreatorLcToPKPi {
   Configurable<bool> fillMcRCollId{"fillMcRCollId", true, "Fill indices of saved derived reconstructed collisions matched to saved derived MC collisions"};
   Configurable<bool> fillParticleBase{"fillParticleBase", true, "Fill MC particle properties"};
   Configurable<bool> fillParticleId{"fillParticleId", true, "Fill original MC indices"};
+  Configurable<bool> skipUnrequiredTables{"skipUnrequiredTables", false, "Do not fill the enabled tables which are neither saved nor consumed in the workflow"};
   // Parameters for production of training samples
   Configurable<float> downSampleBkgFactor{"downSampleBkgFactor", 1., "Fraction of background candidates to keep for ML trainings"};
   Configurable<float> ptMaxForDownSample{"ptMaxForDownSample", 10., "Maximum pt for the application of the downsampling factor"};
@@ -107,12 +109,31 @@ struct HfDerivedDataCreatorLcToPKPi {
   Partition<SelectedCandidatesMcMl> candidatesMcMlSig = nabs(aod::hf_cand_3prong::flagMcMatchRec) == static_cast<int8_t>(BIT(aod::hf_cand_3prong::DecayType::LcToPKPi));
   Partition<SelectedCandidatesMcMl> candidatesMcMlBkg = nabs(aod::hf_cand_3prong::flagMcMatchRec) != static_cast<int8_t>(BIT(aod::hf_cand_3prong::DecayType::LcToPKPi));
 
-  void init(InitContext const&)
+  void init(InitContext& initContext)
   {
     std::array<bool, 8> doprocess{doprocessData, doprocessMcSig, doprocessMcBkg, doprocessMcAll, doprocessDataMl, doprocessMcMlSig, doprocessMcMlBkg, doprocessMcMlAll};
     if (std::accumulate(doprocess.begin(), doprocess.end(), 0) != 1) {
       LOGP(fatal, "Only one process function can be enabled at a time.");
     }
+    if (skipUnrequiredTables) {
+      disableFlagIfTableNotRequired(initContext, "Hf3PBases", fillCandidateBase);
+      disableFlagIfTableNotRequired(initContext, "Hf3PPars", fillCandidatePar);
+      disableFlagIfTableNotRequired(initContext, "Hf3PParEs", fillCandidateParE);
+      disableFlagIfTableNotRequired(initContext, "Hf3PSels", fillCandidateSel);
+      disableFlagIfTableNotRequired(initContext, "Hf3PMls", fillCandidateMl);
+      disableFlagIfTableNotRequired(initContext, "Hf3PIds", fillCandidateId);
+      disableFlagIfTableNotRequired(initContext, "Hf3PMcs", fillCandidateMc);
+      disableFlagIfTableNotRequired(initContext, "Hf3PCollBases", fillCollBase);
+      disableFlagIfTableNotRequired(initContext, "Hf3PCollIds", fillCollId);
+      disableFlagIfTableNotRequired(initContext, "Hf3PMcCollBases", fillMcCollBase);
+      disableFlagIfTableNotRequired(initContext, "Hf3PMcCollIds", fillMcCollId);
+      disableFlagIfTableNotRequired(initContext, "Hf3PMcRCollIds", fillMcRCollId);
+      disableFlagIfTableNotRequired(initContext, "Hf3PPBases", fillParticleBase);
+      disableFlagIfTableNotRequired(initContext, "Hf3PPIds", fillParticleId);
+      // keep the collision tables indexed by the filled tables
+      fillCollBase.value = fillCollBase || fillCandidateBase || fillMcRCollId;
+      fillMcCollBase.value = fillMcCollBase || fillParticleBase || fillMcRCollId;
+    }
   }
 
   template <typename T>
@@ -359,14 +380,17 @@ struct HfDerivedDataCreatorLcToPKPi {
         auto prong0 = candidate.template prong0_as<TracksWPid>();
         auto prong1 = candidate.template prong1_as<TracksWPid>();
         auto prong2 = candidate.template prong2_as<TracksWPid>();
-        double ct = hfHelper.ctLc(candidate);
-        double y = hfHelper.yLc(candidate);
-        float massLcToPKPi = hfHelper.invMassLcToPKPi(candidate);
-        float massLcToPiKP = hfHelper.invMassLcToPiKP(candidate);
+        // quantities only used in the tables which are not filled are not computed
+        double ct = fillCandidateParE ? hfHelper.ctLc(candidate) : 0.;
+        double y = fillCandidateBase ? hfHelper.yLc(candidate) : 0.;
+        float massLcToPKPi = fillCandidateBase ? hfHelper.invMassLcToPKPi(candidate) : 0.f;
+        float massLcToPiKP = fillCandidateBase ? hfHelper.invMassLcToPiKP(candidate) : 0.f;
         std::vector<float> mlScoresLcToPKPi, mlScoresLcToPiKP;
         if constexpr (isMl) {
-          std::copy(candidate.mlProbLcToPKPi().begin(), candidate.mlProbLcToPKPi().end(), std::back_inserter(mlScoresLcToPKPi));
-          std::copy(candidate.mlProbLcToPiKP().begin(), candidate.mlProbLcToPiKP().end(), std::back_inserter(mlScoresLcToPiKP));
+          if (fillCandidateMl) {
+            std::copy(candidate.mlProbLcToPKPi().begin(), candidate.mlProbLcToPKPi().end(), std::back_inserter(mlScoresLcToPKPi));
+            std::copy(candidate.mlProbLcToPiKP().begin(), candidate.mlProbLcToPiKP().end(), std::back_inserter(mlScoresLcToPiKP));
+          }
         }
         if (candidate.isSelLcToPKPi()) {
           fillTablesCandidate(candidate, prong0, prong1, prong2, 0, massLcToPKPi, ct, y, flagMcRec, origin, swapping, mlScoresLcToPKPi);
@@ -14,6 +14,9 @@
 ///
 /// \author Vít Kučera <vit.kucera@cern.ch>, Inha University
 
+#include <array>
+#include <string>
+
 #include "Framework/AnalysisTask.h"
 #include "Framework/runDataProcessing.h"
 
@@ -25,6 +28,24 @@
 using namespace o2;
 using namespace o2::framework;
 
+namespace
+{
+enum HfPidSpecies {
+  kEl = 0,
+  kMu,
+  kPi,
+  kKa,
+  kPr,
+  kNSpecies
+};
+constexpr std::array<const char*, kNSpecies> speciesNames{"El", "Mu", "Pi", "Ka", "Pr"};
+} // namespace
+
+using TracksPidFullAll = soa::Join<aod::pidTPCFullEl, aod::pidTOFFullEl, aod::pidTPCFullMu, aod::pidTOFFullMu, aod::pidTPCFullPi, aod::pidTOFFullPi,
+                                   aod::pidTPCFullKa, aod::pidTOFFullKa, aod::pidTPCFullPr, aod::pidTOFFullPr>;
+using TracksPidTinyAll = soa::Join<aod::pidTPCEl, aod::pidTOFEl, aod::pidTPCMu, aod::pidTOFMu, aod::pidTPCPi, aod::pidTOFPi,
+                                   aod::pidTPCKa, aod::pidTOFKa, aod::pidTPCPr, aod::pidTOFPr>;
+
 struct HfPidCreator {
   Produces<aod::PidTpcTofFullEl> trackPidFullEl;
   Produces<aod::PidTpcTofTinyEl> trackPidTinyEl;
@@ -40,6 +61,9 @@ struct HfPidCreator {
   static constexpr float defaultNSigmaTolerance = .1f;
   static constexpr float defaultNSigma = -999.f + defaultNSigmaTolerance; // -999.f is the default value set in TPCPIDResponse.h and PIDTOF.h
 
+  std::array<bool, kNSpecies> isFullRequired{}; // tables filled by processFullAllSpecies
+  std::array<bool, kNSpecies> isTinyRequired{}; // tables filled by processTinyAllSpecies
+
   /// Function to check whether the process function flag matches the need for filling the table
   /// \param initContext  workflow context (argument of the init function)
   /// \param table  name of the table
@@ -58,19 +82,43 @@ struct HfPidCreator {
     }
   }
 
+  /// Function to find the tables to be filled by the process function of all species
+  /// \param initContext  workflow context (argument of the init function)
+  /// \param type  "Full" or "Tiny"
+  /// \param doprocessSpecies  flags of the process functions per species, which must be disabled
+  /// \param isRequired  flags of the tables needed in the workflow, per species
+  void checkTablesAllSpecies(InitContext& initContext, const std::string& type, const std::array<bool, kNSpecies>& doprocessSpecies, std::array<bool, kNSpecies>& isRequired)
+  {
+    for (int iSpecies = 0; iSpecies < kNSpecies; ++iSpecies) {
+      const std::string table = "PidTpcTof" + type + speciesNames[iSpecies];
+      if (doprocessSpecies[iSpecies]) {
+        LOGF(fatal, "Table %s is filled by process%sAllSpecies. Disable process%s%s!", table, type, type, speciesNames[iSpecies]);
+      }
+      isRequired[iSpecies] = isTableRequiredInWorkflow(initContext, table);
+    }
+  }
+
   void init(InitContext& initContext)
   {
     // Check whether the right process functions are enabled.
-    checkTableSwitch(initContext, "PidTpcTofFullEl", doprocessFullEl);
-    checkTableSwitch(initContext, "PidTpcTofTinyEl", doprocessTinyEl);
-    checkTableSwitch(initContext, "PidTpcTofFullMu", doprocessFullMu);
-    checkTableSwitch(initContext, "PidTpcTofTinyMu", doprocessTinyMu);
-    checkTableSwitch(initContext, "PidTpcTofFullPi", doprocessFullPi);
-    checkTableSwitch(initContext, "PidTpcTofTinyPi", doprocessTinyPi);
-    checkTableSwitch(initContext, "PidTpcTofFullKa", doprocessFullKa);
-    checkTableSwitch(initContext, "PidTpcTofTinyKa", doprocessTinyKa);
-    checkTableSwitch(initContext, "PidTpcTofFullPr", doprocessFullPr);
-    checkTableSwitch(initContext, "PidTpcTofTinyPr", doprocessTinyPr);
+    if (doprocessFullAllSpecies) {
+      checkTablesAllSpecies(initContext, "Full", {doprocessFullEl.value, doprocessFullMu.value, doprocessFullPi.value, doprocessFullKa.value, doprocessFullPr.value}, isFullRequired);
+    } else {
+      checkTableSwitch(initContext, "PidTpcTofFullEl", doprocessFullEl);
+      checkTableSwitch(initContext, "PidTpcTofFullMu", doprocessFullMu);
+      checkTableSwitch(initContext, "PidTpcTofFullPi", doprocessFullPi);
+      checkTableSwitch(initContext, "PidTpcTofFullKa", doprocessFullKa);
+      checkTableSwitch(initContext, "PidTpcTofFullPr", doprocessFullPr);
+    }
+    if (doprocessTinyAllSpecies) {
+      checkTablesAllSpecies(initContext, "Tiny", {doprocessTinyEl.value, doprocessTinyMu.value, doprocessTinyPi.value, doprocessTinyKa.value, doprocessTinyPr.value}, isTinyRequired);
+    } else {
+      checkTableSwitch(initContext, "PidTpcTofTinyEl", doprocessTinyEl);
+      checkTableSwitch(initContext, "PidTpcTofTinyMu", doprocessTinyMu);
+      checkTableSwitch(initContext, "PidTpcTofTinyPi", doprocessTinyPi);
+      checkTableSwitch(initContext, "PidTpcTofTinyKa", doprocessTinyKa);
+      checkTableSwitch(initContext, "PidTpcTofTinyPr", doprocessTinyPr);
+    }
   }
 
   /// Function to combine TPC and TOF NSigma
@@ -126,6 +174,52 @@ struct HfPidCreator {
   PROCESS_PID(Pr)
 
 #undef PROCESS_PID
+
+  // Process functions filling the tables of all the species needed in the workflow in one pass over the tracks.
+  // They require the TPC and TOF PID tables of all the species.
+  void processFullAllSpecies(TracksPidFullAll const& tracks)
+  {
+    for (const auto& track : tracks) {
+      if (isFullRequired[kEl]) {
+        trackPidFullEl(combineNSigma<false>(track.tpcNSigmaEl(), track.tofNSigmaEl()));
+      }
+      if (isFullRequired[kMu]) {
+        trackPidFullMu(combineNSigma<false>(track.tpcNSigmaMu(), track.tofNSigmaMu()));
+      }
+      if (isFullRequired[kPi]) {
+        trackPidFullPi(combineNSigma<false>(track.tpcNSigmaPi(), track.tofNSigmaPi()));
+      }
+      if (isFullRequired[kKa]) {
+        trackPidFullKa(combineNSigma<false>(track.tpcNSigmaKa(), track.tofNSigmaKa()));
+      }
+      if (isFullRequired[kPr]) {
+        trackPidFullPr(combineNSigma<false>(track.tpcNSigmaPr(), track.tofNSigmaPr()));
+      }
+    }
+  }
+  PROCESS_SWITCH(HfPidCreator, processFullAllSpecies, "Process full, all species in one pass", false);
+
+  void processTinyAllSpecies(TracksPidTinyAll const& tracks)
+  {
+    for (const auto& track : tracks) {
+      if (isTinyRequired[kEl]) {
+        trackPidTinyEl(combineNSigma<true>(track.tpcNSigmaStoreEl(), track.tofNSigmaStoreEl()));
+      }
+      if (isTinyRequired[kMu]) {
+        trackPidTinyMu(combineNSigma<true>(track.tpcNSigmaStoreMu(), track.tofNSigmaStoreMu()));
+      }
+      if (isTinyRequired[kPi]) {
+        trackPidTinyPi(combineNSigma<true>(track.tpcNSigmaStorePi(), track.tofNSigmaStorePi()));
+      }
+      if (isTinyRequired[kKa]) {
+        trackPidTinyKa(combineNSigma<true>(track.tpcNSigmaStoreKa(), track.tofNSigmaStoreKa()));
+      }
+      if (isTinyRequired[kPr]) {
+        trackPidTinyPr(combineNSigma<true>(track.tpcNSigmaStorePr(), track.tofNSigmaStorePr()));
+      }
+    }
+  }
+  PROCESS_SWITCH(HfPidCreator, processTinyAllSpecies, "Process tiny, all species in one pass", false);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
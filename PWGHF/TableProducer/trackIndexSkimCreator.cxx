@@ -20,8 +20,11 @@
 /// \author Fabrizio Grosa <fgrosa@cern.ch>, CERN
 /// \author Federica Zanone <federica.zanone@cern.ch>, Heidelberg University
 
-#include <algorithm> // std::find
+#include <algorithm> // std::find, std::min, std::sort
+#include <bitset>    // std::bitset
 #include <iterator>  // std::distance
+#include <map>       // std::map
+#include <memory>    // std::unique_ptr
 #include <string>    // std::string
 #include <vector>    // std::vector
 
@@ -277,6 +280,11 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
   o2::base::Propagator::MatCorrType noMatCorr = o2::base::Propagator::MatCorrType::USEMatCorrNONE;
   int runNumber;
 
+  // PV contributors of the current collision for the PV refit, filled once per collision and reused across collisions
+  std::vector<int64_t> pvContributorGlobIds;
+  std::vector<o2::track::TrackParCov> pvContributorTrackParCovs;
+  std::vector<bool> vecPvRefitContributorUsed;
+
   // single-track cuts
   static const int nCuts = 4;
   // array of 2-prong and 3-prong cuts
@@ -696,14 +704,14 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
   template <typename TTrack>
   void performPvRefitTrack(aod::Collision const& collision,
                            aod::BCsWithTimestamps const&,
-                           std::vector<int64_t> vecPvContributorGlobId,
-                           std::vector<o2::track::TrackParCov> vecPvContributorTrackParCov,
+                           std::vector<int64_t> const& vecPvContributorGlobId,
+                           std::vector<o2::track::TrackParCov> const& vecPvContributorTrackParCov,
                            TTrack const& trackToRemove,
                            std::array<float, 3>& pvCoord,
                            std::array<float, 6>& pvCovMatrix,
                            std::array<float, 2>& dcaXYdcaZ)
   {
-    std::vector<bool> vecPvRefitContributorUsed(vecPvContributorGlobId.size(), true);
+    vecPvRefitContributorUsed.assign(vecPvContributorGlobId.size(), true);
 
     /// Prepare the vertex refitting
     // set the magnetic field from CCDB
@@ -889,6 +897,7 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
                        std::vector<std::array<float, 6>>& pvRefitPvCovMatrixPerTrack)
   {
     auto thisCollId = collision.globalIndex();
+    bool pvContributorsFilled = false;
     for (const auto& trackId : trackIndicesCollision) {
       int statusProng = BIT(CandidateType::NCandidateTypes) - 1; // all bits on
       auto track = trackId.template track_as<TTracks>();
@@ -905,23 +914,25 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
         pvRefitPvCoord = {collision.posX(), collision.posY(), collision.posZ()};
         pvRefitPvCovMatrix = {collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ()};
 
-        /// retrieve PV contributors for the current collision
-        std::vector<int64_t> vecPvContributorGlobId = {};
-        std::vector<o2::track::TrackParCov> vecPvContributorTrackParCov = {};
-
-        for (const auto& contributor : pvContrCollision) {
-          vecPvContributorGlobId.push_back(contributor.globalIndex());
-          vecPvContributorTrackParCov.push_back(getTrackParCov(contributor));
+        /// retrieve PV contributors for the current collision, once for all its tracks
+        if (!pvContributorsFilled) {
+          pvContributorGlobIds.clear();
+          pvContributorTrackParCovs.clear();
+          for (const auto& contributor : pvContrCollision) {
+            pvContributorGlobIds.push_back(contributor.globalIndex());
+            pvContributorTrackParCovs.push_back(getTrackParCov(contributor));
+          }
+          pvContributorsFilled = true;
         }
         if (debugPvRefit) {
-          LOG(info) << "### vecPvContributorGlobId.size()=" << vecPvContributorGlobId.size() << ", vecPvContributorTrackParCov.size()=" << vecPvContributorTrackParCov.size() << ", N. original contributors=" << collision.numContrib();
+          LOG(info) << "### vecPvContributorGlobId.size()=" << pvContributorGlobIds.size() << ", vecPvContributorTrackParCov.size()=" << pvContributorTrackParCovs.size() << ", N. original contributors=" << collision.numContrib();
         }
 
         /// Perform the PV refit only for tracks with an assigned collision
         if (debugPvRefit) {
           LOG(info) << "[BEFORE performPvRefitTrack] track.collision().globalIndex(): " << collision.globalIndex();
         }
-        performPvRefitTrack(collision, bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, track, pvRefitPvCoord, pvRefitPvCovMatrix, pvRefitDcaXYDcaZ);
+        performPvRefitTrack(collision, bcWithTimeStamps, pvContributorGlobIds, pvContributorTrackParCovs, track, pvRefitPvCoord, pvRefitPvCovMatrix, pvRefitDcaXYDcaZ);
         // we subtract the offset since trackIdx is the global index referred to the total track table
         pvRefitDcaPerTrack[trackIdx] = pvRefitDcaXYDcaZ;
         pvRefitPvCoordPerTrack[trackIdx] = pvRefitPvCoord;
@@ -1205,6 +1216,7 @@ struct HfTrackIndexSkimCreator {
   Configurable<std::string> mlModelPathCCDB{"mlModelPathCCDB", "EventFiltering/PWGHF/BDTSmeared", "Path on CCDB of ML models for HF Filters"};
   Configurable<int64_t> timestampCcdbForHfFilters{"timestampCcdbForHfFilters", 1657032422771, "timestamp of the ONNX file for ML model used to query in CCDB"};
   Configurable<bool> loadMlModelsFromCCDB{"loadMlModelsFromCCDB", true, "Flag to enable or disable the loading of ML models from CCDB"};
+  Configurable<int> maxBatchSizeMlForHfFilters{"maxBatchSizeMlForHfFilters", 10000, "Maximum number of candidates evaluated in one call of the ML models for HF Filters (the candidates are evaluated once per timeframe)"};
 
   Configurable<LabeledArray<std::string>> onnxFileNames{"onnxFileNames", {hf_cuts_bdt_multiclass::onnxFileNameSpecies[0], 5, 1, hf_cuts_bdt_multiclass::labelsSpecies, hf_cuts_bdt_multiclass::labelsModels}, "ONNX file names for ML models"};
 
@@ -1237,21 +1249,108 @@ struct HfTrackIndexSkimCreator {
   static constexpr int kN3ProngDecays = hf_cand_3prong::DecayType::N3ProngDecays;                                                                                                               // number of 3-prong hadron types
   static constexpr int kNCuts2Prong[kN2ProngDecays] = {hf_cuts_presel_2prong::nCutVars, hf_cuts_presel_2prong::nCutVars, hf_cuts_presel_2prong::nCutVars};                                      // how many different selections are made on 2-prongs
   static constexpr int kNCuts3Prong[kN3ProngDecays] = {hf_cuts_presel_3prong::nCutVars, hf_cuts_presel_3prong::nCutVars + 1, hf_cuts_presel_ds::nCutVars, hf_cuts_presel_3prong::nCutVars + 1}; // how many different selections are made on 3-prongs (Lc and Xic have also PID potentially)
+  static constexpr int kNCutsMax = 8;                                                                                                                                                           // size of the cut-status bitsets, must not be smaller than any of kNCuts2Prong and kNCuts3Prong
   static constexpr int kNCutsDstar = 3;                                                                                                                                                         // how many different selections are made on Dstars
   std::array<std::array<std::array<double, 2>, 2>, kN2ProngDecays> arrMass2Prong;
   std::array<std::array<std::array<double, 3>, 2>, kN3ProngDecays> arrMass3Prong;
+  using CutStatus = std::bitset<kNCutsMax>;
   // arrays of 2-prong and 3-prong cuts
   std::array<LabeledArray<double>, kN2ProngDecays> cut2Prong;
   std::array<std::vector<double>, kN2ProngDecays> pTBins2Prong;
   std::array<LabeledArray<double>, kN3ProngDecays> cut3Prong;
   std::array<std::vector<double>, kN3ProngDecays> pTBins3Prong;
+  double minPt3Prong{0.}; // lowest pT bin edge among the 3-prong decays, to reject triplets before any mass computation
+
+  /// Prong properties computed once per collision and shared by all the pairs and triplets they enter
+  struct ProngPool {
+    std::vector<o2::track::TrackParCov> trackParVar;
+    std::vector<std::array<float, 3>> pVec;
+    std::vector<o2::gpu::gpustd::array<float, 2>> dcaInfo;
+    std::vector<float> pt;
+
+    void clear()
+    {
+      trackParVar.clear();
+      pVec.clear();
+      dcaInfo.clear();
+      pt.clear();
+    }
+  };
+  ProngPool prongPoolPos;
+  ProngPool prongPoolNeg;
+
+  /// PV contributors of the current collision and PV refits excluding candidate daughters, shared by all its 2- and 3-prong candidates
+  struct PvRefitCollision {
+    std::vector<int64_t> contributorGlobIds;
+    std::vector<o2::track::TrackParCov> contributorTrackParCovs;
+    std::vector<bool> contributorUsed;
+    o2::dataformats::VertexBase primVtx;
+    std::unique_ptr<o2::vertexing::PVertexer> vertexer; // prepared at the first refit of the collision
+    bool isRefitDoable{false};
+    std::map<std::vector<int64_t>, o2::vertexing::PVertex> refits; // refitted PV for each sorted set of excluded contributors
+
+    void clear()
+    {
+      contributorGlobIds.clear();
+      contributorTrackParCovs.clear();
+      contributorUsed.clear();
+      vertexer.reset();
+      isRefitDoable = false;
+      refits.clear();
+    }
+  };
+  PvRefitCollision pvRefitCollision;
 
   // ML response
   o2::analysis::MlResponse<float> hfMlResponse2Prongs;                             // only D0
   std::array<o2::analysis::MlResponse<float>, kN3ProngDecays> hfMlResponse3Prongs; // D+, Lc, Ds, Xic
   std::array<bool, kN3ProngDecays> hasMlModel3Prong{false};
+  static constexpr int kNClassesMl = 3; // bkg, prompt, non-prompt
   o2::ccdb::CcdbApi ccdbApi;
 
+  // candidates selected before the ML selections, the rows are filled by fillPendingCandidates
+  // once per timeframe when the ML is applied (one batched model evaluation), once per collision otherwise
+  struct Pending2Prong {
+    int64_t collisionId{-1};
+    int64_t indexPos{-1};
+    int64_t indexNeg{-1};
+    int isSelected{0};
+    int mlIndexD0{-1}; // index of the candidate in the batch of the D0 model, -1 if not evaluated
+    int rowIndex{-1};  // index of the row in the 2-prong table, -1 if not filled
+    std::array<float, 3> pvRefitCoord{};
+    std::array<float, 6> pvRefitCovMatrix{};
+    std::array<int, kN2ProngDecays> cutStatus{};
+    std::array<double, 3> secondaryVertex{};
+    std::array<std::array<float, 3>, 2> arrMom{};
+    std::array<int, kN2ProngDecays> whichHypo{};
+  };
+  struct Pending3Prong {
+    int64_t collisionId{-1};
+    std::array<int64_t, 3> indices{};
+    int isSelected{0};
+    std::array<int, kN3ProngDecays> mlIndex{-1, -1, -1, -1}; // indices of the candidate in the batches of the 3-prong models, -1 if not evaluated
+    std::array<float, 3> pvRefitCoord{};
+    std::array<float, 6> pvRefitCovMatrix{};
+    std::array<int, kN3ProngDecays> cutStatus{};
+    std::array<double, 3> secondaryVertex{};
+    std::array<std::array<float, 3>, 3> arrMom{};
+    std::array<int, kN3ProngDecays> whichHypo{};
+  };
+  struct PendingDstar {
+    int64_t collisionId{-1};
+    int64_t indexSoftPion{-1};
+    std::size_t iProng2{0}; // index of the D0 candidate in pending2Prongs
+    uint8_t isSelected{0};
+    uint8_t cutStatus{0};
+    float deltaMass{-1.f};
+    std::array<float, 3> pvRefitCoord{};
+    std::array<float, 6> pvRefitCovMatrix{};
+  };
+  std::vector<Pending2Prong> pending2Prongs;
+  std::vector<Pending3Prong> pending3Prongs;
+  std::vector<PendingDstar> pendingDstars;
+  std::vector<std::array<std::size_t, 3>> pendingCollisionEnds; // end of the pending 2-prong, 3-prong and D* candidates of each collision
+
   using SelectedCollisions = soa::Filtered<soa::Join<aod::Collisions, aod::HfSelCollision>>;
   using TracksWithPVRefitAndDCA = soa::Join<aod::TracksWCovDcaExtra, aod::HfPvRefitTrack>;
   using FilteredTrackAssocSel = soa::Filtered<soa::Join<aod::TrackAssoc, aod::HfSelTrack>>;
@@ -1320,6 +1419,10 @@ struct HfTrackIndexSkimCreator {
     // cuts for 3-prong decays retrieved by json. the order must be then one in hf_cand_3prong::DecayType
     cut3Prong = {cutsDplusToPiKPi, cutsLcToPKPi, cutsDsToKKPi, cutsXicToPKPi};
     pTBins3Prong = {binsPtDplusToPiKPi, binsPtLcToPKPi, binsPtDsToKKPi, binsPtXicToPKPi};
+    minPt3Prong = pTBins3Prong[0].front();
+    for (const auto& bins : pTBins3Prong) {
+      minPt3Prong = std::min(minPt3Prong, bins.front());
+    }
 
     df2.setPropagateToPCA(propagateToPCA);
     df2.setMaxR(maxR);
@@ -1428,7 +1531,7 @@ struct HfTrackIndexSkimCreator {
       const std::array<LabeledArray<double>, kN3ProngDecays> thresholdMlScore3Prongs = {thresholdMlScoreDplusToPiKPi, thresholdMlScoreLcToPiKP, thresholdMlScoreDsToPiKK, thresholdMlScoreXicToPiKP};
 
       // initialise 2-prong ML response
-      hfMlResponse2Prongs.configure(ptBinsMl, thresholdMlScoreD0ToKPi, cutDirMl, 3);
+      hfMlResponse2Prongs.configure(ptBinsMl, thresholdMlScoreD0ToKPi, cutDirMl, kNClassesMl);
       if (loadMlModelsFromCCDB) {
         ccdbApi.init(ccdbUrl);
         hfMlResponse2Prongs.setModelPathsCCDB(onnxFileNames2Prongs, ccdbApi, mlModelPathCcdb2Prongs, timestampCcdbForHfFilters);
@@ -1436,6 +1539,7 @@ struct HfTrackIndexSkimCreator {
         hfMlResponse2Prongs.setModelPathsLocal(onnxFileNames2Prongs);
       }
       hfMlResponse2Prongs.init();
+      hfMlResponse2Prongs.setMaxBatchSize(maxBatchSizeMlForHfFilters);
 
       // initialise 3-prong ML responses
       for (int iDecay3P{0}; iDecay3P < kN3ProngDecays; ++iDecay3P) {
@@ -1443,7 +1547,7 @@ struct HfTrackIndexSkimCreator {
           continue;
         }
         hasMlModel3Prong[iDecay3P] = true;
-        hfMlResponse3Prongs[iDecay3P].configure(ptBinsMl, thresholdMlScore3Prongs[iDecay3P], cutDirMl, 3);
+        hfMlResponse3Prongs[iDecay3P].configure(ptBinsMl, thresholdMlScore3Prongs[iDecay3P], cutDirMl, kNClassesMl);
         if (loadMlModelsFromCCDB) {
           ccdbApi.init(ccdbUrl);
           hfMlResponse3Prongs[iDecay3P].setModelPathsCCDB(onnxFileNames3Prongs[iDecay3P], ccdbApi, mlModelPathCcdb3Prongs[iDecay3P], timestampCcdbForHfFilters);
@@ -1451,6 +1555,59 @@ struct HfTrackIndexSkimCreator {
           hfMlResponse3Prongs[iDecay3P].setModelPathsLocal(onnxFileNames3Prongs[iDecay3P]);
         }
         hfMlResponse3Prongs[iDecay3P].init();
+        hfMlResponse3Prongs[iDecay3P].setMaxBatchSize(maxBatchSizeMlForHfFilters);
+      }
+    }
+  }
+
+  /// Fills the prong pool of a collision, re-propagating to it the tracks associated to it but belonging to another collision
+  /// \param pool is the pool to fill, in the same order as the track indices
+  /// \param groupedTrackIndices are the track indices of the collision
+  /// \param collision is the collision
+  template <typename TTracks, typename T1, typename T2>
+  void fillProngPool(ProngPool& pool, T1 const& groupedTrackIndices, T2 const& collision)
+  {
+    pool.clear();
+    for (const auto& trackIndex : groupedTrackIndices) {
+      auto track = trackIndex.template track_as<TTracks>();
+      auto trackParVar = getTrackParCov(track);
+      std::array<float, 3> pVec{track.pVector()};
+      o2::gpu::gpustd::array<float, 2> dcaInfo{track.dcaXY(), track.dcaZ()};
+      if (collision.globalIndex() != track.collisionId()) { // this is not the "default" collision for this track, we have to re-propagate it
+        o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVar, 2.f, noMatCorr, &dcaInfo);
+        getPxPyPz(trackParVar, pVec);
+      }
+      pool.trackParVar.push_back(trackParVar);
+      pool.pVec.push_back(pVec);
+      pool.dcaInfo.push_back(dcaInfo);
+      pool.pt.push_back(RecoDecay::pt(pVec));
+    }
+  }
+
+  /// Computes the squared invariant masses of all the mass hypotheses of all the decays of a prong combination at once.
+  /// The momenta are summed once, only the prong energies depend on the hypothesis.
+  /// \param arrMom is the array of prong momenta
+  /// \param arrMass are the prong masses of each decay and hypothesis
+  /// \param mass2Hypos are the squared invariant masses of each decay and hypothesis
+  template <std::size_t NProngs, std::size_t NDecays>
+  static void computeMass2Hypos(std::array<std::array<float, 3>, NProngs> const& arrMom, std::array<std::array<std::array<double, NProngs>, 2>, NDecays> const& arrMass, std::array<std::array<double, 2>, NDecays>& mass2Hypos)
+  {
+    std::array<double, NProngs> mom2;
+    std::array<double, 3> momTotal{0., 0., 0.};
+    for (std::size_t iProng = 0; iProng < NProngs; ++iProng) {
+      mom2[iProng] = RecoDecay::p2(arrMom[iProng]);
+      for (std::size_t iMom = 0; iMom < 3; ++iMom) {
+        momTotal[iMom] += arrMom[iProng][iMom];
+      }
+    }
+    double momTotal2 = RecoDecay::p2(momTotal);
+    for (std::size_t iDecay = 0; iDecay < NDecays; ++iDecay) {
+      for (std::size_t iHypo = 0; iHypo < 2; ++iHypo) {
+        double energyTot{0.};
+        for (std::size_t iProng = 0; iProng < NProngs; ++iProng) {
+          energyTot += std::sqrt(mom2[iProng] + arrMass[iDecay][iHypo][iProng] * arrMass[iDecay][iHypo][iProng]);
+        }
+        mass2Hypos[iDecay][iHypo] = energyTot * energyTot - momTotal2;
       }
     }
   }
@@ -1469,7 +1626,8 @@ struct HfTrackIndexSkimCreator {
   {
     whichHypo[kN2ProngDecays] = 0; // D0 for D*
 
-    auto arrMom = std::array{pVecTrack0, pVecTrack1};
+    std::array<std::array<double, 2>, kN2ProngDecays> mass2Hypos;
+    computeMass2Hypos(std::array{pVecTrack0, pVecTrack1}, arrMass2Prong, mass2Hypos);
     pt2Prong = RecoDecay::pt(pVecTrack0, pVecTrack1);
     auto pT = pt2Prong + ptTolerance; // add tolerance because of no reco decay vertex
 
@@ -1495,8 +1653,8 @@ struct HfTrackIndexSkimCreator {
       double max2 = maxMass * maxMass;
 
       if ((debug || TESTBIT(isSelected, iDecay2P)) && minMass >= 0. && maxMass > 0.) {
-        massHypos[0] = RecoDecay::m2(arrMom, arrMass2Prong[iDecay2P][0]);
-        massHypos[1] = (iDecay2P == hf_cand_2prong::DecayType::D0ToPiK) ? RecoDecay::m2(arrMom, arrMass2Prong[iDecay2P][1]) : massHypos[0];
+        massHypos[0] = mass2Hypos[iDecay2P][0];
+        massHypos[1] = (iDecay2P == hf_cand_2prong::DecayType::D0ToPiK) ? mass2Hypos[iDecay2P][1] : massHypos[0];
         if (massHypos[0] < min2 || massHypos[0] >= max2) {
           CLRBIT(whichHypo[iDecay2P], 0);
         }
@@ -1586,7 +1744,8 @@ struct HfTrackIndexSkimCreator {
   void applyPreselection3Prong(T1 const& pVecTrack0, T1 const& pVecTrack1, T1 const& pVecTrack2, int8_t& isIdentifiedPidTrack0, int8_t& isIdentifiedPidTrack2, T2& cutStatus, T3& whichHypo, int& isSelected)
   {
 
-    auto arrMom = std::array{pVecTrack0, pVecTrack1, pVecTrack2};
+    std::array<std::array<double, 2>, kN3ProngDecays> mass2Hypos;
+    computeMass2Hypos(std::array{pVecTrack0, pVecTrack1, pVecTrack2}, arrMass3Prong, mass2Hypos);
     auto pT = RecoDecay::pt(pVecTrack0, pVecTrack1, pVecTrack2) + ptTolerance; // add tolerance because of no reco decay vertex
 
     for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
@@ -1629,8 +1788,8 @@ struct HfTrackIndexSkimCreator {
       double max2 = maxMass * maxMass;
 
       if ((debug || TESTBIT(isSelected, iDecay3P)) && minMass >= 0. && maxMass > 0.) { // no need to check isSelected but to avoid mistakes
-        massHypos[0] = RecoDecay::m2(arrMom, arrMass3Prong[iDecay3P][0]);
-        massHypos[1] = (iDecay3P != hf_cand_3prong::DecayType::DplusToPiKPi) ? RecoDecay::m2(arrMom, arrMass3Prong[iDecay3P][1]) : massHypos[0];
+        massHypos[0] = mass2Hypos[iDecay3P][0];
+        massHypos[1] = (iDecay3P != hf_cand_3prong::DecayType::DplusToPiKPi) ? mass2Hypos[iDecay3P][1] : massHypos[0];
         if (massHypos[0] < min2 || massHypos[0] >= max2) {
           CLRBIT(whichHypo[iDecay3P], 0);
         }
@@ -1688,17 +1847,35 @@ struct HfTrackIndexSkimCreator {
     }
   }
 
-  /// Method to perform ML selections for 2-prong candidates after the rectangular selections
-  /// \param featuresCand is the vector with the candidate features
+  /// Method to add 2-prong candidates selected by the rectangular selections to the batch of the ML model
+  /// \param featuresCand is the array with the candidate features
+  /// \param candidate is the pending candidate
+  template <typename T>
+  void addToMlBatchForHfFilters2Prong(const T& featuresCand, Pending2Prong& candidate)
+  {
+    if (!TESTBIT(candidate.isSelected, hf_cand_2prong::DecayType::D0ToPiK)) {
+      return;
+    }
+    const float ptDummy = 1.; // dummy pT value (only one pT bin)
+    candidate.mlIndexD0 = hfMlResponse2Prongs.addToBatch(featuresCand, ptDummy);
+  }
+
+  /// Method to perform ML selections for 2-prong candidates after the evaluation of the batch
+  /// \param candidate is the pending candidate, whose selection bitmap is updated
   /// \param outputScores is the vector with the output scores to be filled
-  /// \param isSelected ia s bitmap with selection outcome
-  void applyMlSelectionForHfFilters2Prong(std::vector<float> featuresCand, std::vector<float>& outputScores, int& isSelected)
+  void applyMlSelectionForHfFilters2Prong(Pending2Prong& candidate, std::vector<float>& outputScores)
   {
+    int& isSelected = candidate.isSelected;
     if (!TESTBIT(isSelected, hf_cand_2prong::DecayType::D0ToPiK)) {
       return;
     }
-    const float ptDummy = 1.; // dummy pT value (only one pT bin)
-    bool isSelMl = hfMlResponse2Prongs.isSelectedMl(featuresCand, ptDummy, outputScores);
+    if (candidate.mlIndexD0 < 0) {
+      CLRBIT(isSelected, hf_cand_2prong::DecayType::D0ToPiK);
+      return;
+    }
+    const float* scores = hfMlResponse2Prongs.getBatchOutput(candidate.mlIndexD0);
+    outputScores.assign(scores, scores + kNClassesMl);
+    bool isSelMl = hfMlResponse2Prongs.isSelectedMlBatch(candidate.mlIndexD0);
     if (fillHistograms) {
       registry.fill(HIST("ML/hMlScoreBkgD0"), outputScores[0]);
       registry.fill(HIST("ML/hMlScorePromptD0"), outputScores[1]);
@@ -1777,20 +1954,44 @@ struct HfTrackIndexSkimCreator {
     }
   }
 
-  /// Method to perform ML selections for 2-prong candidates after the rectangular selections
-  /// \param featuresCand is the vector with the candidate features
+  /// Method to add 3-prong candidates selected by the rectangular selections to the batches of the ML models
+  /// \param featuresCand is the array with the candidate features
+  /// \param candidate is the pending candidate
+  template <typename T>
+  void addToMlBatchForHfFilters3Prong(const T& featuresCand, Pending3Prong& candidate)
+  {
+    if (candidate.isSelected == 0) {
+      return;
+    }
+
+    const float ptDummy = 1.; // dummy pT value (only one pT bin)
+    for (int iDecay3P{0}; iDecay3P < kN3ProngDecays; ++iDecay3P) {
+      if (TESTBIT(candidate.isSelected, iDecay3P) && hasMlModel3Prong[iDecay3P]) {
+        candidate.mlIndex[iDecay3P] = hfMlResponse3Prongs[iDecay3P].addToBatch(featuresCand, ptDummy);
+      }
+    }
+  }
+
+  /// Method to perform ML selections for 3-prong candidates after the evaluation of the batches
+  /// \param candidate is the pending candidate, whose selection bitmap is updated
   /// \param outputScores is the array of vectors with the output scores to be filled
-  /// \param isSelected ia s bitmap with selection outcome
-  void applyMlSelectionForHfFilters3Prong(std::vector<float> featuresCand, std::array<std::vector<float>, kN3ProngDecays>& outputScores, int& isSelected)
+  void applyMlSelectionForHfFilters3Prong(Pending3Prong& candidate, std::array<std::vector<float>, kN3ProngDecays>& outputScores)
   {
+    int& isSelected = candidate.isSelected;
     if (isSelected == 0) {
       return;
     }
 
-    const float ptDummy = 1.; // dummy pT value (only one pT bin)
     for (int iDecay3P{0}; iDecay3P < kN3ProngDecays; ++iDecay3P) {
       if (TESTBIT(isSelected, iDecay3P) && hasMlModel3Prong[iDecay3P]) {
-        bool isMlSel = hfMlResponse3Prongs[iDecay3P].isSelectedMl(featuresCand, ptDummy, outputScores[iDecay3P]);
+        const int mlIndex = candidate.mlIndex[iDecay3P];
+        if (mlIndex < 0) {
+          CLRBIT(isSelected, iDecay3P);
+          continue;
+        }
+        const float* scores = hfMlResponse3Prongs[iDecay3P].getBatchOutput(mlIndex);
+        outputScores[iDecay3P].assign(scores, scores + kNClassesMl);
+        bool isMlSel = hfMlResponse3Prongs[iDecay3P].isSelectedMlBatch(mlIndex);
         if (fillHistograms) {
           switch (iDecay3P) {
             case hf_cand_3prong::DecayType::DplusToPiKPi: {
@@ -1879,48 +2080,55 @@ struct HfTrackIndexSkimCreator {
     return isSelected;
   }
 
-  /// Method for the PV refit excluding the candidate daughters
+  /// Prepares the vertexer for the PV refits of the current collision from its contributors stored in pvRefitCollision
   /// \param collision is a collision
-  /// \param bcWithTimeStamps is a table of bunch crossing joined with timestamps used to query the CCDB for B and material budget
-  /// \param vecPvContributorGlobId is a vector containing the global ID of PV contributors for the current collision
-  /// \param vecPvContributorTrackParCov is a vector containing the TrackParCov of PV contributors for the current collision
-  /// \param vecCandPvContributorGlobId is a vector containing the global indices of daughter tracks that contributed to the original PV refit
-  /// \param pvCoord is a vector where to store X, Y and Z values of refitted PV
-  /// \param pvCovMatrix is a vector where to store the covariance matrix values of refitted PV
-  void performPvRefitCandProngs(SelectedCollisions::iterator const& collision,
-                                aod::BCsWithTimestamps const&,
-                                std::vector<int64_t> vecPvContributorGlobId,
-                                std::vector<o2::track::TrackParCov> vecPvContributorTrackParCov,
-                                std::vector<int64_t> vecCandPvContributorGlobId,
-                                std::array<float, 3>& pvCoord,
-                                std::array<float, 6>& pvCovMatrix)
+  void preparePvRefitCollision(SelectedCollisions::iterator const& collision)
   {
-    std::vector<bool> vecPvRefitContributorUsed(vecPvContributorGlobId.size(), true);
-
-    /// Prepare the vertex refitting
     // set the magnetic field from CCDB
     auto bc = collision.bc_as<o2::aod::BCsWithTimestamps>();
     initCCDB(bc, runNumber, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, lut, isRun2);
 
     // build the VertexBase to initialize the vertexer
-    o2::dataformats::VertexBase primVtx;
+    auto& primVtx = pvRefitCollision.primVtx;
     primVtx.setX(collision.posX());
     primVtx.setY(collision.posY());
     primVtx.setZ(collision.posZ());
     primVtx.setCov(collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ());
     // configure PVertexer
-    o2::vertexing::PVertexer vertexer;
+    pvRefitCollision.vertexer = std::make_unique<o2::vertexing::PVertexer>();
     o2::conf::ConfigurableParam::updateFromString("pvertexer.useMeanVertexConstraint=false"); /// remove diamond constraint (let's keep it at the moment...)
-    vertexer.init();
-    bool pvRefitDoable = vertexer.prepareVertexRefit(vecPvContributorTrackParCov, primVtx);
-    if (!pvRefitDoable) {
+    pvRefitCollision.vertexer->init();
+    pvRefitCollision.isRefitDoable = pvRefitCollision.vertexer->prepareVertexRefit(pvRefitCollision.contributorTrackParCovs, primVtx);
+    pvRefitCollision.contributorUsed.assign(pvRefitCollision.contributorGlobIds.size(), true);
+    if (!pvRefitCollision.isRefitDoable) {
       LOG(info) << "Not enough tracks accepted for the refit";
-      if (doprocess2And3ProngsWithPvRefit && fillHistograms) {
-        registry.fill(HIST("PvRefit/hNContribPvRefitNotDoable"), collision.numContrib());
-      }
     }
     if (debugPvRefit) {
-      LOG(info) << "prepareVertexRefit = " << pvRefitDoable << " Ncontrib= " << vecPvContributorTrackParCov.size() << " Ntracks= " << collision.numContrib() << " Vtx= " << primVtx.asString();
+      LOG(info) << "prepareVertexRefit = " << pvRefitCollision.isRefitDoable << " Ncontrib= " << pvRefitCollision.contributorTrackParCovs.size() << " Ntracks= " << collision.numContrib() << " Vtx= " << primVtx.asString();
+    }
+  }
+
+  /// Method for the PV refit excluding the candidate daughters
+  /// The refits are cached per collision, so candidates sharing the same daughter contributors reuse the same refitted PV.
+  /// \param collision is a collision
+  /// \param vecCandPvContributorGlobId is a vector containing the global indices of daughter tracks that contributed to the original PV refit
+  /// \param pvCoord is a vector where to store X, Y and Z values of refitted PV
+  /// \param pvCovMatrix is a vector where to store the covariance matrix values of refitted PV
+  void performPvRefitCandProngs(SelectedCollisions::iterator const& collision,
+                                std::vector<int64_t> vecCandPvContributorGlobId,
+                                std::array<float, 3>& pvCoord,
+                                std::array<float, 6>& pvCovMatrix)
+  {
+    /// Prepare the vertex refitting, once per collision
+    if (!pvRefitCollision.vertexer) {
+      preparePvRefitCollision(collision);
+    }
+    const auto& vecPvContributorGlobId = pvRefitCollision.contributorGlobIds;
+    auto& vecPvRefitContributorUsed = pvRefitCollision.contributorUsed;
+    const auto& primVtx = pvRefitCollision.primVtx;
+    const bool pvRefitDoable = pvRefitCollision.isRefitDoable;
+    if (!pvRefitDoable && doprocess2And3ProngsWithPvRefit && fillHistograms) {
+      registry.fill(HIST("PvRefit/hNContribPvRefitNotDoable"), collision.numContrib());
     }
 
     /// PV refitting, if the tracks contributed to this at the beginning
@@ -1931,22 +2139,33 @@ struct HfTrackIndexSkimCreator {
         registry.fill(HIST("PvRefit/verticesPerCandidate"), 2);
       }
       recalcPvRefit = true;
-      int nCandContr = 0;
-      for (uint64_t myGlobalID : vecCandPvContributorGlobId) {
-        auto trackIterator = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), myGlobalID); /// track global index
-        if (trackIterator != vecPvContributorGlobId.end()) {
-          /// this is a contributor, let's remove it for the PV refit
-          const int entry = std::distance(vecPvContributorGlobId.begin(), trackIterator);
-          vecPvRefitContributorUsed[entry] = false; /// remove the track from the PV refitting
-          nCandContr++;
+      std::sort(vecCandPvContributorGlobId.begin(), vecCandPvContributorGlobId.end());
+      auto refit = pvRefitCollision.refits.find(vecCandPvContributorGlobId);
+      if (refit == pvRefitCollision.refits.end()) {
+        int nCandContr = 0;
+        for (uint64_t myGlobalID : vecCandPvContributorGlobId) {
+          auto trackIterator = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), myGlobalID); /// track global index
+          if (trackIterator != vecPvContributorGlobId.end()) {
+            /// this is a contributor, let's remove it for the PV refit
+            const int entry = std::distance(vecPvContributorGlobId.begin(), trackIterator);
+            vecPvRefitContributorUsed[entry] = false; /// remove the track from the PV refitting
+            nCandContr++;
+          }
         }
-      }
 
-      /// do the PV refit excluding the candidate daughters that originally contributed to fit it
-      if (debugPvRefit) {
-        LOG(info) << "### PV refit after removing " << nCandContr << " tracks";
+        /// do the PV refit excluding the candidate daughters that originally contributed to fit it
+        if (debugPvRefit) {
+          LOG(info) << "### PV refit after removing " << nCandContr << " tracks";
+        }
+        refit = pvRefitCollision.refits.emplace(vecCandPvContributorGlobId, pvRefitCollision.vertexer->refitVertex(vecPvRefitContributorUsed, primVtx)).first; // vertex refit
+
+        for (size_t i = 0; i < vecPvContributorGlobId.size(); i++) {
+          vecPvRefitContributorUsed[i] = true; /// restore the tracks for the next PV refitting
+        }
+      } else if (debugPvRefit) {
+        LOG(info) << "### PV refit after removing " << vecCandPvContributorGlobId.size() << " tracks already done for this collision, reusing it";
       }
-      auto primVtxRefitted = vertexer.refitVertex(vecPvRefitContributorUsed, primVtx); // vertex refit
+      const auto& primVtxRefitted = refit->second;
       // LOG(info) << "refit " << cnt << "/" << ntr << " result = " << primVtxRefitted.asString();
       // LOG(info) << "refit for track with global index " << static_cast<int>(myTrack.globalIndex()) << " " << primVtxRefitted.asString();
       if (primVtxRefitted.getChi2() < 0) {
@@ -1968,10 +2187,6 @@ struct HfTrackIndexSkimCreator {
         registry.fill(HIST("PvRefit/hChi2vsNContrib"), primVtxRefitted.getNContributors(), primVtxRefitted.getChi2());
       }
 
-      for (size_t i = 0; i < vecPvContributorGlobId.size(); i++) {
-        vecPvRefitContributorUsed[i] = true; /// restore the tracks for the next PV refitting (probably not necessary here)
-      }
-
       if (recalcPvRefit) {
         // fill the histograms for refitted PV with good Chi2
         const double deltaX = primVtx.getX() - primVtxRefitted.getX();
@@ -2015,9 +2230,221 @@ struct HfTrackIndexSkimCreator {
     return;
   } /// end of performPvRefitCandProngs function
 
+  /// Method to fill the tables with a pending 2-prong candidate, after the ML selections
+  /// \param candidate is the pending candidate
+  /// \returns true if the row was filled
+  template <bool doPvRefit>
+  bool fillPending2Prong(Pending2Prong& candidate)
+  {
+    std::vector<float> mlScoresD0{};
+    if (applyMlForHfFilters) {
+      applyMlSelectionForHfFilters2Prong(candidate, mlScoresD0);
+    }
+    if (candidate.isSelected <= 0) {
+      return false;
+    }
+
+    // fill table row
+    rowTrackIndexProng2(candidate.collisionId, candidate.indexPos, candidate.indexNeg, candidate.isSelected);
+    if (applyMlForHfFilters) {
+      rowTrackIndexMlScoreProng2(mlScoresD0);
+    }
+    candidate.rowIndex = rowTrackIndexProng2.lastIndex();
+
+    if constexpr (doPvRefit) {
+      // fill table row with coordinates of PV refit
+      rowProng2PVrefit(candidate.pvRefitCoord[0], candidate.pvRefitCoord[1], candidate.pvRefitCoord[2],
+                       candidate.pvRefitCovMatrix[0], candidate.pvRefitCovMatrix[1], candidate.pvRefitCovMatrix[2], candidate.pvRefitCovMatrix[3], candidate.pvRefitCovMatrix[4], candidate.pvRefitCovMatrix[5]);
+    }
+
+    if (debug) {
+      rowProng2CutStatus(candidate.cutStatus[0], candidate.cutStatus[1], candidate.cutStatus[2]); // FIXME when we can do this by looping over kN2ProngDecays
+    }
+
+    // fill histograms
+    if (fillHistograms) {
+      registry.fill(HIST("hVtx2ProngX"), candidate.secondaryVertex[0]);
+      registry.fill(HIST("hVtx2ProngY"), candidate.secondaryVertex[1]);
+      registry.fill(HIST("hVtx2ProngZ"), candidate.secondaryVertex[2]);
+      for (int iDecay2P = 0; iDecay2P < kN2ProngDecays; iDecay2P++) {
+        if (TESTBIT(candidate.isSelected, iDecay2P)) {
+          if (TESTBIT(candidate.whichHypo[iDecay2P], 0)) {
+            auto mass2Prong = RecoDecay::m(candidate.arrMom, arrMass2Prong[iDecay2P][0]);
+            switch (iDecay2P) {
+              case hf_cand_2prong::DecayType::D0ToPiK:
+                registry.fill(HIST("hMassD0ToPiK"), mass2Prong);
+                break;
+              case hf_cand_2prong::DecayType::JpsiToEE:
+                registry.fill(HIST("hMassJpsiToEE"), mass2Prong);
+                break;
+              case hf_cand_2prong::DecayType::JpsiToMuMu:
+                registry.fill(HIST("hMassJpsiToMuMu"), mass2Prong);
+                break;
+            }
+          }
+          if (TESTBIT(candidate.whichHypo[iDecay2P], 1)) {
+            auto mass2Prong = RecoDecay::m(candidate.arrMom, arrMass2Prong[iDecay2P][1]);
+            if (iDecay2P == hf_cand_2prong::DecayType::D0ToPiK) {
+              registry.fill(HIST("hMassD0ToPiK"), mass2Prong);
+            }
+          }
+        }
+      }
+    }
+    return true;
+  }
+
+  /// Method to fill the tables with a pending 3-prong candidate, after the ML selections
+  /// \param candidate is the pending candidate
+  /// \returns true if the row was filled
+  template <bool doPvRefit>
+  bool fillPending3Prong(Pending3Prong& candidate)
+  {
+    std::array<std::vector<float>, kN3ProngDecays> mlScores3Prongs;
+    if (applyMlForHfFilters) {
+      applyMlSelectionForHfFilters3Prong(candidate, mlScores3Prongs);
+    }
+    if (!debug && candidate.isSelected == 0) {
+      return false;
+    }
+
+    // fill table row
+    rowTrackIndexProng3(candidate.collisionId, candidate.indices[0], candidate.indices[1], candidate.indices[2], candidate.isSelected);
+    if (applyMlForHfFilters) {
+      rowTrackIndexMlScoreProng3(mlScores3Prongs[0], mlScores3Prongs[1], mlScores3Prongs[2], mlScores3Prongs[3]);
+    }
+    if constexpr (doPvRefit) {
+      // fill table row of coordinates of PV refit
+      rowProng3PVrefit(candidate.pvRefitCoord[0], candidate.pvRefitCoord[1], candidate.pvRefitCoord[2],
+                       candidate.pvRefitCovMatrix[0], candidate.pvRefitCovMatrix[1], candidate.pvRefitCovMatrix[2], candidate.pvRefitCovMatrix[3], candidate.pvRefitCovMatrix[4], candidate.pvRefitCovMatrix[5]);
+    }
+
+    if (debug) {
+      rowProng3CutStatus(candidate.cutStatus[0], candidate.cutStatus[1], candidate.cutStatus[2], candidate.cutStatus[3]); // FIXME when we can do this by looping over kN3ProngDecays
+    }
+
+    // fill histograms
+    if (fillHistograms) {
+      registry.fill(HIST("hVtx3ProngX"), candidate.secondaryVertex[0]);
+      registry.fill(HIST("hVtx3ProngY"), candidate.secondaryVertex[1]);
+      registry.fill(HIST("hVtx3ProngZ"), candidate.secondaryVertex[2]);
+      for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
+        if (TESTBIT(candidate.isSelected, iDecay3P)) {
+          if (TESTBIT(candidate.whichHypo[iDecay3P], 0)) {
+            auto mass3Prong = RecoDecay::m(candidate.arrMom, arrMass3Prong[iDecay3P][0]);
+            switch (iDecay3P) {
+              case hf_cand_3prong::DecayType::DplusToPiKPi:
+                registry.fill(HIST("hMassDPlusToPiKPi"), mass3Prong);
+                break;
+              case hf_cand_3prong::DecayType::DsToKKPi:
+                registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
+                break;
+              case hf_cand_3prong::DecayType::LcToPKPi:
+                registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
+                break;
+              case hf_cand_3prong::DecayType::XicToPKPi:
+                registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
+                break;
+            }
+          }
+          if (TESTBIT(candidate.whichHypo[iDecay3P], 1)) {
+            auto mass3Prong = RecoDecay::m(candidate.arrMom, arrMass3Prong[iDecay3P][1]);
+            switch (iDecay3P) {
+              case hf_cand_3prong::DecayType::DsToKKPi:
+                registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
+                break;
+              case hf_cand_3prong::DecayType::LcToPKPi:
+                registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
+                break;
+              case hf_cand_3prong::DecayType::XicToPKPi:
+                registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
+                break;
+            }
+          }
+        }
+      }
+    }
+    return true;
+  }
+
+  /// Method to fill the tables with a pending D* candidate, once its D0 candidate is filled
+  /// \param candidate is the pending candidate
+  template <bool doPvRefit>
+  void fillPendingDstar(const PendingDstar& candidate)
+  {
+    const auto& candidateD0 = pending2Prongs[candidate.iProng2];
+    if (!TESTBIT(candidateD0.isSelected, hf_cand_2prong::DecayType::D0ToPiK)) { // D0 rejected by the ML selections
+      return;
+    }
+    if (candidate.isSelected) {
+      rowTrackIndexDstar(candidate.collisionId, candidate.indexSoftPion, candidateD0.rowIndex);
+      if (fillHistograms) {
+        registry.fill(HIST("hMassDstarToD0Pi"), candidate.deltaMass);
+      }
+      if constexpr (doPvRefit) {
+        // fill table row with coordinates of PV refit (same as 2-prong because we do not remove the soft pion)
+        rowDstarPVrefit(candidate.pvRefitCoord[0], candidate.pvRefitCoord[1], candidate.pvRefitCoord[2],
+                        candidate.pvRefitCovMatrix[0], candidate.pvRefitCovMatrix[1], candidate.pvRefitCovMatrix[2], candidate.pvRefitCovMatrix[3], candidate.pvRefitCovMatrix[4], candidate.pvRefitCovMatrix[5]);
+      }
+    }
+    if (debug) {
+      rowDstarCutStatus(candidate.cutStatus);
+    }
+  }
+
+  /// Method to evaluate the ML models on the pending candidates (one batch per model) and fill the tables, collision by collision
+  template <bool doPvRefit>
+  void fillPendingCandidates()
+  {
+    if (applyMlForHfFilters) {
+      hfMlResponse2Prongs.evaluateBatch();
+      for (int iDecay3P{0}; iDecay3P < kN3ProngDecays; ++iDecay3P) {
+        if (hasMlModel3Prong[iDecay3P]) {
+          hfMlResponse3Prongs[iDecay3P].evaluateBatch();
+        }
+      }
+    }
+
+    std::size_t iCand2{0}, iCand3{0}, iCandDstar{0};
+    for (const auto& ends : pendingCollisionEnds) {
+      int nCand2 = 0; // number of 2-prong candidates in this collision
+      int nCand3 = 0; // number of 3-prong candidates in this collision
+      for (; iCand2 < ends[0]; ++iCand2) {
+        nCand2 += fillPending2Prong<doPvRefit>(pending2Prongs[iCand2]);
+      }
+      for (; iCand3 < ends[1]; ++iCand3) {
+        nCand3 += fillPending3Prong<doPvRefit>(pending3Prongs[iCand3]);
+      }
+      for (; iCandDstar < ends[2]; ++iCandDstar) {
+        fillPendingDstar<doPvRefit>(pendingDstars[iCandDstar]);
+      }
+
+      int nTracks = 0;
+      // auto nTracks = trackIndicesPerCollision.lastIndex() - trackIndicesPerCollision.firstIndex(); // number of tracks passing 2 and 3 prong selection in this collision
+      if (fillHistograms) {
+        registry.fill(HIST("hNTracks"), nTracks);
+        registry.fill(HIST("hNCand2Prong"), nCand2);
+        registry.fill(HIST("hNCand3Prong"), nCand3);
+        registry.fill(HIST("hNCand2ProngVsNTracks"), nTracks, nCand2);
+        registry.fill(HIST("hNCand3ProngVsNTracks"), nTracks, nCand3);
+      }
+    }
+
+    pending2Prongs.clear();
+    pending3Prongs.clear();
+    pendingDstars.clear();
+    pendingCollisionEnds.clear();
+    if (applyMlForHfFilters) {
+      hfMlResponse2Prongs.clearBatch();
+      for (auto& mlResponse : hfMlResponse3Prongs) {
+        mlResponse.clearBatch();
+      }
+    }
+  }
+
   template <bool doPvRefit = false, typename TTracks>
   void run2And3Prongs(SelectedCollisions const& collisions,
-                      aod::BCsWithTimestamps const& bcWithTimeStamps,
+                      aod::BCsWithTimestamps const&,
                       FilteredTrackAssocSel const&,
                       TTracks const& tracks)
   {
@@ -2036,9 +2463,9 @@ struct HfTrackIndexSkimCreator {
     for (const auto& collision : collisions) {
 
       /// retrieve PV contributors for the current collision
-      std::vector<int64_t> vecPvContributorGlobId{};
-      std::vector<o2::track::TrackParCov> vecPvContributorTrackParCov{};
-      std::vector<bool> vecPvRefitContributorUsed{};
+      pvRefitCollision.clear();
+      auto& vecPvContributorGlobId = pvRefitCollision.contributorGlobIds;
+      auto& vecPvContributorTrackParCov = pvRefitCollision.contributorTrackParCovs;
       if constexpr (doPvRefit) {
         auto groupedTracksUnfiltered = tracks.sliceBy(tracksPerCollision, collision.globalIndex());
         const int nTrk = groupedTracksUnfiltered.size();
@@ -2065,7 +2492,6 @@ struct HfTrackIndexSkimCreator {
             LOG(info) << "!!! Some problem here !!! vecPvContributorTrackParCov.size()= " << vecPvContributorTrackParCov.size() << ", nContrib=" << nContrib << ", collision.numContrib()" << collision.numContrib();
           }
         }
-        vecPvRefitContributorUsed = std::vector<bool>(vecPvContributorGlobId.size(), true);
       }
 
       // auto centrality = collision.centV0M(); //FIXME add centrality when option for variations to the process function appears
@@ -2073,18 +2499,13 @@ struct HfTrackIndexSkimCreator {
       int n2ProngBit = BIT(kN2ProngDecays) - 1; // bit value for 2-prong candidates where each candidate is one bit and they are all set to 1
       int n3ProngBit = BIT(kN3ProngDecays) - 1; // bit value for 3-prong candidates where each candidate is one bit and they are all set to 1
 
-      std::array<std::vector<bool>, kN2ProngDecays> cutStatus2Prong;
-      std::array<std::vector<bool>, kN3ProngDecays> cutStatus3Prong;
-      bool nCutStatus2ProngBit[kN2ProngDecays]; // bit value for selection status for each 2-prong candidate where each selection is one bit and they are all set to 1
-      bool nCutStatus3ProngBit[kN3ProngDecays]; // bit value for selection status for each 3-prong candidate where each selection is one bit and they are all set to 1
-
-      for (int iDecay2P = 0; iDecay2P < kN2ProngDecays; iDecay2P++) {
-        nCutStatus2ProngBit[iDecay2P] = BIT(kNCuts2Prong[iDecay2P]) - 1;
-        cutStatus2Prong[iDecay2P] = std::vector<bool>(kNCuts2Prong[iDecay2P], true);
+      std::array<CutStatus, kN2ProngDecays> cutStatus2Prong; // outcome of each selection for each 2-prong decay, one bit per selection
+      std::array<CutStatus, kN3ProngDecays> cutStatus3Prong; // outcome of each selection for each 3-prong decay, one bit per selection
+      for (auto& status : cutStatus2Prong) {
+        status.set();
       }
-      for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
-        nCutStatus3ProngBit[iDecay3P] = BIT(kNCuts3Prong[iDecay3P]) - 1;
-        cutStatus3Prong[iDecay3P] = std::vector<bool>(kNCuts3Prong[iDecay3P], true);
+      for (auto& status : cutStatus3Prong) {
+        status.set();
       }
 
       int whichHypo2Prong[kN2ProngDecays + 1]; // we also put D0 for D* in the last slot
@@ -2096,10 +2517,6 @@ struct HfTrackIndexSkimCreator {
       df2.setBz(o2::base::Propagator::Instance()->getNominalBz());
       df3.setBz(o2::base::Propagator::Instance()->getNominalBz());
 
-      // used to calculate number of candidiates per event
-      auto nCand2 = rowTrackIndexProng2.lastIndex();
-      auto nCand3 = rowTrackIndexProng3.lastIndex();
-
       // if there isn't at least a positive and a negative track, continue immediately
       // if (tracksPos.size() < 1 || tracksNeg.size() < 1) {
       //  return;
@@ -2107,10 +2524,15 @@ struct HfTrackIndexSkimCreator {
 
       auto thisCollId = collision.globalIndex();
 
-      // first loop over positive tracks
+      // prong properties, computed once for all the combinations
       auto groupedTrackIndicesPos1 = positiveFor2And3Prongs->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
-      int lastFilledD0 = -1; // index to be filled in table for D* mesons
-      for (auto trackIndexPos1 = groupedTrackIndicesPos1.begin(); trackIndexPos1 != groupedTrackIndicesPos1.end(); ++trackIndexPos1) {
+      auto groupedTrackIndicesNeg1 = negativeFor2And3Prongs->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
+      fillProngPool<TTracks>(prongPoolPos, groupedTrackIndicesPos1, collision);
+      fillProngPool<TTracks>(prongPoolNeg, groupedTrackIndicesNeg1, collision);
+
+      // first loop over positive tracks
+      std::size_t iPos1 = 0;
+      for (auto trackIndexPos1 = groupedTrackIndicesPos1.begin(); trackIndexPos1 != groupedTrackIndicesPos1.end(); ++trackIndexPos1, ++iPos1) {
         auto trackPos1 = trackIndexPos1.template track_as<TTracks>();
 
         // retrieve the selection flag that corresponds to this collision
@@ -2118,17 +2540,13 @@ struct HfTrackIndexSkimCreator {
         bool sel2ProngStatusPos = TESTBIT(isSelProngPos1, CandidateType::Cand2Prong);
         bool sel3ProngStatusPos1 = TESTBIT(isSelProngPos1, CandidateType::Cand3Prong);
 
-        auto trackParVarPos1 = getTrackParCov(trackPos1);
-        std::array<float, 3> pVecTrackPos1{trackPos1.pVector()};
-        o2::gpu::gpustd::array<float, 2> dcaInfoPos1{trackPos1.dcaXY(), trackPos1.dcaZ()};
-        if (thisCollId != trackPos1.collisionId()) { // this is not the "default" collision for this track, we have to re-propagate it
-          o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarPos1, 2.f, noMatCorr, &dcaInfoPos1);
-          getPxPyPz(trackParVarPos1, pVecTrackPos1);
-        }
+        const auto& trackParVarPos1 = prongPoolPos.trackParVar[iPos1];
+        const auto& pVecTrackPos1 = prongPoolPos.pVec[iPos1];
+        const auto& dcaInfoPos1 = prongPoolPos.dcaInfo[iPos1];
 
         // first loop over negative tracks
-        auto groupedTrackIndicesNeg1 = negativeFor2And3Prongs->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
-        for (auto trackIndexNeg1 = groupedTrackIndicesNeg1.begin(); trackIndexNeg1 != groupedTrackIndicesNeg1.end(); ++trackIndexNeg1) {
+        std::size_t iNeg1 = 0;
+        for (auto trackIndexNeg1 = groupedTrackIndicesNeg1.begin(); trackIndexNeg1 != groupedTrackIndicesNeg1.end(); ++trackIndexNeg1, ++iNeg1) {
           auto trackNeg1 = trackIndexNeg1.template track_as<TTracks>();
 
           // retrieve the selection flag that corresponds to this collision
@@ -2136,21 +2554,15 @@ struct HfTrackIndexSkimCreator {
           bool sel2ProngStatusNeg = TESTBIT(isSelProngNeg1, CandidateType::Cand2Prong);
           bool sel3ProngStatusNeg1 = TESTBIT(isSelProngNeg1, CandidateType::Cand3Prong);
 
-          auto trackParVarNeg1 = getTrackParCov(trackNeg1);
-          std::array<float, 3> pVecTrackNeg1{trackNeg1.pVector()};
-          o2::gpu::gpustd::array<float, 2> dcaInfoNeg1{trackNeg1.dcaXY(), trackNeg1.dcaZ()};
-          if (thisCollId != trackNeg1.collisionId()) { // this is not the "default" collision for this track, we have to re-propagate it
-            o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarNeg1, 2.f, noMatCorr, &dcaInfoNeg1);
-            getPxPyPz(trackParVarNeg1, pVecTrackNeg1);
-          }
+          const auto& trackParVarNeg1 = prongPoolNeg.trackParVar[iNeg1];
+          const auto& pVecTrackNeg1 = prongPoolNeg.pVec[iNeg1];
+          const auto& dcaInfoNeg1 = prongPoolNeg.dcaInfo[iNeg1];
 
           int isSelected2ProngCand = n2ProngBit; // bitmap for checking status of two-prong candidates (1 is true, 0 is rejected)
 
           if (debug) {
-            for (int iDecay2P = 0; iDecay2P < kN2ProngDecays; iDecay2P++) {
-              for (int iCut = 0; iCut < kNCuts2Prong[iDecay2P]; iCut++) {
-                cutStatus2Prong[iDecay2P][iCut] = true;
-              }
+            for (auto& status : cutStatus2Prong) {
+              status.set();
             }
           }
 
@@ -2215,7 +2627,7 @@ struct HfTrackIndexSkimCreator {
                     if (debugPvRefit) {
                       LOG(info) << "### [2 Prong] Calling performPvRefitCandProngs for HF 2 prong candidate";
                     }
-                    performPvRefitCandProngs(collision, bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, {trackPos1.globalIndex(), trackNeg1.globalIndex()}, pvRefitCoord2Prong, pvRefitCovMatrix2Prong);
+                    performPvRefitCandProngs(collision, {trackPos1.globalIndex(), trackNeg1.globalIndex()}, pvRefitCoord2Prong, pvRefitCovMatrix2Prong);
                   } else if (nCandContr == 1) {
                     /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
                     if (debugPvRefit) {
@@ -2257,73 +2669,28 @@ struct HfTrackIndexSkimCreator {
                   is2ProngCandidateGoodFor3Prong = isTwoTrackVertexSelectedFor3Prongs(secondaryVertex2, pvCoord2Prong, df2);
                 }
 
-                std::vector<float> mlScoresD0{};
-                if (applyMlForHfFilters) {
-                  auto trackParVarPcaPos1 = df2.getTrack(0);
-                  auto trackParVarPcaNeg1 = df2.getTrack(1);
-                  std::vector<float> inputFeatures{trackParVarPcaPos1.getPt(), dcaInfoPos1[0], dcaInfoPos1[1], trackParVarPcaNeg1.getPt(), dcaInfoNeg1[0], dcaInfoNeg1[1]};
-                  applyMlSelectionForHfFilters2Prong(inputFeatures, mlScoresD0, isSelected2ProngCand);
-                }
-
                 if (isSelected2ProngCand > 0) {
-                  // fill table row
-                  rowTrackIndexProng2(thisCollId, trackPos1.globalIndex(), trackNeg1.globalIndex(), isSelected2ProngCand);
-                  if (applyMlForHfFilters) {
-                    rowTrackIndexMlScoreProng2(mlScoresD0);
-                  }
-                  if (TESTBIT(isSelected2ProngCand, hf_cand_2prong::DecayType::D0ToPiK)) {
-                    lastFilledD0 = rowTrackIndexProng2.lastIndex();
-                  }
-
-                  if constexpr (doPvRefit) {
-                    // fill table row with coordinates of PV refit
-                    rowProng2PVrefit(pvRefitCoord2Prong[0], pvRefitCoord2Prong[1], pvRefitCoord2Prong[2],
-                                     pvRefitCovMatrix2Prong[0], pvRefitCovMatrix2Prong[1], pvRefitCovMatrix2Prong[2], pvRefitCovMatrix2Prong[3], pvRefitCovMatrix2Prong[4], pvRefitCovMatrix2Prong[5]);
-                  }
-
+                  // the tables are filled once the ML selections are applied, in fillPendingCandidates
+                  auto& candidate = pending2Prongs.emplace_back();
+                  candidate.collisionId = thisCollId;
+                  candidate.indexPos = trackPos1.globalIndex();
+                  candidate.indexNeg = trackNeg1.globalIndex();
+                  candidate.isSelected = isSelected2ProngCand;
+                  candidate.pvRefitCoord = pvRefitCoord2Prong;
+                  candidate.pvRefitCovMatrix = pvRefitCovMatrix2Prong;
                   if (debug) {
-                    int Prong2CutStatus[kN2ProngDecays];
                     for (int iDecay2P = 0; iDecay2P < kN2ProngDecays; iDecay2P++) {
-                      Prong2CutStatus[iDecay2P] = nCutStatus2ProngBit[iDecay2P];
-                      for (int iCut = 0; iCut < kNCuts2Prong[iDecay2P]; iCut++) {
-                        if (!cutStatus2Prong[iDecay2P][iCut]) {
-                          CLRBIT(Prong2CutStatus[iDecay2P], iCut);
-                        }
-                      }
+                      candidate.cutStatus[iDecay2P] = static_cast<int>(cutStatus2Prong[iDecay2P].to_ulong() & (BIT(kNCuts2Prong[iDecay2P]) - 1));
                     }
-                    rowProng2CutStatus(Prong2CutStatus[0], Prong2CutStatus[1], Prong2CutStatus[2]); // FIXME when we can do this by looping over kN2ProngDecays
                   }
-
-                  // fill histograms
-                  if (fillHistograms) {
-                    registry.fill(HIST("hVtx2ProngX"), secondaryVertex2[0]);
-                    registry.fill(HIST("hVtx2ProngY"), secondaryVertex2[1]);
-                    registry.fill(HIST("hVtx2ProngZ"), secondaryVertex2[2]);
-                    std::array<std::array<float, 3>, 2> arrMom = {pvec0, pvec1};
-                    for (int iDecay2P = 0; iDecay2P < kN2ProngDecays; iDecay2P++) {
-                      if (TESTBIT(isSelected2ProngCand, iDecay2P)) {
-                        if (TESTBIT(whichHypo2Prong[iDecay2P], 0)) {
-                          auto mass2Prong = RecoDecay::m(arrMom, arrMass2Prong[iDecay2P][0]);
-                          switch (iDecay2P) {
-                            case hf_cand_2prong::DecayType::D0ToPiK:
-                              registry.fill(HIST("hMassD0ToPiK"), mass2Prong);
-                              break;
-                            case hf_cand_2prong::DecayType::JpsiToEE:
-                              registry.fill(HIST("hMassJpsiToEE"), mass2Prong);
-                              break;
-                            case hf_cand_2prong::DecayType::JpsiToMuMu:
-                              registry.fill(HIST("hMassJpsiToMuMu"), mass2Prong);
-                              break;
-                          }
-                        }
-                        if (TESTBIT(whichHypo2Prong[iDecay2P], 1)) {
-                          auto mass2Prong = RecoDecay::m(arrMom, arrMass2Prong[iDecay2P][1]);
-                          if (iDecay2P == hf_cand_2prong::DecayType::D0ToPiK) {
-                            registry.fill(HIST("hMassD0ToPiK"), mass2Prong);
-                          }
-                        }
-                      }
-                    }
+                  candidate.secondaryVertex = {secondaryVertex2[0], secondaryVertex2[1], secondaryVertex2[2]};
+                  candidate.arrMom = {pvec0, pvec1};
+                  std::copy(whichHypo2Prong, whichHypo2Prong + kN2ProngDecays, candidate.whichHypo.begin());
+                  if (applyMlForHfFilters) {
+                    auto trackParVarPcaPos1 = df2.getTrack(0);
+                    auto trackParVarPcaNeg1 = df2.getTrack(1);
+                    std::array<float, 6> inputFeatures{trackParVarPcaPos1.getPt(), dcaInfoPos1[0], dcaInfoPos1[1], trackParVarPcaNeg1.getPt(), dcaInfoNeg1[0], dcaInfoNeg1[1]};
+                    addToMlBatchForHfFilters2Prong(inputFeatures, candidate);
                   }
                 }
               } else {
@@ -2351,7 +2718,8 @@ struct HfTrackIndexSkimCreator {
 
           if (do3Prong == 1 && is2ProngCandidateGoodFor3Prong) { // if 3 prongs are enabled and the first 2 tracks are selected for the 3-prong channels
             // second loop over positive tracks
-            for (auto trackIndexPos2 = trackIndexPos1 + 1; trackIndexPos2 != groupedTrackIndicesPos1.end(); ++trackIndexPos2) {
+            std::size_t iPos2 = iPos1 + 1;
+            for (auto trackIndexPos2 = trackIndexPos1 + 1; trackIndexPos2 != groupedTrackIndicesPos1.end(); ++trackIndexPos2, ++iPos2) {
 
               int isSelected3ProngCand = n3ProngBit;
               if (!TESTBIT(trackIndexPos2.isSelProng(), CandidateType::Cand3Prong)) { // continue immediately
@@ -2370,23 +2738,22 @@ struct HfTrackIndexSkimCreator {
                 }
               }
 
+              // the pT of the triplet cannot exceed the sum of the prong pT
+              if (!debug && prongPoolPos.pt[iPos1] + prongPoolNeg.pt[iNeg1] + prongPoolPos.pt[iPos2] + ptTolerance < minPt3Prong) {
+                continue;
+              }
+
               auto trackPos2 = trackIndexPos2.template track_as<TTracks>();
-              auto trackParVarPos2 = getTrackParCov(trackPos2);
-              o2::gpu::gpustd::array<float, 2> dcaInfoPos2{trackPos2.dcaXY(), trackPos2.dcaZ()};
+              const auto& trackParVarPos2 = prongPoolPos.trackParVar[iPos2];
+              const auto& dcaInfoPos2 = prongPoolPos.dcaInfo[iPos2];
 
               // preselection of 3-prong candidates
               if (isSelected3ProngCand) {
-                std::array<float, 3> pVecTrackPos2{trackPos2.pVector()};
-                if (thisCollId != trackPos2.collisionId()) { // this is not the "default" collision for this track and we still did not re-propagate it, we have to re-propagate it
-                  o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarPos2, 2.f, noMatCorr, &dcaInfoPos2);
-                  getPxPyPz(trackParVarPos2, pVecTrackPos2);
-                }
+                const auto& pVecTrackPos2 = prongPoolPos.pVec[iPos2];
 
                 if (debug) {
-                  for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
-                    for (int iCut = 0; iCut < kNCuts3Prong[iDecay3P]; iCut++) {
-                      cutStatus3Prong[iDecay3P][iCut] = true;
-                    }
+                  for (auto& status : cutStatus3Prong) {
+                    status.set();
                   }
                 }
 
@@ -2455,7 +2822,7 @@ struct HfTrackIndexSkimCreator {
                   if (debugPvRefit) {
                     LOG(info) << "### [3 prong] Calling performPvRefitCandProngs for HF 3 prong candidate, removing " << nCandContr << " daughters";
                   }
-                  performPvRefitCandProngs(collision, bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, vecCandPvContributorGlobId, pvRefitCoord3Prong2Pos1Neg, pvRefitCovMatrix3Prong2Pos1Neg);
+                  performPvRefitCandProngs(collision, vecCandPvContributorGlobId, pvRefitCoord3Prong2Pos1Neg, pvRefitCovMatrix3Prong2Pos1Neg);
                 } else if (nCandContr == 1) {
                   /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
                   if (debugPvRefit) {
@@ -2516,86 +2883,34 @@ struct HfTrackIndexSkimCreator {
               // 3-prong selections after secondary vertex
               applySelection3Prong(pVecCandProng3Pos, secondaryVertex3, pvRefitCoord3Prong2Pos1Neg, cutStatus3Prong, isSelected3ProngCand);
 
-              std::array<std::vector<float>, kN3ProngDecays> mlScores3Prongs;
-              if (applyMlForHfFilters) {
-                std::vector<float> inputFeatures{trackParVarPcaPos1.getPt(), dcaInfoPos1[0], dcaInfoPos1[1], trackParVarPcaNeg1.getPt(), dcaInfoNeg1[0], dcaInfoNeg1[1], trackParVarPcaPos2.getPt(), dcaInfoPos2[0], dcaInfoPos2[1]};
-                applyMlSelectionForHfFilters3Prong(inputFeatures, mlScores3Prongs, isSelected3ProngCand);
-              }
-
               if (!debug && isSelected3ProngCand == 0) {
                 continue;
               }
 
-              // fill table row
-              rowTrackIndexProng3(thisCollId, trackPos1.globalIndex(), trackNeg1.globalIndex(), trackPos2.globalIndex(), isSelected3ProngCand);
-              if (applyMlForHfFilters) {
-                rowTrackIndexMlScoreProng3(mlScores3Prongs[0], mlScores3Prongs[1], mlScores3Prongs[2], mlScores3Prongs[3]);
-              }
-              if constexpr (doPvRefit) {
-                // fill table row of coordinates of PV refit
-                rowProng3PVrefit(pvRefitCoord3Prong2Pos1Neg[0], pvRefitCoord3Prong2Pos1Neg[1], pvRefitCoord3Prong2Pos1Neg[2],
-                                 pvRefitCovMatrix3Prong2Pos1Neg[0], pvRefitCovMatrix3Prong2Pos1Neg[1], pvRefitCovMatrix3Prong2Pos1Neg[2], pvRefitCovMatrix3Prong2Pos1Neg[3], pvRefitCovMatrix3Prong2Pos1Neg[4], pvRefitCovMatrix3Prong2Pos1Neg[5]);
-              }
-
+              // the tables are filled once the ML selections are applied, in fillPendingCandidates
+              auto& candidate = pending3Prongs.emplace_back();
+              candidate.collisionId = thisCollId;
+              candidate.indices = {trackPos1.globalIndex(), trackNeg1.globalIndex(), trackPos2.globalIndex()};
+              candidate.isSelected = isSelected3ProngCand;
+              candidate.pvRefitCoord = pvRefitCoord3Prong2Pos1Neg;
+              candidate.pvRefitCovMatrix = pvRefitCovMatrix3Prong2Pos1Neg;
               if (debug) {
-                int Prong3CutStatus[kN3ProngDecays];
                 for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
-                  Prong3CutStatus[iDecay3P] = nCutStatus3ProngBit[iDecay3P];
-                  for (int iCut = 0; iCut < kNCuts3Prong[iDecay3P]; iCut++) {
-                    if (!cutStatus3Prong[iDecay3P][iCut]) {
-                      CLRBIT(Prong3CutStatus[iDecay3P], iCut);
-                    }
-                  }
+                  candidate.cutStatus[iDecay3P] = static_cast<int>(cutStatus3Prong[iDecay3P].to_ulong() & (BIT(kNCuts3Prong[iDecay3P]) - 1));
                 }
-                rowProng3CutStatus(Prong3CutStatus[0], Prong3CutStatus[1], Prong3CutStatus[2], Prong3CutStatus[3]); // FIXME when we can do this by looping over kN3ProngDecays
               }
-
-              // fill histograms
-              if (fillHistograms) {
-                registry.fill(HIST("hVtx3ProngX"), secondaryVertex3[0]);
-                registry.fill(HIST("hVtx3ProngY"), secondaryVertex3[1]);
-                registry.fill(HIST("hVtx3ProngZ"), secondaryVertex3[2]);
-                std::array<std::array<float, 3>, 3> arr3Mom = {pvec0, pvec1, pvec2};
-                for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
-                  if (TESTBIT(isSelected3ProngCand, iDecay3P)) {
-                    if (TESTBIT(whichHypo3Prong[iDecay3P], 0)) {
-                      auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][0]);
-                      switch (iDecay3P) {
-                        case hf_cand_3prong::DecayType::DplusToPiKPi:
-                          registry.fill(HIST("hMassDPlusToPiKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::DsToKKPi:
-                          registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::LcToPKPi:
-                          registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::XicToPKPi:
-                          registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
-                          break;
-                      }
-                    }
-                    if (TESTBIT(whichHypo3Prong[iDecay3P], 1)) {
-                      auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][1]);
-                      switch (iDecay3P) {
-                        case hf_cand_3prong::DecayType::DsToKKPi:
-                          registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::LcToPKPi:
-                          registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::XicToPKPi:
-                          registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
-                          break;
-                      }
-                    }
-                  }
-                }
+              candidate.secondaryVertex = {secondaryVertex3[0], secondaryVertex3[1], secondaryVertex3[2]};
+              candidate.arrMom = {pvec0, pvec1, pvec2};
+              std::copy(whichHypo3Prong, whichHypo3Prong + kN3ProngDecays, candidate.whichHypo.begin());
+              if (applyMlForHfFilters) {
+                std::array<float, 9> inputFeatures{trackParVarPcaPos1.getPt(), dcaInfoPos1[0], dcaInfoPos1[1], trackParVarPcaNeg1.getPt(), dcaInfoNeg1[0], dcaInfoNeg1[1], trackParVarPcaPos2.getPt(), dcaInfoPos2[0], dcaInfoPos2[1]};
+                addToMlBatchForHfFilters3Prong(inputFeatures, candidate);
               }
             }
 
             // second loop over negative tracks
-            for (auto trackIndexNeg2 = trackIndexNeg1 + 1; trackIndexNeg2 != groupedTrackIndicesNeg1.end(); ++trackIndexNeg2) {
+            std::size_t iNeg2 = iNeg1 + 1;
+            for (auto trackIndexNeg2 = trackIndexNeg1 + 1; trackIndexNeg2 != groupedTrackIndicesNeg1.end(); ++trackIndexNeg2, ++iNeg2) {
 
               int isSelected3ProngCand = n3ProngBit;
               if (!TESTBIT(trackIndexNeg2.isSelProng(), CandidateType::Cand3Prong)) { // continue immediately
@@ -2614,23 +2929,22 @@ struct HfTrackIndexSkimCreator {
                 }
               }
 
+              // the pT of the triplet cannot exceed the sum of the prong pT
+              if (!debug && prongPoolNeg.pt[iNeg1] + prongPoolPos.pt[iPos1] + prongPoolNeg.pt[iNeg2] + ptTolerance < minPt3Prong) {
+                continue;
+              }
+
               auto trackNeg2 = trackIndexNeg2.template track_as<TTracks>();
-              auto trackParVarNeg2 = getTrackParCov(trackNeg2);
-              o2::gpu::gpustd::array<float, 2> dcaInfoNeg2{trackNeg2.dcaXY(), trackNeg2.dcaZ()};
+              const auto& trackParVarNeg2 = prongPoolNeg.trackParVar[iNeg2];
+              const auto& dcaInfoNeg2 = prongPoolNeg.dcaInfo[iNeg2];
 
               // preselection of 3-prong candidates
               if (isSelected3ProngCand) {
-                std::array<float, 3> pVecTrackNeg2{trackNeg2.pVector()};
-                if (thisCollId != trackNeg2.collisionId()) { // this is not the "default" collision for this track and we still did not re-propagate it, we have to re-propagate it
-                  o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarNeg2, 2.f, noMatCorr, &dcaInfoNeg2);
-                  getPxPyPz(trackParVarNeg2, pVecTrackNeg2);
-                }
+                const auto& pVecTrackNeg2 = prongPoolNeg.pVec[iNeg2];
 
                 if (debug) {
-                  for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
-                    for (int iCut = 0; iCut < kNCuts3Prong[iDecay3P]; iCut++) {
-                      cutStatus3Prong[iDecay3P][iCut] = true;
-                    }
+                  for (auto& status : cutStatus3Prong) {
+                    status.set();
                   }
                 }
 
@@ -2699,7 +3013,7 @@ struct HfTrackIndexSkimCreator {
                   if (debugPvRefit) {
                     LOG(info) << "### [3 prong] Calling performPvRefitCandProngs for HF 3 prong candidate, removing " << nCandContr << " daughters";
                   }
-                  performPvRefitCandProngs(collision, bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, vecCandPvContributorGlobId, pvRefitCoord3Prong1Pos2Neg, pvRefitCovMatrix3Prong1Pos2Neg);
+                  performPvRefitCandProngs(collision, vecCandPvContributorGlobId, pvRefitCoord3Prong1Pos2Neg, pvRefitCovMatrix3Prong1Pos2Neg);
                 } else if (nCandContr == 1) {
                   /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
                   if (debugPvRefit) {
@@ -2761,86 +3075,34 @@ struct HfTrackIndexSkimCreator {
               // 3-prong selections after secondary vertex
               applySelection3Prong(pVecCandProng3Neg, secondaryVertex3, pvRefitCoord3Prong1Pos2Neg, cutStatus3Prong, isSelected3ProngCand);
 
-              std::array<std::vector<float>, kN3ProngDecays> mlScores3Prongs;
-              if (applyMlForHfFilters) {
-                std::vector<float> inputFeatures{trackParVarPcaNeg1.getPt(), dcaInfoNeg1[0], dcaInfoNeg1[1], trackParVarPcaPos1.getPt(), dcaInfoPos1[0], dcaInfoPos1[1], trackParVarPcaNeg2.getPt(), dcaInfoNeg2[0], dcaInfoNeg2[1]};
-                applyMlSelectionForHfFilters3Prong(inputFeatures, mlScores3Prongs, isSelected3ProngCand);
-              }
-
               if (!debug && isSelected3ProngCand == 0) {
                 continue;
               }
 
-              // fill table row
-              rowTrackIndexProng3(thisCollId, trackNeg1.globalIndex(), trackPos1.globalIndex(), trackNeg2.globalIndex(), isSelected3ProngCand);
-              if (applyMlForHfFilters) {
-                rowTrackIndexMlScoreProng3(mlScores3Prongs[0], mlScores3Prongs[1], mlScores3Prongs[2], mlScores3Prongs[3]);
-              }
-              // fill table row of coordinates of PV refit
-              if constexpr (doPvRefit) {
-                rowProng3PVrefit(pvRefitCoord3Prong1Pos2Neg[0], pvRefitCoord3Prong1Pos2Neg[1], pvRefitCoord3Prong1Pos2Neg[2],
-                                 pvRefitCovMatrix3Prong1Pos2Neg[0], pvRefitCovMatrix3Prong1Pos2Neg[1], pvRefitCovMatrix3Prong1Pos2Neg[2], pvRefitCovMatrix3Prong1Pos2Neg[3], pvRefitCovMatrix3Prong1Pos2Neg[4], pvRefitCovMatrix3Prong1Pos2Neg[5]);
-              }
-
+              // the tables are filled once the ML selections are applied, in fillPendingCandidates
+              auto& candidate = pending3Prongs.emplace_back();
+              candidate.collisionId = thisCollId;
+              candidate.indices = {trackNeg1.globalIndex(), trackPos1.globalIndex(), trackNeg2.globalIndex()};
+              candidate.isSelected = isSelected3ProngCand;
+              candidate.pvRefitCoord = pvRefitCoord3Prong1Pos2Neg;
+              candidate.pvRefitCovMatrix = pvRefitCovMatrix3Prong1Pos2Neg;
               if (debug) {
-                int Prong3CutStatus[kN3ProngDecays];
                 for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
-                  Prong3CutStatus[iDecay3P] = nCutStatus3ProngBit[iDecay3P];
-                  for (int iCut = 0; iCut < kNCuts3Prong[iDecay3P]; iCut++) {
-                    if (!cutStatus3Prong[iDecay3P][iCut]) {
-                      CLRBIT(Prong3CutStatus[iDecay3P], iCut);
-                    }
-                  }
+                  candidate.cutStatus[iDecay3P] = static_cast<int>(cutStatus3Prong[iDecay3P].to_ulong() & (BIT(kNCuts3Prong[iDecay3P]) - 1));
                 }
-                rowProng3CutStatus(Prong3CutStatus[0], Prong3CutStatus[1], Prong3CutStatus[2], Prong3CutStatus[3]); // FIXME when we can do this by looping over kN3ProngDecays
               }
-
-              // fill histograms
-              if (fillHistograms) {
-                registry.fill(HIST("hVtx3ProngX"), secondaryVertex3[0]);
-                registry.fill(HIST("hVtx3ProngY"), secondaryVertex3[1]);
-                registry.fill(HIST("hVtx3ProngZ"), secondaryVertex3[2]);
-                std::array<std::array<float, 3>, 3> arr3Mom = {pvec0, pvec1, pvec2};
-                for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
-                  if (TESTBIT(isSelected3ProngCand, iDecay3P)) {
-                    if (TESTBIT(whichHypo3Prong[iDecay3P], 0)) {
-                      auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][0]);
-                      switch (iDecay3P) {
-                        case hf_cand_3prong::DecayType::DplusToPiKPi:
-                          registry.fill(HIST("hMassDPlusToPiKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::DsToKKPi:
-                          registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::LcToPKPi:
-                          registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::XicToPKPi:
-                          registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
-                          break;
-                      }
-                    }
-                    if (TESTBIT(whichHypo3Prong[iDecay3P], 1)) {
-                      auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][1]);
-                      switch (iDecay3P) {
-                        case hf_cand_3prong::DecayType::DsToKKPi:
-                          registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::LcToPKPi:
-                          registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::XicToPKPi:
-                          registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
-                          break;
-                      }
-                    }
-                  }
-                }
+              candidate.secondaryVertex = {secondaryVertex3[0], secondaryVertex3[1], secondaryVertex3[2]};
+              candidate.arrMom = {pvec0, pvec1, pvec2};
+              std::copy(whichHypo3Prong, whichHypo3Prong + kN3ProngDecays, candidate.whichHypo.begin());
+              if (applyMlForHfFilters) {
+                std::array<float, 9> inputFeatures{trackParVarPcaNeg1.getPt(), dcaInfoNeg1[0], dcaInfoNeg1[1], trackParVarPcaPos1.getPt(), dcaInfoPos1[0], dcaInfoPos1[1], trackParVarPcaNeg2.getPt(), dcaInfoNeg2[0], dcaInfoNeg2[1]};
+                addToMlBatchForHfFilters3Prong(inputFeatures, candidate);
               }
             }
           }
 
           if (doDstar && TESTBIT(isSelected2ProngCand, hf_cand_2prong::DecayType::D0ToPiK) && (pt2Prong + ptTolerance) * 1.2 > binsPtDstarToD0Pi->at(0) && whichHypo2Prong[kN2ProngDecays] != 0) { // if D* enabled and pt of the D0 is larger than the minimum of the D* one within 20% (D* and D0 momenta are very similar, always within 20% according to PYTHIA8)
+            const std::size_t iPending2Prong = pending2Prongs.size() - 1; // the D0 candidate is the last pending 2-prong candidate
             // second loop over positive tracks
             if (TESTBIT(whichHypo2Prong[kN2ProngDecays], 0) && (!applyKaonPidIn3Prongs || TESTBIT(trackIndexNeg1.isIdentifiedPid(), channelKaonPid))) { // only for D0 candidates; moreover if kaon PID enabled, apply to the negative track
               auto groupedTrackIndicesSoftPionsPos = positiveSoftPions->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
@@ -2861,19 +3123,9 @@ struct HfTrackIndexSkimCreator {
                 uint8_t cutStatus{BIT(kNCutsDstar) - 1};
                 float deltaMass{-1.};
                 isSelectedDstar = applySelectionDstar(pVecTrackPos1, pVecTrackNeg1, pVecTrackPos2, cutStatus, deltaMass); // we do not compute the D* decay vertex at this stage because we are not interested in applying topological selections
-                if (isSelectedDstar) {
-                  rowTrackIndexDstar(thisCollId, trackPos2.globalIndex(), lastFilledD0);
-                  if (fillHistograms) {
-                    registry.fill(HIST("hMassDstarToD0Pi"), deltaMass);
-                  }
-                  if constexpr (doPvRefit) {
-                    // fill table row with coordinates of PV refit (same as 2-prong because we do not remove the soft pion)
-                    rowDstarPVrefit(pvRefitCoord2Prong[0], pvRefitCoord2Prong[1], pvRefitCoord2Prong[2],
-                                    pvRefitCovMatrix2Prong[0], pvRefitCovMatrix2Prong[1], pvRefitCovMatrix2Prong[2], pvRefitCovMatrix2Prong[3], pvRefitCovMatrix2Prong[4], pvRefitCovMatrix2Prong[5]);
-                  }
-                }
-                if (debug) {
-                  rowDstarCutStatus(cutStatus);
+                if (isSelectedDstar || debug) {
+                  // PV refit same as 2-prong because we do not remove the soft pion
+                  pendingDstars.push_back({thisCollId, trackPos2.globalIndex(), iPending2Prong, isSelectedDstar, cutStatus, deltaMass, pvRefitCoord2Prong, pvRefitCovMatrix2Prong});
                 }
               }
             }
@@ -2898,19 +3150,9 @@ struct HfTrackIndexSkimCreator {
                 uint8_t cutStatus{BIT(kNCutsDstar) - 1};
                 float deltaMass{-1.};
                 isSelectedDstar = applySelectionDstar(pVecTrackNeg1, pVecTrackPos1, pVecTrackNeg2, cutStatus, deltaMass); // we do not compute the D* decay vertex at this stage because we are not interested in applying topological selections
-                if (isSelectedDstar) {
-                  rowTrackIndexDstar(thisCollId, trackNeg2.globalIndex(), lastFilledD0);
-                  if (fillHistograms) {
-                    registry.fill(HIST("hMassDstarToD0Pi"), deltaMass);
-                  }
-                  if constexpr (doPvRefit) {
-                    // fill table row with coordinates of PV refit (same as 2-prong because we do not remove the soft pion)
-                    rowDstarPVrefit(pvRefitCoord2Prong[0], pvRefitCoord2Prong[1], pvRefitCoord2Prong[2],
-                                    pvRefitCovMatrix2Prong[0], pvRefitCovMatrix2Prong[1], pvRefitCovMatrix2Prong[2], pvRefitCovMatrix2Prong[3], pvRefitCovMatrix2Prong[4], pvRefitCovMatrix2Prong[5]);
-                  }
-                }
-                if (debug) {
-                  rowDstarCutStatus(cutStatus);
+                if (isSelectedDstar || debug) {
+                  // PV refit same as 2-prong because we do not remove the soft pion
+                  pendingDstars.push_back({thisCollId, trackNeg2.globalIndex(), iPending2Prong, isSelectedDstar, cutStatus, deltaMass, pvRefitCoord2Prong, pvRefitCovMatrix2Prong});
                 }
               }
             }
@@ -2918,19 +3160,16 @@ struct HfTrackIndexSkimCreator {
         }
       }
 
-      int nTracks = 0;
-      // auto nTracks = trackIndicesPerCollision.lastIndex() - trackIndicesPerCollision.firstIndex(); // number of tracks passing 2 and 3 prong selection in this collision
-      nCand2 = rowTrackIndexProng2.lastIndex() - nCand2; // number of 2-prong candidates in this collision
-      nCand3 = rowTrackIndexProng3.lastIndex() - nCand3; // number of 3-prong candidates in this collision
-
-      if (fillHistograms) {
-        registry.fill(HIST("hNTracks"), nTracks);
-        registry.fill(HIST("hNCand2Prong"), nCand2);
-        registry.fill(HIST("hNCand3Prong"), nCand3);
-        registry.fill(HIST("hNCand2ProngVsNTracks"), nTracks, nCand2);
-        registry.fill(HIST("hNCand3ProngVsNTracks"), nTracks, nCand3);
+      pendingCollisionEnds.push_back({pending2Prongs.size(), pending3Prongs.size(), pendingDstars.size()});
+      if (!applyMlForHfFilters) {
+        fillPendingCandidates<doPvRefit>();
       }
     }
+
+    // with the ML selections, the candidates of the whole timeframe are evaluated together
+    if (applyMlForHfFilters) {
+      fillPendingCandidates<doPvRefit>();
+    }
   } /// end of run2And3Prongs function
 
   void processNo2And3Prongs(SelectedCollisions const&)
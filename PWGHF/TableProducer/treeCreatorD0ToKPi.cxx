@@ -385,8 +385,10 @@ struct HfTreeCreatorD0ToKPi {
       auto prong0 = candidate.template prong0_as<TracksWPid>();
       auto prong1 = candidate.template prong1_as<TracksWPid>();
       double yD = hfHelper.yD0(candidate);
-      double eD = hfHelper.eD0(candidate);
-      double ctD = hfHelper.ctD0(candidate);
+      // ct and E are only stored in the full table
+      double eD = fillCandidateLiteTable ? 0. : hfHelper.eD0(candidate);
+      double ctD = fillCandidateLiteTable ? 0. : hfHelper.ctD0(candidate);
+      const auto kinematics = hfHelper.kinematicsD0(candidate);
       float massD0, massD0bar;
       float topolChi2PerNdf = -999.;
       if constexpr (reconstructionType == aod::hf_cand::VertexerType::KfParticle) {
@@ -394,14 +396,14 @@ struct HfTreeCreatorD0ToKPi {
         massD0bar = candidate.kfGeoMassD0bar();
         topolChi2PerNdf = candidate.kfTopolChi2OverNdf();
       } else {
-        massD0 = hfHelper.invMassD0ToPiK(candidate);
-        massD0bar = hfHelper.invMassD0barToKPi(candidate);
+        massD0 = kinematics.invMassD0;
+        massD0bar = kinematics.invMassD0bar;
       }
       if (candidate.isSelD0()) {
-        fillTable(candidate, prong0, prong1, 0, massD0, hfHelper.cosThetaStarD0(candidate), topolChi2PerNdf, ctD, yD, eD, 0, 0);
+        fillTable(candidate, prong0, prong1, 0, massD0, kinematics.cosThetaStarD0, topolChi2PerNdf, ctD, yD, eD, 0, 0);
       }
       if (candidate.isSelD0bar()) {
-        fillTable(candidate, prong0, prong1, 1, massD0bar, hfHelper.cosThetaStarD0bar(candidate), topolChi2PerNdf, ctD, yD, eD, 0, 0);
+        fillTable(candidate, prong0, prong1, 1, massD0bar, kinematics.cosThetaStarD0bar, topolChi2PerNdf, ctD, yD, eD, 0, 0);
       }
     }
   }
@@ -464,8 +466,10 @@ struct HfTreeCreatorD0ToKPi {
       auto prong0 = candidate.template prong0_as<TracksWPid>();
       auto prong1 = candidate.template prong1_as<TracksWPid>();
       double yD = hfHelper.yD0(candidate);
-      double eD = hfHelper.eD0(candidate);
-      double ctD = hfHelper.ctD0(candidate);
+      // ct and E are only stored in the full table
+      double eD = fillCandidateLiteTable ? 0. : hfHelper.eD0(candidate);
+      double ctD = fillCandidateLiteTable ? 0. : hfHelper.ctD0(candidate);
+      const auto kinematics = hfHelper.kinematicsD0(candidate);
       float massD0, massD0bar;
       float topolChi2PerNdf = -999.;
       if constexpr (reconstructionType == aod::hf_cand::VertexerType::KfParticle) {
@@ -473,14 +477,14 @@ struct HfTreeCreatorD0ToKPi {
         massD0bar = candidate.kfGeoMassD0bar();
         topolChi2PerNdf = candidate.kfTopolChi2OverNdf();
       } else {
-        massD0 = hfHelper.invMassD0ToPiK(candidate);
-        massD0bar = hfHelper.invMassD0barToKPi(candidate);
+        massD0 = kinematics.invMassD0;
+        massD0bar = kinematics.invMassD0bar;
       }
       if (candidate.isSelD0()) {
-        fillTable(candidate, prong0, prong1, 0, massD0, hfHelper.cosThetaStarD0(candidate), topolChi2PerNdf, ctD, yD, eD, candidate.flagMcMatchRec(), candidate.originMcRec());
+        fillTable(candidate, prong0, prong1, 0, massD0, kinematics.cosThetaStarD0, topolChi2PerNdf, ctD, yD, eD, candidate.flagMcMatchRec(), candidate.originMcRec());
       }
       if (candidate.isSelD0bar()) {
-        fillTable(candidate, prong0, prong1, 1, massD0bar, hfHelper.cosThetaStarD0bar(candidate), topolChi2PerNdf, ctD, yD, eD, candidate.flagMcMatchRec(), candidate.originMcRec());
+        fillTable(candidate, prong0, prong1, 1, massD0bar, kinematics.cosThetaStarD0bar, topolChi2PerNdf, ctD, yD, eD, candidate.flagMcMatchRec(), candidate.originMcRec());
       }
     }
 
@@ -0,0 +1,108 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file utilsVertexingHf.h
+/// \brief Secondary-vertex fits of HF candidates with DCAFitterN distributed over several threads
+
+#ifndef PWGHF_UTILS_UTILSVERTEXINGHF_H_
+#define PWGHF_UTILS_UTILSVERTEXINGHF_H_
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "ReconstructionDataFormats/Track.h"
+
+namespace o2::hf_vertexing
+{
+enum FitStatus {
+  NoVertex = 0,
+  Ok,
+  Error
+};
+
+/// Inputs and outputs of the fit of one candidate.
+/// The outputs are copied out of the fitter, so that the fits of a dataframe can run on several threads.
+template <typename TFitter, int NProngs>
+struct Fit {
+  // inputs
+  std::array<o2::track::TrackParCov, NProngs> tracks;
+  double bz{0.};
+  // outputs
+  int status{FitStatus::NoVertex};
+  std::string error;
+  typename TFitter::Vec3D secondaryVertex;
+  double chi2PCA{0.};
+  std::array<float, 6> covMatrixPCA{};
+  std::array<o2::track::TrackParCov, NProngs> tracksAtPCA;
+};
+
+/// Fits the candidates with an already configured fitter
+/// \param fitter is the fitter, each thread works with its own copy
+/// \param fits are the candidates, the outputs are filled in place
+/// \param first is the index of the first candidate to fit
+/// \param last is the index after the last candidate to fit
+template <typename TFitter, int NProngs>
+void runFitsInRange(TFitter const& fitter, std::vector<Fit<TFitter, NProngs>>& fits, std::size_t first, std::size_t last)
+{
+  TFitter threadFitter = fitter;
+  for (auto iFit = first; iFit < last; ++iFit) {
+    auto& fit = fits[iFit];
+    threadFitter.setBz(fit.bz);
+    try {
+      if (std::apply([&threadFitter](auto const&... tracks) { return threadFitter.process(tracks...); }, fit.tracks) == 0) {
+        fit.status = FitStatus::NoVertex;
+        continue;
+      }
+    } catch (const std::runtime_error& error) {
+      fit.status = FitStatus::Error;
+      fit.error = error.what();
+      continue;
+    }
+    fit.status = FitStatus::Ok;
+    fit.secondaryVertex = threadFitter.getPCACandidate();
+    fit.chi2PCA = threadFitter.getChi2AtPCACandidate();
+    fit.covMatrixPCA = threadFitter.calcPCACovMatrixFlat();
+    for (int iProng = 0; iProng < NProngs; ++iProng) {
+      fit.tracksAtPCA[iProng] = threadFitter.getTrack(iProng);
+    }
+  }
+}
+
+/// Fits the candidates of a dataframe on nThreads threads, in contiguous chunks.
+/// The fits are independent of each other, so the outputs do not depend on the number of threads.
+template <typename TFitter, int NProngs>
+void runFits(TFitter const& fitter, std::vector<Fit<TFitter, NProngs>>& fits, int nThreads)
+{
+  const std::size_t nFits = fits.size();
+  const std::size_t nChunks = std::clamp<std::size_t>(nThreads, 1, std::max<std::size_t>(nFits, 1));
+  if (nChunks == 1) {
+    runFitsInRange(fitter, fits, 0, nFits);
+    return;
+  }
+  const std::size_t chunkSize = (nFits + nChunks - 1) / nChunks;
+  std::vector<std::thread> threads;
+  for (std::size_t iChunk = 1; iChunk < nChunks; ++iChunk) {
+    threads.emplace_back(runFitsInRange<TFitter, NProngs>, std::cref(fitter), std::ref(fits), std::min(iChunk * chunkSize, nFits), std::min((iChunk + 1) * chunkSize, nFits));
+  }
+  runFitsInRange(fitter, fits, 0, std::min(chunkSize, nFits));
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+} // namespace o2::hf_vertexing
+
+#endif // PWGHF_UTILS_UTILSVERTEXINGHF_H_
@@ -12,8 +12,12 @@
 // jet finder task
 //
 // Author: Hadi Hassan, Universiy of Jväskylä, hadi.hassan@cern.ch
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <memory>
 #include <tuple>
+#include <vector>
 #include "Framework/Logger.h"
 #include "Common/Core/RecoDecay.h"
 #include "PWGJE/Core/JetUtilities.h"
@@ -43,52 +47,78 @@ void JetBkgSubUtils::initialise()
 
 std::tuple<double, double> JetBkgSubUtils::estimateRhoAreaMedian(const std::vector<fastjet::PseudoJet>& inputParticles, bool doSparseSub)
 {
+  const BkgSubResult& bkg = estimateBackgroundAreaMedian(inputParticles, doSparseSub);
+  return std::make_tuple(bkg.rho, bkg.rhoM);
+}
+
+const BkgSubResult& JetBkgSubUtils::estimateBackgroundAreaMedian(const std::vector<fastjet::PseudoJet>& inputParticles, bool doSparseSub)
+{
+  const std::size_t inputHash = hashInput(inputParticles);
+  if (hasLastBkg && lastBkg.inputHash == inputHash && lastBkg.doSparseSub == doSparseSub) {
+    return lastBkg;
+  }
+
   JetBkgSubUtils::initialise();
 
+  lastBkg = BkgSubResult();
+  lastBkg.doSparseSub = doSparseSub;
+  lastBkg.inputHash = inputHash;
+  hasLastBkg = true;
+
   if (inputParticles.size() == 0) {
-    return std::make_tuple(0.0, 0.0);
+    return lastBkg;
   }
 
   // cluster the kT jets
-  fastjet::ClusterSequenceArea clusterSeq(inputParticles, jetDefBkg, areaDefBkg);
+  lastBkg.clusterSeq = std::make_shared<fastjet::ClusterSequenceArea>(inputParticles, jetDefBkg, areaDefBkg);
 
   // select jets in detector acceptance
-  std::vector<fastjet::PseudoJet> alljets = selRho(clusterSeq.inclusive_jets());
-
-  double totaljetAreaPhys(0), totalAreaCovered(0);
-  std::vector<double> rhovector;
-  std::vector<double> rhoMdvector;
+  lastBkg.kTJets = selRho(lastBkg.clusterSeq->inclusive_jets());
 
   // Fill a vector for pT/area to be used for the median
-  for (auto& ijet : alljets) {
+  for (auto& ijet : lastBkg.kTJets) {
 
     // Physical area/ Physical jets (no ghost)
-    if (!clusterSeq.is_pure_ghost(ijet)) {
-      rhovector.push_back(ijet.perp() / ijet.area());
-      rhoMdvector.push_back(getMd(ijet) / ijet.area());
+    if (!lastBkg.clusterSeq->is_pure_ghost(ijet)) {
+      lastBkg.rhoJets.push_back(ijet.perp() / ijet.area());
+      lastBkg.rhoMJets.push_back(getMd(ijet) / ijet.area());
 
-      totaljetAreaPhys += ijet.area();
+      lastBkg.totalAreaPhys += ijet.area();
     }
     // Full area
-    totalAreaCovered += ijet.area();
+    lastBkg.totalAreaCovered += ijet.area();
   }
   // calculate Rho as the median of the jet pT / jet area
 
-  double rho = 0.0;
-  double rhoM = 0.0;
-  if (rhovector.size() != 0) {
-    rho = TMath::Median<double>(rhovector.size(), rhovector.data());
-    rhoM = TMath::Median<double>(rhoMdvector.size(), rhoMdvector.data());
+  if (lastBkg.rhoJets.size() != 0) {
+    // TMath::Median sorts an index array, the inputs are left untouched
+    lastBkg.rho = TMath::Median<double>(lastBkg.rhoJets.size(), lastBkg.rhoJets.data());
+    lastBkg.rhoM = TMath::Median<double>(lastBkg.rhoMJets.size(), lastBkg.rhoMJets.data());
   }
 
   if (doSparseSub) {
     // calculate The ocupancy factor, which the ratio of covered area / total area
-    double occupancyFactor = totalAreaCovered > 0 ? totaljetAreaPhys / totalAreaCovered : 1.;
-    rho *= occupancyFactor;
-    rhoM *= occupancyFactor;
+    double occupancyFactor = lastBkg.totalAreaCovered > 0 ? lastBkg.totalAreaPhys / lastBkg.totalAreaCovered : 1.;
+    lastBkg.rho *= occupancyFactor;
+    lastBkg.rhoM *= occupancyFactor;
   }
 
-  return std::make_tuple(rho, rhoM);
+  return lastBkg;
+}
+
+std::size_t JetBkgSubUtils::hashInput(const std::vector<fastjet::PseudoJet>& inputParticles)
+{
+  std::size_t seed = inputParticles.size();
+  auto combine = [&seed](double value) {
+    seed ^= std::hash<double>{}(value) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+  };
+  for (const auto& particle : inputParticles) {
+    combine(particle.px());
+    combine(particle.py());
+    combine(particle.pz());
+    combine(particle.E());
+  }
+  return seed;
 }
 
 std::tuple<double, double> JetBkgSubUtils::estimateRhoPerpCone(const std::vector<fastjet::PseudoJet>& inputParticles, const std::vector<fastjet::PseudoJet>& jets)
@@ -176,6 +206,95 @@ std::vector<fastjet::PseudoJet> JetBkgSubUtils::doEventConstSub(std::vector<fast
   return constituentSub.subtract_event(inputParticles, maxEtaEvent);
 }
 
+std::vector<fastjet::PseudoJet> JetBkgSubUtils::doEventConstSubGrid(const std::vector<fastjet::PseudoJet>& inputParticles, double rhoParam, double rhoMParam)
+{
+  // ghosts at the centres of a uniform grid in |eta| < maxEtaEvent and phi, with the area of ghostAreaSpec
+  const double cellSize = std::sqrt(ghostAreaSpec.ghost_area());
+  const int nEta = std::max(1, static_cast<int>(std::ceil(2. * maxEtaEvent / cellSize)));
+  const int nPhi = std::max(1, static_cast<int>(std::ceil(2. * M_PI / cellSize)));
+  const double stepEta = 2. * maxEtaEvent / nEta;
+  const double stepPhi = 2. * M_PI / nPhi;
+  const double ghostArea = stepEta * stepPhi;
+  std::vector<double> ghostPt(nEta * nPhi, rhoParam * ghostArea);
+  std::vector<double> ghostMtMinusPt(nEta * nPhi, rhoMParam * ghostArea);
+
+  struct ParticleGhostPair {
+    double distance;
+    int particle;
+    int ghost;
+  };
+  std::vector<ParticleGhostPair> pairs;
+  std::vector<int> particles; // input particles in the acceptance
+  std::vector<double> particlePt;
+  std::vector<double> particleMtMinusPt;
+  const int nCellsEta = static_cast<int>(std::ceil(constSubRMax / stepEta));
+  const int nCellsPhi = std::min((nPhi - 1) / 2, static_cast<int>(std::ceil(constSubRMax / stepPhi)));
+  for (std::size_t i = 0; i < inputParticles.size(); i++) {
+    const auto& particle = inputParticles[i];
+    if (std::abs(particle.eta()) >= maxEtaEvent) {
+      continue;
+    }
+    const int iParticle = particles.size();
+    particles.push_back(i);
+    particlePt.push_back(particle.pt());
+    particleMtMinusPt.push_back(doRhoMassSub ? particle.mt() - particle.pt() : 0.);
+    const double ptFactor = std::pow(particle.pt(), constSubAlpha);
+    const double rap = particle.rap();
+    const double phi = particle.phi_02pi();
+    const int cellEta = static_cast<int>(std::floor((rap + maxEtaEvent) / stepEta));
+    const int cellPhi = std::min(nPhi - 1, static_cast<int>(phi / stepPhi));
+    for (int iEta = std::max(0, cellEta - nCellsEta); iEta <= std::min(nEta - 1, cellEta + nCellsEta); iEta++) {
+      const double deltaRap = rap - (-maxEtaEvent + (iEta + 0.5) * stepEta);
+      for (int jPhi = cellPhi - nCellsPhi; jPhi <= cellPhi + nCellsPhi; jPhi++) {
+        const int iPhi = (jPhi + nPhi) % nPhi;
+        double deltaPhi = std::abs(phi - (iPhi + 0.5) * stepPhi);
+        deltaPhi = std::min(deltaPhi, 2. * M_PI - deltaPhi);
+        const double deltaR = std::sqrt(deltaRap * deltaRap + deltaPhi * deltaPhi);
+        if (deltaR <= constSubRMax) {
+          pairs.push_back({ptFactor * deltaR, iParticle, iEta * nPhi + iPhi});
+        }
+      }
+    }
+  }
+
+  // closest pairs first, each pair transfers the smaller of the remaining momenta (and mT - pT)
+  std::sort(pairs.begin(), pairs.end(), [](const ParticleGhostPair& a, const ParticleGhostPair& b) { return a.distance < b.distance; });
+  for (const auto& pair : pairs) {
+    double& pt = particlePt[pair.particle];
+    double& gPt = ghostPt[pair.ghost];
+    if (pt > 0. && gPt > 0.) {
+      const double subtracted = std::min(pt, gPt);
+      pt -= subtracted;
+      gPt -= subtracted;
+    }
+    if (doRhoMassSub) {
+      double& mtMinusPt = particleMtMinusPt[pair.particle];
+      double& gMtMinusPt = ghostMtMinusPt[pair.ghost];
+      if (mtMinusPt > 0. && gMtMinusPt > 0.) {
+        const double subtracted = std::min(mtMinusPt, gMtMinusPt);
+        mtMinusPt -= subtracted;
+        gMtMinusPt -= subtracted;
+      }
+    }
+  }
+
+  // particles with a remaining momentum, massless unless the mass is subtracted as well
+  std::vector<fastjet::PseudoJet> subtractedParticles;
+  subtractedParticles.reserve(particles.size());
+  for (std::size_t iParticle = 0; iParticle < particles.size(); iParticle++) {
+    const double pt = particlePt[iParticle];
+    if (pt <= 1.e-10) {
+      continue;
+    }
+    const auto& particle = inputParticles[particles[iParticle]];
+    const double mt = pt + particleMtMinusPt[iParticle];
+    fastjet::PseudoJet subtracted(pt * std::cos(particle.phi()), pt * std::sin(particle.phi()), mt * std::sinh(particle.rap()), mt * std::cosh(particle.rap()));
+    subtracted.set_user_index(particle.user_index());
+    subtractedParticles.push_back(subtracted);
+  }
+  return subtractedParticles;
+}
+
 std::vector<fastjet::PseudoJet> JetBkgSubUtils::doJetConstSub(std::vector<fastjet::PseudoJet>& jets, double rhoParam, double rhoMParam)
 {
   JetBkgSubUtils::initialise();
@@ -47,6 +47,20 @@ enum class BkgSubMode { none = 0,
                         jetConstSub = 3
 };
 
+/// @brief Background estimate of one event, kept so that the kT clustering with ghosts is not repeated for the same input
+struct BkgSubResult {
+  std::shared_ptr<fastjet::ClusterSequenceArea> clusterSeq; // keeps the kT jets and their constituents accessible
+  std::vector<fastjet::PseudoJet> kTJets;                   // kT jets in the background acceptance, including pure ghost jets
+  std::vector<double> rhoJets;                              // pT / area of the physical kT jets, input of the median
+  std::vector<double> rhoMJets;                             // mD / area of the physical kT jets, input of the median
+  double totalAreaPhys = 0.;                                // area covered by physical kT jets
+  double totalAreaCovered = 0.;                             // area covered by all kT jets
+  double rho = 0.;
+  double rhoM = 0.;
+  bool doSparseSub = false;
+  std::size_t inputHash = 0; // fingerprint of the input particles
+};
+
 class JetBkgSubUtils
 {
  public:
@@ -67,6 +81,7 @@ class JetBkgSubUtils
   {
     algorithmBkg = algorithmBkg_out;
     recombSchemeBkg = recombSchemeBkg_out;
+    resetBackgroundCache();
   }
 
   /// @brief Method for estimating the jet background density using the median method or the sparse method
@@ -75,6 +90,18 @@ class JetBkgSubUtils
   /// @return Rho, RhoM the underlying event density
   std::tuple<double, double> estimateRhoAreaMedian(const std::vector<fastjet::PseudoJet>& inputParticles, bool doSparseSub);
 
+  /// @brief Full background estimate with the median method, reused if the same input was already processed with the same settings
+  /// @param inputParticles (all particles in the event)
+  /// @param doSparseSub weather to do rho sparse subtraction
+  /// @return the kT jets, the median inputs and Rho, RhoM. Valid until the next call or resetBackgroundCache
+  const BkgSubResult& estimateBackgroundAreaMedian(const std::vector<fastjet::PseudoJet>& inputParticles, bool doSparseSub);
+
+  /// @brief Last background estimate of estimateBackgroundAreaMedian
+  const BkgSubResult& getLastBackground() const { return lastBkg; }
+
+  /// @brief Invalidates the cached background estimate, to be called when the settings change
+  void resetBackgroundCache() { hasLastBkg = false; }
+
   /// @brief Background estimator using the perpendicular cone method
   /// @param inputParticles
   /// @param jets (all jets in the event)
@@ -95,6 +122,15 @@ class JetBkgSubUtils
   /// @return inputParticles, a vector of background subtracted input particles
   std::vector<fastjet::PseudoJet> doEventConstSub(std::vector<fastjet::PseudoJet>& inputParticles, double rhoParam, double rhoMParam);
 
+  /// @brief same subtraction as doEventConstSub (deltaR distance with the alpha exponent, maximum distance, ghosts on
+  /// a uniform eta-phi grid of the ghost area), with the particle-ghost pairs taken only from the grid cells within the
+  /// maximum distance of each particle, instead of the distances of all pairs
+  /// @param inputParticles (all the tracks/clusters/particles in the event)
+  /// @param rhoParam the underlying evvent density vs pT (to be set)
+  /// @param rhoParam the underlying evvent density vs jet mass (to be set)
+  /// @return inputParticles, a vector of background subtracted input particles
+  std::vector<fastjet::PseudoJet> doEventConstSubGrid(const std::vector<fastjet::PseudoJet>& inputParticles, double rhoParam, double rhoMParam);
+
   /// @brief method that subtracts the background from jets using the jet-wise constituent subtractor
   /// @param jets (all jets in the event)
   /// @param rhoParam the underlying evvent density vs pT (to be set)
@@ -103,16 +139,22 @@ class JetBkgSubUtils
   std::vector<fastjet::PseudoJet> doJetConstSub(std::vector<fastjet::PseudoJet>& jets, double rhoParam, double rhoMParam);
 
   // Setters
-  void setJetBkgR(float jetbkgR_out) { jetBkgR = jetbkgR_out; }
+  void setJetBkgR(float jetbkgR_out)
+  {
+    jetBkgR = jetbkgR_out;
+    resetBackgroundCache();
+  }
   void setPhiMinMax(float phimin_out, float phimax_out)
   {
     bkgPhiMin = phimin_out;
     bkgPhiMax = phimax_out;
+    resetBackgroundCache();
   }
   void setEtaMinMax(float etamin_out, float etamax_out)
   {
     bkgEtaMin = etamin_out;
     bkgEtaMax = etamax_out;
+    resetBackgroundCache();
   }
   void setConstSubAlphaRMax(float alpha_out, float rmax_out)
   {
@@ -121,7 +163,11 @@ class JetBkgSubUtils
   }
   void setMaxEtaEvent(float etaMaxEvent) { maxEtaEvent = etaMaxEvent; }
   void setDoRhoMassSub(bool doMSub_out = true) { doRhoMassSub = doMSub_out; }
-  void setGhostAreaSpec(fastjet::GhostedAreaSpec ghostAreaSpec_out) { ghostAreaSpec = ghostAreaSpec_out; }
+  void setGhostAreaSpec(fastjet::GhostedAreaSpec ghostAreaSpec_out)
+  {
+    ghostAreaSpec = ghostAreaSpec_out;
+    resetBackgroundCache();
+  }
   void setJetDefinition(fastjet::JetDefinition jetdefbkg_out) { jetDefBkg = jetdefbkg_out; }
   void setAreaDefinition(fastjet::AreaDefinition areaDefBkg_out) { areaDefBkg = areaDefBkg_out; }
   void setRhoSelector(fastjet::Selector selRho_out) { selRho = selRho_out; }
@@ -144,6 +190,9 @@ class JetBkgSubUtils
   // Calculate the jet mass
   double getMd(fastjet::PseudoJet jet) const;
 
+  // Fingerprint of the input particles used to recognise an already processed event
+  static std::size_t hashInput(const std::vector<fastjet::PseudoJet>& inputParticles);
+
  protected:
   float jetBkgR = 0.2;
   float bkgEtaMin = -0.9;
@@ -163,6 +212,9 @@ class JetBkgSubUtils
   fastjet::AreaDefinition areaDefBkg = fastjet::AreaDefinition(fastjet::active_area_explicit_ghosts, ghostAreaSpec);
   fastjet::Selector selRho = fastjet::Selector();
 
+  BkgSubResult lastBkg;   //! last background estimate, reused for identical input
+  bool hasLastBkg = false; //!
+
 }; // class JetBkgSubUtils
 
 #endif // PWGJE_CORE_JETBKGSUBUTILS_H_
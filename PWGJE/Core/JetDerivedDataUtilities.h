@@ -318,6 +318,8 @@ bool applyTrackKinematics(T const& track, float pTMin = 0.15, float pTMax = 100.
   return true;
 }
 
+// the selections of a track are evaluated once by the derived data producer (setTrackSelectionBit) and stored in the
+// trackSel bitmap of the J-tracks, the jet finders and analyses only test the bit of their selection
 template <typename T>
 bool selectTrack(T const& track, int trackSelection)
 {
@@ -38,7 +38,23 @@ void JetFinder::setParams()
   // ghostAreaSpec=fastjet::GhostedAreaSpec(selGhosts,ghostRepeatN,ghostArea,gridScatter,ktScatter,ghostktMean);
   ghostAreaSpec = fastjet::GhostedAreaSpec(ghostEtaMax, ghostRepeatN, ghostArea, gridScatter, ktScatter, ghostktMean); // the first argument is rapidity not pseudorapidity, to be checked
   jetDef = fastjet::JetDefinition(algorithm, jetR, recombScheme, strategy);
-  areaDef = fastjet::AreaDefinition(areaType, ghostAreaSpec);
+  switch (areaStrategy) {
+    case JetAreaStrategy::voronoi:
+      areaType = fastjet::voronoi_area;
+      areaDef = fastjet::AreaDefinition(fastjet::VoronoiAreaSpec(voronoiRFact));
+      break;
+    case JetAreaStrategy::passive:
+      areaType = fastjet::passive_area;
+      areaDef = fastjet::AreaDefinition(areaType, ghostAreaSpec);
+      break;
+    case JetAreaStrategy::active:
+      areaType = fastjet::active_area;
+      areaDef = fastjet::AreaDefinition(areaType, ghostAreaSpec);
+      break;
+    default: // none: only used by findJetsNoArea, findJets keeps the active area
+      areaDef = fastjet::AreaDefinition(fastjet::active_area, ghostAreaSpec);
+      break;
+  }
   selJets = fastjet::SelectorPtRange(jetPtMin, jetPtMax) && fastjet::SelectorEtaRange(jetEtaMin, jetEtaMax) && fastjet::SelectorPhiRange(jetPhiMin, jetPhiMax);
 }
 
@@ -60,3 +76,51 @@ fastjet::ClusterSequenceArea JetFinder::findJets(std::vector<fastjet::PseudoJet>
   }
   return clusterSeq;
 }
+
+/// Performs jet finding without any area calculation
+/// \note the input particle and jet lists are passed by reference
+/// \param inputParticles vector of input particles/tracks
+/// \param jets veector of jets to be filled
+/// \return ClusterSequence object needed to access constituents
+fastjet::ClusterSequence JetFinder::findJetsNoArea(std::vector<fastjet::PseudoJet>& inputParticles, std::vector<fastjet::PseudoJet>& jets)
+{
+  setParams();
+  jets.clear();
+  fastjet::ClusterSequence clusterSeq(inputParticles, jetDef);
+  jets = clusterSeq.inclusive_jets();
+  jets = selJets(jets);
+  jets = fastjet::sorted_by_pt(jets);
+  if (isReclustering) {
+    jetR = jetR / 5.0;
+  }
+  return clusterSeq;
+}
+
+/// Performs jet finding for several jet radii on the same input
+/// \note the ghosts are generated once and shared by all radii
+/// \param inputParticles vector of input particles/tracks
+/// \param jetRadii jet radii to be clustered
+/// \param jets vector of jets to be filled for each radius
+/// \return ClusterSequence objects, one per radius, needed to access constituents
+std::vector<std::unique_ptr<fastjet::ClusterSequenceActiveAreaExplicitGhosts>> JetFinder::findJetsMultiRadius(std::vector<fastjet::PseudoJet>& inputParticles, const std::vector<double>& jetRadii, std::vector<std::vector<fastjet::PseudoJet>>& jets)
+{
+  std::vector<std::unique_ptr<fastjet::ClusterSequenceActiveAreaExplicitGhosts>> clusterSeqs;
+  jets.clear();
+  jets.resize(jetRadii.size());
+  const float jetRInput = jetR;
+  ghosts.clear();
+  for (std::size_t iR = 0; iR < jetRadii.size(); iR++) {
+    jetR = jetRadii[iR];
+    setParams();
+    if (iR == 0) {
+      ghostAreaSpec.add_ghosts(ghosts); // the ghost specification does not depend on the jet radius
+    }
+    clusterSeqs.push_back(std::make_unique<fastjet::ClusterSequenceActiveAreaExplicitGhosts>(inputParticles, jetDef, ghosts, ghostAreaSpec.actual_ghost_area()));
+    auto& jetsR = jets[iR];
+    jetsR = clusterSeqs.back()->inclusive_jets();
+    jetsR = (!fastjet::SelectorIsPureGhost() && selJets)(jetsR);
+    jetsR = fastjet::sorted_by_pt(jetsR);
+  }
+  jetR = jetRInput;
+  return clusterSeqs;
+}
@@ -27,7 +27,9 @@
 
 #include "fastjet/PseudoJet.hh"
 #include "fastjet/ClusterSequenceArea.hh"
+#include "fastjet/ClusterSequenceActiveAreaExplicitGhosts.hh"
 #include "fastjet/AreaDefinition.hh"
+#include "fastjet/ClusterSequence.hh"
 #include "fastjet/JetDefinition.hh"
 #include "fastjet/tools/Subtractor.hh"
 
@@ -37,6 +39,13 @@ enum class JetType {
   neutral = 2,
 };
 
+enum class JetAreaStrategy {
+  none = 0,    // no area calculation and no ghosts
+  voronoi = 1, // Voronoi area of the constituents, no ghosts
+  passive = 2, // passive area with ghosts, fast only for the kT and C/A algorithms
+  active = 3,  // active area with ghosts
+};
+
 class JetFinder
 {
 
@@ -69,13 +78,16 @@ class JetFinder
   double ghostktMean = 1.e-100;
   float gridScatter = 1.;
   float ktScatter = .1;
+  float voronoiRFact = 1.;
 
   bool isReclustering = false;
   bool isTriggering = false;
+  bool isMultiRadius = false; // share the ghosts between all jet radii of an event, see findJetsMultiRadius
 
   fastjet::JetAlgorithm algorithm = fastjet::antikt_algorithm;
   fastjet::RecombinationScheme recombScheme = fastjet::E_scheme;
   fastjet::Strategy strategy = fastjet::Best;
+  JetAreaStrategy areaStrategy = JetAreaStrategy::active;
   fastjet::AreaType areaType = fastjet::active_area;
   fastjet::GhostedAreaSpec ghostAreaSpec;
   fastjet::JetDefinition jetDef;
@@ -93,7 +105,28 @@ class JetFinder
   /// \return ClusterSequenceArea object needed to access constituents
   fastjet::ClusterSequenceArea findJets(std::vector<fastjet::PseudoJet>& inputParticles, std::vector<fastjet::PseudoJet>& jets); // ideally find a way of passing the cluster sequence as a reeference
 
+  /// Performs jet finding without any area calculation, for the case where areaStrategy is none
+  /// \note the input particle and jet lists are passed by reference
+  /// \param inputParticles vector of input particles/tracks
+  /// \param jets veector of jets to be filled
+  /// \return ClusterSequence object needed to access constituents
+  fastjet::ClusterSequence findJetsNoArea(std::vector<fastjet::PseudoJet>& inputParticles, std::vector<fastjet::PseudoJet>& jets);
+
+  /// Performs jet finding for several jet radii on the same input
+  /// \note the ghosts are generated once and shared by all radii, which requires the active area with a single ghost repetition
+  /// \note the ghosts are part of the jet constituents and can be recognised as they carry no user info
+  /// \param inputParticles vector of input particles/tracks
+  /// \param jetRadii jet radii to be clustered
+  /// \param jets vector of jets to be filled for each radius
+  /// \return ClusterSequence objects, one per radius, needed to access constituents
+  std::vector<std::unique_ptr<fastjet::ClusterSequenceActiveAreaExplicitGhosts>> findJetsMultiRadius(std::vector<fastjet::PseudoJet>& inputParticles, const std::vector<double>& jetRadii, std::vector<std::vector<fastjet::PseudoJet>>& jets);
+
+  /// Whether the settings allow sharing the ghosts between radii
+  bool canShareGhosts() const { return areaStrategy == JetAreaStrategy::active && ghostRepeatN == 1; }
+
  private:
+  std::vector<fastjet::PseudoJet> ghosts; //! explicit ghosts of the multi-radius jet finding, reused between events
+
   ClassDefNV(JetFinder, 1);
 };
 
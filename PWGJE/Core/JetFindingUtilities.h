@@ -17,6 +17,7 @@
 #ifndef PWGJE_CORE_JETFINDINGUTILITIES_H_
 #define PWGJE_CORE_JETFINDINGUTILITIES_H_
 
+#include <algorithm>
 #include <array>
 #include <vector>
 #include <string>
@@ -214,36 +215,87 @@ bool analyseV0s(std::vector<fastjet::PseudoJet>& inputParticles, T const& v0s, f
 }
 
 /**
- * Performs jet finding and fills jet tables
+ * Constituent buffers shared by all jets of a jet finder, keeping their capacity between jets and data frames
+ */
+struct JetConstituentBuffers {
+  std::vector<fastjet::PseudoJet> constituents;
+  std::vector<int> tracks;
+  std::vector<int> clusters;
+  std::vector<int> cands;
+
+  void clear()
+  {
+    constituents.clear();
+    tracks.clear();
+    clusters.clear();
+    cands.clear();
+  }
+};
+
+/**
+ * Jet finding output of one collision, buffered so that jet finding can run in parallel to the table filling
+ */
+struct JetFindingOutput {
+  struct Jet {
+    float pt;
+    float eta;
+    float phi;
+    float energy;
+    float rapidity;
+    float mass;
+    float area;
+    int r;
+    std::size_t tracksEnd; // constituent indices of jet i are at [end of jet i-1, end of jet i)
+    std::size_t clustersEnd;
+    std::size_t candsEnd;
+  };
+  std::vector<std::array<double, 4>> thnSparseEntries; // (R, pt, eta, phi) of all jets passing the area cut
+  std::vector<Jet> jets;
+  std::vector<int> tracks;
+  std::vector<int> clusters;
+  std::vector<int> cands;
+
+  void clear()
+  {
+    thnSparseEntries.clear();
+    jets.clear();
+    tracks.clear();
+    clusters.clear();
+    cands.clear();
+  }
+};
+
+/**
+ * Performs jet finding and hands the selected jets to the given callables
  *
  * @param jetFinder JetFinder object which carries jet finding parameters
  * @param inputParticles fastjet container
- * @param jetRadius jet finding radii
- * @param collision the collision within which jets are being found
- * @param jetsTable output table of jets
- * @param constituentsTable output table of jet constituents
- * @param doHFJetFinding set whether only jets containing a HF candidate are saved
+ * @param jetRValues jet finding radii
+ * @param buffers constituent buffers reused for all jets
+ * @param fillJetStatistics called with (R, jet) for all jets passing the area cut
+ * @param fillJet called with (R, jet, buffers) for all jets to be stored
+ * @param doCandidateJetFinding set whether only jets containing a HF candidate are saved
  */
-template <typename T, typename U, typename V>
-void findJets(JetFinder& jetFinder, std::vector<fastjet::PseudoJet>& inputParticles, float jetPtMin, float jetPtMax, std::vector<double> jetRadius, float jetAreaFractionMin, T const& collision, U& jetsTable, V& constituentsTable, std::shared_ptr<THn> thnSparseJet, bool fillThnSparse, bool doCandidateJetFinding = false)
+template <typename F, typename G>
+void clusterJets(JetFinder& jetFinder, std::vector<fastjet::PseudoJet>& inputParticles, float jetPtMin, float jetPtMax, std::vector<double> const& jetRValues, float jetAreaFractionMin, JetConstituentBuffers& buffers, F&& fillJetStatistics, G&& fillJet, bool doCandidateJetFinding = false)
 {
-  auto jetRValues = static_cast<std::vector<double>>(jetRadius);
   jetFinder.jetPtMin = jetPtMin;
   jetFinder.jetPtMax = jetPtMax;
-  for (auto R : jetRValues) {
-    jetFinder.jetR = R;
-    std::vector<fastjet::PseudoJet> jets;
-    fastjet::ClusterSequenceArea clusterSeq(jetFinder.findJets(inputParticles, jets));
+  auto fillJets = [&](double R, std::vector<fastjet::PseudoJet> const& jets) {
     for (const auto& jet : jets) {
       if (jet.has_area() && jet.area() < jetAreaFractionMin * M_PI * R * R) {
         continue;
       }
-      if (fillThnSparse) {
-        thnSparseJet->Fill(R, jet.pt(), jet.eta(), jet.phi()); // important for normalisation in V0Jet analyses to store all jets, including those that aren't V0s
+      fillJetStatistics(R, jet);
+      buffers.clear();
+      for (const auto& constituent : jet.constituents()) {
+        if (constituent.has_user_info()) { // skips the explicit ghosts of the multi-radius jet finding
+          buffers.constituents.push_back(constituent);
+        }
       }
       bool isCandidateJet = false;
       if (doCandidateJetFinding) {
-        for (const auto& constituent : jet.constituents()) {
+        for (const auto& constituent : buffers.constituents) {
           auto constituentStatus = constituent.template user_info<fastjetutilities::fastjet_user_info>().getStatus();
           if (constituentStatus == static_cast<int>(JetConstituentStatus::candidateHF)) { // note currently we cannot run V0 and HF in the same jet. If we ever need to we can seperate the loops
             isCandidateJet = true;
@@ -254,24 +306,135 @@ void findJets(JetFinder& jetFinder, std::vector<fastjet::PseudoJet>& inputPartic
           continue;
         }
       }
-      std::vector<int> tracks;
-      std::vector<int> cands;
-      std::vector<int> clusters;
-      jetsTable(collision.globalIndex(), jet.pt(), jet.eta(), jet.phi(),
-                jet.E(), jet.rapidity(), jet.m(), jet.has_area() ? jet.area() : 0., std::round(R * 100));
-      for (const auto& constituent : sorted_by_pt(jet.constituents())) {
-        if (constituent.template user_info<fastjetutilities::fastjet_user_info>().getStatus() == static_cast<int>(JetConstituentStatus::track)) {
-          tracks.push_back(constituent.template user_info<fastjetutilities::fastjet_user_info>().getIndex());
+      std::sort(buffers.constituents.begin(), buffers.constituents.end(), [](const fastjet::PseudoJet& a, const fastjet::PseudoJet& b) { return a.perp2() > b.perp2(); }); // same ordering as sorted_by_pt, in place
+      for (const auto& constituent : buffers.constituents) {
+        const auto& userInfo = constituent.template user_info<fastjetutilities::fastjet_user_info>();
+        if (userInfo.getStatus() == static_cast<int>(JetConstituentStatus::track)) {
+          buffers.tracks.push_back(userInfo.getIndex());
         }
-        if (constituent.template user_info<fastjetutilities::fastjet_user_info>().getStatus() == static_cast<int>(JetConstituentStatus::cluster)) {
-          clusters.push_back(constituent.template user_info<fastjetutilities::fastjet_user_info>().getIndex());
+        if (userInfo.getStatus() == static_cast<int>(JetConstituentStatus::cluster)) {
+          buffers.clusters.push_back(userInfo.getIndex());
         }
-        if (constituent.template user_info<fastjetutilities::fastjet_user_info>().getStatus() == static_cast<int>(JetConstituentStatus::candidateHF)) {
-          cands.push_back(constituent.template user_info<fastjetutilities::fastjet_user_info>().getIndex());
+        if (userInfo.getStatus() == static_cast<int>(JetConstituentStatus::candidateHF)) {
+          buffers.cands.push_back(userInfo.getIndex());
         }
       }
-      constituentsTable(jetsTable.lastIndex(), tracks, clusters, cands);
+      fillJet(R, jet, buffers);
+    }
+  };
+
+  if (jetFinder.isMultiRadius && jetRValues.size() > 1 && jetFinder.canShareGhosts()) {
+    // ghosts generated once for all radii, the cluster sequences must outlive the filling of the tables
+    std::vector<std::vector<fastjet::PseudoJet>> jets;
+    auto clusterSeqs = jetFinder.findJetsMultiRadius(inputParticles, jetRValues, jets);
+    for (std::size_t iR = 0; iR < jetRValues.size(); iR++) {
+      fillJets(jetRValues[iR], jets[iR]);
     }
+    return;
+  }
+  for (auto R : jetRValues) {
+    jetFinder.jetR = R;
+    std::vector<fastjet::PseudoJet> jets;
+    if (jetFinder.areaStrategy == JetAreaStrategy::none) {
+      fastjet::ClusterSequence clusterSeq(jetFinder.findJetsNoArea(inputParticles, jets));
+      fillJets(R, jets);
+      continue;
+    }
+    fastjet::ClusterSequenceArea clusterSeq(jetFinder.findJets(inputParticles, jets));
+    fillJets(R, jets);
+  }
+}
+
+/**
+ * Performs jet finding and fills jet tables
+ *
+ * @param jetFinder JetFinder object which carries jet finding parameters
+ * @param inputParticles fastjet container
+ * @param jetRadius jet finding radii
+ * @param collision the collision within which jets are being found
+ * @param jetsTable output table of jets
+ * @param constituentsTable output table of jet constituents
+ * @param doHFJetFinding set whether only jets containing a HF candidate are saved
+ */
+template <typename T, typename U, typename V>
+void findJets(JetFinder& jetFinder, std::vector<fastjet::PseudoJet>& inputParticles, float jetPtMin, float jetPtMax, std::vector<double> jetRadius, float jetAreaFractionMin, T const& collision, U& jetsTable, V& constituentsTable, std::shared_ptr<THn> thnSparseJet, bool fillThnSparse, bool doCandidateJetFinding = false)
+{
+  auto jetRValues = static_cast<std::vector<double>>(jetRadius);
+  // constituent buffers reused for all jets, so that filling the constituent tables does not allocate per jet
+  static thread_local JetConstituentBuffers buffers;
+  clusterJets(
+    jetFinder, inputParticles, jetPtMin, jetPtMax, jetRValues, jetAreaFractionMin, buffers,
+    [&](double R, fastjet::PseudoJet const& jet) {
+      if (fillThnSparse) {
+        thnSparseJet->Fill(R, jet.pt(), jet.eta(), jet.phi()); // important for normalisation in V0Jet analyses to store all jets, including those that aren't V0s
+      }
+    },
+    [&](double R, fastjet::PseudoJet const& jet, JetConstituentBuffers const& constituents) {
+      jetsTable(collision.globalIndex(), jet.pt(), jet.eta(), jet.phi(),
+                jet.E(), jet.rapidity(), jet.m(), jet.has_area() ? jet.area() : 0., std::round(R * 100));
+      constituentsTable(jetsTable.lastIndex(), constituents.tracks, constituents.clusters, constituents.cands);
+    },
+    doCandidateJetFinding);
+}
+
+/**
+ * Performs jet finding into a buffered output, without touching any table or histogram. Safe to call from several threads with separate jetFinder and output objects
+ *
+ * @param jetFinder JetFinder object which carries jet finding parameters
+ * @param inputParticles fastjet container
+ * @param jetRValues jet finding radii
+ * @param output buffered jets of the collision, cleared first
+ * @param doCandidateJetFinding set whether only jets containing a HF candidate are saved
+ */
+inline void findJetsToOutput(JetFinder& jetFinder, std::vector<fastjet::PseudoJet>& inputParticles, float jetPtMin, float jetPtMax, std::vector<double> const& jetRValues, float jetAreaFractionMin, JetFindingOutput& output, bool doCandidateJetFinding = false)
+{
+  static thread_local JetConstituentBuffers buffers;
+  output.clear();
+  clusterJets(
+    jetFinder, inputParticles, jetPtMin, jetPtMax, jetRValues, jetAreaFractionMin, buffers,
+    [&](double R, fastjet::PseudoJet const& jet) {
+      output.thnSparseEntries.push_back({R, jet.pt(), jet.eta(), jet.phi()});
+    },
+    [&](double R, fastjet::PseudoJet const& jet, JetConstituentBuffers const& constituents) {
+      output.tracks.insert(output.tracks.end(), constituents.tracks.begin(), constituents.tracks.end());
+      output.clusters.insert(output.clusters.end(), constituents.clusters.begin(), constituents.clusters.end());
+      output.cands.insert(output.cands.end(), constituents.cands.begin(), constituents.cands.end());
+      output.jets.push_back({static_cast<float>(jet.pt()), static_cast<float>(jet.eta()), static_cast<float>(jet.phi()),
+                             static_cast<float>(jet.E()), static_cast<float>(jet.rapidity()), static_cast<float>(jet.m()),
+                             jet.has_area() ? static_cast<float>(jet.area()) : 0.f, static_cast<int>(std::round(R * 100)),
+                             output.tracks.size(), output.clusters.size(), output.cands.size()});
+    },
+    doCandidateJetFinding);
+}
+
+/**
+ * Fills the jet tables from a buffered jet finding output
+ *
+ * @param output buffered jets of the collision
+ * @param collision the collision within which jets have been found
+ * @param jetsTable output table of jets
+ * @param constituentsTable output table of jet constituents
+ */
+template <typename T, typename U, typename V>
+void fillJetTables(JetFindingOutput const& output, T const& collision, U& jetsTable, V& constituentsTable, std::shared_ptr<THn> thnSparseJet, bool fillThnSparse)
+{
+  if (fillThnSparse) {
+    for (const auto& entry : output.thnSparseEntries) {
+      thnSparseJet->Fill(entry[0], entry[1], entry[2], entry[3]);
+    }
+  }
+  static thread_local JetConstituentBuffers buffers;
+  std::size_t tracksBegin = 0, clustersBegin = 0, candsBegin = 0;
+  for (const auto& jet : output.jets) {
+    buffers.clear();
+    buffers.tracks.assign(output.tracks.begin() + tracksBegin, output.tracks.begin() + jet.tracksEnd);
+    buffers.clusters.assign(output.clusters.begin() + clustersBegin, output.clusters.begin() + jet.clustersEnd);
+    buffers.cands.assign(output.cands.begin() + candsBegin, output.cands.begin() + jet.candsEnd);
+    jetsTable(collision.globalIndex(), jet.pt, jet.eta, jet.phi, jet.energy, jet.rapidity, jet.mass, jet.area, jet.r);
+    constituentsTable(jetsTable.lastIndex(), buffers.tracks, buffers.clusters, buffers.cands);
+    tracksBegin = jet.tracksEnd;
+    clustersBegin = jet.clustersEnd;
+    candsBegin = jet.candsEnd;
   }
 }
 
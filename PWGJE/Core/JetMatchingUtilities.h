@@ -25,6 +25,10 @@
 #include <string>
 #include <optional>
 #include <tuple>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
 
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
@@ -295,68 +299,283 @@ std::tuple<std::vector<int>, std::vector<int>> MatchJetsGeometrically(
   return std::make_tuple(baseToTagMap, tagToBaseMap);
 }
 
-template <typename T, typename U>
-void MatchGeo(T const& jetsBasePerCollision, U const& jetsTagPerCollision, std::vector<std::vector<int>>& baseToTagMatchingGeo, std::vector<std::vector<int>>& tagToBaseMatchingGeo, float maxMatchingDistance)
+/**
+ * Uniform (eta, phi) grid with periodic phi, used as a spatial index for jet matching.
+ *
+ * The cells are at least as large as the search distance, so that a query only needs to visit the
+ * 3x3 neighbouring cells. Building is linear in the number of jets and the jets are not duplicated
+ * around the phi boundary.
+ */
+template <typename T>
+class EtaPhiGrid
 {
-  std::vector<double> jetsR;
-  for (const auto& jetBase : jetsBasePerCollision) {
-    if (std::find(jetsR.begin(), jetsR.end(), std::round(jetBase.r())) == jetsR.end()) {
-      jetsR.push_back(std::round(jetBase.r()));
+ public:
+  /**
+   * Builds the index.
+   *
+   * @param jetsPhi Jets phi, any range
+   * @param jetsEta Jets eta
+   * @param maxDistance Maximum distance used in the queries
+   */
+  void build(const std::vector<T>& jetsPhi, const std::vector<T>& jetsEta, double maxDistance)
+  {
+    mMaxDistance = maxDistance;
+    mPhi = &jetsPhi;
+    mEta = &jetsEta;
+    const std::size_t nJets = jetsEta.size();
+    mEtaMin = nJets ? *std::min_element(jetsEta.begin(), jetsEta.end()) : 0.;
+    const double etaMax = nJets ? *std::max_element(jetsEta.begin(), jetsEta.end()) : 0.;
+    mNPhi = std::max(1, static_cast<int>(2 * M_PI / maxDistance));
+    mCellPhi = 2 * M_PI / mNPhi;
+    mCellEta = maxDistance;
+    mNEta = static_cast<int>((etaMax - mEtaMin) / mCellEta) + 1;
+
+    // counting sort of the jets into the cells
+    mCellStart.assign(mNEta * mNPhi + 1, 0);
+    mCellOfJet.resize(nJets);
+    for (std::size_t i = 0; i < nJets; i++) {
+      mCellOfJet[i] = cell(etaBin(jetsEta[i]), phiBin(jetsPhi[i]));
+      mCellStart[mCellOfJet[i] + 1]++;
     }
-  }
-  for (const auto& jetTag : jetsTagPerCollision) {
-    if (std::find(jetsR.begin(), jetsR.end(), std::round(jetTag.r())) == jetsR.end()) {
-      jetsR.push_back(std::round(jetTag.r()));
+    std::partial_sum(mCellStart.begin(), mCellStart.end(), mCellStart.begin());
+    mEntries.resize(nJets);
+    std::vector<int> next(mCellStart.begin(), mCellStart.end() - 1);
+    for (std::size_t i = 0; i < nJets; i++) {
+      mEntries[next[mCellOfJet[i]]++] = i;
     }
   }
-  for (auto jetR : jetsR) {
-    std::vector<double> jetsBasePhi;
-    std::vector<double> jetsBaseEta;
-    std::vector<int> baseToTagMatchingGeoIndex;
-    std::vector<int> tagToBaseMatchingGeoIndex;
 
-    for (const auto& jetBase : jetsBasePerCollision) {
-      if (std::round(jetBase.r()) != std::round(jetR)) {
-        continue;
+  /**
+   * Calls func(index, distance) for all jets within the maximum distance of the given point.
+   */
+  template <typename F>
+  void forEachNeighbour(double eta, double phi, F&& func) const
+  {
+    const int iEta = static_cast<int>(std::floor((eta - mEtaMin) / mCellEta));
+    const int iPhi = phiBin(phi);
+    const int nPhiVisit = std::min(3, mNPhi); // avoids visiting the same cell twice for very large distances
+    for (int jEta = std::max(0, iEta - 1); jEta <= std::min(mNEta - 1, iEta + 1); jEta++) {
+      for (int k = 0; k < nPhiVisit; k++) {
+        const int jPhi = (iPhi - 1 + k + mNPhi) % mNPhi;
+        const int iCell = cell(jEta, jPhi);
+        for (int n = mCellStart[iCell]; n < mCellStart[iCell + 1]; n++) {
+          const int index = mEntries[n];
+          const double dEta = (*mEta)[index] - eta;
+          const double dPhi = std::remainder((*mPhi)[index] - phi, 2 * M_PI);
+          const double distance = std::sqrt(dEta * dEta + dPhi * dPhi);
+          if (distance < mMaxDistance) {
+            func(index, distance);
+          }
+        }
       }
-      jetsBasePhi.emplace_back(jetBase.phi());
-      jetsBaseEta.emplace_back(jetBase.eta());
     }
-    std::vector<double> jetsTagPhi;
-    std::vector<double> jetsTagEta;
-    for (const auto& jetTag : jetsTagPerCollision) {
-      if (std::round(jetTag.r()) != std::round(jetR)) {
-        continue;
+  }
+
+  /**
+   * @returns index of the closest jet within the maximum distance, -1 if there is none
+   */
+  int findNearest(double eta, double phi) const
+  {
+    int nearest = -1;
+    double nearestDistance = mMaxDistance;
+    forEachNeighbour(eta, phi, [&](int index, double distance) {
+      if (distance < nearestDistance) {
+        nearest = index;
+        nearestDistance = distance;
       }
-      jetsTagPhi.emplace_back(jetTag.phi());
-      jetsTagEta.emplace_back(jetTag.eta());
+    });
+    return nearest;
+  }
+
+ private:
+  int etaBin(double eta) const { return std::min(mNEta - 1, std::max(0, static_cast<int>((eta - mEtaMin) / mCellEta))); }
+  int phiBin(double phi) const
+  {
+    double phiWrapped = std::fmod(phi, 2 * M_PI);
+    if (phiWrapped < 0) {
+      phiWrapped += 2 * M_PI;
     }
-    std::tie(baseToTagMatchingGeoIndex, tagToBaseMatchingGeoIndex) = MatchJetsGeometrically(jetsBasePhi, jetsBaseEta, jetsTagPhi, jetsTagEta, maxMatchingDistance); // change max distnace to a function call
-    int jetBaseIndex = 0;
-    for (const auto& jetBase : jetsBasePerCollision) {
-      if (std::round(jetBase.r()) != std::round(jetR)) {
-        continue;
-      }
-      int jetTagIndex = baseToTagMatchingGeoIndex[jetBaseIndex];
-      int jetTagGlobalIndex;
-      if (jetTagIndex > -1 && jetTagIndex < jetsTagPerCollision.size()) {
-        jetTagGlobalIndex = jetsTagPerCollision.iteratorAt(jetTagIndex).globalIndex();
-        baseToTagMatchingGeo[jetBase.globalIndex()].push_back(jetTagGlobalIndex);
-      }
-      jetBaseIndex++;
+    return std::min(mNPhi - 1, static_cast<int>(phiWrapped / mCellPhi));
+  }
+  int cell(int iEta, int iPhi) const { return iEta * mNPhi + iPhi; }
+
+  const std::vector<T>* mPhi = nullptr;
+  const std::vector<T>* mEta = nullptr;
+  double mMaxDistance = 0.;
+  double mEtaMin = 0.;
+  double mCellEta = 1.;
+  double mCellPhi = 1.;
+  int mNEta = 1;
+  int mNPhi = 1;
+  std::vector<int> mCellStart; // first entry of each cell, with one extra entry at the end
+  std::vector<int> mCellOfJet;
+  std::vector<int> mEntries; // jet indices sorted by cell
+};
+
+/**
+ * Geometrical jet matching using the (eta, phi) grid index.
+ *
+ * Same result as `MatchJetsGeometrically`: jets are required to be each other's closest jet within
+ * the matching distance. Phi is treated as periodic without duplicating jets.
+ *
+ * @param jetsBasePhi Base jet collection phi.
+ * @param jetsBaseEta Base jet collection eta.
+ * @param jetsTagPhi Tag jet collection phi.
+ * @param jetsTagEta Tag jet collection eta.
+ * @param maxMatchingDistance Maximum matching distance.
+ *
+ * @returns (Base to tag index map, tag to base index map) for uniquely matched jets.
+ */
+template <typename T>
+std::tuple<std::vector<int>, std::vector<int>> MatchJetsGeometricallyGrid(
+  const std::vector<T>& jetsBasePhi,
+  const std::vector<T>& jetsBaseEta,
+  const std::vector<T>& jetsTagPhi,
+  const std::vector<T>& jetsTagEta,
+  double maxMatchingDistance)
+{
+  const std::size_t nJetsBase = jetsBaseEta.size();
+  const std::size_t nJetsTag = jetsTagEta.size();
+  std::vector<int> baseToTagMap(nJetsBase, -1);
+  std::vector<int> tagToBaseMap(nJetsTag, -1);
+  if (!(nJetsBase && nJetsTag)) {
+    return std::make_tuple(baseToTagMap, tagToBaseMap);
+  }
+  if (jetsBasePhi.size() != nJetsBase) {
+    throw std::invalid_argument("Base collection eta and phi sizes don't match. Check the inputs.");
+  }
+  if (jetsTagPhi.size() != nJetsTag) {
+    throw std::invalid_argument("Tag collection eta and phi sizes don't match. Check the inputs.");
+  }
+
+  EtaPhiGrid<T> gridBase, gridTag;
+  gridBase.build(jetsBasePhi, jetsBaseEta, maxMatchingDistance);
+  gridTag.build(jetsTagPhi, jetsTagEta, maxMatchingDistance);
+
+  std::vector<int> matchIndexBase(nJetsTag, -1);
+  for (std::size_t iTag = 0; iTag < nJetsTag; iTag++) {
+    matchIndexBase[iTag] = gridBase.findNearest(jetsTagEta[iTag], jetsTagPhi[iTag]);
+  }
+  // true matches are pairs where the base jet is the closest to the tag jet and vice versa
+  for (std::size_t iBase = 0; iBase < nJetsBase; iBase++) {
+    const int iTag = gridTag.findNearest(jetsBaseEta[iBase], jetsBasePhi[iBase]);
+    if (iTag > -1 && matchIndexBase[iTag] == static_cast<int>(iBase)) {
+      baseToTagMap[iBase] = iTag;
+      tagToBaseMap[iTag] = iBase;
     }
-    int jetTagIndex = 0;
-    for (const auto& jetTag : jetsTagPerCollision) {
-      if (std::round(jetTag.r()) != std::round(jetR)) {
-        continue;
+  }
+  return std::make_tuple(baseToTagMap, tagToBaseMap);
+}
+
+/**
+ * Geometrical jet matching of all jets of a data frame in one call.
+ *
+ * Jets are only matched to jets with the same key, typically built from the collision index and the
+ * jet radius. The inputs do not need to be sorted by key.
+ *
+ * @param jetsBaseKey Base jet collection matching keys.
+ * @param jetsBasePhi Base jet collection phi.
+ * @param jetsBaseEta Base jet collection eta.
+ * @param jetsTagKey Tag jet collection matching keys.
+ * @param jetsTagPhi Tag jet collection phi.
+ * @param jetsTagEta Tag jet collection eta.
+ * @param maxMatchingDistance Maximum matching distance.
+ *
+ * @returns (Base to tag index map, tag to base index map) for uniquely matched jets, as positions in the input vectors.
+ */
+template <typename T>
+std::tuple<std::vector<int>, std::vector<int>> MatchJetsGeometricallyBatch(
+  const std::vector<int64_t>& jetsBaseKey,
+  const std::vector<T>& jetsBasePhi,
+  const std::vector<T>& jetsBaseEta,
+  const std::vector<int64_t>& jetsTagKey,
+  const std::vector<T>& jetsTagPhi,
+  const std::vector<T>& jetsTagEta,
+  double maxMatchingDistance)
+{
+  std::vector<int> baseToTagMap(jetsBaseKey.size(), -1);
+  std::vector<int> tagToBaseMap(jetsTagKey.size(), -1);
+  auto sortedByKey = [](const std::vector<int64_t>& keys) {
+    std::vector<int> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&keys](int a, int b) { return keys[a] < keys[b]; });
+    return order;
+  };
+  const std::vector<int> baseOrder = sortedByKey(jetsBaseKey);
+  const std::vector<int> tagOrder = sortedByKey(jetsTagKey);
+
+  std::vector<T> basePhi, baseEta, tagPhi, tagEta;
+  std::size_t iBase = 0, iTag = 0;
+  while (iBase < baseOrder.size() && iTag < tagOrder.size()) {
+    const int64_t baseKey = jetsBaseKey[baseOrder[iBase]];
+    const int64_t tagKey = jetsTagKey[tagOrder[iTag]];
+    if (baseKey < tagKey) {
+      iBase++;
+      continue;
+    }
+    if (tagKey < baseKey) {
+      iTag++;
+      continue;
+    }
+    // both collections have jets with this key
+    std::size_t iBaseEnd = iBase, iTagEnd = iTag;
+    basePhi.clear();
+    baseEta.clear();
+    tagPhi.clear();
+    tagEta.clear();
+    for (; iBaseEnd < baseOrder.size() && jetsBaseKey[baseOrder[iBaseEnd]] == baseKey; iBaseEnd++) {
+      basePhi.push_back(jetsBasePhi[baseOrder[iBaseEnd]]);
+      baseEta.push_back(jetsBaseEta[baseOrder[iBaseEnd]]);
+    }
+    for (; iTagEnd < tagOrder.size() && jetsTagKey[tagOrder[iTagEnd]] == tagKey; iTagEnd++) {
+      tagPhi.push_back(jetsTagPhi[tagOrder[iTagEnd]]);
+      tagEta.push_back(jetsTagEta[tagOrder[iTagEnd]]);
+    }
+    auto&& [baseToTagGroup, tagToBaseGroup] = MatchJetsGeometricallyGrid(basePhi, baseEta, tagPhi, tagEta, maxMatchingDistance);
+    for (std::size_t i = 0; i < baseToTagGroup.size(); i++) {
+      if (baseToTagGroup[i] > -1) {
+        baseToTagMap[baseOrder[iBase + i]] = tagOrder[iTag + baseToTagGroup[i]];
       }
-      int jetBaseIndex = tagToBaseMatchingGeoIndex[jetTagIndex];
-      int jetBaseGlobalIndex;
-      if (jetBaseIndex > -1 && jetBaseIndex < jetsBasePerCollision.size()) {
-        jetBaseGlobalIndex = jetsBasePerCollision.iteratorAt(jetBaseIndex).globalIndex();
-        tagToBaseMatchingGeo[jetTag.globalIndex()].push_back(jetBaseGlobalIndex);
+    }
+    for (std::size_t i = 0; i < tagToBaseGroup.size(); i++) {
+      if (tagToBaseGroup[i] > -1) {
+        tagToBaseMap[tagOrder[iTag + i]] = baseOrder[iBase + tagToBaseGroup[i]];
       }
-      jetTagIndex++;
+    }
+    iBase = iBaseEnd;
+    iTag = iTagEnd;
+  }
+  return std::make_tuple(baseToTagMap, tagToBaseMap);
+}
+
+template <typename T, typename U>
+void MatchGeo(T const& jetsBasePerCollision, U const& jetsTagPerCollision, std::vector<std::vector<int>>& baseToTagMatchingGeo, std::vector<std::vector<int>>& tagToBaseMatchingGeo, float maxMatchingDistance)
+{
+  // a single pass over the jets, grouped by radius through the batch matching
+  std::vector<int64_t> jetsBaseKey, jetsTagKey;
+  std::vector<double> jetsBasePhi, jetsBaseEta, jetsTagPhi, jetsTagEta;
+  std::vector<int> jetsBaseGlobalIndex, jetsTagGlobalIndex;
+  for (const auto& jetBase : jetsBasePerCollision) {
+    jetsBaseKey.push_back(std::round(jetBase.r()));
+    jetsBasePhi.push_back(jetBase.phi());
+    jetsBaseEta.push_back(jetBase.eta());
+    jetsBaseGlobalIndex.push_back(jetBase.globalIndex());
+  }
+  for (const auto& jetTag : jetsTagPerCollision) {
+    jetsTagKey.push_back(std::round(jetTag.r()));
+    jetsTagPhi.push_back(jetTag.phi());
+    jetsTagEta.push_back(jetTag.eta());
+    jetsTagGlobalIndex.push_back(jetTag.globalIndex());
+  }
+  auto&& [baseToTagMatchingGeoIndex, tagToBaseMatchingGeoIndex] = MatchJetsGeometricallyBatch(jetsBaseKey, jetsBasePhi, jetsBaseEta, jetsTagKey, jetsTagPhi, jetsTagEta, maxMatchingDistance);
+  for (std::size_t i = 0; i < baseToTagMatchingGeoIndex.size(); i++) {
+    if (baseToTagMatchingGeoIndex[i] > -1) {
+      baseToTagMatchingGeo[jetsBaseGlobalIndex[i]].push_back(jetsTagGlobalIndex[baseToTagMatchingGeoIndex[i]]);
+    }
+  }
+  for (std::size_t i = 0; i < tagToBaseMatchingGeoIndex.size(); i++) {
+    if (tagToBaseMatchingGeoIndex[i] > -1) {
+      tagToBaseMatchingGeo[jetsTagGlobalIndex[i]].push_back(jetsBaseGlobalIndex[tagToBaseMatchingGeoIndex[i]]);
     }
   }
 }
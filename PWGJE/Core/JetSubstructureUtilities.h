@@ -45,6 +45,7 @@ namespace jetsubstructureutilities
 
 /**
  * convert an O2Physics jet to a fastjet pseudojet object, returning its clusterSequence
+ * the constituents are reclustered with C/A and without area (no ghosts), so that the declustering sequence of pseudoJet can be used directly
  *
  * @param jet jet to be converted
  * @param tracks vector of constituent tracks
@@ -53,7 +54,7 @@ namespace jetsubstructureutilities
  * @param pseudoJet converted pseudoJet object which is passed by reference
  */
 template <typename T, typename U, typename V, typename O>
-fastjet::ClusterSequenceArea jetToPseudoJet(T const& jet, U const& /*tracks*/, V const& /*clusters*/, O const& /*candidates*/, fastjet::PseudoJet& pseudoJet)
+fastjet::ClusterSequence jetToPseudoJet(T const& jet, U const& /*tracks*/, V const& /*clusters*/, O const& /*candidates*/, fastjet::PseudoJet& pseudoJet)
 {
   std::vector<fastjet::PseudoJet> jetConstituents;
   for (auto& jetConstituent : jet.template tracks_as<U>()) {
@@ -73,8 +74,9 @@ fastjet::ClusterSequenceArea jetToPseudoJet(T const& jet, U const& /*tracks*/, V
 
   JetFinder jetReclusterer;
   jetReclusterer.isReclustering = true;
+  jetReclusterer.algorithm = fastjet::JetAlgorithm::cambridge_algorithm;
   jetReclusterer.jetR = jet.r() / 100.0;
-  fastjet::ClusterSequenceArea clusterSeq = jetReclusterer.findJets(jetConstituents, jetReclustered);
+  fastjet::ClusterSequence clusterSeq = jetReclusterer.findJetsNoArea(jetConstituents, jetReclustered);
   jetReclustered = sorted_by_pt(jetReclustered);
   pseudoJet = jetReclustered[0];
   return clusterSeq;
@@ -94,13 +96,11 @@ fastjet::ClusterSequenceArea jetToPseudoJet(T const& jet, U const& /*tracks*/, V
  * @param beta angular exponent in the SoftDrop condition
  */
 
-// function that returns the N-subjettiness ratio and the distance betewwen the two axes considered for tau2, in the form of a vector
-template <typename T, typename U, typename V, typename O, typename M>
-std::vector<float> getNSubjettiness(T const& jet, U const& tracks, V const& clusters, O const& candidates, int nMax, M const& reclusteringAlgorithm, bool doSoftDrop = false, float zCut = 0.1, float beta = 0.0)
+// same as below for a jet already converted (and reclustered) by the caller, e.g. with jetToPseudoJet, of radius jetR
+template <typename M>
+std::vector<float> getNSubjettinessPseudoJet(fastjet::PseudoJet pseudoJet, float jetR, int nMax, M const& reclusteringAlgorithm, bool doSoftDrop = false, float zCut = 0.1, float beta = 0.0)
 {
   std::vector<float> result;
-  fastjet::PseudoJet pseudoJet;
-  fastjet::ClusterSequenceArea clusterSeq(jetToPseudoJet(jet, tracks, clusters, candidates, pseudoJet));
   if (doSoftDrop) {
     fastjet::contrib::SoftDrop softDrop(beta, zCut);
     pseudoJet = softDrop(pseudoJet);
@@ -114,7 +114,7 @@ std::vector<float> getNSubjettiness(T const& jet, U const& tracks, V const& clus
     if (pseudoJet.constituents().size() < n) { // Tau_N needs at least N tracks
       return result;
     }
-    fastjet::contrib::Nsubjettiness nSub(n, reclusteringAlgorithm, fastjet::contrib::NormalizedMeasure(1.0, jet.r() / 100.0));
+    fastjet::contrib::Nsubjettiness nSub(n, reclusteringAlgorithm, fastjet::contrib::NormalizedMeasure(1.0, jetR));
     result[n] = nSub.result(pseudoJet);
     if (n == 2) {
       std::vector<fastjet::PseudoJet> nSubAxes = nSub.currentAxes(); // gets the two axes used in the 2-subjettiness calculation
@@ -124,6 +124,15 @@ std::vector<float> getNSubjettiness(T const& jet, U const& tracks, V const& clus
   return result;
 }
 
+// function that returns the N-subjettiness ratio and the distance betewwen the two axes considered for tau2, in the form of a vector
+template <typename T, typename U, typename V, typename O, typename M>
+std::vector<float> getNSubjettiness(T const& jet, U const& tracks, V const& clusters, O const& candidates, int nMax, M const& reclusteringAlgorithm, bool doSoftDrop = false, float zCut = 0.1, float beta = 0.0)
+{
+  fastjet::PseudoJet pseudoJet;
+  fastjet::ClusterSequence clusterSeq(jetToPseudoJet(jet, tracks, clusters, candidates, pseudoJet));
+  return getNSubjettinessPseudoJet(pseudoJet, jet.r() / 100.0, nMax, reclusteringAlgorithm, doSoftDrop, zCut, beta);
+}
+
 }; // namespace jetsubstructureutilities
 
 #endif // PWGJE_CORE_JETSUBSTRUCTUREUTILITIES_H_
@@ -19,6 +19,7 @@
 #define PWGJE_CORE_JETTAGGINGUTILITIES_H_
 
 #include <cmath>
+#include <cstdint>
 #include <limits>
 #include <numeric>
 #include <tuple>
@@ -100,15 +101,119 @@ int getOriginalHFMotherIndex(const typename T::iterator& hfparticle)
   return -1.0;
 }
 
+/**
+ * per-particle cache of the HF shower origin (RecoDecay::getCharmHadronOrigin up to the quark) and of the
+ * original HF mother (getOriginalHFMotherIndex) of the MC particles of one dataframe, so that the mother chains
+ * shared by the constituents of all the jets are followed once. The entries are computed at the first request,
+ * the chain of first mothers of getOriginalHFMotherIndex is resolved for all the particles on it.
+ *
+ * Usage:
+ *   cache.update(particles); // once per process() call, reset when the particle table changes
+ *   int origin = mcdJetFromHFShower(jet, tracks, particles, dRMax, &cache);
+ */
+class ParticleHFOriginCache
+{
+ public:
+  template <typename U>
+  void update(U const& particles)
+  {
+    const void* table = particles.asArrowTable().get();
+    if (table == mTable && static_cast<int64_t>(particles.size()) == mNRows) {
+      return;
+    }
+    mTable = table;
+    mNRows = particles.size();
+    mOrigin.assign(mNRows, kUnknown);
+    mOriginalHFMother.assign(mNRows, kUnknown);
+  }
+
+  /// RecoDecay::getCharmHadronOrigin(particles, particle, true)
+  template <typename U>
+  int hfOrigin(U const& particles, typename U::iterator const& particle)
+  {
+    const int64_t row = particle.globalIndex() - particles.offset();
+    if (row < 0 || row >= mNRows) {
+      return RecoDecay::getCharmHadronOrigin(particles, particle, true);
+    }
+    if (mOrigin[row] == kUnknown) {
+      mOrigin[row] = RecoDecay::getCharmHadronOrigin(particles, particle, true);
+    }
+    return mOrigin[row];
+  }
+
+  /// getOriginalHFMotherIndex<U>(particle)
+  template <typename U>
+  int originalHFMotherIndex(U const& particles, typename U::iterator const& particle)
+  {
+    const int64_t first = particle.globalIndex() - particles.offset();
+    if (first < 0 || first >= mNRows) {
+      return getOriginalHFMotherIndex<U>(particle);
+    }
+    // first mothers up to a particle with a known result or without mother
+    mChain.clear();
+    int64_t row = first;
+    while (mOriginalHFMother[row] == kUnknown) {
+      mOriginalHFMother[row] = kOnChain;
+      mChain.push_back(row);
+      auto current = particles.rawIteratorAt(row);
+      if (!current.has_mothers()) {
+        break;
+      }
+      const int64_t motherRow = current.mothersIds().front() - particles.offset();
+      if (motherRow < 0 || motherRow >= mNRows) {
+        break;
+      }
+      row = motherRow;
+    }
+    // resolved from the top of the chain: the first mother if it is an original HF mother, else its own result
+    int result = -1;
+    for (auto it = mChain.rbegin(); it != mChain.rend(); ++it) {
+      auto current = particles.rawIteratorAt(*it);
+      result = -1;
+      if (current.has_mothers()) {
+        const int64_t motherRow = current.mothersIds().front() - particles.offset();
+        if (motherRow >= 0 && motherRow < mNRows) {
+          auto mother = particles.rawIteratorAt(motherRow);
+          if (isOriginalHFMother<U>(mother)) {
+            result = mother.globalIndex();
+          } else if (mOriginalHFMother[motherRow] >= -1) {
+            result = mOriginalHFMother[motherRow];
+          }
+        }
+      }
+      mOriginalHFMother[*it] = result;
+    }
+    return mOriginalHFMother[first];
+  }
+
+ private:
+  static constexpr int kUnknown = -3;
+  static constexpr int kOnChain = -2; // being resolved, a loop in the mother chain ends there
+
+  template <typename U>
+  static bool isOriginalHFMother(typename U::iterator const& mother)
+  {
+    int motherStatusCode = std::abs(mother.getGenStatusCode());
+    return motherStatusCode == 23 || motherStatusCode == 33 || motherStatusCode == 43 || motherStatusCode == 63 || (motherStatusCode == 51 && mother.has_mothers() && mother.template mothers_first_as<U>().pdgCode() == 21);
+  }
+
+  const void* mTable = nullptr;
+  int64_t mNRows = 0;
+  std::vector<int8_t> mOrigin;        // RecoDecay::OriginType per row
+  std::vector<int> mOriginalHFMother; // global index, -1 if none
+  std::vector<int64_t> mChain;
+};
+
 /**
  * checks if atrack in a reco level jet originates from a HF shower. 0:no HF shower, 1:charm shower, 2:beauty shower. The first track originating from an HF shower can be extracted by reference
  *
  * @param jet
  * @param particles table of generator level particles to be searched through
  * @param hftrack track passed as reference which is then replaced by the first track that originated from an HF shower
+ * @param cache optional cache of the origins of the particles, see ParticleHFOriginCache
  */
 template <typename T, typename U, typename V>
-int jetTrackFromHFShower(T const& jet, U const& /*tracks*/, V const& particles, typename U::iterator& hftrack)
+int jetTrackFromHFShower(T const& jet, U const& /*tracks*/, V const& particles, typename U::iterator& hftrack, ParticleHFOriginCache* cache = nullptr)
 {
 
   bool hasMcParticle = false;
@@ -119,7 +224,7 @@ int jetTrackFromHFShower(T const& jet, U const& /*tracks*/, V const& particles,
     }
     hasMcParticle = true;
     auto const& particle = track.template mcParticle_as<V>();
-    origin = RecoDecay::getCharmHadronOrigin(particles, particle, true);
+    origin = cache ? cache->hfOrigin(particles, particle) : RecoDecay::getCharmHadronOrigin(particles, particle, true);
     if (origin == 1 || origin == 2) { // 1=charm , 2=beauty
       hftrack = track;
       if (origin == 1) {
@@ -143,14 +248,15 @@ int jetTrackFromHFShower(T const& jet, U const& /*tracks*/, V const& particles,
  * @param jet
  * @param particles table of generator level particles to be searched through
  * @param hfparticle particle passed as reference which is then replaced by the first track that originated from an HF shower
+ * @param cache optional cache of the origins of the particles, see ParticleHFOriginCache
  */
 template <typename T, typename U>
-int jetParticleFromHFShower(T const& jet, U const& particles, typename U::iterator& hfparticle)
+int jetParticleFromHFShower(T const& jet, U const& particles, typename U::iterator& hfparticle, ParticleHFOriginCache* cache = nullptr)
 {
 
   int origin = -1;
   for (auto& particle : jet.template tracks_as<U>()) {
-    origin = RecoDecay::getCharmHadronOrigin(particles, particle, true);
+    origin = cache ? cache->hfOrigin(particles, particle) : RecoDecay::getCharmHadronOrigin(particles, particle, true);
     if (origin == 1 || origin == 2) { // 1=charm , 2=beauty
       hfparticle = particle;
       if (origin == 1) {
@@ -170,21 +276,22 @@ int jetParticleFromHFShower(T const& jet, U const& particles, typename U::iterat
  * @param jet
  * @param particles table of generator level particles to be searched through
  * @param dRMax maximum distance in eta-phi of initiating heavy-flavour quark from the jet axis
+ * @param cache optional cache of the origins of the particles, see ParticleHFOriginCache
  */
 
 template <typename T, typename U, typename V>
-int mcdJetFromHFShower(T const& jet, U const& tracks, V const& particles, float dRMax = 0.25)
+int mcdJetFromHFShower(T const& jet, U const& tracks, V const& particles, float dRMax = 0.25, ParticleHFOriginCache* cache = nullptr)
 {
 
   typename U::iterator hftrack;
-  int origin = jetTrackFromHFShower(jet, tracks, particles, hftrack);
+  int origin = jetTrackFromHFShower(jet, tracks, particles, hftrack, cache);
   if (origin == JetTaggingSpecies::charm || origin == JetTaggingSpecies::beauty) {
     if (!hftrack.has_mcParticle()) {
       return JetTaggingSpecies::none;
     }
     auto const& hfparticle = hftrack.template mcParticle_as<V>();
 
-    int originalHFMotherIndex = getOriginalHFMotherIndex<V>(hfparticle);
+    int originalHFMotherIndex = cache ? cache->originalHFMotherIndex(particles, hfparticle) : getOriginalHFMotherIndex<V>(hfparticle);
     if (originalHFMotherIndex > -1.0) {
 
       if (jetutilities::deltaR(jet, particles.iteratorAt(originalHFMotherIndex)) < dRMax) {
@@ -211,17 +318,18 @@ int mcdJetFromHFShower(T const& jet, U const& tracks, V const& particles, float
  * @param jet
  * @param particles table of generator level particles to be searched through
  * @param dRMax maximum distance in eta-phi of initiating heavy-flavour quark from the jet axis
+ * @param cache optional cache of the origins of the particles, see ParticleHFOriginCache
  */
 
-template <typename T, typename U, typename V>
-int mcpJetFromHFShower(T const& jet, U const& particles, float dRMax = 0.25)
+template <typename T, typename U>
+int mcpJetFromHFShower(T const& jet, U const& particles, float dRMax = 0.25, ParticleHFOriginCache* cache = nullptr)
 {
 
   typename U::iterator hfparticle;
-  int origin = jetParticleFromHFShower(jet, particles, hfparticle);
+  int origin = jetParticleFromHFShower(jet, particles, hfparticle, cache);
   if (origin == JetTaggingSpecies::charm || origin == JetTaggingSpecies::beauty) {
 
-    int originalHFMotherIndex = getOriginalHFMotherIndex<U>(hfparticle);
+    int originalHFMotherIndex = cache ? cache->originalHFMotherIndex(particles, hfparticle) : getOriginalHFMotherIndex<U>(hfparticle);
     if (originalHFMotherIndex > -1.0) {
 
       if (jetutilities::deltaR(jet, particles.iteratorAt(originalHFMotherIndex)) < dRMax) {
@@ -18,6 +18,7 @@
 #ifndef PWGJE_CORE_JETUTILITIES_H_
 #define PWGJE_CORE_JETUTILITIES_H_
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <numeric>
@@ -138,6 +139,133 @@ std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>> MatchCl
   return std::make_tuple(matchIndexTrack, matchIndexCluster);
 }
 
+/**
+ * Match tracks to clusters with a uniform (eta, phi) grid of the clusters.
+ *
+ * Gives the same cluster to track matches as MatchClustersAndTracks: for each cluster, the maxNumberMatches
+ * closest tracks within dR < maxMatchingDistance (in the (eta, phi) plane, without wrapping of phi),
+ * ordered by increasing distance. The grid cells are at least as large as the matching distance, so each
+ * track is only compared to the clusters of the 3x3 neighbouring cells.
+ * The matches are stored in a compressed (CSR) layout: the tracks matched to the cluster i are
+ * matchedTracks[offsets[i]], ..., matchedTracks[offsets[i + 1] - 1].
+ *
+ * @param clusterPhi cluster collection phi.
+ * @param clusterEta cluster collection eta.
+ * @param trackPhi track collection phi.
+ * @param trackEta track collection eta.
+ * @param maxMatchingDistance Maximum matching distance.
+ * @param maxNumberMatches Maximum number of matches per cluster (e.g. 5 closest).
+ * @param offsets Offsets of the matches of each cluster, filled with nClusters + 1 entries.
+ * @param matchedTracks Indices of the matched tracks.
+ */
+template <typename T>
+void MatchClustersAndTracksGrid(
+  std::vector<T> const& clusterPhi,
+  std::vector<T> const& clusterEta,
+  std::vector<T> const& trackPhi,
+  std::vector<T> const& trackEta,
+  double maxMatchingDistance,
+  int maxNumberMatches,
+  std::vector<int>& offsets,
+  std::vector<int>& matchedTracks)
+{
+  const std::size_t nClusters = clusterEta.size();
+  const std::size_t nTracks = trackEta.size();
+  offsets.assign(nClusters + 1, 0);
+  matchedTracks.clear();
+  if (clusterPhi.size() != nClusters) {
+    throw std::invalid_argument("cluster collection eta and phi sizes don't match. Check the inputs.");
+  }
+  if (trackPhi.size() != nTracks) {
+    throw std::invalid_argument("track collection eta and phi sizes don't match. Check the inputs.");
+  }
+  if (!(nClusters && nTracks) || maxMatchingDistance <= 0. || maxNumberMatches <= 0) {
+    return;
+  }
+
+  // grid over the cluster range, the cells are enlarged if the matching distance would give too many of them
+  const auto [etaMin, etaMax] = std::minmax_element(clusterEta.begin(), clusterEta.end());
+  const auto [phiMin, phiMax] = std::minmax_element(clusterPhi.begin(), clusterPhi.end());
+  const std::size_t maxCells = std::max<std::size_t>(64, 4 * nClusters);
+  double cellSize = maxMatchingDistance;
+  int nCellsEta = 1, nCellsPhi = 1;
+  while (true) {
+    nCellsEta = static_cast<int>((*etaMax - *etaMin) / cellSize) + 1;
+    nCellsPhi = static_cast<int>((*phiMax - *phiMin) / cellSize) + 1;
+    if (static_cast<std::size_t>(nCellsEta) * nCellsPhi <= maxCells) {
+      break;
+    }
+    cellSize *= 2.;
+  }
+  const double invCellSize = 1. / cellSize;
+
+  // clusters sorted by cell (counting sort)
+  std::vector<int> cellStart(nCellsEta * nCellsPhi + 1, 0);
+  std::vector<int> clusterCell(nClusters);
+  for (std::size_t iCluster = 0; iCluster < nClusters; iCluster++) {
+    const int iEta = static_cast<int>((clusterEta[iCluster] - *etaMin) * invCellSize);
+    const int iPhi = static_cast<int>((clusterPhi[iCluster] - *phiMin) * invCellSize);
+    clusterCell[iCluster] = std::min(iEta, nCellsEta - 1) * nCellsPhi + std::min(iPhi, nCellsPhi - 1);
+    cellStart[clusterCell[iCluster] + 1]++;
+  }
+  std::partial_sum(cellStart.begin(), cellStart.end(), cellStart.begin());
+  std::vector<int> cellClusters(nClusters);
+  std::vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+  for (std::size_t iCluster = 0; iCluster < nClusters; iCluster++) {
+    cellClusters[fill[clusterCell[iCluster]]++] = iCluster;
+  }
+
+  // candidate pairs (cluster, distance, track) of each track with the clusters of the neighbouring cells
+  struct Candidate {
+    int cluster;
+    T distance2;
+    int track;
+  };
+  std::vector<Candidate> candidates;
+  const T maxDistance2 = maxMatchingDistance * maxMatchingDistance;
+  for (std::size_t iTrack = 0; iTrack < nTracks; iTrack++) {
+    const double cellEta = std::floor((trackEta[iTrack] - *etaMin) * invCellSize);
+    const double cellPhi = std::floor((trackPhi[iTrack] - *phiMin) * invCellSize);
+    if (cellEta < -1. || cellEta > nCellsEta || cellPhi < -1. || cellPhi > nCellsPhi) {
+      continue; // more than one cell away from the clusters
+    }
+    const int iEtaFirst = std::max(static_cast<int>(cellEta) - 1, 0), iEtaLast = std::min(static_cast<int>(cellEta) + 1, nCellsEta - 1);
+    const int iPhiFirst = std::max(static_cast<int>(cellPhi) - 1, 0), iPhiLast = std::min(static_cast<int>(cellPhi) + 1, nCellsPhi - 1);
+    for (int iEta = iEtaFirst; iEta <= iEtaLast; iEta++) {
+      for (int iPhi = iPhiFirst; iPhi <= iPhiLast; iPhi++) {
+        const int cell = iEta * nCellsPhi + iPhi;
+        for (int iEntry = cellStart[cell]; iEntry < cellStart[cell + 1]; iEntry++) {
+          const int iCluster = cellClusters[iEntry];
+          const T dEta = trackEta[iTrack] - clusterEta[iCluster];
+          const T dPhi = trackPhi[iTrack] - clusterPhi[iCluster];
+          const T distance2 = dEta * dEta + dPhi * dPhi;
+          if (distance2 < maxDistance2) {
+            candidates.push_back({iCluster, distance2, static_cast<int>(iTrack)});
+          }
+        }
+      }
+    }
+  }
+
+  // keep the maxNumberMatches closest tracks of each cluster
+  std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+    return a.cluster != b.cluster ? a.cluster < b.cluster : (a.distance2 != b.distance2 ? a.distance2 < b.distance2 : a.track < b.track);
+  });
+  matchedTracks.reserve(std::min<std::size_t>(candidates.size(), nClusters * maxNumberMatches));
+  for (std::size_t iCand = 0; iCand < candidates.size();) {
+    const int iCluster = candidates[iCand].cluster;
+    int nMatches = 0;
+    for (; iCand < candidates.size() && candidates[iCand].cluster == iCluster; iCand++) {
+      if (nMatches < maxNumberMatches) {
+        matchedTracks.push_back(candidates[iCand].track);
+        nMatches++;
+      }
+    }
+    offsets[iCluster + 1] = nMatches;
+  }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+}
+
 template <typename T, typename U>
 float deltaR(T const& A, U const& B)
 {
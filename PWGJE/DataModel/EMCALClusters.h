@@ -125,5 +125,12 @@ DECLARE_SOA_INDEX_COLUMN(Track, track); //! linked to Track table only for track
 DECLARE_SOA_TABLE(EMCALMatchedTracks, "AOD", "EMCMATCHTRACKS",                                     //!
                   o2::soa::Index<>, emcalclustercell::EMCALClusterId, emcalmatchedtrack::TrackId); //!
 using EMCALMatchedTrack = EMCALMatchedTracks::iterator;
+namespace emcalclustermatchedtrack
+{
+DECLARE_SOA_SLICE_INDEX_COLUMN(EMCALMatchedTrack, matchedTracks); //! range of the EMCALMatchedTracks rows of the cluster
+} // namespace emcalclustermatchedtrack
+// one row per cluster, joinable with EMCALClusters
+DECLARE_SOA_TABLE(EMCALClusterMatchedTrackSlices, "AOD", "EMCCLUSMTSLICE",       //!
+                  emcalclustermatchedtrack::EMCALMatchedTrackIdSlice);           //!
 } // namespace o2::aod
 #endif // PWGJE_DATAMODEL_EMCALCLUSTERS_H_
@@ -15,6 +15,10 @@
 /// \author Jochen Klein <jochen.klein@cern.ch>
 /// \author Raymond Ehlers <raymond.ehlers@cern.ch>, ORNL
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include "PWGJE/Core/JetFindingUtilities.h"
 #include "Framework/runDataProcessing.h"
 
@@ -71,10 +75,13 @@ struct JetFinderTask {
   Configurable<int> jetRecombScheme{"jetRecombScheme", 0, "jet recombination scheme. 0 = E-scheme, 1 = pT-scheme, 2 = pT2-scheme"};
   Configurable<float> jetGhostArea{"jetGhostArea", 0.005, "jet ghost area"};
   Configurable<int> ghostRepeat{"ghostRepeat", 1, "set to 0 to gain speed if you dont need area calculation"};
+  Configurable<int> jetAreaStrategy{"jetAreaStrategy", 3, "jet area calculation. 0 = none (no ghosts), 1 = Voronoi, 2 = passive, 3 = active"};
+  Configurable<bool> jetMultiRadius{"jetMultiRadius", false, "generate the ghosts once per event and share them between all jet radii (requires ghostRepeat = 1)"};
   Configurable<bool> DoTriggering{"DoTriggering", false, "used for the charged jet trigger to remove the eta constraint on the jet axis"};
   Configurable<float> jetAreaFractionMin{"jetAreaFractionMin", -99.0, "used to make a cut on the jet areas"};
   Configurable<int> jetPtBinWidth{"jetPtBinWidth", 5, "used to define the width of the jetPt bins for the THnSparse"};
   Configurable<bool> fillTHnSparse{"fillTHnSparse", false, "switch to fill the THnSparse"};
+  Configurable<int> jetFinderNumThreads{"jetFinderNumThreads", 4, "number of threads used by the parallel process functions"};
 
   Service<o2::framework::O2DatabasePDG> pdgDatabase;
   int trackSelection = -1;
@@ -84,6 +91,12 @@ struct JetFinderTask {
   JetFinder jetFinder;
   std::vector<fastjet::PseudoJet> inputParticles;
 
+  // per-collision inputs and outputs of the parallel process functions
+  SliceCache cache;
+  std::vector<std::vector<fastjet::PseudoJet>> collisionInputs;
+  std::vector<jetfindingutilities::JetFindingOutput> collisionOutputs;
+  std::vector<bool> collisionSelected;
+
   void init(InitContext const&)
   {
     trackSelection = jetderiveddatautilities::initialiseTrackSelection(static_cast<std::string>(trackSelections));
@@ -101,6 +114,8 @@ struct JetFinderTask {
     jetFinder.recombScheme = static_cast<fastjet::RecombinationScheme>(static_cast<int>(jetRecombScheme));
     jetFinder.ghostArea = jetGhostArea;
     jetFinder.ghostRepeatN = ghostRepeat;
+    jetFinder.areaStrategy = static_cast<JetAreaStrategy>(static_cast<int>(jetAreaStrategy));
+    jetFinder.isMultiRadius = jetMultiRadius;
     if (DoTriggering) {
       jetFinder.isTriggering = true;
     }
@@ -133,6 +148,36 @@ struct JetFinderTask {
   Filter partCuts = (aod::jmcparticle::pt >= trackPtMin && aod::jmcparticle::pt < trackPtMax && aod::jmcparticle::eta > trackEtaMin && aod::jmcparticle::eta < trackEtaMax);
   Filter clusterFilter = (aod::jcluster::definition == static_cast<int>(clusterDefinition) && aod::jcluster::eta > clusterEtaMin && aod::jcluster::eta < clusterEtaMax && aod::jcluster::phi >= clusterPhiMin && aod::jcluster::phi <= clusterPhiMax && aod::jcluster::energy >= clusterEnergyMin && aod::jcluster::time > clusterTimeMin && aod::jcluster::time < clusterTimeMax && (clusterRejectExotics && aod::jcluster::isExotic != true));
 
+  /// Clusters the collected collisions on jetFinderNumThreads threads, each with its own copy of the jet finder
+  void findJetsParallel(float ptMin, float ptMax)
+  {
+    std::atomic<std::size_t> nextCollision{0};
+    auto worker = [&]() {
+      JetFinder threadJetFinder = jetFinder;
+      for (std::size_t i = nextCollision++; i < collisionInputs.size(); i = nextCollision++) {
+        if (collisionSelected[i]) {
+          jetfindingutilities::findJetsToOutput(threadJetFinder, collisionInputs[i], ptMin, ptMax, jetRadius.value, jetAreaFractionMin, collisionOutputs[i]);
+        }
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 1; i < jetFinderNumThreads; i++) {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  /// Prepares the per-collision containers of the parallel process functions
+  void resetCollisionBuffers(std::size_t nCollisions)
+  {
+    collisionInputs.resize(nCollisions);
+    collisionOutputs.resize(nCollisions);
+    collisionSelected.assign(nCollisions, false);
+  }
+
   void processChargedJets(soa::Filtered<JetCollisions>::iterator const& collision,
                           soa::Filtered<JetTracks> const& tracks)
   {
@@ -146,6 +191,32 @@ struct JetFinderTask {
 
   PROCESS_SWITCH(JetFinderTask, processChargedJets, "Data and reco level jet finding for charged jets", false);
 
+  void processChargedJetsParallel(soa::Filtered<JetCollisions> const& collisions,
+                                  soa::Filtered<JetTracks> const& tracks)
+  {
+    // the inputs are collected sequentially, the clustering is distributed over the threads and the tables are filled in collision order
+    resetCollisionBuffers(collisions.size());
+    std::size_t iCollision = 0;
+    for (const auto& collision : collisions) {
+      collisionInputs[iCollision].clear();
+      if (jetderiveddatautilities::selectCollision(collision, eventSelection)) {
+        collisionSelected[iCollision] = true;
+        auto tracksPerCollision = tracks.sliceByCached(aod::jtrack::collisionId, collision.globalIndex(), cache);
+        jetfindingutilities::analyseTracks<decltype(tracksPerCollision), typename decltype(tracksPerCollision)::iterator>(collisionInputs[iCollision], tracksPerCollision, trackSelection);
+      }
+      iCollision++;
+    }
+    findJetsParallel(jetPtMin, jetPtMax);
+    iCollision = 0;
+    for (const auto& collision : collisions) {
+      if (collisionSelected[iCollision]) {
+        jetfindingutilities::fillJetTables(collisionOutputs[iCollision], collision, jetsTable, constituentsTable, registry.get<THn>(HIST("hJet")), fillTHnSparse);
+      }
+      iCollision++;
+    }
+  }
+  PROCESS_SWITCH(JetFinderTask, processChargedJetsParallel, "Data and reco level jet finding for charged jets, with the collisions of a dataframe clustered in parallel", false);
+
   void processChargedEvtWiseSubJets(soa::Filtered<JetCollisions>::iterator const& collision,
                                     soa::Filtered<JetTracksSub> const& tracks)
   {
@@ -185,6 +256,35 @@ struct JetFinderTask {
   }
   PROCESS_SWITCH(JetFinderTask, processFullJets, "Data and reco level jet finding for full and neutral jets", false);
 
+  void processFullJetsParallel(soa::Filtered<JetCollisions> const& collisions,
+                               soa::Filtered<JetTracks> const& tracks,
+                               soa::Filtered<JetClusters> const& clusters)
+  {
+    // the inputs are collected sequentially, the clustering is distributed over the threads and the tables are filled in collision order
+    resetCollisionBuffers(collisions.size());
+    std::size_t iCollision = 0;
+    for (const auto& collision : collisions) {
+      collisionInputs[iCollision].clear();
+      if (jetderiveddatautilities::eventEMCAL(collision)) {
+        collisionSelected[iCollision] = true;
+        auto tracksPerCollision = tracks.sliceByCached(aod::jtrack::collisionId, collision.globalIndex(), cache);
+        auto clustersPerCollision = clusters.sliceByCached(aod::jcluster::collisionId, collision.globalIndex(), cache);
+        jetfindingutilities::analyseTracks<decltype(tracksPerCollision), typename decltype(tracksPerCollision)::iterator>(collisionInputs[iCollision], tracksPerCollision, trackSelection);
+        jetfindingutilities::analyseClusters(collisionInputs[iCollision], &clustersPerCollision);
+      }
+      iCollision++;
+    }
+    findJetsParallel(jetPtMin, jetPtMax);
+    iCollision = 0;
+    for (const auto& collision : collisions) {
+      if (collisionSelected[iCollision]) {
+        jetfindingutilities::fillJetTables(collisionOutputs[iCollision], collision, jetsTable, constituentsTable, registry.get<THn>(HIST("hJet")), fillTHnSparse);
+      }
+      iCollision++;
+    }
+  }
+  PROCESS_SWITCH(JetFinderTask, processFullJetsParallel, "Data and reco level jet finding for full and neutral jets, with the collisions of a dataframe clustered in parallel", false);
+
   void processParticleLevelChargedJets(JetMcCollision const& collision, soa::Filtered<JetParticles> const& particles)
   {
     // TODO: MC event selection?
@@ -101,6 +101,8 @@ struct JetFinderHFTask {
   Configurable<int> jetRecombScheme{"jetRecombScheme", 0, "jet recombination scheme. 0 = E-scheme, 1 = pT-scheme, 2 = pT2-scheme"};
   Configurable<float> jetGhostArea{"jetGhostArea", 0.005, "jet ghost area"};
   Configurable<int> ghostRepeat{"ghostRepeat", 1, "set to 0 to gain speed if you dont need area calculation"};
+  Configurable<int> jetAreaStrategy{"jetAreaStrategy", 3, "jet area calculation. 0 = none (no ghosts), 1 = Voronoi, 2 = passive, 3 = active"};
+  Configurable<bool> jetMultiRadius{"jetMultiRadius", false, "generate the ghosts once per event and share them between all jet radii (requires ghostRepeat = 1)"};
   Configurable<float> jetAreaFractionMin{"jetAreaFractionMin", -99.0, "used to make a cut on the jet areas"};
   Configurable<int> jetPtBinWidth{"jetPtBinWidth", 5, "used to define the width of the jetPt bins for the THnSparse"};
   Configurable<bool> fillTHnSparse{"fillTHnSparse", false, "switch to fill the THnSparse"};
@@ -132,6 +134,8 @@ struct JetFinderHFTask {
     jetFinder.recombScheme = static_cast<fastjet::RecombinationScheme>(static_cast<int>(jetRecombScheme));
     jetFinder.ghostArea = jetGhostArea;
     jetFinder.ghostRepeatN = ghostRepeat;
+    jetFinder.areaStrategy = static_cast<JetAreaStrategy>(static_cast<int>(jetAreaStrategy));
+    jetFinder.isMultiRadius = jetMultiRadius;
 
     auto jetRadiiBins = (std::vector<double>)jetRadius;
     if (jetRadiiBins.size() > 1) {
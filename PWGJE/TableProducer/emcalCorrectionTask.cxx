@@ -15,10 +15,14 @@
 /// \author Florian Jonas <florian.jonas@cern.ch>
 
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <memory>
+#include <optional>
+#include <thread>
 #include <unordered_map>
 #include <cmath>
+#include <vector>
 
 #include "CCDB/BasicCCDBManager.h"
 #include "Framework/runDataProcessing.h"
@@ -61,6 +65,7 @@ struct EmcalCorrectionTask {
   Produces<o2::aod::EMCALClusterCells> clustercells; // cells belonging to given cluster
   Produces<o2::aod::EMCALAmbiguousClusterCells> clustercellsambiguous;
   Produces<o2::aod::EMCALMatchedTracks> matchedTracks;
+  Produces<o2::aod::EMCALClusterMatchedTrackSlices> clusterMatchedTrackSlices; // range of the matched tracks of each cluster
   Produces<o2::aod::EMCALMatchedCollisions> emcalcollisionmatch;
 
   // Preslices
@@ -88,6 +93,7 @@ struct EmcalCorrectionTask {
   Configurable<float> exoticCellInCrossMinAmplitude{"exoticCellInCrossMinAmplitude", 0.1, "Minimum energy of cells in cross, if lower not considered in cross"};
   Configurable<bool> useWeightExotic{"useWeightExotic", false, "States if weights should be used for exotic cell cut"};
   Configurable<bool> isMC{"isMC", false, "States if run over MC"};
+  Configurable<int> nThreadsClusterization{"nThreadsClusterization", 1, "number of threads running the clusterizers on the BCs of a dataframe"};
 
   // Require EMCAL cells (CALO type 1)
   Filter emccellfilter = aod::calo::caloType == selectedCellType;
@@ -98,12 +104,36 @@ struct EmcalCorrectionTask {
   // Clusterizer and related
   // Apparently streaming these objects really doesn't work, and causes problems for setting up the workflow.
   // So we use unique_ptr and define them below.
+  // One clusterizer per distinct set of clusterizer settings, shared by the cluster definitions which only differ otherwise
   std::vector<std::unique_ptr<o2::emcal::Clusterizer<o2::emcal::Cell>>> mClusterizers;
   o2::emcal::ClusterFactory<o2::emcal::Cell> mClusterFactories;
+  std::vector<size_t> mClusterizerForDefinition; // index of the clusterizer of each cluster definition
+  // Clusterizers and cluster factories of the additional threads of the clusterization
+  std::vector<std::vector<std::unique_ptr<o2::emcal::Clusterizer<o2::emcal::Cell>>>> mWorkerClusterizers;
+  std::vector<o2::emcal::ClusterFactory<o2::emcal::Cell>> mWorkerClusterFactories;
   o2::emcal::NonlinearityHandler mNonlinearityHandler;
   // Cells and clusters
   std::vector<o2::emcal::AnalysisCluster> mAnalysisClusters;
   std::vector<o2::emcal::ClusterLabel> mClusterLabels;
+  // Calibrated cells of a BC and the clusters found by each clusterizer, for all the BCs with cells of the dataframe
+  struct BCClusterization {
+    int64_t bcIndex = -1;
+    std::vector<o2::emcal::Cell> cells;
+    std::vector<int64_t> cellIndices;
+    std::vector<o2::emcal::CellLabel> cellLabels;
+    std::vector<std::vector<o2::emcal::AnalysisCluster>> clusters;   // per clusterizer
+    std::vector<std::vector<o2::emcal::ClusterLabel>> clusterLabels; // per clusterizer
+  };
+  std::vector<BCClusterization> mBCClusterizations; // reused between dataframes, the first mNBCClusterizations are in use
+  size_t mNBCClusterizations = 0;
+  // Track matching, buffers reused between collisions
+  std::vector<double> mTrackPhi;
+  std::vector<double> mTrackEta;
+  std::vector<int64_t> mTrackGlobalIndex;
+  std::vector<double> mClusterPhi;
+  std::vector<double> mClusterEta;
+  std::vector<int> mClusterMatchOffsets;  // matches of cluster i: mClusterMatchedTracks[mClusterMatchOffsets[i] ... mClusterMatchOffsets[i + 1] - 1]
+  std::vector<int> mClusterMatchedTracks; // matched tracks, as indices in mTrackGlobalIndex
 
   std::vector<o2::aod::EMCALClusterDefinition> mClusterDefinitions;
   // QA
@@ -140,15 +170,19 @@ struct EmcalCorrectionTask {
         mClusterDefinitions.push_back(clusDef);
       }
     }
-    mClusterFactories.setGeometry(geometry);
-    mClusterFactories.SetECALogWeight(logWeight);
-    mClusterFactories.setExoticCellFraction(exoticCellFraction);
-    mClusterFactories.setExoticCellDiffTime(exoticCellDiffTime);
-    mClusterFactories.setExoticCellMinAmplitude(exoticCellMinAmplitude);
-    mClusterFactories.setExoticCellInCrossMinAmplitude(exoticCellInCrossMinAmplitude);
-    mClusterFactories.setUseWeightExotic(useWeightExotic);
+    setupClusterFactory(mClusterFactories, geometry);
+    // cluster definitions with the same clusterizer settings share the clusterizer, the clusterization is then run once per BC for them
+    std::vector<o2::aod::EMCALClusterDefinition> clusterizerDefinitions;
     for (auto& clusterDefinition : mClusterDefinitions) {
-      mClusterizers.emplace_back(std::make_unique<o2::emcal::Clusterizer<o2::emcal::Cell>>(1E9, clusterDefinition.timeMin, clusterDefinition.timeMax, clusterDefinition.gradientCut, clusterDefinition.doGradientCut, clusterDefinition.seedEnergy, clusterDefinition.minCellEnergy));
+      size_t iClusterizer = 0;
+      while (iClusterizer < clusterizerDefinitions.size() && !hasSameClusterizerSettings(clusterizerDefinitions[iClusterizer], clusterDefinition)) {
+        iClusterizer++;
+      }
+      if (iClusterizer == clusterizerDefinitions.size()) {
+        clusterizerDefinitions.push_back(clusterDefinition);
+        mClusterizers.emplace_back(makeClusterizer(clusterDefinition));
+      }
+      mClusterizerForDefinition.push_back(iClusterizer);
       LOG(info) << "Cluster definition initialized: " << clusterDefinition.toString();
       LOG(info) << "timeMin: " << clusterDefinition.timeMin;
       LOG(info) << "timeMax: " << clusterDefinition.timeMax;
@@ -156,10 +190,21 @@ struct EmcalCorrectionTask {
       LOG(info) << "seedEnergy: " << clusterDefinition.seedEnergy;
       LOG(info) << "minCellEnergy: " << clusterDefinition.minCellEnergy;
       LOG(info) << "storageID" << clusterDefinition.storageID;
+      LOG(info) << "clusterizer: " << iClusterizer;
     }
     for (auto& clusterizer : mClusterizers) {
       clusterizer->setGeometry(geometry);
     }
+    // each additional thread gets its own copies of the clusterizers and of the cluster factory
+    for (int iThread = 1; iThread < nThreadsClusterization; iThread++) {
+      auto& clusterizers = mWorkerClusterizers.emplace_back();
+      for (auto& clusterizerDefinition : clusterizerDefinitions) {
+        clusterizers.emplace_back(makeClusterizer(clusterizerDefinition));
+        clusterizers.back()->setGeometry(geometry);
+      }
+      setupClusterFactory(mWorkerClusterFactories.emplace_back(), geometry);
+    }
+    LOG(info) << "Clusterization of " << mClusterDefinitions.size() << " cluster definitions with " << mClusterizers.size() << " clusterizers on " << (mWorkerClusterizers.size() + 1) << " threads";
 
     if (mClusterizers.size() == 0) {
       LOG(error) << "No cluster definitions specified!";
@@ -227,6 +272,7 @@ struct EmcalCorrectionTask {
     int nCellsProcessed = 0;
     std::unordered_map<uint64_t, int> numberCollsInBC; // Number of collisions mapped to the global BC index of all BCs
     std::unordered_map<uint64_t, int> numberCellsInBC; // Number of cells mapped to the global BC index of all BCs to check whether EMCal was readout
+    mNBCClusterizations = 0;
     for (auto bc : bcs) {
       LOG(debug) << "Next BC";
       // Convert aod::Calo to o2::emcal::Cell which can be used with the clusterizer.
@@ -246,8 +292,7 @@ struct EmcalCorrectionTask {
       }
       // Counters for BCs with matched collisions
       countBC(collisionsInFoundBC.size(), true);
-      std::vector<o2::emcal::Cell> cellsBC;
-      std::vector<int64_t> cellIndicesBC;
+      auto& bcClusterization = nextBCClusterization(bc.globalIndex());
       for (auto& cell : cellsInBC) {
         auto amplitude = cell.amplitude();
         if (static_cast<bool>(hasShaperCorrection)) {
@@ -256,47 +301,43 @@ struct EmcalCorrectionTask {
         if (applyCellAbsScale) {
           amplitude *= GetAbsCellScale(cell.cellNumber());
         }
-        cellsBC.emplace_back(cell.cellNumber(),
-                             amplitude,
-                             cell.time(),
-                             o2::emcal::intToChannelType(cell.cellType()));
-        cellIndicesBC.emplace_back(cell.globalIndex());
+        bcClusterization.cells.emplace_back(cell.cellNumber(),
+                                            amplitude,
+                                            cell.time(),
+                                            o2::emcal::intToChannelType(cell.cellType()));
+        bcClusterization.cellIndices.emplace_back(cell.globalIndex());
       }
-      LOG(detail) << "Number of cells for BC (CF): " << cellsBC.size();
-      nCellsProcessed += cellsBC.size();
+      LOG(detail) << "Number of cells for BC (CF): " << bcClusterization.cells.size();
+      nCellsProcessed += bcClusterization.cells.size();
 
-      fillQAHistogram(cellsBC);
+      fillQAHistogram(bcClusterization.cells);
+    } // end of bc loop
 
-      // TODO: Helpful for now, but should be removed.
-      LOG(debug) << "Converted EMCAL cells";
-      for (auto& cell : cellsBC) {
-        LOG(debug) << cell.getTower() << ": E: " << cell.getEnergy() << ", time: " << cell.getTimeStamp() << ", type: " << cell.getType();
-      }
+    //  Run the clusterizers on all the BCs with cells
+    LOG(debug) << "Running clusterizers";
+    clusterizeBCs();
 
-      LOG(debug) << "Converted cells. Contains: " << cellsBC.size() << ". Originally " << cellsInBC.size() << ". About to run clusterizer.";
-      //  this is a test
-      //  Run the clusterizers
-      LOG(debug) << "Running clusterizers";
-      for (size_t iClusterizer = 0; iClusterizer < mClusterizers.size(); iClusterizer++) {
-        cellsToCluster(iClusterizer, cellsBC);
+    // Fill the tables, in the order of the BCs
+    for (size_t iBC = 0; iBC < mNBCClusterizations; iBC++) {
+      auto& bcClusterization = mBCClusterizations[iBC];
+      auto bc = bcs.iteratorAt(bcClusterization.bcIndex);
+      auto collisionsInFoundBC = collisions.sliceBy(collisionsPerFoundBC, bcClusterization.bcIndex);
+      for (size_t iDefinition = 0; iDefinition < mClusterDefinitions.size(); iDefinition++) {
+        setAnalysisClusters(bcClusterization, iDefinition);
 
         if (collisionsInFoundBC.size() == 1) {
           // dummy loop to get the first collision
           for (const auto& col : collisionsInFoundBC) {
-            if (col.foundBCId() == bc.globalIndex()) {
+            if (col.foundBCId() == bcClusterization.bcIndex) {
               mHistManager.fill(HIST("hCollPerBC"), 1);
               mHistManager.fill(HIST("hCollisionType"), 1);
               math_utils::Point3D<float> vertex_pos = {col.posX(), col.posY(), col.posZ()};
 
-              std::vector<std::vector<int>> clusterToTrackIndexMap;
-              std::vector<std::vector<int>> trackToClusterIndexMap;
-              std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>> IndexMapPair{clusterToTrackIndexMap, trackToClusterIndexMap};
-              std::vector<int64_t> trackGlobalIndex;
-              doTrackMatching<collEventSels::filtered_iterator>(col, tracks, IndexMapPair, vertex_pos, trackGlobalIndex);
+              doTrackMatching<collEventSels::filtered_iterator>(col, tracks, vertex_pos);
 
               // Store the clusters in the table where a matching collision could
               // be identified.
-              FillClusterTable<collEventSels::filtered_iterator>(col, vertex_pos, iClusterizer, cellIndicesBC, IndexMapPair, trackGlobalIndex);
+              FillClusterTable<collEventSels::filtered_iterator>(col, vertex_pos, iDefinition, bcClusterization.cellIndices, true);
             }
           }
         } else { // ambiguous
@@ -309,11 +350,11 @@ struct EmcalCorrectionTask {
             hasCollision = true;
             mHistManager.fill(HIST("hCollisionType"), 2);
           }
-          FillAmbigousClusterTable<bcEvSels::iterator>(bc, iClusterizer, cellIndicesBC, hasCollision);
+          FillAmbigousClusterTable(bc, iDefinition, bcClusterization.cellIndices, hasCollision);
         }
 
-        LOG(debug) << "Cluster loop done for clusterizer " << iClusterizer;
-      } // end of clusterizer loop
+        LOG(debug) << "Cluster loop done for cluster definition " << iDefinition;
+      } // end of cluster definition loop
       LOG(debug) << "Done with process BC.";
       nBCsProcessed++;
     } // end of bc loop
@@ -342,6 +383,7 @@ struct EmcalCorrectionTask {
     int nCellsProcessed = 0;
     std::unordered_map<uint64_t, int> numberCollsInBC; // Number of collisions mapped to the global BC index of all BCs
     std::unordered_map<uint64_t, int> numberCellsInBC; // Number of cells mapped to the global BC index of all BCs to check whether EMCal was readout
+    mNBCClusterizations = 0;
     for (auto bc : bcs) {
       LOG(debug) << "Next BC";
       // Convert aod::Calo to o2::emcal::Cell which can be used with the clusterizer.
@@ -361,9 +403,7 @@ struct EmcalCorrectionTask {
       }
       // Counters for BCs with matched collisions
       countBC(collisionsInFoundBC.size(), true);
-      std::vector<o2::emcal::Cell> cellsBC;
-      std::vector<int64_t> cellIndicesBC;
-      std::vector<o2::emcal::CellLabel> cellLabels;
+      auto& bcClusterization = nextBCClusterization(bc.globalIndex());
       for (auto& cell : cellsInBC) {
         mHistManager.fill(HIST("hContributors"), cell.mcParticle_as<aod::StoredMcParticles_001>().size());
         auto cellParticles = cell.mcParticle_as<aod::StoredMcParticles_001>();
@@ -374,48 +414,44 @@ struct EmcalCorrectionTask {
         if (static_cast<bool>(hasShaperCorrection)) {
           amplitude = o2::emcal::NonlinearityHandler::evaluateShaperCorrectionCellEnergy(amplitude);
         }
-        cellsBC.emplace_back(cell.cellNumber(),
-                             amplitude,
-                             cell.time(),
-                             o2::emcal::intToChannelType(cell.cellType()));
-        cellIndicesBC.emplace_back(cell.globalIndex());
-        cellLabels.emplace_back(cell.mcParticleIds(), cell.amplitudeA());
+        bcClusterization.cells.emplace_back(cell.cellNumber(),
+                                            amplitude,
+                                            cell.time(),
+                                            o2::emcal::intToChannelType(cell.cellType()));
+        bcClusterization.cellIndices.emplace_back(cell.globalIndex());
+        bcClusterization.cellLabels.emplace_back(cell.mcParticleIds(), cell.amplitudeA());
       }
-      LOG(detail) << "Number of cells for BC (CF): " << cellsBC.size();
-      nCellsProcessed += cellsBC.size();
+      LOG(detail) << "Number of cells for BC (CF): " << bcClusterization.cells.size();
+      nCellsProcessed += bcClusterization.cells.size();
 
-      fillQAHistogram(cellsBC);
+      fillQAHistogram(bcClusterization.cells);
+    } // end of bc loop
 
-      // TODO: Helpful for now, but should be removed.
-      LOG(debug) << "Converted EMCAL cells";
-      for (auto& cell : cellsBC) {
-        LOG(debug) << cell.getTower() << ": E: " << cell.getEnergy() << ", time: " << cell.getTimeStamp() << ", type: " << cell.getType();
-      }
+    //  Run the clusterizers on all the BCs with cells
+    LOG(debug) << "Running clusterizers";
+    clusterizeBCs();
 
-      LOG(debug) << "Converted cells. Contains: " << cellsBC.size() << ". Originally " << cellsInBC.size() << ". About to run clusterizer.";
-      //  this is a test
-      //  Run the clusterizers
-      LOG(debug) << "Running clusterizers";
-      for (size_t iClusterizer = 0; iClusterizer < mClusterizers.size(); iClusterizer++) {
-        cellsToCluster(iClusterizer, cellsBC, cellLabels);
+    // Fill the tables, in the order of the BCs
+    for (size_t iBC = 0; iBC < mNBCClusterizations; iBC++) {
+      auto& bcClusterization = mBCClusterizations[iBC];
+      auto bc = bcs.iteratorAt(bcClusterization.bcIndex);
+      auto collisionsInFoundBC = collisions.sliceBy(collisionsPerFoundBC, bcClusterization.bcIndex);
+      for (size_t iDefinition = 0; iDefinition < mClusterDefinitions.size(); iDefinition++) {
+        setAnalysisClusters(bcClusterization, iDefinition);
 
         if (collisionsInFoundBC.size() == 1) {
           // dummy loop to get the first collision
           for (const auto& col : collisionsInFoundBC) {
-            if (col.foundBCId() == bc.globalIndex()) {
+            if (col.foundBCId() == bcClusterization.bcIndex) {
               mHistManager.fill(HIST("hCollPerBC"), 1);
               mHistManager.fill(HIST("hCollisionType"), 1);
               math_utils::Point3D<float> vertex_pos = {col.posX(), col.posY(), col.posZ()};
 
-              std::vector<std::vector<int>> clusterToTrackIndexMap;
-              std::vector<std::vector<int>> trackToClusterIndexMap;
-              std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>> IndexMapPair{clusterToTrackIndexMap, trackToClusterIndexMap};
-              std::vector<int64_t> trackGlobalIndex;
-              doTrackMatching<collEventSels::filtered_iterator>(col, tracks, IndexMapPair, vertex_pos, trackGlobalIndex);
+              doTrackMatching<collEventSels::filtered_iterator>(col, tracks, vertex_pos);
 
               // Store the clusters in the table where a matching collision could
               // be identified.
-              FillClusterTable<collEventSels::filtered_iterator>(col, vertex_pos, iClusterizer, cellIndicesBC, IndexMapPair, trackGlobalIndex);
+              FillClusterTable<collEventSels::filtered_iterator>(col, vertex_pos, iDefinition, bcClusterization.cellIndices, true);
             }
           }
         } else { // ambiguous
@@ -428,10 +464,10 @@ struct EmcalCorrectionTask {
             hasCollision = true;
             mHistManager.fill(HIST("hCollisionType"), 2);
           }
-          FillAmbigousClusterTable<bcEvSels::iterator>(bc, iClusterizer, cellIndicesBC, hasCollision);
+          FillAmbigousClusterTable(bc, iDefinition, bcClusterization.cellIndices, hasCollision);
         }
-        LOG(debug) << "Cluster loop done for clusterizer " << iClusterizer;
-      } // end of clusterizer loop
+        LOG(debug) << "Cluster loop done for cluster definition " << iDefinition;
+      } // end of cluster definition loop
       LOG(debug) << "Done with process BC.";
       nBCsProcessed++;
     } // end of bc loop
@@ -456,6 +492,7 @@ struct EmcalCorrectionTask {
     LOG(debug) << "Starting process standalone.";
     int nBCsProcessed = 0;
     int nCellsProcessed = 0;
+    mNBCClusterizations = 0;
     for (auto bc : bcs) {
       LOG(debug) << "Next BC";
       // Convert aod::Calo to o2::emcal::Cell which can be used with the clusterizer.
@@ -473,33 +510,31 @@ struct EmcalCorrectionTask {
       }
       // Counters for BCs with matched collisions
       countBC(collisionsInBC.size(), true);
-      std::vector<o2::emcal::Cell> cellsBC;
-      std::vector<int64_t> cellIndicesBC;
+      auto& bcClusterization = nextBCClusterization(bc.globalIndex());
       for (auto& cell : cellsInBC) {
-        cellsBC.emplace_back(cell.cellNumber(),
-                             cell.amplitude(),
-                             cell.time(),
-                             o2::emcal::intToChannelType(cell.cellType()));
-        cellIndicesBC.emplace_back(cell.globalIndex());
+        bcClusterization.cells.emplace_back(cell.cellNumber(),
+                                            cell.amplitude(),
+                                            cell.time(),
+                                            o2::emcal::intToChannelType(cell.cellType()));
+        bcClusterization.cellIndices.emplace_back(cell.globalIndex());
       }
-      LOG(detail) << "Number of cells for BC (CF): " << cellsBC.size();
-      nCellsProcessed += cellsBC.size();
+      LOG(detail) << "Number of cells for BC (CF): " << bcClusterization.cells.size();
+      nCellsProcessed += bcClusterization.cells.size();
 
-      fillQAHistogram(cellsBC);
-
-      // TODO: Helpful for now, but should be removed.
-      LOG(debug) << "Converted EMCAL cells";
-      for (auto& cell : cellsBC) {
-        LOG(debug) << cell.getTower() << ": E: " << cell.getEnergy() << ", time: " << cell.getTimeStamp() << ", type: " << cell.getType();
-      }
+      fillQAHistogram(bcClusterization.cells);
+    } // end of bc loop
 
-      LOG(debug) << "Converted cells. Contains: " << cellsBC.size() << ". Originally " << cellsInBC.size() << ". About to run clusterizer.";
+    //  Run the clusterizers on all the BCs with cells
+    LOG(debug) << "Running clusterizers";
+    clusterizeBCs();
 
-      //  this is a test
-      //  Run the clusterizers
-      LOG(debug) << "Running clusterizers";
-      for (size_t iClusterizer = 0; iClusterizer < mClusterizers.size(); iClusterizer++) {
-        cellsToCluster(iClusterizer, cellsBC);
+    // Fill the tables, in the order of the BCs
+    for (size_t iBC = 0; iBC < mNBCClusterizations; iBC++) {
+      auto& bcClusterization = mBCClusterizations[iBC];
+      auto bc = bcs.iteratorAt(bcClusterization.bcIndex);
+      auto collisionsInBC = collisions.sliceBy(collisionsPerBC, bcClusterization.bcIndex);
+      for (size_t iDefinition = 0; iDefinition < mClusterDefinitions.size(); iDefinition++) {
+        setAnalysisClusters(bcClusterization, iDefinition);
 
         if (collisionsInBC.size() == 1) {
           // dummy loop to get the first collision
@@ -510,7 +545,7 @@ struct EmcalCorrectionTask {
 
             // Store the clusters in the table where a matching collision could
             // be identified.
-            FillClusterTable<aod::Collision>(col, vertex_pos, iClusterizer, cellIndicesBC);
+            FillClusterTable<aod::Collision>(col, vertex_pos, iDefinition, bcClusterization.cellIndices);
           }
         } else { // ambiguous
           // LOG(warning) << "No vertex found for event. Assuming (0,0,0).";
@@ -522,56 +557,108 @@ struct EmcalCorrectionTask {
             hasCollision = true;
             mHistManager.fill(HIST("hCollisionType"), 2);
           }
-          FillAmbigousClusterTable<aod::BC>(bc, iClusterizer, cellIndicesBC, hasCollision);
+          FillAmbigousClusterTable(bc, iDefinition, bcClusterization.cellIndices, hasCollision);
         }
 
-        LOG(debug) << "Cluster loop done for clusterizer " << iClusterizer;
-      } // end of clusterizer loop
-      LOG(detail) << "Processed " << nBCsProcessed << " BCs with " << nCellsProcessed << " cells";
+        LOG(debug) << "Cluster loop done for cluster definition " << iDefinition;
+      } // end of cluster definition loop
       nBCsProcessed++;
     } // end of bc loop
-    LOG(debug) << "Done with process BC.";
+    LOG(detail) << "Processed " << nBCsProcessed << " BCs with " << nCellsProcessed << " cells";
   }
   PROCESS_SWITCH(EmcalCorrectionTask, processStandalone, "run stand alone analysis", false);
 
-  void cellsToCluster(size_t iClusterizer, const gsl::span<o2::emcal::Cell> cellsBC, std::optional<const gsl::span<o2::emcal::CellLabel>> cellLabels = std::nullopt)
+  /// Next entry of the per-BC clusterization buffers, reusing the memory of the previous dataframes
+  BCClusterization& nextBCClusterization(int64_t bcIndex)
   {
-    mClusterizers.at(iClusterizer)->findClusters(cellsBC);
+    if (mNBCClusterizations == mBCClusterizations.size()) {
+      mBCClusterizations.emplace_back();
+    }
+    auto& bcClusterization = mBCClusterizations[mNBCClusterizations++];
+    bcClusterization.bcIndex = bcIndex;
+    bcClusterization.cells.clear();
+    bcClusterization.cellIndices.clear();
+    bcClusterization.cellLabels.clear();
+    return bcClusterization;
+  }
 
-    auto emcalClusters = mClusterizers.at(iClusterizer)->getFoundClusters();
-    auto emcalClustersInputIndices = mClusterizers.at(iClusterizer)->getFoundClustersInputIndices();
-    LOG(debug) << "Retrieved results. About to setup cluster factory.";
+  /// Runs the clusterizers on the collected BCs, distributed over the worker threads (each with its own clusterizers and cluster factory)
+  void clusterizeBCs()
+  {
+    std::atomic<size_t> nextBC{0};
+    auto worker = [&](std::vector<std::unique_ptr<o2::emcal::Clusterizer<o2::emcal::Cell>>>& clusterizers, o2::emcal::ClusterFactory<o2::emcal::Cell>& clusterFactory) {
+      for (size_t iBC = nextBC++; iBC < mNBCClusterizations; iBC = nextBC++) {
+        auto& bcClusterization = mBCClusterizations[iBC];
+        bcClusterization.clusters.resize(clusterizers.size());
+        bcClusterization.clusterLabels.resize(clusterizers.size());
+        for (size_t iClusterizer = 0; iClusterizer < clusterizers.size(); iClusterizer++) {
+          cellsToCluster(*clusterizers[iClusterizer], clusterFactory, bcClusterization, iClusterizer);
+        }
+      }
+    };
+    std::vector<std::thread> threads;
+    if (mNBCClusterizations > 1) {
+      for (size_t iThread = 0; iThread < mWorkerClusterizers.size(); iThread++) {
+        threads.emplace_back(worker, std::ref(mWorkerClusterizers[iThread]), std::ref(mWorkerClusterFactories[iThread]));
+      }
+    }
+    worker(mClusterizers, mClusterFactories);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  /// Clusterizes the cells of a BC and converts the clusters to analysis clusters
+  /// \note Only touches the given clusterizer, cluster factory and BC buffers, so it can run concurrently for different BCs
+  static void cellsToCluster(o2::emcal::Clusterizer<o2::emcal::Cell>& clusterizer, o2::emcal::ClusterFactory<o2::emcal::Cell>& clusterFactory, BCClusterization& bcClusterization, size_t iClusterizer)
+  {
+    const gsl::span<o2::emcal::Cell> cellsBC = bcClusterization.cells;
+    clusterizer.findClusters(cellsBC);
+
+    auto emcalClusters = clusterizer.getFoundClusters();
+    auto emcalClustersInputIndices = clusterizer.getFoundClustersInputIndices();
 
     // Convert to analysis clusters.
     // First, the cluster factory requires cluster and cell information in order
     // to build the clusters.
-    mAnalysisClusters.clear();
-    mClusterLabels.clear();
-    mClusterFactories.reset();
-    if (cellLabels) {
-      mClusterFactories.setContainer(*emcalClusters, cellsBC, *emcalClustersInputIndices, cellLabels);
+    auto& analysisClusters = bcClusterization.clusters[iClusterizer];
+    auto& clusterLabels = bcClusterization.clusterLabels[iClusterizer];
+    analysisClusters.clear();
+    clusterLabels.clear();
+    clusterFactory.reset();
+    if (bcClusterization.cellLabels.size() > 0) {
+      std::optional<const gsl::span<o2::emcal::CellLabel>> cellLabels{gsl::span<o2::emcal::CellLabel>(bcClusterization.cellLabels)};
+      clusterFactory.setContainer(*emcalClusters, cellsBC, *emcalClustersInputIndices, cellLabels);
     } else {
-      mClusterFactories.setContainer(*emcalClusters, cellsBC, *emcalClustersInputIndices);
+      clusterFactory.setContainer(*emcalClusters, cellsBC, *emcalClustersInputIndices);
     }
 
-    LOG(debug) << "Cluster factory set up.";
     // Convert to analysis clusters.
-    for (int icl = 0; icl < mClusterFactories.getNumberOfClusters(); icl++) {
+    for (int icl = 0; icl < clusterFactory.getNumberOfClusters(); icl++) {
       o2::emcal::ClusterLabel clusterLabel;
-      auto analysisCluster = mClusterFactories.buildCluster(icl, &clusterLabel);
-      mAnalysisClusters.emplace_back(analysisCluster);
-      mClusterLabels.push_back(clusterLabel);
-      LOG(debug) << "Cluster " << icl << ": E: " << analysisCluster.E()
-                 << ", NCells " << analysisCluster.getNCells();
+      analysisClusters.emplace_back(clusterFactory.buildCluster(icl, &clusterLabel));
+      clusterLabels.push_back(clusterLabel);
     }
-    LOG(debug) << "Converted to analysis clusters.";
+  }
+
+  /// Sets the analysis clusters of the given cluster definition in the BC as input of the track matching and of the table filling
+  void setAnalysisClusters(BCClusterization const& bcClusterization, size_t iDefinition)
+  {
+    const auto iClusterizer = mClusterizerForDefinition[iDefinition];
+    mAnalysisClusters.assign(bcClusterization.clusters[iClusterizer].begin(), bcClusterization.clusters[iClusterizer].end());
+    mClusterLabels.assign(bcClusterization.clusterLabels[iClusterizer].begin(), bcClusterization.clusterLabels[iClusterizer].end());
+    LOG(debug) << "Cluster definition " << iDefinition << ": " << mAnalysisClusters.size() << " clusters";
   }
 
   template <typename Collision>
-  void FillClusterTable(Collision const& col, math_utils::Point3D<float> const& vertex_pos, size_t iClusterizer, const gsl::span<int64_t> cellIndicesBC, std::optional<std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>>> const& IndexMapPair = std::nullopt, std::optional<std::vector<int64_t>> const& trackGlobalIndex = std::nullopt)
+  void FillClusterTable(Collision const& col, math_utils::Point3D<float> const& vertex_pos, size_t iDefinition, const gsl::span<int64_t> cellIndicesBC, bool hasTrackMatching = false)
   {
     // we found a collision, put the clusters into the none ambiguous table
     clusters.reserve(mAnalysisClusters.size());
+    clusterMatchedTrackSlices.reserve(mAnalysisClusters.size());
+    if (hasTrackMatching) {
+      matchedTracks.reserve(mClusterMatchedTracks.size());
+    }
     if (mClusterLabels.size() > 0) {
       mcclusters.reserve(mClusterLabels.size());
     }
@@ -596,7 +683,7 @@ struct EmcalCorrectionTask {
 
       // save to table
       LOG(debug) << "Writing cluster definition "
-                 << static_cast<int>(mClusterDefinitions.at(iClusterizer))
+                 << static_cast<int>(mClusterDefinitions.at(iDefinition))
                  << " to table.";
       mHistManager.fill(HIST("hClusterType"), 1);
       clusters(col, cluster.getID(), nonlinCorrEnergy, cluster.getCoreEnergy(), cluster.E(),
@@ -604,7 +691,7 @@ struct EmcalCorrectionTask {
                cluster.getM20(), cluster.getNCells(),
                cluster.getClusterTime(), cluster.getIsExotic(),
                cluster.getDistanceToBadChannel(), cluster.getNExMax(),
-               static_cast<int>(mClusterDefinitions.at(iClusterizer)));
+               static_cast<int>(mClusterDefinitions.at(iDefinition)));
       if (mClusterLabels.size() > 0) {
         mcclusters(mClusterLabels[iCluster].getLabels(), mClusterLabels[iCluster].getEnergyFractions());
       }
@@ -618,20 +705,23 @@ struct EmcalCorrectionTask {
       // fill histograms
       mHistManager.fill(HIST("hClusterE"), cluster.E());
       mHistManager.fill(HIST("hClusterEtaPhi"), pos.Eta(), TVector2::Phi_0_2pi(pos.Phi()));
-      if (IndexMapPair && trackGlobalIndex) {
-        for (unsigned int iTrack = 0; iTrack < std::get<0>(*IndexMapPair)[iCluster].size(); iTrack++) {
-          if (std::get<0>(*IndexMapPair)[iCluster][iTrack] >= 0) {
-            LOG(debug) << "Found track " << (*trackGlobalIndex)[std::get<0>(*IndexMapPair)[iCluster][iTrack]] << " in cluster " << cluster.getID();
-            matchedTracks(clusters.lastIndex(), (*trackGlobalIndex)[std::get<0>(*IndexMapPair)[iCluster][iTrack]]);
-          }
+      // matched tracks, stored contiguously for the cluster, and their range in the matched track table
+      int slice[2] = {-1, -1};
+      if (hasTrackMatching && mClusterMatchOffsets[iCluster + 1] > mClusterMatchOffsets[iCluster]) {
+        slice[0] = matchedTracks.lastIndex() + 1;
+        for (int iMatch = mClusterMatchOffsets[iCluster]; iMatch < mClusterMatchOffsets[iCluster + 1]; iMatch++) {
+          LOG(debug) << "Found track " << mTrackGlobalIndex[mClusterMatchedTracks[iMatch]] << " in cluster " << cluster.getID();
+          matchedTracks(clusters.lastIndex(), mTrackGlobalIndex[mClusterMatchedTracks[iMatch]]);
         }
+        slice[1] = matchedTracks.lastIndex();
       }
+      clusterMatchedTrackSlices(slice);
       iCluster++;
     } // end of cluster loop
   }
 
   template <typename BC>
-  void FillAmbigousClusterTable(BC const& bc, size_t iClusterizer, const gsl::span<int64_t> cellIndicesBC, bool hasCollision)
+  void FillAmbigousClusterTable(BC const& bc, size_t iDefinition, const gsl::span<int64_t> cellIndicesBC, bool hasCollision)
   {
     int cellindex = -1;
     clustersAmbiguous.reserve(mAnalysisClusters.size());
@@ -662,7 +752,7 @@ struct EmcalCorrectionTask {
         pos.Eta(), TVector2::Phi_0_2pi(pos.Phi()), cluster.getM02(),
         cluster.getM20(), cluster.getNCells(), cluster.getClusterTime(),
         cluster.getIsExotic(), cluster.getDistanceToBadChannel(),
-        cluster.getNExMax(), static_cast<int>(mClusterDefinitions.at(iClusterizer)));
+        cluster.getNExMax(), static_cast<int>(mClusterDefinitions.at(iDefinition)));
       clustercellsambiguous.reserve(cluster.getNCells());
       for (int ncell = 0; ncell < cluster.getNCells(); ncell++) {
         cellindex = cluster.getCellIndex(ncell);
@@ -673,23 +763,16 @@ struct EmcalCorrectionTask {
   }
 
   template <typename Collision>
-  void doTrackMatching(Collision const& col, myGlobTracks const& tracks, std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>>& IndexMapPair, math_utils::Point3D<float>& vertex_pos, std::vector<int64_t>& trackGlobalIndex)
+  void doTrackMatching(Collision const& col, myGlobTracks const& tracks, math_utils::Point3D<float>& vertex_pos)
   {
     auto groupedTracks = tracks.sliceBy(perCollision, col.globalIndex());
-    int NTracksInCol = groupedTracks.size();
-    std::vector<double> trackPhi;
-    std::vector<double> trackEta;
-    // reserve memory to reduce on the fly memory allocation
-    trackPhi.reserve(NTracksInCol);
-    trackEta.reserve(NTracksInCol);
-    trackGlobalIndex.reserve(NTracksInCol);
-    FillTrackInfo<decltype(groupedTracks)>(groupedTracks, trackPhi, trackEta, trackGlobalIndex);
-
-    int NClusterInCol = mAnalysisClusters.size();
-    std::vector<double> clusterPhi;
-    std::vector<double> clusterEta;
-    clusterPhi.reserve(NClusterInCol);
-    clusterEta.reserve(NClusterInCol);
+    mTrackPhi.clear();
+    mTrackEta.clear();
+    mTrackGlobalIndex.clear();
+    FillTrackInfo<decltype(groupedTracks)>(groupedTracks, mTrackPhi, mTrackEta, mTrackGlobalIndex);
+
+    mClusterPhi.clear();
+    mClusterEta.clear();
 
     // TODO one loop that could in principle be combined with the other
     // loop to improve performance
@@ -700,13 +783,14 @@ struct EmcalCorrectionTask {
       pos = pos - vertex_pos;
       // Normalize the vector and rescale by energy.
       pos *= (cluster.E() / std::sqrt(pos.Mag2()));
-      clusterPhi.emplace_back(TVector2::Phi_0_2pi(pos.Phi()));
-      clusterEta.emplace_back(pos.Eta());
+      mClusterPhi.emplace_back(TVector2::Phi_0_2pi(pos.Phi()));
+      mClusterEta.emplace_back(pos.Eta());
     }
-    IndexMapPair =
-      jetutilities::MatchClustersAndTracks(clusterPhi, clusterEta,
-                                           trackPhi, trackEta,
-                                           maxMatchingDistance, 20);
+    // same matches as jetutilities::MatchClustersAndTracks, from a grid of the clusters instead of the kd-trees
+    jetutilities::MatchClustersAndTracksGrid(mClusterPhi, mClusterEta,
+                                             mTrackPhi, mTrackEta,
+                                             maxMatchingDistance, 20,
+                                             mClusterMatchOffsets, mClusterMatchedTracks);
   }
 
   template <typename Tracks>
@@ -736,6 +820,27 @@ struct EmcalCorrectionTask {
     mHistManager.fill(HIST("hGlobalTrackMult"), NTrack);
   }
 
+  static bool hasSameClusterizerSettings(o2::aod::EMCALClusterDefinition const& lhs, o2::aod::EMCALClusterDefinition const& rhs)
+  {
+    return lhs.algorithm == rhs.algorithm && lhs.seedEnergy == rhs.seedEnergy && lhs.minCellEnergy == rhs.minCellEnergy && lhs.timeMin == rhs.timeMin && lhs.timeMax == rhs.timeMax && lhs.doGradientCut == rhs.doGradientCut && lhs.gradientCut == rhs.gradientCut;
+  }
+
+  static std::unique_ptr<o2::emcal::Clusterizer<o2::emcal::Cell>> makeClusterizer(o2::aod::EMCALClusterDefinition const& clusterDefinition)
+  {
+    return std::make_unique<o2::emcal::Clusterizer<o2::emcal::Cell>>(1E9, clusterDefinition.timeMin, clusterDefinition.timeMax, clusterDefinition.gradientCut, clusterDefinition.doGradientCut, clusterDefinition.seedEnergy, clusterDefinition.minCellEnergy);
+  }
+
+  void setupClusterFactory(o2::emcal::ClusterFactory<o2::emcal::Cell>& clusterFactory, o2::emcal::Geometry* geometry)
+  {
+    clusterFactory.setGeometry(geometry);
+    clusterFactory.SetECALogWeight(logWeight);
+    clusterFactory.setExoticCellFraction(exoticCellFraction);
+    clusterFactory.setExoticCellDiffTime(exoticCellDiffTime);
+    clusterFactory.setExoticCellMinAmplitude(exoticCellMinAmplitude);
+    clusterFactory.setExoticCellInCrossMinAmplitude(exoticCellInCrossMinAmplitude);
+    clusterFactory.setUseWeightExotic(useWeightExotic);
+  }
+
   void countBC(int numberOfCollisions, bool hasEMCcells)
   {
     int emcDataOffset = hasEMCcells ? 0 : 3;
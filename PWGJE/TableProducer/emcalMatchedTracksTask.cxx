@@ -54,7 +54,7 @@ using namespace o2::framework::expressions;
 using myCollisions = o2::soa::Join<o2::aod::Collisions, o2::aod::EvSels>;
 using myCollision = myCollisions::iterator;
 using myBCs = o2::soa::Join<o2::aod::BCsWithTimestamps, o2::aod::BcSels>;
-using selectedClusters = o2::soa::Filtered<o2::aod::EMCALClusters>;
+using selectedClusters = o2::soa::Filtered<o2::soa::Join<o2::aod::EMCALClusters, o2::aod::EMCALClusterMatchedTrackSlices>>;
 using myTracksPID = o2::soa::Filtered<o2::soa::Join<o2::aod::pidTPCFullEl, o2::aod::pidTPCFullPi, o2::aod::pidTOFFullEl, o2::aod::pidTOFFullPi, o2::aod::FullTracks, o2::aod::TracksCov, o2::aod::TrackSelection>>;
 
 struct EmcalMatchedTracksTask {
@@ -63,8 +63,6 @@ struct EmcalMatchedTracksTask {
   HistogramRegistry mHistManager{"EmcalMatchedTracksHistograms", {}, OutputObjHandlingPolicy::AnalysisObject};
   o2::emcal::Geometry* mGeometry = nullptr;
 
-  Preslice<o2::aod::EMCALMatchedTracks> perClusterMatchedTracks = o2::aod::emcalclustercell::emcalclusterId;
-
   // configurable parameters
   Configurable<bool> mDoEventSel{"doEventSel", 0, "demand kINT7"};
   Configurable<double> mVertexCut{"vertexCut", 10., "apply z-vertex cut with value in cm"};
@@ -142,7 +140,7 @@ struct EmcalMatchedTracksTask {
     }
     // loop over all clusters from accepted collision
     for (const auto& cluster : clusters) {
-      auto tracksofcluster = matchedtracks.sliceBy(perClusterMatchedTracks, cluster.globalIndex());
+      auto tracksofcluster = cluster.matchedTracks_as<o2::aod::EMCALMatchedTracks>();
       // skip clusters with no matched tracks!
       if (tracksofcluster.size() == 0) {
         continue;
@@ -47,6 +47,7 @@ struct eventWiseConstituentSubtractorTask {
   Configurable<float> rMax{"rMax", 0.24, "maximum distance of subtraction"};
   Configurable<float> eventEtaMax{"eventEtaMax", 0.9, "maximum pseudorapidity of event"};
   Configurable<bool> doRhoMassSub{"doRhoMassSub", true, "perfom mass subtraction as well"};
+  Configurable<bool> useGridSubtraction{"useGridSubtraction", false, "pair the particles only with the ghosts of the grid cells within rMax (JetBkgSubUtils::doEventConstSubGrid)"};
 
   JetBkgSubUtils eventWiseConstituentSubtractor;
   float bkgPhiMax_;
@@ -69,6 +70,14 @@ struct eventWiseConstituentSubtractorTask {
   Preslice<aod::BkgLcRhos> perLcCandidate = aod::bkglc::candidateId;
   Preslice<aod::BkgBplusRhos> perBplusCandidate = aod::bkgbplus::candidateId;
 
+  std::vector<fastjet::PseudoJet> subtractEvent(double rho, double rhoM)
+  {
+    if (useGridSubtraction) {
+      return eventWiseConstituentSubtractor.doEventConstSubGrid(inputParticles, rho, rhoM);
+    }
+    return eventWiseConstituentSubtractor.JetBkgSubUtils::doEventConstSub(inputParticles, rho, rhoM);
+  }
+
   template <typename T, typename U, typename V, typename M>
   void analyseHF(T const& tracks, U const& candidates, V const& bkgRhos, M& trackSubtractedTable)
   {
@@ -82,7 +91,7 @@ struct eventWiseConstituentSubtractorTask {
       tracksSubtracted.clear();
       jetfindingutilities::analyseTracks(inputParticles, tracks, trackSelection, std::optional{candidate});
 
-      tracksSubtracted = eventWiseConstituentSubtractor.JetBkgSubUtils::doEventConstSub(inputParticles, bkgRho.rho(), bkgRho.rhoM());
+      tracksSubtracted = subtractEvent(bkgRho.rho(), bkgRho.rhoM());
       for (auto const& trackSubtracted : tracksSubtracted) {
 
         trackSubtractedTable(candidate.globalIndex(), trackSubtracted.pt(), trackSubtracted.eta(), trackSubtracted.phi(), trackSubtracted.E(), jetderiveddatautilities::setSingleTrackSelectionBit(trackSelection));
@@ -97,7 +106,7 @@ struct eventWiseConstituentSubtractorTask {
     tracksSubtracted.clear();
     jetfindingutilities::analyseTracks<soa::Filtered<JetTracks>, soa::Filtered<JetTracks>::iterator>(inputParticles, tracks, trackSelection);
 
-    tracksSubtracted = eventWiseConstituentSubtractor.JetBkgSubUtils::doEventConstSub(inputParticles, collision.rho(), collision.rhoM());
+    tracksSubtracted = subtractEvent(collision.rho(), collision.rhoM());
 
     for (auto const& trackSubtracted : tracksSubtracted) {
       trackSubtractedTable(collision.globalIndex(), trackSubtracted.pt(), trackSubtracted.eta(), trackSubtracted.phi(), trackSubtracted.E(), jetderiveddatautilities::setSingleTrackSelectionBit(trackSelection));
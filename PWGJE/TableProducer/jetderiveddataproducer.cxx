@@ -75,99 +75,151 @@ struct JetDerivedDataProducerTask {
 
   Service<o2::framework::O2DatabasePDG> pdgDatabase;
 
+  // the process functions below loop over the whole tables: the cursors are reserved once per dataframe and
+  // the mother indices of the particles reuse one buffer, instead of one process call and one allocation per row
+  std::vector<int> mothersId;
+
+  // fills mothersId and daughtersId of a particle for the particle tables
+  template <typename T>
+  void setFamilyIds(T const& particle, int (&daughtersId)[2])
+  {
+    mothersId.clear();
+    if (particle.has_mothers()) {
+      auto mothersIdTemps = particle.mothersIds();
+      for (auto mothersIdTemp : mothersIdTemps) {
+        mothersId.push_back(mothersIdTemp);
+      }
+    }
+    daughtersId[0] = -1;
+    daughtersId[1] = -1;
+    auto i = 0;
+    if (particle.has_daughters()) {
+      for (auto daughterId : particle.daughtersIds()) {
+        if (i > 1) {
+          break;
+        }
+        daughtersId[i] = daughterId;
+        i++;
+      }
+    }
+  }
+
+  template <typename T>
+  void fillCollisionIndices(T const& collisions)
+  {
+    jCollisionsParentIndexTable.reserve(collisions.size());
+    jCollisionsBunchCrossingIndexTable.reserve(collisions.size());
+    for (auto const& collision : collisions) {
+      jCollisionsParentIndexTable(collision.globalIndex());
+      jCollisionsBunchCrossingIndexTable(collision.bcId());
+    }
+  }
+
   void init(InitContext const&)
   {
   }
 
-  void processBunchCrossings(soa::Join<aod::BCs, aod::Timestamps>::iterator const& bc)
+  void processBunchCrossings(soa::Join<aod::BCs, aod::Timestamps> const& bcs)
   {
-    jBCsTable(bc.runNumber(), bc.globalBC(), bc.timestamp());
-    jBCParentIndexTable(bc.globalIndex());
+    jBCsTable.reserve(bcs.size());
+    jBCParentIndexTable.reserve(bcs.size());
+    for (auto const& bc : bcs) {
+      jBCsTable(bc.runNumber(), bc.globalBC(), bc.timestamp());
+      jBCParentIndexTable(bc.globalIndex());
+    }
   }
   PROCESS_SWITCH(JetDerivedDataProducerTask, processBunchCrossings, "produces derived bunch crossing table", false);
 
-  void processCollisions(soa::Join<aod::Collisions, aod::EvSels, aod::FT0Mults, aod::CentFT0Cs>::iterator const& collision)
+  void processCollisions(soa::Join<aod::Collisions, aod::EvSels, aod::FT0Mults, aod::CentFT0Cs> const& collisions)
   {
-    jCollisionsTable(collision.posX(), collision.posY(), collision.posZ(), collision.multFT0C(), collision.centFT0C(), jetderiveddatautilities::setEventSelectionBit(collision), collision.alias_raw()); // note change multFT0C to multFT0M when problems with multFT0A are fixed
-    jCollisionsParentIndexTable(collision.globalIndex());
-    jCollisionsBunchCrossingIndexTable(collision.bcId());
+    jCollisionsTable.reserve(collisions.size());
+    for (auto const& collision : collisions) {
+      jCollisionsTable(collision.posX(), collision.posY(), collision.posZ(), collision.multFT0C(), collision.centFT0C(), jetderiveddatautilities::setEventSelectionBit(collision), collision.alias_raw()); // note change multFT0C to multFT0M when problems with multFT0A are fixed
+    }
+    fillCollisionIndices(collisions);
   }
   PROCESS_SWITCH(JetDerivedDataProducerTask, processCollisions, "produces derived collision tables", true);
 
-  void processCollisionsWithoutCentralityAndMultiplicity(soa::Join<aod::Collisions, aod::EvSels>::iterator const& collision)
+  void processCollisionsWithoutCentralityAndMultiplicity(soa::Join<aod::Collisions, aod::EvSels> const& collisions)
   {
-    jCollisionsTable(collision.posX(), collision.posY(), collision.posZ(), -1.0, -1.0, jetderiveddatautilities::setEventSelectionBit(collision), collision.alias_raw());
-    jCollisionsParentIndexTable(collision.globalIndex());
-    jCollisionsBunchCrossingIndexTable(collision.bcId());
+    jCollisionsTable.reserve(collisions.size());
+    for (auto const& collision : collisions) {
+      jCollisionsTable(collision.posX(), collision.posY(), collision.posZ(), -1.0, -1.0, jetderiveddatautilities::setEventSelectionBit(collision), collision.alias_raw());
+    }
+    fillCollisionIndices(collisions);
   }
   PROCESS_SWITCH(JetDerivedDataProducerTask, processCollisionsWithoutCentralityAndMultiplicity, "produces derived collision tables without centrality or multiplicity", false);
 
-  void processCollisionsRun2(soa::Join<aod::Collisions, aod::EvSels, aod::FT0Mults, aod::CentRun2V0Ms>::iterator const& collision)
+  void processCollisionsRun2(soa::Join<aod::Collisions, aod::EvSels, aod::FT0Mults, aod::CentRun2V0Ms> const& collisions)
   {
-    jCollisionsTable(collision.posX(), collision.posY(), collision.posZ(), collision.multFT0C(), collision.centRun2V0M(), jetderiveddatautilities::setEventSelectionBit(collision), collision.alias_raw()); // note change multFT0C to multFT0M when problems with multFT0A are fixed
-    jCollisionsParentIndexTable(collision.globalIndex());
-    jCollisionsBunchCrossingIndexTable(collision.bcId());
+    jCollisionsTable.reserve(collisions.size());
+    for (auto const& collision : collisions) {
+      jCollisionsTable(collision.posX(), collision.posY(), collision.posZ(), collision.multFT0C(), collision.centRun2V0M(), jetderiveddatautilities::setEventSelectionBit(collision), collision.alias_raw()); // note change multFT0C to multFT0M when problems with multFT0A are fixed
+    }
+    fillCollisionIndices(collisions);
   }
   PROCESS_SWITCH(JetDerivedDataProducerTask, processCollisionsRun2, "produces derived collision tables for Run 2 data", false);
 
-  void processMcCollisionLabels(soa::Join<aod::Collisions, aod::McCollisionLabels>::iterator const& collision)
+  void processMcCollisionLabels(soa::Join<aod::Collisions, aod::McCollisionLabels> const& collisions)
   {
-
-    if (collision.has_mcCollision()) {
-      jMcCollisionsLabelTable(collision.mcCollisionId());
-    } else {
-      jMcCollisionsLabelTable(-1);
+    jMcCollisionsLabelTable.reserve(collisions.size());
+    for (auto const& collision : collisions) {
+      if (collision.has_mcCollision()) {
+        jMcCollisionsLabelTable(collision.mcCollisionId());
+      } else {
+        jMcCollisionsLabelTable(-1);
+      }
     }
   }
   PROCESS_SWITCH(JetDerivedDataProducerTask, processMcCollisionLabels, "produces derived MC collision labels table", false);
 
-  void processMcCollisions(aod::McCollision const& McCollision)
+  void processMcCollisions(aod::McCollisions const& mcCollisions)
   {
-    jMcCollisionsTable(McCollision.posX(), McCollision.posY(), McCollision.posZ(), McCollision.weight());
-    jMcCollisionsParentIndexTable(McCollision.globalIndex());
+    jMcCollisionsTable.reserve(mcCollisions.size());
+    jMcCollisionsParentIndexTable.reserve(mcCollisions.size());
+    for (auto const& mcCollision : mcCollisions) {
+      jMcCollisionsTable(mcCollision.posX(), mcCollision.posY(), mcCollision.posZ(), mcCollision.weight());
+      jMcCollisionsParentIndexTable(mcCollision.globalIndex());
+    }
   }
   PROCESS_SWITCH(JetDerivedDataProducerTask, processMcCollisions, "produces derived MC collision table", false);
 
-  void processTracks(soa::Join<aod::Tracks, aod::TracksExtra, aod::TracksDCA, aod::TracksCov, aod::TrackSelection, aod::TrackSelectionExtension>::iterator const& track)
+  void processTracks(soa::Join<aod::Tracks, aod::TracksExtra, aod::TracksDCA, aod::TracksCov, aod::TrackSelection, aod::TrackSelectionExtension> const& tracks)
   {
-    jTracksTable(track.collisionId(), track.pt(), track.eta(), track.phi(), jetderiveddatautilities::setTrackSelectionBit(track));
-    jTracksExtraTable(track.dcaXY(), track.dcaZ(), track.sigma1Pt()); // these need to be recalculated when we add the track to collision associator
-    jTracksParentIndexTable(track.globalIndex());
+    jTracksTable.reserve(tracks.size());
+    jTracksExtraTable.reserve(tracks.size());
+    jTracksParentIndexTable.reserve(tracks.size());
+    for (auto const& track : tracks) {
+      jTracksTable(track.collisionId(), track.pt(), track.eta(), track.phi(), jetderiveddatautilities::setTrackSelectionBit(track));
+      jTracksExtraTable(track.dcaXY(), track.dcaZ(), track.sigma1Pt()); // these need to be recalculated when we add the track to collision associator
+      jTracksParentIndexTable(track.globalIndex());
+    }
   }
   PROCESS_SWITCH(JetDerivedDataProducerTask, processTracks, "produces derived track table", true);
 
-  void processMcTrackLabels(soa::Join<aod::Tracks, aod::McTrackLabels>::iterator const& track)
+  void processMcTrackLabels(soa::Join<aod::Tracks, aod::McTrackLabels> const& tracks)
   {
-    if (track.has_mcParticle()) {
-      jMcTracksLabelTable(track.mcParticleId());
-    } else {
-      jMcTracksLabelTable(-1);
+    jMcTracksLabelTable.reserve(tracks.size());
+    for (auto const& track : tracks) {
+      if (track.has_mcParticle()) {
+        jMcTracksLabelTable(track.mcParticleId());
+      } else {
+        jMcTracksLabelTable(-1);
+      }
     }
   }
   PROCESS_SWITCH(JetDerivedDataProducerTask, processMcTrackLabels, "produces derived track labels table", false);
 
-  void processParticles(aod::McParticle const& particle)
+  void processParticles(aod::McParticles const& particles)
   {
-    std::vector<int> mothersId;
-    if (particle.has_mothers()) {
-      auto mothersIdTemps = particle.mothersIds();
-      for (auto mothersIdTemp : mothersIdTemps) {
-        mothersId.push_back(mothersIdTemp);
-      }
+    jMcParticlesTable.reserve(particles.size());
+    jParticlesParentIndexTable.reserve(particles.size());
+    int daughtersId[2];
+    for (auto const& particle : particles) {
+      setFamilyIds(particle, daughtersId);
+      jMcParticlesTable(particle.mcCollisionId(), particle.pt(), particle.eta(), particle.phi(), particle.y(), particle.e(), particle.pdgCode(), particle.getGenStatusCode(), particle.getHepMCStatusCode(), particle.isPhysicalPrimary(), mothersId, daughtersId);
+      jParticlesParentIndexTable(particle.globalIndex());
     }
-    int daughtersId[2] = {-1, -1};
-    auto i = 0;
-    if (particle.has_daughters()) {
-      for (auto daughterId : particle.daughtersIds()) {
-        if (i > 1) {
-          break;
-        }
-        daughtersId[i] = daughterId;
-        i++;
-      }
-    }
-    jMcParticlesTable(particle.mcCollisionId(), particle.pt(), particle.eta(), particle.phi(), particle.y(), particle.e(), particle.pdgCode(), particle.getGenStatusCode(), particle.getHepMCStatusCode(), particle.isPhysicalPrimary(), mothersId, daughtersId);
-    jParticlesParentIndexTable(particle.globalIndex());
   }
   PROCESS_SWITCH(JetDerivedDataProducerTask, processParticles, "produces derived parrticle table", false);
 
@@ -240,27 +292,14 @@ struct JetDerivedDataProducerTask {
   }
   PROCESS_SWITCH(JetDerivedDataProducerTask, processV0, "produces derived index for V0 candidates", false);
 
-  void processV0MC(aod::McParticle const& particle)
+  void processV0MC(aod::McParticles const& particles)
   { // can loop over McV0Labels tables if we want to only store matched V0Particles
-    if (jetv0utilities::isV0Particle(particle)) {
-      std::vector<int> mothersId;
-      if (particle.has_mothers()) {
-        auto mothersIdTemps = particle.mothersIds();
-        for (auto mothersIdTemp : mothersIdTemps) {
-          mothersId.push_back(mothersIdTemp);
-        }
-      }
-      int daughtersId[2] = {-1, -1};
-      auto i = 0;
-      if (particle.has_daughters()) {
-        for (auto daughterId : particle.daughtersIds()) {
-          if (i > 1) {
-            break;
-          }
-          daughtersId[i] = daughterId;
-          i++;
-        }
+    int daughtersId[2];
+    for (auto const& particle : particles) {
+      if (!jetv0utilities::isV0Particle(particle)) {
+        continue;
       }
+      setFamilyIds(particle, daughtersId);
       auto pdgParticle = pdgDatabase->GetParticle(particle.pdgCode());
       jV0McParticlesTable(particle.mcCollisionId(), particle.globalIndex(), particle.pt(), particle.eta(), particle.phi(), particle.y(), particle.e(), pdgParticle->Mass(), particle.pdgCode(), particle.getGenStatusCode(), particle.getHepMCStatusCode(), particle.isPhysicalPrimary(), mothersId, daughtersId, jetv0utilities::setV0ParticleDecayBit<aod::McParticles>(particle));
     }
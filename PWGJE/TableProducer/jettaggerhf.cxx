@@ -60,6 +60,7 @@ struct JetTaggerHFTask {
   std::unique_ptr<TF1> fSignImpXYSig = nullptr;
   std::vector<float> vecParams;
   std::vector<float> jetProb;
+  jettaggingutilities::ParticleHFOriginCache hfOriginCache; // HF origins of the MC particles of the dataframe, shared by all the jets
   int maxOrder = -1;
   HistogramRegistry registry{"registry", {}, OutputObjHandlingPolicy::AnalysisObject};
   void init(InitContext const&)
@@ -104,13 +105,14 @@ struct JetTaggerHFTask {
 
   void processMCD(JetCollision const& collision, JetTableMCD const& mcdjets, JetTagTracksMCD const& jtracks, OriTracksMCD const& tracks, JetParticles const& particles)
   {
+    hfOriginCache.update(particles);
     for (auto& mcdjet : mcdjets) {
       typename JetTagTracksMCD::iterator hftrack;
       int origin = 0;
       if (removeGluonShower)
-        origin = jettaggingutilities::mcdJetFromHFShower(mcdjet, jtracks, particles, maxDeltaR);
+        origin = jettaggingutilities::mcdJetFromHFShower(mcdjet, jtracks, particles, maxDeltaR, &hfOriginCache);
       else
-        origin = jettaggingutilities::jetTrackFromHFShower(mcdjet, jtracks, particles, hftrack);
+        origin = jettaggingutilities::jetTrackFromHFShower(mcdjet, jtracks, particles, hftrack, &hfOriginCache);
       int algorithm2 = 0;
       int algorithm3 = 0;
       if (useJetProb) {
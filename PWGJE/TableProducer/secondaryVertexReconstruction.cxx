@@ -13,7 +13,11 @@
 //
 /// \author Hadi Hassan <hadi.hassan@cern.ch>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <type_traits>
+#include <vector>
 
 #include <TF1.h>
 #include <TH1.h>
@@ -66,6 +70,9 @@ struct SecondaryVertexReconstruction {
   Configurable<float> ptMinTrack{"ptMinTrack", -1., "min. track pT"};
   Configurable<float> etaMinTrack{"etaMinTrack", -99999., "min. pseudorapidity"};
   Configurable<float> etaMaxTrack{"etaMaxTrack", 4., "max. pseudorapidity"};
+  Configurable<float> minIPSignificance{"minIPSignificance", -1., "min. significance |DCAxy| / sigma(DCAxy) of the prongs (disabled if < 0)"};
+  Configurable<int> maxProngCandidates{"maxProngCandidates", -1, "max. number of constituents per jet used as prongs, the ones with the largest DCAxy significance (all if < 0)"};
+  Configurable<bool> requirePairVertices3Prongs{"requirePairVertices3Prongs", false, "build a 3-prong SV only if each pair of its prongs has a 2-prong vertex"};
   Configurable<bool> fillHistograms{"fillHistograms", true, "do validation plots"};
 
   Configurable<std::string> ccdbUrl{"ccdbUrl", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
@@ -125,145 +132,215 @@ struct SecondaryVertexReconstruction {
   using JetTracksMCDwPIs = soa::Filtered<soa::Join<JetTracksMCD, aod::JTrackPIs>>;
   using OriginalTracks = soa::Join<aod::Tracks, aod::TracksCov, aod::TrackSelection, aod::TracksDCA, aod::TracksDCACov>;
 
+  // constituent of the jet passing the prong selections, with the quantities used by all its combinations
+  struct ProngCandidate {
+    o2::track::TrackParCov trackParCov;
+    double energy = 0.;
+    float pt = 0.;
+    float ipSignificance = 0.; // |DCAxy| / sigma(DCAxy)
+    size_t constituent = 0;    // position in the constituents of the jet
+  };
+  std::vector<ProngCandidate> prongCandidates; // reused for each jet
+  std::vector<uint8_t> pairHasVertex;          // 2-prong fit result of each pair of candidates, for the 3-prong pruning
+
+  template <typename AnyJet, typename AnyParticles>
+  void selectProngCandidates(AnyJet const& analysisJet)
+  {
+    prongCandidates.clear();
+    const auto& particles = analysisJet.template tracks_as<AnyParticles>();
+    for (size_t iprong = 0; iprong < particles.size(); ++iprong) {
+      const auto& track = particles[iprong].template track_as<OriginalTracks>();
+      if (track.pt() < ptMinTrack || track.eta() < etaMinTrack || track.eta() > etaMaxTrack) {
+        continue;
+      }
+      float ipSignificance = track.sigmaDcaXY2() > 0.f ? std::abs(track.dcaXY()) / std::sqrt(track.sigmaDcaXY2()) : 0.f;
+      if (minIPSignificance >= 0.f && ipSignificance < minIPSignificance) {
+        continue;
+      }
+      prongCandidates.push_back({getTrackParCov(track), track.energy(o2::constants::physics::MassPiPlus), track.pt(), ipSignificance, iprong});
+    }
+    const size_t maxCandidates = maxProngCandidates;
+    if (maxProngCandidates >= 0 && prongCandidates.size() > maxCandidates) {
+      // keep the most displaced candidates, in the order of the constituents
+      std::partial_sort(prongCandidates.begin(), prongCandidates.begin() + maxCandidates, prongCandidates.end(),
+                        [](const ProngCandidate& a, const ProngCandidate& b) { return a.ipSignificance > b.ipSignificance; });
+      prongCandidates.resize(maxCandidates);
+      std::sort(prongCandidates.begin(), prongCandidates.end(), [](const ProngCandidate& a, const ProngCandidate& b) { return a.constituent < b.constituent; });
+    }
+  }
+
   template <unsigned int numProngs, typename AnyCollision, typename AnyJet, typename AnyParticles>
   void runCreatorNProng(AnyCollision const& collision,
                         AnyJet const& analysisJet,
-                        AnyParticles const& listoftracks,
+                        AnyParticles const& /*listoftracks*/,
                         std::vector<int>& svIndices,
-                        o2::vertexing::DCAFitterN<numProngs>& df,
-                        size_t prongIndex = 0,
-                        std::vector<size_t> currentCombination = {})
+                        o2::vertexing::DCAFitterN<numProngs>& df)
   {
+    selectProngCandidates<AnyJet, AnyParticles>(analysisJet);
+    const int nCandidates = prongCandidates.size();
+    if (nCandidates < static_cast<int>(numProngs)) {
+      return;
+    }
 
-    const auto& particles = analysisJet.template tracks_as<AnyParticles>();
-
-    if (currentCombination.size() == numProngs) {
-      // Create an array of track parameters and covariance matrices for the current combination
-      std::array<o2::track::TrackParametrizationWithError<float>, numProngs> trackParVars;
-      double energySV = 0.;
-      for (unsigned int inum = 0; inum < numProngs; ++inum) {
-        const auto& prong = particles[currentCombination[inum]].template track_as<OriginalTracks>();
-        energySV += prong.energy(o2::constants::physics::MassPiPlus);
-        trackParVars[inum] = getTrackParCov(prong);
-      }
+    auto bc = collision.template bc_as<aod::BCsWithTimestamps>();
+    if (runNumber != bc.runNumber()) {
+      initCCDB(bc, runNumber, ccdb, ccdbPathGrpMag, lut, false);
+      bz = o2::base::Propagator::Instance()->getNominalBz();
+    }
 
-      auto bc = collision.template bc_as<aod::BCsWithTimestamps>();
-      if (runNumber != bc.runNumber()) {
-        initCCDB(bc, runNumber, ccdb, ccdbPathGrpMag, lut, false);
-        bz = o2::base::Propagator::Instance()->getNominalBz();
-      }
+    // Use a different fitter depending on the number of prongs
+    df.setBz(bz);
 
-      // Use a different fitter depending on the number of prongs
-      df.setBz(bz);
+    auto primaryVertex = getPrimaryVertex(collision);
+    auto covMatrixPV = primaryVertex.getCov();
 
-      // Reconstruct the secondary vertex
-      int processResult = 0;
-      std::apply([&df, &processResult](const auto&... elems) { processResult = df.process(elems...); }, trackParVars);
-      if (processResult == 0) {
-        return;
+    // 2-prong vertices of all the pairs, computed once and required for the 3 pairs of each 3-prong combination
+    const bool prunePairs = numProngs == 3 && requirePairVertices3Prongs;
+    if (prunePairs) {
+      df2.setBz(bz);
+      pairHasVertex.assign(nCandidates * nCandidates, 0);
+      for (int i = 0; i < nCandidates; ++i) {
+        for (int j = i + 1; j < nCandidates; ++j) {
+          pairHasVertex[i * nCandidates + j] = df2.process(prongCandidates[i].trackParCov, prongCandidates[j].trackParCov) > 0;
+        }
       }
+    }
 
-      const auto& secondaryVertex = df.getPCACandidate();
-      auto chi2PCA = df.getChi2AtPCACandidate();
-      auto covMatrixPCA = df.calcPCACovMatrixFlat();
-
-      // get track impact parameters
-      // This modifies track momenta!
-      auto primaryVertex = getPrimaryVertex(collision);
-      auto covMatrixPV = primaryVertex.getCov();
-
-      // Get track momenta and impact parameters
-      std::array<std::array<float, 3>, numProngs> arrayMomenta;
-      std::array<o2::dataformats::DCA, numProngs> impactParameters;
-      for (unsigned int inum = 0; inum < numProngs; ++inum) {
-        trackParVars[inum].getPxPyPzGlo(arrayMomenta[inum]);
-        trackParVars[inum].propagateToDCA(primaryVertex, bz, &impactParameters[inum]);
-
-        if (fillHistograms) {
-          const auto& prong = particles[currentCombination[inum]].template track_as<OriginalTracks>();
-          registry.fill(HIST("hDcaXYNProngs"), prong.pt(), impactParameters[inum].getY() * toMicrometers, numProngs);
-          registry.fill(HIST("hDcaZNProngs"), prong.pt(), impactParameters[inum].getZ() * toMicrometers, numProngs);
+    // all the combinations of numProngs candidates, in lexicographic order
+    std::array<int, numProngs> combination;
+    for (unsigned int inum = 0; inum < numProngs; ++inum) {
+      combination[inum] = inum;
+    }
+    while (true) {
+      bool accepted = true;
+      if (prunePairs) {
+        for (unsigned int inum = 0; inum < numProngs && accepted; ++inum) {
+          for (unsigned int jnum = inum + 1; jnum < numProngs && accepted; ++jnum) {
+            accepted = pairHasVertex[combination[inum] * nCandidates + combination[jnum]];
+          }
         }
       }
-
-      // get uncertainty of the decay length
-      double phi, theta;
-      getPointDirection(std::array{primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ()}, secondaryVertex, phi, theta);
-      auto errorDecayLength = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, theta) + getRotatedCovMatrixXX(covMatrixPCA, phi, theta));
-      auto errorDecayLengthXY = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, 0.) + getRotatedCovMatrixXX(covMatrixPCA, phi, 0.));
-
-      // calculate invariant mass
-      std::array<double, numProngs> massArray;
-      std::fill(massArray.begin(), massArray.end(), o2::constants::physics::MassPiPlus);
-      double massSV = RecoDecay::m(std::move(arrayMomenta), massArray);
-
-      // fill candidate table rows
-      if (doprocessData3Prongs && numProngs == 3) {
-        sv3prongTableData(analysisJet.globalIndex(),
-                          primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
-                          secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
-                          arrayMomenta[0][0] + arrayMomenta[1][0] + arrayMomenta[2][0],
-                          arrayMomenta[0][1] + arrayMomenta[1][1] + arrayMomenta[2][1],
-                          arrayMomenta[0][2] + arrayMomenta[1][2] + arrayMomenta[2][2],
-                          energySV, massSV, chi2PCA, errorDecayLength, errorDecayLengthXY);
-        svIndices.push_back(sv3prongTableData.lastIndex());
-      } else if (doprocessData2Prongs && numProngs == 2) {
-        sv2prongTableData(analysisJet.globalIndex(),
-                          primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
-                          secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
-                          arrayMomenta[0][0] + arrayMomenta[1][0],
-                          arrayMomenta[0][1] + arrayMomenta[1][1],
-                          arrayMomenta[0][2] + arrayMomenta[1][2],
-                          energySV, massSV, chi2PCA, errorDecayLength, errorDecayLengthXY);
-        svIndices.push_back(sv2prongTableData.lastIndex());
-      } else if (doprocessMCD3Prongs && numProngs == 3) {
-        sv3prongTableMCD(analysisJet.globalIndex(),
-                         primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
-                         secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
-                         arrayMomenta[0][0] + arrayMomenta[1][0] + arrayMomenta[2][0],
-                         arrayMomenta[0][1] + arrayMomenta[1][1] + arrayMomenta[2][1],
-                         arrayMomenta[0][2] + arrayMomenta[1][2] + arrayMomenta[2][2],
-                         energySV, massSV, chi2PCA, errorDecayLength, errorDecayLengthXY);
-        svIndices.push_back(sv3prongTableMCD.lastIndex());
-      } else if (doprocessMCD2Prongs && numProngs == 2) {
-        sv2prongTableMCD(analysisJet.globalIndex(),
-                         primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
-                         secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
-                         arrayMomenta[0][0] + arrayMomenta[1][0],
-                         arrayMomenta[0][1] + arrayMomenta[1][1],
-                         arrayMomenta[0][2] + arrayMomenta[1][2],
-                         energySV, massSV, chi2PCA, errorDecayLength, errorDecayLengthXY);
-        svIndices.push_back(sv2prongTableMCD.lastIndex());
-      } else {
-        LOG(error) << "No process specified\n";
+      if (accepted) {
+        fitCombination<numProngs>(analysisJet, primaryVertex, covMatrixPV, combination, svIndices, df);
       }
-
-      // fill histograms
-      if (fillHistograms) {
-        double DecayLengthNormalised = RecoDecay::distance(std::array{primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ()}, std::array{secondaryVertex[0], secondaryVertex[1], secondaryVertex[2]}) / errorDecayLength;
-        double DecayLengthXYNormalised = RecoDecay::distanceXY(std::array{primaryVertex.getX(), primaryVertex.getY()}, std::array{secondaryVertex[0], secondaryVertex[1]}) / errorDecayLengthXY;
-
-        registry.fill(HIST("hMassNProngs"), massSV, numProngs);
-        registry.fill(HIST("hLxySNProngs"), DecayLengthXYNormalised, numProngs);
-        registry.fill(HIST("hLSNProngs"), DecayLengthNormalised, numProngs);
-        registry.fill(HIST("hFeNProngs"), energySV / analysisJet.energy() > 1. ? 0.99 : energySV / analysisJet.energy(), numProngs);
+      int pos = numProngs - 1;
+      while (pos >= 0 && combination[pos] == nCandidates - static_cast<int>(numProngs) + pos) {
+        --pos;
+      }
+      if (pos < 0) {
+        break;
       }
+      ++combination[pos];
+      for (unsigned int inum = pos + 1; inum < numProngs; ++inum) {
+        combination[inum] = combination[inum - 1] + 1;
+      }
+    }
+  }
 
+  template <unsigned int numProngs, typename AnyJet, typename PV, typename PVCov>
+  void fitCombination(AnyJet const& analysisJet,
+                      PV const& primaryVertex,
+                      PVCov const& covMatrixPV,
+                      std::array<int, numProngs> const& combination,
+                      std::vector<int>& svIndices,
+                      o2::vertexing::DCAFitterN<numProngs>& df)
+  {
+    // Create an array of track parameters and covariance matrices for the current combination
+    std::array<o2::track::TrackParametrizationWithError<float>, numProngs> trackParVars;
+    double energySV = 0.;
+    for (unsigned int inum = 0; inum < numProngs; ++inum) {
+      const auto& candidate = prongCandidates[combination[inum]];
+      energySV += candidate.energy;
+      trackParVars[inum] = candidate.trackParCov;
+    }
+
+    // Reconstruct the secondary vertex
+    int processResult = 0;
+    std::apply([&df, &processResult](const auto&... elems) { processResult = df.process(elems...); }, trackParVars);
+    if (processResult == 0) {
       return;
     }
 
-    // Recursive call to explore all combinations
-    for (size_t iprong = prongIndex; iprong < particles.size(); ++iprong) {
+    const auto& secondaryVertex = df.getPCACandidate();
+    auto chi2PCA = df.getChi2AtPCACandidate();
+    auto covMatrixPCA = df.calcPCACovMatrixFlat();
 
-      const auto& testTrack = particles[iprong].template track_as<OriginalTracks>();
-      if (testTrack.pt() < ptMinTrack || testTrack.eta() < etaMinTrack || testTrack.eta() > etaMaxTrack) {
-        continue;
+    // Get track momenta and impact parameters
+    // This modifies track momenta!
+    std::array<std::array<float, 3>, numProngs> arrayMomenta;
+    std::array<o2::dataformats::DCA, numProngs> impactParameters;
+    for (unsigned int inum = 0; inum < numProngs; ++inum) {
+      trackParVars[inum].getPxPyPzGlo(arrayMomenta[inum]);
+      trackParVars[inum].propagateToDCA(primaryVertex, bz, &impactParameters[inum]);
+
+      if (fillHistograms) {
+        const auto& candidate = prongCandidates[combination[inum]];
+        registry.fill(HIST("hDcaXYNProngs"), candidate.pt, impactParameters[inum].getY() * toMicrometers, numProngs);
+        registry.fill(HIST("hDcaZNProngs"), candidate.pt, impactParameters[inum].getZ() * toMicrometers, numProngs);
       }
+    }
+
+    // get uncertainty of the decay length
+    double phi, theta;
+    getPointDirection(std::array{primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ()}, secondaryVertex, phi, theta);
+    auto errorDecayLength = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, theta) + getRotatedCovMatrixXX(covMatrixPCA, phi, theta));
+    auto errorDecayLengthXY = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, 0.) + getRotatedCovMatrixXX(covMatrixPCA, phi, 0.));
+
+    // calculate invariant mass
+    std::array<double, numProngs> massArray;
+    std::fill(massArray.begin(), massArray.end(), o2::constants::physics::MassPiPlus);
+    double massSV = RecoDecay::m(std::move(arrayMomenta), massArray);
+
+    // fill candidate table rows
+    if (doprocessData3Prongs && numProngs == 3) {
+      sv3prongTableData(analysisJet.globalIndex(),
+                        primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
+                        secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
+                        arrayMomenta[0][0] + arrayMomenta[1][0] + arrayMomenta[2][0],
+                        arrayMomenta[0][1] + arrayMomenta[1][1] + arrayMomenta[2][1],
+                        arrayMomenta[0][2] + arrayMomenta[1][2] + arrayMomenta[2][2],
+                        energySV, massSV, chi2PCA, errorDecayLength, errorDecayLengthXY);
+      svIndices.push_back(sv3prongTableData.lastIndex());
+    } else if (doprocessData2Prongs && numProngs == 2) {
+      sv2prongTableData(analysisJet.globalIndex(),
+                        primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
+                        secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
+                        arrayMomenta[0][0] + arrayMomenta[1][0],
+                        arrayMomenta[0][1] + arrayMomenta[1][1],
+                        arrayMomenta[0][2] + arrayMomenta[1][2],
+                        energySV, massSV, chi2PCA, errorDecayLength, errorDecayLengthXY);
+      svIndices.push_back(sv2prongTableData.lastIndex());
+    } else if (doprocessMCD3Prongs && numProngs == 3) {
+      sv3prongTableMCD(analysisJet.globalIndex(),
+                       primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
+                       secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
+                       arrayMomenta[0][0] + arrayMomenta[1][0] + arrayMomenta[2][0],
+                       arrayMomenta[0][1] + arrayMomenta[1][1] + arrayMomenta[2][1],
+                       arrayMomenta[0][2] + arrayMomenta[1][2] + arrayMomenta[2][2],
+                       energySV, massSV, chi2PCA, errorDecayLength, errorDecayLengthXY);
+      svIndices.push_back(sv3prongTableMCD.lastIndex());
+    } else if (doprocessMCD2Prongs && numProngs == 2) {
+      sv2prongTableMCD(analysisJet.globalIndex(),
+                       primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
+                       secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
+                       arrayMomenta[0][0] + arrayMomenta[1][0],
+                       arrayMomenta[0][1] + arrayMomenta[1][1],
+                       arrayMomenta[0][2] + arrayMomenta[1][2],
+                       energySV, massSV, chi2PCA, errorDecayLength, errorDecayLengthXY);
+      svIndices.push_back(sv2prongTableMCD.lastIndex());
+    } else {
+      LOG(error) << "No process specified\n";
+    }
+
+    // fill histograms
+    if (fillHistograms) {
+      double DecayLengthNormalised = RecoDecay::distance(std::array{primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ()}, std::array{secondaryVertex[0], secondaryVertex[1], secondaryVertex[2]}) / errorDecayLength;
+      double DecayLengthXYNormalised = RecoDecay::distanceXY(std::array{primaryVertex.getX(), primaryVertex.getY()}, std::array{secondaryVertex[0], secondaryVertex[1]}) / errorDecayLengthXY;
 
-      currentCombination.push_back(iprong);
-      runCreatorNProng<numProngs>(
-        collision, analysisJet, listoftracks, svIndices, df, iprong + 1, currentCombination);
-      currentCombination.pop_back();
+      registry.fill(HIST("hMassNProngs"), massSV, numProngs);
+      registry.fill(HIST("hLxySNProngs"), DecayLengthXYNormalised, numProngs);
+      registry.fill(HIST("hLSNProngs"), DecayLengthNormalised, numProngs);
+      registry.fill(HIST("hFeNProngs"), energySV / analysisJet.energy() > 1. ? 0.99 : energySV / analysisJet.energy(), numProngs);
     }
   }
 
@@ -153,6 +153,7 @@ struct Photon {
     cellid = cellidin;
 
     acceptance_category = GetAcceptanceCategory(cellid, row, col, supermodulecategory);
+    acceptance_mask = acceptance_category > 0 ? 1u << acceptance_category : 0u;
   }
 
   TLorentzVector photon;
@@ -167,14 +168,16 @@ struct Photon {
   int row;                 // Global row
   int col;                 // Global column
   int acceptance_category; // One of the nine acceptance categories (EMCal, DCal or one third and behindTRD, border and inside)
+  // Bit of the acceptance category, to select the acceptance categories of a pair with a mask intersection
+  uint32_t acceptance_mask;
   int cellid;
   int clusterid;
   int supermodulecategory; // 0: Full, 1: 2/3, 2: 1/3
 };
 
 struct Meson {
-  Meson(Photon p1, Photon p2) : pgamma1(p1),
-                                pgamma2(p2)
+  Meson(const Photon& p1, const Photon& p2) : pgamma1(p1),
+                                              pgamma2(p2)
   {
     pMeson = p1.photon + p2.photon;
   }
@@ -455,12 +458,7 @@ struct Pi0EnergyScaleCalibTask {
           mHistManager.fill(HIST("invMassVsPtVsRow"), meson.getMass(), meson.getPt(), mPhotons[ig2].row);
           mHistManager.fill(HIST("invMassVsPtVsCol"), meson.getMass(), meson.getPt(), mPhotons[ig1].col);
           mHistManager.fill(HIST("invMassVsPtVsCol"), meson.getMass(), meson.getPt(), mPhotons[ig2].col);
-          for (int iAcceptanceCategory = 1; iAcceptanceCategory < NAcceptanceCategories; iAcceptanceCategory++) {
-            if ((!mRequireBothPhotonsFromAcceptance && (mPhotons[ig1].acceptance_category == iAcceptanceCategory || mPhotons[ig2].acceptance_category == iAcceptanceCategory)) ||
-                (mPhotons[ig1].acceptance_category == iAcceptanceCategory && mPhotons[ig2].acceptance_category == iAcceptanceCategory)) {
-              mHistManager.fill(HIST("invMassVsPtVsAcc"), meson.getMass(), meson.getPt(), iAcceptanceCategory);
-            }
-          }
+          FillAcceptanceCategories(HIST("invMassVsPtVsAcc"), meson, mPhotons[ig1], mPhotons[ig2]);
           CalculateBackground(meson, ig1, ig2); // calculate background candidates (rotation background)
         }
       }
@@ -476,28 +474,24 @@ struct Pi0EnergyScaleCalibTask {
     }
     const double rotationAngle = M_PI / 2.0; // 0.78539816339; // rotaion angle 90°
 
-    TLorentzVector lvRotationPhoton1; // photon candidates which get rotated
-    TLorentzVector lvRotationPhoton2; // photon candidates which get rotated
-    TVector3 lvRotationPion;          // rotation axis
+    // the rotated photons only depend on the pair, they are built once for all the third photons
+    TLorentzVector lvRotationPhoton1(mPhotons[ig1].px, mPhotons[ig1].py, mPhotons[ig1].pz, mPhotons[ig1].energy); // photon candidates which get rotated
+    TLorentzVector lvRotationPhoton2(mPhotons[ig2].px, mPhotons[ig2].py, mPhotons[ig2].pz, mPhotons[ig2].energy); // photon candidates which get rotated
+    TVector3 lvRotationPion = (meson.pMeson).Vect();                                                              // rotation axis
+
+    // rotate photons around rotation axis
+    lvRotationPhoton1.Rotate(rotationAngle, lvRotationPion);
+    lvRotationPhoton2.Rotate(rotationAngle, lvRotationPion);
+
+    // initialize Photon objects for rotated photons
+    Photon rotPhoton1(lvRotationPhoton1.Eta(), lvRotationPhoton1.Phi(), lvRotationPhoton1.E(), mPhotons[ig1].clusterid, mPhotons[ig1].cellid);
+    Photon rotPhoton2(lvRotationPhoton2.Eta(), lvRotationPhoton2.Phi(), lvRotationPhoton2.E(), mPhotons[ig2].clusterid, mPhotons[ig2].cellid);
+
     for (unsigned int ig3 = 0; ig3 < mPhotons.size(); ++ig3) {
       // continue if photons are identical
       if (ig3 == ig1 || ig3 == ig2) {
         continue;
       }
-      // calculate rotation axis
-      lvRotationPion = (meson.pMeson).Vect();
-
-      // initialize photons for rotation
-      lvRotationPhoton1.SetPxPyPzE(mPhotons[ig1].px, mPhotons[ig1].py, mPhotons[ig1].pz, mPhotons[ig1].energy);
-      lvRotationPhoton2.SetPxPyPzE(mPhotons[ig2].px, mPhotons[ig2].py, mPhotons[ig2].pz, mPhotons[ig2].energy);
-
-      // rotate photons around rotation axis
-      lvRotationPhoton1.Rotate(rotationAngle, lvRotationPion);
-      lvRotationPhoton2.Rotate(rotationAngle, lvRotationPion);
-
-      // initialize Photon objects for rotated photons
-      Photon rotPhoton1(lvRotationPhoton1.Eta(), lvRotationPhoton1.Phi(), lvRotationPhoton1.E(), mPhotons[ig1].clusterid, mPhotons[ig1].cellid);
-      Photon rotPhoton2(lvRotationPhoton2.Eta(), lvRotationPhoton2.Phi(), lvRotationPhoton2.E(), mPhotons[ig2].clusterid, mPhotons[ig2].cellid);
 
       // build meson from rotated photons
       Meson mesonRotated1(rotPhoton1, mPhotons[ig3]);
@@ -513,12 +507,7 @@ struct Pi0EnergyScaleCalibTask {
         mHistManager.fill(HIST("invMassVsPtVsRowBackground"), mesonRotated1.getMass(), mesonRotated1.getPt(), rotPhoton1.row);
         mHistManager.fill(HIST("invMassVsPtVsColBackground"), mesonRotated1.getMass(), mesonRotated1.getPt(), mPhotons[ig3].col);
         mHistManager.fill(HIST("invMassVsPtVsColBackground"), mesonRotated1.getMass(), mesonRotated1.getPt(), rotPhoton1.col);
-        for (int iAcceptanceCategory = 1; iAcceptanceCategory < NAcceptanceCategories; iAcceptanceCategory++) {
-          if ((!mRequireBothPhotonsFromAcceptance && (rotPhoton1.acceptance_category == iAcceptanceCategory || mPhotons[ig3].acceptance_category == iAcceptanceCategory)) ||
-              (rotPhoton1.acceptance_category == iAcceptanceCategory && mPhotons[ig3].acceptance_category == iAcceptanceCategory)) {
-            mHistManager.fill(HIST("invMassVsPtVsAccBackground"), mesonRotated1.getMass(), mesonRotated1.getPt(), iAcceptanceCategory);
-          }
-        }
+        FillAcceptanceCategories(HIST("invMassVsPtVsAccBackground"), mesonRotated1, rotPhoton1, mPhotons[ig3]);
       }
       if (mesonRotated2.getOpeningAngle() > mMinOpenAngleCut) {
         mHistManager.fill(HIST("invMassVsPtBackground"), mesonRotated2.getMass(), mesonRotated2.getPt());
@@ -529,16 +518,23 @@ struct Pi0EnergyScaleCalibTask {
         mHistManager.fill(HIST("invMassVsPtVsRowBackground"), mesonRotated2.getMass(), mesonRotated2.getPt(), rotPhoton2.row);
         mHistManager.fill(HIST("invMassVsPtVsColBackground"), mesonRotated2.getMass(), mesonRotated2.getPt(), mPhotons[ig3].col);
         mHistManager.fill(HIST("invMassVsPtVsColBackground"), mesonRotated2.getMass(), mesonRotated2.getPt(), rotPhoton2.col);
-        for (int iAcceptanceCategory = 1; iAcceptanceCategory < NAcceptanceCategories; iAcceptanceCategory++) {
-          if ((!mRequireBothPhotonsFromAcceptance && (rotPhoton2.acceptance_category == iAcceptanceCategory || mPhotons[ig3].acceptance_category == iAcceptanceCategory)) ||
-              (rotPhoton2.acceptance_category == iAcceptanceCategory && mPhotons[ig3].acceptance_category == iAcceptanceCategory)) {
-            mHistManager.fill(HIST("invMassVsPtVsAccBackground"), mesonRotated2.getMass(), mesonRotated2.getPt(), iAcceptanceCategory);
-          }
-        }
+        FillAcceptanceCategories(HIST("invMassVsPtVsAccBackground"), mesonRotated2, rotPhoton2, mPhotons[ig3]);
       }
     }
   }
 
+  /// \brief Fill the acceptance categories 1 to NAcceptanceCategories - 1 of a pair of photons: the categories of
+  /// both photons, or with RequireBothPhotonsFromAcceptance only their common category
+  template <typename THist>
+  void FillAcceptanceCategories(THist const& hist, const Meson& meson, const Photon& p1, const Photon& p2)
+  {
+    uint32_t mask = mRequireBothPhotonsFromAcceptance ? (p1.acceptance_mask & p2.acceptance_mask) : (p1.acceptance_mask | p2.acceptance_mask);
+    mask &= (1u << NAcceptanceCategories) - 1;
+    for (; mask != 0; mask &= mask - 1) {
+      mHistManager.fill(hist, meson.getMass(), meson.getPt(), __builtin_ctz(mask));
+    }
+  }
+
   // Beautify acceptance category bin labels
   void initCategoryAxis(TH3* hist)
   {
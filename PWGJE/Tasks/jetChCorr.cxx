@@ -23,7 +23,7 @@
 #include <TLorentzVector.h>
 
 #include "fastjet/PseudoJet.hh"
-#include "fastjet/ClusterSequenceArea.hh"
+#include "fastjet/ClusterSequence.hh"
 
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
@@ -170,7 +170,7 @@ struct JetChCorr {
   void jetReclustering(T const& jet)
   {
     jetReclustered.clear();
-    fastjet::ClusterSequenceArea clusterSeq(jetReclusterer.findJets(jetConstituents, jetReclustered));
+    fastjet::ClusterSequence clusterSeq(jetReclusterer.findJetsNoArea(jetConstituents, jetReclustered));
     jetReclustered = sorted_by_pt(jetReclustered);
     fastjet::PseudoJet daughterSubJet = jetReclustered[0];
     fastjet::PseudoJet parentSubJet1;
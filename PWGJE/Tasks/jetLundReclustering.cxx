@@ -24,7 +24,7 @@
 
 #include "fastjet/contrib/LundGenerator.hh"
 #include "fastjet/PseudoJet.hh"
-#include "fastjet/ClusterSequenceArea.hh"
+#include "fastjet/ClusterSequence.hh"
 
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
@@ -89,7 +89,7 @@ struct JetLundReclustering {
   void jetReclustering(T const& jet)
   {
     jetReclustered.clear();
-    fastjet::ClusterSequenceArea clusterSeq(jetReclusterer.findJets(jetConstituents, jetReclustered));
+    fastjet::ClusterSequence clusterSeq(jetReclusterer.findJetsNoArea(jetConstituents, jetReclustered));
     jetReclustered = sorted_by_pt(jetReclustered);
     fastjet::PseudoJet pair = jetReclustered[0];
     fastjet::PseudoJet j1;
@@ -14,6 +14,9 @@
 /// \author Gijs van Weelden <g.van.weelden@cern.ch>
 //
 
+#include <algorithm>
+#include <vector>
+
 #include "TH1F.h"
 #include "TTree.h"
 
@@ -158,6 +161,8 @@ struct JetFragmentation {
   Preslice<JetParticles> JetParticlesPerCollision = aod::jmcparticle::mcCollisionId;
   Preslice<aod::McParticles> ParticlesPerCollision = aod::mcparticle::mcCollisionId;
 
+  std::vector<int> matchedConstituentIds; // sorted constituent indices of a matched jet
+
   int eventSelection = -1;
 
   void init(InitContext&)
@@ -868,14 +873,26 @@ struct JetFragmentation {
   template <typename Jet, typename Constituent>
   double Xi(Jet const& jet, Constituent const& constituent)
   {
-    double xi = -1., trackProj = -1.;
-    trackProj = TrackProj(jet, constituent);
+    return XiFromTrackProj(TrackProj(jet, constituent));
+  }
+  // xi of a constituent whose projection is already known
+  double XiFromTrackProj(double trackProj)
+  {
+    double xi = -1.;
     if (trackProj > 0) {
       xi = TMath::Log(1. / trackProj);
     }
     return xi;
   }
 
+  // sorted constituent indices of a jet, for the constituent matching of processMcMatched
+  template <typename Ids>
+  void setSortedIds(Ids const& ids, std::vector<int>& sortedIds)
+  {
+    sortedIds.assign(ids.begin(), ids.end());
+    std::sort(sortedIds.begin(), sortedIds.end());
+  }
+
   // TODO: Can probably be made simpler/shorter by using V0MCLabels
   template <typename CollisionType, typename V0Type, typename trackType, typename particleType>
   void fillMcMatchedV0Histograms(CollisionType const& collision, V0Type const& v0, trackType const&, particleType const&, double weight = 1.)
@@ -950,7 +967,7 @@ struct JetFragmentation {
       chargeFrag = ChargeFrag(jet, track);
       trackProj = TrackProj(jet, track);
       theta = Theta(jet, track);
-      xi = Xi(jet, track);
+      xi = XiFromTrackProj(trackProj);
 
       registry.fill(HIST("data/jets/jetPtTrackPt"), jet.pt(), track.pt());
       registry.fill(HIST("data/jets/jetTrackPtEtaPhi"), track.pt(), track.eta(), track.phi());
@@ -1125,12 +1142,12 @@ struct JetFragmentation {
     detChargeFrag = ChargeFrag(detJet, track);
     detTrackProj = TrackProj(detJet, track);
     detTheta = Theta(detJet, track);
-    detXi = Xi(detJet, track);
+    detXi = XiFromTrackProj(detTrackProj);
 
     partChargeFrag = ChargeFrag(partJet, particle);
     partTrackProj = TrackProj(partJet, particle);
     partTheta = Theta(partJet, particle);
-    partXi = Xi(partJet, particle);
+    partXi = XiFromTrackProj(partTrackProj);
 
     // Detector level
     registry.fill(HIST("matching/jets/matchDetJetTrackPtEtaPhi"), track.pt(), track.eta(), track.phi(), weight);
@@ -1181,7 +1198,7 @@ struct JetFragmentation {
     chargeFrag = ChargeFrag(jet, constituent);
     trackProj = TrackProj(jet, constituent);
     theta = Theta(jet, constituent);
-    xi = Xi(jet, constituent);
+    xi = XiFromTrackProj(trackProj);
 
     if (isFake) {
       registry.fill(HIST("matching/jets/fakeDetJetPtFrag"), jet.pt(), chargeFrag, weight);
@@ -1510,7 +1527,7 @@ struct JetFragmentation {
       chargeFrag = ChargeFrag(jet, track);
       trackProj = TrackProj(jet, track);
       theta = Theta(jet, track);
-      xi = Xi(jet, track);
+      xi = XiFromTrackProj(trackProj);
 
       registry.fill(HIST("detector-level/jets/detJetPtTrackPt"), jet.pt(), track.pt(), weight);
       registry.fill(HIST("detector-level/jets/detJetTrackPtEtaPhi"), track.pt(), track.eta(), track.phi(), weight);
@@ -1536,7 +1553,7 @@ struct JetFragmentation {
       chargeFrag = ChargeFrag(jet, track);
       trackProj = TrackProj(jet, track);
       theta = Theta(jet, track);
-      xi = Xi(jet, track);
+      xi = XiFromTrackProj(trackProj);
 
       registry.fill(HIST("particle-level/jets/partJetPtTrackPt"), jet.pt(), track.pt(), weight);
       registry.fill(HIST("particle-level/jets/partJetTrackPtEtaPhi"), track.pt(), track.eta(), track.phi(), weight);
@@ -1644,9 +1661,11 @@ struct JetFragmentation {
     double weight = collision.mcCollision().weight();
     const auto& mcPartJets = allMcPartJets.sliceBy(PartJetsPerCollision, collision.mcCollision().globalIndex()); // Only jets from the same collision
     bool isFake = false;
+    // the constituents of the matched jets are compared through sorted index lists instead of a loop over all the pairs
     for (const auto& detJet : detJetEtaPartition) {
       for (auto& partJet : detJet.template matchedJetGeo_as<MatchedMCPJetsWithConstituents>()) {
         fillMatchingHistogramsJet(detJet, partJet, weight);
+        setSortedIds(partJet.tracksIds(), matchedConstituentIds);
 
         for (const auto& track : detJet.tracks_as<JetTracksMCD>()) {
           bool isTrackMatched = false;
@@ -1655,13 +1674,10 @@ struct JetFragmentation {
             fillMatchingFakeOrMiss(detJet, track, isFake, weight);
             continue;
           }
-          for (const auto& particle : partJet.tracks_as<JetParticles>()) {
-            if (particle.globalIndex() == track.template mcParticle_as<JetParticles>().globalIndex()) {
-              isTrackMatched = true;
-              fillMatchingHistogramsConstituent(detJet, partJet, track, particle, weight);
-              break; // No need to inspect other particles
-            }        // if track has mcParticle and particle is in matched jet
-          }          // for particle in matched partJet
+          if (std::binary_search(matchedConstituentIds.begin(), matchedConstituentIds.end(), track.mcParticleId())) {
+            isTrackMatched = true;
+            fillMatchingHistogramsConstituent(detJet, partJet, track, track.template mcParticle_as<JetParticles>(), weight);
+          } // if track has mcParticle and particle is in matched jet
           if (!isTrackMatched) {
             isFake = true;
             fillMatchingFakeOrMiss(detJet, track, isFake, weight);
@@ -1687,16 +1703,15 @@ struct JetFragmentation {
           continue;
         }
         // If the jets are properly matched, we can check the particles
-        for (const auto& particle : partJet.tracks_as<JetParticles>()) {
-          bool isParticleMatched = false;
-          for (const auto& track : detJet.tracks_as<JetTracksMCD>()) {
-            if (!track.has_mcParticle()) {
-              continue;
-            }
-            if (particle.globalIndex() == track.template mcParticle_as<JetParticles>().globalIndex()) {
-              isParticleMatched = true;
-            }
+        matchedConstituentIds.clear();
+        for (const auto& track : detJet.tracks_as<JetTracksMCD>()) {
+          if (track.has_mcParticle()) {
+            matchedConstituentIds.push_back(track.mcParticleId());
           }
+        }
+        std::sort(matchedConstituentIds.begin(), matchedConstituentIds.end());
+        for (const auto& particle : partJet.tracks_as<JetParticles>()) {
+          bool isParticleMatched = std::binary_search(matchedConstituentIds.begin(), matchedConstituentIds.end(), static_cast<int>(particle.globalIndex()));
           // Ignore matched particles. They have been handled in the previous loop
           if (!isParticleMatched) {
             isFake = false;
@@ -15,7 +15,7 @@
 //
 
 #include "fastjet/PseudoJet.hh"
-#include "fastjet/ClusterSequenceArea.hh"
+#include "fastjet/ClusterSequence.hh"
 
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
@@ -80,9 +80,12 @@ struct JetSubstructureTask {
   void jetReclustering(T const& jet, U& outputTable)
   {
     jetReclustered.clear();
-    fastjet::ClusterSequenceArea clusterSeq(jetReclusterer.findJets(jetConstituents, jetReclustered));
+    fastjet::ClusterSequence clusterSeq(jetReclusterer.findJetsNoArea(jetConstituents, jetReclustered));
     jetReclustered = sorted_by_pt(jetReclustered);
     fastjet::PseudoJet daughterSubJet = jetReclustered[0];
+    if constexpr (!isMCP) { // same constituents as jetToPseudoJet, the reclustered jet is reused (the particle level uses the PDG masses)
+      nSub = jetsubstructureutilities::getNSubjettinessPseudoJet(daughterSubJet, jet.r() / 100.f, 2, fastjet::contrib::CA_Axes(), true, zCut, beta);
+    }
     fastjet::PseudoJet parentSubJet1;
     fastjet::PseudoJet parentSubJet2;
     bool softDropped = false;
@@ -140,14 +143,12 @@ struct JetSubstructureTask {
   }
 
   template <bool isSubtracted, typename T, typename U, typename V>
-  void analyseCharged(T const& jet, U const& tracks, V& outputTable)
+  void analyseCharged(T const& jet, U const& /*tracks*/, V& outputTable)
   {
     jetConstituents.clear();
     for (auto& jetConstituent : jet.template tracks_as<U>()) {
       fastjetutilities::fillTracks(jetConstituent, jetConstituents, jetConstituent.globalIndex());
     }
-    nSub = jetsubstructureutilities::getNSubjettiness(jet, tracks, tracks, tracks, 2, fastjet::contrib::CA_Axes(), true, zCut, beta);
-
     jetReclustering<false, isSubtracted>(jet, outputTable);
   }
 
@@ -15,7 +15,7 @@
 //
 
 #include "fastjet/PseudoJet.hh"
-#include "fastjet/ClusterSequenceArea.hh"
+#include "fastjet/ClusterSequence.hh"
 
 #include "CommonConstants/PhysicsConstants.h"
 #include "Framework/AnalysisTask.h"
@@ -91,9 +91,12 @@ struct JetSubstructureHFTask {
   void jetReclustering(T const& jet, U& outputTable)
   {
     jetReclustered.clear();
-    fastjet::ClusterSequenceArea clusterSeq(jetReclusterer.findJets(jetConstituents, jetReclustered));
+    fastjet::ClusterSequence clusterSeq(jetReclusterer.findJetsNoArea(jetConstituents, jetReclustered));
     jetReclustered = sorted_by_pt(jetReclustered);
     fastjet::PseudoJet daughterSubJet = jetReclustered[0];
+    if constexpr (!isMCP) { // same constituents as jetToPseudoJet, the reclustered jet is reused (the particle level uses the PDG masses)
+      nSub = jetsubstructureutilities::getNSubjettinessPseudoJet(daughterSubJet, jet.r() / 100.f, 2, fastjet::contrib::CA_Axes(), true, zCut, beta);
+    }
     fastjet::PseudoJet parentSubJet1;
     fastjet::PseudoJet parentSubJet2;
     bool softDropped = false;
@@ -157,7 +160,7 @@ struct JetSubstructureHFTask {
   }
 
   template <bool isSubtracted, typename T, typename U, typename V, typename M>
-  void analyseCharged(T const& jet, U const& tracks, V const& candidates, M& outputTable)
+  void analyseCharged(T const& jet, U const& /*tracks*/, V const& /*candidates*/, M& outputTable)
   {
 
     jetConstituents.clear();
@@ -167,7 +170,6 @@ struct JetSubstructureHFTask {
     for (auto& jetHFCandidate : jet.template hfcandidates_as<V>()) { // should only be one at the moment
       fastjetutilities::fillTracks(jetHFCandidate, jetConstituents, jetHFCandidate.globalIndex(), static_cast<int>(JetConstituentStatus::candidateHF), candMass);
     }
-    nSub = jetsubstructureutilities::getNSubjettiness(jet, tracks, tracks, candidates, 2, fastjet::contrib::CA_Axes(), true, zCut, beta);
     jetReclustering<false, isSubtracted>(jet, outputTable);
   }
 
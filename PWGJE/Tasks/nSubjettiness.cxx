@@ -182,9 +182,12 @@ struct NSubjettinessTask {
   template <bool isMCP, typename T, typename U>
   void processJet(T const& jet, U const& tracks, float weight = 1.0)
   {
-    nSub_Kt_results = jetsubstructureutilities::getNSubjettiness(jet, tracks, tracks, tracks, 2, fastjet::contrib::KT_Axes());
-    nSub_CA_results = jetsubstructureutilities::getNSubjettiness(jet, tracks, tracks, tracks, 2, fastjet::contrib::CA_Axes());
-    nSub_CASD_results = jetsubstructureutilities::getNSubjettiness(jet, tracks, tracks, tracks, 2, fastjet::contrib::CA_Axes(), true, SD_z_cut, SD_beta);
+    // the jet is converted and reclustered once for the three sets of axes
+    fastjet::PseudoJet pseudoJet;
+    fastjet::ClusterSequence clusterSeq(jetsubstructureutilities::jetToPseudoJet(jet, tracks, tracks, tracks, pseudoJet));
+    nSub_Kt_results = jetsubstructureutilities::getNSubjettinessPseudoJet(pseudoJet, jet.r() / 100.0, 2, fastjet::contrib::KT_Axes());
+    nSub_CA_results = jetsubstructureutilities::getNSubjettinessPseudoJet(pseudoJet, jet.r() / 100.0, 2, fastjet::contrib::CA_Axes());
+    nSub_CASD_results = jetsubstructureutilities::getNSubjettinessPseudoJet(pseudoJet, jet.r() / 100.0, 2, fastjet::contrib::CA_Axes(), true, SD_z_cut, SD_beta);
 
     if (jet.tracksIds().size() > 1) {
       if constexpr (isMCP) {
@@ -14,8 +14,10 @@
 
 #include <cmath>
 #include <array>
+#include <algorithm>
 #include <cstdlib>
 #include <iterator>
+#include <vector>
 
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
@@ -78,6 +80,17 @@ bool is3bodyDecayedH3L(TMCParticle const& particle)
   return false;
 }
 
+/// Whether the MC particle has the given mother, from its mother indices (no iteration over the mother particles)
+template <typename TMCParticle>
+bool hasMother(TMCParticle const& particle, int64_t motherId)
+{
+  if (!particle.has_mothers()) {
+    return false;
+  }
+  const auto& motherIds = particle.mothersIds();
+  return std::find(motherIds.begin(), motherIds.end(), motherId) != motherIds.end();
+}
+
 namespace o2::aod
 {
 namespace v0goodpostrack
@@ -177,17 +190,13 @@ struct trackprefilter {
       int lPDG = -1;
       bool is3bodyDecay = false;
       for (auto& lMother0 : lMCTrack0.mothers_as<aod::McParticles>()) {
-        for (auto& lMother1 : lMCTrack1.mothers_as<aod::McParticles>()) {
-          for (auto& lMother2 : lMCTrack2.mothers_as<aod::McParticles>()) {
-            if (lMother0.globalIndex() == lMother1.globalIndex() && lMother0.globalIndex() == lMother2.globalIndex()) {
-              lPDG = lMother1.pdgCode();
-              if (lPDG == 1010010030 && lMCTrack0.pdgCode() == 2212 && lMCTrack1.pdgCode() == -211 && lMCTrack2.pdgCode() == 1000010020) {
-                is3bodyDecay = true; // vtxs with the same mother
-              }
-              if (lPDG == -1010010030 && lMCTrack0.pdgCode() == 211 && lMCTrack1.pdgCode() == -2212 && lMCTrack2.pdgCode() == -1000010020) {
-                is3bodyDecay = true; // vtxs with the same mother
-              }
-            }
+        if (hasMother(lMCTrack1, lMother0.globalIndex()) && hasMother(lMCTrack2, lMother0.globalIndex())) {
+          lPDG = lMother0.pdgCode();
+          if (lPDG == 1010010030 && lMCTrack0.pdgCode() == 2212 && lMCTrack1.pdgCode() == -211 && lMCTrack2.pdgCode() == 1000010020) {
+            is3bodyDecay = true; // vtxs with the same mother
+          }
+          if (lPDG == -1010010030 && lMCTrack0.pdgCode() == 211 && lMCTrack1.pdgCode() == -2212 && lMCTrack2.pdgCode() == -1000010020) {
+            is3bodyDecay = true; // vtxs with the same mother
           }
         }
       } // end association check
@@ -265,6 +274,18 @@ struct hypertriton3bodyFinder {
   Preslice<aod::V0Datas> perCollisionV0Datas = o2::aod::v0data::collisionId;
 
   // Helper struct to pass V0 information
+  struct V0Seed {
+    o2::track::TrackParCov track0; // positive and negative legs at their first point, for the 3-body fits of all the bachelors
+    o2::track::TrackParCov track1;
+    float rv0 = 0.f;
+    bool hasDCAXY = false; // DCAs of the legs to the collision, computed for the first candidate of the pair passing the selections
+    float track0DCAXY = 0.f;
+    float track1DCAXY = 0.f;
+  };
+  V0Seed mV0Seed;
+  std::vector<o2::track::TrackParCov> mBachelorTracks; // bachelor candidates of the collision, at their first point
+  std::vector<int64_t> mV0H3LMotherIds;               // MC hypertriton mothers shared by the two legs of the pair
+
   HistogramRegistry registry{
     "registry",
     {
@@ -516,7 +537,7 @@ struct hypertriton3bodyFinder {
   //------------------------------------------------------------------
   // Virtual Lambda V0 finder
   template <class TTrackClass, typename TCollisionTable, typename TTrackTable>
-  bool DecayV0Finder(TCollisionTable const& dCollision, TTrackTable const& dPtrack, TTrackTable const& dNtrack, float& rv0, bool isTrue3bodyV0 = false)
+  bool DecayV0Finder(TCollisionTable const& dCollision, TTrackTable const& dPtrack, TTrackTable const& dNtrack, V0Seed& seed, bool isTrue3bodyV0 = false)
   {
     if (dPtrack.collisionId() != dNtrack.collisionId()) {
       return false;
@@ -526,9 +547,10 @@ struct hypertriton3bodyFinder {
       return false;
     }
 
-    auto Track0 = getTrackParCov(dPtrack);
-    auto Track1 = getTrackParCov(dNtrack);
-    int nCand = fitter.process(Track0, Track1);
+    seed.track0 = getTrackParCov(dPtrack);
+    seed.track1 = getTrackParCov(dNtrack);
+    seed.hasDCAXY = false;
+    int nCand = fitter.process(seed.track0, seed.track1);
     if (nCand == 0) {
       return false;
     }
@@ -538,8 +560,8 @@ struct hypertriton3bodyFinder {
     // First check closeness to the beam-line as same as SVertexer
     const auto& v0XYZ = fitter.getPCACandidate();
     float dxv0 = v0XYZ[0] - mMeanVertex.getX(), dyv0 = v0XYZ[1] - mMeanVertex.getY(), r2v0 = dxv0 * dxv0 + dyv0 * dyv0;
-    // float rv0 = std::sqrt(r2v0);
-    rv0 = std::sqrt(r2v0);
+    const float rv0 = std::sqrt(r2v0);
+    seed.rv0 = rv0;
     if (rv0 < minRToMeanVertex) {
       return false;
     }
@@ -605,7 +627,7 @@ struct hypertriton3bodyFinder {
   //------------------------------------------------------------------
   // 3body decay vertex finder
   template <class TTrackClass, typename TCollisionTable, typename TTrackTable>
-  void Decay3bodyFinder(TCollisionTable const& dCollision, TTrackTable const& dPtrack, TTrackTable const& dNtrack, TTrackTable const& dBachtrack, float const& rv0, bool isTrue3bodyVtx = false)
+  void Decay3bodyFinder(TCollisionTable const& dCollision, TTrackTable const& dPtrack, TTrackTable const& dNtrack, TTrackTable const& dBachtrack, o2::track::TrackParCov const& bach, V0Seed& seed, bool isTrue3bodyVtx = false)
   {
     if (dPtrack.collisionId() != dBachtrack.collisionId()) {
       return;
@@ -618,16 +640,12 @@ struct hypertriton3bodyFinder {
       return;
     }
 
-    auto track0 = getTrackParCov(dPtrack);
-    auto track1 = getTrackParCov(dNtrack);
-    auto bach = getTrackParCov(dBachtrack);
-
     if (bach.getPt() < minbachPt) {
       return;
     }
     FillVtxCounter(kVtxbachPt, isTrue3bodyVtx);
 
-    int n3bodyVtx = fitter3body.process(track0, track1, bach);
+    int n3bodyVtx = fitter3body.process(seed.track0, seed.track1, bach);
     if (n3bodyVtx == 0) { // discard this pair
       return;
     }
@@ -637,7 +655,7 @@ struct hypertriton3bodyFinder {
     // make sure the cascade radius is smaller than that of the vertex
     float dxc = vertexXYZ[0] - dCollision.posX(), dyc = vertexXYZ[1] - dCollision.posY(), dzc = vertexXYZ[2] - dCollision.posZ(), r2vertex = dxc * dxc + dyc * dyc;
     float rvertex = std::sqrt(r2vertex);
-    if (std::abs(rv0 - rvertex) > maxRDiff3bodyV0 || rvertex < minRToMeanVertex) {
+    if (std::abs(seed.rv0 - rvertex) > maxRDiff3bodyV0 || rvertex < minRToMeanVertex) {
       return;
     }
     FillVtxCounter(kVtxRadius, isTrue3bodyVtx);
@@ -684,13 +702,16 @@ struct hypertriton3bodyFinder {
     // Calculate DCA with respect to the collision associated to the V0, not individual tracks
     gpu::gpustd::array<float, 2> dcaInfo;
 
-    auto Track0Par = getTrackPar(dPtrack);
-    o2::base::Propagator::Instance()->propagateToDCABxByBz({dCollision.posX(), dCollision.posY(), dCollision.posZ()}, Track0Par, 2.f, fitter3body.getMatCorrType(), &dcaInfo);
-    auto Track0dcaXY = dcaInfo[0];
+    if (!seed.hasDCAXY) {
+      auto Track0Par = getTrackPar(dPtrack);
+      o2::base::Propagator::Instance()->propagateToDCABxByBz({dCollision.posX(), dCollision.posY(), dCollision.posZ()}, Track0Par, 2.f, fitter3body.getMatCorrType(), &dcaInfo);
+      seed.track0DCAXY = dcaInfo[0];
 
-    auto Track1Par = getTrackPar(dNtrack);
-    o2::base::Propagator::Instance()->propagateToDCABxByBz({dCollision.posX(), dCollision.posY(), dCollision.posZ()}, Track1Par, 2.f, fitter3body.getMatCorrType(), &dcaInfo);
-    auto Track1dcaXY = dcaInfo[0];
+      auto Track1Par = getTrackPar(dNtrack);
+      o2::base::Propagator::Instance()->propagateToDCABxByBz({dCollision.posX(), dCollision.posY(), dCollision.posZ()}, Track1Par, 2.f, fitter3body.getMatCorrType(), &dcaInfo);
+      seed.track1DCAXY = dcaInfo[0];
+      seed.hasDCAXY = true;
+    }
 
     auto Track2Par = getTrackPar(dBachtrack);
     o2::base::Propagator::Instance()->propagateToDCABxByBz({dCollision.posX(), dCollision.posY(), dCollision.posZ()}, Track2Par, 2.f, fitter3body.getMatCorrType(), &dcaInfo);
@@ -711,27 +732,38 @@ struct hypertriton3bodyFinder {
       vertexXYZ[0], vertexXYZ[1], vertexXYZ[2],
       p0[0], p0[1], p0[2], p1[0], p1[1], p1[2], p2[0], p2[1], p2[2],
       fitter3body.getChi2AtPCACandidate(),
-      Track0dcaXY, Track1dcaXY, Track2dcaXY,
+      seed.track0DCAXY, seed.track1DCAXY, Track2dcaXY,
       0); // To be fixed
   }
   //------------------------------------------------------------------
+  // bachelor candidates of a collision, propagated once for all the V0s instead of for each pair
+  template <class TTrackClass, typename TGoodTrackTable>
+  void FillBachelorTracks(TGoodTrackTable const& dGoodtracks)
+  {
+    mBachelorTracks.clear();
+    for (auto& t2id : dGoodtracks) {
+      mBachelorTracks.push_back(getTrackParCov(t2id.template goodTrack_as<TTrackClass>()));
+    }
+  }
+  //------------------------------------------------------------------
   // 3body decay finder for a collsion
   template <class TTrackClass, typename TCollisionTable, typename TPosTrackTable, typename TNegTrackTable, typename TGoodTrackTable>
   void DecayFinder(TCollisionTable const& dCollision, TPosTrackTable const& dPtracks, TNegTrackTable const& dNtracks, TGoodTrackTable const& dGoodtracks)
   {
+    FillBachelorTracks<TTrackClass>(dGoodtracks);
     for (auto& t0id : dPtracks) { // FIXME: turn into combination(...)
       auto t0 = t0id.template goodTrack_as<TTrackClass>();
 
       for (auto& t1id : dNtracks) {
         auto t1 = t1id.template goodTrack_as<TTrackClass>();
-        float rv0;
-        if (!DecayV0Finder<TTrackClass>(dCollision, t0, t1, rv0)) {
+        if (!DecayV0Finder<TTrackClass>(dCollision, t0, t1, mV0Seed)) {
           continue;
         }
 
+        std::size_t ibach = 0;
         for (auto& t2id : dGoodtracks) {
           auto t2 = t2id.template goodTrack_as<TTrackClass>();
-          Decay3bodyFinder<TTrackClass>(dCollision, t0, t1, t2, rv0);
+          Decay3bodyFinder<TTrackClass>(dCollision, t0, t1, t2, mBachelorTracks[ibach++], mV0Seed);
         }
       }
     }
@@ -743,6 +775,7 @@ struct hypertriton3bodyFinder {
   template <class TTrackClass, typename TCollisionTable, typename TPosTrackTable, typename TNegTrackTable, typename TGoodTrackTable>
   void DecayFinderMC(TCollisionTable const& dCollision, TPosTrackTable const& dPtracks, TNegTrackTable const& dNtracks, TGoodTrackTable const& dGoodtracks)
   {
+    FillBachelorTracks<TTrackClass>(dGoodtracks);
     for (auto& t0id : dPtracks) { // FIXME: turn into combination(...)
       auto t0 = t0id.template goodTrack_as<TTrackClass>();
       for (auto& t1id : dNtracks) {
@@ -751,52 +784,47 @@ struct hypertriton3bodyFinder {
           continue;
         }
 
-        bool isTrue3bodyV0 = false;
+        // hypertriton mothers shared by the two legs, found once for the V0 and all its bachelors
+        mV0H3LMotherIds.clear();
+        int bachelorPdg = 0;
         if (t0.has_mcParticle() && t1.has_mcParticle()) {
           auto t0mc = t0.template mcParticle_as<aod::McParticles>();
           auto t1mc = t1.template mcParticle_as<aod::McParticles>();
           if ((t0mc.pdgCode() == 2212 && t1mc.pdgCode() == -211) || (t0mc.pdgCode() == 211 && t1mc.pdgCode() == -2212)) {
+            bachelorPdg = t0mc.pdgCode() == 2212 ? 1000010020 : -1000010020;
             if (t0mc.has_mothers() && t1mc.has_mothers()) {
               for (auto& t0mother : t0mc.template mothers_as<aod::McParticles>()) {
-                for (auto& t1mother : t1mc.template mothers_as<aod::McParticles>()) {
-                  if (t0mother.globalIndex() == t1mother.globalIndex() && std::abs(t0mother.pdgCode()) == 1010010030) {
-                    isTrue3bodyV0 = true;
-                  }
+                if (std::abs(t0mother.pdgCode()) == 1010010030 && hasMother(t1mc, t0mother.globalIndex())) {
+                  mV0H3LMotherIds.push_back(t0mother.globalIndex());
                 }
               }
             }
           }
         }
+        bool isTrue3bodyV0 = !mV0H3LMotherIds.empty();
 
-        float rv0;
-        if (!DecayV0Finder<TTrackClass>(dCollision, t0, t1, rv0, isTrue3bodyV0)) {
+        if (!DecayV0Finder<TTrackClass>(dCollision, t0, t1, mV0Seed, isTrue3bodyV0)) {
           continue;
         }
 
+        std::size_t ibach = 0;
         for (auto& t2id : dGoodtracks) {
           auto t2 = t2id.template goodTrack_as<TTrackClass>();
 
           bool isTrue3bodyVtx = false;
-          if (t0.has_mcParticle() && t1.has_mcParticle() && t2.has_mcParticle()) {
-            auto t0mc = t0.template mcParticle_as<aod::McParticles>();
-            auto t1mc = t1.template mcParticle_as<aod::McParticles>();
+          if (isTrue3bodyV0 && t2.has_mcParticle()) {
             auto t2mc = t2.template mcParticle_as<aod::McParticles>();
-            if ((t0mc.pdgCode() == 2212 && t1mc.pdgCode() == -211 && t2mc.pdgCode() == 1000010020) || (t0mc.pdgCode() == 211 && t1mc.pdgCode() == -2212 && t2mc.pdgCode() == -1000010020)) {
-              if (t0mc.has_mothers() && t1mc.has_mothers() && t2mc.has_mothers()) {
-                for (auto& t0mother : t0mc.template mothers_as<aod::McParticles>()) {
-                  for (auto& t1mother : t1mc.template mothers_as<aod::McParticles>()) {
-                    for (auto& t2mother : t2mc.template mothers_as<aod::McParticles>()) {
-                      if (t0mother.globalIndex() == t1mother.globalIndex() && t0mother.globalIndex() == t2mother.globalIndex() && std::abs(t0mother.pdgCode()) == 1010010030) {
-                        isTrue3bodyVtx = true;
-                      }
-                    }
-                  }
+            if (t2mc.pdgCode() == bachelorPdg) {
+              for (auto motherId : mV0H3LMotherIds) {
+                if (hasMother(t2mc, motherId)) {
+                  isTrue3bodyVtx = true;
+                  break;
                 }
               }
             }
           }
 
-          Decay3bodyFinder<TTrackClass>(dCollision, t0, t1, t2, rv0, isTrue3bodyVtx);
+          Decay3bodyFinder<TTrackClass>(dCollision, t0, t1, t2, mBachelorTracks[ibach++], mV0Seed, isTrue3bodyVtx);
         }
       }
     }
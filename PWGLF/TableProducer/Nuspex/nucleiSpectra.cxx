@@ -19,6 +19,7 @@
 // o2-analysis-pid-tof-base, o2-analysis-multiplicity-table, o2-analysis-event-selection
 // (to add flow: o2-analysis-qvector-table, o2-analysis-centrality-table)
 
+#include <algorithm>
 #include <cmath>
 
 #include "Math/Vector4D.h"
@@ -33,6 +34,7 @@
 #include "Common/DataModel/PIDResponse.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "Common/Core/PID/PIDTOF.h"
+#include "Common/Core/PID/BetheBlochTable.h"
 #include "Common/TableProducer/PID/pidTOFBase.h"
 #include "Common/Core/EventPlaneHelper.h"
 #include "Common/DataModel/Qvectors.h"
@@ -181,7 +183,6 @@ std::shared_ptr<THnSparse> hFlowHists[2][5];
 o2::base::MatLayerCylSet* lut = nullptr;
 
 std::vector<NucleusCandidate> candidates;
-std::vector<NucleusCandidateFlow> candidates_flow;
 
 enum centDetectors {
   kFV0A = 0,
@@ -264,6 +265,9 @@ struct nucleiSpectra {
   Configurable<std::string> cfgCCDBurl{"ccdb-url", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
   int mRunNumber = 0;
   float mBz = 0.f;
+  std::array<o2::pid::tpc::BetheBlochTable, nuclei::species> mBBTables; // expected TPC signal per species, tabulated at init
+  double mBgScalings[nuclei::species][2];                                 // momentum to beta*gamma of the Bethe-Bloch, per species and charge
+  double mBBResolution[nuclei::species];                                  // relative resolution of the TPC signal, per species
 
   Filter trackFilter = nabs(aod::track::eta) < cfgCutEta && aod::track::tpcInnerParam > cfgCutTpcMom;
 
@@ -413,6 +417,12 @@ struct nucleiSpectra {
       for (int iMax{0}; iMax < 2; ++iMax) {
         nuclei::pidCuts[0][iS][iMax] = cfgNsigmaTPC->get(iS, iMax);
       }
+      mBBTables[iS].init({cfgBetheBlochParams->get(iS, 0u), cfgBetheBlochParams->get(iS, 1u), cfgBetheBlochParams->get(iS, 2u), cfgBetheBlochParams->get(iS, 3u), cfgBetheBlochParams->get(iS, 4u)});
+      mBBResolution[iS] = cfgBetheBlochParams->get(iS, 5u);
+      const unsigned int iScaling = std::min(iS, 3); // the He4 uses the momentum scaling of the He3
+      for (unsigned int iC{0}; iC < 2; ++iC) {
+        mBgScalings[iS][iC] = nuclei::charges[iS] * cfgMomentumScalingBetheBloch->get(iScaling, iC) / nuclei::masses[iS];
+      }
     }
 
     nuclei::lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>("GLO/Param/MatLUT"));
@@ -456,12 +466,12 @@ struct nucleiSpectra {
 
     float centrality = getCentrality(collision);
 
-    const double bgScalings[5][2]{
-      {nuclei::charges[0] * cfgMomentumScalingBetheBloch->get(0u, 0u) / nuclei::masses[0], nuclei::charges[0] * cfgMomentumScalingBetheBloch->get(0u, 1u) / nuclei::masses[0]},
-      {nuclei::charges[1] * cfgMomentumScalingBetheBloch->get(1u, 0u) / nuclei::masses[1], nuclei::charges[1] * cfgMomentumScalingBetheBloch->get(1u, 1u) / nuclei::masses[1]},
-      {nuclei::charges[2] * cfgMomentumScalingBetheBloch->get(2u, 0u) / nuclei::masses[2], nuclei::charges[2] * cfgMomentumScalingBetheBloch->get(2u, 1u) / nuclei::masses[2]},
-      {nuclei::charges[3] * cfgMomentumScalingBetheBloch->get(3u, 0u) / nuclei::masses[3], nuclei::charges[3] * cfgMomentumScalingBetheBloch->get(3u, 1u) / nuclei::masses[3]},
-      {nuclei::charges[4] * cfgMomentumScalingBetheBloch->get(3u, 0u) / nuclei::masses[4], nuclei::charges[4] * cfgMomentumScalingBetheBloch->get(3u, 1u) / nuclei::masses[4]}};
+    float psiFT0C{0.f}; // event plane of the flow histograms
+    if constexpr (std::is_same<Tcoll, CollWithEP>::value) {
+      psiFT0C = collision.psiFT0C();
+    } else if constexpr (std::is_same<Tcoll, CollWithQvec>::value) {
+      psiFT0C = computeEventPlane(collision.qvecFT0CIm(), collision.qvecFT0CRe());
+    }
 
     int nGloTracks[2]{0, 0}, nTOFTracks[2]{0, 0};
     for (auto& track : tracks) { // start loop over tracks
@@ -492,8 +502,8 @@ struct nucleiSpectra {
 
       bool selectedTPC[5]{false}, goodToAnalyse{false};
       for (int iS{0}; iS < nuclei::species; ++iS) {
-        double expBethe{tpc::BetheBlochAleph(static_cast<double>(correctedTpcInnerParam * bgScalings[iS][iC]), cfgBetheBlochParams->get(iS, 0u), cfgBetheBlochParams->get(iS, 1u), cfgBetheBlochParams->get(iS, 2u), cfgBetheBlochParams->get(iS, 3u), cfgBetheBlochParams->get(iS, 4u))};
-        double expSigma{expBethe * cfgBetheBlochParams->get(iS, 5u)};
+        double expBethe{mBBTables[iS](static_cast<double>(correctedTpcInnerParam * mBgScalings[iS][iC]))};
+        double expSigma{expBethe * mBBResolution[iS]};
         nSigma[0][iS] = static_cast<float>((track.tpcSignal() - expBethe) / expSigma);
         selectedTPC[iS] = (nSigma[0][iS] > nuclei::pidCuts[0][iS][0] && nSigma[0][iS] < nuclei::pidCuts[0][iS][1]);
         goodToAnalyse = goodToAnalyse || selectedTPC[iS];
@@ -555,13 +565,13 @@ struct nucleiSpectra {
 
                 if (cfgFlowHist->get(iS) && doprocessDataFlow) {
                   if constexpr (std::is_same<Tcoll, CollWithEP>::value) {
-                    auto deltaPhiInRange = getPhiInRange(fvector.phi() - collision.psiFT0C());
+                    auto deltaPhiInRange = getPhiInRange(fvector.phi() - psiFT0C);
                     auto v2 = std::cos(2.0 * deltaPhiInRange);
                     nuclei::hFlowHists[iC][iS]->Fill(collision.centFT0C(), fvector.pt(), nSigma[0][iS], tofMass, v2, track.itsNCls(), track.tpcNClsFound(), track.hasTRD());
                   }
                 } else if (cfgFlowHist->get(iS) && doprocessDataFlowAlternative) {
                   if constexpr (std::is_same<Tcoll, CollWithQvec>::value) {
-                    auto deltaPhiInRange = getPhiInRange(fvector.phi() - computeEventPlane(collision.qvecFT0CIm(), collision.qvecFT0CRe()));
+                    auto deltaPhiInRange = getPhiInRange(fvector.phi() - psiFT0C);
                     auto v2 = std::cos(2.0 * deltaPhiInRange);
                     nuclei::hFlowHists[iC][iS]->Fill(collision.centFT0C(), fvector.pt(), nSigma[0][iS], tofMass, v2, track.itsNCls(), track.tpcNClsFound(), track.hasTRD());
                   }
@@ -582,35 +592,6 @@ struct nucleiSpectra {
         }
       }
       if (flag & (kProton | kDeuteron | kTriton | kHe3 | kHe4) || doprocessMC) { /// ignore PID pre-selections for the MC
-        if constexpr (std::is_same<Tcoll, CollWithEP>::value) {
-          nuclei::candidates_flow.emplace_back(NucleusCandidateFlow{
-            collision.centFV0A(),
-            collision.centFT0M(),
-            collision.centFT0A(),
-            collision.centFT0C(),
-            collision.psiFT0A(),
-            collision.multFT0A(),
-            collision.psiFT0C(),
-            collision.multFT0C(),
-            collision.psiTPC(),
-            collision.psiTPCL(),
-            collision.psiTPCR(),
-            collision.multTPC()});
-        } else if constexpr (std::is_same<Tcoll, CollWithQvec>::value) {
-          nuclei::candidates_flow.emplace_back(NucleusCandidateFlow{
-            collision.centFV0A(),
-            collision.centFT0M(),
-            collision.centFT0A(),
-            collision.centFT0C(),
-            computeEventPlane(collision.qvecFT0AIm(), collision.qvecFT0ARe()),
-            collision.multFT0A(),
-            computeEventPlane(collision.qvecFT0CIm(), collision.qvecFT0CRe()),
-            collision.multFT0C(),
-            -999.,
-            computeEventPlane(collision.qvecBNegIm(), collision.qvecBNegRe()),
-            computeEventPlane(collision.qvecBPosIm(), collision.qvecBPosRe()),
-            collision.multTPC()});
-        }
         nuclei::candidates.emplace_back(NucleusCandidate{static_cast<int>(track.globalIndex()), (1 - 2 * iC) * trackParCov.getPt(), trackParCov.getEta(), trackParCov.getPhi(), correctedTpcInnerParam, beta, collision.posZ(), dcaInfo[0], dcaInfo[1], track.tpcSignal(), track.itsChi2NCl(), track.tpcChi2NCl(), flag, track.tpcNClsFindable(), static_cast<uint8_t>(track.tpcNClsCrossedRows()), track.itsClusterMap(), static_cast<uint8_t>(track.tpcNClsFound()), static_cast<uint32_t>(track.itsClusterSizes())});
       }
     } // end loop over tracks
@@ -619,6 +600,41 @@ struct nucleiSpectra {
     nuclei::hGloTOFtracks[1]->Fill(nGloTracks[1], nTOFTracks[1]);
   }
 
+  /// Flow information of a collision, the same for all its candidates
+  template <typename Tcoll>
+  NucleusCandidateFlow getFlowInfo(Tcoll const& collision)
+  {
+    if constexpr (std::is_same<Tcoll, CollWithEP>::value) {
+      return NucleusCandidateFlow{
+        collision.centFV0A(),
+        collision.centFT0M(),
+        collision.centFT0A(),
+        collision.centFT0C(),
+        collision.psiFT0A(),
+        collision.multFT0A(),
+        collision.psiFT0C(),
+        collision.multFT0C(),
+        collision.psiTPC(),
+        collision.psiTPCL(),
+        collision.psiTPCR(),
+        collision.multTPC()};
+    } else {
+      return NucleusCandidateFlow{
+        collision.centFV0A(),
+        collision.centFT0M(),
+        collision.centFT0A(),
+        collision.centFT0C(),
+        computeEventPlane(collision.qvecFT0AIm(), collision.qvecFT0ARe()),
+        collision.multFT0A(),
+        computeEventPlane(collision.qvecFT0CIm(), collision.qvecFT0CRe()),
+        collision.multFT0C(),
+        -999.,
+        computeEventPlane(collision.qvecBNegIm(), collision.qvecBNegRe()),
+        computeEventPlane(collision.qvecBPosIm(), collision.qvecBPosRe()),
+        collision.multTPC()};
+    }
+  }
+
   void processData(soa::Join<aod::Collisions, aod::EvSels>::iterator const& collision, TrackCandidates const& tracks, aod::BCsWithTimestamps const&)
   {
     nuclei::candidates.clear();
@@ -639,7 +655,6 @@ struct nucleiSpectra {
   void processDataFlow(CollWithEP const& collision, TrackCandidates const& tracks, aod::BCsWithTimestamps const&)
   {
     nuclei::candidates.clear();
-    nuclei::candidates_flow.clear();
     if (!eventSelection(collision)) {
       return;
     }
@@ -647,11 +662,10 @@ struct nucleiSpectra {
       return;
     }
     fillDataInfo(collision, tracks);
+    const auto f = getFlowInfo(collision);
     for (auto& c : nuclei::candidates) {
       nucleiTable(c.pt, c.eta, c.phi, c.tpcInnerParam, c.beta, c.zVertex, c.DCAxy, c.DCAz, c.TPCsignal, c.ITSchi2, c.TPCchi2, c.flags, c.TPCfindableCls, c.TPCcrossedRows, c.ITSclsMap, c.TPCnCls, c.clusterSizesITS);
-    }
-    for (auto& c : nuclei::candidates_flow) {
-      nucleiTableFlow(c.centFV0A, c.centFT0M, c.centFT0A, c.centFT0C, c.psiFT0A, c.multFT0A, c.psiFT0C, c.multFT0C, c.psiTPC, c.psiTPCl, c.psiTPCr, c.multTPC);
+      nucleiTableFlow(f.centFV0A, f.centFT0M, f.centFT0A, f.centFT0C, f.psiFT0A, f.multFT0A, f.psiFT0C, f.multFT0C, f.psiTPC, f.psiTPCl, f.psiTPCr, f.multTPC);
     }
   }
   PROCESS_SWITCH(nucleiSpectra, processDataFlow, "Data analysis with flow", false);
@@ -659,7 +673,6 @@ struct nucleiSpectra {
   void processDataFlowAlternative(CollWithQvec const& collision, TrackCandidates const& tracks, aod::BCsWithTimestamps const&)
   {
     nuclei::candidates.clear();
-    nuclei::candidates_flow.clear();
     if (!eventSelection(collision)) {
       return;
     }
@@ -667,11 +680,10 @@ struct nucleiSpectra {
       return;
     }
     fillDataInfo(collision, tracks);
+    const auto f = getFlowInfo(collision);
     for (auto& c : nuclei::candidates) {
       nucleiTable(c.pt, c.eta, c.phi, c.tpcInnerParam, c.beta, c.zVertex, c.DCAxy, c.DCAz, c.TPCsignal, c.ITSchi2, c.TPCchi2, c.flags, c.TPCfindableCls, c.TPCcrossedRows, c.ITSclsMap, c.TPCnCls, c.clusterSizesITS);
-    }
-    for (auto& c : nuclei::candidates_flow) {
-      nucleiTableFlow(c.centFV0A, c.centFT0M, c.centFT0A, c.centFT0C, c.psiFT0A, c.multFT0A, c.psiFT0C, c.multFT0C, c.psiTPC, c.psiTPCl, c.psiTPCr, c.multTPC);
+      nucleiTableFlow(f.centFV0A, f.centFT0M, f.centFT0A, f.centFT0C, f.psiFT0A, f.multFT0A, f.psiFT0C, f.multFT0C, f.psiTPC, f.psiTPCl, f.psiTPCr, f.multTPC);
     }
   }
   PROCESS_SWITCH(nucleiSpectra, processDataFlowAlternative, "Data analysis with flow - alternative framework", false);
@@ -680,6 +692,7 @@ struct nucleiSpectra {
   void processMC(soa::Join<aod::Collisions, aod::EvSels, aod::McCollisionLabels> const& collisions, aod::McCollisions const& mcCollisions, TrackCandidates const& tracks, aod::McTrackLabels const& trackLabelsMC, aod::McParticles const& particlesMC, aod::BCsWithTimestamps const&)
   {
     nuclei::candidates.clear();
+    nuclei::candidates.reserve(tracks.size()); // candidates of all the collisions of the dataframe, at most one per track
     for (auto& c : mcCollisions) {
       spectra.fill(HIST("hGenVtxZ"), c.posZ());
     }
@@ -51,6 +51,9 @@
 #include "DataFormatsParameters/GRPMagField.h"
 #include "CCDB/BasicCCDBManager.h"
 
+#include <tuple>
+#include <vector>
+
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::framework::expressions;
@@ -62,6 +65,7 @@ struct reso2dfmerged {
   //  SliceCache cache;
 
   Configurable<int> nDF{"nDF", 1, "no of combination of collision"};
+  Configurable<int> nMaxBufferedTracks{"nMaxBufferedTracks", 0, "Write the merged collisions once this number of tracks is buffered, even before nDF collisions (0 = no limit)"};
   HistogramRegistry histos{"histos", {}, OutputObjHandlingPolicy::AnalysisObject};
 
   using resoCols = aod::ResoCollisions;
@@ -77,30 +81,27 @@ struct reso2dfmerged {
   Produces<aod::ResoTrackDFs> reso2trksdf;
   int df = 0;
 
+  using TrackRow = std::tuple<float, float, float, float,
+                              float, float, signed char, unsigned char, unsigned char, unsigned char,
+                              float, float, float, float,
+                              bool, float, float, float,
+                              float, float, float, float,
+                              float, float, bool, bool,
+                              bool, bool, bool, bool, float, float, float>;
+
+  // buffered collisions, with the first of their tracks in the flat track buffer
   std::vector<std::tuple<float, float, float, float, float, float>> vecOfTuples;
-  std::vector<std::vector<std::tuple<float, float, float, float,
-                                     float, float, signed char, unsigned char, unsigned char, unsigned char,
-                                     float, float, float, float,
-                                     bool, float, float, float,
-                                     float, float, float, float,
-                                     float, float, bool, bool,
-                                     bool, bool, bool, bool, float, float, float>>>
-    vecOfVecOfTuples;
+  std::vector<size_t> vecOfFirstTrack;
+  std::vector<TrackRow> vecOfTracks; // tracks of all the buffered collisions, kept in collision order
+
   void processTrackDataDF(resoCols::iterator const& collision, resoTracks const& tracks)
   {
 
     int nCollisions = nDF;
     vecOfTuples.push_back(std::make_tuple(collision.posX(), collision.posY(), collision.posZ(), collision.cent(), collision.spherocity(), collision.evtPl()));
-    std::vector<std::tuple<float, float, float, float,
-                           float, float, signed char, unsigned char, unsigned char, unsigned char,
-                           float, float, float, float,
-                           bool, float, float, float,
-                           float, float, float, float,
-                           float, float, bool, bool,
-                           bool, bool, bool, bool, float, float, float>>
-      innerVector;
+    vecOfFirstTrack.push_back(vecOfTracks.size());
     for (auto& track : tracks) {
-      innerVector.push_back(std::make_tuple(
+      vecOfTracks.emplace_back(
         track.pt(),
         track.px(),
         track.py(),
@@ -133,64 +134,31 @@ struct reso2dfmerged {
         track.isPVContributor(),
         track.tpcCrossedRowsOverFindableCls(),
         track.itsChi2NCl(),
-        track.tpcChi2NCl()));
+        track.tpcChi2NCl());
     }
 
-    vecOfVecOfTuples.push_back(innerVector);
-    innerVector.clear();
     df++;
-    if (df < nCollisions)
+    if (df < nCollisions && (nMaxBufferedTracks <= 0 || vecOfTracks.size() < static_cast<size_t>(nMaxBufferedTracks)))
       return;
     df = 0;
 
+    vecOfFirstTrack.push_back(vecOfTracks.size());
     for (size_t i = 0; i < vecOfTuples.size(); ++i) {
       const auto& tuple = vecOfTuples[i];
-      const auto& innerVector = vecOfVecOfTuples[i];
 
       histos.fill(HIST("Event/h1d_ft0_mult_percentile"), std::get<3>(tuple));
       resoCollisionsdf(std::get<0>(tuple), std::get<1>(tuple), std::get<2>(tuple), std::get<3>(tuple), std::get<4>(tuple), std::get<5>(tuple), 0., 0., 0., 0, 0);
       //  LOGF(info, "collisions: Index = %d ) %f - %f - %f %f %d -- %d", std::get<0>(tuple).globalIndex(),std::get<1>(tuple),std::get<2>(tuple), std::get<3>(tuple), std::get<4>(tuple), std::get<5>(tuple).size(),resoCollisionsdf.lastIndex());
 
-      for (const auto& tuple : innerVector) {
-        reso2trksdf(resoCollisionsdf.lastIndex(),
-                    std::get<0>(tuple),
-                    std::get<1>(tuple),
-                    std::get<2>(tuple),
-                    std::get<3>(tuple),
-                    std::get<4>(tuple),
-                    std::get<5>(tuple),
-                    std::get<6>(tuple),
-                    std::get<7>(tuple),
-                    std::get<8>(tuple),
-                    std::get<9>(tuple),
-                    std::get<10>(tuple),
-                    std::get<11>(tuple),
-                    std::get<12>(tuple),
-                    std::get<13>(tuple),
-                    std::get<14>(tuple),
-                    std::get<15>(tuple),
-                    std::get<16>(tuple),
-                    std::get<17>(tuple),
-                    std::get<18>(tuple),
-                    std::get<19>(tuple),
-                    std::get<20>(tuple),
-                    std::get<21>(tuple),
-                    std::get<22>(tuple),
-                    std::get<23>(tuple),
-                    std::get<24>(tuple),
-                    std::get<25>(tuple),
-                    std::get<26>(tuple),
-                    std::get<27>(tuple),
-                    std::get<28>(tuple),
-                    std::get<29>(tuple),
-                    std::get<30>(tuple),
-                    std::get<31>(tuple),
-                    std::get<32>(tuple));
+      for (size_t iTrack = vecOfFirstTrack[i]; iTrack < vecOfFirstTrack[i + 1]; ++iTrack) {
+        std::apply([&](auto... values) { reso2trksdf(resoCollisionsdf.lastIndex(), values...); }, vecOfTracks[iTrack]);
       }
     }
 
+    // the buffers keep their capacity for the next merged collisions
     vecOfTuples.clear();
-    vecOfVecOfTuples.clear(); //
+    vecOfFirstTrack.clear();
+    vecOfTracks.clear();
   }
 
   PROCESS_SWITCH(reso2dfmerged, processTrackDataDF, "Process for data merged DF", true);
@@ -42,6 +42,7 @@
 #include <map>
 #include <iterator>
 #include <utility>
+#include <vector>
 
 #include "Framework/runDataProcessing.h"
 #include "Framework/RunningWorkflowInfo.h"
@@ -61,6 +62,7 @@
 #include "DataFormatsParameters/GRPObject.h"
 #include "DataFormatsParameters/GRPMagField.h"
 #include "CCDB/BasicCCDBManager.h"
+#include "TableHelper.h"
 #include "Tools/ML/MlResponse.h"
 #include "Tools/ML/model.h"
 
@@ -320,6 +322,21 @@ struct cascadeBuilder {
   o2::track::TrackParCov lV0Track;
   o2::track::TrackParCov lCascadeTrack;
 
+  // DCA fitter results of the V0s of the dataframe, indexed by V0 global index
+  // (shared by all the cascades built with the same V0 in the KF pre-minimisation)
+  enum v0FitStatus : uint8_t { kV0NotFitted = 0,
+                               kV0Fitted,
+                               kV0NoCandidate,
+                               kV0FitException };
+  struct v0FitResult {
+    uint8_t status = kV0NotFitted;
+    o2::track::TrackParCov posTrack; // at the PCA
+    o2::track::TrackParCov negTrack; // at the PCA
+    float dcaV0dau = 0.f;
+  };
+  std::vector<v0FitResult> v0FitCache;
+  std::vector<float> mlInputFeatures; // reused for each candidate
+
   // Helper struct to do bookkeeping of building parameters
   struct {
     std::array<int32_t, kNCascSteps> cascstats;
@@ -647,6 +664,13 @@ struct cascadeBuilder {
       lambdaMassWindow.value = loosest_v0masswindow;
     }
 
+    // auto mode (-1) of the optional tables: fill them, and compute what only they need
+    // (covariance matrices), only if some device of the workflow subscribes to them
+    if (createCascCovMats < 0) {
+      createCascCovMats.value = isTableRequiredInWorkflow(context, "CascCovs") || isTableRequiredInWorkflow(context, "KFCascCovs");
+    }
+    enableFlagIfTableRequired(context, "CascTrackXs", createCascTrackXs);
+
     //*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*
     LOGF(info, "Strangeness builder configuration:");
     if (doprocessRun2 == true) {
@@ -1185,24 +1209,24 @@ struct cascadeBuilder {
         mlConfigurations.calculateOmegaPlusScores) {
       // machine learning is on, go for calculation of thresholds
       // FIXME THIS NEEDS ADJUSTING
-      std::vector<float> inputFeatures{0.0f, 0.0f,
-                                       0.0f, 0.0f};
+      mlInputFeatures = {0.0f, 0.0f,
+                         0.0f, 0.0f};
 
       // calculate scores
       if (mlConfigurations.calculateXiMinusScores) {
-        float* xiMinusProbability = mlModelXiMinus.evalModel(inputFeatures);
+        float* xiMinusProbability = mlModelXiMinus.evalModel(mlInputFeatures);
         cascadecandidate.mlXiMinusScore = xiMinusProbability[1];
       }
       if (mlConfigurations.calculateXiPlusScores) {
-        float* xiPlusProbability = mlModelXiPlus.evalModel(inputFeatures);
+        float* xiPlusProbability = mlModelXiPlus.evalModel(mlInputFeatures);
         cascadecandidate.mlXiPlusScore = xiPlusProbability[1];
       }
       if (mlConfigurations.calculateOmegaMinusScores) {
-        float* omegaMinusProbability = mlModelOmegaMinus.evalModel(inputFeatures);
+        float* omegaMinusProbability = mlModelOmegaMinus.evalModel(mlInputFeatures);
         cascadecandidate.mlOmegaMinusScore = omegaMinusProbability[1];
       }
       if (mlConfigurations.calculateOmegaPlusScores) {
-        float* omegaPlusProbability = mlModelOmegaPlus.evalModel(inputFeatures);
+        float* omegaPlusProbability = mlModelOmegaPlus.evalModel(mlInputFeatures);
         cascadecandidate.mlOmegaPlusScore = omegaPlusProbability[1];
       }
 
@@ -1286,22 +1310,39 @@ struct cascadeBuilder {
     //*>~<* step 1 : V0 with dca fitter, uses material corrections implicitly
     // This is optional - move close to minima and therefore take material
     if (kfDoDCAFitterPreMinimV0) {
-      int nCand = 0;
-      try {
-        nCand = fitter.process(posTrackParCov, negTrackParCov);
-      } catch (...) {
-        LOG(error) << "Exception caught in DCA fitter process call!";
-        return false;
+      // each V0 is fitted once, at the first cascade using it
+      if (static_cast<std::size_t>(v0.globalIndex()) >= v0FitCache.size()) {
+        v0FitCache.resize(v0.globalIndex() + 1);
       }
-      if (nCand == 0) {
+      auto& v0Fit = v0FitCache[v0.globalIndex()];
+      if (v0Fit.status == kV0NotFitted) {
+        int nCand = 0;
+        try {
+          nCand = fitter.process(posTrackParCov, negTrackParCov);
+        } catch (...) {
+          LOG(error) << "Exception caught in DCA fitter process call!";
+          v0Fit.status = kV0FitException;
+        }
+        if (v0Fit.status == kV0NotFitted) {
+          if (nCand == 0) {
+            v0Fit.status = kV0NoCandidate;
+          } else {
+            v0Fit.status = kV0Fitted;
+            v0Fit.posTrack = fitter.getTrack(0);
+            v0Fit.negTrack = fitter.getTrack(1);
+            v0Fit.dcaV0dau = TMath::Sqrt(fitter.getChi2AtPCACandidate());
+          }
+        }
+      }
+      if (v0Fit.status != kV0Fitted) {
         return false;
       }
       // save classical DCA daughters
-      cascadecandidate.v0dcadau = TMath::Sqrt(fitter.getChi2AtPCACandidate());
+      cascadecandidate.v0dcadau = v0Fit.dcaV0dau;
 
       // re-acquire from DCA fitter
-      posTrackParCov = fitter.getTrack(0);
-      negTrackParCov = fitter.getTrack(1);
+      posTrackParCov = v0Fit.posTrack;
+      negTrackParCov = v0Fit.negTrack;
     }
 
     //__________________________________________
@@ -1497,6 +1538,11 @@ struct cascadeBuilder {
     cascadecandidate.yXi = KFXi.GetRapidity();
     cascadecandidate.yOmega = KFOmega.GetRapidity();
 
+    registry.fill(HIST("hKFParticleStatistics"), 1.0f);
+    if (!createCascCovMats) {
+      return true;
+    }
+
     // KF Cascade covariance matrix
     o2::gpu::gpustd::array<float, 21> covCascKF;
     for (int i = 0; i < 21; i++) { // get covariance matrix elements (lower triangle)
@@ -1519,8 +1565,6 @@ struct cascadeBuilder {
       cascadecandidate.kfV0DauPosCov[i] = cvPosKF[i];
       cascadecandidate.kfV0DauNegCov[i] = cvNegKF[i];
     }
-
-    registry.fill(HIST("hKFParticleStatistics"), 1.0f);
     return true;
   }
 
@@ -1928,8 +1972,10 @@ struct cascadeBuilder {
   }
   PROCESS_SWITCH(cascadeBuilder, processFindableRun3, "Produce Run 3 findable cascade tables", false);
 
-  void processRun3withKFParticle(aod::Collisions const& collisions, soa::Filtered<TaggedCascades> const& cascades, FullTracksExtIU const&, aod::BCsWithTimestamps const&, aod::V0s const&)
+  void processRun3withKFParticle(aod::Collisions const& collisions, soa::Filtered<TaggedCascades> const& cascades, FullTracksExtIU const&, aod::BCsWithTimestamps const&, aod::V0s const& v0s)
   {
+    // V0 fits are cached for the whole dataframe
+    v0FitCache.assign(v0s.size(), v0FitResult{});
     for (const auto& collision : collisions) {
       // Fire up CCDB
       auto bc = collision.bc_as<aod::BCsWithTimestamps>();
@@ -2328,15 +2374,14 @@ struct cascadeInitializer {
 struct cascadeLinkBuilder {
   Produces<aod::CascDataLink> cascdataLink;
 
+  std::vector<int> lIndices; // reused across dataframes
+
   void init(InitContext const&) {}
 
   // build Cascade -> CascData link table
   void processFound(aod::Cascades const& casctable, aod::CascDatas const& cascdatatable)
   {
-    std::vector<int> lIndices;
-    lIndices.reserve(casctable.size());
-    for (int ii = 0; ii < casctable.size(); ii++)
-      lIndices[ii] = -1;
+    lIndices.assign(casctable.size(), -1);
     for (auto& cascdata : cascdatatable) {
       lIndices[cascdata.cascadeId()] = cascdata.globalIndex();
     }
@@ -2348,10 +2393,7 @@ struct cascadeLinkBuilder {
   // build Cascade -> CascData link table
   void processFindable(aod::FindableCascades const& casctable, aod::CascDatas const& cascdatatable)
   {
-    std::vector<int> lIndices;
-    lIndices.reserve(casctable.size());
-    for (int ii = 0; ii < casctable.size(); ii++)
-      lIndices[ii] = -1;
+    lIndices.assign(casctable.size(), -1);
     for (auto& cascdata : cascdatatable) {
       lIndices[cascdata.cascadeId()] = cascdata.globalIndex();
     }
@@ -2367,15 +2409,14 @@ struct cascadeLinkBuilder {
 struct kfcascadeLinkBuilder {
   Produces<aod::KFCascDataLink> cascdataLink;
 
+  std::vector<int> lIndices; // reused across dataframes
+
   void init(InitContext const&) {}
 
   // build Cascade -> CascData link table
   void process(aod::Cascades const& casctable, aod::KFCascDatas const& cascdatatable)
   {
-    std::vector<int> lIndices;
-    lIndices.reserve(casctable.size());
-    for (int ii = 0; ii < casctable.size(); ii++)
-      lIndices[ii] = -1;
+    lIndices.assign(casctable.size(), -1);
     for (auto& cascdata : cascdatatable) {
       lIndices[cascdata.cascadeId()] = cascdata.globalIndex();
     }
@@ -2388,15 +2429,14 @@ struct kfcascadeLinkBuilder {
 struct tracascadeLinkBuilder {
   Produces<aod::TraCascDataLink> cascdataLink;
 
+  std::vector<int> lIndices; // reused across dataframes
+
   void init(InitContext const&) {}
 
   // build Cascade -> CascData link table
   void process(aod::Cascades const& casctable, aod::TraCascDatas const& cascdatatable)
   {
-    std::vector<int> lIndices;
-    lIndices.reserve(casctable.size());
-    for (int ii = 0; ii < casctable.size(); ii++)
-      lIndices[ii] = -1;
+    lIndices.assign(casctable.size(), -1);
     for (auto& cascdata : cascdatatable) {
       lIndices[cascdata.cascadeId()] = cascdata.globalIndex();
     }
@@ -38,10 +38,13 @@
 
 #include <cmath>
 #include <array>
+#include <algorithm>
 #include <cstdlib>
 #include <map>
 #include <iterator>
 #include <utility>
+#include <thread>
+#include <vector>
 
 #include "TRandom3.h"
 #include "Framework/runDataProcessing.h"
@@ -51,6 +54,7 @@
 #include "Framework/ASoAHelpers.h"
 #include "DCAFitter/DCAFitterN.h"
 #include "ReconstructionDataFormats/Track.h"
+#include "Common/Core/ProcessTimers.h"
 #include "Common/Core/RecoDecay.h"
 #include "Common/Core/trackUtilities.h"
 #include "PWGLF/DataModel/LFStrangenessTables.h"
@@ -130,13 +134,14 @@ struct lambdakzeroBuilder {
   // Configurables related to table creation
   Configurable<int> createV0CovMats{"createV0CovMats", -1, {"Produces V0 cov matrices. -1: auto, 0: don't, 1: yes. Default: auto (-1)"}};
   Configurable<int> createV0DauCovMats{"createV0DauCovMats", -1, {"Produces V0 cov matrices for daughter tracks. -1: auto, 0: don't, 1: yes. Default: auto (-1)"}};
-  Configurable<int> createV0PosAtDCAs{"createV0PosAtDCAs", 0, {"Produces V0 track positions at minima. 0: don't, 1: yes. Default: no (0)"}};
+  Configurable<int> createV0PosAtDCAs{"createV0PosAtDCAs", 0, {"Produces V0 track positions at minima. -1: auto, 0: don't, 1: yes. Default: no (0)"}};
   Configurable<int> createV0PosAtIUs{"createV0PosAtIUs", 0, {"Produces V0 track positions at IU. 0: don't, 1: yes. Default: no (0)"}};
 
   Configurable<bool> storePhotonCandidates{"storePhotonCandidates", false, "store photon candidates (yes/no)"};
 
   // use auto-detect configuration
   Configurable<bool> d_UseAutodetectMode{"d_UseAutodetectMode", false, "Autodetect requested topo sels"};
+  Configurable<bool> enableProcessTimers{"enableProcessTimers", false, "time the process functions (in builds with O2PHYSICS_PROCESS_TIMERS)"};
 
   // downscaling for testing
   unsigned int randomSeed = 0;
@@ -204,6 +209,7 @@ struct lambdakzeroBuilder {
     Configurable<float> d_maxDXYIni{"dcaFitterConfigurations.d_maxDXYIni", 4, "Dont consider a seed (circles intersection) if XY distance exceeds this"};
     Configurable<int> useMatCorrType{"dcaFitterConfigurations.useMatCorrType", 2, "0: none, 1: TGeo, 2: LUT"};
     Configurable<int> rejDiffCollTracks{"dcaFitterConfigurations.rejDiffCollTracks", 0, "rejDiffCollTracks"};
+    Configurable<int> nThreads{"dcaFitterConfigurations.nThreads", 1, "number of threads for the V0 fits of a dataframe (not with TGeo material corrections)"};
   } dcaFitterConfigurations;
 
   // CCDB options
@@ -283,6 +289,46 @@ struct lambdakzeroBuilder {
 
   // Define o2 fitter, 2-prong, active memory (no need to redefine per event)
   o2::vertexing::DCAFitterN<2> fitter;
+  int nThreadsFit = 1;
+
+  // V0 candidates of a dataframe passing the track selections, stored as contiguous arrays
+  // so that all DCA fits can be run in one go (and on several threads) before the selections
+  struct {
+    // inputs of the fit
+    std::vector<o2::track::TrackParCov> posTracksIU;
+    std::vector<o2::track::TrackParCov> negTracksIU;
+    std::vector<uint8_t> collinear;
+    // quantities from the track selections
+    std::vector<o2::dataformats::VertexBase> primaryVertices;
+    std::vector<float> posDCAxy;
+    std::vector<float> negDCAxy;
+    std::vector<o2::track::TrackPar> posTracksAtDCA; // at the DCA to the PV, for the QA
+    std::vector<o2::track::TrackPar> negTracksAtDCA;
+    std::vector<std::array<float, 2>> negDcaInfos; // for the QA
+    // outputs of the fit
+    std::vector<int> nCands; // -1 if the fitter threw an exception
+    std::vector<o2::track::TrackParCov> posTracks;
+    std::vector<o2::track::TrackParCov> negTracks;
+    std::vector<std::array<float, 3>> vertices;
+    std::vector<float> chi2s;
+    std::vector<std::array<float, 6>> vertexCovs;
+
+    void clear()
+    {
+      posTracksIU.clear();
+      negTracksIU.clear();
+      collinear.clear();
+      primaryVertices.clear();
+      posDCAxy.clear();
+      negDCAxy.clear();
+      posTracksAtDCA.clear();
+      negTracksAtDCA.clear();
+      negDcaInfos.clear();
+    }
+    std::size_t size() const { return posTracksIU.size(); }
+  } v0fits;
+  std::vector<int64_t> v0FitIndices; // index in v0fits of each V0 of the dataframe, -1 if not fitted
+  std::vector<float> mlInputFeatures; // reused for each candidate
 
   // provision to repeat mass selections while doing AND with PID selections
   // fixme : this could be done more uniformly svertexer with reconstruction
@@ -350,6 +396,14 @@ struct lambdakzeroBuilder {
      {"hPositiveITSClusters", "hPositiveITSClusters", {HistType::kTH1D, {{10, -0.5f, 9.5f}}}},
      {"hNegativeITSClusters", "hNegativeITSClusters", {HistType::kTH1D, {{10, -0.5f, 9.5f}}}}}};
 
+  // timers of the process functions and of their stages, see Common/Core/ProcessTimers.h
+  enum TimedStage { kTimeProcessRun2 = 0,
+                    kTimeProcessRun3,
+                    kTimeProcessFindableRun3,
+                    kTimeInitCCDB,
+                    kTimeBuildTables };
+  ProcessTimers processTimers;
+
   // +-~-+-~-+-~-+-~-+-~-+-~-+-~-+-~-+-~-+-~-+-~-+-~-+-~-+-~-+-~-+-~-+
   // tools for downsampling (Marian)
   float TsallisCharged(float pt)
@@ -439,6 +493,7 @@ struct lambdakzeroBuilder {
   {
     prng.SetSeed(0);
     resetHistos();
+    processTimers.init(registry, {"processRun2", "processRun3", "processFindableRun3", "initCCDB", "buildStrangenessTables"}, enableProcessTimers);
     auto h = registry.add<TH1>("hV0Criteria", "hV0Criteria", kTH1D, {{10, -0.5f, 9.5f}});
     h->GetXaxis()->SetBinLabel(1, "All sel");
     h->GetXaxis()->SetBinLabel(2, "TPC requirement");
@@ -612,7 +667,6 @@ struct lambdakzeroBuilder {
             LOGF(info, "Device named %s has subscribed to V0Covs table! Enabling.", device.name);
             createV0CovMats.value = 1;
           }
-          enableFlagIfTableRequired(context, "V0DauCovs", createV0DauCovMats);
         }
       }
       LOGF(info, "Self-configuration finished! Decided on selections:");
@@ -629,6 +683,18 @@ struct lambdakzeroBuilder {
       v0radius.value = loosest_radius;
     }
 
+    // auto mode (-1) of the optional tables: fill them, and compute what only they need
+    // (covariance matrices, IU positions), only if some device of the workflow subscribes to them
+    if (createV0CovMats < 0) {
+      createV0CovMats.value = isTableRequiredInWorkflow(context, "V0Covs") || isTableRequiredInWorkflow(context, "V0fCCovs");
+    }
+    if (createV0DauCovMats < 0) {
+      createV0DauCovMats.value = isTableRequiredInWorkflow(context, "V0DauCovs") || isTableRequiredInWorkflow(context, "V0DauCovIUs");
+    }
+    if (createV0PosAtDCAs < 0) {
+      createV0PosAtDCAs.value = isTableRequiredInWorkflow(context, "V0TraPosAtDCAs") || isTableRequiredInWorkflow(context, "V0TraPosAtIUs");
+    }
+
     //*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*
     LOGF(info, " -+*> process call configuration:");
     if (doprocessRun2 == true) {
@@ -663,6 +729,13 @@ struct lambdakzeroBuilder {
     if (dcaFitterConfigurations.useMatCorrType == 2)
       matCorr = o2::base::Propagator::MatCorrType::USEMatCorrLUT;
     fitter.setMatCorrType(matCorr);
+
+    // the TGeo material queries are not thread safe
+    nThreadsFit = std::max(1, dcaFitterConfigurations.nThreads.value);
+    if (nThreadsFit > 1 && matCorr == o2::base::Propagator::MatCorrType::USEMatCorrTGeo) {
+      LOGF(warn, "TGeo material corrections requested: the V0 fits will run on 1 thread");
+      nThreadsFit = 1;
+    }
   }
 
   void initCCDB(aod::BCsWithTimestamps::iterator const& bc)
@@ -782,8 +855,9 @@ struct lambdakzeroBuilder {
     LOG(info) << "ML Models loaded.";
   }
 
+  // track selections of a V0 candidate, the candidates passing them are added to the fits of the dataframe
   template <class TTrackTo, typename TV0Object>
-  bool buildV0Candidate(TV0Object const& V0)
+  bool addV0Candidate(TV0Object const& V0)
   {
     // Get tracks
     auto const& posTrack = V0.template posTrack_as<TTrackTo>();
@@ -828,51 +902,124 @@ struct lambdakzeroBuilder {
       return false;
     }
 
-    // Initialize properly, please
-    v0candidate.posDCAxy = posTrackdcaXY;
-    v0candidate.negDCAxy = negTrackdcaXY;
-
     // passes DCAxy
     statisticsRegistry.v0stats[kV0DCAxy]++;
 
-    // Change strangenessBuilder tracks
-    lPositiveTrack = getTrackParCov(posTrack);
-    lNegativeTrack = getTrackParCov(negTrack);
-    lPositiveTrackIU = getTrackParCov(posTrack);
-    lNegativeTrackIU = getTrackParCov(negTrack);
-
-    //---/---/---/
-    // Move close to minima
-    int nCand = 0;
-    fitter.setCollinear(dcaFitterConfigurations.d_UseCollinearFit || V0.isCollinearV0());
-    try {
-      nCand = fitter.process(lPositiveTrack, lNegativeTrack);
-    } catch (...) {
+    v0fits.posTracksIU.push_back(getTrackParCov(posTrack));
+    v0fits.negTracksIU.push_back(getTrackParCov(negTrack));
+    v0fits.collinear.push_back(dcaFitterConfigurations.d_UseCollinearFit || V0.isCollinearV0());
+    v0fits.primaryVertices.push_back(primaryVertex);
+    v0fits.posDCAxy.push_back(posTrackdcaXY);
+    v0fits.negDCAxy.push_back(negTrackdcaXY);
+    v0fits.posTracksAtDCA.push_back(posTrackPar);
+    v0fits.negTracksAtDCA.push_back(negTrackPar);
+    v0fits.negDcaInfos.push_back({dcaInfo[0], dcaInfo[1]});
+    return true;
+  }
+
+  // DCA fits of the V0 candidates in [first, last), with a private copy of the fitter
+  void fitV0Candidates(std::size_t first, std::size_t last)
+  {
+    auto threadFitter = fitter;
+    for (auto iFit = first; iFit < last; iFit++) {
+      //---/---/---/
+      // Move close to minima
+      threadFitter.setCollinear(v0fits.collinear[iFit]);
+      try {
+        v0fits.nCands[iFit] = threadFitter.process(v0fits.posTracksIU[iFit], v0fits.negTracksIU[iFit]);
+      } catch (...) {
+        v0fits.nCands[iFit] = -1;
+        continue;
+      }
+      if (v0fits.nCands[iFit] == 0) {
+        continue;
+      }
+      v0fits.posTracks[iFit] = threadFitter.getTrack(0);
+      v0fits.negTracks[iFit] = threadFitter.getTrack(1);
+      const auto& vtx = threadFitter.getPCACandidate();
+      for (int i = 0; i < 3; i++) {
+        v0fits.vertices[iFit][i] = vtx[i];
+      }
+      v0fits.chi2s[iFit] = threadFitter.getChi2AtPCACandidate();
+      if (createV0CovMats) {
+        auto covVtxV = threadFitter.calcPCACovMatrix(0);
+        v0fits.vertexCovs[iFit] = {static_cast<float>(covVtxV(0, 0)), static_cast<float>(covVtxV(1, 0)), static_cast<float>(covVtxV(1, 1)),
+                                   static_cast<float>(covVtxV(2, 0)), static_cast<float>(covVtxV(2, 1)), static_cast<float>(covVtxV(2, 2))};
+      }
+    }
+  }
+
+  // DCA fits of all the V0 candidates of the dataframe, split in contiguous chunks over the threads
+  void fitV0Candidates()
+  {
+    const std::size_t nFits = v0fits.size();
+    v0fits.nCands.assign(nFits, 0);
+    v0fits.posTracks.resize(nFits);
+    v0fits.negTracks.resize(nFits);
+    v0fits.vertices.resize(nFits);
+    v0fits.chi2s.resize(nFits);
+    v0fits.vertexCovs.resize(nFits);
+    const std::size_t nChunks = std::clamp<std::size_t>(nThreadsFit, 1, std::max<std::size_t>(nFits, 1));
+    if (nChunks == 1) {
+      fitV0Candidates(0, nFits);
+      return;
+    }
+    const std::size_t chunkSize = (nFits + nChunks - 1) / nChunks;
+    std::vector<std::thread> threads;
+    for (std::size_t iChunk = 1; iChunk < nChunks; iChunk++) {
+      threads.emplace_back([this, iChunk, chunkSize, nFits]() { fitV0Candidates(std::min(iChunk * chunkSize, nFits), std::min((iChunk + 1) * chunkSize, nFits)); });
+    }
+    fitV0Candidates(0, std::min(chunkSize, nFits));
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  // selections of a fitted V0 candidate, populates the v0candidate struct
+  template <class TTrackTo, typename TV0Object>
+  bool buildV0Candidate(TV0Object const& V0, std::size_t iFit)
+  {
+    // Get tracks
+    auto const& posTrack = V0.template posTrack_as<TTrackTo>();
+    auto const& negTrack = V0.template negTrack_as<TTrackTo>();
+    auto const& primaryVertex = v0fits.primaryVertices[iFit];
+    auto const& posTrackPar = v0fits.posTracksAtDCA[iFit];
+    auto const& negTrackPar = v0fits.negTracksAtDCA[iFit];
+    auto const& dcaInfo = v0fits.negDcaInfos[iFit];
+
+    if (v0fits.nCands[iFit] < 0) {
       statisticsRegistry.exceptions++;
       LOG(error) << "Exception caught in DCA fitter process call!";
       return false;
     }
-    if (nCand == 0) {
+    if (v0fits.nCands[iFit] == 0) {
       return false;
     }
 
-    v0candidate.posTrackX = fitter.getTrack(0).getX();
-    v0candidate.negTrackX = fitter.getTrack(1).getX();
+    // Initialize properly, please
+    v0candidate.posDCAxy = v0fits.posDCAxy[iFit];
+    v0candidate.negDCAxy = v0fits.negDCAxy[iFit];
+
+    // Change strangenessBuilder tracks
+    lPositiveTrackIU = v0fits.posTracksIU[iFit];
+    lNegativeTrackIU = v0fits.negTracksIU[iFit];
+    lPositiveTrack = v0fits.posTracks[iFit];
+    lNegativeTrack = v0fits.negTracks[iFit];
+
+    v0candidate.posTrackX = lPositiveTrack.getX();
+    v0candidate.negTrackX = lNegativeTrack.getX();
 
-    lPositiveTrack = fitter.getTrack(0);
-    lNegativeTrack = fitter.getTrack(1);
     lPositiveTrack.getPxPyPzGlo(v0candidate.posP);
     lNegativeTrack.getPxPyPzGlo(v0candidate.negP);
     lPositiveTrack.getXYZGlo(v0candidate.posPosition);
     lNegativeTrack.getXYZGlo(v0candidate.negPosition);
 
     // get decay vertex coordinates
-    const auto& vtx = fitter.getPCACandidate();
     for (int i = 0; i < 3; i++) {
-      v0candidate.pos[i] = vtx[i];
+      v0candidate.pos[i] = v0fits.vertices[iFit][i];
     }
 
-    v0candidate.dcaV0dau = TMath::Sqrt(fitter.getChi2AtPCACandidate());
+    v0candidate.dcaV0dau = TMath::Sqrt(v0fits.chi2s[iFit]);
 
     // Apply selections so a skimmed table is created only
     if (v0candidate.dcaV0dau > dcav0dau) {
@@ -1064,14 +1211,14 @@ struct lambdakzeroBuilder {
       if (!posTrack.hasITS() && !posTrack.hasTRD() && !posTrack.hasTOF() && !negTrack.hasITS() && !negTrack.hasTRD() && !negTrack.hasTOF()) {
         if (V0.isTrueGamma()) {
           registry.fill(HIST("h2d_pcm_DCAXY_True"), lPt, std::hypot(dcaInfo[0], dcaInfo[1]));
-          registry.fill(HIST("h2d_pcm_DCACHI2_True"), lPt, fitter.getChi2AtPCACandidate());
+          registry.fill(HIST("h2d_pcm_DCACHI2_True"), lPt, v0fits.chi2s[iFit]);
           registry.fill(HIST("h2d_pcm_DeltaDistanceRadii_True"), lPt, centerDistance - trcCircle1.rC - trcCircle2.rC);
           registry.fill(HIST("h2d_pcm_PositionGuess_True"), lPt, delta2);
           registry.fill(HIST("h2d_pcm_RadiallyOutgoingAtThisRadius1_True"), lPt, delta3_track1);
           registry.fill(HIST("h2d_pcm_RadiallyOutgoingAtThisRadius2_True"), lPt, delta3_track2);
         } else {
           registry.fill(HIST("h2d_pcm_DCAXY_Bg"), lPt, std::hypot(dcaInfo[0], dcaInfo[1]));
-          registry.fill(HIST("h2d_pcm_DCACHI2_Bg"), lPt, fitter.getChi2AtPCACandidate());
+          registry.fill(HIST("h2d_pcm_DCACHI2_Bg"), lPt, v0fits.chi2s[iFit]);
           registry.fill(HIST("h2d_pcm_DeltaDistanceRadii_Bg"), lPt, centerDistance - trcCircle1.rC - trcCircle2.rC);
           registry.fill(HIST("h2d_pcm_PositionGuess_Bg"), lPt, delta2);
           registry.fill(HIST("h2d_pcm_RadiallyOutgoingAtThisRadius1_Bg"), lPt, delta3_track1);
@@ -1086,15 +1233,36 @@ struct lambdakzeroBuilder {
   template <class TTrackTo, typename TV0Table>
   void buildStrangenessTables(TV0Table const& V0s)
   {
-    // Loops over all V0s in the time frame
+    // First pass over all V0s in the time frame: track selections
+    v0fits.clear();
+    v0FitIndices.assign(V0s.size(), -1);
+    bool downscaled = false;
+    int64_t iV0 = 0;
     for (auto& V0 : V0s) {
       // downscale some V0s if requested to do so
       if (downscalingOptions.downscaleFactor < 1.f && (static_cast<float>(rand_r(&randomSeed)) / static_cast<float>(RAND_MAX)) > downscalingOptions.downscaleFactor) {
-        return;
+        downscaled = true;
+        break;
+      }
+      if (addV0Candidate<TTrackTo>(V0)) {
+        v0FitIndices[iV0] = v0fits.size() - 1;
+      }
+      iV0++;
+    }
+
+    // DCA fits of the selected candidates
+    fitV0Candidates();
+
+    // Second pass, in the original order: topological selections and tables
+    iV0 = 0;
+    for (auto& V0 : V0s) {
+      auto iFit = v0FitIndices[iV0++];
+      if (iFit < 0) {
+        continue;
       }
 
       // populates v0candidate struct declared inside strangenessbuilder
-      bool validCandidate = buildV0Candidate<TTrackTo>(V0);
+      bool validCandidate = buildV0Candidate<TTrackTo>(V0, iFit);
 
       if (!validCandidate) {
         continue; // doesn't pass selections
@@ -1121,18 +1289,18 @@ struct lambdakzeroBuilder {
           mlConfigurations.calculateGammaScores) {
         // machine learning is on, go for calculation of thresholds
         // FIXME THIS NEEDS ADJUSTING
-        std::vector<float> inputFeatures{pt, 0.0f,
-                                         0.0f, v0candidate.V0radius,
-                                         v0candidate.cosPA, v0candidate.dcaV0dau,
-                                         v0candidate.posDCAxy, v0candidate.negDCAxy};
+        mlInputFeatures = {pt, 0.0f,
+                           0.0f, v0candidate.V0radius,
+                           v0candidate.cosPA, v0candidate.dcaV0dau,
+                           v0candidate.posDCAxy, v0candidate.negDCAxy};
 
         // calculate scores
         if (mlConfigurations.calculateLambdaScores) {
-          float* lambdaProbability = mlModelLambda.evalModel(inputFeatures);
+          float* lambdaProbability = mlModelLambda.evalModel(mlInputFeatures);
           lambdaScore = lambdaProbability[1];
         }
         if (mlConfigurations.calculateGammaScores) {
-          float* gammaProbability = mlModelGamma.evalModel(inputFeatures);
+          float* gammaProbability = mlModelGamma.evalModel(mlInputFeatures);
           gammaScore = gammaProbability[1];
         }
 
@@ -1213,26 +1381,17 @@ struct lambdakzeroBuilder {
 
       // populate V0 covariance matrices if required by any other task
       if (createV0CovMats) {
-        // Calculate position covariance matrix
-        auto covVtxV = fitter.calcPCACovMatrix(0);
-        // std::array<float, 6> positionCovariance;
+        // Position covariance matrix, calculated with the fit
         float positionCovariance[6];
-        positionCovariance[0] = covVtxV(0, 0);
-        positionCovariance[1] = covVtxV(1, 0);
-        positionCovariance[2] = covVtxV(1, 1);
-        positionCovariance[3] = covVtxV(2, 0);
-        positionCovariance[4] = covVtxV(2, 1);
-        positionCovariance[5] = covVtxV(2, 2);
+        for (int i = 0; i < 6; i++) {
+          positionCovariance[i] = v0fits.vertexCovs[iFit][i];
+        }
         std::array<float, 21> covTpositive = {0.};
         std::array<float, 21> covTnegative = {0.};
-        std::array<float, 21> covTpositiveIU = {0.};
-        std::array<float, 21> covTnegativeIU = {0.};
         // std::array<float, 6> momentumCovariance;
         float momentumCovariance[6];
         lPositiveTrack.getCovXYZPxPyPzGlo(covTpositive);
         lNegativeTrack.getCovXYZPxPyPzGlo(covTnegative);
-        lPositiveTrackIU.getCovXYZPxPyPzGlo(covTpositiveIU);
-        lNegativeTrackIU.getCovXYZPxPyPzGlo(covTnegativeIU);
         constexpr int MomInd[6] = {9, 13, 14, 18, 19, 20}; // cov matrix elements for momentum component
         for (int i = 0; i < 6; i++) {
           momentumCovariance[i] = covTpositive[MomInd[i]] + covTnegative[MomInd[i]];
@@ -1243,6 +1402,10 @@ struct lambdakzeroBuilder {
           v0covs(positionCovariance, momentumCovariance);
           if (createV0DauCovMats) {
             // store momentum covariance matrix
+            std::array<float, 21> covTpositiveIU = {0.};
+            std::array<float, 21> covTnegativeIU = {0.};
+            lPositiveTrackIU.getCovXYZPxPyPzGlo(covTpositiveIU);
+            lNegativeTrackIU.getCovXYZPxPyPzGlo(covTnegativeIU);
             float covariancePosTrack[21];
             float covarianceNegTrack[21];
             float covariancePosTrackIU[21];
@@ -1261,6 +1424,9 @@ struct lambdakzeroBuilder {
         }
       }
     }
+    if (downscaled) {
+      return;
+    }
     // En masse histo filling at end of process call
     fillHistos();
     resetHistos();
@@ -1268,17 +1434,25 @@ struct lambdakzeroBuilder {
 
   void processRun2(aod::Collisions const& collisions, soa::Filtered<TaggedV0s> const& V0s, FullTracksExt const&, aod::BCsWithTimestamps const&)
   {
+    O2_PROCESS_TIMERS_DF(processTimers);
+    O2_PROCESS_TIMER(processTimers, kTimeProcessRun2);
     statisticsRegistry.eventCounter += collisions.size();
     // Fire up CCDB
     auto collision = collisions.begin();
     auto bc = collision.bc_as<aod::BCsWithTimestamps>();
-    initCCDB(bc);
+    {
+      O2_PROCESS_TIMER(processTimers, kTimeInitCCDB);
+      initCCDB(bc);
+    }
+    O2_PROCESS_TIMER(processTimers, kTimeBuildTables);
     buildStrangenessTables<FullTracksExt>(V0s);
   }
   PROCESS_SWITCH(lambdakzeroBuilder, processRun2, "Produce Run 2 V0 tables", false);
 
   void processRun3(aod::Collisions const& collisions, soa::Filtered<TaggedV0s> const& V0s, FullTracksExtIU const&, aod::BCsWithTimestamps const& bcs)
   {
+    O2_PROCESS_TIMERS_DF(processTimers);
+    O2_PROCESS_TIMER(processTimers, kTimeProcessRun3);
     statisticsRegistry.eventCounter += collisions.size();
     // Fire up CCDB
     auto bc = collisions.size() ? collisions.begin().bc_as<aod::BCsWithTimestamps>() : bcs.begin();
@@ -1286,13 +1460,19 @@ struct lambdakzeroBuilder {
       LOGF(warn, "No BC found, skipping this DF.");
       return;
     }
-    initCCDB(bc);
+    {
+      O2_PROCESS_TIMER(processTimers, kTimeInitCCDB);
+      initCCDB(bc);
+    }
+    O2_PROCESS_TIMER(processTimers, kTimeBuildTables);
     buildStrangenessTables<FullTracksExtIU>(V0s);
   }
   PROCESS_SWITCH(lambdakzeroBuilder, processRun3, "Produce Run 3 V0 tables", true);
 
   void processFindableRun3(aod::Collisions const& collisions, soa::Filtered<TaggedFindableV0s> const& V0s, FullTracksExtIU const&, aod::BCsWithTimestamps const& bcs)
   {
+    O2_PROCESS_TIMERS_DF(processTimers);
+    O2_PROCESS_TIMER(processTimers, kTimeProcessFindableRun3);
     statisticsRegistry.eventCounter += collisions.size();
     // Fire up CCDB
     auto bc = collisions.size() ? collisions.begin().bc_as<aod::BCsWithTimestamps>() : bcs.begin();
@@ -1300,7 +1480,11 @@ struct lambdakzeroBuilder {
       LOGF(warn, "No BC found, skipping this DF.");
       return;
     }
-    initCCDB(bc);
+    {
+      O2_PROCESS_TIMER(processTimers, kTimeInitCCDB);
+      initCCDB(bc);
+    }
+    O2_PROCESS_TIMER(processTimers, kTimeBuildTables);
     buildStrangenessTables<FullTracksExtIU>(V0s);
   }
   PROCESS_SWITCH(lambdakzeroBuilder, processFindableRun3, "Produce Run 3 V0 tables with all findable candidates", false);
@@ -1661,19 +1845,16 @@ struct lambdakzeroPreselector {
 struct lambdakzeroV0DataLinkBuilder {
   Produces<aod::V0DataLink> v0dataLink;
 
+  std::vector<int> lIndices, lfCIndices; // reused across dataframes
+
   void init(InitContext const&) {}
 
   //*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*
   // build V0 -> V0Data link table
   void processFound(aod::V0s const& v0table, aod::V0Datas const& v0datatable, aod::V0fCDatas const& v0fcdatatable)
   {
-    std::vector<int> lIndices, lfCIndices;
-    lIndices.reserve(v0table.size());
-    lfCIndices.reserve(v0table.size());
-    for (int ii = 0; ii < v0table.size(); ii++) {
-      lIndices[ii] = -1;
-      lfCIndices[ii] = -1;
-    }
+    lIndices.assign(v0table.size(), -1);
+    lfCIndices.assign(v0table.size(), -1);
     for (auto& v0data : v0datatable) {
       lIndices[v0data.v0Id()] = v0data.globalIndex();
     }
@@ -1688,11 +1869,7 @@ struct lambdakzeroV0DataLinkBuilder {
   // build V0Findable -> V0Data link table
   void processFindable(aod::FindableV0s const& v0table, aod::V0Datas const& v0datatable)
   {
-    std::vector<int> lIndices;
-    lIndices.reserve(v0table.size());
-    for (int ii = 0; ii < v0table.size(); ii++) {
-      lIndices[ii] = -1;
-    }
+    lIndices.assign(v0table.size(), -1);
     for (auto& v0data : v0datatable) {
       lIndices[v0data.v0Id()] = v0data.globalIndex();
     }
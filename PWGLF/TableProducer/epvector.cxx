@@ -20,6 +20,7 @@
 
 // C++/ROOT includes.
 #include <TH1F.h>
+#include <array>
 #include <chrono>
 #include <string>
 #include <vector>
@@ -47,9 +48,7 @@
 #include "FV0Base/Geometry.h"
 #include "PWGLF/DataModel/EPCalibrationTables.h"
 #include "TF1.h"
-
-// #include "Common/Core/EventPlaneHelper.h"
-// #include "Common/DataModel/Qvectors.h"
+#include "Common/Core/EventPlaneHelper.h"
 
 // o2 includes.
 #include "CCDB/CcdbApi.h"
@@ -74,6 +73,10 @@ struct epvector {
   o2::ccdb::CcdbApi ccdbApi;
   std::vector<o2::detectors::AlignParam>* offsetFT0;
   std::vector<o2::detectors::AlignParam>* offsetFV0;
+  EventPlaneHelper helperEP; // cos(2 phi), sin(2 phi) of the FT0 channels, with the alignment offsets
+  o2::ft0::Geometry ft0geom;
+  static constexpr int kNFT0Channels = 208;
+  std::array<float, kNFT0Channels> gainEqual; // inverse gains of the FT0 channels for the current run
   std::vector<int> TrkBPosLabel;
   std::vector<int> TrkBNegLabel;
   std::vector<float> qvecRe;
@@ -171,6 +174,12 @@ struct epvector {
     printf("Offset for FT0C: x = %.3f y = %.3f\n", (*offsetFT0)[1].getX(), (*offsetFT0)[1].getY());
     printf("Offset for FV0-left: x = %.3f y = %.3f\n", (*offsetFV0)[0].getX(), (*offsetFV0)[0].getY());
     printf("Offset for FV0-right: x = %.3f y = %.3f\n", (*offsetFV0)[1].getX(), (*offsetFV0)[1].getY());
+    helperEP.SetOffsetFT0A((*offsetFT0)[0].getX(), (*offsetFT0)[0].getY());
+    helperEP.SetOffsetFT0C((*offsetFT0)[1].getX(), (*offsetFT0)[1].getY());
+    helperEP.SetOffsetFV0left((*offsetFV0)[0].getX(), (*offsetFV0)[0].getY());
+    helperEP.SetOffsetFV0right((*offsetFV0)[1].getX(), (*offsetFV0)[1].getY());
+    helperEP.SetChannelAngles(ft0geom, o2::fv0::Geometry::instance(o2::fv0::Geometry::eUninitialized), 2, true);
+    gainEqual.fill(1.f);
   }
 
   template <typename TCollision>
@@ -188,14 +197,6 @@ struct epvector {
     return 1;
   }
 
-  double GetPhiFT0(int chno, double offsetX, double offsetY)
-  {
-    o2::ft0::Geometry ft0Det;
-    ft0Det.calculateChannelCenter();
-    auto chPos = ft0Det.getChannelCenter(chno);
-    return TMath::ATan2(chPos.Y() + offsetY, chPos.X() + offsetX);
-  }
-
   double GetPhiInRange(double phi)
   {
     double result = phi;
@@ -265,40 +266,28 @@ struct epvector {
       triggerevent = true;
       if (useGainCallib && (currentRunNumber != lastRunNumber)) {
         gainprofile = ccdb->getForTimeStamp<TProfile>(ConfGainPath.value, bc.timestamp());
+        for (int chanelid = 0; chanelid < kNFT0Channels; chanelid++) {
+          gainEqual[chanelid] = 1 / gainprofile->GetBinContent(gainprofile->FindBin(chanelid));
+        }
       }
 
       histos.fill(HIST("hCentrality"), centrality);
       histos.fill(HIST("Vz"), vz);
 
       auto ft0 = coll.foundFT0();
-      auto offsetFT0Ax = (*offsetFT0)[0].getX();
-      auto offsetFT0Ay = (*offsetFT0)[0].getY();
-      auto offsetFT0Cx = (*offsetFT0)[1].getX();
-      auto offsetFT0Cy = (*offsetFT0)[1].getY();
       for (std::size_t iChA = 0; iChA < ft0.channelA().size(); iChA++) {
         auto chanelid = ft0.channelA()[iChA];
-        auto gainequal = 1.0;
-        if (useGainCallib) {
-          gainequal = 1 / gainprofile->GetBinContent(gainprofile->FindBin(chanelid));
-        }
-        float ampl = gainequal * ft0.amplitudeA()[iChA];
+        float ampl = (useGainCallib ? gainEqual[chanelid] : 1.f) * ft0.amplitudeA()[iChA];
         histos.fill(HIST("FT0Amp"), chanelid, ampl);
-        auto phiA = GetPhiFT0(chanelid, offsetFT0Ax, offsetFT0Ay);
-        qxFT0A = qxFT0A + ampl * TMath::Cos(2.0 * phiA);
-        qyFT0A = qyFT0A + ampl * TMath::Sin(2.0 * phiA);
+        qxFT0A = qxFT0A + ampl * helperEP.GetCosPhi(0, chanelid, 2);
+        qyFT0A = qyFT0A + ampl * helperEP.GetSinPhi(0, chanelid, 2);
       }
       for (std::size_t iChC = 0; iChC < ft0.channelC().size(); iChC++) {
         auto chanelid = ft0.channelC()[iChC] + 96;
-        // printf("Offset for FT0A: x = %d y = %d\n", chanelid, chanelid-96);
-        auto gainequal = 1.0;
-        if (useGainCallib) {
-          gainequal = 1 / gainprofile->GetBinContent(gainprofile->FindBin(chanelid));
-        }
-        float ampl = gainequal * ft0.amplitudeC()[iChC];
+        float ampl = (useGainCallib ? gainEqual[chanelid] : 1.f) * ft0.amplitudeC()[iChC];
         histos.fill(HIST("FT0Amp"), chanelid, ampl);
-        auto phiC = GetPhiFT0(chanelid, offsetFT0Cx, offsetFT0Cy);
-        qxFT0C = qxFT0C + ampl * TMath::Cos(2.0 * phiC);
-        qyFT0C = qyFT0C + ampl * TMath::Sin(2.0 * phiC);
+        qxFT0C = qxFT0C + ampl * helperEP.GetCosPhi(0, chanelid, 2);
+        qyFT0C = qyFT0C + ampl * helperEP.GetSinPhi(0, chanelid, 2);
       }
 
       for (auto& trk : tracks) {
@@ -35,6 +35,7 @@
 #include "Common/TableProducer/PID/pidTOFBase.h"
 
 #include "Common/Core/PID/TPCPIDResponse.h"
+#include "Common/Core/PID/BetheBlochTable.h"
 #include "Common/DataModel/PIDResponse.h"
 #include "DCAFitter/DCAFitterN.h"
 
@@ -265,6 +266,7 @@ struct antidLambdaEbye {
   Configurable<float> antidItsClsSizeCut{"antidItsClsSizeCut", 2.f, "cluster size cut for antideuterons"};
   Configurable<float> antidPtItsClsSizeCut{"antidPtItsClsSizeCut", 1.f, "pt for cluster size cut for antideuterons"};
 
+  std::array<o2::pid::tpc::BetheBlochTable, kNpart> bbTables; // expected TPC signal per species, tabulated at init
   std::array<float, kNpart> ptMin;
   std::array<float, kNpart> ptTof;
   std::array<float, kNpart> ptMax;
@@ -564,6 +566,10 @@ struct antidLambdaEbye {
     nSigmaTofCut = std::array<float, kNpart>{antipNsigmaTofCut, antidNsigmaTofCut};
     tpcInnerParamMax = std::array<float, kNpart>{antipTpcInnerParamMax, antidTpcInnerParamMax};
     tofMassMax = std::array<float, kNpart>{antipTofMassMax, antidTofMassMax};
+
+    for (int iP{0}; iP < kNpart; ++iP) {
+      bbTables[iP].init({cfgBetheBlochParams->get(iP, "p0"), cfgBetheBlochParams->get(iP, "p1"), cfgBetheBlochParams->get(iP, "p2"), cfgBetheBlochParams->get(iP, "p3"), cfgBetheBlochParams->get(iP, "p4")});
+    }
   }
 
   template <class C, class T>
@@ -623,7 +629,7 @@ struct antidLambdaEbye {
           }
         }
 
-        double expBethe{tpc::BetheBlochAleph(static_cast<double>(track.tpcInnerParam() / partMass[iP]), cfgBetheBlochParams->get(iP, "p0"), cfgBetheBlochParams->get(iP, "p1"), cfgBetheBlochParams->get(iP, "p2"), cfgBetheBlochParams->get(iP, "p3"), cfgBetheBlochParams->get(iP, "p4"))};
+        double expBethe{bbTables[iP](static_cast<double>(track.tpcInnerParam() / partMass[iP]))};
         double expSigma{expBethe * cfgBetheBlochParams->get(iP, "resolution")};
         auto nSigmaTPC = static_cast<float>((track.tpcSignal() - expBethe) / expSigma);
 
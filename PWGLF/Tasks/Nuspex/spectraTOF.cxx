@@ -29,6 +29,7 @@
 #include "Common/DataModel/Multiplicity.h"
 #include "Common/DataModel/McCollisionExtra.h"
 #include "Common/Core/TrackSelection.h"
+#include "Common/Core/DenseHistogram.h"
 #include "Framework/StaticFor.h"
 #include "Common/Core/TrackSelectionDefaults.h"
 #include "PWGLF/DataModel/LFParticleIdentification.h"
@@ -100,10 +101,37 @@ struct tofSpectra {
   Configurable<bool> enableTPCTOFvsEtaHistograms{"enableTPCTOFvsEtaHistograms", false, "choose if produce TPC tof vs Eta"};
   Configurable<bool> includeCentralityMC{"includeCentralityMC", true, "choose if include Centrality to MC"};
   Configurable<bool> tpctofVsMult{"tpctofVsMult", false, "Produce TPC-TOF plots vs multiplicity"};
+  Configurable<int> maxDenseHistogramCells{"maxDenseHistogramCells", 1 << 20, "Max. number of cells of the n-sigma and DCA histograms accumulated in dense arrays before being added to the output (0: direct filling)"};
 
   // Histograms
   HistogramRegistry histos{"Histos", {}, OutputObjHandlingPolicy::AnalysisObject};
 
+  // Dense accumulators of the n-sigma and DCA TH2/TH3 per species and charge, flushed at the end of each process function.
+  // The bin of the pT (and multiplicity) is found once per track for all of them.
+  std::array<DenseHistogram, NpCharge> denseNSigmaTPC;
+  std::array<DenseHistogram, NpCharge> denseNSigmaTOF;
+  std::array<DenseHistogram, NpCharge> denseDCAxy;
+  std::array<DenseHistogram, NpCharge> denseDCAz;
+  DenseAxis denseAxisPt;
+  DenseAxis denseAxisMult;
+
+  void initDenseHistogram(DenseHistogram& dense, TH1* h)
+  {
+    if (maxDenseHistogramCells.value > 0 && dense.init(h, maxDenseHistogramCells.value)) {
+      denseAxisPt.set(h->GetXaxis());
+    }
+  }
+
+  void flushDenseHistograms()
+  {
+    for (int i = 0; i < NpCharge; i++) {
+      denseNSigmaTPC[i].flush();
+      denseNSigmaTOF[i].flush();
+      denseDCAxy[i].flush();
+      denseDCAz[i].flush();
+    }
+  }
+
   void init(o2::framework::InitContext&)
   {
     // Standard process functions
@@ -444,8 +472,8 @@ struct tofSpectra {
           LOG(fatal) << "Unrecognized option for multiplicity " << multiplicityEstimator;
       }
       if (multiplicityEstimator == MultCodes::kNoMultiplicity) {
-        histos.add(hnsigmatof[i].data(), pTCharge[i], kTH2D, {ptAxis, nsigmaTOFAxis});
-        histos.add(hnsigmatpc[i].data(), pTCharge[i], kTH2D, {ptAxis, nsigmaTPCAxis});
+        initDenseHistogram(denseNSigmaTOF[i], histos.add<TH2>(hnsigmatof[i].data(), pTCharge[i], kTH2D, {ptAxis, nsigmaTOFAxis}).get());
+        initDenseHistogram(denseNSigmaTPC[i], histos.add<TH2>(hnsigmatpc[i].data(), pTCharge[i], kTH2D, {ptAxis, nsigmaTPCAxis}).get());
         if (enableDeltaHistograms) {
           histos.add(hdeltatof[i].data(), pTCharge[i], kTH2D, {ptAxis, deltaTOFAxis});
           histos.add(hdeltatpc[i].data(), pTCharge[i], kTH2D, {ptAxis, deltaTPCAxis});
@@ -462,8 +490,10 @@ struct tofSpectra {
           histos.add(hnsigmatof[i].data(), pTCharge[i], kTHnSparseD, {ptAxis, nsigmaTOFAxis, multAxis, dcaXyAxis, dcaZAxis, etaAxis}); // RD
           histos.add(hnsigmatpc[i].data(), pTCharge[i], kTHnSparseD, {ptAxis, nsigmaTPCAxis, multAxis, dcaXyAxis, dcaZAxis, etaAxis}); // RD
         } else {
-          histos.add(hnsigmatof[i].data(), pTCharge[i], kTH3D, {ptAxis, nsigmaTOFAxis, multAxis});
-          histos.add(hnsigmatpc[i].data(), pTCharge[i], kTH3D, {ptAxis, nsigmaTPCAxis, multAxis});
+          initDenseHistogram(denseNSigmaTOF[i], histos.add<TH3>(hnsigmatof[i].data(), pTCharge[i], kTH3D, {ptAxis, nsigmaTOFAxis, multAxis}).get());
+          auto hNSigmaTPC = histos.add<TH3>(hnsigmatpc[i].data(), pTCharge[i], kTH3D, {ptAxis, nsigmaTPCAxis, multAxis});
+          initDenseHistogram(denseNSigmaTPC[i], hNSigmaTPC.get());
+          denseAxisMult.set(hNSigmaTPC->GetZaxis());
         }
         if (enableDeltaHistograms) {
           histos.add(hdeltatof[i].data(), pTCharge[i], kTH3D, {ptAxis, deltaTOFAxis, multAxis});
@@ -486,11 +516,11 @@ struct tofSpectra {
         }
       }
       if (enableDCAxyzHistograms) {
-        histos.add(hdcaxy[i].data(), pTCharge[i], kTH3D, {ptAxis, dcaXyAxis, dcaZAxis});
+        initDenseHistogram(denseDCAxy[i], histos.add<TH3>(hdcaxy[i].data(), pTCharge[i], kTH3D, {ptAxis, dcaXyAxis, dcaZAxis}).get());
         histos.add(hdcaxyphi[i].data(), Form("%s -- 0.9 < #it{p}_{T} < 1.1 GeV/#it{c}", pTCharge[i]), kTH3D, {phiAxis, dcaXyAxis, dcaZAxis});
       } else {
-        histos.add(hdcaxy[i].data(), pTCharge[i], kTH2D, {ptAxis, dcaXyAxis});
-        histos.add(hdcaz[i].data(), pTCharge[i], kTH2D, {ptAxis, dcaZAxis});
+        initDenseHistogram(denseDCAxy[i], histos.add<TH2>(hdcaxy[i].data(), pTCharge[i], kTH2D, {ptAxis, dcaXyAxis}).get());
+        initDenseHistogram(denseDCAz[i], histos.add<TH2>(hdcaz[i].data(), pTCharge[i], kTH2D, {ptAxis, dcaZAxis}).get());
         histos.add(hdcaxyphi[i].data(), Form("%s -- 0.9 < #it{p}_{T} < 1.1 GeV/#it{c}", pTCharge[i]), kTH2D, {phiAxis, dcaXyAxis});
       }
 
@@ -584,8 +614,13 @@ struct tofSpectra {
     const auto& nsigmaTPC = o2::aod::pidutils::tpcNSigma<id>(track);
     // const auto id = track.sign() > 0 ? id : id + Np;
     const float multiplicity = getMultiplicity(collision);
+    const int iCharge = track.sign() > 0 ? id : id + Np;
+    const DenseBin ptBin = denseAxisPt.bin(track.pt());
+    const DenseBin multBin = denseAxisMult.bin(multiplicity);
 
-    if (multiplicityEstimator == MultCodes::kNoMultiplicity) {
+    if (multiplicityEstimator == MultCodes::kNoMultiplicity && denseNSigmaTPC[iCharge].isActive()) {
+      denseNSigmaTPC[iCharge].fill(ptBin, denseNSigmaTPC[iCharge].axis(1).bin(nsigmaTPC));
+    } else if (multiplicityEstimator == MultCodes::kNoMultiplicity) {
       if (track.sign() > 0) {
         histos.fill(HIST(hnsigmatpc[id]), track.pt(), nsigmaTPC);
       } else {
@@ -597,6 +632,8 @@ struct tofSpectra {
       } else {                                                                                                                 // RD
         histos.fill(HIST(hnsigmatpc[id + Np]), track.pt(), nsigmaTPC, multiplicity, track.dcaXY(), track.dcaZ(), track.eta()); // RD
       }                                                                                                                        // RD
+    } else if (denseNSigmaTPC[iCharge].isActive()) {
+      denseNSigmaTPC[iCharge].fill(ptBin, denseNSigmaTPC[iCharge].axis(1).bin(nsigmaTPC), multBin);
     } else {
       if (track.sign() > 0) {
         histos.fill(HIST(hnsigmatpc[id]), track.pt(), nsigmaTPC, multiplicity);
@@ -705,7 +742,9 @@ struct tofSpectra {
       }
     }
 
-    if (multiplicityEstimator == MultCodes::kNoMultiplicity) {
+    if (multiplicityEstimator == MultCodes::kNoMultiplicity && denseNSigmaTOF[iCharge].isActive()) {
+      denseNSigmaTOF[iCharge].fill(ptBin, denseNSigmaTOF[iCharge].axis(1).bin(nsigmaTOF));
+    } else if (multiplicityEstimator == MultCodes::kNoMultiplicity) {
       if (track.sign() > 0) {
         histos.fill(HIST(hnsigmatof[id]), track.pt(), nsigmaTOF);
       } else {
@@ -718,6 +757,8 @@ struct tofSpectra {
         } else {                                                                                                                 // RD
           histos.fill(HIST(hnsigmatof[id + Np]), track.pt(), nsigmaTOF, multiplicity, track.dcaXY(), track.dcaZ(), track.eta()); // RD
         }                                                                                                                        // RD
+      } else if (denseNSigmaTOF[iCharge].isActive()) {
+        denseNSigmaTOF[iCharge].fill(ptBin, denseNSigmaTOF[iCharge].axis(1).bin(nsigmaTOF), multBin);
       } else {
         if (track.sign() > 0) {
           histos.fill(HIST(hnsigmatof[id]), track.pt(), nsigmaTOF, multiplicity);
@@ -786,27 +827,38 @@ struct tofSpectra {
     if (isDCAPureSample) {
       const bool isInPtRangeForPhi = track.pt() < 1.1f && track.pt() > 0.9f;
       if (enableDCAxyzHistograms) {
-        if (track.sign() > 0) {
+        if (denseDCAxy[iCharge].isActive()) {
+          denseDCAxy[iCharge].fill(ptBin, denseDCAxy[iCharge].axis(1).bin(track.dcaXY()), denseDCAxy[iCharge].axis(2).bin(track.dcaZ()));
+        } else if (track.sign() > 0) {
           histos.fill(HIST(hdcaxy[id]), track.pt(), track.dcaXY(), track.dcaZ());
+        } else {
+          histos.fill(HIST(hdcaxy[id + Np]), track.pt(), track.dcaXY(), track.dcaZ());
+        }
+        if (track.sign() > 0) {
           if (isInPtRangeForPhi) {
             histos.fill(HIST(hdcaxyphi[id]), track.phi(), track.dcaXY(), track.dcaZ());
           }
         } else {
-          histos.fill(HIST(hdcaxy[id + Np]), track.pt(), track.dcaXY(), track.dcaZ());
           if (isInPtRangeForPhi) {
             histos.fill(HIST(hdcaxyphi[id + Np]), track.phi(), track.dcaXY(), track.dcaZ());
           }
         }
       } else {
-        if (track.sign() > 0) {
+        if (denseDCAxy[iCharge].isActive() && denseDCAz[iCharge].isActive()) {
+          denseDCAxy[iCharge].fill(ptBin, denseDCAxy[iCharge].axis(1).bin(track.dcaXY()));
+          denseDCAz[iCharge].fill(ptBin, denseDCAz[iCharge].axis(1).bin(track.dcaZ()));
+        } else if (track.sign() > 0) {
           histos.fill(HIST(hdcaxy[id]), track.pt(), track.dcaXY());
           histos.fill(HIST(hdcaz[id]), track.pt(), track.dcaZ());
+        } else {
+          histos.fill(HIST(hdcaxy[id + Np]), track.pt(), track.dcaXY());
+          histos.fill(HIST(hdcaz[id + Np]), track.pt(), track.dcaZ());
+        }
+        if (track.sign() > 0) {
           if (isInPtRangeForPhi) {
             histos.fill(HIST(hdcaxyphi[id]), track.phi(), track.dcaXY());
           }
         } else {
-          histos.fill(HIST(hdcaxy[id + Np]), track.pt(), track.dcaXY());
-          histos.fill(HIST(hdcaz[id + Np]), track.pt(), track.dcaZ());
           if (isInPtRangeForPhi) {
             histos.fill(HIST(hdcaxyphi[id + Np]), track.phi(), track.dcaXY());
           }
@@ -1192,6 +1244,7 @@ struct tofSpectra {
         fillParticleHistos<false, PID::Proton>(track, collision);
       }
     }
+    flushDenseHistograms();
   } // end of the process function
   PROCESS_SWITCH(tofSpectra, processDerived, "Derived data processor", false);
 
@@ -1210,6 +1263,7 @@ struct tofSpectra {
       }                                                                                        \
       fillParticleHistos<isFull, PID::particleId>(track, collision);                           \
     }                                                                                          \
+    flushDenseHistograms();                                                                    \
   }                                                                                            \
   PROCESS_SWITCH(tofSpectra, process##processorName##inputPid, Form("Process for the %s hypothesis from %s tables", #particleId, #processorName), false);
 
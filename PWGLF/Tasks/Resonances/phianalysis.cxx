@@ -15,8 +15,6 @@
 ///
 /// \author Bong-Hwi Lim <bong-hwi.lim@cern.ch>
 
-#include <TLorentzVector.h>
-
 #include "Common/DataModel/PIDResponse.h"
 #include "Common/DataModel/Centrality.h"
 #include "Common/DataModel/EventSelection.h"
@@ -24,6 +22,7 @@
 #include "Framework/ASoAHelpers.h"
 #include "Framework/runDataProcessing.h"
 #include "PWGLF/DataModel/LFResonanceTables.h"
+#include "PWGLF/Utils/resoDaughters.h"
 #include "DataFormatsParameters/GRPObject.h"
 #include "CommonConstants/PhysicsConstants.h"
 
@@ -180,107 +179,118 @@ struct phianalysis {
     return false;
   }
 
-  template <bool IsMC, bool IsMix, typename CollisionType, typename TracksType>
-  void fillHistograms(const CollisionType& collision, const TracksType& dTracks1, const TracksType& dTracks2)
+  /// Selects the kaon candidates of an event, once for all their pairs
+  template <bool FillQA, typename TracksType>
+  void selectKaons(const TracksType& dTracks, o2::analysis::ResoDaughters& kaons)
   {
-    auto multiplicity = collision.cent();
-    TLorentzVector lDecayDaughter1, lDecayDaughter2, lResonance;
-    for (auto& [trk1, trk2] : combinations(CombinationsUpperIndexPolicy(dTracks1, dTracks2))) {
-      // Full index policy is needed to consider all possible combinations
-      if (trk1.index() == trk2.index())
-        continue; // We need to run (0,1), (1,0) pairs as well. but same id pairs are not needed.
-      //// Initialize variables
-      // Trk1: Kaon, Trk2: Kaon
+    kaons.clear();
+    for (const auto& trk : dTracks) {
       // apply the track cut
-      if (!trackCut(trk1) || !trackCut(trk2))
+      if (!trackCut(trk))
         continue;
 
-      auto isTrk1hasTOF = trk1.hasTOF();
-      auto isTrk2hasTOF = trk2.hasTOF();
-      auto trk1ptKa = trk1.pt();
-      auto trk1NSigmaKaTPC = trk1.tpcNSigmaKa();
-      auto trk1NSigmaKaTOF = (isTrk1hasTOF) ? trk1.tofNSigmaKa() : -999.;
-      // auto trk2ptKa = trk2.pt();
-      // auto trk2NSigmaKaTPC = trk2.tpcNSigmaKa();
-      // auto trk2NSigmaKaTOF = (isTrk2hasTOF) ? trk2.tofNSigmaKa() : -999.;
+      auto isTrkhasTOF = trk.hasTOF();
+      auto trkptKa = trk.pt();
+      auto trkNSigmaKaTPC = trk.tpcNSigmaKa();
+      auto trkNSigmaKaTOF = (isTrkhasTOF) ? trk.tofNSigmaKa() : -999.;
 
-      if constexpr (!IsMix) {
+      if constexpr (FillQA) {
         //// QA plots before the selection
         //  --- PID QA Kaon
-        histos.fill(HIST("QAbefore/TPC_Nsigmaka_all"), trk1ptKa, trk1NSigmaKaTPC);
-        if (isTrk1hasTOF) {
-          histos.fill(HIST("QAbefore/TOF_Nsigma_all"), trk1ptKa, trk1NSigmaKaTOF);
-          histos.fill(HIST("QAbefore/TOF_TPC_Mapka_all"), trk1NSigmaKaTOF, trk1NSigmaKaTPC);
+        histos.fill(HIST("QAbefore/TPC_Nsigmaka_all"), trkptKa, trkNSigmaKaTPC);
+        if (isTrkhasTOF) {
+          histos.fill(HIST("QAbefore/TOF_Nsigma_all"), trkptKa, trkNSigmaKaTOF);
+          histos.fill(HIST("QAbefore/TOF_TPC_Mapka_all"), trkNSigmaKaTOF, trkNSigmaKaTPC);
         }
-        histos.fill(HIST("QAbefore/trkpT"), trk1ptKa);
-        histos.fill(HIST("QAbefore/trkDCAxy"), trk1.dcaXY());
-        histos.fill(HIST("QAbefore/trkDCAz"), trk1.dcaZ());
+        histos.fill(HIST("QAbefore/trkpT"), trkptKa);
+        histos.fill(HIST("QAbefore/trkDCAxy"), trk.dcaXY());
+        histos.fill(HIST("QAbefore/trkDCAz"), trk.dcaZ());
       }
 
       //// Apply the selection
-      if (cUseOnlyTOFTrackKa && (!isTrk1hasTOF || !isTrk2hasTOF))
+      if (cUseOnlyTOFTrackKa && !isTrkhasTOF)
         continue;
-      if (!selectionPIDKaon(trk1) || !selectionPIDKaon(trk2))
+      if (!selectionPIDKaon(trk))
         continue;
 
-      if constexpr (!IsMix) {
+      if constexpr (FillQA) {
         //// QA plots after the selection
         //  --- PID QA Kaon
-        histos.fill(HIST("QAafter/TPC_Nsigmaka_all"), trk1ptKa, trk1NSigmaKaTPC);
-        if (isTrk1hasTOF) {
-          histos.fill(HIST("QAafter/TOF_Nsigma_all"), trk1ptKa, trk1NSigmaKaTOF);
-          histos.fill(HIST("QAafter/TOF_TPC_Mapka_all"), trk1NSigmaKaTOF, trk1NSigmaKaTPC);
+        histos.fill(HIST("QAafter/TPC_Nsigmaka_all"), trkptKa, trkNSigmaKaTPC);
+        if (isTrkhasTOF) {
+          histos.fill(HIST("QAafter/TOF_Nsigma_all"), trkptKa, trkNSigmaKaTOF);
+          histos.fill(HIST("QAafter/TOF_TPC_Mapka_all"), trkNSigmaKaTOF, trkNSigmaKaTPC);
         }
-        histos.fill(HIST("QAafter/trkpT"), trk1ptKa);
-        histos.fill(HIST("QAafter/trkDCAxy"), trk1.dcaXY());
-        histos.fill(HIST("QAafter/trkDCAz"), trk1.dcaZ());
+        histos.fill(HIST("QAafter/trkpT"), trkptKa);
+        histos.fill(HIST("QAafter/trkDCAxy"), trk.dcaXY());
+        histos.fill(HIST("QAafter/trkDCAz"), trk.dcaZ());
       }
+      kaons.add(trk.index(), trk.px(), trk.py(), trk.pz(), massKa, trk.sign());
+    }
+  }
 
-      //// Resonance reconstruction
-      lDecayDaughter1.SetXYZM(trk1.px(), trk1.py(), trk1.pz(), massKa);
-      lDecayDaughter2.SetXYZM(trk2.px(), trk2.py(), trk2.pz(), massKa);
-      lResonance = lDecayDaughter1 + lDecayDaughter2;
-      // Rapidity cut
-      if (abs(lResonance.Rapidity()) > 0.5)
-        continue;
-      //// Un-like sign pair only
-      if (trk1.sign() * trk2.sign() < 0) {
-        if constexpr (!IsMix) {
-          if (trk1.sign() > 0) {
-            histos.fill(HIST("phiinvmassDS"), lResonance.M());
-            histos.fill(HIST("h3phiinvmassDS"), multiplicity, lResonance.Pt(), lResonance.M());
+  o2::analysis::ResoDaughters kaons1; // kaon candidates of the (first) event
+  o2::analysis::ResoDaughters kaons2; // kaon candidates of the second event of the mixed-event pairs
+
+  template <bool IsMC, bool IsMix, typename CollisionType, typename TracksType>
+  void fillHistograms(const CollisionType& collision, const TracksType& dTracks1, const TracksType& dTracks2)
+  {
+    auto multiplicity = collision.cent();
+    selectKaons<!IsMix>(dTracks1, kaons1);
+    if constexpr (IsMix) {
+      selectKaons<false>(dTracks2, kaons2);
+    }
+    const auto& kaonsSecond = IsMix ? kaons2 : kaons1;
+    // pairs of CombinationsUpperIndexPolicy(dTracks1, dTracks2) without the same index
+    for (std::size_t i1 = 0; i1 < kaons1.size(); ++i1) {
+      for (std::size_t i2 = kaonsSecond.firstAfter(kaons1.index(i1)); i2 < kaonsSecond.size(); ++i2) {
+        //// Resonance reconstruction
+        const auto lResonance = kaons1.pair(i1, kaonsSecond, i2);
+        // Rapidity cut
+        if (std::abs(lResonance.y) > 0.5)
+          continue;
+        const auto sign1 = kaons1.sign(i1);
+        //// Un-like sign pair only
+        if (sign1 * kaonsSecond.sign(i2) < 0) {
+          if constexpr (!IsMix) {
+            if (sign1 > 0) {
+              histos.fill(HIST("phiinvmassDS"), lResonance.m);
+              histos.fill(HIST("h3phiinvmassDS"), multiplicity, lResonance.pt, lResonance.m);
+            } else {
+            }
           } else {
+            histos.fill(HIST("phiinvmassME"), lResonance.m);
+            histos.fill(HIST("h3phiinvmassME"), multiplicity, lResonance.pt, lResonance.m);
           }
-        } else {
-          histos.fill(HIST("phiinvmassME"), lResonance.M());
-          histos.fill(HIST("h3phiinvmassME"), multiplicity, lResonance.Pt(), lResonance.M());
-        }
 
-        // MC
-        if constexpr (IsMC) {
-          if (abs(trk1.pdgCode()) != 321 || abs(trk2.pdgCode()) != 321)
-            continue;
-          if (trk1.motherId() != trk2.motherId()) // Same mother
-            continue;
-          if (abs(trk1.motherPDG()) != 333)
-            continue;
+          // MC
+          if constexpr (IsMC) {
+            auto trk1 = dTracks1.iteratorAt(kaons1.index(i1));
+            auto trk2 = dTracks2.iteratorAt(kaonsSecond.index(i2));
+            if (abs(trk1.pdgCode()) != 321 || abs(trk2.pdgCode()) != 321)
+              continue;
+            if (trk1.motherId() != trk2.motherId()) // Same mother
+              continue;
+            if (abs(trk1.motherPDG()) != 333)
+              continue;
 
-          // Track selection check.
-          histos.fill(HIST("QAMCTrue/trkDCAxy"), trk2.dcaXY());
-          histos.fill(HIST("QAMCTrue/trkDCAz"), trk2.dcaZ());
+            // Track selection check.
+            histos.fill(HIST("QAMCTrue/trkDCAxy"), trk2.dcaXY());
+            histos.fill(HIST("QAMCTrue/trkDCAz"), trk2.dcaZ());
 
-          // MC histograms
-          histos.fill(HIST("phiRec"), lResonance.Pt(), multiplicity);
-          histos.fill(HIST("phiRecinvmass"), lResonance.M());
-          histos.fill(HIST("h3Recphiinvmass"), multiplicity, lResonance.Pt(), lResonance.M());
-        }
-      } else {
-        if constexpr (!IsMix)
-          continue;
-        if (trk1.sign() > 0) {
-          histos.fill(HIST("phiinvmassLS"), lResonance.M());
-          histos.fill(HIST("h3phiinvmassLS"), multiplicity, lResonance.Pt(), lResonance.M());
+            // MC histograms
+            histos.fill(HIST("phiRec"), lResonance.pt, multiplicity);
+            histos.fill(HIST("phiRecinvmass"), lResonance.m);
+            histos.fill(HIST("h3Recphiinvmass"), multiplicity, lResonance.pt, lResonance.m);
+          }
         } else {
+          if constexpr (!IsMix)
+            continue;
+          if (sign1 > 0) {
+            histos.fill(HIST("phiinvmassLS"), lResonance.m);
+            histos.fill(HIST("h3phiinvmassLS"), multiplicity, lResonance.pt, lResonance.m);
+          } else {
+          }
         }
       }
     }
@@ -352,6 +352,7 @@ struct phianalysisTHnSparse {
         rsnOutput->fillLikemm(pointPair);
       }
     }
+    rsnOutput->flush();
   }
   PROCESS_SWITCH(phianalysisTHnSparse, processData, "Process Event for Data", true);
 
@@ -436,6 +437,7 @@ struct phianalysisTHnSparse {
         }
       }
     }
+    rsnOutput->flush();
   }
 
   PROCESS_SWITCH(phianalysisTHnSparse, processTrue, "Process Event for MC reconstruction.", false);
@@ -502,6 +504,7 @@ struct phianalysisTHnSparse {
           LOGF(info, "Gen:  %d, #Phi =%d, mother=%d (%ld), Inv.mass:%f, Pt= %f", numberofEntries, nuberofPhi, particle.pdgCode(), particle.globalIndex(), mother.Mag(), mother.Pt());
       }
     }
+    rsnOutput->flush();
   }
 
   PROCESS_SWITCH(phianalysisTHnSparse, processGen, "Process generated.", false);
@@ -641,6 +644,7 @@ struct phianalysisTHnSparse {
         rsnOutput->fillMixingmp(pointPair);
       }
     }
+    rsnOutput->flush();
   }
   PROCESS_SWITCH(phianalysisTHnSparse, processMixed, "Process Mixing Event.", true);
 };
@@ -20,11 +20,14 @@
 #include "Framework/AnalysisTask.h"
 #include "Framework/runDataProcessing.h"
 #include "Framework/ASoAHelpers.h"
+#include "PWGLF/Utils/resoDaughters.h"
 #include "TLorentzVector.h"
 
 using namespace std;
 using namespace o2;
 using namespace o2::framework;
+using o2::analysis::ResoDaughters;
+using o2::analysis::ResoPairKinematics;
 
 enum EventSelection { kNoSelection = 0,
                       kTVXselection = 1,
@@ -71,6 +74,12 @@ struct rsn_analysis {
     {},
     OutputObjHandlingPolicy::AnalysisObject};
   //
+  //  Selected daughters of the current event, kept to reuse their storage
+  ResoDaughters kPosSelectedKaons;
+  ResoDaughters kNegSelectedKaons;
+  ResoDaughters kPosSelectedPions;
+  ResoDaughters kNegSelectedPions;
+  //
   // Create Output Objects
   void init(o2::framework::InitContext&)
   {
@@ -317,12 +326,11 @@ struct rsn_analysis {
     uHistograms.fill(HIST("QA/Event/EnumEvents"), EventSelection::kVertexCut);
     uHistograms.fill(HIST("QA/Event/Selected/VertexZ"), kCurrentCollision.posZ());
     //
-    //  Storage for Kaons
-    //  --- PX  PY  PZ  HasPositiveCharge
-    std::vector<std::tuple<Float_t, Float_t, Float_t>> kPosSelectedKaons;
-    std::vector<std::tuple<Float_t, Float_t, Float_t>> kNegSelectedKaons;
-    std::vector<std::tuple<Float_t, Float_t, Float_t>> kPosSelectedPions;
-    std::vector<std::tuple<Float_t, Float_t, Float_t>> kNegSelectedPions;
+    //  Storage for Kaons and Pions, with the energy for their mass
+    kPosSelectedKaons.clear();
+    kNegSelectedKaons.clear();
+    kPosSelectedPions.clear();
+    kNegSelectedPions.clear();
     //
     //  Loop on Tracks
     for (auto kCurrentTrack : kTracks) {
@@ -334,201 +342,25 @@ struct rsn_analysis {
       uFillFullPIDQA(kCurrentTrack);
       //
       if (uIsKaonSelected(kCurrentTrack)) {
-        if (kCurrentTrack.sign() > 0)
-          kPosSelectedKaons.push_back(std::tuple<Float_t, Float_t, Float_t>(
-            kCurrentTrack.px(), kCurrentTrack.py(), kCurrentTrack.pz()));
-        else
-          kNegSelectedKaons.push_back(std::tuple<Float_t, Float_t, Float_t>(
-            kCurrentTrack.px(), kCurrentTrack.py(), kCurrentTrack.pz()));
+        auto& kSelectedKaons = kCurrentTrack.sign() > 0 ? kPosSelectedKaons : kNegSelectedKaons;
+        kSelectedKaons.add(kCurrentTrack.index(), kCurrentTrack.px(), kCurrentTrack.py(), kCurrentTrack.pz(), .493677, kCurrentTrack.sign());
       }
       //
       if (uIsPionSelected(kCurrentTrack)) {
-        if (kCurrentTrack.sign() > 0)
-          kPosSelectedPions.push_back(std::tuple<Float_t, Float_t, Float_t>(
-            kCurrentTrack.px(), kCurrentTrack.py(), kCurrentTrack.pz()));
-        else
-          kNegSelectedPions.push_back(std::tuple<Float_t, Float_t, Float_t>(
-            kCurrentTrack.px(), kCurrentTrack.py(), kCurrentTrack.pz()));
+        auto& kSelectedPions = kCurrentTrack.sign() > 0 ? kPosSelectedPions : kNegSelectedPions;
+        kSelectedPions.add(kCurrentTrack.index(), kCurrentTrack.px(), kCurrentTrack.py(), kCurrentTrack.pz(), .139570, kCurrentTrack.sign());
       }
     }
     //
     //  Invariant Mass for Phi
-    TLorentzVector lPositiveDecayDaughter;
-    TLorentzVector lNegativeDecayDaughter;
-    TLorentzVector lResonanceCandidate;
-    Int_t iUtility = 0;
-    Int_t jUtility = 0;
-    for (auto kPosKaon : kPosSelectedKaons) {
-      iUtility++;
-      for (auto kNegKaon : kNegSelectedKaons) {
-        jUtility++;
-        if (iUtility == jUtility)
-          continue;
-        //
-        lPositiveDecayDaughter.SetXYZM(get<0>(kPosKaon), get<1>(kPosKaon),
-                                       get<2>(kPosKaon), .493677);
-        lNegativeDecayDaughter.SetXYZM(get<0>(kNegKaon), get<1>(kNegKaon),
-                                       get<2>(kNegKaon), .493677);
-        lResonanceCandidate = lPositiveDecayDaughter + lNegativeDecayDaughter;
-        //
-        if (lResonanceCandidate.Mag() < 0.90 ||
-            lResonanceCandidate.Mag() > 1.10)
-          continue;
-        if (fabs(lResonanceCandidate.Rapidity()) > 0.5)
-          continue;
-        //
-        uHistograms.fill(HIST("Analysis/Phi/FullInvariantMass"),
-                         lResonanceCandidate.Mag());
-        uHistograms.fill(HIST("Analysis/Phi/PTInvariantMass"),
-                         lResonanceCandidate.Pt(),
-                         lResonanceCandidate.Mag());
-      }
-    }
-    iUtility = 0;
-    jUtility = 0;
-    for (auto kPosKaon : kPosSelectedKaons) {
-      iUtility++;
-      for (auto kNegKaon : kPosSelectedKaons) {
-        jUtility++;
-        if (iUtility == jUtility)
-          continue;
-        //
-        lPositiveDecayDaughter.SetXYZM(get<0>(kPosKaon), get<1>(kPosKaon),
-                                       get<2>(kPosKaon), .493677);
-        lNegativeDecayDaughter.SetXYZM(get<0>(kNegKaon), get<1>(kNegKaon),
-                                       get<2>(kNegKaon), .493677);
-        lResonanceCandidate = lPositiveDecayDaughter + lNegativeDecayDaughter;
-        //
-        if (lResonanceCandidate.Mag() < 0.90 ||
-            lResonanceCandidate.Mag() > 1.10)
-          continue;
-        if (fabs(lResonanceCandidate.Rapidity()) > 0.5)
-          continue;
-        //
-        uHistograms.fill(HIST("Analysis/Phi/BKG_FullInvariantMass"),
-                         lResonanceCandidate.Mag());
-        uHistograms.fill(HIST("Analysis/Phi/BKG_PTInvariantMass"),
-                         lResonanceCandidate.Pt(),
-                         lResonanceCandidate.Mag());
-      }
-    }
-    iUtility = 0;
-    jUtility = 0;
-    for (auto kPosKaon : kNegSelectedKaons) {
-      iUtility++;
-      for (auto kNegKaon : kNegSelectedKaons) {
-        jUtility++;
-        if (iUtility == jUtility)
-          continue;
-        //
-        lPositiveDecayDaughter.SetXYZM(get<0>(kPosKaon), get<1>(kPosKaon),
-                                       get<2>(kPosKaon), .493677);
-        lNegativeDecayDaughter.SetXYZM(get<0>(kNegKaon), get<1>(kNegKaon),
-                                       get<2>(kNegKaon), .493677);
-        lResonanceCandidate = lPositiveDecayDaughter + lNegativeDecayDaughter;
-        //
-        if (lResonanceCandidate.Mag() < 0.90 ||
-            lResonanceCandidate.Mag() > 1.10)
-          continue;
-        if (fabs(lResonanceCandidate.Rapidity()) > 0.5)
-          continue;
-        //
-        uHistograms.fill(HIST("Analysis/Phi/BKG_FullInvariantMass"),
-                         lResonanceCandidate.Mag());
-        uHistograms.fill(HIST("Analysis/Phi/BKG_PTInvariantMass"),
-                         lResonanceCandidate.Pt(),
-                         lResonanceCandidate.Mag());
-      }
-    }
+    uFillPairs(kPosSelectedKaons, kNegSelectedKaons, 0.90, 1.10, HIST("Analysis/Phi/FullInvariantMass"), HIST("Analysis/Phi/PTInvariantMass"));
+    uFillPairs(kPosSelectedKaons, kPosSelectedKaons, 0.90, 1.10, HIST("Analysis/Phi/BKG_FullInvariantMass"), HIST("Analysis/Phi/BKG_PTInvariantMass"));
+    uFillPairs(kNegSelectedKaons, kNegSelectedKaons, 0.90, 1.10, HIST("Analysis/Phi/BKG_FullInvariantMass"), HIST("Analysis/Phi/BKG_PTInvariantMass"));
     //  Invariant Mass for K*
-    for (auto kPosKaon : kPosSelectedKaons) {
-      for (auto kNegPion : kNegSelectedPions) {
-        //
-        lPositiveDecayDaughter.SetXYZM(get<0>(kPosKaon), get<1>(kPosKaon),
-                                       get<2>(kPosKaon), .493677);
-        lNegativeDecayDaughter.SetXYZM(get<0>(kNegPion), get<1>(kNegPion),
-                                       get<2>(kNegPion), .139570);
-        lResonanceCandidate = lPositiveDecayDaughter + lNegativeDecayDaughter;
-        //
-        if (lResonanceCandidate.Mag() < 0.70 ||
-            lResonanceCandidate.Mag() > 1.10)
-          continue;
-        if (fabs(lResonanceCandidate.Rapidity()) > 0.5)
-          continue;
-        //
-        uHistograms.fill(HIST("Analysis/Kstar/FullInvariantMass"),
-                         lResonanceCandidate.Mag());
-        uHistograms.fill(HIST("Analysis/Kstar/PTInvariantMass"),
-                         lResonanceCandidate.Pt(),
-                         lResonanceCandidate.Mag());
-      }
-    }
-    for (auto kPosPion : kPosSelectedPions) {
-      for (auto kNegKaon : kNegSelectedKaons) {
-        //
-        lPositiveDecayDaughter.SetXYZM(get<0>(kPosPion), get<1>(kPosPion),
-                                       get<2>(kPosPion), .139570);
-        lNegativeDecayDaughter.SetXYZM(get<0>(kNegKaon), get<1>(kNegKaon),
-                                       get<2>(kNegKaon), .493677);
-        lResonanceCandidate = lPositiveDecayDaughter + lNegativeDecayDaughter;
-        //
-        if (lResonanceCandidate.Mag() < 0.70 ||
-            lResonanceCandidate.Mag() > 1.10)
-          continue;
-        if (fabs(lResonanceCandidate.Rapidity()) > 0.5)
-          continue;
-        //
-        uHistograms.fill(HIST("Analysis/Kstar/FullInvariantMass"),
-                         lResonanceCandidate.Mag());
-        uHistograms.fill(HIST("Analysis/Kstar/PTInvariantMass"),
-                         lResonanceCandidate.Pt(),
-                         lResonanceCandidate.Mag());
-      }
-    }
-    for (auto kPosKaon : kPosSelectedKaons) {
-      for (auto kNegPion : kPosSelectedPions) {
-        //
-        lPositiveDecayDaughter.SetXYZM(get<0>(kPosKaon), get<1>(kPosKaon),
-                                       get<2>(kPosKaon), .493677);
-        lNegativeDecayDaughter.SetXYZM(get<0>(kNegPion), get<1>(kNegPion),
-                                       get<2>(kNegPion), .139570);
-        lResonanceCandidate = lPositiveDecayDaughter + lNegativeDecayDaughter;
-        //
-        if (lResonanceCandidate.Mag() < 0.70 ||
-            lResonanceCandidate.Mag() > 1.10)
-          continue;
-        if (fabs(lResonanceCandidate.Rapidity()) > 0.5)
-          continue;
-        //
-        uHistograms.fill(HIST("Analysis/Kstar/BKG_FullInvariantMass"),
-                         lResonanceCandidate.Mag());
-        uHistograms.fill(HIST("Analysis/Kstar/BKG_PTInvariantMass"),
-                         lResonanceCandidate.Pt(),
-                         lResonanceCandidate.Mag());
-      }
-    }
-    for (auto kPosPion : kNegSelectedPions) {
-      for (auto kNegKaon : kNegSelectedKaons) {
-        //
-        lPositiveDecayDaughter.SetXYZM(get<0>(kPosPion), get<1>(kPosPion),
-                                       get<2>(kPosPion), .139570);
-        lNegativeDecayDaughter.SetXYZM(get<0>(kNegKaon), get<1>(kNegKaon),
-                                       get<2>(kNegKaon), .493677);
-        lResonanceCandidate = lPositiveDecayDaughter + lNegativeDecayDaughter;
-        //
-        if (lResonanceCandidate.Mag() < 0.70 ||
-            lResonanceCandidate.Mag() > 1.10)
-          continue;
-        if (fabs(lResonanceCandidate.Rapidity()) > 0.5)
-          continue;
-        //
-        uHistograms.fill(HIST("Analysis/Kstar/BKG_FullInvariantMass"),
-                         lResonanceCandidate.Mag());
-        uHistograms.fill(HIST("Analysis/Kstar/BKG_PTInvariantMass"),
-                         lResonanceCandidate.Pt(),
-                         lResonanceCandidate.Mag());
-      }
-    }
+    uFillPairs(kPosSelectedKaons, kNegSelectedPions, 0.70, 1.10, HIST("Analysis/Kstar/FullInvariantMass"), HIST("Analysis/Kstar/PTInvariantMass"));
+    uFillPairs(kPosSelectedPions, kNegSelectedKaons, 0.70, 1.10, HIST("Analysis/Kstar/FullInvariantMass"), HIST("Analysis/Kstar/PTInvariantMass"));
+    uFillPairs(kPosSelectedKaons, kPosSelectedPions, 0.70, 1.10, HIST("Analysis/Kstar/BKG_FullInvariantMass"), HIST("Analysis/Kstar/BKG_PTInvariantMass"));
+    uFillPairs(kNegSelectedPions, kNegSelectedKaons, 0.70, 1.10, HIST("Analysis/Kstar/BKG_FullInvariantMass"), HIST("Analysis/Kstar/BKG_PTInvariantMass"));
   }
   PROCESS_SWITCH(rsn_analysis, processData, "Process Data", true);
   //
@@ -764,6 +596,29 @@ struct rsn_analysis {
   }
   PROCESS_SWITCH(rsn_analysis, processMCTruth, "Process Monte Carlo Truth", false);
   //
+  //  Fills the pairs of two pools of daughters in the mass window and with |y| < 0.5,
+  //  without the pairs of a daughter with itself when the two pools are the same
+  template <typename kHistFullType, typename kHistPTType>
+  void uFillPairs(ResoDaughters const& kFirstDaughters, ResoDaughters const& kSecondDaughters,
+                  double kMassMin, double kMassMax, kHistFullType kHistFull, kHistPTType kHistPT)
+  {
+    const bool kSamePool = &kFirstDaughters == &kSecondDaughters;
+    ResoPairKinematics lResonanceCandidate;
+    for (std::size_t iDaughter = 0; iDaughter < kFirstDaughters.size(); iDaughter++) {
+      for (std::size_t jDaughter = 0; jDaughter < kSecondDaughters.size(); jDaughter++) {
+        if (kSamePool && iDaughter == jDaughter)
+          continue;
+        if (!kFirstDaughters.pairInWindow(iDaughter, kSecondDaughters, jDaughter, kMassMin, kMassMax, lResonanceCandidate))
+          continue;
+        if (fabs(lResonanceCandidate.y) > 0.5)
+          continue;
+        //
+        uHistograms.fill(kHistFull, lResonanceCandidate.m);
+        uHistograms.fill(kHistPT, lResonanceCandidate.pt, lResonanceCandidate.m);
+      }
+    }
+  }
+  //
   template <typename kCurrentTrackType>
   bool uIsKaonSelected(kCurrentTrackType const& kCurrentTrack)
   {
@@ -0,0 +1,130 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file resoDaughters.h
+/// \brief Pre-selected resonance daughters of one event in flat arrays, for the pairing of the resonance tasks
+///
+/// The daughter candidates of an event are selected once (track and PID cuts) and stored with their
+/// momentum and energy for the mass hypothesis, so that the same-event and mixed-event pair loops
+/// only compute the pair kinematics instead of re-applying the cuts to both legs of every pair.
+
+#ifndef PWGLF_UTILS_RESODAUGHTERS_H_
+#define PWGLF_UTILS_RESODAUGHTERS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace o2::analysis
+{
+
+/// Invariant mass, transverse momentum and rapidity of a pair of daughters, as TLorentzVector::M, Pt and Rapidity
+struct ResoPairKinematics {
+  double m = 0.;
+  double pt = 0.;
+  double y = 0.;
+};
+
+/// Daughter candidates of one event and one mass hypothesis.
+///
+/// Usage:
+///   kaons.clear();
+///   for (const auto& track : tracks) { if (selected) kaons.add(track.index(), track.px(), track.py(), track.pz(), massKa, track.sign()); }
+///   for (std::size_t i = 0; i < kaons.size(); ++i) {
+///     for (std::size_t j = kaons.firstAfter(kaons.index(i)); j < kaons.size(); ++j) { auto pair = kaons.pair(i, kaons, j); ... }
+///   }
+class ResoDaughters
+{
+ public:
+  void clear()
+  {
+    mIndex.clear();
+    mPx.clear();
+    mPy.clear();
+    mPz.clear();
+    mE.clear();
+    mSign.clear();
+  }
+
+  /// Adds a daughter, in increasing order of the index (row of the track in the event)
+  void add(int64_t index, float px, float py, float pz, double mass, int8_t sign)
+  {
+    mIndex.push_back(index);
+    mPx.push_back(px);
+    mPy.push_back(py);
+    mPz.push_back(pz);
+    mE.push_back(std::sqrt(static_cast<double>(px) * px + static_cast<double>(py) * py + static_cast<double>(pz) * pz + mass * mass));
+    mSign.push_back(sign);
+  }
+
+  std::size_t size() const { return mIndex.size(); }
+
+  int64_t index(std::size_t i) const { return mIndex[i]; }
+  float px(std::size_t i) const { return mPx[i]; }
+  float py(std::size_t i) const { return mPy[i]; }
+  float pz(std::size_t i) const { return mPz[i]; }
+  double e(std::size_t i) const { return mE[i]; }
+  int8_t sign(std::size_t i) const { return mSign[i]; }
+
+  /// First daughter with an index larger than the given one, for the pairs of CombinationsUpperIndexPolicy without the diagonal
+  std::size_t firstAfter(int64_t index) const
+  {
+    return std::upper_bound(mIndex.begin(), mIndex.end(), index) - mIndex.begin();
+  }
+
+  /// Kinematics of the pair of the daughter i of this event and the daughter j of another (or the same) event
+  ResoPairKinematics pair(std::size_t i, const ResoDaughters& other, std::size_t j) const
+  {
+    const double px = static_cast<double>(mPx[i]) + other.mPx[j];
+    const double py = static_cast<double>(mPy[i]) + other.mPy[j];
+    const double pz = static_cast<double>(mPz[i]) + other.mPz[j];
+    const double e = mE[i] + other.mE[j];
+    const double m2 = e * e - px * px - py * py - pz * pz;
+    ResoPairKinematics kinematics;
+    kinematics.m = m2 < 0. ? -std::sqrt(-m2) : std::sqrt(m2);
+    kinematics.pt = std::sqrt(px * px + py * py);
+    kinematics.y = 0.5 * std::log((e + pz) / (e - pz));
+    return kinematics;
+  }
+
+  /// Kinematics of the pair as pair(), only if its invariant mass is in [massMin, massMax] (massMin >= 0).
+  /// The pairs outside of the window are rejected on the squared mass, before the square root and the rapidity,
+  /// so that the pairs of several mass hypotheses can be tried against their windows at a small cost.
+  bool pairInWindow(std::size_t i, const ResoDaughters& other, std::size_t j, double massMin, double massMax, ResoPairKinematics& kinematics) const
+  {
+    const double px = static_cast<double>(mPx[i]) + other.mPx[j];
+    const double py = static_cast<double>(mPy[i]) + other.mPy[j];
+    const double pz = static_cast<double>(mPz[i]) + other.mPz[j];
+    const double e = mE[i] + other.mE[j];
+    const double m2 = e * e - px * px - py * py - pz * pz;
+    if (m2 < massMin * massMin || m2 > massMax * massMax) {
+      return false;
+    }
+    kinematics.m = std::sqrt(m2);
+    kinematics.pt = std::sqrt(px * px + py * py);
+    kinematics.y = 0.5 * std::log((e + pz) / (e - pz));
+    return true;
+  }
+
+ private:
+  std::vector<int64_t> mIndex;
+  std::vector<float> mPx;
+  std::vector<float> mPy;
+  std::vector<float> mPz;
+  std::vector<double> mE; // energy for the mass hypothesis
+  std::vector<int8_t> mSign;
+};
+
+} // namespace o2::analysis
+
+#endif // PWGLF_UTILS_RESODAUGHTERS_H_
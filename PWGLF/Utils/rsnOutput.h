@@ -21,6 +21,7 @@
 
 #include "Framework/HistogramRegistry.h"
 #include "Framework/Logger.h"
+#include "Common/Core/SparseHistogram.h"
 
 using namespace o2::framework;
 
@@ -159,6 +160,24 @@ class Output
     mHistogramRegistry->get<THnSparse>(h)->Fill(mFillPoint);
   }
 
+  void fillSparse(SparseHistogram& h, double* point)
+  {
+    int i = 0;
+    for (auto& at : mCurrentAxisTypes) {
+      mFillPoint[i++] = point[static_cast<int>(at)];
+    }
+    h.fill(mFillPoint);
+  }
+
+  void fillSparseSys(SparseHistogram& h, double* point)
+  {
+    int i = 0;
+    for (auto& at : mCurrentAxisTypesSys) {
+      mFillPointSys[i++] = point[static_cast<int>(at)];
+    }
+    h.fill(mFillPointSys);
+  }
+
   template <typename T>
   void fillSparseSys(const T& h, double* point)
   {
@@ -194,6 +213,9 @@ class Output
   virtual void fillMixingmp(double* point) = 0;
   virtual void fillSystematics(double* point) = 0;
 
+  /// Adds the pairs accumulated since the last call to the histograms, to be called at the end of each process()
+  virtual void flush() {}
+
   PairAxisType type(std::string name)
   {
     auto it = std::find(PairAxis::names.begin(), PairAxis::names.end(), name);
@@ -250,27 +272,43 @@ class OutputSparse : public Output
     Output::init(sparseAxes, allAxes, sysAxes, allAxes_sys, produceTrue, eventMixing, produceLikesign, registry);
 
     mHistogramRegistry->add("unlikepm", "Unlike pm", *mPairHisto);
+    mUnlikepm.init(mHistogramRegistry->get<THnSparse>(HIST("unlikepm")).get());
     // mHistogramRegistry->add("unlikemp", "Unlike mp", *mPairHisto);
     if (produceLikesign) {
       mHistogramRegistry->add("likepp", "Like PP", *mPairHisto);
       mHistogramRegistry->add("likemm", "Like MM", *mPairHisto);
+      mLikepp.init(mHistogramRegistry->get<THnSparse>(HIST("likepp")).get());
+      mLikemm.init(mHistogramRegistry->get<THnSparse>(HIST("likemm")).get());
     }
     if (produceTrue) {
       mHistogramRegistry->add("unliketrue", "Unlike True", *mPairHisto);
       mHistogramRegistry->add("unlikegen", "Unlike Gen", *mPairHisto);
+      mUnliketrue.init(mHistogramRegistry->get<THnSparse>(HIST("unliketrue")).get());
+      mUnlikegen.init(mHistogramRegistry->get<THnSparse>(HIST("unlikegen")).get());
     }
     if (eventMixing) {
       mHistogramRegistry->add("mixingpm", "Event Mixing pm", *mPairHisto);
+      mMixingpm.init(mHistogramRegistry->get<THnSparse>(HIST("mixingpm")).get());
       if (produceLikesign) {
         mHistogramRegistry->add("mixingpp", "Event Mixing pp", *mPairHisto);
         mHistogramRegistry->add("mixingmm", "Event Mixing mm", *mPairHisto);
+        mMixingpp.init(mHistogramRegistry->get<THnSparse>(HIST("mixingpp")).get());
+        mMixingmm.init(mHistogramRegistry->get<THnSparse>(HIST("mixingmm")).get());
       }
       mHistogramRegistry->add("mixingmp", "Event Mixing mp", *mPairHisto);
+      mMixingmp.init(mHistogramRegistry->get<THnSparse>(HIST("mixingmp")).get());
     }
 
     mHistogramRegistry->add("Mapping/systematics", "Systematics mapping", *mPairHistoSys);
   }
 
+  virtual void flush()
+  {
+    for (auto* h : {&mUnlikepm, &mLikepp, &mLikemm, &mUnliketrue, &mUnlikegen, &mMixingpm, &mMixingpp, &mMixingmm, &mMixingmp}) {
+      h->flush();
+    }
+  }
+
   virtual void
     fill(EventType t, double* point)
   {
@@ -323,7 +361,7 @@ class OutputSparse : public Output
 
   virtual void fillUnlikepm(double* point)
   {
-    fillSparse(HIST("unlikepm"), point);
+    fillSparse(mUnlikepm, point);
   }
   virtual void fillUnlikemp(double* point)
   {
@@ -331,43 +369,55 @@ class OutputSparse : public Output
   }
   virtual void fillLikepp(double* point)
   {
-    fillSparse(HIST("likepp"), point);
+    fillSparse(mLikepp, point);
   }
 
   virtual void fillLikemm(double* point)
   {
-    fillSparse(HIST("likemm"), point);
+    fillSparse(mLikemm, point);
   }
 
   virtual void fillUnliketrue(double* point)
   {
-    fillSparse(HIST("unliketrue"), point);
+    fillSparse(mUnliketrue, point);
   }
 
   virtual void fillUnlikegen(double* point)
   {
-    fillSparse(HIST("unlikegen"), point);
+    fillSparse(mUnlikegen, point);
   }
   virtual void fillMixingpm(double* point)
   {
-    fillSparse(HIST("mixingpm"), point);
+    fillSparse(mMixingpm, point);
   }
   virtual void fillMixingpp(double* point)
   {
-    fillSparse(HIST("mixingpp"), point);
+    fillSparse(mMixingpp, point);
   }
   virtual void fillMixingmm(double* point)
   {
-    fillSparse(HIST("mixingmm"), point);
+    fillSparse(mMixingmm, point);
   }
   virtual void fillMixingmp(double* point)
   {
-    fillSparse(HIST("mixingmp"), point);
+    fillSparse(mMixingmp, point);
   }
   virtual void fillSystematics(double* point)
   {
     fillSparse(HIST("Mapping/systematics"), point);
   }
+
+ private:
+  // pairs of the histograms filled per pair, flushed by flush()
+  SparseHistogram mUnlikepm;
+  SparseHistogram mLikepp;
+  SparseHistogram mLikemm;
+  SparseHistogram mUnliketrue;
+  SparseHistogram mUnlikegen;
+  SparseHistogram mMixingpm;
+  SparseHistogram mMixingpp;
+  SparseHistogram mMixingmm;
+  SparseHistogram mMixingmp;
 };
 } // namespace rsn
 } // namespace o2::analysis
@@ -13,9 +13,12 @@
 ///        it is meant to be a blank page for further developments.
 /// \author everyone
 
+#include <array>
+
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
+#include "Common/Core/DenseHistogram.h"
 #include "Common/DataModel/EventSelection.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "Framework/ASoAHelpers.h"
@@ -40,6 +43,45 @@ struct lumiStabilityTask {
   Configurable<int> myMaxDeltaBCFT0{"myMaxDeltaBCFT0", 5, {"My BC cut"}};
   Configurable<int> myMaxDeltaBCFV0{"myMaxDeltaBCFV0", 5, {"My BC cut"}};
 
+  // Triggers per BC: accumulated in dense arrays and added to the bc* histograms at the end of processMain,
+  // instead of a registry fill (lookup of the histogram and bin search) per trigger
+  enum BcHistos {
+    kFDDVertexTrigger = 0,
+    kFDDVertexTriggerCoincidence,
+    kFDDVertexTriggerCoincidencePFP,
+    kFDDVertexTriggerCoincidencePP,
+    kFDDVertexTriggerBothSidesCoincidencePFP,
+    kFDDVertexTriggerBothSidesCoincidencePP,
+    kFDDSCentralTrigger,
+    kFDDSCentralTriggerCoincidence,
+    kFDDVSCTrigger,
+    kFDDVSCTriggerCoincidence,
+    kFDDCentralTrigger,
+    kFDDCentralTriggerCoincidence,
+    kFDDVCTrigger,
+    kFDDVCTriggerCoincidence,
+    kFT0VertexTrigger,
+    kFT0VertexTriggerPFP,
+    kFT0VertexTriggerPP,
+    kFT0VertexTriggerBothSidesPFP,
+    kFT0VertexTriggerBothSidesPP,
+    kFT0SCentralTrigger,
+    kFT0VSCTrigger,
+    kFT0SCentralCentralTrigger,
+    kFT0CentralTrigger,
+    kFT0VCTrigger,
+    kFV0OutTrigger,
+    kFV0InTrigger,
+    kFV0SCenTrigger,
+    kFV0CenTrigger,
+    kFV0CenTriggerPFPCentral,
+    kFV0CenTriggerPPCentral,
+    kFV0CenTriggerPFPOutIn,
+    kFV0CenTriggerPPOutIn,
+    kNBcHistos
+  };
+  std::array<DenseHistogram, kNBcHistos> bcHistos;
+
   void init(InitContext const&)
   {
     const AxisSpec axisCounts{5, -0.5, 4.5};
@@ -47,41 +89,42 @@ struct lumiStabilityTask {
 
     // histo about triggers
     histos.add("FDD/hCounts", "0 CountVertexFDD - 1 CountPFPVertexCoincidencesFDD - 2 CountPFPTriggerCoincidencesFDD - 3 CountPPVertexCoincidencesFDD - 4 CountPPTriggerCoincidencesFDD; Number; counts", kTH1F, {axisCounts});
-    histos.add("FDD/bcVertexTrigger", "vertex trigger per BC (FDD);BC in FDD; counts", kTH1F, {axisTriggger});
-    histos.add("FDD/bcVertexTriggerCoincidence", "vertex trigger per BC (FDD) with coincidences;BC in FDD; counts", kTH1F, {axisTriggger});
-    histos.add("FDD/bcVertexTriggerCoincidencePFP", "vertex trigger per BC (FDD) with coincidences and Past Future Protection;BC in FDD; counts", kTH1F, {axisTriggger});
-    histos.add("FDD/bcVertexTriggerCoincidencePP", "vertex trigger per BC (FDD) with coincidences and Past Protection;BC in FDD; counts", kTH1F, {axisTriggger});
-    histos.add("FDD/bcVertexTriggerBothSidesCoincidencePFP", "vertex per BC (FDD) with coincidences, at least one side trigger and Past Future Protection;BC in FDD; counts", kTH1F, {axisTriggger});
-    histos.add("FDD/bcVertexTriggerBothSidesCoincidencePP", "vertex per BC (FDD) with coincidences, at least one side trigger and Past Protection;BC in FDD; counts", kTH1F, {axisTriggger});
-    histos.add("FDD/bcSCentralTrigger", "scentral trigger per BC (FDD);BC in FDD; counts", kTH1F, {axisTriggger});
-    histos.add("FDD/bcSCentralTriggerCoincidence", "scentral trigger per BC (FDD) with coincidences;BC in FDD; counts", kTH1F, {axisTriggger});
-    histos.add("FDD/bcVSCTrigger", "vertex and scentral trigger per BC (FDD);BC in FDD; counts", kTH1F, {axisTriggger});
-    histos.add("FDD/bcVSCTriggerCoincidence", "vertex and scentral trigger per BC (FDD) with coincidences;BC in FDD; counts", kTH1F, {axisTriggger});
-    histos.add("FDD/bcCentralTrigger", "central trigger per BC (FDD);BC in FDD; counts", kTH1F, {axisTriggger});
-    histos.add("FDD/bcCentralTriggerCoincidence", "central trigger per BC (FDD) with coincidences;BC in FDD; counts", kTH1F, {axisTriggger});
-    histos.add("FDD/bcVCTrigger", "vertex and central trigger per BC (FDD);BC in FDD; counts", kTH1F, {axisTriggger});
-    histos.add("FDD/bcVCTriggerCoincidence", "vertex and central trigger per BC (FDD) with coincidences;BC in FDD; counts", kTH1F, {axisTriggger});
+    bcHistos[kFDDVertexTrigger].init(histos.add<TH1>("FDD/bcVertexTrigger", "vertex trigger per BC (FDD);BC in FDD; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFDDVertexTriggerCoincidence].init(histos.add<TH1>("FDD/bcVertexTriggerCoincidence", "vertex trigger per BC (FDD) with coincidences;BC in FDD; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFDDVertexTriggerCoincidencePFP].init(histos.add<TH1>("FDD/bcVertexTriggerCoincidencePFP", "vertex trigger per BC (FDD) with coincidences and Past Future Protection;BC in FDD; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFDDVertexTriggerCoincidencePP].init(histos.add<TH1>("FDD/bcVertexTriggerCoincidencePP", "vertex trigger per BC (FDD) with coincidences and Past Protection;BC in FDD; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFDDVertexTriggerBothSidesCoincidencePFP].init(histos.add<TH1>("FDD/bcVertexTriggerBothSidesCoincidencePFP", "vertex per BC (FDD) with coincidences, at least one side trigger and Past Future Protection;BC in FDD; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFDDVertexTriggerBothSidesCoincidencePP].init(histos.add<TH1>("FDD/bcVertexTriggerBothSidesCoincidencePP", "vertex per BC (FDD) with coincidences, at least one side trigger and Past Protection;BC in FDD; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFDDSCentralTrigger].init(histos.add<TH1>("FDD/bcSCentralTrigger", "scentral trigger per BC (FDD);BC in FDD; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFDDSCentralTriggerCoincidence].init(histos.add<TH1>("FDD/bcSCentralTriggerCoincidence", "scentral trigger per BC (FDD) with coincidences;BC in FDD; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFDDVSCTrigger].init(histos.add<TH1>("FDD/bcVSCTrigger", "vertex and scentral trigger per BC (FDD);BC in FDD; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFDDVSCTriggerCoincidence].init(histos.add<TH1>("FDD/bcVSCTriggerCoincidence", "vertex and scentral trigger per BC (FDD) with coincidences;BC in FDD; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFDDCentralTrigger].init(histos.add<TH1>("FDD/bcCentralTrigger", "central trigger per BC (FDD);BC in FDD; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFDDCentralTriggerCoincidence].init(histos.add<TH1>("FDD/bcCentralTriggerCoincidence", "central trigger per BC (FDD) with coincidences;BC in FDD; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFDDVCTrigger].init(histos.add<TH1>("FDD/bcVCTrigger", "vertex and central trigger per BC (FDD);BC in FDD; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFDDVCTriggerCoincidence].init(histos.add<TH1>("FDD/bcVCTriggerCoincidence", "vertex and central trigger per BC (FDD) with coincidences;BC in FDD; counts", kTH1F, {axisTriggger}).get());
 
     histos.add("FT0/hCounts", "0 CountVertexFT0 - 1 CountPFPVertexCoincidencesFT0 - 2 CountPFPTriggerCoincidencesFT0 - 3 CountPPVertexCoincidencesFT0 - 4 CountPPTriggerCoincidencesFT0; Number; counts", kTH1F, {axisCounts});
-    histos.add("FT0/bcVertexTrigger", "vertex trigger per BC (FT0);BC in FT0; counts", kTH1F, {axisTriggger});
-    histos.add("FT0/bcVertexTriggerPFP", "vertex trigger per BC (FT0) with Past Future Protection;BC in FT0; counts", kTH1F, {axisTriggger});
-    histos.add("FT0/bcVertexTriggerPP", "vertex trigger per BC (FT0) with Past Protection;BC in FT0; counts", kTH1F, {axisTriggger});
-    histos.add("FT0/bcVertexTriggerBothSidesPFP", "vertex per BC (FDD) with coincidences, at least one side trigger and Past Future Protection;BC in FDD; counts", kTH1F, {axisTriggger});
-    histos.add("FT0/bcVertexTriggerBothSidesPP", "vertex per BC (FDD) with coincidences, at least one side trigger and Past Protection;BC in FDD; counts", kTH1F, {axisTriggger});
-    histos.add("FT0/bcSCentralTrigger", "Scentral trigger per BC (FT0);BC in FT0; counts", kTH1F, {axisTriggger});
-    histos.add("FT0/bcVSCTrigger", "vertex and Scentral trigger per BC (FT0);BC in FT0; counts", kTH1F, {axisTriggger});
-    histos.add("FT0/bcCentralTrigger", "central trigger per BC (FT0);BC in FT0; counts", kTH1F, {axisTriggger});
-    histos.add("FT0/bcVCTrigger", "vertex and central trigger per BC (FT0);BC in FT0; counts", kTH1F, {axisTriggger});
+    bcHistos[kFT0VertexTrigger].init(histos.add<TH1>("FT0/bcVertexTrigger", "vertex trigger per BC (FT0);BC in FT0; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFT0VertexTriggerPFP].init(histos.add<TH1>("FT0/bcVertexTriggerPFP", "vertex trigger per BC (FT0) with Past Future Protection;BC in FT0; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFT0VertexTriggerPP].init(histos.add<TH1>("FT0/bcVertexTriggerPP", "vertex trigger per BC (FT0) with Past Protection;BC in FT0; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFT0VertexTriggerBothSidesPFP].init(histos.add<TH1>("FT0/bcVertexTriggerBothSidesPFP", "vertex per BC (FDD) with coincidences, at least one side trigger and Past Future Protection;BC in FDD; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFT0VertexTriggerBothSidesPP].init(histos.add<TH1>("FT0/bcVertexTriggerBothSidesPP", "vertex per BC (FDD) with coincidences, at least one side trigger and Past Protection;BC in FDD; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFT0SCentralTrigger].init(histos.add<TH1>("FT0/bcSCentralTrigger", "Scentral trigger per BC (FT0);BC in FT0; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFT0VSCTrigger].init(histos.add<TH1>("FT0/bcVSCTrigger", "vertex and Scentral trigger per BC (FT0);BC in FT0; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFT0SCentralCentralTrigger].init(histos.add<TH1>("FT0/bcSCentralCentralTrigger", "Scentral and central trigger per BC (FT0);BC in FT0; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFT0CentralTrigger].init(histos.add<TH1>("FT0/bcCentralTrigger", "central trigger per BC (FT0);BC in FT0; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFT0VCTrigger].init(histos.add<TH1>("FT0/bcVCTrigger", "vertex and central trigger per BC (FT0);BC in FT0; counts", kTH1F, {axisTriggger}).get());
 
     histos.add("FV0/hCounts", "0 CountCentralFV0 - 1 CountPFPCentralFV0 - 2 CountPFPOutInFV0 - 3 CountPPCentralFV0 - 4 CountPPOutInFV0; Number; counts", kTH1F, {axisCounts});
-    histos.add("FV0/bcOutTrigger", "Out trigger per BC (FV0);BC in V0; counts", kTH1F, {axisTriggger});
-    histos.add("FV0/bcInTrigger", "In trigger per BC (FV0);BC in V0; counts", kTH1F, {axisTriggger});
-    histos.add("FV0/bcSCenTrigger", "SCen trigger per BC (FV0);BC in V0; counts", kTH1F, {axisTriggger});
-    histos.add("FV0/bcCenTrigger", "Central trigger per BC (FV0);BC in V0; counts", kTH1F, {axisTriggger});
-    histos.add("FV0/bcCenTriggerPFPCentral", "Central trigger per BC (FV0) with PFP in central trigger;BC in V0; counts", kTH1F, {axisTriggger});
-    histos.add("FV0/bcCenTriggerPPCentral", "Central trigger per BC (FV0) with PP in central trigger;BC in V0; counts", kTH1F, {axisTriggger});
-    histos.add("FV0/bcCenTriggerPFPOutIn", "Central trigger per BC (FV0) with PFP in Out and In trigger;BC in V0; counts", kTH1F, {axisTriggger});
-    histos.add("FV0/bcCenTriggerPPOutIn", "Central trigger per BC (FV0) with PP in Out and In trigger;BC in V0; counts", kTH1F, {axisTriggger});
+    bcHistos[kFV0OutTrigger].init(histos.add<TH1>("FV0/bcOutTrigger", "Out trigger per BC (FV0);BC in V0; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFV0InTrigger].init(histos.add<TH1>("FV0/bcInTrigger", "In trigger per BC (FV0);BC in V0; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFV0SCenTrigger].init(histos.add<TH1>("FV0/bcSCenTrigger", "SCen trigger per BC (FV0);BC in V0; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFV0CenTrigger].init(histos.add<TH1>("FV0/bcCenTrigger", "Central trigger per BC (FV0);BC in V0; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFV0CenTriggerPFPCentral].init(histos.add<TH1>("FV0/bcCenTriggerPFPCentral", "Central trigger per BC (FV0) with PFP in central trigger;BC in V0; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFV0CenTriggerPPCentral].init(histos.add<TH1>("FV0/bcCenTriggerPPCentral", "Central trigger per BC (FV0) with PP in central trigger;BC in V0; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFV0CenTriggerPFPOutIn].init(histos.add<TH1>("FV0/bcCenTriggerPFPOutIn", "Central trigger per BC (FV0) with PFP in Out and In trigger;BC in V0; counts", kTH1F, {axisTriggger}).get());
+    bcHistos[kFV0CenTriggerPPOutIn].init(histos.add<TH1>("FV0/bcCenTriggerPPOutIn", "Central trigger per BC (FV0) with PP in Out and In trigger;BC in V0; counts", kTH1F, {axisTriggger}).get());
   }
 
   bool checkAnyCoincidence(const std::vector<int>& channels)
@@ -111,6 +154,7 @@ struct lumiStabilityTask {
 
       Long64_t globalBC = bc.globalBC();
       int localBC = globalBC % nBCsPerOrbit;
+      const DenseBin bcBin{localBC + 1, static_cast<double>(localBC)};
 
       std::bitset<8> fddTriggers = fdd.triggerMask();
       bool vertex = fddTriggers[o2::fdd::Triggers::bitVertex];
@@ -134,9 +178,9 @@ struct lumiStabilityTask {
       bool isCoinC = checkAnyCoincidence(channelC);
 
       if (vertex) {
-        histos.fill(HIST("FDD/bcVertexTrigger"), localBC);
+        bcHistos[kFDDVertexTrigger].fill(bcBin);
         if (isCoinA && isCoinC) {
-          histos.fill(HIST("FDD/bcVertexTriggerCoincidence"), localBC);
+          bcHistos[kFDDVertexTriggerCoincidence].fill(bcBin);
 
           int deltaIndex = 0; // backward move counts
           int deltaBC = 0;    // current difference wrt globalBC
@@ -220,51 +264,51 @@ struct lumiStabilityTask {
           if ((pastActivityFDDTriggerACoincidenceA || futureActivityFDDTriggerACoincidenceA) == true || (pastActivityFDDTriggerCCoincidenceC || futureActivityFDDTriggerCCoincidenceC) == true) {
             histos.fill(HIST("FDD/hCounts"), 2);
           } else {
-            histos.fill(HIST("FDD/bcVertexTriggerBothSidesCoincidencePFP"), localBC);
+            bcHistos[kFDDVertexTriggerBothSidesCoincidencePFP].fill(bcBin);
           }
           if (pastActivityFDDTriggerACoincidenceA == true || pastActivityFDDTriggerCCoincidenceC == true) {
             histos.fill(HIST("FDD/hCounts"), 4);
           } else {
-            histos.fill(HIST("FDD/bcVertexTriggerBothSidesCoincidencePP"), localBC);
+            bcHistos[kFDDVertexTriggerBothSidesCoincidencePP].fill(bcBin);
           }
           if (pastActivityFDDVertexCoincidences == true || futureActivityFDDVertexCoincidences == true) {
             histos.fill(HIST("FDD/hCounts"), 1);
           } else {
-            histos.fill(HIST("FDD/bcVertexTriggerCoincidencePFP"), localBC);
+            bcHistos[kFDDVertexTriggerCoincidencePFP].fill(bcBin);
           }
           if (pastActivityFDDVertexCoincidences == true) {
             histos.fill(HIST("FDD/hCounts"), 3);
           } else {
-            histos.fill(HIST("FDD/bcVertexTriggerCoincidencePP"), localBC);
+            bcHistos[kFDDVertexTriggerCoincidencePP].fill(bcBin);
           }
         }
       } // vertex true
 
       if (scentral) {
-        histos.fill(HIST("FDD/bcSCentralTrigger"), localBC);
+        bcHistos[kFDDSCentralTrigger].fill(bcBin);
         if (isCoinA && isCoinC) {
-          histos.fill(HIST("FDD/bcSCentralTriggerCoincidence"), localBC);
+          bcHistos[kFDDSCentralTriggerCoincidence].fill(bcBin);
         }
       } // central true
 
       if (vertex && scentral) {
-        histos.fill(HIST("FDD/bcVSCTrigger"), localBC);
+        bcHistos[kFDDVSCTrigger].fill(bcBin);
         if (isCoinA && isCoinC) {
-          histos.fill(HIST("FDD/bcVSCTriggerCoincidence"), localBC);
+          bcHistos[kFDDVSCTriggerCoincidence].fill(bcBin);
         }
       } // vertex and scentral true
 
       if (central) {
-        histos.fill(HIST("FDD/bcCentralTrigger"), localBC);
+        bcHistos[kFDDCentralTrigger].fill(bcBin);
         if (isCoinA && isCoinC) {
-          histos.fill(HIST("FDD/bcCentralTriggerCoincidence"), localBC);
+          bcHistos[kFDDCentralTriggerCoincidence].fill(bcBin);
         }
       }
 
       if (vertex && central) {
-        histos.fill(HIST("FDD/bcVCTrigger"), localBC);
+        bcHistos[kFDDVCTrigger].fill(bcBin);
         if (isCoinA && isCoinC) {
-          histos.fill(HIST("FDD/bcVCTriggerCoincidence"), localBC);
+          bcHistos[kFDDVCTriggerCoincidence].fill(bcBin);
         }
       } // vertex and scentral true
     }   // loop over FDD events
@@ -277,6 +321,7 @@ struct lumiStabilityTask {
 
       Long64_t globalBC = bc.globalBC();
       int localBC = globalBC % nBCsPerOrbit;
+      const DenseBin bcBin{localBC + 1, static_cast<double>(localBC)};
 
       std::bitset<8> fT0Triggers = ft0.triggerMask();
       bool vertex = fT0Triggers[o2::ft0::Triggers::bitVertex];
@@ -284,7 +329,7 @@ struct lumiStabilityTask {
       bool central = fT0Triggers[o2::ft0::Triggers::bitCen];
 
       if (vertex) {
-        histos.fill(HIST("FT0/bcVertexTrigger"), localBC);
+        bcHistos[kFT0VertexTrigger].fill(bcBin);
 
         int deltaIndex = 0; // backward move counts
         int deltaBC = 0;    // current difference wrt globalBC
@@ -340,39 +385,39 @@ struct lumiStabilityTask {
         if ((pastActivityFT0TriggerA || futureActivityFT0TriggerA) == true || (pastActivityFT0TriggerC || futureActivityFT0TriggerC) == true) {
           histos.fill(HIST("FT0/hCounts"), 2);
         } else {
-          histos.fill(HIST("FT0/bcVertexTriggerBothSidesPFP"), localBC);
+          bcHistos[kFT0VertexTriggerBothSidesPFP].fill(bcBin);
         }
         if (pastActivityFT0TriggerA == true || pastActivityFT0TriggerC == true) {
           histos.fill(HIST("FT0/hCounts"), 4);
         } else {
-          histos.fill(HIST("FT0/bcVertexTriggerBothSidesPP"), localBC);
+          bcHistos[kFT0VertexTriggerBothSidesPP].fill(bcBin);
         }
         if (pastActivityFT0Vertex == true || futureActivityFT0Vertex == true) {
           histos.fill(HIST("FT0/hCounts"), 1);
         } else {
-          histos.fill(HIST("FT0/bcVertexTriggerPFP"), localBC);
+          bcHistos[kFT0VertexTriggerPFP].fill(bcBin);
         }
         if (pastActivityFT0Vertex == true) {
           histos.fill(HIST("FT0/hCounts"), 3);
         } else {
-          histos.fill(HIST("FT0/bcVertexTriggerPP"), localBC);
+          bcHistos[kFT0VertexTriggerPP].fill(bcBin);
         }
       } // vertex true
 
       if (sCentral) {
-        histos.fill(HIST("FT0/bcSCentralTrigger"), localBC);
+        bcHistos[kFT0SCentralTrigger].fill(bcBin);
         if (vertex) {
-          histos.fill(HIST("FT0/bcVSCTrigger"), localBC);
+          bcHistos[kFT0VSCTrigger].fill(bcBin);
         }
       } // scentral true
 
       if (central) {
-        histos.fill(HIST("FT0/bcCentralTrigger"), localBC);
+        bcHistos[kFT0CentralTrigger].fill(bcBin);
         if (sCentral) {
-          histos.fill(HIST("FT0/bcSCentralCentralTrigger"), localBC);
+          bcHistos[kFT0SCentralCentralTrigger].fill(bcBin);
         }
         if (vertex) {
-          histos.fill(HIST("FT0/bcVCTrigger"), localBC);
+          bcHistos[kFT0VCTrigger].fill(bcBin);
         }
       }
     } // loop over FT0 events
@@ -385,6 +430,7 @@ struct lumiStabilityTask {
 
       Long64_t globalBC = bc.globalBC();
       int localBC = globalBC % nBCsPerOrbit;
+      const DenseBin bcBin{localBC + 1, static_cast<double>(localBC)};
 
       std::bitset<8> fv0Triggers = fv0.triggerMask();
       bool aOut = fv0Triggers[o2::fv0::Triggers::bitAOut];
@@ -393,19 +439,19 @@ struct lumiStabilityTask {
       bool aCen = fv0Triggers[o2::fv0::Triggers::bitTrgCharge];
 
       if (aOut) {
-        histos.fill(HIST("FV0/bcOutTrigger"), localBC);
+        bcHistos[kFV0OutTrigger].fill(bcBin);
       }
 
       if (aIn) {
-        histos.fill(HIST("FV0/bcInTrigger"), localBC);
+        bcHistos[kFV0InTrigger].fill(bcBin);
       }
 
       if (aSCen) {
-        histos.fill(HIST("FV0/bcSCenTrigger"), localBC);
+        bcHistos[kFV0SCenTrigger].fill(bcBin);
       }
 
       if (aCen) {
-        histos.fill(HIST("FV0/bcCenTrigger"), localBC);
+        bcHistos[kFV0CenTrigger].fill(bcBin);
 
         int deltaIndex = 0; // backward move counts
         int deltaBC = 0;    // current difference wrt globalBC
@@ -461,26 +507,30 @@ struct lumiStabilityTask {
         if ((pastActivityFV0TriggerOut || futureActivityFV0TriggerOut) == true || (pastActivityFV0TriggerIn || futureActivityFV0TriggerIn) == true) {
           histos.fill(HIST("FV0/hCounts"), 2);
         } else {
-          histos.fill(HIST("FV0/bcCenTriggerPFPOutIn"), localBC);
+          bcHistos[kFV0CenTriggerPFPOutIn].fill(bcBin);
         }
         if (pastActivityFV0TriggerOut == true || pastActivityFV0TriggerIn == true) {
           histos.fill(HIST("FV0/hCounts"), 4);
         } else {
-          histos.fill(HIST("FV0/bcCenTriggerPPOutIn"), localBC);
+          bcHistos[kFV0CenTriggerPPOutIn].fill(bcBin);
         }
         if (pastActivityFV0Cen == true || futureActivityFV0Cen == true) {
           histos.fill(HIST("FV0/hCounts"), 1);
         } else {
-          histos.fill(HIST("FV0/bcCenTriggerPFPCentral"), localBC);
+          bcHistos[kFV0CenTriggerPFPCentral].fill(bcBin);
         }
         if (pastActivityFV0Cen == true) {
           histos.fill(HIST("FV0/hCounts"), 3);
         } else {
-          histos.fill(HIST("FV0/bcCenTriggerPPCentral"), localBC);
+          bcHistos[kFV0CenTriggerPPCentral].fill(bcBin);
         }
       }
     } // loop over V0 events
-  }   // end processMain
+
+    for (auto& bcHisto : bcHistos) {
+      bcHisto.flush();
+    }
+  } // end processMain
 
   PROCESS_SWITCH(lumiStabilityTask, processMain, "Process FDD and FT0 to lumi stability analysis", true);
 };
@@ -0,0 +1,168 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef PWGMM_MULT_CORE_INCLUDE_DENSECOUNTER_H_
+#define PWGMM_MULT_CORE_INCLUDE_DENSECOUNTER_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "TAxis.h"
+#include "TH1.h"
+#include "THnSparse.h"
+
+namespace pwgmm::mult
+{
+// Unit-weight counts with the binning of a TH1/TH2/TH3 or THnSparse, kept in a dense array
+// (including under- and overflow bins) and added to the histogram by flush().
+// A fill is a bin search per axis and an increment, instead of a THnSparse coordinate lookup;
+// flush() only visits the cells filled since the previous flush.
+class DenseCounter
+{
+ public:
+  // takes the binning of the histogram, stays inactive (returns false) if the number of cells exceeds maxCells
+  bool init(const TH1* h, int64_t maxCells)
+  {
+    std::vector<const TAxis*> axes{h->GetXaxis()};
+    if (h->GetDimension() > 1) {
+      axes.push_back(h->GetYaxis());
+    }
+    if (h->GetDimension() > 2) {
+      axes.push_back(h->GetZaxis());
+    }
+    return init(axes, maxCells);
+  }
+
+  bool init(const THnBase* h, int64_t maxCells)
+  {
+    std::vector<const TAxis*> axes;
+    for (int i = 0; i < h->GetNdimensions(); ++i) {
+      axes.push_back(h->GetAxis(i));
+    }
+    return init(axes, maxCells);
+  }
+
+  bool isActive() const { return !counts.empty(); }
+
+  template <typename... Ts>
+  void fill(Ts... xs)
+  {
+    int64_t cell = 0;
+    int i = 0;
+    ((cell += strides[i] * axes[i].findBin(xs), ++i), ...);
+    if (counts[cell]++ == 0) {
+      touched.push_back(cell);
+    }
+    ++nFills;
+  }
+
+  // the cell numbering (first axis fastest, with under- and overflow) is the global bin numbering of TH1
+  void flush(TH1* h)
+  {
+    const bool sumw2 = h->GetSumw2N() > 0;
+    for (auto cell : touched) {
+      h->AddBinContent(cell, counts[cell]);
+      if (sumw2) {
+        h->GetSumw2()->fArray[cell] += counts[cell];
+      }
+      counts[cell] = 0;
+    }
+    if (nFills > 0) {
+      auto entries = h->GetEntries() + nFills;
+      h->ResetStats();
+      h->SetEntries(entries);
+    }
+    touched.clear();
+    nFills = 0;
+  }
+
+  void flush(THnSparse* h)
+  {
+    std::vector<int> idx(axes.size());
+    const bool sumw2 = h->GetCalculateErrors();
+    for (auto cell : touched) {
+      auto rest = cell;
+      for (auto i = axes.size(); i-- > 0;) {
+        idx[i] = rest / strides[i];
+        rest -= idx[i] * strides[i];
+      }
+      auto bin = h->GetBin(idx.data());
+      h->AddBinContent(bin, counts[cell]);
+      if (sumw2) {
+        h->AddBinError2(bin, counts[cell]);
+      }
+      counts[cell] = 0;
+    }
+    h->SetEntries(h->GetEntries() + nFills);
+    touched.clear();
+    nFills = 0;
+  }
+
+ private:
+  // binning of one axis, with the ROOT numbering (0 -- underflow, nBins + 1 -- overflow) as TAxis::FindBin
+  struct Axis {
+    int nBins = 1;
+    double min = 0.;
+    double max = 1.;
+    std::vector<double> edges; // variable binning only
+
+    int findBin(double x) const
+    {
+      if (x < min) {
+        return 0;
+      }
+      if (!(x < max)) {
+        return nBins + 1;
+      }
+      if (edges.empty()) {
+        return 1 + static_cast<int>(nBins * (x - min) / (max - min));
+      }
+      return static_cast<int>(std::upper_bound(edges.begin(), edges.end(), x) - edges.begin());
+    }
+  };
+
+  bool init(std::vector<const TAxis*> const& rootAxes, int64_t maxCells)
+  {
+    axes.clear();
+    strides.clear();
+    counts.clear();
+    touched.clear();
+    nFills = 0;
+    int64_t nCells = 1;
+    for (auto const* rootAxis : rootAxes) {
+      Axis axis;
+      axis.nBins = rootAxis->GetNbins();
+      axis.min = rootAxis->GetXmin();
+      axis.max = rootAxis->GetXmax();
+      if (rootAxis->IsVariableBinSize()) {
+        axis.edges.assign(rootAxis->GetXbins()->GetArray(), rootAxis->GetXbins()->GetArray() + axis.nBins + 1);
+      }
+      strides.push_back(nCells);
+      nCells *= axis.nBins + 2;
+      axes.push_back(axis);
+    }
+    if (nCells > maxCells) {
+      return false;
+    }
+    counts.assign(nCells, 0);
+    return true;
+  }
+
+  std::vector<Axis> axes;
+  std::vector<int64_t> strides;
+  std::vector<uint32_t> counts;
+  std::vector<int64_t> touched; // cells with non-zero counts
+  int64_t nFills = 0;
+};
+} // namespace pwgmm::mult
+
+#endif // PWGMM_MULT_CORE_INCLUDE_DENSECOUNTER_H_
@@ -70,6 +70,19 @@ DECLARE_SOA_TABLE(StoredRCollisions, "AOD1", "RCOLLISION",
                   Ccols,
                   soa::Marker<2>)
 
+// Event class of the reduced collisions (bin of the reducer class binning, -1 -- outside), joinable with RCollisions
+namespace rcol
+{
+DECLARE_SOA_COLUMN(EvClass, evClass, int8_t);
+} // namespace rcol
+
+DECLARE_SOA_TABLE(RCollClasses, "AOD", "RCOLLCLASS",
+                  rcol::EvClass,
+                  soa::Marker<1>)
+DECLARE_SOA_TABLE(StoredRCollClasses, "AOD1", "RCOLLCLASS",
+                  rcol::EvClass,
+                  soa::Marker<2>)
+
 DECLARE_SOA_TABLE(RCents, "AOD", "RCENTS",
                   CCcols,
                   soa::Marker<1>)
@@ -20,6 +20,8 @@
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/AnalysisTask.h"
 
+#include "Common/Core/ReverseIndex.h"
+
 #include "Index.h"
 
 using namespace o2;
@@ -33,6 +35,7 @@ struct ParticlesToTracks {
   Produces<aod::ParticlesToMftTracks> p2tmft;
 
   std::vector<int> trackIds;
+  ReverseIndex part2track;
 
   void init(InitContext&)
   {
@@ -40,7 +43,7 @@ struct ParticlesToTracks {
 
   void process(aod::McParticles const& particles)
   {
-    if (doprocessIndexingCentral || doprocessIndexingCentralFast) {
+    if (doprocessIndexingCentral) {
       p2t.reserve(particles.size());
     }
     if (doprocessIndexingFwd) {
@@ -50,15 +53,9 @@ struct ParticlesToTracks {
 
   void processIndexingCentralFast(aod::McParticles const& mcParticles, LabeledTracks const& tracks)
   {
-    // faster version, but will use more memory due to pre-allocation
-    std::vector<std::vector<int>> part2track(mcParticles.size());
-    for (auto& track : tracks) {
-      if (track.has_mcParticle())
-        part2track[track.mcParticleId()].push_back(track.globalIndex());
-    }
-    for (auto& mcParticle : mcParticles) {
-      p2t(part2track[mcParticle.globalIndex()]);
-    }
+    // faster version, the whole reverse index is built at once from the track labels
+    part2track.build(mcParticles.size(), tracks, [](auto const& track) { return track.has_mcParticle() ? track.mcParticleId() : -1; });
+    part2track.produce(p2t);
   }
   PROCESS_SWITCH(ParticlesToTracks, processIndexingCentralFast, "Create reverse index from particles to tracks: more memory use but potentially faster", false);
 
@@ -83,6 +80,14 @@ struct ParticlesToTracks {
   }
 
   PROCESS_SWITCH(ParticlesToTracks, processIndexingFwd, "Create reverse index from particles to tracks", false);
+
+  void processIndexingFwdFast(aod::McParticles const& mcParticles, LabeledMFTTracks const& tracks)
+  {
+    part2track.build(mcParticles.size(), tracks, [](auto const& track) { return track.has_mcParticle() ? track.mcParticleId() : -1; });
+    part2track.produce(p2tmft);
+  }
+
+  PROCESS_SWITCH(ParticlesToTracks, processIndexingFwdFast, "Create reverse index from particles to MFT tracks: more memory use but potentially faster", false);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
@@ -40,12 +40,14 @@ struct Reducer {
   Produces<aod::StoredRMCColLabels> rmcl;
   Produces<aod::StoredRCollisions> rc;
   Produces<aod::StoredRHepMCinfos> rhepmci;
+  Produces<aod::StoredRCollClasses> rcc;
 
   Configurable<float> reductionFactor{"reduction-factor", 1.e-4, "Reduction factor"};
   Configurable<LabeledArray<float>> params{"params", {defparams[0], 1, 7, {"pars"}, {"0bin", "l", "a", "n1", "p1", "n2", "p2"}}, "Multiplicity distribution parameterization"};
 
   Configurable<std::vector<double>> etaBins{"eta", {-1.5, -0.5, 0.5, 1.5}, "eta binning"};
   Configurable<std::vector<double>> phiBins{"phi", {0., PI / 2., PI, 3. * PI / 2., 2. * PI}, "phi binning"};
+  Configurable<std::vector<double>> classBins{"classes", {0., 5., 10., 20., 30., 40., 50., 70., 100., 1000.}, "event classes in N_{PV}(|eta| < 1) stored with the reduced collisions"};
 
   Preslice<aod::Collisions> cperBC = aod::collision::bcId;
   Preslice<aod::McCollisions> mccperBC = aod::mccollision::bcId;
@@ -56,12 +58,12 @@ struct Reducer {
   std::mt19937 randomgen;
   std::uniform_real_distribution<float> dist;
 
-  std::vector<int64_t> usedMCCs;
-  std::vector<int64_t> usedLabels;
+  std::vector<int64_t> reducedMCCs; // reduced index of the kept MC collisions of the current BC, by MC collision index
   std::vector<float> weights;
 
   std::vector<double> etabins;
   std::vector<double> phibins;
+  std::vector<double> classbins;
 
   std::vector<int> binned;
 
@@ -88,6 +90,7 @@ struct Reducer {
          params->get((int)0, 3), params->get((int)0, 4), params->get((int)0, 5), params->get((int)0, 6));
     etabins = static_cast<std::vector<double>>(etaBins);
     phibins = static_cast<std::vector<double>>(phiBins);
+    classbins = static_cast<std::vector<double>>(classBins);
     binned.resize((etabins.size() - 1) * (phibins.size() - 1));
   }
 
@@ -105,6 +108,14 @@ struct Reducer {
     return std::distance(etabins.begin(), e) - 1 /* eta pos */ + (etabins.size() - 1) /* stride */ * (std::distance(phibins.begin(), p) - 1) /* phi pos */;
   }
 
+  int8_t findClass(float mult)
+  {
+    if (classbins.size() < 2 || mult < classbins.front() || !(mult < classbins.back())) {
+      return -1;
+    }
+    return std::distance(classbins.begin(), std::upper_bound(classbins.begin(), classbins.end(), mult)) - 1;
+  }
+
   template <typename MCC>
   void checkSampling(MCC const& mccollisions)
   {
@@ -144,43 +155,55 @@ struct Reducer {
                                                   ncheckbit(aod::track::trackCutFlag, trackSelectionTPC), true);
   expressions::Filter fTrackSelectionDCA = ncheckbit(aod::track::trackCutFlag, trackSelectionDCA);
 
-  void processFull(BCs::iterator const& bc,
+  void processFull(BCs const& bcs,
                    MCCollisions const& mccollisions,
                    Collisions const& collisions,
                    Tracks const& tracks)
   {
-    processGeneric(bc, mccollisions, collisions, tracks);
+    processGeneric(bcs, mccollisions, collisions, tracks);
   }
 
   PROCESS_SWITCH(Reducer, processFull, "Full process with HepMC", false);
 
-  void processLite(BCs::iterator const& bc,
+  void processLite(BCs const& bcs,
                    MCCollisionsNoHepMC const& mccollisions,
                    Collisions const& collisions,
                    Tracks const& tracks)
   {
-    processGeneric(bc, mccollisions, collisions, tracks);
+    processGeneric(bcs, mccollisions, collisions, tracks);
   }
 
   PROCESS_SWITCH(Reducer, processLite, "Process without HepMC", true);
 
-  template <typename TBCI, typename TMCC, typename TC, typename TT>
-  void processGeneric(TBCI const& bc,
+  // the whole dataframe is reduced at once, the MC and reconstructed collisions of each BC are found by slicing
+  template <typename TBCs, typename TMCC, typename TC, typename TT>
+  void processGeneric(TBCs const& bcs,
                       TMCC const& mccollisions,
                       TC const& collisions,
                       TT const& tracks)
   {
-    usedMCCs.clear();
-    usedLabels.clear();
-    // if BC has no collisions, skip it
-    if (mccollisions.size() == 0) {
-      return;
-    }
-    checkSampling(mccollisions);
-    // if all events are discarded, skip the BC
-    if (std::all_of(weights.begin(), weights.end(), [](auto const& x) { return x < 0; })) {
-      return;
+    reducedMCCs.assign(mccollisions.size(), -1);
+    for (auto& bc : bcs) {
+      auto bcmccollisions = mccollisions.sliceBy(mccperBC, bc.globalIndex());
+      // if BC has no collisions, skip it
+      if (bcmccollisions.size() == 0) {
+        continue;
+      }
+      checkSampling(bcmccollisions);
+      // if all events are discarded, skip the BC
+      if (std::all_of(weights.begin(), weights.end(), [](auto const& x) { return x < 0; })) {
+        continue;
+      }
+      reduceBC(bc, bcmccollisions, collisions.sliceBy(cperBC, bc.globalIndex()), tracks);
     }
+  }
+
+  template <typename TBCI, typename TMCC, typename TC, typename TT>
+  void reduceBC(TBCI const& bc,
+                TMCC const& mccollisions,
+                TC const& collisions,
+                TT const& tracks)
+  {
     // keep the BC
     rbcs(bc.runNumber());
     auto bcId = rbcs.lastIndex();
@@ -197,22 +220,18 @@ struct Reducer {
         rhepmci(rmcc.lastIndex(), mcc.xsectGen(), mcc.ptHard(), mcc.nMPI(), mcc.processId(), mcc.id1(), mcc.id2(), mcc.pdfId1(), mcc.pdfId2(), mcc.x1(), mcc.x2(), mcc.scalePdf(), mcc.pdf1(), mcc.pdf2());
       }
       // remember used events so that the index relation can be preserved
-      usedMCCs.push_back(mcc.globalIndex());
-      usedLabels.push_back(rmcc.lastIndex());
+      reducedMCCs[mcc.globalIndex()] = rmcc.lastIndex();
       ++i;
     }
-    i = 0;
     // check Reco events
     for (auto& c : collisions) {
       // discard fake events
       if (!c.has_mcCollision()) {
-        ++i;
         continue;
       }
-      // discard events for which MC event was discarded
-      auto pos = std::find(usedMCCs.begin(), usedMCCs.end(), c.mcCollisionId());
-      if (pos == usedMCCs.end()) {
-        ++i;
+      // discard events for which MC event was discarded or belongs to another BC
+      auto label = reducedMCCs[c.mcCollisionId()];
+      if (label < 0) {
         continue;
       }
       std::fill(binned.begin(), binned.end(), 0);
@@ -224,8 +243,12 @@ struct Reducer {
         }
       }
       rc(bcId, c.posX(), c.posY(), c.posZ(), c.collisionTimeRes(), c.multFT0A(), c.multFT0C(), c.multFDDA(), c.multFDDC(), c.multZNA(), c.multZNC(), c.multNTracksPV(), c.multNTracksPVeta1(), c.multNTracksPVetaHalf(), binned);
-      rmcl(usedLabels[std::distance(usedMCCs.begin(), pos)]);
-      ++i;
+      rmcl(label);
+      rcc(findClass(c.multNTracksPVeta1()));
+    }
+    // the MC collisions of this BC are not available to the reconstructed collisions of the other BCs
+    for (auto& mcc : mccollisions) {
+      reducedMCCs[mcc.globalIndex()] = -1;
     }
   }
 };
@@ -23,19 +23,45 @@ struct ReducerPostprocess {
   Produces<aod::RFeatMins> features;
   std::vector<int> spatialMap;
 
+  Configurable<int> minClass{"minClass", -1, "lowest event class to process (-1 -- including the collisions outside of the class binning)"};
+  Configurable<int> maxClass{"maxClass", 127, "highest event class to process"};
+
   using MC = aod::RMCCollisions;
   using C = soa::Join<aod::RCollisions, aod::RMCColLabels>;
-  void process(MC const&, C const& cols)
+  using CC = soa::Filtered<soa::Join<aod::RCollisions, aod::RMCColLabels, aod::RCollClasses>>;
+
+  // the class selection is applied by the framework on the event class column, the other collisions are not iterated
+  Filter classFilter = (aod::rcol::evClass >= minClass) && (aod::rcol::evClass <= maxClass);
+
+  template <typename TC>
+  void fillFeatures(TC const& cols)
   {
+    if (cols.size() == 0) {
+      return;
+    }
     spatialMap.resize(cols.begin().mapetaphi().size());
     for (auto& col : cols) {
-      auto mccol = col.rmccollision_as<MC>();
+      auto mccol = col.template rmccollision_as<MC>();
       for (auto i = 0U; i < col.mapetaphi().size(); ++i) {
         spatialMap[i] = col.mapetaphi()[i];
       }
       features(mccol.multMCNParticlesEta10(), col.multNTracksPVeta1(), col.posX(), col.posY(), col.posZ(), col.collisionTimeRes(), col.multFT0A(), col.multFT0C(), spatialMap);
     }
   }
+
+  void processAll(MC const&, C const& cols)
+  {
+    fillFeatures(cols);
+  }
+
+  PROCESS_SWITCH(ReducerPostprocess, processAll, "Process all reduced collisions", true);
+
+  void processClasses(MC const&, CC const& cols)
+  {
+    fillFeatures(cols);
+  }
+
+  PROCESS_SWITCH(ReducerPostprocess, processClasses, "Process the reduced collisions of the selected event classes (needs RCOLLCLASS)", false);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
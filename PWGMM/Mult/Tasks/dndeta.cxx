@@ -28,6 +28,7 @@
 #include "Functions.h"
 #include "Selections.h"
 #include "Histograms.h"
+#include "DenseCounter.h"
 
 using namespace o2;
 using namespace o2::aod::track;
@@ -63,6 +64,9 @@ struct MultiplicityCounter {
   Configurable<bool> checkFT0PVcoincidence{"checkFT0PVcoincidence", true, "Check coincidence between FT0 and PV"};
   Configurable<bool> rejectITSonly{"rejectITSonly", false, "Reject ITS-only vertex"};
 
+  Configurable<bool> denseCounting{"denseCounting", false, "Count the tracks of the counting processes in dense arrays, added to the histograms after each dataframe"};
+  Configurable<int> denseMaxCells{"denseMaxCells", 1 << 22, "Maximal number of cells of a dense histogram (filled directly if larger)"};
+
   template <typename C>
   inline bool isCollisionSelected(C const& collision)
   {
@@ -104,6 +108,46 @@ struct MultiplicityCounter {
     false,
     true};
 
+  // per-track histograms of the counting processes which can be accumulated in dense arrays
+  enum DenseHistos : int {
+    kDenseEtaZvtx = 0,
+    kDensePhiEta,
+    kDensePtEta,
+    kDenseDCAXYPt,
+    kDenseDCAZPt,
+    kDenseEtaZvtxGt0,
+    kDenseEtaZvtxPVgt0,
+    kNDenseHistos
+  };
+  std::array<DenseCounter, kNDenseHistos> denseInclusive;
+  std::array<DenseCounter, kNDenseHistos> denseBinned;
+
+  template <typename R, typename H, typename... Ts>
+  inline void fillTrack(R& registry, std::array<DenseCounter, kNDenseHistos>& dense, H const& name, int idx, Ts... xs)
+  {
+    if (dense[idx].isActive()) {
+      dense[idx].fill(xs...);
+    } else {
+      registry.fill(name, xs...);
+    }
+  }
+
+  template <typename T>
+  void setupDense(DenseCounter& dense, T const* h)
+  {
+    if (!dense.init(h, denseMaxCells)) {
+      LOGP(info, "{} has too many cells for dense counting, filled directly", h->GetName());
+    }
+  }
+
+  template <typename T, typename R, typename H>
+  void flushDense(DenseCounter& dense, R& registry, H const& name)
+  {
+    if (dense.isActive()) {
+      dense.flush(registry.template get<T>(name).get());
+    }
+  }
+
   std::vector<int> usedTracksIds;
   std::vector<int> usedTracksIdsDF;
   std::vector<int> usedTracksIdsDFMC;
@@ -193,6 +237,30 @@ struct MultiplicityCounter {
       }
     }
 
+    if (denseCounting) {
+      if (!doprocessFlushDenseCounting) {
+        LOGP(fatal, "Dense counting needs processFlushDenseCounting to add the counts to the histograms");
+      }
+      if (doprocessCountingAmbiguous || doprocessCounting) {
+        setupDense(denseInclusive[kDenseEtaZvtx], inclusiveRegistry.get<TH2>(HIST(EtaZvtx)).get());
+        setupDense(denseInclusive[kDensePhiEta], inclusiveRegistry.get<TH2>(HIST(PhiEta)).get());
+        setupDense(denseInclusive[kDensePtEta], inclusiveRegistry.get<TH2>(HIST(PtEta)).get());
+        setupDense(denseInclusive[kDenseDCAXYPt], inclusiveRegistry.get<TH2>(HIST(DCAXYPt)).get());
+        setupDense(denseInclusive[kDenseDCAZPt], inclusiveRegistry.get<TH2>(HIST(DCAZPt)).get());
+        setupDense(denseInclusive[kDenseEtaZvtxGt0], inclusiveRegistry.get<TH2>(HIST(EtaZvtx_gt0)).get());
+        setupDense(denseInclusive[kDenseEtaZvtxPVgt0], inclusiveRegistry.get<TH2>(HIST(EtaZvtx_PVgt0)).get());
+      }
+      if (doprocessCountingAmbiguousCentralityFT0C || doprocessCountingAmbiguousCentralityFT0M || doprocessCountingCentralityFT0C || doprocessCountingCentralityFT0M) {
+        setupDense(denseBinned[kDenseEtaZvtx], binnedRegistry.get<THnSparse>(HIST(EtaZvtx)).get());
+        setupDense(denseBinned[kDensePhiEta], binnedRegistry.get<THnSparse>(HIST(PhiEta)).get());
+        setupDense(denseBinned[kDensePtEta], binnedRegistry.get<THnSparse>(HIST(PtEta)).get());
+        setupDense(denseBinned[kDenseDCAXYPt], binnedRegistry.get<THnSparse>(HIST(DCAXYPt)).get());
+        setupDense(denseBinned[kDenseDCAZPt], binnedRegistry.get<THnSparse>(HIST(DCAZPt)).get());
+        setupDense(denseBinned[kDenseEtaZvtxGt0], binnedRegistry.get<THnSparse>(HIST(EtaZvtx_gt0)).get());
+        setupDense(denseBinned[kDenseEtaZvtxPVgt0], binnedRegistry.get<THnSparse>(HIST(EtaZvtx_PVgt0)).get());
+      }
+    }
+
     if (doprocessGenAmbiguous || doprocessGen || doprocessGenAmbiguousEx || doprocessGenEx) {
       std::string effLabels{" ; N_{gen}; Z_{vtx} (cm)"};
       std::vector<AxisSpec> effAxes{MultAxis, ZAxis};
@@ -452,17 +520,17 @@ struct MultiplicityCounter {
       }
       if constexpr (fillHistos) {
         if constexpr (hasRecoCent<C>()) {
-          binnedRegistry.fill(HIST(EtaZvtx), track.eta(), z, c);
-          binnedRegistry.fill(HIST(PhiEta), track.phi(), track.eta(), c);
-          binnedRegistry.fill(HIST(PtEta), track.pt(), track.eta(), c);
-          binnedRegistry.fill(HIST(DCAXYPt), track.pt(), track.dcaXY(), c);
-          binnedRegistry.fill(HIST(DCAZPt), track.pt(), track.dcaZ(), c);
+          fillTrack(binnedRegistry, denseBinned, HIST(EtaZvtx), kDenseEtaZvtx, track.eta(), z, c);
+          fillTrack(binnedRegistry, denseBinned, HIST(PhiEta), kDensePhiEta, track.phi(), track.eta(), c);
+          fillTrack(binnedRegistry, denseBinned, HIST(PtEta), kDensePtEta, track.pt(), track.eta(), c);
+          fillTrack(binnedRegistry, denseBinned, HIST(DCAXYPt), kDenseDCAXYPt, track.pt(), track.dcaXY(), c);
+          fillTrack(binnedRegistry, denseBinned, HIST(DCAZPt), kDenseDCAZPt, track.pt(), track.dcaZ(), c);
         } else {
-          inclusiveRegistry.fill(HIST(EtaZvtx), track.eta(), z);
-          inclusiveRegistry.fill(HIST(PhiEta), track.phi(), track.eta());
-          inclusiveRegistry.fill(HIST(PtEta), track.pt(), track.eta());
-          inclusiveRegistry.fill(HIST(DCAXYPt), track.pt(), track.dcaXY());
-          inclusiveRegistry.fill(HIST(DCAZPt), track.pt(), track.dcaZ());
+          fillTrack(inclusiveRegistry, denseInclusive, HIST(EtaZvtx), kDenseEtaZvtx, track.eta(), z);
+          fillTrack(inclusiveRegistry, denseInclusive, HIST(PhiEta), kDensePhiEta, track.phi(), track.eta());
+          fillTrack(inclusiveRegistry, denseInclusive, HIST(PtEta), kDensePtEta, track.pt(), track.eta());
+          fillTrack(inclusiveRegistry, denseInclusive, HIST(DCAXYPt), kDenseDCAXYPt, track.pt(), track.dcaXY());
+          fillTrack(inclusiveRegistry, denseInclusive, HIST(DCAZPt), kDenseDCAZPt, track.pt(), track.dcaZ());
         }
       }
     }
@@ -509,10 +577,10 @@ struct MultiplicityCounter {
           }
           for (auto& track : tracks) {
             if (Ntrks > 0) {
-              binnedRegistry.fill(HIST(EtaZvtx_gt0), track.eta(), z, c);
+              fillTrack(binnedRegistry, denseBinned, HIST(EtaZvtx_gt0), kDenseEtaZvtxGt0, track.eta(), z, c);
             }
             if (INELgt0PV) {
-              binnedRegistry.fill(HIST(EtaZvtx_PVgt0), track.eta(), z, c);
+              fillTrack(binnedRegistry, denseBinned, HIST(EtaZvtx_PVgt0), kDenseEtaZvtxPVgt0, track.eta(), z, c);
             }
           }
         }
@@ -528,10 +596,10 @@ struct MultiplicityCounter {
           }
           for (auto& track : tracks) {
             if (Ntrks > 0) {
-              inclusiveRegistry.fill(HIST(EtaZvtx_gt0), track.eta(), z);
+              fillTrack(inclusiveRegistry, denseInclusive, HIST(EtaZvtx_gt0), kDenseEtaZvtxGt0, track.eta(), z);
             }
             if (INELgt0PV) {
-              inclusiveRegistry.fill(HIST(EtaZvtx_PVgt0), track.eta(), z);
+              fillTrack(inclusiveRegistry, denseInclusive, HIST(EtaZvtx_PVgt0), kDenseEtaZvtxPVgt0, track.eta(), z);
             }
           }
         }
@@ -571,17 +639,17 @@ struct MultiplicityCounter {
       }
       if (fillHistos) {
         if constexpr (hasRecoCent<C>()) {
-          binnedRegistry.fill(HIST(EtaZvtx), otrack.eta(), z, c);
-          binnedRegistry.fill(HIST(PhiEta), otrack.phi(), otrack.eta(), c);
-          binnedRegistry.fill(HIST(PtEta), otrack.pt(), otrack.eta(), c);
-          binnedRegistry.fill(HIST(DCAXYPt), otrack.pt(), track.bestDCAXY(), c);
-          binnedRegistry.fill(HIST(DCAZPt), otrack.pt(), track.bestDCAZ(), c);
+          fillTrack(binnedRegistry, denseBinned, HIST(EtaZvtx), kDenseEtaZvtx, otrack.eta(), z, c);
+          fillTrack(binnedRegistry, denseBinned, HIST(PhiEta), kDensePhiEta, otrack.phi(), otrack.eta(), c);
+          fillTrack(binnedRegistry, denseBinned, HIST(PtEta), kDensePtEta, otrack.pt(), otrack.eta(), c);
+          fillTrack(binnedRegistry, denseBinned, HIST(DCAXYPt), kDenseDCAXYPt, otrack.pt(), track.bestDCAXY(), c);
+          fillTrack(binnedRegistry, denseBinned, HIST(DCAZPt), kDenseDCAZPt, otrack.pt(), track.bestDCAZ(), c);
         } else {
-          inclusiveRegistry.fill(HIST(EtaZvtx), otrack.eta(), z);
-          inclusiveRegistry.fill(HIST(PhiEta), otrack.phi(), otrack.eta());
-          inclusiveRegistry.fill(HIST(PtEta), otrack.pt(), otrack.eta());
-          inclusiveRegistry.fill(HIST(DCAXYPt), otrack.pt(), track.bestDCAXY());
-          inclusiveRegistry.fill(HIST(DCAZPt), otrack.pt(), track.bestDCAZ());
+          fillTrack(inclusiveRegistry, denseInclusive, HIST(EtaZvtx), kDenseEtaZvtx, otrack.eta(), z);
+          fillTrack(inclusiveRegistry, denseInclusive, HIST(PhiEta), kDensePhiEta, otrack.phi(), otrack.eta());
+          fillTrack(inclusiveRegistry, denseInclusive, HIST(PtEta), kDensePtEta, otrack.pt(), otrack.eta());
+          fillTrack(inclusiveRegistry, denseInclusive, HIST(DCAXYPt), kDenseDCAXYPt, otrack.pt(), track.bestDCAXY());
+          fillTrack(inclusiveRegistry, denseInclusive, HIST(DCAZPt), kDenseDCAZPt, otrack.pt(), track.bestDCAZ());
         }
       }
       if (otrack.has_collision() && otrack.collisionId() != track.bestCollisionId()) {
@@ -630,17 +698,17 @@ struct MultiplicityCounter {
       }
       if constexpr (fillHistos) {
         if constexpr (hasRecoCent<C>()) {
-          binnedRegistry.fill(HIST(EtaZvtx), track.eta(), z, c);
-          binnedRegistry.fill(HIST(PhiEta), track.phi(), track.eta(), c);
-          binnedRegistry.fill(HIST(PtEta), track.pt(), track.eta(), c);
-          binnedRegistry.fill(HIST(DCAXYPt), track.pt(), track.dcaXY(), c);
-          binnedRegistry.fill(HIST(DCAZPt), track.pt(), track.dcaZ(), c);
+          fillTrack(binnedRegistry, denseBinned, HIST(EtaZvtx), kDenseEtaZvtx, track.eta(), z, c);
+          fillTrack(binnedRegistry, denseBinned, HIST(PhiEta), kDensePhiEta, track.phi(), track.eta(), c);
+          fillTrack(binnedRegistry, denseBinned, HIST(PtEta), kDensePtEta, track.pt(), track.eta(), c);
+          fillTrack(binnedRegistry, denseBinned, HIST(DCAXYPt), kDenseDCAXYPt, track.pt(), track.dcaXY(), c);
+          fillTrack(binnedRegistry, denseBinned, HIST(DCAZPt), kDenseDCAZPt, track.pt(), track.dcaZ(), c);
         } else {
-          inclusiveRegistry.fill(HIST(EtaZvtx), track.eta(), z);
-          inclusiveRegistry.fill(HIST(PhiEta), track.phi(), track.eta());
-          inclusiveRegistry.fill(HIST(PtEta), track.pt(), track.eta());
-          inclusiveRegistry.fill(HIST(DCAXYPt), track.pt(), track.dcaXY());
-          inclusiveRegistry.fill(HIST(DCAZPt), track.pt(), track.dcaZ());
+          fillTrack(inclusiveRegistry, denseInclusive, HIST(EtaZvtx), kDenseEtaZvtx, track.eta(), z);
+          fillTrack(inclusiveRegistry, denseInclusive, HIST(PhiEta), kDensePhiEta, track.phi(), track.eta());
+          fillTrack(inclusiveRegistry, denseInclusive, HIST(PtEta), kDensePtEta, track.pt(), track.eta());
+          fillTrack(inclusiveRegistry, denseInclusive, HIST(DCAXYPt), kDenseDCAXYPt, track.pt(), track.dcaXY());
+          fillTrack(inclusiveRegistry, denseInclusive, HIST(DCAZPt), kDenseDCAZPt, track.pt(), track.dcaZ());
         }
       }
     }
@@ -688,10 +756,10 @@ struct MultiplicityCounter {
           }
           for (auto& track : atracks) {
             if (Ntrks > 0) {
-              binnedRegistry.fill(HIST(EtaZvtx_gt0), track.track_as<FiTracks>().eta(), z, c);
+              fillTrack(binnedRegistry, denseBinned, HIST(EtaZvtx_gt0), kDenseEtaZvtxGt0, track.track_as<FiTracks>().eta(), z, c);
             }
             if (INELgt0PV) {
-              binnedRegistry.fill(HIST(EtaZvtx_PVgt0), track.track_as<FiTracks>().eta(), z, c);
+              fillTrack(binnedRegistry, denseBinned, HIST(EtaZvtx_PVgt0), kDenseEtaZvtxPVgt0, track.track_as<FiTracks>().eta(), z, c);
             }
           }
           for (auto& track : tracks) {
@@ -702,10 +770,10 @@ struct MultiplicityCounter {
               continue;
             }
             if (Ntrks > 0) {
-              binnedRegistry.fill(HIST(EtaZvtx_gt0), track.eta(), z, c);
+              fillTrack(binnedRegistry, denseBinned, HIST(EtaZvtx_gt0), kDenseEtaZvtxGt0, track.eta(), z, c);
             }
             if (INELgt0PV) {
-              binnedRegistry.fill(HIST(EtaZvtx_PVgt0), track.eta(), z, c);
+              fillTrack(binnedRegistry, denseBinned, HIST(EtaZvtx_PVgt0), kDenseEtaZvtxPVgt0, track.eta(), z, c);
             }
           }
         }
@@ -721,10 +789,10 @@ struct MultiplicityCounter {
           }
           for (auto& track : atracks) {
             if (Ntrks > 0) {
-              inclusiveRegistry.fill(HIST(EtaZvtx_gt0), track.track_as<FiTracks>().eta(), z);
+              fillTrack(inclusiveRegistry, denseInclusive, HIST(EtaZvtx_gt0), kDenseEtaZvtxGt0, track.track_as<FiTracks>().eta(), z);
             }
             if (INELgt0PV) {
-              inclusiveRegistry.fill(HIST(EtaZvtx_PVgt0), track.track_as<FiTracks>().eta(), z);
+              fillTrack(inclusiveRegistry, denseInclusive, HIST(EtaZvtx_PVgt0), kDenseEtaZvtxPVgt0, track.track_as<FiTracks>().eta(), z);
             }
           }
           for (auto& track : tracks) {
@@ -735,10 +803,10 @@ struct MultiplicityCounter {
               continue;
             }
             if (Ntrks > 0) {
-              inclusiveRegistry.fill(HIST(EtaZvtx_gt0), track.eta(), z);
+              fillTrack(inclusiveRegistry, denseInclusive, HIST(EtaZvtx_gt0), kDenseEtaZvtxGt0, track.eta(), z);
             }
             if (INELgt0PV) {
-              inclusiveRegistry.fill(HIST(EtaZvtx_PVgt0), track.eta(), z);
+              fillTrack(inclusiveRegistry, denseInclusive, HIST(EtaZvtx_PVgt0), kDenseEtaZvtxPVgt0, track.eta(), z);
             }
           }
         }
@@ -2064,6 +2132,30 @@ struct MultiplicityCounter {
   }
 
   PROCESS_SWITCH(MultiplicityCounter, processGenFT0Mhi, "Process generator-level info (FT0M centrality, HI) w/o ambiguous", false);
+
+  // add the dense counts to the histograms at the end of each dataframe (declared last to be executed after the other processes)
+  void processFlushDenseCounting(aod::Collisions const&)
+  {
+    if (!denseCounting) {
+      return;
+    }
+    flushDense<TH2>(denseInclusive[kDenseEtaZvtx], inclusiveRegistry, HIST(EtaZvtx));
+    flushDense<TH2>(denseInclusive[kDensePhiEta], inclusiveRegistry, HIST(PhiEta));
+    flushDense<TH2>(denseInclusive[kDensePtEta], inclusiveRegistry, HIST(PtEta));
+    flushDense<TH2>(denseInclusive[kDenseDCAXYPt], inclusiveRegistry, HIST(DCAXYPt));
+    flushDense<TH2>(denseInclusive[kDenseDCAZPt], inclusiveRegistry, HIST(DCAZPt));
+    flushDense<TH2>(denseInclusive[kDenseEtaZvtxGt0], inclusiveRegistry, HIST(EtaZvtx_gt0));
+    flushDense<TH2>(denseInclusive[kDenseEtaZvtxPVgt0], inclusiveRegistry, HIST(EtaZvtx_PVgt0));
+    flushDense<THnSparse>(denseBinned[kDenseEtaZvtx], binnedRegistry, HIST(EtaZvtx));
+    flushDense<THnSparse>(denseBinned[kDensePhiEta], binnedRegistry, HIST(PhiEta));
+    flushDense<THnSparse>(denseBinned[kDensePtEta], binnedRegistry, HIST(PtEta));
+    flushDense<THnSparse>(denseBinned[kDenseDCAXYPt], binnedRegistry, HIST(DCAXYPt));
+    flushDense<THnSparse>(denseBinned[kDenseDCAZPt], binnedRegistry, HIST(DCAZPt));
+    flushDense<THnSparse>(denseBinned[kDenseEtaZvtxGt0], binnedRegistry, HIST(EtaZvtx_gt0));
+    flushDense<THnSparse>(denseBinned[kDenseEtaZvtxPVgt0], binnedRegistry, HIST(EtaZvtx_PVgt0));
+  }
+
+  PROCESS_SWITCH(MultiplicityCounter, processFlushDenseCounting, "Add the dense track counts to the histograms after each dataframe", true);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
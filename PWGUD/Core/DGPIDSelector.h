@@ -13,6 +13,7 @@
 #define PWGUD_CORE_DGPIDSELECTOR_H_
 
 #include <gandiva/projector.h>
+#include <algorithm>
 #include <vector>
 #include <TVector3.h>
 #include "TDatabasePDG.h"
@@ -404,33 +405,93 @@ struct DGPIDSelector {
     mUnlikeIVMs.clear();
     mLikeIVMs.clear();
 
-    // create combinations including permutations
-    auto combs = combinations(tracks.size());
-
-    // loop over unique combinations
-    for (auto comb : combs) {
-      // are tracks compatible with PID requirements?
-      bool isGoodTracks = true;
-      auto cnt = -1;
-      for (auto ind : comb) {
-        cnt++;
-        if (!isGoodTrack(tracks.begin() + ind, cnt)) {
-          isGoodTracks = false;
-          break;
-        }
+    const int nCombine = mAnaPars.nCombine();
+    const int nTracks = tracks.size();
+    if (nCombine <= 0 || nTracks < nCombine) {
+      return std::vector<int>{0, 0};
+    }
+
+    // check once per track whether it is compatible with the PID requirements of each particle of the combination
+    // tracks compatible with none of them can not be part of any combination
+    mIsGoodTrack.assign(nTracks * nCombine, false);
+    mCharges.resize(nTracks);
+    mPool.clear();
+    for (auto ind = 0; ind < nTracks; ind++) {
+      auto track = tracks.begin() + ind;
+      mCharges[ind] = track.sign();
+      bool isGoodForAny = false;
+      for (auto cnt = 0; cnt < nCombine; cnt++) {
+        mIsGoodTrack[ind * nCombine + cnt] = isGoodTrack(track, cnt);
+        isGoodForAny = isGoodForAny || mIsGoodTrack[ind * nCombine + cnt];
       }
+      if (isGoodForAny) {
+        mPool.push_back(ind);
+      }
+    }
+    const int nPool = mPool.size();
+    if (nPool < nCombine) {
+      return std::vector<int>{0, 0};
+    }
 
-      // is combination compatible with netCharge requirements?
-      if (isGoodTracks) {
-        DGParticle IVM(fPDG, mAnaPars, tracks, comb);
-        // unlike sign
-        if (isGoodCombination(comb, tracks, mAnaPars.unlikeCharges())) {
-          mUnlikeIVMs.push_back(IVM);
-        }
-        if (isGoodCombination(comb, tracks, mAnaPars.likeCharges())) {
-          mLikeIVMs.push_back(IVM);
+    const auto uniquePerms = mAnaPars.uniquePermutations();
+    const int numUniquePerms = uniquePerms.size() / nCombine;
+    const auto unlikeCharges = mAnaPars.unlikeCharges();
+    const auto likeCharges = mAnaPars.likeCharges();
+
+    // loop over the selections of nCombine tracks of the pool, in increasing order, without storing them
+    // the net charge is checked before the permutations of the selection, which have the same net charge
+    std::vector<int> sel(nCombine);
+    for (auto ii = 0; ii < nCombine; ii++) {
+      sel[ii] = ii;
+    }
+    std::vector<int> cope(nCombine, 0);
+    while (true) {
+      int netCharge = 0;
+      for (auto ii = 0; ii < nCombine; ii++) {
+        netCharge += mCharges[mPool[sel[ii]]];
+      }
+      const bool isUnlike = std::find(unlikeCharges.begin(), unlikeCharges.end(), netCharge) != unlikeCharges.end();
+      const bool isLike = std::find(likeCharges.begin(), likeCharges.end(), netCharge) != likeCharges.end();
+
+      if (isUnlike || isLike) {
+        // assign the tracks of the selection to the particles according to the unique permutations
+        for (auto ii = 0; ii < numUniquePerms; ii++) {
+          for (auto jj = 0; jj < nCombine; jj++) {
+            cope[uniquePerms[ii * nCombine + jj]] = mPool[sel[jj]];
+          }
+
+          // are tracks compatible with PID requirements?
+          bool isGoodTracks = true;
+          for (auto cnt = 0; cnt < nCombine; cnt++) {
+            if (!mIsGoodTrack[cope[cnt] * nCombine + cnt]) {
+              isGoodTracks = false;
+              break;
+            }
+          }
+          if (isGoodTracks) {
+            DGParticle IVM(fPDG, mAnaPars, tracks, cope);
+            if (isUnlike) {
+              mUnlikeIVMs.push_back(IVM);
+            }
+            if (isLike) {
+              mLikeIVMs.push_back(IVM);
+            }
+          }
         }
       }
+
+      // next selection
+      auto last = nCombine - 1;
+      while (last >= 0 && sel[last] == nPool - nCombine + last) {
+        last--;
+      }
+      if (last < 0) {
+        break;
+      }
+      sel[last]++;
+      for (auto ii = last + 1; ii < nCombine; ii++) {
+        sel[ii] = sel[ii - 1] + 1;
+      }
     }
 
     return std::vector<int>{static_cast<int>(mUnlikeIVMs.size()), static_cast<int>(mLikeIVMs.size())};
@@ -491,11 +552,10 @@ struct DGPIDSelector {
   // particle properties
   TDatabasePDG* fPDG;
 
-  // helper functions for computeIVMs
-  void combinations(int n0, std::vector<int>& pool, int np, std::vector<int>& inds, int n,
-                    std::vector<std::vector<int>>& combs);
-  int combinations(int n0, int np, std::vector<std::vector<int>>& combs);
-  std::vector<std::vector<int>> combinations(int nPool);
+  // work arrays of computeIVMs, reused for all events
+  std::vector<bool> mIsGoodTrack; // PID compatibility of track i with the particle j of a combination, at i * nCombine + j
+  std::vector<int> mCharges;      // charges of the tracks
+  std::vector<int> mPool;         // tracks compatible with at least one particle of a combination
 
   // ClassDefNV(DGPIDSelector, 1);
 };
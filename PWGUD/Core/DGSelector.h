@@ -19,6 +19,7 @@
 #include "Framework/Logger.h"
 #include "Framework/AnalysisTask.h"
 #include "PWGUD/Core/UDHelpers.h"
+#include "PWGUD/Core/FITWindowSums.h"
 #include "PWGUD/Core/DGCutparHolder.h"
 
 // -----------------------------------------------------------------------------
@@ -31,6 +32,10 @@ class DGSelector
   DGSelector() { fPDG = TDatabasePDG::Instance(); }
   ~DGSelector() { delete fPDG; }
 
+  // use the prefix sums of the FIT flags for the veto over the compatible BCs
+  // instead of testing each BC, fitSums must be built for the BC table of the processed timeframe
+  void setFITWindowSums(const udhelpers::FITWindowSums* fitSums) { fFITSums = fitSums; }
+
   template <typename CC, typename BCs, typename TCs, typename FWs>
   int Print(DGCutparHolder /*diffCuts*/, CC& collision, BCs& /*bcRange*/, TCs& /*tracks*/, FWs& /*fwdtracks*/)
   {
@@ -52,18 +57,25 @@ class DGSelector
     //  1 TSC
     //  2 TCE
     //  3 TOR
-    for (auto const& bc : bcRange) {
-      /* for debuging
-      auto isVetoed = udhelpers::FITveto(bc, diffCuts);
-      auto isClean = udhelpers::cleanFIT(bc, diffCuts.maxFITtime(), diffCuts.FITAmpLimits());
-      LOGF(info, "<IsSelected> isVetoed: %d isClean: %d", isVetoed, isClean);
-      if (isVetoed) {
+    if (fFITSums) {
+      auto [first, n] = fFITSums->rows(bcRange);
+      if (fFITSums->FITveto(first, n, diffCuts)) {
         return 1;
       }
-      */
+    } else {
+      for (auto const& bc : bcRange) {
+        /* for debuging
+        auto isVetoed = udhelpers::FITveto(bc, diffCuts);
+        auto isClean = udhelpers::cleanFIT(bc, diffCuts.maxFITtime(), diffCuts.FITAmpLimits());
+        LOGF(info, "<IsSelected> isVetoed: %d isClean: %d", isVetoed, isClean);
+        if (isVetoed) {
+          return 1;
+        }
+        */
 
-      if (udhelpers::FITveto(bc, diffCuts)) {
-        return 1;
+        if (udhelpers::FITveto(bc, diffCuts)) {
+          return 1;
+        }
       }
     }
 
@@ -207,10 +219,17 @@ class DGSelector
     //  1 TSC
     //  2 TCE
     //  3 TOR
-    for (auto const& bc : bcRange) {
-      if (udhelpers::FITveto(bc, diffCuts)) {
+    if (fFITSums) {
+      auto [first, n] = fFITSums->rows(bcRange);
+      if (fFITSums->FITveto(first, n, diffCuts)) {
         return 1;
       }
+    } else {
+      for (auto const& bc : bcRange) {
+        if (udhelpers::FITveto(bc, diffCuts)) {
+          return 1;
+        }
+      }
     }
 
     // no activity in muon arm
@@ -277,6 +296,7 @@ class DGSelector
 
  private:
   TDatabasePDG* fPDG;
+  const udhelpers::FITWindowSums* fFITSums = nullptr;
 
   ClassDefNV(DGSelector, 1);
 };
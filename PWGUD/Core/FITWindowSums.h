@@ -0,0 +1,157 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+///
+/// \brief  Prefix sums of the FIT amplitudes and trigger/activity flags over the BC table,
+///         for the BC window queries of the gap selections
+/// \since  14.10.2026
+
+#ifndef PWGUD_CORE_FITWINDOWSUMS_H_
+#define PWGUD_CORE_FITWINDOWSUMS_H_
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "PWGUD/Core/UDHelpers.h"
+#include "PWGUD/Core/DGCutparHolder.h"
+
+namespace udhelpers
+{
+
+// -----------------------------------------------------------------------------
+// The FIT amplitudes and flags of each row of the BC table of a timeframe are
+// accumulated once, so that the sum (or the number of flagged BCs) over any slice
+// of compatible BCs is the difference of two entries, independent of the window size.
+// The flags depend on maxFITtime and the FIT amplitude limits, which are given to build().
+class FITWindowSums
+{
+ public:
+  enum Amplitude {
+    kFV0A = 0,
+    kFT0A,
+    kFT0C,
+    kFDDA,
+    kFDDC,
+    kNAmplitudes
+  };
+
+  enum Flag {
+    kTVX = 0,
+    kTSC,
+    kTCE,
+    kNotCleanFIT,  // !cleanFIT
+    kNotCleanFITA, // !cleanFITA
+    kNotCleanFITC, // !cleanFITC
+    kNFlags
+  };
+
+  // fill the prefix sums for the BC table bcs, nothing is done if they were
+  // already filled for this table (same timeframe)
+  template <typename TBCs>
+  void build(TBCs const& bcs, float maxFITtime, std::vector<float> const& lims)
+  {
+    auto table = bcs.asArrowTable().get();
+    if (table == fTable && static_cast<int64_t>(bcs.size()) == fNRows) {
+      return;
+    }
+    fTable = table;
+    fNRows = bcs.size();
+    for (auto& sums : fAmplitudes) {
+      sums.assign(fNRows + 1, 0.);
+    }
+    for (auto& counts : fFlags) {
+      counts.assign(fNRows + 1, 0);
+    }
+
+    std::array<double, kNAmplitudes> amps{};
+    std::array<int32_t, kNFlags> flags{};
+    int64_t row = 0;
+    for (auto const& bc : bcs) {
+      amps.fill(0.);
+      if (bc.has_foundFV0()) {
+        amps[kFV0A] = FV0AmplitudeA(bc.foundFV0());
+      }
+      if (bc.has_foundFT0()) {
+        amps[kFT0A] = FT0AmplitudeA(bc.foundFT0());
+        amps[kFT0C] = FT0AmplitudeC(bc.foundFT0());
+      }
+      if (bc.has_foundFDD()) {
+        amps[kFDDA] = FDDAmplitudeA(bc.foundFDD());
+        amps[kFDDC] = FDDAmplitudeC(bc.foundFDD());
+      }
+      flags[kTVX] = TVX(bc);
+      flags[kTSC] = TSC(bc);
+      flags[kTCE] = TCE(bc);
+      flags[kNotCleanFITA] = !cleanFITA(bc, maxFITtime, lims);
+      flags[kNotCleanFITC] = !cleanFITC(bc, maxFITtime, lims);
+      flags[kNotCleanFIT] = flags[kNotCleanFITA] || flags[kNotCleanFITC];
+      for (int i = 0; i < kNAmplitudes; i++) {
+        fAmplitudes[i][row + 1] = fAmplitudes[i][row] + amps[i];
+      }
+      for (int i = 0; i < kNFlags; i++) {
+        fFlags[i][row + 1] = fFlags[i][row] + flags[i];
+      }
+      row++;
+    }
+  }
+
+  // rows [first, first + n) of the BC table covered by a slice of it (e.g. from compatibleBCs)
+  template <typename TBCs>
+  std::pair<int64_t, int64_t> rows(TBCs const& bcRange) const
+  {
+    if (bcRange.size() == 0) {
+      return {0, 0};
+    }
+    return {bcRange.begin().globalIndex(), bcRange.size()};
+  }
+
+  // sum of the amplitudes over the rows [first, first + n)
+  double amplitude(Amplitude amp, int64_t first, int64_t n) const
+  {
+    return fAmplitudes[amp][first + n] - fAmplitudes[amp][first];
+  }
+
+  // number of flagged BCs in the rows [first, first + n)
+  int32_t count(Flag flag, int64_t first, int64_t n) const
+  {
+    return fFlags[flag][first + n] - fFlags[flag][first];
+  }
+
+  // same as FITveto being true for any of the BCs in the rows [first, first + n)
+  // maxFITtime and the amplitude limits of diffCuts must be the ones given to build()
+  bool FITveto(int64_t first, int64_t n, DGCutparHolder const& diffCuts) const
+  {
+    if (diffCuts.withTVX()) {
+      return count(kTVX, first, n) > 0;
+    }
+    if (diffCuts.withTSC()) {
+      return count(kTSC, first, n) > 0;
+    }
+    if (diffCuts.withTCE()) {
+      return count(kTCE, first, n) > 0;
+    }
+    if (diffCuts.withTOR()) {
+      return count(kNotCleanFIT, first, n) > 0;
+    }
+    return false;
+  }
+
+ private:
+  const void* fTable = nullptr; // BC table the sums were filled for
+  int64_t fNRows = -1;
+  std::array<std::vector<double>, kNAmplitudes> fAmplitudes; // fNRows + 1 prefix sums each
+  std::array<std::vector<int32_t>, kNFlags> fFlags;          // fNRows + 1 prefix counts each
+};
+
+} // namespace udhelpers
+
+#endif // PWGUD_CORE_FITWINDOWSUMS_H_
@@ -18,6 +18,7 @@
 #include "Framework/Logger.h"
 #include "Framework/AnalysisTask.h"
 #include "PWGUD/Core/UDHelpers.h"
+#include "PWGUD/Core/FITWindowSums.h"
 #include "PWGUD/Core/SGCutParHolder.h"
 
 template <typename BC>
@@ -31,6 +32,10 @@ class SGSelector
  public:
   SGSelector() : fPDG(TDatabasePDG::Instance()) {}
 
+  // use the prefix sums of the FIT flags to reject the collisions with activity on both sides
+  // without testing each compatible BC, fitSums must be built for the BC table of the processed timeframe
+  void setFITWindowSums(const udhelpers::FITWindowSums* fitSums) { fFITSums = fitSums; }
+
   template <typename CC, typename BCs, typename TCs, typename FWs>
   int Print(SGCutParHolder diffCuts, CC& collision, BCs& bcRange, TCs& tracks, FWs& fwdtracks)
   {
@@ -57,6 +62,14 @@ class SGSelector
     float ampc = 0;
     float ampa = 0;
     bool gA = true, gC = true;
+    if (fFITSums) {
+      auto [first, n] = fFITSums->rows(bcRange);
+      if (fFITSums->count(udhelpers::FITWindowSums::kNotCleanFITA, first, n) > 0 &&
+          fFITSums->count(udhelpers::FITWindowSums::kNotCleanFITC, first, n) > 0) {
+        result.value = 3;
+        return result;
+      }
+    }
     for (auto const& bc : bcRange) {
       if (!udhelpers::cleanFITA(bc, diffCuts.maxFITtime(), diffCuts.FITAmpLimits())) {
         if (gA)
@@ -148,6 +161,7 @@ class SGSelector
 
  private:
   TDatabasePDG* fPDG;
+  const udhelpers::FITWindowSums* fFITSums = nullptr;
 };
 
 #endif // PWGUD_CORE_SGSELECTOR_H_
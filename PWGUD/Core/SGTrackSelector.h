@@ -162,4 +162,33 @@ bool selectionPIDMuon(const T& candidate, bool use_tof, float nsigmatpc_cut, flo
   }
   return false;
 }
+// bits of the mask of selectionMask()
+enum SGTrackMaskBits {
+  kSGTrackSelected = 0, // trackselector()
+  kSGElectron,          // selectionPIDElec()
+  kSGMuon,              // selectionPIDMuon()
+  kSGPion,              // selectionPIDPion()
+  kSGKaon,              // selectionPIDKaon()
+  kSGProton             // selectionPIDProton()
+};
+// track selection and species compatibility of a track in one mask, to be computed once per track
+// and combined with a bitwise AND in the loops over track pairs or candidates
+template <typename T>
+int selectionMask(const T& track, const std::vector<float>& params, bool use_tof, float nsigmatpc_cut, float nsigmatof_cut)
+{
+  int mask = 0;
+  if (trackselector(track, params))
+    mask |= 1 << kSGTrackSelected;
+  if (selectionPIDElec(track, use_tof, nsigmatpc_cut, nsigmatof_cut))
+    mask |= 1 << kSGElectron;
+  if (selectionPIDMuon(track, use_tof, nsigmatpc_cut, nsigmatof_cut))
+    mask |= 1 << kSGMuon;
+  if (selectionPIDPion(track, use_tof, nsigmatpc_cut, nsigmatof_cut))
+    mask |= 1 << kSGPion;
+  if (selectionPIDKaon(track, use_tof, nsigmatpc_cut, nsigmatof_cut))
+    mask |= 1 << kSGKaon;
+  if (selectionPIDProton(track, use_tof, nsigmatpc_cut, nsigmatof_cut))
+    mask |= 1 << kSGProton;
+  return mask;
+}
 #endif // PWGUD_CORE_SGTRACKSELECTOR_H_
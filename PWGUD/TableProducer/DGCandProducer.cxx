@@ -31,6 +31,8 @@ struct DGCandProducer {
 
   // DG selector
   DGSelector dgSelector;
+  // FIT flags of the BCs of the timeframe, for the veto over the compatible BCs
+  udhelpers::FITWindowSums fitSums;
 
   // data tables
   Produces<aod::UDCollisions> outputCollisions;
@@ -192,6 +194,7 @@ struct DGCandProducer {
     LOGF(debug, "<DGCandProducer> beginning of init reached");
 
     diffCuts = (DGCutparHolder)DGCuts;
+    dgSelector.setFITWindowSums(&fitSums);
 
     const int nXbinsInStatH = 25;
 
@@ -251,6 +254,7 @@ struct DGCandProducer {
     LOGF(debug, "<DGCandProducer>  Size of bcRange %d", bcRange.size());
 
     // apply DG selection
+    fitSums.build(bcs, diffCuts.maxFITtime(), diffCuts.FITAmpLimits());
     auto isDGEvent = dgSelector.IsSelected(diffCuts, collision, bcRange, tracks, fwdtracks);
 
     // save DG candidates
@@ -40,6 +40,8 @@ struct SGCandProducer {
   Configurable<bool> ITSTPCVertex{"ITSTPCVertex", true, "reject ITS-only vertex"}; // if one wants to look at Single Gap pp events
   //  SG selector
   SGSelector sgSelector;
+  // FIT flags of the BCs of the timeframe, for the gap test over the compatible BCs
+  udhelpers::FITWindowSums fitSums;
 
   // data tables
   Produces<aod::SGCollisions> outputSGCollisions;
@@ -144,6 +146,7 @@ struct SGCandProducer {
   void init(InitContext&)
   {
     sameCuts = (SGCutParHolder)SGCuts;
+    sgSelector.setFITWindowSums(&fitSums);
     registry.add("reco/Stat", "Cut statistics; Selection criterion; Collisions", {HistType::kTH1F, {{14, -0.5, 13.5}}});
   }
 
@@ -188,6 +191,7 @@ struct SGCandProducer {
 
     // obtain slice of compatible BCs
     auto bcRange = udhelpers::compatibleBCs(collision, sameCuts.NDtcoll(), bcs, sameCuts.minNBCs());
+    fitSums.build(bcs, sameCuts.maxFITtime(), sameCuts.FITAmpLimits());
     auto isSGEvent = sgSelector.IsSelected(sameCuts, collision, bcRange, bc);
     // auto isSGEvent = sgSelector.IsSelected(sameCuts, collision, bcRange, tracks);
     int issgevent = isSGEvent.value;
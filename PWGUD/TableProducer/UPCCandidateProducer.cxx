@@ -13,6 +13,7 @@
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
 #include "Common/CCDB/EventSelectionParams.h"
+#include "Common/Core/BcTimeIndex.h"
 #include "Common/DataModel/EventSelection.h"
 #include "CommonConstants/LHCConstants.h"
 #include "DataFormatsFIT/Triggers.h"
@@ -29,6 +30,19 @@ struct UpcCandProducer {
   std::map<int32_t, int32_t> fNewPartIDs;
   uint64_t fMaxBC{0}; // max BC for ITS-TPC search
 
+  // global BC -> row of the FIT/ZDC tables, per trigger class, refilled for each timeframe
+  BcTimeIndex fBcsWithTOR;
+  BcTimeIndex fBcsWithTVX;
+  BcTimeIndex fBcsWithTSC;
+  BcTimeIndex fBcsWithT0A;
+  BcTimeIndex fBcsWithV0A;
+  BcTimeIndex fBcsWithZdc;
+
+  // forward track clusters, grouped by track (CSR layout)
+  std::vector<int32_t> fClsOffsets;
+  std::vector<int32_t> fClsFill;
+  std::vector<int32_t> fClsIds;
+
   Produces<o2::aod::UDMcCollisions> udMCCollisions;
   Produces<o2::aod::UDMcParticles> udMCParticles;
 
@@ -213,19 +227,6 @@ struct UpcCandProducer {
     return true;
   }
 
-  auto findClosestBC(uint64_t globalBC, std::map<uint64_t, int32_t>& bcs)
-  {
-    auto it = bcs.lower_bound(globalBC);
-    auto bc1 = it->first;
-    if (it != bcs.begin())
-      --it;
-    auto bc2 = it->first;
-    auto dbc1 = bc1 >= globalBC ? bc1 - globalBC : globalBC - bc1;
-    auto dbc2 = bc2 >= globalBC ? bc2 - globalBC : globalBC - bc2;
-    auto bc = (dbc1 <= dbc2) ? bc1 : bc2;
-    return bc;
-  }
-
   auto findClosestTrackBCiter(uint64_t globalBC, std::vector<BCTracksPair>& bcs)
   {
     auto it = std::lower_bound(bcs.begin(), bcs.end(), globalBC,
@@ -383,15 +384,30 @@ struct UpcCandProducer {
   void fillFwdClusters(const std::vector<int>& trackIds,
                        o2::aod::FwdTrkCls const& fwdTrkCls)
   {
-    std::map<int, std::vector<int>> clustersPerTrack;
+    // clusters per track in CSR layout: cluster IDs of track i at [fClsOffsets[i], fClsOffsets[i + 1])
+    int32_t nTracks = 0;
     for (const auto& cls : fwdTrkCls) {
-      clustersPerTrack[cls.fwdtrackId()].push_back(cls.globalIndex());
+      nTracks = std::max(nTracks, cls.fwdtrackId() + 1);
+    }
+    fClsOffsets.assign(nTracks + 1, 0);
+    for (const auto& cls : fwdTrkCls) {
+      fClsOffsets[cls.fwdtrackId() + 1]++;
+    }
+    for (int32_t i = 0; i < nTracks; i++) {
+      fClsOffsets[i + 1] += fClsOffsets[i];
+    }
+    fClsIds.resize(fwdTrkCls.size());
+    fClsFill.assign(fClsOffsets.begin(), fClsOffsets.end() - 1);
+    for (const auto& cls : fwdTrkCls) {
+      fClsIds[fClsFill[cls.fwdtrackId()]++] = cls.globalIndex();
     }
     int newId = 0;
     for (auto trackId : trackIds) {
-      const auto& clusters = clustersPerTrack.at(trackId);
-      for (auto clsId : clusters) {
-        const auto& clsInfo = fwdTrkCls.iteratorAt(clsId);
+      if (trackId >= nTracks) {
+        LOGP(fatal, "No clusters found for forward track {}", trackId);
+      }
+      for (int32_t i = fClsOffsets[trackId]; i < fClsOffsets[trackId + 1]; i++) {
+        const auto& clsInfo = fwdTrkCls.iteratorAt(fClsIds[i]);
         udFwdTrkClusters(newId, clsInfo.x(), clsInfo.y(), clsInfo.z(), clsInfo.clInfo());
       }
       newId++;
@@ -437,25 +453,16 @@ struct UpcCandProducer {
 
   bool checkFT0(upchelpers::FITInfo& info, bool isCentral)
   {
-    const uint64_t presBitNum = 16;
-    bool hasNoFT0 = true;
-    for (uint64_t ibit = presBitNum - fFilterRangeFT0; ibit <= presBitNum + fFilterRangeFT0; ibit++) {
-      bool check = false;
-      if (isCentral) {
-        bool isBB = TESTBIT(info.BBFT0Apf, ibit) || TESTBIT(info.BBFT0Cpf, ibit);
-        bool isBG = TESTBIT(info.BGFT0Apf, ibit) || TESTBIT(info.BGFT0Cpf, ibit);
-        check = !isBB && !isBG;
-      } else {
-        bool checkA = TESTBIT(info.BGFT0Apf, ibit);
-        bool checkC = TESTBIT(info.BBFT0Cpf, ibit);
-        check = checkA && checkC;
-      }
-      if (!check) {
-        hasNoFT0 = false;
-        break;
-      }
+    // the pre/post flags hold one bit per BC in [midbc - 16, midbc + 16], tested for the whole window at once
+    const int presBitNum = 16;
+    const int range = std::clamp(static_cast<int>(fFilterRangeFT0), 0, presBitNum - 1);
+    const uint32_t window = ((1u << (2 * range + 1)) - 1) << (presBitNum - range);
+    if (isCentral) {
+      uint32_t flags = info.BBFT0Apf | info.BBFT0Cpf | info.BGFT0Apf | info.BGFT0Cpf;
+      return (flags & window) == 0;
     }
-    return hasNoFT0;
+    uint32_t flags = info.BGFT0Apf & info.BBFT0Cpf;
+    return (flags & window) == window;
   }
 
   void processFITInfo(upchelpers::FITInfo& fitInfo,
@@ -746,16 +753,16 @@ struct UpcCandProducer {
     std::sort(bcsMatchedTrIdsITSTPC.begin(), bcsMatchedTrIdsITSTPC.end(),
               [](const auto& left, const auto& right) { return left.first < right.first; });
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithTOR{};
-    std::map<uint64_t, int32_t> mapGlobalBcWithTVX{};
-    std::map<uint64_t, int32_t> mapGlobalBcWithTSC{};
+    fBcsWithTOR.clear();
+    fBcsWithTVX.clear();
+    fBcsWithTSC.clear();
     for (const auto& ft0 : ft0s) {
       uint64_t globalBC = ft0.bc_as<o2::aod::BCs>().globalBC();
       int32_t globalIndex = ft0.globalIndex();
       if (!(std::abs(ft0.timeA()) > 2.f && std::abs(ft0.timeC()) > 2.f))
-        mapGlobalBcWithTOR[globalBC] = globalIndex;
+        fBcsWithTOR.add(globalBC, globalIndex);
       if (TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitVertex)) { // TVX
-        mapGlobalBcWithTVX[globalBC] = globalIndex;
+        fBcsWithTVX.add(globalBC, globalIndex);
       }
       if (TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitCen)) { // TVX & TCE
         histRegistry.get<TH1>(HIST("hCountersTrg"))->Fill("TCE", 1);
@@ -763,19 +770,23 @@ struct UpcCandProducer {
       if (TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitVertex) &&
           (TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitCen) ||
            TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitSCen))) { // TVX & (TSC | TCE)
-        mapGlobalBcWithTSC[globalBC] = globalIndex;
+        fBcsWithTSC.add(globalBC, globalIndex);
       }
     }
+    fBcsWithTOR.build();
+    fBcsWithTVX.build();
+    fBcsWithTSC.build();
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithV0A{};
+    fBcsWithV0A.clear();
     for (const auto& fv0a : fv0as) {
       if (std::abs(fv0a.time()) > 15.f)
         continue;
       uint64_t globalBC = fv0a.bc_as<o2::aod::BCs>().globalBC();
-      mapGlobalBcWithV0A[globalBC] = fv0a.globalIndex();
+      fBcsWithV0A.add(globalBC, fv0a.globalIndex());
     }
+    fBcsWithV0A.build();
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithZdc{};
+    fBcsWithZdc.clear();
     for (const auto& zdc : zdcs) {
       if (std::abs(zdc.timeZNA()) > 2.f && std::abs(zdc.timeZNC()) > 2.f)
         continue;
@@ -784,14 +795,15 @@ struct UpcCandProducer {
       if (!(std::abs(zdc.timeZNC()) > 2.f))
         histRegistry.get<TH1>(HIST("hCountersTrg"))->Fill("ZNC", 1);
       auto globalBC = zdc.bc_as<o2::aod::BCs>().globalBC();
-      mapGlobalBcWithZdc[globalBC] = zdc.globalIndex();
+      fBcsWithZdc.add(globalBC, zdc.globalIndex());
     }
+    fBcsWithZdc.build();
 
-    auto nTORs = mapGlobalBcWithTOR.size();
-    auto nTSCs = mapGlobalBcWithTSC.size();
-    auto nTVXs = mapGlobalBcWithTVX.size();
-    auto nFV0As = mapGlobalBcWithV0A.size();
-    auto nZdcs = mapGlobalBcWithZdc.size();
+    auto nTORs = fBcsWithTOR.size();
+    auto nTSCs = fBcsWithTSC.size();
+    auto nTVXs = fBcsWithTVX.size();
+    auto nFV0As = fBcsWithV0A.size();
+    auto nZdcs = fBcsWithZdc.size();
     auto nBcsWithITSTPC = bcsMatchedTrIdsITSTPC.size();
 
     // todo: calculate position of UD collision?
@@ -815,12 +827,11 @@ struct UpcCandProducer {
       fitInfo.distClosestBcTVX = 999;
       fitInfo.distClosestBcV0A = 999;
       if (nTORs > 0) {
-        uint64_t closestBcTOR = findClosestBC(globalBC, mapGlobalBcWithTOR);
-        fitInfo.distClosestBcTOR = globalBC - static_cast<int64_t>(closestBcTOR);
+        auto posTOR = fBcsWithTOR.closestPos(globalBC);
+        fitInfo.distClosestBcTOR = static_cast<int64_t>(globalBC) - fBcsWithTOR.globalBC(posTOR);
         if (std::abs(fitInfo.distClosestBcTOR) <= fFilterFT0)
           return false;
-        auto ft0Id = mapGlobalBcWithTOR.at(closestBcTOR);
-        auto ft0 = ft0s.iteratorAt(ft0Id);
+        auto ft0 = ft0s.iteratorAt(fBcsWithTOR.index(posTOR));
         fitInfo.timeFT0A = ft0.timeA();
         fitInfo.timeFT0C = ft0.timeC();
         const auto& t0AmpsA = ft0.amplitudeA();
@@ -831,24 +842,23 @@ struct UpcCandProducer {
           fitInfo.ampFT0C += amp;
       }
       if (nTSCs > 0) {
-        uint64_t closestBcTSC = findClosestBC(globalBC, mapGlobalBcWithTSC);
-        fitInfo.distClosestBcTSC = globalBC - static_cast<int64_t>(closestBcTSC);
+        auto posTSC = fBcsWithTSC.closestPos(globalBC);
+        fitInfo.distClosestBcTSC = static_cast<int64_t>(globalBC) - fBcsWithTSC.globalBC(posTSC);
         if (std::abs(fitInfo.distClosestBcTSC) <= fFilterTSC)
           return false;
       }
       if (nTVXs > 0) {
-        uint64_t closestBcTVX = findClosestBC(globalBC, mapGlobalBcWithTVX);
-        fitInfo.distClosestBcTVX = globalBC - static_cast<int64_t>(closestBcTVX);
+        auto posTVX = fBcsWithTVX.closestPos(globalBC);
+        fitInfo.distClosestBcTVX = static_cast<int64_t>(globalBC) - fBcsWithTVX.globalBC(posTVX);
         if (std::abs(fitInfo.distClosestBcTVX) <= fFilterTVX)
           return false;
       }
       if (nFV0As > 0) {
-        uint64_t closestBcV0A = findClosestBC(globalBC, mapGlobalBcWithV0A);
-        fitInfo.distClosestBcV0A = globalBC - static_cast<int64_t>(closestBcV0A);
+        auto posV0A = fBcsWithV0A.closestPos(globalBC);
+        fitInfo.distClosestBcV0A = static_cast<int64_t>(globalBC) - fBcsWithV0A.globalBC(posV0A);
         if (std::abs(fitInfo.distClosestBcV0A) <= fFilterFV0)
           return false;
-        auto fv0aId = mapGlobalBcWithV0A.at(closestBcV0A);
-        auto fv0a = fv0as.iteratorAt(fv0aId);
+        auto fv0a = fv0as.iteratorAt(fBcsWithV0A.index(posV0A));
         fitInfo.timeFV0A = fv0a.time();
         const auto& v0Amps = fv0a.amplitude();
         for (auto amp : v0Amps)
@@ -886,9 +896,9 @@ struct UpcCandProducer {
       if (!updateFitInfo(globalBC, fitInfo))
         continue;
       if (nZdcs > 0) {
-        auto itZDC = mapGlobalBcWithZdc.find(globalBC);
-        if (itZDC != mapGlobalBcWithZdc.end()) {
-          const auto& zdc = zdcs.iteratorAt(itZDC->second);
+        auto zdcId = fBcsWithZdc.find(globalBC);
+        if (zdcId >= 0) {
+          const auto& zdc = zdcs.iteratorAt(zdcId);
           float timeZNA = zdc.timeZNA();
           float timeZNC = zdc.timeZNC();
           float eComZNA = zdc.energyCommonZNA();
@@ -951,9 +961,9 @@ struct UpcCandProducer {
       if (!updateFitInfo(globalBC, fitInfo))
         continue;
       if (nZdcs > 0) {
-        auto itZDC = mapGlobalBcWithZdc.find(globalBC);
-        if (itZDC != mapGlobalBcWithZdc.end()) {
-          const auto& zdc = zdcs.iteratorAt(itZDC->second);
+        auto zdcId = fBcsWithZdc.find(globalBC);
+        if (zdcId >= 0) {
+          const auto& zdc = zdcs.iteratorAt(zdcId);
           float timeZNA = zdc.timeZNA();
           float timeZNC = zdc.timeZNC();
           float eComZNA = zdc.energyCommonZNA();
@@ -1170,18 +1180,14 @@ struct UpcCandProducer {
 
   template <typename T>
   void fillAmplitudes(const T& t,
-                      const std::map<uint64_t, int32_t>& mapBCs,
+                      const BcTimeIndex& bcIndex,
                       std::vector<float>& amps,
                       std::vector<int8_t>& relBCs,
                       int64_t gbc)
   {
-    auto s = gbc - fBCWindowFITAmps;
-    auto e = gbc + (fBCWindowFITAmps - 1);
-    auto it = mapBCs.lower_bound(s);
-    while (it->first <= e && it != mapBCs.end()) {
-      int i = it->first - s;
-      auto id = it->second;
-      const auto& row = t.iteratorAt(id);
+    auto [first, last] = bcIndex.range(gbc - fBCWindowFITAmps, gbc + (fBCWindowFITAmps - 1));
+    for (auto pos = first; pos < last; pos++) {
+      const auto& row = t.iteratorAt(bcIndex.index(pos));
       float totalAmp = 0.f;
       if constexpr (std::is_same_v<T, o2::aod::FT0s>) {
         const auto& itAmps = row.amplitudeA();
@@ -1193,9 +1199,8 @@ struct UpcCandProducer {
       }
       if (totalAmp > 0.f) {
         amps.push_back(totalAmp);
-        relBCs.push_back(gbc - (i + s));
+        relBCs.push_back(gbc - bcIndex.globalBC(pos));
       }
-      ++it;
     }
   }
 
@@ -1234,7 +1239,7 @@ struct UpcCandProducer {
     std::sort(bcsMatchedTrIdsMCH.begin(), bcsMatchedTrIdsMCH.end(),
               [](const auto& left, const auto& right) { return left.first < right.first; });
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithT0A{};
+    fBcsWithT0A.clear();
     for (const auto& ft0 : ft0s) {
       if (!TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitVertex))
         continue;
@@ -1244,20 +1249,22 @@ struct UpcCandProducer {
       if (std::abs(ft0.timeA()) > 2.f)
         continue;
       uint64_t globalBC = ft0.bc_as<o2::aod::BCs>().globalBC();
-      mapGlobalBcWithT0A[globalBC] = ft0.globalIndex();
+      fBcsWithT0A.add(globalBC, ft0.globalIndex());
     }
+    fBcsWithT0A.build();
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithV0A{};
+    fBcsWithV0A.clear();
     for (const auto& fv0a : fv0as) {
       if (!TESTBIT(fv0a.triggerMask(), o2::fit::Triggers::bitA))
         continue;
       if (std::abs(fv0a.time()) > 15.f)
         continue;
       uint64_t globalBC = fv0a.bc_as<o2::aod::BCs>().globalBC();
-      mapGlobalBcWithV0A[globalBC] = fv0a.globalIndex();
+      fBcsWithV0A.add(globalBC, fv0a.globalIndex());
     }
+    fBcsWithV0A.build();
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithZdc{};
+    fBcsWithZdc.clear();
     for (const auto& zdc : zdcs) {
       if (std::abs(zdc.timeZNA()) > 2.f && std::abs(zdc.timeZNC()) > 2.f)
         continue;
@@ -1266,12 +1273,13 @@ struct UpcCandProducer {
       if (!(std::abs(zdc.timeZNC()) > 2.f))
         histRegistry.get<TH1>(HIST("hCountersTrg"))->Fill("ZNC", 1);
       auto globalBC = zdc.bc_as<o2::aod::BCs>().globalBC();
-      mapGlobalBcWithZdc[globalBC] = zdc.globalIndex();
+      fBcsWithZdc.add(globalBC, zdc.globalIndex());
     }
+    fBcsWithZdc.build();
 
-    auto nFT0s = mapGlobalBcWithT0A.size();
-    auto nFV0As = mapGlobalBcWithV0A.size();
-    auto nZdcs = mapGlobalBcWithZdc.size();
+    auto nFT0s = fBcsWithT0A.size();
+    auto nFV0As = fBcsWithV0A.size();
+    auto nZdcs = fBcsWithZdc.size();
     auto nBcsWithMCH = bcsMatchedTrIdsMCH.size();
 
     // todo: calculate position of UD collision?
@@ -1321,38 +1329,36 @@ struct UpcCandProducer {
       std::vector<int8_t> relBCsT0A{};
       std::vector<int8_t> relBCsV0A{};
       if (nFT0s > 0) {
-        uint64_t closestBcT0A = findClosestBC(globalBC, mapGlobalBcWithT0A);
-        int64_t distClosestBcT0A = globalBC - static_cast<int64_t>(closestBcT0A);
+        auto posT0A = fBcsWithT0A.closestPos(globalBC);
+        int64_t distClosestBcT0A = globalBC - fBcsWithT0A.globalBC(posT0A);
         if (std::abs(distClosestBcT0A) <= fFilterFT0)
           continue;
         fitInfo.distClosestBcT0A = distClosestBcT0A;
-        auto ft0Id = mapGlobalBcWithT0A.at(closestBcT0A);
-        auto ft0 = ft0s.iteratorAt(ft0Id);
+        auto ft0 = ft0s.iteratorAt(fBcsWithT0A.index(posT0A));
         fitInfo.timeFT0A = ft0.timeA();
         fitInfo.timeFT0C = ft0.timeC();
         const auto& t0AmpsA = ft0.amplitudeA();
         const auto& t0AmpsC = ft0.amplitudeC();
         fitInfo.ampFT0A = std::accumulate(t0AmpsA.begin(), t0AmpsA.end(), 0.f);
         fitInfo.ampFT0C = std::accumulate(t0AmpsC.begin(), t0AmpsC.end(), 0.f);
-        fillAmplitudes(ft0s, mapGlobalBcWithT0A, amplitudesT0A, relBCsT0A, globalBC);
+        fillAmplitudes(ft0s, fBcsWithT0A, amplitudesT0A, relBCsT0A, globalBC);
       }
       if (nFV0As > 0) {
-        uint64_t closestBcV0A = findClosestBC(globalBC, mapGlobalBcWithV0A);
-        int64_t distClosestBcV0A = globalBC - static_cast<int64_t>(closestBcV0A);
+        auto posV0A = fBcsWithV0A.closestPos(globalBC);
+        int64_t distClosestBcV0A = globalBC - fBcsWithV0A.globalBC(posV0A);
         if (std::abs(distClosestBcV0A) <= fFilterFV0)
           continue;
         fitInfo.distClosestBcV0A = distClosestBcV0A;
-        auto fv0aId = mapGlobalBcWithV0A.at(closestBcV0A);
-        auto fv0a = fv0as.iteratorAt(fv0aId);
+        auto fv0a = fv0as.iteratorAt(fBcsWithV0A.index(posV0A));
         fitInfo.timeFV0A = fv0a.time();
         const auto& v0Amps = fv0a.amplitude();
         fitInfo.ampFV0A = std::accumulate(v0Amps.begin(), v0Amps.end(), 0.f);
-        fillAmplitudes(fv0as, mapGlobalBcWithV0A, amplitudesV0A, relBCsV0A, globalBC);
+        fillAmplitudes(fv0as, fBcsWithV0A, amplitudesV0A, relBCsV0A, globalBC);
       }
       if (nZdcs > 0) {
-        auto itZDC = mapGlobalBcWithZdc.find(globalBC);
-        if (itZDC != mapGlobalBcWithZdc.end()) {
-          const auto& zdc = zdcs.iteratorAt(itZDC->second);
+        auto zdcId = fBcsWithZdc.find(globalBC);
+        if (zdcId >= 0) {
+          const auto& zdc = zdcs.iteratorAt(zdcId);
           float timeZNA = zdc.timeZNA();
           float timeZNC = zdc.timeZNC();
           float eComZNA = zdc.energyCommonZNA();
@@ -1393,8 +1399,6 @@ struct UpcCandProducer {
     ambFwdTrBCs.clear();
     bcsMatchedTrIdsMID.clear();
     bcsMatchedTrIdsMCH.clear();
-    mapGlobalBcWithT0A.clear();
-    mapGlobalBcWithV0A.clear();
   }
 
   // data processors
@@ -13,6 +13,7 @@
 // \since  May 2024
 
 #include <cstdlib>
+#include <vector>
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
@@ -185,6 +186,27 @@ struct SGResonanceAnalyzer {
   using UDCollisionsFull = soa::Join<aod::UDCollisions, aod::SGCollisions, aod::UDCollisionsSels, aod::UDZdcsReduced>; //
   using UDCollisionFull = UDCollisionsFull::iterator;
 
+  // bits of the track masks in addition to the ones of selectionMask(): kaons without the pion hypothesis and vice versa
+  static constexpr int kKaonNotPion = 1 << 6;
+  static constexpr int kPionNotKaon = 1 << 7;
+  static constexpr int kSelected = 1 << kSGTrackSelected;
+  static constexpr int kKaon = 1 << kSGKaon;
+  static constexpr int kPion = 1 << kSGPion;
+  std::vector<int> trackMasks; // masks of the tracks of the collision, in the order of the tracks
+
+  template <typename T>
+  int trackMask(const T& track, const std::vector<float>& parameters)
+  {
+    int mask = selectionMask(track, parameters, use_tof, nsigmatpc_cut, nsigmatof_cut);
+    if ((mask & kKaon) && std::abs(track.tpcNSigmaPi()) > 3.0) {
+      mask |= kKaonNotPion;
+    }
+    if ((mask & kPion) && std::abs(track.tpcNSigmaKa()) > 3.0) {
+      mask |= kPionNotKaon;
+    }
+    return mask;
+  }
+
   void process(UDCollisionFull const& collision, udtracksfull const& tracks)
   {
     TLorentzVector v0;
@@ -220,6 +242,15 @@ struct SGResonanceAnalyzer {
     Int_t trackDG = 0;
     Int_t trackextra = 0;
     Int_t trackextraDG = 0;
+
+    // the track selection and PID are evaluated once per track, the pair loops only combine the masks
+    trackMasks.clear();
+    for (const auto& track : tracks) {
+      trackMasks.push_back(trackMask(track, parameters));
+    }
+    const int64_t firstTrack = tracks.size() > 0 ? tracks.begin().globalIndex() : 0;
+    auto mask = [&](const auto& track) { return trackMasks[track.globalIndex() - firstTrack]; };
+
     for (auto track1 : tracks) {
       if (!trackselector(track1, parameters))
         continue;
@@ -372,9 +403,9 @@ struct SGResonanceAnalyzer {
     if (rapidity_gap) {
       if (trackgapC > 0 && trackgapA == 0 && trackextra == 0) {
         for (auto& [t0, t1] : combinations(tracks, tracks)) {
-          if (!trackselector(t0, parameters) || !trackselector(t1, parameters))
+          if (!(mask(t0) & mask(t1) & kSelected))
             continue;
-          if (phi && selectionPIDKaon(t0, use_tof, nsigmatpc_cut, nsigmatof_cut) && selectionPIDKaon(t1, use_tof, nsigmatpc_cut, nsigmatof_cut)) {
+          if (phi && (mask(t0) & mask(t1) & kKaon)) {
             // Apply kaon hypothesis and create pairs
             v0.SetXYZM(t0.px(), t0.py(), t0.pz(), o2::constants::physics::MassKaonCharged);
             v1.SetXYZM(t1.px(), t1.py(), t1.pz(), o2::constants::physics::MassKaonCharged);
@@ -392,7 +423,7 @@ struct SGResonanceAnalyzer {
               }
             }
           }
-          if (kstar && selectionPIDKaon(t0, use_tof, nsigmatpc_cut, nsigmatof_cut) && std::abs(t0.tpcNSigmaPi()) > 3.0 && selectionPIDPion(t1, use_tof, nsigmatpc_cut, nsigmatof_cut) && std::abs(t1.tpcNSigmaKa()) > 3.0) {
+          if (kstar && (mask(t0) & kKaonNotPion) && (mask(t1) & kPionNotKaon)) {
             // Apply kaon hypothesis and create pairs
             v0.SetXYZM(t0.px(), t0.py(), t0.pz(), o2::constants::physics::MassKaonCharged);
             v1.SetXYZM(t1.px(), t1.py(), t1.pz(), o2::constants::physics::MassPionCharged);
@@ -415,9 +446,9 @@ struct SGResonanceAnalyzer {
 
       if (trackgapC == 0 && trackgapA > 0 && trackextra == 0) {
         for (auto& [t0, t1] : combinations(tracks, tracks)) {
-          if (!trackselector(t0, parameters) || !trackselector(t1, parameters))
+          if (!(mask(t0) & mask(t1) & kSelected))
             continue;
-          if (phi && selectionPIDKaon(t0, use_tof, nsigmatpc_cut, nsigmatof_cut) && selectionPIDKaon(t1, use_tof, nsigmatpc_cut, nsigmatof_cut)) {
+          if (phi && (mask(t0) & mask(t1) & kKaon)) {
             // Apply kaon hypothesis and create pairs
             v0.SetXYZM(t0.px(), t0.py(), t0.pz(), o2::constants::physics::MassKaonCharged);
             v1.SetXYZM(t1.px(), t1.py(), t1.pz(), o2::constants::physics::MassKaonCharged);
@@ -435,7 +466,7 @@ struct SGResonanceAnalyzer {
               }
             }
           }
-          if (kstar && selectionPIDKaon(t0, use_tof, nsigmatpc_cut, nsigmatof_cut) && std::abs(t0.tpcNSigmaPi()) > 3.0 && selectionPIDPion(t1, use_tof, nsigmatpc_cut, nsigmatof_cut) && std::abs(t1.tpcNSigmaKa()) > 3.0) {
+          if (kstar && (mask(t0) & kKaonNotPion) && (mask(t1) & kPionNotKaon)) {
             // Apply kaon hypothesis and create pairs
             v0.SetXYZM(t0.px(), t0.py(), t0.pz(), o2::constants::physics::MassKaonCharged);
             v1.SetXYZM(t1.px(), t1.py(), t1.pz(), o2::constants::physics::MassPionCharged);
@@ -457,9 +488,9 @@ struct SGResonanceAnalyzer {
       }
       if (trackDG > 0 && trackextraDG == 0) {
         for (auto& [t0, t1] : combinations(tracks, tracks)) {
-          if (!trackselector(t0, parameters) || !trackselector(t1, parameters))
+          if (!(mask(t0) & mask(t1) & kSelected))
             continue;
-          if (phi && selectionPIDKaon(t0, use_tof, nsigmatpc_cut, nsigmatof_cut) && selectionPIDKaon(t1, use_tof, nsigmatpc_cut, nsigmatof_cut)) {
+          if (phi && (mask(t0) & mask(t1) & kKaon)) {
             // Apply kaon hypothesis and create pairs
             v0.SetXYZM(t0.px(), t0.py(), t0.pz(), o2::constants::physics::MassKaonCharged);
             v1.SetXYZM(t1.px(), t1.py(), t1.pz(), o2::constants::physics::MassKaonCharged);
@@ -477,7 +508,7 @@ struct SGResonanceAnalyzer {
               }
             }
           }
-          if (kstar && selectionPIDKaon(t0, use_tof, nsigmatpc_cut, nsigmatof_cut) && std::abs(t0.tpcNSigmaPi()) > 3.0 && selectionPIDPion(t1, use_tof, nsigmatpc_cut, nsigmatof_cut) && std::abs(t1.tpcNSigmaKa()) > 3.0) {
+          if (kstar && (mask(t0) & kKaonNotPion) && (mask(t1) & kPionNotKaon)) {
             // Apply kaon hypothesis and create pairs
             v0.SetXYZM(t0.px(), t0.py(), t0.pz(), o2::constants::physics::MassKaonCharged);
             v1.SetXYZM(t1.px(), t1.py(), t1.pz(), o2::constants::physics::MassPionCharged);
@@ -500,9 +531,9 @@ struct SGResonanceAnalyzer {
     }
 
     for (auto& [t0, t1] : combinations(tracks, tracks)) {
-      if (!trackselector(t0, parameters) || !trackselector(t1, parameters))
+      if (!(mask(t0) & mask(t1) & kSelected))
         continue;
-      if (phi && selectionPIDKaon(t0, use_tof, nsigmatpc_cut, nsigmatof_cut) && selectionPIDKaon(t1, use_tof, nsigmatpc_cut, nsigmatof_cut)) {
+      if (phi && (mask(t0) & mask(t1) & kKaon)) {
         // Apply kaon hypothesis and create pairs
         v0.SetXYZM(t0.px(), t0.py(), t0.pz(), o2::constants::physics::MassKaonCharged);
         v1.SetXYZM(t1.px(), t1.py(), t1.pz(), o2::constants::physics::MassKaonCharged);
@@ -532,7 +563,7 @@ struct SGResonanceAnalyzer {
           }
         }
       }
-      if (rho && selectionPIDPion(t0, use_tof, nsigmatpc_cut, nsigmatof_cut) && selectionPIDPion(t1, use_tof, nsigmatpc_cut, nsigmatof_cut)) {
+      if (rho && (mask(t0) & mask(t1) & kPion)) {
         v0.SetXYZM(t0.px(), t0.py(), t0.pz(), o2::constants::physics::MassPionCharged);
         v1.SetXYZM(t1.px(), t1.py(), t1.pz(), o2::constants::physics::MassPionCharged);
         v01 = v0 + v1;
@@ -560,7 +591,7 @@ struct SGResonanceAnalyzer {
           }
         }
       }
-      if (kstar && selectionPIDKaon(t0, use_tof, nsigmatpc_cut, nsigmatof_cut) && std::abs(t0.tpcNSigmaPi()) > 3.0 && selectionPIDPion(t1, use_tof, nsigmatpc_cut, nsigmatof_cut) && std::abs(t1.tpcNSigmaKa()) > 3.0) {
+      if (kstar && (mask(t0) & kKaonNotPion) && (mask(t1) & kPionNotKaon)) {
         v0.SetXYZM(t0.px(), t0.py(), t0.pz(), o2::constants::physics::MassKaonCharged);
         v1.SetXYZM(t1.px(), t1.py(), t1.pz(), o2::constants::physics::MassPionCharged);
         v01 = v0 + v1;
@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+
+# Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+# See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+# All rights not expressly granted are reserved.
+#
+# This software is distributed under the terms of the GNU General Public
+# License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+#
+# In applying this license CERN does not waive the privileges and immunities
+# granted to it by virtue of its status as an Intergovernmental Organization
+# or submit itself to any jurisdiction.
+
+"""!
+@brief  Benchmark the standard train of the Common producers (timestamp, event selection, multiplicity, centrality,
+        track propagation and selection, TPC and TOF PID, TOF event time, Q vectors) as one workflow.
+
+Each train runs on the given input AO2D files with the DPL resource monitoring enabled, and the script reports:
+- for the train: the wall time, the number of events (from the event-selection counter) and the events per second,
+- for each device: the CPU time, the events per CPU second, the peak resident set size and the CCDB fetch time,
+  read from the summary of the CCDB manager printed by the device at the end of the run.
+The results are written in JSON (-w) together with the version of O2Physics, so that they can be tracked across tags.
+When a reference is given, the script fails if the events per second of a device decrease, or its peak memory
+increases, by more than the allowed fraction.
+
+Trains (workflows, devices, event counter, pattern of the CCDB summary) are defined in a JSON file
+(benchmark_train.json by default). Inputs are given as label=file pairs (e.g. pp and Pb-Pb fixtures).
+The O2 configuration is given with -c, either for all the inputs or for one of them as label=file.
+
+Example:
+    benchmark_train.py -i pp=input_pp.txt -i PbPb=input_PbPb.txt -c pp=config_pp.json -c PbPb=config_PbPb.json \
+        -w results.json
+"""
+
+import argparse
+import datetime
+import json
+import os
+import re
+import subprocess as sp  # nosec B404
+import time
+
+from benchmark_vertexing import msg_fatal, read_counter, read_metrics
+
+FILE_METRICS = "performanceMetrics.json"
+FILE_RESULTS = "AnalysisResults.root"
+FILE_LOG = "stdout.log"
+
+
+def run_train(name: str, train: dict, label: str, path_input: str, path_config, setup: dict, args) -> dict:
+    """Run the workflows of a train on one input and return the measured values."""
+    dir_run = os.path.join(args.dir_out, f"{name}_{label}")
+    os.makedirs(dir_run, exist_ok=True)
+    options = f"-b --resources-monitoring {args.monitoring_interval} --aod-memory-rate-limit 2000000000"
+    options += f" --shm-segment-size {args.shm_segment_size}"
+    if path_config:
+        options += f" --configuration json://{os.path.abspath(path_config)}"
+    workflows = train["workflows"]
+    cmd = f"{workflows[0]} {options} --aod-file @{os.path.abspath(path_input)}"
+    for workflow in workflows[1:]:
+        cmd += f" | {workflow} {options}"
+    print(f"Running {name} on {label}")
+    path_log = os.path.join(dir_run, FILE_LOG)
+    with open(path_log, "w", encoding="utf-8") as file_log:
+        time_start = time.time()
+        result = sp.run(cmd, shell=True, cwd=dir_run, stdout=file_log, stderr=sp.STDOUT, check=False)  # nosec B602
+        time_wall = time.time() - time_start
+    if result.returncode != 0:
+        msg_fatal(f"{name} on {label} failed with exit code {result.returncode}, see {path_log}")
+
+    counter = setup["events"]
+    events = read_counter(os.path.join(dir_run, FILE_RESULTS), counter["device"], counter)
+    ccdb_times = read_ccdb_times(path_log, setup["ccdb"]["pattern"])
+    devices = {}
+    for device in train["devices"]:
+        cpu_time, peak_rss = read_metrics(os.path.join(dir_run, FILE_METRICS), device, setup["metrics"])
+        devices[device] = {
+            "cpu_time": cpu_time,
+            "events_per_s": events / cpu_time if events and cpu_time > 0 else None,
+            "peak_rss": peak_rss,
+            "ccdb_time": ccdb_times.get(device),
+        }
+    return {
+        "wall_time": time_wall,
+        "events": events,
+        "events_per_s": events / time_wall if events and time_wall > 0 else None,
+        "cpu_time": sum(values["cpu_time"] for values in devices.values()),
+        "peak_rss": sum(values["peak_rss"] for values in devices.values()),
+        "devices": devices,
+    }
+
+
+def read_ccdb_times(path: str, pattern: str) -> dict:
+    """Return the CCDB fetch time (s) of each device, summed over the CCDB summaries printed in the log."""
+    regex = re.compile(pattern)
+    times = {}
+    with open(path, encoding="utf-8", errors="replace") as file_log:
+        for line in file_log:
+            match = regex.search(line)
+            if match:
+                device = match.group("device")
+                times[device] = times.get(device, 0.0) + float(match.group("ms")) / 1000.0
+    return times
+
+
+def compare(results: dict, reference: dict, threshold: float) -> list:
+    """Return the list of regressions of the devices with respect to the reference."""
+    regressions = []
+    for key, values in results["trains"].items():
+        if key not in reference.get("trains", {}):
+            print(f"Warning: {key} not in the reference")
+            continue
+        devices_ref = reference["trains"][key]["devices"]
+        for device, dev in values["devices"].items():
+            if device not in devices_ref:
+                print(f"Warning: {key}/{device} not in the reference")
+                continue
+            ref = devices_ref[device]
+            rate, rate_ref = dev["events_per_s"], ref.get("events_per_s")
+            if rate and rate_ref and rate < (1.0 - threshold) * rate_ref:
+                regressions.append(f"{key}/{device}: events_per_s {rate:.4g} < {rate_ref:.4g}")
+            if dev["peak_rss"] and ref.get("peak_rss") and dev["peak_rss"] > (1.0 + threshold) * ref["peak_rss"]:
+                regressions.append(f"{key}/{device}: peak_rss {dev['peak_rss']:.4g} > {ref['peak_rss']:.4g}")
+    return regressions
+
+
+def print_results(results: dict):
+    """Print a table of the results of each train."""
+
+    def fmt(value):
+        return "n/a" if value is None else f"{value:.4g}"
+
+    for key, values in results["trains"].items():
+        print(
+            f"\n{key}: {fmt(values['events'])} events in {fmt(values['wall_time'])} s, "
+            f"{fmt(values['events_per_s'])} events/s"
+        )
+        print(f"{'device':30} {'cpu (s)':>10} {'events/s':>10} {'peak RSS':>10} {'ccdb (s)':>10}")
+        for device, dev in values["devices"].items():
+            print(
+                f"{device:30} {fmt(dev['cpu_time']):>10} {fmt(dev['events_per_s']):>10} "
+                f"{fmt(dev['peak_rss']):>10} {fmt(dev['ccdb_time']):>10}"
+            )
+
+
+def main():
+    """Main function"""
+    dir_this = os.path.dirname(os.path.realpath(__file__))
+    parser = argparse.ArgumentParser(description="Benchmark the standard train of the Common producers.")
+    parser.add_argument(
+        "-i", dest="inputs", type=str, nargs=1, action="append", required=True, help="label=text file with AO2D paths"
+    )
+    parser.add_argument("-t", dest="trains", type=str, nargs="*", help="trains to run (default: all)")
+    parser.add_argument("-s", dest="setup", type=str, default=os.path.join(dir_this, "benchmark_train.json"))
+    parser.add_argument(
+        "-c", dest="dpl_configs", type=str, nargs=1, action="append", help="O2 configuration file, or label=file"
+    )
+    parser.add_argument("-r", dest="reference", type=str, help="reference results to compare with")
+    parser.add_argument("-w", dest="write", type=str, help="output file for the results (e.g. new reference)")
+    parser.add_argument("--threshold", type=float, default=0.1, help="allowed relative regression")
+    parser.add_argument("--tag", type=str, default=os.environ.get("O2PHYSICS_VERSION"), help="version of the results")
+    parser.add_argument("-o", dest="dir_out", type=str, default="benchmark_train", help="working directory")
+    parser.add_argument("--monitoring-interval", type=int, default=1, help="resource monitoring interval (s)")
+    parser.add_argument("--shm-segment-size", type=int, default=16000000000)
+    args = parser.parse_args()
+
+    with open(args.setup, encoding="utf-8") as file_setup:
+        setup = json.load(file_setup)
+    trains = setup["trains"]
+    names = args.trains if args.trains else list(trains)
+    for name in names:
+        if name not in trains:
+            msg_fatal(f"Unknown train {name}, available: {', '.join(trains)}")
+
+    configs = {}
+    for (item,) in args.dpl_configs or []:
+        label, path_config = item.split("=", 1) if "=" in item else ("", item)
+        configs[label] = path_config
+
+    results = {"tag": args.tag, "date": datetime.datetime.now().isoformat(timespec="seconds"), "trains": {}}
+    for (item,) in args.inputs:
+        if "=" not in item:
+            msg_fatal(f"Input {item} is not of the form label=file")
+        label, path_input = item.split("=", 1)
+        path_config = configs.get(label, configs.get(""))
+        for name in names:
+            results["trains"][f"{name}/{label}"] = run_train(
+                name, trains[name], label, path_input, path_config, setup, args
+            )
+
+    print_results(results)
+    if args.write:
+        with open(args.write, "w", encoding="utf-8") as file_out:
+            json.dump(results, file_out, indent=2)
+    if args.reference:
+        with open(args.reference, encoding="utf-8") as file_ref:
+            reference = json.load(file_ref)
+        regressions = compare(results, reference, args.threshold)
+        if regressions:
+            print("\n".join(regressions))
+            msg_fatal(f"{len(regressions)} regression(s) beyond {args.threshold:.0%}")
+        print(f"No regression beyond {args.threshold:.0%}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,203 @@
+#!/usr/bin/env python3
+
+# Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+# See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+# All rights not expressly granted are reserved.
+#
+# This software is distributed under the terms of the GNU General Public
+# License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+#
+# In applying this license CERN does not waive the privileges and immunities
+# granted to it by virtue of its status as an Intergovernmental Organization
+# or submit itself to any jurisdiction.
+
+"""!
+@brief  Benchmark the vertexing builders (HF track-index skims and candidate creators, LF V0 and cascade builders).
+
+Each benchmark runs one builder with its minimal set of dependencies on the given input AO2D files
+with the DPL resource monitoring enabled, and reports for the builder device:
+- the CPU time, integrated from the CPU usage samples of the resource monitoring,
+- the number of candidates and of fitter calls, read from the counters histogrammed by the builder,
+- the candidates and fitter calls per CPU second,
+- the peak resident set size.
+The measured values can be saved as a reference. When a reference is given, the script fails
+if the throughput decreases, or the peak memory increases, by more than the allowed fraction.
+
+Benchmarks (workflows, builder device, counters) are defined in a JSON file (benchmark_vertexing.json by default).
+Inputs are given as label=file pairs, so that the same benchmarks can be run on several datasets (e.g. pp and Pb-Pb).
+The O2 configuration (selections, fillHistograms of the skim creator, ...) is passed with --dpl-config.
+
+Example:
+    benchmark_vertexing.py -i pp=input_pp.txt -i PbPb=input_PbPb.txt -c dpl-config.json -r reference.json
+"""
+
+import argparse
+import json
+import os
+import subprocess as sp  # nosec B404
+import sys
+import time
+
+FILE_METRICS = "performanceMetrics.json"
+FILE_RESULTS = "AnalysisResults.root"
+
+
+def msg_fatal(message: str):
+    """Print an error message and exit."""
+    print(f"\x1b[1;31mFatal: {message}\x1b[0m")
+    sys.exit(1)
+
+
+def run_benchmark(name: str, benchmark: dict, label: str, path_input: str, args, dir_out: str) -> dict:
+    """Run the workflows of a benchmark on one input and return the measured values."""
+    dir_run = os.path.join(dir_out, f"{name}_{label}")
+    os.makedirs(dir_run, exist_ok=True)
+    options = f"-b --resources-monitoring {args.monitoring_interval} --aod-memory-rate-limit 2000000000"
+    options += f" --shm-segment-size {args.shm_segment_size}"
+    if args.dpl_config:
+        options += f" --configuration json://{os.path.abspath(args.dpl_config)}"
+    workflows = benchmark["workflows"]
+    cmd = f"{workflows[0]} {options} --aod-file @{os.path.abspath(path_input)}"
+    for workflow in workflows[1:]:
+        cmd += f" | {workflow} {options}"
+    print(f"Running {name} on {label}")
+    with open(os.path.join(dir_run, "stdout.log"), "w", encoding="utf-8") as file_log:
+        time_start = time.time()
+        result = sp.run(cmd, shell=True, cwd=dir_run, stdout=file_log, stderr=sp.STDOUT, check=False)  # nosec B602
+        time_wall = time.time() - time_start
+    if result.returncode != 0:
+        msg_fatal(f"{name} on {label} failed with exit code {result.returncode}, see {dir_run}/stdout.log")
+
+    cpu_time, peak_rss = read_metrics(os.path.join(dir_run, FILE_METRICS), benchmark["device"], args.metrics)
+    path_results = os.path.join(dir_run, FILE_RESULTS)
+    candidates = read_counter(path_results, benchmark["device"], benchmark.get("candidates"))
+    fitter_calls = read_counter(path_results, benchmark["device"], benchmark.get("fitter_calls"))
+    values = {"wall_time": time_wall, "cpu_time": cpu_time, "peak_rss": peak_rss}
+    values["candidates"] = candidates
+    values["fitter_calls"] = fitter_calls
+    values["candidates_per_s"] = candidates / cpu_time if candidates is not None and cpu_time > 0 else None
+    values["fitter_calls_per_s"] = fitter_calls / cpu_time if fitter_calls is not None and cpu_time > 0 else None
+    return values
+
+
+def read_metrics(path: str, device: str, metrics: dict):
+    """Return the CPU time (s) and the peak resident set size of a device from the DPL performance metrics."""
+    if not os.path.isfile(path):
+        msg_fatal(f"{path} not found, did the resource monitoring run?")
+    with open(path, encoding="utf-8") as file_metrics:
+        metrics_all = json.load(file_metrics)
+    if device not in metrics_all:
+        msg_fatal(f"Device {device} not found in {path}")
+    metrics_device = metrics_all[device]
+    # CPU time: CPU usage fraction integrated over the sampling intervals (timestamps in ms)
+    cpu_time = 0.0
+    samples = metrics_device.get(metrics["cpu"], [])
+    for sample_prev, sample in zip(samples, samples[1:]):
+        cpu_time += float(sample["value"]) * (float(sample["timestamp"]) - float(sample_prev["timestamp"])) / 1000.0
+    peak_rss = max((float(sample["value"]) for sample in metrics_device.get(metrics["rss"], [])), default=0.0)
+    return cpu_time, peak_rss
+
+
+def read_counter(path: str, device: str, counter):
+    """Return the sum of the given bins (or of the entries) of the counter histograms of a device."""
+    if not counter:
+        return None
+    import ROOT  # pylint: disable=import-outside-toplevel, import-error
+
+    file_results = ROOT.TFile.Open(path)
+    if not file_results or file_results.IsZombie():
+        msg_fatal(f"Cannot open {path}")
+    total = 0.0
+    for name_histo in counter["histograms"]:
+        histo = file_results.Get(f"{device}/{name_histo}")
+        if not histo:
+            msg_fatal(f"Histogram {device}/{name_histo} not found in {path}")
+        if "bins" in counter:
+            total += sum(histo.GetBinContent(i_bin) for i_bin in counter["bins"])
+        else:
+            total += histo.GetEntries()
+    file_results.Close()
+    return total
+
+
+def compare(results: dict, reference: dict, threshold: float) -> list:
+    """Return the list of regressions of the results with respect to the reference."""
+    regressions = []
+    for key, values in results.items():
+        if key not in reference:
+            print(f"Warning: {key} not in the reference")
+            continue
+        ref = reference[key]
+        for var in ("candidates_per_s", "fitter_calls_per_s"):
+            if values.get(var) and ref.get(var) and values[var] < (1.0 - threshold) * ref[var]:
+                regressions.append(f"{key}: {var} {values[var]:.4g} < {ref[var]:.4g}")
+        if values.get("peak_rss") and ref.get("peak_rss") and values["peak_rss"] > (1.0 + threshold) * ref["peak_rss"]:
+            regressions.append(f"{key}: peak_rss {values['peak_rss']:.4g} > {ref['peak_rss']:.4g}")
+    return regressions
+
+
+def print_results(results: dict):
+    """Print a table of the results."""
+
+    def fmt(value):
+        return "n/a" if value is None else f"{value:.4g}"
+
+    print(f"{'benchmark':40} {'cpu (s)':>10} {'cands':>10} {'cands/s':>10} {'fits/s':>10} {'peak RSS':>10}")
+    for key, values in results.items():
+        print(
+            f"{key:40} {fmt(values['cpu_time']):>10} {fmt(values['candidates']):>10} "
+            f"{fmt(values['candidates_per_s']):>10} {fmt(values['fitter_calls_per_s']):>10} {fmt(values['peak_rss']):>10}"
+        )
+
+
+def main():
+    """Main function"""
+    dir_this = os.path.dirname(os.path.realpath(__file__))
+    parser = argparse.ArgumentParser(description="Benchmark the vertexing builders of HF and LF.")
+    parser.add_argument(
+        "-i", dest="inputs", type=str, nargs=1, action="append", required=True, help="label=text file with AO2D paths"
+    )
+    parser.add_argument("-b", dest="benchmarks", type=str, nargs="*", help="benchmarks to run (default: all)")
+    parser.add_argument("-s", dest="setup", type=str, default=os.path.join(dir_this, "benchmark_vertexing.json"))
+    parser.add_argument("-c", dest="dpl_config", type=str, help="O2 configuration file")
+    parser.add_argument("-r", dest="reference", type=str, help="reference results to compare with")
+    parser.add_argument("-w", dest="write", type=str, help="output file for the results (e.g. new reference)")
+    parser.add_argument("-t", dest="threshold", type=float, default=0.1, help="allowed relative regression")
+    parser.add_argument("-o", dest="dir_out", type=str, default="benchmark_vertexing", help="working directory")
+    parser.add_argument("--monitoring-interval", type=int, default=1, help="resource monitoring interval (s)")
+    parser.add_argument("--shm-segment-size", type=int, default=16000000000)
+    args = parser.parse_args()
+
+    with open(args.setup, encoding="utf-8") as file_setup:
+        setup = json.load(file_setup)
+    args.metrics = setup["metrics"]
+    benchmarks = setup["benchmarks"]
+    names = args.benchmarks if args.benchmarks else list(benchmarks)
+    for name in names:
+        if name not in benchmarks:
+            msg_fatal(f"Unknown benchmark {name}, available: {', '.join(benchmarks)}")
+
+    results = {}
+    for (item,) in args.inputs:
+        if "=" not in item:
+            msg_fatal(f"Input {item} is not of the form label=file")
+        label, path_input = item.split("=", 1)
+        for name in names:
+            results[f"{name}/{label}"] = run_benchmark(name, benchmarks[name], label, path_input, args, args.dir_out)
+
+    print_results(results)
+    if args.write:
+        with open(args.write, "w", encoding="utf-8") as file_out:
+            json.dump(results, file_out, indent=2)
+    if args.reference:
+        with open(args.reference, encoding="utf-8") as file_ref:
+            reference = json.load(file_ref)
+        regressions = compare(results, reference, args.threshold)
+        if regressions:
+            print("\n".join(regressions))
+            msg_fatal(f"{len(regressions)} regression(s) beyond {args.threshold:.0%}")
+        print(f"No regression beyond {args.threshold:.0%}")
+
+
+if __name__ == "__main__":
+    main()
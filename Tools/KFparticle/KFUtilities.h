@@ -23,6 +23,10 @@
 
 #include <TDatabasePDG.h> // FIXME
 
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
 #include "KFParticle.h"
 #include "KFPTrack.h"
 #include "KFPVertex.h"
@@ -39,7 +43,7 @@
 /// @param collision Collision from aod::Collisions, aod::Mults
 /// @return
 template <typename T>
-KFPVertex createKFPVertexFromCollision(const T& collision)
+inline KFPVertex createKFPVertexFromCollision(const T& collision)
 {
   KFPVertex kfpVertex;
   kfpVertex.SetXYZ(collision.posX(), collision.posY(), collision.posZ());
@@ -53,7 +57,7 @@ KFPVertex createKFPVertexFromCollision(const T& collision)
 /// @brief Function to create a KFPTrack from o2::track::TrackParametrizationWithError tracks. The Covariance matrix is needed.
 /// @param track Track from o2::track::TrackParametrizationWithError
 /// @return KFPTrack
-KFPTrack createKFPTrack(const o2::track::TrackParametrizationWithError<float>& trackparCov,
+inline KFPTrack createKFPTrack(const o2::track::TrackParametrizationWithError<float>& trackparCov,
                         int16_t trackSign,
                         int16_t tpcNClsFound,
                         float tpcChi2NCl)
@@ -84,7 +88,7 @@ KFPTrack createKFPTrack(const o2::track::TrackParametrizationWithError<float>& t
 /// @param track Track from aod::Tracks, aod::TracksExtra, aod::TracksCov
 /// @return KFPTrack
 template <typename T>
-KFPTrack createKFPTrackFromTrack(const T& track)
+inline KFPTrack createKFPTrackFromTrack(const T& track)
 {
   o2::track::TrackParametrizationWithError trackparCov;
   trackparCov = getTrackParCov(track);
@@ -96,7 +100,7 @@ KFPTrack createKFPTrackFromTrack(const T& track)
 /// @brief Function to create a KFPTrack from o2::track::TrackParametrizationWithError tracks. The Covariance matrix is needed.
 /// @param track Track from o2::track::TrackParametrizationWithError
 /// @return KFPTrack
-KFPTrack createKFPTrackFromTrackParCov(const o2::track::TrackParametrizationWithError<float>& trackparCov,
+inline KFPTrack createKFPTrackFromTrackParCov(const o2::track::TrackParametrizationWithError<float>& trackparCov,
                                        int16_t trackSign,
                                        int16_t tpcNClsFound,
                                        float tpcChi2NCl)
@@ -105,11 +109,52 @@ KFPTrack createKFPTrackFromTrackParCov(const o2::track::TrackParametrizationWith
   return kfpTrack;
 }
 
+/// @brief KFPTracks of all the tracks of a table (e.g. the tracks of a collision), converted once before
+/// the loop over the track combinations instead of once per combination
+class KFPTrackCache
+{
+ public:
+  /// @brief Converts the tracks of the table, the memory is reused between the calls
+  /// @tparam T
+  /// @param tracks Tracks from aod::Tracks, aod::TracksExtra, aod::TracksCov, can be filtered or grouped
+  template <typename T>
+  void fill(const T& tracks)
+  {
+    mFirst = 0;
+    mKFPTracks.clear();
+    if (tracks.size() == 0) {
+      return;
+    }
+    int64_t first = tracks.begin().globalIndex();
+    int64_t last = first;
+    for (const auto& track : tracks) {
+      first = std::min<int64_t>(first, track.globalIndex());
+      last = std::max<int64_t>(last, track.globalIndex());
+    }
+    mFirst = first;
+    mKFPTracks.resize(last - first + 1);
+    for (const auto& track : tracks) {
+      mKFPTracks[track.globalIndex() - mFirst] = createKFPTrackFromTrack(track);
+    }
+  }
+
+  /// @brief KFPTrack of a track of the table given to fill()
+  template <typename T>
+  const KFPTrack& get(const T& track) const
+  {
+    return mKFPTracks[track.globalIndex() - mFirst];
+  }
+
+ private:
+  int64_t mFirst = 0;               // global index of the first track
+  std::vector<KFPTrack> mKFPTracks; // indexed by the global index - mFirst
+};
+
 /// @brief Cosine of pointing angle from KFParticles
 /// @param kfp KFParticle
 /// @param PV KFParticle primary vertex
 /// @return cpa
-float cpaFromKF(KFParticle kfp, KFParticle PV)
+inline float cpaFromKF(const KFParticle& kfp, const KFParticle& PV)
 {
   float xVtxP, yVtxP, zVtxP, xVtxS, yVtxS, zVtxS, px, py, pz = 0.;
 
@@ -133,7 +178,7 @@ float cpaFromKF(KFParticle kfp, KFParticle PV)
 /// @param kfp KFParticle
 /// @param PV KFParticle primary vertex
 /// @return cpa in xy
-float cpaXYFromKF(KFParticle kfp, KFParticle PV)
+inline float cpaXYFromKF(const KFParticle& kfp, const KFParticle& PV)
 {
   float xVtxP, yVtxP, xVtxS, yVtxS, px, py = 0.;
 
@@ -159,7 +204,7 @@ float cpaXYFromKF(KFParticle kfp, KFParticle PV)
 /// @param kfpprong0 KFParticle Prong 0
 /// @param kfpprong1 KFParticele Prong 1
 /// @return cos theta star
-float cosThetaStarFromKF(int ip, int pdgvtx, int pdgprong0, int pdgprong1, KFParticle kfpprong0, KFParticle kfpprong1)
+inline float cosThetaStarFromKF(int ip, int pdgvtx, int pdgprong0, int pdgprong1, const KFParticle& kfpprong0, const KFParticle& kfpprong1)
 {
   float px0, py0, pz0, px1, py1, pz1 = 0.;
 
@@ -186,7 +231,7 @@ float cosThetaStarFromKF(int ip, int pdgvtx, int pdgprong0, int pdgprong1, KFPar
 /// @param kfpParticle KFParticle
 /// @param Vertex KFParticle vertex
 /// @return impact parameter
-float impParXYFromKF(KFParticle kfpParticle, KFParticle Vertex)
+inline float impParXYFromKF(const KFParticle& kfpParticle, const KFParticle& Vertex)
 {
   float xVtxP, yVtxP, zVtxP, xVtxS, yVtxS, zVtxS, px, py, pz = 0.;
 
@@ -210,7 +255,7 @@ float impParXYFromKF(KFParticle kfpParticle, KFParticle Vertex)
 /// @param kfpParticle KFParticle
 /// @param PV KFParticle primary vertex
 /// @return l/delta l
-float ldlFromKF(KFParticle kfpParticle, KFParticle PV)
+inline float ldlFromKF(const KFParticle& kfpParticle, const KFParticle& PV)
 {
   float dx_particle = PV.GetX() - kfpParticle.GetX();
   float dy_particle = PV.GetY() - kfpParticle.GetY();
@@ -229,7 +274,7 @@ float ldlFromKF(KFParticle kfpParticle, KFParticle PV)
 /// @param kfpParticle KFParticle
 /// @param PV KFParticle primary vertex
 /// @return l/delta l in xy plane
-float ldlXYFromKF(KFParticle kfpParticle, KFParticle PV)
+inline float ldlXYFromKF(const KFParticle& kfpParticle, const KFParticle& PV)
 {
   float dx_particle = PV.GetX() - kfpParticle.GetX();
   float dy_particle = PV.GetY() - kfpParticle.GetY();
@@ -76,6 +76,7 @@ struct qaKFParticle {
   int runNumber;
   double magneticField = 0.;
   int PVContributor = 0;
+  KFPTrackCache kfpTrackCache; // KFPTracks of the tracks of the collision
 
   /// Histogram Configurables
   ConfigurableAxis binsPt{"binsPt", {VARIABLE_WIDTH, 0.0, 1., 2., 3., 4., 5., 6., 7., 8., 9., 10., 11., 12., 13., 14., 15., 16., 17., 24., 36., 50.0}, ""};
@@ -665,6 +666,7 @@ struct qaKFParticle {
     /// set KF primary vertex
     KFPVertex kfpVertex = createKFPVertexFromCollision(collision);
     KFParticle KFPV(kfpVertex);
+    kfpTrackCache.fill(tracks);
     for (auto& [track1, track2] : combinations(soa::CombinationsStrictlyUpperIndexPolicy(tracks, tracks))) {
 
       histos.fill(HIST("DZeroCandTopo/Selections"), 3.f);
@@ -715,8 +717,8 @@ struct qaKFParticle {
         if (track1.sign() == 1 && track2.sign() == -1) {
           CandD0 = true;
           source = 1;
-          kfpTrackPosPi = createKFPTrackFromTrack(track1);
-          kfpTrackNegKa = createKFPTrackFromTrack(track2);
+          kfpTrackPosPi = kfpTrackCache.get(track1);
+          kfpTrackNegKa = kfpTrackCache.get(track2);
           TPCnSigmaPosPi = track1.tpcNSigmaPi();
           TPCnSigmaNegKa = track2.tpcNSigmaKa();
           TOFnSigmaPosPi = track1.tofNSigmaPi();
@@ -726,8 +728,8 @@ struct qaKFParticle {
         } else if (track1.sign() == -1 && track2.sign() == 1) {
           CandD0bar = true;
           source = 2;
-          kfpTrackNegPi = createKFPTrackFromTrack(track1);
-          kfpTrackPosKa = createKFPTrackFromTrack(track2);
+          kfpTrackNegPi = kfpTrackCache.get(track1);
+          kfpTrackPosKa = kfpTrackCache.get(track2);
           TPCnSigmaNegPi = track1.tpcNSigmaPi();
           TPCnSigmaPosKa = track2.tpcNSigmaKa();
           TOFnSigmaNegPi = track1.tofNSigmaPi();
@@ -745,8 +747,8 @@ struct qaKFParticle {
           if (CandD0 == true) {
             source = 3;
           }
-          kfpTrackNegPi = createKFPTrackFromTrack(track2);
-          kfpTrackPosKa = createKFPTrackFromTrack(track1);
+          kfpTrackNegPi = kfpTrackCache.get(track2);
+          kfpTrackPosKa = kfpTrackCache.get(track1);
           TPCnSigmaNegPi = track2.tpcNSigmaPi();
           TPCnSigmaPosKa = track1.tpcNSigmaKa();
           TOFnSigmaNegPi = track2.tofNSigmaPi();
@@ -759,8 +761,8 @@ struct qaKFParticle {
           if (CandD0bar == true) {
             source = 3;
           }
-          kfpTrackPosPi = createKFPTrackFromTrack(track2);
-          kfpTrackNegKa = createKFPTrackFromTrack(track1);
+          kfpTrackPosPi = kfpTrackCache.get(track2);
+          kfpTrackNegKa = kfpTrackCache.get(track1);
           TPCnSigmaPosPi = track2.tpcNSigmaPi();
           TPCnSigmaNegKa = track1.tpcNSigmaKa();
           TOFnSigmaPosPi = track2.tofNSigmaPi();
@@ -886,6 +888,7 @@ struct qaKFParticle {
     KFPVertex kfpVertexDefault = createKFPVertexFromCollision(collision);
     KFParticle KFPVDefault(kfpVertexDefault);
 
+    kfpTrackCache.fill(tracks);
     for (auto& [track1, track2] : combinations(soa::CombinationsStrictlyUpperIndexPolicy(tracks, tracks))) {
 
       histos.fill(HIST("DZeroCandTopo/Selections"), 3.f);
@@ -1022,8 +1025,8 @@ struct qaKFParticle {
           if (pdgMother == -421) {
             sourceD0 |= kReflection;
           }
-          kfpTrackPosPi = createKFPTrackFromTrack(track1);
-          kfpTrackNegKa = createKFPTrackFromTrack(track2);
+          kfpTrackPosPi = kfpTrackCache.get(track1);
+          kfpTrackNegKa = kfpTrackCache.get(track2);
           TPCnSigmaPosPi = track1.tpcNSigmaPi();
           TPCnSigmaNegKa = track2.tpcNSigmaKa();
           TOFnSigmaPosPi = track1.tofNSigmaPi();
@@ -1035,8 +1038,8 @@ struct qaKFParticle {
           if (pdgMother == 421) {
             sourceD0Bar |= kReflection;
           }
-          kfpTrackNegPi = createKFPTrackFromTrack(track1);
-          kfpTrackPosKa = createKFPTrackFromTrack(track2);
+          kfpTrackNegPi = kfpTrackCache.get(track1);
+          kfpTrackPosKa = kfpTrackCache.get(track2);
           TPCnSigmaNegPi = track1.tpcNSigmaPi();
           TPCnSigmaPosKa = track2.tpcNSigmaKa();
           TOFnSigmaNegPi = track1.tofNSigmaPi();
@@ -1053,8 +1056,8 @@ struct qaKFParticle {
           if (pdgMother == 421) {
             sourceD0Bar |= kReflection;
           }
-          kfpTrackNegPi = createKFPTrackFromTrack(track2);
-          kfpTrackPosKa = createKFPTrackFromTrack(track1);
+          kfpTrackNegPi = kfpTrackCache.get(track2);
+          kfpTrackPosKa = kfpTrackCache.get(track1);
           TPCnSigmaNegPi = track2.tpcNSigmaPi();
           TPCnSigmaPosKa = track1.tpcNSigmaKa();
           TOFnSigmaNegPi = track2.tofNSigmaPi();
@@ -1066,8 +1069,8 @@ struct qaKFParticle {
           if (pdgMother == -421) {
             sourceD0 |= kReflection;
           }
-          kfpTrackPosPi = createKFPTrackFromTrack(track2);
-          kfpTrackNegKa = createKFPTrackFromTrack(track1);
+          kfpTrackPosPi = kfpTrackCache.get(track2);
+          kfpTrackNegKa = kfpTrackCache.get(track1);
           TPCnSigmaPosPi = track2.tpcNSigmaPi();
           TPCnSigmaNegKa = track1.tpcNSigmaKa();
           TOFnSigmaPosPi = track2.tofNSigmaPi();
@@ -23,6 +23,7 @@
 #include <onnxruntime_cxx_api.h>
 #endif
 
+#include <algorithm>
 #include <map>
 #include <string>
 #include <vector>
@@ -162,20 +163,7 @@ class MlResponse
   {
     int nModel = findBin(candVar);
     auto output = getModelOutput(input, nModel);
-    uint8_t iClass{0};
-    for (const auto& outputValue : output) {
-      uint8_t dir = mCutDir.at(iClass);
-      if (dir != o2::cuts_ml::CutDirection::CutNot) {
-        if (dir == o2::cuts_ml::CutDirection::CutGreater && outputValue > mCuts.get(nModel, iClass)) {
-          return false;
-        }
-        if (dir == o2::cuts_ml::CutDirection::CutSmaller && outputValue < mCuts.get(nModel, iClass)) {
-          return false;
-        }
-      }
-      ++iClass;
-    }
-    return true;
+    return passCuts(output.data(), nModel);
   }
 
   /// ML selections
@@ -188,20 +176,80 @@ class MlResponse
   {
     int nModel = findBin(candVar);
     output = getModelOutput(input, nModel);
-    uint8_t iClass{0};
-    for (const auto& outputValue : output) {
-      uint8_t dir = mCutDir.at(iClass);
-      if (dir != o2::cuts_ml::CutDirection::CutNot) {
-        if (dir == o2::cuts_ml::CutDirection::CutGreater && outputValue > mCuts.get(nModel, iClass)) {
-          return false;
-        }
-        if (dir == o2::cuts_ml::CutDirection::CutSmaller && outputValue < mCuts.get(nModel, iClass)) {
-          return false;
-        }
-      }
-      ++iClass;
+    return passCuts(output.data(), nModel);
+  }
+
+  /// Set the maximum number of candidates evaluated in a single model call in batch mode
+  /// \param maxBatchSize is the maximum batch size, the candidates of a bin are evaluated as soon as it is reached
+  void setMaxBatchSize(std::size_t maxBatchSize)
+  {
+    mMaxBatchSize = std::max<std::size_t>(maxBatchSize, 1);
+  }
+
+  /// Add a candidate to the batch of the model selected by candVar, to be evaluated by evaluateBatch()
+  /// \param input a vector containing the values of features used in the model
+  /// \param candVar is the variable value (e.g. pT) used to select which model to use
+  /// \return index of the candidate in the batch, -1 if candVar is outside the model bins
+  template <typename T1, typename T2>
+  int addToBatch(const T1& input, const T2& candVar)
+  {
+    int nModel = findBin(candVar);
+    if (nModel < 0) {
+      return -1;
+    }
+    if (mBatchInputs.size() != mModels.size()) {
+      mBatchInputs.resize(mModels.size());
+      mBatchCandidates.resize(mModels.size());
+    }
+    int iCand = mBatchModel.size();
+    mBatchModel.push_back(nModel);
+    mBatchScores.resize(mBatchScores.size() + mNClasses);
+    mBatchInputs[nModel].insert(mBatchInputs[nModel].end(), std::begin(input), std::end(input));
+    mBatchCandidates[nModel].push_back(iCand);
+    if (mBatchCandidates[nModel].size() >= maxBatchSize(nModel)) {
+      evaluateBatch(nModel);
+    }
+    return iCand;
+  }
+
+  /// Evaluate all the candidates added to the batch, with one model call per bin
+  void evaluateBatch()
+  {
+    for (std::size_t iModel = 0; iModel < mBatchCandidates.size(); ++iModel) {
+      evaluateBatch(iModel);
+    }
+  }
+
+  /// Get the model predictions of a candidate of the batch, available after evaluateBatch()
+  /// \param iCand is the index returned by addToBatch()
+  /// \return pointer to the scores of the mNClasses classes
+  const TypeOutputScore* getBatchOutput(int iCand) const
+  {
+    return mBatchScores.data() + static_cast<std::size_t>(iCand) * mNClasses;
+  }
+
+  /// ML selections for a candidate of the batch, available after evaluateBatch()
+  /// \param iCand is the index returned by addToBatch()
+  /// \return boolean telling if model predictions pass the cuts
+  bool isSelectedMlBatch(int iCand) const
+  {
+    if (iCand < 0) {
+      return false;
+    }
+    return passCuts(getBatchOutput(iCand), mBatchModel[iCand]);
+  }
+
+  /// Remove all the candidates from the batch, keeping the allocated buffers
+  void clearBatch()
+  {
+    mBatchModel.clear();
+    mBatchScores.clear();
+    for (auto& inputs : mBatchInputs) {
+      inputs.clear();
+    }
+    for (auto& candidates : mBatchCandidates) {
+      candidates.clear();
     }
-    return true;
   }
 
  protected:
@@ -215,6 +263,14 @@ class MlResponse
   std::map<std::string, uint8_t> mAvailableInputFeatures; // map of available input features
   std::vector<uint8_t> mCachedIndices;                    // vector of index correspondance between configurables and available input features
 
+  // batch mode
+  std::size_t mMaxBatchSize = 1000;                       // maximum number of candidates evaluated in one model call
+  std::vector<std::vector<TypeOutputScore>> mBatchInputs; // pending input features, one buffer for each bin
+  std::vector<std::vector<int>> mBatchCandidates;         // batch indices of the pending candidates, one buffer for each bin
+  std::vector<int> mBatchModel;                           // model index of each candidate in the batch
+  std::vector<TypeOutputScore> mBatchScores;              // model predictions of the candidates in the batch
+  std::vector<TypeOutputScore> mBatchOutput;              // buffer for the output of one model call
+
   virtual void setAvailableInputFeatures() { return; } // method to fill the map of available input features
 
  private:
@@ -222,6 +278,62 @@ class MlResponse
   /// \param value e.g. pT
   /// \return index of the matching bin, used to access mModels
   /// \note Accounts for the offset due to mBinsLimits storing bin limits (same convention as needed to configure a histogram axis)
+  bool passCuts(const TypeOutputScore* output, int nModel) const
+  {
+    for (uint8_t iClass{0}; iClass < mNClasses; ++iClass) {
+      uint8_t dir = mCutDir.at(iClass);
+      if (dir != o2::cuts_ml::CutDirection::CutNot) {
+        if (dir == o2::cuts_ml::CutDirection::CutGreater && output[iClass] > mCuts.get(nModel, iClass)) {
+          return false;
+        }
+        if (dir == o2::cuts_ml::CutDirection::CutSmaller && output[iClass] < mCuts.get(nModel, iClass)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  /// Maximum number of candidates per call for a given model, limited by a fixed batch dimension of the model input
+  std::size_t maxBatchSize(int nModel) const
+  {
+    int64_t modelBatchSize = mModels[nModel].getInputBatchSize();
+    if (modelBatchSize > 0) {
+      return std::min<std::size_t>(mMaxBatchSize, modelBatchSize);
+    }
+    return mMaxBatchSize;
+  }
+
+  /// Evaluate the pending candidates of one bin
+  void evaluateBatch(int nModel)
+  {
+    std::vector<TypeOutputScore>& inputs = mBatchInputs[nModel];
+    std::vector<int>& candidates = mBatchCandidates[nModel];
+    if (candidates.empty()) {
+      return;
+    }
+    std::size_t nFeatures = inputs.size() / candidates.size();
+    std::size_t chunkSize = maxBatchSize(nModel);
+    for (std::size_t first = 0; first < candidates.size(); first += chunkSize) {
+      std::size_t nCands = std::min(chunkSize, candidates.size() - first);
+      std::vector<TypeOutputScore> chunk;
+      std::vector<TypeOutputScore>* chunkInputs = &inputs;
+      if (nCands != candidates.size()) {
+        chunk.assign(inputs.begin() + first * nFeatures, inputs.begin() + (first + nCands) * nFeatures);
+        chunkInputs = &chunk;
+      }
+      if (!mModels[nModel].evalModelBatch(*chunkInputs, mBatchOutput) || mBatchOutput.size() < nCands * mNClasses) {
+        LOG(fatal) << "Batched evaluation of model " << nModel << " failed for " << nCands << " candidates";
+      }
+      for (std::size_t iCand = 0; iCand < nCands; ++iCand) {
+        std::copy(mBatchOutput.begin() + iCand * mNClasses, mBatchOutput.begin() + (iCand + 1) * mNClasses,
+                  mBatchScores.begin() + static_cast<std::size_t>(candidates[first + iCand]) * mNClasses);
+      }
+    }
+    inputs.clear();
+    candidates.clear();
+  }
+
   template <typename T>
   int findBin(T const& value)
   {
@@ -0,0 +1,162 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file     checkOnnxAllocations.cxx
+///
+/// \brief    Executable to count the heap allocations and time per call of the OnnxModel evaluation methods,
+///           and to benchmark the candidate throughput of a model for a list of batch sizes, numbers of threads
+///           and optimization settings (one line per configuration, for the comparison of the models of the selectors)
+///
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "Tools/ML/model.h"
+
+namespace bpo = boost::program_options;
+
+namespace
+{
+std::atomic<uint64_t> nAllocations{0};
+} // namespace
+
+// count all the heap allocations done in the process
+void* operator new(std::size_t size)
+{
+  nAllocations++;
+  if (void* ptr = std::malloc(size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+// comma-separated list of integers, e.g. "1,16,256,4096"
+std::vector<int> parseList(const std::string& list)
+{
+  std::vector<int> values;
+  std::stringstream stream(list);
+  std::string token;
+  while (std::getline(stream, token, ',')) {
+    if (!token.empty()) {
+      values.push_back(std::stoi(token));
+    }
+  }
+  return values;
+}
+
+// candidates per second, latency quantiles and allocations per call of the bound evaluation of nEntries candidates
+void benchmark(const std::string& modelPath, int nCalls, int nEntries, int nThreads, bool enableOptimizations)
+{
+  o2::ml::OnnxModel model;
+  model.initModel(modelPath, enableOptimizations, nThreads);
+  model.initIoBinding(nEntries);
+  std::fill(model.getInputBuffer(), model.getInputBuffer() + nEntries * model.getNumInputNodes(), 0.5f);
+  model.evalModelBound<float>(nEntries); // warm-up
+
+  std::vector<double> latencies(nCalls);
+  uint64_t allocationsBefore = nAllocations;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < nCalls; ++i) {
+    auto callStart = std::chrono::steady_clock::now();
+    model.evalModelBound<float>(nEntries);
+    latencies[i] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - callStart).count();
+  }
+  auto stop = std::chrono::steady_clock::now();
+  uint64_t allocations = nAllocations - allocationsBefore;
+  double seconds = std::chrono::duration<double>(stop - start).count();
+
+  std::sort(latencies.begin(), latencies.end());
+  auto quantile = [&](double q) { return latencies[std::min<std::size_t>(latencies.size() - 1, static_cast<std::size_t>(q * latencies.size()))]; };
+  LOG(info) << "batch " << nEntries << ", threads " << nThreads << ", optimizations " << enableOptimizations
+            << ": " << nCalls * static_cast<double>(nEntries) / seconds << " candidates/s, p50 " << quantile(0.5) << " us, p99 " << quantile(0.99)
+            << " us per call, " << static_cast<double>(allocations) / nCalls << " allocations per call";
+}
+
+template <typename F>
+void measure(const std::string& name, int nCalls, F&& evaluate)
+{
+  evaluate(); // warm-up, the first call may allocate the arena of the runtime
+  uint64_t allocationsBefore = nAllocations;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < nCalls; ++i) {
+    evaluate();
+  }
+  auto stop = std::chrono::steady_clock::now();
+  uint64_t allocations = nAllocations - allocationsBefore;
+  double timePerCall = std::chrono::duration<double, std::micro>(stop - start).count() / nCalls;
+  LOG(info) << name << ": " << static_cast<double>(allocations) / nCalls << " allocations per call, " << timePerCall << " us per call";
+}
+
+int main(int argc, char* argv[])
+{
+  bpo::options_description options("Allowed options");
+  options.add_options()(
+    "model,m", bpo::value<std::string>()->required(), "Path to the ONNX model file")(
+    "calls,n", bpo::value<int>()->default_value(10000), "Number of evaluations")(
+    "batch,b", bpo::value<int>()->default_value(1), "Number of entries per evaluation")(
+    "benchmark", "Benchmark the bound evaluation for all the combinations of the lists below")(
+    "batches", bpo::value<std::string>()->default_value("1,4,16,64,256,1024,4096"), "Comma-separated batch sizes of the benchmark")(
+    "threads", bpo::value<std::string>()->default_value("1,2,4"), "Comma-separated numbers of intra-op threads of the benchmark")(
+    "optimizations", bpo::value<std::string>()->default_value("0,1"), "Comma-separated graph optimization settings of the benchmark (0: default, 1: extended)")(
+    "help,h", "Produce help message.");
+  bpo::variables_map arguments;
+  try {
+    bpo::store(parse_command_line(argc, argv, options), arguments);
+    if (arguments.count("help")) {
+      LOG(info) << options;
+      return 0;
+    }
+    bpo::notify(arguments);
+  } catch (const bpo::error& e) {
+    LOG(error) << e.what();
+    LOG(error) << options;
+    return 1;
+  }
+
+  const int nCalls = arguments["calls"].as<int>();
+  const int nEntries = arguments["batch"].as<int>();
+  const std::string modelPath = arguments["model"].as<std::string>();
+
+  if (arguments.count("benchmark")) {
+    for (int optimizations : parseList(arguments["optimizations"].as<std::string>())) {
+      for (int nThreads : parseList(arguments["threads"].as<std::string>())) {
+        for (int batch : parseList(arguments["batches"].as<std::string>())) {
+          benchmark(modelPath, nCalls, batch, nThreads, optimizations != 0);
+        }
+      }
+    }
+    return 0;
+  }
+
+  o2::ml::OnnxModel model;
+  model.initModel(modelPath, false, 1);
+  std::vector<float> input(nEntries * model.getNumInputNodes(), 0.5f);
+  std::vector<float> output;
+
+  measure("evalModel", nCalls, [&]() { model.evalModel(input); });
+  measure("evalModelBatch", nCalls, [&]() { model.evalModelBatch(input, output); });
+
+  model.initIoBinding(nEntries);
+  measure("evalModelBound", nCalls, [&]() { model.evalModelBound<float>(nEntries); });
+
+  return 0;
+}
@@ -20,12 +20,41 @@
 // ONNX includes
 #include "Tools/ML/model.h"
 
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <sstream>
+
 namespace o2
 {
 
 namespace ml
 {
 
+bool OnnxModel::mShareSessions = false;
+
+namespace
+{
+// Registry of the sessions shared within the process, keyed by model content and session settings
+// The registry does not own the sessions: they are released when the last model using them is destroyed
+std::mutex sessionRegistryMutex;
+std::weak_ptr<Ort::Env> sharedEnv;
+#if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
+std::map<std::string, std::weak_ptr<Ort::Experimental::Session>> sessionRegistry;
+#else
+std::map<std::string, std::weak_ptr<Ort::Session>> sessionRegistry;
+#endif
+
+std::string getSessionKey(const std::string& path, bool enableOptimizations, int threads)
+{
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream content;
+  content << file.rdbuf();
+  std::string bytes = content.str();
+  return std::to_string(std::hash<std::string>{}(bytes)) + "_" + std::to_string(bytes.size()) + "_" + std::to_string(enableOptimizations) + "_" + std::to_string(threads);
+}
+} // namespace
+
 std::string OnnxModel::printShape(const std::vector<int64_t>& v)
 {
   std::stringstream ss("");
@@ -74,12 +103,7 @@ void OnnxModel::initModel(std::string localPath, bool enableOptimizations, int t
     sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
   }
 
-  mEnv = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "onnx-model");
-#if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
-  mSession = std::make_shared<Ort::Experimental::Session>(*mEnv, modelPath, sessionOptions);
-#else
-  mSession = std::make_shared<Ort::Session>(*mEnv, modelPath.c_str(), sessionOptions);
-#endif
+  createSession(enableOptimizations);
 
 #if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
   mInputNames = mSession->GetInputNames();
@@ -101,6 +125,13 @@ void OnnxModel::initModel(std::string localPath, bool enableOptimizations, int t
     mOutputShapes.emplace_back(mSession->GetOutputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape());
   }
 #endif
+  for (const auto& name : mInputNames) {
+    mInputNamesChar.push_back(name.c_str());
+  }
+  for (const auto& name : mOutputNames) {
+    mOutputNamesChar.push_back(name.c_str());
+  }
+
   LOG(info) << "Input Nodes:";
   for (size_t i = 0; i < mInputNames.size(); i++) {
     LOG(info) << "\t" << mInputNames[i] << " : " << printShape(mInputShapes[i]);
@@ -119,6 +150,129 @@ void OnnxModel::initModel(std::string localPath, bool enableOptimizations, int t
   LOG(info) << "--- Model initialized! ---";
 }
 
+namespace
+{
+std::size_t getElementSize(ONNXTensorElementDataType type)
+{
+  switch (type) {
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_BOOL:
+      return 1;
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT16:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT16:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16:
+      return 2;
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT32:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT:
+      return 4;
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT64:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_DOUBLE:
+      return 8;
+    default:
+      return 0;
+  }
+}
+} // namespace
+
+void OnnxModel::initIoBinding(int64_t maxBatchSize)
+{
+  if (!mSession) {
+    LOG(fatal) << "The model must be initialized before binding its buffers!";
+  }
+  if (mInputNames.size() != 1) {
+    LOG(fatal) << "Persistent buffers are supported only for models with one input, this model has " << mInputNames.size();
+  }
+  if (mSession->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetElementType() != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) {
+    LOG(fatal) << "Persistent buffers are supported only for models with float input";
+  }
+  if (mInputShapes[0][0] > 0 && maxBatchSize > mInputShapes[0][0]) {
+    LOG(warning) << "The model input has a fixed batch size of " << mInputShapes[0][0] << ", reducing the maximum batch size to it";
+    maxBatchSize = mInputShapes[0][0];
+  }
+
+  mMaxBoundBatchSize = maxBatchSize;
+  mMemoryInfo = Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
+  mInputBuffer.assign(maxBatchSize * mInputShapes[0][1], 0.f);
+
+  mOutputBuffers.clear();
+  mOutputTypes.clear();
+  for (std::size_t i = 0; i < mOutputNames.size(); ++i) {
+    ONNXTensorElementDataType type = mSession->GetOutputTypeInfo(i).GetTensorTypeAndShapeInfo().GetElementType();
+    std::size_t size = getElementSize(type);
+    if (size == 0) {
+      LOG(fatal) << "Unsupported element type of output " << mOutputNames[i] << " for persistent buffers";
+    }
+    for (const auto& dim : mOutputShapes[i]) {
+      size *= (dim < 0 ? maxBatchSize : dim);
+    }
+    mOutputTypes.push_back(type);
+    mOutputBuffers.emplace_back(size, 0);
+  }
+
+  mIoBinding = std::make_unique<Ort::IoBinding>(static_cast<Ort::Session&>(*mSession));
+  bindBuffers(1);
+  LOG(info) << "Bound persistent buffers for up to " << mMaxBoundBatchSize << " entries";
+}
+
+void OnnxModel::bindBuffers(int64_t nEntries)
+{
+  mIoBinding->ClearBoundInputs();
+  mIoBinding->ClearBoundOutputs();
+
+  std::vector<int64_t> inputShape{nEntries, mInputShapes[0][1]};
+  auto inputTensor = Ort::Value::CreateTensor<float>(mMemoryInfo, mInputBuffer.data(), nEntries * mInputShapes[0][1], inputShape.data(), inputShape.size());
+  mIoBinding->BindInput(mInputNamesChar[0], inputTensor);
+
+  for (std::size_t i = 0; i < mOutputNames.size(); ++i) {
+    std::vector<int64_t> outputShape = mOutputShapes[i];
+    std::size_t size = getElementSize(mOutputTypes[i]);
+    for (auto& dim : outputShape) {
+      if (dim < 0) {
+        dim = nEntries;
+      }
+      size *= dim;
+    }
+    auto outputTensor = Ort::Value::CreateTensor(mMemoryInfo, mOutputBuffers[i].data(), size, outputShape.data(), outputShape.size(), mOutputTypes[i]);
+    mIoBinding->BindOutput(mOutputNamesChar[i], outputTensor);
+  }
+  mBoundBatchSize = nEntries;
+}
+
+void OnnxModel::createSession(bool enableOptimizations)
+{
+  if (!mShareSessions) {
+    mEnv = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "onnx-model");
+#if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
+    mSession = std::make_shared<Ort::Experimental::Session>(*mEnv, modelPath, sessionOptions);
+#else
+    mSession = std::make_shared<Ort::Session>(*mEnv, modelPath.c_str(), sessionOptions);
+#endif
+    return;
+  }
+
+  std::string key = getSessionKey(modelPath, enableOptimizations, activeThreads);
+  std::lock_guard<std::mutex> lock(sessionRegistryMutex);
+  mEnv = sharedEnv.lock();
+  if (!mEnv) {
+    mEnv = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "onnx-model");
+    sharedEnv = mEnv;
+  }
+  mSession = sessionRegistry[key].lock();
+  if (mSession) {
+    LOG(info) << "Reusing the session of an identical model already loaded in this process";
+    return;
+  }
+#if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
+  mSession = std::make_shared<Ort::Experimental::Session>(*mEnv, modelPath, sessionOptions);
+#else
+  mSession = std::make_shared<Ort::Session>(*mEnv, modelPath.c_str(), sessionOptions);
+#endif
+  sessionRegistry[key] = mSession;
+}
+
 void OnnxModel::setActiveThreads(int threads)
 {
   activeThreads = threads;
@@ -54,6 +54,11 @@ class OnnxModel
   // Inferencing
   void initModel(std::string, bool = false, int = 0, uint64_t = 0, uint64_t = 0);
 
+  // Session sharing: when enabled, models initialized from identical files with the same settings share one
+  // environment and one (thread-safe) session, with its thread pool, within the process
+  static void setShareSessions(bool share) { mShareSessions = share; }
+  static bool getShareSessions() { return mShareSessions; }
+
   // template methods -- best to define them in header
   template <typename T>
   T* evalModel(std::vector<Ort::Value>& input)
@@ -65,15 +70,7 @@ class OnnxModel
 #if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
       auto outputTensors = mSession->Run(mInputNames, input, mOutputNames);
 #else
-      Ort::RunOptions runOptions;
-      std::vector<const char*> inputNamesChar(mInputNames.size(), nullptr);
-      std::transform(std::begin(mInputNames), std::end(mInputNames), std::begin(inputNamesChar),
-                     [&](const std::string& str) { return str.c_str(); });
-
-      std::vector<const char*> outputNamesChar(mOutputNames.size(), nullptr);
-      std::transform(std::begin(mOutputNames), std::end(mOutputNames), std::begin(outputNamesChar),
-                     [&](const std::string& str) { return str.c_str(); });
-      auto outputTensors = mSession->Run(runOptions, inputNamesChar.data(), input.data(), input.size(), outputNamesChar.data(), outputNamesChar.size());
+      auto outputTensors = mSession->Run(mRunOptions, mInputNamesChar.data(), input.data(), input.size(), mOutputNamesChar.data(), mOutputNamesChar.size());
 #endif
       LOG(debug) << "Number of output tensors: " << outputTensors.size();
       if (outputTensors.size() != mOutputNames.size()) {
@@ -111,6 +108,85 @@ class OnnxModel
     return evalModel<T>(inputTensors);
   }
 
+  // Evaluate the model on a batch of entries stored contiguously in input (one row of getNumInputNodes() features per entry)
+  // The values of the last output tensor are copied to output, whose capacity is reused between calls
+  template <typename T>
+  bool evalModelBatch(std::vector<T>& input, std::vector<T>& output)
+  {
+    int64_t size = input.size();
+    int64_t nFeatures = mInputShapes[0][1];
+    if (size == 0 || size % nFeatures != 0) {
+      LOG(error) << "Input size " << size << " is not a multiple of the number of input features " << nFeatures;
+      return false;
+    }
+    std::vector<int64_t> inputShape{size / nFeatures, nFeatures};
+    std::vector<Ort::Value> inputTensors;
+#if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
+    inputTensors.emplace_back(Ort::Experimental::Value::CreateTensor<T>(input.data(), size, inputShape));
+#else
+    Ort::MemoryInfo mem_info =
+      Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
+    inputTensors.emplace_back(Ort::Value::CreateTensor<T>(mem_info, input.data(), size, inputShape.data(), inputShape.size()));
+#endif
+    try {
+#if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
+      auto outputTensors = mSession->Run(mInputNames, inputTensors, mOutputNames);
+#else
+      auto outputTensors = mSession->Run(mRunOptions, mInputNamesChar.data(), inputTensors.data(), inputTensors.size(), mOutputNamesChar.data(), mOutputNamesChar.size());
+#endif
+      if (outputTensors.size() != mOutputNames.size()) {
+        LOG(fatal) << "Number of output tensors: " << outputTensors.size() << " does not agree with the model specified size: " << mOutputNames.size();
+      }
+      // copy the scores before the output tensors go out of scope
+      const T* outputValues = outputTensors.back().GetTensorMutableData<T>();
+      std::size_t nOutputValues = outputTensors.back().GetTensorTypeAndShapeInfo().GetElementCount();
+      output.assign(outputValues, outputValues + nOutputValues);
+      return true;
+    } catch (const Ort::Exception& exception) {
+      LOG(error) << "Error running model inference: " << exception.what();
+    }
+    return false;
+  }
+
+  // Evaluation with persistent buffers: initIoBinding() allocates the input and output buffers once, for up to maxBatchSize entries,
+  // and binds them to the session. evalModelBound() then only reads the features written in getInputBuffer() and
+  // returns a pointer to the last output buffer, so that no heap allocation happens per evaluation
+  void initIoBinding(int64_t maxBatchSize = 1);
+  bool hasIoBinding() const { return mIoBinding != nullptr; }
+  float* getInputBuffer() { return mInputBuffer.data(); }
+
+  template <typename T>
+  T* evalModelBound(int64_t nEntries = 1)
+  {
+    if (!mIoBinding || nEntries < 1 || nEntries > mMaxBoundBatchSize) {
+      LOG(error) << "Cannot evaluate " << nEntries << " entries with the bound buffers (maximum " << mMaxBoundBatchSize << ")";
+      return nullptr;
+    }
+    if (nEntries != mBoundBatchSize) {
+      bindBuffers(nEntries);
+    }
+    try {
+      static_cast<Ort::Session&>(*mSession).Run(mRunOptions, *mIoBinding);
+    } catch (const Ort::Exception& exception) {
+      LOG(error) << "Error running model inference: " << exception.what();
+      return nullptr;
+    }
+    return reinterpret_cast<T*>(mOutputBuffers.back().data());
+  }
+
+  // Same as above, copying the features from a vector to the input buffer first
+  template <typename T>
+  T* evalModelBound(const std::vector<float>& input)
+  {
+    int64_t nEntries = input.size() / mInputShapes[0][1];
+    if (!mIoBinding || nEntries > mMaxBoundBatchSize) {
+      LOG(error) << "Cannot evaluate " << nEntries << " entries with the bound buffers (maximum " << mMaxBoundBatchSize << ")";
+      return nullptr;
+    }
+    std::copy(input.begin(), input.end(), mInputBuffer.begin());
+    return evalModelBound<T>(nEntries);
+  }
+
   // Reset session
 #if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
   void resetSession() { mSession.reset(new Ort::Experimental::Session{*mEnv, modelPath, sessionOptions}); }
@@ -133,6 +209,7 @@ class OnnxModel
 #endif
   int getNumInputNodes() const { return mInputShapes[0][1]; }
   int getNumOutputNodes() const { return mOutputShapes[0][1]; }
+  int64_t getInputBatchSize() const { return mInputShapes[0][0]; } // -1 if the model accepts batches of any size
   uint64_t getValidityFrom() const { return validFrom; }
   uint64_t getValidityUntil() const { return validUntil; }
   void setActiveThreads(int);
@@ -153,15 +230,35 @@ class OnnxModel
   std::vector<std::string> mOutputNames;
   std::vector<std::vector<int64_t>> mOutputShapes;
 
+  // Cached C-string names, needed by the ONNX runtime C++ API
+  std::vector<const char*> mInputNamesChar;
+  std::vector<const char*> mOutputNamesChar;
+  Ort::RunOptions mRunOptions;
+
+  // Persistent buffers bound to the session (see initIoBinding())
+  std::unique_ptr<Ort::IoBinding> mIoBinding = nullptr;
+  Ort::MemoryInfo mMemoryInfo{nullptr};
+  std::vector<float> mInputBuffer;
+  std::vector<std::vector<uint8_t>> mOutputBuffers; // raw storage, the element type depends on the output
+  std::vector<ONNXTensorElementDataType> mOutputTypes;
+  int64_t mMaxBoundBatchSize = 0;
+  int64_t mBoundBatchSize = 0;
+
   // Environment settings
   std::string modelPath;
   int activeThreads = 0;
   uint64_t validFrom = 0;
   uint64_t validUntil = 0;
 
+  // Process-wide session sharing
+  static bool mShareSessions;
+  void createSession(bool enableOptimizations);
+
   // Internal function for printing the shape of tensors
   std::string printShape(const std::vector<int64_t>&);
   bool checkHyperloop(bool = true);
+  // Bind the persistent buffers for a batch of nEntries
+  void bindBuffers(int64_t nEntries);
 };
 
 } // namespace ml
@@ -19,6 +19,8 @@
 
 #include <string>
 #include <algorithm>
+#include <array>
+#include <cstddef>
 #include <map>
 #include <utility>
 #include <memory>
@@ -131,6 +133,44 @@ struct PidONNXModel {
     return getModelOutput(track) >= mMinCertainty;
   }
 
+  /// Certainties of all the tracks of a table (e.g. the tracks of a collision), in the order of the table.
+  /// The inputs of up to kMaxBatchSize tracks are evaluated in one run of the session if the model has a
+  /// variable batch dimension, else one track at a time.
+  template <typename T>
+  void applyModel(const T& tracks, std::vector<float>& certainties)
+  {
+    certainties.resize(tracks.size());
+    const std::size_t nFeatures = getNFeatures();
+    const std::size_t batchSize = (!mInputShapes[0].empty() && mInputShapes[0][0] < 0) ? kMaxBatchSize : 1;
+    mInputValues.resize(batchSize * nFeatures);
+    std::size_t first = 0;
+    std::size_t nInBatch = 0;
+    for (const auto& track : tracks) {
+      fillInputs(track, mInputValues.data() + nInBatch * nFeatures);
+      if (++nInBatch == batchSize) {
+        runModel(nInBatch, certainties.data() + first);
+        first += nInBatch;
+        nInBatch = 0;
+      }
+    }
+    if (nInBatch > 0) {
+      runModel(nInBatch, certainties.data() + first);
+    }
+  }
+
+  /// Decisions of all the tracks of a table, in the order of the table
+  template <typename T>
+  void applyModelBoolean(const T& tracks, std::vector<bool>& accepted)
+  {
+    applyModel(tracks, mCertainties);
+    accepted.resize(mCertainties.size());
+    for (std::size_t i = 0; i < mCertainties.size(); ++i) {
+      accepted[i] = mCertainties[i] >= mMinCertainty;
+    }
+  }
+
+  static constexpr std::size_t kMaxBatchSize = 1024; ///< maximum number of tracks per run of the session
+
   PidMLDetector mDetector;
   int mPid;
   double mMinCertainty;
@@ -201,40 +241,89 @@ struct PidONNXModel {
         mScalingParams[param[0].GetString()] = std::make_pair(param[1].GetFloat(), param[2].GetFloat());
       }
     }
+    resolveScaling();
   }
 
+  // scaled inputs, in the order of the ScaledInput enum
+  enum ScaledInput {
+    kX = 0,
+    kY,
+    kZ,
+    kAlpha,
+    kTPCNClsShared,
+    kDcaXY,
+    kDcaZ,
+    kTPCSignal,
+    kTOFSignal,
+    kBeta,
+    kTRDSignal,
+    kTRDPattern,
+    kNScaledInputs
+  };
+
+  // scaling parameters of the inputs used by the detector configuration, looked up once instead of per track
+  void resolveScaling()
+  {
+    static constexpr const char* names[kNScaledInputs] = {"fX", "fY", "fZ", "fAlpha", "fTPCNClsShared", "fDcaXY", "fDcaZ", "fTPCSignal", "fTOFSignal", "fBeta", "fTRDSignal", "fTRDPattern"};
+    int nUsed = kTOFSignal;
+    if (mDetector >= kTPCTOF) {
+      nUsed = kTRDSignal;
+    }
+    if (mDetector >= kTPCTOFTRD) {
+      nUsed = kNScaledInputs;
+    }
+    for (int i = 0; i < nUsed; ++i) {
+      mScaling[i] = mScalingParams.at(names[i]);
+    }
+  }
+
+  float scale(float value, ScaledInput input) const
+  {
+    return (value - mScaling[input].first) / mScaling[input].second;
+  }
+
+  std::size_t getNFeatures() const
+  {
+    std::size_t n = 14;
+    if (mDetector >= kTPCTOF) {
+      n += 2;
+    }
+    if (mDetector >= kTPCTOFTRD) {
+      n += 2;
+    }
+    return n;
+  }
+
+  // writes the getNFeatures() inputs of the track to values
   template <typename T>
-  std::vector<float> createInputsSingle(const T& track)
+  void fillInputs(const T& track, float* values) const
   {
     // TODO: Hardcoded for now. Planning to implement RowView extension to get runtime access to selected columns
     // sign is short, trackType and tpcNClsShared uint8_t
-    float scaledX = (track.x() - mScalingParams.at("fX").first) / mScalingParams.at("fX").second;
-    float scaledY = (track.y() - mScalingParams.at("fY").first) / mScalingParams.at("fY").second;
-    float scaledZ = (track.z() - mScalingParams.at("fZ").first) / mScalingParams.at("fZ").second;
-    float scaledAlpha = (track.alpha() - mScalingParams.at("fAlpha").first) / mScalingParams.at("fAlpha").second;
-    float scaledTPCNClsShared = (static_cast<float>(track.tpcNClsShared()) - mScalingParams.at("fTPCNClsShared").first) / mScalingParams.at("fTPCNClsShared").second;
-    float scaledDcaXY = (track.dcaXY() - mScalingParams.at("fDcaXY").first) / mScalingParams.at("fDcaXY").second;
-    float scaledDcaZ = (track.dcaZ() - mScalingParams.at("fDcaZ").first) / mScalingParams.at("fDcaZ").second;
-
-    float scaledTPCSignal = (track.tpcSignal() - mScalingParams.at("fTPCSignal").first) / mScalingParams.at("fTPCSignal").second;
-
-    std::vector<float> inputValues{track.px(), track.py(), track.pz(), static_cast<float>(track.sign()), scaledX, scaledY, scaledZ, scaledAlpha, static_cast<float>(track.trackType()), scaledTPCNClsShared, scaledDcaXY, scaledDcaZ, track.p(), scaledTPCSignal};
+    values[0] = track.px();
+    values[1] = track.py();
+    values[2] = track.pz();
+    values[3] = static_cast<float>(track.sign());
+    values[4] = scale(track.x(), kX);
+    values[5] = scale(track.y(), kY);
+    values[6] = scale(track.z(), kZ);
+    values[7] = scale(track.alpha(), kAlpha);
+    values[8] = static_cast<float>(track.trackType());
+    values[9] = scale(static_cast<float>(track.tpcNClsShared()), kTPCNClsShared);
+    values[10] = scale(track.dcaXY(), kDcaXY);
+    values[11] = scale(track.dcaZ(), kDcaZ);
+    values[12] = track.p();
+    values[13] = scale(track.tpcSignal(), kTPCSignal);
 
     if (mDetector >= kTPCTOF) {
-      float scaledTOFSignal = (track.tofSignal() - mScalingParams.at("fTOFSignal").first) / mScalingParams.at("fTOFSignal").second;
-      float scaledBeta = (track.beta() - mScalingParams.at("fBeta").first) / mScalingParams.at("fBeta").second;
-      inputValues.push_back(scaledTOFSignal);
-      inputValues.push_back(scaledBeta);
+      values[14] = scale(track.tofSignal(), kTOFSignal);
+      values[15] = scale(track.beta(), kBeta);
     }
 
     if (mDetector >= kTPCTOFTRD) {
-      float scaledTRDSignal = (track.trdSignal() - mScalingParams.at("fTRDSignal").first) / mScalingParams.at("fTRDSignal").second;
-      float scaledTRDPattern = (track.trdPattern() - mScalingParams.at("fTRDPattern").first) / mScalingParams.at("fTRDPattern").second;
-      inputValues.push_back(scaledTRDSignal);
-      inputValues.push_back(scaledTRDPattern);
+      values[16] = scale(track.trdSignal(), kTRDSignal);
+      values[17] = scale(track.trdPattern(), kTRDPattern);
     }
-
-    return inputValues;
   }
 
   // FIXME: Temporary solution, new networks will have sigmoid layer added
@@ -246,16 +335,29 @@ struct PidONNXModel {
 
   template <typename T>
   float getModelOutput(const T& track)
+  {
+    mInputValues.resize(getNFeatures());
+    fillInputs(track, mInputValues.data());
+    float certainty = 0.f;
+    runModel(1, &certainty);
+    return certainty;
+  }
+
+  // runs the session on the inputs of nTracks tracks in mInputValues, writes nTracks certainties
+  void runModel(std::size_t nTracks, float* certainties)
   {
     auto input_shape = mInputShapes[0];
-    std::vector<float> inputTensorValues = createInputsSingle(track);
+    if (!input_shape.empty() && input_shape[0] < 0) {
+      input_shape[0] = static_cast<int64_t>(nTracks);
+    }
+    const std::size_t nValues = nTracks * getNFeatures();
     std::vector<Ort::Value> inputTensors;
 #if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
-    inputTensors.emplace_back(Ort::Experimental::Value::CreateTensor<float>(inputTensorValues.data(), inputTensorValues.size(), input_shape));
+    inputTensors.emplace_back(Ort::Experimental::Value::CreateTensor<float>(mInputValues.data(), nValues, input_shape));
 #else
     Ort::MemoryInfo mem_info =
       Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
-    inputTensors.emplace_back(Ort::Value::CreateTensor<float>(mem_info, inputTensorValues.data(), inputTensorValues.size(), input_shape.data(), input_shape.size()));
+    inputTensors.emplace_back(Ort::Value::CreateTensor<float>(mem_info, mInputValues.data(), nValues, input_shape.data(), input_shape.size()));
 
 #endif
 
@@ -285,12 +387,14 @@ struct PidONNXModel {
       LOG(debug) << "output tensor shape: " << printShape(outputTensors[0].GetTensorTypeAndShapeInfo().GetShape());
 
       const float* output_value = outputTensors[0].GetTensorData<float>();
-      float certainty = sigmoid(*output_value); // FIXME: Temporary, sigmoid will be added as network layer
-      return certainty;
+      for (std::size_t i = 0; i < nTracks; ++i) {
+        certainties[i] = sigmoid(output_value[i]); // FIXME: Temporary, sigmoid will be added as network layer
+      }
+      return;
     } catch (const Ort::Exception& exception) {
       LOG(error) << "Error running model inference: " << exception.what();
     }
-    return false; // unreachable code
+    std::fill(certainties, certainties + nTracks, 0.f); // unreachable code
   }
 
   // Pretty prints a shape dimension vector
@@ -305,6 +409,9 @@ struct PidONNXModel {
 
   std::vector<std::string> mTrainColumns;
   std::map<std::string, std::pair<float, float>> mScalingParams;
+  std::array<std::pair<float, float>, kNScaledInputs> mScaling{}; // mean and scale of the used inputs
+  std::vector<float> mInputValues;                                 // inputs of the tracks of one run of the session
+  std::vector<float> mCertainties;                                 // used by the batched applyModelBoolean
 
   std::shared_ptr<Ort::Env> mEnv = nullptr;
   // No empty constructors for Session, we need a pointer
@@ -21,7 +21,9 @@
 #include "Common/DataModel/PIDResponse.h"
 #include <TParameter.h>
 #include "Tools/PIDML/pidOnnxModel.h"
+#include <array>
 #include <string>
+#include <vector>
 
 using namespace o2;
 using namespace o2::framework;
@@ -322,18 +324,14 @@ struct pidml {
     }
   }
 
+  // iTrack: index of the track in the certainties of the models, evaluated once per table
   template <std::size_t i, typename T>
-  void pidML(const T& track, const int pdgCodeMC)
+  void pidML(const T& track, const int pdgCodeMC, std::size_t iTrack)
   {
     float pidCertainties[3];
-    if (track.p() < pSwitchValue[i]) {
-      pidCertainties[0] = model211TPC.applyModel(track);
-      pidCertainties[1] = model2212TPC.applyModel(track);
-      pidCertainties[2] = model321TPC.applyModel(track);
-    } else {
-      pidCertainties[0] = model211All.applyModel(track);
-      pidCertainties[1] = model2212All.applyModel(track);
-      pidCertainties[2] = model321All.applyModel(track);
+    const auto& certainties = track.p() < pSwitchValue[i] ? certaintiesTPC : certaintiesAll;
+    for (int j = 0; j < numParticles; j++) {
+      pidCertainties[j] = certainties[j][iTrack];
     }
     int pid = getParticlePdg(pidCertainties);
     // condition for sign: we want to work only with pi, p and K, without antiparticles
@@ -354,6 +352,9 @@ struct pidml {
   PidONNXModel model211TPC;
   PidONNXModel model2212TPC;
   PidONNXModel model321TPC;
+  // certainties of the tracks of the table for pi, p, K
+  std::array<std::vector<float>, numParticles> certaintiesAll;
+  std::array<std::vector<float>, numParticles> certaintiesTPC;
 
   Configurable<std::string> cfgPathCCDB{"ccdb-path", "Users/m/mkabus/PIDML", "base path to the CCDB directory with ONNX models"};
   Configurable<std::string> cfgCCDBURL{"ccdb-url", "http://alice-ccdb.cern.ch", "URL of the CCDB repository"};
@@ -393,6 +394,15 @@ struct pidml {
       model321TPC = PidONNXModel(cfgPathLocal.value, cfgPathCCDB.value, cfgUseCCDB.value, ccdbApi, bc.timestamp(), 321, kTPCOnly, 0.5f);
     }
 
+    // batched inference on all the tracks
+    model211All.applyModel(tracks, certaintiesAll[0]);
+    model2212All.applyModel(tracks, certaintiesAll[1]);
+    model321All.applyModel(tracks, certaintiesAll[2]);
+    model211TPC.applyModel(tracks, certaintiesTPC[0]);
+    model2212TPC.applyModel(tracks, certaintiesTPC[1]);
+    model321TPC.applyModel(tracks, certaintiesTPC[2]);
+
+    std::size_t iTrack = 0;
     for (auto& track : tracks) {
       auto particle = track.mcParticle_as<aod::McParticles_000>();
       int pdgCodeMC = particle.pdgCode();
@@ -401,8 +411,9 @@ struct pidml {
 
       // only 3 particles can be predicted by model
       static_for<0, 2>([&](auto i) {
-        pidML<i>(track, pdgCodeMC);
+        pidML<i>(track, pdgCodeMC, iTrack);
       });
+      ++iTrack;
     }
   }
 };